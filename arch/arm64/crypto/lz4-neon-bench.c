@@ -0,0 +1,188 @@
+/*
+ * LZ4 decompression benchmark, generic vs NEON
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Pages of text-like data are compressed once, then decompressed on every
+ * online cpu by the generic decoder and by the "lz4-neon" crypto driver.
+ * Throughput is reported in MB/s with the cpu part number, so that big and
+ * little cores (0xd09 A73, 0xd03 A53) can be compared, e.g.
+ *
+ * #insmod lz4-neon-bench.ko nr_pages=64 loops=32
+ */
+
+#define pr_fmt(fmt) "lz4_neon_bench: " fmt
+
+#include <linux/crypto.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/lz4.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/random.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/workqueue.h>
+
+#include <asm/cputype.h>
+
+static unsigned int nr_pages = 64;
+module_param(nr_pages, uint, 0444);
+MODULE_PARM_DESC(nr_pages, "pages compressed for the benchmark");
+
+static unsigned int loops = 32;
+module_param(loops, uint, 0444);
+MODULE_PARM_DESC(loops, "decompression passes over the pages");
+
+struct lz4_bench {
+	struct crypto_comp	*tfm;
+	u8			*comp;
+	unsigned int		*comp_len;
+	u8			*out;
+	int			ret;
+};
+
+static const char * const lz4_bench_words[] = {
+	"the ", "kernel ", "page ", "swap ", "zram ", "binder ",
+	"surfaceflinger ", "0123456789 ", "\0\0\0\0\0\0\0\0",
+};
+
+static void lz4_bench_fill(u8 *buf, size_t len)
+{
+	size_t n = 0, i, wlen;
+	const char *w;
+	u32 rnd;
+
+	while (n < len) {
+		rnd = prandom_u32();
+		if (!(rnd & 0xf)) {
+			/* incompressible noise */
+			buf[n++] = rnd >> 8;
+			continue;
+		}
+
+		w = lz4_bench_words[(rnd >> 4) % ARRAY_SIZE(lz4_bench_words)];
+		wlen = strlen(w) ?: 8;
+		for (i = 0; i < wlen && n < len; i++)
+			buf[n++] = w[i];
+	}
+}
+
+/* Returns MB/s of decompressing every page, generic if @tfm is NULL */
+static u64 lz4_bench_run(struct lz4_bench *b, struct crypto_comp *tfm)
+{
+	unsigned int i, j, dlen;
+	ktime_t start;
+	u64 ns;
+	int ret;
+
+	start = ktime_get();
+	for (j = 0; j < loops; j++) {
+		for (i = 0; i < nr_pages; i++) {
+			u8 *src = b->comp + i * LZ4_COMPRESSBOUND(PAGE_SIZE);
+
+			dlen = PAGE_SIZE;
+			if (tfm)
+				ret = crypto_comp_decompress(tfm, src,
+						b->comp_len[i], b->out, &dlen);
+			else
+				ret = LZ4_decompress_safe(src, b->out,
+						b->comp_len[i], dlen) < 0;
+			if (ret || dlen != PAGE_SIZE) {
+				b->ret = -EINVAL;
+				return 0;
+			}
+		}
+		cond_resched();
+	}
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	return ns ? div64_u64((u64)PAGE_SIZE * nr_pages * loops *
+			NSEC_PER_SEC, ns) >> 20 : 0;
+}
+
+static long lz4_bench_cpu(void *data)
+{
+	struct lz4_bench *b = data;
+	u64 generic, neon;
+
+	generic = lz4_bench_run(b, NULL);
+	neon = lz4_bench_run(b, b->tfm);
+
+	pr_info("cpu%d part 0x%03x: generic %5llu MB/s neon %5llu MB/s\n",
+		smp_processor_id(), read_cpuid_part_number(), generic, neon);
+
+	return b->ret;
+}
+
+static int __init lz4_bench_init(void)
+{
+	struct lz4_bench b = { };
+	void *wrkmem;
+	u8 *in;
+	unsigned int i;
+	int cpu, ret = 0;
+
+	if (!nr_pages || !loops)
+		return -EINVAL;
+
+	b.tfm = crypto_alloc_comp("lz4-neon", 0, 0);
+	if (IS_ERR(b.tfm)) {
+		pr_err("lz4-neon is not available\n");
+		return PTR_ERR(b.tfm);
+	}
+
+	in = vmalloc(PAGE_SIZE * nr_pages);
+	b.comp = vmalloc(LZ4_COMPRESSBOUND(PAGE_SIZE) * nr_pages);
+	b.comp_len = kcalloc(nr_pages, sizeof(*b.comp_len), GFP_KERNEL);
+	b.out = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	wrkmem = vmalloc(LZ4_MEM_COMPRESS);
+	if (!in || !b.comp || !b.comp_len || !b.out || !wrkmem) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	lz4_bench_fill(in, PAGE_SIZE * nr_pages);
+	for (i = 0; i < nr_pages; i++) {
+		b.comp_len[i] = LZ4_compress_default(in + i * PAGE_SIZE,
+				b.comp + i * LZ4_COMPRESSBOUND(PAGE_SIZE),
+				PAGE_SIZE, LZ4_COMPRESSBOUND(PAGE_SIZE), wrkmem);
+		if (!b.comp_len[i]) {
+			ret = -EINVAL;
+			goto out;
+		}
+	}
+
+	get_online_cpus();
+	for_each_online_cpu(cpu) {
+		ret = work_on_cpu(cpu, lz4_bench_cpu, &b);
+		if (ret) {
+			pr_err("cpu%d: decompression failed\n", cpu);
+			break;
+		}
+	}
+	put_online_cpus();
+
+out:
+	vfree(wrkmem);
+	kfree(b.out);
+	kfree(b.comp_len);
+	vfree(b.comp);
+	vfree(in);
+	crypto_free_comp(b.tfm);
+
+	return ret;
+}
+
+static void __exit lz4_bench_exit(void)
+{
+}
+
+module_init(lz4_bench_init);
+module_exit(lz4_bench_exit);
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("LZ4 decompression benchmark, generic vs NEON");
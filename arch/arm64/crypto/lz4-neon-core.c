@@ -0,0 +1,211 @@
+/*
+ * LZ4 decompression using NEON instructions
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Based on LZ4_decompress_generic() of lib/lz4/lz4_decompress.c, reduced
+ * to the safe, full block, no dictionary case.
+ *
+ * Literals and matches whose offset is 16 or more are copied 16 bytes at a
+ * time with NEON loads and stores while there are 16 bytes of slack in both
+ * buffers, which covers nearly all sequences of a 4K page. Short offsets
+ * and the end of the block fall back to the 8 bytes copies of the generic
+ * decoder.
+ *
+ * This file is compiled with NEON enabled, so the caller must hold
+ * kernel_neon_begin().
+ */
+
+#include <arm_neon.h>
+
+#define MINMATCH	4
+#define WILDCOPYLENGTH	8
+#define LASTLITERALS	5
+#define MFLIMIT		(WILDCOPYLENGTH + MINMATCH)
+
+#define ML_BITS		4
+#define ML_MASK		((1U << ML_BITS) - 1)
+#define RUN_BITS	(8 - ML_BITS)
+#define RUN_MASK	((1U << RUN_BITS) - 1)
+
+#define likely(x)	__builtin_expect(!!(x), 1)
+#define unlikely(x)	__builtin_expect(!!(x), 0)
+
+static inline void lz4_copy8(uint8_t *d, const uint8_t *s)
+{
+	vst1_u8(d, vld1_u8(s));
+}
+
+static inline void lz4_copy16(uint8_t *d, const uint8_t *s)
+{
+	vst1q_u8(d, vld1q_u8(s));
+}
+
+/* may write up to 7 bytes beyond e */
+static inline void lz4_wild_copy8(uint8_t *d, const uint8_t *s, uint8_t *e)
+{
+	do {
+		lz4_copy8(d, s);
+		d += 8;
+		s += 8;
+	} while (d < e);
+}
+
+/* may write up to 15 bytes beyond e */
+static inline void lz4_wild_copy16(uint8_t *d, const uint8_t *s, uint8_t *e)
+{
+	do {
+		lz4_copy16(d, s);
+		d += 16;
+		s += 16;
+	} while (d < e);
+}
+
+static inline unsigned int lz4_read_le16(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+int lz4_decompress_neon(const uint8_t *src, uint8_t *dst, int src_len,
+			int dst_len)
+{
+	static const unsigned int dec32table[] = { 0, 1, 2, 1, 4, 4, 4, 4 };
+	static const int dec64table[] = { 0, 0, 0, -1, 0, 1, 2, 3 };
+	const uint8_t *ip = src;
+	const uint8_t * const iend = ip + src_len;
+	uint8_t *op = dst;
+	uint8_t * const oend = op + dst_len;
+	uint8_t *cpy;
+
+	if (unlikely(dst_len == 0))
+		return ((src_len == 1) && (*ip == 0)) ? 0 : -1;
+
+	while (1) {
+		unsigned int token = *ip++;
+		const uint8_t *match;
+		uintptr_t length;
+		uintptr_t offset;
+
+		/* get literal length */
+		length = token >> ML_BITS;
+		if (length == RUN_MASK) {
+			unsigned int s;
+
+			do {
+				s = *ip++;
+				length += s;
+			} while (likely(ip < iend - RUN_MASK) & (s == 255));
+
+			/* overflow detection */
+			if (unlikely((uintptr_t)(op + length) < (uintptr_t)op))
+				return -1;
+			if (unlikely((uintptr_t)(ip + length) < (uintptr_t)ip))
+				return -1;
+		}
+
+		/* copy literals */
+		cpy = op + length;
+		if (cpy > oend - MFLIMIT ||
+		    ip + length > iend - (2 + 1 + LASTLITERALS)) {
+			/* last literals, input must be consumed */
+			if (ip + length != iend || cpy > oend)
+				return -1;
+
+			__builtin_memcpy(op, ip, length);
+			op += length;
+			break;
+		}
+
+		if (likely(cpy <= oend - 16 && ip + length <= iend - 16))
+			lz4_wild_copy16(op, ip, cpy);
+		else
+			lz4_wild_copy8(op, ip, cpy);
+		ip += length;
+		op = cpy;
+
+		/* get offset */
+		offset = lz4_read_le16(ip);
+		ip += 2;
+		match = op - offset;
+		if (unlikely(match < dst))
+			return -1;
+
+		/* get match length */
+		length = token & ML_MASK;
+		if (length == ML_MASK) {
+			unsigned int s;
+
+			do {
+				s = *ip++;
+				if (ip > iend - LASTLITERALS)
+					return -1;
+				length += s;
+			} while (s == 255);
+
+			/* overflow detection */
+			if (unlikely((uintptr_t)(op + length) < (uintptr_t)op))
+				return -1;
+		}
+		length += MINMATCH;
+
+		/* copy match */
+		cpy = op + length;
+
+		/*
+		 * With an offset of 16 or more, every 16 bytes load reads
+		 * bytes which are already written.
+		 */
+		if (likely(offset >= 16 && cpy <= oend - 16)) {
+			lz4_wild_copy16(op, match, cpy);
+			op = cpy;
+			continue;
+		}
+
+		if (unlikely(offset < 8)) {
+			const int dec64 = dec64table[offset];
+
+			op[0] = match[0];
+			op[1] = match[1];
+			op[2] = match[2];
+			op[3] = match[3];
+			match += dec32table[offset];
+			__builtin_memcpy(op + 4, match, 4);
+			match -= dec64;
+		} else {
+			lz4_copy8(op, match);
+			match += 8;
+		}
+
+		op += 8;
+
+		if (unlikely(cpy > oend - 12)) {
+			uint8_t * const ocopy_limit = oend - (WILDCOPYLENGTH - 1);
+
+			/* last LASTLITERALS bytes must be literals */
+			if (cpy > oend - LASTLITERALS)
+				return -1;
+
+			if (op < ocopy_limit) {
+				lz4_wild_copy8(op, match, ocopy_limit);
+				match += ocopy_limit - op;
+				op = ocopy_limit;
+			}
+
+			while (op < cpy)
+				*op++ = *match++;
+		} else {
+			lz4_copy8(op, match);
+			if (length > 16)
+				lz4_wild_copy8(op + 8, match + 8, cpy);
+		}
+
+		op = cpy;
+	}
+
+	/* number of output bytes decoded */
+	return (int)(op - dst);
+}
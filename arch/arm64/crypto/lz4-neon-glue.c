@@ -0,0 +1,188 @@
+/*
+ * LZ4 compression algorithm with NEON accelerated decompression
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Registered with a higher priority than the generic "lz4", so that zram
+ * and other users of the crypto API pick it up. Compression is the generic
+ * one, decompression falls back to the generic one where NEON may not be
+ * used.
+ */
+
+#include <crypto/internal/scompress.h>
+#include <linux/crypto.h>
+#include <linux/kernel.h>
+#include <linux/lz4.h>
+#include <linux/module.h>
+#include <linux/vmalloc.h>
+
+#include <asm/hwcap.h>
+#include <asm/neon.h>
+#include <asm/simd.h>
+
+int lz4_decompress_neon(const u8 *src, u8 *dst, int src_len, int dst_len);
+
+struct lz4_neon_ctx {
+	void *lz4_comp_mem;
+};
+
+static void *lz4_neon_alloc_ctx(struct crypto_scomp *tfm)
+{
+	void *ctx;
+
+	ctx = vmalloc(LZ4_MEM_COMPRESS);
+	if (!ctx)
+		return ERR_PTR(-ENOMEM);
+
+	return ctx;
+}
+
+static void lz4_neon_free_ctx(struct crypto_scomp *tfm, void *ctx)
+{
+	vfree(ctx);
+}
+
+static int lz4_neon_init(struct crypto_tfm *tfm)
+{
+	struct lz4_neon_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	ctx->lz4_comp_mem = lz4_neon_alloc_ctx(NULL);
+	if (IS_ERR(ctx->lz4_comp_mem))
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void lz4_neon_exit(struct crypto_tfm *tfm)
+{
+	struct lz4_neon_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	lz4_neon_free_ctx(NULL, ctx->lz4_comp_mem);
+}
+
+static int __lz4_neon_compress(const u8 *src, unsigned int slen,
+			       u8 *dst, unsigned int *dlen, void *ctx)
+{
+	int out_len = LZ4_compress_default(src, dst, slen, *dlen, ctx);
+
+	if (!out_len)
+		return -EINVAL;
+
+	*dlen = out_len;
+	return 0;
+}
+
+static int __lz4_neon_decompress(const u8 *src, unsigned int slen,
+				 u8 *dst, unsigned int *dlen)
+{
+	int out_len;
+
+	if (may_use_simd()) {
+		kernel_neon_begin();
+		out_len = lz4_decompress_neon(src, dst, slen, *dlen);
+		kernel_neon_end();
+	} else {
+		out_len = LZ4_decompress_safe(src, dst, slen, *dlen);
+	}
+
+	if (out_len < 0)
+		return -EINVAL;
+
+	*dlen = out_len;
+	return 0;
+}
+
+static int lz4_neon_scompress(struct crypto_scomp *tfm, const u8 *src,
+			      unsigned int slen, u8 *dst, unsigned int *dlen,
+			      void *ctx)
+{
+	return __lz4_neon_compress(src, slen, dst, dlen, ctx);
+}
+
+static int lz4_neon_sdecompress(struct crypto_scomp *tfm, const u8 *src,
+				unsigned int slen, u8 *dst, unsigned int *dlen,
+				void *ctx)
+{
+	return __lz4_neon_decompress(src, slen, dst, dlen);
+}
+
+static int lz4_neon_compress_crypto(struct crypto_tfm *tfm, const u8 *src,
+				    unsigned int slen, u8 *dst,
+				    unsigned int *dlen)
+{
+	struct lz4_neon_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	return __lz4_neon_compress(src, slen, dst, dlen, ctx->lz4_comp_mem);
+}
+
+static int lz4_neon_decompress_crypto(struct crypto_tfm *tfm, const u8 *src,
+				      unsigned int slen, u8 *dst,
+				      unsigned int *dlen)
+{
+	return __lz4_neon_decompress(src, slen, dst, dlen);
+}
+
+static struct crypto_alg alg_lz4_neon = {
+	.cra_name		= "lz4",
+	.cra_driver_name	= "lz4-neon",
+	.cra_priority		= 200,
+	.cra_flags		= CRYPTO_ALG_TYPE_COMPRESS,
+	.cra_ctxsize		= sizeof(struct lz4_neon_ctx),
+	.cra_module		= THIS_MODULE,
+	.cra_init		= lz4_neon_init,
+	.cra_exit		= lz4_neon_exit,
+	.cra_u			= { .compress = {
+	.coa_compress		= lz4_neon_compress_crypto,
+	.coa_decompress		= lz4_neon_decompress_crypto } }
+};
+
+static struct scomp_alg scomp_lz4_neon = {
+	.alloc_ctx		= lz4_neon_alloc_ctx,
+	.free_ctx		= lz4_neon_free_ctx,
+	.compress		= lz4_neon_scompress,
+	.decompress		= lz4_neon_sdecompress,
+	.base			= {
+		.cra_name	= "lz4",
+		.cra_driver_name = "lz4-neon-scomp",
+		.cra_priority	= 200,
+		.cra_module	= THIS_MODULE,
+	}
+};
+
+static int __init lz4_neon_mod_init(void)
+{
+	int ret;
+
+	if (!(elf_hwcap & HWCAP_ASIMD))
+		return -ENODEV;
+
+	ret = crypto_register_alg(&alg_lz4_neon);
+	if (ret)
+		return ret;
+
+	ret = crypto_register_scomp(&scomp_lz4_neon);
+	if (ret) {
+		crypto_unregister_alg(&alg_lz4_neon);
+		return ret;
+	}
+
+	return 0;
+}
+
+static void __exit lz4_neon_mod_exit(void)
+{
+	crypto_unregister_alg(&alg_lz4_neon);
+	crypto_unregister_scomp(&scomp_lz4_neon);
+}
+
+module_init(lz4_neon_mod_init);
+module_exit(lz4_neon_mod_exit);
+
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("LZ4 Compression Algorithm, NEON accelerated decompression");
+MODULE_ALIAS_CRYPTO("lz4");
+MODULE_ALIAS_CRYPTO("lz4-neon");
@@ -0,0 +1,96 @@
+/*
+ * Inline CRC32 and CRC32C using the ARMv8 CRC32 instructions
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#ifndef __ASM_CRC32_H
+#define __ASM_CRC32_H
+
+#include <linux/compiler.h>
+#include <linux/types.h>
+
+#include <asm/hwcap.h>
+#include <asm/unaligned.h>
+
+/*
+ * For the checksums of metadata blocks and pages on hot paths, which cannot
+ * afford the indirect calls and the descriptor of a shash. No state, no
+ * allocation and no NEON, so they may be used in any context. Seed and
+ * result are the ones of crc32_le() and __crc32c_le(), which are used on
+ * cpus without the instructions.
+ */
+
+#define __crc32_armv8_op(insn, crc, val, w)				\
+	asm(".arch_extension crc\n"					\
+	    insn "\t%w0, %w0, %" w "1" : "+r" (crc) : "r" (val))
+
+static __always_inline u32 __crc32_armv8_le(u32 crc, const u8 *p, size_t len,
+					     bool castagnoli)
+{
+	for (; len >= 8; len -= 8, p += 8) {
+		u64 val = get_unaligned_le64(p);
+
+		if (castagnoli)
+			__crc32_armv8_op("crc32cx", crc, val, "x");
+		else
+			__crc32_armv8_op("crc32x", crc, val, "x");
+	}
+
+	if (len & 4) {
+		u32 val = get_unaligned_le32(p);
+
+		if (castagnoli)
+			__crc32_armv8_op("crc32cw", crc, val, "w");
+		else
+			__crc32_armv8_op("crc32w", crc, val, "w");
+		p += 4;
+	}
+
+	if (len & 2) {
+		u32 val = get_unaligned_le16(p);
+
+		if (castagnoli)
+			__crc32_armv8_op("crc32ch", crc, val, "w");
+		else
+			__crc32_armv8_op("crc32h", crc, val, "w");
+		p += 2;
+	}
+
+	if (len & 1) {
+		u32 val = *p;
+
+		if (castagnoli)
+			__crc32_armv8_op("crc32cb", crc, val, "w");
+		else
+			__crc32_armv8_op("crc32b", crc, val, "w");
+	}
+
+	return crc;
+}
+
+static inline bool crc32_armv8_available(void)
+{
+	return elf_hwcap & HWCAP_CRC32;
+}
+
+static inline u32 crc32_le_inline(u32 crc, const void *p, size_t len)
+{
+	if (likely(crc32_armv8_available()))
+		return __crc32_armv8_le(crc, p, len, false);
+
+	return crc32_le(crc, p, len);
+}
+
+static inline u32 crc32c_le_inline(u32 crc, const void *p, size_t len)
+{
+	if (likely(crc32_armv8_available()))
+		return __crc32_armv8_le(crc, p, len, true);
+
+	return __crc32c_le(crc, p, len);
+}
+
+#endif /* __ASM_CRC32_H */
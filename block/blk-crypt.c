@@ -19,6 +19,7 @@
 #include <linux/module.h>
 #include <linux/blkdev.h>
 #include <crypto/skcipher.h>
+#include <crypto/diskcipher.h>
 
 #define BLK_CRYPT_ALG_NAMELEN_MAX	(15)
 #define BLK_CRYPT_VERSION		"1.0.0"
@@ -139,20 +140,39 @@ bool blk_crypt_encrypted(const struct bio *bio)
 	return __bio_crypt(bio) ? true : false;
 }
 
+/**
+ * blk_crypt_mergeable() - check if @b may follow @a in a request
+ * @a: bio which ends where @b starts, i.e. the tail bio in a back merge
+ * @b: bio to be placed after @a
+ *
+ * Bios of the same crypt context are merged as long as their DUNs are
+ * contiguous, so that sequential I/O of an encrypted file is issued as
+ * large requests. Results are counted by the diskcipher debug log.
+ */
 bool blk_crypt_mergeable(const struct bio *a, const struct bio *b)
 {
 #ifdef CONFIG_BLK_DEV_CRYPT
-	if (__bio_crypt(a) != __bio_crypt(b))
+	if (!__bio_crypt(a) ^ !__bio_crypt(b)) {
+		crypto_diskcipher_debug(DISKC_MERGE_ERR_DISKC, 0);
 		return false;
+	}
+
+	if (!__bio_crypt(a))
+		return true;
+
+	if (__bio_crypt(a) != __bio_crypt(b)) {
+		crypto_diskcipher_debug(DISKC_MERGE_ERR_INODE, 0);
+		return false;
+	}
 
 #ifdef CONFIG_BLK_DEV_CRYPT_DUN
-	if (__bio_crypt(a)) {
-		if (!bio_dun(a) ^ !bio_dun(b))
-			return false;
-		if (bio_dun(a) && bio_end_dun(a) != bio_dun(b))
-			return false;
+	if ((!bio_dun(a) ^ !bio_dun(b)) ||
+	    (bio_dun(a) && bio_end_dun(a) != bio_dun(b))) {
+		crypto_diskcipher_debug(DISKC_MERGE_ERR_DUN, 0);
+		return false;
 	}
 #endif
+	crypto_diskcipher_debug(DISKC_MERGE, 0);
 #endif
 	return true;
 }
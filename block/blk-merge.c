@@ -708,7 +708,7 @@ static struct request *attempt_merge(struct request_queue *q,
 	    !blk_write_same_mergeable(req->bio, next->bio))
 		return NULL;
 
-	if (!blk_crypt_mergeable(req->bio, next->bio))
+	if (!blk_crypt_mergeable(req->biotail, next->bio))
 		return NULL;
 
 	/*
@@ -866,7 +866,7 @@ enum elv_merge blk_try_merge(struct request *rq, struct bio *bio)
 		return ELEVATOR_DISCARD_MERGE;
 	} else if (blk_rq_pos(rq) + blk_rq_sectors(rq) ==
 						bio->bi_iter.bi_sector) {
-		if (!blk_crypt_mergeable(rq->bio, bio))
+		if (!blk_crypt_mergeable(rq->biotail, bio))
 			return ELEVATOR_NO_MERGE;
 		return ELEVATOR_BACK_MERGE;
 	} else if (blk_rq_pos(rq) - bio_sectors(bio) ==
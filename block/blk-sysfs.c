@@ -477,6 +477,47 @@ static ssize_t queue_wb_lat_store(struct request_queue *q, const char *page,
 	return count;
 }
 
+static ssize_t queue_wb_bg_budget_show(struct request_queue *q, char *page)
+{
+	if (!q->rq_wb)
+		return -EINVAL;
+
+	return sprintf(page, "%u\n", q->rq_wb->bg_budget);
+}
+
+static ssize_t queue_wb_bg_budget_store(struct request_queue *q,
+					const char *page, size_t count)
+{
+	unsigned long val;
+	ssize_t ret;
+
+	if (!q->rq_wb)
+		return -EINVAL;
+
+	ret = queue_var_store(&val, page, count);
+	if (ret < 0)
+		return ret;
+	if (val > 100)
+		return -EINVAL;
+
+	q->rq_wb->bg_budget = val;
+	return ret;
+}
+
+static ssize_t queue_wb_group_stat_show(struct request_queue *q, char *page)
+{
+	struct rq_wb *rwb = q->rq_wb;
+
+	if (!rwb)
+		return -EINVAL;
+
+	return sprintf(page, "fg %lld %lld\nbg %lld %lld\n",
+		(long long)atomic64_read(&rwb->throttled_cnt[WBT_GROUP_FG]),
+		(long long)atomic64_read(&rwb->throttled_bytes[WBT_GROUP_FG]),
+		(long long)atomic64_read(&rwb->throttled_cnt[WBT_GROUP_BG]),
+		(long long)atomic64_read(&rwb->throttled_bytes[WBT_GROUP_BG]));
+}
+
 static ssize_t queue_wc_show(struct request_queue *q, char *page)
 {
 	if (test_bit(QUEUE_FLAG_WC, &q->queue_flags))
@@ -688,6 +729,17 @@ static struct queue_sysfs_entry queue_wb_lat_entry = {
 	.store = queue_wb_lat_store,
 };
 
+static struct queue_sysfs_entry queue_wb_bg_budget_entry = {
+	.attr = {.name = "wbt_bg_budget", .mode = S_IRUGO | S_IWUSR },
+	.show = queue_wb_bg_budget_show,
+	.store = queue_wb_bg_budget_store,
+};
+
+static struct queue_sysfs_entry queue_wb_group_stat_entry = {
+	.attr = {.name = "wbt_group_stat", .mode = S_IRUGO },
+	.show = queue_wb_group_stat_show,
+};
+
 #ifdef CONFIG_BLK_DEV_THROTTLING_LOW
 static struct queue_sysfs_entry throtl_sample_time_entry = {
 	.attr = {.name = "throttle_sample_time", .mode = S_IRUGO | S_IWUSR },
@@ -728,6 +780,8 @@ static struct attribute *default_attrs[] = {
 	&queue_wc_entry.attr,
 	&queue_dax_entry.attr,
 	&queue_wb_lat_entry.attr,
+	&queue_wb_bg_budget_entry.attr,
+	&queue_wb_group_stat_entry.attr,
 	&queue_poll_delay_entry.attr,
 #ifdef CONFIG_BLK_DEV_THROTTLING_LOW
 	&throtl_sample_time_entry.attr,
@@ -23,6 +23,7 @@
 #include <linux/slab.h>
 #include <linux/backing-dev.h>
 #include <linux/swap.h>
+#include <linux/ems_service.h>
 
 #include "blk-wbt.h"
 
@@ -51,6 +52,11 @@ enum {
 	 * information to scale up or down, scale up.
 	 */
 	RWB_UNKNOWN_BUMP	= 5,
+
+	/*
+	 * Background groups get half of the depth by default
+	 */
+	RWB_DEF_BG_BUDGET	= 50,
 };
 
 static inline bool rwb_enabled(struct rq_wb *rwb)
@@ -101,9 +107,37 @@ static bool wb_recent_wait(struct rq_wb *rwb)
 	return time_before(jiffies, wb->dirty_sleep + HZ);
 }
 
-static inline struct rq_wait *get_rq_wait(struct rq_wb *rwb, bool is_kswapd)
+static inline struct rq_wait *get_rq_wait(struct rq_wb *rwb,
+					  enum wbt_flags wb_acct)
 {
-	return &rwb->rq_wait[is_kswapd];
+	if (wb_acct & WBT_KSWAPD)
+		return &rwb->rq_wait[WBT_RWQ_KSWAPD];
+	else if (wb_acct & WBT_BG_GROUP)
+		return &rwb->rq_wait[WBT_RWQ_BG];
+
+	return &rwb->rq_wait[WBT_RWQ_FG];
+}
+
+static inline bool is_bg_rq_wait(struct rq_wb *rwb, struct rq_wait *rqw)
+{
+	return rqw == &rwb->rq_wait[WBT_RWQ_BG];
+}
+
+/*
+ * Writes are accounted to the schedtune group of the issuing task. Writeback
+ * flushed by the kernel threads counts as background, while fsync and
+ * O_SYNC writes are issued in the context of the task asking for them.
+ */
+static enum wbt_flags wbt_group(struct rq_wb *rwb)
+{
+	if (current_is_kswapd())
+		return WBT_KSWAPD;
+
+	if (IS_ENABLED(CONFIG_SCHED_EMS) && READ_ONCE(rwb->bg_budget) &&
+	    !ems_task_is_foreground(current))
+		return WBT_BG_GROUP;
+
+	return 0;
 }
 
 static void rwb_wake_all(struct rq_wb *rwb)
@@ -126,7 +160,7 @@ void __wbt_done(struct rq_wb *rwb, enum wbt_flags wb_acct)
 	if (!(wb_acct & WBT_TRACKED))
 		return;
 
-	rqw = get_rq_wait(rwb, wb_acct & WBT_KSWAPD);
+	rqw = get_rq_wait(rwb, wb_acct);
 	inflight = atomic_dec_return(&rqw->inflight);
 
 	/*
@@ -138,6 +172,17 @@ void __wbt_done(struct rq_wb *rwb, enum wbt_flags wb_acct)
 		return;
 	}
 
+	/*
+	 * Background groups are limited by the foreground writes in flight
+	 * as well, so a foreground completion may let one of them go.
+	 */
+	if (rqw == &rwb->rq_wait[WBT_RWQ_FG] && !waitqueue_active(&rqw->wait)) {
+		struct rq_wait *bg = &rwb->rq_wait[WBT_RWQ_BG];
+
+		if (waitqueue_active(&bg->wait))
+			wake_up(&bg->wait);
+	}
+
 	/*
 	 * If the device does write back caching, drop further down
 	 * before we wake people up.
@@ -505,6 +550,8 @@ static inline unsigned int get_limit(struct rq_wb *rwb, unsigned long rw)
 static inline bool may_queue(struct rq_wb *rwb, struct rq_wait *rqw,
 			     wait_queue_entry_t *wait, unsigned long rw)
 {
+	unsigned int limit, fg_inflight;
+
 	/*
 	 * inc it here even if disabled, since we'll dec it at completion.
 	 * this only happens if the task was sleeping in __wbt_wait(),
@@ -523,23 +570,46 @@ static inline bool may_queue(struct rq_wb *rwb, struct rq_wait *rqw,
 	    rqw->wait.head.next != &wait->entry)
 		return false;
 
-	return atomic_inc_below(&rqw->inflight, get_limit(rwb, rw));
+	limit = get_limit(rwb, rw);
+	if (!is_bg_rq_wait(rwb, rqw))
+		return atomic_inc_below(&rqw->inflight, limit);
+
+	/*
+	 * Background groups yield to waiting foreground writers, and share
+	 * their budget with the foreground writes in flight. One write is
+	 * always allowed, so that they can't be starved completely.
+	 */
+	if (waitqueue_active(&rwb->rq_wait[WBT_RWQ_FG].wait))
+		return false;
+
+	limit = limit * READ_ONCE(rwb->bg_budget) / 100;
+	fg_inflight = atomic_read(&rwb->rq_wait[WBT_RWQ_FG].inflight);
+	limit = limit > fg_inflight ? limit - fg_inflight : 0;
+
+	return atomic_inc_below(&rqw->inflight, max(limit, 1U));
 }
 
 /*
  * Block if we will exceed our limit, or if we are currently waiting for
  * the timer to kick off queuing again.
  */
-static void __wbt_wait(struct rq_wb *rwb, unsigned long rw, spinlock_t *lock)
+static void __wbt_wait(struct rq_wb *rwb, enum wbt_flags wb_acct,
+		       struct bio *bio, spinlock_t *lock)
 	__releases(lock)
 	__acquires(lock)
 {
-	struct rq_wait *rqw = get_rq_wait(rwb, current_is_kswapd());
+	struct rq_wait *rqw = get_rq_wait(rwb, wb_acct);
+	unsigned long rw = bio->bi_opf;
 	DEFINE_WAIT(wait);
+	int group;
 
 	if (may_queue(rwb, rqw, &wait, rw))
 		return;
 
+	group = (wb_acct & WBT_BG_GROUP) ? WBT_GROUP_BG : WBT_GROUP_FG;
+	atomic64_add(bio->bi_iter.bi_size, &rwb->throttled_bytes[group]);
+	atomic64_inc(&rwb->throttled_cnt[group]);
+
 	do {
 		prepare_to_wait_exclusive(&rqw->wait, &wait,
 						TASK_UNINTERRUPTIBLE);
@@ -599,14 +669,12 @@ enum wbt_flags wbt_wait(struct rq_wb *rwb, struct bio *bio, spinlock_t *lock)
 		return ret;
 	}
 
-	__wbt_wait(rwb, bio->bi_opf, lock);
+	ret |= wbt_group(rwb);
+	__wbt_wait(rwb, ret, bio, lock);
 
 	if (!blk_stat_is_active(rwb->cb))
 		rwb_arm_timer(rwb);
 
-	if (current_is_kswapd())
-		ret |= WBT_KSWAPD;
-
 	return ret | WBT_TRACKED;
 }
 
@@ -731,6 +799,12 @@ int wbt_init(struct request_queue *q)
 		init_waitqueue_head(&rwb->rq_wait[i].wait);
 	}
 
+	for (i = 0; i < WBT_NUM_GROUPS; i++) {
+		atomic64_set(&rwb->throttled_bytes[i], 0);
+		atomic64_set(&rwb->throttled_cnt[i], 0);
+	}
+	rwb->bg_budget = RWB_DEF_BG_BUDGET;
+
 	rwb->wc = 1;
 	rwb->queue_depth = RWB_DEF_DEPTH;
 	rwb->last_comp = rwb->last_issue = jiffies;
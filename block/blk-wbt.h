@@ -14,12 +14,27 @@ enum wbt_flags {
 	WBT_TRACKED		= 1,	/* write, tracked for throttling */
 	WBT_READ		= 2,	/* read */
 	WBT_KSWAPD		= 4,	/* write, from kswapd */
+	WBT_BG_GROUP		= 8,	/* write, from a background group */
 
-	WBT_NR_BITS		= 3,	/* number of bits */
+	WBT_NR_BITS		= 4,	/* number of bits */
 };
 
+/*
+ * Writes are throttled on separate wait queues, so that writers of the
+ * foreground groups never queue up behind background ones.
+ */
+enum {
+	WBT_RWQ_FG		= 0,
+	WBT_RWQ_KSWAPD,
+	WBT_RWQ_BG,
+	WBT_NUM_RWQ,
+};
+
+/* Groups writes are accounted to, see wbt_group() */
 enum {
-	WBT_NUM_RWQ		= 2,
+	WBT_GROUP_FG		= 0,
+	WBT_GROUP_BG,
+	WBT_NUM_GROUPS,
 };
 
 /*
@@ -95,6 +110,16 @@ struct rq_wb {
 	unsigned long min_lat_nsec;
 	struct request_queue *queue;
 	struct rq_wait rq_wait[WBT_NUM_RWQ];
+
+	/*
+	 * Background groups may only have this percentage of the current
+	 * depth in flight, counting foreground writes as well.
+	 */
+	unsigned int bg_budget;
+
+	/* Writes that had to wait for a budget, per group */
+	atomic64_t throttled_bytes[WBT_NUM_GROUPS];
+	atomic64_t throttled_cnt[WBT_NUM_GROUPS];
 };
 
 static inline unsigned int wbt_inflight(struct rq_wb *rwb)
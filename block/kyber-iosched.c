@@ -23,6 +23,7 @@
 #include <linux/elevator.h>
 #include <linux/module.h>
 #include <linux/sbitmap.h>
+#include <linux/ems_service.h>
 
 #include "blk.h"
 #include "blk-mq.h"
@@ -33,6 +34,7 @@
 
 /* Scheduling domains. */
 enum {
+	KYBER_FG_READ, /* Reads issued by top-app and foreground tasks */
 	KYBER_READ,
 	KYBER_SYNC_WRITE,
 	KYBER_OTHER, /* Async writes, discard, etc. */
@@ -58,6 +60,7 @@ enum {
  * So, we cap these to a reasonable value.
  */
 static const unsigned int kyber_depth[] = {
+	[KYBER_FG_READ] = 256,
 	[KYBER_READ] = 256,
 	[KYBER_SYNC_WRITE] = 128,
 	[KYBER_OTHER] = 64,
@@ -67,11 +70,18 @@ static const unsigned int kyber_depth[] = {
  * Scheduling domain batch sizes. We favor reads.
  */
 static const unsigned int kyber_batch_size[] = {
+	[KYBER_FG_READ] = 32,
 	[KYBER_READ] = 16,
 	[KYBER_SYNC_WRITE] = 8,
 	[KYBER_OTHER] = 8,
 };
 
+struct kyber_lat_stat {
+	atomic64_t nr_samples;
+	atomic64_t total_nsec;
+	atomic64_t nr_missed;	/* completed later than the target */
+};
+
 struct kyber_queue_data {
 	struct request_queue *q;
 
@@ -90,8 +100,17 @@ struct kyber_queue_data {
 	 */
 	unsigned int async_depth;
 
-	/* Target latencies in nanoseconds. */
-	u64 read_lat_nsec, write_lat_nsec;
+	/*
+	 * Target latencies in nanoseconds. Reads are classified as foreground
+	 * only while fg_read_lat_nsec is non-zero.
+	 */
+	u64 fg_read_lat_nsec, read_lat_nsec, write_lat_nsec;
+
+	/* Other domains were throttled in favor of foreground reads. */
+	bool fg_throttled;
+
+	/* Completion latencies since the scheduler was set up. */
+	struct kyber_lat_stat lat_stat[KYBER_NUM_DOMAINS];
 };
 
 struct kyber_hctx_data {
@@ -103,12 +122,18 @@ struct kyber_hctx_data {
 	atomic_t wait_index[KYBER_NUM_DOMAINS];
 };
 
+/* Requests are classified when allocated, in the context of the issuer. */
+static bool rq_is_fg(const struct request *rq)
+{
+	return (rq->rq_flags & RQF_ELVPRIV) && rq->elv.priv[1];
+}
+
 static int rq_sched_domain(const struct request *rq)
 {
 	unsigned int op = rq->cmd_flags;
 
 	if ((op & REQ_OP_MASK) == REQ_OP_READ)
-		return KYBER_READ;
+		return rq_is_fg(rq) ? KYBER_FG_READ : KYBER_READ;
 	else if ((op & REQ_OP_MASK) == REQ_OP_WRITE && op_is_sync(op))
 		return KYBER_SYNC_WRITE;
 	else
@@ -244,6 +269,43 @@ static void kyber_adjust_other_depth(struct kyber_queue_data *kqd,
 		sbitmap_queue_resize(&kqd->domain_tokens[KYBER_OTHER], depth);
 }
 
+/*
+ * Foreground reads are never throttled. While they miss their target, every
+ * other domain is throttled instead, and restored once they are fine again.
+ * Returns true if the other domains were throttled.
+ */
+static bool kyber_adjust_fg_depth(struct kyber_queue_data *kqd, int fg_status)
+{
+	unsigned int orig_depth, depth;
+	bool throttled = false;
+	int i;
+
+	if (!IS_BAD(fg_status) && !kqd->fg_throttled)
+		return false;
+
+	for (i = 0; i < KYBER_NUM_DOMAINS; i++) {
+		if (i == KYBER_FG_READ)
+			continue;
+
+		orig_depth = depth = kqd->domain_tokens[i].sb.depth;
+		if (fg_status == AWFUL)
+			depth /= 2;
+		else if (fg_status == BAD)
+			depth -= max(depth / 4, 1U);
+		else
+			depth += max(depth / 4, 1U);
+
+		depth = clamp(depth, 1U, kyber_depth[i]);
+		if (depth != orig_depth)
+			sbitmap_queue_resize(&kqd->domain_tokens[i], depth);
+		if (depth < kyber_depth[i])
+			throttled = true;
+	}
+
+	kqd->fg_throttled = throttled;
+	return IS_BAD(fg_status);
+}
+
 /*
  * Apply heuristics for limiting queue depths based on gathered latency
  * statistics.
@@ -251,22 +313,27 @@ static void kyber_adjust_other_depth(struct kyber_queue_data *kqd,
 static void kyber_stat_timer_fn(struct blk_stat_callback *cb)
 {
 	struct kyber_queue_data *kqd = cb->data;
-	int read_status, write_status;
+	int fg_status, read_status, write_status;
 
+	fg_status = kyber_lat_status(cb, KYBER_FG_READ, kqd->fg_read_lat_nsec);
 	read_status = kyber_lat_status(cb, KYBER_READ, kqd->read_lat_nsec);
 	write_status = kyber_lat_status(cb, KYBER_SYNC_WRITE, kqd->write_lat_nsec);
 
-	kyber_adjust_rw_depth(kqd, KYBER_READ, read_status, write_status);
-	kyber_adjust_rw_depth(kqd, KYBER_SYNC_WRITE, write_status, read_status);
-	kyber_adjust_other_depth(kqd, read_status, write_status,
-				 cb->stat[KYBER_OTHER].nr_samples != 0);
+	if (!kyber_adjust_fg_depth(kqd, fg_status)) {
+		kyber_adjust_rw_depth(kqd, KYBER_READ, read_status, write_status);
+		kyber_adjust_rw_depth(kqd, KYBER_SYNC_WRITE, write_status,
+				      read_status);
+		kyber_adjust_other_depth(kqd, read_status, write_status,
+					 cb->stat[KYBER_OTHER].nr_samples != 0);
+	}
 
 	/*
 	 * Continue monitoring latencies if we aren't hitting the targets or
 	 * we're still throttling other requests.
 	 */
 	if (!blk_stat_is_active(kqd->cb) &&
-	    ((IS_BAD(read_status) || IS_BAD(write_status) ||
+	    ((IS_BAD(fg_status) || IS_BAD(read_status) ||
+	      IS_BAD(write_status) || kqd->fg_throttled ||
 	      kqd->domain_tokens[KYBER_OTHER].sb.depth < kyber_depth[KYBER_OTHER])))
 		blk_stat_activate_msecs(kqd->cb, 100);
 }
@@ -322,8 +389,16 @@ static struct kyber_queue_data *kyber_queue_data_alloc(struct request_queue *q)
 	shift = kyber_sched_tags_shift(kqd);
 	kqd->async_depth = (1U << shift) * KYBER_ASYNC_PERCENT / 100U;
 
+	kqd->fg_read_lat_nsec = 1000000ULL;
 	kqd->read_lat_nsec = 2000000ULL;
 	kqd->write_lat_nsec = 10000000ULL;
+	kqd->fg_throttled = false;
+
+	for (i = 0; i < KYBER_NUM_DOMAINS; i++) {
+		atomic64_set(&kqd->lat_stat[i].nr_samples, 0);
+		atomic64_set(&kqd->lat_stat[i].total_nsec, 0);
+		atomic64_set(&kqd->lat_stat[i].nr_missed, 0);
+	}
 
 	return kqd;
 
@@ -441,7 +516,11 @@ static void kyber_limit_depth(unsigned int op, struct blk_mq_alloc_data *data)
 
 static void kyber_prepare_request(struct request *rq, struct bio *bio)
 {
+	struct kyber_queue_data *kqd = rq->q->elevator->elevator_data;
+
 	rq_set_domain_token(rq, -1);
+	rq->elv.priv[1] = (void *)(long)(READ_ONCE(kqd->fg_read_lat_nsec) &&
+					 ems_task_is_foreground(current));
 }
 
 static void kyber_finish_request(struct request *rq)
@@ -464,6 +543,9 @@ static void kyber_completed_request(struct request *rq)
 	 */
 	sched_domain = rq_sched_domain(rq);
 	switch (sched_domain) {
+	case KYBER_FG_READ:
+		target = kqd->fg_read_lat_nsec;
+		break;
 	case KYBER_READ:
 		target = kqd->read_lat_nsec;
 		break;
@@ -474,16 +556,21 @@ static void kyber_completed_request(struct request *rq)
 		return;
 	}
 
-	/* If we are already monitoring latencies, don't check again. */
-	if (blk_stat_is_active(kqd->cb))
-		return;
-
 	now = __blk_stat_time(ktime_to_ns(ktime_get()));
 	if (now < blk_stat_time(&rq->issue_stat))
 		return;
 
 	latency = now - blk_stat_time(&rq->issue_stat);
 
+	atomic64_inc(&kqd->lat_stat[sched_domain].nr_samples);
+	atomic64_add(latency, &kqd->lat_stat[sched_domain].total_nsec);
+	if (latency > target)
+		atomic64_inc(&kqd->lat_stat[sched_domain].nr_missed);
+
+	/* If we are already monitoring latencies, don't check again. */
+	if (blk_stat_is_active(kqd->cb))
+		return;
+
 	if (latency > target)
 		blk_stat_activate_msecs(kqd->cb, 10);
 }
@@ -668,12 +755,14 @@ static ssize_t kyber_##op##_lat_store(struct elevator_queue *e,		\
 									\
 	return count;							\
 }
+KYBER_LAT_SHOW_STORE(fg_read);
 KYBER_LAT_SHOW_STORE(read);
 KYBER_LAT_SHOW_STORE(write);
 #undef KYBER_LAT_SHOW_STORE
 
 #define KYBER_LAT_ATTR(op) __ATTR(op##_lat_nsec, 0644, kyber_##op##_lat_show, kyber_##op##_lat_store)
 static struct elv_fs_entry kyber_sched_attrs[] = {
+	KYBER_LAT_ATTR(fg_read),
 	KYBER_LAT_ATTR(read),
 	KYBER_LAT_ATTR(write),
 	__ATTR_NULL
@@ -734,7 +823,21 @@ static int kyber_##name##_waiting_show(void *data, struct seq_file *m)	\
 									\
 	seq_printf(m, "%d\n", !list_empty_careful(&wait->entry));	\
 	return 0;							\
+}									\
+									\
+static int kyber_##name##_latency_show(void *data, struct seq_file *m)	\
+{									\
+	struct request_queue *q = data;					\
+	struct kyber_queue_data *kqd = q->elevator->elevator_data;	\
+	struct kyber_lat_stat *stat = &kqd->lat_stat[domain];		\
+	u64 nr = atomic64_read(&stat->nr_samples);			\
+									\
+	seq_printf(m, "samples=%llu mean=%llu missed=%llu\n", nr,	\
+		   nr ? div64_u64(atomic64_read(&stat->total_nsec), nr) : 0, \
+		   (u64)atomic64_read(&stat->nr_missed));		\
+	return 0;							\
 }
+KYBER_DEBUGFS_DOMAIN_ATTRS(KYBER_FG_READ, fg_read)
 KYBER_DEBUGFS_DOMAIN_ATTRS(KYBER_READ, read)
 KYBER_DEBUGFS_DOMAIN_ATTRS(KYBER_SYNC_WRITE, sync_write)
 KYBER_DEBUGFS_DOMAIN_ATTRS(KYBER_OTHER, other)
@@ -755,6 +858,9 @@ static int kyber_cur_domain_show(void *data, struct seq_file *m)
 	struct kyber_hctx_data *khd = hctx->sched_data;
 
 	switch (khd->cur_domain) {
+	case KYBER_FG_READ:
+		seq_puts(m, "FG_READ\n");
+		break;
 	case KYBER_READ:
 		seq_puts(m, "READ\n");
 		break;
@@ -780,9 +886,11 @@ static int kyber_batching_show(void *data, struct seq_file *m)
 	return 0;
 }
 
-#define KYBER_QUEUE_DOMAIN_ATTRS(name)	\
-	{#name "_tokens", 0400, kyber_##name##_tokens_show}
+#define KYBER_QUEUE_DOMAIN_ATTRS(name)					\
+	{#name "_tokens", 0400, kyber_##name##_tokens_show},		\
+	{#name "_latency", 0400, kyber_##name##_latency_show}
 static const struct blk_mq_debugfs_attr kyber_queue_debugfs_attrs[] = {
+	KYBER_QUEUE_DOMAIN_ATTRS(fg_read),
 	KYBER_QUEUE_DOMAIN_ATTRS(read),
 	KYBER_QUEUE_DOMAIN_ATTRS(sync_write),
 	KYBER_QUEUE_DOMAIN_ATTRS(other),
@@ -795,6 +903,7 @@ static const struct blk_mq_debugfs_attr kyber_queue_debugfs_attrs[] = {
 	{#name "_rqs", 0400, .seq_ops = &kyber_##name##_rqs_seq_ops},	\
 	{#name "_waiting", 0400, kyber_##name##_waiting_show}
 static const struct blk_mq_debugfs_attr kyber_hctx_debugfs_attrs[] = {
+	KYBER_HCTX_DOMAIN_ATTRS(fg_read),
 	KYBER_HCTX_DOMAIN_ATTRS(read),
 	KYBER_HCTX_DOMAIN_ATTRS(sync_write),
 	KYBER_HCTX_DOMAIN_ATTRS(other),
@@ -27,6 +27,7 @@
 #include <crypto/aead.h>
 #include <crypto/hash.h>
 #include <crypto/skcipher.h>
+#include <linux/crc32.h>
 #include <linux/err.h>
 #include <linux/fips.h>
 #include <linux/init.h>
@@ -38,6 +39,7 @@
 #include <linux/jiffies.h>
 #include <linux/timex.h>
 #include <linux/interrupt.h>
+#include <linux/xxhash.h>
 #include "tcrypt.h"
 
 /*
@@ -770,6 +772,105 @@ static void test_hash_speed(const char *algo, unsigned int secs,
 	return test_ahash_speed_common(algo, secs, speed, CRYPTO_ALG_ASYNC);
 }
 
+/*
+ * Checksums called directly as library functions, the way f2fs and zram use
+ * them, to compare with the cost of going through a shash.
+ */
+struct lib_hash {
+	const char *name;
+	u32 (*fn)(u32 seed, const void *p, size_t len);
+};
+
+static u32 lib_crc32_le(u32 seed, const void *p, size_t len)
+{
+	return crc32_le(seed, p, len);
+}
+
+static u32 lib_crc32c_le(u32 seed, const void *p, size_t len)
+{
+	return __crc32c_le(seed, p, len);
+}
+
+#if IS_ENABLED(CONFIG_XXHASH)
+static u32 lib_xxh32(u32 seed, const void *p, size_t len)
+{
+	return xxh32(p, len, seed);
+}
+
+static u32 lib_xxh64(u32 seed, const void *p, size_t len)
+{
+	return xxh64(p, len, seed);
+}
+#endif
+
+static const struct lib_hash lib_hashes[] = {
+	{ "crc32_le",		lib_crc32_le },
+	{ "crc32_le_inline",	crc32_le_inline },
+	{ "__crc32c_le",	lib_crc32c_le },
+	{ "crc32c_le_inline",	crc32c_le_inline },
+#if IS_ENABLED(CONFIG_XXHASH)
+	{ "xxh32",		lib_xxh32 },
+	{ "xxh64",		lib_xxh64 },
+#endif
+};
+
+static void test_lib_hash_speed(unsigned int secs, struct hash_speed *speed)
+{
+	const void *p = tvmem[0];
+	volatile u32 crc;
+	int i, j, k;
+
+	for (j = 0; j < ARRAY_SIZE(lib_hashes); j++) {
+		const struct lib_hash *h = &lib_hashes[j];
+
+		printk(KERN_INFO "\ntesting speed of %s\n", h->name);
+
+		for (i = 0; speed[i].blen != 0; i++) {
+			unsigned int blen = speed[i].blen;
+
+			/* one call per block, blocks fit in a page */
+			if (speed[i].plen != blen || blen > PAGE_SIZE)
+				continue;
+
+			pr_info("test%3u (%5u byte blocks): ", i, blen);
+
+			if (secs) {
+				unsigned long start, end;
+				int bcount;
+
+				for (start = jiffies, end = start + secs * HZ,
+				     bcount = 0; time_before(jiffies, end);
+				     bcount++)
+					crc = h->fn(~0, p, blen);
+
+				pr_cont("%6u opers/sec, %9lu bytes/sec\n",
+					bcount / secs,
+					((long)bcount * blen) / secs);
+			} else {
+				unsigned long cycles = 0;
+
+				/* Warm-up run. */
+				for (k = 0; k < 4; k++)
+					crc = h->fn(~0, p, blen);
+
+				/* The real thing. */
+				for (k = 0; k < 8; k++) {
+					cycles_t start, end;
+
+					start = get_cycles();
+					crc = h->fn(~0, p, blen);
+					end = get_cycles();
+
+					cycles += end - start;
+				}
+
+				pr_cont("%6lu cycles/operation, %4lu cycles/byte\n",
+					cycles / 8, cycles / (8 * blen));
+			}
+		}
+	}
+}
+
 static inline int do_one_acipher_op(struct skcipher_request *req, int ret)
 {
 	if (ret == -EINPROGRESS || ret == -EBUSY) {
@@ -1719,6 +1820,10 @@ static int do_test(const char *alg, u32 type, u32 mask, int m)
 		test_hash_speed("sha3-512", sec, generic_hash_speed_template);
 		if (mode > 300 && mode < 400) break;
 
+	case 326:
+		test_lib_hash_speed(sec, generic_hash_speed_template);
+		if (mode > 300 && mode < 400) break;
+
 	case 399:
 		break;
 
@@ -17,8 +17,12 @@
 #include <linux/interrupt.h>
 #include <linux/mm.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
 #include <linux/net.h>
+#include <linux/percpu.h>
+#include <linux/spinlock.h>
 #include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 #include <linux/zstd.h>
 #include <crypto/internal/scompress.h>
 
@@ -236,6 +240,411 @@ static struct scomp_alg scomp = {
 	}
 };
 
+/*
+ * Profiles for page sized data of zram
+ *
+ * Each profile is registered as its own algorithm, so that zram selects it
+ * by comp_algorithm. The frame header carries neither content size nor
+ * checksum, zram knows the page size.
+ *
+ * Transforms of a profile do not own workspaces. Compression uses the
+ * workspace of the profile for the current cpu and decompression the
+ * workspace shared by all profiles for the current cpu, both with
+ * preemption disabled as zram streams already are. The workspaces are
+ * allocated with the first transform and freed with the last one, so the
+ * per-cpu transforms of every zram device share one set per cpu.
+ *
+ * zstd_dict compresses with a raw content dictionary of swap pages. Until
+ * ZSTD_DICT_PAGES pages are sampled, one of every ZSTD_DICT_STRIDE pages,
+ * pages are compressed without it. The dictionary never changes once built,
+ * pages compressed with it are marked by the first byte of the output.
+ */
+#define ZSTD_DICT_PAGES		8
+#define ZSTD_DICT_STRIDE	64
+#define ZSTD_DICT_SIZE		(ZSTD_DICT_PAGES * PAGE_SIZE)
+
+enum {
+	ZSTD_DICT_MARK_NONE,
+	ZSTD_DICT_MARK_USED,
+};
+
+struct zstd_pcpu_cctx {
+	ZSTD_CCtx *cctx;
+	void *wksp;
+};
+
+struct zstd_pcpu_dctx {
+	ZSTD_DCtx *dctx;
+	void *wksp;
+};
+
+struct zstd_profile {
+	int level;
+	/* 0 keeps the value of the level */
+	unsigned int hash_log;
+	unsigned int search_length;
+	bool dict;
+
+	ZSTD_parameters params;
+	struct zstd_pcpu_cctx __percpu *pcpu;
+	int users;
+	struct crypto_alg alg;
+};
+
+static struct {
+	spinlock_t lock;
+	struct work_struct work;
+	void *buf;
+	unsigned int nr_pages;
+	unsigned long seen;
+	bool ready;
+
+	ZSTD_CDict *cdict;
+	ZSTD_DDict *ddict;
+	void *cwksp;
+	void *dwksp;
+} zstd_dict;
+
+static DEFINE_MUTEX(zstd_profile_lock);
+static struct zstd_pcpu_dctx __percpu *zstd_pcpu_dctx;
+static int zstd_dctx_users;
+
+static struct zstd_profile *zstd_tfm_profile(struct crypto_tfm *tfm)
+{
+	return container_of(tfm->__crt_alg, struct zstd_profile, alg);
+}
+
+static void zstd_profile_free_cctx(struct zstd_profile *profile)
+{
+	int cpu;
+
+	if (!profile->pcpu)
+		return;
+
+	for_each_possible_cpu(cpu)
+		vfree(per_cpu_ptr(profile->pcpu, cpu)->wksp);
+	free_percpu(profile->pcpu);
+	profile->pcpu = NULL;
+}
+
+static int zstd_profile_alloc_cctx(struct zstd_profile *profile)
+{
+	const size_t wksp_size =
+		ZSTD_CCtxWorkspaceBound(profile->params.cParams);
+	struct zstd_pcpu_cctx *c;
+	int cpu;
+
+	profile->pcpu = alloc_percpu(struct zstd_pcpu_cctx);
+	if (!profile->pcpu)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu) {
+		c = per_cpu_ptr(profile->pcpu, cpu);
+		c->wksp = vzalloc(wksp_size);
+		if (!c->wksp)
+			goto err;
+		c->cctx = ZSTD_initCCtx(c->wksp, wksp_size);
+		if (!c->cctx)
+			goto err;
+	}
+
+	return 0;
+err:
+	zstd_profile_free_cctx(profile);
+	return -ENOMEM;
+}
+
+static void zstd_free_pcpu_dctx(void)
+{
+	int cpu;
+
+	if (!zstd_pcpu_dctx)
+		return;
+
+	for_each_possible_cpu(cpu)
+		vfree(per_cpu_ptr(zstd_pcpu_dctx, cpu)->wksp);
+	free_percpu(zstd_pcpu_dctx);
+	zstd_pcpu_dctx = NULL;
+}
+
+static int zstd_alloc_pcpu_dctx(void)
+{
+	const size_t wksp_size = ZSTD_DCtxWorkspaceBound();
+	struct zstd_pcpu_dctx *d;
+	int cpu;
+
+	zstd_pcpu_dctx = alloc_percpu(struct zstd_pcpu_dctx);
+	if (!zstd_pcpu_dctx)
+		return -ENOMEM;
+
+	for_each_possible_cpu(cpu) {
+		d = per_cpu_ptr(zstd_pcpu_dctx, cpu);
+		d->wksp = vzalloc(wksp_size);
+		if (!d->wksp)
+			goto err;
+		d->dctx = ZSTD_initDCtx(d->wksp, wksp_size);
+		if (!d->dctx)
+			goto err;
+	}
+
+	return 0;
+err:
+	zstd_free_pcpu_dctx();
+	return -ENOMEM;
+}
+
+static int zstd_profile_init(struct crypto_tfm *tfm)
+{
+	struct zstd_profile *profile = zstd_tfm_profile(tfm);
+	int ret = 0;
+
+	mutex_lock(&zstd_profile_lock);
+
+	if (!zstd_dctx_users) {
+		ret = zstd_alloc_pcpu_dctx();
+		if (ret)
+			goto out;
+	}
+
+	if (!profile->users) {
+		ret = zstd_profile_alloc_cctx(profile);
+		if (ret) {
+			if (!zstd_dctx_users)
+				zstd_free_pcpu_dctx();
+			goto out;
+		}
+	}
+
+	profile->users++;
+	zstd_dctx_users++;
+out:
+	mutex_unlock(&zstd_profile_lock);
+	return ret;
+}
+
+static void zstd_profile_exit(struct crypto_tfm *tfm)
+{
+	struct zstd_profile *profile = zstd_tfm_profile(tfm);
+
+	mutex_lock(&zstd_profile_lock);
+
+	if (!--profile->users)
+		zstd_profile_free_cctx(profile);
+	if (!--zstd_dctx_users)
+		zstd_free_pcpu_dctx();
+
+	mutex_unlock(&zstd_profile_lock);
+}
+
+static int zstd_profile_compress(struct crypto_tfm *tfm, const u8 *src,
+				 unsigned int slen, u8 *dst, unsigned int *dlen);
+static int zstd_profile_decompress(struct crypto_tfm *tfm, const u8 *src,
+				   unsigned int slen, u8 *dst, unsigned int *dlen);
+
+#define ZSTD_PROFILE(_name, _level, _hash_log, _search_length, _dict)	\
+	{								\
+		.level		= _level,				\
+		.hash_log	= _hash_log,				\
+		.search_length	= _search_length,			\
+		.dict		= _dict,				\
+		.alg = {						\
+			.cra_name	= _name,			\
+			.cra_flags	= CRYPTO_ALG_TYPE_COMPRESS,	\
+			.cra_module	= THIS_MODULE,			\
+			.cra_init	= zstd_profile_init,		\
+			.cra_exit	= zstd_profile_exit,		\
+			.cra_u		= { .compress = {		\
+			.coa_compress	= zstd_profile_compress,	\
+			.coa_decompress	= zstd_profile_decompress } }	\
+		},							\
+	}
+
+static struct zstd_profile zstd_profiles[] = {
+	/* fastest, a 2K entries hash table fits the L1 cache */
+	ZSTD_PROFILE("zstd_fast", 1, 11, 6, false),
+	/* double fast strategy, better ratio for writeback */
+	ZSTD_PROFILE("zstd_ratio", 3, 0, 0, false),
+	ZSTD_PROFILE("zstd_dict", 1, 0, 0, true),
+};
+
+static struct zstd_profile *zstd_dict_profile(void)
+{
+	return &zstd_profiles[ARRAY_SIZE(zstd_profiles) - 1];
+}
+
+static void zstd_dict_build(struct work_struct *work)
+{
+	const ZSTD_parameters params = zstd_dict_profile()->params;
+	const size_t cwksp_size = ZSTD_CDictWorkspaceBound(params.cParams);
+	const size_t dwksp_size = ZSTD_DDictWorkspaceBound();
+
+	zstd_dict.cwksp = vzalloc(cwksp_size);
+	zstd_dict.dwksp = vzalloc(dwksp_size);
+	if (!zstd_dict.cwksp || !zstd_dict.dwksp)
+		goto err;
+
+	zstd_dict.cdict = ZSTD_initCDict(zstd_dict.buf, ZSTD_DICT_SIZE, params,
+					 zstd_dict.cwksp, cwksp_size);
+	zstd_dict.ddict = ZSTD_initDDict(zstd_dict.buf, ZSTD_DICT_SIZE,
+					 zstd_dict.dwksp, dwksp_size);
+	if (!zstd_dict.cdict || !zstd_dict.ddict)
+		goto err;
+
+	/* the digested dictionary must be visible before ready */
+	smp_store_release(&zstd_dict.ready, true);
+	pr_info("zstd: dictionary of %lu bytes is built from swap pages\n",
+		ZSTD_DICT_SIZE);
+	return;
+err:
+	pr_err("zstd: failed to build a dictionary\n");
+	vfree(zstd_dict.cwksp);
+	vfree(zstd_dict.dwksp);
+	zstd_dict.cwksp = NULL;
+	zstd_dict.dwksp = NULL;
+}
+
+/* Samples @src while the dictionary is not complete */
+static void zstd_dict_sample(const u8 *src, unsigned int slen)
+{
+	unsigned long flags;
+	bool full = false;
+
+	if (slen != PAGE_SIZE || READ_ONCE(zstd_dict.nr_pages) >= ZSTD_DICT_PAGES)
+		return;
+
+	spin_lock_irqsave(&zstd_dict.lock, flags);
+	if (zstd_dict.nr_pages < ZSTD_DICT_PAGES &&
+	    !(zstd_dict.seen++ % ZSTD_DICT_STRIDE)) {
+		memcpy(zstd_dict.buf + zstd_dict.nr_pages * PAGE_SIZE,
+		       src, PAGE_SIZE);
+		full = ++zstd_dict.nr_pages == ZSTD_DICT_PAGES;
+	}
+	spin_unlock_irqrestore(&zstd_dict.lock, flags);
+
+	if (full)
+		schedule_work(&zstd_dict.work);
+}
+
+static int zstd_profile_compress(struct crypto_tfm *tfm, const u8 *src,
+				 unsigned int slen, u8 *dst, unsigned int *dlen)
+{
+	struct zstd_profile *profile = zstd_tfm_profile(tfm);
+	struct zstd_pcpu_cctx *c;
+	unsigned int hlen = 0;
+	size_t out_len;
+
+	if (profile->dict) {
+		if (*dlen < 1)
+			return -EINVAL;
+		hlen = 1;
+	}
+
+	c = get_cpu_ptr(profile->pcpu);
+	if (profile->dict && smp_load_acquire(&zstd_dict.ready)) {
+		dst[0] = ZSTD_DICT_MARK_USED;
+		out_len = ZSTD_compress_usingCDict(c->cctx, dst + hlen,
+				*dlen - hlen, src, slen, zstd_dict.cdict);
+	} else {
+		if (profile->dict)
+			dst[0] = ZSTD_DICT_MARK_NONE;
+		out_len = ZSTD_compressCCtx(c->cctx, dst + hlen, *dlen - hlen,
+				src, slen, profile->params);
+	}
+	put_cpu_ptr(profile->pcpu);
+
+	if (ZSTD_isError(out_len))
+		return -EINVAL;
+
+	if (profile->dict)
+		zstd_dict_sample(src, slen);
+
+	*dlen = out_len + hlen;
+	return 0;
+}
+
+static int zstd_profile_decompress(struct crypto_tfm *tfm, const u8 *src,
+				   unsigned int slen, u8 *dst, unsigned int *dlen)
+{
+	struct zstd_profile *profile = zstd_tfm_profile(tfm);
+	struct zstd_pcpu_dctx *d;
+	bool use_dict = false;
+	size_t out_len;
+
+	if (profile->dict) {
+		if (slen < 1 || src[0] > ZSTD_DICT_MARK_USED)
+			return -EINVAL;
+		use_dict = src[0] == ZSTD_DICT_MARK_USED;
+		if (use_dict && !smp_load_acquire(&zstd_dict.ready))
+			return -EINVAL;
+		src++;
+		slen--;
+	}
+
+	d = get_cpu_ptr(zstd_pcpu_dctx);
+	if (use_dict)
+		out_len = ZSTD_decompress_usingDDict(d->dctx, dst, *dlen,
+				src, slen, zstd_dict.ddict);
+	else
+		out_len = ZSTD_decompressDCtx(d->dctx, dst, *dlen, src, slen);
+	put_cpu_ptr(zstd_pcpu_dctx);
+
+	if (ZSTD_isError(out_len))
+		return -EINVAL;
+	*dlen = out_len;
+	return 0;
+}
+
+static void zstd_unregister_profiles(int nr)
+{
+	while (nr--)
+		crypto_unregister_alg(&zstd_profiles[nr].alg);
+}
+
+static int zstd_register_profiles(void)
+{
+	struct zstd_profile *profile;
+	ZSTD_parameters *params;
+	int i, ret;
+
+	spin_lock_init(&zstd_dict.lock);
+	INIT_WORK(&zstd_dict.work, zstd_dict_build);
+	zstd_dict.buf = vzalloc(ZSTD_DICT_SIZE);
+	if (!zstd_dict.buf)
+		return -ENOMEM;
+
+	for (i = 0; i < ARRAY_SIZE(zstd_profiles); i++) {
+		profile = &zstd_profiles[i];
+		params = &profile->params;
+
+		*params = ZSTD_getParams(profile->level, PAGE_SIZE,
+				profile->dict ? ZSTD_DICT_SIZE : 0);
+		if (profile->hash_log)
+			params->cParams.hashLog = profile->hash_log;
+		if (profile->search_length)
+			params->cParams.searchLength = profile->search_length;
+		params->fParams.contentSizeFlag = 0;
+		params->fParams.checksumFlag = 0;
+		params->fParams.noDictIDFlag = 1;
+
+		ret = crypto_register_alg(&profile->alg);
+		if (ret) {
+			zstd_unregister_profiles(i);
+			vfree(zstd_dict.buf);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static void zstd_free_dict(void)
+{
+	cancel_work_sync(&zstd_dict.work);
+	vfree(zstd_dict.cwksp);
+	vfree(zstd_dict.dwksp);
+	vfree(zstd_dict.buf);
+}
+
 static int __init zstd_mod_init(void)
 {
 	int ret;
@@ -245,14 +654,24 @@ static int __init zstd_mod_init(void)
 		return ret;
 
 	ret = crypto_register_scomp(&scomp);
-	if (ret)
+	if (ret) {
 		crypto_unregister_alg(&alg);
+		return ret;
+	}
+
+	ret = zstd_register_profiles();
+	if (ret) {
+		crypto_unregister_scomp(&scomp);
+		crypto_unregister_alg(&alg);
+	}
 
 	return ret;
 }
 
 static void __exit zstd_mod_fini(void)
 {
+	zstd_unregister_profiles(ARRAY_SIZE(zstd_profiles));
+	zstd_free_dict();
 	crypto_unregister_alg(&alg);
 	crypto_unregister_scomp(&scomp);
 }
@@ -263,3 +682,6 @@ module_exit(zstd_mod_fini);
 MODULE_LICENSE("GPL");
 MODULE_DESCRIPTION("Zstd Compression Algorithm");
 MODULE_ALIAS_CRYPTO("zstd");
+MODULE_ALIAS_CRYPTO("zstd_fast");
+MODULE_ALIAS_CRYPTO("zstd_ratio");
+MODULE_ALIAS_CRYPTO("zstd_dict");
@@ -0,0 +1,193 @@
+/*
+ * Page compression benchmark of the zstd profiles
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published by
+ * the Free Software Foundation.
+ *
+ * Pages of text-like data are compressed and decompressed one by one, as
+ * zram does, by every available algorithm. Ratio and ns per page are
+ * reported at module load, e.g.
+ *
+ * #insmod zstd_bench.ko nr_pages=1024 loops=4
+ *
+ * zstd_dict is warmed up first, so that its dictionary is sampled from the
+ * same pages.
+ */
+
+#define pr_fmt(fmt) "zstd_bench: " fmt
+
+#include <linux/crypto.h>
+#include <linux/delay.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/random.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+
+static unsigned int nr_pages = 1024;
+module_param(nr_pages, uint, 0444);
+MODULE_PARM_DESC(nr_pages, "pages compressed per pass");
+
+static unsigned int loops = 4;
+module_param(loops, uint, 0444);
+MODULE_PARM_DESC(loops, "passes over the pages");
+
+static const char * const zstd_bench_algs[] = {
+	"lzo", "lz4", "zstd", "zstd_fast", "zstd_ratio", "zstd_dict",
+};
+
+static const char * const zstd_bench_words[] = {
+	"the ", "kernel ", "page ", "swap ", "zram ", "binder ",
+	"surfaceflinger ", "0123456789 ", "\0\0\0\0\0\0\0\0",
+};
+
+/* compressed pages may be larger than a page */
+#define ZSTD_BENCH_DST_SIZE	(PAGE_SIZE * 2)
+
+static void zstd_bench_fill(u8 *buf, size_t len)
+{
+	size_t n = 0, i, wlen;
+	const char *w;
+	u32 rnd;
+
+	while (n < len) {
+		rnd = prandom_u32();
+		if (!(rnd & 0xf)) {
+			/* incompressible noise */
+			buf[n++] = rnd >> 8;
+			continue;
+		}
+
+		w = zstd_bench_words[(rnd >> 4) % ARRAY_SIZE(zstd_bench_words)];
+		wlen = strlen(w) ?: 8;
+		for (i = 0; i < wlen && n < len; i++)
+			buf[n++] = w[i];
+	}
+}
+
+static int zstd_bench_compress(struct crypto_comp *tfm, const u8 *in,
+			       u8 *comp, unsigned int *comp_len)
+{
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < nr_pages; i++) {
+		comp_len[i] = ZSTD_BENCH_DST_SIZE;
+		ret = crypto_comp_compress(tfm, in + i * PAGE_SIZE, PAGE_SIZE,
+				comp + i * ZSTD_BENCH_DST_SIZE, &comp_len[i]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int zstd_bench_alg(const char *name, const u8 *in, u8 *comp,
+			  unsigned int *comp_len, u8 *out)
+{
+	struct crypto_comp *tfm;
+	ktime_t start;
+	u64 comp_ns, decomp_ns, total = 0;
+	unsigned int i, j, dlen;
+	int ret = 0;
+
+	tfm = crypto_alloc_comp(name, 0, 0);
+	if (IS_ERR(tfm))
+		return 0;
+
+	if (!strcmp(name, "zstd_dict")) {
+		ret = zstd_bench_compress(tfm, in, comp, comp_len);
+		if (ret)
+			goto out;
+		/* the dictionary is built by a work */
+		msleep(100);
+	}
+
+	start = ktime_get();
+	for (j = 0; j < loops; j++) {
+		ret = zstd_bench_compress(tfm, in, comp, comp_len);
+		if (ret)
+			goto out;
+		cond_resched();
+	}
+	comp_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	start = ktime_get();
+	for (j = 0; j < loops; j++) {
+		for (i = 0; i < nr_pages; i++) {
+			dlen = PAGE_SIZE;
+			ret = crypto_comp_decompress(tfm,
+					comp + i * ZSTD_BENCH_DST_SIZE,
+					comp_len[i], out, &dlen);
+			if (ret || dlen != PAGE_SIZE) {
+				ret = -EINVAL;
+				goto out;
+			}
+		}
+		cond_resched();
+	}
+	decomp_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	for (i = 0; i < nr_pages; i++)
+		total += comp_len[i];
+
+	pr_info("%-10s ratio %3llu%% compress %6llu ns/page decompress %6llu ns/page\n",
+		name, div64_u64(total * 100, (u64)nr_pages * PAGE_SIZE),
+		div64_u64(comp_ns, (u64)nr_pages * loops),
+		div64_u64(decomp_ns, (u64)nr_pages * loops));
+out:
+	if (ret)
+		pr_err("%s: failed %d\n", name, ret);
+	crypto_free_comp(tfm);
+
+	return ret;
+}
+
+static int __init zstd_bench_init(void)
+{
+	unsigned int *comp_len;
+	u8 *in, *comp, *out;
+	int i, ret = 0;
+
+	if (!nr_pages || !loops)
+		return -EINVAL;
+
+	in = vmalloc(PAGE_SIZE * nr_pages);
+	comp = vmalloc(ZSTD_BENCH_DST_SIZE * nr_pages);
+	comp_len = kcalloc(nr_pages, sizeof(*comp_len), GFP_KERNEL);
+	out = kmalloc(PAGE_SIZE, GFP_KERNEL);
+	if (!in || !comp || !comp_len || !out) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	zstd_bench_fill(in, PAGE_SIZE * nr_pages);
+
+	for (i = 0; i < ARRAY_SIZE(zstd_bench_algs); i++) {
+		ret = zstd_bench_alg(zstd_bench_algs[i], in, comp, comp_len, out);
+		if (ret)
+			break;
+	}
+
+out:
+	kfree(out);
+	kfree(comp_len);
+	vfree(comp);
+	vfree(in);
+
+	return ret;
+}
+
+static void __exit zstd_bench_exit(void)
+{
+}
+
+module_init(zstd_bench_init);
+module_exit(zstd_bench_exit);
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Page compression benchmark of the zstd profiles");
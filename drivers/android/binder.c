@@ -52,15 +52,19 @@
 #define pr_fmt(fmt) KBUILD_MODNAME ": " fmt
 
 #include <asm/cacheflush.h>
+#include <linux/dma-buf.h>
 #include <linux/fdtable.h>
 #include <linux/file.h>
 #include <linux/freezer.h>
 #include <linux/fs.h>
+#include <linux/ktime.h>
 #include <linux/list.h>
+#include <linux/math64.h>
 #include <linux/miscdevice.h>
 #include <linux/module.h>
 #include <linux/mutex.h>
 #include <linux/nsproxy.h>
+#include <linux/percpu.h>
 #include <linux/poll.h>
 #include <linux/debugfs.h>
 #include <linux/rbtree.h>
@@ -219,6 +223,35 @@ static inline void binder_stats_created(enum binder_stat_types type)
 	atomic_inc(&binder_stats.obj_created[type]);
 }
 
+static void binder_lat_hist_add(struct binder_lat_hist __percpu *lat,
+				enum binder_lat_types type, u64 us)
+{
+	int idx = min_t(int, fls64(us), BINDER_LAT_BUCKETS - 1);
+
+	this_cpu_inc(lat->bucket[type][idx]);
+	this_cpu_add(lat->sum_us[type], us);
+}
+
+/*
+ * Transaction latency histograms, collected per cpu for all transactions and
+ * for each process. Bucket n counts latencies of [2^(n-1), 2^n) us.
+ */
+enum binder_lat_types {
+	BINDER_LAT_QUEUE,	/* queued until a thread of the target reads it */
+	BINDER_LAT_HANDLE,	/* read by the target until its reply */
+	BINDER_LAT_REPLY,	/* queued until the reply, seen by the caller */
+	BINDER_LAT_COUNT
+};
+
+#define BINDER_LAT_BUCKETS	20
+
+struct binder_lat_hist {
+	u32 bucket[BINDER_LAT_COUNT][BINDER_LAT_BUCKETS];
+	u64 sum_us[BINDER_LAT_COUNT];
+};
+
+static DEFINE_PER_CPU(struct binder_lat_hist, binder_lat);
+
 struct binder_transaction_log_entry {
 	int debug_id;
 	int debug_id_done;
@@ -575,6 +608,7 @@ struct binder_proc {
 	struct binder_context *context;
 	spinlock_t inner_lock;
 	spinlock_t outer_lock;
+	struct binder_lat_hist __percpu *lat;
 };
 
 enum {
@@ -661,6 +695,8 @@ struct binder_transaction {
 	bool    set_priority_called;
 	kuid_t	sender_euid;
 	binder_uintptr_t security_ctx;
+	ktime_t	enqueue_time;
+	ktime_t	start_time;
 	/**
 	 * @lock:  protects @from, @to_proc, and @to_thread
 	 *
@@ -670,6 +706,16 @@ struct binder_transaction {
 	spinlock_t lock;
 };
 
+static void binder_lat_add(struct binder_proc *proc,
+			   enum binder_lat_types type, ktime_t start)
+{
+	u64 us = ktime_us_delta(ktime_get(), start);
+
+	binder_lat_hist_add(&binder_lat, type, us);
+	if (proc->lat)
+		binder_lat_hist_add(proc->lat, type, us);
+}
+
 /**
  * binder_proc_lock() - Acquire outer lock for given binder_proc
  * @proc:         struct binder_proc to acquire
@@ -2846,6 +2892,66 @@ static void print_binder_proc_inner(struct binder_proc *proc)
 }
 //SAnP]
 
+/*
+ * Map the dma-buf given by the fd in @bp->buffer into the extra buffers
+ * space of the transaction instead of copying @bp->length bytes. On
+ * success @bp->buffer is the target address like for a copied buffer.
+ */
+static int binder_translate_dma_buf(struct binder_buffer_object *bp,
+				    struct binder_transaction *t,
+				    struct binder_thread *thread,
+				    u8 **sg_bufp, u8 *sg_buf_end)
+{
+	struct binder_proc *proc = thread->proc;
+	struct binder_proc *target_proc = t->to_proc;
+	struct binder_device *device;
+	struct dma_buf *dmabuf;
+	u8 *start = PTR_ALIGN(*sg_bufp, PAGE_SIZE);
+	size_t size = PAGE_ALIGN(bp->length);
+	int ret;
+
+	if (!bp->length || size < bp->length || start > sg_buf_end ||
+	    size > sg_buf_end - start) {
+		binder_user_error("%d:%d got transaction with too large dma-buf\n",
+				  proc->pid, thread->pid);
+		return -EINVAL;
+	}
+
+	dmabuf = dma_buf_get((int)bp->buffer);
+	if (IS_ERR(dmabuf)) {
+		binder_user_error("%d:%d got transaction with invalid dma-buf fd, %d\n",
+				  proc->pid, thread->pid, (int)bp->buffer);
+		return PTR_ERR(dmabuf);
+	}
+
+	ret = security_binder_transfer_file(proc->tsk, target_proc->tsk,
+					    dmabuf->file);
+	if (ret < 0) {
+		ret = -EPERM;
+		goto out;
+	}
+
+	device = container_of(target_proc->context, struct binder_device,
+			      context);
+	ret = binder_alloc_map_dma_buf(&target_proc->alloc, t->buffer,
+				       start, size, dmabuf,
+				       device->miscdev.this_device);
+	if (ret < 0)
+		goto out;
+
+	binder_debug(BINDER_DEBUG_TRANSACTION,
+		     "        dma-buf fd %d size %zd\n",
+		     (int)bp->buffer, size);
+
+	/* Fixup buffer pointer to target proc address space */
+	bp->buffer = (uintptr_t)start +
+		binder_alloc_get_user_buffer_offset(&target_proc->alloc);
+	*sg_bufp = start + size;
+out:
+	dma_buf_put(dmabuf);
+	return ret;
+}
+
 static int binder_fixup_parent(struct binder_transaction *t,
 			       struct binder_thread *thread,
 			       struct binder_buffer_object *bp,
@@ -3459,6 +3565,18 @@ static void binder_transaction(struct binder_proc *proc,
 				to_binder_buffer_object(hdr);
 			size_t buf_left = sg_buf_end - sg_bufp;
 
+			if (bp->flags & BINDER_BUFFER_FLAG_DMA_BUF) {
+				ret = binder_translate_dma_buf(bp, t, thread,
+							       &sg_bufp,
+							       sg_buf_end);
+				if (ret < 0) {
+					return_error = BR_FAILED_REPLY;
+					return_error_param = ret;
+					return_error_line = __LINE__;
+					goto err_translate_failed;
+				}
+				goto fixup_parent;
+			}
 			if (bp->length > buf_left) {
 				binder_user_error("%d:%d got transaction with too large buffer\n",
 						  proc->pid, thread->pid);
@@ -3483,6 +3601,7 @@ static void binder_transaction(struct binder_proc *proc,
 						&target_proc->alloc);
 			sg_bufp += ALIGN(bp->length, sizeof(u64));
 
+fixup_parent:
 			ret = binder_fixup_parent(t, thread, bp, off_start,
 						  offp - off_start,
 						  last_fixup_obj,
@@ -3507,6 +3626,7 @@ static void binder_transaction(struct binder_proc *proc,
 	}
 	tcomplete->type = BINDER_WORK_TRANSACTION_COMPLETE;
 	t->work.type = BINDER_WORK_TRANSACTION;
+	t->enqueue_time = ktime_get();
 
 	if (reply) {
 		binder_enqueue_thread_work(thread, tcomplete);
@@ -3521,6 +3641,8 @@ static void binder_transaction(struct binder_proc *proc,
 		binder_inner_proc_unlock(target_proc);
 		wake_up_interruptible_sync(&target_thread->wait);
 		binder_restore_priority(current, in_reply_to->saved_priority);
+		binder_lat_add(proc, BINDER_LAT_HANDLE, in_reply_to->start_time);
+		binder_lat_add(proc, BINDER_LAT_REPLY, in_reply_to->enqueue_time);
 		binder_free_transaction(in_reply_to);
 	} else if (!(t->flags & TF_ONE_WAY)) {
 		BUG_ON(t->buffer->async_transaction != 0);
@@ -4445,6 +4567,8 @@ retry:
 			node_prio.prio = target_node->min_priority;
 			binder_transaction_priority(current, t, node_prio,
 						    target_node->inherit_rt);
+			t->start_time = ktime_get();
+			binder_lat_add(proc, BINDER_LAT_QUEUE, t->enqueue_time);
 			cmd = BR_TRANSACTION;
 		} else {
 			trd->target.ptr = 0;
@@ -4683,6 +4807,7 @@ static void binder_free_proc(struct binder_proc *proc)
 	binder_alloc_deferred_release(&proc->alloc);
 	put_task_struct(proc->tsk);
 	binder_stats_deleted(BINDER_STAT_PROC);
+	free_percpu(proc->lat);
 	kfree(proc);
 }
 
@@ -5176,6 +5301,8 @@ static int binder_open(struct inode *nodp, struct file *filp)
 				  miscdev);
 	proc->context = &binder_dev->context;
 	binder_alloc_init(&proc->alloc);
+	/* latency is only accounted globally if this fails */
+	proc->lat = alloc_percpu(struct binder_lat_hist);
 
 	binder_stats_created(BINDER_STAT_PROC);
 	proc->pid = current->group_leader->pid;
@@ -5976,6 +6103,76 @@ static int binder_stats_show(struct seq_file *m, void *unused)
 	return 0;
 }
 
+static const char * const binder_lat_strings[] = {
+	"queue",
+	"handle",
+	"reply"
+};
+
+static void print_binder_lat_hist(struct seq_file *m, const char *prefix,
+				  struct binder_lat_hist __percpu *lat)
+{
+	struct binder_lat_hist sum;
+	struct binder_lat_hist *h;
+	u64 count;
+	int cpu, i, j;
+
+	memset(&sum, 0, sizeof(sum));
+	for_each_possible_cpu(cpu) {
+		h = per_cpu_ptr(lat, cpu);
+		for (i = 0; i < BINDER_LAT_COUNT; i++) {
+			for (j = 0; j < BINDER_LAT_BUCKETS; j++)
+				sum.bucket[i][j] += h->bucket[i][j];
+			sum.sum_us[i] += h->sum_us[i];
+		}
+	}
+
+	BUILD_BUG_ON(ARRAY_SIZE(binder_lat_strings) != BINDER_LAT_COUNT);
+	for (i = 0; i < BINDER_LAT_COUNT; i++) {
+		count = 0;
+		for (j = 0; j < BINDER_LAT_BUCKETS; j++)
+			count += sum.bucket[i][j];
+		if (!count)
+			continue;
+
+		seq_printf(m, "%s%s: count %llu avg %lluus\n", prefix,
+			   binder_lat_strings[i], count,
+			   div64_u64(sum.sum_us[i], count));
+		seq_printf(m, "%s ", prefix);
+		for (j = 0; j < BINDER_LAT_BUCKETS; j++) {
+			if (!sum.bucket[i][j])
+				continue;
+			if (j == BINDER_LAT_BUCKETS - 1)
+				seq_printf(m, " >=%luus:%u", 1UL << (j - 1),
+					   sum.bucket[i][j]);
+			else
+				seq_printf(m, " <%luus:%u", 1UL << j,
+					   sum.bucket[i][j]);
+		}
+		seq_puts(m, "\n");
+	}
+}
+
+static int binder_latency_show(struct seq_file *m, void *unused)
+{
+	struct binder_proc *proc;
+
+	seq_puts(m, "binder latency:\n");
+
+	print_binder_lat_hist(m, "", &binder_lat);
+
+	mutex_lock(&binder_procs_lock);
+	hlist_for_each_entry(proc, &binder_procs, proc_node) {
+		if (!proc->lat)
+			continue;
+		seq_printf(m, "proc %d\n", proc->pid);
+		print_binder_lat_hist(m, "  ", proc->lat);
+	}
+	mutex_unlock(&binder_procs_lock);
+
+	return 0;
+}
+
 static int binder_transactions_show(struct seq_file *m, void *unused)
 {
 	struct binder_proc *proc;
@@ -6068,6 +6265,7 @@ BINDER_DEBUG_ENTRY(state);
 BINDER_DEBUG_ENTRY(stats);
 BINDER_DEBUG_ENTRY(transactions);
 BINDER_DEBUG_ENTRY(transaction_log);
+BINDER_DEBUG_ENTRY(latency);
 
 static int __init init_binder_device(const char *name)
 {
@@ -6142,6 +6340,11 @@ static int __init binder_init(void)
 				    binder_debugfs_dir_entry_root,
 				    &binder_transaction_log_failed,
 				    &binder_transaction_log_fops);
+		debugfs_create_file("latency",
+				    0444,
+				    binder_debugfs_dir_entry_root,
+				    NULL,
+				    &binder_latency_fops);
 	}
 
 	/*
@@ -19,6 +19,7 @@
 
 #include <asm/cacheflush.h>
 #include <linux/list.h>
+#include <linux/dma-buf.h>
 #include <linux/sched/mm.h>
 #include <linux/module.h>
 #include <linux/rtmutex.h>
@@ -306,12 +307,17 @@ free_range:
 		index = (page_addr - alloc->buffer) / PAGE_SIZE;
 		page = &alloc->pages[index];
 
+		/* dma-buf pages were lent in place of this one */
+		if (!page->page_ptr)
+			goto next_page;
+
 		trace_binder_free_lru_start(alloc, index);
 
 		ret = list_lru_add(&binder_alloc_lru, &page->lru);
 		WARN_ON(!ret);
 
 		trace_binder_free_lru_end(alloc, index);
+next_page:
 		if (page_addr == start)
 			break;
 		continue;
@@ -362,19 +368,83 @@ static inline struct vm_area_struct *binder_alloc_get_vma(
 	return vma;
 }
 
+static int binder_size_class(struct binder_alloc *alloc, size_t size)
+{
+	int cls;
+
+	if (!alloc->size_classes ||
+	    size > BINDER_SIZE_CLASS_SIZE(BINDER_NR_SIZE_CLASSES - 1))
+		return -1;
+
+	for (cls = 0; size > BINDER_SIZE_CLASS_SIZE(cls); cls++)
+		;
+
+	return cls;
+}
+
+/* The class with the most allocations gets its buffers carved a page ahead */
+static bool binder_size_class_hottest(struct binder_alloc *alloc, int cls)
+{
+	int i;
+
+	for (i = 0; i < BINDER_NR_SIZE_CLASSES; i++)
+		if (alloc->class_alloc[i] > alloc->class_alloc[cls])
+			return false;
+
+	return true;
+}
+
+static void binder_size_class_cache(struct binder_alloc *alloc,
+				    struct binder_buffer *buffer, int cls)
+{
+	buffer->free = 1;
+	buffer->cached = 1;
+	list_add(&buffer->class_entry, &alloc->class_free[cls]);
+	alloc->class_cached[cls]++;
+}
+
+/*
+ * Split the tail of a freshly allocated class buffer into further buffers
+ * of the same class. Their pages were mapped together with the head, so
+ * they go straight to the class list.
+ */
+static void binder_size_class_carve(struct binder_alloc *alloc,
+				    struct binder_buffer *buffer, int cls,
+				    int nr)
+{
+	size_t size = BINDER_SIZE_CLASS_SIZE(cls);
+	struct binder_buffer *prev = buffer;
+	int i;
+
+	for (i = 1; i < nr; i++) {
+		struct binder_buffer *new_buffer;
+
+		new_buffer = kzalloc(sizeof(*new_buffer), GFP_KERNEL);
+		if (!new_buffer)
+			break;
+		new_buffer->data = (u8 *)buffer->data + i * size;
+		list_add(&new_buffer->entry, &prev->entry);
+		binder_size_class_cache(alloc, new_buffer, cls);
+		prev = new_buffer;
+	}
+}
+
+static int binder_size_class_flush(struct binder_alloc *alloc);
+
 struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 						  size_t data_size,
 						  size_t offsets_size,
 						  size_t extra_buffers_size,
 						  int is_async)
 {
-	struct rb_node *n = alloc->free_buffers.rb_node;
+	struct rb_node *n;
 	struct binder_buffer *buffer;
 	size_t buffer_size;
-	struct rb_node *best_fit = NULL;
+	struct rb_node *best_fit;
 	void *has_page_addr;
 	void *end_page_addr;
-	size_t size, data_offsets_size;
+	size_t size, req_size, data_offsets_size;
+	int cls, carve = 0;
 	int ret;
 
 	if (!binder_alloc_get_vma(alloc)) {
@@ -411,7 +481,32 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 
 	/* Pad 0-size buffers so they get assigned unique addresses */
 	size = max(size, sizeof(void *));
+	req_size = size;
+
+	cls = binder_size_class(alloc, size);
+	if (cls >= 0) {
+		alloc->class_alloc[cls]++;
+		if (!list_empty(&alloc->class_free[cls])) {
+			buffer = list_first_entry(&alloc->class_free[cls],
+						  struct binder_buffer,
+						  class_entry);
+			list_del_init(&buffer->class_entry);
+			buffer->cached = 0;
+			alloc->class_cached[cls]--;
+			alloc->class_hit[cls]++;
+			goto claim;
+		}
+		size = BINDER_SIZE_CLASS_SIZE(cls);
+		if (binder_size_class_hottest(alloc, cls)) {
+			carve = min_t(int, PAGE_SIZE / size,
+				      BINDER_SIZE_CLASS_DEPTH + 1);
+			size *= carve;
+		}
+	}
 
+search:
+	n = alloc->free_buffers.rb_node;
+	best_fit = NULL;
 	while (n) {
 		buffer = rb_entry(n, struct binder_buffer, rb_node);
 		BUG_ON(!buffer->free);
@@ -427,6 +522,14 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 			break;
 		}
 	}
+	if (best_fit == NULL && carve > 1) {
+		/* not worth failing for the slices carved ahead */
+		size /= carve;
+		carve = 0;
+		goto search;
+	}
+	if (best_fit == NULL && binder_size_class_flush(alloc))
+		goto search;
 	if (best_fit == NULL) {
 		size_t allocated_buffers = 0;
 		size_t largest_alloc_size = 0;
@@ -497,6 +600,10 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 	}
 
 	rb_erase(best_fit, &alloc->free_buffers);
+	if (carve > 1)
+		binder_size_class_carve(alloc, buffer, cls, carve);
+
+claim:
 	buffer->free = 0;
 	buffer->allow_user_free = 0;
 	binder_insert_allocated_buffer_locked(alloc, buffer);
@@ -508,6 +615,7 @@ struct binder_buffer *binder_alloc_new_buf_locked(struct binder_alloc *alloc,
 	buffer->async_transaction = is_async;
 	buffer->extra_buffers_size = extra_buffers_size;
 	if (is_async) {
+		size = req_size;
 		alloc->free_async_space -= size + sizeof(struct binder_buffer);
 		if ((system_server_pid == alloc->pid) && (alloc->free_async_space <= 153600)) { // 150K
 			pr_info("%d: [free_size<150K] binder_alloc_buf size %zd async free %zd\n",
@@ -616,10 +724,138 @@ static void binder_delete_free_buffer(struct binder_alloc *alloc,
 	kfree(buffer);
 }
 
+static void binder_alloc_unmap_dma_buf(struct binder_alloc *alloc,
+				       struct vm_area_struct *vma,
+				       struct binder_dma_buf_map *map)
+{
+	struct dma_buf *dmabuf = map->attach->dmabuf;
+
+	if (vma && map->size)
+		zap_page_range(vma, (uintptr_t)map->start +
+			       alloc->user_buffer_offset, map->size);
+	if (map->size)
+		unmap_kernel_range((unsigned long)map->start, map->size);
+	alloc->pages_borrowed -= map->size >> PAGE_SHIFT;
+
+	dma_buf_unmap_attachment(map->attach, map->sgt, DMA_BIDIRECTIONAL);
+	dma_buf_detach(dmabuf, map->attach);
+	dma_buf_put(dmabuf);
+	kfree(map);
+}
+
+/*
+ * Give the lent pages back to their dma-buf. The buffer pages they
+ * replaced are left unallocated and are mapped again on the next use.
+ */
+static void binder_alloc_unmap_dma_bufs(struct binder_alloc *alloc,
+					struct binder_buffer *buffer)
+{
+	struct binder_dma_buf_map *map;
+	struct vm_area_struct *vma = NULL;
+	struct mm_struct *mm = NULL;
+
+	if (!buffer->dma_bufs)
+		return;
+
+	if (mmget_not_zero(alloc->vma_vm_mm)) {
+		mm = alloc->vma_vm_mm;
+		down_read(&mm->mmap_sem);
+		vma = binder_alloc_get_vma(alloc);
+	}
+
+	while ((map = buffer->dma_bufs)) {
+		buffer->dma_bufs = map->next;
+		binder_alloc_unmap_dma_buf(alloc, vma, map);
+	}
+
+	if (mm) {
+		up_read(&mm->mmap_sem);
+		mmput(mm);
+	}
+}
+
+/*
+ * Merge @buffer with free neighbours and return it to free_buffers.
+ * Cached neighbours stay on their size class list.
+ */
+static struct binder_buffer *binder_free_buf_merge(struct binder_alloc *alloc,
+						   struct binder_buffer *buffer)
+{
+	buffer->free = 1;
+	if (!list_is_last(&buffer->entry, &alloc->buffers)) {
+		struct binder_buffer *next = binder_buffer_next(buffer);
+
+		if (next->free && !next->cached) {
+			rb_erase(&next->rb_node, &alloc->free_buffers);
+			binder_delete_free_buffer(alloc, next);
+		}
+	}
+	if (alloc->buffers.next != &buffer->entry) {
+		struct binder_buffer *prev = binder_buffer_prev(buffer);
+
+		if (prev->free && !prev->cached) {
+			binder_delete_free_buffer(alloc, buffer);
+			rb_erase(&prev->rb_node, &alloc->free_buffers);
+			buffer = prev;
+		}
+	}
+	binder_insert_free_buffer(alloc, buffer);
+
+	return buffer;
+}
+
+/*
+ * A page shared only by cached buffers is kept mapped off the lru. Once
+ * it lies entirely in a free buffer, hand it to the shrinker again.
+ */
+static void binder_size_class_release_page(struct binder_alloc *alloc,
+					   struct binder_buffer *buffer,
+					   void *page_addr)
+{
+	struct binder_lru_page *page;
+	void *end = (u8 *)buffer->data + binder_alloc_buffer_size(alloc, buffer);
+
+	if (page_addr < buffer->data || page_addr + PAGE_SIZE > end)
+		return;
+
+	page = &alloc->pages[(page_addr - alloc->buffer) / PAGE_SIZE];
+	if (page->page_ptr && list_empty(&page->lru))
+		list_lru_add(&binder_alloc_lru, &page->lru);
+}
+
+/* Return all cached buffers to free_buffers, returns the number flushed */
+static int binder_size_class_flush(struct binder_alloc *alloc)
+{
+	struct binder_buffer *buffer, *tmp;
+	int cls, count = 0;
+
+	for (cls = 0; cls < BINDER_NR_SIZE_CLASSES; cls++) {
+		list_for_each_entry_safe(buffer, tmp, &alloc->class_free[cls],
+					 class_entry) {
+			void *start = buffer_start_page(buffer);
+			void *end = (void *)(((uintptr_t)buffer->data +
+				binder_alloc_buffer_size(alloc, buffer) - 1) &
+				PAGE_MASK);
+
+			list_del_init(&buffer->class_entry);
+			buffer->cached = 0;
+			buffer = binder_free_buf_merge(alloc, buffer);
+			binder_size_class_release_page(alloc, buffer, start);
+			if (end != start)
+				binder_size_class_release_page(alloc, buffer, end);
+			count++;
+		}
+		alloc->class_cached[cls] = 0;
+	}
+
+	return count;
+}
+
 static void binder_free_buf_locked(struct binder_alloc *alloc,
 				   struct binder_buffer *buffer)
 {
 	size_t size, buffer_size;
+	int cls;
 
 	buffer_size = binder_alloc_buffer_size(alloc, buffer);
 
@@ -645,30 +881,21 @@ static void binder_free_buf_locked(struct binder_alloc *alloc,
 			      alloc->pid, size, alloc->free_async_space);
 	}
 
+	binder_alloc_unmap_dma_bufs(alloc, buffer);
 	binder_update_page_range(alloc, 0,
 		(void *)PAGE_ALIGN((uintptr_t)buffer->data),
 		(void *)(((uintptr_t)buffer->data + buffer_size) & PAGE_MASK));
 
 	rb_erase(&buffer->rb_node, &alloc->allocated_buffers);
-	buffer->free = 1;
-	if (!list_is_last(&buffer->entry, &alloc->buffers)) {
-		struct binder_buffer *next = binder_buffer_next(buffer);
 
-		if (next->free) {
-			rb_erase(&next->rb_node, &alloc->free_buffers);
-			binder_delete_free_buffer(alloc, next);
-		}
+	cls = binder_size_class(alloc, buffer_size);
+	if (cls >= 0 && buffer_size == BINDER_SIZE_CLASS_SIZE(cls) &&
+	    alloc->class_cached[cls] < BINDER_SIZE_CLASS_DEPTH) {
+		binder_size_class_cache(alloc, buffer, cls);
+		return;
 	}
-	if (alloc->buffers.next != &buffer->entry) {
-		struct binder_buffer *prev = binder_buffer_prev(buffer);
 
-		if (prev->free) {
-			binder_delete_free_buffer(alloc, buffer);
-			rb_erase(&prev->rb_node, &alloc->free_buffers);
-			buffer = prev;
-		}
-	}
-	binder_insert_free_buffer(alloc, buffer);
+	binder_free_buf_merge(alloc, buffer);
 }
 
 /**
@@ -686,6 +913,167 @@ void binder_alloc_free_buf(struct binder_alloc *alloc,
 	mutex_unlock(&alloc->mutex);
 }
 
+static int binder_alloc_lend_page(struct binder_alloc *alloc,
+				  struct vm_area_struct *vma,
+				  void *page_addr, struct page *page)
+{
+	struct binder_lru_page *lru_page;
+	unsigned long user_page_addr;
+	int ret;
+
+	lru_page = &alloc->pages[(page_addr - alloc->buffer) / PAGE_SIZE];
+	user_page_addr = (uintptr_t)page_addr + alloc->user_buffer_offset;
+
+	/* The page of the buffer is active, it is not on the lru */
+	if (lru_page->page_ptr) {
+		zap_page_range(vma, user_page_addr, PAGE_SIZE);
+		unmap_kernel_range((unsigned long)page_addr, PAGE_SIZE);
+		__free_page(lru_page->page_ptr);
+		lru_page->page_ptr = NULL;
+	}
+
+	ret = map_kernel_range_noflush((unsigned long)page_addr,
+				       PAGE_SIZE, PAGE_KERNEL, &page);
+	flush_cache_vmap((unsigned long)page_addr,
+			 (unsigned long)page_addr + PAGE_SIZE);
+	if (ret != 1) {
+		pr_err("%d: binder_alloc_buf failed to map dma-buf page at %pK in kernel\n",
+		       alloc->pid, page_addr);
+		unmap_kernel_range((unsigned long)page_addr, PAGE_SIZE);
+		return -ENOMEM;
+	}
+
+	ret = vm_insert_page(vma, user_page_addr, page);
+	if (ret) {
+		pr_err("%d: binder_alloc_buf failed to map dma-buf page at %lx in userspace\n",
+		       alloc->pid, user_page_addr);
+		unmap_kernel_range((unsigned long)page_addr, PAGE_SIZE);
+		return ret;
+	}
+
+	alloc->pages_borrowed++;
+
+	return 0;
+}
+
+/**
+ * binder_alloc_map_dma_buf() - map dma-buf pages into a binder buffer
+ * @alloc:	binder_alloc for this proc
+ * @buffer:	allocated buffer to map the pages into
+ * @start:	page aligned kernel address inside @buffer
+ * @size:	page aligned size to map
+ * @dmabuf:	dma-buf providing the pages
+ * @dev:	device the dma-buf is attached to
+ *
+ * The pages of @buffer between @start and @start + @size are replaced by
+ * the first pages of @dmabuf, so the payload is visible to the proc
+ * without being copied. @dmabuf is referenced until @buffer is freed.
+ *
+ * Return:	0 on success, negative errno otherwise
+ */
+int binder_alloc_map_dma_buf(struct binder_alloc *alloc,
+			     struct binder_buffer *buffer,
+			     void *start, size_t size,
+			     struct dma_buf *dmabuf,
+			     struct device *dev)
+{
+	struct binder_dma_buf_map *map;
+	struct vm_area_struct *vma = NULL;
+	struct mm_struct *mm = NULL;
+	struct scatterlist *sg;
+	int i, ret;
+
+	if (!PAGE_ALIGNED(start) || !PAGE_ALIGNED(size) || !size ||
+	    size > dmabuf->size)
+		return -EINVAL;
+
+	map = kzalloc(sizeof(*map), GFP_KERNEL);
+	if (!map)
+		return -ENOMEM;
+
+	map->attach = dma_buf_attach(dmabuf, dev);
+	if (IS_ERR(map->attach)) {
+		ret = PTR_ERR(map->attach);
+		kfree(map);
+		return ret;
+	}
+
+	map->sgt = dma_buf_map_attachment(map->attach, DMA_BIDIRECTIONAL);
+	if (IS_ERR(map->sgt)) {
+		ret = PTR_ERR(map->sgt);
+		dma_buf_detach(dmabuf, map->attach);
+		kfree(map);
+		return ret;
+	}
+
+	get_dma_buf(dmabuf);
+	map->start = start;
+
+	mutex_lock(&alloc->mutex);
+	if ((u8 *)start < (u8 *)buffer->data ||
+	    (u8 *)start + size > (u8 *)buffer->data +
+				 binder_alloc_buffer_size(alloc, buffer)) {
+		ret = -EINVAL;
+		goto err;
+	}
+
+	if (!mmget_not_zero(alloc->vma_vm_mm)) {
+		ret = -ESRCH;
+		goto err;
+	}
+	mm = alloc->vma_vm_mm;
+	down_read(&mm->mmap_sem);
+	vma = binder_alloc_get_vma(alloc);
+	if (!vma) {
+		ret = -ESRCH;
+		goto err;
+	}
+
+	for_each_sg(map->sgt->sgl, sg, map->sgt->orig_nents, i) {
+		unsigned long j;
+
+		if (sg->offset) {
+			ret = -EINVAL;
+			goto err;
+		}
+
+		for (j = 0; j < sg->length >> PAGE_SHIFT; j++) {
+			if (map->size == size)
+				break;
+			ret = binder_alloc_lend_page(alloc, vma,
+						     (u8 *)start + map->size,
+						     nth_page(sg_page(sg), j));
+			if (ret)
+				goto err;
+			map->size += PAGE_SIZE;
+		}
+	}
+
+	if (map->size != size) {
+		ret = -EINVAL;
+		goto err;
+	}
+
+	map->next = buffer->dma_bufs;
+	buffer->dma_bufs = map;
+
+	up_read(&mm->mmap_sem);
+	mmput(mm);
+	mutex_unlock(&alloc->mutex);
+
+	return 0;
+
+err:
+	binder_alloc_unmap_dma_buf(alloc, vma, map);
+	if (mm) {
+		up_read(&mm->mmap_sem);
+		mmput(mm);
+	}
+	mutex_unlock(&alloc->mutex);
+
+	return ret;
+}
+
 /**
  * binder_alloc_mmap_handler() - map virtual address space for proc
  * @alloc:	alloc structure for this proc
@@ -799,6 +1187,8 @@ void binder_alloc_deferred_release(struct binder_alloc *alloc)
 		buffers++;
 	}
 
+	binder_size_class_flush(alloc);
+
 	while (!list_empty(&alloc->buffers)) {
 		buffer = list_first_entry(&alloc->buffers,
 					  struct binder_buffer, entry);
@@ -886,6 +1276,7 @@ void binder_alloc_print_pages(struct seq_file *m,
 	int active = 0;
 	int lru = 0;
 	int free = 0;
+	size_t borrowed;
 
 	mutex_lock(&alloc->mutex);
 	for (i = 0; i < alloc->buffer_size / PAGE_SIZE; i++) {
@@ -897,9 +1288,15 @@ void binder_alloc_print_pages(struct seq_file *m,
 		else
 			lru++;
 	}
+	borrowed = alloc->pages_borrowed;
 	mutex_unlock(&alloc->mutex);
 	seq_printf(m, "  pages: %d:%d:%d\n", active, lru, free);
+	seq_printf(m, "  pages lent by dma-buf: %zu\n", borrowed);
 	seq_printf(m, "  pages high watermark: %zu\n", alloc->pages_high);
+	for (i = 0; i < BINDER_NR_SIZE_CLASSES; i++)
+		seq_printf(m, "  size class %zu: alloc %u hit %u cached %u\n",
+			   BINDER_SIZE_CLASS_SIZE(i), alloc->class_alloc[i],
+			   alloc->class_hit[i], alloc->class_cached[i]);
 }
 
 /**
@@ -1042,9 +1439,14 @@ static struct shrinker binder_shrinker = {
  */
 void binder_alloc_init(struct binder_alloc *alloc)
 {
+	int cls;
+
 	alloc->pid = current->group_leader->pid;
 	mutex_init(&alloc->mutex);
 	INIT_LIST_HEAD(&alloc->buffers);
+	alloc->size_classes = true;
+	for (cls = 0; cls < BINDER_NR_SIZE_CLASSES; cls++)
+		INIT_LIST_HEAD(&alloc->class_free[cls]);
 }
 
 int binder_alloc_shrinker_init(void)
@@ -25,20 +25,36 @@
 
 extern struct list_lru binder_alloc_lru;
 struct binder_transaction;
+struct dma_buf;
+
+/*
+ * Small buffers are rounded up to a power of two size class between
+ * 128 bytes and 2KB. Freed class buffers are kept on a per-proc list
+ * with their pages mapped, so the next transaction of the same class
+ * skips the rb tree walk, the split and the page mapping.
+ */
+#define BINDER_SIZE_CLASS_SHIFT		7
+#define BINDER_NR_SIZE_CLASSES		5
+#define BINDER_SIZE_CLASS_DEPTH		16
+#define BINDER_SIZE_CLASS_SIZE(cls)	\
+	((size_t)1 << (BINDER_SIZE_CLASS_SHIFT + (cls)))
 
 /**
  * struct binder_buffer - buffer used for binder transactions
  * @entry:              entry alloc->buffers
  * @rb_node:            node for allocated_buffers/free_buffers rb trees
+ * @class_entry:        entry in alloc->class_free while cached
  * @free:               true if buffer is free
  * @allow_user_free:    describe the second member of struct blah,
  * @async_transaction:  describe the second member of struct blah,
+ * @cached:             true if free buffer is kept on a size class list
  * @debug_id:           describe the second member of struct blah,
  * @transaction:        describe the second member of struct blah,
  * @target_node:        describe the second member of struct blah,
  * @data_size:          describe the second member of struct blah,
  * @offsets_size:       describe the second member of struct blah,
  * @extra_buffers_size: describe the second member of struct blah,
+ * @dma_bufs:           dma-buf pages mapped into the buffer in place
  * @data:i              describe the second member of struct blah,
  *
  * Bookkeeping structure for binder transaction buffers
@@ -47,10 +63,12 @@ struct binder_buffer {
 	struct list_head entry; /* free and allocated entries by address */
 	struct rb_node rb_node; /* free entry by size or allocated entry */
 				/* by address */
+	struct list_head class_entry;
 	unsigned free:1;
 	unsigned allow_user_free:1;
 	unsigned async_transaction:1;
-	unsigned debug_id:29;
+	unsigned cached:1;
+	unsigned debug_id:28;
 
 	struct binder_transaction *transaction;
 
@@ -58,9 +76,30 @@ struct binder_buffer {
 	size_t data_size;
 	size_t offsets_size;
 	size_t extra_buffers_size;
+	struct binder_dma_buf_map *dma_bufs;
 	void *data;
 };
 
+/**
+ * struct binder_dma_buf_map - dma-buf pages lent to a binder buffer
+ * @next:    next mapping of the same buffer
+ * @attach:  attachment of the dma-buf to the binder device
+ * @sgt:     pages of the dma-buf
+ * @start:   kernel address of the first page in the buffer
+ * @size:    page aligned size of the mapping
+ *
+ * The pages replace the ones of the buffer between @start and
+ * @start + @size until the buffer is freed, so the payload reaches the
+ * target without copying.
+ */
+struct binder_dma_buf_map {
+	struct binder_dma_buf_map *next;
+	struct dma_buf_attachment *attach;
+	struct sg_table *sgt;
+	void *start;
+	size_t size;
+};
+
 /**
  * struct binder_lru_page - page object used for binder shrinker
  * @page_ptr: pointer to physical page in mmap'd space
@@ -92,6 +131,12 @@ struct binder_lru_page {
  * @buffer_size:        size of address space specified via mmap
  * @pid:                pid for associated binder_proc (invariant after init)
  * @pages_high:         high watermark of offset in @pages
+ * @size_classes:       round small buffers up to size classes
+ * @class_free:         cached free buffers of each size class
+ * @class_cached:       number of buffers on each @class_free list
+ * @class_alloc:        allocations served by each size class
+ * @class_hit:          allocations served from @class_free
+ * @pages_borrowed:     dma-buf pages currently mapped into buffers
  *
  * Bookkeeping structure for per-proc address space management for binder
  * buffers. It is normally initialized during binder_init() and binder_mmap()
@@ -113,6 +158,12 @@ struct binder_alloc {
 	uint32_t buffer_free;
 	int pid;
 	size_t pages_high;
+	bool size_classes;
+	struct list_head class_free[BINDER_NR_SIZE_CLASSES];
+	uint32_t class_cached[BINDER_NR_SIZE_CLASSES];
+	uint32_t class_alloc[BINDER_NR_SIZE_CLASSES];
+	uint32_t class_hit[BINDER_NR_SIZE_CLASSES];
+	size_t pages_borrowed;
 };
 
 #ifdef CONFIG_ANDROID_BINDER_IPC_SELFTEST
@@ -136,6 +187,11 @@ binder_alloc_prepare_to_free(struct binder_alloc *alloc,
 			     uintptr_t user_ptr);
 extern void binder_alloc_free_buf(struct binder_alloc *alloc,
 				  struct binder_buffer *buffer);
+extern int binder_alloc_map_dma_buf(struct binder_alloc *alloc,
+				    struct binder_buffer *buffer,
+				    void *start, size_t size,
+				    struct dma_buf *dmabuf,
+				    struct device *dev);
 extern int binder_alloc_mmap_handler(struct binder_alloc *alloc,
 				     struct vm_area_struct *vma);
 extern void binder_alloc_deferred_release(struct binder_alloc *alloc);
@@ -298,7 +298,10 @@ void binder_selftest_alloc(struct binder_alloc *alloc)
 	if (!binder_selftest_run || !alloc->vma)
 		goto done;
 	pr_info("STARTED\n");
+	/* the tests expect buffers of the exact requested sizes */
+	alloc->size_classes = false;
 	binder_selftest_alloc_offset(alloc, end_offset, 0);
+	alloc->size_classes = true;
 	binder_selftest_run = false;
 	if (binder_selftest_failures > 0)
 		pr_info("%d tests FAILED\n", binder_selftest_failures);
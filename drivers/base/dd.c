@@ -27,6 +27,9 @@
 #include <linux/async.h>
 #include <linux/pm_runtime.h>
 #include <linux/pinctrl/devinfo.h>
+#ifdef CONFIG_SEC_BOOTSTAT
+#include <linux/sec_ext.h>
+#endif
 
 #include "base.h"
 #include "power/power.h"
@@ -354,6 +357,9 @@ static int really_probe(struct device *dev, struct device_driver *drv)
 {
 	int ret = -EPROBE_DEFER;
 	int local_trigger_count = atomic_read(&deferred_trigger_count);
+#ifdef CONFIG_SEC_BOOTSTAT
+	ktime_t probe_start;
+#endif
 	bool test_remove = IS_ENABLED(CONFIG_DEBUG_TEST_DRIVER_REMOVE) &&
 			   !drv->suppress_bind_attrs;
 
@@ -401,6 +407,9 @@ re_probe:
 			goto probe_failed;
 	}
 
+#ifdef CONFIG_SEC_BOOTSTAT
+	probe_start = ktime_get();
+#endif
 	if (dev->bus->probe) {
 		ret = dev->bus->probe(dev);
 		if (ret)
@@ -410,6 +419,10 @@ re_probe:
 		if (ret)
 			goto probe_failed;
 	}
+#ifdef CONFIG_SEC_BOOTSTAT
+	sec_bootstat_add_probe(drv->name, dev_name(dev),
+			ktime_us_delta(ktime_get(), probe_start));
+#endif
 
 	if (test_remove) {
 		test_remove = false;
@@ -34,6 +34,9 @@ static const char * const backends[] = {
 #endif
 #if IS_ENABLED(CONFIG_CRYPTO_ZSTD)
 	"zstd",
+	"zstd_fast",
+	"zstd_ratio",
+	"zstd_dict",
 #endif
 	NULL
 };
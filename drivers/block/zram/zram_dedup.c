@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * Deduplication of identical pages. Compressed objects are indexed by the
+ * crc32c of their data, and a page whose compressed data is the same as
+ * the one of a stored object takes a reference to it instead of a new one.
+ * The compressors are deterministic, so the same compressed data means the
+ * same page, and comparing the compressed data is enough. It is a fraction
+ * of the page and needs no decompression.
+ *
+ * Only the single page write path deduplicates. Pages sharing an object are
+ * flagged ZRAM_DEDUP and are not recompressed.
+ */
+
+#define KMSG_COMPONENT "zram"
+#define pr_fmt(fmt) KMSG_COMPONENT ": " fmt
+
+#include <linux/crc32.h>
+#include <linux/log2.h>
+#include <linux/rbtree.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/vmalloc.h>
+
+#include "zram_drv.h"
+#include "zram_dedup.h"
+
+/* stored pages per bucket of the table */
+#define ZRAM_DEDUP_PAGES_PER_BUCKET	64
+
+struct zram_dedup_bucket {
+	spinlock_t lock;
+	struct rb_root root;
+};
+
+struct zram_dedup_entry {
+	struct rb_node node;
+	unsigned long handle;
+	unsigned int len;
+	u32 checksum;
+	unsigned long refcount;	/* protected by the bucket lock */
+};
+
+u32 zram_dedup_checksum(const void *mem, unsigned int len)
+{
+	return crc32c_le_inline(~0, mem, len);
+}
+
+static struct zram_dedup_bucket *zram_dedup_bucket(struct zram *zram,
+						   u32 checksum)
+{
+	return &zram->dedup_table[checksum & zram->dedup_mask];
+}
+
+/* Leftmost entry with @checksum, entries of the same checksum follow it */
+static struct zram_dedup_entry *
+zram_dedup_lookup(struct zram_dedup_bucket *bucket, u32 checksum)
+{
+	struct rb_node *node = bucket->root.rb_node;
+	struct zram_dedup_entry *entry, *found = NULL;
+
+	while (node) {
+		entry = rb_entry(node, struct zram_dedup_entry, node);
+		if (checksum <= entry->checksum) {
+			if (checksum == entry->checksum)
+				found = entry;
+			node = node->rb_left;
+		} else {
+			node = node->rb_right;
+		}
+	}
+
+	return found;
+}
+
+static struct zram_dedup_entry *zram_dedup_next(struct zram_dedup_entry *entry)
+{
+	struct rb_node *node = rb_next(&entry->node);
+	struct zram_dedup_entry *next;
+
+	if (!node)
+		return NULL;
+
+	next = rb_entry(node, struct zram_dedup_entry, node);
+	return next->checksum == entry->checksum ? next : NULL;
+}
+
+static bool zram_dedup_match(struct zram *zram, struct zram_dedup_entry *entry,
+			     const void *mem, unsigned int len)
+{
+	void *obj;
+	bool match;
+
+	if (entry->len != len)
+		return false;
+
+	obj = zs_map_object(zram->mem_pool, entry->handle, ZS_MM_RO);
+	match = !memcmp(obj, mem, len);
+	zs_unmap_object(zram->mem_pool, entry->handle);
+
+	return match;
+}
+
+/*
+ * Returns the handle of a stored object with the compressed data @mem, with
+ * a reference taken for the caller, or 0.
+ */
+unsigned long zram_dedup_find(struct zram *zram, const void *mem,
+			      unsigned int len, u32 checksum)
+{
+	struct zram_dedup_bucket *bucket = zram_dedup_bucket(zram, checksum);
+	struct zram_dedup_entry *entry;
+	unsigned long handle = 0;
+
+	spin_lock(&bucket->lock);
+	for (entry = zram_dedup_lookup(bucket, checksum); entry;
+	     entry = zram_dedup_next(entry)) {
+		if (zram_dedup_match(zram, entry, mem, len)) {
+			entry->refcount++;
+			handle = entry->handle;
+			break;
+		}
+	}
+	spin_unlock(&bucket->lock);
+
+	return handle;
+}
+
+/*
+ * Indexes a newly stored object. Returns false if it could not be, then the
+ * object is owned by its page alone.
+ */
+bool zram_dedup_insert(struct zram *zram, unsigned long handle,
+		       unsigned int len, u32 checksum)
+{
+	struct zram_dedup_bucket *bucket = zram_dedup_bucket(zram, checksum);
+	struct rb_node **link, *parent = NULL;
+	struct zram_dedup_entry *entry, *new;
+
+	new = kmalloc(sizeof(*new), GFP_NOIO | __GFP_NOWARN);
+	if (!new)
+		return false;
+
+	new->handle = handle;
+	new->len = len;
+	new->checksum = checksum;
+	new->refcount = 1;
+
+	spin_lock(&bucket->lock);
+	link = &bucket->root.rb_node;
+	while (*link) {
+		parent = *link;
+		entry = rb_entry(parent, struct zram_dedup_entry, node);
+		if (checksum < entry->checksum)
+			link = &parent->rb_left;
+		else
+			link = &parent->rb_right;
+	}
+	rb_link_node(&new->node, parent, link);
+	rb_insert_color(&new->node, &bucket->root);
+	spin_unlock(&bucket->lock);
+
+	return true;
+}
+
+/*
+ * Drops a reference to the object @handle of a ZRAM_DEDUP page. Returns true
+ * for the last one, then the caller frees the object.
+ */
+bool zram_dedup_put(struct zram *zram, unsigned long handle, unsigned int len)
+{
+	struct zram_dedup_bucket *bucket;
+	struct zram_dedup_entry *entry;
+	bool last = false;
+	u32 checksum;
+	void *obj;
+
+	obj = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
+	checksum = zram_dedup_checksum(obj, len);
+	zs_unmap_object(zram->mem_pool, handle);
+
+	bucket = zram_dedup_bucket(zram, checksum);
+	spin_lock(&bucket->lock);
+	for (entry = zram_dedup_lookup(bucket, checksum); entry;
+	     entry = zram_dedup_next(entry)) {
+		if (entry->handle != handle)
+			continue;
+
+		if (!--entry->refcount) {
+			rb_erase(&entry->node, &bucket->root);
+			last = true;
+		}
+		break;
+	}
+	spin_unlock(&bucket->lock);
+
+	/* Should NEVER happen */
+	WARN_ON_ONCE(!entry);
+	if (last)
+		kfree(entry);
+
+	return !entry || last;
+}
+
+bool zram_dedup_init(struct zram *zram, size_t num_pages)
+{
+	unsigned long nr, i;
+
+	if (!zram->use_dedup)
+		return true;
+
+	nr = roundup_pow_of_two(max_t(size_t, num_pages /
+				ZRAM_DEDUP_PAGES_PER_BUCKET, 1));
+	zram->dedup_table = vmalloc(nr * sizeof(*zram->dedup_table));
+	if (!zram->dedup_table)
+		return false;
+
+	for (i = 0; i < nr; i++) {
+		spin_lock_init(&zram->dedup_table[i].lock);
+		zram->dedup_table[i].root = RB_ROOT;
+	}
+	zram->dedup_mask = nr - 1;
+
+	return true;
+}
+
+/* Called once every page is freed, the table is empty */
+void zram_dedup_fini(struct zram *zram)
+{
+	vfree(zram->dedup_table);
+	zram->dedup_table = NULL;
+	zram->dedup_mask = 0;
+}
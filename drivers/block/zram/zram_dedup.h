@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef _ZRAM_DEDUP_H_
+#define _ZRAM_DEDUP_H_
+
+#ifdef CONFIG_ZRAM_DEDUP
+u32 zram_dedup_checksum(const void *mem, unsigned int len);
+unsigned long zram_dedup_find(struct zram *zram, const void *mem,
+			      unsigned int len, u32 checksum);
+bool zram_dedup_insert(struct zram *zram, unsigned long handle,
+		       unsigned int len, u32 checksum);
+bool zram_dedup_put(struct zram *zram, unsigned long handle,
+		    unsigned int len);
+
+bool zram_dedup_init(struct zram *zram, size_t num_pages);
+void zram_dedup_fini(struct zram *zram);
+
+static inline bool zram_dedup_enabled(struct zram *zram)
+{
+	return zram->dedup_table;
+}
+#else
+static inline u32 zram_dedup_checksum(const void *mem, unsigned int len)
+{
+	return 0;
+}
+
+static inline unsigned long zram_dedup_find(struct zram *zram,
+		const void *mem, unsigned int len, u32 checksum)
+{
+	return 0;
+}
+
+static inline bool zram_dedup_insert(struct zram *zram, unsigned long handle,
+		unsigned int len, u32 checksum)
+{
+	return false;
+}
+
+static inline bool zram_dedup_put(struct zram *zram, unsigned long handle,
+		unsigned int len)
+{
+	return true;
+}
+
+static inline bool zram_dedup_init(struct zram *zram, size_t num_pages)
+{
+	return true;
+}
+
+static inline void zram_dedup_fini(struct zram *zram) {}
+
+static inline bool zram_dedup_enabled(struct zram *zram)
+{
+	return false;
+}
+#endif
+
+#endif /* _ZRAM_DEDUP_H_ */
@@ -32,8 +32,10 @@
 #include <linux/idr.h>
 #include <linux/sysfs.h>
 #include <linux/cpuhotplug.h>
+#include <linux/sched.h>
 
 #include "zram_drv.h"
+#include "zram_dedup.h"
 
 /* Total bytes used by the compressed storage */
 static u64 zram_pool_total_size;
@@ -423,24 +425,6 @@ out:
 	return err;
 }
 
-static unsigned long get_entry_bdev(struct zram *zram)
-{
-	unsigned long entry;
-
-	spin_lock(&zram->bitmap_lock);
-	/* skip 0 bit to confuse zram.handle = 0 */
-	entry = find_next_zero_bit(zram->bitmap, zram->nr_pages, 1);
-	if (entry == zram->nr_pages) {
-		spin_unlock(&zram->bitmap_lock);
-		return 0;
-	}
-
-	set_bit(entry, zram->bitmap);
-	spin_unlock(&zram->bitmap_lock);
-
-	return entry;
-}
-
 static void put_entry_bdev(struct zram *zram, unsigned long entry)
 {
 	int was_set;
@@ -550,46 +534,6 @@ static int read_from_bdev(struct zram *zram, struct bio_vec *bvec,
 		return read_from_bdev_async(zram, bvec, entry, parent);
 }
 
-static int write_to_bdev(struct zram *zram, struct bio_vec *bvec,
-					u32 index, struct bio *parent,
-					unsigned long *pentry)
-{
-	struct bio *bio;
-	unsigned long entry;
-
-	bio = bio_alloc(GFP_ATOMIC, 1);
-	if (!bio)
-		return -ENOMEM;
-
-	entry = get_entry_bdev(zram);
-	if (!entry) {
-		bio_put(bio);
-		return -ENOSPC;
-	}
-
-	bio->bi_iter.bi_sector = entry * (PAGE_SIZE >> 9);
-	bio_set_dev(bio, zram->bdev);
-	if (!bio_add_page(bio, bvec->bv_page, bvec->bv_len,
-					bvec->bv_offset)) {
-		bio_put(bio);
-		put_entry_bdev(zram, entry);
-		return -EIO;
-	}
-
-	if (!parent) {
-		bio->bi_opf = REQ_OP_WRITE | REQ_SYNC;
-		bio->bi_end_io = zram_page_end_io;
-	} else {
-		bio->bi_opf = parent->bi_opf;
-		bio_chain(bio, parent);
-	}
-
-	submit_bio(bio);
-	*pentry = entry;
-
-	return 0;
-}
-
 static void zram_wb_clear(struct zram *zram, u32 index)
 {
 	unsigned long entry;
@@ -598,19 +542,12 @@ static void zram_wb_clear(struct zram *zram, u32 index)
 	entry = zram_get_element(zram, index);
 	zram_set_element(zram, index, 0);
 	put_entry_bdev(zram, entry);
+	atomic64_dec(&zram->stats.bd_count);
 }
 
 #else
 static bool zram_wb_enabled(struct zram *zram) { return false; }
 static inline void reset_bdev(struct zram *zram) {};
-static int write_to_bdev(struct zram *zram, struct bio_vec *bvec,
-					u32 index, struct bio *parent,
-					unsigned long *pentry)
-
-{
-	return -EIO;
-}
-
 static int read_from_bdev(struct zram *zram, struct bio_vec *bvec,
 			unsigned long entry, struct bio *parent, bool sync)
 {
@@ -682,6 +619,119 @@ static ssize_t comp_algorithm_store(struct device *dev,
 	return len;
 }
 
+/*
+ * Secondary compression tier. Slots which are not read for a whole scan
+ * period are recompressed with this algorithm, e.g. lz4 for the write path
+ * and zstd for cold slots. Writing "none" disables it.
+ */
+static ssize_t recomp_algorithm_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	size_t sz;
+	struct zram *zram = dev_to_zram(dev);
+
+	down_read(&zram->init_lock);
+	if (!zram->recompressor[0])
+		sz = scnprintf(buf, PAGE_SIZE, "[none]\n");
+	else
+		sz = zcomp_available_show(zram->recompressor, buf);
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+static ssize_t recomp_algorithm_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	char compressor[ARRAY_SIZE(zram->recompressor)];
+	size_t sz;
+
+	strlcpy(compressor, buf, sizeof(compressor));
+	/* ignore trailing newline */
+	sz = strlen(compressor);
+	if (sz > 0 && compressor[sz - 1] == '\n')
+		compressor[sz - 1] = 0x00;
+
+	if (!strcmp(compressor, "none"))
+		compressor[0] = 0x00;
+	else if (!zcomp_available_algorithm(compressor))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change algorithm for initialized device\n");
+		return -EBUSY;
+	}
+
+	strcpy(zram->recompressor, compressor);
+	up_write(&zram->init_lock);
+	return len;
+}
+
+static ssize_t recomp_threshold_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", zram->recomp_threshold);
+}
+
+static ssize_t recomp_threshold_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned int threshold;
+	int ret;
+
+	ret = kstrtouint(buf, 10, &threshold);
+	if (ret)
+		return ret;
+
+	if (threshold > 100)
+		return -EINVAL;
+
+	zram->recomp_threshold = threshold;
+	return len;
+}
+
+#ifdef CONFIG_ZRAM_DEDUP
+static ssize_t use_dedup_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	down_read(&zram->init_lock);
+	val = zram->use_dedup;
+	up_read(&zram->init_lock);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", (int)val);
+}
+
+static ssize_t use_dedup_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	bool val;
+
+	if (kstrtobool(buf, &val))
+		return -EINVAL;
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change dedup usage for initialized device\n");
+		return -EBUSY;
+	}
+	zram->use_dedup = val;
+	up_write(&zram->init_lock);
+
+	return len;
+}
+#endif
+
 static ssize_t compact_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
@@ -707,11 +757,15 @@ static ssize_t io_stat_show(struct device *dev,
 
 	down_read(&zram->init_lock);
 	ret = scnprintf(buf, PAGE_SIZE,
-			"%8llu %8llu %8llu %8llu\n",
+			"%8llu %8llu %8llu %8llu %8llu %8llu %8llu %8llu\n",
 			(u64)atomic64_read(&zram->stats.failed_reads),
 			(u64)atomic64_read(&zram->stats.failed_writes),
 			(u64)atomic64_read(&zram->stats.invalid_io),
-			(u64)atomic64_read(&zram->stats.notify_free));
+			(u64)atomic64_read(&zram->stats.notify_free),
+			(u64)atomic64_read(&zram->stats.batch_writes),
+			(u64)atomic64_read(&zram->stats.batch_pages),
+			(u64)atomic64_read(&zram->stats.batch_parallel),
+			(u64)atomic64_read(&zram->stats.batch_fallback));
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -738,14 +792,19 @@ static ssize_t mm_stat_show(struct device *dev,
 	max_used = atomic_long_read(&zram->stats.max_used_pages);
 
 	ret = scnprintf(buf, PAGE_SIZE,
-			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu\n",
+			"%8llu %8llu %8llu %8lu %8ld %8llu %8lu %8llu %8llu %8llu %8llu %8llu\n",
 			orig_size << PAGE_SHIFT,
 			(u64)atomic64_read(&zram->stats.compr_data_size),
 			mem_used << PAGE_SHIFT,
 			zram->limit_pages << PAGE_SHIFT,
 			max_used << PAGE_SHIFT,
 			(u64)atomic64_read(&zram->stats.same_pages),
-			pool_stats.pages_compacted);
+			pool_stats.pages_compacted,
+			(u64)atomic64_read(&zram->stats.recomp_pages),
+			(u64)atomic64_read(&zram->stats.recomp_data_size),
+			(u64)atomic64_read(&zram->stats.recomp_saved),
+			(u64)atomic64_read(&zram->stats.dup_pages),
+			(u64)atomic64_read(&zram->stats.dup_data_size));
 	up_read(&zram->init_lock);
 
 	return ret;
@@ -791,6 +850,7 @@ static void zram_meta_free(struct zram *zram, u64 disksize)
 	for (index = 0; index < num_pages; index++)
 		zram_free_page(zram, index);
 
+	zram_dedup_fini(zram);
 	zs_destroy_pool(zram->mem_pool);
 	vfree(zram->table);
 }
@@ -810,6 +870,12 @@ static bool zram_meta_alloc(struct zram *zram, u64 disksize)
 		return false;
 	}
 
+	if (!zram_dedup_init(zram, num_pages)) {
+		zs_destroy_pool(zram->mem_pool);
+		vfree(zram->table);
+		return false;
+	}
+
 	return true;
 }
 
@@ -840,12 +906,36 @@ static void zram_free_page(struct zram *zram, size_t index)
 		return;
 	}
 
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+
 	handle = zram_get_handle(zram, index);
 	if (!handle)
 		return;
 
+	if (zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		size_t size = zram_get_obj_size(zram, index);
+
+		zram_clear_flag(zram, index, ZRAM_DEDUP);
+		if (!zram_dedup_put(zram, handle, size)) {
+			/* the object is still used by other pages */
+			atomic64_dec(&zram->stats.dup_pages);
+			atomic64_sub(size, &zram->stats.dup_data_size);
+			atomic64_dec(&zram->stats.pages_stored);
+			zram_set_handle(zram, index, 0);
+			zram_set_obj_size(zram, index, 0);
+			return;
+		}
+	}
+
 	zs_free(zram->mem_pool, handle);
 
+	if (zram_test_flag(zram, index, ZRAM_RECOMP)) {
+		zram_clear_flag(zram, index, ZRAM_RECOMP);
+		atomic64_dec(&zram->stats.recomp_pages);
+		atomic64_sub(zram_get_obj_size(zram, index),
+				&zram->stats.recomp_data_size);
+	}
+
 	atomic64_sub(zram_get_obj_size(zram, index),
 			&zram->stats.compr_data_size);
 	atomic64_dec(&zram->stats.pages_stored);
@@ -872,6 +962,7 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 			bvec.bv_page = page;
 			bvec.bv_len = PAGE_SIZE;
 			bvec.bv_offset = 0;
+			atomic64_inc(&zram->stats.bd_reads);
 			return read_from_bdev(zram, &bvec,
 					zram_get_element(zram, index),
 					bio, partial_io);
@@ -880,6 +971,7 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 	}
 
 	zram_slot_lock(zram, index);
+	zram_clear_flag(zram, index, ZRAM_IDLE);
 	handle = zram_get_handle(zram, index);
 	if (!handle || zram_test_flag(zram, index, ZRAM_SAME)) {
 		unsigned long value;
@@ -902,12 +994,14 @@ static int __zram_bvec_read(struct zram *zram, struct page *page, u32 index,
 		kunmap_atomic(dst);
 		ret = 0;
 	} else {
-		struct zcomp_strm *zstrm = zcomp_stream_get(zram->comp);
+		struct zcomp *comp = zram_test_flag(zram, index, ZRAM_RECOMP) ?
+					zram->recomp : zram->comp;
+		struct zcomp_strm *zstrm = zcomp_stream_get(comp);
 
 		dst = kmap_atomic(page);
 		ret = zcomp_decompress(zstrm, src, size, dst);
 		kunmap_atomic(dst);
-		zcomp_stream_put(zram->comp);
+		zcomp_stream_put(comp);
 	}
 	/* Should NEVER happen. BUG() if it does. */
 	if (unlikely(ret)) {
@@ -966,7 +1060,8 @@ static int __zram_bvec_write(struct zram *zram, struct bio_vec *bvec,
 	struct page *page = bvec->bv_page;
 	unsigned long element = 0;
 	enum zram_pageflags flags = 0;
-	bool allow_wb = true;
+	bool dedup = false;
+	u32 checksum = 0;
 
 	mem = kmap_atomic(page);
 	if (page_same_filled(mem, &element)) {
@@ -991,19 +1086,35 @@ compress_again:
 		return ret;
 	}
 
-	if (unlikely(comp_len > max_zpage_size)) {
-		if (zram_wb_enabled(zram) && allow_wb) {
+	/*
+	 * Incompressible pages are stored as they are and can be written
+	 * back to the backing device later by writeback_store().
+	 */
+	if (unlikely(comp_len > max_zpage_size))
+		comp_len = PAGE_SIZE;
+
+	if (zram_dedup_enabled(zram)) {
+		unsigned long dup;
+
+		src = zstrm->buffer;
+		if (comp_len == PAGE_SIZE)
+			src = kmap_atomic(page);
+		checksum = zram_dedup_checksum(src, comp_len);
+		dup = zram_dedup_find(zram, src, comp_len, checksum);
+		if (comp_len == PAGE_SIZE)
+			kunmap_atomic(src);
+
+		if (dup) {
 			zcomp_stream_put(zram->comp);
-			ret = write_to_bdev(zram, bvec, index, bio, &element);
-			if (!ret) {
-				flags = ZRAM_WB;
-				ret = 1;
-				goto out;
-			}
-			allow_wb = false;
-			goto compress_again;
+			/* allocated by the slow path */
+			if (handle)
+				zs_free(zram->mem_pool, handle);
+			handle = dup;
+			dedup = true;
+			atomic64_inc(&zram->stats.dup_pages);
+			atomic64_add(comp_len, &zram->stats.dup_data_size);
+			goto out;
 		}
-		comp_len = PAGE_SIZE;
 	}
 
 	/*
@@ -1058,6 +1169,9 @@ compress_again:
 	zcomp_stream_put(zram->comp);
 	zs_unmap_object(zram->mem_pool, handle);
 	atomic64_add(comp_len, &zram->stats.compr_data_size);
+
+	if (zram_dedup_enabled(zram))
+		dedup = zram_dedup_insert(zram, handle, comp_len, checksum);
 out:
 	/*
 	 * Free memory associated with this sector
@@ -1072,6 +1186,8 @@ out:
 	}  else {
 		zram_set_handle(zram, index, handle);
 		zram_set_obj_size(zram, index, comp_len);
+		if (dedup)
+			zram_set_flag(zram, index, ZRAM_DEDUP);
 	}
 	zram_slot_unlock(zram, index);
 
@@ -1196,9 +1312,259 @@ static int zram_bvec_rw(struct zram *zram, struct bio_vec *bvec, u32 index,
 	return ret;
 }
 
+/*
+ * Compresses pages of @slot and stores them in newly allocated handles.
+ * Only the allocation without direct reclaim is tried here. Pages which
+ * need the slow path are marked to be redone by __zram_bvec_write().
+ */
+static void zram_batch_compress(struct zram *zram,
+				struct zram_batch_slot *slot, int nr)
+{
+	struct zcomp_strm *zstrm;
+	void *src, *dst, *mem;
+	int i, ret;
+
+	for (i = 0; i < nr; i++, slot++) {
+		slot->handle = 0;
+		slot->element = 0;
+		slot->comp_len = 0;
+
+		mem = kmap_atomic(slot->page);
+		if (page_same_filled(mem, &slot->element)) {
+			kunmap_atomic(mem);
+			slot->ret = 1;
+			continue;
+		}
+		kunmap_atomic(mem);
+
+		zstrm = zcomp_stream_get(zram->comp);
+		src = kmap_atomic(slot->page);
+		ret = zcomp_compress(zstrm, src, &slot->comp_len);
+		kunmap_atomic(src);
+
+		if (unlikely(ret)) {
+			zcomp_stream_put(zram->comp);
+			slot->ret = ret;
+			continue;
+		}
+
+		if (unlikely(slot->comp_len > max_zpage_size))
+			slot->comp_len = PAGE_SIZE;
+
+		slot->handle = zs_malloc(zram->mem_pool, slot->comp_len,
+				__GFP_KSWAPD_RECLAIM |
+				__GFP_NOWARN |
+				__GFP_HIGHMEM |
+				__GFP_MOVABLE);
+		if (!slot->handle) {
+			zcomp_stream_put(zram->comp);
+			slot->ret = -ENOMEM;
+			continue;
+		}
+
+		dst = zs_map_object(zram->mem_pool, slot->handle, ZS_MM_WO);
+
+		src = zstrm->buffer;
+		if (slot->comp_len == PAGE_SIZE)
+			src = kmap_atomic(slot->page);
+		memcpy(dst, src, slot->comp_len);
+		if (slot->comp_len == PAGE_SIZE)
+			kunmap_atomic(src);
+
+		zcomp_stream_put(zram->comp);
+		zs_unmap_object(zram->mem_pool, slot->handle);
+		slot->ret = 0;
+	}
+}
+
+static void zram_batch_work_fn(struct work_struct *work)
+{
+	struct zram_batch_work *bw = container_of(work,
+					struct zram_batch_work, work);
+	struct zram_batch *batch = &bw->zram->batch;
+
+	zram_batch_compress(bw->zram, bw->slot, bw->nr);
+
+	if (atomic_dec_and_test(&batch->pending))
+		complete(&batch->done);
+}
+
+/*
+ * Slices except the first one are handed to idle cpus, each of which uses
+ * its own per-cpu stream. Slices without an idle cpu and the first one are
+ * compressed by the caller.
+ */
+static void zram_batch_run(struct zram *zram, int nr)
+{
+	struct zram_batch *batch = &zram->batch;
+	int this_cpu = raw_smp_processor_id();
+	int nr_slice, first, queued = 0, i;
+	int cpu = -1;
+
+	nr_slice = nr < ZRAM_BATCH_PARALLEL_MIN ? 1 :
+			DIV_ROUND_UP(nr, ZRAM_BATCH_SLICE);
+	first = nr_slice == 1 ? nr : ZRAM_BATCH_SLICE;
+
+	atomic_set(&batch->pending, 1);
+	reinit_completion(&batch->done);
+
+	for (i = 1; i < nr_slice; i++) {
+		struct zram_batch_work *bw = &batch->work[i];
+
+		do {
+			cpu = cpumask_next(cpu, cpu_online_mask);
+		} while (cpu < nr_cpu_ids && (cpu == this_cpu || !idle_cpu(cpu)));
+
+		if (cpu >= nr_cpu_ids)
+			break;
+
+		bw->slot = &batch->slot[i * ZRAM_BATCH_SLICE];
+		bw->nr = min(nr - i * ZRAM_BATCH_SLICE, ZRAM_BATCH_SLICE);
+		atomic_inc(&batch->pending);
+		queue_work_on(cpu, system_highpri_wq, &bw->work);
+		queued++;
+	}
+
+	/* the first slice and the slices no idle cpu was found for */
+	zram_batch_compress(zram, batch->slot, first);
+	if (i < nr_slice)
+		zram_batch_compress(zram, &batch->slot[i * ZRAM_BATCH_SLICE],
+				    nr - i * ZRAM_BATCH_SLICE);
+
+	if (!atomic_dec_and_test(&batch->pending))
+		wait_for_completion(&batch->done);
+
+	if (queued)
+		atomic64_inc(&zram->stats.batch_parallel);
+}
+
+/*
+ * Stores compressed pages to the table. zs_malloc() pool usage is updated
+ * once per batch.
+ */
+static int zram_batch_commit(struct zram *zram, int nr, struct bio *bio)
+{
+	struct zram_batch_slot *slot = zram->batch.slot;
+	unsigned long alloced_pages;
+	u64 compr_size = 0;
+	int i, ret = 0;
+
+	alloced_pages = zs_get_total_pages(zram->mem_pool);
+	zram_pool_total_size = alloced_pages << PAGE_SHIFT;
+	update_used_max(zram, alloced_pages);
+
+	if (zram->limit_pages && alloced_pages > zram->limit_pages) {
+		for (i = 0; i < nr; i++)
+			zs_free(zram->mem_pool, slot[i].handle);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < nr; i++, slot++) {
+		if (slot->ret < 0) {
+			struct bio_vec bv = {
+				.bv_page = slot->page,
+				.bv_len = PAGE_SIZE,
+				.bv_offset = 0,
+			};
+
+			atomic64_inc(&zram->stats.batch_fallback);
+			ret = __zram_bvec_write(zram, &bv, slot->index, bio);
+			if (ret < 0)
+				break;
+			continue;
+		}
+
+		/*
+		 * Free memory associated with this sector
+		 * before overwriting unused sectors.
+		 */
+		zram_slot_lock(zram, slot->index);
+		zram_free_page(zram, slot->index);
+
+		if (slot->ret) {
+			zram_set_flag(zram, slot->index, ZRAM_SAME);
+			zram_set_element(zram, slot->index, slot->element);
+			atomic64_inc(&zram->stats.same_pages);
+		} else {
+			zram_set_handle(zram, slot->index, slot->handle);
+			zram_set_obj_size(zram, slot->index, slot->comp_len);
+			compr_size += slot->comp_len;
+		}
+		zram_slot_unlock(zram, slot->index);
+
+		atomic64_inc(&zram->stats.pages_stored);
+	}
+
+	/* release handles of pages we did not get to */
+	for (i++, slot++; i < nr; i++, slot++)
+		zs_free(zram->mem_pool, slot->handle);
+
+	atomic64_add(compr_size, &zram->stats.compr_data_size);
+
+	return ret < 0 ? ret : 0;
+}
+
+/*
+ * Batched write path for bios of full pages, which is what swap-out under
+ * reclaim issues. Returns -EAGAIN if the bio should go page by page.
+ */
+static int zram_batch_write(struct zram *zram, struct bio *bio, u32 index)
+{
+	struct zram_batch *batch = &zram->batch;
+	struct request_queue *q = zram->disk->queue;
+	struct bio_vec bvec;
+	struct bvec_iter iter;
+	unsigned long start_time;
+	int nr = 0, ret = 0;
+
+	if (bio->bi_iter.bi_size < 2 * PAGE_SIZE)
+		return -EAGAIN;
+
+	bio_for_each_segment(bvec, bio, iter)
+		if (bvec.bv_offset || bvec.bv_len != PAGE_SIZE)
+			return -EAGAIN;
+
+	/* another writer is batching, go page by page */
+	if (!mutex_trylock(&batch->lock))
+		return -EAGAIN;
+
+	bio_for_each_segment(bvec, bio, iter) {
+		batch->slot[nr].page = bvec.bv_page;
+		batch->slot[nr].index = index++;
+
+		if (++nr < ZRAM_BATCH_PAGES &&
+		    iter.bi_size > bvec.bv_len)
+			continue;
+
+		start_time = jiffies;
+		generic_start_io_acct(q, REQ_OP_WRITE,
+				nr << SECTORS_PER_PAGE_SHIFT, &zram->disk->part0);
+		atomic64_add(nr, &zram->stats.num_writes);
+
+		zram_batch_run(zram, nr);
+		ret = zram_batch_commit(zram, nr, bio);
+
+		generic_end_io_acct(q, REQ_OP_WRITE, &zram->disk->part0,
+				start_time);
+
+		atomic64_inc(&zram->stats.batch_writes);
+		atomic64_add(nr, &zram->stats.batch_pages);
+
+		if (ret < 0) {
+			atomic64_inc(&zram->stats.failed_writes);
+			break;
+		}
+		nr = 0;
+	}
+
+	mutex_unlock(&batch->lock);
+
+	return ret;
+}
+
 static void __zram_make_request(struct zram *zram, struct bio *bio)
 {
-	int offset;
+	int offset, ret;
 	u32 index;
 	struct bio_vec bvec;
 	struct bvec_iter iter;
@@ -1213,6 +1579,17 @@ static void __zram_make_request(struct zram *zram, struct bio *bio)
 		zram_bio_discard(zram, index, offset, bio);
 		bio_endio(bio);
 		return;
+	case REQ_OP_WRITE:
+		if (offset)
+			break;
+
+		ret = zram_batch_write(zram, bio, index);
+		if (ret == -EAGAIN)
+			break;
+		if (ret < 0)
+			goto out;
+		bio_endio(bio);
+		return;
 	default:
 		break;
 	}
@@ -1327,11 +1704,469 @@ out:
 	return ret;
 }
 
+/*
+ * Recompresses the slot at @index with the secondary algorithm. The slot
+ * is decompressed into @page under the slot lock and compressed again
+ * without it, so the slot is replaced only if it was neither rewritten
+ * nor read meanwhile.
+ */
+static void zram_recompress_slot(struct zram *zram, u32 index,
+				 struct page *page)
+{
+	unsigned long handle, new_handle;
+	unsigned int size, new_size;
+	struct zcomp_strm *zstrm;
+	void *src, *dst;
+	int ret = 0;
+
+	zram_slot_lock(zram, index);
+	handle = zram_get_handle(zram, index);
+	if (!handle || zram_test_flag(zram, index, ZRAM_SAME) ||
+	    zram_test_flag(zram, index, ZRAM_WB) ||
+	    zram_test_flag(zram, index, ZRAM_RECOMP) ||
+	    zram_test_flag(zram, index, ZRAM_DEDUP)) {
+		zram_slot_unlock(zram, index);
+		return;
+	}
+
+	/* give a second chance to the slot read since the last scan */
+	if (!zram_test_flag(zram, index, ZRAM_IDLE)) {
+		zram_set_flag(zram, index, ZRAM_IDLE);
+		zram_slot_unlock(zram, index);
+		return;
+	}
+
+	size = zram_get_obj_size(zram, index);
+	src = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
+	dst = kmap_atomic(page);
+	if (size == PAGE_SIZE) {
+		memcpy(dst, src, PAGE_SIZE);
+	} else {
+		zstrm = zcomp_stream_get(zram->comp);
+		ret = zcomp_decompress(zstrm, src, size, dst);
+		zcomp_stream_put(zram->comp);
+	}
+	kunmap_atomic(dst);
+	zs_unmap_object(zram->mem_pool, handle);
+	zram_slot_unlock(zram, index);
+
+	if (unlikely(ret))
+		return;
+
+	zstrm = zcomp_stream_get(zram->recomp);
+	src = kmap_atomic(page);
+	ret = zcomp_compress(zstrm, src, &new_size);
+	kunmap_atomic(src);
+
+	if (ret || new_size > max_zpage_size || new_size >= size ||
+	    (size - new_size) * 100 < size * zram->recomp_threshold) {
+		zcomp_stream_put(zram->recomp);
+		return;
+	}
+
+	/* never reclaim for a background job */
+	new_handle = zs_malloc(zram->mem_pool, new_size,
+			__GFP_NOWARN | __GFP_HIGHMEM | __GFP_MOVABLE);
+	if (!new_handle) {
+		zcomp_stream_put(zram->recomp);
+		return;
+	}
+
+	dst = zs_map_object(zram->mem_pool, new_handle, ZS_MM_WO);
+	memcpy(dst, zstrm->buffer, new_size);
+	zcomp_stream_put(zram->recomp);
+	zs_unmap_object(zram->mem_pool, new_handle);
+
+	zram_slot_lock(zram, index);
+	if (zram_get_handle(zram, index) != handle ||
+	    !zram_test_flag(zram, index, ZRAM_IDLE)) {
+		zram_slot_unlock(zram, index);
+		zs_free(zram->mem_pool, new_handle);
+		return;
+	}
+
+	zs_free(zram->mem_pool, handle);
+	zram_set_handle(zram, index, new_handle);
+	zram_set_obj_size(zram, index, new_size);
+	zram_set_flag(zram, index, ZRAM_RECOMP);
+	zram_slot_unlock(zram, index);
+
+	atomic64_sub(size - new_size, &zram->stats.compr_data_size);
+	atomic64_inc(&zram->stats.recomp_pages);
+	atomic64_add(new_size, &zram->stats.recomp_data_size);
+	atomic64_add(size - new_size, &zram->stats.recomp_saved);
+}
+
+/*
+ * Deferrable work, so the scan runs only while the cpu is awake for
+ * something else and does not wake up an idle system.
+ */
+static void zram_recomp_work_fn(struct work_struct *work)
+{
+	struct zram *zram = container_of(to_delayed_work(work),
+					struct zram, recomp_work);
+	unsigned long nr_slots, i;
+	struct page *page;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram->recomp) {
+		up_read(&zram->init_lock);
+		return;
+	}
+
+	page = alloc_page(GFP_KERNEL | __GFP_HIGHMEM | __GFP_NOWARN);
+	if (!page)
+		goto out;
+
+	nr_slots = zram->disksize >> PAGE_SHIFT;
+	for (i = 0; i < ZRAM_RECOMP_BATCH; i++) {
+		if (zram->recomp_cursor >= nr_slots)
+			zram->recomp_cursor = 0;
+
+		zram_recompress_slot(zram, zram->recomp_cursor++, page);
+		cond_resched();
+	}
+
+	__free_page(page);
+out:
+	queue_delayed_work(system_power_efficient_wq, &zram->recomp_work,
+				msecs_to_jiffies(ZRAM_RECOMP_INTERVAL_MS));
+	up_read(&zram->init_lock);
+}
+
+#ifdef CONFIG_ZRAM_WRITEBACK
+enum zram_wb_mode {
+	ZRAM_WB_IDLE,	/* slots not read since marked by idle_store() */
+	ZRAM_WB_HUGE,	/* incompressible slots */
+};
+
+/*
+ * User marks every stored slot idle as below and the flag is cleared when
+ * the slot is read:
+ *
+ * #echo all > /sys/block/zramX/idle
+ */
+static ssize_t idle_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long nr_pages, index;
+
+	if (!sysfs_streq(buf, "all"))
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram)) {
+		up_read(&zram->init_lock);
+		return -EINVAL;
+	}
+
+	nr_pages = zram->disksize >> PAGE_SHIFT;
+	for (index = 0; index < nr_pages; index++) {
+		zram_slot_lock(zram, index);
+		if (zram_get_handle(zram, index) &&
+		    !zram_test_flag(zram, index, ZRAM_WB))
+			zram_set_flag(zram, index, ZRAM_IDLE);
+		zram_slot_unlock(zram, index);
+	}
+	up_read(&zram->init_lock);
+
+	return len;
+}
+
+/* Returns the number of pages allowed to write back for today */
+static unsigned long zram_wb_budget(struct zram *zram)
+{
+	if (!zram->wb_limit)
+		return ULONG_MAX;
+
+	if (time_after(jiffies, zram->wb_day_start + 24 * 60 * 60 * HZ)) {
+		zram->wb_day_start = jiffies;
+		zram->wb_day_pages = 0;
+	}
+
+	return zram->wb_limit > zram->wb_day_pages ?
+		zram->wb_limit - zram->wb_day_pages : 0;
+}
+
+/* Allocates up to @nr consecutive entries, returns the first one */
+static unsigned long get_entries_bdev(struct zram *zram, unsigned int *nr)
+{
+	unsigned long entry;
+
+	spin_lock(&zram->bitmap_lock);
+	while (*nr) {
+		/* skip 0 bit to confuse zram.handle = 0 */
+		entry = bitmap_find_next_zero_area(zram->bitmap, zram->nr_pages,
+						   1, *nr, 0);
+		if (entry < zram->nr_pages) {
+			bitmap_set(zram->bitmap, entry, *nr);
+			spin_unlock(&zram->bitmap_lock);
+			return entry;
+		}
+		*nr >>= 1;
+	}
+	spin_unlock(&zram->bitmap_lock);
+
+	return 0;
+}
+
+/* Copies out the uncompressed data of a writeback candidate */
+static bool zram_wb_read_slot(struct zram *zram, u32 index, int mode,
+			      struct page *page, unsigned long *phandle)
+{
+	unsigned long handle;
+	unsigned int size;
+	void *src, *dst;
+	int ret = 0;
+
+	zram_slot_lock(zram, index);
+	handle = zram_get_handle(zram, index);
+	if (!handle || zram_test_flag(zram, index, ZRAM_SAME) ||
+	    zram_test_flag(zram, index, ZRAM_WB))
+		goto skip;
+
+	size = zram_get_obj_size(zram, index);
+	if (mode == ZRAM_WB_IDLE && !zram_test_flag(zram, index, ZRAM_IDLE))
+		goto skip;
+	if (mode == ZRAM_WB_HUGE && size != PAGE_SIZE)
+		goto skip;
+
+	src = zs_map_object(zram->mem_pool, handle, ZS_MM_RO);
+	dst = kmap_atomic(page);
+	if (size == PAGE_SIZE) {
+		memcpy(dst, src, PAGE_SIZE);
+	} else {
+		struct zcomp *comp = zram_test_flag(zram, index, ZRAM_RECOMP) ?
+					zram->recomp : zram->comp;
+		struct zcomp_strm *zstrm = zcomp_stream_get(comp);
+
+		ret = zcomp_decompress(zstrm, src, size, dst);
+		zcomp_stream_put(comp);
+	}
+	kunmap_atomic(dst);
+	zs_unmap_object(zram->mem_pool, handle);
+	zram_slot_unlock(zram, index);
+
+	*phandle = handle;
+	return !ret;
+skip:
+	zram_slot_unlock(zram, index);
+	return false;
+}
+
+/*
+ * Writes @nr collected pages with one bio to consecutive entries and
+ * replaces the slots which were not changed during the I/O.
+ */
+static int zram_wb_flush(struct zram *zram, struct page **pages,
+			 u32 *indices, unsigned long *handles, unsigned int nr)
+{
+	unsigned long entry;
+	unsigned int i, done = 0;
+	struct bio *bio;
+	int ret;
+
+	while (done < nr) {
+		unsigned int count = nr - done;
+
+		entry = get_entries_bdev(zram, &count);
+		if (!entry)
+			return -ENOSPC;
+
+		bio = bio_alloc(GFP_KERNEL, count);
+		bio->bi_iter.bi_sector = entry * (PAGE_SIZE >> 9);
+		bio_set_dev(bio, zram->bdev);
+		bio->bi_opf = REQ_OP_WRITE | REQ_SYNC;
+		for (i = 0; i < count; i++)
+			bio_add_page(bio, pages[done + i], PAGE_SIZE, 0);
+
+		ret = submit_bio_wait(bio);
+		bio_put(bio);
+		if (ret) {
+			for (i = 0; i < count; i++)
+				put_entry_bdev(zram, entry + i);
+			return ret;
+		}
+
+		for (i = 0; i < count; i++) {
+			u32 index = indices[done + i];
+
+			zram_slot_lock(zram, index);
+			if (zram_get_handle(zram, index) != handles[done + i] ||
+			    zram_test_flag(zram, index, ZRAM_WB) ||
+			    (zram->wb_mode == ZRAM_WB_IDLE &&
+			     !zram_test_flag(zram, index, ZRAM_IDLE))) {
+				/* rewritten or read meanwhile */
+				zram_slot_unlock(zram, index);
+				put_entry_bdev(zram, entry + i);
+				continue;
+			}
+
+			zram_free_page(zram, index);
+			zram_set_flag(zram, index, ZRAM_WB);
+			zram_set_element(zram, index, entry + i);
+			atomic64_inc(&zram->stats.pages_stored);
+			zram_slot_unlock(zram, index);
+
+			atomic64_inc(&zram->stats.bd_count);
+			atomic64_inc(&zram->stats.bd_writes);
+			zram->wb_day_pages++;
+		}
+
+		done += count;
+	}
+
+	return 0;
+}
+
+static void zram_wb_work_fn(struct work_struct *work)
+{
+	struct zram *zram = container_of(work, struct zram, wb_work);
+	struct page *pages[ZRAM_WB_BATCH];
+	unsigned long handles[ZRAM_WB_BATCH];
+	u32 indices[ZRAM_WB_BATCH];
+	unsigned long nr_slots, index, budget;
+	unsigned int nr = 0, i;
+	int ret = 0;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram_wb_enabled(zram))
+		goto out;
+
+	for (i = 0; i < ZRAM_WB_BATCH; i++) {
+		pages[i] = alloc_page(GFP_KERNEL);
+		if (!pages[i])
+			goto free_pages;
+	}
+
+	budget = zram_wb_budget(zram);
+	nr_slots = zram->disksize >> PAGE_SHIFT;
+
+	for (index = 0; index < nr_slots && budget; index++) {
+		if (!zram_wb_read_slot(zram, index, zram->wb_mode,
+				       pages[nr], &handles[nr]))
+			continue;
+
+		indices[nr++] = index;
+		budget--;
+
+		if (nr < ZRAM_WB_BATCH && budget)
+			continue;
+
+		ret = zram_wb_flush(zram, pages, indices, handles, nr);
+		nr = 0;
+		if (ret)
+			break;
+		cond_resched();
+	}
+
+	if (nr && !ret)
+		ret = zram_wb_flush(zram, pages, indices, handles, nr);
+
+	if (ret)
+		pr_info("writeback stopped(%d)\n", ret);
+
+free_pages:
+	while (i--)
+		__free_page(pages[i]);
+out:
+	up_read(&zram->init_lock);
+}
+
+/*
+ * Writeback is triggered as below and done in background with sequential
+ * bios of up to ZRAM_WB_BATCH pages:
+ *
+ * #echo idle > /sys/block/zramX/writeback
+ * #echo huge > /sys/block/zramX/writeback
+ */
+static ssize_t writeback_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	int mode;
+
+	if (sysfs_streq(buf, "idle"))
+		mode = ZRAM_WB_IDLE;
+	else if (sysfs_streq(buf, "huge"))
+		mode = ZRAM_WB_HUGE;
+	else
+		return -EINVAL;
+
+	down_read(&zram->init_lock);
+	if (!init_done(zram) || !zram_wb_enabled(zram)) {
+		up_read(&zram->init_lock);
+		return -EINVAL;
+	}
+
+	if (!work_pending(&zram->wb_work)) {
+		zram->wb_mode = mode;
+		queue_work(system_unbound_wq, &zram->wb_work);
+	}
+	up_read(&zram->init_lock);
+
+	return len;
+}
+
+static ssize_t writeback_limit_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%lu\n", zram->wb_limit);
+}
+
+/*
+ * Limits the number of pages written back per day,
+ * e.g. 256MB per day of 4K page is as below. 0 means unlimited.
+ *
+ * #echo 65536 > /sys/block/zramX/writeback_limit
+ */
+static ssize_t writeback_limit_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	unsigned long limit;
+	int ret;
+
+	ret = kstrtoul(buf, 10, &limit);
+	if (ret)
+		return ret;
+
+	zram->wb_limit = limit;
+	return len;
+}
+
+static ssize_t bd_stat_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	ssize_t ret;
+
+	down_read(&zram->init_lock);
+	ret = scnprintf(buf, PAGE_SIZE,
+			"%8llu %8llu %8llu %8lu\n",
+			(u64)atomic64_read(&zram->stats.bd_count),
+			(u64)atomic64_read(&zram->stats.bd_reads),
+			(u64)atomic64_read(&zram->stats.bd_writes),
+			zram->wb_day_pages);
+	up_read(&zram->init_lock);
+
+	return ret;
+}
+#endif
+
 static void zram_reset_device(struct zram *zram)
 {
-	struct zcomp *comp;
+	struct zcomp *comp, *recomp;
 	u64 disksize;
 
+	cancel_delayed_work_sync(&zram->recomp_work);
+#ifdef CONFIG_ZRAM_WRITEBACK
+	cancel_work_sync(&zram->wb_work);
+#endif
+
 	down_write(&zram->init_lock);
 
 	zram->limit_pages = 0;
@@ -1342,6 +2177,9 @@ static void zram_reset_device(struct zram *zram)
 	}
 
 	comp = zram->comp;
+	recomp = zram->recomp;
+	zram->recomp = NULL;
+	zram->recomp_cursor = 0;
 	disksize = zram->disksize;
 	zram->disksize = 0;
 
@@ -1353,6 +2191,8 @@ static void zram_reset_device(struct zram *zram)
 	zram_meta_free(zram, disksize);
 	memset(&zram->stats, 0, sizeof(zram->stats));
 	zcomp_destroy(comp);
+	if (recomp)
+		zcomp_destroy(recomp);
 	reset_bdev(zram);
 }
 
@@ -1389,6 +2229,20 @@ static ssize_t disksize_store(struct device *dev,
 		goto out_free_meta;
 	}
 
+	if (zram->recompressor[0]) {
+		zram->recomp = zcomp_create(zram->recompressor);
+		if (IS_ERR(zram->recomp)) {
+			pr_err("Cannot initialise %s recompressing backend\n",
+					zram->recompressor);
+			err = PTR_ERR(zram->recomp);
+			zram->recomp = NULL;
+			goto out_free_comp;
+		}
+		queue_delayed_work(system_power_efficient_wq,
+				&zram->recomp_work,
+				msecs_to_jiffies(ZRAM_RECOMP_INTERVAL_MS));
+	}
+
 	zram->comp = comp;
 	zram->disksize = disksize;
 	set_capacity(zram->disk, zram->disksize >> SECTOR_SHIFT);
@@ -1397,6 +2251,8 @@ static ssize_t disksize_store(struct device *dev,
 
 	return len;
 
+out_free_comp:
+	zcomp_destroy(comp);
 out_free_meta:
 	zram_meta_free(zram, disksize);
 out_unlock:
@@ -1479,8 +2335,17 @@ static DEVICE_ATTR_WO(mem_limit);
 static DEVICE_ATTR_WO(mem_used_max);
 static DEVICE_ATTR_RW(max_comp_streams);
 static DEVICE_ATTR_RW(comp_algorithm);
+static DEVICE_ATTR_RW(recomp_algorithm);
+static DEVICE_ATTR_RW(recomp_threshold);
+#ifdef CONFIG_ZRAM_DEDUP
+static DEVICE_ATTR_RW(use_dedup);
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 static DEVICE_ATTR_RW(backing_dev);
+static DEVICE_ATTR_WO(idle);
+static DEVICE_ATTR_WO(writeback);
+static DEVICE_ATTR_RW(writeback_limit);
+static DEVICE_ATTR_RO(bd_stat);
 #endif
 
 static struct attribute *zram_disk_attrs[] = {
@@ -1492,8 +2357,17 @@ static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_mem_used_max.attr,
 	&dev_attr_max_comp_streams.attr,
 	&dev_attr_comp_algorithm.attr,
+	&dev_attr_recomp_algorithm.attr,
+	&dev_attr_recomp_threshold.attr,
+#ifdef CONFIG_ZRAM_DEDUP
+	&dev_attr_use_dedup.attr,
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 	&dev_attr_backing_dev.attr,
+	&dev_attr_idle.attr,
+	&dev_attr_writeback.attr,
+	&dev_attr_writeback_limit.attr,
+	&dev_attr_bd_stat.attr,
 #endif
 	&dev_attr_io_stat.attr,
 	&dev_attr_mm_stat.attr,
@@ -1518,7 +2392,7 @@ static int zram_add(void)
 {
 	struct zram *zram;
 	struct request_queue *queue;
-	int ret, device_id;
+	int ret, device_id, i;
 
 	zram = kzalloc(sizeof(struct zram), GFP_KERNEL);
 	if (!zram)
@@ -1531,6 +2405,19 @@ static int zram_add(void)
 
 	init_rwsem(&zram->init_lock);
 
+	zram->recomp_threshold = ZRAM_RECOMP_THRESHOLD;
+#ifdef CONFIG_ZRAM_WRITEBACK
+	INIT_WORK(&zram->wb_work, zram_wb_work_fn);
+#endif
+	INIT_DEFERRABLE_WORK(&zram->recomp_work, zram_recomp_work_fn);
+
+	mutex_init(&zram->batch.lock);
+	init_completion(&zram->batch.done);
+	for (i = 0; i < ZRAM_BATCH_WORKERS; i++) {
+		zram->batch.work[i].zram = zram;
+		INIT_WORK(&zram->batch.work[i].work, zram_batch_work_fn);
+	}
+
 	queue = blk_alloc_queue(GFP_KERNEL);
 	if (!queue) {
 		pr_err("Error allocating disk queue for device %d\n",
@@ -16,6 +16,9 @@
 #define _ZRAM_DRV_H_
 
 #include <linux/rwsem.h>
+#include <linux/mutex.h>
+#include <linux/completion.h>
+#include <linux/workqueue.h>
 #include <linux/zsmalloc.h>
 #include <linux/crypto.h>
 
@@ -35,6 +38,27 @@ static const size_t max_zpage_size = PAGE_SIZE / 4 * 3;
  * always return failure.
  */
 
+/*
+ * Full page writes of a bio are compressed in batches of up to
+ * ZRAM_BATCH_PAGES. A batch with at least ZRAM_BATCH_PARALLEL_MIN pages is
+ * split into slices of ZRAM_BATCH_SLICE pages compressed on idle cpus.
+ */
+#define ZRAM_BATCH_PAGES	32
+#define ZRAM_BATCH_SLICE	4
+#define ZRAM_BATCH_PARALLEL_MIN	8
+#define ZRAM_BATCH_WORKERS	(ZRAM_BATCH_PAGES / ZRAM_BATCH_SLICE)
+
+/*
+ * Slots not read for a whole scan period are recompressed with the
+ * secondary algorithm if it saves more than recomp_threshold percent.
+ */
+#define ZRAM_RECOMP_INTERVAL_MS	1000
+#define ZRAM_RECOMP_BATCH	512
+#define ZRAM_RECOMP_THRESHOLD	20
+
+/* Pages written back to the backing device in one sequential bio */
+#define ZRAM_WB_BATCH		32
+
 /*-- End of configurable params */
 
 #define SECTOR_SHIFT		9
@@ -64,6 +88,9 @@ enum zram_pageflags {
 	ZRAM_SAME = ZRAM_FLAG_SHIFT,
 	ZRAM_ACCESS,	/* page is now accessed */
 	ZRAM_WB,	/* page is stored on backing_device */
+	ZRAM_IDLE,	/* page is not read since the last recompress scan */
+	ZRAM_RECOMP,	/* page is compressed with the secondary algorithm */
+	ZRAM_DEDUP,	/* page object is refcounted by the dedup table */
 
 	__NR_ZRAM_PAGEFLAGS,
 };
@@ -91,6 +118,42 @@ struct zram_stats {
 	atomic64_t pages_stored;	/* no. of pages currently stored */
 	atomic_long_t max_used_pages;	/* no. of maximum pages stored */
 	atomic64_t writestall;		/* no. of write slow paths */
+	atomic64_t batch_writes;	/* no. of batched writes */
+	atomic64_t batch_pages;		/* no. of pages written in batch */
+	atomic64_t batch_parallel;	/* no. of batches compressed in parallel */
+	atomic64_t batch_fallback;	/* no. of batch pages redone one by one */
+	atomic64_t recomp_pages;	/* no. of pages in secondary algorithm */
+	atomic64_t recomp_data_size;	/* compressed size of those pages */
+	atomic64_t recomp_saved;	/* bytes saved by recompression */
+	atomic64_t bd_count;		/* no. of pages in backing device */
+	atomic64_t bd_writes;		/* no. of pages written to backing device */
+	atomic64_t bd_reads;		/* no. of pages read from backing device */
+	atomic64_t dup_pages;		/* no. of pages sharing a stored object */
+	atomic64_t dup_data_size;	/* compressed size saved by sharing */
+};
+
+struct zram_batch_slot {
+	struct page *page;
+	u32 index;
+	unsigned long handle;
+	unsigned long element;
+	unsigned int comp_len;
+	int ret;	/* 0: compressed, 1: same filled, -errno: redo */
+};
+
+struct zram_batch_work {
+	struct work_struct work;
+	struct zram *zram;
+	struct zram_batch_slot *slot;
+	int nr;
+};
+
+struct zram_batch {
+	struct mutex lock;
+	struct zram_batch_slot slot[ZRAM_BATCH_PAGES];
+	struct zram_batch_work work[ZRAM_BATCH_WORKERS];
+	atomic_t pending;
+	struct completion done;
 };
 
 struct zram {
@@ -112,10 +175,22 @@ struct zram {
 	 */
 	u64 disksize;	/* bytes */
 	char compressor[CRYPTO_MAX_ALG_NAME];
+	/* secondary compression tier, disabled if recompressor is empty */
+	struct zcomp *recomp;
+	char recompressor[CRYPTO_MAX_ALG_NAME];
+	unsigned int recomp_threshold;	/* percent */
+	unsigned long recomp_cursor;
+	struct delayed_work recomp_work;
 	/*
 	 * zram is claimed so open request will be failed
 	 */
 	bool claim; /* Protected by bdev->bd_mutex */
+	struct zram_batch batch;
+#ifdef CONFIG_ZRAM_DEDUP
+	bool use_dedup;
+	struct zram_dedup_bucket *dedup_table;
+	unsigned long dedup_mask;
+#endif
 #ifdef CONFIG_ZRAM_WRITEBACK
 	struct file *backing_dev;
 	struct block_device *bdev;
@@ -123,6 +198,12 @@ struct zram {
 	unsigned long *bitmap;
 	unsigned long nr_pages;
 	spinlock_t bitmap_lock;
+	struct work_struct wb_work;
+	int wb_mode;
+	/* pages allowed to write back per day for flash wear, 0: unlimited */
+	unsigned long wb_limit;
+	unsigned long wb_day_pages;
+	unsigned long wb_day_start;	/* jiffies */
 #endif
 };
 #endif
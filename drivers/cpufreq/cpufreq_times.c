@@ -18,6 +18,8 @@
 #include <linux/hashtable.h>
 #include <linux/init.h>
 #include <linux/jiffies.h>
+#include <linux/module.h>
+#include <linux/percpu.h>
 #include <linux/proc_fs.h>
 #include <linux/sched.h>
 #include <linux/seq_file.h>
@@ -29,6 +31,10 @@
 
 static DECLARE_HASHTABLE(uid_hash_table, UID_HASH_BITS);
 
+/*
+ * task->time_in_state is only updated by the accounting of the task itself,
+ * which takes the lock to resize it.
+ */
 static DEFINE_SPINLOCK(task_time_in_state_lock); /* task->time_in_state */
 static DEFINE_SPINLOCK(uid_lock); /* uid_hash_table */
 
@@ -37,12 +43,18 @@ struct concurrent_times {
 	atomic64_t policy[NR_CPUS];
 };
 
+/*
+ * The accounting adds to the per-cpu times of the entry without a lock, they
+ * are summed up when read. time_in_state holds the times of the entry this
+ * one replaced when max_state grew.
+ */
 struct uid_entry {
 	uid_t uid;
 	unsigned int max_state;
 	struct hlist_node hash;
 	struct rcu_head rcu;
 	struct concurrent_times *concurrent_times;
+	u64 __percpu *cpu_time_in_state;
 	u64 time_in_state[0];
 };
 
@@ -89,52 +101,89 @@ static struct uid_entry *find_uid_entry_locked(uid_t uid)
 	return NULL;
 }
 
+/* Caller must hold rcu_read_lock() or uid lock */
+static u64 uid_entry_time_in_state(struct uid_entry *uid_entry,
+				   unsigned int state)
+{
+	u64 time = uid_entry->time_in_state[state];
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		time += READ_ONCE(per_cpu_ptr(uid_entry->cpu_time_in_state,
+					      cpu)[state]);
+
+	return time;
+}
+
+static void uid_entry_reclaim(struct rcu_head *rcu)
+{
+	struct uid_entry *uid_entry = container_of(rcu, struct uid_entry, rcu);
+
+	free_percpu(uid_entry->cpu_time_in_state);
+	kfree(uid_entry->concurrent_times);
+	kfree(uid_entry);
+}
+
+/* concurrent_times is taken over by the entry which replaced this one */
+static void uid_entry_reclaim_replaced(struct rcu_head *rcu)
+{
+	struct uid_entry *uid_entry = container_of(rcu, struct uid_entry, rcu);
+
+	free_percpu(uid_entry->cpu_time_in_state);
+	kfree(uid_entry);
+}
+
 /* Caller must hold uid lock */
 static struct uid_entry *find_or_register_uid_locked(uid_t uid)
 {
 	struct uid_entry *uid_entry, *temp;
 	struct concurrent_times *times;
-	unsigned int max_state = READ_ONCE(next_offset);
+	unsigned int i, max_state = READ_ONCE(next_offset);
 	size_t alloc_size = sizeof(*uid_entry) + max_state *
 		sizeof(uid_entry->time_in_state[0]);
 
 	uid_entry = find_uid_entry_locked(uid);
+	if (uid_entry && uid_entry->max_state == max_state)
+		return uid_entry;
+
+	temp = kzalloc(alloc_size, GFP_ATOMIC);
+	if (!temp)
+		return uid_entry;
+	temp->cpu_time_in_state = __alloc_percpu_gfp(max_state * sizeof(u64),
+						     sizeof(u64), GFP_ATOMIC);
+	if (!temp->cpu_time_in_state) {
+		kfree(temp);
+		return uid_entry;
+	}
+
+	temp->uid = uid;
+	temp->max_state = max_state;
+
 	if (uid_entry) {
-		if (uid_entry->max_state == max_state)
-			return uid_entry;
-		/* uid_entry->time_in_state is too small to track all freqs, so
-		 * expand it.
+		/* uid_entry is too small to track all freqs, so replace it.
+		 * The times added to it until the grace period ends are lost,
+		 * which only happens while the policies are created.
 		 */
-		temp = __krealloc(uid_entry, alloc_size, GFP_ATOMIC);
-		if (!temp)
-			return uid_entry;
-		temp->max_state = max_state;
-		memset(temp->time_in_state + uid_entry->max_state, 0,
-		       (max_state - uid_entry->max_state) *
-		       sizeof(uid_entry->time_in_state[0]));
-		if (temp != uid_entry) {
-			hlist_replace_rcu(&uid_entry->hash, &temp->hash);
-			kfree_rcu(uid_entry, rcu);
-		}
+		for (i = 0; i < uid_entry->max_state; i++)
+			temp->time_in_state[i] =
+				uid_entry_time_in_state(uid_entry, i);
+		temp->concurrent_times = uid_entry->concurrent_times;
+		hlist_replace_rcu(&uid_entry->hash, &temp->hash);
+		call_rcu(&uid_entry->rcu, uid_entry_reclaim_replaced);
 		return temp;
 	}
 
-	uid_entry = kzalloc(alloc_size, GFP_ATOMIC);
-	if (!uid_entry)
-		return NULL;
 	times = kzalloc(sizeof(*times), GFP_ATOMIC);
 	if (!times) {
-		kfree(uid_entry);
+		free_percpu(temp->cpu_time_in_state);
+		kfree(temp);
 		return NULL;
 	}
+	temp->concurrent_times = times;
 
-	uid_entry->uid = uid;
-	uid_entry->max_state = max_state;
-	uid_entry->concurrent_times = times;
-
-	hash_add_rcu(uid_hash_table, &uid_entry->hash, uid);
+	hash_add_rcu(uid_hash_table, &temp->hash, uid);
 
-	return uid_entry;
+	return temp;
 }
 
 static int single_uid_time_in_state_show(struct seq_file *m, void *ptr)
@@ -155,7 +204,8 @@ static int single_uid_time_in_state_show(struct seq_file *m, void *ptr)
 	}
 
 	for (i = 0; i < uid_entry->max_state; ++i) {
-		u64 time = nsec_to_clock_t(uid_entry->time_in_state[i]);
+		u64 time = nsec_to_clock_t(
+				uid_entry_time_in_state(uid_entry, i));
 		seq_write(m, &time, sizeof(time));
 	}
 
@@ -215,7 +265,8 @@ static int uid_time_in_state_seq_show(struct seq_file *m, void *v)
 			seq_putc(m, ':');
 		}
 		for (i = 0; i < uid_entry->max_state; ++i) {
-			u64 time = nsec_to_clock_t(uid_entry->time_in_state[i]);
+			u64 time = nsec_to_clock_t(
+				uid_entry_time_in_state(uid_entry, i));
 			seq_put_decimal_ull(m, " ", time);
 		}
 		if (uid_entry->max_state)
@@ -412,25 +463,32 @@ void cpufreq_acct_update_power(struct task_struct *p, u64 cputime)
 
 	state = freqs->offset + READ_ONCE(freqs->last_index);
 
-	spin_lock_irqsave(&task_time_in_state_lock, flags);
-	if ((state < p->max_state || !cpufreq_task_times_realloc_locked(p)) &&
-	    p->time_in_state)
+	if (state < p->max_state && p->time_in_state) {
 		p->time_in_state[state] += cputime;
-	spin_unlock_irqrestore(&task_time_in_state_lock, flags);
-
-	spin_lock_irqsave(&uid_lock, flags);
-	uid_entry = find_or_register_uid_locked(uid);
-	if (uid_entry && state < uid_entry->max_state)
-		uid_entry->time_in_state[state] += cputime;
-	spin_unlock_irqrestore(&uid_lock, flags);
+	} else {
+		spin_lock_irqsave(&task_time_in_state_lock, flags);
+		if ((state < p->max_state ||
+		     !cpufreq_task_times_realloc_locked(p)) &&
+		    p->time_in_state)
+			p->time_in_state[state] += cputime;
+		spin_unlock_irqrestore(&task_time_in_state_lock, flags);
+	}
 
 	rcu_read_lock();
 	uid_entry = find_uid_entry_rcu(uid);
-	if (!uid_entry) {
-		rcu_read_unlock();
-		return;
+	if (!uid_entry || uid_entry->max_state != READ_ONCE(next_offset)) {
+		spin_lock_irqsave(&uid_lock, flags);
+		uid_entry = find_or_register_uid_locked(uid);
+		spin_unlock_irqrestore(&uid_lock, flags);
+		if (!uid_entry) {
+			rcu_read_unlock();
+			return;
+		}
 	}
 
+	if (state < uid_entry->max_state)
+		this_cpu_add(uid_entry->cpu_time_in_state[state], cputime);
+
 	for_each_possible_cpu(cpu)
 		if (!idle_cpu(cpu))
 			++active_cpu_cnt;
@@ -460,6 +518,7 @@ void cpufreq_acct_update_power(struct task_struct *p, u64 cputime)
 							  policy_cpu_cnt - 1]);
 	rcu_read_unlock();
 }
+EXPORT_SYMBOL_GPL(cpufreq_acct_update_power);
 
 static int cpufreq_times_get_index(struct cpu_freqs *freqs, unsigned int freq)
 {
@@ -510,14 +569,6 @@ void cpufreq_times_create_policy(struct cpufreq_policy *policy)
 		all_freqs[cpu] = freqs;
 }
 
-static void uid_entry_reclaim(struct rcu_head *rcu)
-{
-	struct uid_entry *uid_entry = container_of(rcu, struct uid_entry, rcu);
-
-	kfree(uid_entry->concurrent_times);
-	kfree(uid_entry);
-}
-
 void cpufreq_task_times_remove_uids(uid_t uid_start, uid_t uid_end)
 {
 	struct uid_entry *uid_entry;
@@ -0,0 +1,115 @@
+/*
+ * Benchmark of the time-in-state accounting
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * A thread bound to every online cpu accounts ticks of 1ns to itself, all
+ * of them at the same time as the ticks of a loaded system would, and the
+ * ns per accounting are reported per cpu at module load, e.g.
+ *
+ * #insmod cpufreq_times_bench.ko loops=100000
+ *
+ * The threads belong to uid 0, whose times grow by loops ns per cpu.
+ */
+
+#define pr_fmt(fmt) "cpufreq_times_bench: " fmt
+
+#include <linux/completion.h>
+#include <linux/cpufreq_times.h>
+#include <linux/kernel.h>
+#include <linux/kthread.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/percpu.h>
+#include <linux/sched.h>
+
+static unsigned int loops = 100000;
+module_param(loops, uint, 0444);
+MODULE_PARM_DESC(loops, "ticks accounted per cpu");
+
+static DECLARE_COMPLETION(cpufreq_times_bench_start);
+static atomic_t cpufreq_times_bench_running;
+static DECLARE_COMPLETION(cpufreq_times_bench_done);
+static DEFINE_PER_CPU(u64, cpufreq_times_bench_ns);
+
+static int cpufreq_times_bench_thread(void *data)
+{
+	unsigned int i;
+	unsigned long flags;
+	ktime_t start;
+
+	wait_for_completion(&cpufreq_times_bench_start);
+
+	start = ktime_get();
+	for (i = 0; i < loops; i++) {
+		/* as from the tick */
+		local_irq_save(flags);
+		cpufreq_acct_update_power(current, 1);
+		local_irq_restore(flags);
+	}
+	*this_cpu_ptr(&cpufreq_times_bench_ns) =
+		ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	if (atomic_dec_and_test(&cpufreq_times_bench_running))
+		complete(&cpufreq_times_bench_done);
+
+	return 0;
+}
+
+static int __init cpufreq_times_bench_init(void)
+{
+	struct task_struct *tsk;
+	u64 ns, total = 0;
+	int cpu, nr = 0;
+
+	if (!loops)
+		return -EINVAL;
+
+	get_online_cpus();
+	atomic_set(&cpufreq_times_bench_running, num_online_cpus());
+	for_each_online_cpu(cpu) {
+		tsk = kthread_create_on_node(cpufreq_times_bench_thread, NULL,
+					     cpu_to_node(cpu),
+					     "cpufreq_times_bench/%d", cpu);
+		if (IS_ERR(tsk)) {
+			atomic_dec(&cpufreq_times_bench_running);
+			continue;
+		}
+		kthread_bind(tsk, cpu);
+		wake_up_process(tsk);
+		nr++;
+	}
+	put_online_cpus();
+
+	if (!nr)
+		return -ENOMEM;
+
+	complete_all(&cpufreq_times_bench_start);
+	wait_for_completion(&cpufreq_times_bench_done);
+
+	for_each_possible_cpu(cpu) {
+		ns = per_cpu(cpufreq_times_bench_ns, cpu);
+		if (!ns)
+			continue;
+		pr_info("cpu%d: %llu ns per tick\n", cpu, div_u64(ns, loops));
+		total += ns;
+	}
+	pr_info("%d cpus: %llu ns per tick\n", nr,
+		div64_u64(total, (u64)loops * nr));
+
+	return 0;
+}
+
+static void __exit cpufreq_times_bench_exit(void)
+{
+}
+
+module_init(cpufreq_times_bench_init);
+module_exit(cpufreq_times_bench_exit);
+MODULE_LICENSE("GPL v2");
+MODULE_DESCRIPTION("Benchmark of the time-in-state accounting");
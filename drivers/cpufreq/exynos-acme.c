@@ -20,7 +20,9 @@
 #include <linux/pm_opp.h>
 #include <linux/cpu_cooling.h>
 #include <linux/suspend.h>
+#include <linux/workqueue.h>
 #include <linux/ems.h>
+#include <linux/math64.h>
 
 #include <soc/samsung/cal-if.h>
 #include <soc/samsung/ect_parser.h>
@@ -153,6 +155,103 @@ static unsigned int index_to_freq(struct cpufreq_frequency_table *table,
 	return table[index].frequency;
 }
 
+static int freq_to_index(struct exynos_cpufreq_domain *domain,
+					unsigned int freq)
+{
+	int index;
+
+	for (index = 0; index < domain->table_size; index++)
+		if (domain->freq_table[index].frequency == freq)
+			return index;
+
+	return -EINVAL;
+}
+
+/*********************************************************************
+ *                  ENERGY EFFICIENT FREQUENCY                       *
+ *********************************************************************/
+/*
+ * Default frequency slack of efficient frequency selection in percent.
+ * The target frequency can be raised up to this slack.
+ */
+#define EFF_SLACK_DEFAULT	10
+
+/*
+ * Energy per cycle is proportional to power / frequency. Since the voltage
+ * does not decrease as the frequency increases, the cheapest cycle is given
+ * by the resolved frequency itself, but the higher frequencies that share
+ * the same voltage cost nothing more per cycle and finish the work earlier.
+ * Within the slack, pick the highest frequency whose energy per cycle is not
+ * higher than that of the resolved frequency.
+ */
+static int eff_select_index(struct exynos_cpufreq_domain *domain,
+				struct cpufreq_policy *policy,
+				int index, unsigned int relation)
+{
+	unsigned int freq, limit, best_freq, best_power;
+	int i, best = index;
+
+	if (!domain->eff_enabled || !domain->eff_power)
+		return index;
+
+	/* RELATION_H is an upper bound given by the caller */
+	if (relation == CPUFREQ_RELATION_H || static_governor(policy))
+		return index;
+
+	best_freq = freq = index_to_freq(domain->freq_table, index);
+	best_power = domain->eff_power[index];
+	limit = min(freq + freq * domain->eff_slack / 100, policy->max);
+
+	for (i = 0; i < domain->table_size; i++) {
+		unsigned int f = domain->freq_table[i].frequency;
+
+		if (f == CPUFREQ_ENTRY_INVALID || f <= best_freq || f > limit)
+			continue;
+
+		/* power(i) / f <= best_power / best_freq */
+		if ((u64)domain->eff_power[i] * best_freq >
+				(u64)best_power * f)
+			continue;
+
+		best = i;
+		best_freq = f;
+		best_power = domain->eff_power[i];
+	}
+
+	return best;
+}
+
+/*
+ * Account residency and estimated energy of the current frequency up to now.
+ * The energy assumes the domain is busy during the residency, so it is an
+ * upper bound of the energy spent at the frequency.
+ */
+static void eff_account(struct exynos_cpufreq_domain *domain)
+{
+	unsigned long flags;
+	ktime_t now;
+	u64 delta;
+	int index;
+
+	if (!domain->eff_residency)
+		return;
+
+	raw_spin_lock_irqsave(&domain->eff_lock, flags);
+
+	now = ktime_get();
+	delta = ktime_to_ns(ktime_sub(now, domain->eff_last_update));
+	domain->eff_last_update = now;
+
+	index = freq_to_index(domain, domain->old);
+	if (index >= 0) {
+		domain->eff_residency[index] += delta;
+		/* power in the unit of EMS energy table, multiplied by ns */
+		domain->eff_energy[index] += (u64)domain->eff_power[index] * delta;
+	}
+
+	raw_spin_unlock_irqrestore(&domain->eff_lock, flags);
+}
+
 
 /*********************************************************************
  *                         FREQUENCY SCALING                         *
@@ -246,6 +345,32 @@ static unsigned int apply_pm_qos(struct exynos_cpufreq_domain *domain,
 	return freq;
 }
 
+/*
+ * Frequency of fast switch domain is changed in scheduler context without
+ * domain->lock, so the frequency and domain->old are updated together under
+ * fast_lock.
+ */
+static int set_freq_and_update(struct exynos_cpufreq_domain *domain,
+					unsigned int target_freq)
+{
+	unsigned long flags = 0;
+	int ret;
+
+	if (domain->fast_switch)
+		raw_spin_lock_irqsave(&domain->fast_lock, flags);
+
+	ret = set_freq(domain, target_freq);
+	if (!ret) {
+		eff_account(domain);
+		domain->old = target_freq;
+	}
+
+	if (domain->fast_switch)
+		raw_spin_unlock_irqrestore(&domain->fast_lock, flags);
+
+	return ret;
+}
+
 static int pre_scale(void)
 {
 	return 0;
@@ -276,7 +401,7 @@ static int scale(struct exynos_cpufreq_domain *domain,
 		goto fail_scale;
 
 	/* Scale frequency by hooked function, set_freq() */
-	ret = set_freq(domain, target_freq);
+	ret = set_freq_and_update(domain, target_freq);
 	if (ret)
 		goto fail_scale;
 
@@ -343,6 +468,7 @@ static int exynos_cpufreq_driver_init(struct cpufreq_policy *policy)
 
 	policy->cur = get_freq(domain);
 	policy->cpuinfo.transition_latency = TRANSITION_LATENCY;
+	policy->fast_switch_possible = domain->fast_switch;
 	cpumask_copy(policy->cpus, &domain->cpus);
 
 	pr_info("CPUFREQ domain%d registered\n", domain->id);
@@ -376,11 +502,15 @@ static int __exynos_cpufreq_target(struct cpufreq_policy *policy,
 	if (!domain->enabled)
 		goto out;
 
+	if (domain->fast_switch)
+		raw_spin_lock_irq(&domain->fast_lock);
 	if (domain->old != get_freq(domain)) {
 		pr_err("oops, inconsistency between domain->old:%d, real clk:%d\n",
 			domain->old, get_freq(domain));
 		BUG_ON(1);
 	}
+	if (domain->fast_switch)
+		raw_spin_unlock_irq(&domain->fast_lock);
 
 	/*
 	 * Update target_freq.
@@ -393,6 +523,7 @@ static int __exynos_cpufreq_target(struct cpufreq_policy *policy,
 		goto out;
 	}
 
+	index = eff_select_index(domain, policy, index, relation);
 	target_freq = index_to_freq(domain->freq_table, index);
 
 	/* Target is same as current, skip scaling */
@@ -403,10 +534,9 @@ static int __exynos_cpufreq_target(struct cpufreq_policy *policy,
 	if (ret)
 		goto out;
 
-	pr_debug("CPUFREQ domain%d frequency change %u kHz -> %u kHz\n",
-			domain->id, domain->old, target_freq);
+	pr_debug("CPUFREQ domain%d frequency changed to %u kHz\n",
+			domain->id, target_freq);
 
-	domain->old = target_freq;
 	arch_set_freq_scale(&domain->cpus, target_freq, policy->max);
 
 out:
@@ -425,19 +555,16 @@ static unsigned int exynos_cpufreq_get(unsigned int cpu)
 	return get_freq(domain);
 }
 
-static int exynos_cpufreq_target(struct cpufreq_policy *policy,
+static int exynos_cpufreq_sync_target(struct exynos_cpufreq_domain *domain,
+					struct cpufreq_policy *policy,
 					unsigned int target_freq,
 					unsigned int relation)
 {
-	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
 	unsigned long freq;
 	unsigned int index;
 	unsigned int policy_min, policy_max;
 	unsigned int pm_qos_min, pm_qos_max;
 
-	if (!domain)
-		return -EINVAL;
-
 	target_freq = apply_pm_qos(domain, policy, target_freq);
 
 	if (list_empty(&domain->dm_list))
@@ -468,6 +595,373 @@ static int exynos_cpufreq_target(struct cpufreq_policy *policy,
 				min(policy_max, pm_qos_max), &freq);
 }
 
+/*********************************************************************
+ *                 ASYNCHRONOUS FREQUENCY TRANSITION                 *
+ *********************************************************************/
+/*
+ * In asynchronous mode, the caller only leaves the target and returns, and
+ * the transition is done by the worker. Requests made while a transition is
+ * pending are coalesced and only the latest target is applied, so there is
+ * only one transition in flight per domain.
+ */
+static struct workqueue_struct *acme_async_wq;
+
+static const unsigned int async_latency_bound[ASYNC_LATENCY_HIST_SIZE - 1] = {
+	50, 100, 200, 500, 1000, 2000, 5000,
+};
+
+static void async_account_latency(struct exynos_cpufreq_domain *domain,
+					ktime_t req_time)
+{
+	s64 latency = ktime_us_delta(ktime_get(), req_time);
+	unsigned long flags;
+	int i;
+
+	for (i = 0; i < ASYNC_LATENCY_HIST_SIZE - 1; i++)
+		if (latency < async_latency_bound[i])
+			break;
+
+	spin_lock_irqsave(&domain->async_lock, flags);
+	domain->async_latency_hist[i]++;
+	spin_unlock_irqrestore(&domain->async_lock, flags);
+}
+
+static void exynos_cpufreq_async_work(struct work_struct *work)
+{
+	struct exynos_cpufreq_domain *domain = container_of(work,
+				struct exynos_cpufreq_domain, async_work);
+	struct cpufreq_policy *policy;
+	unsigned int target_freq, relation;
+	ktime_t req_time;
+	unsigned long flags;
+	struct cpumask mask;
+
+	spin_lock_irqsave(&domain->async_lock, flags);
+	if (!domain->async_pending) {
+		spin_unlock_irqrestore(&domain->async_lock, flags);
+		return;
+	}
+	target_freq = domain->async_target;
+	relation = domain->async_relation;
+	req_time = domain->async_req_time;
+	domain->async_pending = false;
+	spin_unlock_irqrestore(&domain->async_lock, flags);
+
+	cpumask_and(&mask, &domain->cpus, cpu_online_mask);
+	if (cpumask_empty(&mask))
+		return;
+
+	policy = cpufreq_cpu_get(cpumask_first(&mask));
+	if (!policy)
+		return;
+
+	down_read(&policy->rwsem);
+	exynos_cpufreq_sync_target(domain, policy, target_freq, relation);
+	up_read(&policy->rwsem);
+
+	cpufreq_cpu_put(policy);
+
+	async_account_latency(domain, req_time);
+}
+
+static bool async_transition(struct exynos_cpufreq_domain *domain)
+{
+	return READ_ONCE(domain->async_enabled) && !READ_ONCE(domain->async_paused);
+}
+
+static void async_request(struct exynos_cpufreq_domain *domain,
+					unsigned int target_freq,
+					unsigned int relation)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&domain->async_lock, flags);
+	if (domain->async_pending)
+		domain->async_coalesced++;
+	else
+		domain->async_req_time = ktime_get();
+
+	/* latest request wins */
+	domain->async_target = target_freq;
+	domain->async_relation = relation;
+	domain->async_pending = true;
+	spin_unlock_irqrestore(&domain->async_lock, flags);
+
+	queue_work(acme_async_wq, &domain->async_work);
+}
+
+/* Stop asynchronous transition and drop the pending request */
+static void async_pause(struct exynos_cpufreq_domain *domain)
+{
+	unsigned long flags;
+
+	WRITE_ONCE(domain->async_paused, true);
+	cancel_work_sync(&domain->async_work);
+
+	spin_lock_irqsave(&domain->async_lock, flags);
+	domain->async_pending = false;
+	spin_unlock_irqrestore(&domain->async_lock, flags);
+}
+
+static void async_resume(struct exynos_cpufreq_domain *domain)
+{
+	WRITE_ONCE(domain->async_paused, false);
+}
+
+static int exynos_cpufreq_target(struct cpufreq_policy *policy,
+					unsigned int target_freq,
+					unsigned int relation)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+
+	if (!domain)
+		return -EINVAL;
+
+	if (async_transition(domain)) {
+		async_request(domain, target_freq, relation);
+		return 0;
+	}
+
+	return exynos_cpufreq_sync_target(domain, policy, target_freq, relation);
+}
+
+/*********************************************************************
+ *                            FAST SWITCH                            *
+ *********************************************************************/
+/*
+ * Fast switch is supported by the domain whose frequency can be changed by
+ * direct write in atomic context, given by "fast-switch" property. Fast switch
+ * only changes the frequency of the domain, and the propagation of DVFS
+ * Manager constraints to the other domains is deferred to the asynchronous
+ * transition worker.
+ */
+static unsigned int exynos_cpufreq_fast_switch(struct cpufreq_policy *policy,
+					unsigned int target_freq)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+	unsigned long flags;
+	int index, ret;
+
+	if (!domain || !domain->fast_switch)
+		return 0;
+
+	target_freq = apply_pm_qos(domain, policy, target_freq);
+
+	index = cpufreq_frequency_table_target(policy, target_freq,
+						CPUFREQ_RELATION_L);
+	if (index < 0)
+		return 0;
+
+	index = eff_select_index(domain, policy, index, CPUFREQ_RELATION_L);
+	target_freq = index_to_freq(domain->freq_table, index);
+
+	raw_spin_lock_irqsave(&domain->fast_lock, flags);
+
+	if (!domain->enabled) {
+		target_freq = 0;
+		goto out;
+	}
+
+	if (domain->old == target_freq)
+		goto out;
+
+	dbg_snapshot_freq(domain->id, domain->old, target_freq, DSS_FLAG_IN);
+
+	ret = set_freq(domain, target_freq);
+
+	dbg_snapshot_freq(domain->id, domain->old, target_freq,
+					ret < 0 ? ret : DSS_FLAG_OUT);
+	if (ret) {
+		target_freq = 0;
+		goto out;
+	}
+
+	eff_account(domain);
+	domain->old = target_freq;
+	arch_set_freq_scale(&domain->cpus, target_freq, policy->max);
+
+out:
+	raw_spin_unlock_irqrestore(&domain->fast_lock, flags);
+
+	if (target_freq && !list_empty(&domain->dm_list))
+		async_request(domain, target_freq, CPUFREQ_RELATION_L);
+
+	return target_freq;
+}
+
+static ssize_t show_async_transition(struct cpufreq_policy *policy, char *buf)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+
+	if (!domain)
+		return -EINVAL;
+
+	return snprintf(buf, PAGE_SIZE, "%d\n", domain->async_enabled);
+}
+
+static ssize_t store_async_transition(struct cpufreq_policy *policy,
+					const char *buf, size_t count)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+	unsigned int input;
+
+	if (!domain)
+		return -EINVAL;
+
+	if (kstrtouint(buf, 0, &input))
+		return -EINVAL;
+
+	if (!acme_async_wq)
+		return -ENODEV;
+
+	WRITE_ONCE(domain->async_enabled, !!input);
+
+	/* Apply the pending request before going back to synchronous mode */
+	if (!input)
+		flush_work(&domain->async_work);
+
+	return count;
+}
+
+static ssize_t show_async_latency(struct cpufreq_policy *policy, char *buf)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+	unsigned int hist[ASYNC_LATENCY_HIST_SIZE];
+	unsigned int coalesced;
+	unsigned long flags;
+	ssize_t ret = 0;
+	int i;
+
+	if (!domain)
+		return -EINVAL;
+
+	spin_lock_irqsave(&domain->async_lock, flags);
+	memcpy(hist, domain->async_latency_hist, sizeof(hist));
+	coalesced = domain->async_coalesced;
+	spin_unlock_irqrestore(&domain->async_lock, flags);
+
+	for (i = 0; i < ASYNC_LATENCY_HIST_SIZE - 1; i++)
+		ret += snprintf(buf + ret, PAGE_SIZE - ret, "<%uus : %u\n",
+				async_latency_bound[i], hist[i]);
+	ret += snprintf(buf + ret, PAGE_SIZE - ret, ">=%uus : %u\n",
+				async_latency_bound[i - 1], hist[i]);
+	ret += snprintf(buf + ret, PAGE_SIZE - ret, "coalesced : %u\n",
+				coalesced);
+
+	return ret;
+}
+
+static ssize_t show_efficient_freq(struct cpufreq_policy *policy, char *buf)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+
+	if (!domain)
+		return -EINVAL;
+
+	return snprintf(buf, PAGE_SIZE, "%d\n", domain->eff_enabled);
+}
+
+static ssize_t store_efficient_freq(struct cpufreq_policy *policy,
+					const char *buf, size_t count)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+	unsigned int input;
+
+	if (!domain)
+		return -EINVAL;
+
+	if (kstrtouint(buf, 0, &input))
+		return -EINVAL;
+
+	if (!domain->eff_power)
+		return -ENODEV;
+
+	WRITE_ONCE(domain->eff_enabled, !!input);
+
+	return count;
+}
+
+static ssize_t show_efficient_slack(struct cpufreq_policy *policy, char *buf)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+
+	if (!domain)
+		return -EINVAL;
+
+	return snprintf(buf, PAGE_SIZE, "%u\n", domain->eff_slack);
+}
+
+static ssize_t store_efficient_slack(struct cpufreq_policy *policy,
+					const char *buf, size_t count)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+	unsigned int input;
+
+	if (!domain)
+		return -EINVAL;
+
+	if (kstrtouint(buf, 0, &input))
+		return -EINVAL;
+
+	if (input > 100)
+		return -EINVAL;
+
+	WRITE_ONCE(domain->eff_slack, input);
+
+	return count;
+}
+
+static ssize_t show_efficient_stat(struct cpufreq_policy *policy, char *buf)
+{
+	struct exynos_cpufreq_domain *domain = find_domain(policy->cpu);
+	ssize_t ret = 0;
+	int index;
+
+	if (!domain)
+		return -EINVAL;
+
+	if (!domain->eff_residency)
+		return -ENODEV;
+
+	eff_account(domain);
+
+	ret += snprintf(buf + ret, PAGE_SIZE - ret,
+			"freq(kHz) power residency(ms) energy(power*s)\n");
+
+	for (index = 0; index < domain->table_size; index++) {
+		unsigned int freq = domain->freq_table[index].frequency;
+
+		if (freq == CPUFREQ_ENTRY_INVALID)
+			continue;
+
+		ret += snprintf(buf + ret, PAGE_SIZE - ret, "%u %u %llu %llu\n",
+				freq, domain->eff_power[index],
+				div64_u64(domain->eff_residency[index], NSEC_PER_MSEC),
+				div64_u64(domain->eff_energy[index], 1000000000ULL));
+	}
+
+	return ret;
+}
+
+cpufreq_freq_attr_rw(async_transition);
+cpufreq_freq_attr_ro(async_latency);
+cpufreq_freq_attr_rw(efficient_freq);
+cpufreq_freq_attr_rw(efficient_slack);
+cpufreq_freq_attr_ro(efficient_stat);
+
+static struct freq_attr *exynos_cpufreq_attr[] = {
+	&cpufreq_freq_attr_scaling_available_freqs,
+#ifdef CONFIG_CPU_FREQ_BOOST_SW
+	&cpufreq_freq_attr_scaling_boost_freqs,
+#endif
+	&async_transition,
+	&async_latency,
+	&efficient_freq,
+	&efficient_slack,
+	&efficient_stat,
+	NULL,
+};
+
 static int __exynos_cpufreq_suspend(struct exynos_cpufreq_domain *domain)
 {
 	unsigned int freq;
@@ -475,6 +969,9 @@ static int __exynos_cpufreq_suspend(struct exynos_cpufreq_domain *domain)
 	if (!domain)
 		return -EINVAL;
 
+	/* Frequency should be synchronized with resume freq before suspend */
+	async_pause(domain);
+
 	/* To handle reboot faster, it does not thrrotle frequency of domain0 */
 	if (system_state == SYSTEM_RESTART && domain->id != 0)
 		freq = domain->min_freq;
@@ -517,6 +1014,7 @@ static int __exynos_cpufreq_resume(struct exynos_cpufreq_domain *domain)
 		return -EINVAL;
 
 	enable_domain(domain);
+	async_resume(domain);
 
 	pm_qos_update_request(&domain->min_qos_req, domain->min_freq);
 	pm_qos_update_request(&domain->max_qos_req, domain->max_freq);
@@ -578,12 +1076,13 @@ static struct cpufreq_driver exynos_driver = {
 	.init		= exynos_cpufreq_driver_init,
 	.verify		= exynos_cpufreq_verify,
 	.target		= exynos_cpufreq_target,
+	.fast_switch	= exynos_cpufreq_fast_switch,
 	.get		= exynos_cpufreq_get,
 	.suspend	= exynos_cpufreq_suspend,
 	.resume		= exynos_cpufreq_resume,
 	.ready		= exynos_cpufreq_ready,
 	.exit		= exynos_cpufreq_exit,
-	.attr		= cpufreq_generic_attr,
+	.attr		= exynos_cpufreq_attr,
 };
 
 /*********************************************************************
@@ -879,6 +1378,59 @@ static __init void init_sysfs(void)
 {
 }
 
+/*
+ * Power of each frequency is estimated with the same model as the energy
+ * table of EMS, power = coefficient * frequency * voltage^2, where the
+ * coefficient is given by "power-coefficient" of a cpu node in the domain.
+ */
+static __init void init_efficient_freq(struct exynos_cpufreq_domain *domain,
+				unsigned long *table, unsigned int *volt_table)
+{
+	struct device_node *cpu_dn;
+	unsigned int coefficient = 0;
+	int index;
+
+	cpu_dn = of_get_cpu_node(cpumask_first(&domain->cpus), NULL);
+	if (cpu_dn) {
+		of_property_read_u32(cpu_dn, "power-coefficient", &coefficient);
+		of_node_put(cpu_dn);
+	}
+
+	if (!coefficient) {
+		domain->eff_enabled = false;
+		return;
+	}
+
+	domain->eff_power = kcalloc(domain->table_size,
+				sizeof(unsigned int), GFP_KERNEL);
+	if (!domain->eff_power)
+		goto fail;
+
+	domain->eff_residency = kcalloc(domain->table_size * 2,
+				sizeof(u64), GFP_KERNEL);
+	if (!domain->eff_residency)
+		goto fail;
+
+	domain->eff_energy = domain->eff_residency + domain->table_size;
+
+	for (index = 0; index < domain->table_size; index++) {
+		u64 f = table[index] / 1000;		/* KHz -> MHz */
+		u64 v = volt_table[index] / 1000;	/* uV -> mV */
+
+		domain->eff_power[index] = div64_u64(coefficient * f * v * v,
+							1000000000ULL);
+	}
+
+	domain->eff_last_update = ktime_get();
+
+	return;
+
+fail:
+	kfree(domain->eff_power);
+	domain->eff_power = NULL;
+	domain->eff_enabled = false;
+}
+
 static __init int init_table(struct exynos_cpufreq_domain *domain)
 {
 	unsigned int index;
@@ -941,6 +1493,8 @@ static __init int init_table(struct exynos_cpufreq_domain *domain)
 	init_sched_energy_table(&domain->cpus, domain->table_size, table, volt_table,
 				domain->max_freq, domain->min_freq);
 
+	init_efficient_freq(domain, table, volt_table);
+
 	kfree(volt_table);
 
 free_table:
@@ -1185,6 +1739,27 @@ static __init int init_domain(struct exynos_cpufreq_domain *domain,
 	if (of_property_read_bool(dn, "need-awake"))
 		domain->need_awake = true;
 
+	spin_lock_init(&domain->async_lock);
+	INIT_WORK(&domain->async_work, exynos_cpufreq_async_work);
+	if (of_property_read_bool(dn, "async-transition") && acme_async_wq)
+		domain->async_enabled = true;
+
+	/*
+	 * Fast switch does not wake up the cluster, and DM constraints are
+	 * propagated by asynchronous worker.
+	 */
+	raw_spin_lock_init(&domain->fast_lock);
+	if (of_property_read_bool(dn, "fast-switch") && !domain->need_awake &&
+	    (list_empty(&domain->dm_list) || acme_async_wq))
+		domain->fast_switch = true;
+
+	raw_spin_lock_init(&domain->eff_lock);
+	domain->eff_slack = EFF_SLACK_DEFAULT;
+	if (!of_property_read_u32(dn, "efficient-slack", &val))
+		domain->eff_slack = min_t(unsigned int, val, 100);
+	if (of_property_read_bool(dn, "efficient-freq"))
+		domain->eff_enabled = true;
+
 	domain->boot_freq = cal_dfs_get_boot_freq(domain->cal_id);
 	domain->resume_freq = cal_dfs_get_resume_freq(domain->cal_id);
 
@@ -1333,6 +1908,10 @@ static int __init exynos_cpufreq_init(void)
 	int ret = 0;
 	unsigned int domain_id = 0;
 
+	acme_async_wq = alloc_workqueue("acme_async", WQ_HIGHPRI | WQ_UNBOUND, 0);
+	if (!acme_async_wq)
+		pr_err("failed to create workqueue for async transition\n");
+
 	while ((dn = of_find_node_by_type(dn, "cpufreq-domain"))) {
 		domain = alloc_domain(dn);
 		if (!domain) {
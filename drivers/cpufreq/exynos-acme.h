@@ -34,6 +34,13 @@ struct exynos_cpufreq_ready_block {
 	int (*get_target)(struct cpufreq_policy *policy, target_fn target);
 };
 
+/*
+ * Request-to-applied latency histogram of asynchronous transition.
+ * Upper bounds of buckets are 50, 100, 200, 500, 1000, 2000, 5000us
+ * and the last bucket covers the rest.
+ */
+#define ASYNC_LATENCY_HIST_SIZE	8
+
 struct exynos_cpufreq_domain {
 	/* list of domain */
 	struct list_head		list;
@@ -67,9 +74,9 @@ struct exynos_cpufreq_domain {
 	unsigned int			pm_qos_max_class;
 	struct pm_qos_request		min_qos_req;
 	struct pm_qos_request		max_qos_req;
-	struct pm_qos_request		user_min_qos_req;
-	struct pm_qos_request		user_max_qos_req;
-	struct pm_qos_request		user_min_qos_wo_boost_req;
+	struct ufc_request		user_min_req;
+	struct ufc_request		user_max_req;
+	struct ufc_request		user_min_wo_boost_req;
 	struct notifier_block		pm_qos_min_notifier;
 	struct notifier_block		pm_qos_max_notifier;
 
@@ -87,10 +94,36 @@ struct exynos_cpufreq_domain {
 
 	/* list head of User cpuFreq Ctrl (UFC - User Frequency Control) */
 	struct list_head		ufc_list;
+	struct ufc_aggr			*ufc_aggr;
 
 	bool				need_awake;
 
+	/* fast switch, serialized with normal scaling by fast_lock */
+	bool				fast_switch;
+	raw_spinlock_t			fast_lock;
+
 	struct thermal_cooling_device *cdev;
+
+	/* asynchronous frequency transition */
+	bool				async_enabled;
+	bool				async_paused;
+	spinlock_t			async_lock;
+	struct work_struct		async_work;
+	bool				async_pending;
+	unsigned int			async_target;
+	unsigned int			async_relation;
+	ktime_t				async_req_time;
+	unsigned int			async_coalesced;
+	unsigned int			async_latency_hist[ASYNC_LATENCY_HIST_SIZE];
+
+	/* energy efficient frequency selection */
+	bool				eff_enabled;
+	unsigned int			eff_slack;
+	unsigned int			*eff_power;
+	raw_spinlock_t			eff_lock;
+	ktime_t				eff_last_update;
+	u64				*eff_residency;
+	u64				*eff_energy;
 };
 
 /*
@@ -23,6 +23,235 @@
 
 #include "exynos-acme.h"
 
+/*********************************************************************
+ *                      USER REQUEST AGGREGATION                     *
+ *********************************************************************/
+static DEFINE_MUTEX(ufc_lock);
+
+/*
+ * Minimum requests are rounded up and maximum requests are rounded down
+ * to a valid frequency, the same way cpufreq resolves the policy limits.
+ */
+static int ufc_freq_to_level(struct ufc_aggr *aggr, int req_class,
+						unsigned int freq)
+{
+	int level;
+
+	if (req_class == UFC_REQ_MIN) {
+		for (level = 0; level < aggr->level_count - 1; level++)
+			if (aggr->level_freq[level] >= freq)
+				break;
+		return level;
+	}
+
+	for (level = aggr->level_count - 1; level > 0; level--)
+		if (aggr->level_freq[level] <= freq)
+			break;
+	return level;
+}
+
+static void ufc_bucket_add(struct ufc_bucket *bucket, int level)
+{
+	if (!bucket->count[level]++)
+		__set_bit(level, &bucket->mask);
+}
+
+static void ufc_bucket_del(struct ufc_bucket *bucket, int level)
+{
+	if (!--bucket->count[level])
+		__clear_bit(level, &bucket->mask);
+}
+
+static unsigned int ufc_aggregate(struct exynos_cpufreq_domain *domain,
+						int req_class)
+{
+	struct ufc_aggr *aggr = domain->ufc_aggr;
+	unsigned long mask = aggr->bucket[req_class].mask;
+
+	/* the highest minimum and the lowest maximum win */
+	if (req_class == UFC_REQ_MIN)
+		return mask ? aggr->level_freq[__fls(mask)] : domain->min_freq;
+
+	return mask ? aggr->level_freq[__ffs(mask)] : domain->max_freq;
+}
+
+static void ufc_apply(struct exynos_cpufreq_domain *domain, int req_class)
+{
+	struct ufc_aggr *aggr = domain->ufc_aggr;
+	unsigned int value = ufc_aggregate(domain, req_class);
+
+	if (value == aggr->qos_value[req_class])
+		return;
+
+	aggr->qos_value[req_class] = value;
+	aggr->qos_update_count[req_class]++;
+	pm_qos_update_request(&aggr->qos_req[req_class], value);
+}
+
+/*
+ * Update user request. Minimum request with 0 frequency does not
+ * constrain the domain, maximum request is always counted. PM QoS is
+ * updated only if the aggregated value is changed.
+ */
+static void ufc_update_request(struct ufc_request *req, unsigned int freq)
+{
+	struct exynos_cpufreq_domain *domain = req->domain;
+	struct ufc_aggr *aggr;
+	int level;
+
+	if (!domain || !domain->ufc_aggr)
+		return;
+
+	aggr = domain->ufc_aggr;
+
+	mutex_lock(&ufc_lock);
+
+	req->freq = freq;
+	req->update_count++;
+
+	if (req->req_class == UFC_REQ_MIN && !freq)
+		level = -1;
+	else
+		level = ufc_freq_to_level(aggr, req->req_class, freq);
+
+	if (level != req->level) {
+		if (req->level >= 0)
+			ufc_bucket_del(&aggr->bucket[req->req_class], req->level);
+		if (level >= 0)
+			ufc_bucket_add(&aggr->bucket[req->req_class], level);
+		req->level = level;
+
+		ufc_apply(domain, req->req_class);
+	}
+
+	mutex_unlock(&ufc_lock);
+}
+
+static void ufc_add_request(struct exynos_cpufreq_domain *domain,
+		struct ufc_request *req, const char *name, int req_class,
+		unsigned int freq)
+{
+	strlcpy(req->name, name, UFC_REQ_NAME_LEN);
+	req->domain = domain;
+	req->req_class = req_class;
+	req->level = -1;
+
+	mutex_lock(&ufc_lock);
+	list_add_tail(&req->list, &domain->ufc_aggr->requests);
+	mutex_unlock(&ufc_lock);
+
+	ufc_update_request(req, freq);
+	req->update_count = 0;
+}
+
+/*
+ * Writers of user frequency nodes are accounted by thread group to find
+ * out who is issuing requests. When the table is full, the writer that
+ * was least recently seen is replaced.
+ */
+#define UFC_WRITER_MAX		16
+
+struct ufc_writer {
+	pid_t			tgid;
+	char			comm[TASK_COMM_LEN];
+	u64			count[TYPE_END];
+	int			last_input[TYPE_END];
+	ktime_t			last_time;
+};
+
+static struct ufc_writer ufc_writers[UFC_WRITER_MAX];
+
+static void ufc_account_writer(int type, int input)
+{
+	struct ufc_writer *writer = NULL;
+	pid_t tgid = task_tgid_nr(current);
+	int i;
+
+	mutex_lock(&ufc_lock);
+
+	for (i = 0; i < UFC_WRITER_MAX; i++) {
+		if (ufc_writers[i].tgid == tgid) {
+			writer = &ufc_writers[i];
+			break;
+		}
+
+		if (!writer || ktime_before(ufc_writers[i].last_time,
+						writer->last_time))
+			writer = &ufc_writers[i];
+	}
+
+	if (writer->tgid != tgid) {
+		memset(writer, 0, sizeof(*writer));
+		writer->tgid = tgid;
+		get_task_comm(writer->comm, current->group_leader);
+	}
+
+	writer->count[type]++;
+	writer->last_input[type] = input;
+	writer->last_time = ktime_get();
+
+	mutex_unlock(&ufc_lock);
+}
+
+static const char *ufc_class_name[UFC_REQ_CLASS_END] = { "min", "max" };
+
+static ssize_t show_cpufreq_ufc_requests(struct kobject *kobj,
+				struct attribute *attr, char *buf)
+{
+	struct list_head *domains = get_domain_list();
+	struct exynos_cpufreq_domain *domain;
+	struct ufc_request *req;
+	ssize_t count = 0;
+	int i;
+
+	mutex_lock(&ufc_lock);
+
+	list_for_each_entry(domain, domains, list) {
+		struct ufc_aggr *aggr = domain->ufc_aggr;
+
+		if (!aggr)
+			continue;
+
+		count += snprintf(buf + count, PAGE_SIZE - count,
+				"domain%d: min=%u (updates=%llu) max=%u (updates=%llu)\n",
+				domain->id,
+				aggr->qos_value[UFC_REQ_MIN],
+				aggr->qos_update_count[UFC_REQ_MIN],
+				aggr->qos_value[UFC_REQ_MAX],
+				aggr->qos_update_count[UFC_REQ_MAX]);
+
+		list_for_each_entry(req, &aggr->requests, list)
+			count += snprintf(buf + count, PAGE_SIZE - count,
+				"  %-16s %s freq=%u level=%d updates=%llu\n",
+				req->name, ufc_class_name[req->req_class],
+				req->freq, req->level, req->update_count);
+	}
+
+	count += snprintf(buf + count, PAGE_SIZE - count,
+			"writers: tgid comm min_limit min_wo_boost max_limit\n");
+
+	for (i = 0; i < UFC_WRITER_MAX; i++) {
+		struct ufc_writer *writer = &ufc_writers[i];
+
+		if (!writer->tgid)
+			continue;
+
+		count += snprintf(buf + count, PAGE_SIZE - count,
+			"  %d %-16s %llu(%d) %llu(%d) %llu(%d)\n",
+			writer->tgid, writer->comm,
+			writer->count[PM_QOS_MIN_LIMIT],
+			writer->last_input[PM_QOS_MIN_LIMIT],
+			writer->count[PM_QOS_MIN_WO_BOOST_LIMIT],
+			writer->last_input[PM_QOS_MIN_WO_BOOST_LIMIT],
+			writer->count[PM_QOS_MAX_LIMIT],
+			writer->last_input[PM_QOS_MAX_LIMIT]);
+	}
+
+	mutex_unlock(&ufc_lock);
+
+	return count;
+}
+
 /*********************************************************************
  *                          SYSFS INTERFACES                         *
  *********************************************************************/
@@ -116,6 +345,8 @@ static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
 	if (!sscanf(buf, "%8d", &input))
 		return -EINVAL;
 
+	ufc_account_writer(PM_QOS_MIN_LIMIT, input);
+
 	if (!domains) {
 		pr_err("failed to get domains!\n");
 		return -ENXIO;
@@ -148,7 +379,7 @@ static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
 
 		if (set_limit) {
 			req_limit_freq = min(req_limit_freq, domain->max_freq);
-			pm_qos_update_request(&domain->user_min_qos_req, req_limit_freq);
+			ufc_update_request(&domain->user_min_req, req_limit_freq);
 			set_limit = false;
 			continue;
 		}
@@ -159,13 +390,13 @@ static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
 			if (domain->user_default_qos)
 				qos = domain->user_default_qos;
 
-			pm_qos_update_request(&domain->user_min_qos_req, qos);
+			ufc_update_request(&domain->user_min_req, qos);
 			continue;
 		}
 
 		/* Clear all constraint by cpufreq_min_limit */
 		if (input < 0) {
-			pm_qos_update_request(&domain->user_min_qos_req, 0);
+			ufc_update_request(&domain->user_min_req, 0);
 			kpp_request(STUNE_TOPAPP, &kpp_ta, 0);
 			kpp_request(STUNE_FOREGROUND, &kpp_fg, 0);
 			continue;
@@ -181,7 +412,7 @@ static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
 		freq = input << (scale * SCALE_SIZE);
 
 		if (freq < domain->min_freq) {
-			pm_qos_update_request(&domain->user_min_qos_req, 0);
+			ufc_update_request(&domain->user_min_req, 0);
 			continue;
 		}
 
@@ -193,7 +424,7 @@ static ssize_t store_cpufreq_min_limit(struct kobject *kobj,
 		}
 
 		freq = min(freq, domain->max_freq);
-		pm_qos_update_request(&domain->user_min_qos_req, freq);
+		ufc_update_request(&domain->user_min_req, freq);
 
 		kpp_request(STUNE_TOPAPP, &kpp_ta, domain->user_boost);
 		kpp_request(STUNE_FOREGROUND, &kpp_fg, domain->user_boost);
@@ -221,6 +452,8 @@ static ssize_t store_cpufreq_min_limit_wo_boost(struct kobject *kobj,
 	if (!sscanf(buf, "%8d", &input))
 		return -EINVAL;
 
+	ufc_account_writer(PM_QOS_MIN_WO_BOOST_LIMIT, input);
+
 	if (!domains) {
 		pr_err("failed to get domains!\n");
 		return -ENXIO;
@@ -253,7 +486,7 @@ static ssize_t store_cpufreq_min_limit_wo_boost(struct kobject *kobj,
 
 		if (set_limit) {
 			req_limit_freq = min(req_limit_freq, domain->max_freq);
-			pm_qos_update_request(&domain->user_min_qos_req, req_limit_freq);
+			ufc_update_request(&domain->user_min_req, req_limit_freq);
 			set_limit = false;
 			continue;
 		}
@@ -264,13 +497,13 @@ static ssize_t store_cpufreq_min_limit_wo_boost(struct kobject *kobj,
 			if (domain->user_default_qos)
 				qos = domain->user_default_qos;
 
-			pm_qos_update_request(&domain->user_min_qos_wo_boost_req, qos);
+			ufc_update_request(&domain->user_min_wo_boost_req, qos);
 			continue;
 		}
 
 		/* Clear all constraint by cpufreq_min_limit */
 		if (input < 0) {
-			pm_qos_update_request(&domain->user_min_qos_wo_boost_req, 0);
+			ufc_update_request(&domain->user_min_wo_boost_req, 0);
 			continue;
 		}
 
@@ -284,7 +517,7 @@ static ssize_t store_cpufreq_min_limit_wo_boost(struct kobject *kobj,
 		freq = input << (scale * SCALE_SIZE);
 
 		if (freq < domain->min_freq) {
-			pm_qos_update_request(&domain->user_min_qos_wo_boost_req, 0);
+			ufc_update_request(&domain->user_min_wo_boost_req, 0);
 			continue;
 		}
 
@@ -296,7 +529,7 @@ static ssize_t store_cpufreq_min_limit_wo_boost(struct kobject *kobj,
 		}
 
 		freq = min(freq, domain->max_freq);
-		pm_qos_update_request(&domain->user_min_qos_wo_boost_req, freq);
+		ufc_update_request(&domain->user_min_wo_boost_req, freq);
 
 		set_max = true;
 	}
@@ -385,6 +618,8 @@ static ssize_t store_cpufreq_max_limit(struct kobject *kobj, struct attribute *a
 	if (!sscanf(buf, "%8d", &input))
 		return -EINVAL;
 
+	ufc_account_writer(PM_QOS_MAX_LIMIT, input);
+
 	list_for_each_entry_reverse(domain, domains, list) {
 		struct exynos_ufc *ufc, *r_ufc;
 		struct cpufreq_policy *policy = NULL;
@@ -408,14 +643,14 @@ static ssize_t store_cpufreq_max_limit(struct kobject *kobj, struct attribute *a
 
 		if (set_limit) {
 			req_limit_freq = max(req_limit_freq, domain->min_freq);
-			pm_qos_update_request(&domain->user_max_qos_req,
+			ufc_update_request(&domain->user_max_req,
 					req_limit_freq);
 			set_limit = false;
 			continue;
 		}
 
 		if (set_max) {
-			pm_qos_update_request(&domain->user_max_qos_req,
+			ufc_update_request(&domain->user_max_req,
 					domain->max_freq);
 			continue;
 		}
@@ -423,7 +658,7 @@ static ssize_t store_cpufreq_max_limit(struct kobject *kobj, struct attribute *a
 		/* Clear all constraint by cpufreq_max_limit */
 		if (input < 0) {
 			enable_domain_cpus(domain);
-			pm_qos_update_request(&domain->user_max_qos_req,
+			ufc_update_request(&domain->user_max_req,
 						domain->max_freq);
 			continue;
 		}
@@ -446,7 +681,7 @@ static ssize_t store_cpufreq_max_limit(struct kobject *kobj, struct attribute *a
 
 		if (freq < domain->min_freq) {
 			set_limit = false;
-			pm_qos_update_request(&domain->user_max_qos_req, 0);
+			ufc_update_request(&domain->user_max_req, 0);
 			disable_domain_cpus(domain);
 			continue;
 		}
@@ -454,7 +689,7 @@ static ssize_t store_cpufreq_max_limit(struct kobject *kobj, struct attribute *a
 		enable_domain_cpus(domain);
 
 		freq = max(freq, domain->min_freq);
-		pm_qos_update_request(&domain->user_max_qos_req, freq);
+		ufc_update_request(&domain->user_max_req, freq);
 
 		set_max = true;
 	}
@@ -473,6 +708,8 @@ __ATTR(cpufreq_min_limit_wo_boost, 0644,
 static struct global_attr cpufreq_max_limit =
 __ATTR(cpufreq_max_limit, 0644,
 		show_cpufreq_max_limit, store_cpufreq_max_limit);
+static struct global_attr cpufreq_ufc_requests =
+__ATTR(cpufreq_ufc_requests, 0444, show_cpufreq_ufc_requests, NULL);
 
 static __init void init_sysfs(void)
 {
@@ -488,6 +725,8 @@ static __init void init_sysfs(void)
 	if (sysfs_create_file(power_kobj, &cpufreq_max_limit.attr))
 		pr_err("failed to create cpufreq_max_limit node\n");
 
+	if (sysfs_create_file(power_kobj, &cpufreq_ufc_requests.attr))
+		pr_err("failed to create cpufreq_ufc_requests node\n");
 }
 
 static int parse_ufc_ctrl_info(struct exynos_cpufreq_domain *domain,
@@ -504,14 +743,63 @@ static int parse_ufc_ctrl_info(struct exynos_cpufreq_domain *domain,
 	return 0;
 }
 
-static __init void init_pm_qos(struct exynos_cpufreq_domain *domain)
+static int ufc_cmp_freq(const void *a, const void *b)
+{
+	unsigned int fa = *(const unsigned int *)a;
+	unsigned int fb = *(const unsigned int *)b;
+
+	return fa < fb ? -1 : fa > fb;
+}
+
+static __init int init_pm_qos(struct exynos_cpufreq_domain *domain)
 {
-	pm_qos_add_request(&domain->user_min_qos_req,
+	struct ufc_aggr *aggr;
+	int index;
+
+	aggr = kzalloc(sizeof(struct ufc_aggr), GFP_KERNEL);
+	if (!aggr)
+		return -ENOMEM;
+
+	for (index = 0; index < domain->table_size; index++) {
+		unsigned int freq = domain->freq_table[index].frequency;
+
+		if (freq == CPUFREQ_ENTRY_INVALID)
+			continue;
+
+		if (aggr->level_count == UFC_LEVEL_MAX) {
+			pr_warn("domain%d has too many frequencies for ufc\n",
+							domain->id);
+			break;
+		}
+
+		aggr->level_freq[aggr->level_count++] = freq;
+	}
+
+	if (!aggr->level_count) {
+		kfree(aggr);
+		return -EINVAL;
+	}
+
+	sort(aggr->level_freq, aggr->level_count, sizeof(unsigned int),
+						ufc_cmp_freq, NULL);
+
+	INIT_LIST_HEAD(&aggr->requests);
+	aggr->qos_value[UFC_REQ_MIN] = domain->min_freq;
+	aggr->qos_value[UFC_REQ_MAX] = domain->max_freq;
+	pm_qos_add_request(&aggr->qos_req[UFC_REQ_MIN],
 			domain->pm_qos_min_class, domain->min_freq);
-	pm_qos_add_request(&domain->user_max_qos_req,
+	pm_qos_add_request(&aggr->qos_req[UFC_REQ_MAX],
 			domain->pm_qos_max_class, domain->max_freq);
-	pm_qos_add_request(&domain->user_min_qos_wo_boost_req,
-			domain->pm_qos_min_class, domain->min_freq);
+	domain->ufc_aggr = aggr;
+
+	ufc_add_request(domain, &domain->user_min_req,
+			"min_limit", UFC_REQ_MIN, 0);
+	ufc_add_request(domain, &domain->user_min_wo_boost_req,
+			"min_wo_boost", UFC_REQ_MIN, 0);
+	ufc_add_request(domain, &domain->user_max_req,
+			"max_limit", UFC_REQ_MAX, domain->max_freq);
+
+	return 0;
 }
 
 int ufc_domain_init(struct exynos_cpufreq_domain *domain)
@@ -643,7 +931,11 @@ static int __init exynos_ufc_init(void)
 			goto exit;
 		}
 		/* Initialize PM QoS */
-		init_pm_qos(domain);
+		ret = init_pm_qos(domain);
+		if (ret) {
+			pr_err("failed to initialize pm qos for ufc\n");
+			goto exit;
+		}
 		pr_info("Complete to initialize domain%d\n",domain->id);
 	}
 
@@ -9,6 +9,7 @@
  */
 
 #include <linux/cpufreq.h>
+#include <linux/pm_qos.h>
 
 #define EXYNOS_UFC_TYPE_NAME_LEN	16
 
@@ -30,3 +31,51 @@ struct exynos_ufc_info {
 
 	struct exynos_ufc_freq *freq_table;
 };
+
+/*
+ * User frequency requests are aggregated per domain and class. A request
+ * is counted in the bucket of the frequency level it resolves to, and a
+ * bit of the level mask is set while the bucket is not empty, so adding,
+ * removing and finding the strongest request are all O(1). Only the
+ * aggregated value is handed to PM QoS, and only when it changes.
+ */
+#define UFC_LEVEL_MAX		BITS_PER_LONG
+#define UFC_REQ_NAME_LEN	16
+
+enum ufc_req_class {
+	UFC_REQ_MIN = 0,
+	UFC_REQ_MAX,
+	UFC_REQ_CLASS_END
+};
+
+struct ufc_bucket {
+	unsigned int		count[UFC_LEVEL_MAX];
+	unsigned long		mask;
+};
+
+struct ufc_aggr {
+	/* valid frequencies of domain in ascending order */
+	unsigned int		level_count;
+	unsigned int		level_freq[UFC_LEVEL_MAX];
+
+	struct ufc_bucket	bucket[UFC_REQ_CLASS_END];
+	struct pm_qos_request	qos_req[UFC_REQ_CLASS_END];
+	unsigned int		qos_value[UFC_REQ_CLASS_END];
+	u64			qos_update_count[UFC_REQ_CLASS_END];
+
+	struct list_head	requests;
+};
+
+struct exynos_cpufreq_domain;
+
+struct ufc_request {
+	struct list_head	list;
+	char			name[UFC_REQ_NAME_LEN];
+	struct exynos_cpufreq_domain *domain;
+	int			req_class;
+
+	/* level in bucket, -1 if request does not constrain */
+	int			level;
+	unsigned int		freq;
+	u64			update_count;
+};
@@ -56,11 +56,12 @@ static void post_idle(unsigned int cpu, int index, int fail)
 {
 	cpuidle_profile_cpu_idle_exit(cpu, index, fail);
 
-	if (!index)
-		return;
+	if (index) {
+		exynos_cpu_pm_exit(cpu, fail);
+		cpu_pm_exit();
+	}
 
-	exynos_cpu_pm_exit(cpu, fail);
-	cpu_pm_exit();
+	cpuidle_profile_cpu_idle_exit_done(cpu, index);
 }
 
 static int enter_idle(unsigned int index)
@@ -11,7 +11,12 @@
 #include <linux/device.h>
 #include <linux/kobject.h>
 #include <linux/cpuidle.h>
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/log2.h>
 #include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
 
 /* whether profiling has started */
 static bool profile_started;
@@ -67,6 +72,16 @@ struct group_idle_state {
 
 	/* idle state statstics */
 	struct cpuidle_stats	stats;
+
+	/*
+	 * Accuracy of idle prediction.
+	 * hit/early : number of times the state is exited after/before
+	 *             target residency
+	 * prevent   : number of times the entry is prevented by prediction
+	 */
+	unsigned int		predict_hit;
+	unsigned int		predict_early;
+	unsigned int		predict_prevent;
 };
 
 /*
@@ -80,6 +95,43 @@ struct group_idle_state {
 static struct group_idle_state * group_idle_state[MAX_GROUP_IDLE_STATE];
 static int group_idle_state_count;
 
+/*
+ * Histogram of idle state
+ * Unlike the statistics above, histograms are always collected regardless
+ * of profile start/stop. Bucket i counts the values of [2^i, 2^(i+1)) usec,
+ * the last bucket counts all larger values. Each cpu updates only its own
+ * buffer in idle path, so no lock is needed. Readers may see a slightly
+ * stale snapshot.
+ */
+#define HIST_SIZE	16
+
+struct cpuidle_hist {
+	/* time in idle state */
+	u32			residency[HIST_SIZE];
+
+	/* time from wakeup to the end of idle exit sequence */
+	u32			exit_latency[HIST_SIZE];
+};
+
+struct cpuidle_hist_buf {
+	ktime_t			entry_time;
+	ktime_t			exit_time;
+
+	struct cpuidle_hist	hist[CPUIDLE_STATE_MAX];
+};
+
+static DEFINE_PER_CPU(struct cpuidle_hist_buf, cpuidle_hist_buf);
+
+static inline void hist_add(u32 *hist, s64 value)
+{
+	int bucket = value > 1 ? ilog2((u64)value) : 0;
+
+	if (bucket >= HIST_SIZE)
+		bucket = HIST_SIZE - 1;
+
+	hist[bucket]++;
+}
+
 /************************************************************************
  *                              Profiling                               *
  ************************************************************************/
@@ -120,6 +172,10 @@ static void idle_exit(struct cpuidle_stats *stats, int cancel)
  */
 void cpuidle_profile_cpu_idle_enter(int cpu, int index)
 {
+	struct cpuidle_hist_buf *buf = per_cpu_ptr(&cpuidle_hist_buf, cpu);
+
+	buf->entry_time = ktime_get();
+
 	if (!profile_started)
 		return;
 
@@ -128,12 +184,38 @@ void cpuidle_profile_cpu_idle_enter(int cpu, int index)
 
 void cpuidle_profile_cpu_idle_exit(int cpu, int index, int cancel)
 {
+	struct cpuidle_hist_buf *buf = per_cpu_ptr(&cpuidle_hist_buf, cpu);
+
+	if (cancel)
+		buf->exit_time = 0;
+	else if (buf->entry_time && index < CPUIDLE_STATE_MAX) {
+		buf->exit_time = ktime_get();
+		hist_add(buf->hist[index].residency,
+			ktime_us_delta(buf->exit_time, buf->entry_time));
+	}
+
 	if (!profile_started)
 		return;
 
 	idle_exit(&cpu_idle_state[index].stats[cpu], cancel);
 }
 
+/*
+ * cpuidle_profile_cpu_idle_exit_done
+ * : called at the end of idle exit sequence to profile exit latency
+ */
+void cpuidle_profile_cpu_idle_exit_done(int cpu, int index)
+{
+	struct cpuidle_hist_buf *buf = per_cpu_ptr(&cpuidle_hist_buf, cpu);
+
+	if (!buf->exit_time || index >= CPUIDLE_STATE_MAX)
+		return;
+
+	hist_add(buf->hist[index].exit_latency,
+		ktime_us_delta(ktime_get(), buf->exit_time));
+	buf->exit_time = 0;
+}
+
 /*
  * cpuidle_profile_group_idle_enter/cpuidle_profile_group_idle_exit
  * : profilie for group idle state
@@ -166,6 +248,50 @@ void cpuidle_profile_group_idle_exit(int id, int cancel)
 	idle_exit(&group_idle_state[i]->stats, cancel);
 }
 
+static struct group_idle_state *find_group_idle_state(int id)
+{
+	int i;
+
+	for (i = 0; i < group_idle_state_count; i++)
+		if (group_idle_state[i]->id == id)
+			return group_idle_state[i];
+
+	return NULL;
+}
+
+/*
+ * cpuidle_profile_group_idle_residency/cpuidle_profile_group_idle_prevent
+ * : profile accuracy of idle prediction for group idle state
+ */
+void cpuidle_profile_group_idle_residency(int id, int early)
+{
+	struct group_idle_state *state;
+
+	if (!profile_started)
+		return;
+
+	state = find_group_idle_state(id);
+	if (!state)
+		return;
+
+	if (early)
+		state->predict_early++;
+	else
+		state->predict_hit++;
+}
+
+void cpuidle_profile_group_idle_prevent(int id)
+{
+	struct group_idle_state *state;
+
+	if (!profile_started)
+		return;
+
+	state = find_group_idle_state(id);
+	if (state)
+		state->predict_prevent++;
+}
+
 /************************************************************************
  *                          Profile start/stop                          *
  ************************************************************************/
@@ -201,8 +327,12 @@ static void reset_profile(void)
 		for_each_possible_cpu(cpu)
 			clear_stats(&cpu_idle_state[i].stats[cpu]);
 
-	for (i = 0; i < group_idle_state_count; i++)
+	for (i = 0; i < group_idle_state_count; i++) {
 		clear_stats(&group_idle_state[i]->stats);
+		group_idle_state[i]->predict_hit = 0;
+		group_idle_state[i]->predict_early = 0;
+		group_idle_state[i]->predict_prevent = 0;
+	}
 
 	memset(idle_ip_stats, 0, sizeof(idle_ip_stats));
 }
@@ -399,6 +529,30 @@ static ssize_t show_result(struct kobject *kobj,
 				"\n");
 	}
 
+	/*
+	 * Example of idle prediction result.
+	 * hit and early are the number of times group idle state is exited
+	 * after and before target residency, prevent is the number of times
+	 * entry is prevented by prediction.
+	 *
+	 * [idle prediction]
+	 * #state             #hit   #early  #prevent
+	 * CLUSTER0             48        4        31
+	 */
+	ret += snprintf(buf + ret, PAGE_SIZE - ret, "[idle prediction]\n");
+	ret += snprintf(buf + ret, PAGE_SIZE - ret,
+		"#state             #hit   #early  #prevent\n");
+	for (i = 0; i < group_idle_state_count; i++)
+		ret += snprintf(buf + ret, PAGE_SIZE - ret,
+			"%-16s %6u   %6u    %6u\n",
+			group_idle_state[i]->desc,
+			group_idle_state[i]->predict_hit,
+			group_idle_state[i]->predict_early,
+			group_idle_state[i]->predict_prevent);
+
+	ret += snprintf(buf + ret, PAGE_SIZE - ret,
+			"\n");
+
 	ret += snprintf(buf + ret, PAGE_SIZE - ret, "[IDLE-IP statistics]\n");
 	for (i = 0; i < 4; i++) {
 		for (bit = 0; bit < 32; bit++) {
@@ -464,6 +618,108 @@ static const struct attribute_group cpuidle_profile_group = {
 	.attrs = cpuidle_profile_attrs,
 };
 
+/*********************************************************************
+ *                         Debugfs interface                         *
+ *********************************************************************/
+/*
+ * Binary layout of /sys/kernel/debug/cpuidle_profiler/histogram
+ *
+ * struct cpuidle_hist_header
+ * for each possible cpu (ascending order)
+ *	for each cpu idle state
+ *		u32 residency[hist_size]
+ *		u32 exit_latency[hist_size]
+ */
+#define CPUIDLE_HIST_MAGIC	0x43494850	/* "CIHP" */
+#define CPUIDLE_HIST_VERSION	1
+
+struct cpuidle_hist_header {
+	u32			magic;
+	u32			version;
+	u32			nr_cpus;
+	u32			nr_states;
+	u32			hist_size;
+	u32			reserved;
+};
+
+struct cpuidle_hist_snapshot {
+	size_t			size;
+	char			data[0];
+};
+
+static int cpuidle_hist_open(struct inode *inode, struct file *file)
+{
+	struct cpuidle_hist_snapshot *snapshot;
+	struct cpuidle_hist_header *header;
+	int state_count = min(cpu_idle_state_count, CPUIDLE_STATE_MAX);
+	size_t size, hist_size = sizeof(struct cpuidle_hist) * state_count;
+	char *pos;
+	int cpu;
+
+	size = sizeof(*header) + hist_size * num_possible_cpus();
+	snapshot = vmalloc(sizeof(*snapshot) + size);
+	if (!snapshot)
+		return -ENOMEM;
+
+	snapshot->size = size;
+
+	header = (struct cpuidle_hist_header *)snapshot->data;
+	header->magic = CPUIDLE_HIST_MAGIC;
+	header->version = CPUIDLE_HIST_VERSION;
+	header->nr_cpus = num_possible_cpus();
+	header->nr_states = state_count;
+	header->hist_size = HIST_SIZE;
+	header->reserved = 0;
+
+	pos = snapshot->data + sizeof(*header);
+	for_each_possible_cpu(cpu) {
+		memcpy(pos, per_cpu_ptr(&cpuidle_hist_buf, cpu)->hist, hist_size);
+		pos += hist_size;
+	}
+
+	file->private_data = snapshot;
+
+	return 0;
+}
+
+static ssize_t cpuidle_hist_read(struct file *file, char __user *ubuf,
+				size_t count, loff_t *ppos)
+{
+	struct cpuidle_hist_snapshot *snapshot = file->private_data;
+
+	return simple_read_from_buffer(ubuf, count, ppos,
+				snapshot->data, snapshot->size);
+}
+
+static int cpuidle_hist_release(struct inode *inode, struct file *file)
+{
+	vfree(file->private_data);
+
+	return 0;
+}
+
+static const struct file_operations cpuidle_hist_fops = {
+	.open		= cpuidle_hist_open,
+	.read		= cpuidle_hist_read,
+	.release	= cpuidle_hist_release,
+	.llseek		= default_llseek,
+};
+
+static void __init cpuidle_hist_debugfs_init(void)
+{
+	struct dentry *root;
+
+	root = debugfs_create_dir("cpuidle_profiler", NULL);
+	if (!root) {
+		pr_err("%s: failed to create debugfs directory\n", __func__);
+		return;
+	}
+
+	if (!debugfs_create_file("histogram", 0444, root, NULL,
+					&cpuidle_hist_fops))
+		pr_err("%s: failed to create debugfs file\n", __func__);
+}
+
 /*********************************************************************
  *                   Initialize cpuidle profiler                     *
  *********************************************************************/
@@ -519,6 +775,8 @@ static int __init cpuidle_profile_init(void)
 	if (ret)
 		pr_err("%s: failed to create sysfs group", __func__);
 
+	cpuidle_hist_debugfs_init();
+
 	return ret;
 }
 late_initcall(cpuidle_profile_init);
@@ -20,6 +20,9 @@
 #include <linux/crypto.h>
 #include <crypto/fmp.h>
 #include <linux/scatterlist.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/percpu.h>
 
 #include "fmp_test.h"
 #include "fmp_fips_main.h"
@@ -134,11 +137,15 @@ int fmplib_set_algo_mode(struct fmp_table_setting *table,
 	return 0;
 }
 
-static int fmplib_set_file_key(struct fmp_table_setting *table,
-			struct fmp_crypto_info *crypto)
+/*
+ * Expands the file key into the order of file_enckey0..file_twkey7 of the
+ * descriptor.
+ */
+static int fmplib_expand_file_key(u32 *words, struct fmp_crypto_info *crypto)
 {
 	enum fmp_crypto_algo_mode algo_mode = crypto->algo_mode;
 	enum fmp_crypto_key_size key_size = crypto->fmp_key_size;
+	u32 *twkey = words + FMP_KEY_WORDS / 2;
 	char *key = crypto->key;
 	int idx, max;
 
@@ -157,24 +164,42 @@ static int fmplib_set_file_key(struct fmp_table_setting *table,
 		return -EINVAL;
 	}
 
+	memset(words, 0, sizeof(u32) * FMP_KEY_WORDS);
 	if (algo_mode == EXYNOS_FMP_ALGO_MODE_AES_CBC) {
 		max = key_size / WORD_SIZE;
 		for (idx = 0; idx < max; idx++)
-			*(&table->file_enckey0 + idx) =
-			    get_word(key, max - (idx + 1));
+			words[idx] = get_word(key, max - (idx + 1));
 	} else if (algo_mode == EXYNOS_FMP_ALGO_MODE_AES_XTS) {
 		key_size *= 2;
 		max = key_size / WORD_SIZE;
 		for (idx = 0; idx < (max / 2); idx++)
-			*(&table->file_enckey0 + idx) =
-			    get_word(key, (max / 2) - (idx + 1));
+			words[idx] = get_word(key, (max / 2) - (idx + 1));
 		for (idx = 0; idx < (max / 2); idx++)
-			*(&table->file_twkey0 + idx) =
-			    get_word(key, max - (idx + 1));
+			twkey[idx] = get_word(key, max - (idx + 1));
 	}
 	return 0;
 }
 
+/* Returns true if the key was copied from the expansion of setkey */
+static bool fmplib_set_file_key(struct fmp_table_setting *table,
+			struct fmp_crypto_info *crypto, int *ret)
+{
+	u32 words[FMP_KEY_WORDS];
+
+	if (likely(crypto->key_expanded)) {
+		memcpy(&table->file_enckey0, crypto->key_words,
+				sizeof(crypto->key_words));
+		*ret = 0;
+		return true;
+	}
+
+	*ret = fmplib_expand_file_key(words, crypto);
+	if (!*ret)
+		memcpy(&table->file_enckey0, words, sizeof(words));
+	memzero_explicit(words, sizeof(words));
+	return false;
+}
+
 static int fmplib_set_key_size(struct fmp_table_setting *table,
 			struct fmp_crypto_info *crypto, bool cmdq_enabled)
 {
@@ -281,6 +306,8 @@ int exynos_fmp_crypt(struct fmp_crypto_info *ci, void *priv)
 	int ret = 0;
 	u8 iv[FMP_IV_SIZE_16];
 	bool test_mode = 0;
+	bool key_hit = false;
+	u64 start = ktime_get_ns();
 
 	if (!r || !fmp) {
 		pr_err("%s: invalid req:%p, fmp:%p\n", __func__, r, fmp);
@@ -340,7 +367,7 @@ int exynos_fmp_crypt(struct fmp_crypto_info *ci, void *priv)
 	/* set key size into table */
 	switch (ci->enc_mode) {
 	case EXYNOS_FMP_FILE_ENC:
-		ret = fmplib_set_file_key(r->table, ci);
+		key_hit = fmplib_set_file_key(r->table, ci, &ret);
 		if (ret) {
 			dev_err(fmp->dev, "%s: Fail to set FMP key\n",
 				__func__);
@@ -389,6 +416,16 @@ out:
 		dump_ci(ci);
 		if (r && r->table)
 			dump_table(r->table);
+	} else if (fmp->stat) {
+		struct fmp_stat *stat = get_cpu_ptr(fmp->stat);
+		u64 ns = ktime_get_ns() - start;
+
+		stat->crypt++;
+		stat->key_hit += key_hit;
+		stat->setup_ns += ns;
+		if (ns > stat->setup_max_ns)
+			stat->setup_max_ns = ns;
+		put_cpu_ptr(fmp->stat);
 	}
 	return ret;
 }
@@ -480,6 +517,9 @@ int exynos_fmp_setkey(struct fmp_crypto_info *ci, u8 *in_key, u32 keylen,
 		ci->enc_mode = EXYNOS_FMP_FILE_ENC;
 		memset(ci->key, 0, sizeof(ci->key));
 		memcpy(ci->key, in_key, ci->key_size);
+
+		/* invalid keys are rejected again when a request uses them */
+		ci->key_expanded = !fmplib_expand_file_key(ci->key_words, ci);
 	}
 	return ret;
 }
@@ -502,6 +542,8 @@ int exynos_fmp_clearkey(struct fmp_crypto_info *ci)
 	} else if (ci->enc_mode == EXYNOS_FMP_FILE_ENC) {
 		memset(ci->key, 0, sizeof(ci->key));
 		ci->key_size = 0;
+		ci->key_expanded = false;
+		memzero_explicit(ci->key_words, sizeof(ci->key_words));
 	} else {
 		pr_err("%s: invalid algo mode:%d\n", __func__, ci->enc_mode);
 		ret = -EINVAL;
@@ -557,6 +599,31 @@ err:
 #endif
 
 #define CFG_DESCTYPE_3 0x3
+static ssize_t fmp_stat_show(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct exynos_fmp *fmp = dev_get_drvdata(dev);
+	struct fmp_stat sum = {0, };
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct fmp_stat *stat = per_cpu_ptr(fmp->stat, cpu);
+
+		sum.crypt += stat->crypt;
+		sum.key_hit += stat->key_hit;
+		sum.setup_ns += stat->setup_ns;
+		sum.setup_max_ns = max(sum.setup_max_ns, stat->setup_max_ns);
+	}
+
+	return snprintf(buf, PAGE_SIZE,
+			"crypt:%llu key_hit:%llu avg_ns:%llu max_ns:%llu\n",
+			sum.crypt, sum.key_hit,
+			sum.crypt ? div64_u64(sum.setup_ns, sum.crypt) : 0,
+			sum.setup_max_ns);
+}
+
+static DEVICE_ATTR(fmp_stat, 0444, fmp_stat_show, NULL);
+
 int exynos_fmp_sec_config(int id)
 {
 	int ret;
@@ -617,6 +684,11 @@ void *exynos_fmp_init(struct platform_device *pdev)
 		goto err_dev;
 	}
 
+	fmp->stat = devm_alloc_percpu(fmp->dev, struct fmp_stat);
+	if (fmp->stat && device_create_file(fmp->dev, &dev_attr_fmp_stat))
+		dev_err(fmp->dev, "%s: Fail to create sysfs for fmp_stat\n",
+				__func__);
+
 	dev_info(fmp->dev, "Exynos FMP driver is initialized\n");
 	return fmp;
 
@@ -627,6 +699,8 @@ err_dev:
 
 void exynos_fmp_exit(struct exynos_fmp *fmp)
 {
+	if (fmp->stat)
+		device_remove_file(fmp->dev, &dev_attr_fmp_stat);
 	exynos_fmp_fips_exit(fmp);
 	kzfree(fmp);
 }
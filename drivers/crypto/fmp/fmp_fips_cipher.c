@@ -26,6 +26,7 @@ int fmp_cipher_set_key(struct fmp_test_data *fdata,
 	ci = &fdata->ci;
 	memset(ci->key, 0, FMP_MAX_KEY_SIZE);
 	ci->key_size = key_len;
+	ci->key_expanded = false;
 
 	if (ci->algo_mode == EXYNOS_FMP_ALGO_MODE_AES_CBC) {
 		switch (key_len) {
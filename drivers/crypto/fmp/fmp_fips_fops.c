@@ -10,8 +10,10 @@
  */
 
 #include <linux/completion.h>
+#include <linux/poll.h>
 #include <linux/rtnetlink.h>
 #include <linux/slab.h>
+#include <linux/workqueue.h>
 
 #include <crypto/fmp.h>
 #include <crypto/authenc.h>
@@ -38,7 +40,16 @@
  * These are free, pending and done items all together.
  */
 #define DEF_COP_RINGSIZE 16
-#define MAX_COP_RINGSIZE 64
+#define MAX_COP_RINGSIZE FMP_MAX_MULTI_OPS
+
+#ifdef CONFIG_COMPAT
+static int compat_kcop_from_user(struct fmp_fips_info *info,
+		struct kernel_crypt_op *kcop,
+		struct fcrypt *fcr, void __user *arg);
+static int compat_kcop_to_user(struct fmp_fips_info *info,
+		struct kernel_crypt_op *kcop,
+		struct fcrypt *fcr, void __user *arg);
+#endif
 
 static int fmp_fips_set_key(struct exynos_fmp *fmp, struct fmp_fips_info *info,
 			uint8_t *enckey, uint8_t *twkey, uint32_t key_len)
@@ -176,27 +187,26 @@ static ssize_t fmp_fips_hash_update(struct exynos_fmp *fmp,
 				struct hash_data *hdata,
 				struct scatterlist *sg, size_t len)
 {
-	int ret = -ENOMSG;
-	int8_t *buf;
+	int ret = 0;
 
-	buf = kmalloc(len, GFP_KERNEL);
-	if (!buf) {
-		ret = -ENOMEM;
-		goto exit;
-	}
+	/* the data is in lowmem pages, hashed in place */
+	for (; sg && len; sg = sg_next(sg)) {
+		size_t n = min_t(size_t, len, sg->length);
 
-	if (len != sg_copy_to_buffer(sg, 1, buf, len)) {
-		dev_err(fmp->dev, "%s: sg_copy_buffer error copying\n", __func__);
-		goto exit;
+		if (hdata->sha != NULL)
+			ret = sha256_update(hdata->sha, sg_virt(sg), n);
+		else
+			ret = hmac_sha256_update(hdata->hmac, sg_virt(sg), n);
+		if (ret)
+			break;
+		len -= n;
 	}
 
-	if (hdata->sha != NULL)
-		ret = sha256_update(hdata->sha, buf, len);
-	else
-		ret = hmac_sha256_update(hdata->hmac, buf, len);
+	if (!ret && len) {
+		dev_err(fmp->dev, "%s: %zu bytes beyond the sg\n", __func__, len);
+		ret = -ENOMSG;
+	}
 
-exit:
-	kzfree(buf);
 	return ret;
 }
 
@@ -343,6 +353,27 @@ static int __fmp_run_std(struct fmp_fips_info *info,
 	return ret;
 }
 
+/* Runs an async op on its kernel copy, one page at a time */
+static int __fmp_run_sg(struct fmp_fips_info *info,
+		struct csession *ses_ptr, struct kernel_crypt_op *kcop)
+{
+	struct exynos_fmp *fmp = info->fmp;
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < kcop->nents; i++) {
+		ret = fmp_n_crypt(info, ses_ptr, &kcop->cop, &kcop->sg[i],
+				&kcop->sg[i], kcop->sg[i].length);
+		if (unlikely(ret)) {
+			dev_err(fmp->dev, "fmp_n_crypt failed\n");
+			return ret;
+		}
+	}
+
+	kcop->copy_out = ses_ptr->cdata.init != 0;
+	return 0;
+}
+
 static int fmp_run(struct fmp_fips_info *info, struct fcrypt *fcr,
 				struct kernel_crypt_op *kcop)
 {
@@ -371,7 +402,8 @@ static int fmp_run(struct fmp_fips_info *info, struct fcrypt *fcr,
 
 	if ((ses_ptr->cdata.init != 0) && (cop->len > PAGE_SIZE)) {
 		dev_err(fmp->dev, "Invalid input length. len = %d\n", cop->len);
-		return -EINVAL;
+		ret = -EINVAL;
+		goto out_unlock;
 	}
 
 	if (ses_ptr->cdata.init != 0) {
@@ -400,7 +432,10 @@ static int fmp_run(struct fmp_fips_info *info, struct fcrypt *fcr,
 	}
 
 	if (likely(cop->len)) {
-		ret = __fmp_run_std(info, ses_ptr, &kcop->cop);
+		if (kcop->sg)
+			ret = __fmp_run_sg(info, ses_ptr, kcop);
+		else
+			ret = __fmp_run_std(info, ses_ptr, &kcop->cop);
 		if (unlikely(ret))
 			goto out_unlock;
 	}
@@ -885,9 +920,11 @@ static void fmptask_routine(struct work_struct *work)
 	list_cut_position(&tmp, &info->todo.list, info->todo.list.prev);
 	mutex_unlock(&info->todo.lock);
 
-	/* handle each job locklessly */
+	/* handle each job without the list locks */
 	list_for_each_entry(item, &tmp, __hook) {
+		mutex_lock(&info->run_lock);
 		item->result = fmp_run(info, &info->fcrypt, &item->kcop);
+		mutex_unlock(&info->run_lock);
 		if (unlikely(item->result))
 			dev_err(fmp->dev, "%s: crypto_run() failed: %d\n",
 					__func__, item->result);
@@ -937,6 +974,7 @@ int fmp_fips_open(struct inode *inode, struct file *file)
 	INIT_LIST_HEAD(&info->todo.list);
 	INIT_LIST_HEAD(&info->done.list);
 	INIT_WORK(&info->fmptask, fmptask_routine);
+	mutex_init(&info->run_lock);
 	mutex_init(&info->free.lock);
 	mutex_init(&info->todo.lock);
 	mutex_init(&info->done.lock);
@@ -983,6 +1021,9 @@ static int fill_kcop_from_cop(struct fmp_fips_info *info,
 		return -EINVAL;
 	}
 	kcop->digestsize = 0; /* will be updated during operation */
+	kcop->sg = NULL;
+	kcop->nents = 0;
+	kcop->copy_out = false;
 
 	fmp_put_session(ses_ptr);
 
@@ -1060,6 +1101,307 @@ static int kcop_to_user(struct fmp_fips_info *info, struct kernel_crypt_op *kcop
 	return 0;
 }
 
+static int fmp_kcop_from_user(struct fmp_fips_info *info,
+		struct kernel_crypt_op *kcop, struct fcrypt *fcr,
+		void __user *arg, bool compat)
+{
+#ifdef CONFIG_COMPAT
+	if (compat)
+		return compat_kcop_from_user(info, kcop, fcr, arg);
+#endif
+	return kcop_from_user(info, kcop, fcr, arg);
+}
+
+static int fmp_kcop_to_user(struct fmp_fips_info *info,
+		struct kernel_crypt_op *kcop, struct fcrypt *fcr,
+		void __user *arg, bool compat)
+{
+#ifdef CONFIG_COMPAT
+	if (compat)
+		return compat_kcop_to_user(info, kcop, fcr, arg);
+#endif
+	return kcop_to_user(info, kcop, fcr, arg);
+}
+
+static size_t fmp_cop_size(bool compat)
+{
+#ifdef CONFIG_COMPAT
+	if (compat)
+		return sizeof(struct compat_crypt_op);
+#endif
+	return sizeof(struct crypt_op);
+}
+
+static void fmp_kcop_free_sg(struct kernel_crypt_op *kcop)
+{
+	unsigned int i;
+
+	if (!kcop->sg)
+		return;
+
+	for (i = 0; i < kcop->nents; i++) {
+		struct page *page = sg_page(&kcop->sg[i]);
+
+		if (page) {
+			clear_page(page_address(page));
+			__free_page(page);
+		}
+	}
+	kfree(kcop->sg);
+	kcop->sg = NULL;
+	kcop->nents = 0;
+}
+
+/*
+ * Async ops run in the fmptask work, without the user mm. The source is
+ * copied to kernel pages when the op is queued, and the result is copied
+ * back when it is fetched, both from the ioctl.
+ */
+static int fmp_kcop_map(struct fmp_fips_info *info,
+		struct kernel_crypt_op *kcop)
+{
+	struct crypt_op *cop = &kcop->cop;
+	unsigned int i, nents;
+	size_t done = 0;
+	int ret;
+
+	if (cop->len > FMP_ASYNC_MAX_LEN) {
+		dev_err(info->fmp->dev, "Invalid async length. len = %u\n",
+				cop->len);
+		return -EINVAL;
+	}
+
+	nents = DIV_ROUND_UP(cop->len, PAGE_SIZE);
+	if (!nents)
+		return 0;
+
+	kcop->sg = kcalloc(nents, sizeof(*kcop->sg), GFP_KERNEL);
+	if (!kcop->sg)
+		return -ENOMEM;
+	sg_init_table(kcop->sg, nents);
+	kcop->nents = nents;
+
+	for (i = 0; i < nents; i++) {
+		size_t len = min_t(size_t, cop->len - done, PAGE_SIZE);
+		struct page *page = alloc_page(GFP_KERNEL);
+
+		if (!page) {
+			ret = -ENOMEM;
+			goto err;
+		}
+		sg_set_page(&kcop->sg[i], page, len, 0);
+
+		if (unlikely(copy_from_user(page_address(page),
+						cop->src + done, len))) {
+			ret = -EFAULT;
+			goto err;
+		}
+		done += len;
+	}
+
+	return 0;
+err:
+	fmp_kcop_free_sg(kcop);
+	return ret;
+}
+
+static int fmp_kcop_unmap(struct kernel_crypt_op *kcop)
+{
+	struct crypt_op *cop = &kcop->cop;
+	size_t done = 0;
+	unsigned int i;
+	int ret = 0;
+
+	if (kcop->copy_out && cop->dst) {
+		for (i = 0; i < kcop->nents; i++) {
+			struct scatterlist *sg = &kcop->sg[i];
+
+			if (unlikely(copy_to_user(cop->dst + done,
+						sg_virt(sg), sg->length))) {
+				ret = -EFAULT;
+				break;
+			}
+			done += sg->length;
+		}
+	}
+
+	fmp_kcop_free_sg(kcop);
+	return ret;
+}
+
+static struct todo_list_item *fmp_get_free_item(struct fmp_fips_info *info)
+{
+	struct todo_list_item *item = NULL;
+
+	mutex_lock(&info->free.lock);
+	if (!list_empty(&info->free.list)) {
+		item = list_first_entry(&info->free.list,
+				struct todo_list_item, __hook);
+		list_del(&item->__hook);
+	} else if (info->itemcount < MAX_COP_RINGSIZE) {
+		item = kzalloc(sizeof(*item), GFP_KERNEL);
+		if (item)
+			info->itemcount++;
+	}
+	mutex_unlock(&info->free.lock);
+
+	return item;
+}
+
+static void fmp_put_free_item(struct fmp_fips_info *info,
+		struct todo_list_item *item)
+{
+	mutex_lock(&info->free.lock);
+	list_add(&item->__hook, &info->free.list);
+	mutex_unlock(&info->free.lock);
+
+	/* wake for POLLOUT */
+	wake_up_interruptible(&info->user_waiter);
+}
+
+static int fmp_crypt_sync(struct fmp_fips_info *info, struct fcrypt *fcr,
+		void __user *arg, bool compat)
+{
+	struct exynos_fmp *fmp = info->fmp;
+	struct kernel_crypt_op kcop;
+	int ret;
+
+	ret = fmp_kcop_from_user(info, &kcop, fcr, arg, compat);
+	if (unlikely(ret)) {
+		dev_err(fmp->dev, "%s: Error copying from user", __func__);
+		return ret;
+	}
+
+	if (unlikely(in_fmp_fips_err())) {
+		dev_err(fmp->dev, "%s: Fail to run fmp due to fips in error.",
+				__func__);
+		return -EPERM;
+	}
+
+	mutex_lock(&info->run_lock);
+	ret = fmp_run(info, fcr, &kcop);
+	mutex_unlock(&info->run_lock);
+	if (unlikely(ret)) {
+		dev_err(fmp->dev, "%s: Fail to run fmp crypt. ret = %d\n",
+			       __func__, ret);
+		return ret;
+	}
+	return fmp_kcop_to_user(info, &kcop, fcr, arg, compat);
+}
+
+/* Queues an op for fmptask, its result is fetched by FMPASYNCFETCH */
+static int fmp_crypt_async(struct fmp_fips_info *info, struct fcrypt *fcr,
+		void __user *arg, bool compat)
+{
+	struct exynos_fmp *fmp = info->fmp;
+	struct todo_list_item *item;
+	int ret;
+
+	if (unlikely(in_fmp_fips_err())) {
+		dev_err(fmp->dev, "%s: Fail to run fmp due to fips in error.",
+				__func__);
+		return -EPERM;
+	}
+
+	item = fmp_get_free_item(info);
+	if (!item)
+		return -EBUSY;
+
+	ret = fmp_kcop_from_user(info, &item->kcop, fcr, arg, compat);
+	if (likely(!ret))
+		ret = fmp_kcop_map(info, &item->kcop);
+	if (unlikely(ret)) {
+		dev_err(fmp->dev, "%s: Fail to queue fmp crypt. ret = %d\n",
+				__func__, ret);
+		fmp_put_free_item(info, item);
+		return ret;
+	}
+
+	mutex_lock(&info->todo.lock);
+	list_add_tail(&item->__hook, &info->todo.list);
+	mutex_unlock(&info->todo.lock);
+
+	queue_work(system_unbound_wq, &info->fmptask);
+	return 0;
+}
+
+/*
+ * Copies the oldest completed op back to @arg, with its src and dst for the
+ * caller to match it. Returns its result, or -EBUSY if none is completed.
+ */
+static int fmp_fetch_async(struct fmp_fips_info *info, struct fcrypt *fcr,
+		void __user *arg, bool compat)
+{
+	struct todo_list_item *item;
+	int ret;
+
+	mutex_lock(&info->done.lock);
+	if (list_empty(&info->done.list)) {
+		mutex_unlock(&info->done.lock);
+		return -EBUSY;
+	}
+	item = list_first_entry(&info->done.list, struct todo_list_item, __hook);
+	list_del(&item->__hook);
+	mutex_unlock(&info->done.lock);
+
+	ret = fmp_kcop_unmap(&item->kcop);
+	if (likely(!ret))
+		ret = fmp_kcop_to_user(info, &item->kcop, fcr, arg, compat);
+	if (likely(!ret))
+		ret = item->result;
+
+	fmp_put_free_item(info, item);
+	return ret;
+}
+
+/*
+ * Runs or queues the ops of @mop in order, stopping at the first failure.
+ * mop->count is updated to the number of ops run or queued.
+ */
+static int fmp_crypt_multi(struct fmp_fips_info *info, struct fcrypt *fcr,
+		struct crypt_multi_op *mop, bool compat, bool async)
+{
+	size_t size = fmp_cop_size(compat);
+	unsigned int i;
+	int ret = 0;
+
+	if (mop->count > FMP_MAX_MULTI_OPS)
+		return -EINVAL;
+
+	for (i = 0; i < mop->count; i++) {
+		void __user *uop = (u8 __user *)mop->ops + i * size;
+
+		if (async)
+			ret = fmp_crypt_async(info, fcr, uop, compat);
+		else
+			ret = fmp_crypt_sync(info, fcr, uop, compat);
+		if (ret)
+			break;
+	}
+	mop->count = i;
+
+	return ret;
+}
+
+unsigned int fmp_fips_poll(struct file *file, poll_table *wait)
+{
+	struct fmp_fips_info *info = file->private_data;
+	unsigned int mask = 0;
+
+	if (!info)
+		return POLLERR;
+
+	poll_wait(file, &info->user_waiter, wait);
+
+	if (!list_empty_careful(&info->done.list))
+		mask |= POLLIN | POLLRDNORM;
+	if (!list_empty_careful(&info->free.list) ||
+	    info->itemcount < MAX_COP_RINGSIZE)
+		mask |= POLLOUT | POLLWRNORM;
+
+	return mask;
+}
+
 static int get_session_info(struct fmp_fips_info *info,
 		struct fcrypt *fcr, struct session_info_op *siop)
 {
@@ -1096,6 +1438,7 @@ long fmp_fips_ioctl(struct file *file, unsigned int cmd, unsigned long arg_)
 	void __user *arg = (void __user *)arg_;
 	struct fcrypt *fcr;
 	struct session_info_op siop;
+	struct crypt_multi_op mop;
 	uint32_t ses;
 
 	if (!info || !info->fmp) {
@@ -1142,25 +1485,21 @@ long fmp_fips_ioctl(struct file *file, unsigned int cmd, unsigned long arg_)
 		}
 		return copy_to_user(arg, &siop, sizeof(siop));
 	case FMPCRYPT:
-		ret = kcop_from_user(info, &kcop, fcr, arg);
-		if (unlikely(ret)) {
-			dev_err(fmp->dev, "%s: Error copying from user", __func__);
-			return ret;
-		}
-
-		if (unlikely(in_fmp_fips_err())) {
-			dev_err(fmp->dev, "%s: Fail to run fmp due to fips in error.",
-					__func__);
-			return -EPERM;
-		}
-
-		ret = fmp_run(info, fcr, &kcop);
-		if (unlikely(ret)) {
-			dev_err(fmp->dev, "%s: Fail to run fmp crypt. ret = %d\n",
-				       __func__, ret);
-			return ret;
-		}
-		return kcop_to_user(info, &kcop, fcr, arg);
+		return fmp_crypt_sync(info, fcr, arg, false);
+	case FMPASYNCCRYPT:
+		return fmp_crypt_async(info, fcr, arg, false);
+	case FMPASYNCFETCH:
+		return fmp_fetch_async(info, fcr, arg, false);
+	case FMPCRYPTMULTI:
+	case FMPASYNCCRYPTMULTI:
+		if (unlikely(copy_from_user(&mop, arg, sizeof(mop))))
+			return -EFAULT;
+		ret = fmp_crypt_multi(info, fcr, &mop, false,
+				cmd == FMPASYNCCRYPTMULTI);
+		if (unlikely(put_user(mop.count,
+				&((struct crypt_multi_op __user *)arg)->count)))
+			return -EFAULT;
+		return ret;
 	case FMP_AES_CBC_MCT:
 		ret = kcop_from_user(info, &kcop, fcr, arg);
 		if (unlikely(ret)) {
@@ -1174,7 +1513,9 @@ long fmp_fips_ioctl(struct file *file, unsigned int cmd, unsigned long arg_)
 			return -EPERM;
 		}
 
+		mutex_lock(&info->run_lock);
 		ret = fmp_run_AES_CBC_MCT(info, fcr, &kcop);
+		mutex_unlock(&info->run_lock);
 		if (unlikely(ret)) {
 			dev_err(fmp->dev, "%s: Error in fmp_run_AES_CBC_MCT", __func__);
 			return ret;
@@ -1301,6 +1642,8 @@ long fmp_fips_compat_ioctl(struct file *file, unsigned int cmd,
 	int ret;
 	struct session_op sop;
 	struct compat_session_op compat_sop;
+	struct compat_crypt_multi_op compat_mop;
+	struct crypt_multi_op mop;
 	struct kernel_crypt_op kcop;
 	struct fmp_fips_info *info = file->private_data;
 	struct exynos_fmp *fmp;
@@ -1339,23 +1682,23 @@ long fmp_fips_compat_ioctl(struct file *file, unsigned int cmd,
 		}
 		return ret;
 	case COMPAT_FMPCRYPT:
-		ret = compat_kcop_from_user(info, &kcop, fcr, arg);
-		if (unlikely(ret)) {
-			dev_err(fmp->dev, "Error copying from user");
-			return ret;
-		}
-
-		if (unlikely(in_fmp_fips_err())) {
-			dev_err(fmp->dev, "Fail to run fmp due to fips in error.");
-			return -EPERM;
-		}
-
-		ret = fmp_run(info, fcr, &kcop);
-		if (unlikely(ret)) {
-			dev_err(fmp->dev, "Fail to run fm)p crypt. ret = %d\n", ret);
-			return ret;
-		}
-		return compat_kcop_to_user(info, &kcop, fcr, arg);
+		return fmp_crypt_sync(info, fcr, arg, true);
+	case COMPAT_FMPASYNCCRYPT:
+		return fmp_crypt_async(info, fcr, arg, true);
+	case COMPAT_FMPASYNCFETCH:
+		return fmp_fetch_async(info, fcr, arg, true);
+	case COMPAT_FMPCRYPTMULTI:
+	case COMPAT_FMPASYNCCRYPTMULTI:
+		if (unlikely(copy_from_user(&compat_mop, arg, sizeof(compat_mop))))
+			return -EFAULT;
+		mop.count = compat_mop.count;
+		mop.ops = compat_ptr(compat_mop.ops);
+		ret = fmp_crypt_multi(info, fcr, &mop, true,
+				cmd == COMPAT_FMPASYNCCRYPTMULTI);
+		if (unlikely(put_user(mop.count,
+			&((struct compat_crypt_multi_op __user *)arg)->count)))
+			return -EFAULT;
+		return ret;
 	case COMPAT_FMP_AES_CBC_MCT:
 		ret = compat_kcop_from_user(info, &kcop, fcr, arg);
 		if (unlikely(ret)) {
@@ -1368,7 +1711,9 @@ long fmp_fips_compat_ioctl(struct file *file, unsigned int cmd,
 			return -EPERM;
 		}
 
+		mutex_lock(&info->run_lock);
 		ret = fmp_run_AES_CBC_MCT(info, fcr, &kcop);
+		mutex_unlock(&info->run_lock);
 		if (unlikely(ret)) {
 			dev_err(fmp->dev, "Error in fmp_run_AES_CBC_MCT");
 			return ret;
@@ -1399,6 +1744,7 @@ int fmp_fips_release(struct inode *inode, struct file *file)
 	mutex_destroy(&info->todo.lock);
 	mutex_destroy(&info->done.lock);
 	mutex_destroy(&info->free.lock);
+	mutex_destroy(&info->run_lock);
 
 	list_splice_tail(&info->todo.list, &info->free.list);
 	list_splice_tail(&info->done.list, &info->free.list);
@@ -1407,6 +1753,7 @@ int fmp_fips_release(struct inode *inode, struct file *file)
 		dev_err(fmp->dev, "%s: freeing item at %lx\n",
 				__func__, (unsigned long)item);
 		list_del(&item->__hook);
+		fmp_kcop_free_sg(&item->kcop);
 		kzfree(item);
 		items_freed++;
 	}
@@ -9,9 +9,13 @@
 
 #ifndef _FMP_FIPS_FOPS_H_
 #define _FMP_FIPS_FOPS_H_
+
+#include <linux/poll.h>
+
 int fmp_fips_open(struct inode *inode, struct file *file);
 int fmp_fips_release(struct inode *inode, struct file *file);
 long fmp_fips_ioctl(struct file *file, unsigned int cmd, unsigned long arg_);
+unsigned int fmp_fips_poll(struct file *file, poll_table *wait);
 #ifdef CONFIG_COMPAT
 long fmp_fips_compat_ioctl(struct file *file, unsigned int cmd,
 				unsigned long arg_);
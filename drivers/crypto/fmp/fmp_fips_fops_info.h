@@ -112,10 +112,28 @@ struct crypt_op {
 #define COP_FLAG_AES_XTS	(1 << 8)
 #define COP_FLAG_AES_CBC_MCT	(1 << 9)
 
+/*
+ * input of FMPCRYPTMULTI and FMPASYNCCRYPTMULTI, count is updated to the
+ * number of ops run or queued
+ */
+struct crypt_multi_op {
+	__u32 count;
+	struct crypt_op __user *ops;
+};
+
+/* maximum number of queued async ops and of ops of a multi op */
+#define FMP_MAX_MULTI_OPS	64
+/* maximum length of an async op */
+#define FMP_ASYNC_MAX_LEN	(64 * 1024)
+
 #define FMPGSESSION		_IOWR('c', 200, struct session_op)
 #define FMPFSESSION		_IOWR('c', 201, __u32)
 #define FMPGSESSIONINFO		_IOWR('c', 202, struct session_info_op)
 #define FMPCRYPT		_IOWR('c', 203, struct crypt_op)
 #define FMP_AES_CBC_MCT		_IOWR('c', 204, struct crypt_op)
+#define FMPASYNCCRYPT		_IOW('c', 205, struct crypt_op)
+#define FMPASYNCFETCH		_IOR('c', 206, struct crypt_op)
+#define FMPCRYPTMULTI		_IOWR('c', 207, struct crypt_multi_op)
+#define FMPASYNCCRYPTMULTI	_IOWR('c', 208, struct crypt_multi_op)
 
 #endif
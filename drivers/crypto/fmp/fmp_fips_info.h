@@ -47,6 +47,11 @@ struct kernel_crypt_op {
 
 	struct task_struct *task;
 	struct mm_struct *mm;
+
+	/* kernel copy of the data of async ops, one page per entry */
+	struct scatterlist *sg;
+	unsigned int nents;
+	bool copy_out;	/* dst is written back on fetch */
 };
 
 struct todo_list_item {
@@ -65,6 +70,8 @@ struct fmp_fips_info {
 	struct locked_list free, todo, done;
 	int itemcount;
 	struct work_struct fmptask;
+	/* serializes the ops of the file, they share the test data */
+	struct mutex run_lock;
 	wait_queue_head_t user_waiter;
 	struct exynos_fmp *fmp;
 	struct fmp_test_data *data;
@@ -107,9 +114,19 @@ struct compat_crypt_op {
 	compat_uptr_t thirdLastEncodedData;
 };
 
+/* input of FMPCRYPTMULTI and FMPASYNCCRYPTMULTI */
+struct compat_crypt_multi_op {
+	uint32_t	count;
+	compat_uptr_t	ops;		/* array of compat_crypt_op */
+};
+
 #define COMPAT_FMPGSESSION    _IOWR('c', 200, struct compat_session_op)
 #define COMPAT_FMPCRYPT       _IOWR('c', 203, struct compat_crypt_op)
 #define COMPAT_FMP_AES_CBC_MCT	_IOWR('c', 204, struct compat_crypt_op)
+#define COMPAT_FMPASYNCCRYPT	_IOW('c', 205, struct compat_crypt_op)
+#define COMPAT_FMPASYNCFETCH	_IOR('c', 206, struct compat_crypt_op)
+#define COMPAT_FMPCRYPTMULTI	_IOWR('c', 207, struct compat_crypt_multi_op)
+#define COMPAT_FMPASYNCCRYPTMULTI	_IOWR('c', 208, struct compat_crypt_multi_op)
 #endif
 
 /* the maximum of the above */
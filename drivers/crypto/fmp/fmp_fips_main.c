@@ -15,6 +15,7 @@
 #include <linux/buffer_head.h>
 #include <linux/genhd.h>
 #include <linux/delay.h>
+#include <linux/ktime.h>
 
 #include <crypto/authenc.h>
 #include <crypto/fmp.h>
@@ -105,12 +106,22 @@ static ssize_t fmp_fips_integrity_result_show(struct device *dev,
 	return snprintf(buf, sizeof(pass), "%s\n", fmp->result.integrity ? pass : fail);
 }
 
+static ssize_t fmp_fips_time_show(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct exynos_fmp *fmp = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "selftest=%lluus integrity=%lluus\n",
+			fmp->result.selftest_us, fmp->result.integrity_us);
+}
+
 static DEVICE_ATTR(fmp_fips_status, 0444, fmp_fips_result_show, NULL);
 static DEVICE_ATTR(aes_xts_status, 0444, fmp_fips_aes_xts_result_show, NULL);
 static DEVICE_ATTR(aes_cbc_status, 0444, fmp_fips_aes_cbc_result_show, NULL);
 static DEVICE_ATTR(sha256_status, 0444, fmp_fips_sha256_result_show, NULL);
 static DEVICE_ATTR(hmac_status, 0444, fmp_fips_hmac_result_show, NULL);
 static DEVICE_ATTR(integrity_status, 0444, fmp_fips_integrity_result_show, NULL);
+static DEVICE_ATTR(fips_time, 0444, fmp_fips_time_show, NULL);
 
 static struct attribute *fmp_fips_attr[] = {
 	&dev_attr_fmp_fips_status.attr,
@@ -119,6 +130,7 @@ static struct attribute *fmp_fips_attr[] = {
 	&dev_attr_sha256_status.attr,
 	&dev_attr_hmac_status.attr,
 	&dev_attr_integrity_status.attr,
+	&dev_attr_fips_time.attr,
 	NULL,
 };
 
@@ -132,6 +144,7 @@ static const struct file_operations fmp_fips_fops = {
 	.open		= fmp_fips_open,
 	.release	= fmp_fips_release,
 	.unlocked_ioctl = fmp_fips_ioctl,
+	.poll		= fmp_fips_poll,
 #ifdef CONFIG_COMPAT
 	.compat_ioctl	= fmp_fips_compat_ioctl,
 #endif
@@ -139,6 +152,7 @@ static const struct file_operations fmp_fips_fops = {
 
 int exynos_fmp_fips_init(struct exynos_fmp *fmp)
 {
+	ktime_t start;
 	int ret;
 
 	if (!fmp || !fmp->dev) {
@@ -175,21 +189,27 @@ int exynos_fmp_fips_init(struct exynos_fmp *fmp)
 		goto err;
 	}
 
+	start = ktime_get();
 	ret = do_fmp_selftest(fmp);
+	fmp->result.selftest_us = ktime_us_delta(ktime_get(), start);
 	if (ret) {
 		dev_err(fmp->dev, "%s: self-tests for FMP failed\n", __func__);
 		goto err;
 	} else {
-		dev_info(fmp->dev, "%s: self-tests for FMP passed\n", __func__);
+		dev_info(fmp->dev, "%s: self-tests for FMP passed in %lluus\n",
+				__func__, fmp->result.selftest_us);
 	}
 
+	start = ktime_get();
 	ret = do_fmp_integrity_check(fmp);
+	fmp->result.integrity_us = ktime_us_delta(ktime_get(), start);
 	if (ret) {
 		dev_err(fmp->dev, "%s: integrity check for FMP failed\n", __func__);
 		fmp->result.integrity = 0;
 		goto err;
 	} else {
-		dev_info(fmp->dev, "%s: integrity check for FMP passed\n", __func__);
+		dev_info(fmp->dev, "%s: integrity check for FMP passed in %lluus\n",
+				__func__, fmp->result.integrity_us);
 		fmp->result.integrity = 1;
 	}
 
@@ -19,6 +19,7 @@
 #include <linux/device.h>
 #include <linux/platform_device.h>
 #include <linux/of.h>
+#include <linux/of_address.h>
 #include <linux/slab.h>
 #include <linux/reboot.h>
 #include <linux/suspend.h>
@@ -43,6 +44,7 @@
 #endif
 
 #include "../governor.h"
+#include "exynos_ppmu.h"
 
 static struct exynos_devfreq_data **devfreq_data;
 
@@ -792,6 +794,133 @@ static struct attribute_group devfreq_delay_time_attr_group = {
 	.attrs = devfreq_interactive_sysfs_entries,
 };
 
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+/*
+ * Traffic measured by PPMU
+ * busy_time is the number of cycles the bus is activated by read or write
+ * and total_time is the number of cycles during the measurement.
+ */
+static int exynos_devfreq_get_dev_status(struct device *dev,
+					struct devfreq_dev_status *stat)
+{
+	struct platform_device *pdev = container_of(dev, struct platform_device, dev);
+	struct exynos_devfreq_data *data = platform_get_drvdata(pdev);
+	struct ppmu_data ppmu;
+
+	exynos_stop_ppmu(data->ppmu_base);
+	exynos_read_ppmu(&ppmu, data->ppmu_base, 0);
+	exynos_reset_ppmu(data->ppmu_base, 0);
+	exynos_start_ppmu(data->ppmu_base);
+
+	stat->current_frequency = data->old_freq;
+	stat->total_time = ppmu.ccnt;
+	stat->busy_time = min(max(ppmu.pmcnt0, ppmu.pmcnt1), ppmu.ccnt);
+
+	return 0;
+}
+
+#define show_predictive_param(name)						\
+static ssize_t show_predictive_##name(struct device *dev,			\
+			struct device_attribute *attr, char *buf)		\
+{										\
+	struct device *parent = dev->parent;					\
+	struct platform_device *pdev = container_of(parent, struct platform_device, dev);	\
+	struct exynos_devfreq_data *data = platform_get_drvdata(pdev);		\
+										\
+	return snprintf(buf, PAGE_SIZE, "%u\n",				\
+			data->simple_predictive_data.name);			\
+}
+
+#define store_predictive_param(name, limit)					\
+static ssize_t store_predictive_##name(struct device *dev,			\
+			struct device_attribute *attr, const char *buf,		\
+			size_t count)						\
+{										\
+	struct device *parent = dev->parent;					\
+	struct platform_device *pdev = container_of(parent, struct platform_device, dev);	\
+	struct exynos_devfreq_data *data = platform_get_drvdata(pdev);		\
+	unsigned int val;							\
+										\
+	if (sscanf(buf, "%u", &val) != 1 || val > limit)			\
+		return -EINVAL;							\
+										\
+	mutex_lock(&data->devfreq->lock);					\
+	data->simple_predictive_data.name = val;				\
+	mutex_unlock(&data->devfreq->lock);					\
+										\
+	return count;								\
+}
+
+show_predictive_param(target_load);
+store_predictive_param(target_load, 100);
+show_predictive_param(predict_ratio);
+store_predictive_param(predict_ratio, 1000);
+show_predictive_param(down_weight);
+store_predictive_param(down_weight, 99);
+
+static ssize_t show_predictive_stat(struct device *dev,
+			struct device_attribute *attr, char *buf)
+{
+	struct device *parent = dev->parent;
+	struct platform_device *pdev = container_of(parent, struct platform_device, dev);
+	struct exynos_devfreq_data *data = platform_get_drvdata(pdev);
+	struct devfreq_simple_predictive_data *gov_data = &data->simple_predictive_data;
+	ssize_t count = 0;
+
+	mutex_lock(&data->devfreq->lock);
+	count += snprintf(buf + count, PAGE_SIZE - count,
+			"demand    : %lu\npredicted : %lu\n",
+			gov_data->prev_demand, gov_data->predicted);
+	count += snprintf(buf + count, PAGE_SIZE - count,
+			"update    : %lu\nahead     : %lu\nlate      : %lu\n",
+			gov_data->update_cnt, gov_data->ahead_cnt,
+			gov_data->late_cnt);
+	mutex_unlock(&data->devfreq->lock);
+
+	return count;
+}
+
+static DEVICE_ATTR(target_load, 0640, show_predictive_target_load,
+		store_predictive_target_load);
+static DEVICE_ATTR(predict_ratio, 0640, show_predictive_predict_ratio,
+		store_predictive_predict_ratio);
+static DEVICE_ATTR(down_weight, 0640, show_predictive_down_weight,
+		store_predictive_down_weight);
+static DEVICE_ATTR(stat, 0440, show_predictive_stat, NULL);
+
+static struct attribute *devfreq_predictive_sysfs_entries[] = {
+	&dev_attr_target_load.attr,
+	&dev_attr_predict_ratio.attr,
+	&dev_attr_down_weight.attr,
+	&dev_attr_stat.attr,
+	NULL,
+};
+
+static struct attribute_group devfreq_predictive_attr_group = {
+	.name = "predictive",
+	.attrs = devfreq_predictive_sysfs_entries,
+};
+
+static int exynos_devfreq_parse_predictive(struct device_node *np,
+				struct exynos_devfreq_data *data)
+{
+	struct devfreq_simple_predictive_data *gov_data = &data->simple_predictive_data;
+
+	of_property_read_u32(np, "target_load", &gov_data->target_load);
+	of_property_read_u32(np, "upthreshold", &gov_data->upthreshold);
+	of_property_read_u32(np, "predict_ratio", &gov_data->predict_ratio);
+	of_property_read_u32(np, "down_weight", &gov_data->down_weight);
+	of_property_read_u32(np, "polling_ms", &data->devfreq_profile.polling_ms);
+
+	/* Without PPMU, the governor follows pm_qos only */
+	data->ppmu_base = of_iomap(np, 0);
+	if (!data->ppmu_base)
+		dev_info(data->dev, "This does not use ppmu\n");
+
+	return 0;
+}
+#endif
+
 #ifdef CONFIG_EXYNOS_DVFS_MANAGER
 int find_exynos_devfreq_dm_type(struct device *dev, int *dm_type)
 {
@@ -918,6 +1047,10 @@ static int exynos_devfreq_parse_dt(struct device_node *np, struct exynos_devfreq
 		return -ENODEV;
 	if (data->gov_type == SIMPLE_INTERACTIVE)
 		data->governor_name = "interactive";
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+	else if (data->gov_type == SIMPLE_PREDICTIVE)
+		data->governor_name = "predictive";
+#endif
 	else {
 		dev_err(data->dev, "invalid governor name (%s)\n", data->governor_name);
 		return -EINVAL;
@@ -1000,6 +1133,11 @@ static int exynos_devfreq_parse_dt(struct device_node *np, struct exynos_devfreq
 				data->simple_interactive_data.ndelay_time = ntokens;
 			}
 		}
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+	} else if (data->gov_type == SIMPLE_PREDICTIVE) {
+		if (exynos_devfreq_parse_predictive(np, data))
+			return -EINVAL;
+#endif
 	} else {
 		dev_err(data->dev, "not support governor type %u\n", data->gov_type);
 		return -EINVAL;
@@ -1316,6 +1454,19 @@ static int exynos_devfreq_probe(struct platform_device *pdev)
 		data->simple_interactive_data.pm_qos_class_max = data->pm_qos_class_max;
 		data->governor_data = &data->simple_interactive_data;
 	}
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+	if (data->gov_type == SIMPLE_PREDICTIVE) {
+		data->simple_predictive_data.pm_qos_class = data->pm_qos_class;
+		data->simple_predictive_data.pm_qos_class_max = data->pm_qos_class_max;
+		data->governor_data = &data->simple_predictive_data;
+
+		if (data->ppmu_base) {
+			exynos_init_ppmu(data->ppmu_base, 0, 0);
+			exynos_start_ppmu(data->ppmu_base);
+			data->devfreq_profile.get_dev_status = exynos_devfreq_get_dev_status;
+		}
+	}
+#endif
 
 	data->devfreq_profile.freq_table = kzalloc(sizeof(*(data->devfreq_profile.freq_table)) * data->max_state, GFP_KERNEL);
 	if (data->devfreq_profile.freq_table == NULL) {
@@ -1424,6 +1575,14 @@ static int exynos_devfreq_probe(struct platform_device *pdev)
 	ret = sysfs_create_group(&data->devfreq->dev.kobj, &devfreq_delay_time_attr_group);
 	if (ret)
 		dev_warn(data->dev, "failed create sysfs for devfreq data\n");
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+	if (data->gov_type == SIMPLE_PREDICTIVE) {
+		ret = sysfs_create_group(&data->devfreq->dev.kobj,
+					&devfreq_predictive_attr_group);
+		if (ret)
+			dev_warn(data->dev, "failed create sysfs for predictive governor\n");
+	}
+#endif
 
 	data->devfreq_disabled = false;
 
@@ -1490,6 +1649,11 @@ static int exynos_devfreq_remove(struct platform_device *pdev)
 	sysfs_remove_group(&data->devfreq->dev.kobj, &exynos_devfreq_attr_group);
 #endif
 	sysfs_remove_group(&data->devfreq->dev.kobj, &devfreq_delay_time_attr_group);
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+	if (data->gov_type == SIMPLE_PREDICTIVE)
+		sysfs_remove_group(&data->devfreq->dev.kobj,
+					&devfreq_predictive_attr_group);
+#endif
 
 	unregister_reboot_notifier(&data->reboot_notifier);
 	devfreq_unregister_opp_notifier(data->dev, data->devfreq);
@@ -22,11 +22,21 @@ struct ppmu_data {
 	u64 pmcnt3;
 };
 
+#if defined(CONFIG_EXYNOS_WD_DVFS) || IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+void exynos_read_ppmu(struct ppmu_data *ppmu, void __iomem *ppmu_base,
+		      u32 channel);
+void exynos_init_ppmu(void __iomem *ppmu_base, u32 mask_v, u32 mask_a);
+void exynos_exit_ppmu(void __iomem *ppmu_base);
+void exynos_reset_ppmu(void __iomem *ppmu_base, u32 channel);
+void exynos_start_ppmu(void __iomem *ppmu_base);
+void exynos_stop_ppmu(void __iomem *ppmu_base);
+#else
 #define exynos_read_ppmu(a, ...) do {} while(0)
 #define exynos_init_ppmu(a, ...) do {} while(0)
 #define exynos_exit_ppmu(a, ...) do {} while(0)
 #define exynos_reset_ppmu(a, ...) do {} while(0)
 #define exynos_start_ppmu(a, ...) do {} while(0)
 #define exynos_stop_ppmu(a, ...) do {} while(0)
+#endif
 
 #endif /* __DEVFREQ_EXYNOS_PPMU_H */
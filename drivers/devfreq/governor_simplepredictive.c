@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/errno.h>
+#include <linux/module.h>
+#include <linux/devfreq.h>
+#include <linux/math64.h>
+#include <linux/pm_qos.h>
+#include <linux/pm_opp.h>
+
+#include "governor.h"
+
+/* Default constants for Simple-Predictive */
+#define DFSP_TARGET_LOAD	(70)
+#define DFSP_UPTHRESHOLD	(95)
+#define DFSP_PREDICT_RATIO	(100)
+#define DFSP_DOWN_WEIGHT	(50)
+
+static int devfreq_simple_predictive_notifier(struct notifier_block *nb, unsigned long val,
+						void *v)
+{
+	struct devfreq_notifier_block *devfreq_nb;
+
+	devfreq_nb = container_of(nb, struct devfreq_notifier_block, nb);
+
+	mutex_lock(&devfreq_nb->df->lock);
+	update_devfreq(devfreq_nb->df);
+	mutex_unlock(&devfreq_nb->df->lock);
+
+	return NOTIFY_OK;
+}
+
+/*
+ * Returns the frequency predicted by measured traffic.
+ * The demand is the frequency at which measured traffic occupies target_load
+ * of the bus. While the demand is rising, the governor steps ahead by
+ * predict_ratio of the rise so that the frequency is raised before the bus
+ * is saturated. While the demand is falling, the prediction decays toward
+ * the demand with down_weight.
+ */
+static unsigned long devfreq_simple_predictive_demand(struct devfreq *df,
+			struct devfreq_simple_predictive_data *data)
+{
+	struct devfreq_dev_status *stat = &df->last_status;
+	unsigned int target_load = data->target_load ? : DFSP_TARGET_LOAD;
+	unsigned int upthreshold = data->upthreshold ? : DFSP_UPTHRESHOLD;
+	unsigned long long demand;
+	unsigned long predicted;
+
+	if (!df->profile->get_dev_status || devfreq_update_stats(df))
+		return 0;
+
+	if (!stat->total_time || !stat->current_frequency)
+		return 0;
+
+	/* Prevent overflow */
+	if (stat->busy_time >= (1 << 24) || stat->total_time >= (1 << 24)) {
+		stat->busy_time >>= 7;
+		stat->total_time >>= 7;
+	}
+
+	data->update_cnt++;
+
+	/* bus is already saturated, the prediction was late */
+	if (stat->busy_time * 100 >= stat->total_time * upthreshold)
+		data->late_cnt++;
+
+	demand = stat->busy_time;
+	demand *= stat->current_frequency;
+	demand = div_u64(demand, stat->total_time);
+	demand = div_u64(demand * 100, target_load);
+
+	if (demand > data->prev_demand) {
+		predicted = demand + (demand - data->prev_demand) *
+					data->predict_ratio / 100;
+		if (predicted > demand)
+			data->ahead_cnt++;
+	} else {
+		predicted = (data->predicted * data->down_weight +
+				demand * (100 - data->down_weight)) / 100;
+	}
+
+	data->prev_demand = demand;
+	data->predicted = predicted;
+
+	return predicted;
+}
+
+static int devfreq_simple_predictive_func(struct devfreq *df,
+					unsigned long *freq)
+{
+	struct devfreq_simple_predictive_data *data = df->data;
+	unsigned long pm_qos_min = 0;
+	unsigned long pm_qos_max = INT_MAX;
+	struct dev_pm_opp *limit_opp;
+
+	if (!data) {
+		pr_err("%s: failed to find governor data\n", __func__);
+		return -ENODATA;
+	}
+
+	/*
+	 * Bandwidth declared by display, MFC, camera and so on is reflected
+	 * to pm_qos minimum by BTS before the traffic occurs.
+	 */
+	if (!df->disabled_pm_qos) {
+		pm_qos_min = pm_qos_request(data->pm_qos_class);
+		if (data->pm_qos_class_max) {
+			pm_qos_max = pm_qos_request(data->pm_qos_class_max);
+			limit_opp = devfreq_recommended_opp(df->dev.parent, &pm_qos_max,
+					DEVFREQ_FLAG_LEAST_UPPER_BOUND);
+			if (IS_ERR(limit_opp)) {
+				pr_err("%s: failed to limit by max frequency\n", __func__);
+				return PTR_ERR(limit_opp);
+			}
+			dev_pm_opp_put(limit_opp);
+		}
+	}
+
+	*freq = max(pm_qos_min, devfreq_simple_predictive_demand(df, data));
+	*freq = min(pm_qos_max, *freq);
+
+	return 0;
+}
+
+static int devfreq_simple_predictive_register_notifier(struct devfreq *df)
+{
+	int ret;
+	struct devfreq_simple_predictive_data *data = df->data;
+
+	if (!data)
+		return -EINVAL;
+
+	if (!data->predict_ratio)
+		data->predict_ratio = DFSP_PREDICT_RATIO;
+	if (!data->down_weight || data->down_weight >= 100)
+		data->down_weight = DFSP_DOWN_WEIGHT;
+
+	data->nb.df = df;
+	data->nb.nb.notifier_call = devfreq_simple_predictive_notifier;
+
+	ret = pm_qos_add_notifier(data->pm_qos_class, &data->nb.nb);
+	if (ret < 0)
+		return ret;
+
+	if (data->pm_qos_class_max) {
+		data->nb_max.df = df;
+		data->nb_max.nb.notifier_call = devfreq_simple_predictive_notifier;
+
+		ret = pm_qos_add_notifier(data->pm_qos_class_max, &data->nb_max.nb);
+		if (ret < 0) {
+			pm_qos_remove_notifier(data->pm_qos_class, &data->nb.nb);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int devfreq_simple_predictive_unregister_notifier(struct devfreq *df)
+{
+	int ret;
+	struct devfreq_simple_predictive_data *data = df->data;
+
+	if (!data)
+		return -EINVAL;
+
+	if (data->pm_qos_class_max) {
+		ret = pm_qos_remove_notifier(data->pm_qos_class_max, &data->nb_max.nb);
+		if (ret < 0)
+			return ret;
+	}
+
+	return pm_qos_remove_notifier(data->pm_qos_class, &data->nb.nb);
+}
+
+static int devfreq_simple_predictive_handler(struct devfreq *devfreq,
+				unsigned int event, void *data)
+{
+	int ret;
+
+	switch (event) {
+	case DEVFREQ_GOV_START:
+		ret = devfreq_simple_predictive_register_notifier(devfreq);
+		if (ret)
+			return ret;
+		devfreq_monitor_start(devfreq);
+		break;
+
+	case DEVFREQ_GOV_STOP:
+		devfreq_monitor_stop(devfreq);
+		ret = devfreq_simple_predictive_unregister_notifier(devfreq);
+		if (ret)
+			return ret;
+		break;
+
+	case DEVFREQ_GOV_INTERVAL:
+		devfreq_interval_update(devfreq, (unsigned int *)data);
+		break;
+
+	case DEVFREQ_GOV_SUSPEND:
+		devfreq_monitor_suspend(devfreq);
+		break;
+
+	case DEVFREQ_GOV_RESUME:
+		devfreq_monitor_resume(devfreq);
+		break;
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+static struct devfreq_governor devfreq_simple_predictive = {
+	.name = "predictive",
+	.get_target_freq = devfreq_simple_predictive_func,
+	.event_handler = devfreq_simple_predictive_handler,
+};
+
+static int __init devfreq_simple_predictive_init(void)
+{
+	return devfreq_add_governor(&devfreq_simple_predictive);
+}
+subsys_initcall(devfreq_simple_predictive_init);
+
+static void __exit devfreq_simple_predictive_exit(void)
+{
+	int ret;
+
+	ret = devfreq_remove_governor(&devfreq_simple_predictive);
+	if (ret)
+		pr_err("%s: failed remove governor %d\n", __func__, ret);
+
+	return;
+}
+module_exit(devfreq_simple_predictive_exit);
+MODULE_LICENSE("GPL");
@@ -163,6 +163,95 @@ static int dmabuf_container_mmap(struct dma_buf *dmabuf,
 	return -EACCES;
 }
 
+/*
+ * Cpu access to a dma-buf container is forwarded to the member buffers that
+ * overlap [@offset, @offset + @len) of the container. If dmabuf_mask is set,
+ * only the members whose bit is set in the mask are synced because the other
+ * members are not going to be accessed by the user of the mask.
+ */
+static int dmabuf_container_cpu_access(struct dma_buf *dmabuf,
+				       enum dma_data_direction direction,
+				       unsigned int offset, unsigned int len,
+				       bool begin)
+{
+	struct dma_buf_container *container = dmabuf->priv;
+	u32 mask = container->dmabuf_mask;
+	unsigned int orig = offset;
+	size_t start = 0, end;
+	int i, ret, err = 0;
+
+	for (i = 0; i < container->count && len; i++) {
+		struct dma_buf *member = container->dmabufs[i];
+		unsigned int moff, mlen;
+
+		end = start + member->size;
+		if (offset >= end)
+			goto next;
+
+		moff = offset - start;
+		mlen = min_t(size_t, len, member->size - moff);
+		offset += mlen;
+		len -= mlen;
+
+		if (mask && !(mask & (1 << i)))
+			goto next;
+
+		if (begin) {
+			ret = dma_buf_begin_cpu_access_partial(member,
+							       direction,
+							       moff, mlen);
+			if (ret) {
+				pr_err("%s: failed to begin cpu access of %d\n",
+				       __func__, i);
+				/* end the members that are already begun */
+				dmabuf_container_cpu_access(dmabuf, direction,
+						orig, offset - mlen - orig,
+						false);
+				return ret;
+			}
+		} else {
+			ret = dma_buf_end_cpu_access_partial(member, direction,
+							     moff, mlen);
+			if (ret && !err)
+				err = ret;
+		}
+next:
+		start = end;
+	}
+
+	return err;
+}
+
+static int dmabuf_container_begin_cpu_access(struct dma_buf *dmabuf,
+					     enum dma_data_direction direction)
+{
+	return dmabuf_container_cpu_access(dmabuf, direction,
+					   0, dmabuf->size, true);
+}
+
+static int dmabuf_container_end_cpu_access(struct dma_buf *dmabuf,
+					   enum dma_data_direction direction)
+{
+	return dmabuf_container_cpu_access(dmabuf, direction,
+					   0, dmabuf->size, false);
+}
+
+static int dmabuf_container_begin_cpu_access_partial(struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len)
+{
+	return dmabuf_container_cpu_access(dmabuf, direction,
+					   offset, len, true);
+}
+
+static int dmabuf_container_end_cpu_access_partial(struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len)
+{
+	return dmabuf_container_cpu_access(dmabuf, direction,
+					   offset, len, false);
+}
+
 static struct dma_buf_ops dmabuf_container_dma_buf_ops = {
 	.map_dma_buf = dmabuf_container_map_dma_buf,
 	.unmap_dma_buf = dmabuf_container_unmap_dma_buf,
@@ -170,6 +259,10 @@ static struct dma_buf_ops dmabuf_container_dma_buf_ops = {
 	.map_atomic = dmabuf_container_dma_buf_kmap,
 	.map = dmabuf_container_dma_buf_kmap,
 	.mmap = dmabuf_container_mmap,
+	.begin_cpu_access = dmabuf_container_begin_cpu_access,
+	.end_cpu_access = dmabuf_container_end_cpu_access,
+	.begin_cpu_access_partial = dmabuf_container_begin_cpu_access_partial,
+	.end_cpu_access_partial = dmabuf_container_end_cpu_access_partial,
 };
 
 static bool is_dmabuf_container(struct dma_buf *dmabuf)
@@ -67,6 +67,75 @@ static DEFINE_MUTEX(trace_lock);
 
 static struct dentry *debug_root;
 
+static atomic_long_t map_events[NR_DMABUF_TRACE_MAP_EVENTS];
+
+void dmabuf_trace_map_event(enum dmabuf_trace_map_event event)
+{
+	atomic_long_inc(&map_events[event]);
+}
+
+static int dmabuf_trace_map_cache_show(struct seq_file *s, void *unused)
+{
+	long hit = atomic_long_read(&map_events[DMABUF_TRACE_MAP_HIT]);
+	long miss = atomic_long_read(&map_events[DMABUF_TRACE_MAP_MISS]);
+
+	seq_printf(s, "hit     : %ld\n", hit);
+	seq_printf(s, "miss    : %ld\n", miss);
+	seq_printf(s, "release : %ld\n",
+		   atomic_long_read(&map_events[DMABUF_TRACE_MAP_RELEASE]));
+	seq_printf(s, "reclaim : %ld\n",
+		   atomic_long_read(&map_events[DMABUF_TRACE_MAP_RECLAIM]));
+	seq_printf(s, "hit ratio : %ld%%\n",
+		   hit + miss ? hit * 100 / (hit + miss) : 0);
+
+	return 0;
+}
+
+static int dmabuf_trace_map_cache_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dmabuf_trace_map_cache_show, NULL);
+}
+
+static const struct file_operations dmabuf_trace_map_cache_fops = {
+	.open = dmabuf_trace_map_cache_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static atomic_long_t cpu_sync_full;
+static atomic_long_t cpu_sync_partial;
+static atomic64_t cpu_sync_bytes;
+
+/* bytes requested to be synced by begin/end_cpu_access of exporters */
+void dmabuf_trace_cpu_sync(size_t bytes, bool partial)
+{
+	atomic_long_inc(partial ? &cpu_sync_partial : &cpu_sync_full);
+	atomic64_add(bytes, &cpu_sync_bytes);
+}
+
+static int dmabuf_trace_cpu_sync_show(struct seq_file *s, void *unused)
+{
+	seq_printf(s, "full    : %ld\n", atomic_long_read(&cpu_sync_full));
+	seq_printf(s, "partial : %ld\n", atomic_long_read(&cpu_sync_partial));
+	seq_printf(s, "bytes   : %lld\n",
+		   (long long)atomic64_read(&cpu_sync_bytes));
+
+	return 0;
+}
+
+static int dmabuf_trace_cpu_sync_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dmabuf_trace_cpu_sync_show, NULL);
+}
+
+static const struct file_operations dmabuf_trace_cpu_sync_fops = {
+	.open = dmabuf_trace_cpu_sync_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 static int dmabuf_trace_debug_show(struct seq_file *s, void *unused)
 {
 	struct dmabuf_trace_task *task = s->private;
@@ -503,6 +572,11 @@ static int __init dmabuf_trace_create(void)
 	INIT_LIST_HEAD(&head_task.node);
 	INIT_LIST_HEAD(&head_task.ref_list);
 
+	debugfs_create_file("map_cache", 0444, dma_buf_debugfs_dir, NULL,
+			    &dmabuf_trace_map_cache_fops);
+	debugfs_create_file("cpu_sync", 0444, dma_buf_debugfs_dir, NULL,
+			    &dmabuf_trace_cpu_sync_fops);
+
 	pr_info("Initialized dma-buf trace successfully.\n");
 
 	return 0;
@@ -32,12 +32,28 @@
 struct dentry;
 extern struct dentry *dma_buf_debugfs_dir;
 
+enum dmabuf_trace_map_event {
+	DMABUF_TRACE_MAP_HIT,		/* cached mapping is reused */
+	DMABUF_TRACE_MAP_MISS,		/* exporter is asked to map */
+	DMABUF_TRACE_MAP_RELEASE,	/* cached mapping is released by detach */
+	DMABUF_TRACE_MAP_RECLAIM,	/* cached mapping is released by shrinker */
+	NR_DMABUF_TRACE_MAP_EVENTS,
+};
+
 #ifdef CONFIG_DMABUF_TRACE
+void dmabuf_trace_map_event(enum dmabuf_trace_map_event event);
+void dmabuf_trace_cpu_sync(size_t bytes, bool partial);
 int dmabuf_trace_alloc(struct dma_buf *dmabuf);
 void dmabuf_trace_free(struct dma_buf *dmabuf);
 int dmabuf_trace_track_buffer(struct dma_buf *dmabuf);
 int dmabuf_trace_untrack_buffer(struct dma_buf *dmabuf);
 #else
+static inline void dmabuf_trace_map_event(enum dmabuf_trace_map_event event)
+{
+}
+static inline void dmabuf_trace_cpu_sync(size_t bytes, bool partial)
+{
+}
 static inline int dmabuf_trace_alloc(struct dma_buf *dmabuf)
 {
 	return -EINVAL;
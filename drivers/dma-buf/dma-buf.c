@@ -35,6 +35,7 @@
 #include <linux/reservation.h>
 #include <linux/mm.h>
 
+#include <linux/dma-buf-container.h>
 #include <uapi/linux/dma-buf.h>
 
 #include "dma-buf-container.h"
@@ -282,11 +283,35 @@ out:
 	return events;
 }
 
+static int dma_buf_sync_direction(u64 flags,
+				  enum dma_data_direction *direction)
+{
+	if (flags & ~DMA_BUF_SYNC_VALID_FLAGS_MASK)
+		return -EINVAL;
+
+	switch (flags & DMA_BUF_SYNC_RW) {
+	case DMA_BUF_SYNC_READ:
+		*direction = DMA_FROM_DEVICE;
+		break;
+	case DMA_BUF_SYNC_WRITE:
+		*direction = DMA_TO_DEVICE;
+		break;
+	case DMA_BUF_SYNC_RW:
+		*direction = DMA_BIDIRECTIONAL;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static long dma_buf_ioctl(struct file *file,
 			  unsigned int cmd, unsigned long arg)
 {
 	struct dma_buf *dmabuf;
 	struct dma_buf_sync sync;
+	struct dma_buf_sync_partial sync_partial;
 	enum dma_data_direction direction;
 	int ret;
 
@@ -297,28 +322,35 @@ static long dma_buf_ioctl(struct file *file,
 		if (copy_from_user(&sync, (void __user *) arg, sizeof(sync)))
 			return -EFAULT;
 
-		if (sync.flags & ~DMA_BUF_SYNC_VALID_FLAGS_MASK)
-			return -EINVAL;
-
-		switch (sync.flags & DMA_BUF_SYNC_RW) {
-		case DMA_BUF_SYNC_READ:
-			direction = DMA_FROM_DEVICE;
-			break;
-		case DMA_BUF_SYNC_WRITE:
-			direction = DMA_TO_DEVICE;
-			break;
-		case DMA_BUF_SYNC_RW:
-			direction = DMA_BIDIRECTIONAL;
-			break;
-		default:
-			return -EINVAL;
-		}
+		ret = dma_buf_sync_direction(sync.flags, &direction);
+		if (ret)
+			return ret;
 
 		if (sync.flags & DMA_BUF_SYNC_END)
 			ret = dma_buf_end_cpu_access(dmabuf, direction);
 		else
 			ret = dma_buf_begin_cpu_access(dmabuf, direction);
 
+		return ret;
+	case DMA_BUF_IOCTL_SYNC_PARTIAL:
+		if (copy_from_user(&sync_partial, (void __user *) arg,
+				   sizeof(sync_partial)))
+			return -EFAULT;
+
+		ret = dma_buf_sync_direction(sync_partial.flags, &direction);
+		if (ret)
+			return ret;
+
+		if (sync_partial.flags & DMA_BUF_SYNC_END)
+			ret = dma_buf_end_cpu_access_partial(dmabuf, direction,
+							     sync_partial.offset,
+							     sync_partial.len);
+		else
+			ret = dma_buf_begin_cpu_access_partial(dmabuf,
+							direction,
+							sync_partial.offset,
+							sync_partial.len);
+
 		return ret;
 #ifdef CONFIG_COMPAT
 	case DMA_BUF_COMPAT_IOCTL_MERGE:
@@ -564,6 +596,160 @@ void dma_buf_put(struct dma_buf *dmabuf)
 }
 EXPORT_SYMBOL_GPL(dma_buf_put);
 
+/*
+ * Containers do not flush by themselves but through the cpu access of their
+ * members, which is accounted by the members.
+ */
+static void dma_buf_trace_cpu_sync(struct dma_buf *dmabuf, size_t bytes,
+				   bool partial)
+{
+	if (dmabuf_container_get_count(dmabuf) < 0)
+		dmabuf_trace_cpu_sync(bytes, partial);
+}
+
+/* number of cached mappings that are not used by importers */
+static atomic_long_t dma_buf_idle_maps;
+
+static struct sg_table *__map_dma_buf(struct dma_buf_attachment *attach,
+				      enum dma_data_direction direction,
+				      size_t size)
+{
+	const struct dma_buf_ops *ops = attach->dmabuf->ops;
+	struct sg_table *sg_table;
+
+	if (size && ops->map_dma_buf_area)
+		sg_table = ops->map_dma_buf_area(attach, direction, size);
+	else
+		sg_table = ops->map_dma_buf(attach, direction);
+
+	if (!sg_table)
+		sg_table = ERR_PTR(-ENOMEM);
+
+	return sg_table;
+}
+
+/* Must be called with dmabuf->lock held */
+static void dma_buf_release_cached(struct dma_buf_attachment *attach)
+{
+	if (!attach->map_count)
+		atomic_long_dec(&dma_buf_idle_maps);
+
+	attach->dmabuf->ops->unmap_dma_buf(attach, attach->sgt, attach->dir);
+	attach->sgt = NULL;
+	attach->map_count = 0;
+}
+
+/*
+ * Returns the cached mapping of @attach if it is mapped in @direction.
+ * Otherwise a new mapping is made and cached unless the cached mapping in the
+ * other direction is still in use.
+ */
+static struct sg_table *dma_buf_map_cached(struct dma_buf_attachment *attach,
+					   enum dma_data_direction direction,
+					   size_t size)
+{
+	struct dma_buf *dmabuf = attach->dmabuf;
+	struct sg_table *sg_table;
+
+	mutex_lock(&dmabuf->lock);
+
+	if (attach->sgt && attach->dir == direction) {
+		if (attach->map_count++ == 0)
+			atomic_long_dec(&dma_buf_idle_maps);
+		sg_table = attach->sgt;
+		mutex_unlock(&dmabuf->lock);
+
+		dmabuf_trace_map_event(DMABUF_TRACE_MAP_HIT);
+
+		return sg_table;
+	}
+
+	if (attach->sgt && !attach->map_count) {
+		dma_buf_release_cached(attach);
+		dmabuf_trace_map_event(DMABUF_TRACE_MAP_RELEASE);
+	}
+
+	sg_table = __map_dma_buf(attach, direction, size);
+	if (!IS_ERR(sg_table) && !attach->sgt) {
+		attach->sgt = sg_table;
+		attach->dir = direction;
+		attach->map_count = 1;
+	}
+
+	mutex_unlock(&dmabuf->lock);
+
+	dmabuf_trace_map_event(DMABUF_TRACE_MAP_MISS);
+
+	return sg_table;
+}
+
+/* Returns false if @sg_table is not the cached mapping of @attach */
+static bool dma_buf_unmap_cached(struct dma_buf_attachment *attach,
+				 struct sg_table *sg_table)
+{
+	struct dma_buf *dmabuf = attach->dmabuf;
+	bool cached;
+
+	mutex_lock(&dmabuf->lock);
+
+	cached = attach->sgt && attach->sgt == sg_table;
+	if (cached && !WARN_ON(!attach->map_count) && --attach->map_count == 0)
+		atomic_long_inc(&dma_buf_idle_maps);
+
+	mutex_unlock(&dmabuf->lock);
+
+	return cached;
+}
+
+static unsigned long dma_buf_map_cache_count(struct shrinker *shrinker,
+					     struct shrink_control *sc)
+{
+	return atomic_long_read(&dma_buf_idle_maps);
+}
+
+static unsigned long dma_buf_map_cache_scan(struct shrinker *shrinker,
+					    struct shrink_control *sc)
+{
+	struct dma_buf_attachment *attach;
+	struct dma_buf *dmabuf;
+	unsigned long freed = 0;
+
+	/* the locks may be held by the allocating context */
+	if (!mutex_trylock(&db_list.lock))
+		return SHRINK_STOP;
+
+	list_for_each_entry(dmabuf, &db_list.head, list_node) {
+		if (!mutex_trylock(&dmabuf->lock))
+			continue;
+
+		list_for_each_entry(attach, &dmabuf->attachments, node) {
+			if (!attach->sgt || attach->map_count)
+				continue;
+
+			dma_buf_release_cached(attach);
+			dmabuf_trace_map_event(DMABUF_TRACE_MAP_RECLAIM);
+
+			if (++freed >= sc->nr_to_scan)
+				break;
+		}
+
+		mutex_unlock(&dmabuf->lock);
+
+		if (freed >= sc->nr_to_scan)
+			break;
+	}
+
+	mutex_unlock(&db_list.lock);
+
+	return freed;
+}
+
+static struct shrinker dma_buf_map_cache_shrinker = {
+	.count_objects = dma_buf_map_cache_count,
+	.scan_objects = dma_buf_map_cache_scan,
+	.seeks = DEFAULT_SEEKS,
+};
+
 /**
  * dma_buf_attach - Add the device to dma_buf's attachments list; optionally,
  * calls attach() of dma_buf_ops to allow device-specific attach functionality
@@ -632,6 +818,11 @@ void dma_buf_detach(struct dma_buf *dmabuf, struct dma_buf_attachment *attach)
 
 	mutex_lock(&dmabuf->lock);
 	list_del(&attach->node);
+	if (attach->sgt) {
+		WARN_ON(attach->map_count);
+		dma_buf_release_cached(attach);
+		dmabuf_trace_map_event(DMABUF_TRACE_MAP_RELEASE);
+	}
 	if (dmabuf->ops->detach)
 		dmabuf->ops->detach(dmabuf, attach);
 
@@ -673,6 +864,9 @@ struct sg_table *dma_buf_map_attachment_area(struct dma_buf_attachment *attach,
 	if (WARN_ON(!attach || !attach->dmabuf))
 		return ERR_PTR(-EINVAL);
 
+	if (attach->dmabuf->ops->cache_sgt_mapping)
+		return dma_buf_map_cached(attach, direction, size);
+
 	sg_table = attach->dmabuf->ops->map_dma_buf_area(attach, direction,
 							 size);
 	if (!sg_table)
@@ -705,6 +899,10 @@ void dma_buf_unmap_attachment_area(struct dma_buf_attachment *attach,
 	if (WARN_ON(!attach || !attach->dmabuf || !sg_table))
 		return;
 
+	if (attach->dmabuf->ops->cache_sgt_mapping &&
+	    dma_buf_unmap_cached(attach, sg_table))
+		return;
+
 	attach->dmabuf->ops->unmap_dma_buf_area(attach, sg_table,
 						   direction, size);
 }
@@ -735,6 +933,9 @@ struct sg_table *dma_buf_map_attachment(struct dma_buf_attachment *attach,
 	if (WARN_ON(!attach || !attach->dmabuf))
 		return ERR_PTR(-EINVAL);
 
+	if (attach->dmabuf->ops->cache_sgt_mapping)
+		return dma_buf_map_cached(attach, direction, 0);
+
 	sg_table = attach->dmabuf->ops->map_dma_buf(attach, direction);
 	if (!sg_table)
 		sg_table = ERR_PTR(-ENOMEM);
@@ -762,6 +963,10 @@ void dma_buf_unmap_attachment(struct dma_buf_attachment *attach,
 	if (WARN_ON(!attach || !attach->dmabuf || !sg_table))
 		return;
 
+	if (attach->dmabuf->ops->cache_sgt_mapping &&
+	    dma_buf_unmap_cached(attach, sg_table))
+		return;
+
 	attach->dmabuf->ops->unmap_dma_buf(attach, sg_table,
 						direction);
 }
@@ -922,8 +1127,10 @@ int dma_buf_begin_cpu_access(struct dma_buf *dmabuf,
 	if (WARN_ON(!dmabuf))
 		return -EINVAL;
 
-	if (dmabuf->ops->begin_cpu_access)
+	if (dmabuf->ops->begin_cpu_access) {
 		ret = dmabuf->ops->begin_cpu_access(dmabuf, direction);
+		dma_buf_trace_cpu_sync(dmabuf, dmabuf->size, false);
+	}
 
 	/* Ensure that all fences are waited upon - but we first allow
 	 * the native handler the chance to do so more efficiently if it
@@ -955,13 +1162,96 @@ int dma_buf_end_cpu_access(struct dma_buf *dmabuf,
 
 	WARN_ON(!dmabuf);
 
-	if (dmabuf->ops->end_cpu_access)
+	if (dmabuf->ops->end_cpu_access) {
 		ret = dmabuf->ops->end_cpu_access(dmabuf, direction);
+		dma_buf_trace_cpu_sync(dmabuf, dmabuf->size, false);
+	}
 
 	return ret;
 }
 EXPORT_SYMBOL_GPL(dma_buf_end_cpu_access);
 
+/**
+ * dma_buf_begin_cpu_access_partial - Must be called before accessing a part of
+ * dma_buf from the cpu in the kernel context. Calls begin_cpu_access_partial
+ * to allow exporter-specific preparations for the range.
+ * @dmabuf:	[in]	buffer to prepare cpu access for.
+ * @direction:	[in]	direction of cpu access.
+ * @offset:	[in]	offset in bytes of the range for cpu access.
+ * @len:	[in]	length in bytes of the range for cpu access.
+ *
+ * This is the same as dma_buf_begin_cpu_access() but coherency is only
+ * guaranteed in the specified range. Falls back to begin_cpu_access if the
+ * exporter does not support partial cpu access.
+ *
+ * Can return negative error values, returns 0 on success.
+ */
+int dma_buf_begin_cpu_access_partial(struct dma_buf *dmabuf,
+				     enum dma_data_direction direction,
+				     unsigned int offset, unsigned int len)
+{
+	int ret = 0;
+
+	if (WARN_ON(!dmabuf))
+		return -EINVAL;
+
+	if (offset > dmabuf->size || len > dmabuf->size - offset)
+		return -EINVAL;
+
+	if (dmabuf->ops->begin_cpu_access_partial) {
+		ret = dmabuf->ops->begin_cpu_access_partial(dmabuf, direction,
+							    offset, len);
+		dma_buf_trace_cpu_sync(dmabuf, len, true);
+	} else if (dmabuf->ops->begin_cpu_access) {
+		ret = dmabuf->ops->begin_cpu_access(dmabuf, direction);
+		dma_buf_trace_cpu_sync(dmabuf, dmabuf->size, false);
+	}
+
+	if (ret == 0)
+		ret = __dma_buf_begin_cpu_access(dmabuf, direction);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(dma_buf_begin_cpu_access_partial);
+
+/**
+ * dma_buf_end_cpu_access_partial - Must be called after accessing a part of
+ * dma_buf from the cpu in the kernel context. Calls end_cpu_access_partial to
+ * allow exporter-specific actions for the range.
+ * @dmabuf:	[in]	buffer to complete cpu access for.
+ * @direction:	[in]	direction of cpu access.
+ * @offset:	[in]	offset in bytes of the range for cpu access.
+ * @len:	[in]	length in bytes of the range for cpu access.
+ *
+ * This terminates CPU access started with dma_buf_begin_cpu_access_partial().
+ *
+ * Can return negative error values, returns 0 on success.
+ */
+int dma_buf_end_cpu_access_partial(struct dma_buf *dmabuf,
+				   enum dma_data_direction direction,
+				   unsigned int offset, unsigned int len)
+{
+	int ret = 0;
+
+	if (WARN_ON(!dmabuf))
+		return -EINVAL;
+
+	if (offset > dmabuf->size || len > dmabuf->size - offset)
+		return -EINVAL;
+
+	if (dmabuf->ops->end_cpu_access_partial) {
+		ret = dmabuf->ops->end_cpu_access_partial(dmabuf, direction,
+							  offset, len);
+		dma_buf_trace_cpu_sync(dmabuf, len, true);
+	} else if (dmabuf->ops->end_cpu_access) {
+		ret = dmabuf->ops->end_cpu_access(dmabuf, direction);
+		dma_buf_trace_cpu_sync(dmabuf, dmabuf->size, false);
+	}
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(dma_buf_end_cpu_access_partial);
+
 /**
  * dma_buf_kmap_atomic - Map a page of the buffer object into kernel address
  * space. The same restrictions as for kmap_atomic and friends apply.
@@ -1301,6 +1591,7 @@ static int __init dma_buf_init(void)
 	mutex_init(&db_list.lock);
 	INIT_LIST_HEAD(&db_list.head);
 	dma_buf_init_debugfs();
+	register_shrinker(&dma_buf_map_cache_shrinker);
 	return 0;
 }
 subsys_initcall(dma_buf_init);
@@ -14,6 +14,7 @@
  *
  */
 
+#include <linux/debugfs.h>
 #include <linux/export.h>
 #include <linux/file.h>
 #include <linux/fs.h>
@@ -21,11 +22,14 @@
 #include <linux/poll.h>
 #include <linux/sched.h>
 #include <linux/slab.h>
+#include <linux/sort.h>
 #include <linux/uaccess.h>
 #include <linux/anon_inodes.h>
 #include <linux/sync_file.h>
 #include <uapi/linux/sync_file.h>
 
+#include "dma-buf-trace.h"
+
 static const struct file_operations sync_file_fops;
 
 static struct sync_file *sync_file_alloc(void)
@@ -161,7 +165,7 @@ static int sync_file_set_fence(struct sync_file *sync_file,
 
 	/*
 	 * The reference for the fences in the new sync_file and held
-	 * in add_fence() during the merge procedure, so for num_fences == 1
+	 * in sync_file_merge() during the merge procedure, so for num_fences == 1
 	 * we already own a new reference to the fence. For num_fence > 1
 	 * we own the reference of the dma_fence_array creation.
 	 */
@@ -195,15 +199,75 @@ static struct dma_fence **get_fences(struct sync_file *sync_file,
 	return &sync_file->fence;
 }
 
-static void add_fence(struct dma_fence **fences,
-		      int *i, struct dma_fence *fence)
+/*
+ * Merge statistics: the fences of the merged sync_files as they were given,
+ * the leaves they hold once nested arrays are flattened, the leaves dropped
+ * because they were signaled or superseded by a later fence of the same
+ * context, and the fences of the merged sync_files.
+ */
+static struct {
+	atomic_long_t merges;
+	atomic_long_t fences_in;
+	atomic_long_t leaves;
+	atomic_long_t flattened;
+	atomic_long_t signaled;
+	atomic_long_t duplicates;
+	atomic_long_t fences_out;
+} sync_file_merge_stats;
+
+/* Unsignaled leaf fences of @fence, with arrays expanded at any depth */
+static int sync_file_count_fences(struct dma_fence *fence)
 {
-	fences[*i] = fence;
+	struct dma_fence_array *array;
+	int i, count = 0;
+
+	if (!dma_fence_is_array(fence))
+		return 1;
+
+	array = to_dma_fence_array(fence);
+	for (i = 0; i < array->num_fences; i++) {
+		int n = sync_file_count_fences(array->fences[i]);
 
-	if (!dma_fence_is_signaled(fence)) {
-		dma_fence_get(fence);
-		(*i)++;
+		if (count > INT_MAX - n)
+			return -EOVERFLOW;
+		count += n;
 	}
+
+	return count;
+}
+
+static void sync_file_collect_fences(struct dma_fence *fence,
+				     struct dma_fence **fences, int *i)
+{
+	struct dma_fence_array *array;
+	int j;
+
+	if (!dma_fence_is_array(fence)) {
+		atomic_long_inc(&sync_file_merge_stats.leaves);
+		if (dma_fence_is_signaled(fence)) {
+			atomic_long_inc(&sync_file_merge_stats.signaled);
+			return;
+		}
+		fences[(*i)++] = fence;
+		return;
+	}
+
+	atomic_long_inc(&sync_file_merge_stats.flattened);
+	array = to_dma_fence_array(fence);
+	for (j = 0; j < array->num_fences; j++)
+		sync_file_collect_fences(array->fences[j], fences, i);
+}
+
+static int sync_file_fence_cmp(const void *a, const void *b)
+{
+	const struct dma_fence *pt_a = *(const struct dma_fence **)a;
+	const struct dma_fence *pt_b = *(const struct dma_fence **)b;
+
+	if (pt_a->context < pt_b->context)
+		return -1;
+	if (pt_a->context > pt_b->context)
+		return 1;
+	return 0;
 }
 
 /**
@@ -215,82 +279,89 @@ static void add_fence(struct dma_fence **fences,
  * Creates a new sync_file which contains copies of all the fences in both
  * @a and @b.  @a and @b remain valid, independent sync_file. Returns the
  * new merged sync_file or NULL in case of error.
+ *
+ * The fences of @a and @b are flattened, so that long pipelines do not build
+ * trees of arrays for the waiters to walk, and the signaled ones are dropped.
+ * Only the latest fence of each context is kept. The fences of a sync_file
+ * created by a driver from its own array may come in any order, so they
+ * are sorted by context rather than assumed to be.
  */
 static struct sync_file *sync_file_merge(const char *name, struct sync_file *a,
 					 struct sync_file *b)
 {
 	struct sync_file *sync_file;
-	struct dma_fence **fences, **nfences, **a_fences, **b_fences;
-	int i, i_a, i_b, num_fences, a_num_fences, b_num_fences;
+	struct dma_fence **fences, **nfences;
+	int i, j, num_fences, a_num_fences, b_num_fences;
 
 	sync_file = sync_file_alloc();
 	if (!sync_file)
 		return NULL;
 
-	a_fences = get_fences(a, &a_num_fences);
-	b_fences = get_fences(b, &b_num_fences);
-	if (a_num_fences > INT_MAX - b_num_fences)
+	a_num_fences = sync_file_count_fences(a->fence);
+	b_num_fences = sync_file_count_fences(b->fence);
+	if (a_num_fences < 0 || b_num_fences < 0 ||
+	    a_num_fences > INT_MAX - b_num_fences)
 		goto err;
 
 	num_fences = a_num_fences + b_num_fences;
 
-	fences = kcalloc(num_fences, sizeof(*fences), GFP_KERNEL);
+	/* room for a signaled fence if every leaf is signaled */
+	fences = kcalloc(max(num_fences, 1), sizeof(*fences), GFP_KERNEL);
 	if (!fences)
 		goto err;
 
-	/*
-	 * Assume sync_file a and b are both ordered and have no
-	 * duplicates with the same context.
-	 *
-	 * If a sync_file can only be created with sync_file_merge
-	 * and sync_file_create, this is a reasonable assumption.
-	 */
-	for (i = i_a = i_b = 0; i_a < a_num_fences && i_b < b_num_fences; ) {
-		struct dma_fence *pt_a = a_fences[i_a];
-		struct dma_fence *pt_b = b_fences[i_b];
-
-		if (pt_a->context < pt_b->context) {
-			add_fence(fences, &i, pt_a);
-
-			i_a++;
-		} else if (pt_a->context > pt_b->context) {
-			add_fence(fences, &i, pt_b);
-
-			i_b++;
-		} else {
-			if (pt_a->seqno - pt_b->seqno <= INT_MAX)
-				add_fence(fences, &i, pt_a);
-			else
-				add_fence(fences, &i, pt_b);
-
-			i_a++;
-			i_b++;
-		}
-	}
+	atomic_long_inc(&sync_file_merge_stats.merges);
+	get_fences(a, &i);
+	get_fences(b, &j);
+	atomic_long_add(i + j, &sync_file_merge_stats.fences_in);
+
+	i = 0;
+	sync_file_collect_fences(a->fence, fences, &i);
+	sync_file_collect_fences(b->fence, fences, &i);
 
-	for (; i_a < a_num_fences; i_a++)
-		add_fence(fences, &i, a_fences[i_a]);
+	sort(fences, i, sizeof(*fences), sync_file_fence_cmp, NULL);
 
-	for (; i_b < b_num_fences; i_b++)
-		add_fence(fences, &i, b_fences[i_b]);
+	/* keep the latest fence of each context, and take its reference */
+	for (j = 0, num_fences = 0; j < i; j++) {
+		struct dma_fence *pt = fences[j];
+
+		if (num_fences &&
+		    fences[num_fences - 1]->context == pt->context) {
+			atomic_long_inc(&sync_file_merge_stats.duplicates);
+			if (pt->seqno - fences[num_fences - 1]->seqno <= INT_MAX)
+				fences[num_fences - 1] = pt;
+			continue;
+		}
+		fences[num_fences++] = pt;
+	}
+	i = num_fences;
+	for (j = 0; j < i; j++)
+		dma_fence_get(fences[j]);
 
 	if (i == 0)
-		fences[i++] = dma_fence_get(a_fences[0]);
+		fences[i++] = dma_fence_get(a->fence);
 
-	if (num_fences > i) {
+	if (a_num_fences + b_num_fences > i) {
 		nfences = krealloc(fences, i * sizeof(*fences),
 				  GFP_KERNEL);
-		if (!nfences)
+		if (!nfences) {
+			while (i--)
+				dma_fence_put(fences[i]);
+			kfree(fences);
 			goto err;
+		}
 
 		fences = nfences;
 	}
 
 	if (sync_file_set_fence(sync_file, fences, i) < 0) {
+		while (i--)
+			dma_fence_put(fences[i]);
 		kfree(fences);
 		goto err;
 	}
 
+	atomic_long_add(i, &sync_file_merge_stats.fences_out);
 	strlcpy(sync_file->user_name, name, sizeof(sync_file->user_name));
 	return sync_file;
 
@@ -490,3 +561,46 @@ static const struct file_operations sync_file_fops = {
 	.unlocked_ioctl = sync_file_ioctl,
 	.compat_ioctl = sync_file_ioctl,
 };
+
+#ifdef CONFIG_DEBUG_FS
+static int sync_file_merge_stats_show(struct seq_file *m, void *unused)
+{
+	seq_printf(m, "merges     %ld\n",
+		   atomic_long_read(&sync_file_merge_stats.merges));
+	seq_printf(m, "fences_in  %ld\n",
+		   atomic_long_read(&sync_file_merge_stats.fences_in));
+	seq_printf(m, "leaves     %ld\n",
+		   atomic_long_read(&sync_file_merge_stats.leaves));
+	seq_printf(m, "flattened  %ld\n",
+		   atomic_long_read(&sync_file_merge_stats.flattened));
+	seq_printf(m, "signaled   %ld\n",
+		   atomic_long_read(&sync_file_merge_stats.signaled));
+	seq_printf(m, "duplicates %ld\n",
+		   atomic_long_read(&sync_file_merge_stats.duplicates));
+	seq_printf(m, "fences_out %ld\n",
+		   atomic_long_read(&sync_file_merge_stats.fences_out));
+
+	return 0;
+}
+
+static int sync_file_merge_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sync_file_merge_stats_show, NULL);
+}
+
+static const struct file_operations sync_file_merge_stats_fops = {
+	.open		= sync_file_merge_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init sync_file_debugfs_init(void)
+{
+	debugfs_create_file("sync_file_merge", 0444, dma_buf_debugfs_dir, NULL,
+			    &sync_file_merge_stats_fops);
+
+	return 0;
+}
+late_initcall(sync_file_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
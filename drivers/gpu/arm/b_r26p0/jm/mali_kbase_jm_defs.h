@@ -366,6 +366,8 @@ struct kbase_ext_res {
  *                         input fence got signaled
  * @start_timestamp:       time at which the atom was submitted to the GPU, by
  *                         updating the JS_HEAD_NEXTn register.
+ * @queue_timestamp:       time at which the atom was added to the runnable
+ *                         tree of its context, to measure queueing delay.
  * @udata:                 copy of the user data sent for the atom in
  *                         base_jd_submit.
  * @kctx:                  Pointer to the base context with which the atom is
@@ -486,6 +488,7 @@ struct kbase_ext_res {
 struct kbase_jd_atom {
 	struct work_struct work;
 	ktime_t start_timestamp;
+	ktime_t queue_timestamp;
 
 	struct base_jd_udata udata;
 	struct kbase_context *kctx;
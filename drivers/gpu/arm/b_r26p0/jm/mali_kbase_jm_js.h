@@ -596,6 +596,18 @@ void kbase_js_set_ctx_priority(struct kbase_context *kctx, int new_priority);
  */
 void kbase_js_update_ctx_priority(struct kbase_context *kctx);
 
+/**
+ * kbase_js_update_ctx_ui_boost - update whether the context serves the
+ *                                foreground app
+ *
+ * @kctx: Context pointer
+ *
+ * Called from the submitting thread. While atoms are submitted by a task of
+ * the top-app schedtune group, the context is scheduled at the highest
+ * priority regardless of the priority of its atoms.
+ */
+void kbase_js_update_ctx_ui_boost(struct kbase_context *kctx);
+
 /*
  * Helpers follow
  */
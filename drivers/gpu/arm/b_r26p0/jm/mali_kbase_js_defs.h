@@ -274,6 +274,19 @@ struct kbasep_js_device_data {
 	u32 gpu_reset_ticks_dumping; /*< Value for JS_RESET_TICKS_DUMPING */
 	u32 ctx_timeslice_ns;		 /**< Value for JS_CTX_TIMESLICE_NS */
 
+	/** Contexts submitting from the foreground app are scheduled at the
+	 * highest priority. */
+	bool ui_boost;
+
+	/** Delay from an atom becoming runnable to being pulled, per
+	 * priority of the context it was pulled from. Protected by
+	 * hwaccess_lock. */
+	struct kbasep_js_queue_latency {
+		u64 count;
+		u64 total_ns;
+		u64 max_ns;
+	} queue_latency[KBASE_JS_ATOM_SCHED_PRIO_COUNT];
+
 	/** List of suspended soft jobs */
 	struct list_head suspended_soft_jobs_list;
 
@@ -4086,6 +4086,130 @@ static const struct file_operations
 	.release = single_release,
 };
 
+static int kbase_device_debugfs_mem_pool_low_wm_show(struct seq_file *sfile,
+	void *data)
+{
+	CSTD_UNUSED(data);
+	return kbase_debugfs_helper_seq_read(sfile,
+		MEMORY_GROUP_MANAGER_NR_GROUPS,
+		kbase_mem_pool_debugfs_low_wm);
+}
+
+static ssize_t kbase_device_debugfs_mem_pool_low_wm_write(struct file *file,
+		const char __user *ubuf, size_t count, loff_t *ppos)
+{
+	int err = 0;
+
+	CSTD_UNUSED(ppos);
+	err = kbase_debugfs_helper_seq_write(file, ubuf, count,
+		MEMORY_GROUP_MANAGER_NR_GROUPS,
+		kbase_mem_pool_debugfs_set_low_wm);
+
+	return err ? err : count;
+}
+
+static int kbase_device_debugfs_mem_pool_low_wm_open(struct inode *in,
+	struct file *file)
+{
+	return single_open(file, kbase_device_debugfs_mem_pool_low_wm_show,
+		in->i_private);
+}
+
+static const struct file_operations
+	kbase_device_debugfs_mem_pool_low_wm_fops = {
+	.owner = THIS_MODULE,
+	.open = kbase_device_debugfs_mem_pool_low_wm_open,
+	.read = seq_read,
+	.write = kbase_device_debugfs_mem_pool_low_wm_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int kbase_device_debugfs_mem_pool_fault_show(struct seq_file *sfile,
+	void *data)
+{
+	struct kbase_device *kbdev = sfile->private;
+	u64 refill = 0, lp_refill = 0;
+	int gid;
+
+	CSTD_UNUSED(data);
+
+	for (gid = 0; gid < MEMORY_GROUP_MANAGER_NR_GROUPS; gid++) {
+		refill += READ_ONCE(kbdev->mem_pools.small[gid].refill_pages);
+		lp_refill += READ_ONCE(kbdev->mem_pools.large[gid].refill_pages);
+	}
+
+	seq_printf(sfile, "served from pool: %d\n",
+			atomic_read(&kbdev->mem_pool_fault_served));
+	seq_printf(sfile, "grown on fault: %d\n",
+			atomic_read(&kbdev->mem_pool_fault_grown));
+	seq_printf(sfile, "refilled pages: %llu, lp: %llu\n",
+			refill, lp_refill);
+
+	return 0;
+}
+
+static int kbase_device_debugfs_mem_pool_fault_open(struct inode *in,
+	struct file *file)
+{
+	return single_open(file, kbase_device_debugfs_mem_pool_fault_show,
+		in->i_private);
+}
+
+static const struct file_operations
+	kbase_device_debugfs_mem_pool_fault_fops = {
+	.owner = THIS_MODULE,
+	.open = kbase_device_debugfs_mem_pool_fault_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int kbase_device_debugfs_js_queue_latency_show(struct seq_file *sfile,
+	void *data)
+{
+	static const char * const prio_name[KBASE_JS_ATOM_SCHED_PRIO_COUNT] = {
+		"high", "med", "low",
+	};
+	struct kbase_device *kbdev = sfile->private;
+	struct kbasep_js_queue_latency lat[KBASE_JS_ATOM_SCHED_PRIO_COUNT];
+	unsigned long flags;
+	int prio;
+
+	CSTD_UNUSED(data);
+
+	spin_lock_irqsave(&kbdev->hwaccess_lock, flags);
+	memcpy(lat, kbdev->js_data.queue_latency, sizeof(lat));
+	spin_unlock_irqrestore(&kbdev->hwaccess_lock, flags);
+
+	seq_printf(sfile, "%4s %12s %12s %12s\n",
+			"prio", "count", "avg(us)", "max(us)");
+	for (prio = 0; prio < KBASE_JS_ATOM_SCHED_PRIO_COUNT; prio++)
+		seq_printf(sfile, "%4s %12llu %12llu %12llu\n",
+			prio_name[prio], lat[prio].count,
+			lat[prio].count ? div64_u64(lat[prio].total_ns,
+				lat[prio].count * NSEC_PER_USEC) : 0,
+			div64_u64(lat[prio].max_ns, NSEC_PER_USEC));
+
+	return 0;
+}
+
+static int kbase_device_debugfs_js_queue_latency_open(struct inode *in,
+	struct file *file)
+{
+	return single_open(file, kbase_device_debugfs_js_queue_latency_show,
+		in->i_private);
+}
+
+static const struct file_operations
+	kbase_device_debugfs_js_queue_latency_fops = {
+	.owner = THIS_MODULE,
+	.open = kbase_device_debugfs_js_queue_latency_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 int kbase_device_debugfs_init(struct kbase_device *kbdev)
 {
 	struct dentry *debugfs_ctx_defaults_directory;
@@ -4180,6 +4304,20 @@ int kbase_device_debugfs_init(struct kbase_device *kbdev)
 			&kbdev->mem_pool_defaults.large,
 			&kbase_device_debugfs_mem_pool_max_size_fops);
 
+	debugfs_create_file("mem_pool_low_wm", mode,
+			kbdev->mali_debugfs_directory,
+			&kbdev->mem_pools.small,
+			&kbase_device_debugfs_mem_pool_low_wm_fops);
+
+	debugfs_create_file("lp_mem_pool_low_wm", mode,
+			kbdev->mali_debugfs_directory,
+			&kbdev->mem_pools.large,
+			&kbase_device_debugfs_mem_pool_low_wm_fops);
+
+	debugfs_create_file("mem_pool_fault", S_IRUGO,
+			kbdev->mali_debugfs_directory, kbdev,
+			&kbase_device_debugfs_mem_pool_fault_fops);
+
 	if (kbase_hw_has_feature(kbdev, BASE_HW_FEATURE_PROTECTED_DEBUG_MODE)) {
 		debugfs_create_file("protected_debug_mode", S_IRUGO,
 				kbdev->mali_debugfs_directory, kbdev,
@@ -4203,6 +4341,14 @@ int kbase_device_debugfs_init(struct kbase_device *kbdev)
 			kbdev->mali_debugfs_directory, kbdev,
 			&kbasep_serialize_jobs_debugfs_fops);
 
+	debugfs_create_bool("js_ui_boost", mode,
+			kbdev->mali_debugfs_directory,
+			&kbdev->js_data.ui_boost);
+
+	debugfs_create_file("js_queue_latency", S_IRUGO,
+			kbdev->mali_debugfs_directory, kbdev,
+			&kbase_device_debugfs_js_queue_latency_fops);
+
 	return 0;
 
 out:
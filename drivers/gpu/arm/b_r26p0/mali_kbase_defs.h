@@ -456,6 +456,34 @@ struct kbase_pm_device_data {
 	struct kbase_clk_rate_trace_manager clk_rtm;
 };
 
+/* Default low watermarks of device pools, in pages of the pool */
+#define KBASE_MEM_POOL_LOW_WM     (256)
+#define KBASE_MEM_POOL_LP_LOW_WM  (1)
+
+/* Maximum number of pages cached per cpu in front of a pool */
+#define KBASE_MEM_POOL_PCP_SIZE  (32)
+/* Number of pages moved between the per-cpu cache and the pool at once */
+#define KBASE_MEM_POOL_PCP_BATCH (16)
+
+/**
+ * struct kbase_mem_pool_pcp - Per-cpu cache of free pages in front of a pool
+ * @lock:      Lock protecting the cache. It's only contended while another
+ *             cpu drains the cache back to the pool.
+ * @count:     Number of free pages in @page_list
+ * @page_list: List of free pages cached on this cpu
+ * @hit:       Number of pages allocated without taking the pool lock
+ * @refill:    Number of times the cache was refilled from the pool
+ * @drain:     Number of times the cache was drained to the pool
+ */
+struct kbase_mem_pool_pcp {
+	spinlock_t       lock;
+	size_t           count;
+	struct list_head page_list;
+	u64              hit;
+	u64              refill;
+	u64              drain;
+};
+
 /**
  * struct kbase_mem_pool - Page based memory pool for kctx/kbdev
  * @kbdev:        Kbase device where memory is used
@@ -478,6 +506,14 @@ struct kbase_pm_device_data {
  *                operations should be abandoned
  * @dont_reclaim: true if the shrinker is forbidden from reclaiming memory from
  *                this pool, eg during a grow operation
+ * @low_wm:       Pool is refilled in background when it falls below this
+ *                number of pages. 0 disables the refill. Only the device
+ *                pools have it since context pools are backed by them.
+ * @refill_work:  Work item allocating zeroed pages up to twice @low_wm
+ * @refill_pages: Number of pages added by @refill_work
+ * @pcp:          Per-cpu caches of free pages, refilled from and drained to
+ *                @page_list in batches. Pages in the caches aren't counted in
+ *                @cur_size. NULL for pools of large pages.
  */
 struct kbase_mem_pool {
 	struct kbase_device *kbdev;
@@ -493,6 +529,12 @@ struct kbase_mem_pool {
 
 	bool dying;
 	bool dont_reclaim;
+
+	size_t low_wm;
+	struct work_struct refill_work;
+	u64 refill_pages;
+
+	struct kbase_mem_pool_pcp __percpu *pcp;
 };
 
 /**
@@ -720,6 +762,10 @@ struct kbase_process {
  *                         the device
  * @mem_pools:             Global pools of free physical memory pages which can
  *                         be used by all the contexts.
+ * @mem_pool_fault_served: Number of GPU page faults served by pages already
+ *                         present in the pools
+ * @mem_pool_fault_grown:  Number of GPU page faults which had to grow a pool
+ *                         before they could be served
  * @memdev:                keeps track of the in use physical pages allocated by
  *                         the Driver.
  * @mmu_mode:              Pointer to the object containing methods for programming
@@ -960,6 +1006,8 @@ struct kbase_device {
 	struct kbase_pm_device_data pm;
 
 	struct kbase_mem_pool_group mem_pools;
+	atomic_t mem_pool_fault_served;
+	atomic_t mem_pool_fault_grown;
 	struct kbasep_mem_device memdev;
 	struct kbase_mmu_mode const *mmu_mode;
 
@@ -1562,6 +1610,13 @@ struct kbase_sub_alloc {
  *                        is used to determine the atom's age when it is added to
  *                        the runnable RB-tree.
  * @trim_level:           Level of JIT allocation trimming to perform on free (0-100%)
+ * @jit_bin_peak_pages:   Recent peak of backed pages of JIT allocations per
+ *                        bin, decayed on every free. Backing up to it is
+ *                        kept on free so the next frame needn't grow again.
+ * @jit_grow_stalls:      Number of JIT allocations which had to allocate
+ *                        backing pages in the job path.
+ * @jit_stalls_avoided:   Number of JIT allocations fully served by backing
+ *                        pages retained by @jit_bin_peak_pages.
  * @kprcs:                Reference to @struct kbase_process that the current
  *                        kbase_context belongs to.
  * @kprcs_link:           List link for the list of kbase context maintained
@@ -1574,6 +1629,9 @@ struct kbase_sub_alloc {
  * @gwt_snapshot_list:    Snapshot of the @gwt_current_list for sending to user space.
  * @priority:             Indicates the context priority. Used along with @atoms_count
  *                        for context scheduling, protected by hwaccess_lock.
+ * @ui_boost:             Set while atoms are submitted by the foreground app,
+ *                        raising @priority to the highest. Protected by
+ *                        hwaccess_lock.
  * @atoms_count:          Number of GPU atoms currently in use, per priority
  * @create_flags:         Flags used in context creation.
  * @kinstr_jm:            Kernel job manager instrumentation context handle
@@ -1637,6 +1695,7 @@ struct kbase_context {
 	int atoms_pulled_slot_pri[BASE_JM_MAX_NR_SLOTS][
 			KBASE_JS_ATOM_SCHED_PRIO_COUNT];
 	int priority;
+	bool ui_boost;
 	bool blocked_js[BASE_JM_MAX_NR_SLOTS][KBASE_JS_ATOM_SCHED_PRIO_COUNT];
 	s16 atoms_count[KBASE_JS_ATOM_SCHED_PRIO_COUNT];
 	u32 slots_pullable;
@@ -1712,6 +1771,9 @@ struct kbase_context {
 	struct list_head ext_res_meta_head;
 
 	u8 trim_level;
+	u32 jit_bin_peak_pages[256];
+	u32 jit_grow_stalls;
+	u32 jit_stalls_avoided;
 
 	struct kbase_process *kprcs;
 	struct list_head kprcs_link;
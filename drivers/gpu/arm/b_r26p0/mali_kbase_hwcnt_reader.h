@@ -42,6 +42,7 @@
 #define KBASE_HWCNT_READER_SET_INTERVAL    _IOW(KBASE_HWCNT_READER, 0x30, u32)
 #define KBASE_HWCNT_READER_ENABLE_EVENT    _IOW(KBASE_HWCNT_READER, 0x40, u32)
 #define KBASE_HWCNT_READER_DISABLE_EVENT   _IOW(KBASE_HWCNT_READER, 0x41, u32)
+#define KBASE_HWCNT_READER_GET_OVERRUN     _IOR(KBASE_HWCNT_READER, 0x50, u32)
 #define KBASE_HWCNT_READER_GET_API_VERSION _IOW(KBASE_HWCNT_READER, 0xFF, u32)
 #define KBASE_HWCNT_READER_GET_API_VERSION_WITH_FEATURES \
 		_IOW(KBASE_HWCNT_READER, 0xFF, \
@@ -72,6 +73,27 @@ struct kbase_hwcnt_reader_metadata {
 	struct kbase_hwcnt_reader_metadata_cycles cycles;
 };
 
+/**
+ * struct kbase_hwcnt_reader_ring - hwcnt reader sample ring shared with user
+ * @write_idx: number of samples written, advanced by the kernel
+ * @read_idx:  number of samples consumed, advanced by the reader
+ * @buf_cnt:   number of sample buffers in the ring
+ * @overrun:   number of periodic samples not taken because the ring was full
+ * @meta:      metadata of sample buffers, indexed by (idx % buf_cnt)
+ *
+ * The ring is mapped one page at the page aligned end of the sample buffers.
+ * Once it is mapped, samples are consumed by advancing read_idx instead of
+ * GET_BUFFER/PUT_BUFFER, so a reader needs no ioctl per sample. Counters of
+ * a sample which is not taken are accumulated into the next one.
+ */
+struct kbase_hwcnt_reader_ring {
+	u32 write_idx;
+	u32 read_idx;
+	u32 buf_cnt;
+	u32 overrun;
+	struct kbase_hwcnt_reader_metadata meta[];
+};
+
 /**
  * enum base_hwcnt_reader_event - hwcnt dumping events
  * @BASE_HWCNT_READER_EVENT_MANUAL:   manual request for dump
@@ -97,6 +119,7 @@ enum base_hwcnt_reader_event {
 #define KBASE_HWCNT_READER_API_VERSION_NO_FEATURE                  (0)
 #define KBASE_HWCNT_READER_API_VERSION_FEATURE_CYCLES_TOP          (1 << 0)
 #define KBASE_HWCNT_READER_API_VERSION_FEATURE_CYCLES_SHADER_CORES (1 << 1)
+#define KBASE_HWCNT_READER_API_VERSION_FEATURE_RING               (1 << 2)
 struct kbase_hwcnt_reader_api_version {
 	u32 version;
 	u32 features;
@@ -41,6 +41,7 @@
 /* MALI_SEC_INTEGRATION */
 #include <linux/smc.h>
 #include "platform/exynos/gpu_integration_defs.h"
+#include <soc/samsung/exynos-frametrace.h>
 #include <mali_kbase_cs_experimental.h>
 #include <mali_kbase_caps.h>
 
@@ -77,11 +78,31 @@ get_compat_pointer(struct kbase_context *kctx, const u64 p)
 	return u64_to_user_ptr(p);
 }
 
+/* Trace the imported dma-bufs of an atom in exynos-frametrace */
+static void jd_frametrace_atom(struct kbase_jd_atom *katom,
+			       enum exynos_frametrace_stage stage)
+{
+	struct kbase_mem_phy_alloc *alloc;
+	u16 i;
+
+	if (!exynos_frametrace_enabled() || !katom->extres ||
+	    !(katom->core_req & BASE_JD_REQ_EXTERNAL_RESOURCES))
+		return;
+
+	for (i = 0; i < katom->nr_extres; i++) {
+		alloc = katom->extres[i].alloc;
+		if (alloc && alloc->type == KBASE_MEM_TYPE_IMPORTED_UMM)
+			exynos_frametrace(alloc->imported.umm.dma_buf, stage,
+					  kbase_jd_atom_id(katom->kctx, katom));
+	}
+}
+
 /* Mark an atom as complete, and trace it in kinstr_jm */
 static void jd_mark_atom_complete(struct kbase_jd_atom *katom)
 {
 	katom->status = KBASE_JD_ATOM_STATE_COMPLETED;
 	kbase_kinstr_jm_atom_complete(katom);
+	jd_frametrace_atom(katom, EXYNOS_FRAMETRACE_GPU_DONE);
 	dev_dbg(katom->kctx->kbdev->dev, "Atom %p status to completed\n",
 		(void *)katom);
 }
@@ -124,6 +145,7 @@ static bool jd_run_atom(struct kbase_jd_atom *katom)
 
 	katom->status = KBASE_JD_ATOM_STATE_IN_JS;
 	dev_dbg(kctx->kbdev->dev, "Atom %p status to in JS\n", (void *)katom);
+	jd_frametrace_atom(katom, EXYNOS_FRAMETRACE_GPU_START);
 	/* Queue an action about whether we should try scheduling a context */
 	return kbasep_js_add_job(kctx, katom);
 }
@@ -1263,6 +1285,8 @@ int kbase_jd_submit(struct kbase_context *kctx,
 	/* All atoms submitted in this call have the same flush ID */
 	latest_flush = kbase_backend_get_current_flush_id(kbdev);
 
+	kbase_js_update_ctx_ui_boost(kctx);
+
 	for (i = 0; i < nr_atoms; i++) {
 		struct base_jd_atom user_atom;
 		struct base_jd_fragment user_jc_incr;
@@ -34,6 +34,7 @@
 
 #include <mali_kbase_defs.h>
 #include <mali_kbase_config_defaults.h>
+#include <linux/ems_service.h>
 
 #include "mali_kbase_jm.h"
 #include "mali_kbase_hwaccess_jm.h"
@@ -403,6 +404,8 @@ jsctx_tree_add(struct kbase_context *kctx, struct kbase_jd_atom *katom)
 	rb_link_node(&katom->runnable_tree_node, parent, new);
 	rb_insert_color(&katom->runnable_tree_node, &queue->runnable_tree);
 
+	katom->queue_timestamp = ktime_get();
+
 	KBASE_TLSTREAM_TL_ATTRIB_ATOM_STATE(kbdev, katom, TL_ATOM_STATE_READY);
 }
 
@@ -476,6 +479,7 @@ int kbasep_js_devdata_init(struct kbase_device * const kbdev)
 	jsdd->gpu_reset_ticks_cl = DEFAULT_JS_RESET_TICKS_CL;
 	jsdd->gpu_reset_ticks_dumping = DEFAULT_JS_RESET_TICKS_DUMPING;
 	jsdd->ctx_timeslice_ns = DEFAULT_JS_CTX_TIMESLICE_NS;
+	jsdd->ui_boost = true;
 	atomic_set(&jsdd->soft_job_timeout_ms, DEFAULT_JS_SOFT_JOB_TIMEOUT);
 
 	dev_dbg(kbdev->dev, "JS Config Attribs: ");
@@ -1177,7 +1181,11 @@ void kbase_js_update_ctx_priority(struct kbase_context *kctx)
 
 	lockdep_assert_held(&kbdev->hwaccess_lock);
 
-	if (kbdev->js_ctx_scheduling_mode == KBASE_JS_SYSTEM_PRIORITY_MODE) {
+	if (kctx->ui_boost) {
+		/* Foreground app goes ahead of the others */
+		new_priority = KBASE_JS_ATOM_SCHED_PRIO_HIGH;
+	} else if (kbdev->js_ctx_scheduling_mode ==
+			KBASE_JS_SYSTEM_PRIORITY_MODE) {
 		/* Determine the new priority for context, as per the priority
 		 * of currently in-use atoms.
 		 */
@@ -1193,6 +1201,22 @@ void kbase_js_update_ctx_priority(struct kbase_context *kctx)
 	kbase_js_set_ctx_priority(kctx, new_priority);
 }
 
+void kbase_js_update_ctx_ui_boost(struct kbase_context *kctx)
+{
+	struct kbase_device *kbdev = kctx->kbdev;
+	unsigned long flags;
+	bool ui_boost;
+
+	ui_boost = kbdev->js_data.ui_boost && ems_task_is_topapp(current);
+	if (READ_ONCE(kctx->ui_boost) == ui_boost)
+		return;
+
+	spin_lock_irqsave(&kbdev->hwaccess_lock, flags);
+	kctx->ui_boost = ui_boost;
+	kbase_js_update_ctx_priority(kctx);
+	spin_unlock_irqrestore(&kbdev->hwaccess_lock, flags);
+}
+
 /**
  * js_add_start_rp() - Add an atom that starts a renderpass to the job scheduler
  * @start_katom: Pointer to the atom to be added.
@@ -2424,6 +2448,30 @@ static void kbase_js_evict_deps(struct kbase_context *kctx,
 	}
 }
 
+/**
+ * js_account_queue_latency() - Account the delay an atom spent runnable
+ * @kctx:  Context the atom is pulled from
+ * @katom: Pointer to the atom being pulled
+ *
+ * The delay is accounted to the current priority of the context, which is
+ * the list the context was waiting in.
+ */
+static void js_account_queue_latency(struct kbase_context *kctx,
+		struct kbase_jd_atom *katom)
+{
+	struct kbasep_js_queue_latency *lat =
+		&kctx->kbdev->js_data.queue_latency[kctx->priority];
+	u64 delay = ktime_to_ns(ktime_sub(ktime_get(),
+			katom->queue_timestamp));
+
+	lockdep_assert_held(&kctx->kbdev->hwaccess_lock);
+
+	lat->count++;
+	lat->total_ns += delay;
+	if (delay > lat->max_ns)
+		lat->max_ns = delay;
+}
+
 struct kbase_jd_atom *kbase_js_pull(struct kbase_context *kctx, int js)
 {
 	struct kbase_jd_atom *katom;
@@ -2518,6 +2566,8 @@ struct kbase_jd_atom *kbase_js_pull(struct kbase_context *kctx, int js)
 
 	katom->ticks = 0;
 
+	js_account_queue_latency(kctx, katom);
+
 	dev_dbg(kbdev->dev, "JS: successfully pulled atom %p from kctx %p (s:%d)\n",
 		(void *)katom, (void *)kctx, js);
 
@@ -3274,6 +3324,8 @@ struct kbase_jd_atom *kbase_js_complete_atom(struct kbase_jd_atom *katom,
 		/* MALI_SEC_INTEGRATION */
 		if (kbdev->vendor_callbacks->cl_boost_update_utilization)
 			kbdev->vendor_callbacks->cl_boost_update_utilization(kbdev, katom, microseconds_spent);
+		if (kbdev->vendor_callbacks->dvfs_update_busy)
+			kbdev->vendor_callbacks->dvfs_update_busy(kbdev, katom, end_timestamp);
 
 		do_div(microseconds_spent, 1000);
 
@@ -67,6 +67,13 @@
  */
 #define KBASE_GPU_ALLOCATED_OBJECT_MAX_BYTES (512u)
 
+/*
+ * Recent peak backed size of a JIT bin loses 1/(2^shift) of itself on every
+ * free, so backing retained for a past peak is released after a few frames of
+ * lower usage.
+ */
+#define KBASE_JIT_PEAK_DECAY_SHIFT (3)
+
 
 /* Forward declarations */
 static void free_partial_locked(struct kbase_context *kctx,
@@ -2974,6 +2981,29 @@ static int kbase_jit_debugfs_count_get(struct kbase_jit_debugfs_data *data)
 KBASE_JIT_DEBUGFS_DECLARE(kbase_jit_debugfs_count_fops,
 		kbase_jit_debugfs_count_get);
 
+/*
+ * Reports allocations which grew backing in the job path, allocations served
+ * by retained backing and the pages currently retained in the pool.
+ */
+static int kbase_jit_debugfs_history_get(struct kbase_jit_debugfs_data *data)
+{
+	struct kbase_context *kctx = data->kctx;
+	struct kbase_va_region *reg;
+
+	data->active_value = READ_ONCE(kctx->jit_grow_stalls);
+	data->pool_value = READ_ONCE(kctx->jit_stalls_avoided);
+
+	mutex_lock(&kctx->jit_evict_lock);
+	list_for_each_entry(reg, &kctx->jit_pool_head, jit_node) {
+		data->destroy_value += reg->jit_retained_pages;
+	}
+	mutex_unlock(&kctx->jit_evict_lock);
+
+	return 0;
+}
+KBASE_JIT_DEBUGFS_DECLARE(kbase_jit_debugfs_history_fops,
+		kbase_jit_debugfs_history_get);
+
 static int kbase_jit_debugfs_vm_get(struct kbase_jit_debugfs_data *data)
 {
 	struct kbase_context *kctx = data->kctx;
@@ -3117,6 +3147,13 @@ void kbase_jit_debugfs_init(struct kbase_context *kctx)
 	 */
 	debugfs_create_file("mem_jit_phys", mode, kctx->kctx_dentry,
 			kctx, &kbase_jit_debugfs_phys_fops);
+
+	/*
+	 * Debugfs entry for getting the JIT allocation stalls and the stalls
+	 * avoided by backing retained for the recent peak usage.
+	 */
+	debugfs_create_file("mem_jit_history", mode, kctx->kctx_dentry,
+			kctx, &kbase_jit_debugfs_history_fops);
 #if MALI_JIT_PRESSURE_LIMIT_BASE
 	/*
 	 * Debugfs entry for getting the number of pages used
@@ -3401,8 +3438,13 @@ static int kbase_jit_grow(struct kbase_context *kctx,
 	if (!kbase_mem_evictable_unmake(reg->gpu_alloc))
 		goto update_failed;
 
-	if (reg->gpu_alloc->nents >= info->commit_pages)
+	if (reg->gpu_alloc->nents >= info->commit_pages) {
+		if (reg->jit_retained_pages)
+			kctx->jit_stalls_avoided++;
 		goto done;
+	}
+
+	kctx->jit_grow_stalls++;
 
 	/* Grow the backing */
 	old_size = reg->gpu_alloc->nents;
@@ -3836,6 +3878,7 @@ struct kbase_va_region *kbase_jit_allocate(struct kbase_context *kctx,
 		mutex_unlock(&kctx->jit_evict_lock);
 		kbase_gpu_vm_unlock(kctx);
 
+		kctx->jit_grow_stalls++;
 		reg = kbase_mem_alloc(kctx, info->va_pages, info->commit_pages,
 				info->extent, &flags, &gpu_addr);
 		if (!reg) {
@@ -3891,20 +3934,37 @@ end:
 void kbase_jit_free(struct kbase_context *kctx, struct kbase_va_region *reg)
 {
 	u64 old_pages;
+	u32 peak_pages;
 
 	/* JIT id not immediately available here, so use 0u */
 	trace_mali_jit_free(reg, 0u);
 
 	/* Get current size of JIT region */
 	old_pages = kbase_reg_current_backed_size(reg);
+
+	/* Decay the recent peak of the bin, then raise it by this usage */
+	peak_pages = READ_ONCE(kctx->jit_bin_peak_pages[reg->jit_bin_id]);
+	peak_pages -= peak_pages >> KBASE_JIT_PEAK_DECAY_SHIFT;
+	peak_pages = max_t(u32, peak_pages, old_pages);
+	WRITE_ONCE(kctx->jit_bin_peak_pages[reg->jit_bin_id], peak_pages);
+
+	reg->jit_retained_pages = 0;
 	if (reg->initial_commit < old_pages) {
 		/* Free trim_level % of region, but don't go below initial
-		 * commit size
+		 * commit size nor the recent peak of the bin. Pages kept for
+		 * the peak are still reclaimable through the evict list.
 		 */
 		u64 new_size = MAX(reg->initial_commit,
 			div_u64(old_pages * (100 - kctx->trim_level), 100));
-		u64 delta = old_pages - new_size;
+		u64 retain_size = MIN(old_pages, (u64)peak_pages);
+		u64 delta;
 
+		if (retain_size > new_size) {
+			reg->jit_retained_pages = retain_size - new_size;
+			new_size = retain_size;
+		}
+
+		delta = old_pages - new_size;
 		if (delta)
 			kbase_mem_shrink(kctx, reg, old_pages - delta);
 	}
@@ -3966,6 +4026,11 @@ void kbase_jit_backing_lost(struct kbase_va_region *reg)
 	 */
 	list_move(&reg->jit_node, &kctx->jit_destroy_head);
 
+	/* Memory is under pressure, stop retaining backing for this bin until
+	 * its usage builds up again.
+	 */
+	WRITE_ONCE(kctx->jit_bin_peak_pages[reg->jit_bin_id], 0);
+
 	schedule_work(&kctx->jit_work);
 }
 
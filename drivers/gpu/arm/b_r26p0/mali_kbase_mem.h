@@ -269,6 +269,8 @@ static inline struct kbase_mem_phy_alloc *kbase_mem_phy_alloc_put(struct kbase_m
  * @jit_node:     Links to neighboring regions in the just-in-time memory pool.
  * @jit_usage_id: The last just-in-time memory usage ID for this region.
  * @jit_bin_id:   The just-in-time memory bin this region came from.
+ * @jit_retained_pages: Backing pages kept on free beyond trim_level because
+ *                      of the recent peak usage of the region's bin.
  * @va_refcnt:    Number of users of this region. Protected by reg_lock.
  */
 struct kbase_va_region {
@@ -403,6 +405,7 @@ struct kbase_va_region {
 	struct list_head jit_node;
 	u16 jit_usage_id;
 	u8 jit_bin_id;
+	u32 jit_retained_pages;
 #if MALI_JIT_PRESSURE_LIMIT_BASE
 	/* Pointer to an object in GPU memory defining an end of an allocated
 	 * region
@@ -900,6 +903,44 @@ static inline size_t kbase_mem_pool_size(struct kbase_mem_pool *pool)
 	return READ_ONCE(pool->cur_size);
 }
 
+/**
+ * kbase_mem_pool_set_low_wm - Set the low watermark of a memory pool
+ * @pool:   Memory pool to modify
+ * @low_wm: Pool is refilled in background with zeroed pages when it falls
+ *          below this number of pages. 0 disables the refill.
+ */
+void kbase_mem_pool_set_low_wm(struct kbase_mem_pool *pool, size_t low_wm);
+
+/**
+ * kbase_mem_pool_low_wm - Get the low watermark of a memory pool
+ * @pool:  Memory pool to inspect
+ *
+ * Return: Number of pages below which the pool is refilled in background
+ */
+static inline size_t kbase_mem_pool_low_wm(struct kbase_mem_pool *pool)
+{
+	return READ_ONCE(pool->low_wm);
+}
+
+/**
+ * kbase_mem_pool_pcp_size - Get number of free pages cached on all cpus
+ * @pool:  Memory pool to inspect
+ *
+ * Return: Number of free pages in the per-cpu caches of the pool, these are
+ *         not included in kbase_mem_pool_size()
+ */
+size_t kbase_mem_pool_pcp_size(struct kbase_mem_pool *pool);
+
+/**
+ * kbase_mem_pool_pcp_stat - Get statistics of the per-cpu caches of a pool
+ * @pool:   Memory pool to inspect
+ * @hit:    Number of pages allocated without taking the pool lock
+ * @refill: Number of batches moved from the pool to the caches
+ * @drain:  Number of times the caches were drained to the pool
+ */
+void kbase_mem_pool_pcp_stat(struct kbase_mem_pool *pool, u64 *hit,
+		u64 *refill, u64 *drain);
+
 /**
  * kbase_mem_pool_max_size - Get maximum number of free pages in memory pool
  * @pool:  Memory pool to inspect
@@ -27,6 +27,7 @@
 #include <linux/spinlock.h>
 #include <linux/shrinker.h>
 #include <linux/atomic.h>
+#include <linux/percpu.h>
 #include <linux/version.h>
 
 #define pool_dbg(pool, format, ...) \
@@ -123,6 +124,190 @@ static struct page *kbase_mem_pool_remove(struct kbase_mem_pool *pool)
 	return p;
 }
 
+/*
+ * Device pools are refilled in background so that a GPU page fault finds
+ * pages there instead of growing a pool synchronously. It may be called with
+ * the pool lock held.
+ */
+static void kbase_mem_pool_check_low_wm(struct kbase_mem_pool *pool)
+{
+	size_t low_wm = READ_ONCE(pool->low_wm);
+
+	if (low_wm && kbase_mem_pool_size(pool) < low_wm && !pool->dying)
+		queue_work(system_unbound_wq, &pool->refill_work);
+}
+
+static void kbase_mem_pool_refill_worker(struct work_struct *work)
+{
+	struct kbase_mem_pool *pool = container_of(work, struct kbase_mem_pool,
+			refill_work);
+	size_t target = min(READ_ONCE(pool->low_wm) * 2,
+			kbase_mem_pool_max_size(pool));
+	size_t cur_size = kbase_mem_pool_size(pool);
+
+	if (cur_size >= target)
+		return;
+
+	/* Pages from the kernel are zeroed by the allocation */
+	if (!kbase_mem_pool_grow(pool, target - cur_size))
+		pool->refill_pages += target - cur_size;
+
+	pool_dbg(pool, "refilled up to %zu pages\n", target);
+}
+
+void kbase_mem_pool_set_low_wm(struct kbase_mem_pool *pool, size_t low_wm)
+{
+	WRITE_ONCE(pool->low_wm, low_wm);
+	kbase_mem_pool_check_low_wm(pool);
+}
+
+/*
+ * Takes a page from the cache of the current cpu. An empty cache is refilled
+ * from the pool in a batch so that the pool lock is taken once per batch.
+ */
+static struct page *kbase_mem_pool_pcp_alloc(struct kbase_mem_pool *pool)
+{
+	struct kbase_mem_pool_pcp *pcp;
+	struct page *p = NULL;
+	bool refilled = false;
+	size_t i;
+
+	if (!pool->pcp)
+		return NULL;
+
+	pcp = get_cpu_ptr(pool->pcp);
+	spin_lock(&pcp->lock);
+
+	if (!pcp->count) {
+		kbase_mem_pool_lock(pool);
+		for (i = 0; i < KBASE_MEM_POOL_PCP_BATCH; i++) {
+			p = kbase_mem_pool_remove_locked(pool);
+			if (!p)
+				break;
+
+			list_add(&p->lru, &pcp->page_list);
+			pcp->count++;
+		}
+		kbase_mem_pool_unlock(pool);
+
+		if (pcp->count)
+			pcp->refill++;
+		refilled = true;
+	}
+
+	p = NULL;
+	if (pcp->count) {
+		p = list_first_entry(&pcp->page_list, struct page, lru);
+		list_del_init(&p->lru);
+		pcp->count--;
+		if (!refilled)
+			pcp->hit++;
+	}
+
+	spin_unlock(&pcp->lock);
+	put_cpu_ptr(pool->pcp);
+
+	return p;
+}
+
+/*
+ * Puts a free page into the cache of the current cpu. A full cache is
+ * drained to the pool in a batch first, which may overfill the pool.
+ */
+static bool kbase_mem_pool_pcp_free(struct kbase_mem_pool *pool,
+		struct page *p)
+{
+	struct kbase_mem_pool_pcp *pcp;
+	struct page *q;
+	size_t i;
+
+	if (!pool->pcp)
+		return false;
+
+	pcp = get_cpu_ptr(pool->pcp);
+	spin_lock(&pcp->lock);
+
+	if (pcp->count >= KBASE_MEM_POOL_PCP_SIZE) {
+		kbase_mem_pool_lock(pool);
+		for (i = 0; i < KBASE_MEM_POOL_PCP_BATCH; i++) {
+			q = list_last_entry(&pcp->page_list, struct page, lru);
+			list_del_init(&q->lru);
+			pcp->count--;
+			kbase_mem_pool_add_locked(pool, q);
+		}
+		kbase_mem_pool_unlock(pool);
+		pcp->drain++;
+	}
+
+	list_add(&p->lru, &pcp->page_list);
+	pcp->count++;
+
+	spin_unlock(&pcp->lock);
+	put_cpu_ptr(pool->pcp);
+
+	return true;
+}
+
+/* Moves the pages cached on every cpu back to the pool */
+static void kbase_mem_pool_pcp_drain(struct kbase_mem_pool *pool)
+{
+	struct kbase_mem_pool_pcp *pcp;
+	int cpu;
+
+	if (!pool->pcp)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		pcp = per_cpu_ptr(pool->pcp, cpu);
+
+		spin_lock(&pcp->lock);
+		if (pcp->count) {
+			kbase_mem_pool_lock(pool);
+			kbase_mem_pool_add_list_locked(pool, &pcp->page_list,
+					pcp->count);
+			kbase_mem_pool_unlock(pool);
+
+			INIT_LIST_HEAD(&pcp->page_list);
+			pcp->count = 0;
+			pcp->drain++;
+		}
+		spin_unlock(&pcp->lock);
+	}
+}
+
+size_t kbase_mem_pool_pcp_size(struct kbase_mem_pool *pool)
+{
+	size_t size = 0;
+	int cpu;
+
+	if (!pool->pcp)
+		return 0;
+
+	for_each_possible_cpu(cpu)
+		size += READ_ONCE(per_cpu_ptr(pool->pcp, cpu)->count);
+
+	return size;
+}
+
+void kbase_mem_pool_pcp_stat(struct kbase_mem_pool *pool, u64 *hit,
+		u64 *refill, u64 *drain)
+{
+	struct kbase_mem_pool_pcp *pcp;
+	int cpu;
+
+	*hit = *refill = *drain = 0;
+
+	if (!pool->pcp)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		pcp = per_cpu_ptr(pool->pcp, cpu);
+		*hit += READ_ONCE(pcp->hit);
+		*refill += READ_ONCE(pcp->refill);
+		*drain += READ_ONCE(pcp->drain);
+	}
+}
+
 static void kbase_mem_pool_sync_page(struct kbase_mem_pool *pool,
 		struct page *p)
 {
@@ -282,6 +467,8 @@ void kbase_mem_pool_trim(struct kbase_mem_pool *pool, size_t new_size)
 	size_t cur_size;
 	int err = 0;
 
+	kbase_mem_pool_pcp_drain(pool);
+
 	cur_size = kbase_mem_pool_size(pool);
 
 	if (new_size > pool->max_size)
@@ -306,6 +493,8 @@ void kbase_mem_pool_set_max_size(struct kbase_mem_pool *pool, size_t max_size)
 	size_t cur_size;
 	size_t nr_to_shrink;
 
+	kbase_mem_pool_pcp_drain(pool);
+
 	kbase_mem_pool_lock(pool);
 
 	pool->max_size = max_size;
@@ -336,7 +525,7 @@ static unsigned long kbase_mem_pool_reclaim_count_objects(struct shrinker *s,
 	pool_size = kbase_mem_pool_size(pool);
 	kbase_mem_pool_unlock(pool);
 
-	return pool_size;
+	return pool_size + kbase_mem_pool_pcp_size(pool);
 }
 
 static unsigned long kbase_mem_pool_reclaim_scan_objects(struct shrinker *s,
@@ -347,6 +536,10 @@ static unsigned long kbase_mem_pool_reclaim_scan_objects(struct shrinker *s,
 
 	pool = container_of(s, struct kbase_mem_pool, reclaim);
 
+	/* cached pages are reclaimed as well */
+	if (!READ_ONCE(pool->dont_reclaim) || READ_ONCE(pool->dying))
+		kbase_mem_pool_pcp_drain(pool);
+
 	kbase_mem_pool_lock(pool);
 	if (pool->dont_reclaim && !pool->dying) {
 		kbase_mem_pool_unlock(pool);
@@ -394,10 +587,36 @@ int kbase_mem_pool_init(struct kbase_mem_pool *pool,
 	pool->kbdev = kbdev;
 	pool->next_pool = next_pool;
 	pool->dying = false;
+	pool->refill_pages = 0;
+	pool->low_wm = 0;
+	if (!next_pool)
+		pool->low_wm = order ? KBASE_MEM_POOL_LP_LOW_WM :
+				KBASE_MEM_POOL_LOW_WM;
+	INIT_WORK(&pool->refill_work, kbase_mem_pool_refill_worker);
 
 	spin_lock_init(&pool->pool_lock);
 	INIT_LIST_HEAD(&pool->page_list);
 
+	/* Pages of large pools are too big to be kept aside on every cpu */
+	pool->pcp = NULL;
+	if (!order) {
+		pool->pcp = alloc_percpu(struct kbase_mem_pool_pcp);
+		if (pool->pcp) {
+			int cpu;
+
+			for_each_possible_cpu(cpu) {
+				struct kbase_mem_pool_pcp *pcp =
+					per_cpu_ptr(pool->pcp, cpu);
+
+				spin_lock_init(&pcp->lock);
+				INIT_LIST_HEAD(&pcp->page_list);
+			}
+		} else {
+			dev_warn(kbdev->dev,
+				"Mem pool runs without per-cpu cache\n");
+		}
+	}
+
 	/* Register shrinker */
 #if LINUX_VERSION_CODE < KERNEL_VERSION(3, 12, 0)
 	pool->reclaim.shrink = kbase_mem_pool_reclaim_shrink;
@@ -436,8 +655,13 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 
 	pool_dbg(pool, "terminate()\n");
 
+	WRITE_ONCE(pool->low_wm, 0);
+	cancel_work_sync(&pool->refill_work);
+
 	unregister_shrinker(&pool->reclaim);
 
+	kbase_mem_pool_pcp_drain(pool);
+
 	kbase_mem_pool_lock(pool);
 	pool->max_size = 0;
 
@@ -476,6 +700,9 @@ void kbase_mem_pool_term(struct kbase_mem_pool *pool)
 		kbase_mem_pool_free_page(pool, p);
 	}
 
+	free_percpu(pool->pcp);
+	pool->pcp = NULL;
+
 	pool_dbg(pool, "terminated\n");
 }
 
@@ -485,7 +712,11 @@ struct page *kbase_mem_pool_alloc(struct kbase_mem_pool *pool)
 
 	do {
 		pool_dbg(pool, "alloc()\n");
-		p = kbase_mem_pool_remove(pool);
+		if (pool->pcp)
+			p = kbase_mem_pool_pcp_alloc(pool);
+		else
+			p = kbase_mem_pool_remove(pool);
+		kbase_mem_pool_check_low_wm(pool);
 
 		if (p)
 			return p;
@@ -504,6 +735,7 @@ struct page *kbase_mem_pool_alloc_locked(struct kbase_mem_pool *pool)
 
 	pool_dbg(pool, "alloc_locked()\n");
 	p = kbase_mem_pool_remove_locked(pool);
+	kbase_mem_pool_check_low_wm(pool);
 
 	if (p)
 		return p;
@@ -523,7 +755,8 @@ void kbase_mem_pool_free(struct kbase_mem_pool *pool, struct page *p,
 		if (dirty)
 			kbase_mem_pool_sync_page(pool, p);
 
-		kbase_mem_pool_add(pool, p);
+		if (!kbase_mem_pool_pcp_free(pool, p))
+			kbase_mem_pool_add(pool, p);
 	} else if (next_pool && !kbase_mem_pool_is_full(next_pool)) {
 		/* Spill to next pool */
 		kbase_mem_pool_spill(next_pool, p);
@@ -569,9 +802,27 @@ int kbase_mem_pool_alloc_pages(struct kbase_mem_pool *pool, size_t nr_4k_pages,
 	pool_dbg(pool, "alloc_pages(4k=%zu):\n", nr_4k_pages);
 	pool_dbg(pool, "alloc_pages(internal=%zu):\n", nr_pages_internal);
 
+	/* Get pages cached on this cpu first, only small pools have them */
+	if (pool->pcp) {
+		struct kbase_mem_pool_pcp *pcp = get_cpu_ptr(pool->pcp);
+
+		spin_lock(&pcp->lock);
+		nr_from_pool = min(nr_pages_internal, pcp->count);
+		if (nr_from_pool)
+			pcp->hit += nr_from_pool;
+		while (nr_from_pool--) {
+			p = list_first_entry(&pcp->page_list, struct page, lru);
+			list_del_init(&p->lru);
+			pcp->count--;
+			pages[i++] = as_tagged(page_to_phys(p));
+		}
+		spin_unlock(&pcp->lock);
+		put_cpu_ptr(pool->pcp);
+	}
+
 	/* Get pages from this pool */
 	kbase_mem_pool_lock(pool);
-	nr_from_pool = min(nr_pages_internal, kbase_mem_pool_size(pool));
+	nr_from_pool = min(nr_pages_internal - i, kbase_mem_pool_size(pool));
 	while (nr_from_pool--) {
 		int j;
 		p = kbase_mem_pool_remove_locked(pool);
@@ -586,6 +837,7 @@ int kbase_mem_pool_alloc_pages(struct kbase_mem_pool *pool, size_t nr_4k_pages,
 			pages[i++] = as_tagged(page_to_phys(p));
 		}
 	}
+	kbase_mem_pool_check_low_wm(pool);
 	kbase_mem_pool_unlock(pool);
 
 	if (i != nr_4k_pages && pool->next_pool) {
@@ -676,6 +928,8 @@ int kbase_mem_pool_alloc_pages_locked(struct kbase_mem_pool *pool,
 		}
 	}
 
+	kbase_mem_pool_check_low_wm(pool);
+
 	return nr_4k_pages;
 }
 
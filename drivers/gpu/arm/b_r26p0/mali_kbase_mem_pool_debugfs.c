@@ -72,6 +72,29 @@ size_t kbase_mem_pool_debugfs_max_size(void *const array, size_t const index)
 	return kbase_mem_pool_max_size(&mem_pools[index]);
 }
 
+void kbase_mem_pool_debugfs_set_low_wm(void *const array,
+	size_t const index, size_t const value)
+{
+	struct kbase_mem_pool *const mem_pools = array;
+
+	if (WARN_ON(!mem_pools) ||
+		WARN_ON(index >= MEMORY_GROUP_MANAGER_NR_GROUPS))
+		return;
+
+	kbase_mem_pool_set_low_wm(&mem_pools[index], value);
+}
+
+size_t kbase_mem_pool_debugfs_low_wm(void *const array, size_t const index)
+{
+	struct kbase_mem_pool *const mem_pools = array;
+
+	if (WARN_ON(!mem_pools) ||
+		WARN_ON(index >= MEMORY_GROUP_MANAGER_NR_GROUPS))
+		return 0;
+
+	return kbase_mem_pool_low_wm(&mem_pools[index]);
+}
+
 void kbase_mem_pool_config_debugfs_set_max_size(void *const array,
 	size_t const index, size_t const value)
 {
@@ -166,6 +189,41 @@ static const struct file_operations kbase_mem_pool_debugfs_max_size_fops = {
 	.release = single_release,
 };
 
+static int kbase_mem_pool_debugfs_pcp_show(struct seq_file *sfile, void *data)
+{
+	struct kbase_mem_pool *const mem_pools = sfile->private;
+	u64 hit, refill, drain;
+	int i;
+
+	CSTD_UNUSED(data);
+
+	seq_printf(sfile, "%5s %8s %12s %12s %12s\n",
+			"group", "cached", "hit", "refill", "drain");
+
+	for (i = 0; i < MEMORY_GROUP_MANAGER_NR_GROUPS; i++) {
+		kbase_mem_pool_pcp_stat(&mem_pools[i], &hit, &refill, &drain);
+		seq_printf(sfile, "%5d %8zu %12llu %12llu %12llu\n", i,
+				kbase_mem_pool_pcp_size(&mem_pools[i]),
+				hit, refill, drain);
+	}
+
+	return 0;
+}
+
+static int kbase_mem_pool_debugfs_pcp_open(struct inode *in, struct file *file)
+{
+	return single_open(file, kbase_mem_pool_debugfs_pcp_show,
+		in->i_private);
+}
+
+static const struct file_operations kbase_mem_pool_debugfs_pcp_fops = {
+	.owner = THIS_MODULE,
+	.open = kbase_mem_pool_debugfs_pcp_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_context *kctx)
 {
@@ -183,6 +241,9 @@ void kbase_mem_pool_debugfs_init(struct dentry *parent,
 	debugfs_create_file("mem_pool_max_size", mode, parent,
 		&kctx->mem_pools.small, &kbase_mem_pool_debugfs_max_size_fops);
 
+	debugfs_create_file("mem_pool_pcp", 0444, parent,
+		&kctx->mem_pools.small, &kbase_mem_pool_debugfs_pcp_fops);
+
 	debugfs_create_file("lp_mem_pool_size", mode, parent,
 		&kctx->mem_pools.large, &kbase_mem_pool_debugfs_fops);
 
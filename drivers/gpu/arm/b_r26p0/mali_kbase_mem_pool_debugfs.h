@@ -30,11 +30,12 @@
  * @parent:  Parent debugfs dentry
  * @kctx:    The kbase context
  *
- * Adds four debugfs files under @parent:
+ * Adds five debugfs files under @parent:
  * - mem_pool_size: get/set the current sizes of @kctx: mem_pools
  * - mem_pool_max_size: get/set the max sizes of @kctx: mem_pools
  * - lp_mem_pool_size: get/set the current sizes of @kctx: lp_mem_pool
  * - lp_mem_pool_max_size: get/set the max sizes of @kctx:lp_mem_pool
+ * - mem_pool_pcp: per-cpu cache statistics of @kctx: mem_pools
  */
 void kbase_mem_pool_debugfs_init(struct dentry *parent,
 		struct kbase_context *kctx);
@@ -93,6 +94,29 @@ size_t kbase_mem_pool_debugfs_size(void *array, size_t index);
  */
 size_t kbase_mem_pool_debugfs_max_size(void *array, size_t index);
 
+/**
+ * kbase_mem_pool_debugfs_set_low_wm - Set the low watermark of a memory pool
+ *
+ * @array: Address of the first in an array of physical memory pools.
+ * @index: A memory group ID to be used as an index into the array of memory
+ *         pools. Valid range is 0..(MEMORY_GROUP_MANAGER_NR_GROUPS-1).
+ * @value: Number of pages below which the pool is refilled in background.
+ *         0 disables the refill.
+ */
+void kbase_mem_pool_debugfs_set_low_wm(void *array, size_t index,
+	size_t value);
+
+/**
+ * kbase_mem_pool_debugfs_low_wm - Get the low watermark of a memory pool
+ *
+ * @array: Address of the first in an array of physical memory pools.
+ * @index: A memory group ID to be used as an index into the array of memory
+ *         pools. Valid range is 0..(MEMORY_GROUP_MANAGER_NR_GROUPS-1).
+ *
+ * Return: Number of pages below which the pool is refilled in background
+ */
+size_t kbase_mem_pool_debugfs_low_wm(void *array, size_t index);
+
 /**
  * kbase_mem_pool_config_debugfs_set_max_size - Set maximum number of free pages
  *                                              in initial configuration of pool
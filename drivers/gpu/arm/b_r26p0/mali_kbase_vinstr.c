@@ -89,6 +89,10 @@ struct kbase_vinstr_context {
  * @read_idx:          Index of buffer read by userspace.
  * @write_idx:         Index of buffer being written by dump worker.
  * @waitq:             Client's notification queue.
+ * @ring:              Sample ring shared with userspace, always allocated so
+ *                     that overruns are counted for every client.
+ * @ring_mapped:       True once userspace mapped the ring. The reader then
+ *                     advances ring->read_idx instead of read_idx.
  */
 struct kbase_vinstr_client {
 	struct kbase_vinstr_context *vctx;
@@ -103,6 +107,8 @@ struct kbase_vinstr_client {
 	atomic_t read_idx;
 	atomic_t write_idx;
 	wait_queue_head_t waitq;
+	struct kbase_hwcnt_reader_ring *ring;
+	bool ring_mapped;
 };
 
 static unsigned int kbasep_vinstr_hwcnt_reader_poll(
@@ -166,6 +172,22 @@ static u64 kbasep_vinstr_next_dump_time_ns(u64 cur_ts_ns, u32 interval)
 	return (cur_ts_ns + 1) * interval;
 }
 
+/**
+ * kbasep_vinstr_client_read_idx() - Get the index of the oldest buffer not
+ *                                   yet released by the reader.
+ * @vcli: Non-NULL pointer to a vinstr client.
+ *
+ * Return: read_idx, or the read index of the ring once it is mapped.
+ */
+static unsigned int kbasep_vinstr_client_read_idx(
+	struct kbase_vinstr_client *vcli)
+{
+	if (vcli->ring_mapped)
+		return READ_ONCE(vcli->ring->read_idx);
+
+	return atomic_read(&vcli->read_idx);
+}
+
 /**
  * kbasep_vinstr_client_dump() - Perform a dump for a client.
  * @vcli:     Non-NULL pointer to a vinstr client.
@@ -190,11 +212,17 @@ static int kbasep_vinstr_client_dump(
 	lockdep_assert_held(&vcli->vctx->lock);
 
 	write_idx = atomic_read(&vcli->write_idx);
-	read_idx = atomic_read(&vcli->read_idx);
+	read_idx = kbasep_vinstr_client_read_idx(vcli);
 
-	/* Check if there is a place to copy HWC block into. */
-	if (write_idx - read_idx == vcli->dump_bufs.buf_cnt)
+	/* Check if there is a place to copy HWC block into. A read index of
+	 * the ring is written by userspace, so anything out of range is taken
+	 * as a full ring.
+	 */
+	if (write_idx - read_idx >= vcli->dump_bufs.buf_cnt) {
+		if (event_id == BASE_HWCNT_READER_EVENT_PERIODIC)
+			vcli->ring->overrun++;
 		return -EBUSY;
+	}
 	write_idx %= vcli->dump_bufs.buf_cnt;
 
 	dump_buf = &vcli->dump_bufs.bufs[write_idx];
@@ -221,10 +249,12 @@ static int kbasep_vinstr_client_dump(
 	meta->cycles.top = (clk_cnt > 0) ? dump_buf->clk_cnt_buf[0] : 0;
 	meta->cycles.shader_cores =
 	    (clk_cnt > 1) ? dump_buf->clk_cnt_buf[1] : 0;
+	vcli->ring->meta[write_idx] = *meta;
 
 	/* Notify client. Make sure all changes to memory are visible. */
 	wmb();
 	atomic_inc(&vcli->write_idx);
+	WRITE_ONCE(vcli->ring->write_idx, atomic_read(&vcli->write_idx));
 	wake_up_interruptible(&vcli->waitq);
 	return 0;
 }
@@ -369,6 +399,7 @@ static void kbasep_vinstr_client_destroy(struct kbase_vinstr_client *vcli)
 		return;
 
 	kbase_hwcnt_virtualizer_client_destroy(vcli->hvcli);
+	free_page((unsigned long)vcli->ring);
 	kfree(vcli->dump_bufs_meta);
 	kbase_hwcnt_dump_buffer_array_free(&vcli->dump_bufs);
 	kbase_hwcnt_enable_map_free(&vcli->enable_map);
@@ -430,6 +461,14 @@ static int kbasep_vinstr_client_create(
 	if (!vcli->dump_bufs_meta)
 		goto error;
 
+	BUILD_BUG_ON(sizeof(*vcli->ring) + MAX_BUFFER_COUNT *
+		sizeof(*vcli->ring->meta) > PAGE_SIZE);
+	vcli->ring = (struct kbase_hwcnt_reader_ring *)get_zeroed_page(
+		GFP_KERNEL);
+	if (!vcli->ring)
+		goto error;
+	vcli->ring->buf_cnt = setup->buffer_count;
+
 	errcode = kbase_hwcnt_virtualizer_client_create(
 		vctx->hvirt, &vcli->enable_map, &vcli->hvcli);
 	if (errcode)
@@ -625,6 +664,10 @@ static int kbasep_vinstr_hwcnt_reader_buffer_ready(
 	struct kbase_vinstr_client *cli)
 {
 	WARN_ON(!cli);
+	if (cli->ring_mapped)
+		return atomic_read(&cli->write_idx) !=
+			READ_ONCE(cli->ring->read_idx);
+
 	return atomic_read(&cli->write_idx) != atomic_read(&cli->meta_idx);
 }
 
@@ -687,6 +730,10 @@ static long kbasep_vinstr_hwcnt_reader_ioctl_get_buffer(
 	const size_t meta_size = sizeof(struct kbase_hwcnt_reader_metadata);
 	const size_t min_size = min(size, meta_size);
 
+	/* Buffers of a mapped ring are released through the ring itself */
+	if (unlikely(cli->ring_mapped))
+		return -EPERM;
+
 	/* Metadata sanity check. */
 	WARN_ON(idx != meta->buffer_idx);
 
@@ -736,7 +783,8 @@ static long kbasep_vinstr_hwcnt_reader_ioctl_put_buffer(
 	size_t i;
 
 	/* Check if any buffer was taken. */
-	if (unlikely(atomic_read(&cli->meta_idx) == read_idx))
+	if (unlikely(cli->ring_mapped ||
+		     atomic_read(&cli->meta_idx) == read_idx))
 		return -EPERM;
 
 	if (likely(max_size <= sizeof(stack_kbuf))) {
@@ -913,6 +961,7 @@ static long kbasep_vinstr_hwcnt_reader_ioctl_get_api_version(
 		if (clk_cnt > 1)
 			api_version.features |=
 			    KBASE_HWCNT_READER_API_VERSION_FEATURE_CYCLES_SHADER_CORES;
+		api_version.features |= KBASE_HWCNT_READER_API_VERSION_FEATURE_RING;
 
 		ret = put_user(api_version,
 			       (struct kbase_hwcnt_reader_api_version __user *)
@@ -984,6 +1033,10 @@ static long kbasep_vinstr_hwcnt_reader_ioctl(
 		rcode = kbasep_vinstr_hwcnt_reader_ioctl_disable_event(
 			cli, (enum base_hwcnt_reader_event)arg);
 		break;
+	case _IOC_NR(KBASE_HWCNT_READER_GET_OVERRUN):
+		rcode = put_user(READ_ONCE(cli->ring->overrun),
+			(u32 __user *)arg);
+		break;
 	default:
 		pr_warn("Unknown HWCNT ioctl 0x%x nr:%d", cmd, _IOC_NR(cmd));
 		rcode = -EINVAL;
@@ -1044,6 +1097,31 @@ static int kbasep_vinstr_hwcnt_reader_mmap(
 	vm_size = vma->vm_end - vma->vm_start;
 	size = cli->dump_bufs.buf_cnt * cli->vctx->metadata->dump_buf_bytes;
 
+	/* The sample ring follows the buffers. Mapping it switches the client
+	 * to releasing buffers through the ring.
+	 */
+	if (vma->vm_pgoff == (PAGE_ALIGN(size) >> PAGE_SHIFT)) {
+		int err;
+
+		if (vm_size != PAGE_SIZE)
+			return -EINVAL;
+
+		pfn = __pa(cli->ring) >> PAGE_SHIFT;
+		err = remap_pfn_range(
+			vma, vma->vm_start, pfn, vm_size, vma->vm_page_prot);
+		if (err)
+			return err;
+
+		mutex_lock(&cli->vctx->lock);
+		if (!cli->ring_mapped) {
+			cli->ring->read_idx = atomic_read(&cli->read_idx);
+			cli->ring_mapped = true;
+		}
+		mutex_unlock(&cli->vctx->lock);
+
+		return 0;
+	}
+
 	if (vma->vm_pgoff > (size >> PAGE_SHIFT))
 		return -EINVAL;
 
@@ -546,6 +546,7 @@ void page_fault_worker(struct work_struct *data)
 	bool grown = false;
 	int pages_to_grow;
 	bool grow_2mb_pool;
+	bool pool_grown = false;
 	struct kbase_sub_alloc *prealloc_sas[2] = { NULL, NULL };
 	int i;
 	size_t current_backed_size;
@@ -788,6 +789,11 @@ page_fault_retry:
 		u64 pfn_offset;
 		u32 op;
 
+		if (pool_grown)
+			atomic_inc(&kbdev->mem_pool_fault_grown);
+		else
+			atomic_inc(&kbdev->mem_pool_fault_served);
+
 		/* alloc success */
 		WARN_ON(kbase_reg_current_backed_size(region) >
 			region->nr_pages);
@@ -941,6 +947,7 @@ page_fault_retry:
 					"Page allocation failure", fault);
 		} else {
 			dev_dbg(kbdev->dev, "Try again after pool_grow\n");
+			pool_grown = true;
 			goto page_fault_retry;
 		}
 	}
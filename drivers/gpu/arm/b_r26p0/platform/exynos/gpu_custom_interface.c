@@ -915,6 +915,111 @@ static ssize_t set_highspeed_delay(struct device *dev, struct device_attribute *
 	return count;
 }
 
+static ssize_t show_frame_period(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	ssize_t ret = 0;
+	unsigned long flags;
+	int period_us, target_load;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	spin_lock_irqsave(&platform->gpu_dvfs_spinlock, flags);
+	period_us = platform->frame.period_us;
+	target_load = platform->frame.target_load;
+	spin_unlock_irqrestore(&platform->gpu_dvfs_spinlock, flags);
+
+	ret += snprintf(buf+ret, PAGE_SIZE-ret, "%d %d", period_us, target_load);
+
+	if (ret < PAGE_SIZE - 1) {
+		ret += snprintf(buf+ret, PAGE_SIZE-ret, "\n");
+	} else {
+		buf[PAGE_SIZE-2] = '\n';
+		buf[PAGE_SIZE-1] = '\0';
+		ret = PAGE_SIZE-1;
+	}
+
+	return ret;
+}
+
+static ssize_t set_frame_period(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+	unsigned long flags;
+	int period_us = 0, target_load = 0;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	if (sscanf(buf, "%d %d", &period_us, &target_load) < 1) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid value\n", __func__);
+		return -ENOENT;
+	}
+
+	if ((period_us <= 0) || (target_load < 0) || (target_load > 100)) {
+		GPU_LOG(DVFS_WARNING, DUMMY, 0u, 0u, "%s: invalid period or load value (%d %d)\n",
+				__func__, period_us, target_load);
+		return -ENOENT;
+	}
+
+	spin_lock_irqsave(&platform->gpu_dvfs_spinlock, flags);
+	platform->frame.period_us = period_us;
+	if (target_load)
+		platform->frame.target_load = target_load;
+	spin_unlock_irqrestore(&platform->gpu_dvfs_spinlock, flags);
+
+	return count;
+}
+
+static ssize_t show_frame_stat(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	ssize_t ret = 0;
+	unsigned long flags;
+	int frame_us;
+	unsigned int frame_count, miss_count;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	spin_lock_irqsave(&platform->gpu_dvfs_spinlock, flags);
+	frame_us = platform->frame.frame_us;
+	frame_count = platform->frame.frame_count;
+	miss_count = platform->frame.miss_count;
+	spin_unlock_irqrestore(&platform->gpu_dvfs_spinlock, flags);
+
+	ret += snprintf(buf+ret, PAGE_SIZE-ret, "frame_us %d frames %u miss %u", frame_us, frame_count, miss_count);
+
+	if (ret < PAGE_SIZE - 1) {
+		ret += snprintf(buf+ret, PAGE_SIZE-ret, "\n");
+	} else {
+		buf[PAGE_SIZE-2] = '\n';
+		buf[PAGE_SIZE-1] = '\0';
+		ret = PAGE_SIZE-1;
+	}
+
+	return ret;
+}
+
+static ssize_t set_frame_stat(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+	unsigned long flags;
+	struct exynos_context *platform = (struct exynos_context *)pkbdev->platform_context;
+
+	if (!platform)
+		return -ENODEV;
+
+	spin_lock_irqsave(&platform->gpu_dvfs_spinlock, flags);
+	platform->frame.frame_count = 0;
+	platform->frame.miss_count = 0;
+	spin_unlock_irqrestore(&platform->gpu_dvfs_spinlock, flags);
+
+	gpu_dvfs_init_time_in_state();
+
+	return count;
+}
+
 static ssize_t show_wakeup_lock(struct device *dev, struct device_attribute *attr, char *buf)
 {
 	ssize_t ret = 0;
@@ -1452,6 +1557,8 @@ DEVICE_ATTR(down_staycount, S_IRUGO|S_IWUSR, show_down_staycount, set_down_stayc
 DEVICE_ATTR(highspeed_clock, S_IRUGO|S_IWUSR, show_highspeed_clock, set_highspeed_clock);
 DEVICE_ATTR(highspeed_load, S_IRUGO|S_IWUSR, show_highspeed_load, set_highspeed_load);
 DEVICE_ATTR(highspeed_delay, S_IRUGO|S_IWUSR, show_highspeed_delay, set_highspeed_delay);
+DEVICE_ATTR(frame_period, S_IRUGO|S_IWUSR, show_frame_period, set_frame_period);
+DEVICE_ATTR(frame_stat, S_IRUGO|S_IWUSR, show_frame_stat, set_frame_stat);
 DEVICE_ATTR(wakeup_lock, S_IRUGO|S_IWUSR, show_wakeup_lock, set_wakeup_lock);
 DEVICE_ATTR(polling_speed, S_IRUGO|S_IWUSR, show_polling_speed, set_polling_speed);
 DEVICE_ATTR(tmu, S_IRUGO|S_IWUSR, show_tmu, set_tmu_control);
@@ -2067,6 +2174,16 @@ int gpu_create_sysfs_file(struct device *dev)
 		goto out;
 	}
 
+	if (device_create_file(dev, &dev_attr_frame_period)) {
+		GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "couldn't create sysfs file [frame_period]\n");
+		goto out;
+	}
+
+	if (device_create_file(dev, &dev_attr_frame_stat)) {
+		GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "couldn't create sysfs file [frame_stat]\n");
+		goto out;
+	}
+
 	if (device_create_file(dev, &dev_attr_wakeup_lock)) {
 		GPU_LOG(DVFS_ERROR, DUMMY, 0u, 0u, "couldn't create sysfs file [wakeup_lock]\n");
 		goto out;
@@ -2189,6 +2306,8 @@ void gpu_remove_sysfs_file(struct device *dev)
 	device_remove_file(dev, &dev_attr_highspeed_clock);
 	device_remove_file(dev, &dev_attr_highspeed_load);
 	device_remove_file(dev, &dev_attr_highspeed_delay);
+	device_remove_file(dev, &dev_attr_frame_period);
+	device_remove_file(dev, &dev_attr_frame_stat);
 	device_remove_file(dev, &dev_attr_wakeup_lock);
 	device_remove_file(dev, &dev_attr_polling_speed);
 	device_remove_file(dev, &dev_attr_tmu);
@@ -643,6 +643,33 @@ int gpu_dvfs_get_utilization(void)
 	return util;
 }
 
+#ifdef CONFIG_MALI_DVFS
+/*
+ * Copies and clears the busy time of each level since the previous call, in
+ * percent x ms: 100ms at 50% of load is 5000. The levels are the ones of
+ * gpu_dvfs_get_clock(). Returns the number of levels copied.
+ */
+int gpu_dvfs_get_load_residency(u64 *residency, int nr_levels)
+{
+	struct kbase_device *kbdev = pkbdev;
+	struct exynos_context *platform = (struct exynos_context *) kbdev->platform_context;
+	unsigned long flags;
+	int i;
+
+	DVFS_ASSERT(platform);
+
+	nr_levels = min3(nr_levels, platform->table_size, DVFS_TABLE_ROW_MAX);
+
+	spin_lock_irqsave(&platform->gpu_dvfs_spinlock, flags);
+	for (i = 0; i < nr_levels; i++)
+		residency[i] = platform->load_residency[i];
+	memset(platform->load_residency, 0, sizeof(platform->load_residency));
+	spin_unlock_irqrestore(&platform->gpu_dvfs_spinlock, flags);
+
+	return nr_levels;
+}
+#endif /* CONFIG_MALI_DVFS */
+
 int gpu_dvfs_get_max_freq(void)
 {
 	struct kbase_device *kbdev = pkbdev;
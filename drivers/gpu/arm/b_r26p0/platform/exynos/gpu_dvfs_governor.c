@@ -33,6 +33,7 @@ static int gpu_dvfs_governor_interactive(struct exynos_context *platform, int ut
 static int gpu_dvfs_governor_static(struct exynos_context *platform, int utilization);
 static int gpu_dvfs_governor_booster(struct exynos_context *platform, int utilization);
 static int gpu_dvfs_governor_dynamic(struct exynos_context *platform, int utilization);
+static int gpu_dvfs_governor_frame(struct exynos_context *platform, int utilization);
 
 static gpu_dvfs_governor_info governor_info[G3D_MAX_GOVERNOR_NUM] = {
 	{
@@ -65,6 +66,12 @@ static gpu_dvfs_governor_info governor_info[G3D_MAX_GOVERNOR_NUM] = {
 		gpu_dvfs_governor_dynamic,
 		NULL
 	},
+	{
+		G3D_DVFS_GOVERNOR_FRAME,
+		"Frame",
+		gpu_dvfs_governor_frame,
+		NULL
+	},
 };
 
 void gpu_dvfs_update_start_clk(int governor_type, int clk)
@@ -275,6 +282,98 @@ static int gpu_dvfs_governor_dynamic(struct exynos_context *platform, int utiliz
 	return 0;
 }
 
+/*
+ * Accumulates the time the GPU spent on atoms. Atoms running on several job
+ * slots at once overlap, so only the part after the previous busy end is
+ * counted.
+ */
+void gpu_dvfs_frame_update_busy(void *dev, void *atom, ktime_t *end_timestamp)
+{
+	struct kbase_device *kbdev = (struct kbase_device *)dev;
+	struct kbase_jd_atom *katom = (struct kbase_jd_atom *)atom;
+	struct exynos_context *platform;
+	unsigned long flags;
+	ktime_t start;
+
+	platform = (struct exynos_context *)kbdev->platform_context;
+	if (!platform || platform->governor_type != G3D_DVFS_GOVERNOR_FRAME)
+		return;
+
+	spin_lock_irqsave(&platform->frame.lock, flags);
+	start = katom->start_timestamp;
+	if (ktime_before(start, platform->frame.window_start))
+		start = platform->frame.window_start;
+	if (ktime_before(start, platform->frame.busy_end))
+		start = platform->frame.busy_end;
+	if (ktime_after(*end_timestamp, start)) {
+		platform->frame.busy_ns += ktime_to_ns(ktime_sub(*end_timestamp, start));
+		platform->frame.busy_end = *end_timestamp;
+	}
+	spin_unlock_irqrestore(&platform->frame.lock, flags);
+}
+
+/*
+ * GPU time of a frame is estimated as the busy time of the window spread
+ * over the vsync periods in it. The lowest clock which finishes that work
+ * within target_load of the period is chosen.
+ */
+static int gpu_dvfs_governor_frame(struct exynos_context *platform, int utilization)
+{
+	int max_clock_lev = gpu_dvfs_get_level(platform->gpu_max_clock);
+	int min_clock_lev = gpu_dvfs_get_level(platform->gpu_min_clock);
+	u64 window_ns, busy_ns, frame_ns, period_ns, required_clock;
+	ktime_t now = ktime_get();
+	int step;
+
+	DVFS_ASSERT(platform);
+
+	spin_lock(&platform->frame.lock);
+	window_ns = ktime_to_ns(ktime_sub(now, platform->frame.window_start));
+	busy_ns = platform->frame.busy_ns;
+	platform->frame.busy_ns = 0;
+	platform->frame.window_start = now;
+	spin_unlock(&platform->frame.lock);
+
+	period_ns = (u64)platform->frame.period_us * NSEC_PER_USEC;
+	if (!window_ns || !period_ns)
+		return 0;
+
+	frame_ns = div64_u64(min(busy_ns, window_ns) * period_ns, window_ns);
+	platform->frame.frame_us = (int)div_u64(frame_ns, NSEC_PER_USEC);
+	platform->frame.frame_count += (unsigned int)div64_u64(window_ns, period_ns);
+
+	/* the GPU was busy for the whole period at the current clock */
+	if (frame_ns >= period_ns)
+		platform->frame.miss_count++;
+
+	required_clock = div64_u64((u64)platform->cur_clock * frame_ns * 100,
+			period_ns * platform->frame.target_load);
+
+	for (step = min_clock_lev; step > max_clock_lev; step--)
+		if (platform->table[step].clock >= required_clock)
+			break;
+
+	if (platform->table[step].clock > platform->gpu_max_clock_limit)
+		step = gpu_dvfs_get_level(platform->gpu_max_clock_limit);
+
+	if (step < platform->step) {
+		platform->step = step;
+		platform->down_requirement = platform->table[platform->step].down_staycount;
+	} else if (step > platform->step) {
+		platform->down_requirement--;
+		if (platform->down_requirement <= 0) {
+			platform->step = step;
+			platform->down_requirement = platform->table[platform->step].down_staycount;
+		}
+	} else {
+		platform->down_requirement = platform->table[platform->step].down_staycount;
+	}
+
+	DVFS_ASSERT((platform->step >= max_clock_lev) && (platform->step <= min_clock_lev));
+
+	return 0;
+}
+
 static int gpu_dvfs_decide_next_governor(struct exynos_context *platform)
 {
 	return 0;
@@ -338,6 +437,13 @@ int gpu_dvfs_governor_setting(struct exynos_context *platform, int governor_type
 	platform->governor_type = governor_type;
 
 	gpu_dvfs_init_time_in_state();
+
+	spin_lock(&platform->frame.lock);
+	platform->frame.window_start = ktime_get();
+	platform->frame.busy_ns = 0;
+	platform->frame.frame_count = 0;
+	platform->frame.miss_count = 0;
+	spin_unlock(&platform->frame.lock);
 #else /* CONFIG_MALI_DVFS */
 	platform->table = (gpu_dvfs_info *)gpu_get_attrib_data(platform->attrib, GPU_GOVERNOR_TABLE_DEFAULT);
 	platform->table_size = (u32)gpu_get_attrib_data(platform->attrib, GPU_GOVERNOR_TABLE_SIZE_DEFAULT);
@@ -24,9 +24,14 @@ typedef enum {
 	G3D_DVFS_GOVERNOR_STATIC,
 	G3D_DVFS_GOVERNOR_BOOSTER,
 	G3D_DVFS_GOVERNOR_DYNAMIC,
+	G3D_DVFS_GOVERNOR_FRAME,
 	G3D_MAX_GOVERNOR_NUM,
 } gpu_governor_type;
 
+/* frame governor defaults, 60Hz panel and 10% headroom */
+#define G3D_FRAME_PERIOD_US		16667
+#define G3D_FRAME_TARGET_LOAD		90
+
 void gpu_dvfs_update_start_clk(int governor_type, int clk);
 void gpu_dvfs_update_table(int governor_type, gpu_dvfs_info *table);
 void gpu_dvfs_update_table_size(int governor_type, int size);
@@ -34,5 +39,6 @@ void *gpu_dvfs_get_governor_info(void);
 int gpu_dvfs_decide_next_freq(struct kbase_device *kbdev, int utilization);
 int gpu_dvfs_governor_setting(struct exynos_context *platform, int governor_type);
 int gpu_dvfs_governor_init(struct kbase_device *kbdev);
+void gpu_dvfs_frame_update_busy(void *dev, void *atom, ktime_t *end_timestamp);
 
 #endif /* _GPU_DVFS_GOVERNOR_H_ */
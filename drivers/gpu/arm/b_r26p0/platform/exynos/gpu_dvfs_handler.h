@@ -59,6 +59,7 @@ int gpu_dvfs_get_clock(int level);
 int gpu_dvfs_get_step(void);
 int gpu_dvfs_get_cur_clock(void);
 int gpu_dvfs_get_utilization(void);
+int gpu_dvfs_get_load_residency(u64 *residency, int nr_levels);
 int gpu_dvfs_get_max_freq(void);
 
 int gpu_dvfs_decide_max_clock(struct exynos_context *platform);
@@ -27,6 +27,7 @@
 
 #if MALI_SEC_PROBE_TEST != 1
 #include <platform/exynos/gpu_integration_defs.h>
+#include <platform/exynos/gpu_dvfs_governor.h>
 #endif
 
 #if defined(CONFIG_SCHED_EMS)
@@ -694,9 +695,11 @@ struct kbase_vendor_callbacks exynos_callbacks = {
 #ifdef CONFIG_MALI_DVFS
 	.pm_metrics_init = gpu_pm_metrics_init,
 	.pm_metrics_term = gpu_pm_metrics_term,
+	.dvfs_update_busy = gpu_dvfs_frame_update_busy,
 #else
 	.pm_metrics_init = NULL,
 	.pm_metrics_term = NULL,
+	.dvfs_update_busy = NULL,
 #endif
 	.debug_pagetable_info = gpu_debug_pagetable_info,
 	.mem_profile_check_kctx = gpu_mem_profile_check_kctx,
@@ -50,6 +50,7 @@ struct kbase_vendor_callbacks {
 	void (*pm_metrics_term)(void *dev);
 	void (*cl_boost_init)(void *dev);
 	void (*cl_boost_update_utilization)(void *dev, void *atom, u64 microseconds_spent);
+	void (*dvfs_update_busy)(void *dev, void *atom, ktime_t *end_timestamp);
 	int (*get_core_mask)(void *dev);
 	int (*init_hw)(void *dev);
 	void (*debug_pagetable_info)(void *ctx, u64 vaddr);
@@ -49,6 +49,9 @@ static void gpu_dvfs_update_utilization(struct kbase_device *kbdev)
 	spin_lock_irqsave(&platform->gpu_dvfs_spinlock, flags);
 
 	platform->env_data.utilization = gpu_pm_get_dvfs_utilisation(kbdev, 0, 0);
+	if (platform->step >= 0 && platform->step < DVFS_TABLE_ROW_MAX)
+		platform->load_residency[platform->step] +=
+			(u64)platform->env_data.utilization * platform->polling_speed;
 
 	spin_unlock_irqrestore(&platform->gpu_dvfs_spinlock, flags);
 
@@ -258,10 +258,20 @@ static int gpu_dvfs_update_config_data_from_dt(struct kbase_device *kbdev)
 		platform->governor_type = G3D_DVFS_GOVERNOR_BOOSTER;
 	} else if (!strncmp("dynamic", of_string, strlen("dynamic"))) {
 		platform->governor_type = G3D_DVFS_GOVERNOR_DYNAMIC;
+	} else if (!strncmp("frame", of_string, strlen("frame"))) {
+		platform->governor_type = G3D_DVFS_GOVERNOR_FRAME;
 	} else {
 		platform->governor_type = G3D_DVFS_GOVERNOR_DEFAULT;
 	}
 
+	/* frame governor can be selected at runtime, so its data is always parsed */
+	gpu_update_config_data_int(np, "frame_period_us", &platform->frame.period_us);
+	gpu_update_config_data_int(np, "frame_target_load", &platform->frame.target_load);
+	if (platform->frame.period_us == 0)
+		platform->frame.period_us = G3D_FRAME_PERIOD_US;
+	if (platform->frame.target_load == 0)
+		platform->frame.target_load = G3D_FRAME_TARGET_LOAD;
+
 #ifdef CONFIG_CAL_IF
 	platform->gpu_dvfs_start_clock = cal_dfs_get_boot_freq(platform->g3d_cmu_cal_id);
 	GPU_LOG(DVFS_INFO, DUMMY, 0u, 0u, "get g3d start clock from ect : %d\n", platform->gpu_dvfs_start_clock);
@@ -447,6 +457,9 @@ static int gpu_context_init(struct kbase_device *kbdev)
 	mutex_init(&platform->gpu_clock_lock);
 	mutex_init(&platform->gpu_dvfs_handler_lock);
 	spin_lock_init(&platform->gpu_dvfs_spinlock);
+#ifdef CONFIG_MALI_DVFS
+	spin_lock_init(&platform->frame.lock);
+#endif
 
 #if (defined(CONFIG_SCHED_EMS) || defined(CONFIG_SCHED_EHMP) || defined(CONFIG_SCHED_HMP))
 	mutex_init(&platform->gpu_sched_hmp_lock);
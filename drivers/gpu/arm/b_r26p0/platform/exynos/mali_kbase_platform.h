@@ -210,6 +210,22 @@ struct exynos_context {
 		int highspeed_delay;
 		int delay_count;
 	} interactive;
+
+	/* For the frame governor */
+	struct {
+		spinlock_t lock;
+		int period_us;
+		int target_load;
+		ktime_t window_start;
+		ktime_t busy_end;
+		u64 busy_ns;
+		int frame_us;
+		unsigned int frame_count;
+		unsigned int miss_count;
+	} frame;
+
+	/* Busy time per level for the thermal power model, percent x ms */
+	u64 load_residency[DVFS_TABLE_ROW_MAX];
 #ifdef CONFIG_CPU_THERMAL_IPA
 	int norm_utilisation;
 	int freq_for_normalisation;
@@ -20,6 +20,7 @@
 #include <media/exynos_repeater.h>
 #include <linux/pm_qos.h>
 #include <soc/samsung/exynos-itmon.h>
+#include <soc/samsung/exynos-stat.h>
 
 struct g2d_task; /* defined in g2d_task.h */
 
@@ -78,6 +79,22 @@ struct g2d_dvfs_table {
 /* Separate bitfield to select YCbCr Bitdepth at REG_COLORMODE[29:28] */
 #define G2D_DEVICE_CAPS_YUV_BITDEPTH		2
 
+/*
+ * Time of the tasks from the user request to the H/W push (queue) and from
+ * the push, or the completion of the previous task, to the completion
+ * (exec) with the time estimated by the cycle model (est), protected by
+ * g2d_device.lock_task.
+ */
+struct g2d_task_stats {
+	u64	tasks;
+	u64	chained;
+	u64	queue_us;
+	u64	exec_us;
+	u64	est_us;
+	u32	max_queue_us;
+	u32	max_exec_us;
+};
+
 struct g2d_device {
 	unsigned long		state;
 	unsigned long		caps;
@@ -102,6 +119,10 @@ struct g2d_device {
 	struct list_head	tasks_prepared;
 	struct list_head	tasks_active;
 	struct workqueue_struct	*schedule_workq;
+	struct workqueue_struct	*complete_workq;
+	struct g2d_task_stats	task_stats;
+	struct exynos_stat	*stat;
+	ktime_t			ktime_last_done;
 
 	struct notifier_block	pm_notifier;
 	wait_queue_head_t	freeze_wait;
@@ -112,6 +133,7 @@ struct g2d_device {
 	struct dentry *debug_logs;
 	struct dentry *debug_contexts;
 	struct dentry *debug_tasks;
+	struct dentry *debug_task_stats;
 
 	atomic_t	prior_stats[G2D_PRIORITY_END];
 
@@ -122,6 +144,9 @@ struct g2d_device {
 
 	struct g2d_dvfs_table *dvfs_table;
 	u32 dvfs_table_cnt;
+	/* measured over estimated time, in G2D_PERF_CALIB_UNIT */
+	u32 perf_calib;
+	u32 perf_clk_khz;
 
 	struct notifier_block	itmon_nb;
 };
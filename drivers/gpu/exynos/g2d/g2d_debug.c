@@ -25,6 +25,7 @@
 #include "g2d_uapi.h"
 #include "g2d_debug.h"
 #include "g2d_regs.h"
+#include "g2d_perf.h"
 
 static unsigned int g2d_debug;
 
@@ -215,10 +216,31 @@ static const struct file_operations g2d_debug_tasks_fops = {
 	.release = single_release,
 };
 
+static int g2d_debug_task_stats_show(struct seq_file *s, void *unused)
+{
+	g2d_perf_show_task_stats(s, s->private);
+
+	return 0;
+}
+
+static int g2d_debug_task_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, g2d_debug_task_stats_show, inode->i_private);
+}
+
+static const struct file_operations g2d_debug_task_stats_fops = {
+	.open = g2d_debug_task_stats_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 void g2d_init_debug(struct g2d_device *g2d_dev)
 {
 	atomic_set(&g2d_stamp_id, -1);
 
+	g2d_perf_init_stat(g2d_dev);
+
 	g2d_dev->debug_root = debugfs_create_dir("g2d", NULL);
 	if (!g2d_dev->debug_root) {
 		perrdev(g2d_dev, "debugfs: failed to create root directory");
@@ -254,6 +276,14 @@ void g2d_init_debug(struct g2d_device *g2d_dev)
 		perrdev(g2d_dev, "debugfs: failed to create tasks file");
 		return;
 	}
+
+	g2d_dev->debug_task_stats = debugfs_create_file("task_stats",
+					0400, g2d_dev->debug_root, g2d_dev,
+					&g2d_debug_task_stats_fops);
+	if (!g2d_dev->debug_task_stats) {
+		perrdev(g2d_dev, "debugfs: failed to create task_stats file");
+		return;
+	}
 }
 
 void g2d_destroy_debug(struct g2d_device *g2d_dev)
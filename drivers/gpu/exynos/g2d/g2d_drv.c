@@ -148,6 +148,7 @@ int g2d_device_run(struct g2d_device *g2d_dev, struct g2d_task *task)
 	/* record the time between user request and H/W push */
 	g2d_stamp_task(task, G2D_STAMP_STATE_PUSH,
 		(int)ktime_us_delta(task->ktime_end, task->ktime_begin));
+	g2d_perf_account_queue(g2d_dev, task);
 
 	task->ktime_begin = ktime_get();
 
@@ -932,6 +933,8 @@ static int g2d_probe(struct platform_device *pdev)
 	if (ret < 0)
 		return ret;
 
+	g2d_dev->perf_calib = G2D_PERF_CALIB_UNIT;
+
 	of_id = of_match_node(of_g2d_match, pdev->dev.of_node);
 	if (of_id->data) {
 		const struct g2d_device_data *devdata = of_id->data;
@@ -1050,6 +1053,9 @@ static int g2d_remove(struct platform_device *pdev)
 
 	g2d_shutdown(pdev);
 
+	/* no task is accounted anymore */
+	g2d_perf_destroy_stat(g2d_dev);
+
 	g2d_destroy_tasks(g2d_dev);
 
 	misc_deregister(&g2d_dev->misc[0]);
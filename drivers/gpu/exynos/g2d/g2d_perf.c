@@ -19,8 +19,11 @@
 #include "g2d_perf.h"
 #include "g2d_task.h"
 #include "g2d_uapi.h"
+#include "g2d_format.h"
 #include <soc/samsung/bts.h>
 
+#include <linux/math64.h>
+#include <linux/seq_file.h>
 #include <linux/workqueue.h>
 
 #ifdef CONFIG_PM_DEVFREQ
@@ -67,10 +70,9 @@ static bool g2d_still_need_perf(struct g2d_device *g2d_dev)
  */
 static u32 perf_basis[PPC_SC] = {1024, 1023, 256, 113, 64, 0};
 
-static char perf_index_sc(struct g2d_performance_layer_data *layer)
+static char __perf_index_sc(u32 crop, u32 window)
 {
-	u32 ratio = (((u64)layer->window_w * layer->window_h) << 10) /
-			((u32)layer->crop_w * layer->crop_h);
+	u32 ratio = ((u64)window << 10) / crop;
 	int i;
 
 	for (i = 0; i < PPC_SC; i++) {
@@ -81,16 +83,62 @@ static char perf_index_sc(struct g2d_performance_layer_data *layer)
 	return PPC_SC_DOWN_16;
 }
 
+static char perf_index_sc(struct g2d_performance_layer_data *layer)
+{
+	return __perf_index_sc((u32)layer->crop_w * layer->crop_h,
+			       (u32)layer->window_w * layer->window_h);
+}
+
+/*
+ * Bytes read for 8 pixels of a source by the format index of hw_ppc:
+ * 32bpp RGB, YCbCr420 2 plane of 8 bit and of 8+2 bit.
+ */
+static const u32 perf_read_bytes8[PPC_FMT] = {32, 12, 15};
+
+/*
+ * Read bandwidth of a layer in bytes. AFBC is counted as the half of the
+ * plain read and rotation as a quarter more, for the reads across the
+ * lines of the tiles.
+ */
+static u32 g2d_perf_layer_read(u32 crop, int fmt, bool rot, bool afbc)
+{
+	u32 bytes = (u32)(((u64)crop * perf_read_bytes8[fmt]) >> 3);
+
+	if (afbc)
+		bytes >>= 1;
+	if (rot)
+		bytes += bytes >> 2;
+
+	return bytes;
+}
+
+/* Cost of a layer in 1000 cycles because hw_ppc is pixels per 1000 cycles */
+static u32 g2d_perf_layer_cycles(struct g2d_device *g2d_dev,
+				 u32 crop, u32 window, int fmt, int rot)
+{
+	u32 (*ppc)[PPC_ROT][PPC_SC] = (u32 (*)[PPC_ROT][PPC_SC])g2d_dev->hw_ppc;
+
+	if (!crop)
+		return window / g2d_dev->hw_ppc[PPC_COLORFILL];
+
+	return max(crop, window) / ppc[fmt][rot][__perf_index_sc(crop, window)];
+}
+
+static u32 g2d_perf_calibrate(struct g2d_device *g2d_dev, u32 cycle)
+{
+	return (u32)(((u64)cycle * READ_ONCE(g2d_dev->perf_calib)) /
+		     G2D_PERF_CALIB_UNIT);
+}
+
 static void g2d_set_device_frequency(struct g2d_context *g2d_ctx,
 					  struct g2d_performance_data *data)
 {
 	struct g2d_device *g2d_dev = g2d_ctx->g2d_dev;
 	struct g2d_performance_frame_data *frame;
 	struct g2d_performance_layer_data *layer;
-	u32 (*ppc)[PPC_ROT][PPC_SC] = (u32 (*)[PPC_ROT][PPC_SC])g2d_dev->hw_ppc;
 	unsigned int cycle, ip_clock, crop, window;
 	int i, j;
-	int sc, fmt, rot;
+	int fmt, rot;
 
 	cycle = 0;
 
@@ -112,12 +160,12 @@ static void g2d_set_device_frequency(struct g2d_context *g2d_ctx,
 			window = (u32)layer->window_w * layer->window_h;
 
 			fmt = perf_index_fmt(layer);
-			sc = perf_index_sc(layer);
 
 			if (fmt == PPC_FMT)
 				return;
 
-			cycle += max(crop, window) / ppc[fmt][rot][sc];
+			cycle += g2d_perf_layer_cycles(g2d_dev, crop, window,
+						       fmt, rot);
 
 			/*
 			 * If frame has colorfill layer on the bottom,
@@ -137,6 +185,8 @@ static void g2d_set_device_frequency(struct g2d_context *g2d_ctx,
 		}
 	}
 
+	cycle = g2d_perf_calibrate(g2d_dev, cycle);
+
 	/* ip_clock(Mhz) = cycles / time_in_ms * 1000 * 10% */
 	ip_clock = (cycle / 7) * 1100;
 
@@ -155,6 +205,37 @@ static void g2d_set_device_frequency(struct g2d_context *g2d_ctx,
 		g2d_pm_qos_update_devfreq(&g2d_ctx->req, ip_clock);
 }
 
+/*
+ * Bandwidth in KB/s of a frame from its layers, for the users that do not
+ * tell theirs or underestimate it. The target is written in 32bpp or in
+ * YCbCr420 2 plane.
+ */
+static void g2d_perf_frame_bandwidth(struct g2d_performance_frame_data *frame,
+				     u32 *rbw, u32 *wbw)
+{
+	struct g2d_performance_layer_data *layer;
+	u64 read = 0, write;
+	int j, fmt;
+
+	for (j = 0; j < frame->num_layers; j++) {
+		layer = &frame->layer[j];
+
+		fmt = perf_index_fmt(layer);
+		if (fmt == PPC_FMT)
+			return;
+
+		read += g2d_perf_layer_read((u32)layer->crop_w * layer->crop_h,
+				fmt, perf_index_rotate(layer),
+				is_perf_layer_afbc(layer));
+	}
+
+	write = (u64)frame->target_pixelcount *
+		((frame->frame_attr & G2D_PERF_FRAME_YUV2P) ? 12 : 32) >> 3;
+
+	*rbw = max_t(u32, *rbw, div_u64(read * frame->frame_rate, 1000));
+	*wbw = max_t(u32, *wbw, div_u64(write * frame->frame_rate, 1000));
+}
+
 static void g2d_set_qos_frequency(struct g2d_context *g2d_ctx,
 					  struct g2d_performance_data *data)
 {
@@ -170,10 +251,16 @@ static void g2d_set_qos_frequency(struct g2d_context *g2d_ctx,
 	wbw = 0;
 
 	for (i = 0; i < data->num_frame; i++) {
+		u32 frame_rbw, frame_wbw;
+
 		frame = &data->frame[i];
 
-		rbw += frame->bandwidth_read;
-		wbw += frame->bandwidth_write;
+		frame_rbw = frame->bandwidth_read;
+		frame_wbw = frame->bandwidth_write;
+		g2d_perf_frame_bandwidth(frame, &frame_rbw, &frame_wbw);
+
+		rbw += frame_rbw;
+		wbw += frame_wbw;
 	}
 
 	if (list_empty(&g2d_ctx->qos_node) && !rbw && !wbw)
@@ -274,3 +361,155 @@ void g2d_put_performance(struct g2d_context *ctx, bool release)
 
 	g2d_set_performance(ctx, &data, release);
 }
+
+void g2d_perf_update_clock(struct g2d_device *g2d_dev)
+{
+	WRITE_ONCE(g2d_dev->perf_clk_khz,
+		   (u32)(clk_get_rate(g2d_dev->clock) / 1000));
+}
+
+static int g2d_perf_task_fmt(struct g2d_device *g2d_dev, u32 mode)
+{
+	if (!IS_YUV(mode))
+		return PPC_RGB;
+
+	if (IS_YUV_82(mode, g2d_dev->caps & G2D_DEVICE_CAPS_YUV_BITDEPTH))
+		return PPC_YUV2P_82;
+
+	return PPC_YUV2P;
+}
+
+/*
+ * Calibration of the cycle model by the measured time of the tasks long
+ * enough not to be dominated by the overhead of the H/W job, as a moving
+ * average of 1/8.
+ */
+#define G2D_PERF_CALIB_MIN_US	100
+
+static bool perf_calibration = true;
+module_param(perf_calibration, bool, 0644);
+
+/* The below functions should be called with g2d_device.lock_task held */
+void g2d_perf_estimate_task(struct g2d_device *g2d_dev, struct g2d_task *task)
+{
+	struct g2d_reg *cmd;
+	u32 kcycles = 0, crop, window, clk_khz;
+	int i, rot;
+
+	for (i = 0; i < task->num_source; i++) {
+		cmd = task->source[i].commands;
+
+		crop = (cmd[G2DSFR_IMG_RIGHT].value - cmd[G2DSFR_IMG_LEFT].value) *
+		       (cmd[G2DSFR_IMG_BOTTOM].value - cmd[G2DSFR_IMG_TOP].value);
+		window = (cmd[G2DSFR_SRC_DSTRIGHT].value -
+			  cmd[G2DSFR_SRC_DSTLEFT].value) *
+			 (cmd[G2DSFR_SRC_DSTBOTTOM].value -
+			  cmd[G2DSFR_SRC_DSTTOP].value);
+		rot = (cmd[G2DSFR_SRC_ROTATE].value & 1) ?
+				PPC_ROTATE : PPC_NO_ROTATE;
+
+		kcycles += g2d_perf_layer_cycles(g2d_dev, crop, window,
+				g2d_perf_task_fmt(g2d_dev,
+					cmd[G2DSFR_IMG_COLORMODE].value), rot);
+	}
+
+	clk_khz = READ_ONCE(g2d_dev->perf_clk_khz);
+
+	/* 1000 cycles at clk_khz take 1000000 / clk_khz us */
+	task->perf_est_us = clk_khz ?
+		(u32)div_u64((u64)kcycles * USEC_PER_SEC, clk_khz) : 0;
+}
+
+void g2d_perf_account_queue(struct g2d_device *g2d_dev, struct g2d_task *task)
+{
+	struct g2d_task_stats *stats = &g2d_dev->task_stats;
+	u32 us = (u32)ktime_us_delta(task->ktime_end, task->ktime_begin);
+
+	stats->tasks++;
+	stats->queue_us += us;
+	stats->max_queue_us = max(stats->max_queue_us, us);
+
+	exynos_stat_inc(g2d_dev->stat, G2D_STAT_TASKS);
+	exynos_stat_hist(g2d_dev->stat, G2D_STAT_QUEUE_US, us);
+}
+
+void g2d_perf_account_exec(struct g2d_device *g2d_dev, struct g2d_task *task,
+			   bool success)
+{
+	struct g2d_task_stats *stats = &g2d_dev->task_stats;
+	ktime_t start = task->ktime_begin;
+	u32 us, ratio;
+
+	/* the H/W starts a queued task when the previous one is done */
+	if (ktime_after(g2d_dev->ktime_last_done, start))
+		start = g2d_dev->ktime_last_done;
+	g2d_dev->ktime_last_done = task->ktime_end;
+
+	us = (u32)ktime_us_delta(task->ktime_end, start);
+
+	stats->exec_us += us;
+	stats->est_us += task->perf_est_us;
+	stats->max_exec_us = max(stats->max_exec_us, us);
+
+	exynos_stat_hist(g2d_dev->stat, G2D_STAT_EXEC_US, us);
+	if (!success)
+		exynos_stat_inc(g2d_dev->stat, G2D_STAT_FAILED);
+
+	if (!perf_calibration || !success ||
+	    task->perf_est_us < G2D_PERF_CALIB_MIN_US)
+		return;
+
+	ratio = clamp_t(u32, (u64)us * G2D_PERF_CALIB_UNIT / task->perf_est_us,
+			G2D_PERF_CALIB_UNIT / 4, G2D_PERF_CALIB_UNIT * 4);
+
+	WRITE_ONCE(g2d_dev->perf_calib,
+		   g2d_dev->perf_calib - g2d_dev->perf_calib / 8 + ratio / 8);
+}
+
+void g2d_perf_show_task_stats(struct seq_file *s, struct g2d_device *g2d_dev)
+{
+	struct g2d_task_stats stats;
+	unsigned long flags;
+	u64 tasks;
+
+	spin_lock_irqsave(&g2d_dev->lock_task, flags);
+	stats = g2d_dev->task_stats;
+	spin_unlock_irqrestore(&g2d_dev->lock_task, flags);
+
+	tasks = stats.tasks ? stats.tasks : 1;
+
+	seq_printf(s, "tasks %llu chained %llu\n", stats.tasks, stats.chained);
+	seq_printf(s, "queue avg %llu us max %u us\n",
+		   div64_u64(stats.queue_us, tasks), stats.max_queue_us);
+	seq_printf(s, "exec  avg %llu us max %u us\n",
+		   div64_u64(stats.exec_us, tasks), stats.max_exec_us);
+	seq_printf(s, "est   avg %llu us clock %u KHz calib %u/%u\n",
+		   div64_u64(stats.est_us, tasks),
+		   READ_ONCE(g2d_dev->perf_clk_khz),
+		   READ_ONCE(g2d_dev->perf_calib), G2D_PERF_CALIB_UNIT);
+}
+
+static const char * const g2d_stat_counters[G2D_STAT_COUNTERS] = {
+	[G2D_STAT_TASKS]	= "tasks",
+	[G2D_STAT_CHAINED]	= "chained",
+	[G2D_STAT_FAILED]	= "failed",
+};
+
+static const char * const g2d_stat_hists[G2D_STAT_HISTS] = {
+	[G2D_STAT_QUEUE_US]	= "queue_us",
+	[G2D_STAT_EXEC_US]	= "exec_us",
+};
+
+/* task_stats stays for the g2d/task_stats file, stat is for the tools */
+void g2d_perf_init_stat(struct g2d_device *g2d_dev)
+{
+	g2d_dev->stat = exynos_stat_create("g2d",
+			g2d_stat_counters, G2D_STAT_COUNTERS,
+			g2d_stat_hists, G2D_STAT_HISTS);
+}
+
+void g2d_perf_destroy_stat(struct g2d_device *g2d_dev)
+{
+	exynos_stat_destroy(g2d_dev->stat);
+	g2d_dev->stat = NULL;
+}
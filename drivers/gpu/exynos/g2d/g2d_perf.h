@@ -17,19 +17,50 @@
 #define _G2D_PERF_H_
 
 struct g2d_context;
+struct g2d_device;
 struct g2d_performance_data;
+struct g2d_task;
+struct seq_file;
 
 #define perf_index_fmt(layer) \
 		((((layer)->layer_attr) & G2D_PERF_LAYER_FMTMASK) >> 4)
 #define perf_index_rotate(layer) \
 		(((layer)->layer_attr) & G2D_PERF_LAYER_ROTATE)
+#define is_perf_layer_afbc(layer) \
+		(((layer)->layer_attr) & G2D_PERF_LAYER_AFBC)
 #define is_perf_frame_colorfill(frame) \
 		(((frame)->frame_attr) & G2D_PERF_FRAME_SOLIDCOLORFILL)
 
 #define BTS_PEAK_FPS_RATIO 1667
 
+/* counters and histograms of g2d_device.stat, in exynos-stat/g2d */
+enum g2d_stat_counter {
+	G2D_STAT_TASKS,
+	G2D_STAT_CHAINED,
+	G2D_STAT_FAILED,
+	G2D_STAT_COUNTERS,
+};
+
+enum g2d_stat_hist {
+	G2D_STAT_QUEUE_US,
+	G2D_STAT_EXEC_US,
+	G2D_STAT_HISTS,
+};
+
+/* g2d_device.perf_calib of the cycle model as is */
+#define G2D_PERF_CALIB_UNIT	1024
+
 void g2d_set_performance(struct g2d_context *ctx,
 			struct g2d_performance_data *data, bool release);
 void g2d_put_performance(struct g2d_context *ctx, bool release);
 
+void g2d_perf_update_clock(struct g2d_device *g2d_dev);
+void g2d_perf_estimate_task(struct g2d_device *g2d_dev, struct g2d_task *task);
+void g2d_perf_account_queue(struct g2d_device *g2d_dev, struct g2d_task *task);
+void g2d_perf_account_exec(struct g2d_device *g2d_dev, struct g2d_task *task,
+			   bool success);
+void g2d_perf_show_task_stats(struct seq_file *s, struct g2d_device *g2d_dev);
+void g2d_perf_init_stat(struct g2d_device *g2d_dev);
+void g2d_perf_destroy_stat(struct g2d_device *g2d_dev);
+
 #endif /* _G2D_PERF_H_ */
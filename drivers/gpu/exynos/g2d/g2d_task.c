@@ -26,6 +26,7 @@
 #include "g2d_fence.h"
 #include "g2d_debug.h"
 #include "g2d_secure.h"
+#include "g2d_perf.h"
 
 static void g2d_secure_enable(void)
 {
@@ -77,7 +78,10 @@ struct g2d_task *g2d_get_active_task_from_id(struct g2d_device *g2d_dev,
 	return NULL;
 }
 
-/* TODO: consider separate workqueue to eliminate delay by scheduling work */
+/*
+ * Completion runs on its own workqueue so that releasing the buffers of a
+ * finished task does not delay scheduling the tasks waiting for its fence.
+ */
 static void g2d_task_completion_work(struct work_struct *work)
 {
 	struct g2d_task *task = container_of(work, struct g2d_task, work);
@@ -99,7 +103,7 @@ static void __g2d_finish_task(struct g2d_task *task, bool success)
 		bool failed;
 
 		INIT_WORK(&task->work, g2d_task_completion_work);
-		failed = !queue_work(task->g2d_dev->schedule_workq,
+		failed = !queue_work(task->g2d_dev->complete_workq,
 					&task->work);
 		BUG_ON(failed);
 	}
@@ -116,6 +120,7 @@ static void g2d_finish_task(struct g2d_device *g2d_dev,
 
 	g2d_stamp_task(task, G2D_STAMP_STATE_DONE,
 		(int)ktime_us_delta(task->ktime_end, task->ktime_begin));
+	g2d_perf_account_exec(g2d_dev, task, success);
 
 	g2d_secure_disable();
 
@@ -172,6 +177,8 @@ static void g2d_execute_task(struct g2d_device *g2d_dev, struct g2d_task *task)
 		jiffies + msecs_to_jiffies(G2D_HW_TIMEOUT_MSEC);
 	add_timer(&task->hw_timer);
 
+	g2d_perf_estimate_task(g2d_dev, task);
+
 	/*
 	 * g2d_device_run() is not reentrant while g2d_schedule() is
 	 * reentrant g2d_device_run() should be protected with
@@ -245,6 +252,8 @@ static void g2d_schedule_task(struct g2d_task *task)
 		goto err_clk;
 	}
 
+	g2d_perf_update_clock(g2d_dev);
+
 	spin_lock_irqsave(&g2d_dev->lock_task, flags);
 
 	list_add_tail(&task->node, &g2d_dev->tasks_prepared);
@@ -262,18 +271,74 @@ err_fence:
 	__g2d_finish_task(task, false);
 }
 
-/* TODO: consider separate workqueue to eliminate delay by completion work */
 static void g2d_task_schedule_work(struct work_struct *work)
 {
 	g2d_schedule_task(container_of(work, struct g2d_task, work));
 }
 
+static bool chain_tasks = true;
+module_param(chain_tasks, bool, 0644);
+
+/*
+ * Pushes a task whose fences are signaled right behind the tasks running on
+ * the H/W, from the fence callback, instead of waking up the scheduler. The
+ * H/W executes the pushed jobs back to back. Power and clock are already
+ * held by the active tasks, so it is only done while there is one.
+ */
+static bool g2d_chain_task(struct g2d_task *task)
+{
+	struct g2d_device *g2d_dev = task->g2d_dev;
+	unsigned long flags;
+
+	if (!chain_tasks || IS_HWFC(task->flags))
+		return false;
+
+	if (g2d_task_has_error_fence(task))
+		return false;
+
+	spin_lock_irqsave(&g2d_dev->lock_task, flags);
+
+	if (list_empty(&g2d_dev->tasks_active) ||
+	    test_bit(G2D_DEVICE_STATE_SUSPEND, &g2d_dev->state))
+		goto err;
+
+	pm_runtime_get_noresume(g2d_dev->dev);
+
+	if (clk_enable(g2d_dev->clock) < 0) {
+		pm_runtime_put_noidle(g2d_dev->dev);
+		goto err;
+	}
+
+	del_timer(&task->fence_timer);
+
+	g2d_complete_commands(task);
+
+	list_add_tail(&task->node, &g2d_dev->tasks_prepared);
+	change_task_state_prepared(task);
+
+	g2d_dev->task_stats.chained++;
+	exynos_stat_inc(g2d_dev->stat, G2D_STAT_CHAINED);
+
+	g2d_execute_task(g2d_dev, task);
+
+	spin_unlock_irqrestore(&g2d_dev->lock_task, flags);
+
+	return true;
+err:
+	spin_unlock_irqrestore(&g2d_dev->lock_task, flags);
+
+	return false;
+}
+
 void g2d_queuework_task(struct kref *kref)
 {
 	struct g2d_task *task = container_of(kref, struct g2d_task, starter);
 	struct g2d_device *g2d_dev = task->g2d_dev;
 	bool failed;
 
+	if (g2d_chain_task(task))
+		return;
+
 	failed = !queue_work(g2d_dev->schedule_workq, &task->work);
 
 	BUG_ON(failed);
@@ -448,6 +513,7 @@ void g2d_destroy_tasks(struct g2d_device *g2d_dev)
 
 	spin_unlock_irqrestore(&g2d_dev->lock_task, flags);
 
+	destroy_workqueue(g2d_dev->complete_workq);
 	destroy_workqueue(g2d_dev->schedule_workq);
 }
 
@@ -516,6 +582,12 @@ int g2d_create_tasks(struct g2d_device *g2d_dev)
 	if (!g2d_dev->schedule_workq)
 		return -ENOMEM;
 
+	g2d_dev->complete_workq = create_singlethread_workqueue("g2dcompletion");
+	if (!g2d_dev->complete_workq) {
+		destroy_workqueue(g2d_dev->schedule_workq);
+		return -ENOMEM;
+	}
+
 	for (i = 0; i < G2D_MAX_JOBS; i++) {
 		task = g2d_create_task(g2d_dev, i);
 
@@ -114,6 +114,8 @@ struct g2d_task {
 
 	ktime_t			ktime_begin;
 	ktime_t			ktime_end;
+	/* time to process estimated by g2d_perf_estimate_task() */
+	u32			perf_est_us;
 
 	struct work_struct	work;
 	struct completion	completion;
@@ -212,6 +212,7 @@ struct g2d_task_data {
 /* flags of g2d_performance_layer_data.layer_attr */
 #define G2D_PERF_LAYER_ROTATE		(1 << 0)
 #define G2D_PERF_LAYER_SCALING		(1 << 1)
+#define G2D_PERF_LAYER_AFBC		(1 << 2)
 #define G2D_PERF_LAYER_YUV2P		(1 << 4)
 #define G2D_PERF_LAYER_YUV2P_82		(1 << 5)
 #define G2D_PERF_LAYER_FMTMASK		(3 << 4)
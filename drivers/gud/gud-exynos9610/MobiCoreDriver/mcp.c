@@ -15,6 +15,9 @@
 #include <linux/err.h>
 #include <linux/slab.h>
 #include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
 #include <linux/device.h>
 #include <linux/sched.h>
 #include <linux/kthread.h>
@@ -52,6 +55,23 @@
 #define MCP_TIMEOUT		10
 #define MCP_RETRIES		5
 #define MCP_NF_QUEUE_SZ		8
+/* Round-trip histograms, in log2 of micro-seconds */
+#define MCP_RTT_BUCKETS		16
+
+/* Histogram rows: one per MCP command, and one for TA notifications */
+enum mcp_rtt_id {
+	MCP_RTT_OPEN_SESSION,
+	MCP_RTT_CLOSE_SESSION,
+	MCP_RTT_MAP,
+	MCP_RTT_UNMAP,
+	MCP_RTT_GET_VERSION,
+	MCP_RTT_CLOSE_MCP,
+	MCP_RTT_LOAD_TOKEN,
+	MCP_RTT_CHECK_LOAD_TA,
+	MCP_RTT_OTHER,
+	MCP_RTT_SESSION,
+	MCP_RTT_MAX,
+};
 
 static struct {
 	union mcp_message	*buffer;	/* MCP communication buffer */
@@ -88,6 +108,14 @@ static struct {
 		enum mcp_result		result;	/* Command result */
 	}				last_cmds[LAST_CMDS_SIZE];
 	int				last_cmds_index;
+	/* Round-trip times, from notification to answer */
+	spinlock_t		rtt_lock;	/* Histograms protection */
+	struct mcp_rtt {
+		u64			count;
+		u64			total_ns;
+		u64			max_ns;
+		u64			buckets[MCP_RTT_BUCKETS];
+	}			rtt[MCP_RTT_MAX];
 } l_ctx;
 
 static const char *cmd_to_string(enum cmd_id id)
@@ -119,6 +147,76 @@ static const char *cmd_to_string(enum cmd_id id)
 	return "unknown";
 }
 
+static enum mcp_rtt_id cmd_to_rtt_id(enum cmd_id id)
+{
+	switch (id) {
+	case MC_MCP_CMD_OPEN_SESSION:
+		return MCP_RTT_OPEN_SESSION;
+	case MC_MCP_CMD_CLOSE_SESSION:
+		return MCP_RTT_CLOSE_SESSION;
+	case MC_MCP_CMD_MAP:
+		return MCP_RTT_MAP;
+	case MC_MCP_CMD_UNMAP:
+		return MCP_RTT_UNMAP;
+	case MC_MCP_CMD_GET_MOBICORE_VERSION:
+		return MCP_RTT_GET_VERSION;
+	case MC_MCP_CMD_CLOSE_MCP:
+		return MCP_RTT_CLOSE_MCP;
+	case MC_MCP_CMD_LOAD_TOKEN:
+		return MCP_RTT_LOAD_TOKEN;
+	case MC_MCP_CMD_CHECK_LOAD_TA:
+		return MCP_RTT_CHECK_LOAD_TA;
+	default:
+		return MCP_RTT_OTHER;
+	}
+}
+
+static const char *rtt_id_to_string(enum mcp_rtt_id id)
+{
+	switch (id) {
+	case MCP_RTT_OPEN_SESSION:
+		return cmd_to_string(MC_MCP_CMD_OPEN_SESSION);
+	case MCP_RTT_CLOSE_SESSION:
+		return cmd_to_string(MC_MCP_CMD_CLOSE_SESSION);
+	case MCP_RTT_MAP:
+		return cmd_to_string(MC_MCP_CMD_MAP);
+	case MCP_RTT_UNMAP:
+		return cmd_to_string(MC_MCP_CMD_UNMAP);
+	case MCP_RTT_GET_VERSION:
+		return cmd_to_string(MC_MCP_CMD_GET_MOBICORE_VERSION);
+	case MCP_RTT_CLOSE_MCP:
+		return cmd_to_string(MC_MCP_CMD_CLOSE_MCP);
+	case MCP_RTT_LOAD_TOKEN:
+		return cmd_to_string(MC_MCP_CMD_LOAD_TOKEN);
+	case MCP_RTT_CHECK_LOAD_TA:
+		return cmd_to_string(MC_MCP_CMD_CHECK_LOAD_TA);
+	case MCP_RTT_OTHER:
+		return "other";
+	case MCP_RTT_SESSION:
+		return "TA notification";
+	case MCP_RTT_MAX:
+		break;
+	}
+	return "unknown";
+}
+
+static void mcp_rtt_add(enum mcp_rtt_id id, u64 start_clk)
+{
+	struct mcp_rtt *rtt = &l_ctx.rtt[id];
+	u64 ns = local_clock() - start_clk;
+	u32 us = min_t(u64, div_u64(ns, NSEC_PER_USEC), U32_MAX);
+	int bucket = us ? min(ilog2(us) + 1, MCP_RTT_BUCKETS - 1) : 0;
+
+	spin_lock(&l_ctx.rtt_lock);
+	rtt->count++;
+	rtt->total_ns += ns;
+	if (ns > rtt->max_ns)
+		rtt->max_ns = ns;
+
+	rtt->buckets[bucket]++;
+	spin_unlock(&l_ctx.rtt_lock);
+}
+
 static const char *state_to_string(enum mcp_session_state state)
 {
 	switch (state) {
@@ -161,6 +259,7 @@ void mcp_session_init(struct mcp_session *session)
 	session->exit_code = 0;
 	session->state = MCP_SESSION_RUNNING;
 	session->notif_count = 0;
+	session->notif_clk = 0;
 }
 
 static inline bool mcp_session_isrunning(struct mcp_session *session)
@@ -316,6 +415,7 @@ static int mcp_cmd(union mcp_message *cmd,
 	union mcp_message *msg;
 	enum cmd_id cmd_id = cmd->cmd_header.cmd_id;
 	struct command_info *cmd_info;
+	u64 start_clk;
 
 	/* Initialize MCP log */
 	mutex_lock(&l_ctx.last_cmds_mutex);
@@ -353,6 +453,7 @@ static int mcp_cmd(union mcp_message *cmd,
 	memcpy(msg, cmd, sizeof(*msg));
 
 	/* Send MCP notification, with cmd_id as payload for debug purpose */
+	start_clk = local_clock();
 	nq_session_notify(&l_ctx.mcp_session.nq_session, l_ctx.mcp_session.sid,
 			  cmd_id);
 
@@ -364,6 +465,8 @@ static int mcp_cmd(union mcp_message *cmd,
 	if (ret)
 		goto out;
 
+	mcp_rtt_add(cmd_to_rtt_id(cmd_id), start_clk);
+
 	/* Check response ID */
 	if (msg->rsp_header.rsp_id != (cmd_id | FLAG_RESPONSE)) {
 		ret = -EBADE;
@@ -794,6 +897,7 @@ int mcp_notify(struct mcp_session *session)
 #endif
 
 	/* Put notif_count as payload for debug purpose */
+	session->notif_clk = local_clock();
 	return nq_session_notify(&session->nq_session, session->sid,
 				 ++session->notif_count);
 }
@@ -816,6 +920,12 @@ static inline void session_notif_handler(struct mcp_session *session, u32 id,
 		nq_session_state_update(&session->nq_session,
 					NQ_NOTIF_RECEIVED);
 
+		/* Answer to the last notification, if any */
+		if (session->notif_clk) {
+			mcp_rtt_add(MCP_RTT_SESSION, session->notif_clk);
+			session->notif_clk = 0;
+		}
+
 		/* Unblock waiter */
 		complete(&session->completion);
 	}
@@ -975,6 +1085,67 @@ static const struct file_operations debug_last_cmds_ops = {
 	.release = debug_generic_release,
 };
 
+static int debug_rtt(struct kasnprintf_buf *buf)
+{
+	int i, j, ret;
+
+	ret = kasnprintf(buf, "%-16s %8s %8s %8s  buckets of <2^n us\n",
+			 "command", "count", "mean us", "max us");
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < MCP_RTT_MAX; i++) {
+		struct mcp_rtt rtt;
+
+		/* Copy the row, kasnprintf may sleep */
+		spin_lock(&l_ctx.rtt_lock);
+		rtt = l_ctx.rtt[i];
+		spin_unlock(&l_ctx.rtt_lock);
+		if (!rtt.count)
+			continue;
+
+		ret = kasnprintf(buf, "%-16s %8llu %8llu %8llu ",
+				 rtt_id_to_string(i), rtt.count,
+				 div64_u64(rtt.total_ns,
+					   rtt.count * NSEC_PER_USEC),
+				 div_u64(rtt.max_ns, NSEC_PER_USEC));
+		for (j = 0; ret >= 0 && j < MCP_RTT_BUCKETS; j++)
+			ret = kasnprintf(buf, " %llu", rtt.buckets[j]);
+
+		if (ret >= 0)
+			ret = kasnprintf(buf, "\n");
+
+		if (ret < 0)
+			break;
+	}
+
+	return ret;
+}
+
+static ssize_t debug_rtt_read(struct file *file, char __user *user_buf,
+			      size_t count, loff_t *ppos)
+{
+	return debug_generic_read(file, user_buf, count, ppos, debug_rtt);
+}
+
+/* Any write clears the histograms */
+static ssize_t debug_rtt_write(struct file *file, const char __user *user_buf,
+			       size_t count, loff_t *ppos)
+{
+	spin_lock(&l_ctx.rtt_lock);
+	memset(l_ctx.rtt, 0, sizeof(l_ctx.rtt));
+	spin_unlock(&l_ctx.rtt_lock);
+	return count;
+}
+
+static const struct file_operations debug_rtt_ops = {
+	.read = debug_rtt_read,
+	.write = debug_rtt_write,
+	.llseek = default_llseek,
+	.open = debug_generic_open,
+	.release = debug_generic_release,
+};
+
 int mcp_init(void)
 {
 	l_ctx.buffer = nq_get_mcp_buffer();
@@ -987,6 +1158,7 @@ int mcp_init(void)
 	INIT_LIST_HEAD(&l_ctx.sessions);
 	mutex_init(&l_ctx.sessions_lock);
 	mutex_init(&l_ctx.last_cmds_mutex);
+	spin_lock_init(&l_ctx.rtt_lock);
 
 	l_ctx.timeout_period = MCP_TIMEOUT;
 
@@ -1010,6 +1182,8 @@ int mcp_start(void)
 			    &debug_sessions_ops);
 	debugfs_create_file("last_mcp_commands", 0400, g_ctx.debug_dir, NULL,
 			    &debug_last_cmds_ops);
+	debugfs_create_file("mcp_rtt", 0600, g_ctx.debug_dir, NULL,
+			    &debug_rtt_ops);
 	debugfs_create_u32("mcp_timeout", 0600, g_ctx.debug_dir,
 			   &l_ctx.timeout_period);
 	return 0;
@@ -83,6 +83,8 @@ struct mcp_session {
 	}			state;
 	/* Notification counter */
 	u32			notif_count;
+	/* Time of the last notification, 0 once answered */
+	u64			notif_clk;
 };
 
 /* Init for the mcp_session structure */
@@ -46,6 +46,7 @@
 #define NQ_NUM_ELEMS		64
 #define SCHEDULING_FREQ		5	/**< N-SIQ every n-th time */
 #define DEFAULT_TIMEOUT_MS	20000	/* We do nothing on timeout anyway */
+#define NSIQ_BATCH_US		20	/* Max wait for concurrent notifiers */
 
 /* If not forced by platform header, use defaults below */
 
@@ -93,6 +94,7 @@ static struct {
 	/* Scheduler */
 	int			active_cpu;	/* We always start on CPU #0 */
 	int			next_cpu;	/* If core switch required */
+	int			home_cpu;	/* Pinned core, -1 if none */
 	struct task_struct	*tee_scheduler_thread;
 	bool			tee_scheduler_run;
 	bool			tee_hung;
@@ -112,6 +114,17 @@ static struct {
 	}			request;
 	bool			suspended;
 
+	/* N-SIQ batching */
+	atomic_t		notifiers;	/* Notifications being pushed */
+	u32			batch_us;	/* Max wait for them to finish */
+	u32			last_write_cnt;	/* At the last N-SIQ */
+	/* Statistics, only written by the scheduler */
+	u64			nsiq_count;
+	u64			yield_count;
+	u64			batch_count;	/* N-SIQs delayed for a batch */
+	u64			notif_count;	/* Notifications sent by N-SIQs */
+	u32			notif_max;	/* Most in one N-SIQ */
+
 	/* Logging */
 	phys_addr_t		log_buffer;
 	u32			log_buffer_size;
@@ -130,6 +143,16 @@ static inline int nq_set_cpus_allowed(struct task_struct *p, cpumask_t new_mask)
 }
 #endif /* ! MC_SMC_FASTCALL */
 
+/* Go back to the pinned core once it is online again */
+static inline void switch_to_home_core(int cpu)
+{
+	if (cpu != l_ctx.home_cpu || l_ctx.active_cpu == cpu)
+		return;
+
+	mc_dev_info("CPU #%d is back online, switching to it", cpu);
+	mc_switch_core(cpu);
+}
+
 static inline int switch_to_online_core(int dying_cpu)
 {
 	int cpu;
@@ -165,6 +188,10 @@ static int cpu_notifer_callback(struct notifier_block *nfb,
 		mc_dev_devel("CPU #%d is going to die", cpu);
 		switch_to_online_core(cpu);
 		break;
+	case CPU_ONLINE:
+	case CPU_ONLINE_FROZEN:
+		switch_to_home_core(cpu);
+		break;
 	}
 	return NOTIFY_OK;
 }
@@ -173,6 +200,13 @@ static struct notifier_block cpu_notifer = {
 	.notifier_call = cpu_notifer_callback,
 };
 #else
+static int nq_cpu_online(unsigned int cpu)
+{
+	switch_to_home_core(cpu);
+	/* Never prevent the CPU from coming up */
+	return 0;
+}
+
 static int nq_cpu_down_prep(unsigned int cpu)
 {
 	mc_dev_devel("CPU #%d is going to die", cpu);
@@ -378,6 +412,8 @@ int nq_session_notify(struct nq_session *session, u32 id, u32 payload)
 {
 	int ret = 0;
 
+	/* Tell the scheduler to wait for us before its next N-SIQ */
+	atomic_inc(&l_ctx.notifiers);
 	mutex_lock(&l_ctx.notifications_mutex);
 	session->id = id;
 	session->payload = payload;
@@ -414,6 +450,7 @@ int nq_session_notify(struct nq_session *session, u32 id, u32 payload)
 	}
 
 	mutex_unlock(&l_ctx.notifications_mutex);
+	atomic_dec(&l_ctx.notifiers);
 	return ret;
 }
 
@@ -468,6 +505,77 @@ static const struct file_operations debug_smclog_ops = {
 	.release = debug_generic_release,
 };
 
+static int debug_stats(struct kasnprintf_buf *buf)
+{
+	return kasnprintf(buf,
+			  "n-siqs:         %llu\n"
+			  "yields:         %llu\n"
+			  "batched n-siqs: %llu\n"
+			  "notifications:  %llu\n"
+			  "max per n-siq:  %u\n"
+			  "active cpu:     %d\n"
+			  "home cpu:       %d\n",
+			  l_ctx.nsiq_count, l_ctx.yield_count, l_ctx.batch_count,
+			  l_ctx.notif_count, l_ctx.notif_max, l_ctx.active_cpu,
+			  l_ctx.home_cpu);
+}
+
+static ssize_t debug_stats_read(struct file *file, char __user *user_buf,
+				size_t count, loff_t *ppos)
+{
+	return debug_generic_read(file, user_buf, count, ppos, debug_stats);
+}
+
+static const struct file_operations debug_stats_ops = {
+	.read = debug_stats_read,
+	.llseek = default_llseek,
+	.open = debug_generic_open,
+	.release = debug_generic_release,
+};
+
+/* Pin the TEE to a core, it follows hotplug and comes back; -1 to unpin */
+static ssize_t debug_home_cpu_write(struct file *file,
+				    const char __user *buffer,
+				    size_t buffer_len, loff_t *ppos)
+{
+	int cpu;
+	int ret;
+
+	if (kstrtoint_from_user(buffer, buffer_len, 0, &cpu))
+		return -EINVAL;
+
+	if (cpu < 0) {
+		l_ctx.home_cpu = -1;
+		return buffer_len;
+	}
+
+	ret = mc_switch_core(cpu);
+	if (ret)
+		return ret;
+
+	l_ctx.home_cpu = cpu;
+	return buffer_len;
+}
+
+static ssize_t debug_home_cpu_read(struct file *file, char __user *buffer,
+				   size_t buffer_len, loff_t *ppos)
+{
+	char cpu_str[8];
+	int ret;
+
+	ret = snprintf(cpu_str, sizeof(cpu_str), "%d\n", l_ctx.home_cpu);
+	if (ret < 0)
+		return -EINVAL;
+
+	return simple_read_from_buffer(buffer, buffer_len, ppos,
+				       cpu_str, ret);
+}
+
+static const struct file_operations debug_home_cpu_ops = {
+	.write = debug_home_cpu_write,
+	.read = debug_home_cpu_read,
+};
+
 static void nq_dump_status(void)
 {
 	static const struct {
@@ -869,6 +977,27 @@ static inline int nq_switch_core(void)
 	return ret;
 }
 
+/*
+ * Small TA commands, as the ones of fingerprint and DRM sessions, often come
+ * from several threads at once. Rather than one world switch each, wait a bit
+ * for the notifications being pushed so that a single N-SIQ carries them all.
+ * Nobody waits when there is no concurrent notifier.
+ */
+static inline void nq_batch_wait(void)
+{
+	u64 deadline;
+
+	if (!l_ctx.batch_us || !atomic_read(&l_ctx.notifiers))
+		return;
+
+	deadline = local_clock() + (u64)l_ctx.batch_us * NSEC_PER_USEC;
+	while (atomic_read(&l_ctx.notifiers) && !notif_queue_full() &&
+	       local_clock() < deadline)
+		cpu_relax();
+
+	l_ctx.batch_count++;
+}
+
 /*
  * This thread, and only this thread, schedules the SWd. Hence, reading the idle
  * status and its associated timeout is safe from race conditions.
@@ -931,6 +1060,10 @@ static int tee_scheduler(void *arg)
 		if (!l_ctx.tee_scheduler_run)
 			break;
 
+		/* Racy read, only to know whether an N-SIQ is coming */
+		if (l_ctx.request == NSIQ)
+			nq_batch_wait();
+
 		/* Get requested command if any */
 		mutex_lock(&l_ctx.request_mutex);
 		switch (l_ctx.request) {
@@ -965,6 +1098,8 @@ static int tee_scheduler(void *arg)
 			cpumask_set_cpu(l_ctx.active_cpu, &cpu_mask);
 			nq_set_cpus_allowed(l_ctx.tee_scheduler_thread,
 					    cpu_mask);
+			/* Handle S-SIQs where the SWd runs */
+			nq_set_cpus_allowed(l_ctx.irq_bh_thread, cpu_mask);
 		}
 
 		l_ctx.request = NONE;
@@ -979,13 +1114,22 @@ static int tee_scheduler(void *arg)
 		if (timeslice--) {
 			/* Resume SWd from where it was */
 			fc_yield(timeslice);
+			l_ctx.yield_count++;
 		} else {
 			u32 session_id = 0;
 			u32 payload = 0;
+			u32 sent;
 
 			retrieve_last_session_payload(&session_id, &payload);
 			timeslice = SCHEDULING_FREQ;
 
+			sent = l_ctx.nq.tx->hdr.write_cnt - l_ctx.last_write_cnt;
+			l_ctx.last_write_cnt += sent;
+			l_ctx.notif_count += sent;
+			if (sent > l_ctx.notif_max)
+				l_ctx.notif_max = sent;
+			l_ctx.nsiq_count++;
+
 			/* Call SWd scheduler */
 			fc_nsiq(session_id, payload);
 		}
@@ -1106,6 +1250,13 @@ int nq_start(void)
 		return l_ctx.boot_ret;
 
 	complete(&l_ctx.idle_complete);
+
+	debugfs_create_file("nq_stats", 0400, g_ctx.debug_dir, NULL,
+			    &debug_stats_ops);
+	debugfs_create_file("home_cpu", 0600, g_ctx.debug_dir, NULL,
+			    &debug_home_cpu_ops);
+	debugfs_create_u32("nsiq_batch_us", 0600, g_ctx.debug_dir,
+			   &l_ctx.batch_us);
 	return 0;
 }
 
@@ -1135,7 +1286,8 @@ int nq_init(void)
 #else
 		ret = cpuhp_setup_state_nocalls(CPUHP_AP_ONLINE_DYN,
 						"tee/trustonic:online",
-						NULL, nq_cpu_down_prep);
+						nq_cpu_online,
+						nq_cpu_down_prep);
 #endif
 		/* ExySp : Kinibi 410 */
 		if (ret < 0) {
@@ -1207,6 +1359,9 @@ int nq_init(void)
 	init_completion(&l_ctx.sleep_complete);
 	mutex_init(&l_ctx.sleep_mutex);
 	mutex_init(&l_ctx.request_mutex);
+	l_ctx.home_cpu = -1;
+	atomic_set(&l_ctx.notifiers, 0);
+	l_ctx.batch_us = NSIQ_BATCH_US;
 	return 0;
 
 err_mci:
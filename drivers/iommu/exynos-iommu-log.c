@@ -64,7 +64,8 @@ static const char * const sysmmu_event_name[] = {
 	"IOMMU_ALLOCSLPD",
 	"IOMMU_FREESLPD",
 	"IOVMM_MAP",
-	"IOVMM_UNMAP"
+	"IOVMM_UNMAP",
+	"TLB_PRELOAD"
 };
 
 static void exynos_iommu_debug_log_show(struct seq_file *s,
@@ -93,6 +94,7 @@ static void exynos_iommu_debug_log_show(struct seq_file *s,
 				log->eventdata.range.end);
 		break;
 	case EVENT_SYSMMU_TLB_INV_RANGE:
+	case EVENT_SYSMMU_TLB_PRELOAD:
 	case EVENT_SYSMMU_IOMMU_UNMAP:
 	case EVENT_SYSMMU_IOVMM_UNMAP:
 		seq_printf(s, " @ [%#010x, %#010x)\n",
@@ -191,6 +193,85 @@ void iommu_add_log_to_debugfs(struct dentry *debugfs_root,
 				log, name);
 }
 
+static int sysmmu_debugfs_tlb_stat_show(struct seq_file *s, void *unused)
+{
+	struct sysmmu_tlb_stat *stat = s->private;
+
+	seq_printf(s, "Preloaded buffers         : %d\n",
+		   atomic_read(&stat->preload));
+	seq_printf(s, "Preloads of unmapped pages: %d\n",
+		   atomic_read(&stat->preload_fault));
+	seq_printf(s, "Prefetching way updates   : %d\n",
+		   atomic_read(&stat->preload_way));
+	seq_printf(s, "Cold misses of sections   : %d\n",
+		   atomic_read(&stat->miss_sect));
+	seq_printf(s, "Cold misses of large pages: %d\n",
+		   atomic_read(&stat->miss_lpage));
+	seq_printf(s, "Cold misses of small pages: %d\n",
+		   atomic_read(&stat->miss_spage));
+
+	return 0;
+}
+
+static int sysmmu_debugfs_tlb_stat_open(struct inode *inode,
+					struct file *file)
+{
+	return single_open(file, sysmmu_debugfs_tlb_stat_show,
+				inode->i_private);
+}
+
+static ssize_t sysmmu_debugfs_tlb_stat_write(struct file *filp,
+			const char __user *p, size_t len, loff_t *off)
+{
+	struct seq_file *s = filp->private_data;
+	struct sysmmu_tlb_stat *stat = s->private;
+
+	/* clears the counters */
+	atomic_set(&stat->preload, 0);
+	atomic_set(&stat->preload_fault, 0);
+	atomic_set(&stat->preload_way, 0);
+	atomic_set(&stat->miss_sect, 0);
+	atomic_set(&stat->miss_lpage, 0);
+	atomic_set(&stat->miss_spage, 0);
+
+	return len;
+}
+
+#define SYSMMU_DENTRY_TLB_STAT_ROOT_NAME "tlbstat"
+static struct dentry *sysmmu_debugfs_tlb_stat_root;
+
+static const struct file_operations sysmmu_debugfs_tlb_stat_fops = {
+	.open = sysmmu_debugfs_tlb_stat_open,
+	.read = seq_read,
+	.write = sysmmu_debugfs_tlb_stat_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+void sysmmu_add_tlb_stat_to_debugfs(struct dentry *debugfs_root,
+			struct sysmmu_tlb_stat *stat, const char *name)
+{
+	if (!debugfs_root)
+		return;
+
+	if (!sysmmu_debugfs_tlb_stat_root) {
+		sysmmu_debugfs_tlb_stat_root = debugfs_create_dir(
+				SYSMMU_DENTRY_TLB_STAT_ROOT_NAME, debugfs_root);
+		if (!sysmmu_debugfs_tlb_stat_root) {
+			pr_err("%s: Failed to create 'tlbstat' entry\n",
+				__func__);
+			return;
+		}
+	}
+
+	stat->debugfs_root = debugfs_create_file(name, 0600,
+					sysmmu_debugfs_tlb_stat_root, stat,
+					&sysmmu_debugfs_tlb_stat_fops);
+	if (!stat->debugfs_root)
+		pr_err("%s: Failed to create '%s' entry of 'tlbstat'\n",
+				__func__, name);
+}
+
 #if defined(CONFIG_EXYNOS_IOVMM)
 static struct dentry *iovmm_debugfs_log_root;
 
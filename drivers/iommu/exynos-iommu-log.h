@@ -35,7 +35,8 @@ enum sysmmu_event_log_event {
 	EVENT_SYSMMU_IOMMU_ALLOCSLPD,
 	EVENT_SYSMMU_IOMMU_FREESLPD,
 	EVENT_SYSMMU_IOVMM_MAP,
-	EVENT_SYSMMU_IOVMM_UNMAP
+	EVENT_SYSMMU_IOVMM_UNMAP,
+	EVENT_SYSMMU_TLB_PRELOAD
 };
 
 struct sysmmu_event_range {
@@ -85,6 +86,21 @@ struct exynos_iommu_event_log {
 	struct dentry *debugfs_root;
 };
 
+/*
+ * Page table walks of the buffers preloaded by the master. On a cold TLB,
+ * every entry of a buffer is a miss on its first access, so the entries
+ * walked count the misses that the prefetching way has to hide.
+ */
+struct sysmmu_tlb_stat {
+	atomic_t preload;		/* buffers walked */
+	atomic_t preload_fault;		/* buffers with unmapped pages */
+	atomic_t preload_way;		/* prefetching way set to a buffer */
+	atomic_t miss_sect;		/* 1MB section entries walked */
+	atomic_t miss_lpage;		/* 64KB large page entries walked */
+	atomic_t miss_spage;		/* 4KB small page entries walked */
+	struct dentry *debugfs_root;
+};
+
 /* sizeof(struct sysmmu_event_log) = 8 + 4 * 3 + 4 = 24 bytes */
 #define SYSMMU_LOG_LEN 1024
 #define IOMMU_LOG_LEN 4096
@@ -179,6 +195,9 @@ void sysmmu_add_log_to_debugfs(struct dentry *debugfs_root,
 void iommu_add_log_to_debugfs(struct dentry *debugfs_root,
 			struct exynos_iommu_event_log *log, const char *name);
 
+void sysmmu_add_tlb_stat_to_debugfs(struct dentry *debugfs_root,
+			struct sysmmu_tlb_stat *stat, const char *name);
+
 #if defined(CONFIG_EXYNOS_IOVMM)
 void iovmm_add_log_to_debugfs(struct dentry *debugfs_root,
 			struct exynos_iommu_event_log *log, const char *name);
@@ -196,6 +215,7 @@ DEFINE_SYSMMU_EVENT_LOG_2ADDR(IOMMU_ALLOCSLPD)
 DEFINE_SYSMMU_EVENT_LOG_2ADDR(IOMMU_FREESLPD)
 
 DEFINE_SYSMMU_EVENT_LOG_2ADDR(TLB_INV_RANGE)
+DEFINE_SYSMMU_EVENT_LOG_2ADDR(TLB_PRELOAD)
 DEFINE_SYSMMU_EVENT_LOG_2ADDR(IOMMU_UNMAP)
 DEFINE_SYSMMU_EVENT_LOG_2ADDR(IOVMM_UNMAP)
 
@@ -519,6 +519,13 @@ static inline void __sysmmu_set_private_way_addr(struct sysmmu_drvdata *drvdata,
 	writel_relaxed(cfg, drvdata->sfrbase + REG_PRIVATE_WAY_CFG(way_idx));
 
 	dev_dbg(drvdata->sysmmu, "priv ADDR way[%d] cfg : %#x\n", way_idx, cfg);
+
+	if (priv_cfg[priv_addr_idx].end) {
+		writel_relaxed(priv_cfg[priv_addr_idx].start,
+			drvdata->sfrbase + REG_PRIVATE_ADDR_START(way_idx));
+		writel_relaxed(priv_cfg[priv_addr_idx].end,
+			drvdata->sfrbase + REG_PRIVATE_ADDR_END(way_idx));
+	}
 }
 
 static inline void __sysmmu_set_tlb_way_type(struct sysmmu_drvdata *drvdata)
@@ -97,6 +97,53 @@ static inline void pgtable_flush(void *vastart, void *vaend)
 	__dma_flush_area(vastart, vaend - vastart);
 }
 
+static void sysmmu_batch_flush_lv1(struct sysmmu_pgtable_batch *batch)
+{
+	if (batch->sent_start == batch->sent_end)
+		return;
+
+	pgtable_flush(batch->sent_start, batch->sent_end);
+	atomic_inc(&batch->domain->nr_pgtable_flush);
+	batch->sent_start = batch->sent_end = NULL;
+}
+
+static void sysmmu_batch_flush_lv2(struct sysmmu_pgtable_batch *batch)
+{
+	if (batch->pent_start == batch->pent_end)
+		return;
+
+	pgtable_flush(batch->pent_start, batch->pent_end);
+	atomic_inc(&batch->domain->nr_pgtable_flush);
+	batch->pent_start = batch->pent_end = NULL;
+}
+
+/* Entries of a lv2 table are flushed before the lv1 entry pointing it */
+static void sysmmu_batch_flush(struct sysmmu_pgtable_batch *batch)
+{
+	sysmmu_batch_flush_lv2(batch);
+	sysmmu_batch_flush_lv1(batch);
+}
+
+static void sysmmu_batch_add_lv1(struct sysmmu_pgtable_batch *batch,
+				 sysmmu_pte_t *sent)
+{
+	if (sent != batch->sent_end) {
+		sysmmu_batch_flush_lv1(batch);
+		batch->sent_start = sent;
+	}
+	batch->sent_end = sent + 1;
+}
+
+static void sysmmu_batch_add_lv2(struct sysmmu_pgtable_batch *batch,
+				 sysmmu_pte_t *pent, int n)
+{
+	if (pent != batch->pent_end) {
+		sysmmu_batch_flush_lv2(batch);
+		batch->pent_start = pent;
+	}
+	batch->pent_end = pent + n;
+}
+
 void exynos_sysmmu_tlb_invalidate(struct iommu_domain *iommu_domain,
 					dma_addr_t d_start, size_t size)
 {
@@ -106,6 +153,8 @@ void exynos_sysmmu_tlb_invalidate(struct iommu_domain *iommu_domain,
 	sysmmu_iova_t start = (sysmmu_iova_t)d_start;
 	unsigned long flags;
 
+	atomic_inc(&domain->nr_tlb_flush);
+
 	spin_lock_irqsave(&domain->lock, flags);
 	list_for_each_entry(owner, &domain->clients_list, client) {
 		list_for_each_entry(list, &owner->sysmmu_list, node) {
@@ -132,6 +181,102 @@ void exynos_sysmmu_tlb_invalidate(struct iommu_domain *iommu_domain,
 	spin_unlock_irqrestore(&domain->lock, flags);
 }
 
+/*
+ * Walks the page table entries of a buffer that @master is about to read.
+ * Returns -EFAULT if a page is not mapped, as the access would fault, then
+ * the buffer should not be given to the device. Otherwise the private TLB
+ * way of address matching @slot, with the prefetch configured by the device
+ * tree, is set to the buffer so that its entries are fetched ahead of the
+ * accesses. Slots beyond the address matching ways are only walked.
+ */
+int exynos_sysmmu_preload(struct device *master, dma_addr_t d_start,
+			  size_t size, unsigned int slot)
+{
+	struct exynos_iommu_owner *owner = master->archdata.iommu;
+	struct exynos_iommu_domain *domain;
+	struct sysmmu_list_data *list;
+	sysmmu_iova_t start = (sysmmu_iova_t)d_start;
+	sysmmu_iova_t iova = start, end = start + size;
+	int nr_sect = 0, nr_lpage = 0, nr_spage = 0;
+	bool fault = false;
+	unsigned long flags;
+
+	if (!has_sysmmu(master) || !owner->domain)
+		return -ENODEV;
+
+	if (!size || end < start)
+		return -EINVAL;
+
+	domain = to_exynos_domain(owner->domain);
+
+	spin_lock_irqsave(&domain->pgtablelock, flags);
+	while (iova < end && iova >= start) {
+		sysmmu_pte_t *ent = section_entry(domain->pgtable, iova);
+
+		if (lv1ent_section(ent)) {
+			nr_sect++;
+			iova = (iova & SECT_MASK) + SECT_SIZE;
+			continue;
+		}
+
+		if (!lv1ent_page(ent)) {
+			fault = true;
+			break;
+		}
+
+		ent = page_entry(ent, iova);
+		if (lv2ent_large(ent)) {
+			nr_lpage++;
+			iova = (iova & LPAGE_MASK) + LPAGE_SIZE;
+		} else if (lv2ent_small(ent)) {
+			nr_spage++;
+			iova = (iova & SPAGE_MASK) + SPAGE_SIZE;
+		} else {
+			fault = true;
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&domain->pgtablelock, flags);
+
+	list_for_each_entry(list, &owner->sysmmu_list, node) {
+		struct sysmmu_drvdata *drvdata = dev_get_drvdata(list->sysmmu);
+		struct tlb_props *tlb_props = &drvdata->tlb_props;
+		struct sysmmu_tlb_stat *stat = &drvdata->tlb_stat;
+		struct tlb_priv_addr *priv_cfg;
+
+		if (fault) {
+			atomic_inc(&stat->preload_fault);
+			continue;
+		}
+
+		atomic_inc(&stat->preload);
+		atomic_add(nr_sect, &stat->miss_sect);
+		atomic_add(nr_lpage, &stat->miss_lpage);
+		atomic_add(nr_spage, &stat->miss_spage);
+
+		if (!IS_TLB_WAY_TYPE(drvdata) ||
+				!(tlb_props->flags & TLB_WAY_PRIVATE_ADDR) ||
+				slot >= tlb_props->way_props.priv_addr_cnt)
+			continue;
+
+		spin_lock_irqsave(&drvdata->lock, flags);
+		priv_cfg = &tlb_props->way_props.priv_addr_cfg[slot];
+		priv_cfg->start = start;
+		priv_cfg->end = end - 1;
+		/* applied when the System MMU is enabled otherwise */
+		if (is_runtime_active_or_enabled(drvdata) &&
+				is_sysmmu_active(drvdata)) {
+			__sysmmu_set_private_way_addr(drvdata, slot);
+			atomic_inc(&stat->preload_way);
+		}
+		SYSMMU_EVENT_LOG_TLB_PRELOAD(SYSMMU_DRVDATA_TO_LOG(drvdata),
+					start, end);
+		spin_unlock_irqrestore(&drvdata->lock, flags);
+	}
+
+	return fault ? -EFAULT : 0;
+}
+
 static void sysmmu_get_interrupt_info(struct sysmmu_drvdata *data,
 			int *flags, unsigned long *addr, bool is_secure)
 {
@@ -543,6 +688,9 @@ static int __init exynos_sysmmu_probe(struct platform_device *pdev)
 	else
 		return ret;
 
+	sysmmu_add_tlb_stat_to_debugfs(exynos_sysmmu_debugfs_root,
+				&data->tlb_stat, dev_name(dev));
+
 	ret = sysmmu_get_hw_info(data);
 	if (ret) {
 		dev_err(dev, "Failed to get h/w info\n");
@@ -978,6 +1126,7 @@ static sysmmu_pte_t *alloc_lv2entry(struct exynos_iommu_domain *domain,
 			atomic_set(pgcounter, NUM_LV2ENTRIES);
 			pgtable_flush(pent, pent + NUM_LV2ENTRIES);
 			pgtable_flush(sent, sent + 1);
+			atomic_add(2, &domain->nr_pgtable_flush);
 			SYSMMU_EVENT_LOG_IOMMU_ALLOCSLPD(IOMMU_PRIV_TO_LOG(domain),
 					iova & SECT_MASK, *sent);
 		} else {
@@ -995,7 +1144,7 @@ static void clear_lv2_page_table(sysmmu_pte_t *ent, int n)
 		memset(ent, 0, sizeof(*ent) * n);
 }
 
-static int lv1set_section(struct exynos_iommu_domain *domain,
+static int lv1set_section(struct sysmmu_pgtable_batch *batch,
 			  sysmmu_pte_t *sent, sysmmu_iova_t iova,
 			  phys_addr_t paddr, int prot, atomic_t *pgcnt)
 {
@@ -1019,13 +1168,13 @@ static int lv1set_section(struct exynos_iommu_domain *domain,
 	*sent = mk_lv1ent_sect(paddr);
 	if (shareable)
 		set_lv1ent_shareable(sent);
-	pgtable_flush(sent, sent + 1);
+	sysmmu_batch_add_lv1(batch, sent);
 
 	return 0;
 }
 
-static int lv2set_page(sysmmu_pte_t *pent, phys_addr_t paddr, size_t size,
-						int prot, atomic_t *pgcnt)
+static int lv2set_page(struct sysmmu_pgtable_batch *batch, sysmmu_pte_t *pent,
+		       phys_addr_t paddr, size_t size, int prot, atomic_t *pgcnt)
 {
 	bool shareable = !!(prot & IOMMU_CACHE);
 
@@ -1036,7 +1185,7 @@ static int lv2set_page(sysmmu_pte_t *pent, phys_addr_t paddr, size_t size,
 		*pent = mk_lv2ent_spage(paddr);
 		if (shareable)
 			set_lv2ent_shareable(pent);
-		pgtable_flush(pent, pent + 1);
+		sysmmu_batch_add_lv2(batch, pent, 1);
 		atomic_dec(pgcnt);
 	} else { /* size == LPAGE_SIZE */
 		int i;
@@ -1051,19 +1200,19 @@ static int lv2set_page(sysmmu_pte_t *pent, phys_addr_t paddr, size_t size,
 			if (shareable)
 				set_lv2ent_shareable(pent);
 		}
-		pgtable_flush(pent - SPAGES_PER_LPAGE, pent);
+		sysmmu_batch_add_lv2(batch, pent - SPAGES_PER_LPAGE,
+				     SPAGES_PER_LPAGE);
 		atomic_sub(SPAGES_PER_LPAGE, pgcnt);
 	}
 
 	return 0;
 }
-static int exynos_iommu_map(struct iommu_domain *iommu_domain,
-			    unsigned long l_iova, phys_addr_t paddr, size_t size,
-			    int prot)
+static int __exynos_iommu_map(struct sysmmu_pgtable_batch *batch,
+			      sysmmu_iova_t iova, phys_addr_t paddr,
+			      size_t size, int prot)
 {
-	struct exynos_iommu_domain *domain = to_exynos_domain(iommu_domain);
+	struct exynos_iommu_domain *domain = batch->domain;
 	sysmmu_pte_t *entry;
-	sysmmu_iova_t iova = (sysmmu_iova_t)l_iova;
 	int ret = -ENOMEM;
 
 	BUG_ON(domain->pgtable == NULL);
@@ -1071,7 +1220,7 @@ static int exynos_iommu_map(struct iommu_domain *iommu_domain,
 	entry = section_entry(domain->pgtable, iova);
 
 	if (size == SECT_SIZE) {
-		ret = lv1set_section(domain, entry, iova, paddr, prot,
+		ret = lv1set_section(batch, entry, iova, paddr, prot,
 				     &domain->lv2entcnt[lv1ent_offset(iova)]);
 	} else {
 		sysmmu_pte_t *pent;
@@ -1082,22 +1231,143 @@ static int exynos_iommu_map(struct iommu_domain *iommu_domain,
 		if (IS_ERR(pent))
 			ret = PTR_ERR(pent);
 		else
-			ret = lv2set_page(pent, paddr, size, prot,
+			ret = lv2set_page(batch, pent, paddr, size, prot,
 				       &domain->lv2entcnt[lv1ent_offset(iova)]);
 	}
 
 	if (ret)
 		pr_err("%s: Failed(%d) to map %#zx bytes @ %#x\n",
 			__func__, ret, size, iova);
+	else if (size == SECT_SIZE)
+		atomic_inc(&domain->nr_sect_map);
+	else if (size == LPAGE_SIZE)
+		atomic_inc(&domain->nr_lpage_map);
+	else
+		atomic_inc(&domain->nr_spage_map);
 
 	return ret;
 }
 
-static size_t exynos_iommu_unmap(struct iommu_domain *iommu_domain,
-				 unsigned long l_iova, size_t size)
+static int exynos_iommu_map(struct iommu_domain *iommu_domain,
+			    unsigned long l_iova, phys_addr_t paddr, size_t size,
+			    int prot)
 {
-	struct exynos_iommu_domain *domain = to_exynos_domain(iommu_domain);
-	sysmmu_iova_t iova = (sysmmu_iova_t)l_iova;
+	struct sysmmu_pgtable_batch batch = {
+		.domain = to_exynos_domain(iommu_domain),
+	};
+	int ret;
+
+	ret = __exynos_iommu_map(&batch, (sysmmu_iova_t)l_iova,
+				 paddr, size, prot);
+	sysmmu_batch_flush(&batch);
+
+	return ret;
+}
+
+/* Returns the largest page size that @iova and @paddr are aligned to */
+static size_t sysmmu_pgsize(sysmmu_iova_t iova, phys_addr_t paddr, size_t size)
+{
+	if (IS_ALIGNED(iova | paddr, SECT_SIZE) && size >= SECT_SIZE)
+		return SECT_SIZE;
+
+	if (IS_ALIGNED(iova | paddr, LPAGE_SIZE) && size >= LPAGE_SIZE)
+		return LPAGE_SIZE;
+
+	return SPAGE_SIZE;
+}
+
+void exynos_iommu_batch_start(struct iommu_domain *dom,
+			      struct sysmmu_pgtable_batch *batch)
+{
+	memset(batch, 0, sizeof(*batch));
+	batch->domain = to_exynos_domain(dom);
+	batch->start = ktime_get();
+}
+
+/*
+ * exynos_iommu_map_batch - map physically contiguous memory in a batch
+ *
+ * Page table entries are not written back to memory until
+ * exynos_iommu_batch_finish() is called on @batch unless the next mapping
+ * is not adjacent to them. The mapped part is unmapped on failure.
+ */
+int exynos_iommu_map_batch(struct sysmmu_pgtable_batch *batch,
+			   dma_addr_t d_iova, phys_addr_t paddr, size_t size,
+			   int prot)
+{
+	sysmmu_iova_t iova = (sysmmu_iova_t)d_iova;
+	size_t mapped = 0;
+	int ret;
+
+	if (WARN_ON(!IS_ALIGNED(iova | paddr | size, SPAGE_SIZE)))
+		return -EINVAL;
+
+	while (mapped < size) {
+		size_t pgsize = sysmmu_pgsize(iova + mapped, paddr + mapped,
+					      size - mapped);
+
+		ret = __exynos_iommu_map(batch, iova + mapped, paddr + mapped,
+					 pgsize, prot);
+		if (ret)
+			goto err;
+
+		mapped += pgsize;
+	}
+
+	return 0;
+err:
+	sysmmu_batch_flush(batch);
+	exynos_iommu_unmap_range(&batch->domain->domain, d_iova, mapped);
+
+	return ret;
+}
+
+void exynos_iommu_batch_finish(struct sysmmu_pgtable_batch *batch)
+{
+	sysmmu_batch_flush(batch);
+
+	atomic64_add(ktime_to_ns(ktime_sub(ktime_get(), batch->start)),
+		     &batch->domain->map_time_ns);
+}
+
+static size_t exynos_iommu_map_sg(struct iommu_domain *iommu_domain,
+				  unsigned long iova, struct scatterlist *sg,
+				  unsigned int nents, int prot)
+{
+	struct sysmmu_pgtable_batch batch;
+	struct scatterlist *s;
+	size_t mapped = 0;
+	unsigned int i;
+
+	exynos_iommu_batch_start(iommu_domain, &batch);
+
+	for_each_sg(sg, s, nents, i) {
+		phys_addr_t phys = page_to_phys(sg_page(s)) + s->offset;
+
+		if (!IS_ALIGNED(s->offset | s->length, SPAGE_SIZE))
+			goto err;
+
+		if (exynos_iommu_map_batch(&batch, iova + mapped, phys,
+					   s->length, prot))
+			goto err;
+
+		mapped += s->length;
+	}
+
+	exynos_iommu_batch_finish(&batch);
+
+	return mapped;
+err:
+	exynos_iommu_batch_finish(&batch);
+	exynos_iommu_unmap_range(iommu_domain, iova, mapped);
+
+	return 0;
+}
+
+static size_t __exynos_iommu_unmap(struct sysmmu_pgtable_batch *batch,
+				   sysmmu_iova_t iova, size_t size)
+{
+	struct exynos_iommu_domain *domain = batch->domain;
 	sysmmu_pte_t *sent, *pent;
 	size_t err_pgsize;
 	atomic_t *lv2entcnt = &domain->lv2entcnt[lv1ent_offset(iova)];
@@ -1113,7 +1383,7 @@ static size_t exynos_iommu_unmap(struct iommu_domain *iommu_domain,
 		}
 
 		*sent = 0;
-		pgtable_flush(sent, sent + 1);
+		sysmmu_batch_add_lv1(batch, sent);
 		size = SECT_SIZE;
 		goto done;
 	}
@@ -1136,7 +1406,7 @@ static size_t exynos_iommu_unmap(struct iommu_domain *iommu_domain,
 	if (lv2ent_small(pent)) {
 		*pent = 0;
 		size = SPAGE_SIZE;
-		pgtable_flush(pent, pent + 1);
+		sysmmu_batch_add_lv2(batch, pent, 1);
 		atomic_inc(lv2entcnt);
 		goto unmap_flpd;
 	}
@@ -1148,7 +1418,7 @@ static size_t exynos_iommu_unmap(struct iommu_domain *iommu_domain,
 	}
 
 	clear_lv2_page_table(pent, SPAGES_PER_LPAGE);
-	pgtable_flush(pent, pent + SPAGES_PER_LPAGE);
+	sysmmu_batch_add_lv2(batch, pent, SPAGES_PER_LPAGE);
 	size = LPAGE_SIZE;
 	atomic_add(SPAGES_PER_LPAGE, lv2entcnt);
 
@@ -1158,6 +1428,8 @@ unmap_flpd:
 		unsigned long flags;
 		spin_lock_irqsave(&domain->pgtablelock, flags);
 		if (atomic_read(lv2entcnt) == NUM_LV2ENTRIES) {
+			/* pending entries may be in the table to be freed */
+			sysmmu_batch_flush_lv2(batch);
 			kmem_cache_free(lv2table_kmem_cache,
 					page_entry(sent, 0));
 			atomic_set(lv2entcnt, 0);
@@ -1167,6 +1439,7 @@ unmap_flpd:
 				iova_from_sent(domain->pgtable, sent), *sent);
 
 			*sent = 0;
+			sysmmu_batch_add_lv1(batch, sent);
 		}
 		spin_unlock_irqrestore(&domain->pgtablelock, flags);
 	}
@@ -1182,6 +1455,50 @@ err:
 	return 0;
 }
 
+static size_t exynos_iommu_unmap(struct iommu_domain *iommu_domain,
+				 unsigned long l_iova, size_t size)
+{
+	struct sysmmu_pgtable_batch batch = {
+		.domain = to_exynos_domain(iommu_domain),
+	};
+
+	size = __exynos_iommu_unmap(&batch, (sysmmu_iova_t)l_iova, size);
+	sysmmu_batch_flush(&batch);
+
+	return size;
+}
+
+/*
+ * exynos_iommu_unmap_range - unmap @size bytes from @iova
+ *
+ * All page table entries cleared are written back to memory with as few
+ * cache flushes as possible. TLB invalidation is left to the caller.
+ */
+size_t exynos_iommu_unmap_range(struct iommu_domain *dom,
+				dma_addr_t d_iova, size_t size)
+{
+	struct sysmmu_pgtable_batch batch = {
+		.domain = to_exynos_domain(dom),
+	};
+	sysmmu_iova_t iova = (sysmmu_iova_t)d_iova;
+	size_t unmapped = 0;
+
+	while (unmapped < size) {
+		size_t pgsize, len;
+
+		pgsize = sysmmu_pgsize(iova + unmapped, 0, size - unmapped);
+		len = __exynos_iommu_unmap(&batch, iova + unmapped, pgsize);
+		if (!len)
+			break;
+
+		unmapped += len;
+	}
+
+	sysmmu_batch_flush(&batch);
+
+	return unmapped;
+}
+
 static phys_addr_t exynos_iommu_iova_to_phys(struct iommu_domain *iommu_domain,
 					  dma_addr_t d_iova)
 {
@@ -1292,7 +1609,7 @@ static struct iommu_ops exynos_iommu_ops = {
 	.detach_dev = exynos_iommu_detach_device,
 	.map = exynos_iommu_map,
 	.unmap = exynos_iommu_unmap,
-	.map_sg = default_iommu_map_sg,
+	.map_sg = exynos_iommu_map_sg,
 	.iova_to_phys = exynos_iommu_iova_to_phys,
 	.pgsize_bitmap = SECT_SIZE | LPAGE_SIZE | SPAGE_SIZE,
 	.of_xlate = exynos_iommu_of_xlate,
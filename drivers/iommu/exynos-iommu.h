@@ -20,6 +20,8 @@
 #include <linux/iommu.h>
 #include <linux/irq.h>
 #include <linux/clk.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
 
 #include <linux/exynos_iovmm.h>
 
@@ -255,6 +257,26 @@ struct exynos_iommu_domain {
 	atomic_t *lv2entcnt;	/* free lv2 entry counter for each section */
 	spinlock_t lock;		/* lock for modifying clients_list */
 	struct exynos_iommu_event_log log;
+	atomic_t nr_sect_map;		/* number of 1MB section mappings */
+	atomic_t nr_lpage_map;		/* number of 64KB large page mappings */
+	atomic_t nr_spage_map;		/* number of 4KB small page mappings */
+	atomic_t nr_pgtable_flush;	/* number of page table cache flushes */
+	atomic_t nr_tlb_flush;		/* number of TLB invalidations */
+	atomic64_t map_time_ns;		/* time spent on batched mappings */
+};
+
+/*
+ * Page table entries written by a sequence of mappings or unmappings.
+ * Adjacent entries are accumulated and written back to memory with a single
+ * cache flush when the next entry is not adjacent or the batch is finished.
+ */
+struct sysmmu_pgtable_batch {
+	struct exynos_iommu_domain *domain;
+	sysmmu_pte_t *sent_start;	/* range of dirty lv1 entries */
+	sysmmu_pte_t *sent_end;
+	sysmmu_pte_t *pent_start;	/* range of dirty lv2 entries */
+	sysmmu_pte_t *pent_end;
+	ktime_t start;
 };
 
 /*
@@ -277,6 +299,9 @@ struct exynos_iommu_owner {
 
 struct tlb_priv_addr {
 	unsigned int cfg;
+	/* matching range set by exynos_sysmmu_preload(), end 0 if unset */
+	unsigned int start;
+	unsigned int end;
 };
 
 struct tlb_priv_id {
@@ -359,6 +384,7 @@ struct sysmmu_drvdata {
 	bool is_suspended;
 	bool hold_rpm_on_boot;
 	struct exynos_iommu_event_log log;
+	struct sysmmu_tlb_stat tlb_stat;
 	int no_rpm_control;
 };
 
@@ -370,6 +396,27 @@ struct exynos_vm_region {
 	u32 dummy_size;
 };
 
+/*
+ * IOVA ranges of recently freed regions are cached per size class in
+ * magazines and reused by allocations of the same size without searching
+ * the bitmap. A class covers sizes of (2^(order - 1), 2^order] pages.
+ */
+#define IOVMM_RCACHE_MIN_ORDER	6	/* 256KB */
+#define IOVMM_NR_RCACHES	9	/* up to 64MB */
+#define IOVMM_RCACHE_DEPTH	8
+
+struct iovmm_magazine {
+	unsigned int nr;
+	u32 index[IOVMM_RCACHE_DEPTH];	/* first page in the bitmap */
+	u32 vsize[IOVMM_RCACHE_DEPTH];	/* number of pages */
+};
+
+struct iovmm_rcache {
+	spinlock_t lock;
+	struct iovmm_magazine loaded;
+	struct iovmm_magazine prev;
+};
+
 struct exynos_iovmm {
 	struct iommu_domain *domain;	/* iommu domain for this iovmm */
 	size_t iovm_size;		/* iovm bitmap size per plane */
@@ -386,10 +433,26 @@ struct exynos_iovmm {
 	const char *domain_name;
 	struct iommu_group *group;
 	struct exynos_iommu_event_log log;
+	spinlock_t deferred_lock;	/* lock for deferred_list */
+	struct list_head deferred_list;	/* unmapped regions before TLB flush */
+	unsigned int nr_deferred;
+	struct delayed_work deferred_work;
+	struct iovmm_rcache rcaches[IOVMM_NR_RCACHES];
+	atomic_t rcache_pages;		/* pages held by rcaches */
+	atomic_t rcache_hit;
+	atomic_t rcache_miss;
 };
 
 void exynos_sysmmu_tlb_invalidate(struct iommu_domain *domain, dma_addr_t start,
 				  size_t size);
+void exynos_iommu_batch_start(struct iommu_domain *dom,
+			      struct sysmmu_pgtable_batch *batch);
+int exynos_iommu_map_batch(struct sysmmu_pgtable_batch *batch,
+			   dma_addr_t iova, phys_addr_t paddr, size_t size,
+			   int prot);
+void exynos_iommu_batch_finish(struct sysmmu_pgtable_batch *batch);
+size_t exynos_iommu_unmap_range(struct iommu_domain *dom,
+				dma_addr_t iova, size_t size);
 int exynos_iommu_map_userptr(struct iommu_domain *dom, unsigned long addr,
 			      dma_addr_t iova, size_t size, int prot);
 void exynos_iommu_unmap_userptr(struct iommu_domain *dom,
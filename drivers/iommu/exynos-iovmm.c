@@ -19,6 +19,8 @@
 #include <linux/err.h>
 #include <linux/debugfs.h>
 #include <linux/delay.h>
+#include <linux/math64.h>
+#include <linux/moduleparam.h>
 
 #include <linux/exynos_iovmm.h>
 
@@ -26,6 +28,136 @@
 
 #define sg_physically_continuous(sg) (sg_next(sg) == NULL)
 
+/* unmapped regions are kept out of allocation until TLB is invalidated */
+#define IOVMM_DEFERRED_UNMAP_MAX	16
+#define IOVMM_DEFERRED_UNMAP_DELAY	msecs_to_jiffies(10)
+
+static bool deferred_unmap = true;
+module_param(deferred_unmap, bool, 0644);
+MODULE_PARM_DESC(deferred_unmap, "defer and coalesce TLB invalidation on unmap");
+
+static int iovmm_rcache_class(u32 vsize)
+{
+	int cls = fls(vsize - 1) - IOVMM_RCACHE_MIN_ORDER;
+
+	if (cls < 0)
+		return 0;
+
+	return cls < IOVMM_NR_RCACHES ? cls : -1;
+}
+
+static bool iovmm_magazine_pop(struct iovmm_magazine *mag, u32 vsize, u32 *index)
+{
+	unsigned int i;
+
+	for (i = 0; i < mag->nr; i++) {
+		if (mag->vsize[i] != vsize)
+			continue;
+
+		*index = mag->index[i];
+		mag->nr--;
+		mag->index[i] = mag->index[mag->nr];
+		mag->vsize[i] = mag->vsize[mag->nr];
+		return true;
+	}
+
+	return false;
+}
+
+static void iovmm_magazine_release(struct exynos_iovmm *vmm,
+				   struct iovmm_magazine *mag)
+{
+	unsigned int i;
+
+	spin_lock(&vmm->bitmap_lock);
+	for (i = 0; i < mag->nr; i++) {
+		bitmap_clear(vmm->vm_map, mag->index[i], mag->vsize[i]);
+		atomic_sub(mag->vsize[i], &vmm->rcache_pages);
+	}
+	spin_unlock(&vmm->bitmap_lock);
+
+	mag->nr = 0;
+}
+
+/* Takes a cached range of exactly @vsize pages that is still set in bitmap */
+static bool iovmm_rcache_get(struct exynos_iovmm *vmm, u32 vsize, u32 *index)
+{
+	int cls = iovmm_rcache_class(vsize);
+	struct iovmm_rcache *rcache;
+	bool hit;
+
+	if (cls < 0)
+		return false;
+
+	rcache = &vmm->rcaches[cls];
+
+	spin_lock(&rcache->lock);
+	hit = iovmm_magazine_pop(&rcache->loaded, vsize, index) ||
+		iovmm_magazine_pop(&rcache->prev, vsize, index);
+	spin_unlock(&rcache->lock);
+
+	if (hit) {
+		atomic_sub(vsize, &vmm->rcache_pages);
+		atomic_inc(&vmm->rcache_hit);
+	} else {
+		atomic_inc(&vmm->rcache_miss);
+	}
+
+	return hit;
+}
+
+/*
+ * Keeps a freed range in the bitmap for reuse. A full loaded magazine is
+ * swapped with prev as drivers/iommu/iova.c does, but a full prev is
+ * returned to the bitmap instead of a depot. Returns false if the range is
+ * not cached.
+ */
+static bool iovmm_rcache_put(struct exynos_iovmm *vmm, u32 index, u32 vsize)
+{
+	int cls = iovmm_rcache_class(vsize);
+	struct iovmm_rcache *rcache;
+
+	if (cls < 0)
+		return false;
+
+	/* do not starve the allocator of IOVA space */
+	if (atomic_add_return(vsize, &vmm->rcache_pages) >
+			IOVM_NUM_PAGES(vmm->iovm_size) / 16) {
+		atomic_sub(vsize, &vmm->rcache_pages);
+		return false;
+	}
+
+	rcache = &vmm->rcaches[cls];
+
+	spin_lock(&rcache->lock);
+	if (rcache->loaded.nr == IOVMM_RCACHE_DEPTH) {
+		if (rcache->prev.nr == IOVMM_RCACHE_DEPTH)
+			iovmm_magazine_release(vmm, &rcache->prev);
+		swap(rcache->loaded, rcache->prev);
+	}
+
+	rcache->loaded.index[rcache->loaded.nr] = index;
+	rcache->loaded.vsize[rcache->loaded.nr] = vsize;
+	rcache->loaded.nr++;
+	spin_unlock(&rcache->lock);
+
+	return true;
+}
+
+static void iovmm_rcache_flush(struct exynos_iovmm *vmm)
+{
+	int i;
+
+	for (i = 0; i < IOVMM_NR_RCACHES; i++) {
+		struct iovmm_rcache *rcache = &vmm->rcaches[i];
+
+		spin_lock(&rcache->lock);
+		iovmm_magazine_release(vmm, &rcache->loaded);
+		iovmm_magazine_release(vmm, &rcache->prev);
+		spin_unlock(&rcache->lock);
+	}
+}
+
 /* alloc_iovm_region - Allocate IO virtual memory region
  * vmm: virtual memory allocator
  * size: total size to allocate vm region from @vmm.
@@ -45,7 +177,7 @@
  * (section_offset + page_offset). Returns 0 if this function is not able
  * to allocate IO virtual memory.
  */
-static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
+static dma_addr_t __alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 			size_t section_offset,
 			off_t page_offset)
 {
@@ -63,6 +195,9 @@ static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
 	align >>= PAGE_SHIFT;
 	section_offset >>= PAGE_SHIFT;
 
+	if (iovmm_rcache_get(vmm, vsize, &index))
+		goto found;
+
 	spin_lock(&vmm->bitmap_lock);
 again:
 	index = find_next_zero_bit(vmm->vm_map,
@@ -95,7 +230,7 @@ again:
 	bitmap_set(vmm->vm_map, index, vsize);
 
 	spin_unlock(&vmm->bitmap_lock);
-
+found:
 	vstart = (index << PAGE_SHIFT) + vmm->iova_start + page_offset;
 
 	region = kmalloc(sizeof(*region), GFP_KERNEL);
@@ -183,6 +318,108 @@ static void free_iovm_region(struct exynos_iovmm *vmm,
 	kfree(region);
 }
 
+/*
+ * Frees a region allocated by alloc_iovm_region() keeping its IOVA range in
+ * the size-class caches. Regions added by add_iovm_region() are not in the
+ * bitmap and must be freed by free_iovm_region().
+ */
+static void recycle_iovm_region(struct exynos_iovmm *vmm,
+				struct exynos_vm_region *region)
+{
+	if (!region)
+		return;
+
+	if (!iovmm_rcache_put(vmm,
+			(region->start - vmm->iova_start) >> PAGE_SHIFT,
+			region->size >> PAGE_SHIFT)) {
+		free_iovm_region(vmm, region);
+		return;
+	}
+
+	SYSMMU_EVENT_LOG_IOVMM_UNMAP(IOVMM_TO_LOG(vmm),
+			region->start, region->start + region->size);
+
+	kfree(region);
+}
+
+/*
+ * Invalidates TLB of all regions unmapped so far with a single range
+ * invalidation and returns them to the allocator. Range invalidation walks
+ * the TLB entries once whatever the size of the range is, so the gaps
+ * between the regions do not add to the cost.
+ */
+static void iovmm_flush_deferred(struct exynos_iovmm *vmm)
+{
+	struct exynos_vm_region *region, *tmp;
+	u32 start = ~0, end = 0;
+	LIST_HEAD(list);
+
+	spin_lock(&vmm->deferred_lock);
+	list_splice_init(&vmm->deferred_list, &list);
+	vmm->nr_deferred = 0;
+	spin_unlock(&vmm->deferred_lock);
+
+	if (list_empty(&list))
+		return;
+
+	list_for_each_entry(region, &list, node) {
+		start = min(start, region->start);
+		end = max(end, region->start + region->size);
+	}
+
+	exynos_sysmmu_tlb_invalidate(vmm->domain, start, end - start);
+
+	/* TODO: for sysmmu v6, remove it later */
+	/* 60us is required to guarantee that PTW ends itself */
+	udelay(60);
+
+	list_for_each_entry_safe(region, tmp, &list, node)
+		recycle_iovm_region(vmm, region);
+}
+
+static void iovmm_deferred_work(struct work_struct *work)
+{
+	struct exynos_iovmm *vmm = container_of(to_delayed_work(work),
+					struct exynos_iovmm, deferred_work);
+
+	iovmm_flush_deferred(vmm);
+}
+
+static void iovmm_defer_unmap(struct exynos_iovmm *vmm,
+			      struct exynos_vm_region *region)
+{
+	unsigned int nr;
+
+	spin_lock(&vmm->deferred_lock);
+	list_add_tail(&region->node, &vmm->deferred_list);
+	nr = ++vmm->nr_deferred;
+	spin_unlock(&vmm->deferred_lock);
+
+	if (nr >= IOVMM_DEFERRED_UNMAP_MAX)
+		iovmm_flush_deferred(vmm);
+	else if (nr == 1)
+		queue_delayed_work(system_unbound_wq, &vmm->deferred_work,
+				   IOVMM_DEFERRED_UNMAP_DELAY);
+}
+
+static dma_addr_t alloc_iovm_region(struct exynos_iovmm *vmm, size_t size,
+			size_t section_offset,
+			off_t page_offset)
+{
+	dma_addr_t start;
+
+	start = __alloc_iovm_region(vmm, size, section_offset, page_offset);
+	if (!start && (READ_ONCE(vmm->nr_deferred) ||
+		       atomic_read(&vmm->rcache_pages))) {
+		iovmm_flush_deferred(vmm);
+		iovmm_rcache_flush(vmm);
+		start = __alloc_iovm_region(vmm, size, section_offset,
+					    page_offset);
+	}
+
+	return start;
+}
+
 static dma_addr_t add_iovm_region(struct exynos_iovmm *vmm,
 					dma_addr_t start, size_t size)
 {
@@ -226,6 +463,10 @@ static void show_iovm_regions(struct exynos_iovmm *vmm)
 				pos->section_off, pos->dummy_size);
 	}
 	spin_unlock(&vmm->vmlist_lock);
+	pr_err("CACHED: %#x bytes, hit %d, miss %d\n",
+			atomic_read(&vmm->rcache_pages) << PAGE_SHIFT,
+			atomic_read(&vmm->rcache_hit),
+			atomic_read(&vmm->rcache_miss));
 	pr_err("END OF LISTING IOVMM REGIONS...\n");
 }
 
@@ -293,6 +534,7 @@ dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
 	int idx;
 	struct scatterlist *tsg;
 	struct exynos_vm_region *region;
+	struct sysmmu_pgtable_batch batch;
 
 	if (vmm == NULL) {
 		dev_err(dev, "%s: IOVMM not found\n", __func__);
@@ -340,6 +582,9 @@ dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
 
 	addr = start - start_off;
 
+	/* page table entries are written back at once after the loop */
+	exynos_iommu_batch_start(vmm->domain, &batch);
+
 	do {
 		phys_addr_t phys;
 		size_t len;
@@ -370,7 +615,7 @@ dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
 		if (len > (size - mapped_size))
 			len = size - mapped_size;
 
-		ret = iommu_map(vmm->domain, addr, phys, len, prot);
+		ret = exynos_iommu_map_batch(&batch, addr, phys, len, prot);
 		if (ret) {
 			dev_err(dev, "iommu_map failed w/ err: %d\n", ret);
 			break;
@@ -380,6 +625,8 @@ dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
 		mapped_size += len;
 	} while ((sg = sg_next(sg)) && (mapped_size < size));
 
+	exynos_iommu_batch_finish(&batch);
+
 	BUG_ON(mapped_size > size);
 
 	if (mapped_size < size) {
@@ -425,7 +672,7 @@ dma_addr_t iovmm_map(struct device *dev, struct scatterlist *sg, off_t offset,
 	return start;
 
 err_map_map:
-	iommu_unmap(vmm->domain, start - start_off, mapped_size);
+	exynos_iommu_unmap_range(vmm->domain, start - start_off, mapped_size);
 	free_iovm_region(vmm, remove_iovm_region(vmm, start));
 
 	dev_err(dev,
@@ -476,7 +723,8 @@ void iovmm_unmap(struct device *dev, dma_addr_t iova)
 			kfree(region);
 			return;
 		}
-		unmap_size = iommu_unmap(vmm->domain, start & SPAGE_MASK, size);
+		unmap_size = exynos_iommu_unmap_range(vmm->domain,
+						start & SPAGE_MASK, size);
 		if (unlikely(unmap_size != size)) {
 			dev_err(dev,
 				"Failed to unmap REGION of %#x:\n", start);
@@ -488,16 +736,21 @@ void iovmm_unmap(struct device *dev, dma_addr_t iova)
 			return;
 		}
 
+		dev_dbg(dev, "IOVMM: Unmapped %#x bytes from %#x.\n",
+				(unsigned int)unmap_size, (unsigned int)iova);
+
+		if (deferred_unmap) {
+			iovmm_defer_unmap(vmm, region);
+			return;
+		}
+
 		exynos_sysmmu_tlb_invalidate(vmm->domain, region->start, region->size);
 
 		/* TODO: for sysmmu v6, remove it later */
 		/* 60us is required to guarantee that PTW ends itself */
 		udelay(60);
 
-		free_iovm_region(vmm, region);
-
-		dev_dbg(dev, "IOVMM: Unmapped %#x bytes from %#x.\n",
-				(unsigned int)unmap_size, (unsigned int)iova);
+		recycle_iovm_region(vmm, region);
 	} else {
 		dev_err(dev, "IOVMM: No IOVM region %pa to free.\n", &iova);
 	}
@@ -609,7 +862,7 @@ void exynos_iovmm_unmap_userptr(struct device *dev, dma_addr_t iova)
 		exynos_iommu_unmap_userptr(vmm->domain,
 					   start & SPAGE_MASK, size);
 
-		free_iovm_region(vmm, region);
+		recycle_iovm_region(vmm, region);
 	} else {
 		dev_err(dev, "IOVMM: No IOVM region %pa to free.\n", &iova);
 	}
@@ -702,6 +955,7 @@ core_initcall(exynos_iovmm_create_debugfs);
 static int iovmm_debug_show(struct seq_file *s, void *unused)
 {
 	struct exynos_iovmm *vmm = s->private;
+	struct exynos_iommu_domain *domain = to_exynos_domain(vmm->domain);
 
 	seq_printf(s, "%10.s  %10.s  %10.s  %6.s\n",
 			"VASTART", "SIZE", "FREE", "CHUNKS");
@@ -717,6 +971,27 @@ static int iovmm_debug_show(struct seq_file *s, void *unused)
 	seq_printf(s, "Total number of unmappings: %d\n", vmm->num_unmap);
 	spin_unlock(&vmm->vmlist_lock);
 
+	/* a TLB entry covers one mapping, fewer small pages means fewer misses */
+	seq_printf(s, "Mapped 1MB sections       : %d\n",
+		   atomic_read(&domain->nr_sect_map));
+	seq_printf(s, "Mapped 64KB large pages   : %d\n",
+		   atomic_read(&domain->nr_lpage_map));
+	seq_printf(s, "Mapped 4KB small pages    : %d\n",
+		   atomic_read(&domain->nr_spage_map));
+	seq_printf(s, "Page table flushes        : %d\n",
+		   atomic_read(&domain->nr_pgtable_flush));
+	seq_printf(s, "TLB invalidations         : %d\n",
+		   atomic_read(&domain->nr_tlb_flush));
+	seq_printf(s, "Batched mapping time (us) : %llu\n",
+		   div_u64(atomic64_read(&domain->map_time_ns), NSEC_PER_USEC));
+	seq_printf(s, "Regions pending TLB flush : %u\n",
+		   READ_ONCE(vmm->nr_deferred));
+	seq_printf(s, "Cached IOVA (KB)          : %d\n",
+		   atomic_read(&vmm->rcache_pages) << (PAGE_SHIFT - 10));
+	seq_printf(s, "IOVA cache hit / miss     : %d / %d\n",
+		   atomic_read(&vmm->rcache_hit),
+		   atomic_read(&vmm->rcache_miss));
+
 	return 0;
 }
 
@@ -730,11 +1005,20 @@ static ssize_t iovmm_debug_write(struct file *filp, const char __user *p,
 {
 	struct seq_file *s = filp->private_data;
 	struct exynos_iovmm *vmm = s->private;
+	struct exynos_iommu_domain *domain = to_exynos_domain(vmm->domain);
 	/* clears the map count in IOVMM */
 	spin_lock(&vmm->vmlist_lock);
 	vmm->num_map = 0;
 	vmm->num_unmap = 0;
 	spin_unlock(&vmm->vmlist_lock);
+	atomic_set(&domain->nr_sect_map, 0);
+	atomic_set(&domain->nr_lpage_map, 0);
+	atomic_set(&domain->nr_spage_map, 0);
+	atomic_set(&domain->nr_pgtable_flush, 0);
+	atomic_set(&domain->nr_tlb_flush, 0);
+	atomic64_set(&domain->map_time_ns, 0);
+	atomic_set(&vmm->rcache_hit, 0);
+	atomic_set(&vmm->rcache_miss, 0);
 	return len;
 }
 
@@ -760,6 +1044,7 @@ struct exynos_iovmm *exynos_create_single_iovmm(const char *name,
 {
 	struct exynos_iovmm *vmm;
 	int ret = 0;
+	int i;
 
 	vmm = kzalloc(sizeof(*vmm), GFP_KERNEL);
 	if (!vmm) {
@@ -793,8 +1078,14 @@ struct exynos_iovmm *exynos_create_single_iovmm(const char *name,
 
 	spin_lock_init(&vmm->vmlist_lock);
 	spin_lock_init(&vmm->bitmap_lock);
+	spin_lock_init(&vmm->deferred_lock);
 
 	INIT_LIST_HEAD(&vmm->regions_list);
+	INIT_LIST_HEAD(&vmm->deferred_list);
+	INIT_DELAYED_WORK(&vmm->deferred_work, iovmm_deferred_work);
+
+	for (i = 0; i < IOVMM_NR_RCACHES; i++)
+		spin_lock_init(&vmm->rcaches[i].lock);
 
 	vmm->domain_name = name;
 
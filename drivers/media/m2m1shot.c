@@ -28,6 +28,8 @@
 #include <linux/dma-buf.h>
 #include <linux/vmalloc.h>
 #include <linux/sched.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 
 #include <media/m2m1shot.h>
 
@@ -438,6 +440,137 @@ err:
 	return (task->state == M2M1SHOT_BUFSTATE_DONE) ? 0 : -EINVAL;
 }
 
+/*
+ * Waits for a task in a batch. A task behind a stuck task never reaches H/W
+ * and is just removed from the queue when it times out.
+ */
+static void m2m1shot_batch_wait_task(struct m2m1shot_device *m21dev,
+				struct m2m1shot_context *ctx,
+				struct m2m1shot_task *task)
+{
+	unsigned long flags;
+	bool running;
+
+	if (m21dev->timeout_jiffies == -1) {
+		wait_for_completion(&task->complete);
+		return;
+	}
+
+	if (wait_for_completion_timeout(&task->complete,
+					m21dev->timeout_jiffies))
+		return;
+
+	spin_lock_irqsave(&m21dev->lock_task, flags);
+	running = (m21dev->current_task == task);
+	if (!running && (task->state == M2M1SHOT_BUFSTATE_READY)) {
+		list_del_init(&task->task_node);
+		task->state = M2M1SHOT_BUFSTATE_TIMEDOUT;
+		spin_unlock_irqrestore(&m21dev->lock_task, flags);
+		return;
+	}
+	spin_unlock_irqrestore(&m21dev->lock_task, flags);
+
+	if (!running) { /* finished just after timed out */
+		wait_for_completion(&task->complete);
+		return;
+	}
+
+	m2m1shot_task_cancel(m21dev, task, M2M1SHOT_BUFSTATE_TIMEDOUT);
+
+	m21dev->ops->timeout_task(ctx, task);
+
+	dev_notice(m21dev->dev, "%s: %u msecs timed out\n", __func__,
+			jiffies_to_msecs(m21dev->timeout_jiffies));
+}
+
+static int m2m1shot_process_batch(struct m2m1shot_context *ctx,
+			struct m2m1shot_task *tasks, unsigned int num_tasks,
+			struct m2m1shot_batch *batch)
+{
+	struct m2m1shot_device *m21dev = ctx->m21dev;
+	unsigned long flags;
+	unsigned int i, prepared;
+	ktime_t begin;
+	int ret = 0;
+
+	/*
+	 * Formats and operation are configured to the context once per task.
+	 * They should not be changed in a batch because the tasks are queued
+	 * before the first one is processed.
+	 */
+	for (i = 1; i < num_tasks; i++) {
+		if (memcmp(&tasks[i].task.fmt_out, &tasks[0].task.fmt_out,
+				sizeof(tasks[0].task.fmt_out)) ||
+			memcmp(&tasks[i].task.fmt_cap, &tasks[0].task.fmt_cap,
+				sizeof(tasks[0].task.fmt_cap)) ||
+			memcmp(&tasks[i].task.op, &tasks[0].task.op,
+				sizeof(tasks[0].task.op))) {
+			dev_err(m21dev->dev,
+				"%s: task %u has different format\n",
+				__func__, i);
+			return -EINVAL;
+		}
+	}
+
+	kref_get(&ctx->kref);
+
+	mutex_lock(&ctx->mutex);
+
+	for (prepared = 0; prepared < num_tasks; prepared++) {
+		struct m2m1shot_task *task = &tasks[prepared];
+
+		INIT_LIST_HEAD(&task->task_node);
+		init_completion(&task->complete);
+
+		ret = m2m1shot_prepare_task(m21dev, ctx, task);
+		if (ret)
+			goto err;
+
+		task->ctx = ctx;
+		task->state = M2M1SHOT_BUFSTATE_READY;
+	}
+
+	begin = ktime_get();
+
+	spin_lock_irqsave(&m21dev->lock_task, flags);
+	for (i = 0; i < num_tasks; i++)
+		list_add_tail(&tasks[i].task_node, &m21dev->tasks);
+	spin_unlock_irqrestore(&m21dev->lock_task, flags);
+
+	/* the next tasks are run by m2m1shot_task_finish() from the client */
+	m2m1shot_task_schedule(m21dev);
+
+	for (i = 0; i < num_tasks; i++)
+		m2m1shot_batch_wait_task(m21dev, ctx, &tasks[i]);
+
+	batch->elapsed_us = ktime_us_delta(ktime_get(), begin);
+
+	for (i = 0; i < num_tasks; i++) {
+		BUG_ON(tasks[i].state == M2M1SHOT_BUFSTATE_READY);
+		if (tasks[i].state == M2M1SHOT_BUFSTATE_DONE)
+			batch->num_done++;
+	}
+
+	spin_lock_irqsave(&m21dev->lock_task, flags);
+	m21dev->batch_count++;
+	m21dev->batch_tasks += num_tasks;
+	m21dev->batch_time_us += batch->elapsed_us;
+	if (num_tasks > m21dev->batch_max)
+		m21dev->batch_max = num_tasks;
+	spin_unlock_irqrestore(&m21dev->lock_task, flags);
+err:
+	for (i = 0; i < prepared; i++)
+		m2m1shot_finish_task(m21dev, ctx, &tasks[i]);
+
+	mutex_unlock(&ctx->mutex);
+
+	kref_put(&ctx->kref, m2m1shot_destroy_context);
+
+	if (ret)
+		return ret;
+	return (batch->num_done == num_tasks) ? 0 : -EINVAL;
+}
+
 static int m2m1shot_open(struct inode *inode, struct file *filp)
 {
 	struct m2m1shot_device *m21dev = container_of(filp->private_data,
@@ -513,6 +646,67 @@ static long m2m1shot_ioctl(struct file *filp,
 
 		return ret;
 	}
+	case M2M1SHOT_IOC_PROCESS_BATCH:
+	{
+		struct m2m1shot_batch batch;
+		struct m2m1shot __user *utasks;
+		struct m2m1shot_task *tasks;
+		unsigned int i;
+		int ret;
+
+		if (copy_from_user(&batch, (void __user *)arg, sizeof(batch))) {
+			dev_err(m21dev->dev,
+				"%s: Failed to read batch\n", __func__);
+			return -EFAULT;
+		}
+
+		if (!batch.num_tasks || batch.num_tasks > M2M1SHOT_MAX_BATCH) {
+			dev_err(m21dev->dev, "%s: Invalid number of tasks %u\n",
+				__func__, batch.num_tasks);
+			return -EINVAL;
+		}
+
+		tasks = kcalloc(batch.num_tasks, sizeof(*tasks), GFP_KERNEL);
+		if (!tasks)
+			return -ENOMEM;
+
+		utasks = (struct m2m1shot __user *)batch.tasks;
+		for (i = 0; i < batch.num_tasks; i++) {
+			if (copy_from_user(&tasks[i].task, &utasks[i],
+						sizeof(tasks[i].task))) {
+				dev_err(m21dev->dev,
+					"%s: Failed to read userdata\n",
+					__func__);
+				kfree(tasks);
+				return -EFAULT;
+			}
+		}
+
+		batch.num_done = 0;
+		batch.elapsed_us = 0;
+
+		ret = m2m1shot_process_batch(ctx, tasks, batch.num_tasks,
+						&batch);
+
+		for (i = 0; i < batch.num_tasks; i++) {
+			if (copy_to_user(&utasks[i], &tasks[i].task,
+						sizeof(tasks[i].task))) {
+				ret = -EFAULT;
+				break;
+			}
+		}
+
+		kfree(tasks);
+
+		if (copy_to_user((void __user *)arg, &batch, sizeof(batch)))
+			ret = -EFAULT;
+
+		if (ret == -EFAULT)
+			dev_err(m21dev->dev,
+				"%s: Failed to write userdata\n", __func__);
+
+		return ret;
+	}
 	case M2M1SHOT_IOC_CUSTOM:
 	{
 		struct m2m1shot_custom_data data;
@@ -759,6 +953,38 @@ static long m2m1shot_compat_ioctl32(struct file *filp,
 }
 #endif
 
+static ssize_t batch_stat_show(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct miscdevice *misc = dev_get_drvdata(dev);
+	struct m2m1shot_device *m21dev =
+			container_of(misc, struct m2m1shot_device, misc);
+	unsigned long flags, count, tasks;
+	unsigned int max;
+	u64 time_us;
+
+	spin_lock_irqsave(&m21dev->lock_task, flags);
+	count = m21dev->batch_count;
+	tasks = m21dev->batch_tasks;
+	time_us = m21dev->batch_time_us;
+	max = m21dev->batch_max;
+	spin_unlock_irqrestore(&m21dev->lock_task, flags);
+
+	return scnprintf(buf, PAGE_SIZE,
+		"batches %lu tasks %lu max %u time %llu us avg %llu us/batch %llu tasks/s\n",
+		count, tasks, max, time_us,
+		count ? div64_u64(time_us, count) : 0,
+		time_us ? div64_u64((u64)tasks * USEC_PER_SEC, time_us) : 0);
+}
+
+static DEVICE_ATTR_RO(batch_stat);
+
+static struct attribute *m2m1shot_attrs[] = {
+	&dev_attr_batch_stat.attr,
+	NULL,
+};
+ATTRIBUTE_GROUPS(m2m1shot);
+
 static const struct file_operations m2m1shot_fops = {
 	.owner          = THIS_MODULE,
 	.open           = m2m1shot_open,
@@ -814,9 +1040,7 @@ struct m2m1shot_device *m2m1shot_create_device(struct device *dev,
 	m21dev->misc.minor = MISC_DYNAMIC_MINOR;
 	m21dev->misc.name = name;
 	m21dev->misc.fops = &m2m1shot_fops;
-	ret = misc_register(&m21dev->misc);
-	if (ret)
-		goto err_misc;
+	m21dev->misc.groups = m2m1shot_groups;
 
 	INIT_LIST_HEAD(&m21dev->tasks);
 	INIT_LIST_HEAD(&m21dev->contexts);
@@ -824,6 +1048,10 @@ struct m2m1shot_device *m2m1shot_create_device(struct device *dev,
 	spin_lock_init(&m21dev->lock_task);
 	spin_lock_init(&m21dev->lock_ctx);
 
+	ret = misc_register(&m21dev->misc);
+	if (ret)
+		goto err_misc;
+
 	m21dev->dev = dev;
 	m21dev->ops = ops;
 	m21dev->timeout_jiffies = timeout_jiffies;
@@ -18,6 +18,7 @@
 #include <linux/interrupt.h>
 #include <linux/clk.h>
 #include <linux/slab.h>
+#include <linux/math64.h>
 #include <linux/pm_runtime.h>
 #include <linux/exynos_iovmm.h>
 #include <linux/smc.h>
@@ -41,6 +42,25 @@ module_param_named(gdc_log_level, gdc_log_level, uint, S_IRUGO | S_IWUSR);
 int __gdc_measure_hw_latency;
 module_param_named(gdc_measure_hw_latency, __gdc_measure_hw_latency, int, 0644);
 
+/*
+ * Size of the processing block by the width of the output frame.
+ * The pixel cache fetches the source of a block at a time, and a wider
+ * block of the same area makes longer bursts and less block switches on
+ * the source lines of large frames. 64x64 is kept up to FHD.
+ */
+static bool gdc_pro_size_adaptive = true;
+module_param(gdc_pro_size_adaptive, bool, 0644);
+
+static const struct gdc_pro_size {
+	u32 max_width;
+	u32 width;	/* multiples of 32, 32 ~ 512 */
+	u32 height;	/* multiples of 8, 8 ~ 512 */
+} gdc_pro_sizes[] = {
+	{ 1920,		64,	64 },
+	{ 4096,		128,	32 },
+	{ UINT_MAX,	256,	16 },
+};
+
 struct vb2_gdc_buffer {
 	struct v4l2_m2m_buffer mb;
 	struct gdc_ctx *ctx;
@@ -962,6 +982,9 @@ static int gdc_release(struct file *file)
 		clk_unprepare(gdc->pclk);
 	v4l2_fh_del(&ctx->fh);
 	v4l2_fh_exit(&ctx->fh);
+	/* a new ctx may be allocated at the same address */
+	if (gdc->grid_ctx == ctx)
+		camerapp_gdc_grid_invalidate(gdc);
 	kfree(ctx);
 
 	return 0;
@@ -1029,6 +1052,7 @@ static void gdc_watchdog(unsigned long arg)
 	gdc_dbg("timeout watchdog\n");
 	if (atomic_read(&gdc->wdt.cnt) >= GDC_WDT_CNT) {
 		camerapp_hw_gdc_sw_reset(gdc->regs_base);
+		camerapp_gdc_grid_invalidate(gdc);
 
 		atomic_set(&gdc->wdt.cnt, 0);
 		clear_bit(DEV_RUN, &gdc->state);
@@ -1097,6 +1121,22 @@ static void gdc_set_prefetch_buffers(struct device *dev, struct gdc_ctx *ctx)
 		pb_reg[i++].config = GDC_DST_PBCONFIG;
 	}
 }
+static void gdc_set_pro_size(struct gdc_ctx *ctx)
+{
+	const struct gdc_pro_size *size = &gdc_pro_sizes[0];
+	int i;
+
+	if (gdc_pro_size_adaptive) {
+		for (i = 0; i < ARRAY_SIZE(gdc_pro_sizes) - 1; i++)
+			if (ctx->d_frame.width <= gdc_pro_sizes[i].max_width)
+				break;
+		size = &gdc_pro_sizes[i];
+	}
+
+	ctx->pro_width = size->width;
+	ctx->pro_height = size->height;
+}
+
 static int gdc_run_next_job(struct gdc_dev *gdc)
 {
 	unsigned long flags;
@@ -1144,6 +1184,7 @@ static int gdc_run_next_job(struct gdc_dev *gdc)
 	gdc_dbg("gdc sw reset\n");
 
 	camerapp_gdc_grid_setting(gdc);
+	gdc_set_pro_size(ctx);
 
 	camerapp_hw_gdc_update_param(gdc->regs_base, gdc);
 	gdc_dbg("gdc tpu param update done\n");
@@ -1166,6 +1207,7 @@ static int gdc_run_next_job(struct gdc_dev *gdc)
 		svb->ktime = ktime_get();
 	}
 
+	gdc->ktime_start = ktime_get();
 	camerapp_hw_gdc_start(gdc->regs_base);
 
 	return 0;
@@ -1182,6 +1224,18 @@ static int gdc_add_context_and_run(struct gdc_dev *gdc, struct gdc_ctx *ctx)
 	return gdc_run_next_job(gdc);
 }
 
+/* called with slock held */
+static void gdc_account_latency(struct gdc_dev *gdc)
+{
+	u32 latency = (u32)ktime_us_delta(ktime_get(), gdc->ktime_start);
+
+	gdc->frames++;
+	gdc->latency_total_us += latency;
+	gdc->latency_last_us = latency;
+	if (latency > gdc->latency_max_us)
+		gdc->latency_max_us = latency;
+}
+
 static irqreturn_t gdc_irq_handler(int irq, void *priv)
 {
 	struct gdc_dev *gdc = priv;
@@ -1213,6 +1267,8 @@ static irqreturn_t gdc_irq_handler(int irq, void *priv)
 
 		gdc_clk_power_disable(gdc);
 
+		gdc_account_latency(gdc);
+
 		clear_bit(CTX_RUN, &ctx->flags);
 
 		BUG_ON(ctx != v4l2_m2m_get_curr_priv(gdc->m2m.m2m_dev));
@@ -1612,6 +1668,9 @@ static int gdc_runtime_resume(struct device *dev)
 	if (gdc->qosreq_intcam_level > 0)
 		pm_qos_update_request(&gdc->qosreq_intcam, gdc->qosreq_intcam_level);
 
+	/* the SFRs are lost while the power domain is off */
+	camerapp_gdc_grid_invalidate(gdc);
+
 	return 0;
 }
 
@@ -1629,6 +1688,27 @@ static const struct dev_pm_ops gdc_pm_ops = {
 	SET_RUNTIME_PM_OPS(NULL, gdc_runtime_resume, gdc_runtime_suspend)
 };
 
+static ssize_t frame_latency_show(struct device *dev,
+				  struct device_attribute *attr, char *buf)
+{
+	struct gdc_dev *gdc = dev_get_drvdata(dev);
+	unsigned long flags;
+	u64 frames, total;
+	u32 last, max;
+
+	spin_lock_irqsave(&gdc->slock, flags);
+	frames = gdc->frames;
+	total = gdc->latency_total_us;
+	last = gdc->latency_last_us;
+	max = gdc->latency_max_us;
+	spin_unlock_irqrestore(&gdc->slock, flags);
+
+	return scnprintf(buf, PAGE_SIZE,
+			"frames %llu avg %llu us last %u us max %u us\n",
+			frames, frames ? div64_u64(total, frames) : 0, last, max);
+}
+static DEVICE_ATTR_RO(frame_latency);
+
 static int gdc_probe(struct platform_device *pdev)
 {
 	struct gdc_dev *gdc;
@@ -1754,6 +1834,9 @@ static int gdc_probe(struct platform_device *pdev)
 
 	iovmm_set_fault_handler(&pdev->dev, gdc_sysmmu_fault_handler, gdc);
 
+	if (device_create_file(&pdev->dev, &dev_attr_frame_latency))
+		dev_warn(&pdev->dev, "failed to create frame_latency\n");
+
 	dev_info(&pdev->dev,
 		"Driver probed successfully(version: %08x)\n",
 		gdc->version);
@@ -1778,6 +1861,8 @@ static int gdc_remove(struct platform_device *pdev)
 {
 	struct gdc_dev *gdc = platform_get_drvdata(pdev);
 
+	device_remove_file(gdc->dev, &dev_attr_frame_latency);
+
 	iovmm_deactivate(gdc->dev);
 
 	gdc_clk_put(gdc);
@@ -8,34 +8,62 @@
  * published by the Free Software Foundation.
  */
 
+#include <linux/module.h>
+#include <linux/string.h>
+
 #include "camerapp-gdc.h"
 #include "camerapp-hw-api-gdc.h"
 #include <exynos-fimc-is-sensor.h>
 
+/*
+ * The grid tables are rebuilt only after V4L2_CID_CAMERAPP_GDC_GRID_CONTROL,
+ * and are loaded to the SFRs only when they are not the ones loaded by the
+ * previous job. Most of the streams set the same grid for every frame.
+ */
+static bool gdc_grid_cache = true;
+module_param(gdc_grid_cache, bool, 0644);
+
+void camerapp_gdc_grid_invalidate(struct gdc_dev *gdc)
+{
+	gdc->grid_ctx = NULL;
+}
+
 void camerapp_gdc_grid_setting(struct gdc_dev *gdc)
 {
-	int i, j;
 	struct gdc_ctx *ctx = gdc->current_ctx;
+	struct gdc_grid_param *grid_param = &ctx->grid_param;
+	bool changed;
 
-	if (ctx->crop_param.use_calculated_grid) {
-		for (i = 0; i < GRID_Y_SIZE; i++) {
-			for (j = 0; j < GRID_X_SIZE; j++) {
-				ctx->grid_param.dx[i][j] = ctx->crop_param.calculated_grid_x[i][j];
-				ctx->grid_param.dy[i][j] = ctx->crop_param.calculated_grid_y[i][j];
+	if (!grid_param->is_valid) {
+		if (ctx->crop_param.use_calculated_grid) {
+			changed = memcmp(grid_param->dx, ctx->crop_param.calculated_grid_x,
+					sizeof(grid_param->dx)) ||
+				memcmp(grid_param->dy, ctx->crop_param.calculated_grid_y,
+					sizeof(grid_param->dy));
+			if (changed) {
+				memcpy(grid_param->dx, ctx->crop_param.calculated_grid_x,
+					sizeof(grid_param->dx));
+				memcpy(grid_param->dy, ctx->crop_param.calculated_grid_y,
+					sizeof(grid_param->dy));
 			}
-		}
-		gdc_dbg("use calculated grid table\n");
-	} else {
-		for (i = 0; i < GRID_Y_SIZE; i++) {
-			for (j = 0; j < GRID_X_SIZE; j++) {
-				ctx->grid_param.dx[i][j] = 0;
-				ctx->grid_param.dy[i][j] = 0;
+			gdc_dbg("use calculated grid table\n");
+		} else {
+			changed = memchr_inv(grid_param->dx, 0, sizeof(grid_param->dx)) ||
+				memchr_inv(grid_param->dy, 0, sizeof(grid_param->dy));
+			if (changed) {
+				memset(grid_param->dx, 0, sizeof(grid_param->dx));
+				memset(grid_param->dy, 0, sizeof(grid_param->dy));
 			}
 		}
+
+		if (changed && gdc->grid_ctx == ctx)
+			camerapp_gdc_grid_invalidate(gdc);
+
+		grid_param->is_valid = true;
 	}
 
-	ctx->grid_param.is_valid = true;
+	grid_param->need_load = !gdc_grid_cache || gdc->grid_ctx != ctx;
+	gdc->grid_ctx = ctx;
 
 	return;
 }
-
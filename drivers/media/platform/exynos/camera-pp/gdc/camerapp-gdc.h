@@ -188,6 +188,7 @@ struct gdc_wdt {
 
 struct gdc_grid_param {
 	bool is_valid;
+	bool need_load;		/* the tables in the SFRs are not of this ctx */
 	u32 prev_width;
 	u32 prev_height;
 	int dx[GRID_Y_SIZE][GRID_X_SIZE];
@@ -223,6 +224,8 @@ struct gdc_crop_param {
  * @g_alpha:		global alpha value
  * @color_fill:		enable color fill
  * @flags:		context state flags
+ * @pro_width:		width of the processing block
+ * @pro_height:		height of the processing block
  */
 struct gdc_ctx {
 	struct list_head		node;
@@ -234,6 +237,8 @@ struct gdc_ctx {
 	unsigned long		flags;
 	struct gdc_grid_param		grid_param;
 	struct gdc_crop_param		crop_param;
+	u32				pro_width;
+	u32				pro_height;
 };
 
 struct gdc_priv_buf {
@@ -263,6 +268,12 @@ struct gdc_priv_buf {
  * @version:	IP version number
  * @cfw:	cfw flag
  * @pb_disable:	prefetch-buffer disable flag
+ * @grid_ctx:	ctx whose grid tables are in the SFRs
+ * @ktime_start: time the current job is started
+ * @frames:	number of frames done
+ * @latency_total_us: sum of the latencies of the frames done
+ * @latency_last_us: latency of the last frame
+ * @latency_max_us: maximum latency of a frame
  */
 struct gdc_dev {
 	struct device			*dev;
@@ -288,6 +299,12 @@ struct gdc_dev {
 	s32				qosreq_intcam_level;
 	int				dev_id;
 	u32				version;
+	struct gdc_ctx			*grid_ctx;
+	ktime_t				ktime_start;
+	u64				frames;
+	u64				latency_total_us;
+	u32				latency_last_us;
+	u32				latency_max_us;
 };
 
 static inline struct gdc_frame *ctx_get_frame(struct gdc_ctx *ctx,
@@ -316,6 +333,7 @@ void camerapp_hw_gdc_status_read(void __iomem *base_addr);
 void camerapp_gdc_sfr_dump(void __iomem *base_addr);
 u32 camerapp_hw_gdc_get_intr_status_and_clear(void __iomem *base_addr);
 void camerapp_gdc_grid_setting(struct gdc_dev *gdc);
+void camerapp_gdc_grid_invalidate(struct gdc_dev *gdc);
 
 #ifdef CONFIG_VIDEOBUF2_DMA_SG
 static inline dma_addr_t gdc_get_dma_address(struct vb2_buffer *vb2_buf, u32 plane)
@@ -85,7 +85,7 @@ void camerapp_hw_gdc_update_grid_param(void __iomem *base_addr, struct gdc_grid_
 	u32 sfr_start_x = 0x0100;
 	u32 sfr_start_y = 0x0200;
 
-	if (grid_param->is_valid == true) {
+	if (grid_param->is_valid == true && grid_param->need_load) {
 		for (i = 0; i < 7; i++) {
 			for (j = 0; j < 9; j++) {
 				writel((u32)grid_param->dx[i][j], base_addr + sfr_start_x + sfr_offset * i * j);
@@ -234,9 +234,9 @@ void camerapp_hw_gdc_update_param(void __iomem *base_addr, struct gdc_dev *gdc)
 	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_PXC_PIXEL_FORMAT], &gdc_fields[GDC_F_ENDIAN], 0);	/* 0 : Little endian  / 1:  Big endian */
 
 	/* The values are multiples of 32, value : 32 ~ 512 */
-	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_WIDTH], 64);
+	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_WIDTH], gdc->current_ctx->pro_width);
 	/* The values are multiples of 8, value : 8 ~ 512 */
-	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_HEIGHT], 64);
+	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_HEIGHT], gdc->current_ctx->pro_height);
 
 	camerapp_sfr_set_reg(base_addr, &gdc_regs[GDC_R_GDC_PROCESSING], 1);
 
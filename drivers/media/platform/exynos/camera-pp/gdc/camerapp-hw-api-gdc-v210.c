@@ -86,7 +86,7 @@ void camerapp_hw_gdc_update_grid_param(void __iomem *base_addr, struct gdc_grid_
 	u32 sfr_start_x = 0x1000;
 	u32 sfr_start_y = 0x3000;
 
-	if (grid_param->is_valid == true) {
+	if (grid_param->is_valid == true && grid_param->need_load) {
 		for (i = 0; i < GRID_Y_SIZE; i++) {
 			for (j = 0; j < GRID_X_SIZE; j++) {
                 u32 cal_sfr_offset = (sfr_offset * i * GRID_X_SIZE) + (sfr_offset * j);
@@ -581,9 +581,9 @@ void camerapp_hw_gdc_update_param(void __iomem *base_addr, struct gdc_dev *gdc)
 	camerapp_hw_gdc_set_pixel_minmax(base_addr, luma_min, luma_max, chroma_min, chroma_max);
 
 	/* The values are multiples of 32, value : 32 ~ 512 */
-	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_WIDTH], 64);
+	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_WIDTH], gdc->current_ctx->pro_width);
 	/* The values are multiples of 8, value : 8 ~ 512 */
-	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_HEIGHT], 64);
+	camerapp_sfr_set_field(base_addr, &gdc_regs[GDC_R_GDC_PRO_SIZE], &gdc_fields[GDC_F_GDC_PRO_HEIGHT], gdc->current_ctx->pro_height);
 	camerapp_sfr_set_reg(base_addr, &gdc_regs[GDC_R_GDC_PROCESSING], 1);
 }
 
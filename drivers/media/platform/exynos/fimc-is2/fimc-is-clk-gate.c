@@ -64,6 +64,54 @@ int fimc_is_wrap_clk_gate_set(struct fimc_is_core *core,
 	return 0;
 }
 
+/* should be called with gate_ctrl->lock */
+static void fimc_is_clk_gate_idle_end(struct fimc_is_clk_gate_ctrl *gate_ctrl,
+			int group_id)
+{
+	u64 idle;
+
+	if (!gate_ctrl->idle_start[group_id])
+		return;
+
+	idle = (local_clock() - gate_ctrl->idle_start[group_id]) / NSEC_PER_USEC;
+	gate_ctrl->idle_start[group_id] = 0;
+
+	/* moving average of 1/8 weight */
+	if (gate_ctrl->idle_avg[group_id])
+		gate_ctrl->idle_avg[group_id] = (u32)min_t(u64, U32_MAX,
+			(gate_ctrl->idle_avg[group_id] * 7ULL + idle) >> 3);
+	else
+		gate_ctrl->idle_avg[group_id] = (u32)min_t(u64, U32_MAX, idle);
+
+	if (gate_ctrl->gated[group_id]) {
+		gate_ctrl->gated_time[group_id] += idle;
+		gate_ctrl->gated[group_id] = false;
+	}
+}
+
+ssize_t fimc_is_clk_gate_stat(struct fimc_is_core *core, char *buf, size_t size)
+{
+	struct fimc_is_clk_gate_ctrl *gate_ctrl;
+	ssize_t len = 0;
+	int i;
+
+	gate_ctrl = &core->resourcemgr.clk_gate_ctrl;
+
+	spin_lock(&gate_ctrl->lock);
+	for (i = 0; i < GROUP_ID_MAX; i++) {
+		if (!gate_ctrl->gate_cnt[i] && !gate_ctrl->gate_skip_cnt[i])
+			continue;
+
+		len += scnprintf(buf + len, size - len,
+			"G%d: gate(%u) skip(%u) idle(%uus) gated(%lluus)\n", i,
+			gate_ctrl->gate_cnt[i], gate_ctrl->gate_skip_cnt[i],
+			gate_ctrl->idle_avg[i], gate_ctrl->gated_time[i]);
+	}
+	spin_unlock(&gate_ctrl->lock);
+
+	return len;
+}
+
 inline bool fimc_is_group_otf(struct fimc_is_device_ischain *device, int group_id)
 {
 	struct fimc_is_group *group;
@@ -121,6 +169,7 @@ int fimc_is_clk_gate_set(struct fimc_is_core *core,
 			(gate_ctrl->chk_on_off_cnt[group_id])++; /* for debuging */
 			(gate_ctrl->msk_cnt[group_id])++;
 			set_bit(group_id, &gate_ctrl->msk_state);
+			fimc_is_clk_gate_idle_end(gate_ctrl, group_id);
 		}
 		gate_info->groups[group_id].mask_clk_on_mod =
 			gate_info->groups[group_id].mask_clk_on_org;
@@ -136,6 +185,7 @@ int fimc_is_clk_gate_set(struct fimc_is_core *core,
 		/* if there's some processing group shot, don't clock off */
 		if (test_bit_variables(group_id, &gate_ctrl->msk_state))
 			goto exit;
+		gate_ctrl->idle_start[group_id] = local_clock();
 		gate_info->groups[group_id].mask_clk_off_self_mod =
 			gate_info->groups[group_id].mask_clk_off_self_org;
 	}
@@ -157,6 +207,21 @@ int fimc_is_clk_gate_set(struct fimc_is_core *core,
 		}
 	}
 
+	/*
+	 * Don't off!! if the group is expected to be shot again soon,
+	 * clock on/off would cost more than the idle time saves.
+	 */
+	if (is_on == false) {
+		if (gate_ctrl->idle_avg[group_id] &&
+			(gate_ctrl->idle_avg[group_id] < sysfs_debug.clk_gate_min_idle)) {
+			gate_ctrl->gate_skip_cnt[group_id]++;
+			goto exit;
+		}
+
+		gate_ctrl->gated[group_id] = true;
+		gate_ctrl->gate_cnt[group_id]++;
+	}
+
 	/* Check user scenario */
 	if (user_scenario && gate_info->user_clk_gate) {
 		if (fimc_is_set_user_clk_gate(group_id,
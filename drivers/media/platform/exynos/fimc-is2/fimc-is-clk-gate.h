@@ -19,6 +19,12 @@
 
 #include "fimc-is-core.h"
 
+/*
+ * Clock off is skipped if the predicted idle time of group is shorter than
+ * this. It should cover the cost of clock on and off. (us)
+ */
+#define CLK_GATE_MIN_IDLE_TIME	500
+
 int fimc_is_clk_gate_init(struct fimc_is_core *core);
 int fimc_is_clk_gate_lock_set(struct fimc_is_core *core, u32 instance, u32 is_start);
 /* For several groups */
@@ -28,6 +34,8 @@ int fimc_is_wrap_clk_gate_set(struct fimc_is_core *core,
 int fimc_is_clk_gate_set(struct fimc_is_core *core,
 			int group_id, bool is_on, bool skip_set_state, bool user_scenario);
 
+ssize_t fimc_is_clk_gate_stat(struct fimc_is_core *core, char *buf, size_t size);
+
 int fimc_is_set_user_clk_gate(u32 group_id,
 		struct fimc_is_core *core,
 		bool is_on,
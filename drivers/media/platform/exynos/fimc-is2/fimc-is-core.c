@@ -812,6 +812,36 @@ static ssize_t store_hal_debug_delay(struct device *dev,
 	return count;
 }
 
+static ssize_t show_clk_gate_min_idle(struct device *dev, struct device_attribute *attr,
+				  char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%u us\n", sysfs_debug.clk_gate_min_idle);
+}
+
+static ssize_t store_clk_gate_min_idle(struct device *dev,
+				 struct device_attribute *attr,
+				 const char *buf, size_t count)
+{
+	int ret;
+
+	ret = kstrtouint(buf, 10, &sysfs_debug.clk_gate_min_idle);
+	if (ret < 0) {
+		pr_err("%s, %s, failed for clk_gate_min_idle:%u, ret:%d", __func__, buf, sysfs_debug.clk_gate_min_idle, ret);
+		return 0;
+	}
+
+	return count;
+}
+
+static ssize_t show_clk_gate_stat(struct device *dev, struct device_attribute *attr,
+				  char *buf)
+{
+	struct fimc_is_core *core =
+		(struct fimc_is_core *)dev_get_drvdata(dev);
+
+	return fimc_is_clk_gate_stat(core, buf, PAGE_SIZE);
+}
+
 #ifdef ENABLE_DBG_STATE
 static ssize_t show_debug_state(struct device *dev, struct device_attribute *attr,
 				  char *buf)
@@ -1130,6 +1160,8 @@ static ssize_t store_en_fixed_sensor(struct device *dev,
 
 static DEVICE_ATTR(en_clk_gate, 0644, show_en_clk_gate, store_en_clk_gate);
 static DEVICE_ATTR(clk_gate_mode, 0644, show_clk_gate_mode, store_clk_gate_mode);
+static DEVICE_ATTR(clk_gate_min_idle, 0644, show_clk_gate_min_idle, store_clk_gate_min_idle);
+static DEVICE_ATTR(clk_gate_stat, 0444, show_clk_gate_stat, NULL);
 static DEVICE_ATTR(en_dvfs, 0644, show_en_dvfs, store_en_dvfs);
 static DEVICE_ATTR(pattern_en, 0644, show_pattern_en, store_pattern_en);
 static DEVICE_ATTR(pattern_fps, 0644, show_pattern_fps, store_pattern_fps);
@@ -1158,6 +1190,8 @@ static DEVICE_ATTR(en_fixed_sensor, 0644, show_en_fixed_sensor, store_en_fixed_s
 static struct attribute *fimc_is_debug_entries[] = {
 	&dev_attr_en_clk_gate.attr,
 	&dev_attr_clk_gate_mode.attr,
+	&dev_attr_clk_gate_min_idle.attr,
+	&dev_attr_clk_gate_stat.attr,
 	&dev_attr_en_dvfs.attr,
 	&dev_attr_pattern_en.attr,
 	&dev_attr_pattern_fps.attr,
@@ -1647,6 +1681,7 @@ static int __init fimc_is_probe(struct platform_device *pdev)
 
 	/* set sysfs for debuging */
 	sysfs_debug.en_clk_gate = 0;
+	sysfs_debug.clk_gate_min_idle = CLK_GATE_MIN_IDLE_TIME;
 	sysfs_debug.en_dvfs = 1;
 	sysfs_debug.hal_debug_mode = 0;
 	sysfs_debug.hal_debug_delay = DBG_HAL_DEAD_PANIC_DELAY;
@@ -229,6 +229,7 @@ struct fimc_is_sysfs_debug {
 	unsigned int en_dvfs;
 	unsigned int en_clk_gate;
 	unsigned int clk_gate_mode;
+	unsigned int clk_gate_min_idle;
 	unsigned int pattern_en;
 	unsigned int pattern_fps;
 	unsigned long hal_debug_mode;
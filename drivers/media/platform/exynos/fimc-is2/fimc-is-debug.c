@@ -488,6 +488,33 @@ void fimc_is_draw_digit(ulong addr, int width, int height, u32 pixelformat,
 }
 #endif
 
+void fimc_is_debug_s_stream_on(u32 instance)
+{
+	if (instance >= FIMC_IS_STREAM_COUNT)
+		return;
+
+	fimc_is_debug.stream_on_time[instance] = ktime_get();
+}
+
+/* should be called on every done of the stream leader, only the first one counts */
+void fimc_is_debug_s_first_frame(u32 instance)
+{
+	ktime_t start;
+
+	if (instance >= FIMC_IS_STREAM_COUNT)
+		return;
+
+	start = fimc_is_debug.stream_on_time[instance];
+	if (!ktime_to_ns(start))
+		return;
+
+	fimc_is_debug.stream_on_time[instance] = ktime_set(0, 0);
+	fimc_is_debug.first_frame_us[instance] = ktime_us_delta(ktime_get(), start);
+
+	info("[%d] first frame done %lldus after stream start\n", instance,
+		fimc_is_debug.first_frame_us[instance]);
+}
+
 void fimc_is_dmsg_init(void)
 {
 	fimc_is_debug.dsentence_pos = 0;
@@ -1061,6 +1088,18 @@ int fimc_is_debug_info_dump(struct seq_file *s, struct fimc_is_debug_event *debu
 		atomic_read(&debug_event->overflow_csi),
 		atomic_read(&debug_event->overflow_3aa));
 
+	{
+		u32 i;
+
+		for (i = 0; i < FIMC_IS_STREAM_COUNT; i++) {
+			if (!fimc_is_debug.first_frame_us[i])
+				continue;
+
+			seq_printf(s, "first frame: stream%d(%lldus)\n", i,
+				fimc_is_debug.first_frame_us[i]);
+		}
+	}
+
 	seq_printf(s, "------------------- FIMC-IS EVENT LOGGER - END ----------------\n");
 	return 0;
 }
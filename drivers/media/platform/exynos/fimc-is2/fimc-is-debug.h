@@ -69,6 +69,9 @@ struct fimc_is_debug {
 
 	unsigned long		state;
 
+	/* time to first frame */
+	ktime_t			stream_on_time[FIMC_IS_STREAM_COUNT];
+	s64			first_frame_us[FIMC_IS_STREAM_COUNT];
 };
 
 extern struct fimc_is_debug fimc_is_debug;
@@ -77,6 +80,9 @@ int fimc_is_debug_probe(void);
 int fimc_is_debug_open(struct fimc_is_minfo *minfo);
 int fimc_is_debug_close(void);
 
+void fimc_is_debug_s_stream_on(u32 instance);
+void fimc_is_debug_s_first_frame(u32 instance);
+
 void fimc_is_dmsg_init(void);
 void fimc_is_dmsg_concate(const char *fmt, ...);
 char *fimc_is_dmsg_print(void);
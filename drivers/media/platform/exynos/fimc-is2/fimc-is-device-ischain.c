@@ -63,6 +63,7 @@
 #include "fimc-is-device-ischain.h"
 #include "fimc-is-clk-gate.h"
 #include "fimc-is-dvfs.h"
+#include "fimc-is-debug.h"
 #include "fimc-is-device-preprocessor.h"
 #include "fimc-is-vender-specific.h"
 #include "exynos-fimc-is-module.h"
@@ -4003,8 +4004,34 @@ static int fimc_is_ischain_start(struct fimc_is_device_ischain *device)
 		merr("fimc_is_dvfs_sel_table is fail(%d)", device, ret);
 		goto p_err;
 	}
+
+	/*
+	 * The static scenario only depends on the stream configuration
+	 * (sensor size, fps and the set of opened nodes) which is fixed here.
+	 * Apply it before the init shots so that the first frames don't run
+	 * at the previous or default level; stream on evaluates it again and
+	 * only the changed qos values are updated.
+	 */
+	if ((!pm_qos_request_active(&device->user_qos)) && (sysfs_debug.en_dvfs)) {
+		struct fimc_is_dvfs_ctrl *dvfs_ctrl;
+		int scenario_id;
+
+		dvfs_ctrl = &device->resourcemgr->dvfs_ctrl;
+
+		mutex_lock(&dvfs_ctrl->lock);
+
+		scenario_id = fimc_is_dvfs_sel_static(device);
+		if (scenario_id >= 0) {
+			minfo("[ISC:D] pre-select static scenario(%d)\n", device, scenario_id);
+			fimc_is_set_dvfs((struct fimc_is_core *)device->interface->core, device, scenario_id);
+		}
+
+		mutex_unlock(&dvfs_ctrl->lock);
+	}
 #endif
 
+	fimc_is_debug_s_stream_on(device->instance);
+
 	set_bit(FIMC_IS_ISCHAIN_START, &device->state);
 
 p_err:
@@ -897,6 +897,7 @@ static int fimc_is_sensor_notify_by_fstr(struct fimc_is_device_sensor *device, v
 	FIMC_BUG(!arg);
 
 	device->fcount = *(u32 *)arg;
+	device->fstart_time = ktime_get();
 	framemgr = GET_FRAMEMGR(device->vctx);
 	if (unlikely(!framemgr)) {
 		merr("framemgr is null", device);
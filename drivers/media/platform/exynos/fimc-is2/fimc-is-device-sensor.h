@@ -353,6 +353,8 @@ struct fimc_is_device_sensor {
 
 	u32						fcount;
 	u32						line_fcount;
+	/* for timing the i2c sequences of a frame to its start */
+	ktime_t						fstart_time;
 	u32						instant_cnt;
 	int						instant_ret;
 	wait_queue_head_t				instant_wait;
@@ -1053,6 +1053,7 @@ static int fimc_is_sensor_notify_by_fstr(struct fimc_is_device_sensor *device, v
 	FIMC_BUG(!arg);
 
 	fcount = *(u32 *)arg;
+	device->fstart_time = ktime_get();
 
 	if (device->instant_cnt) {
 		device->instant_cnt--;
@@ -28,6 +28,8 @@
 #include <linux/videodev2_exynos_camera.h>
 #include <linux/v4l2-mediabus.h>
 #include <linux/bug.h>
+#include <linux/sched/clock.h>
+#include <linux/math64.h>
 
 #include "fimc-is-core.h"
 #include "fimc-is-cmd.h"
@@ -42,6 +44,15 @@ ulong frame_fcount(struct fimc_is_frame *frame, void *data)
 	return (ulong)frame->fcount - (ulong)data;
 }
 
+static inline void frame_account_queued_time(struct fimc_is_framemgr *this,
+			struct fimc_is_frame *frame)
+{
+	u64 msec = div_u64(local_clock() - frame->queued_time, NSEC_PER_MSEC);
+
+	this->queued_hist[frame->state][min(fls64(msec),
+						FRAMEMGR_HIST_SIZE - 1)]++;
+}
+
 int put_frame(struct fimc_is_framemgr *this, struct fimc_is_frame *frame,
 			enum fimc_is_frame_state state)
 {
@@ -54,6 +65,7 @@ int put_frame(struct fimc_is_framemgr *this, struct fimc_is_frame *frame,
 	}
 
 	frame->state = state;
+	frame->queued_time = local_clock();
 
 	list_add_tail(&frame->list, &this->queued_list[state]);
 	this->queued_count[state]++;
@@ -80,6 +92,7 @@ struct fimc_is_frame *get_frame(struct fimc_is_framemgr *this,
 						struct fimc_is_frame, list);
 	list_del(&frame->list);
 	this->queued_count[state]--;
+	frame_account_queued_time(this, frame);
 
 	frame->state = FS_INVALID;
 
@@ -105,6 +118,7 @@ int trans_frame(struct fimc_is_framemgr *this, struct fimc_is_frame *frame,
 
 	list_del(&frame->list);
 	this->queued_count[frame->state]--;
+	frame_account_queued_time(this, frame);
 
 	if (state == FS_PROCESS && (!(this->id & FRAMEMGR_ID_HW)))
 		frame->bak_flag = frame->out_flag;
@@ -191,6 +205,26 @@ void print_frame_queue(struct fimc_is_framemgr *this,
 	pr_cont("X\n");
 }
 
+static void print_frame_queue_stat(struct fimc_is_framemgr *this)
+{
+	int i, j;
+
+	if (!(TRACE_ID & this->id))
+			return;
+
+	pr_info("[FRM_STAT] %s contended %u\n", this->name, this->contended);
+
+	for (i = 0; i < NR_FRAME_STATE; i++) {
+		pr_info("[FRM_STAT] %s(%s) msec <1:%u",
+			frame_state_name[i], this->name, this->queued_hist[i][0]);
+		for (j = 1; j < FRAMEMGR_HIST_SIZE; j++)
+			pr_cont(" %s%u:%u", (j < FRAMEMGR_HIST_SIZE - 1) ? "<" : ">=",
+				(j < FRAMEMGR_HIST_SIZE - 1) ? 1 << j : 1 << (j - 1),
+				this->queued_hist[i][j]);
+		pr_cont("\n");
+	}
+}
+
 #ifndef ENABLE_IS_CORE
 void print_frame_info_queue(struct fimc_is_framemgr *this,
 			enum fimc_is_frame_state state)
@@ -271,6 +305,8 @@ int frame_manager_open(struct fimc_is_framemgr *this, u32 buffers)
 	spin_lock_irqsave(&this->slock, flag);
 
 	this->num_frames = buffers;
+	this->contended = 0;
+	memset(this->queued_hist, 0, sizeof(this->queued_hist));
 
 	for (i = 0; i < NR_FRAME_STATE; i++) {
 		this->queued_count[i] = 0;
@@ -338,6 +374,8 @@ void frame_manager_print_queues(struct fimc_is_framemgr *this)
 
 	for (i = 0; i < NR_FRAME_STATE; i++)
 		print_frame_queue(this, (enum fimc_is_frame_state)i);
+
+	print_frame_queue_stat(this);
 }
 
 void frame_manager_print_info_queues(struct fimc_is_framemgr *this)
@@ -117,10 +117,14 @@
 #define FMGR_IDX_30		(1 << 30)
 #define FMGR_IDX_31		(1 << 31)
 
+/* contended counts the times the lock was not acquired at once */
 #define framemgr_e_barrier_irqs(this, index, flag)		\
 	do {							\
 		this->sindex |= index;				\
-		spin_lock_irqsave(&this->slock, flag);		\
+		if (!spin_trylock_irqsave(&this->slock, flag)) {	\
+			spin_lock_irqsave(&this->slock, flag);	\
+			this->contended++;			\
+		}						\
 	} while (0)
 #define framemgr_x_barrier_irqr(this, index, flag)		\
 	do {							\
@@ -130,7 +134,10 @@
 #define framemgr_e_barrier_irq(this, index)			\
 	do {							\
 		this->sindex |= index;				\
-		spin_lock_irq(&this->slock);			\
+		if (!spin_trylock_irq(&this->slock)) {		\
+			spin_lock_irq(&this->slock);		\
+			this->contended++;			\
+		}						\
 	} while (0)
 #define framemgr_x_barrier_irq(this, index)			\
 	do {							\
@@ -140,7 +147,10 @@
 #define framemgr_e_barrier(this, index)				\
 	do {							\
 		this->sindex |= index;				\
-		spin_lock(&this->slock);			\
+		if (!spin_trylock(&this->slock)) {		\
+			spin_lock(&this->slock);		\
+			this->contended++;			\
+		}						\
 	} while (0)
 #define framemgr_x_barrier(this, index)				\
 	do {							\
@@ -165,6 +175,12 @@ enum fimc_is_frame_state {
 
 #define NR_FRAME_STATE FS_INVALID
 
+/*
+ * Histogram of the time that frames stay in a queue.
+ * Bucket i counts [2^(i-1), 2^i) msec and bucket 0 counts less than 1 msec.
+ */
+#define FRAMEMGR_HIST_SIZE	8
+
 enum fimc_is_frame_mem_state {
 	/* initialized memory */
 	FRAME_MEM_INIT,
@@ -262,6 +278,7 @@ struct fimc_is_frame {
 	u32			result;
 	unsigned long		out_flag;
 	unsigned long		bak_flag;
+	u64			queued_time; /* local_clock() at put_frame() */
 
 #ifndef ENABLE_IS_CORE
 	struct fimc_is_frame_info frame_info[MAX_FRAME_INFO];
@@ -308,6 +325,10 @@ struct fimc_is_framemgr {
 
 	u32			queued_count[NR_FRAME_STATE];
 	struct list_head	queued_list[NR_FRAME_STATE];
+
+	/* statistics protected by slock */
+	u32			contended;
+	u32			queued_hist[NR_FRAME_STATE][FRAMEMGR_HIST_SIZE];
 };
 
 static const char * const hw_frame_state_name[NR_FRAME_STATE] = {
@@ -321,7 +342,8 @@ static const char * const frame_state_name[NR_FRAME_STATE] = {
 	"Free",
 	"Request",
 	"Process",
-	"Complete"
+	"Complete",
+	"Stripe_Process"
 };
 
 ulong frame_fcount(struct fimc_is_frame *frame, void *data);
@@ -18,6 +18,7 @@
 #include <linux/device.h>
 #include <linux/platform_device.h>
 #include <linux/slab.h>
+#include <linux/vmalloc.h>
 #include <video/videonode.h>
 #include <asm/cacheflush.h>
 #include <asm/pgtable.h>
@@ -113,7 +114,8 @@ static void fimc_is_gframe_print_free(struct fimc_is_group_framemgr *gframemgr)
 
 	FIMC_BUG_VOID(!gframemgr);
 
-	printk(KERN_ERR "[GFM] fre(%d) :", gframemgr->gframe_cnt);
+	printk(KERN_ERR "[GFM] fre(%d/%d, min %d) :", gframemgr->gframe_cnt,
+		gframemgr->gframe_num, gframemgr->gframe_min);
 
 	list_for_each_entry_safe(gframe, temp, &gframemgr->gframe_head, list) {
 		printk(KERN_CONT "%d->", gframe->fcount);
@@ -139,6 +141,8 @@ static void fimc_is_gframe_s_group(struct fimc_is_group *group,
 
 	list_add_tail(&gframe->list, &group->gframe_head);
 	group->gframe_cnt++;
+	if (group->gframe_cnt > group->gframe_hwm)
+		group->gframe_hwm = group->gframe_cnt;
 }
 
 static void fimc_is_gframe_print_group(struct fimc_is_group *group)
@@ -146,7 +150,8 @@ static void fimc_is_gframe_print_group(struct fimc_is_group *group)
 	struct fimc_is_group_frame *gframe, *temp;
 
 	while (group) {
-		printk(KERN_ERR "[GP%d] req(%d) :", group->id, group->gframe_cnt);
+		printk(KERN_ERR "[GP%d] req(%d, max %d) :", group->id,
+			group->gframe_cnt, group->gframe_hwm);
 
 		list_for_each_entry_safe(gframe, temp, &group->gframe_head, list) {
 			printk(KERN_CONT "%d->", gframe->fcount);
@@ -335,6 +340,8 @@ static int fimc_is_gframe_trans_fre_to_grp(struct fimc_is_group_framemgr *gframe
 	if (gframe->group_cfg[group->slot].capture[group->tail->junction->cid].request) {
 		list_del(&gframe->list);
 		gframemgr->gframe_cnt--;
+		if (gframemgr->gframe_cnt < gframemgr->gframe_min)
+			gframemgr->gframe_min = gframemgr->gframe_cnt;
 		fimc_is_gframe_s_group(gnext, gframe);
 	}
 
@@ -400,6 +407,73 @@ p_err:
 	return ret;
 }
 
+/* should be called with gframe_slock held */
+static void fimc_is_gframe_init_free(struct fimc_is_group_framemgr *gframemgr,
+	struct fimc_is_group_frame *gframes, u32 num)
+{
+	u32 i;
+
+	INIT_LIST_HEAD(&gframemgr->gframe_head);
+	gframemgr->gframe_cnt = 0;
+	gframemgr->gframe_num = num;
+	gframemgr->gframe_min = num;
+
+	for (i = 0; i < num; ++i) {
+		gframes[i].fcount = 0;
+		fimc_is_gframe_s_free(gframemgr, &gframes[i]);
+	}
+}
+
+/*
+ * Reserves gframes for the frame rate of the sensor mode at stream-on.
+ * The gframes stay in the free list until the leader shots, so the number of
+ * gframes in flight grows with the frame rate.
+ */
+static int fimc_is_gframe_reserve(struct fimc_is_groupmgr *groupmgr,
+	struct fimc_is_group *group, u32 framerate)
+{
+	struct fimc_is_group_framemgr *gframemgr;
+	struct fimc_is_group_frame *gframes = NULL, *old;
+	u32 num;
+	ulong flags;
+
+	gframemgr = &groupmgr->gframemgr[group->instance];
+	num = FIMC_IS_MAX_GFRAME * clamp_t(u32,
+			DIV_ROUND_UP(framerate, FIMC_IS_GFRAME_FPS_UNIT),
+			1, FIMC_IS_MAX_GFRAME_SCALE);
+
+	if (num > FIMC_IS_MAX_GFRAME) {
+		gframes = vzalloc(sizeof(struct fimc_is_group_frame) * num);
+		if (!gframes) {
+			mgwarn("failed to reserve %d gframes", group, group, num);
+			num = FIMC_IS_MAX_GFRAME;
+		}
+	}
+
+	spin_lock_irqsave(&gframemgr->gframe_slock, flags);
+
+	if (gframemgr->gframe_cnt != gframemgr->gframe_num) {
+		spin_unlock_irqrestore(&gframemgr->gframe_slock, flags);
+		mgwarn("gframes are in use(%d/%d)", group, group,
+			gframemgr->gframe_cnt, gframemgr->gframe_num);
+		vfree(gframes);
+		return -EBUSY;
+	}
+
+	old = gframemgr->gframes_ext;
+	gframemgr->gframes_ext = gframes;
+	fimc_is_gframe_init_free(gframemgr,
+		gframes ? gframes : gframemgr->gframes, num);
+
+	spin_unlock_irqrestore(&gframemgr->gframe_slock, flags);
+
+	vfree(old);
+
+	mginfo("%d gframes reserved for %dfps\n", group, group, num, framerate);
+
+	return 0;
+}
+
 void * fimc_is_gframe_rewind(struct fimc_is_groupmgr *groupmgr,
 	struct fimc_is_group *group, u32 target_fcount)
 {
@@ -1074,14 +1148,13 @@ int fimc_is_groupmgr_probe(struct platform_device *pdev,
 	struct fimc_is_groupmgr *groupmgr)
 {
 	int ret = 0;
-	u32 stream, slot, id, index;
+	u32 stream, slot, id;
 	struct fimc_is_group_framemgr *gframemgr;
 
 	for (stream = 0; stream < FIMC_IS_STREAM_COUNT; ++stream) {
 		gframemgr = &groupmgr->gframemgr[stream];
 		spin_lock_init(&groupmgr->gframemgr[stream].gframe_slock);
-		INIT_LIST_HEAD(&groupmgr->gframemgr[stream].gframe_head);
-		groupmgr->gframemgr[stream].gframe_cnt = 0;
+		gframemgr->gframes_ext = NULL;
 
 		gframemgr->gframes = devm_kzalloc(&pdev->dev,
 					sizeof(struct fimc_is_group_frame) * FIMC_IS_MAX_GFRAME,
@@ -1092,8 +1165,8 @@ int fimc_is_groupmgr_probe(struct platform_device *pdev,
 			goto p_err;
 		}
 
-		for (index = 0; index < FIMC_IS_MAX_GFRAME; ++index)
-			fimc_is_gframe_s_free(gframemgr, &gframemgr->gframes[index]);
+		fimc_is_gframe_init_free(gframemgr, gframemgr->gframes,
+					FIMC_IS_MAX_GFRAME);
 
 		groupmgr->leader[stream] = NULL;
 		for (slot = 0; slot < GROUP_SLOT_MAX; ++slot)
@@ -1865,17 +1938,23 @@ int fimc_is_group_close(struct fimc_is_groupmgr *groupmgr,
 	}
 
 	if (all_slot_empty) {
+		struct fimc_is_group_frame *gframes_ext;
+		ulong flags;
+
 		gframemgr = &groupmgr->gframemgr[stream];
 
-		if (gframemgr->gframe_cnt != FIMC_IS_MAX_GFRAME) {
+		spin_lock_irqsave(&gframemgr->gframe_slock, flags);
+		if (gframemgr->gframe_cnt != gframemgr->gframe_num)
 			mwarn("gframemgr free count is invalid(%d)", group, gframemgr->gframe_cnt);
-			INIT_LIST_HEAD(&gframemgr->gframe_head);
-			gframemgr->gframe_cnt = 0;
-			for (i = 0; i < FIMC_IS_MAX_GFRAME; ++i) {
-				gframemgr->gframes[i].fcount = 0;
-				fimc_is_gframe_s_free(gframemgr, &gframemgr->gframes[i]);
-			}
-		}
+
+		/* the gframes reserved for high frame rate are released */
+		gframes_ext = gframemgr->gframes_ext;
+		gframemgr->gframes_ext = NULL;
+		fimc_is_gframe_init_free(gframemgr, gframemgr->gframes,
+					FIMC_IS_MAX_GFRAME);
+		spin_unlock_irqrestore(&gframemgr->gframe_slock, flags);
+
+		vfree(gframes_ext);
 	}
 
 	mdbgd_group("%s(ref %d, %d)", group, __func__, atomic_read(&gtask->refcount), ret);
@@ -2088,6 +2167,7 @@ int fimc_is_group_start(struct fimc_is_groupmgr *groupmgr,
 	sema_init(&group->smp_trigger, 0);
 
 	INIT_LIST_HEAD(&group->votf_list);
+	group->gframe_hwm = 0;
 
 	if (test_bit(FIMC_IS_ISCHAIN_REPROCESSING, &device->state)) {
 		group->asyn_shots = 1;
@@ -2100,6 +2180,9 @@ int fimc_is_group_start(struct fimc_is_groupmgr *groupmgr,
 		framerate = fimc_is_sensor_g_framerate(sensor);
 		ex_mode = fimc_is_sensor_g_ex_mode(sensor);
 
+		if (group == groupmgr->leader[group->instance])
+			fimc_is_gframe_reserve(groupmgr, group, framerate);
+
 		if (test_bit(FIMC_IS_GROUP_OTF_INPUT, &group->state)) {
 			resourcemgr = device->resourcemgr;
 			set_group_shots(group, resourcemgr->hal_version, framerate, ex_mode);
@@ -3404,6 +3487,10 @@ int fimc_is_group_done(struct fimc_is_groupmgr *groupmgr,
 	if (test_bit(FIMC_IS_GROUP_OTF_INPUT, &group->state))
 		fimc_is_sensor_dm_tag(device->sensor, frame);
 
+	/* the last group of the stream completes the frame */
+	if (!gnext && (done_state == VB2_BUF_STATE_DONE))
+		fimc_is_debug_s_first_frame(group->instance);
+
 #ifdef ENABLE_SHARED_METADATA
 	fimc_is_hw_shared_meta_update(device, group, frame, SHARED_META_SHOT_DONE);
 #else
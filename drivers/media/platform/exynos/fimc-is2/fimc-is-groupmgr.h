@@ -87,6 +87,9 @@
 #endif
 
 #define FIMC_IS_MAX_GFRAME	(VIDEO_MAX_FRAME) /* max shot buffer of F/W : 32 */
+/* gframes are reserved by multiple of FIMC_IS_MAX_GFRAME per 120fps */
+#define FIMC_IS_GFRAME_FPS_UNIT	120
+#define FIMC_IS_MAX_GFRAME_SCALE	4
 #define MIN_OF_ASYNC_SHOTS	1
 #define MIN_OF_SYNC_SHOTS	2
 
@@ -147,11 +150,20 @@ struct fimc_is_group_frame {
 	struct camera2_node_group	group_cfg[GROUP_SLOT_MAX];
 };
 
+/*
+ * @gframes	: FIMC_IS_MAX_GFRAME gframes allocated at probe
+ * @gframes_ext	: gframes reserved at stream-on for a high frame rate mode
+ * @gframe_num	: number of gframes in use, either of @gframes or @gframes_ext
+ * @gframe_min	: the lowest @gframe_cnt since stream-on
+ */
 struct fimc_is_group_framemgr {
 	struct fimc_is_group_frame	*gframes;
+	struct fimc_is_group_frame	*gframes_ext;
 	spinlock_t			gframe_slock;
 	struct list_head		gframe_head;
 	u32				gframe_cnt;
+	u32				gframe_num;
+	u32				gframe_min;
 };
 
 struct fimc_is_group {
@@ -201,6 +213,7 @@ struct fimc_is_group {
 
 	struct list_head		gframe_head;
 	u32				gframe_cnt;
+	u32				gframe_hwm; /* the highest gframe_cnt */
 
 	fimc_is_shot_callback		shot_callback;
 	fimc_is_pipe_shot_callback	pipe_shot_callback;
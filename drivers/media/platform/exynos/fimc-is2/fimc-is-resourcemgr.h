@@ -81,6 +81,17 @@ struct fimc_is_clk_gate_ctrl {
 	 * And will decrease when clock off.
 	 */
 	unsigned long chk_on_off_cnt[GROUP_ID_MAX];
+	/*
+	 * Idle prediction per group.
+	 * The gap between shot done and next shot is averaged and clock off
+	 * is skipped when the predicted gap is shorter than min idle time.
+	 */
+	u64 idle_start[GROUP_ID_MAX]; /* ns, 0 means not idle */
+	u32 idle_avg[GROUP_ID_MAX]; /* us */
+	bool gated[GROUP_ID_MAX];
+	u32 gate_cnt[GROUP_ID_MAX];
+	u32 gate_skip_cnt[GROUP_ID_MAX];
+	u64 gated_time[GROUP_ID_MAX]; /* us */
 };
 
 struct fimc_is_resource {
@@ -35,6 +35,7 @@
 #include <media/v4l2-device.h>
 #include <media/v4l2-mem2mem.h>
 #include <media/v4l2-mediabus.h>
+#include <soc/samsung/exynos-frametrace.h>
 
 #include "fimc-is-time.h"
 #include "fimc-is-core.h"
@@ -1586,6 +1587,9 @@ int fimc_is_video_qbuf(struct fimc_is_video_ctx *vctx,
 	queue->buf_req++;
 
 	ret = vb2_qbuf(queue->vbq, buf);
+	if (!ret)
+		exynos_frametrace(vbq->bufs[buf->index]->planes[0].dbuf,
+				EXYNOS_FRAMETRACE_CAM_QBUF, video->id);
 	if (ret) {
 		mverr("vb2_qbuf is fail(index : %d, %d)", vctx, video, buf->index, ret);
 
@@ -2186,6 +2190,8 @@ int fimc_is_video_buffer_done(struct fimc_is_video_ctx *vctx,
 
 	queue->buf_com++;
 
+	exynos_frametrace(vb->planes[0].dbuf, EXYNOS_FRAMETRACE_CAM_DONE,
+			video->id);
 	vb2_buffer_done(vb, state);
 
 p_err:
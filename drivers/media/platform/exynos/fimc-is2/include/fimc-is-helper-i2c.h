@@ -13,6 +13,7 @@
 #define fimc_is_helper_i2c_H
 
 #include <linux/i2c.h>
+#include <linux/ktime.h>
 
 //#define FIMC_IS_VIRTUAL_MODULE
 
@@ -35,6 +36,34 @@
 #define I2C_MODE_BURST_DATA	(2 + I2C_MODE_BASE)
 #define I2C_MODE_DELAY	(3 + I2C_MODE_BASE)
 
+/* longest burst message of a compiled sequence, in data bytes */
+#define I2C_SEQ_BURST_MAX	128
+
+/*
+ * Setfile precompiled into i2c messages, so that the settings of a sensor
+ * mode or the controls of a frame are written by a single transfer.
+ * Registers of consecutive addresses are merged into one burst message.
+ * If hold_addr is set, the messages are put between setting and clearing
+ * the grouped parameter hold, and the sensor applies them at one frame.
+ * The values of a compiled sequence can be changed in place per frame.
+ */
+struct fimc_is_i2c_seq {
+	struct i2c_msg		*msg;
+	u32			msg_cnt;
+	u8			*buf;
+	u16			hold_addr;
+	u8			hold_buf[2][3];
+
+	/* writes, and their timing from the start of the frame given */
+	u32			write_cnt;
+	u32			fail_cnt;
+	u64			write_ns;
+	u64			write_max_ns;
+	u32			done_cnt;
+	u64			done_ns;	/* from frame start to done */
+	u64			done_max_ns;
+};
+
 int fimc_is_i2c_transfer(struct i2c_adapter *adapter, struct i2c_msg *msg, u32 size);
 int fimc_is_sensor_addr8_read8(struct i2c_client *client,
 	u8 addr, u8 *val);
@@ -58,4 +87,12 @@ int fimc_is_sensor_write16_burst(struct i2c_client *client,
 	u16 addr, u16 *val, u32 num);
 int fimc_is_sensor_write8_sequential(struct i2c_client *client,
 	u16 addr, u8 *val, u16 num);
+int fimc_is_i2c_seq_compile(struct i2c_client *client,
+	struct fimc_is_i2c_seq *seq, const u32 *regs, u32 size, u16 hold_addr);
+void fimc_is_i2c_seq_free(struct fimc_is_i2c_seq *seq);
+int fimc_is_i2c_seq_set(struct fimc_is_i2c_seq *seq,
+	u16 addr, u16 val, u32 bytes);
+int fimc_is_i2c_seq_write(struct i2c_client *client,
+	struct fimc_is_i2c_seq *seq, ktime_t fstart);
+void fimc_is_i2c_seq_dump(struct fimc_is_i2c_seq *seq, const char *name);
 #endif
@@ -11,6 +11,7 @@
  */
 
 #include <linux/delay.h>
+#include <linux/math64.h>
 #include <linux/slab.h>
 
 #include "fimc-is-helper-i2c.h"
@@ -529,3 +530,221 @@ p_err:
 	return ret;
 }
 
+/*
+ * Lays out the setfile entries in burst messages to @client_addr, or only
+ * counts them if @msg is NULL. Returns the number of messages, and the
+ * bytes of their buffers in @len.
+ */
+static int fimc_is_i2c_seq_build(const u32 *regs, u32 size, u16 client_addr,
+	struct i2c_msg *msg, u8 *buf, u32 *len)
+{
+	u32 i, addr, bytes, burst = 0, next = 0;
+	int cnt = 0;
+	u8 *pos = buf;
+
+	*len = 0;
+	for (i = 0; i < size; i += I2C_NEXT) {
+		addr = regs[i + I2C_ADDR];
+		bytes = regs[i + I2C_BYTE];
+		if (addr >= I2C_MODE_BASE || addr > 0xFFFF ||
+				(bytes != 1 && bytes != 2)) {
+			pr_err("setfile entry %d can't be compiled\n",
+				i / I2C_NEXT);
+			return -EINVAL;
+		}
+
+		if (!cnt || addr != next || burst + bytes > I2C_SEQ_BURST_MAX) {
+			if (msg) {
+				msg[cnt].addr = client_addr;
+				msg[cnt].flags = 0;
+				msg[cnt].len = 2;
+				msg[cnt].buf = pos;
+				*pos++ = (addr & 0xFF00) >> 8;
+				*pos++ = (addr & 0xFF);
+			}
+			cnt++;
+			burst = 0;
+			*len += 2;
+		}
+
+		if (msg) {
+			if (bytes == 2)
+				*pos++ = (regs[i + I2C_DATA] & 0xFF00) >> 8;
+			*pos++ = (regs[i + I2C_DATA] & 0xFF);
+			msg[cnt - 1].len += bytes;
+		}
+		burst += bytes;
+		*len += bytes;
+		next = addr + bytes;
+	}
+
+	return cnt;
+}
+
+/*
+ * Compiles a setfile of @size u32, in entries of I2C_NEXT, into @seq.
+ * The delays and bursts of setfile write options need separate transfers
+ * and are not supported. A non zero @hold_addr is the grouped parameter
+ * hold register of the sensor.
+ */
+int fimc_is_i2c_seq_compile(struct i2c_client *client,
+	struct fimc_is_i2c_seq *seq, const u32 *regs, u32 size, u16 hold_addr)
+{
+	int ret = 0;
+	int cnt, hold = hold_addr ? 1 : 0;
+	u32 len;
+
+	if (!regs || !size || size % I2C_NEXT) {
+		pr_err("invalid setfile size(%d)\n", size);
+		ret = -EINVAL;
+		goto p_err;
+	}
+
+	if (!client->adapter) {
+		pr_err("Could not find adapter!\n");
+		ret = -ENODEV;
+		goto p_err;
+	}
+
+	memset(seq, 0, sizeof(*seq));
+
+	cnt = fimc_is_i2c_seq_build(regs, size, client->addr, NULL, NULL, &len);
+	if (cnt < 0) {
+		ret = cnt;
+		goto p_err;
+	}
+
+	seq->msg = kcalloc(cnt + hold * 2, sizeof(*seq->msg), GFP_KERNEL);
+	seq->buf = kzalloc(len, GFP_KERNEL);
+	if (!seq->msg || !seq->buf) {
+		pr_err("failed to alloc buffer for i2c sequence\n");
+		ret = -ENOMEM;
+		goto p_err_free;
+	}
+
+	fimc_is_i2c_seq_build(regs, size, client->addr, seq->msg + hold,
+		seq->buf, &len);
+	seq->msg_cnt = cnt + hold * 2;
+
+	if (hold) {
+		seq->hold_addr = hold_addr;
+		seq->hold_buf[0][0] = seq->hold_buf[1][0] = (hold_addr & 0xFF00) >> 8;
+		seq->hold_buf[0][1] = seq->hold_buf[1][1] = (hold_addr & 0xFF);
+		seq->hold_buf[0][2] = 0x01;
+		seq->hold_buf[1][2] = 0x00;
+
+		seq->msg[0].addr = client->addr;
+		seq->msg[0].len = 3;
+		seq->msg[0].buf = seq->hold_buf[0];
+		seq->msg[seq->msg_cnt - 1].addr = client->addr;
+		seq->msg[seq->msg_cnt - 1].len = 3;
+		seq->msg[seq->msg_cnt - 1].buf = seq->hold_buf[1];
+	}
+
+	i2c_info("I2CSEQ(%d) %d entries in %d messages\n", client->addr,
+		size / I2C_NEXT, seq->msg_cnt);
+
+	return 0;
+
+p_err_free:
+	fimc_is_i2c_seq_free(seq);
+p_err:
+	return ret;
+}
+
+void fimc_is_i2c_seq_free(struct fimc_is_i2c_seq *seq)
+{
+	kfree(seq->msg);
+	kfree(seq->buf);
+	seq->msg = NULL;
+	seq->buf = NULL;
+	seq->msg_cnt = 0;
+}
+
+/* Changes the value of a compiled register, e.g. the exposure of a frame */
+int fimc_is_i2c_seq_set(struct fimc_is_i2c_seq *seq,
+	u16 addr, u16 val, u32 bytes)
+{
+	struct i2c_msg *msg;
+	u32 i, start, off;
+
+	for (i = 0; i < seq->msg_cnt; i++) {
+		msg = &seq->msg[i];
+		if (msg->buf == seq->hold_buf[0] || msg->buf == seq->hold_buf[1])
+			continue;
+
+		start = (msg->buf[0] << 8) | msg->buf[1];
+		if (addr < start || addr + bytes > start + msg->len - 2)
+			continue;
+
+		off = 2 + addr - start;
+		if (bytes == 2)
+			msg->buf[off++] = (val & 0xFF00) >> 8;
+		msg->buf[off] = (val & 0xFF);
+
+		return 0;
+	}
+
+	pr_err("[0x%04X] is not in the i2c sequence\n", addr);
+
+	return -EINVAL;
+}
+
+/*
+ * Writes @seq by a single transfer. @fstart is the start of the frame that
+ * the write is for, and the time from it to the end of the write is
+ * accounted, so that the writes missing the frame can be found.
+ */
+int fimc_is_i2c_seq_write(struct i2c_client *client,
+	struct fimc_is_i2c_seq *seq, ktime_t fstart)
+{
+	int ret = 0;
+	ktime_t start, done;
+	u64 ns;
+
+	if (!client->adapter) {
+		pr_err("Could not find adapter!\n");
+		ret = -ENODEV;
+		goto p_err;
+	}
+
+	start = ktime_get();
+	ret = fimc_is_i2c_transfer(client->adapter, seq->msg, seq->msg_cnt);
+	done = ktime_get();
+	if (ret != seq->msg_cnt) {
+		seq->fail_cnt++;
+		pr_err("i2c treansfer fail(%d)", ret);
+		ret = ret < 0 ? ret : -EIO;
+		goto p_err;
+	}
+
+	ns = ktime_to_ns(ktime_sub(done, start));
+	seq->write_cnt++;
+	seq->write_ns += ns;
+	if (ns > seq->write_max_ns)
+		seq->write_max_ns = ns;
+
+	if (ktime_to_ns(fstart) && ktime_after(done, fstart)) {
+		ns = ktime_to_ns(ktime_sub(done, fstart));
+		seq->done_cnt++;
+		seq->done_ns += ns;
+		if (ns > seq->done_max_ns)
+			seq->done_max_ns = ns;
+	}
+
+	i2c_info("I2CSEQ(%d) %d messages\n", client->addr, seq->msg_cnt);
+
+	return 0;
+p_err:
+	return ret;
+}
+
+void fimc_is_i2c_seq_dump(struct fimc_is_i2c_seq *seq, const char *name)
+{
+	pr_info("%s: %u writes(%u fail), write avg %llu max %llu us, done from fstart avg %llu max %llu us\n",
+		name, seq->write_cnt, seq->fail_cnt,
+		seq->write_cnt ? div64_u64(seq->write_ns, seq->write_cnt) / NSEC_PER_USEC : 0,
+		div64_u64(seq->write_max_ns, NSEC_PER_USEC),
+		seq->done_cnt ? div64_u64(seq->done_ns, seq->done_cnt) / NSEC_PER_USEC : 0,
+		div64_u64(seq->done_max_ns, NSEC_PER_USEC));
+}
@@ -504,6 +504,8 @@ enum v4l2_mpeg_video_hevc_hierarchical_coding_type {
 					(V4L2_CID_MPEG_MFC_BASE + 231)
 #define V4L2_CID_MPEG_VIDEO_STATIC_INFO_ENABLE			\
 					(V4L2_CID_MPEG_MFC_BASE + 232)
+#define V4L2_CID_MPEG_VIDEO_PRIORITY				\
+					(V4L2_CID_MPEG_MFC_BASE + 233)
 
 #define V4L2_CID_MPEG_VIDEO_BPG_THUMBNAIL_SIZE			\
 					(V4L2_CID_MPEG_MFC_BASE + 250)
@@ -20,6 +20,9 @@
 #include <linux/debugfs.h>
 #include <linux/seq_file.h>
 #include <linux/poll.h>
+#include <linux/firmware.h>
+#include <soc/samsung/exynos-probe.h>
+#include <soc/samsung/exynos-wq.h>
 
 #include "mfc_common.h"
 
@@ -336,6 +339,8 @@ static int __mfc_init_instance(struct mfc_dev *dev, struct mfc_ctx *ctx)
 		msecs_to_jiffies(WATCHDOG_TICK_INTERVAL);
 	add_timer(&dev->watchdog_timer);
 
+	mfc_perf_resume_begin(dev, MFC_RESUME_OPEN);
+
 	/* Load the FW */
 	if (!dev->fw.status) {
 		ret = mfc_alloc_firmware(dev);
@@ -347,6 +352,7 @@ static int __mfc_init_instance(struct mfc_dev *dev, struct mfc_ctx *ctx)
 	ret = mfc_load_firmware(dev);
 	if (ret)
 		goto err_fw_load;
+	mfc_perf_resume_mark(dev, MFC_RESUME_FW_LOAD);
 
 #ifdef CONFIG_EXYNOS_CONTENT_PATH_PROTECTION
 	trace_mfc_dcpp_start(ctx->num, 1, dev->fw.drm_status);
@@ -388,6 +394,7 @@ static int __mfc_init_instance(struct mfc_dev *dev, struct mfc_ctx *ctx)
 		mfc_err_ctx("power on failed\n");
 		goto err_pwr_enable;
 	}
+	mfc_perf_resume_mark(dev, MFC_RESUME_POWER_ON);
 
 	dev->curr_ctx = ctx->num;
 	dev->preempt_ctx = MFC_NO_INSTANCE_SET;
@@ -398,6 +405,7 @@ static int __mfc_init_instance(struct mfc_dev *dev, struct mfc_ctx *ctx)
 		mfc_err_ctx("Failed to init mfc h/w\n");
 		goto err_hw_init;
 	}
+	mfc_perf_resume_mark(dev, MFC_RESUME_HW_INIT);
 
 	if (dev->has_mmcache && (dev->mmcache.is_on_status == 0))
 		mfc_mmcache_enable(dev);
@@ -982,6 +990,9 @@ static void __mfc_parse_dt(struct device_node *np, struct mfc_dev *mfc)
 	/* NAL-Q size */
 	of_property_read_u32(np, "nal_q_entry_size", &pdata->nal_q_entry_size);
 	of_property_read_u32(np, "nal_q_dump_size", &pdata->nal_q_dump_size);
+	of_property_read_u32(np, "nal_q_queue_size", &pdata->nal_q_queue_size);
+	if (!pdata->nal_q_queue_size || pdata->nal_q_queue_size > NAL_Q_QUEUE_SIZE_MAX)
+		pdata->nal_q_queue_size = NAL_Q_QUEUE_SIZE;
 
 	/* Features */
 	of_property_read_u32_array(np, "nal_q", &pdata->nal_q.support, 2);
@@ -1384,12 +1395,8 @@ static int mfc_probe(struct platform_device *pdev)
 	mfc_init_hwlock(dev);
 	mfc_create_bits(&dev->work_bits);
 
-	dev->watchdog_wq =
-		create_singlethread_workqueue("mfc/watchdog");
-	if (!dev->watchdog_wq) {
-		dev_err(&pdev->dev, "failed to create workqueue for watchdog\n");
-		goto err_wq_watchdog;
-	}
+	/* the watchdog work is queued by a timer, keep it off the big cores */
+	dev->watchdog_wq = exynos_little_wq;
 	INIT_WORK(&dev->watchdog_work, mfc_watchdog_worker);
 	atomic_set(&dev->watchdog_tick_running, 0);
 	atomic_set(&dev->watchdog_tick_cnt, 0);
@@ -1417,6 +1424,7 @@ static int mfc_probe(struct platform_device *pdev)
 #ifdef CONFIG_MFC_USE_BUS_DEVFREQ
 	atomic_set(&dev->qos_req_cur, 0);
 	mutex_init(&dev->qos_mutex);
+	dev->qos_cl.step = -1;
 
 	mfc_info_dev("[QoS] control: mfc_freq(%d), mo(%d), bw(%d)\n",
 			dev->pdata->mfc_freq_control, dev->pdata->mo_control, dev->pdata->bw_control);
@@ -1452,8 +1460,13 @@ static int mfc_probe(struct platform_device *pdev)
 	itmon_notifier_chain_register(&dev->itmon_nb);
 #endif
 
+	mfc_buf_pool_init(dev);
+
 	mfc_init_debugfs(dev);
 
+	/* the sysmmu resumes early, nothing else orders the resume of MFC */
+	device_enable_async_suspend(&pdev->dev);
+
 	pr_debug("%s--\n", __func__);
 	return 0;
 
@@ -1463,8 +1476,6 @@ err_alloc_debug:
 err_iovmm_active:
 	destroy_workqueue(dev->butler_wq);
 err_butler_wq:
-	destroy_workqueue(dev->watchdog_wq);
-err_wq_watchdog:
 	video_unregister_device(dev->vfd_enc_otf_drm);
 alloc_vdev_enc_otf_drm:
 	video_unregister_device(dev->vfd_enc_otf);
@@ -1504,8 +1515,7 @@ static int mfc_remove(struct platform_device *pdev)
 	dev_dbg(&pdev->dev, "%s++\n", __func__);
 	v4l2_info(&dev->v4l2_dev, "Removing %s\n", pdev->name);
 	del_timer_sync(&dev->watchdog_timer);
-	flush_workqueue(dev->watchdog_wq);
-	destroy_workqueue(dev->watchdog_wq);
+	cancel_work_sync(&dev->watchdog_work);
 	flush_workqueue(dev->butler_wq);
 	destroy_workqueue(dev->butler_wq);
 	video_unregister_device(dev->vfd_enc);
@@ -1520,6 +1530,9 @@ static int mfc_remove(struct platform_device *pdev)
 	remove_proc_entry(MFC_PROC_ROOT, NULL);
 #endif
 	mfc_destroy_listable_wq_dev(dev);
+	mfc_buf_pool_destroy(dev);
+	if (dev->fw.blob)
+		release_firmware(dev->fw.blob);
 	iovmm_deactivate(&pdev->dev);
 	mfc_debug(2, "Will now deinit HW\n");
 	mfc_run_deinit_hw(dev);
@@ -1720,6 +1733,7 @@ static struct platform_driver mfc_driver = {
 		.name	= MFC_NAME,
 		.owner	= THIS_MODULE,
 		.pm	= &mfc_pm_ops,
+		.probe_type = EXYNOS_PROBE_NONCRITICAL,
 		.of_match_table = exynos_mfc_match,
 		.suppress_bind_attrs = true,
 	},
@@ -12,12 +12,217 @@
 
 #include <linux/smc.h>
 #include <linux/firmware.h>
+#include <linux/log2.h>
+#include <soc/samsung/exynos-wq.h>
 #include <trace/events/mfc.h>
 
 #include "mfc_buf.h"
 
 #include "mfc_mem.h"
 
+/*
+ * Size class of the pooled buffer, 4 classes per power of two.
+ * Buffers of slightly different resolutions are rounded up to the same class
+ * so that they can be reused by each other.
+ */
+static size_t __mfc_buf_pool_size(size_t size)
+{
+	size_t step;
+
+	if (size <= PAGE_SIZE)
+		return PAGE_ALIGN(size);
+
+	step = max_t(size_t, rounddown_pow_of_two(size) >> 2, PAGE_SIZE);
+
+	return ALIGN(size, step);
+}
+
+static void __mfc_buf_pool_free_entry(struct mfc_dev *dev,
+		struct mfc_buf_pool_entry *entry)
+{
+	struct mfc_buf_pool *pool = &dev->buf_pool;
+
+	list_del(&entry->list);
+	pool->count--;
+	pool->total_size -= entry->buf.size;
+
+	mfc_mem_ion_free(dev, &entry->buf);
+	kfree(entry);
+}
+
+/* Take the pooled buffer of the same buftype and size class */
+static int __mfc_buf_pool_get(struct mfc_dev *dev, struct mfc_special_buf *buf)
+{
+	struct mfc_buf_pool *pool = &dev->buf_pool;
+	struct mfc_buf_pool_entry *entry;
+	int ret = -ENOENT;
+
+	mutex_lock(&pool->lock);
+	list_for_each_entry(entry, &pool->entries, list) {
+		if (entry->buf.buftype != buf->buftype ||
+				entry->buf.size != buf->size)
+			continue;
+
+		*buf = entry->buf;
+		list_del(&entry->list);
+		pool->count--;
+		pool->total_size -= buf->size;
+		kfree(entry);
+		pool->hit++;
+		ret = 0;
+		break;
+	}
+	if (ret)
+		pool->miss++;
+	mutex_unlock(&pool->lock);
+
+	return ret;
+}
+
+/* Keep the buffer in the pool, the oldest buffers are freed over the limit */
+static int __mfc_buf_pool_put(struct mfc_dev *dev, struct mfc_special_buf *buf)
+{
+	struct mfc_buf_pool *pool = &dev->buf_pool;
+	struct mfc_buf_pool_entry *entry, *old, *tmp;
+
+	if (!buf->dma_buf || buf->size > MFC_BUF_POOL_MAX_SIZE)
+		return -EINVAL;
+
+	entry = kzalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		return -ENOMEM;
+
+	entry->buf = *buf;
+	entry->expires = jiffies + msecs_to_jiffies(MFC_BUF_POOL_TIMEOUT_MS);
+
+	mutex_lock(&pool->lock);
+	list_for_each_entry_safe(old, tmp, &pool->entries, list) {
+		if (pool->count < MFC_BUF_POOL_MAX_COUNT &&
+				pool->total_size + buf->size <= MFC_BUF_POOL_MAX_SIZE)
+			break;
+		__mfc_buf_pool_free_entry(dev, old);
+		pool->reclaim++;
+	}
+	list_add_tail(&entry->list, &pool->entries);
+	pool->count++;
+	pool->total_size += buf->size;
+	if (pool->count == 1)
+		queue_delayed_work(exynos_little_wq, &pool->reclaim_work,
+				msecs_to_jiffies(MFC_BUF_POOL_TIMEOUT_MS));
+	mutex_unlock(&pool->lock);
+
+	buf->dma_buf = NULL;
+	buf->attachment = NULL;
+	buf->sgt = NULL;
+	buf->daddr = 0;
+	buf->vaddr = NULL;
+
+	return 0;
+}
+
+static void __mfc_buf_pool_reclaim_work(struct work_struct *work)
+{
+	struct mfc_buf_pool *pool = container_of(to_delayed_work(work),
+			struct mfc_buf_pool, reclaim_work);
+	struct mfc_dev *dev = container_of(pool, struct mfc_dev, buf_pool);
+	struct mfc_buf_pool_entry *entry, *tmp;
+
+	mutex_lock(&pool->lock);
+	list_for_each_entry_safe(entry, tmp, &pool->entries, list) {
+		if (time_before(jiffies, entry->expires)) {
+			queue_delayed_work(exynos_little_wq, &pool->reclaim_work,
+					entry->expires - jiffies);
+			break;
+		}
+		__mfc_buf_pool_free_entry(dev, entry);
+		pool->reclaim++;
+	}
+	mutex_unlock(&pool->lock);
+}
+
+static unsigned long __mfc_buf_pool_count(struct shrinker *shrinker,
+		struct shrink_control *sc)
+{
+	struct mfc_buf_pool *pool = container_of(shrinker,
+			struct mfc_buf_pool, shrinker);
+
+	return pool->total_size >> PAGE_SHIFT;
+}
+
+static unsigned long __mfc_buf_pool_scan(struct shrinker *shrinker,
+		struct shrink_control *sc)
+{
+	struct mfc_buf_pool *pool = container_of(shrinker,
+			struct mfc_buf_pool, shrinker);
+	struct mfc_dev *dev = container_of(pool, struct mfc_dev, buf_pool);
+	struct mfc_buf_pool_entry *entry, *tmp;
+	unsigned long freed = 0;
+
+	if (!mutex_trylock(&pool->lock))
+		return SHRINK_STOP;
+
+	list_for_each_entry_safe(entry, tmp, &pool->entries, list) {
+		if (freed >= sc->nr_to_scan)
+			break;
+		freed += entry->buf.size >> PAGE_SHIFT;
+		__mfc_buf_pool_free_entry(dev, entry);
+		pool->shrink++;
+	}
+	mutex_unlock(&pool->lock);
+
+	return freed;
+}
+
+void mfc_buf_pool_init(struct mfc_dev *dev)
+{
+	struct mfc_buf_pool *pool = &dev->buf_pool;
+
+	mutex_init(&pool->lock);
+	INIT_LIST_HEAD(&pool->entries);
+	INIT_DELAYED_WORK(&pool->reclaim_work, __mfc_buf_pool_reclaim_work);
+
+	pool->shrinker.count_objects = __mfc_buf_pool_count;
+	pool->shrinker.scan_objects = __mfc_buf_pool_scan;
+	pool->shrinker.seeks = DEFAULT_SEEKS;
+	if (register_shrinker(&pool->shrinker))
+		mfc_err_dev("[MEMINFO] failed to register buffer pool shrinker\n");
+}
+
+void mfc_buf_pool_destroy(struct mfc_dev *dev)
+{
+	struct mfc_buf_pool *pool = &dev->buf_pool;
+	struct mfc_buf_pool_entry *entry, *tmp;
+
+	unregister_shrinker(&pool->shrinker);
+	cancel_delayed_work_sync(&pool->reclaim_work);
+
+	mutex_lock(&pool->lock);
+	list_for_each_entry_safe(entry, tmp, &pool->entries, list)
+		__mfc_buf_pool_free_entry(dev, entry);
+	mutex_unlock(&pool->lock);
+}
+
+/* Only normal buffers are pooled, secure memory is given back at once */
+static int __mfc_alloc_internal_buf(struct mfc_dev *dev, struct mfc_special_buf *buf)
+{
+	if (buf->buftype == MFCBUF_NORMAL && !buf_pool_disable) {
+		buf->size = __mfc_buf_pool_size(buf->size);
+		if (!__mfc_buf_pool_get(dev, buf))
+			return 0;
+	}
+
+	return mfc_mem_ion_alloc(dev, buf);
+}
+
+static void __mfc_release_internal_buf(struct mfc_dev *dev, struct mfc_special_buf *buf)
+{
+	if (buf->buftype == MFCBUF_NORMAL && !buf_pool_disable &&
+			!__mfc_buf_pool_put(dev, buf))
+		return;
+
+	mfc_mem_ion_free(dev, buf);
+}
+
 static void __mfc_alloc_common_context(struct mfc_dev *dev,
 					enum mfc_buf_usage_type buf_type)
 {
@@ -138,7 +343,7 @@ int mfc_alloc_instance_context(struct mfc_ctx *ctx)
 	else
 		ctx->instance_ctx_buf.buftype = MFCBUF_NORMAL;
 
-	if (mfc_mem_ion_alloc(dev, &ctx->instance_ctx_buf)) {
+	if (__mfc_alloc_internal_buf(dev, &ctx->instance_ctx_buf)) {
 		mfc_err_ctx("Allocating context buffer failed\n");
 		return -ENOMEM;
 	}
@@ -156,7 +361,7 @@ void mfc_release_instance_context(struct mfc_ctx *ctx)
 
 	mfc_debug_enter();
 
-	mfc_mem_ion_free(dev, &ctx->instance_ctx_buf);
+	__mfc_release_internal_buf(dev, &ctx->instance_ctx_buf);
 	mfc_debug(2, "[MEMINFO] Release the instance buffer ctx[%d]\n", ctx->num);
 
 	mfc_debug_leave();
@@ -363,7 +568,7 @@ int mfc_alloc_codec_buffers(struct mfc_ctx *ctx)
 		ctx->codec_buf.buftype = MFCBUF_NORMAL;
 
 	if (ctx->codec_buf.size > 0) {
-		if (mfc_mem_ion_alloc(dev, &ctx->codec_buf)) {
+		if (__mfc_alloc_internal_buf(dev, &ctx->codec_buf)) {
 			mfc_err_ctx("Allocating codec buffer failed\n");
 			return -ENOMEM;
 		}
@@ -383,7 +588,7 @@ void mfc_release_codec_buffers(struct mfc_ctx *ctx)
 {
 	struct mfc_dev *dev = ctx->dev;
 
-	mfc_mem_ion_free(dev, &ctx->codec_buf);
+	__mfc_release_internal_buf(dev, &ctx->codec_buf);
 	ctx->codec_buffer_allocated = 0;
 	mfc_debug(2, "[MEMINFO] Release the codec buffer ctx[%d]\n", ctx->num);
 }
@@ -567,7 +772,7 @@ int mfc_alloc_firmware(struct mfc_dev *dev)
 /* Load firmware to MFC */
 int mfc_load_firmware(struct mfc_dev *dev)
 {
-	struct firmware *fw_blob;
+	const struct firmware *fw_blob;
 	size_t firmware_size;
 	int err;
 
@@ -576,14 +781,22 @@ int mfc_load_firmware(struct mfc_dev *dev)
 	/* Firmare has to be present as a separate file or compiled
 	 * into kernel. */
 	mfc_debug_enter();
-	mfc_debug(4, "[F/W] Requesting F/W\n");
-	err = request_firmware((const struct firmware **)&fw_blob,
-					MFC_FW_NAME, dev->v4l2_dev.dev);
+	if (dev->fw.blob && !fw_cache_disable) {
+		mfc_debug(4, "[F/W] Using the cached F/W\n");
+		fw_blob = dev->fw.blob;
+		dev->fw.blob_hit++;
+	} else {
+		if (dev->fw.blob) {
+			release_firmware(dev->fw.blob);
+			dev->fw.blob = NULL;
+		}
 
-	if (err != 0) {
-		mfc_err_dev("[F/W] Couldn't find the F/W invalid path\n");
-		release_firmware(fw_blob);
-		return -EINVAL;
+		mfc_debug(4, "[F/W] Requesting F/W\n");
+		err = request_firmware(&fw_blob, MFC_FW_NAME, dev->v4l2_dev.dev);
+		if (err != 0) {
+			mfc_err_dev("[F/W] Couldn't find the F/W invalid path\n");
+			return -EINVAL;
+		}
 	}
 
 	mfc_debug(2, "[MEMINFO][F/W] loaded F/W Size: %zu\n", fw_blob->size);
@@ -591,17 +804,21 @@ int mfc_load_firmware(struct mfc_dev *dev)
 	if (fw_blob->size > firmware_size) {
 		mfc_err_dev("[MEMINFO][F/W] MFC firmware(%zu) is too big to be loaded in memory(%zu)\n",
 				fw_blob->size, firmware_size);
-		release_firmware(fw_blob);
-		return -ENOMEM;
+		err = -ENOMEM;
+		goto err_release;
 	}
 
 	if (dev->fw_buf.dma_buf == NULL || dev->fw_buf.daddr == 0) {
 		mfc_err_dev("[F/W] MFC firmware is not allocated or was not mapped correctly\n");
-		release_firmware(fw_blob);
-		return -EINVAL;
+		err = -EINVAL;
+		goto err_release;
 	}
 
-	/*  This adds to clear with '0' for firmware memory except code region. */
+	/*
+	 * F/W uses the region after the code as its working memory, so the
+	 * image is copied again even if it is cached.
+	 * This adds to clear with '0' for firmware memory except code region.
+	 */
 	mfc_debug(4, "[F/W] memset before memcpy for normal fw\n");
 	memset((dev->fw_buf.vaddr + fw_blob->size), 0, (firmware_size - fw_blob->size));
 	memcpy(dev->fw_buf.vaddr, fw_blob->data, fw_blob->size);
@@ -611,10 +828,20 @@ int mfc_load_firmware(struct mfc_dev *dev)
 		memcpy(dev->drm_fw_buf.vaddr, fw_blob->data, fw_blob->size);
 		mfc_debug(4, "[F/W] copy firmware to secure region\n");
 	}
-	release_firmware(fw_blob);
+
+	if (fw_cache_disable)
+		release_firmware(fw_blob);
+	else
+		dev->fw.blob = fw_blob;
+
 	trace_mfc_loadfw_end(dev->fw.size, firmware_size);
 	mfc_debug_leave();
 	return 0;
+
+err_release:
+	release_firmware(fw_blob);
+	dev->fw.blob = NULL;
+	return err;
 }
 
 /* Release firmware memory */
@@ -633,5 +860,10 @@ int mfc_release_firmware(struct mfc_dev *dev)
 
 	mfc_mem_ion_free(dev, &dev->fw_buf);
 
+	if (dev->fw.blob) {
+		release_firmware(dev->fw.blob);
+		dev->fw.blob = NULL;
+	}
+
 	return 0;
 }
@@ -16,6 +16,9 @@
 #include "mfc_common.h"
 
 /* Memory allocation */
+void mfc_buf_pool_init(struct mfc_dev *dev);
+void mfc_buf_pool_destroy(struct mfc_dev *dev);
+
 void mfc_alloc_common_context(struct mfc_dev *dev);
 void mfc_release_common_context(struct mfc_dev *dev);
 
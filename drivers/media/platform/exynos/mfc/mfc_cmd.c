@@ -405,6 +405,7 @@ void mfc_cmd_dec_one_frame(struct mfc_ctx *ctx, int last_frame)
 	switch (last_frame) {
 	case 0:
 		mfc_perf_measure_on(dev);
+		mfc_perf_hw_run_begin(dev);
 
 		mfc_cmd_host2risc(dev, MFC_REG_H2R_CMD_NAL_START);
 		break;
@@ -437,6 +438,7 @@ void mfc_cmd_enc_one_frame(struct mfc_ctx *ctx, int last_frame)
 	switch (last_frame) {
 	case 0:
 		mfc_perf_measure_on(dev);
+		mfc_perf_hw_run_begin(dev);
 
 		mfc_cmd_host2risc(dev, MFC_REG_H2R_CMD_NAL_START);
 		break;
@@ -20,6 +20,7 @@
 #include <linux/ion_exynos.h>
 #include <linux/dma-buf-container.h>
 #include <media/videobuf2-dma-sg.h>
+#include <soc/samsung/exynos-frametrace.h>
 #include <asm/cacheflush.h>
 
 #include "mfc_regs.h"
@@ -59,6 +60,10 @@
 
 #define MFC_NO_INSTANCE_SET	-1
 
+/* Scheduling priority of context, 0 is the highest */
+#define MFC_SCHED_PRIO_HIGHEST	0
+#define MFC_SCHED_PRIO_LOWEST	7
+
 #define MFC_ENC_CAP_PLANE_COUNT	1
 #define MFC_ENC_OUT_PLANE_COUNT	2
 
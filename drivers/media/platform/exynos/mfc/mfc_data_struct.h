@@ -23,6 +23,11 @@
 #ifdef CONFIG_EXYNOS_BTS
 #include <soc/samsung/bts.h>
 #endif
+#ifdef CONFIG_EXYNOS_BCM
+#include <soc/samsung/bcm.h>
+#endif
+#include <linux/shrinker.h>
+#include <linux/sizes.h>
 #include <linux/videodev2.h>
 #ifdef CONFIG_EXYNOS_ITMON
 #include <soc/samsung/exynos-itmon.h>
@@ -311,6 +316,35 @@ struct mfc_fw {
 	size_t		size;
 	int		status;
 	int		drm_status;
+
+	/* F/W image kept from the first load to skip request_firmware() */
+	const struct firmware	*blob;
+	unsigned long		blob_hit;
+};
+
+/*
+ * Latency of the steps until the first frame after the F/W is started,
+ * by the first open(MFC_RESUME_OPEN) or by system resume(MFC_RESUME_WAKEUP).
+ */
+enum mfc_resume_type {
+	MFC_RESUME_OPEN		= 0,
+	MFC_RESUME_WAKEUP	= 1,
+};
+
+enum mfc_resume_stage {
+	MFC_RESUME_FW_LOAD	= 0,
+	MFC_RESUME_POWER_ON,
+	MFC_RESUME_HW_INIT,
+	MFC_RESUME_FIRST_FRAME,
+	MFC_RESUME_STAGE_MAX,
+};
+
+struct mfc_resume_latency {
+	enum mfc_resume_type type;
+	int pending;
+	ktime_t begin;
+	ktime_t last;
+	unsigned int stage_us[MFC_RESUME_STAGE_MAX];
 };
 
 struct mfc_ctx_buf_size {
@@ -367,7 +401,13 @@ struct mfc_debugfs {
 	struct dentry *sfr_dump;
 	struct dentry *mmcache_dump;
 	struct dentry *mmcache_disable;
+	struct dentry *mmcache_policy;
+	struct dentry *mmcache_bcm;
 	struct dentry *perf_boost_mode;
+	struct dentry *sched_deadline_disable;
+	struct dentry *qos_closed_loop;
+	struct dentry *buf_pool_disable;
+	struct dentry *fw_cache_disable;
 };
 
 /**
@@ -386,6 +426,35 @@ struct mfc_special_buf {
 	size_t				size;
 };
 
+/*
+ * Pool of the internal buffers released by closed instances.
+ * Buffers are kept mapped for MFC_BUF_POOL_TIMEOUT_MS and are given back
+ * to the instance which requests the same size class.
+ */
+#define MFC_BUF_POOL_MAX_COUNT		8
+#define MFC_BUF_POOL_MAX_SIZE		(SZ_64M)
+#define MFC_BUF_POOL_TIMEOUT_MS		3000
+
+struct mfc_buf_pool_entry {
+	struct list_head list;
+	struct mfc_special_buf buf;
+	unsigned long expires;
+};
+
+struct mfc_buf_pool {
+	struct mutex lock;
+	struct list_head entries;
+	unsigned int count;
+	size_t total_size;
+	struct delayed_work reclaim_work;
+	struct shrinker shrinker;
+
+	unsigned long hit;
+	unsigned long miss;
+	unsigned long reclaim;
+	unsigned long shrink;
+};
+
 #ifdef CONFIG_EXYNOS_BTS
 struct mfc_bw_data {
 	unsigned int	peak;
@@ -449,6 +518,20 @@ struct mfc_qos_weight {
 	unsigned int weight_num_of_tile;
 	unsigned int weight_super64_bframe;
 };
+
+/*
+ * Closed-loop QoS state
+ * step - QoS table index chosen from the measured H/W load, -1 if none
+ * load - H/W busy ratio(%) of all QoS contexts at the last evaluation
+ */
+struct mfc_qos_cl {
+	int step;
+	unsigned int load;
+	unsigned int frames;
+	unsigned int down_hold;
+	unsigned long up_cnt;
+	unsigned long down_cnt;
+};
 #endif
 
 struct mfc_feature {
@@ -486,6 +569,7 @@ struct mfc_platdata {
 #endif
 	/* NAL-Q size */
 	unsigned int nal_q_entry_size;
+	unsigned int nal_q_queue_size;
 	unsigned int nal_q_dump_size;
 	/* Features */
 	struct mfc_feature nal_q;
@@ -519,8 +603,9 @@ struct mfc_platdata {
 /************************ NAL_Q data structure ************************/
 #define NAL_Q_ENTRY_SIZE_FOR_HDR10	512
 
-/* slot 4 * max instance 32 = 128 */
+/* slot 4 * max instance 32 = 128, default of pdata->nal_q_queue_size */
 #define NAL_Q_QUEUE_SIZE		128
+#define NAL_Q_QUEUE_SIZE_MAX		512
 
 typedef struct __DecoderInputStr {
 	int StartCode; /* = 0xAAAAAAAA; Decoder input structure marker */
@@ -747,6 +832,14 @@ struct mfc_perf {
 	int new_start;
 	int count;
 	int drv_margin;
+
+	/* start of the frame currently running on H/W */
+	ktime_t hw_run_begin;
+
+	/* NAL-Q completion, frames handled per QUEUE_DONE interrupt */
+	unsigned long nal_q_irq_cnt;
+	unsigned long nal_q_frame_cnt;
+	unsigned int nal_q_max_batch;
 };
 
 extern struct mfc_dump_ops mfc_dump_ops;
@@ -759,9 +852,19 @@ struct mfc_dump_ops {
 	void (*dump_and_stop_debug_mode)(struct mfc_dev *dev);
 };
 
+/*
+ * bcm - BCM output of the last measurement for each mmcache status
+ *	 (index 0: disabled, 1: enabled)
+ */
 struct mfc_mmcache {
 	void __iomem *base;
 	int is_on_status;
+	unsigned long policy_switch;
+#ifdef CONFIG_EXYNOS_BCM
+	int bcm_running;
+	int bcm_status;
+	struct output_data bcm[2];
+#endif
 };
 
 /**
@@ -834,6 +937,9 @@ struct mfc_dev {
 	struct workqueue_struct *butler_wq;
 	struct work_struct butler_work;
 
+	struct mfc_buf_pool buf_pool;
+	struct mfc_resume_latency resume;
+
 #ifdef CONFIG_MFC_USE_BUS_DEVFREQ
 	struct list_head qos_queue;
 	atomic_t qos_req_cur;
@@ -843,6 +949,7 @@ struct mfc_dev {
 	struct pm_qos_request qos_req_cluster[MAX_NUM_CLUSTER];
 	int qos_has_enc_ctx;
 	struct mutex qos_mutex;
+	struct mfc_qos_cl qos_cl;
 #endif
 	int id;
 	atomic_t clk_ref;
@@ -1537,6 +1644,15 @@ struct mfc_ctx {
 	unsigned long last_framerate;
 	unsigned int qos_ratio;
 
+	/* deadline scheduling, sched_deadline is protected by work_bits.lock */
+	int sched_prio;
+	u64 sched_deadline;
+	unsigned int sched_cnt;
+	unsigned int deadline_miss;
+
+	/* average H/W time(ns) of a frame, measured from NAL_START to FRAME_DONE */
+	u64 hw_time_avg;
+
 #ifdef CONFIG_MFC_USE_BUS_DEVFREQ
 	int qos_req_step;
 	struct list_head qos_list;
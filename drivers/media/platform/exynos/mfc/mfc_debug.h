@@ -28,7 +28,12 @@ extern unsigned int otf_dump;
 extern unsigned int sfr_dump;
 extern unsigned int mmcache_dump;
 extern unsigned int mmcache_disable;
+extern unsigned int mmcache_policy;
 extern unsigned int perf_boost_mode;
+extern unsigned int sched_deadline_disable;
+extern unsigned int qos_closed_loop;
+extern unsigned int buf_pool_disable;
+extern unsigned int fw_cache_disable;
 extern unsigned int reg_test;
 
 #define mfc_debug(level, fmt, args...)				\
@@ -19,6 +19,7 @@
 #include "mfc_pm.h"
 
 #include "mfc_queue.h"
+#include "mfc_mmcache.h"
 
 unsigned int debug_level;
 unsigned int debug_ts;
@@ -32,8 +33,13 @@ unsigned int perf_measure_option;
 unsigned int sfr_dump;
 unsigned int mmcache_dump;
 unsigned int mmcache_disable;
+unsigned int mmcache_policy = MFC_MMCACHE_POLICY_ALL;
 unsigned int perf_boost_mode;
 unsigned int reg_test;
+unsigned int sched_deadline_disable;
+unsigned int qos_closed_loop;
+unsigned int buf_pool_disable;
+unsigned int fw_cache_disable;
 
 static int __mfc_info_show(struct seq_file *s, void *unused)
 {
@@ -55,10 +61,18 @@ static int __mfc_info_show(struct seq_file *s, void *unused)
 			dev->hwlock.owned_by_irq, dev->hwlock.wl_count);
 	seq_printf(s, "[DEBUG MODE] dt: %s sysfs: %s\n", dev->pdata->debug_mode ? "enabled" : "disabled",
 			debug_mode_en ? "enabled" : "disabled");
-	seq_printf(s, "[MMCACHE] %s(%s)\n",
+	seq_printf(s, "[MMCACHE] %s(%s), policy: %#x, switch: %lu\n",
 			dev->has_mmcache ? "supported" : "not supported",
-			dev->mmcache.is_on_status ? "enabled" : "disabled");
+			dev->mmcache.is_on_status ? "enabled" : "disabled",
+			mmcache_policy, dev->mmcache.policy_switch);
 	seq_printf(s, "[PERF BOOST] %s\n", perf_boost_mode ? "enabled" : "disabled");
+#ifdef CONFIG_MFC_USE_BUS_DEVFREQ
+	seq_printf(s, "[QoS] table[%d], closed-loop: %s(step: %d, load: %d%%, up: %lu, down: %lu)\n",
+			atomic_read(&dev->qos_req_cur) - 1,
+			qos_closed_loop ? "enabled" : "disabled",
+			dev->qos_cl.step, dev->qos_cl.load,
+			dev->qos_cl.up_cnt, dev->qos_cl.down_cnt);
+#endif
 	seq_printf(s, "[FEATURES] nal_q: %d(0x%x), skype: %d(0x%x), black_bar: %d(0x%x)\n",
 			dev->pdata->nal_q.support, dev->pdata->nal_q.version,
 			dev->pdata->skype.support, dev->pdata->skype.version,
@@ -74,8 +88,30 @@ static int __mfc_info_show(struct seq_file *s, void *unused)
 			dev->pdata->support_422 ? "supported" : "not supported",
 			dev->pdata->support_rgb ? "supported" : "not supported");
 	seq_printf(s, "[LOWMEM] is_low_mem: %d\n", IS_LOW_MEM);
+	seq_printf(s, "[F/W] cache: %s(hit: %lu)\n",
+			dev->fw.blob ? "kept" : "none", dev->fw.blob_hit);
+	seq_printf(s, "[RESUME] %s%s: fw load: %uus, power on: %uus, hw init: %uus, first frame: %uus\n",
+			dev->resume.type == MFC_RESUME_OPEN ? "open" : "wakeup",
+			dev->resume.pending ? "(running)" : "",
+			dev->resume.stage_us[MFC_RESUME_FW_LOAD],
+			dev->resume.stage_us[MFC_RESUME_POWER_ON],
+			dev->resume.stage_us[MFC_RESUME_HW_INIT],
+			dev->resume.stage_us[MFC_RESUME_FIRST_FRAME]);
+	seq_printf(s, "[BUF POOL] %s, count: %u, size: %zu, hit: %lu, miss: %lu, reclaim: %lu, shrink: %lu\n",
+			buf_pool_disable ? "disabled" : "enabled",
+			dev->buf_pool.count, dev->buf_pool.total_size,
+			dev->buf_pool.hit, dev->buf_pool.miss,
+			dev->buf_pool.reclaim, dev->buf_pool.shrink);
 	if (dev->nal_q_handle)
 		seq_printf(s, "[NAL-Q] state: %d\n", dev->nal_q_handle->nal_q_state);
+	seq_printf(s, "[NAL-Q] queue size: %d, irq: %lu, frames: %lu (%lu.%02lu/irq, max %u)\n",
+			dev->pdata->nal_q_queue_size,
+			dev->perf.nal_q_irq_cnt, dev->perf.nal_q_frame_cnt,
+			dev->perf.nal_q_irq_cnt ?
+			dev->perf.nal_q_frame_cnt / dev->perf.nal_q_irq_cnt : 0,
+			dev->perf.nal_q_irq_cnt ?
+			(dev->perf.nal_q_frame_cnt * 100 / dev->perf.nal_q_irq_cnt) % 100 : 0,
+			dev->perf.nal_q_max_batch);
 
 	seq_puts(s, ">> MFC device information(instance)\n");
 	for (i = 0; i < MFC_NUM_CONTEXTS; i++) {
@@ -96,6 +132,10 @@ static int __mfc_info_show(struct seq_file *s, void *unused)
 				mfc_get_queue_count(&ctx->buf_queue_lock, &ctx->src_buf_nal_queue),
 				mfc_get_queue_count(&ctx->buf_queue_lock, &ctx->dst_buf_nal_queue),
 				mfc_get_queue_count(&ctx->buf_queue_lock, &ctx->ref_buf_queue));
+			seq_printf(s, "        sched(prio: %d, fps: %ld, run: %u, deadline miss: %u, hw time: %lluus)\n",
+				ctx->sched_prio, ctx->framerate / 1000,
+				ctx->sched_cnt, ctx->deadline_miss,
+				div_u64(ctx->hw_time_avg, NSEC_PER_USEC));
 		}
 	}
 
@@ -117,6 +157,12 @@ static int __mfc_debug_info_show(struct seq_file *s, void *unused)
 	seq_puts(s, "64  (1 << 6): ERR interrupt\n");
 	seq_puts(s, "128 (1 << 7): WARN interrupt\n");
 
+	seq_puts(s, "-----mmcache policy options (bit setting)\n");
+	seq_puts(s, "ex) echo 6 > /d/mfc/mmcache_policy (dec and enc over FHD)\n");
+	seq_puts(s, "1   (1 << 0): always\n");
+	seq_puts(s, "2   (1 << 1): decoder of H.264/HEVC/VP8/VP9\n");
+	seq_puts(s, "4   (1 << 2): encoder\n");
+
 	seq_puts(s, "-----Performance boost options (bit setting)\n");
 	seq_puts(s, "ex) echo 7 > /d/mfc/perf_boost_mode (max freq)\n");
 	seq_puts(s, "1   (1 << 0): DVFS (INT/MFC/MIF)\n");
@@ -196,6 +242,59 @@ static ssize_t __mfc_reg_info_write(struct file *file, const char __user *user_b
 }
 #endif
 
+#ifdef CONFIG_EXYNOS_BCM
+static int __mfc_mmcache_bcm_show(struct seq_file *s, void *unused)
+{
+	struct mfc_dev *dev = s->private;
+	struct output_data *out;
+	int i;
+
+	seq_printf(s, ">> MFC mmcache BCM (%s)\n",
+			dev->mmcache.bcm_running ? "running" : "stopped");
+	for (i = 0; i < 2; i++) {
+		out = &dev->mmcache.bcm[i];
+		seq_printf(s, "mmcache %s: rd0: %u, rd1: %u, rd2: %u, rd3: %llu, rd4: %llu, rd5: %llu\n",
+				i ? "on" : "off", out->rd0, out->rd1, out->rd2,
+				out->rd3, out->rd4, out->rd5);
+	}
+
+	return 0;
+}
+
+/* echo 1 to start, echo 0 to stop and keep the result */
+static ssize_t __mfc_mmcache_bcm_write(struct file *file, const char __user *user_buf,
+					size_t count, loff_t *ppos)
+{
+	struct mfc_dev *dev = ((struct seq_file *)file->private_data)->private;
+	unsigned int start;
+	int ret;
+
+	ret = kstrtouint_from_user(user_buf, count, 0, &start);
+	if (ret)
+		return ret;
+
+	if (start)
+		mfc_mmcache_bcm_start(dev);
+	else
+		mfc_mmcache_bcm_stop(dev);
+
+	return count;
+}
+
+static int __mfc_mmcache_bcm_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, __mfc_mmcache_bcm_show, inode->i_private);
+}
+
+static const struct file_operations mmcache_bcm_fops = {
+	.open = __mfc_mmcache_bcm_open,
+	.read = seq_read,
+	.write = __mfc_mmcache_bcm_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+#endif
+
 static int __mfc_info_open(struct inode *inode, struct file *file)
 {
 	return single_open(file, __mfc_info_show, inode->i_private);
@@ -281,6 +380,20 @@ void mfc_init_debugfs(struct mfc_dev *dev)
 			0644, debugfs->root, &mmcache_dump);
 	debugfs->mmcache_disable = debugfs_create_u32("mmcache_disable",
 			0644, debugfs->root, &mmcache_disable);
+	debugfs->mmcache_policy = debugfs_create_u32("mmcache_policy",
+			0644, debugfs->root, &mmcache_policy);
+#ifdef CONFIG_EXYNOS_BCM
+	debugfs->mmcache_bcm = debugfs_create_file("mmcache_bcm",
+			0644, debugfs->root, dev, &mmcache_bcm_fops);
+#endif
 	debugfs->perf_boost_mode = debugfs_create_u32("perf_boost_mode",
 			0644, debugfs->root, &perf_boost_mode);
+	debugfs->sched_deadline_disable = debugfs_create_u32("sched_deadline_disable",
+			0644, debugfs->root, &sched_deadline_disable);
+	debugfs->qos_closed_loop = debugfs_create_u32("qos_closed_loop",
+			0644, debugfs->root, &qos_closed_loop);
+	debugfs->buf_pool_disable = debugfs_create_u32("buf_pool_disable",
+			0644, debugfs->root, &buf_pool_disable);
+	debugfs->fw_cache_disable = debugfs_create_u32("fw_cache_disable",
+			0644, debugfs->root, &fw_cache_disable);
 }
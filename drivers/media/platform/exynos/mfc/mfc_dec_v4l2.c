@@ -985,6 +985,9 @@ static int __mfc_dec_get_ctrl_val(struct mfc_ctx *ctx, struct v4l2_control *ctrl
 	case V4L2_CID_MPEG_VIDEO_QOS_RATIO:
 		ctrl->value = ctx->qos_ratio;
 		break;
+	case V4L2_CID_MPEG_VIDEO_PRIORITY:
+		ctrl->value = ctx->sched_prio;
+		break;
 	case V4L2_CID_MPEG_MFC_SET_DYNAMIC_DPB_MODE:
 		ctrl->value = dec->is_dynamic_dpb;
 		break;
@@ -1103,6 +1106,10 @@ static int mfc_dec_s_ctrl(struct file *file, void *priv,
 		ctx->qos_ratio = ctrl->value;
 		mfc_info_ctx("[QoS] set %d qos_ratio\n", ctrl->value);
 		break;
+	case V4L2_CID_MPEG_VIDEO_PRIORITY:
+		ctx->sched_prio = ctrl->value;
+		mfc_info_ctx("[SCHED] set %d priority\n", ctrl->value);
+		break;
 	case V4L2_CID_MPEG_MFC_SET_DYNAMIC_DPB_MODE:
 		dec->is_dynamic_dpb = ctrl->value;
 		if (dec->is_dynamic_dpb == 0)
@@ -434,6 +434,8 @@ static void mfc_enc_buf_queue(struct vb2_buffer *vb)
 			mfc_debug(2, "[BUFINFO] ctx[%d] add src index: %d, addr[%d]: 0x%08llx\n",
 					ctx->num, vb->index, i, buf->addr[0][i]);
 		mfc_add_tail_buf(&ctx->buf_queue_lock, &ctx->src_buf_queue, buf);
+		exynos_frametrace(vb->planes[0].dbuf,
+				EXYNOS_FRAMETRACE_MFC_QBUF, ctx->num);
 
 		if (debug_ts == 1)
 			mfc_info_ctx("[TS] framerate: %ld, timestamp: %lld\n",
@@ -21,6 +21,7 @@
 #include "mfc_cmd.h"
 #include "mfc_reg_api.h"
 #include "mfc_hw_reg_api.h"
+#include "mfc_mmcache.h"
 
 #include "mfc_queue.h"
 #include "mfc_utils.h"
@@ -678,6 +679,8 @@ int mfc_just_run(struct mfc_dev *dev, int new_ctx_index)
 	mfc_debug(2, "New context: %d\n", new_ctx_index);
 	dev->curr_ctx = ctx->num;
 
+	mfc_sched_dispatch(ctx);
+
 	/* Got context to run in ctx */
 	mfc_debug(2, "src: %d, dst: %d, state: %d, dpb_count = %d\n",
 		mfc_get_queue_count(&ctx->buf_queue_lock, &ctx->src_buf_queue),
@@ -718,6 +721,8 @@ int mfc_just_run(struct mfc_dev *dev, int new_ctx_index)
 	if (need_cache_flush)
 		mfc_cache_flush(dev, ctx->is_drm);
 
+	mfc_mmcache_apply_policy(dev);
+
 	if (ctx->type == MFCINST_DECODER) {
 		ret = __mfc_just_run_dec(ctx);
 	} else if (ctx->type == MFCINST_ENCODER) {
@@ -816,6 +816,8 @@ static void __mfc_handle_stream_input(struct mfc_ctx *ctx)
 				if (src_mb) {
 					for (i = 0; i < raw->num_planes; i++)
 						mfc_bufcon_put_daddr(ctx, src_mb, i);
+					exynos_frametrace(src_mb->vb.vb2_buf.planes[0].dbuf,
+							EXYNOS_FRAMETRACE_MFC_DONE, ctx->num);
 					vb2_buffer_done(&src_mb->vb.vb2_buf, VB2_BUF_STATE_DONE);
 
 					/* encoder src buffer CFW UNPROT */
@@ -836,6 +838,8 @@ static void __mfc_handle_stream_input(struct mfc_ctx *ctx)
 				mfc_err_ctx("failed in recover_buf_ctrls_val\n");
 
 			mfc_debug(3, "find src buf in src_queue\n");
+			exynos_frametrace(src_mb->vb.vb2_buf.planes[0].dbuf,
+					EXYNOS_FRAMETRACE_MFC_DONE, ctx->num);
 			vb2_buffer_done(&src_mb->vb.vb2_buf, VB2_BUF_STATE_DONE);
 
 			/* encoder src buffer CFW UNPROT */
@@ -847,6 +851,8 @@ static void __mfc_handle_stream_input(struct mfc_ctx *ctx)
 					&ctx->ref_buf_queue, enc_addr[0]);
 			if (ref_mb) {
 				mfc_debug(3, "find src buf in ref_queue\n");
+				exynos_frametrace(ref_mb->vb.vb2_buf.planes[0].dbuf,
+						EXYNOS_FRAMETRACE_MFC_DONE, ctx->num);
 				vb2_buffer_done(&ref_mb->vb.vb2_buf, VB2_BUF_STATE_DONE);
 
 				/* encoder src buffer CFW UNPROT */
@@ -1259,6 +1265,15 @@ irqreturn_t mfc_top_half_irq(int irq, void *priv)
 
 	mfc_perf_measure_off(dev);
 
+	if (reason == MFC_REG_R2H_CMD_FRAME_DONE_RET && !mfc_get_err(err))
+		mfc_perf_hw_run_end(dev, ctx);
+	else
+		dev->perf.hw_run_begin = ktime_set(0, 0);
+
+	if (reason == MFC_REG_R2H_CMD_FRAME_DONE_RET ||
+			reason == MFC_REG_R2H_CMD_QUEUE_DONE_RET)
+		mfc_perf_resume_mark(dev, MFC_RESUME_FIRST_FRAME);
+
 	return IRQ_WAKE_THREAD;
 }
 
@@ -1273,28 +1288,45 @@ static inline int __mfc_nal_q_irq(struct mfc_dev *dev,
 {
 	int ret = -1;
 	unsigned int errcode;
+	unsigned int frames = 0;
 
 	nal_queue_handle *nal_q_handle = dev->nal_q_handle;
 	EncoderOutputStr *pOutStr;
 
 	switch (reason) {
 	case MFC_REG_R2H_CMD_QUEUE_DONE_RET:
-		pOutStr = mfc_nal_q_dequeue_out_buf(dev,
-			nal_q_handle->nal_q_out_handle, &errcode);
-		if (pOutStr) {
+		/*
+		 * Handle all the outputs that are done until now. The outputs
+		 * of the following interrupts may be already handled here.
+		 */
+		while (frames < dev->pdata->nal_q_queue_size) {
+			pOutStr = mfc_nal_q_dequeue_out_buf(dev,
+				nal_q_handle->nal_q_out_handle, &errcode);
+			if (!pOutStr)
+				break;
+
 			if (mfc_nal_q_handle_out_buf(dev, pOutStr))
 				mfc_err_dev("[NALQ] Failed to handle out buf\n");
-		} else {
-			mfc_err_dev("[NALQ] pOutStr is NULL\n");
+			frames++;
+
+			if (nal_q_handle->nal_q_exception)
+				break;
 		}
 
+		if (!frames)
+			mfc_debug(2, "[NALQ] out buf is already handled\n");
+
+		mfc_perf_nal_q_irq(dev, frames);
+
 		if (nal_q_handle->nal_q_exception)
 			mfc_set_bit(nal_q_handle->nal_q_out_handle->nal_q_ctx,
 					&dev->work_bits);
 		mfc_clear_int();
 
+		/* a clock reference was taken for each input by enqueue */
 		if (!nal_q_handle->nal_q_exception)
-			mfc_nal_q_clock_off(dev, nal_q_handle);
+			while (frames--)
+				mfc_nal_q_clock_off(dev, nal_q_handle);
 
 		ret = 0;
 		break;
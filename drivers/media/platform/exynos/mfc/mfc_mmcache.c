@@ -208,3 +208,107 @@ void mfc_invalidate_mmcache(struct mfc_dev *dev)
 
 	mfc_debug_leave();
 }
+
+static int __mfc_mmcache_inter_dec(struct mfc_ctx *ctx)
+{
+	switch (ctx->codec_mode) {
+	case MFC_REG_CODEC_H264_DEC:
+	case MFC_REG_CODEC_H264_MVC_DEC:
+	case MFC_REG_CODEC_HEVC_DEC:
+	case MFC_REG_CODEC_VP8_DEC:
+	case MFC_REG_CODEC_VP9_DEC:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static int __mfc_mmcache_policy_wanted(struct mfc_dev *dev)
+{
+	struct mfc_ctx *ctx;
+	unsigned int mb;
+	int i;
+
+	if (mmcache_policy & MFC_MMCACHE_POLICY_ALL)
+		return 1;
+
+	for (i = 0; i < MFC_NUM_CONTEXTS; i++) {
+		ctx = dev->ctx[i];
+		if (!ctx)
+			continue;
+
+		mb = DIV_ROUND_UP(ctx->img_width, 16) * DIV_ROUND_UP(ctx->img_height, 16);
+		if (mb < MMCACHE_POLICY_MIN_MB)
+			continue;
+
+		if (ctx->type == MFCINST_DECODER && (mmcache_policy & MFC_MMCACHE_POLICY_DEC) &&
+				__mfc_mmcache_inter_dec(ctx))
+			return 1;
+		if (ctx->type == MFCINST_ENCODER && (mmcache_policy & MFC_MMCACHE_POLICY_ENC))
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Turn the mmcache on or off by the policy for the current contexts.
+ * It has to be called with the clock on while the H/W is idle.
+ */
+void mfc_mmcache_apply_policy(struct mfc_dev *dev)
+{
+	int wanted;
+
+	if (!dev->has_mmcache || mmcache_disable)
+		return;
+
+	wanted = __mfc_mmcache_policy_wanted(dev);
+	if (wanted == dev->mmcache.is_on_status)
+		return;
+
+	mfc_debug(2, "[MMCACHE] policy %#x: %s\n", mmcache_policy,
+			wanted ? "enable" : "disable");
+
+	if (wanted) {
+		mfc_mmcache_enable(dev);
+	} else {
+		mfc_invalidate_mmcache(dev);
+		mfc_mmcache_disable(dev);
+	}
+	dev->mmcache.policy_switch++;
+}
+
+#ifdef CONFIG_EXYNOS_BCM
+void mfc_mmcache_bcm_start(struct mfc_dev *dev)
+{
+	if (dev->mmcache.bcm_running)
+		return;
+
+	bcm_start(NULL);
+	dev->mmcache.bcm_status = dev->mmcache.is_on_status;
+	dev->mmcache.bcm_running = 1;
+	mfc_debug(2, "[MMCACHE] BCM started (mmcache %s)\n",
+			dev->mmcache.bcm_status ? "on" : "off");
+}
+
+/* The result is kept for the mmcache status at the start */
+void mfc_mmcache_bcm_stop(struct mfc_dev *dev)
+{
+	struct output_data *out;
+
+	if (!dev->mmcache.bcm_running)
+		return;
+
+	out = bcm_stop(NULL);
+	dev->mmcache.bcm_running = 0;
+	if (!out) {
+		mfc_err_dev("[MMCACHE] BCM has no result\n");
+		return;
+	}
+
+	if (dev->mmcache.bcm_status != dev->mmcache.is_on_status)
+		mfc_info_dev("[MMCACHE] status is changed during BCM measurement\n");
+
+	dev->mmcache.bcm[dev->mmcache.bcm_status ? 1 : 0] = *out;
+}
+#endif
@@ -29,6 +29,19 @@
 
 #define MMCACHE_GROUP2			0x2
 
+/*
+ * mmcache policy (bit setting)
+ * ALL: always enabled while MFC is running
+ * DEC: enabled for the decoders of inter-predicted codecs over MMCACHE_POLICY_MIN_MB
+ * ENC: enabled for the encoders over MMCACHE_POLICY_MIN_MB
+ */
+#define MFC_MMCACHE_POLICY_ALL		(1 << 0)
+#define MFC_MMCACHE_POLICY_DEC		(1 << 1)
+#define MFC_MMCACHE_POLICY_ENC		(1 << 2)
+
+/* FHD, small frames have few reference reads to be hit */
+#define MMCACHE_POLICY_MIN_MB		((1920 / 16) * (1088 / 16))
+
 /* Need HW lock to call this function */
 
 void mfc_mmcache_enable(struct mfc_dev *dev);
@@ -37,5 +50,11 @@ void mfc_mmcache_disable(struct mfc_dev *dev);
 
 /* Need HW lock to call this function */
 void mfc_invalidate_mmcache(struct mfc_dev *dev);
+void mfc_mmcache_apply_policy(struct mfc_dev *dev);
+
+#ifdef CONFIG_EXYNOS_BCM
+void mfc_mmcache_bcm_start(struct mfc_dev *dev);
+void mfc_mmcache_bcm_stop(struct mfc_dev *dev);
+#endif
 
 #endif /* __MFC_MMCACHE_H */
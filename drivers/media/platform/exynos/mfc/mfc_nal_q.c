@@ -217,7 +217,7 @@ static nal_queue_in_handle* __mfc_nal_q_create_in_q(struct mfc_dev *dev,
 	 *     512 byte * 4 slot * 32 instance = 64KB
 	 * Plus 1 is needed for margin, because F/W exceeds sometimes.
 	 */
-	nal_q_in_handle->in_buf.size = dev->pdata->nal_q_entry_size * (NAL_Q_QUEUE_SIZE + 1);
+	nal_q_in_handle->in_buf.size = dev->pdata->nal_q_entry_size * (dev->pdata->nal_q_queue_size + 1);
 	if (mfc_mem_ion_alloc(dev, &nal_q_in_handle->in_buf)) {
 		mfc_err_dev("[NALQ] failed to get memory\n");
 		kfree(nal_q_in_handle);
@@ -251,7 +251,7 @@ static nal_queue_out_handle* __mfc_nal_q_create_out_q(struct mfc_dev *dev,
 	 *     512 byte * 4 slot * 32 instance = 64KB
 	 * Plus 1 is needed for margin, because F/W exceeds sometimes.
 	 */
-	nal_q_out_handle->out_buf.size = dev->pdata->nal_q_entry_size * (NAL_Q_QUEUE_SIZE + 1);
+	nal_q_out_handle->out_buf.size = dev->pdata->nal_q_entry_size * (dev->pdata->nal_q_queue_size + 1);
 	if (mfc_mem_ion_alloc(dev, &nal_q_out_handle->out_buf)) {
 		mfc_err_dev("[NALQ] failed to get memory\n");
 		kfree(nal_q_out_handle);
@@ -401,7 +401,7 @@ void mfc_nal_q_start(struct mfc_dev *dev, nal_queue_handle *nal_q_handle)
 
 	addr = nal_q_handle->nal_q_in_handle->in_buf.daddr;
 
-	mfc_update_nal_queue_input(dev, addr, dev->pdata->nal_q_entry_size * NAL_Q_QUEUE_SIZE);
+	mfc_update_nal_queue_input(dev, addr, dev->pdata->nal_q_entry_size * dev->pdata->nal_q_queue_size);
 
 	mfc_debug(2, "[NALQ] MFC_REG_NAL_QUEUE_INPUT_ADDR=0x%x\n",
 		mfc_get_nal_q_input_addr());
@@ -410,7 +410,7 @@ void mfc_nal_q_start(struct mfc_dev *dev, nal_queue_handle *nal_q_handle)
 
 	addr = nal_q_handle->nal_q_out_handle->out_buf.daddr;
 
-	mfc_update_nal_queue_output(dev, addr, dev->pdata->nal_q_entry_size * NAL_Q_QUEUE_SIZE);
+	mfc_update_nal_queue_output(dev, addr, dev->pdata->nal_q_entry_size * dev->pdata->nal_q_queue_size);
 
 	mfc_debug(2, "[NALQ] MFC_REG_NAL_QUEUE_OUTPUT_ADDR=0x%x\n",
 		mfc_get_nal_q_output_addr());
@@ -1881,23 +1881,23 @@ int mfc_nal_q_enqueue_in_buf(struct mfc_dev *dev, struct mfc_ctx *ctx,
 
 	/*
 	 * meaning of the variable input_diff
-	 * 0:				number of available slots = NAL_Q_QUEUE_SIZE
-	 * 1:				number of available slots = NAL_Q_QUEUE_SIZE - 1
+	 * 0:				number of available slots = queue_size
+	 * 1:				number of available slots = queue_size - 1
 	 * ...
-	 * NAL_Q_QUEUE_SIZE-1:		number of available slots = 1
-	 * NAL_Q_QUEUE_SIZE:		number of available slots = 0
+	 * queue_size-1:		number of available slots = 1
+	 * queue_size:			number of available slots = 0
 	 */
 
 	mfc_debug(2, "[NALQ] input_diff = %d(in: %d, exe: %d)\n",
 			input_diff, input_count, input_exe_count);
 
-	if ((input_diff < 0) || (input_diff >= NAL_Q_QUEUE_SIZE)) {
+	if ((input_diff < 0) || (input_diff >= (int)dev->pdata->nal_q_queue_size)) {
 		mfc_err_dev("[NALQ] No available input slot(%d)\n", input_diff);
 		spin_unlock_irqrestore(&nal_q_in_handle->nal_q_handle->lock, flags);
 		return -EINVAL;
 	}
 
-	index = input_count % NAL_Q_QUEUE_SIZE;
+	index = input_count % dev->pdata->nal_q_queue_size;
 	offset = dev->pdata->nal_q_entry_size * index;
 	pStr = (EncoderInputStr *)(nal_q_in_handle->nal_q_in_addr + offset);
 
@@ -1974,24 +1974,25 @@ EncoderOutputStr *mfc_nal_q_dequeue_out_buf(struct mfc_dev *dev,
 	 * 0:				number of output slots = 0
 	 * 1:				number of output slots = 1
 	 * ...
-	 * NAL_Q_QUEUE_SIZE-1:		number of output slots = NAL_Q_QUEUE_SIZE - 1
-	 * NAL_Q_QUEUE_SIZE:		number of output slots = NAL_Q_QUEUE_SIZE
+	 * queue_size-1:		number of output slots = queue_size - 1
+	 * queue_size:			number of output slots = queue_size
 	 */
 
 	mfc_debug(2, "[NALQ] output_diff = %d(out: %d, exe: %d)\n",
 			output_diff, output_count, output_exe_count);
-	if ((output_diff <= 0) || (output_diff > NAL_Q_QUEUE_SIZE)) {
+	if ((output_diff <= 0) || (output_diff > (int)dev->pdata->nal_q_queue_size)) {
 		spin_unlock_irqrestore(&nal_q_out_handle->nal_q_handle->lock, flags);
 		mfc_debug(2, "[NALQ] No available output slot(%d)\n", output_diff);
 		return pStr;
 	}
 
-	index = output_exe_count % NAL_Q_QUEUE_SIZE;
+	index = output_exe_count % dev->pdata->nal_q_queue_size;
 	offset = dev->pdata->nal_q_entry_size * index;
 	pStr = (EncoderOutputStr *)(nal_q_out_handle->nal_q_out_addr + offset);
 
 	nal_q_out_handle->nal_q_ctx = __mfc_nal_q_find_ctx(dev, pStr);
 	if (nal_q_out_handle->nal_q_ctx < 0) {
+		spin_unlock_irqrestore(&nal_q_out_handle->nal_q_handle->lock, flags);
 		mfc_err_dev("[NALQ] Can't find ctx in nal q\n");
 		pStr = NULL;
 		return pStr;
@@ -12,6 +12,72 @@
 
 #include "mfc_perf_measure.h"
 
+/* Number of NAL-Q outputs handled by a QUEUE_DONE interrupt */
+void mfc_perf_nal_q_irq(struct mfc_dev *dev, unsigned int frames)
+{
+	dev->perf.nal_q_irq_cnt++;
+	dev->perf.nal_q_frame_cnt += frames;
+	if (frames > dev->perf.nal_q_max_batch)
+		dev->perf.nal_q_max_batch = frames;
+}
+
+void mfc_perf_hw_run_begin(struct mfc_dev *dev)
+{
+	dev->perf.hw_run_begin = ktime_get();
+}
+
+/*
+ * Update the average H/W time of the frame which is finished now.
+ * Average is weighted by 1/8 to the new frame, the first frame is taken as is.
+ */
+void mfc_perf_hw_run_end(struct mfc_dev *dev, struct mfc_ctx *ctx)
+{
+	u64 hw_time;
+
+	if (!ktime_to_ns(dev->perf.hw_run_begin))
+		return;
+
+	hw_time = ktime_to_ns(ktime_sub(ktime_get(), dev->perf.hw_run_begin));
+	dev->perf.hw_run_begin = ktime_set(0, 0);
+
+	if (!ctx->hw_time_avg)
+		ctx->hw_time_avg = hw_time;
+	else
+		ctx->hw_time_avg = (ctx->hw_time_avg * 7 + hw_time) >> 3;
+}
+
+void mfc_perf_resume_begin(struct mfc_dev *dev, enum mfc_resume_type type)
+{
+	struct mfc_resume_latency *resume = &dev->resume;
+
+	memset(resume->stage_us, 0, sizeof(resume->stage_us));
+	resume->type = type;
+	resume->begin = ktime_get();
+	resume->last = resume->begin;
+	resume->pending = 1;
+}
+
+/* Time from the previous stage, the first frame finishes the measurement */
+void mfc_perf_resume_mark(struct mfc_dev *dev, enum mfc_resume_stage stage)
+{
+	struct mfc_resume_latency *resume = &dev->resume;
+	ktime_t now;
+
+	if (!resume->pending)
+		return;
+
+	now = ktime_get();
+	resume->stage_us[stage] = (unsigned int)ktime_us_delta(now, resume->last);
+	resume->last = now;
+
+	if (stage == MFC_RESUME_FIRST_FRAME) {
+		resume->pending = 0;
+		mfc_debug(2, "[PERF] %s to first frame %lldus\n",
+				resume->type == MFC_RESUME_OPEN ? "open" : "wakeup",
+				ktime_us_delta(now, resume->begin));
+	}
+}
+
 #ifndef PERF_MEASURE
 
 void mfc_perf_register(struct mfc_dev *dev) {}
@@ -23,6 +23,11 @@ void __mfc_measure_on(struct mfc_dev *dev);
 void __mfc_measure_off(struct mfc_dev *dev);
 void __mfc_measure_store(struct mfc_dev *dev, int diff);
 void mfc_perf_print(void);
+void mfc_perf_nal_q_irq(struct mfc_dev *dev, unsigned int frames);
+void mfc_perf_hw_run_begin(struct mfc_dev *dev);
+void mfc_perf_hw_run_end(struct mfc_dev *dev, struct mfc_ctx *ctx);
+void mfc_perf_resume_begin(struct mfc_dev *dev, enum mfc_resume_type type);
+void mfc_perf_resume_mark(struct mfc_dev *dev, enum mfc_resume_stage stage);
 
 //#define PERF_MEASURE
 
@@ -193,6 +193,9 @@ static void __mfc_qos_operate(struct mfc_ctx *ctx, int opr_type, int idx)
 #endif
 
 		atomic_set(&dev->qos_req_cur, 0);
+		dev->qos_cl.step = -1;
+		dev->qos_cl.frames = 0;
+		dev->qos_cl.down_hold = 0;
 		MFC_TRACE_CTX("QoS remove\n");
 		mfc_debug(2, "[QoS] QoS remove\n");
 		break;
@@ -524,8 +527,11 @@ void mfc_qos_on(struct mfc_ctx *ctx)
 		if (qos_ctx == ctx)
 			found = 1;
 
-	if (!found)
+	/* the measured load is not valid for the new set of contexts */
+	if (!found) {
 		list_add_tail(&ctx->qos_list, &dev->qos_queue);
+		dev->qos_cl.step = -1;
+	}
 
 #ifdef CONFIG_EXYNOS_BTS
 	curr_mfc_bw.peak = 0;
@@ -571,6 +577,12 @@ void mfc_qos_on(struct mfc_ctx *ctx)
 	if (total_mb > pdata->max_mb)
 		mfc_debug(4, "[QoS] overspec mb %ld > %d\n", total_mb, pdata->max_mb);
 
+	if (qos_closed_loop && dev->qos_cl.step >= 0) {
+		mfc_debug(4, "[QoS][CL] table[%d] -> table[%d] by load %d%%\n",
+				i, dev->qos_cl.step, dev->qos_cl.load);
+		i = min(dev->qos_cl.step, start_qos_step - 1);
+	}
+
 #ifdef CONFIG_EXYNOS_BTS
 	__mfc_qos_set(ctx, &curr_mfc_bw, i);
 #else
@@ -656,8 +668,10 @@ void mfc_qos_off(struct mfc_ctx *ctx)
 	if (total_mb > pdata->max_mb)
 		mfc_debug(4, "[QoS] overspec mb %ld > %d\n", total_mb, pdata->max_mb);
 
-	if (found)
+	if (found) {
 		list_del(&ctx->qos_list);
+		dev->qos_cl.step = -1;
+	}
 
 	if (list_empty(&dev->qos_queue) || total_mb == 0) {
 		mutex_lock(&dev->qos_mutex);
@@ -671,6 +685,111 @@ void mfc_qos_off(struct mfc_ctx *ctx)
 #endif
 	}
 }
+
+/* Frequency of the QoS step to which the H/W time is proportional */
+static inline unsigned int __mfc_qos_cl_freq(struct mfc_dev *dev, int i)
+{
+	struct mfc_qos *qos_table = dev->pdata->qos_table;
+
+	if (dev->pdata->mfc_freq_control)
+		return qos_table[i].freq_mfc;
+
+	return qos_table[i].freq_int;
+}
+
+/* Load(%) expected at QoS step @to when @load is measured at step @from */
+static inline unsigned int __mfc_qos_cl_load_at(struct mfc_dev *dev,
+		unsigned int load, int from, int to)
+{
+	unsigned int freq_to = __mfc_qos_cl_freq(dev, to);
+
+	if (!freq_to)
+		return load;
+
+	return (unsigned int)div_u64((u64)load * __mfc_qos_cl_freq(dev, from), freq_to);
+}
+
+/*
+ * Closed-loop QoS
+ * H/W load is the sum of (fps * average H/W time of a frame) of all QoS
+ * contexts, measured at the current QoS step. Above MFC_QOS_CL_UP_LOAD the
+ * lowest step which is expected to bring the load under MFC_QOS_CL_TARGET_LOAD
+ * is taken at once. The step is lowered one by one, only when the lower step
+ * is expected to keep the load under the target for MFC_QOS_CL_DOWN_HOLD
+ * evaluations in a row.
+ */
+void mfc_qos_feedback(struct mfc_ctx *ctx)
+{
+	struct mfc_dev *dev = ctx->dev;
+	struct mfc_ctx *qos_ctx;
+	unsigned int load;
+	int cur, step, max_step;
+	int enc_found = 0;
+	u64 busy = 0;
+
+	if (!qos_closed_loop || perf_boost_mode)
+		return;
+
+	if (++dev->qos_cl.frames < MFC_QOS_CL_PERIOD)
+		return;
+	dev->qos_cl.frames = 0;
+
+	cur = atomic_read(&dev->qos_req_cur) - 1;
+	if (cur < 0)
+		return;
+
+	/* H/W time is not measured while NAL-Q runs the frames */
+	if (dev->nal_q_handle && dev->nal_q_handle->nal_q_state != NAL_Q_STATE_CREATED)
+		return;
+
+	/* framerate is fps * 1000 and hw_time_avg is nsec */
+	list_for_each_entry(qos_ctx, &dev->qos_queue, qos_list) {
+		if (!qos_ctx->hw_time_avg)
+			return;
+		if (OVER_UHD_ENC60(qos_ctx))
+			enc_found = 1;
+		busy += (u64)qos_ctx->framerate * qos_ctx->hw_time_avg;
+	}
+	load = (unsigned int)div64_u64(busy, 10000000000ULL);
+	dev->qos_cl.load = load;
+
+	max_step = enc_found ? dev->pdata->max_qos_steps : dev->pdata->num_qos_steps;
+	step = cur;
+
+	if (load > MFC_QOS_CL_UP_LOAD) {
+		dev->qos_cl.down_hold = 0;
+		while (step < max_step - 1) {
+			step++;
+			if (__mfc_qos_cl_load_at(dev, load, cur, step) <= MFC_QOS_CL_TARGET_LOAD)
+				break;
+		}
+	} else if (cur > 0 && __mfc_qos_cl_load_at(dev, load, cur, cur - 1)
+						<= MFC_QOS_CL_TARGET_LOAD) {
+		if (++dev->qos_cl.down_hold >= MFC_QOS_CL_DOWN_HOLD) {
+			dev->qos_cl.down_hold = 0;
+			step = cur - 1;
+		}
+	} else {
+		dev->qos_cl.down_hold = 0;
+	}
+
+	mfc_debug(3, "[QoS][CL] load: %d%% at table[%d], hold: %d\n",
+			load, cur, dev->qos_cl.down_hold);
+
+	if (step == cur && dev->qos_cl.step >= 0)
+		return;
+
+	if (step > cur)
+		dev->qos_cl.up_cnt++;
+	else if (step < cur)
+		dev->qos_cl.down_cnt++;
+
+	MFC_TRACE_CTX("QoS CL load %d%%: table[%d] -> table[%d]\n", load, cur, step);
+	mfc_debug(2, "[QoS][CL] load %d%%: table[%d] -> table[%d]\n", load, cur, step);
+
+	dev->qos_cl.step = step;
+	mfc_qos_on(ctx);
+}
 #endif
 
 #define COL_FRAME_RATE		0
@@ -855,6 +974,8 @@ void mfc_qos_update_framerate(struct mfc_ctx *ctx)
 		ctx->framerate = ctx->last_framerate;
 		mfc_qos_on(ctx);
 	}
+
+	mfc_qos_feedback(ctx);
 }
 
 void mfc_qos_update_last_framerate(struct mfc_ctx *ctx, u64 timestamp)
@@ -869,3 +990,16 @@ void mfc_qos_update_last_framerate(struct mfc_ctx *ctx, u64 timestamp)
 		ctx->last_framerate = MFC_MAX_FPS;
 	ctx->last_framerate = (ctx->qos_ratio * ctx->last_framerate) / 100;
 }
+
+/* Return the frame interval in nsec measured by timestamps */
+u64 mfc_qos_get_frame_period(struct mfc_ctx *ctx)
+{
+	unsigned long framerate = ctx->framerate;
+
+	if (!framerate)
+		framerate = (ctx->type == MFCINST_ENCODER) ?
+				ENC_DEFAULT_FPS : DEC_DEFAULT_FPS;
+
+	/* framerate is fps * 1000 */
+	return div64_u64((u64)NSEC_PER_SEC * 1000, framerate);
+}
@@ -26,20 +26,29 @@
 
 #define MFC_DRV_TIME			500
 
+/* closed-loop QoS, load is H/W busy ratio(%) */
+#define MFC_QOS_CL_PERIOD		30
+#define MFC_QOS_CL_UP_LOAD		90
+#define MFC_QOS_CL_TARGET_LOAD		75
+#define MFC_QOS_CL_DOWN_HOLD		3
+
 #ifdef CONFIG_MFC_USE_BUS_DEVFREQ
 void mfc_perf_boost_enable(struct mfc_dev *dev);
 void mfc_perf_boost_disable(struct mfc_dev *dev);
 void mfc_qos_on(struct mfc_ctx *ctx);
 void mfc_qos_off(struct mfc_ctx *ctx);
+void mfc_qos_feedback(struct mfc_ctx *ctx);
 #else
 #define mfc_perf_boost_enable(dev)	do {} while (0)
 #define mfc_perf_boost_disable(dev)	do {} while (0)
 #define mfc_qos_on(ctx)		do {} while (0)
 #define mfc_qos_off(ctx)		do {} while (0)
+#define mfc_qos_feedback(ctx)		do {} while (0)
 #endif
 
 void mfc_qos_update_framerate(struct mfc_ctx *ctx);
 void mfc_qos_update_last_framerate(struct mfc_ctx *ctx, u64 timestamp);
+u64 mfc_qos_get_frame_period(struct mfc_ctx *ctx);
 
 static inline void mfc_qos_reset_framerate(struct mfc_ctx *ctx)
 {
@@ -25,6 +25,7 @@
 #include "mfc_queue.h"
 #include "mfc_utils.h"
 #include "mfc_mem.h"
+#include "mfc_perf_measure.h"
 
 /* Initialize hardware */
 static int __mfc_init_hw(struct mfc_dev *dev, enum mfc_buf_usage_type buf_type)
@@ -250,6 +251,8 @@ int mfc_run_wakeup(struct mfc_dev *dev)
 	mfc_debug_enter();
 	mfc_info_dev("curr_ctx_is_drm:%d\n", dev->curr_ctx_is_drm);
 
+	mfc_perf_resume_begin(dev, MFC_RESUME_WAKEUP);
+
 	/* 0. MFC reset */
 	mfc_debug(2, "MFC reset...\n");
 
@@ -302,6 +305,7 @@ int mfc_run_wakeup(struct mfc_dev *dev)
 	}
 
 	dev->sleep = 0;
+	mfc_perf_resume_mark(dev, MFC_RESUME_HW_INIT);
 
 	mfc_pm_clock_off(dev);
 
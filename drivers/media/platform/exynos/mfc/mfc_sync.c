@@ -16,6 +16,7 @@
 #include "mfc_perf_measure.h"
 
 #include "mfc_queue.h"
+#include "mfc_qos.h"
 
 #define R2H_BIT(x)	(((x) > 0) ? (1 << ((x) - 1)) : 0)
 
@@ -147,6 +148,73 @@ void mfc_wake_up_ctx(struct mfc_ctx *ctx, unsigned int reason,
 	wake_up(&ctx->cmd_wq);
 }
 
+/*
+ * Should be called with work_bits.lock
+ *
+ * A context that becomes ready is expected to get the hardware within
+ * a frame interval.
+ */
+static void __mfc_ctx_ready_protected(struct mfc_ctx *ctx, struct mfc_bits *data)
+{
+	if (!__test_and_set_bit(ctx->num, &data->bits))
+		ctx->sched_deadline = ktime_get_ns() + mfc_qos_get_frame_period(ctx);
+}
+
+/*
+ * Should be called with work_bits.lock
+ *
+ * Choose the ready context of the highest priority with the earliest
+ * deadline. Contexts are visited in round-robin order from the previous
+ * context so that the contexts of the same deadline are served in turn.
+ */
+static int __mfc_get_deadline_ctx_protected(struct mfc_dev *dev)
+{
+	struct mfc_ctx *ctx, *best = NULL;
+	int i, index;
+
+	for (i = 1; i <= MFC_NUM_CONTEXTS; i++) {
+		index = (dev->curr_ctx + i) % MFC_NUM_CONTEXTS;
+		if (!test_bit(index, &dev->work_bits.bits))
+			continue;
+
+		ctx = dev->ctx[index];
+		if (!ctx)
+			return index;
+
+		if (!best || ctx->sched_prio < best->sched_prio ||
+			(ctx->sched_prio == best->sched_prio &&
+			(s64)(ctx->sched_deadline - best->sched_deadline) < 0))
+			best = ctx;
+	}
+
+	return best ? best->num : -EAGAIN;
+}
+
+/*
+ * Update the deadline of the context that gets the hardware.
+ * The context is late if it is run after the deadline.
+ */
+void mfc_sched_dispatch(struct mfc_ctx *ctx)
+{
+	struct mfc_dev *dev = ctx->dev;
+	unsigned long wflags;
+	u64 now = ktime_get_ns();
+
+	spin_lock_irqsave(&dev->work_bits.lock, wflags);
+
+	ctx->sched_cnt++;
+	if ((s64)(now - ctx->sched_deadline) > 0) {
+		ctx->deadline_miss++;
+		mfc_debug(2, "[SCHED] ctx %d missed deadline by %lluns\n",
+				ctx->num, now - ctx->sched_deadline);
+	}
+
+	/* deadline of the next frame if the context is still ready */
+	ctx->sched_deadline = now + mfc_qos_get_frame_period(ctx);
+
+	spin_unlock_irqrestore(&dev->work_bits.lock, wflags);
+}
+
 int mfc_get_new_ctx(struct mfc_dev *dev)
 {
 	unsigned long wflags;
@@ -173,6 +241,12 @@ int mfc_get_new_ctx(struct mfc_dev *dev)
 			}
 		}
 
+		if (!sched_deadline_disable) {
+			new_ctx_index = __mfc_get_deadline_ctx_protected(dev);
+			spin_unlock_irqrestore(&dev->work_bits.lock, wflags);
+			return new_ctx_index;
+		}
+
 		new_ctx_index = (dev->curr_ctx + 1) % MFC_NUM_CONTEXTS;
 		while (!test_bit(new_ctx_index, &dev->work_bits.bits)) {
 			new_ctx_index = (new_ctx_index + 1) % MFC_NUM_CONTEXTS;
@@ -253,7 +327,7 @@ int __mfc_dec_ctx_ready_set_bit(struct mfc_ctx *ctx, struct mfc_bits *data, bool
 
 	if ((is_ready == 1) && (set == true)) {
 		/* if the ctx is ready and request set_bit, set the work_bit */
-		__set_bit(ctx->num, &data->bits);
+		__mfc_ctx_ready_protected(ctx, data);
 	} else if ((is_ready == 0) && (set == false)) {
 		/* if the ctx is not ready and request clear_bit, clear the work_bit */
 		__clear_bit(ctx->num, &data->bits);
@@ -333,7 +407,7 @@ static int __mfc_enc_ctx_ready_set_bit(struct mfc_ctx *ctx, struct mfc_bits *dat
 
 	if ((is_ready == 1) && (set == true)) {
 		/* if the ctx is ready and request set_bit, set the work_bit */
-		__set_bit(ctx->num, &data->bits);
+		__mfc_ctx_ready_protected(ctx, data);
 	} else if ((is_ready == 0) && (set == false)) {
 		/* if the ctx is not ready and request clear_bit, clear the work_bit */
 		__clear_bit(ctx->num, &data->bits);
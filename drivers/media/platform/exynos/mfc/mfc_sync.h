@@ -44,6 +44,7 @@ void mfc_wake_up_ctx(struct mfc_ctx *ctx, unsigned int reason,
 		unsigned int err);
 
 int mfc_get_new_ctx(struct mfc_dev *dev);
+void mfc_sched_dispatch(struct mfc_ctx *ctx);
 
 int mfc_ctx_ready_set_bit(struct mfc_ctx *ctx, struct mfc_bits *data);
 int mfc_ctx_ready_clear_bit(struct mfc_ctx *ctx, struct mfc_bits *data);
@@ -296,7 +296,7 @@ static int __mfc_get_curr_ctx(struct mfc_dev *dev)
 
 	if (nal_q_handle) {
 		if (nal_q_handle->nal_q_state == NAL_Q_STATE_STARTED) {
-			index = nal_q_handle->nal_q_in_handle->in_exe_count % NAL_Q_QUEUE_SIZE;
+			index = nal_q_handle->nal_q_in_handle->in_exe_count % dev->pdata->nal_q_queue_size;
 			offset = dev->pdata->nal_q_entry_size * index;
 			pStr = (DecoderInputStr *)(nal_q_handle->nal_q_in_handle->nal_q_in_addr + offset);
 			return pStr->InstanceId;
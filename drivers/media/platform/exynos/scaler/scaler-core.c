@@ -22,6 +22,7 @@
 #include <linux/exynos_iovmm.h>
 #include <linux/smc.h>
 #include <linux/ion_exynos.h>
+#include <soc/samsung/exynos-probe.h>
 
 #include <media/v4l2-ioctl.h>
 #include <media/m2m1shot.h>
@@ -60,6 +61,10 @@ static inline unsigned int sc_ext_buf_size(int width)
 int __measure_hw_latency;
 module_param_named(measure_hw_latency, __measure_hw_latency, int, 0644);
 
+/* If zero, intermediate buffers are freed when contexts release them */
+int sc_intbuf_pool = 1;
+module_param_named(intbuf_pool, sc_intbuf_pool, int, 0644);
+
 struct vb2_sc_buffer {
 	struct v4l2_m2m_buffer mb;
 	struct sc_ctx *ctx;
@@ -1346,34 +1351,223 @@ static void sc_calc_intbufsize(struct sc_dev *sc, struct sc_int_frame *int_frame
 	memcpy(&int_frame->dst_addr, &frame->addr, sizeof(int_frame->dst_addr));
 }
 
+static void sc_intbuf_release(struct device *dev, struct sc_intbuf *buf)
+{
+	ion_iovmm_unmap(buf->attachment, buf->src_addr);
+	ion_iovmm_unmap(buf->attachment, buf->dst_addr);
+	dma_buf_unmap_attachment(buf->attachment, buf->sgt, DMA_BIDIRECTIONAL);
+	dma_buf_detach(buf->dma_buf, buf->attachment);
+	dma_buf_put(buf->dma_buf);
+	kfree(buf);
+}
+
+/* Drops the oldest buffers until @count buffers of @total_size remain */
+static unsigned long sc_intbuf_pool_trim(struct sc_dev *sc,
+				unsigned int count, size_t total_size)
+{
+	struct sc_intbuf_pool *pool = &sc->intbuf_pool;
+	struct sc_intbuf *buf, *tmp;
+	unsigned long freed = 0;
+
+	list_for_each_entry_safe(buf, tmp, &pool->list, node) {
+		if ((pool->count <= count) && (pool->total_size <= total_size))
+			break;
+
+		list_del(&buf->node);
+		pool->count--;
+		pool->total_size -= buf->size;
+		sc_intbuf_release(sc->dev, buf);
+		freed++;
+	}
+
+	return freed;
+}
+
+/*
+ * Takes a pooled buffer not smaller than @size and not larger than @size by
+ * a quarter. The buffer is already mapped to both directions.
+ */
+static bool sc_intbuf_get(struct sc_dev *sc, struct sc_int_frame *iframe,
+				int i, size_t size)
+{
+	struct sc_intbuf_pool *pool = &sc->intbuf_pool;
+	struct sc_intbuf *buf;
+	bool found = false;
+
+	if (!sc_intbuf_pool || iframe->secure)
+		return false;
+
+	mutex_lock(&pool->lock);
+	list_for_each_entry(buf, &pool->list, node) {
+		if ((buf->size >= size) && (buf->size - size <= size / 4)) {
+			list_del(&buf->node);
+			pool->count--;
+			pool->total_size -= buf->size;
+			found = true;
+			break;
+		}
+	}
+
+	if (found)
+		pool->hit++;
+	else
+		pool->miss++;
+	mutex_unlock(&pool->lock);
+
+	if (!found)
+		return false;
+
+	iframe->dma_buf[i] = buf->dma_buf;
+	iframe->attachment[i] = buf->attachment;
+	iframe->sgt[i] = buf->sgt;
+	iframe->src_addr.ioaddr[i] = buf->src_addr;
+	iframe->dst_addr.ioaddr[i] = buf->dst_addr;
+	iframe->buf_size[i] = buf->size;
+	kfree(buf);
+
+	return true;
+}
+
+static bool sc_intbuf_put(struct sc_dev *sc, struct sc_int_frame *iframe,
+				int i)
+{
+	struct sc_intbuf_pool *pool = &sc->intbuf_pool;
+	struct sc_intbuf *buf;
+
+	if (!sc_intbuf_pool || iframe->secure ||
+			(iframe->buf_size[i] > SC_INTBUF_POOL_MAX_SIZE) ||
+			!iframe->src_addr.ioaddr[i] ||
+			!iframe->dst_addr.ioaddr[i])
+		return false;
+
+	buf = kzalloc(sizeof(*buf), GFP_KERNEL);
+	if (!buf)
+		return false;
+
+	buf->size = iframe->buf_size[i];
+	buf->dma_buf = iframe->dma_buf[i];
+	buf->attachment = iframe->attachment[i];
+	buf->sgt = iframe->sgt[i];
+	buf->src_addr = iframe->src_addr.ioaddr[i];
+	buf->dst_addr = iframe->dst_addr.ioaddr[i];
+
+	mutex_lock(&pool->lock);
+	sc_intbuf_pool_trim(sc, SC_INTBUF_POOL_MAX_COUNT - 1,
+				SC_INTBUF_POOL_MAX_SIZE - buf->size);
+	list_add_tail(&buf->node, &pool->list);
+	pool->count++;
+	pool->total_size += buf->size;
+	mutex_unlock(&pool->lock);
+
+	return true;
+}
+
+static unsigned long sc_intbuf_shrink_count(struct shrinker *shrinker,
+					struct shrink_control *sctl)
+{
+	struct sc_intbuf_pool *pool =
+		container_of(shrinker, struct sc_intbuf_pool, shrinker);
+
+	return pool->count;
+}
+
+static unsigned long sc_intbuf_shrink_scan(struct shrinker *shrinker,
+					struct shrink_control *sctl)
+{
+	struct sc_intbuf_pool *pool =
+		container_of(shrinker, struct sc_intbuf_pool, shrinker);
+	struct sc_dev *sc = container_of(pool, struct sc_dev, intbuf_pool);
+	unsigned long freed;
+
+	if (!mutex_trylock(&pool->lock))
+		return SHRINK_STOP;
+
+	freed = sc_intbuf_pool_trim(sc,
+			pool->count - min_t(unsigned int, pool->count,
+						sctl->nr_to_scan), 0);
+	pool->shrunk += freed;
+	mutex_unlock(&pool->lock);
+
+	return freed;
+}
+
+static void sc_intbuf_pool_init(struct sc_dev *sc)
+{
+	struct sc_intbuf_pool *pool = &sc->intbuf_pool;
+
+	mutex_init(&pool->lock);
+	INIT_LIST_HEAD(&pool->list);
+
+	pool->shrinker.count_objects = sc_intbuf_shrink_count;
+	pool->shrinker.scan_objects = sc_intbuf_shrink_scan;
+	pool->shrinker.seeks = DEFAULT_SEEKS;
+	if (register_shrinker(&pool->shrinker))
+		dev_err(sc->dev, "failed to register intermediate buffer shrinker\n");
+}
+
+static void sc_intbuf_pool_destroy(struct sc_dev *sc)
+{
+	struct sc_intbuf_pool *pool = &sc->intbuf_pool;
+
+	unregister_shrinker(&pool->shrinker);
+
+	mutex_lock(&pool->lock);
+	sc_intbuf_pool_trim(sc, 0, 0);
+	mutex_unlock(&pool->lock);
+}
+
+static ssize_t intbuf_pool_show(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct sc_dev *sc = dev_get_drvdata(dev);
+	struct sc_intbuf_pool *pool = &sc->intbuf_pool;
+	ssize_t len;
+
+	mutex_lock(&pool->lock);
+	len = scnprintf(buf, PAGE_SIZE,
+		"%u buffers %zu bytes, hit %lu miss %lu shrunk %lu\n",
+		pool->count, pool->total_size,
+		pool->hit, pool->miss, pool->shrunk);
+	mutex_unlock(&pool->lock);
+
+	return len;
+}
+
+static DEVICE_ATTR_RO(intbuf_pool);
+
 static void free_intermediate_frame(struct sc_ctx *ctx)
 {
+	struct sc_int_frame *iframe = ctx->i_frame;
 	int i;
 
-	if (ctx->i_frame == NULL)
+	if (iframe == NULL)
 		return;
 
-	if (!ctx->i_frame->dma_buf[0])
+	if (!iframe->dma_buf[0])
 		return;
 
 	for(i = 0; i < 3; i++) {
-		if (ctx->i_frame->src_addr.ioaddr[i])
-			ion_iovmm_unmap(ctx->i_frame->attachment[i],
-					ctx->i_frame->src_addr.ioaddr[i]);
-		if (ctx->i_frame->dst_addr.ioaddr[i])
-			ion_iovmm_unmap(ctx->i_frame->attachment[i],
-					ctx->i_frame->dst_addr.ioaddr[i]);
-		if (ctx->i_frame->dma_buf[i]) {
-			dma_buf_unmap_attachment(ctx->i_frame->attachment[i],
-					ctx->i_frame->sgt[i], DMA_BIDIRECTIONAL);
-			dma_buf_detach(ctx->i_frame->dma_buf[i], ctx->i_frame->attachment[i]);
-			dma_buf_put(ctx->i_frame->dma_buf[i]);
+		if (iframe->dma_buf[i] && sc_intbuf_put(ctx->sc_dev, iframe, i))
+			continue;
+
+		if (iframe->src_addr.ioaddr[i])
+			ion_iovmm_unmap(iframe->attachment[i],
+					iframe->src_addr.ioaddr[i]);
+		if (iframe->dst_addr.ioaddr[i])
+			ion_iovmm_unmap(iframe->attachment[i],
+					iframe->dst_addr.ioaddr[i]);
+		if (iframe->dma_buf[i]) {
+			dma_buf_unmap_attachment(iframe->attachment[i],
+					iframe->sgt[i], DMA_BIDIRECTIONAL);
+			dma_buf_detach(iframe->dma_buf[i], iframe->attachment[i]);
+			dma_buf_put(iframe->dma_buf[i]);
 		}
 	}
 
-	memset(&ctx->i_frame->dma_buf, 0, sizeof(struct dma_buf *) * 3);
-	memset(&ctx->i_frame->src_addr, 0, sizeof(ctx->i_frame->src_addr));
-	memset(&ctx->i_frame->dst_addr, 0, sizeof(ctx->i_frame->dst_addr));
+	memset(&iframe->dma_buf, 0, sizeof(struct dma_buf *) * 3);
+	memset(&iframe->src_addr, 0, sizeof(iframe->src_addr));
+	memset(&iframe->dst_addr, 0, sizeof(iframe->dst_addr));
+	memset(&iframe->buf_size, 0, sizeof(iframe->buf_size));
 }
 
 static void destroy_intermediate_frame(struct sc_ctx *ctx)
@@ -1386,11 +1580,16 @@ static void destroy_intermediate_frame(struct sc_ctx *ctx)
 	}
 }
 
-static bool alloc_intermediate_buffer(struct device *dev,
+static bool alloc_intermediate_buffer(struct sc_dev *sc,
 				      struct sc_int_frame *iframe, int i,
 				      size_t size, const char *heapname,
 				      unsigned long flags)
 {
+	struct device *dev = sc->dev;
+
+	if (sc_intbuf_get(sc, iframe, i, size))
+		return true;
+
 	iframe->dma_buf[i] = ion_alloc_dmabuf(heapname, size, flags);
 	if (IS_ERR(iframe->dma_buf[i])) {
 		dev_err(dev,
@@ -1433,6 +1632,8 @@ static bool alloc_intermediate_buffer(struct device *dev,
 		goto err_dst_map;
 	}
 
+	iframe->buf_size[i] = size;
+
 	return true;
 
 err_dst_map:
@@ -1482,16 +1683,18 @@ static bool initialize_initermediate_frame(struct sc_ctx *ctx)
 	if(test_bit(CTX_INT_FRAME_CP, &sc->state)) {
 		heapname = "vscaler_heap";
 		flag = ION_FLAG_PROTECTED;
+		ctx->i_frame->secure = true;
 	} else {
 		heapname = "ion_system_heap";
 		flag = 0;
+		ctx->i_frame->secure = false;
 	}
 
 	for (i = 0; i < SC_MAX_PLANES; i++) {
 		if (!frame->addr.size[i])
 			break;
 
-		if (!alloc_intermediate_buffer(sc->dev, ctx->i_frame, i,
+		if (!alloc_intermediate_buffer(sc, ctx->i_frame, i,
 					       frame->addr.size[i],
 					       heapname, flag))
 			goto err_ion_alloc;
@@ -3873,6 +4076,10 @@ static int sc_probe(struct platform_device *pdev)
 	if (ret)
 		return ret;
 
+	sc_intbuf_pool_init(sc);
+	if (device_create_file(&pdev->dev, &dev_attr_intbuf_pool))
+		dev_err(&pdev->dev, "failed to create intbuf_pool file\n");
+
 	ret = sc_register_m2m_device(sc, sc->dev_id);
 	if (ret) {
 		dev_err(&pdev->dev, "failed to register m2m device\n");
@@ -3976,6 +4183,8 @@ err_iommu:
 		pm_qos_remove_request(&sc->qosreq_int);
 	sc_unregister_m2m_device(sc);
 err_m2m:
+	device_remove_file(&pdev->dev, &dev_attr_intbuf_pool);
+	sc_intbuf_pool_destroy(sc);
 	m2m1shot_destroy_device(sc->m21dev);
 
 	return ret;
@@ -3985,6 +4194,9 @@ static int sc_remove(struct platform_device *pdev)
 {
 	struct sc_dev *sc = platform_get_drvdata(pdev);
 
+	device_remove_file(&pdev->dev, &dev_attr_intbuf_pool);
+	sc_intbuf_pool_destroy(sc);
+
 	iovmm_deactivate(sc->dev);
 
 	sc_clk_put(sc);
@@ -4028,6 +4240,7 @@ static struct platform_driver sc_driver = {
 		.name	= MODULE_NAME,
 		.owner	= THIS_MODULE,
 		.pm	= &sc_pm_ops,
+		.probe_type = EXYNOS_PROBE_NONCRITICAL,
 		.of_match_table = of_match_ptr(exynos_sc_match),
 	}
 };
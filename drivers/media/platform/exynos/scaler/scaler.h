@@ -21,6 +21,8 @@
 #include <linux/io.h>
 #include <linux/pm_qos.h>
 #include <linux/dma-buf.h>
+#include <linux/shrinker.h>
+#include <linux/sizes.h>
 #include <media/videobuf2-core.h>
 #include <media/v4l2-device.h>
 #include <media/v4l2-mem2mem.h>
@@ -310,6 +312,36 @@ struct sc_int_frame {
 	struct sg_table			*sgt[3];
 	struct dma_buf			*dma_buf[3];
 	struct dma_buf_attachment	*attachment[3];
+	size_t				buf_size[3];
+	bool				secure;
+};
+
+/*
+ * Intermediate buffers released by contexts are kept mapped in
+ * sc_intbuf_pool and given to the next context needing the similar size.
+ */
+#define SC_INTBUF_POOL_MAX_COUNT	6
+#define SC_INTBUF_POOL_MAX_SIZE		SZ_32M
+
+struct sc_intbuf {
+	struct list_head		node;
+	size_t				size;
+	struct dma_buf			*dma_buf;
+	struct dma_buf_attachment	*attachment;
+	struct sg_table			*sgt;
+	dma_addr_t			src_addr;
+	dma_addr_t			dst_addr;
+};
+
+struct sc_intbuf_pool {
+	struct mutex			lock;
+	struct list_head		list;
+	unsigned int			count;
+	size_t				total_size;
+	struct shrinker			shrinker;
+	unsigned long			hit;
+	unsigned long			miss;
+	unsigned long			shrunk;
 };
 
 /*
@@ -422,6 +454,7 @@ struct sc_dev {
 	struct sc_qos_table		*qos_table;
 	int qos_table_cnt;
 	struct notifier_block itmon_nb;
+	struct sc_intbuf_pool		intbuf_pool;
 };
 
 enum SC_CONTEXT_TYPE {
@@ -22,13 +22,17 @@ static bool smfc_alloc_tables(struct smfc_ctx *ctx)
 {
 	int i;
 
+	/*
+	 * The quantizers and the huffman codes are initialized when the tables
+	 * are parsed in smfc_parse_tables() because they are reused if the
+	 * table segments are not changed from the previous stream.
+	 */
 	if (!ctx->quantizer_tables) {
 		ctx->quantizer_tables = kmalloc(
 				sizeof(*ctx->quantizer_tables), GFP_KERNEL);
 		if (!ctx->quantizer_tables)
 			return false;
 	}
-	memset(ctx->quantizer_tables, 0, sizeof(*ctx->quantizer_tables));
 	for (i = 0; i < SMFC_MAX_QTBL_COUNT; i++)
 		ctx->quantizer_tables->compsel[i] = INVALID_QTBLIDX;
 
@@ -38,7 +42,16 @@ static bool smfc_alloc_tables(struct smfc_ctx *ctx)
 		if (!ctx->huffman_tables)
 			return false;
 	}
-	memset(ctx->huffman_tables, 0, sizeof(*ctx->huffman_tables));
+	memset(ctx->huffman_tables->compsel, 0,
+			sizeof(ctx->huffman_tables->compsel));
+
+	if (!ctx->table_cache) {
+		ctx->table_cache = kzalloc(
+				sizeof(*ctx->table_cache), GFP_KERNEL);
+		if (!ctx->table_cache)
+			return false;
+	}
+	ctx->table_cache->len[ctx->table_cache->cur] = 0;
 
 	return true;
 }
@@ -95,32 +108,20 @@ unsigned int smfc_get_num_huffval(u8 *hufflen)
 	return num;
 }
 
-static int smfc_parse_dht(struct smfc_ctx *ctx, unsigned long *cursor)
+/* @seg points to the length field of the segment copied from the stream */
+static int smfc_parse_dht(struct smfc_ctx *ctx, const u8 *seg, u16 len)
 {
-	u8 __user *pcursor = (u8 __user *)*cursor;
-	unsigned long segend;
-	int ret;
-	u16 len;
-
-	ret = smfc_get_segment_length(ctx, *cursor, 0xc4, &len);
-	if (ret)
-		return ret;
-
-	segend = *cursor + len;
-	pcursor += 2;
+	unsigned int pos = 2;
 
 	/* 17 : TcTh, L1...L16 */
-	while (((unsigned long)pcursor) < (segend - 17)) {
+	while ((pos + 17) < len) {
 		u8 *table;
 		unsigned int num_values;
 		u8 tcth;
 		bool dc;
 
-		ret = get_user(tcth, pcursor++);
-		if (ret) {
-			dev_err(ctx->smfc->dev, "Failed to read TcTh in DHT\n");
-			return ret;
-		} else if (__halfbytes_larger_than(tcth, 1)) {
+		tcth = seg[pos++];
+		if (__halfbytes_larger_than(tcth, 1)) {
 			dev_err(ctx->smfc->dev,
 					"Unsupported TcTh %#x in DHT\n", tcth);
 			return -EINVAL;
@@ -130,14 +131,8 @@ static int smfc_parse_dht(struct smfc_ctx *ctx, unsigned long *cursor)
 		dc = (((tcth >> 4) & 0xF) == 0);
 		table = dc ? ctx->huffman_tables->dc[tcth & 1].code
 			   : ctx->huffman_tables->ac[tcth & 1].code;
-		ret = copy_from_user(table, pcursor, SMFC_NUM_HCODE);
-		pcursor += SMFC_NUM_HCODE;
-		if (ret) {
-			dev_err(ctx->smfc->dev,
-					"Failed to read HUFFLEN of %d,%d\n",
-					tcth >> 4, tcth & 1);
-			return ret;
-		}
+		memcpy(table, seg + pos, SMFC_NUM_HCODE);
+		pos += SMFC_NUM_HCODE;
 
 		num_values = smfc_get_num_huffval(table);
 		if ((dc && (num_values > SMFC_NUM_DC_HVAL)) ||
@@ -148,76 +143,150 @@ static int smfc_parse_dht(struct smfc_ctx *ctx, unsigned long *cursor)
 			return -EINVAL;
 		}
 
-		if (((unsigned long)pcursor + num_values) > segend)
+		if ((pos + num_values) > len)
 			break;
 
 		/* HUFFVAL */
 		table = dc ? ctx->huffman_tables->dc[tcth & 1].value
 			   : ctx->huffman_tables->ac[tcth & 1].value;
-		ret = copy_from_user(table, pcursor, num_values);
-		pcursor += (unsigned long)num_values;
-		if (ret) {
-			dev_err(ctx->smfc->dev,
-				"Failed to read huffval of %d,%d\n",
-				tcth >> 4, tcth & 1);
-			return -EINVAL;
-		}
+		memcpy(table, seg + pos, num_values);
+		pos += num_values;
 	}
 
-	if ((*cursor + len) != (unsigned long)pcursor) {
+	if (pos != len) {
 		dev_err(ctx->smfc->dev, "Incorrect DHT length %d\n", len);
 		return -EINVAL;
 	}
 
-	*cursor += len;
-
 	return 0;
 }
 
-static int smfc_parse_dqt(struct smfc_ctx *ctx, unsigned long *cursor)
+static int smfc_parse_dqt(struct smfc_ctx *ctx, const u8 *seg, u16 len)
 {
-	u8 __user *pcursor = (u8 __user *)*cursor;
-	unsigned long segend;
-	int ret;
-	u16 len;
-
-	ret = smfc_get_segment_length(ctx, *cursor, 0xdb, &len);
-	if (ret)
-		return ret;
+	unsigned int pos = 2;
 
-	segend = *cursor + len;
-	pcursor += 2;
+	while (pos < len) {
+		u8 pqtq = seg[pos++];
 
-	/* 17 : TcTh, L1...L16 */
-	while ((unsigned long)pcursor < segend) {
-		u8 pqtq;
-
-		ret = get_user(pqtq, pcursor++);
-		if (ret) {
-			dev_err(ctx->smfc->dev, "Failed to read PqTq in DQT\n");
-			return ret;
-		} else if (pqtq >= SMFC_MAX_QTBL_COUNT) {
+		if (pqtq >= SMFC_MAX_QTBL_COUNT) {
 			/* Pq should be 0, Tq should be < 4 */
 			dev_err(ctx->smfc->dev,
 					"Invalid PqTq %02xin DQT\n", pqtq);
 			return -EINVAL;
 		}
 
-		ret = copy_from_user(ctx->quantizer_tables->table[pqtq],
-							pcursor, SMFC_MCU_SIZE);
-		pcursor += (unsigned long)SMFC_MCU_SIZE;
-		if (ret) {
+		if ((pos + SMFC_MCU_SIZE) > len) {
 			dev_err(ctx->smfc->dev,
-				"Failed to read %dth Q-Table\n", pqtq);
-			return ret;
+				"Incorrect DQT length %d\n", len);
+			return -EINVAL;
 		}
+
+		memcpy(ctx->quantizer_tables->table[pqtq],
+					seg + pos, SMFC_MCU_SIZE);
+		pos += SMFC_MCU_SIZE;
 	}
 
+	return 0;
+}
+
+/* Copies DHT or DQT segment to the table cache to be parsed at SOS */
+static int smfc_read_table_segment(struct smfc_ctx *ctx,
+				   unsigned long *cursor, u8 marker)
+{
+	struct smfc_table_cache *cache = ctx->table_cache;
+	unsigned int *seglen = &cache->len[cache->cur];
+	u8 *segs = cache->segs[cache->cur];
+	int ret;
+	u16 len;
+
+	ret = smfc_get_segment_length(ctx, *cursor, marker, &len);
+	if (ret)
+		return ret;
+
+	if (len < 2) {
+		dev_err(ctx->smfc->dev,
+			"Invalid length %d of 0xFF%02X\n", len, marker);
+		return -EINVAL;
+	}
+
+	if ((*seglen + len + 1) > SMFC_TABLE_SEGS_SIZE) {
+		dev_err(ctx->smfc->dev,
+			"Too large table segments (%u bytes)\n",
+			*seglen + len + 1);
+		return -EINVAL;
+	}
+
+	segs[*seglen] = marker;
+	if (copy_from_user(segs + *seglen + 1,
+				(void __user *)*cursor, len)) {
+		dev_err(ctx->smfc->dev, "Failed to read 0xFF%02X\n", marker);
+		return -EFAULT;
+	}
+
+	*seglen += len + 1;
 	*cursor += len;
 
 	return 0;
 }
 
+/*
+ * Parses the DHT and DQT segments collected in the table cache. If they are
+ * identical to the segments of the previous stream, the tables parsed from
+ * the previous stream are still valid. The tables are programmed to H/W
+ * anyway because H/W is reset before every job.
+ */
+static int smfc_parse_tables(struct smfc_ctx *ctx)
+{
+	struct smfc_table_cache *cache = ctx->table_cache;
+	unsigned int cur = cache->cur;
+	unsigned int len = cache->len[cur];
+	const u8 *segs = cache->segs[cur];
+	unsigned long flags;
+	unsigned int pos = 0;
+	bool hit;
+	int ret;
+
+	hit = cache->valid && (len == cache->len[!cur]) &&
+				!memcmp(segs, cache->segs[!cur], len);
+
+	spin_lock_irqsave(&ctx->smfc->flag_lock, flags);
+	if (hit)
+		ctx->smfc->table_cache_hit++;
+	else
+		ctx->smfc->table_cache_miss++;
+	spin_unlock_irqrestore(&ctx->smfc->flag_lock, flags);
+
+	if (hit)
+		return 0;
+
+	cache->valid = false;
+
+	memset(ctx->quantizer_tables->table, 0,
+			sizeof(ctx->quantizer_tables->table));
+	memset(ctx->huffman_tables->dc, 0, sizeof(ctx->huffman_tables->dc));
+	memset(ctx->huffman_tables->ac, 0, sizeof(ctx->huffman_tables->ac));
+
+	while (pos < len) {
+		u8 marker = segs[pos++];
+		u16 seglen = (segs[pos] << 8) | segs[pos + 1];
+
+		if (marker == 0xC4)
+			ret = smfc_parse_dht(ctx, segs + pos, seglen);
+		else
+			ret = smfc_parse_dqt(ctx, segs + pos, seglen);
+		if (ret)
+			return ret;
+
+		pos += seglen;
+	}
+
+	/* the segments just parsed are compared with the next stream */
+	cache->cur = !cur;
+	cache->valid = true;
+
+	return 0;
+}
+
 #define SOF0_LENGTH 17 /* Lf+P+Y+X+Nf+Nf*Comp */
 static int smfc_parse_frameheader(struct smfc_ctx *ctx, unsigned long *cursor)
 {
@@ -400,12 +469,9 @@ int smfc_parse_jpeg_header(struct smfc_ctx *ctx, struct vb2_buffer *vb)
 
 		switch (marker.byte[1]) {
 		case 0xC4: /* DHT */
-			ret = smfc_parse_dht(ctx, &cursor);
-			if (ret)
-				return ret;
-			break;
 		case 0xDB: /* DQT */
-			ret = smfc_parse_dqt(ctx, &cursor);
+			ret = smfc_read_table_segment(ctx, &cursor,
+						      marker.byte[1]);
 			if (ret)
 				return ret;
 			break;
@@ -415,6 +481,9 @@ int smfc_parse_jpeg_header(struct smfc_ctx *ctx, struct vb2_buffer *vb)
 				return ret;
 			break;
 		case 0xDA: /**** SOS - THE END OF HEADER PARSING ****/
+			ret = smfc_parse_tables(ctx);
+			if (ret)
+				return ret;
 			return smfc_parse_scanheader(ctx, streambase, &cursor);
 		case 0xD9: /* EOI */
 			dev_err(ctx->smfc->dev,
@@ -21,6 +21,7 @@
 #include <linux/mutex.h>
 #include <linux/wait.h>
 #include <linux/exynos_iovmm.h>
+#include <soc/samsung/exynos-probe.h>
 
 #include <media/videobuf2-core.h>
 #include <media/videobuf2-dma-sg.h>
@@ -525,6 +526,7 @@ static int exynos_smfc_release(struct file *filp)
 
 	kfree(ctx->quantizer_tables);
 	kfree(ctx->huffman_tables);
+	kfree(ctx->table_cache);
 
 	kfree(ctx);
 
@@ -773,6 +775,22 @@ static int smfc_init_clock(struct device *dev, struct smfc_dev *smfc)
 	return 0;
 }
 
+static ssize_t table_cache_show(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct smfc_dev *smfc = dev_get_drvdata(dev);
+	unsigned long flags, hit, miss;
+
+	spin_lock_irqsave(&smfc->flag_lock, flags);
+	hit = smfc->table_cache_hit;
+	miss = smfc->table_cache_miss;
+	spin_unlock_irqrestore(&smfc->flag_lock, flags);
+
+	return scnprintf(buf, PAGE_SIZE, "hit %lu miss %lu\n", hit, miss);
+}
+
+static DEVICE_ATTR_RO(table_cache);
+
 static int smfc_find_hw_version(struct device *dev, struct smfc_dev *smfc)
 {
 	int ret = pm_runtime_get_sync(dev);
@@ -959,6 +977,9 @@ static int exynos_smfc_probe(struct platform_device *pdev)
 
 	spin_lock_init(&smfc->flag_lock);
 
+	if (device_create_file(&pdev->dev, &dev_attr_table_cache))
+		dev_err(&pdev->dev, "Failed to create table_cache file\n");
+
 	dev_info(&pdev->dev, "Probed H/W Version: %02x.%02x.%04x\n",
 			(smfc->hwver >> 24) & 0xFF, (smfc->hwver >> 16) & 0xFF,
 			smfc->hwver & 0xFFFF);
@@ -987,6 +1008,7 @@ static int exynos_smfc_remove(struct platform_device *pdev)
 {
 	struct smfc_dev *smfc = platform_get_drvdata(pdev);
 
+	device_remove_file(&pdev->dev, &dev_attr_table_cache);
 	pm_qos_remove_request(&smfc->qosreq_int);
 	smfc_deinit_clock(smfc);
 
@@ -1080,6 +1102,7 @@ static struct platform_driver exynos_smfc_driver = {
 		.name	= MODULE_NAME,
 		.owner	= THIS_MODULE,
 		.pm	= &exynos_smfc_pm_ops,
+		.probe_type = EXYNOS_PROBE_NONCRITICAL,
 		.of_match_table = of_match_ptr(exynos_smfc_match),
 	}
 };
@@ -111,6 +111,9 @@ struct smfc_dev {
 	struct pm_qos_request qosreq_int;
 	s32 qosreq_int_level;
 
+	/* protected by flag_lock */
+	unsigned long table_cache_hit;
+	unsigned long table_cache_miss;
 };
 
 #define SMFC_CTX_COMPRESS	(1 << 0)
@@ -156,6 +159,19 @@ struct smfc_decomp_qtable {
 	char compsel[SMFC_MAX_QTBL_COUNT];
 };
 
+/*
+ * DHT and DQT segments of the streams. segs[cur] collects the segments of the
+ * stream being parsed and segs[!cur] keeps the segments that the current
+ * tables are parsed from, if valid.
+ */
+#define SMFC_TABLE_SEGS_SIZE	2048
+struct smfc_table_cache {
+	u8 segs[2][SMFC_TABLE_SEGS_SIZE];
+	unsigned int len[2];
+	unsigned int cur;
+	bool valid;
+};
+
 struct smfc_crop {
 	u32 width;
 	u32 height;
@@ -196,6 +212,7 @@ struct smfc_ctx {
 	/* Decompression settings */
 	struct smfc_decomp_qtable *quantizer_tables;
 	struct smfc_decomp_htable *huffman_tables;
+	struct smfc_table_cache *table_cache;
 	unsigned char stream_hfactor;
 	unsigned char stream_vfactor;
 	unsigned char num_components;
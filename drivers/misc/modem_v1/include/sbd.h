@@ -31,6 +31,7 @@
 
 #include <linux/types.h>
 #include <linux/kfifo.h>
+#include <linux/dynamic_queue_limits.h>
 #include "../modem_v1.h"
 
 #include "link_device_memory_config.h"
@@ -251,6 +252,22 @@ struct sbd_ring_buffer {
 
 	/* Flow control */
 	atomic_t busy;
+
+	/*
+	Byte queue limit of an UL RB: the bytes in flight to CP are limited to
+	what CP has drained recently, and the rest wait in the qdisc.
+	@tx_done is the slot up to which the frames taken by CP are completed.
+	*/
+	struct dql dql;
+	u16 tx_done;
+	bool bql_stop;
+
+	/*
+	RX polling statistics
+	*/
+	unsigned int rx_polls;		/* polls which received any frame	*/
+	unsigned int rx_frames;		/* frames received by the polls		*/
+	unsigned int rx_max_batch;	/* max frames received by a poll	*/
 };
 
 struct sbd_link_attr {
@@ -431,6 +448,17 @@ struct sbd_link_device {
 	unsigned long rxdone_mask;
 
 	bool reset_zerocopy_done;
+
+	/*
+	UL capacity of the link, estimated from the rate at which CP drains the
+	UL RBs and published to the net interfaces as a hint for TCP.
+	@tx_rate_bytes are the bytes completed since @tx_rate_start, and
+	@tx_rate_idle is set if an UL RB has been drained during the window.
+	*/
+	unsigned long tx_rate_start;
+	unsigned int tx_rate_bytes;
+	bool tx_rate_idle;
+	unsigned int tx_capacity_kbps;
 };
 
 static inline void sbd_activate(struct sbd_link_device *sl)
@@ -595,6 +623,7 @@ int create_sbd_link_device(struct link_device *ld, struct sbd_link_device *sl,
 int init_sbd_link(struct sbd_link_device *sl);
 
 int sbd_pio_tx(struct sbd_ring_buffer *rb, struct sk_buff *skb);
+void sbd_tx_completed(struct sbd_ring_buffer *rb);
 struct sk_buff *sbd_pio_rx(struct sbd_ring_buffer *rb);
 
 #define SBD_UL_LIMIT		16	/* Uplink burst limit */
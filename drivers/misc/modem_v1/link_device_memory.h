@@ -178,6 +178,8 @@ struct mem_ipc_device {
 #ifdef GROUP_MEM_FLOW_CONTROL
 #define MAX_SKB_TXQ_DEPTH		1024
 #define TX_PERIOD_MS			1	/* 1 ms */
+#define TX_BATCH_MAX			32	/* packets queued before a kick */
+#define TX_KICK_US			50	/* 50 us */
 #define MAX_TX_BUSY_COUNT		1024
 #define BUSY_COUNT_MASK			0xF
 
@@ -185,6 +187,7 @@ struct mem_ipc_device {
 
 #define TXQ_STOP_MASK			(0x1<<0)
 #define TX_SUSPEND_MASK			(0x1<<1)
+#define TXQ_BQL_MASK			(0x1<<3)
 #define SHM_FLOWCTL_BIT			BIT(2)
 #endif
 
@@ -495,9 +498,20 @@ struct mem_link_device {
 	struct dentry *dbgfs_frame;
 #endif
 	unsigned int tx_period_ms;
+	unsigned int tx_batch_max;	/* kick TX once this many are queued */
+	unsigned int tx_kick_us;	/* delay of a kick to coalesce senders */
+	unsigned int tx_db_pending;	/* frames written since the doorbell */
+	unsigned int tx_db_max_pkts;
+	unsigned long tx_db_count;
+	unsigned long tx_db_pkts;
+	unsigned long tx_kick_count;
 	unsigned int force_use_memcpy;
 	unsigned int memcpy_packet_count;
 	unsigned int zeromemcpy_packet_count;
+	u64 memcpy_rx_bytes;
+	u64 zeromemcpy_rx_bytes;
+	u64 memcpy_rx_ns;
+	u64 zeromemcpy_rx_ns;
 
 #ifdef CONFIG_LINK_DEVICE_NAPI
 	struct net_device dummy_net;
@@ -505,10 +519,17 @@ struct mem_link_device {
 	unsigned int rx_int_enable;
 	unsigned int rx_int_count;
 	unsigned int rx_poll_count;
+	unsigned int rx_poll_ring;	/* RX ring served first by the next poll */
 	unsigned long long rx_int_disabled_time;
 #endif /* CONFIG_LINK_DEVICE_NAPI */
 #ifdef CONFIG_MODEM_IF_NET_GRO
-	struct timespec flush_time;
+	u64 flush_time;			/* ns of the last GRO flush */
+	u64 gro_last_ns;		/* ns of the last packet given to GRO */
+	u64 gro_ia_ns;			/* EWMA of GRO packet inter-arrival */
+	unsigned int gro_segs;		/* packets given to GRO since the flush */
+	unsigned int gro_max_segs;
+	unsigned long gro_flush_cnt;
+	unsigned long gro_flush_segs;
 #endif
 
 	atomic_t forced_cp_crash;
@@ -848,6 +869,10 @@ void sbd_txq_start(struct sbd_ring_buffer *rb);
 int sbd_under_tx_flow_ctrl(struct sbd_ring_buffer *rb);
 int sbd_check_tx_flow_ctrl(struct sbd_ring_buffer *rb);
 
+bool sbd_bql_avail(struct sbd_ring_buffer *rb);
+void sbd_txq_bql_stop(struct sbd_ring_buffer *rb);
+void sbd_txq_bql_start(struct sbd_ring_buffer *rb);
+
 void tx_flowctrl_suspend(struct mem_link_device *mld);
 void tx_flowctrl_resume(struct mem_link_device *mld);
 void txq_stop(struct mem_link_device *mld, struct mem_ipc_device *dev);
@@ -118,6 +118,66 @@ int sbd_check_tx_flow_ctrl(struct sbd_ring_buffer *rb)
 	return -EBUSY;
 }
 
+/*
+ * Returns true while the bytes in flight on an UL RB of a PS channel are
+ * under the byte queue limit. Control channels are never limited.
+ */
+bool sbd_bql_avail(struct sbd_ring_buffer *rb)
+{
+	if (!sipc_ps_ch(rb->ch))
+		return true;
+
+	return dql_avail(&rb->dql) >= 0;
+}
+
+/*
+ * Stops the net interfaces while an UL RB is over its byte queue limit so
+ * that the packets wait in the qdisc instead of the SHMEM ring.
+ */
+void sbd_txq_bql_stop(struct sbd_ring_buffer *rb)
+{
+	struct link_device *ld = rb->ld;
+	unsigned long flags;
+
+	if (rb->bql_stop)
+		return;
+
+	spin_lock_irqsave(&rb->lock, flags);
+
+	rb->bql_stop = true;
+	if (!test_and_set_bit(TXQ_BQL_MASK, &ld->tx_flowctrl_mask))
+		stop_net_ifaces(ld);
+
+	spin_unlock_irqrestore(&rb->lock, flags);
+}
+
+void sbd_txq_bql_start(struct sbd_ring_buffer *rb)
+{
+	struct link_device *ld = rb->ld;
+	struct sbd_link_device *sl = rb->sl;
+	unsigned long flags;
+	int i;
+
+	if (!rb->bql_stop)
+		return;
+
+	spin_lock_irqsave(&rb->lock, flags);
+
+	rb->bql_stop = false;
+
+	for (i = 0; i < sl->num_channels; i++) {
+		if (sbd_id2rb(sl, i, UL)->bql_stop)
+			goto exit;
+	}
+
+	clear_bit(TXQ_BQL_MASK, &ld->tx_flowctrl_mask);
+	if (ld->tx_flowctrl_mask == 0)
+		resume_net_ifaces(ld);
+
+exit:
+	spin_unlock_irqrestore(&rb->lock, flags);
+}
+
 void txq_stop(struct mem_link_device *mld, struct mem_ipc_device *dev)
 {
 #ifdef CONFIG_MODEM_IF_LEGACY_QOS
@@ -182,6 +182,10 @@ static int setup_sbd_rb(struct sbd_link_device *sl, struct sbd_ring_buffer *rb,
 	rb->rp = &sl->rp[rb->dir][rb->id];
 	rb->wp = &sl->wp[rb->dir][rb->id];
 
+	dql_init(&rb->dql, HZ);
+	rb->tx_done = 0;
+	rb->bql_stop = false;
+
 	alloc_size = (rb->len * sizeof(u32));
 
 	rb->addr_v = (u32 *)desc_alloc(sl, alloc_size);
@@ -442,6 +446,12 @@ int init_sbd_link(struct sbd_link_device *sl)
 	init_desc_alloc(sl, DESC_RGN_OFFSET);
 	init_buff_alloc(sl, BUFF_RGN_OFFSET);
 
+	sl->tx_rate_start = jiffies;
+	sl->tx_rate_bytes = 0;
+	sl->tx_rate_idle = false;
+	sl->tx_capacity_kbps = 0;
+	netif_set_link_hint(sl->ld->msd, 0, 0);
+
 	err = init_sbd_ipc(sl, sl->ipc_dev, sl->link_attr);
 	if (!err)
 		print_sbd_config(sl);
@@ -567,9 +577,90 @@ int sbd_pio_tx(struct sbd_ring_buffer *rb, struct sk_buff *skb)
 	/* Commit the item before incrementing the head */
 	smp_mb();
 
+	dql_queued(&rb->dql, count);
+
 	return count;
 }
 
+/* window of the UL capacity estimation */
+#define SBD_TX_RATE_WINDOW	(HZ / 10)
+
+/**
+@brief		estimate the UL capacity of the link from the drain rate of CP
+
+While every UL RB has kept frames in flight through a window, CP drained
+them as fast as the link allowed, and the rate of the window is averaged
+into the capacity. Otherwise the rate is only a lower bound of it. The
+capacity and the bytes in flight are published to the net interfaces.
+*/
+static void sbd_tx_rate_update(struct sbd_ring_buffer *rb, unsigned int bytes)
+{
+	struct sbd_link_device *sl = rb->sl;
+	unsigned long elapsed = jiffies - sl->tx_rate_start;
+	unsigned int rate, cap, queued = 0;
+	int i;
+
+	sl->tx_rate_bytes += bytes;
+	if (rb->dql.num_queued == rb->dql.num_completed)
+		sl->tx_rate_idle = true;
+
+	if (elapsed < SBD_TX_RATE_WINDOW)
+		return;
+
+	rate = div_u64((u64)sl->tx_rate_bytes * 8 * HZ, elapsed * 1000);
+	cap = sl->tx_capacity_kbps;
+	if (!sl->tx_rate_idle)
+		cap = cap ? (cap * 3 + rate) / 4 : rate;
+	else if (rate > cap)
+		cap = rate;
+	sl->tx_capacity_kbps = cap;
+
+	sl->tx_rate_start = jiffies;
+	sl->tx_rate_bytes = 0;
+	sl->tx_rate_idle = false;
+
+	for (i = 0; i < sl->num_channels; i++) {
+		struct sbd_ring_buffer *ul = sbd_id2rb(sl, i, UL);
+
+		if (sipc_ps_ch(ul->ch))
+			queued += ul->dql.num_queued - ul->dql.num_completed;
+	}
+
+	netif_set_link_hint(rb->ld->msd, cap, queued);
+}
+
+/**
+@brief		complete the frames that CP has taken from an UL RB
+
+The size of each frame is read back from the SBD between @rb->tx_done and
+the RP of CP, and the sum is reported to the byte queue limit of @rb.
+*/
+void sbd_tx_completed(struct sbd_ring_buffer *rb)
+{
+	unsigned int qlen = rb->len;
+	unsigned int out = *rb->rp;
+	unsigned int done = rb->tx_done;
+	unsigned int inflight = rb->dql.num_queued - rb->dql.num_completed;
+	unsigned int bytes = 0;
+
+	if (unlikely(out >= qlen))
+		return;
+
+	while (done != out) {
+		bytes += rb->size_v[done] & 0xFFFF;
+		done = circ_new_ptr(qlen, done, 1);
+	}
+
+	rb->tx_done = done;
+
+	/* Never complete more than queued even if an SBD has been scribbled */
+	if (bytes)
+		dql_completed(&rb->dql, min(bytes, inflight));
+
+	if (sipc_ps_ch(rb->ch))
+		sbd_tx_rate_update(rb, min(bytes, inflight));
+}
+
 /**
 @}
 */
@@ -787,6 +787,7 @@ static int tx_frames_to_dev(struct mem_link_device *mld,
 		pktlog_tx_bottom_skb(mld, skb);
 
 		tx_bytes += ret;
+		mld->tx_db_pending++;
 
 #ifdef DEBUG_MODEM_IF_LINK_TX
 		mif_pkt(skbpriv(skb)->sipc_ch, "LNK-TX", skb);
@@ -798,6 +799,21 @@ static int tx_frames_to_dev(struct mem_link_device *mld,
 	return (ret < 0) ? ret : tx_bytes;
 }
 
+/* Accounts the frames published to CP by one doorbell interrupt */
+static inline void account_tx_doorbell(struct mem_link_device *mld)
+{
+	unsigned int pkts = mld->tx_db_pending;
+
+	if (!pkts)
+		return;
+
+	mld->tx_db_pending = 0;
+	mld->tx_db_count++;
+	mld->tx_db_pkts += pkts;
+	if (pkts > mld->tx_db_max_pkts)
+		mld->tx_db_max_pkts = pkts;
+}
+
 static enum hrtimer_restart tx_timer_func(struct hrtimer *timer)
 {
 	struct mem_link_device *mld;
@@ -882,8 +898,10 @@ static enum hrtimer_restart tx_timer_func(struct hrtimer *timer)
 		}
 	}
 
-	if (mask)
+	if (mask) {
 		send_ipc_irq(mld, mask2int(mask));
+		account_tx_doorbell(mld);
+	}
 
 exit:
 	if (need_schedule) {
@@ -917,6 +935,36 @@ exit:
 	spin_unlock_irqrestore(&mc->lock, flags);
 }
 
+/*
+ * Pulls the TX timer in to tx_kick_us when the sender has no more packets
+ * to hand over (!xmit_more) or when tx_batch_max packets are waiting, so
+ * that a batch is published with one doorbell without waiting a whole
+ * tx_period_ms. The short delay also merges the batches of other senders.
+ */
+static inline void kick_tx_timer(struct mem_link_device *mld,
+				 struct hrtimer *timer)
+{
+	struct link_device *ld = &mld->link_dev;
+	struct modem_ctl *mc = ld->mc;
+	unsigned long flags;
+	ktime_t ktime;
+
+	spin_lock_irqsave(&mc->lock, flags);
+
+	if (unlikely(cp_offline(mc)))
+		goto exit;
+
+	ktime = ktime_set(0, mld->tx_kick_us * NSEC_PER_USEC);
+	if (!hrtimer_is_queued(timer) ||
+	    ktime_compare(hrtimer_get_remaining(timer), ktime) > 0) {
+		hrtimer_start(timer, ktime, HRTIMER_MODE_REL);
+		mld->tx_kick_count++;
+	}
+
+exit:
+	spin_unlock_irqrestore(&mc->lock, flags);
+}
+
 static inline void cancel_tx_timer(struct mem_link_device *mld,
 				   struct hrtimer *timer)
 {
@@ -986,13 +1034,24 @@ static inline void cancel_datalloc_timer(struct mem_link_device *mld)
 
 static int tx_frames_to_rb(struct sbd_ring_buffer *rb)
 {
+	struct mem_link_device *mld = ld_to_mem_link_device(rb->ld);
 	struct sk_buff_head *skb_txq = &rb->skb_q;
 	int tx_bytes = 0;
 	int ret = 0;
 
+	sbd_tx_completed(rb);
+	if (sbd_bql_avail(rb))
+		sbd_txq_bql_start(rb);
+
 	while (1) {
 		struct sk_buff *skb;
 
+		if (!sbd_bql_avail(rb)) {
+			if (!skb_queue_empty(skb_txq))
+				sbd_txq_bql_stop(rb);
+			break;
+		}
+
 		skb = skb_dequeue(skb_txq);
 		if (unlikely(!skb))
 			break;
@@ -1005,6 +1064,7 @@ static int tx_frames_to_rb(struct sbd_ring_buffer *rb)
 		}
 
 		tx_bytes += ret;
+		mld->tx_db_pending++;
 #ifdef DEBUG_MODEM_IF_LINK_TX
 		mif_pkt(rb->ch, "LNK-TX", skb);
 #endif
@@ -1104,6 +1164,7 @@ static enum hrtimer_restart sbd_tx_timer_func(struct hrtimer *timer)
 			goto exit;
 		}
 		send_ipc_irq(mld, mask2int(mask));
+		account_tx_doorbell(mld);
 		spin_unlock_irqrestore(&mc->lock, flags);
 	}
 
@@ -1157,6 +1218,7 @@ static int xmit_ipc_to_rb(struct mem_link_device *mld, enum sipc_ch_id ch,
 	struct sbd_ring_buffer *rb = sbd_ch2rb_with_skb(&mld->sbd_link_dev, ch, TX, skb);
 	struct sk_buff_head *skb_txq;
 	unsigned long flags;
+	bool more = skb->xmit_more;
 
 	if (!rb) {
 		mif_err("%s: %s->%s: ERR! NO SBD RB {ch:%d}\n",
@@ -1184,7 +1246,10 @@ static int xmit_ipc_to_rb(struct mem_link_device *mld, enum sipc_ch_id ch,
 
 		ret = skb->len;
 		skb_queue_tail(skb_txq, skb);
-		start_tx_timer(mld, &mld->sbd_tx_timer);
+		if (!more || skb_txq->qlen >= mld->tx_batch_max)
+			kick_tx_timer(mld, &mld->sbd_tx_timer);
+		else
+			start_tx_timer(mld, &mld->sbd_tx_timer);
 	}
 
 	spin_unlock_irqrestore(&rb->lock, flags);
@@ -1207,6 +1272,7 @@ static int xmit_ipc_to_dev(struct mem_link_device *mld, enum sipc_ch_id ch,
 	struct modem_ctl *mc = ld->mc;
 	struct mem_ipc_device *dev = mld->dev[get_mmap_idx(ch, skb)];
 	struct sk_buff_head *skb_txq;
+	bool more = skb->xmit_more;
 
 	if (!dev) {
 		mif_err("%s: %s->%s: ERR! NO IPC DEV {ch:%d}\n",
@@ -1228,7 +1294,10 @@ static int xmit_ipc_to_dev(struct mem_link_device *mld, enum sipc_ch_id ch,
 	} else {
 		ret = skb->len;
 		skb_queue_tail(dev->skb_txq, skb);
-		start_tx_timer(mld, &mld->tx_timer);
+		if (!more || skb_txq->qlen >= mld->tx_batch_max)
+			kick_tx_timer(mld, &mld->tx_timer);
+		else
+			start_tx_timer(mld, &mld->tx_timer);
 	}
 
 #ifdef CONFIG_LINK_POWER_MANAGEMENT
@@ -1619,6 +1688,44 @@ void pass_skb_to_net(struct mem_link_device *mld, struct sk_buff *skb)
 }
 
 #define FREE_RB_BUF_COUNT 200
+
+#ifdef CONFIG_LINK_DEVICE_NAPI
+static inline void rb_account_rx_poll(struct sbd_ring_buffer *rb, int rcvd)
+{
+	if (rcvd <= 0)
+		return;
+
+	rb->rx_polls++;
+	rb->rx_frames += rcvd;
+	if (rcvd > rb->rx_max_batch)
+		rb->rx_max_batch = rcvd;
+}
+
+/*
+ * Returns the RX ring to be served first and rotates it for the next poll, so
+ * that a busy ring cannot keep the budget away from the rings behind it.
+ */
+static inline int rx_poll_first_ring(struct mem_link_device *mld)
+{
+	struct sbd_link_device *sl = &mld->sbd_link_dev;
+	int first;
+
+	if (unlikely(!sl->num_channels))
+		return 0;
+
+	first = mld->rx_poll_ring % sl->num_channels;
+
+	mld->rx_poll_ring = (first + 1) % sl->num_channels;
+
+	return first;
+}
+#else /* !CONFIG_LINK_DEVICE_NAPI */
+static inline int rx_poll_first_ring(struct mem_link_device *mld)
+{
+	return 0;
+}
+#endif /* CONFIG_LINK_DEVICE_NAPI */
+
 static int rx_net_frames_from_zerocopy_adaptor(struct sbd_ring_buffer *rb,
 		int budget, int *work_done)
 {
@@ -1627,7 +1734,10 @@ static int rx_net_frames_from_zerocopy_adaptor(struct sbd_ring_buffer *rb,
 	struct mem_link_device *mld = ld_to_mem_link_device(ld);
 	struct zerocopy_adaptor *zdptr = rb->zdptr;
 	unsigned int num_frames;
+	unsigned int min_posted;
 	int use_memcpy = 0;
+	u64 bytes = 0;
+	ktime_t start;
 
 #ifdef CONFIG_LINK_DEVICE_NAPI
 	num_frames = min_t(unsigned int, rb_usage(rb), budget);
@@ -1635,14 +1745,17 @@ static int rx_net_frames_from_zerocopy_adaptor(struct sbd_ring_buffer *rb,
 	num_frames = rb_usage(rb);
 #endif /* CONFIG_LINK_DEVICE_NAPI */
 
+	/*
+	 * Copy out only when CP is about to run short of posted buffers, a
+	 * fixed count would be most of a small ring and copy all the time.
+	 */
+	min_posted = min_t(unsigned int, FREE_RB_BUF_COUNT, zdptr->len / 4);
+
 	if (mld->force_use_memcpy || (num_frames > ld->mif_buff_mng->free_cell_count)
-		|| (FREE_RB_BUF_COUNT > circ_get_space(zdptr->len, *(zdptr->rp), *(zdptr->wp)))) {
+		|| (min_posted > circ_get_space(zdptr->len, *(zdptr->rp), *(zdptr->wp))))
 		use_memcpy = 1;
-		mld->memcpy_packet_count++;
-	} else {
-		use_memcpy = 0;
-		mld->zeromemcpy_packet_count++;
-	}
+
+	start = ktime_get();
 
 	while (rcvd < num_frames) {
 		struct sk_buff *skb;
@@ -1654,10 +1767,22 @@ static int rx_net_frames_from_zerocopy_adaptor(struct sbd_ring_buffer *rb,
 		/* The $rcvd must be accumulated here, because $skb can be freed
 		   in pass_skb_to_net(). */
 		rcvd++;
+		bytes += skb->len;
 
 		pass_skb_to_net(mld, skb);
 	}
 
+	/* compared by zmc_count while toggling force_use_memcpy */
+	if (use_memcpy) {
+		mld->memcpy_packet_count += rcvd;
+		mld->memcpy_rx_bytes += bytes;
+		mld->memcpy_rx_ns += ktime_to_ns(ktime_sub(ktime_get(), start));
+	} else {
+		mld->zeromemcpy_packet_count += rcvd;
+		mld->zeromemcpy_rx_bytes += bytes;
+		mld->zeromemcpy_rx_ns += ktime_to_ns(ktime_sub(ktime_get(), start));
+	}
+
 	if (rcvd < num_frames) {
 		struct io_device *iod = rb->iod;
 		struct link_device *ld = rb->ld;
@@ -1668,6 +1793,7 @@ static int rx_net_frames_from_zerocopy_adaptor(struct sbd_ring_buffer *rb,
 
 #ifdef CONFIG_LINK_DEVICE_NAPI
 	*work_done = rcvd;
+	rb_account_rx_poll(rb, rcvd);
 	allocate_data_in_advance(zdptr);
 #else /* !CONFIG_LINK_DEVICE_NAPI */
 	start_datalloc_timer(mld, &zdptr->datalloc_timer);
@@ -1714,6 +1840,7 @@ static int rx_net_frames_from_rb(struct sbd_ring_buffer *rb, int budget,
 
 #ifdef CONFIG_LINK_DEVICE_NAPI
 	*work_done = rcvd;
+	rb_account_rx_poll(rb, rcvd);
 #endif /* CONFIG_LINK_DEVICE_NAPI */
 
 	return rcvd;
@@ -1868,14 +1995,18 @@ static int recv_sbd_ipc_frames(struct mem_link_device *mld,
 				struct mem_snapshot *mst, int budget)
 {
 	struct sbd_link_device *sl = &mld->sbd_link_dev;
-	int i;
+	int i, n;
+	int first = rx_poll_first_ring(mld);
 	int total_ps_rcvd = 0;
 	int total_non_ps_rcvd = 0;
 
-	for (i = 0; i < sl->num_channels; i++) {
-		struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, RX);
+	for (n = 0; n < sl->num_channels; n++) {
+		struct sbd_ring_buffer *rb;
 		int rcvd = 0;
 
+		i = (first + n) % sl->num_channels;
+		rb = sbd_id2rb(sl, i, RX);
+
 		if (unlikely(rb_empty(rb)))
 			continue;
 
@@ -1941,7 +2072,9 @@ static int ipc_rx_func(struct mem_link_device *mld, int budget)
 			mld->cmd_handler(mld, int2cmd(intr));
 
 		if (sbd_active(&mld->sbd_link_dev)) {
-			ps_rcvd = recv_sbd_ipc_frames(mld, &msb->snapshot, budget);
+			/* The budget is shared by all the snapshots in the queue */
+			ps_rcvd = recv_sbd_ipc_frames(mld, &msb->snapshot,
+					max(budget - total_ps_rcvd, 0));
 			if (ps_rcvd >= 0)
 				total_ps_rcvd += ps_rcvd;
 			else
@@ -2299,26 +2432,38 @@ exit:
 long gro_flush_time = 0;
 module_param(gro_flush_time, long, 0644);
 
+/*
+ * Holding packets for GRO only pays off when more packets of the burst are
+ * expected within gro_flush_time. The packet rate is tracked by an EWMA of
+ * the inter-arrival time, and GRO is flushed right away when fewer than
+ * GRO_FLUSH_MIN_SEGS packets would arrive until the flush time.
+ */
+#define GRO_FLUSH_MIN_SEGS	4
+
 static void gro_flush_timer(struct link_device *ld)
 {
 	struct mem_link_device *mld = to_mem_link_device(ld);
-	struct timespec curr, diff;
+	u64 now = ktime_get_ns();
+	u64 ia = min_t(u64, now - mld->gro_last_ns, NSEC_PER_SEC);
+	long flush_time = READ_ONCE(gro_flush_time);
 
-	if (!gro_flush_time) {
-		napi_gro_flush(&mld->mld_napi, false);
+	mld->gro_ia_ns = mld->gro_ia_ns - (mld->gro_ia_ns >> 3) + (ia >> 3);
+	mld->gro_last_ns = now;
+	mld->gro_segs++;
+
+	if (flush_time > 0 &&
+	    mld->gro_ia_ns * GRO_FLUSH_MIN_SEGS < flush_time &&
+	    now - mld->flush_time <= flush_time)
 		return;
-	}
 
-	if (unlikely(mld->flush_time.tv_sec == 0)) {
-		getnstimeofday(&mld->flush_time);
-	} else {
-		getnstimeofday(&(curr));
-		diff = timespec_sub(curr, mld->flush_time);
-		if ((diff.tv_sec > 0) || (diff.tv_nsec > gro_flush_time)) {
-			napi_gro_flush(&mld->mld_napi, false);
-			getnstimeofday(&mld->flush_time);
-		}
-	}
+	napi_gro_flush(&mld->mld_napi, false);
+
+	mld->gro_flush_cnt++;
+	mld->gro_flush_segs += mld->gro_segs;
+	if (mld->gro_segs > mld->gro_max_segs)
+		mld->gro_max_segs = mld->gro_segs;
+	mld->gro_segs = 0;
+	mld->flush_time = now;
 }
 #endif
 
@@ -2346,7 +2491,7 @@ static int mld_rx_int_poll(struct napi_struct *napi, int budget)
 	struct sbd_link_device *sl = &mld->sbd_link_dev;
 	int total_ps_rcvd = 0;
 	int ps_rcvd = 0;
-	int i;
+	int i, n;
 	int ret;
 	int total_budget;
 
@@ -2376,10 +2521,15 @@ static int mld_rx_int_poll(struct napi_struct *napi, int budget)
 		goto dummy_poll_complete;
 	} else {
 		/* Leave interrupt disabled and poll if NET polling is not finished. */
+		int first = rx_poll_first_ring(mld);
+
 		total_budget = budget;
 
-		for (i = 0; i < sl->num_channels; i++) {
-			struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, RX);
+		for (n = 0; n < sl->num_channels && budget > 0; n++) {
+			struct sbd_ring_buffer *rb;
+
+			i = (first + n) % sl->num_channels;
+			rb = sbd_id2rb(sl, i, RX);
 			if (likely(sipc_ps_ch(rb->ch))) {
 				ps_rcvd = shmem_poll_recv_on_iod(ld, rb->iod, budget);
 				budget -= ps_rcvd;
@@ -3191,6 +3341,56 @@ static ssize_t tx_period_ms_store(struct device *dev,
 	return ret;
 }
 
+static ssize_t tx_batch_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct modem_data *modem;
+	struct mem_link_device *mld;
+	ssize_t count = 0;
+
+	modem = (struct modem_data *)dev->platform_data;
+	mld = modem->mld;
+
+	count += sprintf(&buf[count], "batch_max:%u kick_us:%u\n",
+			mld->tx_batch_max, mld->tx_kick_us);
+	count += sprintf(&buf[count], "doorbells:%lu pkts:%lu avg:%lu max:%u kicks:%lu\n",
+			mld->tx_db_count, mld->tx_db_pkts,
+			mld->tx_db_count ? mld->tx_db_pkts / mld->tx_db_count : 0,
+			mld->tx_db_max_pkts, mld->tx_kick_count);
+
+	return count;
+}
+
+/* "<batch_max> <kick_us>" sets the batching bounds and resets the counters */
+static ssize_t tx_batch_store(struct device *dev,
+		struct device_attribute *attr,
+		const char *buf, size_t count)
+{
+	struct modem_data *modem;
+	struct mem_link_device *mld;
+	unsigned int batch_max, kick_us;
+	int ret;
+
+	modem = (struct modem_data *)dev->platform_data;
+	mld = modem->mld;
+
+	ret = sscanf(buf, "%u %u", &batch_max, &kick_us);
+	if (ret < 1)
+		return -EINVAL;
+
+	mld->tx_batch_max = batch_max;
+	if (ret == 2)
+		mld->tx_kick_us = min_t(unsigned int, kick_us,
+					mld->tx_period_ms * USEC_PER_MSEC);
+
+	mld->tx_db_count = 0;
+	mld->tx_db_pkts = 0;
+	mld->tx_db_max_pkts = 0;
+	mld->tx_kick_count = 0;
+
+	return count;
+}
+
 static int rb_ch_id = 8;
 static ssize_t rb_info_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
@@ -3206,9 +3406,15 @@ static ssize_t rb_info_show(struct device *dev,
 	if (rb_tx->len && rb_rx->len)
 		return sprintf(buf, "rb_ch_id = %d (total: %d)\n"
 				"TX(len: %d, rp: %d, wp: %d, space: %d, usage: %d)\n"
+				"BQL(limit: %u, inflight: %u, stop: %d)\n"
+				"LINK(capacity: %u kbps)\n"
 				"RX(len: %d, rp: %d, pre_rp: %d,wp: %d, space: %d, usage: %d)\n",
 				rb_ch_id, sl->num_channels,
 				rb_tx->len, *rb_tx->rp, *rb_tx->wp, rb_space(rb_tx) + 1, rb_usage(rb_tx),
+				rb_tx->dql.limit,
+				rb_tx->dql.num_queued - rb_tx->dql.num_completed,
+				rb_tx->bql_stop,
+				sl->tx_capacity_kbps,
 				rb_rx->len, *rb_rx->rp, rb_rx->zerocopy ? rb_rx->zdptr->pre_rp : -1,
 				*rb_rx->wp, rb_space(rb_rx) + 1, rb_usage(rb_rx));
 	else
@@ -3238,15 +3444,55 @@ static ssize_t rb_info_store(struct device *dev,
 	return ret;
 }
 
+#ifdef CONFIG_MODEM_IF_NET_GRO
+static ssize_t gro_stat_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct modem_data *modem;
+	struct mem_link_device *mld;
+
+	modem = (struct modem_data *)dev->platform_data;
+	mld = modem->mld;
+
+	return sprintf(buf, "flush(%lu) segs(%lu) avg(%lu) max(%u) ia(%llu ns)\n",
+			mld->gro_flush_cnt, mld->gro_flush_segs,
+			mld->gro_flush_cnt ? mld->gro_flush_segs / mld->gro_flush_cnt : 0,
+			mld->gro_max_segs, mld->gro_ia_ns);
+}
+
+static ssize_t gro_stat_store(struct device *dev,
+		struct device_attribute *attr,
+		const char *buf, size_t count)
+{
+	struct modem_data *modem;
+	struct mem_link_device *mld;
+
+	modem = (struct modem_data *)dev->platform_data;
+	mld = modem->mld;
+
+	mld->gro_flush_cnt = 0;
+	mld->gro_flush_segs = 0;
+	mld->gro_max_segs = 0;
+	return count;
+}
+#endif
+
 #if defined(CONFIG_CP_ZEROCOPY)
 static ssize_t zmc_count_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
 	struct modem_data *modem;
+	struct mem_link_device *mld;
+
 	modem = (struct modem_data *)dev->platform_data;
+	mld = modem->mld;
 
-	return sprintf(buf, "memcpy_packet(%d)/zeromemcpy_packet(%d)\n",
-			modem->mld->memcpy_packet_count, modem->mld->zeromemcpy_packet_count);
+	return sprintf(buf, "memcpy_packet(%d)/zeromemcpy_packet(%d)\n"
+			"memcpy(%llu bytes, %llu us)/zeromemcpy(%llu bytes, %llu us)\n",
+			mld->memcpy_packet_count, mld->zeromemcpy_packet_count,
+			mld->memcpy_rx_bytes, div_u64(mld->memcpy_rx_ns, NSEC_PER_USEC),
+			mld->zeromemcpy_rx_bytes,
+			div_u64(mld->zeromemcpy_rx_ns, NSEC_PER_USEC));
 }
 
 static ssize_t zmc_count_store(struct device *dev,
@@ -3262,6 +3508,10 @@ static ssize_t zmc_count_store(struct device *dev,
 	if (val == 0) {
 		modem->mld->memcpy_packet_count = 0;
 		modem->mld->zeromemcpy_packet_count = 0;
+		modem->mld->memcpy_rx_bytes = 0;
+		modem->mld->zeromemcpy_rx_bytes = 0;
+		modem->mld->memcpy_rx_ns = 0;
+		modem->mld->zeromemcpy_rx_ns = 0;
 	}
 
 	return count;
@@ -3273,9 +3523,11 @@ static ssize_t mif_buff_mng_show(struct device *dev,
 	if (!g_mif_buff_mng)
 		return sprintf(buf, "g_mif_buff_mng is NULL\n");
 
-	return sprintf(buf, "used(%d)/free(%d)/total(%d)\n",
+	return sprintf(buf, "used(%d)/free(%d)/total(%d)\n"
+			"recycle_hit(%lu)/recycle_miss(%lu)\n",
 			g_mif_buff_mng->used_cell_count, g_mif_buff_mng->free_cell_count,
-			g_mif_buff_mng->cell_count);
+			g_mif_buff_mng->cell_count,
+			g_mif_buff_mng->recycle_hit, g_mif_buff_mng->recycle_miss);
 }
 
 static ssize_t force_use_memcpy_show(struct device *dev,
@@ -3306,7 +3558,11 @@ static ssize_t force_use_memcpy_store(struct device *dev,
 #endif
 
 static DEVICE_ATTR_RW(tx_period_ms);
+static DEVICE_ATTR_RW(tx_batch);
 static DEVICE_ATTR_RW(rb_info);
+#ifdef CONFIG_MODEM_IF_NET_GRO
+static DEVICE_ATTR_RW(gro_stat);
+#endif
 #if defined(CONFIG_CP_ZEROCOPY)
 static DEVICE_ATTR_RO(mif_buff_mng);
 static DEVICE_ATTR_RW(zmc_count);
@@ -3315,7 +3571,11 @@ static DEVICE_ATTR_RW(force_use_memcpy);
 
 static struct attribute *shmem_attrs[] = {
 	&dev_attr_tx_period_ms.attr,
+	&dev_attr_tx_batch.attr,
 	&dev_attr_rb_info.attr,
+#ifdef CONFIG_MODEM_IF_NET_GRO
+	&dev_attr_gro_stat.attr,
+#endif
 #if defined(CONFIG_CP_ZEROCOPY)
 	&dev_attr_mif_buff_mng.attr,
 	&dev_attr_zmc_count.attr,
@@ -3361,8 +3621,29 @@ static ssize_t rx_int_count_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
 	struct modem_data *modem;
+	struct sbd_link_device *sl;
+	ssize_t count = 0;
+	int i;
+
 	modem = (struct modem_data *)dev->platform_data;
-	return sprintf(buf, "%d\n", modem->mld->rx_int_count);
+	sl = &modem->mld->sbd_link_dev;
+
+	count += sprintf(&buf[count], "%d\n", modem->mld->rx_int_count);
+
+	/* packets per poll of each PS ring */
+	for (i = 0; i < sl->num_channels; i++) {
+		struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, RX);
+
+		if (!sipc_ps_ch(rb->ch) || !rb->rx_polls)
+			continue;
+
+		count += sprintf(&buf[count],
+				"ch%u: polls %u frames %u avg %u max %u\n",
+				rb->ch, rb->rx_polls, rb->rx_frames,
+				rb->rx_frames / rb->rx_polls, rb->rx_max_batch);
+	}
+
+	return count;
 }
 
 static ssize_t rx_int_count_store(struct device *dev,
@@ -3375,8 +3656,19 @@ static ssize_t rx_int_count_store(struct device *dev,
 	modem = (struct modem_data *)dev->platform_data;
 	ret = sscanf(buf, "%u", &val);
 
-	if (val == 0)
+	if (val == 0) {
+		struct sbd_link_device *sl = &modem->mld->sbd_link_dev;
+		int i;
+
 		modem->mld->rx_int_count = 0;
+		for (i = 0; i < sl->num_channels; i++) {
+			struct sbd_ring_buffer *rb = sbd_id2rb(sl, i, RX);
+
+			rb->rx_polls = 0;
+			rb->rx_frames = 0;
+			rb->rx_max_batch = 0;
+		}
+	}
 	return count;
 }
 
@@ -3852,6 +4144,8 @@ struct link_device *shmem_create_link_device(struct platform_device *pdev)
 	clean_vss_magic_code();
 
 	mld->tx_period_ms = TX_PERIOD_MS;
+	mld->tx_batch_max = TX_BATCH_MAX;
+	mld->tx_kick_us = TX_KICK_US;
 
 	if (sysfs_create_group(&pdev->dev.kobj, &shmem_group))
 		mif_err("failed to create sysfs node related shmem\n");
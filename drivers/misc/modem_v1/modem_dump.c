@@ -18,12 +18,15 @@
 
 #ifdef GROUP_MEM_LINK_DEBUG
 
+/*
+ * The dump is not copied at crash time: the size is returned to the
+ * application and misc_read() then copies the region straight from the
+ * reserved memory, one read() at a time.
+ */
 static int save_dump_file(struct link_device *ld, struct io_device *iod,
 		unsigned long arg, u8 __iomem *dump_base, size_t dump_size)
 {
-	size_t copied = 0;
-	struct sk_buff *skb;
-	size_t alloc_size = 0xE00;
+	struct iod_dump_stream *ds = &iod->dump_stream;
 	int ret;
 
 	if (dump_size == 0 || dump_base == NULL) {
@@ -37,40 +40,18 @@ static int save_dump_file(struct link_device *ld, struct io_device *iod,
 		return -EFAULT;
 	}
 
-	while (copied < dump_size) {
-		if (dump_size - copied < alloc_size)
-			alloc_size =  dump_size - copied;
-
-		skb = alloc_skb(alloc_size, GFP_ATOMIC);
-		if (!skb) {
-			skb_queue_purge(&iod->sk_rx_q);
-			mif_err("ERR! alloc_skb fail, purged skb_rx_q\n");
-			return -ENOMEM;
-		}
-
-		memcpy(skb_put(skb, alloc_size), dump_base + copied,
-				alloc_size);
-		copied += alloc_size;
-
-		/* Record the IO device and the link device into the &skb->cb */
-		skbpriv(skb)->iod = iod;
-		skbpriv(skb)->ld = ld;
-
-		skbpriv(skb)->lnk_hdr = false;
-		skbpriv(skb)->sipc_ch = iod->id;
-
-		ret = iod->recv_skb_single(iod, ld, skb);
-		if (unlikely(ret < 0)) {
-			struct modem_ctl *mc = ld->mc;
-
-			mif_err_limited("%s: %s<-%s: %s->recv_skb fail (%d)\n",
-				ld->name, iod->name, mc->name, iod->name, ret);
-			dev_kfree_skb_any(skb);
-			return ret;
-		}
-	}
+	mutex_lock(&ds->lock);
+	if (ds->base)
+		mif_err("%s: previous dump not complete (%zu/%zu bytes)\n",
+			iod->name, ds->offset, ds->size);
+	ds->base = dump_base;
+	ds->size = dump_size;
+	ds->offset = 0;
+	mutex_unlock(&ds->lock);
+
+	mif_info("%s: %zu bytes ready\n", ld->name, dump_size);
 
-	mif_info("Complete! (%zu bytes)\n", copied);
+	wake_up(&iod->wq);
 
 	return 0;
 }
@@ -28,6 +28,10 @@
 #include <linux/tcp.h>
 #include <linux/time.h>
 #include <linux/timer.h>
+#include <linux/netdevice.h>
+#include <linux/percpu.h>
+#include <linux/smp.h>
+#include <linux/io.h>
 #include "modem_prj.h"
 #include "modem_utils.h"
 
@@ -296,8 +300,84 @@ static int rx_raw_misc(struct sk_buff *skb)
 }
 
 #ifdef CONFIG_MODEM_IF_NET_GRO
+/*
+ * Latency sensitive channels skip GRO: the PDP channels set in
+ * gro_bypass_ch_mask (bit 0 for PDP_0), and channels whose packets arrive
+ * further apart than gro_bypass_us on average, like VoLTE voice streams,
+ * which would only wait for a flush without being aggregated.
+ */
+static unsigned int gro_bypass_ch_mask;
+module_param(gro_bypass_ch_mask, uint, 0644);
+
+static unsigned int gro_bypass_us = 2000;
+module_param(gro_bypass_us, uint, 0644);
+
+#define NUM_GRO_PDP_CH	(SIPC_CH_ID_PDP_14 - SIPC_CH_ID_PDP_0 + 1)
+
+struct gro_ch_stat {
+	u64 last_ns;
+	u64 ia_ns;		/* EWMA of the packet inter-arrival time */
+	unsigned long gro;
+	unsigned long bypass;
+};
+
+static struct gro_ch_stat gro_ch_stats[NUM_GRO_PDP_CH];
+
+static bool gro_bypass_ch(struct sk_buff *skb)
+{
+	u8 ch = skbpriv(skb)->sipc_ch;
+	struct gro_ch_stat *st;
+	u64 now, ia;
+	bool bypass;
+
+	if (!sipc_ps_ch(ch))
+		return false;
+
+	st = &gro_ch_stats[ch - SIPC_CH_ID_PDP_0];
+	now = ktime_get_ns();
+	ia = min_t(u64, now - st->last_ns, NSEC_PER_SEC);
+	st->ia_ns = st->ia_ns - (st->ia_ns >> 3) + (ia >> 3);
+	st->last_ns = now;
+
+	bypass = (gro_bypass_ch_mask & BIT(ch - SIPC_CH_ID_PDP_0)) ||
+		(gro_bypass_us && st->ia_ns > (u64)gro_bypass_us * NSEC_PER_USEC);
+	if (bypass)
+		st->bypass++;
+	else
+		st->gro++;
+
+	return bypass;
+}
+
+static ssize_t show_gro_bypass(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	char *p = buf;
+	int i;
+
+	for (i = 0; i < NUM_GRO_PDP_CH; i++) {
+		struct gro_ch_stat *st = &gro_ch_stats[i];
+
+		if (!st->gro && !st->bypass)
+			continue;
+
+		p += sprintf(p, "ch%d: ia %lluus gro %lu bypass %lu%s\n",
+				SIPC_CH_ID_PDP_0 + i, div_u64(st->ia_ns, NSEC_PER_USEC),
+				st->gro, st->bypass,
+				(gro_bypass_ch_mask & BIT(i)) ? " (forced)" : "");
+	}
+
+	return p - buf;
+}
+
+static struct device_attribute attr_gro_bypass =
+	__ATTR(gro_bypass, S_IRUGO, show_gro_bypass, NULL);
+
 static int check_gro_support(struct sk_buff *skb)
 {
+	if (gro_bypass_ch(skb))
+		return 0;
+
 	switch (skb->data[0] & 0xF0) {
 	case 0x40:
 		return (ip_hdr(skb)->protocol == IPPROTO_TCP);
@@ -314,14 +394,298 @@ static int check_gro_support(struct sk_buff *skb)
 }
 #endif
 
-static int rx_multi_pdp(struct sk_buff *skb)
+/*
+ * Delivers a PDP packet to the network stack. GRO is done on @napi, or on the
+ * NAPI being polled by the link device when @napi is NULL.
+ */
+static void rx_pdp_deliver(struct sk_buff *skb, struct napi_struct *napi)
 {
 	struct link_device *ld = skbpriv(skb)->ld;
+	struct net_device *ndev = skb->dev;
+	int ret;
+
+	if (check_gro_support(skb)) {
+		ret = napi_gro_receive(napi ? napi : napi_get_current(), skb);
+		if (ret == GRO_DROP) {
+			ndev->stats.rx_dropped++;
+		}
+
+		if (!napi && ld->gro_flush)
+			ld->gro_flush(ld);
+	} else {
+#ifdef CONFIG_LINK_DEVICE_NAPI
+		ret = netif_receive_skb(skb);
+#else /* !CONFIG_LINK_DEVICE_NAPI */
+		if (in_interrupt())
+			ret = netif_rx(skb);
+		else
+			ret = netif_rx_ni(skb);
+#endif /* CONFIG_LINK_DEVICE_NAPI */
+
+		if (ret != NET_RX_SUCCESS) {
+			ndev->stats.rx_dropped++;
+		}
+	}
+}
+
+/*
+ * RX steering spreads PDP packets over several CPUs before GRO, either by
+ * SIPC channel (one session per CPU) or by flow hash. Each CPU has its own
+ * backlog and NAPI instance which is kicked by an IPI like RPS does.
+ */
+enum rx_steer_mode {
+	RX_STEER_OFF,
+	RX_STEER_CHANNEL,
+	RX_STEER_FLOW,
+	MAX_RX_STEER_MODE,
+};
+
+static const char * const rx_steer_mode_str[MAX_RX_STEER_MODE] = {
+	[RX_STEER_OFF] = "off",
+	[RX_STEER_CHANNEL] = "channel",
+	[RX_STEER_FLOW] = "flow",
+};
+
+#define RX_STEER_MAX_QLEN	1000
+
+struct rx_steer_cpu {
+	struct sk_buff_head q;
+	struct napi_struct napi;
+	call_single_data_t csd;
+	bool scheduled;
+	unsigned long packets;	/* PDP packets delivered on this CPU */
+	unsigned long dropped;	/* dropped for a full backlog */
+};
+
+static DEFINE_PER_CPU(struct rx_steer_cpu, rx_steer_cpus);
+static struct net_device rx_steer_dev;
+static DEFINE_MUTEX(rx_steer_lock);
+static bool rx_steer_ready;
+static int rx_steer_mode;
+static struct cpumask rx_steer_mask;
+static int rx_steer_map[NR_CPUS];
+static unsigned int rx_steer_nr;
+
+static int rx_steer_poll(struct napi_struct *napi, int budget)
+{
+	struct rx_steer_cpu *pc = container_of(napi, struct rx_steer_cpu, napi);
+	struct sk_buff *skb;
+	unsigned long flags;
+	int done = 0;
+
+	while (done < budget) {
+		skb = skb_dequeue(&pc->q);
+		if (!skb)
+			break;
+
+		rx_pdp_deliver(skb, napi);
+		pc->packets++;
+		done++;
+	}
+
+	if (done < budget) {
+		spin_lock_irqsave(&pc->q.lock, flags);
+		if (skb_queue_empty(&pc->q)) {
+			pc->scheduled = false;
+			napi_complete_done(napi, done);
+		} else {
+			/* stay on the poll list for the packets queued meanwhile */
+			done = budget;
+		}
+		spin_unlock_irqrestore(&pc->q.lock, flags);
+	}
+
+	return done;
+}
+
+static void rx_steer_kick(void *info)
+{
+	struct rx_steer_cpu *pc = info;
+
+	napi_schedule(&pc->napi);
+}
+
+/* Returns the CPU to deliver @skb on, or -1 to deliver it right here */
+static int rx_steer_get_cpu(struct sk_buff *skb)
+{
+	unsigned int nr = READ_ONCE(rx_steer_nr);
+	int mode = READ_ONCE(rx_steer_mode);
+	int cpu;
+
+	if (mode == RX_STEER_OFF || !nr)
+		return -1;
+
+	if (mode == RX_STEER_CHANNEL)
+		cpu = rx_steer_map[skbpriv(skb)->sipc_ch % nr];
+	else
+		cpu = rx_steer_map[reciprocal_scale(skb_get_hash(skb), nr)];
+
+	if (cpu >= nr_cpu_ids || !cpu_online(cpu))
+		return -1;
+
+	return cpu;
+}
+
+/* Returns true if @skb was queued to another CPU */
+static bool rx_steer_skb(struct sk_buff *skb)
+{
+	struct rx_steer_cpu *pc;
+	unsigned long flags;
+	bool kick;
+	int cpu;
+
+	cpu = rx_steer_get_cpu(skb);
+	if (cpu < 0)
+		return false;
+
+	pc = &per_cpu(rx_steer_cpus, cpu);
+
+	spin_lock_irqsave(&pc->q.lock, flags);
+
+	/* Keep the order behind the packets still queued on this CPU */
+	if (cpu == raw_smp_processor_id() && skb_queue_empty(&pc->q)) {
+		spin_unlock_irqrestore(&pc->q.lock, flags);
+		pc->packets++;
+		return false;
+	}
+
+	if (skb_queue_len(&pc->q) >= RX_STEER_MAX_QLEN) {
+		spin_unlock_irqrestore(&pc->q.lock, flags);
+		pc->dropped++;
+		skb->dev->stats.rx_dropped++;
+		dev_kfree_skb_any(skb);
+		return true;
+	}
+
+	__skb_queue_tail(&pc->q, skb);
+	kick = !pc->scheduled;
+	pc->scheduled = true;
+
+	spin_unlock_irqrestore(&pc->q.lock, flags);
+
+	if (kick)
+		smp_call_function_single_async(cpu, &pc->csd);
+
+	return true;
+}
+
+static void rx_steer_set_cpus(const struct cpumask *mask)
+{
+	unsigned int nr = 0;
+	int cpu;
+
+	WRITE_ONCE(rx_steer_nr, 0);
+	cpumask_copy(&rx_steer_mask, mask);
+	for_each_cpu(cpu, &rx_steer_mask)
+		rx_steer_map[nr++] = cpu;
+	WRITE_ONCE(rx_steer_nr, nr);
+}
+
+static void rx_steer_init(void)
+{
+	int cpu;
+
+	mutex_lock(&rx_steer_lock);
+	if (rx_steer_ready)
+		goto out;
+
+	init_dummy_netdev(&rx_steer_dev);
+
+	for_each_possible_cpu(cpu) {
+		struct rx_steer_cpu *pc = &per_cpu(rx_steer_cpus, cpu);
+
+		skb_queue_head_init(&pc->q);
+		pc->csd.func = rx_steer_kick;
+		pc->csd.info = pc;
+		netif_napi_add(&rx_steer_dev, &pc->napi, rx_steer_poll,
+				NAPI_POLL_WEIGHT);
+		napi_enable(&pc->napi);
+	}
+
+	rx_steer_set_cpus(cpu_online_mask);
+	rx_steer_ready = true;
+out:
+	mutex_unlock(&rx_steer_lock);
+}
+
+static ssize_t show_rxsteer(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	char *p = buf;
+	int cpu;
+
+	p += sprintf(p, "mode: %s\n", rx_steer_mode_str[rx_steer_mode]);
+	p += sprintf(p, "cpus: %*pbl\n", cpumask_pr_args(&rx_steer_mask));
+
+	for_each_possible_cpu(cpu) {
+		struct rx_steer_cpu *pc = &per_cpu(rx_steer_cpus, cpu);
+
+		p += sprintf(p, "cpu%d: packets %lu dropped %lu\n",
+				cpu, pc->packets, pc->dropped);
+	}
+
+	return p - buf;
+}
+
+static ssize_t store_rxsteer(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	int mode;
+
+	for (mode = 0; mode < MAX_RX_STEER_MODE; mode++) {
+		if (sysfs_streq(buf, rx_steer_mode_str[mode])) {
+			WRITE_ONCE(rx_steer_mode, mode);
+			mif_info("rx steering mode: %s\n", rx_steer_mode_str[mode]);
+			return count;
+		}
+	}
+
+	return -EINVAL;
+}
+
+static struct device_attribute attr_rxsteer =
+	__ATTR(rxsteer, S_IRUGO | S_IWUSR, show_rxsteer, store_rxsteer);
+
+static ssize_t show_rxsteer_cpus(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%*pbl\n", cpumask_pr_args(&rx_steer_mask));
+}
+
+static ssize_t store_rxsteer_cpus(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	cpumask_var_t mask;
+	int ret;
+
+	if (!alloc_cpumask_var(&mask, GFP_KERNEL))
+		return -ENOMEM;
+
+	ret = cpulist_parse(buf, mask);
+	if (!ret && cpumask_empty(mask))
+		ret = -EINVAL;
+
+	if (!ret) {
+		mutex_lock(&rx_steer_lock);
+		rx_steer_set_cpus(mask);
+		mutex_unlock(&rx_steer_lock);
+	}
+
+	free_cpumask_var(mask);
+
+	return ret ? ret : count;
+}
+
+static struct device_attribute attr_rxsteer_cpus =
+	__ATTR(rxsteer_cpus, S_IRUGO | S_IWUSR, show_rxsteer_cpus,
+			store_rxsteer_cpus);
+
+static int rx_multi_pdp(struct sk_buff *skb)
+{
 	struct io_device *iod = skbpriv(skb)->iod;
 	struct net_device *ndev;
 	struct iphdr *iphdr;
 	int len = skb->len;
-	int ret;
 
 	ndev = iod->ndev;
 	if (!ndev) {
@@ -369,28 +733,9 @@ static int rx_multi_pdp(struct sk_buff *skb)
 	skb_reset_network_header(skb);
 	skb_reset_mac_header(skb);
 
-	if (check_gro_support(skb)) {
-		ret = napi_gro_receive(napi_get_current(), skb);
-		if (ret == GRO_DROP) {
-			ndev->stats.rx_dropped++;
-		}
-
-		if (ld->gro_flush)
-			ld->gro_flush(ld);
-	} else {
-#ifdef CONFIG_LINK_DEVICE_NAPI
-		ret = netif_receive_skb(skb);
-#else /* !CONFIG_LINK_DEVICE_NAPI */
-		if (in_interrupt())
-			ret = netif_rx(skb);
-		else
-			ret = netif_rx_ni(skb);
-#endif /* CONFIG_LINK_DEVICE_NAPI */
+	if (!rx_steer_skb(skb))
+		rx_pdp_deliver(skb, NULL);
 
-		if (ret != NET_RX_SUCCESS) {
-			ndev->stats.rx_dropped++;
-		}
-	}
 	return len;
 }
 
@@ -595,6 +940,9 @@ static unsigned int misc_poll(struct file *filp, struct poll_table_struct *wait)
 	mc = iod->mc;
 	rxq = &iod->sk_rx_q;
 
+	if (READ_ONCE(iod->dump_stream.base))
+		return POLLIN | POLLRDNORM;
+
 	if (skb_queue_empty(rxq))
 		poll_wait(filp, &iod->wq, wait);
 
@@ -1067,6 +1415,49 @@ static ssize_t misc_write(struct file *filp, const char __user *data,
 	return count;
 }
 
+/* Copy the next part of the dump region through a bounce page */
+static ssize_t misc_read_dump(struct io_device *iod, char __user *buf,
+			size_t count)
+{
+	struct iod_dump_stream *ds = &iod->dump_stream;
+	size_t copied = 0;
+	size_t len;
+	void *page;
+
+	page = (void *)__get_free_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+
+	mutex_lock(&ds->lock);
+	if (!ds->base)
+		goto exit;
+
+	count = min(count, ds->size - ds->offset);
+	while (copied < count) {
+		len = min_t(size_t, count - copied, PAGE_SIZE);
+		memcpy_fromio(page, ds->base + ds->offset, len);
+		if (copy_to_user(buf + copied, page, len)) {
+			mif_err("%s: ERR! copy_to_user fail\n", iod->name);
+			if (!copied)
+				copied = -EFAULT;
+			goto exit;
+		}
+		ds->offset += len;
+		copied += len;
+	}
+
+	if (ds->offset == ds->size) {
+		mif_info("%s: Complete! (%zu bytes)\n", iod->name, ds->size);
+		ds->base = NULL;
+	}
+
+exit:
+	mutex_unlock(&ds->lock);
+	free_page((unsigned long)page);
+
+	return copied;
+}
+
 static ssize_t misc_read(struct file *filp, char *buf, size_t count,
 			loff_t *fpos)
 {
@@ -1075,6 +1466,9 @@ static ssize_t misc_read(struct file *filp, char *buf, size_t count,
 	struct sk_buff *skb;
 	int copied;
 
+	if (READ_ONCE(iod->dump_stream.base))
+		return misc_read_dump(iod, (char __user *)buf, count);
+
 	if (skb_queue_empty(rxq)) {
 		long tmo = msecs_to_jiffies(100);
 		wait_event_timeout(iod->wq, !skb_queue_empty(rxq), tmo);
@@ -1250,6 +1644,8 @@ static int vnet_xmit(struct sk_buff *skb, struct net_device *ndev)
 			mif_info("%s: ERR! skb_copy_expand fail\n", iod->name);
 			goto retry;
 		}
+		/* The link device batches TX doorbells by xmit_more */
+		skb_new->xmit_more = skb->xmit_more;
 	}
 
 	/* Store the IO device, the link device, etc. */
@@ -1482,6 +1878,7 @@ int sipc5_init_io_device(struct io_device *iod)
 	case IODEV_MISC:
 		init_waitqueue_head(&iod->wq);
 		skb_queue_head_init(&iod->sk_rx_q);
+		mutex_init(&iod->dump_stream.lock);
 
 		iod->miscdev.minor = MISC_DYNAMIC_MINOR;
 		iod->miscdev.name = iod->name;
@@ -1571,6 +1968,28 @@ int sipc5_init_io_device(struct io_device *iod)
 		if (ret)
 			mif_err("failed to create `txlink file' : %s\n",
 					iod->name);
+
+		rx_steer_init();
+
+		ret = device_create_file(iod->miscdev.this_device,
+				&attr_rxsteer);
+		if (ret)
+			mif_err("failed to create `rxsteer file' : %s\n",
+					iod->name);
+
+		ret = device_create_file(iod->miscdev.this_device,
+				&attr_rxsteer_cpus);
+		if (ret)
+			mif_err("failed to create `rxsteer_cpus file' : %s\n",
+					iod->name);
+
+#ifdef CONFIG_MODEM_IF_NET_GRO
+		ret = device_create_file(iod->miscdev.this_device,
+				&attr_gro_bypass);
+		if (ret)
+			mif_err("failed to create `gro_bypass file' : %s\n",
+					iod->name);
+#endif
 		break;
 
 	default:
@@ -1610,6 +2029,11 @@ void sipc5_deinit_io_device(struct io_device *iod)
 		device_remove_file(iod->miscdev.this_device, &attr_waketime);
 		device_remove_file(iod->miscdev.this_device, &attr_loopback);
 		device_remove_file(iod->miscdev.this_device, &attr_txlink);
+		device_remove_file(iod->miscdev.this_device, &attr_rxsteer);
+		device_remove_file(iod->miscdev.this_device, &attr_rxsteer_cpus);
+#ifdef CONFIG_MODEM_IF_NET_GRO
+		device_remove_file(iod->miscdev.this_device, &attr_gro_bypass);
+#endif
 
 		misc_deregister(&iod->miscdev);
 		break;
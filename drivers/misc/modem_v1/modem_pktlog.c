@@ -19,8 +19,12 @@
 #include <linux/skbuff.h>
 #include <linux/interrupt.h>
 #include <linux/netdevice.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
 
+#include "modem_v1.h"
 #include "modem_pktlog.h"
+#include "include/sipc5.h"
 
 #if 0
 #define PKTLOG_MAX_LEN 256
@@ -54,36 +58,141 @@ void pktlog_copy_buf(struct pktlog_data *pktlog, int type, void *buf)
 }
 #endif
 
+static inline unsigned ring_space(struct pktlog_ring *ring,
+		unsigned head, unsigned tail)
+{
+	return (tail > head) ? tail - head - 1 : ring->size - head + tail - 1;
+}
+
+/*
+ * Writes a pcap record of @skb truncated to snaplen straight into the ring,
+ * so that neither a clone nor a queue is needed.
+ */
 void pktlog_queue_skb(struct pktlog_data *pktlog, unsigned char dir,
 		struct sk_buff *skb)
 {
-	struct sk_buff *pkt;
+	struct pktlog_ring *ring;
+	struct pktdump_hdr hdr;
+	struct timeval tv;
+	unsigned cook_hdr_len = sizeof(struct pktdump_hdr)
+			- sizeof(struct pcap_hdr);
+	unsigned head, tail, payload_len, rec_len, space;
+	unsigned long flags;
 
-	if (!pktlog || !pktlog->qmax)
+	if (!pktlog || !pktlog->qmax || !pktlog->ring)
 		return;
 
-	pkt = skb_clone(skb, in_interrupt() ? GFP_ATOMIC : GFP_KERNEL);
-	if (!pkt) {
-		pr_err("%s: fail to skb_clone for pktlog buf\n", __func__);
-		return;
+	spin_lock_irqsave(&pktlog->lock, flags);
+
+	ring = pktlog->ring;
+	if (!ring)
+		goto exit;
+
+	if (skb->len > SIPC5_CH_ID_OFFSET &&
+	    !test_bit(sipc5_get_ch(skb->data), pktlog->ch_filter)) {
+		ring->filtered++;
+		goto exit;
 	}
-	pkt->tstamp = timespec_to_ktime(current_kernel_time());
-	pktpriv(pkt)->dir = dir;
 
-	skb_queue_tail(&pktlog->logq, pkt);
-	if (pktlog->logq.qlen > pktlog->qmax) {
-		struct sk_buff *drop = skb_dequeue(&pktlog->logq);
-		if (drop)
-			dev_kfree_skb_any(drop);
-		printk_ratelimited(KERN_INFO "%s: over qmax(%d)\n", __func__,
-			pktlog->logq.qlen);
+	payload_len = min(skb->len, pktlog->snaplen - cook_hdr_len);
+	rec_len = sizeof(struct pktdump_hdr) + payload_len;
+
+	head = ring->head;
+	tail = READ_ONCE(ring->tail);
+	if (unlikely(head >= ring->size || tail >= ring->size)) {
+		/* The reader scribbled the control page, start over */
+		ring->head = ring->tail = 0;
+		head = tail = 0;
 	}
+
+	space = ring_space(ring, head, tail);
+	if (ring->size - head < rec_len) {
+		/* The record does not fit before the end, wrap to offset 0 */
+		if (tail > head || space < ring->size - head + rec_len) {
+			ring->drops++;
+			goto exit;
+		}
+		if (ring->size - head >= sizeof(struct pcap_hdr)) {
+			hdr.pcap.caplen = PKTLOG_WRAP;
+			memcpy(pktlog->rec + head, &hdr.pcap,
+					sizeof(struct pcap_hdr));
+		}
+		head = 0;
+	} else if (space < rec_len) {
+		ring->drops++;
+		goto exit;
+	}
+
+	tv = ktime_to_timeval(ktime_get_real());
+	hdr.pcap.tv_sec = tv.tv_sec;
+	hdr.pcap.tv_usec = tv.tv_usec;
+	hdr.pcap.len = cook_hdr_len + skb->len;
+	hdr.pcap.caplen = cook_hdr_len + payload_len;
+	hdr.sd.dir = dir;
+
+	memcpy(pktlog->rec + head, &hdr, sizeof(struct pktdump_hdr));
+	skb_copy_bits(skb, 0, pktlog->rec + head + sizeof(struct pktdump_hdr),
+			payload_len);
+
+	/* Publish the record to the reader after its contents */
+	smp_wmb();
+	head += rec_len;
+	WRITE_ONCE(ring->head, (head < ring->size) ? head : 0);
+	pktlog->logged++;
+
+	spin_unlock_irqrestore(&pktlog->lock, flags);
+
 	wake_up(&pktlog->wq);
+	return;
+
+exit:
+	spin_unlock_irqrestore(&pktlog->lock, flags);
+}
+
+static int pktlog_alloc_ring(struct pktlog_data *pktlog)
+{
+	struct pktlog_ring *ring;
+	unsigned long size;
+	unsigned long flags;
+
+	/* Room for qmax records of snaplen */
+	size = (unsigned long)max(pktlog->qmax, 1U) *
+		(sizeof(struct pcap_hdr) + pktlog->snaplen);
+	size = PAGE_ALIGN(size);
+
+	ring = vmalloc_user(PKTLOG_RING_OFFSET + size);
+	if (!ring)
+		return -ENOMEM;
+
+	ring->size = size;
+
+	spin_lock_irqsave(&pktlog->lock, flags);
+	pktlog->rec = (u8 *)ring + PKTLOG_RING_OFFSET;
+	pktlog->ring = ring;
+	pktlog->logged = 0;
+	spin_unlock_irqrestore(&pktlog->lock, flags);
+
+	return 0;
+}
+
+static void pktlog_free_ring(struct pktlog_data *pktlog)
+{
+	struct pktlog_ring *ring;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pktlog->lock, flags);
+	ring = pktlog->ring;
+	pktlog->ring = NULL;
+	pktlog->rec = NULL;
+	spin_unlock_irqrestore(&pktlog->lock, flags);
+
+	vfree(ring);
 }
 
 static int pktlog_open(struct inode *inode, struct file *filp)
 {
 	struct pktlog_data *pktlog = filp->private_data;
+	int ret;
 
 	if (!pktlog) {
 		pr_err("%s: Invalid pktlog data\n", __func__);
@@ -99,8 +208,15 @@ static int pktlog_open(struct inode *inode, struct file *filp)
 	pktlog->file_hdr.snaplen = pktlog->snaplen;
 	pktlog->copy_file_header = true;
 
-	pr_info("%s: qmax = %d open by %s\n", __func__, pktlog->qmax,
-			current->comm);
+	ret = pktlog_alloc_ring(pktlog);
+	if (ret) {
+		pr_err("%s: fail to alloc pktlog ring\n", __func__);
+		atomic_dec(&pktlog->opened);
+		return ret;
+	}
+
+	pr_info("%s: qmax = %d ring = %u open by %s\n", __func__, pktlog->qmax,
+			pktlog->ring->size, current->comm);
 	return 0;
 }
 
@@ -108,11 +224,20 @@ static int pktlog_release(struct inode *inode, struct file *filp)
 {
 	struct pktlog_data *pktlog = filp->private_data;
 
+	pktlog_free_ring(pktlog);
+
 	pr_info("%s: qmax = %d close by %s- %d\n", __func__, pktlog->qmax,
 			current->comm, atomic_dec_return(&pktlog->opened));
 	return 0;
 }
 
+static bool pktlog_ring_empty(struct pktlog_data *pktlog)
+{
+	struct pktlog_ring *ring = pktlog->ring;
+
+	return !ring || READ_ONCE(ring->head) == READ_ONCE(ring->tail);
+}
+
 static unsigned int pktlog_poll(struct file *filp, struct poll_table_struct *wait)
 {
 	struct pktlog_data *pktlog = filp->private_data;
@@ -122,76 +247,89 @@ static unsigned int pktlog_poll(struct file *filp, struct poll_table_struct *wai
 		return POLLERR;
 	}
 
-	if (skb_queue_empty(&pktlog->logq))
-		poll_wait(filp, &pktlog->wq, wait);
+	poll_wait(filp, &pktlog->wq, wait);
 
-	return POLLIN;
+	return pktlog_ring_empty(pktlog) ? 0 : (POLLIN | POLLRDNORM);
+}
+
+/*
+ * The record area and the control page are mapped read/write so that the
+ * reader can consume records in place and move the tail by itself.
+ */
+static int pktlog_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	struct pktlog_data *pktlog = filp->private_data;
+	unsigned long size = vma->vm_end - vma->vm_start;
+
+	if (!pktlog || !pktlog->ring)
+		return -EINVAL;
+
+	if (vma->vm_pgoff ||
+	    size > PKTLOG_RING_OFFSET + pktlog->ring->size)
+		return -EINVAL;
+
+	return remap_vmalloc_range(vma, pktlog->ring, 0);
 }
 
 static ssize_t pktlog_read(struct file *filp, char *buf, size_t count,
 			loff_t *fpos)
 {
 	struct pktlog_data *pktlog = filp->private_data;
-	struct sk_buff *pkt;
+	struct pktlog_ring *ring;
+	struct pcap_hdr pcap;
 	char *p = buf;
-	struct pktdump_hdr *hdr = &pktlog->hdr;
-	struct timeval tv;
-	int ret;
-	unsigned cook_hdr_len = sizeof(struct pktdump_hdr)
-			- sizeof(struct pcap_hdr);
-	unsigned payload_len, cplen = 0;
+	unsigned tail, rec_len;
+	unsigned cplen = 0;
 
-	if (!pktlog) {
+	if (!pktlog || !pktlog->ring) {
 		pr_err("%s: Invalid pktlog data\n", __func__);
 		return -EINVAL;
 	}
+	ring = pktlog->ring;
 
 	if (pktlog->copy_file_header) {
+		if (count < sizeof(struct pcap_file_header))
+			return -EINVAL;
+		if (copy_to_user(p, &pktlog->file_hdr,
+				sizeof(struct pcap_file_header)))
+			return -EFAULT;
 		pktlog->copy_file_header = false;
-		ret = copy_to_user(p, &pktlog->file_hdr,
-				sizeof(struct pcap_file_header));
-		if (ret < 0)
-			printk_ratelimited(KERN_ERR
-			"%s: fileheader copy fail\n", __func__);
 		cplen += sizeof(struct pcap_file_header);
 		p += sizeof(struct pcap_file_header);
 	}
 
-	pkt = skb_dequeue(&pktlog->logq);
-	if (unlikely(!pkt)) {
-		printk_ratelimited(KERN_ERR "%s: no log pakcets\n", __func__);
-		return 0;
-	}
+	if (pktlog_ring_empty(pktlog))
+		return cplen;
 
-	tv = ktime_to_timeval(pkt->tstamp);
-	hdr->pcap.tv_sec = tv.tv_sec;
-	hdr->pcap.tv_usec = tv.tv_usec;
-	hdr->pcap.len = cook_hdr_len + pkt->len;
-	hdr->pcap.caplen = min(hdr->pcap.len, pktlog->snaplen);
+	/* Read the record after seeing the head that published it */
+	smp_rmb();
 
-	hdr->sd.dir = pktpriv(pkt)->dir;
+	tail = READ_ONCE(ring->tail);
+	if (tail >= ring->size)
+		return -EIO;
 
-	ret = copy_to_user(p, hdr, sizeof(struct pktdump_hdr));
-	if (ret < 0) {
-		printk_ratelimited(KERN_ERR "%s: pcap header copy fail\n",
-			__func__);
-		goto exit;
+	if (ring->size - tail < sizeof(struct pcap_hdr))
+		tail = 0;
+	memcpy(&pcap, pktlog->rec + tail, sizeof(struct pcap_hdr));
+	if (pcap.caplen == PKTLOG_WRAP) {
+		tail = 0;
+		memcpy(&pcap, pktlog->rec, sizeof(struct pcap_hdr));
 	}
-	cplen += sizeof(struct pktdump_hdr);
 
-	p += sizeof(struct pktdump_hdr);
-	payload_len = min(pkt->len, pktlog->snaplen - cook_hdr_len);
-	ret = copy_to_user(p, pkt->data, payload_len);
-	if (ret < 0) {
-		printk_ratelimited(KERN_ERR "%s: pcap data copy fail\n",
-			__func__);
-		goto exit;
-	}
-	cplen += payload_len;
-	dev_consume_skb_any(pkt);
-	return cplen;
-exit:
-	dev_kfree_skb_any(pkt);
+	rec_len = sizeof(struct pcap_hdr) + pcap.caplen;
+	if (tail + rec_len > ring->size)
+		return -EIO;
+
+	if (count - cplen < rec_len)
+		return cplen ? cplen : -EINVAL;
+
+	if (copy_to_user(p, pktlog->rec + tail, rec_len))
+		return -EFAULT;
+	cplen += rec_len;
+
+	tail += rec_len;
+	WRITE_ONCE(ring->tail, (tail < ring->size) ? tail : 0);
+
 	return cplen;
 }
 
@@ -253,12 +391,69 @@ static ssize_t store_qmax(struct device *dev,
 static struct device_attribute attr_qmax =
 	__ATTR(qmax, S_IRUGO | S_IWUSR, show_qmax, store_qmax);
 
+/* Channels that are logged, e.g. "10-14,245" */
+static ssize_t show_ch_filter(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct pktlog_data *pktlog = dev_get_drvdata(dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%*pbl\n", MAX_SIPC_CHANNELS,
+			pktlog->ch_filter);
+}
+
+static ssize_t store_ch_filter(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct pktlog_data *pktlog = dev_get_drvdata(dev);
+	DECLARE_BITMAP(filter, MAX_SIPC_CHANNELS);
+	unsigned long flags;
+	int ret;
+
+	ret = bitmap_parselist(buf, filter, MAX_SIPC_CHANNELS);
+	if (ret)
+		return ret;
+
+	spin_lock_irqsave(&pktlog->lock, flags);
+	bitmap_copy(pktlog->ch_filter, filter, MAX_SIPC_CHANNELS);
+	spin_unlock_irqrestore(&pktlog->lock, flags);
+
+	return count;
+}
+
+static struct device_attribute attr_ch_filter =
+	__ATTR(ch_filter, S_IRUGO | S_IWUSR, show_ch_filter, store_ch_filter);
+
+static ssize_t show_stat(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct pktlog_data *pktlog = dev_get_drvdata(dev);
+	struct pktlog_ring *ring;
+	unsigned long flags;
+	char *p = buf;
+
+	spin_lock_irqsave(&pktlog->lock, flags);
+	ring = pktlog->ring;
+	if (ring)
+		p += sprintf(p, "ring %u head %u tail %u logged %lu drops %u filtered %u\n",
+				ring->size, ring->head, ring->tail,
+				pktlog->logged, ring->drops, ring->filtered);
+	else
+		p += sprintf(p, "not opened\n");
+	spin_unlock_irqrestore(&pktlog->lock, flags);
+
+	return p - buf;
+}
+
+static struct device_attribute attr_stat =
+	__ATTR(stat, S_IRUGO, show_stat, NULL);
+
 static const struct file_operations pktlog_fops = {
 	.owner = THIS_MODULE,
 	.open = pktlog_open,
 	.release = pktlog_release,
 	.poll = pktlog_poll,
 	.read = pktlog_read,
+	.mmap = pktlog_mmap,
 };
 
 static void init_pcap_fileheader(struct pktlog_data *pktlog)
@@ -292,7 +487,8 @@ struct pktlog_data *create_pktlog(char *name)
 	pktlog->misc.parent = NULL;
 
 	init_waitqueue_head(&pktlog->wq);
-	skb_queue_head_init(&pktlog->logq);
+	spin_lock_init(&pktlog->lock);
+	bitmap_fill(pktlog->ch_filter, MAX_SIPC_CHANNELS);
 	pktlog->qmax = 0;
 	pktlog->snaplen = 256;
 	atomic_set(&pktlog->opened, 0);
@@ -317,6 +513,20 @@ struct pktlog_data *create_pktlog(char *name)
 				name);
 		goto free_exit;
 	}
+
+	ret = device_create_file(pktlog->misc.this_device, &attr_ch_filter);
+	if (ret) {
+		pr_err("%s: fail to create ch_filter sysfs file: %s\n", __func__,
+				name);
+		goto free_exit;
+	}
+
+	ret = device_create_file(pktlog->misc.this_device, &attr_stat);
+	if (ret) {
+		pr_err("%s: fail to create stat sysfs file: %s\n", __func__,
+				name);
+		goto free_exit;
+	}
 	init_pcap_fileheader(pktlog);
 	pr_info("%s: probed - %s\n", __func__, name);
 
@@ -333,6 +543,9 @@ void remove_pktlog(struct pktlog_data *pktlog)
 		return;
 
 	device_remove_file(pktlog->misc.this_device, &attr_qmax);
+	device_remove_file(pktlog->misc.this_device, &attr_snaplen);
+	device_remove_file(pktlog->misc.this_device, &attr_ch_filter);
+	device_remove_file(pktlog->misc.this_device, &attr_stat);
 	misc_deregister(&pktlog->misc);
 	kfree(pktlog);
 }
@@ -4,6 +4,7 @@
 #ifdef CONFIG_DEBUG_PKTLOG
 
 #include <linux/time.h>
+#include <linux/bitmap.h>
 
 struct pktbuf_private {
 	unsigned char dir;
@@ -52,6 +53,25 @@ struct pktdump_hdr {
 	struct sipc_debug sd;
 } __packed;
 
+/*
+ * The log is a ring of pcap records (struct pktdump_hdr + payload truncated
+ * to snaplen) in a vmalloc area that a reader can mmap. The first page has
+ * the ring control below and the records start at PKTLOG_RING_OFFSET.
+ * The kernel moves @head, the reader moves @tail after consuming records.
+ * A record never wraps; a record with caplen PKTLOG_WRAP, or less than a
+ * pcap header left before the end, means the next record is at offset 0.
+ */
+#define PKTLOG_RING_OFFSET	PAGE_SIZE
+#define PKTLOG_WRAP		0xFFFFFFFF
+
+struct pktlog_ring {
+	unsigned size;		/* bytes of the record area */
+	unsigned head;		/* offset of the next record to be written */
+	unsigned tail;		/* offset of the next record to be read */
+	unsigned drops;		/* records dropped because the ring was full */
+	unsigned filtered;	/* packets skipped by the channel filter */
+} __packed;
+
 struct pktlog_data {
 	struct miscdevice misc;
 	atomic_t opened;
@@ -60,11 +80,14 @@ struct pktlog_data {
 	unsigned qmax;
 	unsigned snaplen;
 
-	struct sk_buff_head logq;
+	spinlock_t lock;
+	struct pktlog_ring *ring;	/* allocated while the node is open */
+	u8 *rec;			/* record area of @ring */
+	unsigned long logged;
+	DECLARE_BITMAP(ch_filter, MAX_SIPC_CHANNELS);
 
 	bool copy_file_header;
 	struct pcap_file_header file_hdr;
-	struct pktdump_hdr hdr;
 };
 
 enum {
@@ -24,6 +24,7 @@
 #include <linux/completion.h>
 #include <linux/wakelock.h>
 #include <linux/spinlock.h>
+#include <linux/mutex.h>
 #include <linux/cdev.h>
 #include <linux/gpio.h>
 #include <linux/irq.h>
@@ -299,6 +300,14 @@ static const inline char *rx_state(enum iod_rx_state state)
 		return rx_state_string[state];
 }
 
+/* CP memory region read out by misc_read() without staging it in skbs */
+struct iod_dump_stream {
+	struct mutex lock;
+	u8 __iomem *base;	/* NULL if no dump is in progress */
+	size_t size;
+	size_t offset;
+};
+
 struct io_device {
 	struct list_head list;
 
@@ -351,6 +360,9 @@ struct io_device {
 	/* Rx queue of sk_buff */
 	struct sk_buff_head sk_rx_q;
 
+	/* Memory dump being read by the application */
+	struct iod_dump_stream dump_stream;
+
 	/* For keeping multi-frame packets temporarily */
 	struct sk_buff_head sk_multi_q[NUM_SIPC_MULTI_FRAME_IDS];
 
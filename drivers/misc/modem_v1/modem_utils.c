@@ -490,6 +490,20 @@ void netif_tx_flowctl(struct modem_shared *msd, bool tx_stop)
 	return;
 }
 
+#ifdef CONFIG_NET_LINK_HINT
+/* Publishes the UL capacity of the link for TCP on every net interface */
+void netif_set_link_hint(struct modem_shared *msd, unsigned int capacity_kbps,
+			 unsigned int queue_bytes)
+{
+	struct io_device *iod;
+
+	spin_lock(&msd->active_list_lock);
+	list_for_each_entry(iod, &msd->activated_ndev_list, node_ndev)
+		netdev_set_link_hint(iod->ndev, capacity_kbps, queue_bytes);
+	spin_unlock(&msd->active_list_lock);
+}
+#endif
+
 static void iodev_set_tx_link(struct io_device *iod, void *args)
 {
 	struct link_device *ld = (struct link_device *)args;
@@ -1280,6 +1294,13 @@ struct mif_buff_mng *init_mif_buff_mng(unsigned char *buffer_start,
 		return NULL;
 	}
 
+	bm->recycle = kcalloc(MIF_BUFF_RECYCLE_SIZE, sizeof(void *), GFP_KERNEL);
+	if (bm->recycle == NULL) {
+		kfree(bm->buffer_map);
+		kfree(bm);
+		return NULL;
+	}
+
 	mif_info("cell_count:%u, map_size:%u, map_size_byte:%lu  buff_map:%pK\n"
 		, bm->cell_count, bm->buffer_map_size,
 		(sizeof(unsigned int) * bm->buffer_map_size), bm->buffer_map);
@@ -1298,6 +1319,7 @@ struct mif_buff_mng *init_mif_buff_mng(unsigned char *buffer_start,
 void exit_mif_buff_mng(struct mif_buff_mng *bm)
 {
 	if (bm) {
+		kfree(bm->recycle);
 		kfree(bm->buffer_map);
 		kfree(bm);
 	}
@@ -1325,6 +1347,18 @@ void *alloc_mif_buff(struct mif_buff_mng *bm)
 
 	spin_lock_irqsave(&bm->lock, flags);
 
+	/* The cell of a consumed skb is still set in the map */
+	if (bm->recycle_count > 0) {
+		buff_allocated = bm->recycle[--bm->recycle_count];
+		bm->recycle_hit++;
+		bm->free_cell_count--;
+		bm->used_cell_count++;
+		spin_unlock_irqrestore(&bm->lock, flags);
+
+		return (void *)buff_allocated;
+	}
+	bm->recycle_miss++;
+
 	for (i = bm->current_map_index ; i < bm->buffer_map_size; i++) {
 		test_map = (uint64_t) bm->buffer_map[i];
 		test_map = ~test_map;
@@ -1442,7 +1476,12 @@ int free_mif_buff(struct mif_buff_mng *bm, void *buffer)
 
 	spin_lock_irqsave(&bm->lock, flags);
 
-	bm->buffer_map[i] &= ~(MIF_64BIT_FIRST_BIT >> j);
+	/* Keep the cell for the next allocation rather than scanning the map */
+	if (bm->recycle_count < MIF_BUFF_RECYCLE_SIZE)
+		bm->recycle[bm->recycle_count++] = bm->buffer_start +
+						(location * bm->cell_size);
+	else
+		bm->buffer_map[i] &= ~(MIF_64BIT_FIRST_BIT >> j);
 	bm->free_cell_count++;
 	bm->used_cell_count--;
 
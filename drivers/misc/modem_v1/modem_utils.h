@@ -392,6 +392,10 @@ void iodev_netif_stop(struct io_device *iod, void *args);
 
 /* netif wake/stop queue of iod having activated ndev */
 void netif_tx_flowctl(struct modem_shared *msd, bool tx_stop);
+#ifdef CONFIG_NET_LINK_HINT
+void netif_set_link_hint(struct modem_shared *msd, unsigned int capacity_kbps,
+			 unsigned int queue_bytes);
+#endif
 
 /* change tx_link of raw devices */
 void rawdevs_set_tx_link(struct modem_shared *msd, enum modem_link link_type);
@@ -534,6 +538,7 @@ void set_wakeup_packet_log(bool enable);
 #define MIF_BITS_FOR_BYTE	(8)
 #define MIF_BITS_FOR_MAP_CELL	(MIF_BUFF_MAP_CELL_SIZE * MIF_BITS_FOR_BYTE)
 #define MIF_64BIT_FIRST_BIT	(0x8000000000000000ULL)
+#define MIF_BUFF_RECYCLE_SIZE	(256)
 
 struct mif_buff_mng {
 	unsigned char *buffer_start;
@@ -550,6 +555,12 @@ struct mif_buff_mng {
 	uint64_t *buffer_map;
 	unsigned int buffer_map_size;
 	int current_map_index;
+
+	/* Cells freed lately, handed out again before the map is scanned */
+	void **recycle;
+	unsigned int recycle_count;
+	unsigned long recycle_hit;
+	unsigned long recycle_miss;
 };
 
 struct mif_buff_mng *init_mif_buff_mng(unsigned char *buffer_start,
@@ -15,6 +15,10 @@ static struct slsi_kic_pdata *pdata;
 
 static struct genl_ops slsi_kic_ops[SLSI_MAX_NUM_KIC_OPS];
 
+static uint batch_window_ms = 10;
+module_param(batch_window_ms, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(batch_window_ms, "Time indications are held to be multicast together, 0 sends each one immediately");
+
 static int slsi_kic_pre_doit(const struct genl_ops *ops, struct sk_buff *skb,
 			     struct genl_info *info)
 {
@@ -159,10 +163,8 @@ static int kic_build_firmware_event_msg(struct sk_buff *msg, uint32_t portid,
 	struct nlattr *nla;
 
 	hdr = kic_hdr_put(msg, portid, seq, flags, SLSI_KIC_CMD_FIRMWARE_EVENT_IND);
-	if (!hdr) {
-		nlmsg_free(msg);
+	if (!hdr)
 		return -EFAULT;
-	}
 
 	if (nla_put_u16(msg, SLSI_KIC_ATTR_FIRMWARE_EVENT_TYPE, firmware_event_type))
 		goto nla_put_failure;
@@ -603,6 +605,175 @@ nl_hdr_failure:
 }
 
 
+/**
+ * Batched multicast of indications
+ */
+static void kic_batch_send(struct slsi_kic_batch *batch, struct sk_buff *skb, uint32_t msgs, gfp_t flags)
+{
+	unsigned long irq_flags;
+	int           err;
+
+	err = genlmsg_multicast(&slsi_kic_fam, skb, 0, 0, flags);
+
+	spin_lock_irqsave(&batch->lock, irq_flags);
+	/* -ESRCH only means nobody is listening */
+	if (err && err != -ESRCH)
+		batch->dropped += msgs;
+	else
+		batch->sent += msgs;
+	spin_unlock_irqrestore(&batch->lock, irq_flags);
+}
+
+static void kic_batch_flush(struct slsi_kic_batch *batch)
+{
+	struct sk_buff *skb;
+	unsigned long  irq_flags;
+	uint32_t       msgs;
+
+	spin_lock_irqsave(&batch->lock, irq_flags);
+	skb = batch->skb;
+	msgs = batch->skb_msgs;
+	batch->skb = NULL;
+	batch->skb_msgs = 0;
+	batch->last_key = 0;
+	spin_unlock_irqrestore(&batch->lock, irq_flags);
+
+	if (skb)
+		kic_batch_send(batch, skb, msgs, GFP_KERNEL);
+}
+
+static void kic_batch_flush_work(struct work_struct *work)
+{
+	struct slsi_kic_batch *batch = container_of(to_delayed_work(work), struct slsi_kic_batch, flush_work);
+
+	kic_batch_flush(batch);
+}
+
+/**
+ * Queue a complete genl message for multicast, consuming msg.
+ * A message with the same non-zero key as the previous queued one is
+ * dropped and accounted as coalesced. Safe in atomic context.
+ */
+static int kic_batch_queue(struct sk_buff *msg, uint64_t key, gfp_t flags)
+{
+	struct slsi_kic_pdata *pdata = slsi_kic_core_get_context();
+	struct slsi_kic_batch *batch;
+	struct sk_buff        *full = NULL;
+	uint32_t              full_msgs = 0;
+	unsigned long         irq_flags;
+	uint                  window = READ_ONCE(batch_window_ms);
+
+	if (!pdata) {
+		nlmsg_free(msg);
+		return -EINVAL;
+	}
+	batch = &pdata->batch;
+
+	spin_lock_irqsave(&batch->lock, irq_flags);
+	batch->queued++;
+
+	if (key && batch->skb && key == batch->last_key) {
+		batch->coalesced++;
+		spin_unlock_irqrestore(&batch->lock, irq_flags);
+		nlmsg_free(msg);
+		return 0;
+	}
+
+	if (!window) {
+		spin_unlock_irqrestore(&batch->lock, irq_flags);
+		kic_batch_send(batch, msg, 1, flags);
+		return 0;
+	}
+
+	if (batch->skb && skb_tailroom(batch->skb) < msg->len) {
+		full = batch->skb;
+		full_msgs = batch->skb_msgs;
+		batch->skb = NULL;
+		batch->skb_msgs = 0;
+	}
+
+	if (!batch->skb)
+		batch->skb = nlmsg_new(NLMSG_DEFAULT_SIZE, GFP_ATOMIC);
+
+	if (batch->skb && skb_tailroom(batch->skb) >= msg->len) {
+		skb_put_data(batch->skb, msg->data, msg->len);
+		batch->skb_msgs++;
+		batch->last_key = key;
+		spin_unlock_irqrestore(&batch->lock, irq_flags);
+		nlmsg_free(msg);
+	} else {
+		/* Too big to be batched, or no memory for the batch */
+		spin_unlock_irqrestore(&batch->lock, irq_flags);
+		kic_batch_send(batch, msg, 1, flags);
+	}
+
+	if (full)
+		kic_batch_send(batch, full, full_msgs, flags);
+
+	/* Not re-armed if pending, the window starts with the first message */
+	schedule_delayed_work(&batch->flush_work, msecs_to_jiffies(window));
+
+	return 0;
+}
+
+static void kic_batch_init(struct slsi_kic_batch *batch)
+{
+	spin_lock_init(&batch->lock);
+	INIT_DELAYED_WORK(&batch->flush_work, kic_batch_flush_work);
+}
+
+static void kic_batch_deinit(struct slsi_kic_batch *batch)
+{
+	cancel_delayed_work_sync(&batch->flush_work);
+	kic_batch_flush(batch);
+}
+
+static int batch_stats_set_param_cb(const char *val, const struct kernel_param *kp)
+{
+	return -EPERM;
+}
+
+static int batch_stats_get_param_cb(char *buffer, const struct kernel_param *kp)
+{
+	struct slsi_kic_pdata *pdata = slsi_kic_core_get_context();
+	struct slsi_kic_batch *batch;
+	unsigned long         irq_flags;
+	int                   len;
+
+	if (!pdata)
+		return -EINVAL;
+	batch = &pdata->batch;
+
+	spin_lock_irqsave(&batch->lock, irq_flags);
+	len = sprintf(buffer, "queued %u sent %u coalesced %u filtered %u dropped %u pending %u\n",
+		      batch->queued, batch->sent, batch->coalesced, batch->filtered,
+		      batch->dropped, batch->skb_msgs);
+	spin_unlock_irqrestore(&batch->lock, irq_flags);
+
+	return len;
+}
+
+static struct kernel_param_ops batch_stats_ops = {
+	.set = batch_stats_set_param_cb,
+	.get = batch_stats_get_param_cb,
+};
+module_param_cb(batch_stats, &batch_stats_ops, NULL, 0444);
+MODULE_PARM_DESC(batch_stats, "Indication delivery statistics");
+
+static void kic_batch_filtered(void)
+{
+	struct slsi_kic_pdata *pdata = slsi_kic_core_get_context();
+	unsigned long         irq_flags;
+
+	if (!pdata)
+		return;
+
+	spin_lock_irqsave(&pdata->batch.lock, irq_flags);
+	pdata->batch.filtered++;
+	spin_unlock_irqrestore(&pdata->batch.lock, irq_flags);
+}
+
+
 int slsi_kic_service_information_ind(enum slsi_kic_technology_type tech,
 				     struct slsi_kic_service_info  *info)
 {
@@ -621,7 +792,7 @@ int slsi_kic_service_information_ind(enum slsi_kic_technology_type tech,
 	if (kic_build_service_info_msg(msg, 0, 0, 0, tech, info) < 0)
 		goto err;
 
-	return genlmsg_multicast(&slsi_kic_fam, msg, 0, 0, GFP_KERNEL);
+	return kic_batch_queue(msg, 0, GFP_KERNEL);
 
 err:
 	nlmsg_free(msg);
@@ -635,6 +806,11 @@ int slsi_kic_system_event_ind(enum slsi_kic_system_event_category event_cat,
 {
 	struct sk_buff *msg;
 
+	if (slsi_kic_filter_system_event(event_cat, event)) {
+		kic_batch_filtered();
+		return 0;
+	}
+
 	msg = nlmsg_new(NLMSG_DEFAULT_SIZE, flags);
 	if (!msg)
 		return -ENOMEM;
@@ -642,7 +818,8 @@ int slsi_kic_system_event_ind(enum slsi_kic_system_event_category event_cat,
 	if (kic_build_system_event_msg(msg, 0, 0, 0, event_cat, event) < 0)
 		goto err;
 
-	return genlmsg_multicast(&slsi_kic_fam, msg, 0, 0, flags);
+	/* Back to back repeats of an event, e.g. while roaming, are sent once */
+	return kic_batch_queue(msg, BIT_ULL(63) | ((uint64_t)event_cat << 32) | event, flags);
 
 err:
 	nlmsg_free(msg);
@@ -656,14 +833,21 @@ int slsi_kic_firmware_event_ind(uint16_t firmware_event_type, enum slsi_kic_tech
 {
 	struct sk_buff *msg;
 
+	if (slsi_kic_filter_firmware_event(firmware_event_type)) {
+		kic_batch_filtered();
+		return 0;
+	}
+
 	msg = nlmsg_new(NLMSG_DEFAULT_SIZE, GFP_KERNEL);
 	if (!msg)
 		return -ENOMEM;
 
-	if (kic_build_firmware_event_msg(msg, 0, 0, 0, firmware_event_type, tech_type, contain_type, event) < 0)
+	if (kic_build_firmware_event_msg(msg, 0, 0, 0, firmware_event_type, tech_type, contain_type, event) < 0) {
+		nlmsg_free(msg);
 		return -ENOBUFS;
+	}
 
-	return genlmsg_multicast(&slsi_kic_fam, msg, 0, 0, GFP_KERNEL);
+	return kic_batch_queue(msg, 0, GFP_KERNEL);
 }
 EXPORT_SYMBOL(slsi_kic_firmware_event_ind);
 
@@ -736,6 +920,7 @@ static int __init slsi_kic_init(void)
 	/* Init chip information proxy list */
 	INIT_LIST_HEAD(&pdata->chip_details.proxy_service_list);
 	sema_init(&pdata->chip_details.proxy_service_list_mutex, 1);
+	kic_batch_init(&pdata->batch);
 	pdata->state = idle;
 
 	err = genl_register_family(&slsi_kic_fam);
@@ -766,6 +951,7 @@ static void __exit slsi_kic_exit(void)
 	}
 
 	mutex_lock(&kic_lock);
+	kic_batch_deinit(&pdata->batch);
 	err = genl_unregister_family(&slsi_kic_fam);
 	if (err < 0)
 		SCSC_TAG_ERR(KIC_COMMON, "%s Failed to unregister family\n", __func__);
@@ -4,5 +4,27 @@
  *
  ****************************************************************************/
 
-/* Implement subscriber and filtering here. This won't be essential for
- * first draft of the kernel KIC implementation */
+#include "slsi_kic_internal.h"
+
+/* Subscriber based filtering is not implemented: events filtered here
+ * are dropped for all listeners of the multicast group. */
+
+static uint system_event_category_filter;
+module_param(system_event_category_filter, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(system_event_category_filter, "Bitmask of system event categories not sent to userspace");
+
+static uint firmware_event_type_filter;
+module_param(firmware_event_type_filter, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(firmware_event_type_filter, "Bitmask of firmware event types not sent to userspace");
+
+bool slsi_kic_filter_system_event(uint32_t event_cat, uint32_t event)
+{
+	OS_UNUSED_PARAMETER(event);
+
+	return event_cat < 32 && (READ_ONCE(system_event_category_filter) & BIT(event_cat));
+}
+
+bool slsi_kic_filter_firmware_event(uint16_t firmware_event_type)
+{
+	return firmware_event_type < 32 && (READ_ONCE(firmware_event_type_filter) & BIT(firmware_event_type));
+}
@@ -17,6 +17,8 @@
 #include <net/genetlink.h>
 #include <linux/time.h>
 #include <linux/module.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
 
 #include <scsc/scsc_logring.h>
 
@@ -72,6 +74,26 @@ struct slsi_kic_cm_ops_tuple {
 	struct mutex           ops_mutex;
 };
 
+/**
+ * Indications queued for multicast. Messages are appended to one skb
+ * for up to batch_window_ms so that userspace reads a burst of events
+ * in a single recv().
+ */
+struct slsi_kic_batch {
+	spinlock_t          lock;
+	struct sk_buff      *skb;
+	uint32_t            skb_msgs;
+	uint64_t            last_key;   /* Key of the last queued message, 0 if none */
+	struct delayed_work flush_work;
+
+	/* Statistics, in number of messages */
+	uint32_t            queued;
+	uint32_t            sent;
+	uint32_t            coalesced;
+	uint32_t            filtered;
+	uint32_t            dropped;
+};
+
 struct slsi_kic_pdata {
 	enum slsi_kic_state            state;
 	struct slsi_kic_chip_details   chip_details;
@@ -79,6 +101,7 @@ struct slsi_kic_pdata {
 	struct slsi_kic_cm_ops_tuple   cm_ops_tuple;
 	struct slsi_kic_bt_ops_tuple   bt_ops_tuple;
 	struct slsi_kic_ant_ops_tuple  ant_ops_tuple;
+	struct slsi_kic_batch          batch;
 	uint32_t                       seq;     /* This should *perhaps* be moved to a record struct for
 						* each subscription - will look into that during the
 						* filtering work. */
@@ -86,4 +109,8 @@ struct slsi_kic_pdata {
 
 struct slsi_kic_pdata *slsi_kic_core_get_context(void);
 
+/* Return true if the event must not be sent to userspace */
+bool slsi_kic_filter_system_event(uint32_t event_cat, uint32_t event);
+bool slsi_kic_filter_firmware_event(uint16_t firmware_event_type);
+
 #endif /* #ifndef __SLSI_KIC_INTERNAL_H */
@@ -317,6 +317,82 @@ void cpacketbuffer_peek_complete(struct cpacketbuffer *buffer, const void *curre
 	wmb();
 }
 
+uint32_t cpacketbuffer_peek_batch(struct cpacketbuffer *buffer, struct cpacketbuffer_batch *batch, uint32_t max_packets)
+{
+	uint32_t read_index = cpacketbuffer_read_index(buffer);
+	uint32_t write_index = cpacketbuffer_write_index(buffer);
+	uint32_t num_packets;
+
+	batch->num_packets[0] = 0;
+	batch->num_packets[1] = 0;
+
+	if (read_index >= buffer->num_packets || write_index >= buffer->num_packets)
+		return 0;
+
+	/* Read the packets after the write index that published them */
+	rmb();
+
+	num_packets = (write_index + buffer->num_packets - read_index) % buffer->num_packets;
+	if (num_packets > max_packets)
+		num_packets = max_packets;
+	if (num_packets == 0)
+		return 0;
+
+	batch->data[0] = cpacketbuffer_index_to_address(buffer, &read_index);
+	if (read_index + num_packets > buffer->num_packets) {
+		/* The batch wraps around the end of the buffer */
+		batch->num_packets[0] = buffer->num_packets - read_index;
+		batch->data[1] = buffer->buffer;
+		batch->num_packets[1] = num_packets - batch->num_packets[0];
+	} else
+		batch->num_packets[0] = num_packets;
+
+	return num_packets;
+}
+
+void cpacketbuffer_peek_batch_complete(struct cpacketbuffer *buffer, uint32_t num_packets)
+{
+	if (num_packets == 0)
+		return;
+
+	/* Finish reading the packets before handing them back to the writer */
+	mb();
+	cpacketbuffer_advance_index(buffer->read_index, num_packets, buffer->num_packets);
+	/* CPU memory barrier */
+	wmb();
+}
+
+uint32_t cpacketbuffer_batch_copy(const struct cpacketbuffer *buffer, const struct cpacketbuffer_batch *batch,
+				  uint32_t first_packet, void *buf, uint32_t num_bytes)
+{
+	uint32_t num_packets = (num_bytes + buffer->packet_size - 1) / buffer->packet_size;
+	uint32_t copied = 0;
+	int      i;
+
+	if (first_packet + num_packets > batch->num_packets[0] + batch->num_packets[1])
+		return 0;
+
+	for (i = 0; i < 2 && copied < num_bytes; i++) {
+		uint32_t run_bytes;
+
+		if (first_packet >= batch->num_packets[i]) {
+			first_packet -= batch->num_packets[i];
+			continue;
+		}
+
+		run_bytes = (batch->num_packets[i] - first_packet) * buffer->packet_size;
+		if (run_bytes > num_bytes - copied)
+			run_bytes = num_bytes - copied;
+
+		memcpy((uint8_t *)buf + copied,
+		       (const uint8_t *)batch->data[i] + first_packet * buffer->packet_size, run_bytes);
+		copied += run_bytes;
+		first_packet = 0;
+	}
+
+	return copied;
+}
+
 bool cpacketbuffer_is_empty(const struct cpacketbuffer *buffer)
 {
 	return cpacketbuffer_read_index(buffer) == cpacketbuffer_write_index(buffer);
@@ -19,6 +19,16 @@
 
 struct cpacketbuffer;
 
+/**
+ * Packets returned by cpacketbuffer_peek_batch(), as up to two runs of
+ * contiguous packets: the second run is used when the packets wrap around
+ * the end of the buffer.
+ */
+struct cpacketbuffer_batch {
+	const void *data[2];
+	uint32_t   num_packets[2];
+};
+
 /**
  * Initialises the circular buffer.
  * The memory buffer length must be a multiple of the packet size.
@@ -82,6 +92,35 @@ const void *cpacketbuffer_peek(struct cpacketbuffer *buffer, const void *current
  */
 void cpacketbuffer_peek_complete(struct cpacketbuffer *buffer, const void *packet);
 
+/**
+ * Returns up to max_packets of the packets available in the buffer in one
+ * call, without removing them. The write index is sampled once, so the
+ * caller can process the whole batch in place without touching the shared
+ * indexes again.
+ *
+ * cpacketbuffer_peek_batch_complete must be called to remove the packets that
+ * have been processed from the buffer.
+ *
+ * Returns the number of packets in the batch, 0 if the buffer is empty.
+ */
+uint32_t cpacketbuffer_peek_batch(struct cpacketbuffer *buffer, struct cpacketbuffer_batch *batch, uint32_t max_packets);
+
+/**
+ * Removes the first num_packets packets of a batch from the buffer, moving
+ * the read index once.
+ */
+void cpacketbuffer_peek_batch_complete(struct cpacketbuffer *buffer, uint32_t num_packets);
+
+/**
+ * Copies num_bytes starting at packet first_packet of a batch to the provided
+ * address, following the wrap of the batch.
+ *
+ * Returns the number of bytes copied, or 0 if the batch does not hold that
+ * much data.
+ */
+uint32_t cpacketbuffer_batch_copy(const struct cpacketbuffer *buffer, const struct cpacketbuffer_batch *batch,
+				  uint32_t first_packet, void *buf, uint32_t num_bytes);
+
 /**
  * Writes a number of bytes to the buffer. This will always use up whole packets in the buffer
  * even if the amount of data written is not an exact multiple of the packet size.
@@ -10,6 +10,9 @@
 #include "mifproc.h"
 #include "scsc_mif_abs.h"
 #include "miframman.h"
+#ifdef CONFIG_SCSC_QOS
+#include "mifqos.h"
+#endif
 
 #define MX_MAX_PROC_RAMMAN 2	/* Number of RAMMANs to track */
 
@@ -42,6 +45,11 @@ MIF_PROCFS_RO_FILE_OPS(ramman_size);
 
 MIF_PROCFS_SEQ_FILE_OPS(ramman_list);
 
+#ifdef CONFIG_SCSC_QOS
+/* mifqos ops */
+MIF_PROCFS_SEQ_FILE_OPS(qos_log);
+#endif
+
 #ifdef CONFIG_SCSC_PCIE
 static ssize_t mifprocfs_mif_reg_read(struct file *file, char __user *user_buf, size_t count, loff_t *ppos)
 {
@@ -366,6 +374,19 @@ static int mifprocfs_ramman_list_show(struct seq_file *m, void *v)
 	return 0;
 }
 
+#ifdef CONFIG_SCSC_QOS
+/* Current QoS levels and recent requests */
+static int mifprocfs_qos_log_show(struct seq_file *m, void *v)
+{
+	struct mifqos *qos = (struct mifqos *)m->private;
+	(void)v;
+
+	mifqos_log(qos, m);
+
+	return 0;
+}
+#endif
+
 static const char *procdir = "driver/mif_ctrl";
 static int refcount;
 
@@ -524,3 +545,50 @@ void mifproc_remove_ramman_proc_dir(struct miframman *ramman)
 	/* De-ref the root dir */
 	destroy_procfs_dir();
 }
+
+#ifdef CONFIG_SCSC_QOS
+/* /proc/driver/mif_ctrl/qos */
+static const char *qos_procdir = "qos";
+static struct proc_dir_entry *procfs_dir_qos;
+
+int mifproc_create_qos_proc_dir(struct mifqos *qos)
+{
+	struct proc_dir_entry *parent;
+	struct proc_dir_entry *root;
+
+	if (procfs_dir_qos)
+		return -EEXIST;
+
+	/* Ref the root dir /proc/driver/mif_ctrl */
+	root = create_procfs_dir();
+	if (!root)
+		return -EINVAL;
+
+	parent = proc_mkdir(qos_procdir, root);
+	if (!parent) {
+		SCSC_TAG_INFO(MIF, "failed to create /proc dir\n");
+		destroy_procfs_dir();
+		return -EINVAL;
+	}
+
+	MIF_PROCFS_SEQ_ADD_FILE(qos, qos_log, parent, S_IRUSR | S_IRGRP | S_IROTH);
+	procfs_dir_qos = parent;
+
+	return 0;
+}
+
+void mifproc_remove_qos_proc_dir(struct mifqos *qos)
+{
+	(void)qos;
+
+	if (!procfs_dir_qos)
+		return;
+
+	MIF_PROCFS_REMOVE_FILE(qos_log, procfs_dir_qos);
+	remove_proc_entry(qos_procdir, procfs_dir);
+	procfs_dir_qos = NULL;
+
+	/* De-ref the root dir */
+	destroy_procfs_dir();
+}
+#endif
@@ -104,11 +104,14 @@
 
 struct scsc_mif_abs;
 struct miframman;
+struct mifqos;
 
 int mifproc_create_proc_dir(struct scsc_mif_abs *mif);
 void mifproc_remove_proc_dir(void);
 int mifproc_create_ramman_proc_dir(struct miframman *miframman);
 void mifproc_remove_ramman_proc_dir(struct miframman *miframman);
+int mifproc_create_qos_proc_dir(struct mifqos *qos);
+void mifproc_remove_qos_proc_dir(struct mifqos *qos);
 
 struct mifproc {
 };
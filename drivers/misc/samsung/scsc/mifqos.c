@@ -6,15 +6,113 @@
 
 /* uses */
 #include <linux/kernel.h>
+#include <linux/module.h>
 #include <linux/slab.h>
 #include <linux/mutex.h>
+#include <linux/sched/clock.h>
 #include <scsc/scsc_logring.h>
 #include <linux/bitmap.h>
 #include "scsc_mif_abs.h"
+#include "mifproc.h"
 
 /* Implements */
 #include "mifqos.h"
 
+static uint qos_tput_med_mbps = 100;
+module_param(qos_tput_med_mbps, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(qos_tput_med_mbps, "Throughput from which SCSC_QOS_MED is requested");
+
+static uint qos_tput_max_mbps = 400;
+module_param(qos_tput_max_mbps, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(qos_tput_max_mbps, "Throughput from which SCSC_QOS_MAX is requested");
+
+static uint qos_hold_ms = 200;
+module_param(qos_hold_ms, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(qos_hold_ms, "Time a lower QoS level must be requested before being applied, 0 disables");
+
+static const char * const mifqos_event_str[] = {
+	[MIFQOS_EV_ADD] = "add",
+	[MIFQOS_EV_UPDATE] = "update",
+	[MIFQOS_EV_HOLD] = "hold",
+	[MIFQOS_EV_LOWER] = "lower",
+	[MIFQOS_EV_REMOVE] = "remove",
+};
+
+/* Caller holds qos->lock */
+static void mifqos_trace(struct mifqos *qos, enum mifqos_event event, enum scsc_service_id id,
+			 enum scsc_qos_config requested)
+{
+	struct mifqos_trace_entry *e = &qos->trace[qos->trace_count++ % MIFQOS_TRACE_LEN];
+
+	e->ns = local_clock();
+	e->event = event;
+	e->id = id;
+	e->requested = requested;
+	e->applied = qos->svc[id].applied;
+	e->tput_mbps = qos->svc[id].tput_mbps;
+}
+
+static enum scsc_qos_config mifqos_tput_to_config(u32 tput_mbps)
+{
+	if (!tput_mbps)
+		return SCSC_QOS_DISABLED;
+	if (tput_mbps >= qos_tput_max_mbps)
+		return SCSC_QOS_MAX;
+	if (tput_mbps >= qos_tput_med_mbps)
+		return SCSC_QOS_MED;
+	return SCSC_QOS_MIN;
+}
+
+/*
+ * Raising the level is applied straight away, while lowering it is
+ * deferred by qos_hold_ms and dropped if the level is raised again in the
+ * meantime: a short throughput dip or spike then costs at most one MIF
+ * frequency change instead of two per burst.
+ * Caller holds qos->lock
+ */
+static int mifqos_apply(struct mifqos *qos, enum scsc_service_id id, enum scsc_qos_config config)
+{
+	struct mifqos_service *svc = &qos->svc[id];
+	struct scsc_mif_abs *mif = qos->mif;
+	int ret = 0;
+
+	svc->target = config;
+
+	if (config < svc->applied && qos_hold_ms) {
+		/* Not re-armed if already pending: hold from the first drop */
+		if (queue_delayed_work(system_wq, &svc->lower_work, msecs_to_jiffies(qos_hold_ms)))
+			mifqos_trace(qos, MIFQOS_EV_HOLD, id, config);
+		return 0;
+	}
+
+	cancel_delayed_work(&svc->lower_work);
+	if (config != svc->applied && mif->mif_pm_qos_update_request) {
+		ret = mif->mif_pm_qos_update_request(mif, &qos->qos_req[id], config);
+		if (!ret)
+			svc->applied = config;
+	}
+	mifqos_trace(qos, MIFQOS_EV_UPDATE, id, config);
+
+	return ret;
+}
+
+static void mifqos_lower_work(struct work_struct *work)
+{
+	struct mifqos_service *svc = container_of(to_delayed_work(work), struct mifqos_service, lower_work);
+	struct mifqos *qos = svc->qos;
+	struct scsc_mif_abs *mif = qos->mif;
+
+	mutex_lock(&qos->lock);
+	if (qos->qos_in_use[svc->id] && svc->target < svc->applied) {
+		SCSC_TAG_INFO(MIF, "Service id %d lower QoS %d -> %d\n", svc->id, svc->applied, svc->target);
+		if (mif->mif_pm_qos_update_request &&
+		    !mif->mif_pm_qos_update_request(mif, &qos->qos_req[svc->id], svc->target))
+			svc->applied = svc->target;
+		mifqos_trace(qos, MIFQOS_EV_LOWER, svc->id, svc->target);
+	}
+	mutex_unlock(&qos->lock);
+}
+
 int mifqos_init(struct mifqos *qos, struct scsc_mif_abs *mif)
 {
 	u8 i;
@@ -24,12 +122,23 @@ int mifqos_init(struct mifqos *qos, struct scsc_mif_abs *mif)
 
 	SCSC_TAG_INFO(MIF, "Init MIF QoS\n");
 
-	for (i = 0; i < SCSC_SERVICE_TOTAL; i++)
+	for (i = 0; i < SCSC_SERVICE_TOTAL; i++) {
 		qos->qos_in_use[i] = false;
+		qos->svc[i].qos = qos;
+		qos->svc[i].id = i;
+		qos->svc[i].applied = SCSC_QOS_DISABLED;
+		qos->svc[i].target = SCSC_QOS_DISABLED;
+		qos->svc[i].tput_mbps = 0;
+		INIT_DELAYED_WORK(&qos->svc[i].lower_work, mifqos_lower_work);
+	}
+	memset(qos->trace, 0, sizeof(qos->trace));
+	qos->trace_count = 0;
 
 	mutex_init(&qos->lock);
 	qos->mif = mif;
 
+	mifproc_create_qos_proc_dir(qos);
+
 	return 0;
 }
 
@@ -60,6 +169,10 @@ int mifqos_add_request(struct mifqos *qos, enum scsc_service_id id, enum scsc_qo
 		return ret;
 	}
 	qos->qos_in_use[id] = true;
+	qos->svc[id].applied = config;
+	qos->svc[id].target = config;
+	qos->svc[id].tput_mbps = 0;
+	mifqos_trace(qos, MIFQOS_EV_ADD, id, config);
 	mutex_unlock(&qos->lock);
 
 	return 0;
@@ -67,8 +180,7 @@ int mifqos_add_request(struct mifqos *qos, enum scsc_service_id id, enum scsc_qo
 
 int mifqos_update_request(struct mifqos *qos, enum scsc_service_id id, enum scsc_qos_config config)
 {
-	struct scsc_mif_abs *mif;
-	struct scsc_mifqos_request *req;
+	int ret;
 
 	if (!qos)
 		return -EIO;
@@ -81,15 +193,44 @@ int mifqos_update_request(struct mifqos *qos, enum scsc_service_id id, enum scsc
 
 	SCSC_TAG_INFO(MIF, "Service id %d update QoS request %d\n", id, config);
 
-	mif = qos->mif;
-	req = &qos->qos_req[id];
-
+	qos->svc[id].tput_mbps = 0;
+	ret = mifqos_apply(qos, id, config);
 	mutex_unlock(&qos->lock);
 
-	if (mif->mif_pm_qos_update_request)
-		return mif->mif_pm_qos_update_request(mif, req, config);
-	else
+	return ret;
+}
+
+/*
+ * Same as mifqos_update_request() with the level derived from the
+ * throughput the service is expecting. Meant to be called often, so
+ * only level changes are logged.
+ */
+int mifqos_update_request_tput(struct mifqos *qos, enum scsc_service_id id, u32 tput_mbps)
+{
+	enum scsc_qos_config config = mifqos_tput_to_config(tput_mbps);
+	int ret;
+
+	if (!qos)
+		return -EIO;
+
+	mutex_lock(&qos->lock);
+	if (!qos->qos_in_use[id]) {
+		mutex_unlock(&qos->lock);
+		return -EIO;
+	}
+
+	qos->svc[id].tput_mbps = tput_mbps;
+	if (config == qos->svc[id].target) {
+		mutex_unlock(&qos->lock);
 		return 0;
+	}
+
+	SCSC_TAG_DEBUG(MIF, "Service id %d update QoS tput %u Mbps -> %d\n", id, tput_mbps, config);
+
+	ret = mifqos_apply(qos, id, config);
+	mutex_unlock(&qos->lock);
+
+	return ret;
 }
 
 int mifqos_remove_request(struct mifqos *qos, enum scsc_service_id id)
@@ -112,9 +253,15 @@ int mifqos_remove_request(struct mifqos *qos, enum scsc_service_id id)
 	req = &qos->qos_req[id];
 
 	qos->qos_in_use[id] = false;
+	mifqos_trace(qos, MIFQOS_EV_REMOVE, id, SCSC_QOS_DISABLED);
+	qos->svc[id].applied = SCSC_QOS_DISABLED;
+	qos->svc[id].target = SCSC_QOS_DISABLED;
 
 	mutex_unlock(&qos->lock);
 
+	/* The worker checks qos_in_use, so it cannot touch req anymore */
+	cancel_delayed_work_sync(&qos->svc[id].lower_work);
+
 	if (mif->mif_pm_qos_remove_request)
 		return mif->mif_pm_qos_remove_request(mif, req);
 	else
@@ -130,6 +277,39 @@ int mifqos_deinit(struct mifqos *qos)
 	for (i = 0; i < SCSC_SERVICE_TOTAL; i++)
 		mifqos_remove_request(qos, i);
 
+	mifproc_remove_qos_proc_dir(qos);
+
 	return 0;
 }
 
+/* Log current requests and recent QoS events in proc */
+void mifqos_log(struct mifqos *qos, struct seq_file *fd)
+{
+	struct mifqos_trace_entry *e;
+	u32 i, n;
+
+	if (!qos)
+		return;
+
+	mutex_lock(&qos->lock);
+	seq_printf(fd, "tput med %u Mbps, max %u Mbps, hold %u ms\n\n",
+		qos_tput_med_mbps, qos_tput_max_mbps, qos_hold_ms);
+
+	for (i = 0; i < SCSC_SERVICE_TOTAL; i++) {
+		if (!qos->qos_in_use[i])
+			continue;
+		seq_printf(fd, "svc %u: applied %d, target %d, tput %u Mbps%s\n",
+			i, qos->svc[i].applied, qos->svc[i].target, qos->svc[i].tput_mbps,
+			delayed_work_pending(&qos->svc[i].lower_work) ? ", lowering" : "");
+	}
+
+	seq_puts(fd, "\n");
+	n = min_t(u32, qos->trace_count, MIFQOS_TRACE_LEN);
+	for (i = qos->trace_count - n; i != qos->trace_count; i++) {
+		e = &qos->trace[i % MIFQOS_TRACE_LEN];
+		seq_printf(fd, "[%llu.%06llu] svc %u %-6s requested %u applied %u tput %u Mbps\n",
+			e->ns / NSEC_PER_SEC, (e->ns % NSEC_PER_SEC) / NSEC_PER_USEC,
+			e->id, mifqos_event_str[e->event], e->requested, e->applied, e->tput_mbps);
+	}
+	mutex_unlock(&qos->lock);
+}
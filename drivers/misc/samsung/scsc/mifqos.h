@@ -7,6 +7,8 @@
 #define __MIFQOS_H
 
 #include <linux/mutex.h>
+#include <linux/workqueue.h>
+#include <linux/seq_file.h>
 #include <scsc/scsc_mx.h>
 
 struct scsc_mif_abs;
@@ -15,16 +17,53 @@ struct mifqos;
 int mifqos_init(struct mifqos *qos, struct scsc_mif_abs *mif);
 int mifqos_add_request(struct mifqos *qos, enum scsc_service_id id, enum scsc_qos_config config);
 int mifqos_update_request(struct mifqos *qos, enum scsc_service_id id, enum scsc_qos_config config);
+int mifqos_update_request_tput(struct mifqos *qos, enum scsc_service_id id, u32 tput_mbps);
 int mifqos_remove_request(struct mifqos *qos, enum scsc_service_id id);
 int mifqos_list(struct mifqos *qos);
 int mifqos_deinit(struct mifqos *qos);
+void mifqos_log(struct mifqos *qos, struct seq_file *fd);
 
 struct scsc_mifqos_request;
 
+#define MIFQOS_TRACE_LEN	64
+
+enum mifqos_event {
+	MIFQOS_EV_ADD,
+	MIFQOS_EV_UPDATE,
+	MIFQOS_EV_HOLD,		/* Lowering deferred by the hysteresis */
+	MIFQOS_EV_LOWER,	/* Deferred lowering applied */
+	MIFQOS_EV_REMOVE,
+};
+
+struct mifqos_trace_entry {
+	u64                   ns;
+	u32                   tput_mbps;	/* 0 if requested by level */
+	u8                    event;
+	u8                    id;
+	u8                    requested;
+	u8                    applied;
+};
+
+/*
+ * Per service state: lowering the level is held for qos_hold_ms so that
+ * bursty traffic does not bounce MIF/INT/CPU frequencies up and down.
+ */
+struct mifqos_service {
+	struct mifqos         *qos;
+	enum scsc_service_id  id;
+	enum scsc_qos_config  applied;
+	enum scsc_qos_config  target;
+	u32                   tput_mbps;
+	struct delayed_work   lower_work;
+};
+
 struct mifqos {
 	bool                 qos_in_use[SCSC_SERVICE_TOTAL];
 	struct mutex         lock;
 	struct scsc_mif_abs  *mif;
 	struct scsc_mifqos_request qos_req[SCSC_SERVICE_TOTAL];
+	struct mifqos_service svc[SCSC_SERVICE_TOTAL];
+	struct mifqos_trace_entry trace[MIFQOS_TRACE_LEN];
+	u32                  trace_count;
 };
 #endif
@@ -7,6 +7,8 @@
 #include <linux/kernel.h>
 #include <linux/printk.h>
 #include <linux/slab.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include <scsc/scsc_logring.h>
 #include "scsc_mif_abs.h"
 
@@ -33,6 +35,13 @@ void miframman_init(struct miframman *ram, void *start_dram, size_t size_pool, v
 	}
 
 	memset(ram->bitmap, BLOCK_FREE, sizeof(ram->bitmap));
+	memset(ram->classes, 0, sizeof(ram->classes));
+	ram->first_free = 0;
+	ram->num_allocs = 0;
+	ram->num_fails = 0;
+	ram->class_hits = 0;
+	ram->total_alloc_ns = 0;
+	ram->max_alloc_ns = 0;
 
 	ram->start_region = start_region;  /* For monitoring purposes only */
 	ram->start_dram = start_dram;
@@ -48,13 +57,76 @@ void miframabox_init(struct mifabox *mifabox, void *start_aboxram)
 	mifabox->aboxram = (struct scsc_bt_audio_abox *)start_aboxram;
 }
 
+static inline unsigned int miframman_class_of(size_t num_blocks)
+{
+	unsigned int c = fls(num_blocks) - 1;
+
+	return min_t(unsigned int, c, MIFRAMMAN_NUM_CLASSES - 1);
+}
+
+/* Remember a freed extent in its size class, evicting the oldest one */
+static void miframman_class_put(struct miframman *ram, u32 index, u32 num_blocks)
+{
+	struct miframman_class *cl = &ram->classes[miframman_class_of(num_blocks)];
+
+	if (cl->count == MIFRAMMAN_CLASS_DEPTH) {
+		memmove(&cl->index[0], &cl->index[1], sizeof(cl->index[0]) * (MIFRAMMAN_CLASS_DEPTH - 1));
+		memmove(&cl->blocks[0], &cl->blocks[1], sizeof(cl->blocks[0]) * (MIFRAMMAN_CLASS_DEPTH - 1));
+		cl->count--;
+	}
+	cl->index[cl->count] = index;
+	cl->blocks[cl->count] = num_blocks;
+	cl->count++;
+}
+
+/*
+ * Look for a cached extent of the class of num_blocks, long enough and
+ * still free in the bitmap (it may have been merged into a larger
+ * allocation by a bitmap scan since). Stale entries are dropped.
+ * Returns the first block index or -1.
+ */
+static int miframman_class_get(struct miframman *ram, size_t num_blocks)
+{
+	struct miframman_class *cl = &ram->classes[miframman_class_of(num_blocks)];
+	unsigned int i, j, b;
+	int index = -1;
+
+	/* Most recently freed first */
+	for (j = cl->count; j-- > 0;) {
+		bool stale = cl->index[j] + cl->blocks[j] > ram->num_blocks;
+
+		for (b = 0; !stale && b < cl->blocks[j]; b++)
+			if (ram->bitmap[cl->index[j] + b] != BLOCK_FREE)
+				stale = true;
+
+		if (!stale && cl->blocks[j] < num_blocks)
+			continue;
+
+		if (!stale)
+			index = cl->index[j];
+
+		/* Either taken or stale, drop it from the class */
+		for (i = j; i + 1 < cl->count; i++) {
+			cl->index[i] = cl->index[i + 1];
+			cl->blocks[i] = cl->blocks[i + 1];
+		}
+		cl->count--;
+
+		if (index >= 0)
+			break;
+	}
+
+	return index;
+}
+
 void *__miframman_alloc(struct miframman *ram, size_t nbytes, int tag)
 {
-	unsigned int index = 0;
+	unsigned int index;
 	unsigned int available;
 	unsigned int i;
 	size_t       num_blocks;
 	void         *free_mem = NULL;
+	int          cached;
 
 	if (!nbytes || nbytes > ram->free_mem)
 		goto end;
@@ -66,6 +138,15 @@ void *__miframman_alloc(struct miframman *ram, size_t nbytes, int tag)
 	if (num_blocks > ram->num_blocks)
 		goto end;
 
+	cached = miframman_class_get(ram, num_blocks);
+	if (cached >= 0) {
+		ram->class_hits++;
+		index = cached;
+	} else {
+		/* Nothing free below first_free, start the scan from there */
+		index = ram->first_free;
+	}
+
 	while (index <= (ram->num_blocks - num_blocks)) {
 		available = 0;
 
@@ -79,6 +160,9 @@ void *__miframman_alloc(struct miframman *ram, size_t nbytes, int tag)
 			free_mem = ram->start_dram +
 				   MIFRAMMAN_BLOCK_SIZE * index;
 
+			if (index == ram->first_free)
+				ram->first_free = index + num_blocks;
+
 			/* Mark the block boundary as used */
 			ram->bitmap[index] = BLOCK_BOUND;
 			ram->bitmap[index] |= (u8)(tag <<  MIFRAMMAN_BLOCK_OWNER_SHIFT); /* Add owner tack for tracking */
@@ -128,6 +212,7 @@ exit:
 void *miframman_alloc(struct miframman *ram, size_t nbytes, size_t align, int tag)
 {
 	void *mem, *align_mem = NULL;
+	u64 start, elapsed;
 
 	mutex_lock(&ram->lock);
 	if (!is_power_of_2(align) || nbytes == 0) {
@@ -138,9 +223,17 @@ void *miframman_alloc(struct miframman *ram, size_t nbytes, size_t align, int ta
 	if (align < sizeof(void *))
 		align = sizeof(void *);
 
+	start = ktime_get_ns();
 	mem = __miframman_alloc(ram, nbytes + align + sizeof(void *), tag);
-	if (!mem)
+	elapsed = ktime_get_ns() - start;
+	ram->total_alloc_ns += elapsed;
+	if (elapsed > ram->max_alloc_ns)
+		ram->max_alloc_ns = elapsed;
+	if (!mem) {
+		ram->num_fails++;
 		goto end;
+	}
+	ram->num_allocs++;
 
 	align_mem = MIFRAMMAN_ALIGN(mem, align);
 
@@ -160,7 +253,7 @@ end:
  */
 void __miframman_free(struct miframman *ram, void *mem)
 {
-	unsigned int index, num_blocks = 0;
+	unsigned int index, first, num_blocks = 0;
 
 	if (ram->start_dram == NULL || !mem) {
 		SCSC_TAG_ERR(MIF, "Mem is NULL\n");
@@ -182,6 +275,7 @@ void __miframman_free(struct miframman *ram, void *mem)
 		SCSC_TAG_ERR(MIF, "Incorrect Block descriptor\n");
 		return;
 	}
+	first = index;
 	ram->bitmap[index++] = BLOCK_FREE;
 
 	/* Free remaining blocks */
@@ -192,6 +286,10 @@ void __miframman_free(struct miframman *ram, void *mem)
 	}
 
 	ram->free_mem += num_blocks * MIFRAMMAN_BLOCK_SIZE;
+
+	if (first < ram->first_free)
+		ram->first_free = first;
+	miframman_class_put(ram, first, num_blocks);
 }
 
 void miframman_free(struct miframman *ram, void *mem)
@@ -208,8 +306,10 @@ void miframman_deinit(struct miframman *ram)
 {
 	/* Mark all the blocks as INUSE (by Common) to prevent new allocations */
 	memset(ram->bitmap, BLOCK_INUSE, sizeof(ram->bitmap));
+	memset(ram->classes, 0, sizeof(ram->classes));
 
 	ram->num_blocks = 0;
+	ram->first_free = 0;
 	ram->start_dram = NULL;
 	ram->size_pool = 0;
 	ram->free_mem = 0;
@@ -231,13 +331,36 @@ void miframman_log(struct miframman *ram, struct seq_file *fd)
 	unsigned int i;
 	int tag;
 	size_t num_blocks = 0;
+	u32 run = 0, largest = 0, extents = 0;
+	u32 allocs;
 
 	if (!ram)
 		return;
 
-	seq_printf(fd, "ramman: start_dram %p, size %zd, free_mem %u\n\n",
+	seq_printf(fd, "ramman: start_dram %p, size %zd, free_mem %u\n",
 		ram->start_region, ram->size_pool, ram->free_mem);
 
+	/* Fragmentation: how the free memory is split in free extents */
+	for (b = 0; b < ram->num_blocks; b++) {
+		if (ram->bitmap[b] == BLOCK_FREE) {
+			if (!run++)
+				extents++;
+			if (run > largest)
+				largest = run;
+		} else {
+			run = 0;
+		}
+	}
+	seq_printf(fd, "free extents %u, largest %u bytes, fragmentation %u%%\n",
+		extents, largest * MIFRAMMAN_BLOCK_SIZE,
+		ram->free_mem ? 100 - (u32)div_u64((u64)largest * MIFRAMMAN_BLOCK_SIZE * 100, ram->free_mem) : 0);
+
+	allocs = ram->num_allocs + ram->num_fails;
+	seq_printf(fd, "allocs %u, fails %u, class hits %u, alloc time avg %llu ns max %llu ns\n\n",
+		ram->num_allocs, ram->num_fails, ram->class_hits,
+		allocs ? div_u64(ram->total_alloc_ns, allocs) : 0,
+		ram->max_alloc_ns);
+
 	for (b = 0; b < ram->num_blocks; b++) {
 		if ((ram->bitmap[b] & MIFRAMMAN_BLOCK_STATUS_MASK) == BLOCK_BOUND) {
 			/* Found a boundary allocation */
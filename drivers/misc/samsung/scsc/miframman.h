@@ -41,6 +41,22 @@ void miframman_log(struct miframman *ram, struct seq_file *fd);
 
 #define MIFRAMMAN_OWNER_COMMON	0	/* Owner tag for Common driver */
 
+/*
+ * Recently freed extents are cached per size class, class n holding
+ * extents of [2^n, 2^(n+1)) blocks, so that reallocations on service
+ * restart land again on the same spot without scanning the bitmap.
+ * The bitmap remains the only authority: a cached extent is checked
+ * still free before being reused.
+ */
+#define MIFRAMMAN_NUM_CLASSES	16
+#define MIFRAMMAN_CLASS_DEPTH	4
+
+struct miframman_class {
+	u32 index[MIFRAMMAN_CLASS_DEPTH];   /* First block of the extent */
+	u32 blocks[MIFRAMMAN_CLASS_DEPTH];  /* Extent length in blocks */
+	u32 count;
+};
+
 /* Inclusion in core.c treat it as opaque */
 struct miframman {
 	void         *start_region;                /* Base address of region containing the pool */
@@ -49,6 +65,14 @@ struct miframman {
 	char         bitmap[MIFRAMMAN_NUM_BLOCKS]; /* Zero initialized-> all blocks free */
 	u32          num_blocks;                   /* Blocks of MIFRAMMAN_BLOCK_SIZE in pool */
 	u32          free_mem;                     /* Bytes remaining in allocator pool */
+	u32          first_free;                   /* No free block below this index */
+	struct miframman_class classes[MIFRAMMAN_NUM_CLASSES];
+	/* Allocation statistics */
+	u32          num_allocs;
+	u32          num_fails;
+	u32          class_hits;                   /* Allocations served by the class cache */
+	u64          total_alloc_ns;
+	u64          max_alloc_ns;
 	struct mutex lock;
 };
 
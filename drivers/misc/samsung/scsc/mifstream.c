@@ -138,6 +138,30 @@ void mif_stream_peek_complete(struct mif_stream *stream, const void *packet)
 	mif_abs->irq_bit_set(mif_abs, stream->read_bit_idx, (enum scsc_mif_abs_target)stream->peer);
 }
 
+uint32_t mif_stream_peek_batch(struct mif_stream *stream, struct cpacketbuffer_batch *batch, uint32_t max_packets)
+{
+	return cpacketbuffer_peek_batch(&stream->buffer, batch, max_packets);
+}
+
+void mif_stream_peek_batch_complete(struct mif_stream *stream, uint32_t num_packets)
+{
+	struct scsc_mif_abs *mif_abs = scsc_mx_get_mif_abs(stream->mx);
+
+	if (num_packets == 0)
+		return;
+
+	cpacketbuffer_peek_batch_complete(&stream->buffer, num_packets);
+
+	/* Signal that the read is finished to anyone interested */
+	mif_abs->irq_bit_set(mif_abs, stream->read_bit_idx, (enum scsc_mif_abs_target)stream->peer);
+}
+
+uint32_t mif_stream_batch_copy(struct mif_stream *stream, const struct cpacketbuffer_batch *batch,
+			       uint32_t first_packet, void *buf, uint32_t num_bytes)
+{
+	return cpacketbuffer_batch_copy(&stream->buffer, batch, first_packet, buf, num_bytes);
+}
+
 bool mif_stream_write(struct mif_stream *stream, const void *buf, uint32_t num_bytes)
 {
 	struct scsc_mif_abs *mif_abs = scsc_mx_get_mif_abs(stream->mx);
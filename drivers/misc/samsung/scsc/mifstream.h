@@ -127,6 +127,44 @@ const void *mif_stream_peek(struct mif_stream *stream, const void *current_packe
  */
 void mif_stream_peek_complete(struct mif_stream *stream, const void *packet);
 
+/**
+ * Returns up to max_packets of the packets available in the stream in one
+ * call, as up to two contiguous runs (the second one after the wrap), without
+ * removing them.
+ *
+ * mif_stream_peek_batch_complete must be called with the number of packets
+ * processed, which moves the read index and signals the peer only once for
+ * the whole batch.
+ *
+ * Returns the number of packets in the batch, 0 if there is none.
+ *
+ * Example use:
+ *   struct cpacketbuffer_batch batch;
+ *   uint32_t n = mif_stream_peek_batch(stream, &batch, UINT_MAX);
+ *   uint32_t i, j;
+ *
+ *   for (i = 0; i < 2; i++)
+ *      for (j = 0; j < batch.num_packets[i]; j++)
+ *         // Process batch.data[i] + j * mif_stream_block_size(stream)
+ *
+ *   mif_stream_peek_batch_complete(stream, n);
+ */
+uint32_t mif_stream_peek_batch(struct mif_stream *stream, struct cpacketbuffer_batch *batch, uint32_t max_packets);
+
+/**
+ * Removes the first num_packets packets of a batch from the stream.
+ */
+void mif_stream_peek_batch_complete(struct mif_stream *stream, uint32_t num_packets);
+
+/**
+ * Copies num_bytes starting at packet first_packet of a batch, which may
+ * wrap, to the provided address.
+ *
+ * Returns the number of bytes copied, or 0 if the batch is too short.
+ */
+uint32_t mif_stream_batch_copy(struct mif_stream *stream, const struct cpacketbuffer_batch *batch,
+			       uint32_t first_packet, void *buf, uint32_t num_bytes);
+
 /**
  * Writes the given number of bytes to the MIF stream.
  *
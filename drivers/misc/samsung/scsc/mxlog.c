@@ -4,6 +4,10 @@
  *
  ****************************************************************************/
 
+#include <linux/miscdevice.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/sched/clock.h>
 #include <scsc/scsc_logring.h>
 #include <scsc/scsc_mx.h>
 #include "scsc_mx_impl.h"
@@ -12,6 +16,178 @@
 #include "fwhdr.h"
 #include "mxlog.h"
 
+static bool mxlog_passthrough;
+module_param(mxlog_passthrough, bool, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(mxlog_passthrough, "Copy raw mxlog records to mxlog_bin while it is open, instead of decoding them");
+
+static uint mxlog_bin_size_kb = 512;
+module_param(mxlog_bin_size_kb, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(mxlog_bin_size_kb, "Size of the mxlog_bin ring allocated at open");
+
+/* Records received at each kernel log level, decoded or passed through */
+static uint mxlog_level_count[8];
+module_param_array(mxlog_level_count, uint, NULL, S_IRUGO);
+MODULE_PARM_DESC(mxlog_level_count, "Records received per kernel log level 0..7");
+
+static struct mxlog_bin {
+	spinlock_t            lock;
+	struct mxlog_bin_ring *ring;
+	u8                    *rec;
+	atomic_t              opened;
+	bool                  registered;
+} mxlog_bin;
+
+/* Returns true if the record has been passed through without decoding */
+static bool mxlog_bin_write(u8 phase, const void *message, size_t length, u32 level)
+{
+	struct mxlog_bin_ring   *ring;
+	struct mxlog_bin_record hdr;
+	unsigned long           flags;
+	u32                     head, tail, space, rec_len;
+	bool                    ret = true;
+
+	if (!mxlog_passthrough || !mxlog_bin.ring)
+		return false;
+
+	rec_len = sizeof(hdr) + ALIGN(length, 4);
+
+	spin_lock_irqsave(&mxlog_bin.lock, flags);
+	ring = mxlog_bin.ring;
+	if (!ring) {
+		ret = false;
+		goto exit;
+	}
+
+	head = ring->head;
+	tail = READ_ONCE(ring->tail);
+	if (head >= ring->size || tail >= ring->size) {
+		/* The reader scribbled the control page, start over */
+		ring->head = ring->tail = 0;
+		head = tail = 0;
+	}
+	space = (tail > head) ? tail - head - 1 : ring->size - head + tail - 1;
+
+	if (ring->size - head < rec_len) {
+		/* Does not fit before the end, continue at offset 0 */
+		if (tail > head || space < ring->size - head + rec_len) {
+			ring->drops++;
+			goto exit;
+		}
+		if (ring->size - head >= sizeof(hdr)) {
+			hdr.length = MXLOG_BIN_WRAP;
+			memcpy(mxlog_bin.rec + head, &hdr, sizeof(hdr));
+		}
+		head = 0;
+	} else if (space < rec_len) {
+		ring->drops++;
+		goto exit;
+	}
+
+	hdr.timestamp = local_clock();
+	hdr.phase = phase;
+	hdr.level = level;
+	hdr.length = length;
+	memcpy(mxlog_bin.rec + head, &hdr, sizeof(hdr));
+	memcpy(mxlog_bin.rec + head + sizeof(hdr), message, length);
+
+	/* Publish the record after its contents */
+	smp_wmb();
+	head += rec_len;
+	WRITE_ONCE(ring->head, (head < ring->size) ? head : 0);
+exit:
+	spin_unlock_irqrestore(&mxlog_bin.lock, flags);
+	return ret;
+}
+
+static int mxlog_bin_open(struct inode *inode, struct file *filp)
+{
+	struct mxlog_bin_ring *ring;
+	unsigned long         flags;
+	u32                   size = PAGE_ALIGN(mxlog_bin_size_kb * 1024);
+
+	if (!size)
+		return -EINVAL;
+
+	if (atomic_inc_return(&mxlog_bin.opened) > 1) {
+		atomic_dec(&mxlog_bin.opened);
+		return -EBUSY;
+	}
+
+	ring = vmalloc_user(MXLOG_BIN_RING_OFFSET + size);
+	if (!ring) {
+		atomic_dec(&mxlog_bin.opened);
+		return -ENOMEM;
+	}
+	ring->size = size;
+
+	spin_lock_irqsave(&mxlog_bin.lock, flags);
+	mxlog_bin.rec = (u8 *)ring + MXLOG_BIN_RING_OFFSET;
+	mxlog_bin.ring = ring;
+	spin_unlock_irqrestore(&mxlog_bin.lock, flags);
+
+	SCSC_TAG_INFO(MX_FW, "mxlog_bin opened, ring %u bytes\n", size);
+	return 0;
+}
+
+static int mxlog_bin_release(struct inode *inode, struct file *filp)
+{
+	struct mxlog_bin_ring *ring;
+	unsigned long         flags;
+
+	spin_lock_irqsave(&mxlog_bin.lock, flags);
+	ring = mxlog_bin.ring;
+	mxlog_bin.ring = NULL;
+	mxlog_bin.rec = NULL;
+	spin_unlock_irqrestore(&mxlog_bin.lock, flags);
+
+	vfree(ring);
+	atomic_dec(&mxlog_bin.opened);
+	return 0;
+}
+
+static int mxlog_bin_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	struct mxlog_bin_ring *ring = mxlog_bin.ring;
+
+	if (!ring || vma->vm_pgoff ||
+	    vma->vm_end - vma->vm_start > MXLOG_BIN_RING_OFFSET + ring->size)
+		return -EINVAL;
+
+	return remap_vmalloc_range(vma, ring, 0);
+}
+
+static const struct file_operations mxlog_bin_fops = {
+	.owner   = THIS_MODULE,
+	.open    = mxlog_bin_open,
+	.release = mxlog_bin_release,
+	.mmap    = mxlog_bin_mmap,
+};
+
+static struct miscdevice mxlog_bin_dev = {
+	.minor = MISC_DYNAMIC_MINOR,
+	.name  = "mxlog_bin",
+	.fops  = &mxlog_bin_fops,
+};
+
+int mxlog_bin_init(void)
+{
+	int r;
+
+	spin_lock_init(&mxlog_bin.lock);
+	atomic_set(&mxlog_bin.opened, 0);
+
+	r = misc_register(&mxlog_bin_dev);
+	mxlog_bin.registered = !r;
+	return r;
+}
+
+void mxlog_bin_exit(void)
+{
+	if (mxlog_bin.registered)
+		misc_deregister(&mxlog_bin_dev);
+	mxlog_bin.registered = false;
+}
+
 /*
  * Receive handler for messages from the FW along the maxwell management transport
  */
@@ -287,6 +463,13 @@ static void mxlog_message_handler(u8 phase, const void *message,
 		return;
 	}
 
+	if (level < ARRAY_SIZE(mxlog_level_count))
+		mxlog_level_count[level]++;
+
+	/* Left to the offline decoder */
+	if (mxlog_bin_write(phase, message, length, level))
+		return;
+
 	switch (phase) {
 	case MX_LOG_PHASE_4:
 		mxlog_phase4_message_handler(message, length, level, data);
@@ -82,6 +82,40 @@ struct mxlog_event_log_msg {
 	u32 offset;
 } __packed;
 
+/**
+ * Binary passthrough
+ * ------------------
+ * With mxlog_passthrough set and the "mxlog_bin" node open, records are not
+ * decoded in the kernel: they are copied raw, as received by the message
+ * handler, to a ring that the reader mmaps and decodes offline against the
+ * same log-strings.bin.
+ *
+ * The first page of the mapping is struct mxlog_bin_ring and the records
+ * start at MXLOG_BIN_RING_OFFSET. Each record is struct mxlog_bin_record
+ * followed by @length bytes of payload, padded to 4 bytes. A record never
+ * wraps: a record with length MXLOG_BIN_WRAP, or less than a record header
+ * left before the end, means the next one is at offset 0.
+ */
+#define MXLOG_BIN_RING_OFFSET	PAGE_SIZE
+#define MXLOG_BIN_WRAP		0xFFFF
+
+struct mxlog_bin_ring {
+	u32 size;	/* bytes of the record area */
+	u32 head;	/* written by the kernel */
+	u32 tail;	/* written by the reader */
+	u32 drops;	/* records dropped because the ring was full */
+} __packed;
+
+struct mxlog_bin_record {
+	u64 timestamp;	/* local_clock() ns at reception */
+	u8  phase;
+	u8  level;	/* already remapped to kernel levels */
+	u16 length;
+} __packed;
+
+int mxlog_bin_init(void);
+void mxlog_bin_exit(void);
+
 struct mxlog;
 
 void mxlog_init(struct mxlog *mxlog, struct scsc_mx *mx, char *fw_build_id);
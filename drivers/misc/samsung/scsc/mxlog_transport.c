@@ -99,6 +99,11 @@ static int mxlog_thread_function(void *arg)
 	u32                        header;
 	char			   *buf = NULL;
 	size_t			   buf_sz = 4096;
+	struct cpacketbuffer_batch batch;
+	uint32_t                   packet_size = mif_stream_block_size(&mxlog_transport->mif_stream);
+	/* A full stream holds one packet less than its size */
+	uint32_t                   max_packets = mxlog_transport->mif_stream.buffer.num_packets - 1;
+	uint32_t                   num_packets, pos;
 
 	buf = kmalloc(buf_sz, GFP_KERNEL);
 	if (!buf) {
@@ -135,53 +140,78 @@ static int mxlog_thread_function(void *arg)
 					 "mxlog_transport->header_handler_fn_==NULL\n");
 			break;
 		}
-		while (mif_stream_read(&mxlog_transport->mif_stream,
-				       &header, sizeof(uint32_t))) {
-			u8 level = 0;
-			u8 phase = 0;
-			u32 num_bytes = 0;
-
-			mutex_lock(&mxlog_transport->lock);
-			if (!mxlog_transport->header_handler_fn) {
-				/* Invalid header handler:
-				 * unrecoverable log and terminate
+		/* Take all pending records as one batch and release them once */
+		while ((num_packets = mif_stream_peek_batch(&mxlog_transport->mif_stream, &batch, UINT_MAX)) != 0) {
+			bool partial = false;
+
+			pos = 0;
+			while (pos < num_packets) {
+				u8 level = 0;
+				u8 phase = 0;
+				u32 num_bytes = 0;
+
+				mif_stream_batch_copy(&mxlog_transport->mif_stream, &batch, pos, &header, sizeof(uint32_t));
+
+				mutex_lock(&mxlog_transport->lock);
+				if (!mxlog_transport->header_handler_fn) {
+					/* Invalid header handler:
+					 * unrecoverable log and terminate
+					 */
+					SCSC_TAG_WARNING(MXLOG_TRANS,
+							 "mxlog_transport->header_handler_fn_==NULL. Channel has been released\n");
+					mutex_unlock(&mxlog_transport->lock);
+					/* not recoverable, terminate straight away */
+					mif_stream_peek_batch_complete(&mxlog_transport->mif_stream, pos);
+					goto mxlog_thread_exit;
+				}
+				/**
+				 * A generic header processor will properly retrieve
+				 * level and num_bytes as specifically implemented
+				 * by the phase.
 				 */
-				SCSC_TAG_WARNING(MXLOG_TRANS,
-						 "mxlog_transport->header_handler_fn_==NULL. Channel has been released\n");
+				if (mxlog_transport->header_handler_fn(header, &phase,
+								       &level, &num_bytes)) {
+					SCSC_TAG_ERR(MXLOG_TRANS,
+						     "Bad sync in header: header=0x%08x\n", header);
+					mutex_unlock(&mxlog_transport->lock);
+					/* not recoverable, terminate straight away */
+					mif_stream_peek_batch_complete(&mxlog_transport->mif_stream, pos + 1);
+					goto mxlog_thread_exit;
+				}
+				if (num_bytes > 0 &&
+				    num_bytes < (MXLOG_TRANSPORT_BUF_LENGTH - sizeof(uint32_t))) {
+					/* 2nd part - payload (msg), which may wrap */
+					if (!mif_stream_batch_copy(&mxlog_transport->mif_stream, &batch,
+								   pos + 1, buf, num_bytes)) {
+						mutex_unlock(&mxlog_transport->lock);
+						if (num_packets < max_packets) {
+							/* Not fully written yet, wait for the rest */
+							partial = true;
+							break;
+						}
+						/* Cannot fit in the stream, drop what there is */
+						SCSC_TAG_ERR(MXLOG_TRANS,
+							     "Truncated record num_bytes(%d): header=0x%08x\n",
+							     num_bytes, header);
+						pos = num_packets;
+						break;
+					}
+					mxlog_transport->channel_handler_fn(phase, buf,
+									    num_bytes,
+									    level,
+									    mxlog_transport->channel_handler_data);
+					pos += 1 + DIV_ROUND_UP(num_bytes, packet_size);
+				} else {
+					SCSC_TAG_ERR(MXLOG_TRANS,
+						     "Bad num_bytes(%d) in header: header=0x%08x\n",
+						     num_bytes, header);
+					pos++;
+				}
 				mutex_unlock(&mxlog_transport->lock);
-				/* not recoverable, terminate straight away */
-				goto mxlog_thread_exit;
 			}
-			/**
-			 * A generic header processor will properly retrieve
-			 * level and num_bytes as specifically implemented
-			 * by the phase.
-			 */
-			if (mxlog_transport->header_handler_fn(header, &phase,
-							       &level, &num_bytes)) {
-				SCSC_TAG_ERR(MXLOG_TRANS,
-					     "Bad sync in header: header=0x%08x\n", header);
-				mutex_unlock(&mxlog_transport->lock);
-				/* not recoverable, terminate straight away */
-				goto mxlog_thread_exit;
-			}
-			if (num_bytes > 0 &&
-			    num_bytes < (MXLOG_TRANSPORT_BUF_LENGTH - sizeof(uint32_t))) {
-				u32	ret_bytes = 0;
-
-				/* 2nd read - payload (msg) */
-				ret_bytes = mif_stream_read(&mxlog_transport->mif_stream,
-							    buf, num_bytes);
-				mxlog_transport->channel_handler_fn(phase, buf,
-								    ret_bytes,
-								    level,
-								    mxlog_transport->channel_handler_data);
-			} else {
-				SCSC_TAG_ERR(MXLOG_TRANS,
-					     "Bad num_bytes(%d) in header: header=0x%08x\n",
-					     num_bytes, header);
-			}
-			mutex_unlock(&mxlog_transport->lock);
+			mif_stream_peek_batch_complete(&mxlog_transport->mif_stream, min(pos, num_packets));
+			if (partial)
+				break;
 		}
 	}
 
@@ -103,6 +103,21 @@ static void thread_wait_until_stopped(struct mxmgmt_transport *mxmgmt_transport)
 	SCSC_TAG_DEBUG(MXMGT_TRANS, "%s exiting....\n", th->name);
 }
 
+/** Forwards a message to the registered handler of its channel */
+static void mxmgmt_forward_message(struct mxmgmt_transport *mxmgmt_transport, const struct mxmgr_message *current_message)
+{
+	mutex_lock(&mxmgmt_transport->channel_handler_mutex);
+	if (current_message->channel_id < MMTRANS_NUM_CHANNELS &&
+	    mxmgmt_transport->channel_handler_fns[current_message->channel_id]) {
+		SCSC_TAG_DEBUG(MXMGT_TRANS, "Calling handler for channel_id: %d\n", current_message->channel_id);
+		(*mxmgmt_transport->channel_handler_fns[current_message->channel_id])(current_message->payload,
+										      mxmgmt_transport->channel_handler_data[current_message->channel_id]);
+	} else
+		/* HERE: Invalid channel or no handler, raise fault or log message */
+		SCSC_TAG_WARNING(MXMGT_TRANS, "Invalid channel or no handler channel_id: %d\n", current_message->channel_id);
+	mutex_unlock(&mxmgmt_transport->channel_handler_mutex);
+}
+
 /**
  * A thread that forwards messages sent across the transport to
  * the registered handlers for each channel.
@@ -112,6 +127,9 @@ static int mxmgmt_thread_function(void *arg)
 	struct mxmgmt_transport    *mxmgmt_transport = (struct mxmgmt_transport *)arg;
 	struct mxmgmt_thread       *th = &mxmgmt_transport->mxmgmt_thread;
 	const struct mxmgr_message *current_message;
+	struct cpacketbuffer_batch batch;
+	uint32_t                   packet_size = mif_stream_block_size(&mxmgmt_transport->mif_istream);
+	uint32_t                   num_messages, i, j;
 	int                        ret;
 
 	complete(&th->completion);
@@ -135,24 +153,19 @@ static int mxmgmt_thread_function(void *arg)
 		}
 		th->wakeup_flag = 0;
 		SCSC_TAG_DEBUG(MXMGT_TRANS, "wokeup: r=%d\n", ret);
-		/* Forward each pending message to the applicable channel handler */
-		current_message = mif_stream_peek(&mxmgmt_transport->mif_istream, NULL);
-		while (current_message != NULL) {
-			mutex_lock(&mxmgmt_transport->channel_handler_mutex);
-			if (current_message->channel_id < MMTRANS_NUM_CHANNELS &&
-			    mxmgmt_transport->channel_handler_fns[current_message->channel_id]) {
-				SCSC_TAG_DEBUG(MXMGT_TRANS, "Calling handler for channel_id: %d\n", current_message->channel_id);
-				(*mxmgmt_transport->channel_handler_fns[current_message->channel_id])(current_message->payload,
-												      mxmgmt_transport->channel_handler_data[current_message->channel_id]);
-			} else
-				/* HERE: Invalid channel or no handler, raise fault or log message */
-				SCSC_TAG_WARNING(MXMGT_TRANS, "Invalid channel or no handler channel_id: %d\n", current_message->channel_id);
-			mutex_unlock(&mxmgmt_transport->channel_handler_mutex);
-			/* Remove the current message from the buffer before processing the next
-			 * one in case it generated another message, otherwise it's possible we
-			 * could run out of space in the stream before we get through all the messages. */
-			mif_stream_peek_complete(&mxmgmt_transport->mif_istream, current_message);
-			current_message = mif_stream_peek(&mxmgmt_transport->mif_istream, NULL);
+		/* Forward each pending message to the applicable channel handler.
+		 * The pending messages are taken as one batch, and the read index is
+		 * moved once the batch is processed: the peer keeps the free space
+		 * it had when the batch was taken, so replies from the handlers do
+		 * not run the stream out of space. */
+		while ((num_messages = mif_stream_peek_batch(&mxmgmt_transport->mif_istream, &batch, UINT_MAX)) != 0) {
+			for (i = 0; i < ARRAY_SIZE(batch.data); i++) {
+				for (j = 0; j < batch.num_packets[i]; j++) {
+					current_message = (const struct mxmgr_message *)((const uint8_t *)batch.data[i] + j * packet_size);
+					mxmgmt_forward_message(mxmgmt_transport, current_message);
+				}
+			}
+			mif_stream_peek_batch_complete(&mxmgmt_transport->mif_istream, num_messages);
 		}
 	}
 
@@ -59,6 +59,54 @@ static struct dentry *scsc_debugfs_root;
 static atomic_t      scsc_debugfs_root_refcnt;
 static char          *global_fmt_string = "%s";
 
+/* Truncates the ring or, when split, all of its per-cpu sub-rings */
+static void samlog_ring_truncate(struct scsc_ring_buffer *rb)
+{
+	unsigned long flags;
+	int           cpu;
+
+	if (!rb->cpu_rb) {
+		raw_spin_lock_irqsave(&rb->lock, flags);
+		scsc_ring_truncate(rb);
+		raw_spin_unlock_irqrestore(&rb->lock, flags);
+		return;
+	}
+	for (cpu = 0; cpu < rb->nr_cpu_rb; cpu++) {
+		raw_spin_lock_irqsave(&rb->cpu_rb[cpu]->lock, flags);
+		scsc_ring_truncate(rb->cpu_rb[cpu]);
+		raw_spin_unlock_irqrestore(&rb->cpu_rb[cpu]->lock, flags);
+	}
+}
+
+/**
+ * Positions a merged reader on the head (live samsg reader) or on the
+ * tail (samlog dump) of every per-cpu sub-ring.
+ */
+static void samlog_cpu_rings_start(struct scsc_ibox *i, bool from_head)
+{
+	struct scsc_ring_buffer *crb;
+	unsigned long           flags;
+	int                     cpu;
+
+	for (cpu = 0; cpu < i->rb->nr_cpu_rb; cpu++) {
+		crb = i->rb->cpu_rb[cpu];
+		raw_spin_lock_irqsave(&crb->lock, flags);
+		i->cpu_pos[cpu] = from_head ? crb->head : crb->tail;
+		raw_spin_unlock_irqrestore(&crb->lock, flags);
+	}
+}
+
+/* Lockless check used as a wakeup condition: did any cpu write since ? */
+static bool samlog_cpu_rings_moved(struct scsc_ibox *i)
+{
+	int cpu;
+
+	for (cpu = 0; cpu < i->rb->nr_cpu_rb; cpu++)
+		if (READ_ONCE(i->rb->cpu_rb[cpu]->head) != i->cpu_pos[cpu])
+			return true;
+	return false;
+}
+
 /**
  * Generic open/close calls to use with every logring debugfs file.
  * Any file in debugfs has an underlying associated ring buffer:
@@ -102,14 +150,24 @@ static int debugfile_open(struct inode *ino, struct file *filp)
 	i->tsz = scsc_double_buffer_sz;
 	pr_info("LogRing: Allocated per-reader tbuf of %d bytes\n",
 		scsc_double_buffer_sz);
+	/* A merged reader keeps its own position on each per-cpu sub-ring */
+	if (i->rb->cpu_rb && !i->cpu_pos) {
+		i->cpu_pos = kcalloc(i->rb->nr_cpu_rb, sizeof(*i->cpu_pos),
+				     GFP_KERNEL);
+		if (!i->cpu_pos) {
+			if (!i->tbuf_vm)
+				kfree(i->tbuf);
+			else
+				vfree(i->tbuf);
+			kfree(i);
+			filp->private_data = NULL;
+			return -ENOMEM;
+		}
+	}
 	/* Truncate when attempting to write RO files samlog and samsg */
 	if (filp->f_flags & (O_WRONLY | O_RDWR) &&
 	    filp->f_flags & O_TRUNC) {
-		unsigned long    flags;
-
-		raw_spin_lock_irqsave(&i->rb->lock, flags);
-		scsc_ring_truncate(i->rb);
-		raw_spin_unlock_irqrestore(&i->rb->lock, flags);
+		samlog_ring_truncate(i->rb);
 		pr_info("LogRing Truncated to zerolen\n");
 		return -EACCES;
 	}
@@ -128,6 +186,7 @@ static int debugfile_release(struct inode *ino, struct file *filp)
 	else
 		vfree(i->tbuf);
 	i->tbuf = NULL;
+	kfree(i->cpu_pos);
 
 	/* Were we using a snapshot ? Free it.*/
 	if (i->saved_live_rb) {
@@ -229,7 +288,19 @@ static ssize_t samsg_read(struct file *filp, char __user *ubuf,
 		return -EAGAIN;
 	/* open() assures us that this private data is certainly non-NULL */
 	i = filp->private_data;
-	if (!i->t_used) {
+	if (!i->t_used && i->rb->cpu_rb) {
+		/* Same as below but merging all the per-cpu sub-rings */
+		if (!*f_pos)
+			samlog_cpu_rings_start(i, true);
+		if (wait_event_interruptible(i->rb->wq,
+					     samlog_cpu_rings_moved(i)))
+			return -ERESTARTSYS;
+		retrieved_bytes =
+			read_next_records_merged(i->rb,
+						 scsc_max_records_per_read,
+						 i->cpu_pos, i->tbuf, i->tsz);
+		off = init_cached_read(i, retrieved_bytes, &count);
+	} else if (!i->t_used) {
 		raw_spin_lock_irqsave(&i->rb->lock, flags);
 		current_head = *f_pos ? i->f_pos : i->rb->head;
 		while (current_head == i->rb->head) {
@@ -285,10 +356,24 @@ loff_t debugfile_llseek(struct file *filp, loff_t off, int whence)
 	if (!filp->private_data)
 		return -EFAULT;
 	i = filp->private_data;
-	raw_spin_lock_irqsave(&i->rb->lock, flags);
-	maxpos = SCSC_LOGGED_BYTES(i->rb) >= 1 ?
-		 SCSC_LOGGED_BYTES(i->rb) - 1 : 0;
-	raw_spin_unlock_irqrestore(&i->rb->lock, flags);
+	if (i->rb->cpu_rb) {
+		int cpu;
+
+		maxpos = 0;
+		for (cpu = 0; cpu < i->rb->nr_cpu_rb; cpu++) {
+			struct scsc_ring_buffer *crb = i->rb->cpu_rb[cpu];
+
+			raw_spin_lock_irqsave(&crb->lock, flags);
+			maxpos += SCSC_LOGGED_BYTES(crb);
+			raw_spin_unlock_irqrestore(&crb->lock, flags);
+		}
+		maxpos = maxpos >= 1 ? maxpos - 1 : 0;
+	} else {
+		raw_spin_lock_irqsave(&i->rb->lock, flags);
+		maxpos = SCSC_LOGGED_BYTES(i->rb) >= 1 ?
+			 SCSC_LOGGED_BYTES(i->rb) - 1 : 0;
+		raw_spin_unlock_irqrestore(&i->rb->lock, flags);
+	}
 	switch (whence) {
 	case 0: /* SEEK_SET */
 		newpos = (off <= maxpos) ? off : maxpos;
@@ -355,6 +440,9 @@ static int debugfile_open_snapshot(struct inode *ino, struct file *filp)
 	int ret;
 
 	ret = debugfile_open(ino, filp);
+	/* Per-cpu sub-rings are always dumped live by a merged reader */
+	if (!ret && ((struct scsc_ibox *)filp->private_data)->rb->cpu_rb)
+		return ret;
 	/* if regular debug_file_open has gone through, attempt snapshot */
 	if (!ret) {
 		/* filp && filp->private_data NON-NULL by debugfile_open */
@@ -423,7 +511,16 @@ static ssize_t samlog_read(struct file *filp, char __user *ubuf,
 	if (!filp->private_data)
 		return -EFAULT;
 	i = filp->private_data;
-	if (!i->t_used) {
+	if (!i->t_used && i->rb->cpu_rb) {
+		/* Dump from the tail of each per-cpu sub-ring, merged */
+		if (*f_pos == 0)
+			samlog_cpu_rings_start(i, false);
+		retrieved_bytes =
+			read_next_records_merged(i->rb,
+						 scsc_max_records_per_read,
+						 i->cpu_pos, i->tbuf, i->tsz);
+		off = init_cached_read(i, retrieved_bytes, &count);
+	} else if (!i->t_used) {
 		unsigned long    flags;
 
 		/* Lock ONLY if NOT using a snapshot */
@@ -486,6 +583,61 @@ static int statfile_release(struct inode *ino, struct file *filp)
 }
 
 
+/**
+ * Stats of a ring split into per-cpu sub-rings: one line per cpu, with
+ * the records lost by each of them either dropped being too long or
+ * overwritten by the writer wrapping over.
+ */
+static ssize_t statfile_read_percpu(struct scsc_ring_buffer *rb,
+				    char __user *ubuf, size_t count,
+				    loff_t *f_pos)
+{
+	struct scsc_ring_buffer *crb;
+	unsigned long           flags;
+	size_t                  ssz;
+	int                     slen, cpu;
+	char                    *statstr;
+
+	ssz = STATSTR_SZ + rb->nr_cpu_rb * CPU_STATSTR_SZ;
+	statstr = kzalloc(ssz, GFP_KERNEL);
+	if (!statstr)
+		return -ENOMEM;
+	slen = scnprintf(statstr, ssz, "sz:%zd  cpus:%d\n",
+			 rb->bsz, rb->nr_cpu_rb);
+	for (cpu = 0; cpu < rb->nr_cpu_rb; cpu++) {
+		loff_t used, logged;
+		int    records, wraps, oos, drops, overwritten;
+		u64    written;
+
+		crb = rb->cpu_rb[cpu];
+		raw_spin_lock_irqsave(&crb->lock, flags);
+		used = SCSC_USED_BYTES(crb);
+		logged = SCSC_LOGGED_BYTES(crb);
+		records = crb->records;
+		written = crb->written;
+		wraps = crb->wraps;
+		oos = crb->oos;
+		drops = crb->drops;
+		overwritten = crb->overwritten;
+		raw_spin_unlock_irqrestore(&crb->lock, flags);
+		slen += scnprintf(statstr + slen, ssz - slen,
+				  "c%d: sz:%zd  used:%lld  logged:%lld  records:%d  written:%lld  wraps:%d  oos:%d  drops:%d  overwritten:%d\n",
+				  cpu, crb->bsz, used, logged, records,
+				  written, wraps, oos, drops, overwritten);
+	}
+	if (*f_pos < slen) {
+		count = (count <= slen - *f_pos) ? count : (slen - *f_pos);
+		if (copy_to_user(ubuf, statstr + *f_pos, count)) {
+			kfree(statstr);
+			return -EFAULT;
+		}
+		*f_pos += count;
+	} else
+		count = 0;
+	kfree(statstr);
+	return count;
+}
+
 /* A simple read to dump some stats about the ring buffer. */
 static ssize_t statfile_read(struct file *filp, char __user *ubuf,
 			     size_t count, loff_t *f_pos)
@@ -499,6 +651,8 @@ static ssize_t statfile_read(struct file *filp, char __user *ubuf,
 	char                    statstr[STATSTR_SZ] = {};
 	struct scsc_ring_buffer *rb = filp->private_data;
 
+	if (rb->cpu_rb)
+		return statfile_read_percpu(rb, ubuf, count, f_pos);
 	raw_spin_lock_irqsave(&rb->lock, flags);
 	bsz = rb->bsz;
 	head = rb->head;
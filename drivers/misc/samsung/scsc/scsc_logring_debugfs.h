@@ -19,6 +19,7 @@
 #include "scsc_logring_ring.h"
 
 #define STATSTR_SZ				256
+#define CPU_STATSTR_SZ				128
 #define SCSC_DEBUGFS_ROOT			"scsc"
 #define SCSC_SAMSG_FNAME			"samsg"
 #define SCSC_SAMLOG_FNAME			"samlog"
@@ -37,6 +38,7 @@ struct scsc_ibox {
 	size_t				t_used;
 	size_t				cached_reads;
 	loff_t				f_pos;
+	loff_t				*cpu_pos;
 	struct scsc_ring_buffer		*saved_live_rb;
 };
 
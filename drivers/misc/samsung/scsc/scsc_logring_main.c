@@ -20,6 +20,7 @@ static int              ringsize = DEFAULT_RING_BUFFER_SZ;
 static int		ringsize = CONFIG_SCSC_STATIC_RING_SIZE;
 #endif
 static int              prepend_header = DEFAULT_ENABLE_HEADER;
+static bool             percpu_rings = DEFAULT_PERCPU_RINGS;
 static int              default_dbglevel = DEFAULT_DBGLEVEL;
 static int              scsc_droplevel_wlbt = DEFAULT_DROPLEVEL;
 static int              scsc_droplevel_all = DEFAULT_ALL_DISABLED;
@@ -67,6 +68,10 @@ int __init samlog_init(void)
 
 	if (!rb)
 		goto tfail;
+	if (percpu_rings && alloc_ring_buffer_percpu(rb)) {
+		pr_info("Samlog: cannot split ring per-cpu...using a single ring.\n");
+		percpu_rings = false;
+	}
 	rb->private = samlog_debugfs_init(rb->name, rb);
 	if (!rb->private)
 		pr_info("Samlog: Cannot Initialize DebugFS.\n");
@@ -87,6 +92,10 @@ int __init samlog_init(void)
 	                virt_to_phys((const volatile void *)(rb->buf + rb->bsz)));
 	scsc_printk_tag(NO_ECHO_PRK, NO_TAG,
 			"Using THROWAWAY DYNAMIC per-reader buffer.\n");
+	if (rb->cpu_rb)
+		scsc_printk_tag(NO_ECHO_PRK, NO_TAG,
+				"Ring split into %d per-cpu sub-rings of %zd bytes.\n",
+				rb->nr_cpu_rb, rb->cpu_rb[0]->bsz);
 
 #ifdef CONFIG_SCSC_LOG_COLLECTION
 	scsc_log_collector_register_client(&logring_collect_client);
@@ -129,6 +138,11 @@ SCSC_MODPARAM_DESC(ringsize,
 		   "run-time", DEFAULT_RING_BUFFER_SZ);
 #endif
 
+module_param(percpu_rings, bool, S_IRUGO);
+SCSC_MODPARAM_DESC(percpu_rings,
+		   "Split the ring into per-cpu sub-rings merged back by timestamp on read.",
+		   "load-time", DEFAULT_PERCPU_RINGS);
+
 module_param(prepend_header, int, S_IRUGO | S_IWUSR);
 SCSC_MODPARAM_DESC(prepend_header, "Enable/disable header prepending. ",
 		   "run-time", DEFAULT_ENABLE_HEADER);
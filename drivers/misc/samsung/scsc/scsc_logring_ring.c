@@ -235,10 +235,12 @@ loff_t find_next_tail_far_enough_from_start(struct scsc_ring_buffer *rb,
 	while (start + len >= new_tail && new_tail != rb->last) {
 		new_tail = SCSC_GET_NEXT_REC_ENTRY_POS(rb, new_tail);
 		rb->records--;
+		rb->overwritten++;
 	}
 	if (start + len >= new_tail) {
 		new_tail = 0;
 		rb->records--;
+		rb->overwritten++;
 	}
 	return new_tail;
 }
@@ -349,6 +351,17 @@ int tag_writer_string(char *spare, int tag, int lev,
 	return written;
 }
 
+/**
+ * Readers are woken only when someone is actually sleeping: per-cpu
+ * sub-rings share the wait queue of their parent and an unconditional
+ * wake_up would bounce its lock across all the writing cpus.
+ */
+static inline void scsc_ring_wake_readers(struct scsc_ring_buffer *rb)
+{
+	if (wq_has_sleeper(rb->rwq))
+		wake_up_interruptible(rb->rwq);
+}
+
 /**
  * A ring API function to push variable length format string into the buffer
  * After the record has been created and pushed into the ring any process
@@ -361,12 +374,14 @@ int push_record_string(struct scsc_ring_buffer *rb, int tag, int lev,
 	loff_t        free_bytes;
 	unsigned long flags;
 
+	rb = scsc_ring_this_cpu(rb);
 	/* Prepare ring_record and header if needed */
 	raw_spin_lock_irqsave(&rb->lock, flags);
 	rec_len = tag_writer_string(rb->spare, tag, lev, prepend_header,
 				    msg_head, args);
 	/* Line too long anyway drop */
 	if (rec_len >= BASE_SPARE_SZ - SCSC_RINGREC_SZ) {
+		rb->drops++;
 		raw_spin_unlock_irqrestore(&rb->lock, flags);
 		return 0;
 	}
@@ -388,7 +403,7 @@ int push_record_string(struct scsc_ring_buffer *rb, int tag, int lev,
 	rb->written += rec_len;
 	raw_spin_unlock_irqrestore(&rb->lock, flags);
 	/* WAKEUP EVERYONE WAITING ON THIS BUFFER */
-	wake_up_interruptible(&rb->wq);
+	scsc_ring_wake_readers(rb);
 	return rec_len;
 }
 
@@ -419,6 +434,7 @@ int push_record_blob(struct scsc_ring_buffer *rb, int tag, int lev,
 
 	if (len > SCSC_MAX_BIN_BLOB_SZ)
 		len = SCSC_MAX_BIN_BLOB_SZ;
+	rb = scsc_ring_this_cpu(rb);
 	/* Prepare ring_record and header if needed */
 	raw_spin_lock_irqsave(&rb->lock, flags);
 	memset(rb->spare, 0x00, rb->ssz);
@@ -433,7 +449,7 @@ int push_record_blob(struct scsc_ring_buffer *rb, int tag, int lev,
 	rb->written += len;
 	raw_spin_unlock_irqrestore(&rb->lock, flags);
 	/* WAKEUP EVERYONE WAITING ON THIS BUFFER */
-	wake_up_interruptible(&rb->wq);
+	scsc_ring_wake_readers(rb);
 	return len;
 }
 
@@ -694,6 +710,120 @@ size_t read_next_records(struct scsc_ring_buffer *rb, int max_recs,
 	return bytes_read;
 }
 
+/**
+ * Peeks at the record following *last_read_rec returning its timestamp
+ * in @nsec: an invalid position is reported as the oldest possible record
+ * so that the merged reader resyncs it (and marks the OOS) straight away.
+ * Returns false when there is nothing more to read.
+ * ASSUMES ring is locked.
+ */
+static inline bool peek_next_record(struct scsc_ring_buffer *rb,
+				    loff_t last_read_rec, s64 *nsec)
+{
+	loff_t next_rec;
+
+	if (last_read_rec == rb->head)
+		return false;
+	if (!is_ring_pos_safe(rb, last_read_rec) ||
+	    !is_record_crc_valid(SCSC_GET_REC(rb, last_read_rec),
+				 last_read_rec)) {
+		*nsec = S64_MIN;
+		return true;
+	}
+	next_rec = (last_read_rec != rb->last) ?
+		SCSC_GET_NEXT_SLOT_POS(rb, last_read_rec) : 0;
+	*nsec = SCSC_GET_REC(rb, next_rec)->nsec;
+	return true;
+}
+
+/**
+ * Reads into tbuf the ONE WHOLE record following *last_read_rec, with the
+ * same resync policy of read_next_records().
+ * ASSUMES ring is locked.
+ */
+static inline size_t read_next_one_record(struct scsc_ring_buffer *rb,
+					  loff_t *last_read_rec,
+					  void *tbuf, size_t tsz)
+{
+	size_t bytes_read = 0, rec_bytes;
+	int resynced_bytes = 0;
+	loff_t next_rec;
+
+	if (*last_read_rec == rb->head)
+		return bytes_read;
+	if (!is_ring_read_pos_valid(rb, *last_read_rec)) {
+		if (is_ring_pos_safe(rb, *last_read_rec))
+			next_rec = reader_resync(rb, *last_read_rec,
+						 &resynced_bytes);
+		else
+			next_rec = rb->head;
+		bytes_read += mark_out_of_sync(tbuf, tsz, resynced_bytes);
+	} else {
+		next_rec = (*last_read_rec != rb->last) ?
+			SCSC_GET_NEXT_SLOT_POS(rb, *last_read_rec) : 0;
+	}
+	rec_bytes = _read_one_whole_record(tbuf + bytes_read, rb, next_rec,
+					   tsz - bytes_read);
+	if (rec_bytes)
+		*last_read_rec = next_rec;
+	return bytes_read + rec_bytes;
+}
+
+/**
+ * The per-cpu flavour of read_next_records(): @rb is a ring split into
+ * per-cpu sub-rings and @last_read_recs holds the last record read from
+ * each of them. Records are merged back interleaving them by timestamp,
+ * each step picking the oldest record pending among all the sub-rings.
+ * Same stop conditions of read_next_records().
+ *
+ * Sub-rings are locked one at a time by this function itself, so that a
+ * reader never starves the writers of all the cpus at once: a record
+ * overwritten between the peek and the read is handled by the usual resync.
+ * Does NOT SLEEP.
+ */
+size_t read_next_records_merged(struct scsc_ring_buffer *rb, int max_recs,
+				loff_t *last_read_recs, void *tbuf, size_t tsz)
+{
+	struct scsc_ring_buffer *crb;
+	size_t bytes_read = 0;
+	int records = 0, cpu, next_cpu;
+	s64 nsec, next_nsec = 0;
+	unsigned long flags;
+	loff_t prev;
+
+	do {
+		next_cpu = -1;
+		for (cpu = 0; cpu < rb->nr_cpu_rb; cpu++) {
+			crb = rb->cpu_rb[cpu];
+			if (!crb)
+				continue;
+			raw_spin_lock_irqsave(&crb->lock, flags);
+			if (peek_next_record(crb, last_read_recs[cpu], &nsec) &&
+			    (next_cpu < 0 || nsec < next_nsec)) {
+				next_cpu = cpu;
+				next_nsec = nsec;
+			}
+			raw_spin_unlock_irqrestore(&crb->lock, flags);
+		}
+		if (next_cpu < 0)
+			break;
+		crb = rb->cpu_rb[next_cpu];
+		prev = last_read_recs[next_cpu];
+		raw_spin_lock_irqsave(&crb->lock, flags);
+		bytes_read += read_next_one_record(crb,
+						   &last_read_recs[next_cpu],
+						   tbuf + bytes_read,
+						   tsz - bytes_read);
+		raw_spin_unlock_irqrestore(&crb->lock, flags);
+		/* Did a WHOLE record fit into available tbuf ? */
+		if (last_read_recs[next_cpu] == prev)
+			break;
+		records++;
+	} while (!max_recs || records <= max_recs);
+
+	return bytes_read;
+}
+
 /**
  * This function returns a static snapshot of the ring that can be used
  * for further processing using usual records operations.
@@ -742,6 +872,8 @@ struct scsc_ring_buffer *scsc_ring_get_snapshot(const struct scsc_ring_buffer *r
 		snap_rb->written = rb->written;
 		snap_rb->records = rb->records;
 		snap_rb->wraps = rb->wraps;
+		snap_rb->drops = rb->drops;
+		snap_rb->overwritten = rb->overwritten;
 		/* this is related to reads so must be re-init */
 		snap_rb->oos = 0;
 		strncpy(snap_rb->name, snap_name, RNAME_SZ - 1);
@@ -753,6 +885,7 @@ struct scsc_ring_buffer *scsc_ring_get_snapshot(const struct scsc_ring_buffer *r
 		/* Re-init snapshot copies of sync tools */
 		raw_spin_lock_init(&snap_rb->lock);
 		init_waitqueue_head(&snap_rb->wq);
+		snap_rb->rwq = &snap_rb->wq;
 	} else {
 		kfree(snap_rb);
 		snap_rb = NULL;
@@ -769,10 +902,34 @@ void scsc_ring_truncate(struct scsc_ring_buffer *rb)
 	rb->records = 0;
 	rb->written = 0;
 	rb->wraps = 0;
+	rb->drops = 0;
+	rb->overwritten = 0;
 	rb->last = 0;
 	memset(rb->buf + rb->head, 0x00, SCSC_RINGREC_SZ);
 }
 
+static void __init init_ring_buffer(struct scsc_ring_buffer *rb,
+				    const char *name)
+{
+	rb->head = 0;
+	rb->tail = 0;
+	rb->last = 0;
+	rb->written = 0;
+	rb->records = 0;
+	rb->wraps = 0;
+	rb->oos = 0;
+	rb->drops = 0;
+	rb->overwritten = 0;
+	rb->cpu_rb = NULL;
+	rb->nr_cpu_rb = 0;
+	rb->spare = rb->buf + rb->bsz;
+	memset(rb->name, 0x00, RNAME_SZ);
+	strncpy(rb->name, name, RNAME_SZ - 1);
+	raw_spin_lock_init(&rb->lock);
+	init_waitqueue_head(&rb->wq);
+	rb->rwq = &rb->wq;
+}
+
 /**
  * alloc_ring_buffer - Allocates and initializes a basic ring buffer,
  * including a basic spare area where to handle strings-splitting when
@@ -800,22 +957,54 @@ struct scsc_ring_buffer __init *alloc_ring_buffer(size_t bsz, size_t ssz,
 #else
 	rb->buf = a_ring;
 #endif
-	rb->head = 0;
-	rb->tail = 0;
-	rb->last = 0;
-	rb->written = 0;
-	rb->records = 0;
-	rb->wraps = 0;
-	rb->oos = 0;
-	rb->spare = rb->buf + rb->bsz;
-	memset(rb->name, 0x00, RNAME_SZ);
-	strncpy(rb->name, name, RNAME_SZ - 1);
-	raw_spin_lock_init(&rb->lock);
-	init_waitqueue_head(&rb->wq);
+	init_ring_buffer(rb, name);
 
 	return rb;
 }
 
+/**
+ * alloc_ring_buffer_percpu - Splits the storage of an already allocated
+ * ring into per-cpu sub-rings, each one with its own lock and spare area
+ * carved out of the original buffer: the whole ring memory footprint is
+ * unchanged and a raw dump of rb->buf still holds all the records.
+ * The parent ring itself is not written anymore once split.
+ *
+ * @rb: the ring to split
+ */
+int __init alloc_ring_buffer_percpu(struct scsc_ring_buffer *rb)
+{
+	struct scsc_ring_buffer *crb;
+	char name[RNAME_SZ];
+	size_t csz;
+	int cpu;
+
+	csz = rb->bsz / nr_cpu_ids;
+	if (csz < SCSC_MIN_CPU_RING_SZ + rb->ssz)
+		return -ENOMEM;
+	rb->cpu_rb = kcalloc(nr_cpu_ids, sizeof(*rb->cpu_rb), GFP_KERNEL);
+	if (!rb->cpu_rb)
+		return -ENOMEM;
+	crb = kcalloc(nr_cpu_ids, sizeof(*crb), GFP_KERNEL);
+	if (!crb) {
+		kfree(rb->cpu_rb);
+		rb->cpu_rb = NULL;
+		return -ENOMEM;
+	}
+	for (cpu = 0; cpu < nr_cpu_ids; cpu++, crb++) {
+		crb->bsz = csz - rb->ssz;
+		crb->ssz = rb->ssz;
+		crb->buf = rb->buf + cpu * csz;
+		snprintf(name, RNAME_SZ, "%s_c%d", rb->name, cpu);
+		init_ring_buffer(crb, name);
+		crb->rwq = &rb->wq;
+		memset(crb->buf, 0x00, SCSC_RINGREC_SZ);
+		rb->cpu_rb[cpu] = crb;
+	}
+	rb->nr_cpu_rb = nr_cpu_ids;
+
+	return 0;
+}
+
 /*
  * free_ring_buffer - Free the ring what else...
  * ...does NOT account for spinlocks existence currently
@@ -826,6 +1015,11 @@ void free_ring_buffer(struct scsc_ring_buffer *rb)
 {
 	if (!rb)
 		return;
+	if (rb->cpu_rb) {
+		/* sub-ring descriptors were allocated as a single array */
+		kfree(rb->cpu_rb[0]);
+		kfree(rb->cpu_rb);
+	}
 #ifndef CONFIG_SCSC_STATIC_RING_SIZE
 	kfree(rb->buf);
 #endif
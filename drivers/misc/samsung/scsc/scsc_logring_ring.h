@@ -43,6 +43,7 @@
 #define DEFAULT_RING_BUFFER_SZ	     1048576
 #define DEFAULT_ENABLE_HEADER              1
 #define DEFAULT_ENABLE_LOGRING             1
+#define DEFAULT_PERCPU_RINGS               0
 /* The default len, in bytes, of the binary blob to decode in ASCII
  * Human readable form. -1 means DECODE EVERYTHING !
  */
@@ -84,11 +85,19 @@
  * from here
  * @last: the last record before the end of the ring.
  * @records: the number of records
+ * @drops: records dropped because too long to fit the spare area
+ * @overwritten: records evicted from the tail by a wrapping writer
  * @written: a general progressive counter of total bytes written into
  * the ring
  * @lock: a spinlock_t to protetc concurrent access
  * @wq: a wait queue where to put sleeping processes waiting for input.
  * They're woken up at the end os scsc_printk().
+ * @rwq: the wait queue actually woken by writers: it is @wq itself for a
+ * plain ring while the per-cpu sub-rings all point to the @wq of their
+ * parent ring, so that a merged reader sleeps on one queue only.
+ * @cpu_rb: when not NULL the ring storage is split into per-cpu sub-rings,
+ * indexed by cpu id, and writers push into the sub-ring of their own cpu.
+ * @nr_cpu_rb: number of entries in @cpu_rb
  * @refc: a reference counter...currently unused.
  * @private: useful to hold some user provided data (used to hold debugfs
  * initdata related to this ring)
@@ -108,10 +117,15 @@ struct scsc_ring_buffer {
 	int               records;
 	int               wraps;
 	int		  oos;
+	int               drops;
+	int               overwritten;
 	u64               written;
 	raw_spinlock_t    lock;
 	wait_queue_head_t wq;
+	wait_queue_head_t *rwq;
 	atomic_t          refc;
+	struct scsc_ring_buffer **cpu_rb;
+	int               nr_cpu_rb;
 	void *private;
 };
 
@@ -227,9 +241,23 @@ struct scsc_ring_record {
 	(rpos + SCSC_RINGREC_SZ + \
 	 SCSC_GET_REC_LEN(SCSC_GET_PTR((ring), (rpos))))
 
+/* Smallest sub-ring worth splitting a ring into per-cpu sub-rings */
+#define SCSC_MIN_CPU_RING_SZ	(8 * BASE_SPARE_SZ)
+
+/**
+ * Writers always go to the sub-ring of the cpu they are running on when
+ * the ring is split: being preempted right after this lookup simply
+ * means pushing into another cpu sub-ring, still under its own lock.
+ */
+static inline struct scsc_ring_buffer *scsc_ring_this_cpu(struct scsc_ring_buffer *rb)
+{
+	return rb->cpu_rb ? rb->cpu_rb[raw_smp_processor_id()] : rb;
+}
+
 /* Ring buffer API */
 struct scsc_ring_buffer *alloc_ring_buffer(size_t bsz, size_t ssz,
 					   const char *name) __init;
+int alloc_ring_buffer_percpu(struct scsc_ring_buffer *rb) __init;
 void free_ring_buffer(struct scsc_ring_buffer *rb);
 void scsc_ring_truncate(struct scsc_ring_buffer *rb);
 int push_record_string(struct scsc_ring_buffer *rb, int tag, int lev,
@@ -238,6 +266,8 @@ int push_record_blob(struct scsc_ring_buffer *rb, int tag, int lev,
 		     int prepend_header, const void *start, size_t len);
 size_t read_next_records(struct scsc_ring_buffer *rb, int max_recs,
 			 loff_t *last_read_rec, void *tbuf, size_t tsz);
+size_t read_next_records_merged(struct scsc_ring_buffer *rb, int max_recs,
+				loff_t *last_read_recs, void *tbuf, size_t tsz);
 struct scsc_ring_buffer *scsc_ring_get_snapshot(const struct scsc_ring_buffer *rb,
 						void *snap_buf, size_t snap_sz,
 						char *snap_name);
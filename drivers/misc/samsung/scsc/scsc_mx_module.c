@@ -11,6 +11,7 @@
 #include <scsc/scsc_logring.h>
 #include "scsc_mif_abs.h"
 #include "scsc_mx_impl.h"
+#include "mxlog.h"
 #ifdef CONFIG_SCSC_WLBTD
 #include "scsc_wlbtd.h"
 #endif
@@ -108,6 +109,9 @@ static int __init scsc_mx_module_init(void)
 		SCSC_RELEASE_CANDIDATE,
 		SCSC_RELEASE_POINT);
 
+	if (mxlog_bin_init())
+		SCSC_TAG_WARNING(MXMAN, "mxlog_bin not available\n");
+
 	scsc_mif_abs_register(&mx_module_mif_if);
 	return 0;
 }
@@ -125,6 +129,8 @@ static void __exit scsc_mx_module_exit(void)
 
 	scsc_mif_abs_unregister(&mx_module_mif_if);
 
+	mxlog_bin_exit();
+
 	SCSC_TAG_INFO(MXMAN, SCSC_MX_CORE_MODDESC " unloaded\n");
 }
 
@@ -1181,6 +1181,17 @@ int scsc_service_pm_qos_update_request(struct scsc_service *service, enum scsc_q
 }
 EXPORT_SYMBOL(scsc_service_pm_qos_update_request);
 
+/* Let mifqos pick the level from the expected throughput */
+int scsc_service_pm_qos_update_request_tput(struct scsc_service *service, u32 tput_mbps)
+{
+	struct scsc_mx      *mx = service->mx;
+
+	mifqos_update_request_tput(scsc_mx_get_qos(mx), service->id, tput_mbps);
+
+	return 0;
+}
+EXPORT_SYMBOL(scsc_service_pm_qos_update_request_tput);
+
 int scsc_service_pm_qos_remove_request(struct scsc_service *service)
 {
 	struct scsc_mx      *mx = service->mx;
@@ -238,6 +238,19 @@ static inline void scsc_wlog_ring_set_drop_on_full(struct scsc_wlog_ring *r)
 	r->drop_on_full = true;
 }
 
+/**
+ * Lockless hint that a drop_on_full ring has no room for a record of @sz
+ * payload bytes: producers can then avoid building a record that would
+ * be dropped anyway. Racing with the reader only means the record is
+ * dropped a bit too early.
+ */
+static inline bool scsc_wlog_ring_is_full(struct scsc_wlog_ring *r, size_t sz)
+{
+	size_t chunk_sz = sizeof(struct scsc_wifi_ring_buffer_entry) + sz;
+
+	return r->drop_on_full && !CAN_FIT(r, chunk_sz);
+}
+
 static inline void scsc_wlog_register_verbosity_reference(struct scsc_wlog_ring *r, u32 *verbose_ref)
 {
 	r->verbosity = verbose_ref;
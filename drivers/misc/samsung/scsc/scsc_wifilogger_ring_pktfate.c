@@ -8,15 +8,71 @@
 
 /* Uses */
 #include <stdarg.h>
+#include <linux/percpu.h>
+#include <linux/math64.h>
 #include "scsc_wifilogger_internal.h"
 
 static bool pktfate_monitor_started;
 
-static wifi_tx_report txr;
-static wifi_rx_report rxr;
+static uint pktfate_mode = PKTFATE_MODE_FULL;
+module_param(pktfate_mode, uint, 0644);
+MODULE_PARM_DESC(pktfate_mode, "Data frames capture: 0 full, 1 headers only, 2 sampled headers");
+
+static uint pktfate_sample_rate = PKTFATE_DEFAULT_SAMPLE_RATE;
+module_param(pktfate_sample_rate, uint, 0644);
+MODULE_PARM_DESC(pktfate_sample_rate, "Log one data frame every N in sampling mode");
+
+/**
+ * Reports are built in a per-cpu staging area, with local irqs disabled,
+ * so that producers on different cpus never share it: the ring write lock
+ * is then the only shared state touched on the data path.
+ */
+union pktfate_report {
+	wifi_tx_report tx;
+	wifi_rx_report rx;
+};
+
+/* Per-cpu overhead accounting, indexed by TX_FATE/RX_FATE */
+struct pktfate_stats {
+	u64 seen;
+	u64 logged;
+	u64 sampled_out;
+	u64 ring_full;
+	u64 ns;
+	u32 sample_seq;
+};
+
+struct pktfate_cpu {
+	union pktfate_report report;
+	struct pktfate_stats stats[2];
+};
+
+static DEFINE_PER_CPU(struct pktfate_cpu, pktfate_cpu);
+
 static struct scsc_wlog_ring *fate_ring_tx;
 static struct scsc_wlog_ring *fate_ring_rx;
 
+/**
+ * Returns how many bytes of a data frame should be captured according to
+ * the configured mode, or 0 if the frame is not sampled.
+ */
+static inline size_t pktfate_capture_len(struct pktfate_stats *st, size_t len)
+{
+	switch (pktfate_mode) {
+	case PKTFATE_MODE_SAMPLE:
+		if (++st->sample_seq < pktfate_sample_rate) {
+			st->sampled_out++;
+			return 0;
+		}
+		st->sample_seq = 0;
+		/* fall through */
+	case PKTFATE_MODE_HEADER:
+		return min_t(size_t, len, PKTFATE_HDR_LEN);
+	default:
+		return min_t(size_t, len, MAX_UNITDATA_LOGGED_SZ);
+	}
+}
+
 #ifdef CONFIG_SCSC_WIFILOGGER_DEBUGFS
 #include "scsc_wifilogger_debugfs.h"
 #include "scsc_wifilogger.h"
@@ -73,6 +129,56 @@ const struct file_operations get_fates_fops = {
 };
 #endif /* CONFIG_SCSC_WIFILOGGER_TEST */
 
+#define PKTFATE_OVERHEAD_STAT_SZ	256
+
+/* Data path overhead of the pkt_fate logging summed over all the cpus */
+static ssize_t dfs_read_overhead(struct file *filp, char __user *ubuf,
+				 size_t count, loff_t *f_pos)
+{
+	struct scsc_ring_test_object *rto;
+	struct pktfate_stats tot = {};
+	char statstr[PKTFATE_OVERHEAD_STAT_SZ];
+	int slen, cpu, fate;
+
+	if (!filp->private_data)
+		return -EINVAL;
+	rto = filp->private_data;
+	fate = !strncmp(rto->r->st.name, WLOGGER_RFATE_TX_NAME, RING_NAME_SZ - 1) ?
+	       TX_FATE : RX_FATE;
+
+	for_each_possible_cpu(cpu) {
+		struct pktfate_stats *st = &per_cpu_ptr(&pktfate_cpu, cpu)->stats[fate];
+
+		tot.seen += st->seen;
+		tot.logged += st->logged;
+		tot.sampled_out += st->sampled_out;
+		tot.ring_full += st->ring_full;
+		tot.ns += st->ns;
+	}
+
+	slen = snprintf(statstr, PKTFATE_OVERHEAD_STAT_SZ,
+			"[%s]:: mode:%u  sample_rate:%u\n"
+			"\tseen:%llu  logged:%llu  sampled_out:%llu  ring_full:%llu  ns:%llu  ns_per_frame:%llu\n",
+			rto->r->st.name, pktfate_mode, pktfate_sample_rate,
+			tot.seen, tot.logged, tot.sampled_out, tot.ring_full, tot.ns,
+			tot.seen ? div64_u64(tot.ns, tot.seen) : 0);
+	if (slen >= 0 && *f_pos < slen) {
+		count = (count <= slen - *f_pos) ? count : (slen - *f_pos);
+		if (copy_to_user(ubuf, statstr + *f_pos, count))
+			return -EFAULT;
+		*f_pos += count;
+	} else {
+		count = 0;
+	}
+	return count;
+}
+
+const struct file_operations overhead_fops = {
+	.owner = THIS_MODULE,
+	.open = dfs_open,
+	.read = dfs_read_overhead,
+	.release = dfs_release,
+};
 #endif /* CONFIG_SCSC_WIFILOGGER_DEBUGFS */
 
 bool is_pktfate_monitor_started(void)
@@ -138,6 +244,8 @@ bool scsc_wifilogger_ring_pktfate_init(void)
 	rto_tx = init_ring_test_object(fate_ring_tx);
 	if (rto_tx) {
 		scsc_register_common_debugfs_entries(fate_ring_tx->st.name, rto_tx, &di_tx);
+		scsc_wlog_register_debugfs_entry(fate_ring_tx->st.name, "overhead",
+						 &overhead_fops, rto_tx, &di_tx);
 #ifdef CONFIG_SCSC_WIFILOGGER_TEST
 		scsc_wlog_register_debugfs_entry(fate_ring_tx->st.name, "get_fates",
 						 &get_fates_fops, rto_tx, &di_tx);
@@ -147,6 +255,8 @@ bool scsc_wifilogger_ring_pktfate_init(void)
 	rto_rx = init_ring_test_object(fate_ring_rx);
 	if (rto_rx) {
 		scsc_register_common_debugfs_entries(fate_ring_rx->st.name, rto_rx, &di_rx);
+		scsc_wlog_register_debugfs_entry(fate_ring_rx->st.name, "overhead",
+						 &overhead_fops, rto_rx, &di_rx);
 #ifdef CONFIG_SCSC_WIFILOGGER_TEST
 		scsc_wlog_register_debugfs_entry(fate_ring_rx->st.name, "get_fates",
 						 &get_fates_fops, rto_rx, &di_rx);
@@ -159,9 +269,15 @@ bool scsc_wifilogger_ring_pktfate_init(void)
 
 void scsc_wifilogger_ring_pktfate_start_monitoring(void)
 {
+	int cpu;
+
 	if (!fate_ring_rx || !fate_ring_tx)
 		return;
 
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(&pktfate_cpu, cpu)->stats, 0,
+		       sizeof(per_cpu_ptr(&pktfate_cpu, cpu)->stats));
+
 	/* Just in case */
 	scsc_wlog_flush_ring(fate_ring_tx);
 	scsc_wlog_start_logging(fate_ring_tx, WLOG_DEBUG, 0, 0, 0);
@@ -219,22 +335,42 @@ void scsc_wifilogger_ring_pktfate_log_tx_frame(wifi_tx_packet_fate fate,
 					       u16 htag, void *frame,
 					       size_t len, bool ma_unitdata)
 {
+	struct pktfate_stats *st;
+	wifi_tx_report *txr;
+	unsigned long flags;
+	u64 start;
+
 	if (len > MAX_FRAME_LEN_ETHERNET) {
 		SCSC_TAG_WARNING(WLOG, "pktfate TX:: dropped unplausible length frame.\n");
 		return;
 	}
 
-	if (ma_unitdata)
-		len = len <= MAX_UNITDATA_LOGGED_SZ ? len : MAX_UNITDATA_LOGGED_SZ;
+	local_irq_save(flags);
+	start = local_clock();
+	st = &this_cpu_ptr(&pktfate_cpu)->stats[TX_FATE];
+	st->seen++;
+
+	if (ma_unitdata) {
+		len = pktfate_capture_len(st, len);
+		if (!len)
+			goto out;
+	}
+
+	/* Do not even build a report that the full ring would drop */
+	if (scsc_wlog_ring_is_full(fate_ring_tx, sizeof(*txr))) {
+		st->ring_full++;
+		goto out;
+	}
 
-	txr.fate = fate;
-	txr.frame_inf.payload_type = FRAME_TYPE_ETHERNET_II;
-	txr.frame_inf.frame_len = len;
-	txr.frame_inf.driver_timestamp_usec = ktime_to_ns(ktime_get_boottime());
-	txr.frame_inf.firmware_timestamp_usec = 0;
-	memcpy(&txr.frame_inf.frame_content, frame, len);
+	txr = &this_cpu_ptr(&pktfate_cpu)->report.tx;
+	txr->fate = fate;
+	txr->frame_inf.payload_type = FRAME_TYPE_ETHERNET_II;
+	txr->frame_inf.frame_len = len;
+	txr->frame_inf.driver_timestamp_usec = ktime_to_ns(ktime_get_boottime());
+	txr->frame_inf.firmware_timestamp_usec = 0;
+	memcpy(&txr->frame_inf.frame_content, frame, len);
 	//TODO MD5 checksum using Kernel Crypto API
-	memset(&txr.md5_prefix, 0x00, MD5_PREFIX_LEN);
+	memset(&txr->md5_prefix, 0x00, MD5_PREFIX_LEN);
 	/**
 	 * We have to waste a lot of space storing the frame in a full-sized
 	 * frame_content array, even if the frame size is much smaller, because
@@ -246,31 +382,55 @@ void scsc_wifilogger_ring_pktfate_log_tx_frame(wifi_tx_packet_fate fate,
 	 *
 	 * frame_len field is anyway provided to recognize the actual end of frame.
 	 */
-	scsc_wlog_write_record(fate_ring_tx, NULL, 0, &txr, sizeof(txr), WLOG_DEBUG, 0);
+	if (scsc_wlog_write_record(fate_ring_tx, NULL, 0, txr, sizeof(*txr), WLOG_DEBUG, 0))
+		st->logged++;
+out:
+	st->ns += local_clock() - start;
+	local_irq_restore(flags);
 }
 EXPORT_SYMBOL(scsc_wifilogger_ring_pktfate_log_tx_frame);
 
 void scsc_wifilogger_ring_pktfate_log_rx_frame(wifi_rx_packet_fate fate, u16 du_desc,
 					       void *frame, size_t len,  bool ma_unitdata)
 {
+	struct pktfate_stats *st;
+	wifi_rx_report *rxr;
+	unsigned long flags;
+	u64 start;
+
 	if ((du_desc == SCSC_DUD_ETHERNET_FRAME && len > MAX_FRAME_LEN_ETHERNET) ||
 	    (du_desc == SCSC_DUD_80211_FRAME && len > MAX_FRAME_LEN_80211_MGMT)) {
 		SCSC_TAG_WARNING(WLOG, "pktfate RX:: dropped unplausible length frame.\n");
 		return;
 	}
 
-	if (ma_unitdata)
-		len = len <= MAX_UNITDATA_LOGGED_SZ ? len : MAX_UNITDATA_LOGGED_SZ;
+	local_irq_save(flags);
+	start = local_clock();
+	st = &this_cpu_ptr(&pktfate_cpu)->stats[RX_FATE];
+	st->seen++;
+
+	if (ma_unitdata) {
+		len = pktfate_capture_len(st, len);
+		if (!len)
+			goto out;
+	}
+
+	/* Do not even build a report that the full ring would drop */
+	if (scsc_wlog_ring_is_full(fate_ring_rx, sizeof(*rxr))) {
+		st->ring_full++;
+		goto out;
+	}
 
-	rxr.fate = fate;
-	rxr.frame_inf.payload_type = du_desc == SCSC_DUD_ETHERNET_FRAME ? FRAME_TYPE_ETHERNET_II :
-				    (du_desc == SCSC_DUD_80211_FRAME ? FRAME_TYPE_80211_MGMT : FRAME_TYPE_UNKNOWN);
-	rxr.frame_inf.frame_len = len;
-	rxr.frame_inf.driver_timestamp_usec = ktime_to_ns(ktime_get_boottime());
-	rxr.frame_inf.firmware_timestamp_usec = 0;
-	memcpy(&rxr.frame_inf.frame_content, frame, len);
+	rxr = &this_cpu_ptr(&pktfate_cpu)->report.rx;
+	rxr->fate = fate;
+	rxr->frame_inf.payload_type = du_desc == SCSC_DUD_ETHERNET_FRAME ? FRAME_TYPE_ETHERNET_II :
+				     (du_desc == SCSC_DUD_80211_FRAME ? FRAME_TYPE_80211_MGMT : FRAME_TYPE_UNKNOWN);
+	rxr->frame_inf.frame_len = len;
+	rxr->frame_inf.driver_timestamp_usec = ktime_to_ns(ktime_get_boottime());
+	rxr->frame_inf.firmware_timestamp_usec = 0;
+	memcpy(&rxr->frame_inf.frame_content, frame, len);
 	//TODO MD5 checksum using Kernel Crypto API
-	memset(&rxr.md5_prefix, 0x00, MD5_PREFIX_LEN);
+	memset(&rxr->md5_prefix, 0x00, MD5_PREFIX_LEN);
 	/**
 	 * We have to waste a lot of space storing the frame in a full-sized
 	 * frame_content array, even if the frame size is much smaller, because
@@ -282,6 +442,10 @@ void scsc_wifilogger_ring_pktfate_log_rx_frame(wifi_rx_packet_fate fate, u16 du_
 	 *
 	 * frame_len field is anyway provided to recognize the actual end of frame.
 	 */
-	scsc_wlog_write_record(fate_ring_rx, NULL, 0, &rxr, sizeof(rxr), WLOG_DEBUG, 0);
+	if (scsc_wlog_write_record(fate_ring_rx, NULL, 0, rxr, sizeof(*rxr), WLOG_DEBUG, 0))
+		st->logged++;
+out:
+	st->ns += local_clock() - start;
+	local_irq_restore(flags);
 }
 EXPORT_SYMBOL(scsc_wifilogger_ring_pktfate_log_rx_frame);
@@ -25,6 +25,13 @@
 #define SCSC_DUD_80211_FRAME		1
 #define SCSC_DUD_MLME			2
 
+/* Capture modes for data frames, control frames are always fully logged */
+#define PKTFATE_MODE_FULL		0	/* up to MAX_UNITDATA_LOGGED_SZ */
+#define PKTFATE_MODE_HEADER		1	/* up to PKTFATE_HDR_LEN */
+#define PKTFATE_MODE_SAMPLE		2	/* headers of 1 frame every sample_rate */
+#define PKTFATE_HDR_LEN			54	/* Ethernet + IPv4 + TCP with no options */
+#define PKTFATE_DEFAULT_SAMPLE_RATE	16
+
 bool is_pktfate_monitor_started(void);
 bool scsc_wifilogger_ring_pktfate_init(void);
 void scsc_wifilogger_ring_pktfate_start_monitoring(void);
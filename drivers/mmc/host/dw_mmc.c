@@ -452,6 +452,18 @@ static void dw_mci_init_debugfs(struct dw_mci_slot *slot)
 	if (!node)
 		goto err;
 
+	if (host->use_dma == TRANS_MODE_IDMAC) {
+		node = debugfs_create_u32("desc_prep_ahead", S_IRUSR, root,
+					  &host->desc_prep_ahead);
+		if (!node)
+			goto err;
+
+		node = debugfs_create_u32("desc_prep_sync", S_IRUSR, root,
+					  &host->desc_prep_sync);
+		if (!node)
+			goto err;
+	}
+
 	return;
 
  err:
@@ -845,6 +857,64 @@ static void dw_mci_stop_dma(struct dw_mci *host)
 	set_bit(EVENT_XFER_COMPLETE, &host->pending_events);
 }
 
+static inline size_t dw_mci_desc_size(struct dw_mci *host)
+{
+	if (host->dma_64bit_address == 1)
+		return sizeof(struct idmac_desc_64addr);
+
+	return sizeof(struct idmac_desc);
+}
+
+static inline void *dw_mci_desc_ring(struct dw_mci *host, int ring)
+{
+	return host->sg_cpu + ring * host->ring_size * dw_mci_desc_size(host);
+}
+
+static inline dma_addr_t dw_mci_desc_ring_dma(struct dw_mci *host, int ring)
+{
+	return host->sg_dma + ring * host->ring_size * dw_mci_desc_size(host);
+}
+
+/*
+ * Clears the first @nr_desc descriptors of @ring and forward links them.
+ * The last descriptor of a ring is linked back to the head of the ring.
+ */
+static void dw_mci_idmac_link_ring(struct dw_mci *host, int ring, unsigned int nr_desc)
+{
+	dma_addr_t base = dw_mci_desc_ring_dma(host, ring);
+	dma_addr_t next;
+	unsigned int i;
+
+	nr_desc = min(nr_desc, host->ring_size);
+
+	if (host->dma_64bit_address == 1) {
+		struct idmac_desc_64addr *p = dw_mci_desc_ring(host, ring);
+
+		for (i = 0; i < nr_desc; i++, p++) {
+			next = base + sizeof(*p) * ((i + 1) % host->ring_size);
+
+			memset(p, 0, sizeof(*p));
+			p->des6 = next & 0xffffffff;
+			p->des7 = (u64) next >> 32;
+			if (i == host->ring_size - 1)
+				p->des0 = IDMAC_DES0_ER;
+		}
+	} else {
+		struct idmac_desc *p = dw_mci_desc_ring(host, ring);
+
+		for (i = 0; i < nr_desc; i++, p++) {
+			next = base + sizeof(*p) * ((i + 1) % host->ring_size);
+
+			memset(p, 0, sizeof(*p));
+			p->des3 = cpu_to_le32(next);
+			if (i == host->ring_size - 1)
+				p->des0 = cpu_to_le32(IDMAC_DES0_ER);
+		}
+	}
+
+	host->ring_used[ring] = 0;
+}
+
 static void dw_mci_dma_cleanup(struct dw_mci *host)
 {
 	struct mmc_data *data = host->data;
@@ -853,7 +923,13 @@ static void dw_mci_dma_cleanup(struct dw_mci *host)
 		dma_unmap_sg(host->dev, data->sg, data->sg_len, mmc_get_dma_dir(data));
 		data->host_cookie = COOKIE_UNMAPPED;
 	}
-	memset(host->sg_cpu, 0, DESC_RING_BUF_SZ);
+
+	/* Only the ring of this transfer, the other may be built by pre_req */
+	if (host->use_dma == TRANS_MODE_IDMAC)
+		dw_mci_idmac_link_ring(host, host->desc_ring,
+				host->ring_used[host->desc_ring]);
+	else
+		memset(host->sg_cpu, 0, DESC_RING_BUF_SZ);
 }
 
 static void dw_mci_idmac_reset(struct dw_mci *host)
@@ -898,7 +974,8 @@ static void dw_mci_dmac_complete_dma(void *arg)
 				    data->sg, data->sg_len, DMA_FROM_DEVICE);
 
 	if (drv_data->crypto_engine_clear) {
-		ret = drv_data->crypto_engine_clear(host, host->sg_cpu, false);
+		ret = drv_data->crypto_engine_clear(host,
+				dw_mci_desc_ring(host, host->desc_ring), false);
 		if (ret) {
 			dev_err(host->dev,
 					"%s: failed to clear crypto engine(%d)\n",
@@ -918,52 +995,36 @@ static void dw_mci_dmac_complete_dma(void *arg)
 	}
 }
 
-static int dw_mci_idmac_init(struct dw_mci *host)
+static void dw_mci_idmac_set_base(struct dw_mci *host, int ring)
 {
-	int i;
+	dma_addr_t base = dw_mci_desc_ring_dma(host, ring);
 
 	if (host->dma_64bit_address == 1) {
-		struct idmac_desc_64addr *p;
-		/* Number of descriptors in the ring buffer */
-		host->ring_size = host->desc_sz * DESC_RING_BUF_SZ /
-		    sizeof(struct idmac_desc_64addr);
-
-		/* Forward link the descriptor list */
-		for (i = 0, p = host->sg_cpu; i < host->ring_size * MMC_DW_IDMAC_MULTIPLIER - 1;
-		     i++, p++) {
-			p->des6 = (host->sg_dma +
-				   (sizeof(struct idmac_desc_64addr) * (i + 1))) & 0xffffffff;
-
-			p->des7 = (u64) (host->sg_dma +
-					 (sizeof(struct idmac_desc_64addr) * (i + 1))) >> 32;
-			/* Initialize reserved and buffer size fields to "0" */
-			p->des0 = 0;
-			p->des1 = 0;
-			p->des2 = 0;
-			p->des3 = 0;
-		}
-
-		/* Set the last descriptor as the end-of-ring descriptor */
-		p->des6 = host->sg_dma & 0xffffffff;
-		p->des7 = (u64) host->sg_dma >> 32;
-		p->des0 = IDMAC_DES0_ER;
-
+		mci_writel(host, DBADDRL, base & 0xffffffff);
+		mci_writel(host, DBADDRU, (u64) base >> 32);
 	} else {
-		struct idmac_desc *p;
-		/* Number of descriptors in the ring buffer */
-		host->ring_size = host->desc_sz * DESC_RING_BUF_SZ / sizeof(struct idmac_desc);
-
-		/* Forward link the descriptor list */
-		for (i = 0, p = host->sg_cpu; i < host->ring_size - 1; i++, p++) {
-			p->des3 = cpu_to_le32(host->sg_dma + (sizeof(struct idmac_desc) * (i + 1)));
-			p->des0 = 0;
-			p->des1 = 0;
-		}
+		mci_writel(host, DBADDR, base);
+	}
+}
 
-		/* Set the last descriptor as the end-of-ring descriptor */
-		p->des3 = cpu_to_le32(host->sg_dma);
-		p->des0 = cpu_to_le32(IDMAC_DES0_ER);
+static int dw_mci_idmac_init(struct dw_mci *host)
+{
+	int i;
+
+	/*
+	 * Number of descriptors in each ring. The descriptor buffer is split
+	 * so that pre_req can fill one ring while the other is in flight.
+	 */
+	host->ring_size = host->desc_sz * DESC_RING_BUF_SZ * MMC_DW_IDMAC_MULTIPLIER /
+			(dw_mci_desc_size(host) * DW_MCI_DESC_RINGS);
+
+	/* Descriptors built by pre_req are invalidated */
+	host->desc_gen++;
+	for (i = 0; i < DW_MCI_DESC_RINGS; i++) {
+		dw_mci_idmac_link_ring(host, i, host->ring_size);
+		host->ring_data[i] = NULL;
 	}
+	host->desc_ring = 0;
 
 	dw_mci_idmac_reset(host);
 
@@ -972,26 +1033,21 @@ static int dw_mci_idmac_init(struct dw_mci *host)
 		mci_writel(host, IDSTS64, IDMAC_INT_CLR);
 		mci_writel(host, IDINTEN64, SDMMC_IDMAC_INT_NI |
 			   SDMMC_IDMAC_INT_RI | SDMMC_IDMAC_INT_TI);
-
-		/* Set the descriptor base address */
-		mci_writel(host, DBADDRL, host->sg_dma & 0xffffffff);
-		mci_writel(host, DBADDRU, (u64) host->sg_dma >> 32);
-
 	} else {
 		/* Mask out interrupts - get Tx & Rx complete only */
 		mci_writel(host, IDSTS, IDMAC_INT_CLR);
 		mci_writel(host, IDINTEN, SDMMC_IDMAC_INT_NI |
 			   SDMMC_IDMAC_INT_RI | SDMMC_IDMAC_INT_TI);
-
-		/* Set the descriptor base address */
-		mci_writel(host, DBADDR, host->sg_dma);
 	}
 
+	/* Set the descriptor base address */
+	dw_mci_idmac_set_base(host, host->desc_ring);
+
 	return 0;
 }
 
 static inline int dw_mci_prepare_desc64(struct dw_mci *host,
-					struct mmc_data *data, unsigned int sg_len)
+					struct mmc_data *data, unsigned int sg_len, int ring)
 {
 	unsigned int desc_len;
 	struct idmac_desc_64addr *desc_first, *desc_last, *desc;
@@ -1001,7 +1057,7 @@ static inline int dw_mci_prepare_desc64(struct dw_mci *host,
 	int sector_offset = 0;
 	int ret;
 
-	desc_first = desc_last = desc = host->sg_cpu;
+	desc_first = desc_last = desc = dw_mci_desc_ring(host, ring);
 
 	for (i = 0; i < sg_len; i++) {
 		unsigned int length = sg_dma_len(&data->sg[i]);
@@ -1014,6 +1070,9 @@ static inline int dw_mci_prepare_desc64(struct dw_mci *host,
 
 			length -= desc_len;
 
+			if (host->ring_used[ring] == host->ring_size)
+				goto err_ring_full;
+
 			/*
 			 * Wait for the former clear OWN bit operation
 			 * of IDMAC to make sure that this descriptor
@@ -1030,6 +1089,7 @@ static inline int dw_mci_prepare_desc64(struct dw_mci *host,
 			 * for this descriptor
 			 */
 			desc->des0 = IDMAC_DES0_OWN | IDMAC_DES0_DIC | IDMAC_DES0_CH;
+			host->ring_used[ring]++;
 
 			/* Buffer length */
 			IDMAC_64ADDR_SET_BUFFER1_SIZE(desc, desc_len);
@@ -1066,23 +1126,23 @@ static inline int dw_mci_prepare_desc64(struct dw_mci *host,
 	desc_last->des0 |= IDMAC_DES0_LD;
 
 	return 0;
+ err_ring_full:
+	dev_dbg(host->dev, "descriptor ring is too small for the request.\n");
+	return -EINVAL;
  err_own_bit:
-	/* restore the descriptor chain as it's polluted */
 	dev_dbg(host->dev, "descriptor is still owned by IDMAC.\n");
-	memset(host->sg_cpu, 0, DESC_RING_BUF_SZ);
-	dw_mci_idmac_init(host);
-	return -EINVAL;
+	return -EBUSY;
 }
 
 static inline int dw_mci_prepare_desc32(struct dw_mci *host,
-					struct mmc_data *data, unsigned int sg_len)
+					struct mmc_data *data, unsigned int sg_len, int ring)
 {
 	unsigned int desc_len;
 	struct idmac_desc *desc_first, *desc_last, *desc;
 	u32 val;
 	int i;
 
-	desc_first = desc_last = desc = host->sg_cpu;
+	desc_first = desc_last = desc = dw_mci_desc_ring(host, ring);
 
 	for (i = 0; i < sg_len; i++) {
 		unsigned int length = sg_dma_len(&data->sg[i]);
@@ -1095,6 +1155,9 @@ static inline int dw_mci_prepare_desc32(struct dw_mci *host,
 
 			length -= desc_len;
 
+			if (host->ring_used[ring] == host->ring_size)
+				goto err_ring_full;
+
 			/*
 			 * Wait for the former clear OWN bit operation
 			 * of IDMAC to make sure that this descriptor
@@ -1111,6 +1174,7 @@ static inline int dw_mci_prepare_desc32(struct dw_mci *host,
 			 * for this descriptor
 			 */
 			desc->des0 = cpu_to_le32(IDMAC_DES0_OWN | IDMAC_DES0_DIC | IDMAC_DES0_CH);
+			host->ring_used[ring]++;
 
 			/* Buffer length */
 			IDMAC_SET_BUFFER1_SIZE(desc, desc_len);
@@ -1134,32 +1198,112 @@ static inline int dw_mci_prepare_desc32(struct dw_mci *host,
 	desc_last->des0 |= cpu_to_le32(IDMAC_DES0_LD);
 
 	return 0;
+ err_ring_full:
+	dev_dbg(host->dev, "descriptor ring is too small for the request.\n");
+	return -EINVAL;
  err_own_bit:
-	/* restore the descriptor chain as it's polluted */
 	dev_dbg(host->dev, "descriptor is still owned by IDMAC.\n");
-	memset(host->sg_cpu, 0, DESC_RING_BUF_SZ);
-	dw_mci_idmac_init(host);
-	return -EINVAL;
+	return -EBUSY;
 }
 
-static int dw_mci_idmac_start_dma(struct dw_mci *host, unsigned int sg_len)
+static int dw_mci_idmac_prepare_desc(struct dw_mci *host,
+				     struct mmc_data *data, unsigned int sg_len, int ring)
 {
-	u32 temp;
 	int ret;
 
 	if (host->dma_64bit_address == 1)
-		ret = dw_mci_prepare_desc64(host, host->data, sg_len);
+		ret = dw_mci_prepare_desc64(host, data, sg_len, ring);
 	else
-		ret = dw_mci_prepare_desc32(host, host->data, sg_len);
+		ret = dw_mci_prepare_desc32(host, data, sg_len, ring);
 
+	/* restore the descriptor chain as it's polluted */
 	if (ret)
-		goto out;
+		dw_mci_idmac_link_ring(host, ring, host->ring_size);
+
+	return ret;
+}
+
+/*
+ * Builds the descriptors of the next request into the idle ring while the
+ * current transfer is running on the other one, so that start_dma only
+ * has to point the IDMAC at them. Descriptors are built again at start if
+ * the rings were reinitialized meanwhile.
+ */
+static void dw_mci_idmac_pre_req(struct dw_mci *host, struct mmc_data *data,
+				 unsigned int sg_len)
+{
+	int ring = (host->desc_ring + 1) % DW_MCI_DESC_RINGS;
+	u32 gen = READ_ONCE(host->desc_gen);
+
+	if (host->ring_data[ring])
+		return;
+
+	/* Left over by a transfer which was not cleaned up */
+	if (host->ring_used[ring])
+		dw_mci_idmac_link_ring(host, ring, host->ring_used[ring]);
+
+	if (dw_mci_idmac_prepare_desc(host, data, sg_len, ring))
+		return;
+
+	host->ring_gen[ring] = gen;
+	host->ring_data[ring] = data;
+}
+
+static void dw_mci_idmac_post_req(struct dw_mci *host, struct mmc_data *data)
+{
+	int ring;
+
+	/* Release the ring if the request was not started after all */
+	for (ring = 0; ring < DW_MCI_DESC_RINGS; ring++) {
+		if (host->ring_data[ring] != data)
+			continue;
+
+		host->ring_data[ring] = NULL;
+		if (host->ring_gen[ring] == host->desc_gen)
+			dw_mci_idmac_link_ring(host, ring, host->ring_used[ring]);
+	}
+}
+
+static int dw_mci_idmac_start_dma(struct dw_mci *host, unsigned int sg_len)
+{
+	struct mmc_data *data = host->data;
+	u32 temp;
+	int ring;
+	int ret = 0;
+
+	for (ring = 0; ring < DW_MCI_DESC_RINGS; ring++)
+		if (host->ring_data[ring] == data &&
+		    host->ring_gen[ring] == host->desc_gen)
+			break;
+
+	if (ring < DW_MCI_DESC_RINGS) {
+		host->desc_prep_ahead++;
+	} else {
+		/* Not built by pre_req, reuse the ring of the former transfer */
+		ring = host->desc_ring;
+		if (host->ring_data[ring])
+			ring = (ring + 1) % DW_MCI_DESC_RINGS;
+		host->ring_data[ring] = NULL;
+		dw_mci_idmac_link_ring(host, ring, host->ring_used[ring]);
+
+		ret = dw_mci_idmac_prepare_desc(host, data, sg_len, ring);
+		if (ret == -EBUSY)
+			dw_mci_idmac_init(host);
+		if (ret)
+			goto out;
+
+		host->desc_prep_sync++;
+	}
+
+	host->ring_data[ring] = NULL;
+	host->desc_ring = ring;
 
 	/* drain writebuffer */
 	wmb();
 
 	/* Make sure to reset DMA in case we did PIO before this */
 	dw_mci_ctrl_reset(host, SDMMC_CTRL_DMA_RESET);
+	dw_mci_idmac_set_base(host, ring);
 	dw_mci_idmac_reset(host);
 
 	/* Select IDMAC interface */
@@ -1356,6 +1500,7 @@ static void dw_mci_pre_req(struct mmc_host *mmc, struct mmc_request *mrq)
 {
 	struct dw_mci_slot *slot = mmc_priv(mmc);
 	struct mmc_data *data = mrq->data;
+	int sg_len;
 
 	if (!slot->host->use_dma || !data)
 		return;
@@ -1363,8 +1508,14 @@ static void dw_mci_pre_req(struct mmc_host *mmc, struct mmc_request *mrq)
 	/* This data might be unmapped at this time */
 	data->host_cookie = COOKIE_UNMAPPED;
 
-	if (dw_mci_pre_dma_transfer(slot->host, mrq->data, COOKIE_PRE_MAPPED) < 0)
+	sg_len = dw_mci_pre_dma_transfer(slot->host, mrq->data, COOKIE_PRE_MAPPED);
+	if (sg_len < 0) {
 		data->host_cookie = COOKIE_UNMAPPED;
+		return;
+	}
+
+	if (slot->host->use_dma == TRANS_MODE_IDMAC)
+		dw_mci_idmac_pre_req(slot->host, data, sg_len);
 }
 
 static void dw_mci_post_req(struct mmc_host *mmc, struct mmc_request *mrq, int err)
@@ -1375,6 +1526,9 @@ static void dw_mci_post_req(struct mmc_host *mmc, struct mmc_request *mrq, int e
 	if (!slot->host->use_dma || !data)
 		return;
 
+	if (slot->host->use_dma == TRANS_MODE_IDMAC)
+		dw_mci_idmac_post_req(slot->host, data);
+
 	if (data->host_cookie != COOKIE_UNMAPPED)
 		dma_unmap_sg(slot->host->dev, data->sg, data->sg_len, mmc_get_dma_dir(data));
 	data->host_cookie = COOKIE_UNMAPPED;
@@ -1581,10 +1735,9 @@ static int dw_mci_submit_data_dma(struct dw_mci *host, struct mmc_data *data)
 	if (!host->use_dma)
 		return -ENODEV;
 
-	if (host->use_dma && host->dma_ops->init && host->dma_ops->reset) {
-		host->dma_ops->init(host);
+	/* IDMAC rings are linked once by init, start_dma sets the ring to run */
+	if (host->use_dma && host->dma_ops->reset)
 		host->dma_ops->reset(host);
-	}
 
 	sg_len = dw_mci_pre_dma_transfer(host, data, COOKIE_MAPPED);
 	if (sg_len < 0) {
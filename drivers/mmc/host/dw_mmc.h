@@ -45,6 +45,9 @@ enum dw_mci_cookie {
 	COOKIE_MAPPED,		/* mapped by prepare_data() of dwmmc */
 };
 
+/* descriptor rings, one is filled by pre_req while the other is in flight */
+#define DW_MCI_DESC_RINGS		2
+
 struct mmc_data;
 
 enum {
@@ -83,6 +86,13 @@ struct dw_mci_dma_slave {
  * @dma_ops: Pointer to platform-specific DMA callbacks.
  * @cmd_status: Snapshot of SR taken upon completion of the current
  * @ring_size: Buffer size for idma descriptors.
+ * @desc_ring: Index of the descriptor ring used by the current transfer.
+ * @ring_data: Data whose descriptors were built in advance by pre_req.
+ * @ring_gen: @desc_gen at which @ring_data was built.
+ * @desc_gen: Bumped whenever the rings are linked again by idmac init.
+ * @ring_used: Number of descriptors filled in each ring.
+ * @desc_prep_ahead: Transfers started with descriptors built by pre_req.
+ * @desc_prep_sync: Transfers whose descriptors were built at start.
  *	command. Only valid when EVENT_CMD_COMPLETE is pending.
  * @dms: structure of slave-dma private data.
  * @phy_regs: physical address of controller's register map
@@ -188,6 +198,13 @@ struct dw_mci {
 	const struct dw_mci_dma_ops *dma_ops;
 	/* For idmac */
 	unsigned int ring_size;
+	int desc_ring;
+	struct mmc_data *ring_data[DW_MCI_DESC_RINGS];
+	u32 ring_gen[DW_MCI_DESC_RINGS];
+	u32 desc_gen;
+	unsigned int ring_used[DW_MCI_DESC_RINGS];
+	u32 desc_prep_ahead;
+	u32 desc_prep_sync;
 
 	/* For edmac */
 	struct dw_mci_dma_slave *dms;
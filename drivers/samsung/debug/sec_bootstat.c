@@ -29,6 +29,7 @@
 #include <linux/sec_ext.h>
 #include <clocksource/arm_arch_timer.h>
 #include <linux/slab.h>
+#include <linux/mutex.h>
 
 static u32 mct_start;
 
@@ -114,6 +115,8 @@ unsigned long long boot_complete_time = 0;
 static int events_ebs = 0;
 
 LIST_HEAD(device_init_time_list);
+/* initcalls and asynchronous probes add to device_init_time_list at once */
+static DEFINE_MUTEX(device_init_time_lock);
 LIST_HEAD(systemserver_init_time_list);
 LIST_HEAD(enhanced_boot_time_list);
 
@@ -137,6 +140,33 @@ void sec_bootstat_add_initcall(const char *s)
 	}
 }
 
+void sec_bootstat_add_device_init(struct device_init_time_entry *entry)
+{
+	mutex_lock(&device_init_time_lock);
+	list_add(&entry->next, &device_init_time_list);
+	mutex_unlock(&device_init_time_lock);
+}
+
+void sec_bootstat_add_probe(const char *drv, const char *dev,
+		unsigned long long duration)
+{
+	struct device_init_time_entry *entry;
+
+	if (bootcompleted || duration < DEVICE_PROBE_TIME_10MS)
+		return;
+
+	entry = kmalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		return;
+	entry->buf = kasprintf(GFP_KERNEL, "probe %s %s", drv, dev);
+	if (!entry->buf) {
+		kfree(entry);
+		return;
+	}
+	entry->duration = duration;
+	sec_bootstat_add_device_init(entry);
+}
+
 void sec_enhanced_boot_stat_record(const char *buf)
 {
 	unsigned long long t = 0;
@@ -271,11 +301,13 @@ static int sec_boot_stat_proc_show(struct seq_file *m, void *v)
 	} while (i > 0 && i < ARRAY_SIZE(boot_events));
 	
 	seq_puts(m, "---------------------------------------------------------------------------------------------------------\n");		
-	seq_printf(m, "device init time over %d ms\n\n",
-			DEVICE_INIT_TIME_100MS / 1000);
+	seq_printf(m, "device init time over %d ms, probe time over %d ms\n\n",
+			DEVICE_INIT_TIME_100MS / 1000, DEVICE_PROBE_TIME_10MS / 1000);
 	
+	mutex_lock(&device_init_time_lock);
 	list_for_each_entry (entry, &device_init_time_list, next)
 		seq_printf(m, "%-20s : %lld usces\n", entry->buf, entry->duration);
+	mutex_unlock(&device_init_time_lock);
 
 	seq_puts(m, "---------------------------------------------------------------------------------------------------------\n");		
 	seq_puts(m, "SystemServer services that took long time\n\n");
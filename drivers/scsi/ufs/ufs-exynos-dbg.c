@@ -794,6 +794,76 @@ void exynos_ufs_show_uic_info(struct ufs_hba *hba)
 	exynos_ufs_dump_attr(hba, ufs_show_attr);
 }
 
+/* Called with host_lock held from the transfer request completion */
+void exynos_ufs_lat_hist_update(struct ufs_hba *hba, struct ufshcd_lrb *lrbp)
+{
+	struct exynos_ufs *ufs = to_exynos_ufs(hba);
+	s64 us = ktime_us_delta(ktime_get(), lrbp->issue_time_stamp);
+	int mode = lrbp->intr_cmd ? UFS_LAT_MODE_INTR : UFS_LAT_MODE_AGGR;
+	int idx = 0;
+
+	if (us > 0)
+		idx = fls64((u64)us >> UFS_LAT_HIST_MIN_SHIFT);
+	if (idx >= UFS_LAT_HIST_BUCKETS)
+		idx = UFS_LAT_HIST_BUCKETS - 1;
+
+	ufs->debug.lat_hist.cnt[mode][idx]++;
+}
+
+static ssize_t exynos_ufs_lat_hist_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct exynos_ufs *ufs = to_exynos_ufs(hba);
+	static const char * const name[UFS_LAT_MODE_MAX] = { "intr", "aggr" };
+	ssize_t len = 0;
+	int mode, i;
+
+	len += snprintf(buf + len, PAGE_SIZE - len, "%-6s", "us<");
+	for (i = 0; i < UFS_LAT_HIST_BUCKETS - 1; i++)
+		len += snprintf(buf + len, PAGE_SIZE - len, " %8u",
+				1U << (UFS_LAT_HIST_MIN_SHIFT + i));
+	len += snprintf(buf + len, PAGE_SIZE - len, " %8s\n", "max");
+
+	for (mode = 0; mode < UFS_LAT_MODE_MAX; mode++) {
+		len += snprintf(buf + len, PAGE_SIZE - len, "%-6s", name[mode]);
+		for (i = 0; i < UFS_LAT_HIST_BUCKETS; i++)
+			len += snprintf(buf + len, PAGE_SIZE - len, " %8lu",
+					ufs->debug.lat_hist.cnt[mode][i]);
+		len += snprintf(buf + len, PAGE_SIZE - len, "\n");
+	}
+
+	return len;
+}
+
+/* Any write clears the histogram */
+static ssize_t exynos_ufs_lat_hist_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct exynos_ufs *ufs = to_exynos_ufs(hba);
+	unsigned long flags;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	memset(ufs->debug.lat_hist.cnt, 0, sizeof(ufs->debug.lat_hist.cnt));
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	return count;
+}
+
+static void exynos_ufs_init_lat_hist(struct ufs_hba *hba)
+{
+	struct exynos_ufs *ufs = to_exynos_ufs(hba);
+	struct device_attribute *attrs = &ufs->debug.lat_hist.attrs;
+
+	attrs->show = exynos_ufs_lat_hist_show;
+	attrs->store = exynos_ufs_lat_hist_store;
+	sysfs_attr_init(&attrs->attr);
+	attrs->attr.name = "lat_hist";
+	attrs->attr.mode = S_IRUGO | S_IWUSR;
+	if (device_create_file(hba->dev, attrs))
+		dev_err(hba->dev, "Failed to create sysfs for lat_hist\n");
+}
 
 int exynos_ufs_init_dbg(struct ufs_hba *hba)
 {
@@ -805,6 +875,7 @@ int exynos_ufs_init_dbg(struct ufs_hba *hba)
 	ufs->debug.sfr = ufs_log_sfr;
 	ufs->debug.attr = ufs_log_attr;
 	INIT_LIST_HEAD(&ufs->debug.misc.clk_list_head);
+	exynos_ufs_init_lat_hist(hba);
 
 	if (!head || list_empty(head))
 		return 0;
@@ -26,6 +26,8 @@
 #include <linux/regmap.h>
 #include <linux/soc/samsung/exynos-soc.h>
 #include <linux/spinlock.h>
+#include <linux/ems_service.h>
+#include <trace/events/ufs.h>
 
 /*
  * Unipro attribute value
@@ -571,7 +573,9 @@ static void exynos_ufs_set_features(struct ufs_hba *hba, u32 hw_rev)
 	/* caps */
 	hba->caps = UFSHCD_CAP_CLK_GATING |
 			UFSHCD_CAP_HIBERN8_WITH_CLK_GATING |
-			UFSHCD_CAP_INTR_AGGR;
+			UFSHCD_CAP_INTR_AGGR |
+			UFSHCD_CAP_ADAPTIVE_INTR_AGGR |
+			UFSHCD_CAP_HIBERN8_PREDICT;
 
 	/* quirks of common driver */
 	hba->quirks = UFSHCD_QUIRK_PRDT_BYTE_GRAN |
@@ -582,6 +586,181 @@ static void exynos_ufs_set_features(struct ufs_hba *hba, u32 hw_rev)
 	/* quirks of exynos-specific driver */
 }
 
+#define UFS_BOOST_DEPTH		4
+#define UFS_BOOST_HOLD_MS	100
+
+/* Brings pm_qos in line with the requested boost state */
+static void exynos_ufs_boost_apply(struct exynos_ufs *ufs)
+{
+	struct exynos_ufs_boost *boost = &ufs->boost;
+	struct ufs_hba *hba = ufs->hba;
+	unsigned long flags;
+	bool boosted;
+	s64 lat = 0;
+
+	mutex_lock(&boost->lock);
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	boosted = boost->boosted;
+	if (boosted)
+		lat = ktime_us_delta(ktime_get(), boost->busy_start);
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	if (boosted == boost->applied)
+		goto out;
+
+	pm_qos_update_request(&boost->pm_qos_int, boosted ? boost->int_value : 0);
+	pm_qos_update_request(&boost->pm_qos_fsys0, boosted ? boost->fsys0_value : 0);
+	boost->applied = boosted;
+
+	if (boosted) {
+		boost->up_cnt++;
+		boost->up_lat_us = lat;
+		boost->up_lat_max_us = max(boost->up_lat_max_us, lat);
+	}
+	trace_ufshcd_profile_clk_scaling(dev_name(hba->dev),
+			boosted ? "boost up" : "boost down", lat, 0);
+out:
+	mutex_unlock(&boost->lock);
+}
+
+static void exynos_ufs_boost_up_work(struct work_struct *work)
+{
+	struct exynos_ufs *ufs = container_of(work, struct exynos_ufs,
+						boost.up_work);
+
+	exynos_ufs_boost_apply(ufs);
+	mod_delayed_work(system_wq, &ufs->boost.down_work,
+			msecs_to_jiffies(ufs->boost.hold_ms));
+}
+
+static void exynos_ufs_boost_down_work(struct work_struct *work)
+{
+	struct exynos_ufs *ufs = container_of(to_delayed_work(work),
+						struct exynos_ufs, boost.down_work);
+	struct exynos_ufs_boost *boost = &ufs->boost;
+	struct ufs_hba *hba = ufs->hba;
+	unsigned long flags, quiet_end;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	quiet_end = boost->last_busy + msecs_to_jiffies(boost->hold_ms);
+	if (boost->boosted && time_before(jiffies, quiet_end)) {
+		spin_unlock_irqrestore(hba->host->host_lock, flags);
+		mod_delayed_work(system_wq, &boost->down_work,
+				quiet_end - jiffies);
+		return;
+	}
+	boost->boosted = false;
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	exynos_ufs_boost_apply(ufs);
+}
+
+/* Called with host_lock held before the request rings the doorbell */
+static void exynos_ufs_boost_check(struct exynos_ufs *ufs,
+				struct ufs_hba *hba)
+{
+	struct exynos_ufs_boost *boost = &ufs->boost;
+
+	if (!boost->enabled)
+		return;
+
+	boost->last_busy = jiffies;
+	if (boost->boosted)
+		return;
+
+	if (!hba->outstanding_reqs)
+		boost->busy_start = ktime_get();
+
+	if (hweight_long(hba->outstanding_reqs) + 1 >= boost->depth ||
+			ems_task_is_topapp(current)) {
+		boost->boosted = true;
+		queue_work(system_highpri_wq, &boost->up_work);
+	}
+}
+
+static void exynos_ufs_boost_stop(struct exynos_ufs *ufs)
+{
+	struct exynos_ufs_boost *boost = &ufs->boost;
+	unsigned long flags;
+
+	if (!boost->int_value && !boost->fsys0_value)
+		return;
+
+	cancel_work_sync(&boost->up_work);
+	cancel_delayed_work_sync(&boost->down_work);
+
+	spin_lock_irqsave(ufs->hba->host->host_lock, flags);
+	boost->boosted = false;
+	spin_unlock_irqrestore(ufs->hba->host->host_lock, flags);
+
+	exynos_ufs_boost_apply(ufs);
+}
+
+static ssize_t exynos_ufs_boost_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct exynos_ufs_boost *boost = &to_exynos_ufs(hba)->boost;
+
+	return snprintf(buf, PAGE_SIZE,
+			"enable:%d depth:%u hold_ms:%u int:%d fsys0:%d boosted:%d up:%lu up_lat_us:%lld up_lat_max_us:%lld\n",
+			boost->enabled, boost->depth, boost->hold_ms,
+			boost->int_value, boost->fsys0_value, boost->applied,
+			boost->up_cnt, boost->up_lat_us, boost->up_lat_max_us);
+}
+
+/* "<enable> [depth hold_ms]" */
+static ssize_t exynos_ufs_boost_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct exynos_ufs *ufs = to_exynos_ufs(hba);
+	struct exynos_ufs_boost *boost = &ufs->boost;
+	u32 enable, depth, hold_ms;
+	unsigned long flags;
+	int ret;
+
+	ret = sscanf(buf, "%u %u %u", &enable, &depth, &hold_ms);
+	if (ret != 1 && ret != 3)
+		return -EINVAL;
+	if (ret == 3 && !depth)
+		return -EINVAL;
+
+	if (!boost->int_value && !boost->fsys0_value)
+		return -ENODEV;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	boost->enabled = !!enable;
+	if (ret == 3) {
+		boost->depth = depth;
+		boost->hold_ms = hold_ms;
+	}
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	if (!enable)
+		exynos_ufs_boost_stop(ufs);
+
+	return count;
+}
+
+static void exynos_ufs_init_boost(struct exynos_ufs *ufs)
+{
+	struct exynos_ufs_boost *boost = &ufs->boost;
+
+	mutex_init(&boost->lock);
+	INIT_WORK(&boost->up_work, exynos_ufs_boost_up_work);
+	INIT_DELAYED_WORK(&boost->down_work, exynos_ufs_boost_down_work);
+	boost->enabled = boost->int_value || boost->fsys0_value;
+
+	boost->attrs.show = exynos_ufs_boost_show;
+	boost->attrs.store = exynos_ufs_boost_store;
+	sysfs_attr_init(&boost->attrs.attr);
+	boost->attrs.attr.name = "boost";
+	boost->attrs.attr.mode = S_IRUGO | S_IWUSR;
+	if (device_create_file(ufs->dev, &boost->attrs))
+		dev_err(ufs->dev, "Failed to create sysfs for boost\n");
+}
+
 /*
  * Exynos-specific callback functions
  *
@@ -639,6 +818,8 @@ static int exynos_ufs_init(struct ufs_hba *hba)
 
 	ufs->misc_flags = EXYNOS_UFS_MISC_TOGGLE_LOG;
 
+	exynos_ufs_init_boost(ufs);
+
 	return 0;
 }
 
@@ -932,6 +1113,9 @@ static void exynos_ufs_set_nexus_t_xfer_req(struct ufs_hba *hba,
 		type &= ~(1 << tag);
 
 	hci_writel(ufs, type, HCI_UTRL_NEXUS_TYPE);
+
+	if (cmd)
+		exynos_ufs_boost_check(ufs, hba);
 }
 
 static void exynos_ufs_set_nexus_t_task_mgmt(struct ufs_hba *hba, int tag, u8 tm_func)
@@ -1000,6 +1184,7 @@ static int __exynos_ufs_suspend(struct ufs_hba *hba, enum ufs_pm_op pm_op)
 {
 	struct exynos_ufs *ufs = to_exynos_ufs(hba);
 
+	exynos_ufs_boost_stop(ufs);
 	pm_qos_update_request(&ufs->pm_qos_int, 0);
 	pm_qos_update_request(&ufs->pm_qos_fsys0, 0);
 
@@ -1071,6 +1256,12 @@ static int exynos_ufs_crypto_engine_clear(struct ufs_hba *hba,
 	return exynos_ufs_fmp_clear(hba, lrbp);
 }
 
+static void exynos_ufs_compl_xfer_req(struct ufs_hba *hba,
+				struct ufshcd_lrb *lrbp)
+{
+	exynos_ufs_lat_hist_update(hba, lrbp);
+}
+
 static int exynos_ufs_access_control_abort(struct ufs_hba *hba)
 {
 	struct exynos_ufs *ufs = to_exynos_ufs(hba);
@@ -1097,6 +1288,7 @@ static struct ufs_hba_variant_ops exynos_ufs_ops = {
 	.crypto_engine_cfg = exynos_ufs_crypto_engine_cfg,
 	.crypto_engine_clear = exynos_ufs_crypto_engine_clear,
 	.access_control_abort = exynos_ufs_access_control_abort,
+	.compl_xfer_req = exynos_ufs_compl_xfer_req,
 };
 
 static int exynos_ufs_populate_dt_phy(struct device *dev, struct exynos_ufs *ufs)
@@ -1276,6 +1468,18 @@ static int exynos_ufs_populate_dt(struct device *dev, struct exynos_ufs *ufs)
 	if (of_property_read_u32(np, "ufs-pm-qos-fsys0", &ufs->pm_qos_fsys0_value))
 		ufs->pm_qos_fsys0_value = 0;
 
+	if (of_property_read_s32(np, "ufs-pm-qos-int-boost", &ufs->boost.int_value))
+		ufs->boost.int_value = 0;
+
+	if (of_property_read_s32(np, "ufs-pm-qos-fsys0-boost", &ufs->boost.fsys0_value))
+		ufs->boost.fsys0_value = 0;
+
+	if (of_property_read_u32(np, "ufs-boost-depth", &ufs->boost.depth))
+		ufs->boost.depth = UFS_BOOST_DEPTH;
+
+	if (of_property_read_u32(np, "ufs-boost-hold-ms", &ufs->boost.hold_ms))
+		ufs->boost.hold_ms = UFS_BOOST_HOLD_MS;
+
 
 out:
 	return ret;
@@ -1381,10 +1585,14 @@ static int exynos_ufs_probe(struct platform_device *pdev)
 
 	pm_qos_add_request(&ufs->pm_qos_int, PM_QOS_DEVICE_THROUGHPUT, 0);
 	pm_qos_add_request(&ufs->pm_qos_fsys0, PM_QOS_BUS_THROUGHPUT, 0);
+	pm_qos_add_request(&ufs->boost.pm_qos_int, PM_QOS_DEVICE_THROUGHPUT, 0);
+	pm_qos_add_request(&ufs->boost.pm_qos_fsys0, PM_QOS_BUS_THROUGHPUT, 0);
 	if (ufs->tcxo_ex_ctrl)
 		spin_lock_init(&fsys0_tcxo_lock);
 
 	ret = ufshcd_pltfrm_init(pdev, &exynos_ufs_ops);
+	if (!ret)
+		device_enable_async_suspend(dev);
 
 	return ret;
 }
@@ -1395,6 +1603,8 @@ static int exynos_ufs_remove(struct platform_device *pdev)
 
 	ufshcd_pltfrm_exit(pdev);
 
+	pm_qos_remove_request(&ufs->boost.pm_qos_fsys0);
+	pm_qos_remove_request(&ufs->boost.pm_qos_int);
 	pm_qos_remove_request(&ufs->pm_qos_fsys0);
 	pm_qos_remove_request(&ufs->pm_qos_int);
 
@@ -496,11 +496,58 @@ struct exynos_ufs_attr_log {
 	u32 val;
 };
 
+/*
+ * Completion latency of transfer requests, split by whether the request
+ * raised its own interrupt or was aggregated. Bucket 0 is below 32us and
+ * each next bucket doubles, the last one holds the rest.
+ */
+enum exynos_ufs_lat_mode {
+	UFS_LAT_MODE_INTR,
+	UFS_LAT_MODE_AGGR,
+	UFS_LAT_MODE_MAX,
+};
+
+#define UFS_LAT_HIST_MIN_SHIFT	5
+#define UFS_LAT_HIST_BUCKETS	10
+
+struct exynos_ufs_lat_hist {
+	struct device_attribute attrs;
+	unsigned long cnt[UFS_LAT_MODE_MAX][UFS_LAT_HIST_BUCKETS];
+};
+
 struct exynos_ufs_debug {
 	struct exynos_ufs_sfr_log* std_sfr;
 	struct exynos_ufs_sfr_log* sfr;
 	struct exynos_ufs_attr_log* attr;
 	struct exynos_ufs_misc_log misc;
+	struct exynos_ufs_lat_hist lat_hist;
+};
+
+/*
+ * Demand driven boost of INT and FSYS0 above the static pm_qos values.
+ * A queue depth spike or a request from the foreground app raises the
+ * floors at once, and they are released after the host has issued nothing
+ * for hold_ms.
+ */
+struct exynos_ufs_boost {
+	struct device_attribute attrs;
+	struct pm_qos_request pm_qos_int;
+	struct pm_qos_request pm_qos_fsys0;
+	s32 int_value;
+	s32 fsys0_value;
+	u32 depth;
+	u32 hold_ms;
+	bool enabled;
+	bool boosted;		/* requested, protected by host_lock */
+	bool applied;		/* pm_qos updated, protected by lock */
+	struct mutex lock;
+	ktime_t busy_start;
+	unsigned long last_busy;
+	struct work_struct up_work;
+	struct delayed_work down_work;
+	unsigned long up_cnt;
+	s64 up_lat_us;
+	s64 up_lat_max_us;
 };
 
 struct exynos_access_cxt {
@@ -566,6 +613,7 @@ struct exynos_ufs {
 	s32			pm_qos_int_value;
 	struct pm_qos_request	pm_qos_fsys0;
 	s32			pm_qos_fsys0_value;
+	struct exynos_ufs_boost	boost;
 	bool lane1_poweroff;
 	struct ufs_cal_param	*cal_param;
 };
@@ -642,6 +690,8 @@ extern int exynos_ufs_init_dbg(struct ufs_hba *hba);
 extern void exynos_ufs_show_uic_info(struct ufs_hba *hba);
 extern void exynos_ufs_cmd_log_start(struct ufs_hba *hba, struct scsi_cmnd *cmd);
 extern void exynos_ufs_cmd_log_end(struct ufs_hba *hba, int tag);
+extern void exynos_ufs_lat_hist_update(struct ufs_hba *hba,
+					struct ufshcd_lrb *lrbp);
 
 /* TCXO UFS */
 enum shared_resource_owner {
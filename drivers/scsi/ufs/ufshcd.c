@@ -58,6 +58,8 @@
 #define CREATE_TRACE_POINTS
 #include <trace/events/ufs.h>
 
+EXPORT_TRACEPOINT_SYMBOL_GPL(ufshcd_profile_clk_scaling);
+
 #define UFSHCD_REQ_SENSE_SIZE	18
 
 #define UFSHCD_ENABLE_INTRS	(UTP_TRANSFER_REQ_COMPL |\
@@ -105,9 +107,20 @@
 /* Interrupt aggregation default timeout, unit: 40us */
 #define INT_AGGR_DEF_TO	0x01
 
+/* Adaptive interrupt aggregation */
+#define INT_AGGR_LAT_DEPTH	2
+#define INT_AGGR_LAT_BYTES	(16 * 1024)
+#define INT_AGGR_SEQ_BYTES	(128 * 1024)
+#define INT_AGGR_MIN_CNT	2
+
 /* Link Hibernation delay, msecs */
 #define LINK_H8_DELAY  20
 
+/* Gating delay when the idle gap is predicted long, msecs */
+#define LINK_H8_PREDICT_DELAY	1
+/* Default hibern8 break-even, usecs */
+#define LINK_H8_BREAKEVEN	5000
+
 /* UFS link setup retries */
 #define UFS_LINK_SETUP_RETRIES 5
 
@@ -590,6 +603,69 @@ static void ufshcd_init_monitor(struct ufs_hba *hba)
 		dev_err(hba->dev, "Failed to create sysfs for monitor\n");
 }
 
+static ssize_t ufshcd_queue_stats_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "blk_mq:%d issued:%lu busy:%d\n",
+			shost_use_blk_mq(hba->host), hba->queue_stats.issued,
+			atomic_read(&hba->queue_stats.busy));
+}
+
+static void ufshcd_init_queue_stats(struct ufs_hba *hba)
+{
+	hba->queue_stats.attrs.show = ufshcd_queue_stats_show;
+	sysfs_attr_init(&hba->queue_stats.attrs.attr);
+	hba->queue_stats.attrs.attr.name = "queue_stats";
+	hba->queue_stats.attrs.attr.mode = S_IRUGO;
+	if (device_create_file(hba->dev, &hba->queue_stats.attrs))
+		dev_err(hba->dev, "Failed to create sysfs for queue_stats\n");
+}
+
+static ssize_t ufshcd_intr_aggr_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct ufs_intr_aggr *aggr = &hba->intr_aggr;
+
+	return snprintf(buf, PAGE_SIZE,
+			"adaptive:%d cnt:%u tmout:%u depth_avg:%u reconfig:%lu\n",
+			aggr->adaptive, aggr->cnt, aggr->tmout,
+			aggr->depth_avg >> 3, aggr->reconfig);
+}
+
+static ssize_t ufshcd_intr_aggr_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	bool value;
+
+	if (kstrtobool(buf, &value))
+		return -EINVAL;
+
+	if (!ufshcd_is_intr_aggr_allowed(hba))
+		return -EPERM;
+
+	/* Registers follow on the next request issued to an empty queue */
+	hba->intr_aggr.adaptive = value;
+
+	return count;
+}
+
+static void ufshcd_init_intr_aggr(struct ufs_hba *hba)
+{
+	hba->intr_aggr.adaptive = ufshcd_is_intr_aggr_allowed(hba) &&
+			(hba->caps & UFSHCD_CAP_ADAPTIVE_INTR_AGGR);
+	hba->intr_aggr.attrs.show = ufshcd_intr_aggr_show;
+	hba->intr_aggr.attrs.store = ufshcd_intr_aggr_store;
+	sysfs_attr_init(&hba->intr_aggr.attrs.attr);
+	hba->intr_aggr.attrs.attr.name = "intr_aggr";
+	hba->intr_aggr.attrs.attr.mode = S_IRUGO | S_IWUSR;
+	if (device_create_file(hba->dev, &hba->intr_aggr.attrs))
+		dev_err(hba->dev, "Failed to create sysfs for intr_aggr\n");
+}
+
 static inline int ufshcd_enable_irq(struct ufs_hba *hba)
 {
 	int ret = 0;
@@ -1164,6 +1240,54 @@ static inline void ufshcd_disable_intr_aggr(struct ufs_hba *hba)
 	ufshcd_writel(hba, 0, REG_UTP_TRANSFER_REQ_INT_AGG_CONTROL);
 }
 
+/**
+ * ufshcd_adapt_intr_aggr - choose interrupt aggregation for a request
+ * @hba: per adapter instance
+ * @cmd: SCSI command to be issued
+ *
+ * Small requests issued at a shallow queue depth, e.g. random 4K reads, are
+ * latency bound and raise their own interrupt. Other requests are aggregated
+ * with the counter threshold following the average queue depth, so that a
+ * stream of large writes completes with an interrupt per batch. The
+ * aggregation registers are only rewritten while no request is outstanding.
+ *
+ * Returns true if the request should not participate in aggregation.
+ */
+static bool ufshcd_adapt_intr_aggr(struct ufs_hba *hba, struct scsi_cmnd *cmd)
+{
+	struct ufs_intr_aggr *aggr = &hba->intr_aggr;
+	unsigned int depth = hweight_long(READ_ONCE(hba->outstanding_reqs));
+	unsigned int bytes = scsi_bufflen(cmd);
+	unsigned long flags;
+	u8 cnt, tmout;
+
+	aggr->depth_avg = aggr->depth_avg - (aggr->depth_avg >> 3) + depth;
+
+	if (aggr->adaptive) {
+		cnt = clamp_t(unsigned int, aggr->depth_avg >> 3,
+				INT_AGGR_MIN_CNT, hba->nutrs - 1);
+		tmout = bytes >= INT_AGGR_SEQ_BYTES ?
+				INT_AGGR_DEF_TO * 2 : INT_AGGR_DEF_TO;
+	} else {
+		cnt = hba->nutrs - 1;
+		tmout = INT_AGGR_DEF_TO;
+	}
+
+	if (!depth && (cnt != aggr->cnt || tmout != aggr->tmout)) {
+		spin_lock_irqsave(hba->host->host_lock, flags);
+		if (!hba->outstanding_reqs) {
+			ufshcd_config_intr_aggr(hba, cnt, tmout);
+			aggr->cnt = cnt;
+			aggr->tmout = tmout;
+			aggr->reconfig++;
+		}
+		spin_unlock_irqrestore(hba->host->host_lock, flags);
+	}
+
+	return aggr->adaptive && depth < INT_AGGR_LAT_DEPTH &&
+			bytes <= INT_AGGR_LAT_BYTES;
+}
+
 /**
  * ufshcd_enable_run_stop_reg - Enable run-stop registers,
  *			When run-stop registers are set to 1, it indicates the
@@ -1826,6 +1950,7 @@ static void ufshcd_ungate_work(struct work_struct *work)
 					__func__, ret);
 			} else {
 				ufshcd_set_link_active(hba);
+				hba->clk_gating.h8_predict.exits++;
 			}
 		}
 		hba->clk_gating.is_suspended = false;
@@ -1834,6 +1959,44 @@ unblock_reqs:
 	scsi_unblock_requests(hba->host);
 }
 
+/*
+ * Idle gaps are measured from the release that arms the gate work to the next
+ * hold. Host lock must be held.
+ */
+static void ufshcd_h8_predict_end_idle(struct ufs_hba *hba)
+{
+	struct ufs_h8_predict *pred = &hba->clk_gating.h8_predict;
+	u32 gap;
+
+	if (!pred->idle_start)
+		return;
+
+	gap = min_t(s64, ktime_us_delta(ktime_get(), pred->idle_start), U32_MAX);
+	pred->gap_avg_us = pred->gap_avg_us - (pred->gap_avg_us >> 2) + (gap >> 2);
+
+	if (pred->entered && gap < pred->breakeven_us)
+		pred->wrong_long++;
+	else if (!pred->predict_long && gap >= pred->breakeven_us)
+		pred->wrong_short++;
+
+	pred->idle_start = 0;
+	pred->entered = false;
+}
+
+static unsigned long ufshcd_h8_predict_start_idle(struct ufs_hba *hba)
+{
+	struct ufs_h8_predict *pred = &hba->clk_gating.h8_predict;
+
+	pred->idle_start = ktime_get();
+	pred->predict_long = pred->gap_avg_us >= pred->breakeven_us;
+
+	if (pred->enabled && pred->predict_long)
+		return min_t(unsigned long, LINK_H8_PREDICT_DELAY,
+				hba->clk_gating.delay_ms);
+
+	return hba->clk_gating.delay_ms;
+}
+
 /**
  * ufshcd_hold - Enable clocks that were gated earlier due to ufshcd_release.
  * Also, exit from hibern8 mode and set the link as active.
@@ -1849,6 +2012,7 @@ int ufshcd_hold(struct ufs_hba *hba, bool async)
 		goto out;
 	spin_lock_irqsave(hba->host->host_lock, flags);
 	hba->clk_gating.active_reqs++;
+	ufshcd_h8_predict_end_idle(hba);
 
 	if (ufshcd_eh_in_progress(hba)) {
 		spin_unlock_irqrestore(hba->host->host_lock, flags);
@@ -1928,6 +2092,7 @@ static void ufshcd_gate_work(struct work_struct *work)
 	struct ufs_hba *hba = container_of(work, struct ufs_hba,
 			clk_gating.gate_work.work);
 	bool gating_allowed = !ufshcd_can_fake_clkgating(hba);
+	bool h8_entered = false;
 	unsigned long flags;
 
 	spin_lock_irqsave(hba->host->host_lock, flags);
@@ -1973,6 +2138,7 @@ static void ufshcd_gate_work(struct work_struct *work)
 			goto out;
 		}
 		ufshcd_set_link_hibern8(hba);
+		h8_entered = true;
 	}
 
 	if (gating_allowed) {
@@ -1993,6 +2159,10 @@ static void ufshcd_gate_work(struct work_struct *work)
 	 * new requests arriving before the current cancel work is done.
 	 */
 	spin_lock_irqsave(hba->host->host_lock, flags);
+	if (h8_entered) {
+		hba->clk_gating.h8_predict.entries++;
+		hba->clk_gating.h8_predict.entered = true;
+	}
 	if (hba->clk_gating.state == REQ_CLKS_OFF) {
 		hba->clk_gating.state = CLKS_OFF;
 		trace_ufshcd_clk_gating(dev_name(hba->dev),
@@ -2023,7 +2193,7 @@ static void __ufshcd_release(struct ufs_hba *hba)
 	hba->clk_gating.state = REQ_CLKS_OFF;
 	trace_ufshcd_clk_gating(dev_name(hba->dev), hba->clk_gating.state);
 	queue_delayed_work(hba->ufshcd_workq, &hba->clk_gating.gate_work,
-			msecs_to_jiffies(hba->clk_gating.delay_ms));
+			msecs_to_jiffies(ufshcd_h8_predict_start_idle(hba)));
 }
 
 void ufshcd_release(struct ufs_hba *hba)
@@ -2094,6 +2264,42 @@ out:
 	return count;
 }
 
+static ssize_t ufshcd_h8_predict_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct ufs_h8_predict *pred = &hba->clk_gating.h8_predict;
+
+	return snprintf(buf, PAGE_SIZE,
+			"enable:%d breakeven_us:%u gap_avg_us:%u entries:%lu exits:%lu wrong_long:%lu wrong_short:%lu\n",
+			pred->enabled, pred->breakeven_us, pred->gap_avg_us,
+			pred->entries, pred->exits, pred->wrong_long,
+			pred->wrong_short);
+}
+
+/* "<enable> [breakeven_us]" */
+static ssize_t ufshcd_h8_predict_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t count)
+{
+	struct ufs_hba *hba = dev_get_drvdata(dev);
+	struct ufs_h8_predict *pred = &hba->clk_gating.h8_predict;
+	unsigned long flags;
+	u32 enable, breakeven;
+	int ret;
+
+	ret = sscanf(buf, "%u %u", &enable, &breakeven);
+	if (ret < 1 || (ret == 2 && !breakeven))
+		return -EINVAL;
+
+	spin_lock_irqsave(hba->host->host_lock, flags);
+	pred->enabled = !!enable;
+	if (ret == 2)
+		pred->breakeven_us = breakeven;
+	spin_unlock_irqrestore(hba->host->host_lock, flags);
+
+	return count;
+}
+
 static int ufshcd_init_clk_gating(struct ufs_hba *hba)
 {
 	int ret = 0;
@@ -2128,6 +2334,17 @@ static int ufshcd_init_clk_gating(struct ufs_hba *hba)
 	hba->clk_gating.enable_attr.attr.mode = 0644;
 	if (device_create_file(hba->dev, &hba->clk_gating.enable_attr))
 		dev_err(hba->dev, "Failed to create sysfs for clkgate_enable\n");
+
+	hba->clk_gating.h8_predict.enabled = ufshcd_can_hibern8_during_gating(hba) &&
+			(hba->caps & UFSHCD_CAP_HIBERN8_PREDICT);
+	hba->clk_gating.h8_predict.breakeven_us = LINK_H8_BREAKEVEN;
+	hba->clk_gating.h8_predict.attrs.show = ufshcd_h8_predict_show;
+	hba->clk_gating.h8_predict.attrs.store = ufshcd_h8_predict_store;
+	sysfs_attr_init(&hba->clk_gating.h8_predict.attrs.attr);
+	hba->clk_gating.h8_predict.attrs.attr.name = "h8_predict";
+	hba->clk_gating.h8_predict.attrs.attr.mode = 0644;
+	if (device_create_file(hba->dev, &hba->clk_gating.h8_predict.attrs))
+		dev_err(hba->dev, "Failed to create sysfs for h8_predict\n");
 		
 out:
        return ret;		
@@ -2140,6 +2357,7 @@ static void ufshcd_exit_clk_gating(struct ufs_hba *hba)
 	destroy_workqueue(hba->ufshcd_workq);
 	device_remove_file(hba->dev, &hba->clk_gating.delay_attr);
 	device_remove_file(hba->dev, &hba->clk_gating.enable_attr);
+	device_remove_file(hba->dev, &hba->clk_gating.h8_predict.attrs);
 }
 
 #if defined(CONFIG_PM_DEVFREQ)
@@ -2865,8 +3083,10 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 		BUG();
 	}
 
-	if (!down_read_trylock(&hba->clk_scaling_lock))
+	if (!down_read_trylock(&hba->clk_scaling_lock)) {
+		atomic_inc(&hba->queue_stats.busy);
 		return SCSI_MLQUEUE_HOST_BUSY;
+	}
 
 	if ((ufs_shutdown_state == 1) && (cmd->cmnd[0] == START_STOP)) {
 		scsi_block_requests(hba->host);
@@ -2934,7 +3154,10 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 
 	scsi_lun = ufshcd_get_scsi_lun(cmd);
 	lrbp->lun = ufshcd_scsi_to_upiu_lun(scsi_lun);
-	lrbp->intr_cmd = !ufshcd_is_intr_aggr_allowed(hba) ? true : false;
+	if (ufshcd_is_intr_aggr_allowed(hba))
+		lrbp->intr_cmd = ufshcd_adapt_intr_aggr(hba, cmd);
+	else
+		lrbp->intr_cmd = true;
 	lrbp->req_abort_skip = false;
 
 	ufshcd_comp_scsi_upiu(hba, lrbp);
@@ -2957,12 +3180,15 @@ static int ufshcd_queuecommand(struct Scsi_Host *host, struct scsi_cmnd *cmd)
 	exynos_ufs_cmd_log_start(hba, cmd);
 #endif
 	ufshcd_send_command(hba, tag);
+	hba->queue_stats.issued++;
 
 	if (hba->monitor.flag & UFSHCD_MONITOR_LEVEL1)
 		dev_info(hba->dev, "IO issued(%d)\n", tag);
 out_unlock:
 	spin_unlock_irqrestore(hba->host->host_lock, flags);
 out:
+	if (err == SCSI_MLQUEUE_HOST_BUSY)
+		atomic_inc(&hba->queue_stats.busy);
 	up_read(&hba->clk_scaling_lock);
 	return err;
 }
@@ -4865,9 +5091,12 @@ static int ufshcd_make_hba_operational(struct ufs_hba *hba)
 	ufshcd_enable_intr(hba, UFSHCD_ENABLE_INTRS);
 
 	/* Configure interrupt aggregation */
-	if (ufshcd_is_intr_aggr_allowed(hba))
-		ufshcd_config_intr_aggr(hba, hba->nutrs - 1, INT_AGGR_DEF_TO);
-	else
+	if (ufshcd_is_intr_aggr_allowed(hba)) {
+		hba->intr_aggr.cnt = hba->nutrs - 1;
+		hba->intr_aggr.tmout = INT_AGGR_DEF_TO;
+		ufshcd_config_intr_aggr(hba, hba->intr_aggr.cnt,
+				hba->intr_aggr.tmout);
+	} else
 		ufshcd_disable_intr_aggr(hba);
 
 	/* Configure UTRL and UTMRL base address registers */
@@ -5605,6 +5834,7 @@ static void __ufshcd_transfer_req_compl(struct ufs_hba *hba, int reason,
 		cmd = lrbp->cmd;
 		if (cmd) {
 			ufshcd_add_command_trace(hba, index, "complete");
+			ufshcd_vops_compl_xfer_req(hba, lrbp);
 			result = ufshcd_vops_crypto_engine_clear(hba, lrbp);
 			if (result) {
 				dev_err(hba->dev,
@@ -8041,6 +8271,9 @@ static struct scsi_host_template ufshcd_driver_template = {
 	.max_host_blocked	= 1,
 	.skip_settle_delay	= 1,
 	.track_queue_depth	= 1,
+#ifdef CONFIG_SCSI_UFSHCD_BLK_MQ
+	.force_blk_mq		= 1,
+#endif
 };
 
 static int ufshcd_config_vreg_load(struct device *dev, struct ufs_vreg *vreg,
@@ -9864,6 +10097,8 @@ int ufshcd_init(struct ufs_hba *hba, void __iomem *mmio_base, unsigned int irq)
 
 	/* Initialize monitor */
 	ufshcd_init_monitor(hba);
+	ufshcd_init_queue_stats(hba);
+	ufshcd_init_intr_aggr(hba);
 	
 	err = ufshcd_init_clk_gating(hba);
 	if (err) {
@@ -350,6 +350,7 @@ struct ufs_hba_variant_ops {
 					struct scatterlist *, int, int, int);
 	int	(*crypto_engine_clear)(struct ufs_hba *, struct ufshcd_lrb *);
 	int	(*access_control_abort)(struct ufs_hba *);
+	void	(*compl_xfer_req)(struct ufs_hba *, struct ufshcd_lrb *);
 
 };
 
@@ -378,7 +379,36 @@ enum clk_gating_state {
  * @is_enabled: Indicates the current status of clock gating
  * @active_reqs: number of requests that are pending and should be waited for
  * completion before gating clocks.
+ * @h8_predict: idle gap prediction for hibern8 entry
  */
+/**
+ * struct ufs_h8_predict - hibern8 entry driven by predicted idle gaps
+ * @attrs: sysfs attribute
+ * @enabled: gate early only when the predicted idle exceeds break-even
+ * @breakeven_us: idle time from which hibern8 saves more than its exit costs
+ * @gap_avg_us: moving average of recent idle gaps
+ * @idle_start: time the host became idle, zero while busy
+ * @predict_long: the current idle gap was predicted to exceed break-even
+ * @entered: hibern8 was entered during the current idle gap
+ * @entries: hibern8 entries by clock gating
+ * @exits: hibern8 exits by clock ungating
+ * @wrong_long: entered, but the gap ended before break-even
+ * @wrong_short: predicted short, but the gap exceeded break-even
+ */
+struct ufs_h8_predict {
+	struct device_attribute attrs;
+	bool enabled;
+	u32 breakeven_us;
+	u32 gap_avg_us;
+	ktime_t idle_start;
+	bool predict_long;
+	bool entered;
+	unsigned long entries;
+	unsigned long exits;
+	unsigned long wrong_long;
+	unsigned long wrong_short;
+};
+
 struct ufs_clk_gating {
 	struct delayed_work gate_work;
 	struct work_struct ungate_work;
@@ -389,6 +419,7 @@ struct ufs_clk_gating {
 	struct device_attribute enable_attr;
 	bool is_enabled;
 	int active_reqs;
+	struct ufs_h8_predict h8_predict;
 };
 
 struct ufs_saved_pwr_info {
@@ -448,6 +479,37 @@ struct ufs_monitor {
 #define UFSHCD_MONITOR_LEVEL2	(1 << 1)
 };
 
+/**
+ * struct ufs_queue_stats - counts of SCSI command submission, so that blk-mq
+ *			    and legacy I/O paths can be compared
+ * @attrs: sysfs attribute
+ * @issued: commands rung on the doorbell, protected by host_lock
+ * @busy: commands returned to the block layer as host busy
+ */
+struct ufs_queue_stats {
+	struct device_attribute attrs;
+	unsigned long issued;
+	atomic_t busy;
+};
+
+/**
+ * struct ufs_intr_aggr - interrupt aggregation chosen from the I/O pattern
+ * @attrs: sysfs attribute
+ * @adaptive: pick aggregation per request from queue depth and request size
+ * @depth_avg: moving average of outstanding requests at issue, in 1/8 unit
+ * @cnt: counter threshold currently programmed
+ * @tmout: timeout currently programmed, in 40us unit
+ * @reconfig: times the aggregation registers were rewritten
+ */
+struct ufs_intr_aggr {
+	struct device_attribute attrs;
+	bool adaptive;
+	unsigned int depth_avg;
+	u8 cnt;
+	u8 tmout;
+	unsigned long reconfig;
+};
+
 struct ufs_secure_log {
 	unsigned long paddr;
 	u32 *vaddr;
@@ -814,6 +876,19 @@ struct ufs_hba {
 	/* Allow only hibern8 without clk gating */
 #define UFSHCD_CAP_FAKE_CLK_GATING (1 << 6)
 
+	/*
+	 * Small requests at a shallow queue depth bypass interrupt aggregation
+	 * and the aggregation counter follows the queue depth. Effective only
+	 * with UFSHCD_CAP_INTR_AGGR.
+	 */
+#define UFSHCD_CAP_ADAPTIVE_INTR_AGGR (1 << 7)
+
+	/*
+	 * Clock gating enters hibern8 early when the idle gap predicted from
+	 * recent gaps exceeds break-even, and after delay_ms otherwise.
+	 */
+#define UFSHCD_CAP_HIBERN8_PREDICT (1 << 8)
+
 	struct devfreq *devfreq;
 	struct ufs_clk_scaling clk_scaling;
 	bool is_sys_suspended;
@@ -826,6 +901,8 @@ struct ufs_hba {
 	unsigned int lc_info;
 	
 	struct ufs_monitor monitor;
+	struct ufs_queue_stats queue_stats;
+	struct ufs_intr_aggr intr_aggr;
 
 	enum bkops_status urgent_bkops_lvl;
 	bool is_urgent_bkops_lvl_checked;
@@ -1172,6 +1249,13 @@ static inline int ufshcd_vops_crypto_engine_clear(struct ufs_hba *hba,
 	return 0;
 }
 
+static inline void ufshcd_vops_compl_xfer_req(struct ufs_hba *hba,
+					struct ufshcd_lrb *lrbp)
+{
+	if (hba->vops && hba->vops->compl_xfer_req)
+		hba->vops->compl_xfer_req(hba, lrbp);
+}
+
 static inline int ufshcd_vops_access_control_abort(struct ufs_hba *hba)
 {
 	if (hba->vops && hba->vops->access_control_abort)
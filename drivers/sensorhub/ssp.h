@@ -21,6 +21,7 @@
 #include <linux/iio/iio.h>
 #include <linux/wakelock.h>
 #include <linux/rtc.h>
+#include <soc/samsung/exynos-timesync.h>
 
 #include "ssp_type_define.h"
 #include "ssp_platform.h"
@@ -75,6 +76,25 @@ struct sensor_info {
 	int report_data_len;
 };
 
+/* Round trip time of the commands waiting for the response */
+struct ssp_cmd_stat {
+	u64 sent;
+	u64 done;
+	u64 timeout;
+	u64 total_ns;
+	u64 max_ns;
+	unsigned int pending;
+	unsigned int max_pending;
+};
+
+/* Delay from the sample timestamp to the push to iio */
+struct ssp_push_stat {
+	u64 samples;
+	u64 batches;
+	u64 total_ns;
+	u64 max_ns;
+};
+
 enum {
 	RESET_TYPE_KERNEL_NO_EVENT = 0,
 	RESET_TYPE_KERNEL_COM_FAIL,
@@ -257,6 +277,8 @@ struct ssp_data {
 	struct timer_list ts_sync_timer;
 	struct workqueue_struct *ts_sync_wq;
 	struct work_struct work_ts_sync;
+	struct exynos_timesync_client *timesync;
+	u64 ts_sync_last;
 
 	char fw_name[50];
 	int fw_type;
@@ -272,6 +294,8 @@ struct ssp_data {
 	struct mutex comm_mutex;
 	struct mutex pending_mutex;
 	struct list_head pending_list;
+	u32 cmd_seq;
+	struct ssp_cmd_stat cmd_stat;
 	unsigned int cnt_timeout;
 	unsigned int cnt_com_fail;
 
@@ -298,6 +322,7 @@ struct ssp_data {
 	uint64_t sensor_probe_state;    /* uSensorState */
 	atomic64_t sensor_en_state;	     /* aSensorEnable */
 	u64 latest_timestamp[SENSOR_TYPE_MAX];
+	struct ssp_push_stat push_stat[SENSOR_TYPE_MAX];
 
 	struct sensor_value buf[SENSOR_TYPE_MAX];
 	struct sensor_delay delay[SENSOR_TYPE_MAX];
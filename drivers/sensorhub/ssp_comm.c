@@ -1,4 +1,5 @@
 
+#include <linux/err.h>
 #include <linux/kernel.h>
 #include <linux/slab.h>
 
@@ -11,6 +12,19 @@
 #define SSP_CMD_SIZE 64
 #define SSP_MSG_HEADER_SIZE 13
 
+/* should be called with pending_mutex held */
+static void ssp_cmd_stat_done(struct ssp_data *data, struct ssp_msg *msg)
+{
+	struct ssp_cmd_stat *stat = &data->cmd_stat;
+	u64 rtt = get_current_timestamp() - msg->timestamp;
+
+	stat->done++;
+	stat->pending--;
+	stat->total_ns += rtt;
+	if (stat->max_ns < rtt)
+		stat->max_ns = rtt;
+}
+
 void handle_packet(struct ssp_data *data, char *packet, int packet_size)
 {
 	u16 msg_length = 0;
@@ -45,9 +59,11 @@ void handle_packet(struct ssp_data *data, char *packet, int packet_size)
 			list_for_each_entry_safe(msg, n,
 			                         &data->pending_list, list) {
 
+				/* the oldest outstanding one of the same command */
 				if ((msg->cmd == msg_cmd) && (msg->type == msg_type) &&
 				    (msg->subcmd == msg_subcmd)) {
-					list_del(&msg->list);
+					list_del_init(&msg->list);
+					ssp_cmd_stat_done(data, msg);
 					found = true;
 					break;
 				}
@@ -95,10 +111,16 @@ exit:
 
 static char ssp_cmd_data[SSP_CMD_SIZE];
 
-static int do_transfer(struct ssp_data *data, struct ssp_msg *msg, int timeout)
+/*
+ * Write the command to the hub. The command waiting for the response is put
+ * on the pending list before the write and it is matched by handle_packet(),
+ * so that more commands can be written while the response is on the way.
+ */
+static int ssp_submit_msg(struct ssp_data *data, struct ssp_msg *msg,
+                          int timeout)
 {
+	struct ssp_cmd_stat *stat = &data->cmd_stat;
 	int status = 0;
-	int ret = 0;
 	bool is_ssp_shutdown;
 
 	mutex_lock(&data->comm_mutex);
@@ -109,19 +131,25 @@ static int do_transfer(struct ssp_data *data, struct ssp_msg *msg, int timeout)
 		return -EIO;
 	}
 
+	if (msg->length > (SSP_CMD_SIZE - SSP_MSG_HEADER_SIZE)) {
+		ssp_errf("command size over !");
+		mutex_unlock(&data->comm_mutex);
+		return -EINVAL;
+	}
+
 	msg->timestamp = get_current_timestamp();
 	memcpy(ssp_cmd_data, msg, SSP_MSG_HEADER_SIZE);
 	if (msg->length > 0) {
 		memcpy(&ssp_cmd_data[SSP_MSG_HEADER_SIZE], msg->buffer, msg->length);
-	} else if (msg->length > (SSP_CMD_SIZE - SSP_MSG_HEADER_SIZE)) {
-		ssp_errf("command size over !");
-		mutex_unlock(&data->comm_mutex);
-		return -EINVAL;
 	}
 
 	if (msg->done != NULL) {
 		mutex_lock(&data->pending_mutex);
+		msg->seq = data->cmd_seq++;
 		list_add_tail(&msg->list, &data->pending_list);
+		stat->sent++;
+		if (++stat->pending > stat->max_pending)
+			stat->max_pending = stat->pending;
 		mutex_unlock(&data->pending_mutex);
 	}
 
@@ -130,51 +158,69 @@ static int do_transfer(struct ssp_data *data, struct ssp_msg *msg, int timeout)
 	if (status < 0 && msg->done != NULL) {
 		ssp_errf("comm write fail!!");
 		mutex_lock(&data->pending_mutex);
-		list_del(&msg->list);
+		if (!list_empty(&msg->list)) {
+			list_del_init(&msg->list);
+			stat->pending--;
+		}
 		mutex_unlock(&data->pending_mutex);
-
-		goto exit;
 	}
 
-exit:
 	mutex_unlock(&data->comm_mutex);
 	if (status < 0) {
 		is_ssp_shutdown = !is_sensorhub_working(data);
 		data->cnt_com_fail += (is_ssp_shutdown)? 0 : 1;
 		ssp_errf("cnt_com_fail %d , ssp_down %d ", data->cnt_com_fail, is_ssp_shutdown);
-		return status;
 	}
 
-	if ((status >= 0) && (msg->done != NULL) && (timeout > 0)) {
-		ret = wait_for_completion_timeout(msg->done,
-		                                  msecs_to_jiffies(timeout));
+	return status;
+}
 
-		if (msg->clean_pending_list_flag) {
-			ssp_errf("clean_pending_list_flag %d", msg->clean_pending_list_flag);
-			msg->clean_pending_list_flag = 0;
-			return -EINVAL;
-		}
+static int ssp_wait_msg(struct ssp_data *data, struct ssp_msg *msg, int timeout)
+{
+	bool is_ssp_shutdown;
 
-		/* when timeout happen */
-		if (!ret) {
-			msg->done = NULL;
-			list_del(&msg->list);
-			is_ssp_shutdown = !is_sensorhub_working(data);
-			data->cnt_timeout += (is_ssp_shutdown)? 0 : 1;
-			if (msg->done != NULL) {
-				list_del(&msg->list);
-			}
+	wait_for_completion_timeout(msg->done, msecs_to_jiffies(timeout));
 
-			ssp_errf("cnt_timeout %d, ssp_down %d !!",
-			         data->cnt_timeout, is_ssp_shutdown);
-			return -EINVAL;
-		}
+	mutex_lock(&data->pending_mutex);
+	if (msg->clean_pending_list_flag) {
+		mutex_unlock(&data->pending_mutex);
+		ssp_errf("clean_pending_list_flag %d", msg->clean_pending_list_flag);
+		msg->clean_pending_list_flag = 0;
+		return -EINVAL;
 	}
 
-	return status;
+	/* when timeout happen, the response is not matched yet */
+	if (!list_empty(&msg->list)) {
+		list_del_init(&msg->list);
+		data->cmd_stat.pending--;
+		data->cmd_stat.timeout++;
+		mutex_unlock(&data->pending_mutex);
+
+		is_ssp_shutdown = !is_sensorhub_working(data);
+		data->cnt_timeout += (is_ssp_shutdown)? 0 : 1;
+		ssp_errf("cnt_timeout %d, ssp_down %d !! (seq %u)",
+		         data->cnt_timeout, is_ssp_shutdown, msg->seq);
+		return -EINVAL;
+	}
+	mutex_unlock(&data->pending_mutex);
+
+	return 0;
 }
 
+static int do_transfer(struct ssp_data *data, struct ssp_msg *msg, int timeout)
+{
+	int status;
+
+	status = ssp_submit_msg(data, msg, timeout);
+	if ((status >= 0) && (msg->done != NULL) && (timeout > 0)) {
+		int ret = ssp_wait_msg(data, msg, timeout);
 
+		if (ret < 0)
+			status = ret;
+	}
+
+	return status;
+}
 
 static void clean_msg(struct ssp_msg *msg)
 {
@@ -193,59 +239,60 @@ void clean_pending_list(struct ssp_data *data)
 	mutex_lock(&data->pending_mutex);
 	list_for_each_entry_safe(msg, n, &data->pending_list, list) {
 
-		list_del(&msg->list);
+		list_del_init(&msg->list);
 		if (msg->done != NULL && !completion_done(msg->done)) {
 			msg->clean_pending_list_flag = 1;
 			complete(msg->done);
 		}
 	}
+	data->cmd_stat.pending = 0;
 	mutex_unlock(&data->pending_mutex);
 }
 
-int ssp_send_command(struct ssp_data *data, u8 cmd, u8 type, u8 subcmd,
-                     int timeout, char *send_buf, int send_buf_len, char **receive_buf,
-                     int *receive_buf_len)
+static struct ssp_msg *ssp_create_msg(struct ssp_data *data, u8 cmd, u8 type,
+                                      u8 subcmd, bool wait, char *send_buf,
+                                      int send_buf_len)
 {
-	int status = 0;
 	struct ssp_msg *msg;
-	DECLARE_COMPLETION_ONSTACK(done);
 
 	if ((type < SENSOR_TYPE_MAX) && !(data->sensor_probe_state& (1ULL << type))) {
 		ssp_infof("Skip this function!, sensor is not connected(0x%llx)", data->sensor_probe_state);
-		return -ENODEV;
+		return ERR_PTR(-ENODEV);
 	}
 	msg = kzalloc(sizeof(*msg), GFP_KERNEL);
+	if (!msg)
+		return ERR_PTR(-ENOMEM);
 	msg->cmd = cmd;
 	msg->type = type;
 	msg->subcmd = subcmd;
 	msg->length = send_buf_len;
+	INIT_LIST_HEAD(&msg->list);
 
-	if (timeout > 0) {
-		if (send_buf != NULL && send_buf_len != 0) {
-			msg->buffer = kzalloc(send_buf_len, GFP_KERNEL);
-			memcpy(msg->buffer, send_buf, send_buf_len);
-		} else {
-			msg->length = 0;
+	if (send_buf != NULL && send_buf_len != 0) {
+		msg->buffer = kzalloc(send_buf_len, GFP_KERNEL);
+		if (!msg->buffer) {
+			kfree(msg);
+			return ERR_PTR(-ENOMEM);
 		}
-		msg->done = &done;
+		memcpy(msg->buffer, send_buf, send_buf_len);
 	} else {
-		if (send_buf != NULL && send_buf_len != 0) {
-			msg->buffer = kzalloc(send_buf_len, GFP_KERNEL);
-			memcpy(msg->buffer, send_buf, send_buf_len);
-		} else {
-			msg->length = 0;
-		}
-		msg->done = NULL;
+		msg->length = 0;
 	}
 
-	ssp_infof("cmd %d type %d subcmd %d send_buf_len %d timeout %d", cmd, type,
-	          subcmd, send_buf_len, timeout);
-
-	if (do_transfer(data, msg, timeout) < 0) {
-		ssp_errf("do_transfer error");
-		status = ERROR;
+	if (wait) {
+		init_completion(&msg->completion);
+		msg->done = &msg->completion;
+	} else {
+		msg->done = NULL;
 	}
 
+	return msg;
+}
+
+static int ssp_finish_msg(struct ssp_data *data, struct ssp_msg *msg,
+                          int status, int timeout, char **receive_buf,
+                          int *receive_buf_len)
+{
 	//mutex_lock(&data->cmd_mutex);
 	if (((msg->cmd == CMD_GETVALUE) && (receive_buf != NULL) &&
 	     ((receive_buf_len != NULL) && (msg->length != 0))) &&
@@ -256,6 +303,7 @@ int ssp_send_command(struct ssp_data *data, u8 cmd, u8 type, u8 subcmd,
 			memcpy(*receive_buf, msg->buffer, msg->length);
 		} else {
 			ssp_errf("CMD_GETVALUE zero timeout");
+			clean_msg(msg);
 			//mutex_unlock(&data->cmd_mutex);
 			return -EINVAL;
 		}
@@ -271,6 +319,77 @@ int ssp_send_command(struct ssp_data *data, u8 cmd, u8 type, u8 subcmd,
 	return status;
 }
 
+int ssp_send_command(struct ssp_data *data, u8 cmd, u8 type, u8 subcmd,
+                     int timeout, char *send_buf, int send_buf_len, char **receive_buf,
+                     int *receive_buf_len)
+{
+	int status = 0;
+	struct ssp_msg *msg;
+
+	msg = ssp_create_msg(data, cmd, type, subcmd, timeout > 0, send_buf,
+	                     send_buf_len);
+	if (IS_ERR(msg))
+		return PTR_ERR(msg);
+
+	ssp_infof("cmd %d type %d subcmd %d send_buf_len %d timeout %d", cmd, type,
+	          subcmd, send_buf_len, timeout);
+
+	if (do_transfer(data, msg, timeout) < 0) {
+		ssp_errf("do_transfer error");
+		status = ERROR;
+	}
+
+	return ssp_finish_msg(data, msg, status, timeout, receive_buf,
+	                      receive_buf_len);
+}
+
+/*
+ * Write the command waiting for the response and return without waiting.
+ * The response is received by ssp_wait_command() with the returned message,
+ * so that the caller writes other commands in the meantime. Commands are
+ * matched to the responses in the order written.
+ */
+struct ssp_msg *ssp_send_command_async(struct ssp_data *data, u8 cmd, u8 type,
+                                       u8 subcmd, char *send_buf, int send_buf_len)
+{
+	struct ssp_msg *msg;
+	int ret;
+
+	msg = ssp_create_msg(data, cmd, type, subcmd, true, send_buf,
+	                     send_buf_len);
+	if (IS_ERR(msg))
+		return msg;
+
+	ssp_infof("cmd %d type %d subcmd %d send_buf_len %d seq %u", cmd, type,
+	          subcmd, send_buf_len, data->cmd_seq);
+
+	ret = ssp_submit_msg(data, msg, 0);
+	if (ret < 0) {
+		ssp_errf("do_transfer error");
+		ssp_finish_msg(data, msg, ERROR, 0, NULL, NULL);
+		return ERR_PTR(ret);
+	}
+
+	return msg;
+}
+
+int ssp_wait_command(struct ssp_data *data, struct ssp_msg *msg, int timeout,
+                     char **receive_buf, int *receive_buf_len)
+{
+	int status = 0;
+
+	if (IS_ERR_OR_NULL(msg))
+		return msg ? PTR_ERR(msg) : -EINVAL;
+
+	if (ssp_wait_msg(data, msg, timeout) < 0) {
+		ssp_errf("do_transfer error");
+		status = ERROR;
+	}
+
+	return ssp_finish_msg(data, msg, status, timeout, receive_buf,
+	                      receive_buf_len);
+}
+
 static void get_tm(struct rtc_time *tm)
 {
 	struct timespec ts;
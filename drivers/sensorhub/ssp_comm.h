@@ -22,6 +22,9 @@ struct ssp_msg {
 	bool clean_pending_list_flag;
 	struct completion *done;
 	struct list_head list;
+	/* not sent, for asynchronous command */
+	u32 seq;
+	struct completion completion;
 } __attribute__((__packed__));
 
 void handle_packet(struct ssp_data *, char *, int);
@@ -32,6 +35,11 @@ int ssp_send_command(struct ssp_data *data, u8 cmd, u8 type, u8 subcmd,
                      int timeout, char *send_buf, int send_buf_len, char **receive_buf,
                      int *receive_buf_len);
 
+struct ssp_msg *ssp_send_command_async(struct ssp_data *data, u8 cmd, u8 type,
+                                       u8 subcmd, char *send_buf, int send_buf_len);
+int ssp_wait_command(struct ssp_data *data, struct ssp_msg *msg, int timeout,
+                     char **receive_buf, int *receive_buf_len);
+
 void clean_pending_list(struct ssp_data *data);
 int ssp_send_status(struct ssp_data *data, char command);
 
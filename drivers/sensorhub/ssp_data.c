@@ -51,6 +51,9 @@ typedef enum _hub_req_reset_type {
 #define U64_US2NS 1000ULL
 
 #define SSP_TIMESTAMP_SYNC_TIMER_SEC     (30 * HZ)
+/* the hub is resynced at once when it is that far ahead, once a second */
+#define SSP_TIMESTAMP_SYNC_AHEAD_NS      (1000000ULL)
+#define SSP_TIMESTAMP_SYNC_MIN_NS        (1000000000ULL)
 
 /* fw */
 #define SSP_INVALID_REVISION	    99999
@@ -75,6 +78,7 @@ void get_timestamp(struct ssp_data *data, char *dataframe,
 	memset(&timestamp_ns, 0, 8);
 	memcpy(&timestamp_ns, dataframe + *ptr_data, 8);
 
+	check_timestamp(data, timestamp_ns, current_timestamp);
 	if (timestamp_ns > current_timestamp) {
 		//ssp_infof("future timestamp(%d) : last = %lld, cur = %lld", type, data->latest_timestamp[type], current_timestamp);
 		timestamp_ns = current_timestamp;
@@ -236,6 +240,22 @@ int parse_dataframe(struct ssp_data *data, char *dataframe, int frame_len)
 			index += 2;
 			batch_event_count = length;
 
+			if (batch_event_count > 1 && is_bulk_report_sensor(data, type)) {
+				int sample_len = data->info[type].get_data_len + 8;
+				int count = min_t(int, batch_event_count,
+				                  (frame_len - index) / sample_len);
+
+				if (count > 0) {
+					report_sensor_data_bulk(data, type,
+					                        dataframe + index, count);
+					index += count * sample_len;
+					batch_event_count -= count;
+				}
+				if (batch_event_count > 0)
+					ssp_errf("batch count error (%d)", batch_event_count);
+				break;
+			}
+
 			do {
 				get_sensordata(data, dataframe, &index, type, &event);
 				get_timestamp(data, dataframe, &index, &event, type);
@@ -383,15 +403,21 @@ int get_sensor_scanning_info(struct ssp_data *data)
 	return ret;
 }
 
-int get_firmware_rev(struct ssp_data *data)
+/*
+ * pending is VERSION_INFO sent by ssp_send_command_async() before, or NULL to
+ * send it now.
+ */
+int get_firmware_rev(struct ssp_data *data, struct ssp_msg *pending)
 {
 	int ret;
 	u32 result = SSP_INVALID_REVISION;
 	char *buffer = NULL;
 	int buffer_length;
 
-	ret = ssp_send_command(data, CMD_GETVALUE, TYPE_MCU, VERSION_INFO, 1000, NULL,
-			       0, &buffer, &buffer_length);
+	if (!pending)
+		pending = ssp_send_command_async(data, CMD_GETVALUE, TYPE_MCU,
+						 VERSION_INFO, NULL, 0);
+	ret = ssp_wait_command(data, pending, 1000, &buffer, &buffer_length);
 
 	if (ret != SUCCESS)
 		ssp_errf("transfer fail %d", ret);
@@ -1248,11 +1274,27 @@ int get_sensorname(struct ssp_data *data, int sensor_type, char *name, int size)
 	return SUCCESS;
 }
 
+/*
+ * The hub timestamps are kept as the drift of the "chub" timesync client.
+ * The offset includes the latency of the dataframe, so a timestamp from the
+ * future means the hub clock has drifted ahead, and it is resynced then
+ * instead of waiting for the timer.
+ */
+void check_timestamp(struct ssp_data *data, u64 timestamp, u64 current_timestamp)
+{
+	exynos_timesync_sample(data->timesync, current_timestamp, timestamp);
+
+	if (timestamp > current_timestamp + SSP_TIMESTAMP_SYNC_AHEAD_NS &&
+	    current_timestamp > READ_ONCE(data->ts_sync_last) + SSP_TIMESTAMP_SYNC_MIN_NS)
+		queue_work(data->ts_sync_wq, &data->work_ts_sync);
+}
+
 static void timestamp_sync_work_func(struct work_struct *work)
 {
 	struct ssp_data *data = container_of(work, struct ssp_data, work_ts_sync);
 	int ret;
 
+	WRITE_ONCE(data->ts_sync_last, get_current_timestamp());
 	ret = ssp_send_command(data, CMD_SETVALUE, TYPE_MCU, RTC_TIME, 0,
 			       NULL, 0, NULL, NULL);
 	if (ret != SUCCESS) {
@@ -1291,6 +1333,7 @@ int initialize_timestamp_sync_timer(struct ssp_data *data)
 		return -ENOMEM;
 
 	INIT_WORK(&data->work_ts_sync, timestamp_sync_work_func);
+	data->timesync = exynos_timesync_register("chub");
 	return 0;
 }
 
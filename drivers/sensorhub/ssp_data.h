@@ -16,12 +16,14 @@
 #define __SSP_DATA_H__
 #include "ssp.h"
 
+struct ssp_msg;
+
 u64 get_current_timestamp(void);
 
 int parse_dataframe(struct ssp_data *, char *, int);
 
 int get_sensor_scanning_info(struct ssp_data *data);
-int get_firmware_rev(struct ssp_data *data);
+int get_firmware_rev(struct ssp_data *data, struct ssp_msg *pending);
 int set_sensor_position(struct ssp_data *data);
 u64 get_current_timestamp(void);
 
@@ -31,6 +33,7 @@ int initialize_timestamp_sync_timer(struct ssp_data *);
 
 void get_sensordata(struct ssp_data *, char *, int *, int, struct sensor_value *);
 void get_timestamp(struct ssp_data *, char *, int *, struct sensor_value *, int);
+void check_timestamp(struct ssp_data *data, u64 timestamp, u64 current_timestamp);
 
 int get_sensorname(struct ssp_data *data, int sensor_type, char* name, int size);
 
@@ -148,6 +148,7 @@ int initialize_magnetic_sensor(struct ssp_data *data)
 
 int initialize_mcu(struct ssp_data *data)
 {
+	struct ssp_msg *fw_rev_msg;
 	int ret = 0;
 
 	//ssp_dbgf();
@@ -163,15 +164,20 @@ int initialize_mcu(struct ssp_data *data)
 		return FAIL;
 	}
 
+	/* the hub answers the revision while iio devices are created */
+	fw_rev_msg = ssp_send_command_async(data, CMD_GETVALUE, TYPE_MCU,
+					    VERSION_INFO, NULL, 0);
+
 	if (data->cnt_reset == 0) {
 		ret = initialize_indio_dev(data->dev, data);
 		if (ret < 0) {
 			ssp_errf("could not create input device");
+			get_firmware_rev(data, fw_rev_msg);
 			return FAIL;
 		}
 	}
 
-	ret = get_firmware_rev(data);
+	ret = get_firmware_rev(data, fw_rev_msg);
 	if (ret < 0)     {
 		ssp_errf("get firmware rev");
 		return FAIL;
@@ -538,6 +544,7 @@ err_sysfs_create:
 	destroy_workqueue(data->debug_wq);
 err_create_ts_sync_workqueue:
 	destroy_workqueue(data->ts_sync_wq);
+	exynos_timesync_unregister(data->timesync);
 err_create_workqueue:
 	wake_lock_destroy(&data->ssp_wake_lock);
 	mutex_destroy(&data->comm_mutex);
@@ -580,6 +587,7 @@ void ssp_remove(struct ssp_data *data)
 	del_timer(&data->ts_sync_timer);
 	cancel_work(&data->work_ts_sync);
 	destroy_workqueue(data->ts_sync_wq);
+	exynos_timesync_unregister(data->timesync);
 	wake_lock_destroy(&data->ssp_wake_lock);
 	mutex_destroy(&data->comm_mutex);
 	mutex_destroy(&data->pending_mutex);
@@ -19,6 +19,7 @@
 #include <linux/iio/kfifo_buf.h>
 #include <linux/iio/sysfs.h>
 #include <linux/iio/types.h>
+#include <linux/poll.h>
 #include <linux/slab.h>
 
 #include "ssp.h"
@@ -103,6 +104,23 @@ static void ssp_iio_push_buffers(struct iio_dev *indio_dev, u64 timestamp,
 	mutex_unlock(&indio_dev->mlock);
 }
 
+static void ssp_iio_update_push_stat(struct ssp_data *data, int type,
+                                     u64 timestamp, u64 current_timestamp)
+{
+	struct ssp_push_stat *stat = &data->push_stat[type];
+	u64 latency = 0;
+
+	if (current_timestamp > timestamp) {
+		latency = current_timestamp - timestamp;
+	}
+
+	stat->samples++;
+	stat->total_ns += latency;
+	if (stat->max_ns < latency) {
+		stat->max_ns = latency;
+	}
+}
+
 #ifdef CONFIG_SENSORS_SSP_PROXIMITY
 static void report_prox_raw_data(struct ssp_data *data, int type,
                                  struct sensor_value *proxrawdata)
@@ -231,6 +249,9 @@ void report_sensor_data(struct ssp_data *data, int type,
 		return;
 	}
 
+	ssp_iio_update_push_stat(data, type, event->timestamp,
+	                         get_current_timestamp());
+	data->push_stat[type].batches++;
 	ssp_iio_push_buffers(data->indio_devs[type], event->timestamp,
 	                     (char *)&data->buf[type], data->info[type].report_data_len);
 
@@ -242,6 +263,101 @@ void report_sensor_data(struct ssp_data *data, int type,
 	}
 }
 
+/*
+ * Sensors of which the sample in the dataframe is the iio scan as it is, and
+ * which need no handling per sample in report_sensor_data().
+ */
+bool is_bulk_report_sensor(struct ssp_data *data, int type)
+{
+	switch (type) {
+	case SENSOR_TYPE_PROXIMITY:
+	case SENSOR_TYPE_PROXIMITY_RAW:
+	case SENSOR_TYPE_PROXIMITY_CALIBRATION:
+	case SENSOR_TYPE_LIGHT:
+	case SENSOR_TYPE_LIGHT_CCT:
+	case SENSOR_TYPE_LIGHT_AUTOBRIGHTNESS:
+	case SENSOR_TYPE_STEP_COUNTER:
+	case SENSOR_TYPE_SIGNIFICANT_MOTION:
+	case SENSOR_TYPE_TILT_DETECTOR:
+	case SENSOR_TYPE_PICK_UP_GESTURE:
+	case SENSOR_TYPE_WAKE_UP_MOTION:
+		return false;
+	default:
+		break;
+	}
+
+	return data->info[type].get_data_len == data->info[type].report_data_len;
+}
+
+/*
+ * Report a batch of samples of a sensor at once. Each sample is the data of
+ * get_data_len followed by the 64bit timestamp, which is the iio scan of the
+ * sensor, so that the samples are pushed from the dataframe without copy.
+ * Timestamps from the future are clamped to the time of the batch in place.
+ * The kfifo is filled under one lock and readers are woken up once for the
+ * batch.
+ */
+int report_sensor_data_bulk(struct ssp_data *data, int type, char *samples,
+                            int count)
+{
+	struct iio_dev *indio_dev = data->indio_devs[type];
+	struct iio_buffer *buffer;
+	int data_len = data->info[type].get_data_len;
+	int sample_len = data_len + sizeof(u64);
+	u64 current_timestamp = get_current_timestamp();
+	u64 timestamp = 0;
+	char *sample;
+	int i;
+
+	for (i = 0, sample = samples; i < count; i++, sample += sample_len) {
+		memcpy(&timestamp, sample + data_len, sizeof(timestamp));
+		check_timestamp(data, timestamp, current_timestamp);
+		if (timestamp > current_timestamp) {
+			timestamp = current_timestamp;
+			memcpy(sample + data_len, &timestamp, sizeof(timestamp));
+		}
+		ssp_iio_update_push_stat(data, type, timestamp,
+		                         current_timestamp);
+	}
+	data->push_stat[type].batches++;
+
+	/* the last sample is the current value of the sensor */
+	sample = samples + (count - 1) * sample_len;
+	memcpy(&data->buf[type], sample, data_len);
+	data->buf[type].timestamp = timestamp;
+	data->latest_timestamp[type] = current_timestamp;
+
+	if (!(atomic64_read(&data->sensor_en_state) & (1ULL << type)))
+	{
+		ssp_errf("sensor is not enabled(%d)", type);
+		return count;
+	}
+
+	if (!indio_dev) {
+		return count;
+	}
+
+	mutex_lock(&indio_dev->mlock);
+	buffer = indio_dev->buffer;
+	if (list_is_singular(&indio_dev->buffer_list) &&
+	    list_first_entry(&indio_dev->buffer_list, struct iio_buffer,
+	                     buffer_list) == buffer && !buffer->demux_bounce) {
+		for (i = 0, sample = samples; i < count; i++, sample += sample_len) {
+			if (buffer->access->store_to(buffer, sample)) {
+				break;
+			}
+		}
+		wake_up_interruptible_poll(&buffer->pollq, POLLIN | POLLRDNORM);
+	} else {
+		for (i = 0, sample = samples; i < count; i++, sample += sample_len) {
+			iio_push_to_buffers(indio_dev, sample);
+		}
+	}
+	mutex_unlock(&indio_dev->mlock);
+
+	return count;
+}
+
 void report_camera_lux_data(struct ssp_data *data, int lux)
 {
 	int type = SENSOR_TYPE_LIGHT_AUTOBRIGHTNESS;
@@ -24,6 +24,9 @@
 struct sensor_value;
 
 void report_sensor_data(struct ssp_data *, int, struct sensor_value *);
+bool is_bulk_report_sensor(struct ssp_data *data, int type);
+int report_sensor_data_bulk(struct ssp_data *data, int type, char *samples,
+                            int count);
 void report_meta_data(struct ssp_data *, struct sensor_value *);
 int initialize_indio_dev(struct device *dev, struct ssp_data *data);
 void remove_indio_dev(struct ssp_data *data);
@@ -379,6 +379,58 @@ static ssize_t show_reset_info(struct device *dev, struct device_attribute *attr
 	return ret;
 }
 
+static ssize_t cmd_rtt_show(struct device *dev,
+			    struct device_attribute *attr, char *buf)
+{
+	struct ssp_data *data = dev_get_drvdata(dev);
+	struct ssp_cmd_stat stat;
+
+	mutex_lock(&data->pending_mutex);
+	stat = data->cmd_stat;
+	mutex_unlock(&data->pending_mutex);
+
+	return sprintf(buf, "sent=%llu done=%llu timeout=%llu pending=%u max_pending=%u avg=%lluus max=%lluus\n",
+		       stat.sent, stat.done, stat.timeout, stat.pending,
+		       stat.max_pending,
+		       stat.done ? div64_u64(stat.total_ns, stat.done * NSEC_PER_USEC) : 0,
+		       div_u64(stat.max_ns, NSEC_PER_USEC));
+}
+
+static ssize_t push_latency_show(struct device *dev,
+				 struct device_attribute *attr, char *buf)
+{
+	struct ssp_data *data = dev_get_drvdata(dev);
+	struct ssp_push_stat *stat;
+	ssize_t ret = 0;
+	int type;
+
+	for (type = 0; type < SENSOR_TYPE_MAX; type++) {
+		stat = &data->push_stat[type];
+		if (!stat->samples)
+			continue;
+
+		ret += scnprintf(buf + ret, PAGE_SIZE - ret,
+				 "%s(%d): samples=%llu batches=%llu avg=%lluus max=%lluus\n",
+				 data->info[type].name, type, stat->samples,
+				 stat->batches,
+				 div64_u64(stat->total_ns, stat->samples * NSEC_PER_USEC),
+				 div_u64(stat->max_ns, NSEC_PER_USEC));
+	}
+
+	return ret;
+}
+
+/* write resets the statistics */
+static ssize_t push_latency_store(struct device *dev,
+				  struct device_attribute *attr, const char *buf, size_t size)
+{
+	struct ssp_data *data = dev_get_drvdata(dev);
+
+	memset(data->push_stat, 0, sizeof(data->push_stat));
+
+	return size;
+}
+
 #define TIMEINFO_SIZE		   50
 #define SUPPORT_SENSORLIST = {SENSOR_TYPE_ACCELEROMETER, SENSOR_TYPE_GYROSCOPE, \
 									SENSOR_TYPE_GEOMAGNETIC_FIELD, SENSOR_TYPE_PRESSURE, \
@@ -813,6 +865,9 @@ static DEVICE_ATTR(sensor_dump, S_IRUGO | S_IWUSR | S_IWGRP,     sensor_dump_sho
 		   sensor_dump_store);
 
 static DEVICE_ATTR(reset_info, S_IRUGO, show_reset_info, NULL);
+static DEVICE_ATTR(cmd_rtt, S_IRUGO, cmd_rtt_show, NULL);
+static DEVICE_ATTR(push_latency, S_IRUGO | S_IWUSR | S_IWGRP,
+		   push_latency_show, push_latency_store);
 
 static DEVICE_ATTR(ssp_dump, S_IRUGO, ssp_dump_show, NULL);
 
@@ -840,6 +895,8 @@ static struct device_attribute *mcu_attrs[] = {
 	&dev_attr_register_rw,
 #endif
 	&dev_attr_reset_info,
+	&dev_attr_cmd_rtt,
+	&dev_attr_push_latency,
 	&dev_attr_ssp_dump,
 	&dev_attr_mcu_test,
 	&dev_attr_mcu_sleep_test,
@@ -21,6 +21,9 @@
 #include <linux/slab.h>
 #include <linux/debug-snapshot.h>
 #include <linux/sched/clock.h>
+#include <linux/workqueue.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <soc/samsung/exynos-pmu.h>
 
 #include "acpm.h"
@@ -356,6 +359,174 @@ unsigned int acpm_ipc_release_channel(struct device_node *np, unsigned int chann
 	return 0;
 }
 
+static const unsigned int ipc_latency_bound[ACPM_IPC_LATENCY_HIST_SIZE - 1] = {
+	10, 20, 50, 100, 200, 500, 1000,
+};
+
+static void acpm_ipc_account_latency(struct acpm_ipc_ch *channel, u64 start)
+{
+	u64 latency = sched_clock() - start;
+	unsigned long flags;
+	int i;
+
+	for (i = 0; i < ACPM_IPC_LATENCY_HIST_SIZE - 1; i++)
+		if (latency < ipc_latency_bound[i] * NSEC_PER_USEC)
+			break;
+
+	spin_lock_irqsave(&channel->stat_lock, flags);
+	channel->latency_hist[i]++;
+	if (latency > channel->latency_max)
+		channel->latency_max = latency;
+	spin_unlock_irqrestore(&channel->stat_lock, flags);
+}
+
+static struct acpm_ipc_async_req *
+find_async_req(struct acpm_ipc_ch *channel, unsigned int seq_num)
+{
+	struct acpm_ipc_async_req *req;
+
+	list_for_each_entry(req, &channel->async_list, list)
+		if (req->seq_num == seq_num)
+			return req;
+
+	return NULL;
+}
+
+/*
+ * If the response in rx queue entry belongs to an asynchronous request,
+ * take the request out of the list with the response. The caller calls
+ * done of the returned request.
+ */
+static struct acpm_ipc_async_req *
+take_async_req(struct acpm_ipc_ch *channel, void __iomem *entry)
+{
+	struct acpm_ipc_async_req *req;
+	unsigned int seq_num;
+	unsigned long flags;
+
+	if (list_empty(&channel->async_list))
+		return NULL;
+
+	seq_num = (__raw_readl(entry) >> ACPM_IPC_PROTOCOL_SEQ_NUM) & 0x3f;
+
+	spin_lock_irqsave(&channel->async_lock, flags);
+	req = find_async_req(channel, seq_num);
+	if (req) {
+		memcpy_align_4(req->cmd, entry, channel->rx_ch.size);
+		list_del(&req->list);
+		channel->async_inflight--;
+	}
+	spin_unlock_irqrestore(&channel->async_lock, flags);
+
+	if (req)
+		acpm_ipc_account_latency(channel, req->submit_time);
+
+	return req;
+}
+
+/*
+ * Collect responses of asynchronous requests from rx queue of polling
+ * channel. Same as check_response(), the collected entry is replaced by the
+ * entry at rear and rear is increased, so the other responses are kept.
+ */
+static void collect_async_response(struct acpm_ipc_ch *channel)
+{
+	struct acpm_ipc_async_req *req, *tmp;
+	struct list_head *cb_list = &channel->list;
+	struct callback_info *cb;
+	void __iomem *entry;
+	unsigned int front, rear, i;
+	LIST_HEAD(done);
+
+	spin_lock(&channel->rx_lock);
+
+	front = __raw_readl(channel->rx_ch.front);
+	rear = __raw_readl(channel->rx_ch.rear);
+	i = rear;
+
+	while (i != front) {
+		entry = channel->rx_ch.base + channel->rx_ch.size * i;
+
+		req = take_async_req(channel, entry);
+		if (req) {
+			memcpy_align_4(channel->cmd, entry, channel->rx_ch.size);
+
+			if (i != rear)
+				memcpy_align_4(entry,
+					channel->rx_ch.base + channel->rx_ch.size * rear,
+					channel->rx_ch.size);
+
+			list_for_each_entry(cb, cb_list, list)
+				if (cb && cb->ipc_callback)
+					cb->ipc_callback(channel->cmd, channel->rx_ch.size);
+
+			rear = (rear + 1) % channel->rx_ch.len;
+			__raw_writel(rear, channel->rx_ch.rear);
+			front = __raw_readl(channel->rx_ch.front);
+
+			if (rear == front)
+				__raw_writel((1 << channel->id), acpm_ipc->intr + INTCR1);
+
+			list_add_tail(&req->list, &done);
+		}
+
+		i = (i + 1) % channel->rx_ch.len;
+	}
+
+	spin_unlock(&channel->rx_lock);
+
+	/* done may submit the next request, call it without rx_lock */
+	list_for_each_entry_safe(req, tmp, &done, list) {
+		list_del(&req->list);
+		req->done(req, 0);
+	}
+}
+
+/* Complete asynchronous requests which are not responded until timeout */
+static void expire_async_req(struct acpm_ipc_ch *channel)
+{
+	struct acpm_ipc_async_req *req, *tmp;
+	unsigned long flags;
+	LIST_HEAD(expired);
+	u64 now = sched_clock();
+
+	spin_lock_irqsave(&channel->async_lock, flags);
+	list_for_each_entry_safe(req, tmp, &channel->async_list, list) {
+		if (now - req->submit_time < IPC_TIMEOUT)
+			continue;
+
+		list_move_tail(&req->list, &expired);
+		channel->async_inflight--;
+	}
+	spin_unlock_irqrestore(&channel->async_lock, flags);
+
+	list_for_each_entry_safe(req, tmp, &expired, list) {
+		list_del(&req->list);
+		pr_err("[ACPM] ch%u async request(seq %u) timeout\n",
+				channel->id, req->seq_num);
+		req->done(req, -ETIMEDOUT);
+	}
+}
+
+/*
+ * Polling channel has no interrupt, so responses of asynchronous requests
+ * are collected by this work while requests are in flight. The work sleeps
+ * between polls instead of spinning.
+ */
+static void acpm_ipc_poll_work(struct work_struct *work)
+{
+	struct acpm_ipc_ch *channel = container_of(work,
+				struct acpm_ipc_ch, poll_work);
+
+	while (READ_ONCE(channel->async_inflight)) {
+		collect_async_response(channel);
+		expire_async_req(channel);
+
+		if (READ_ONCE(channel->async_inflight))
+			usleep_range(ASYNC_POLL_US, ASYNC_POLL_US * 2);
+	}
+}
+
 static bool check_response(struct acpm_ipc_ch *channel, struct ipc_config *cfg)
 {
 	unsigned int front;
@@ -427,6 +598,8 @@ static void dequeue_policy(struct acpm_ipc_ch *channel)
 	unsigned int rear;
 	struct list_head *cb_list = &channel->list;
 	struct callback_info *cb;
+	struct acpm_ipc_async_req *req, *tmp;
+	LIST_HEAD(done);
 
 	spin_lock(&channel->rx_lock);
 
@@ -445,8 +618,11 @@ static void dequeue_policy(struct acpm_ipc_ch *channel)
 	rear = __raw_readl(channel->rx_ch.rear);
 
 	while (rear != front) {
-		memcpy_align_4(channel->cmd, channel->rx_ch.base + channel->rx_ch.size * rear,
-				channel->rx_ch.size);
+		void __iomem *entry = channel->rx_ch.base + channel->rx_ch.size * rear;
+
+		memcpy_align_4(channel->cmd, entry, channel->rx_ch.size);
+
+		req = take_async_req(channel, entry);
 
 		list_for_each_entry(cb, cb_list, list)
 			if (cb && cb->ipc_callback)
@@ -457,7 +633,10 @@ static void dequeue_policy(struct acpm_ipc_ch *channel)
 		else
 			rear++;
 
-		if (!channel->polling)
+		/* response of asynchronous request does not wake up waiter */
+		if (req)
+			list_add_tail(&req->list, &done);
+		else if (!channel->polling)
 			complete(&channel->wait);
 
 		__raw_writel(rear, channel->rx_ch.rear);
@@ -466,6 +645,11 @@ static void dequeue_policy(struct acpm_ipc_ch *channel)
 
 	acpm_log_print();
 	spin_unlock(&channel->rx_lock);
+
+	list_for_each_entry_safe(req, tmp, &done, list) {
+		list_del(&req->list);
+		req->done(req, 0);
+	}
 }
 
 static irqreturn_t acpm_ipc_irq_handler(int irq, void *data)
@@ -508,7 +692,7 @@ static void apm_interrupt_gen(unsigned int id)
 }
 
 static int enqueue_indirection_cmd(struct acpm_ipc_ch *channel,
-		struct ipc_config *cfg)
+		struct ipc_config *cfg, bool wait)
 {
 	unsigned int front;
 	unsigned int rear;
@@ -525,6 +709,10 @@ static int enqueue_indirection_cmd(struct acpm_ipc_ch *channel,
 
 			if (buf & (1 << ACPM_IPC_PROTOCOL_INDIRECTION)) {
 
+				/* indirection buffer is shared, do not spin */
+				if (!wait)
+					return -EBUSY;
+
 				UNTIL_EQUAL(true, rear != __raw_readl(channel->tx_ch.rear),
 						timeout_flag);
 
@@ -557,6 +745,7 @@ int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg)
 {
 	int ret;
 	struct acpm_ipc_ch *channel;
+	u64 start = sched_clock();
 
 	ret = acpm_ipc_send_data(channel_id, cfg);
 
@@ -570,6 +759,7 @@ int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg)
 				pr_err("[%s] ipc_timeout!!!\n", __func__);
 				ret = -ETIMEDOUT;
 			} else {
+				acpm_ipc_account_latency(channel, start);
 				ret = 0;
 			}
 		}
@@ -603,6 +793,7 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	bool timeout_flag = 0;
 	int ret;
 	u64 timeout, now;
+	u64 start = sched_clock();
 	u32 retry_cnt = 0;
 
 	if (channel_id >= acpm_ipc->num_channels && !cfg)
@@ -647,7 +838,7 @@ int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg)
 	cfg->cmd[2] = 0;
 	cfg->cmd[3] = 0;
 
-	ret = enqueue_indirection_cmd(channel, cfg);
+	ret = enqueue_indirection_cmd(channel, cfg, true);
 	if (ret) {
 		pr_err("[ACPM] indirection command fail %d\n", ret);
 		spin_unlock(&channel->tx_lock);
@@ -686,8 +877,10 @@ retry:
 		}
 
 		if (timeout_flag) {
-			if (!check_response(channel, cfg))
+			if (!check_response(channel, cfg)) {
+				acpm_ipc_account_latency(channel, start);
 				return 0;
+			}
 			pr_err("%s Timeout error! now = %llu, timeout = %llu\n",
 					__func__, now, timeout);
 			pr_err("[ACPM] status:0x%x, 0x%x\n",
@@ -709,12 +902,90 @@ retry:
 			return -ETIMEDOUT;
 		}
 
+		acpm_ipc_account_latency(channel, start);
 		queue_work(update_log_wq, &acpm_debug->update_log_work);
 	}
 
 	return 0;
 }
 
+/*
+ * acpm_ipc_send_data_async - send IPC command without waiting for response
+ *
+ * @channel_id : channel given by acpm_ipc_request_channel()
+ * @cfg : command to send, cfg->response must be set
+ * @req : request completed with the response
+ *
+ * Unlike acpm_ipc_send_data(), it never spins in the caller context. If tx
+ * queue is full or indirection buffer is in use, it returns -EBUSY and the
+ * caller can retry later. Several requests can be in flight per channel.
+ * The response is collected by interrupt thread, or by poll work in case of
+ * polling channel, and req->done is called with the result.
+ */
+int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_config *cfg,
+		struct acpm_ipc_async_req *req)
+{
+	struct acpm_ipc_ch *channel;
+	unsigned int front, tmp_index;
+	unsigned long flags;
+	int ret;
+
+	if (channel_id >= acpm_ipc->num_channels || !cfg || !cfg->cmd)
+		return -EIO;
+
+	if (!req || !req->done || !req->cmd || !cfg->response)
+		return -EINVAL;
+
+	channel = &acpm_ipc->channel[channel_id];
+
+	spin_lock(&channel->tx_lock);
+
+	front = __raw_readl(channel->tx_ch.front);
+	tmp_index = front + 1;
+	if (tmp_index >= channel->tx_ch.len)
+		tmp_index = 0;
+
+	/* buffer full, or sequence numbers are exhausted */
+	if (tmp_index == __raw_readl(channel->tx_ch.rear) ||
+			channel->async_inflight >= ASYNC_MAX_INFLIGHT) {
+		spin_unlock(&channel->tx_lock);
+		return -EBUSY;
+	}
+
+	if (++channel->seq_num == 64)
+		channel->seq_num = 1;
+
+	cfg->cmd[0] |= (channel->seq_num & 0x3f) << ACPM_IPC_PROTOCOL_SEQ_NUM;
+
+	ret = enqueue_indirection_cmd(channel, cfg, false);
+	if (ret) {
+		spin_unlock(&channel->tx_lock);
+		return ret;
+	}
+
+	memcpy_align_4(channel->tx_ch.base + channel->tx_ch.size * front, cfg->cmd,
+			channel->tx_ch.size);
+
+	req->seq_num = channel->seq_num;
+	req->submit_time = sched_clock();
+
+	/* the request is visible before the response can arrive */
+	spin_lock_irqsave(&channel->async_lock, flags);
+	list_add_tail(&req->list, &channel->async_list);
+	channel->async_inflight++;
+	spin_unlock_irqrestore(&channel->async_lock, flags);
+
+	writel(tmp_index, channel->tx_ch.front);
+
+	apm_interrupt_gen(channel->id);
+	spin_unlock(&channel->tx_lock);
+
+	if (channel->polling)
+		queue_work(system_highpri_wq, &channel->poll_work);
+
+	return 0;
+}
+
 static void log_buffer_init(struct device *dev, struct device_node *node)
 {
 	const __be32 *prop;
@@ -776,6 +1047,45 @@ static void log_buffer_init(struct device *dev, struct device_node *node)
 		acpm_reg_id = acpm_initdata->regulator_id;
 }
 
+static int acpm_ipc_latency_show(struct seq_file *s, void *unused)
+{
+	struct acpm_ipc_ch *channel;
+	unsigned int hist[ACPM_IPC_LATENCY_HIST_SIZE];
+	unsigned long flags;
+	u64 max;
+	int i, j;
+
+	seq_puts(s, "ch   <10us   <20us   <50us  <100us  <200us  <500us   <1ms    >=1ms  max(ns) inflight\n");
+
+	for (i = 0; i < acpm_ipc->num_channels; i++) {
+		channel = &acpm_ipc->channel[i];
+
+		spin_lock_irqsave(&channel->stat_lock, flags);
+		memcpy(hist, channel->latency_hist, sizeof(hist));
+		max = channel->latency_max;
+		spin_unlock_irqrestore(&channel->stat_lock, flags);
+
+		seq_printf(s, "%2u", channel->id);
+		for (j = 0; j < ACPM_IPC_LATENCY_HIST_SIZE; j++)
+			seq_printf(s, " %7u", hist[j]);
+		seq_printf(s, " %8llu %8u\n", max, READ_ONCE(channel->async_inflight));
+	}
+
+	return 0;
+}
+
+static int acpm_ipc_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, acpm_ipc_latency_show, inode->i_private);
+}
+
+static const struct file_operations acpm_ipc_latency_fops = {
+	.open		= acpm_ipc_latency_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static int channel_init(void)
 {
 	int i;
@@ -817,6 +1127,11 @@ static int channel_init(void)
 		spin_lock_init(&acpm_ipc->channel[i].tx_lock);
 		spin_lock_init(&acpm_ipc->channel[i].ch_lock);
 		INIT_LIST_HEAD(&acpm_ipc->channel[i].list);
+
+		spin_lock_init(&acpm_ipc->channel[i].async_lock);
+		INIT_LIST_HEAD(&acpm_ipc->channel[i].async_list);
+		INIT_WORK(&acpm_ipc->channel[i].poll_work, acpm_ipc_poll_work);
+		spin_lock_init(&acpm_ipc->channel[i].stat_lock);
 	}
 
 	__raw_writel(mask, acpm_ipc->intr + INTMR1);
@@ -884,6 +1199,9 @@ static int acpm_ipc_probe(struct platform_device *pdev)
 
 	channel_init();
 
+	debugfs_create_file("acpm_ipc_latency", 0444, NULL, NULL,
+			&acpm_ipc_latency_fops);
+
 	update_log_wq = create_freezable_workqueue("acpm_update_log");
 	INIT_WORK(&acpm_debug->update_log_work, acpm_update_log);
 
@@ -20,6 +20,12 @@ struct callback_info {
 	struct list_head list;
 };
 
+/*
+ * Upper bounds of latency histogram buckets are 10, 20, 50, 100, 200, 500,
+ * 1000us and the last bucket covers the rest.
+ */
+#define ACPM_IPC_LATENCY_HIST_SIZE	(8)
+
 struct acpm_ipc_ch {
 	struct buff_info rx_ch;
 	struct buff_info tx_ch;
@@ -36,6 +42,17 @@ struct acpm_ipc_ch {
 
 	struct completion wait;
 	bool polling;
+
+	/* asynchronous requests waiting for response */
+	struct list_head async_list;
+	spinlock_t async_lock;
+	unsigned int async_inflight;
+	struct work_struct poll_work;
+
+	/* request-to-response latency */
+	spinlock_t stat_lock;
+	unsigned int latency_hist[ACPM_IPC_LATENCY_HIST_SIZE];
+	u64 latency_max;
 };
 
 struct acpm_ipc_info {
@@ -102,6 +119,9 @@ struct regulator_ss_info {
 #define SR3					0x008C
 
 #define IPC_TIMEOUT				(15000000)
+#define ASYNC_POLL_US				(20)
+/* sequence number is 6 bits and 0 is not used */
+#define ASYNC_MAX_INFLIGHT			(62)
 #define APM_PERITIMER_NS_PERIOD			(10416)
 
 #define UNTIL_EQUAL(arg0, arg1, flag)			\
@@ -62,7 +62,7 @@ int cal_dfs_set_rate(unsigned int id, unsigned long rate)
 		if (!ret) {
 			vclk = cmucal_get_node(id);
 			if (vclk)
-				vclk->vrate = rate;
+				WRITE_ONCE(vclk->vrate, rate);
 		}
 	} else {
 		ret = vclk_set_rate(id, rate);
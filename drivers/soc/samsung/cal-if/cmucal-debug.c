@@ -1,6 +1,8 @@
 #include <linux/debugfs.h>
 #include <linux/uaccess.h>
 #include <linux/io.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include <soc/samsung/cal-if.h>
 
 #include "cmucal.h"
@@ -15,6 +17,7 @@ static struct dentry *rootdir;
 static struct cmucal_clk *clk_info;
 static struct vclk *dvfs_domain;
 static unsigned int margin;
+static unsigned int bench_loops = 1000;
 
 extern unsigned int dbg_offset;
 
@@ -257,6 +260,119 @@ vclk_write_set_margin(struct file *filp, const char __user *ubuf,
 	return len;
 }
 
+/*
+ * DVFS micro-benchmark of dvfs_domain: LUT lookups of every level, linear
+ * as before and binary as get_lut() does now, and the rate reads. Nothing
+ * is written to the clocks. Writing sets the loops per measurement.
+ */
+static int dvfs_bench_linear(struct vclk *vclk, unsigned int rate)
+{
+	int i;
+
+	for (i = 0; i < vclk->num_rates; i++)
+		if (rate >= vclk->lut[i].rate)
+			break;
+
+	return i;
+}
+
+static int dvfs_bench_binary(struct vclk *vclk, unsigned int rate)
+{
+	int lo = 0, hi = vclk->num_rates, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (rate >= vclk->lut[mid].rate)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+static u64 dvfs_bench_lookup(struct vclk *vclk,
+			     int (*lookup)(struct vclk *, unsigned int))
+{
+	unsigned int i;
+	ktime_t start;
+	int lv, sum = 0;
+
+	start = ktime_get();
+	for (i = 0; i < bench_loops; i++)
+		for (lv = 0; lv < vclk->num_rates; lv++)
+			sum += lookup(vclk, vclk->lut[lv].rate);
+	barrier_data(&sum);
+
+	return div64_u64(ktime_to_ns(ktime_sub(ktime_get(), start)),
+			 (u64)bench_loops * vclk->num_rates);
+}
+
+static ssize_t
+vclk_read_dvfs_bench(struct file *filp, char __user *ubuf,
+		       size_t cnt, loff_t *ppos)
+{
+	struct vclk *vclk = dvfs_domain;
+	u64 linear, binary, get_ns, recalc_ns;
+	unsigned int i;
+	ktime_t start;
+	char buf[512];
+	int r;
+
+	if (*ppos)
+		return 0;
+
+	if (vclk == NULL || !vclk->lut || !vclk->num_rates) {
+		r = sprintf(buf, "echo id > dvfs_domain\n");
+		return simple_read_from_buffer(ubuf, cnt, ppos, buf, r);
+	}
+
+	linear = dvfs_bench_lookup(vclk, dvfs_bench_linear);
+	binary = dvfs_bench_lookup(vclk, dvfs_bench_binary);
+
+	start = ktime_get();
+	for (i = 0; i < bench_loops; i++)
+		vclk_get_rate(vclk->id);
+	get_ns = div_u64(ktime_to_ns(ktime_sub(ktime_get(), start)),
+			 bench_loops);
+
+	start = ktime_get();
+	for (i = 0; i < bench_loops; i++)
+		vclk_recalc_rate(vclk->id);
+	recalc_ns = div_u64(ktime_to_ns(ktime_sub(ktime_get(), start)),
+			    bench_loops);
+
+	r = sprintf(buf, "%s : %d levels, %u loops, lut %ssorted\n"
+			 " lookup linear : %llu ns\n"
+			 " lookup binary : %llu ns\n"
+			 " get_rate      : %llu ns\n"
+			 " recalc_rate   : %llu ns\n",
+			 vclk->name, vclk->num_rates, bench_loops,
+			 vclk->lut_sorted ? "" : "NOT ",
+			 linear, binary, get_ns, recalc_ns);
+
+	return simple_read_from_buffer(ubuf, cnt, ppos, buf, r);
+}
+
+static ssize_t
+vclk_write_dvfs_bench(struct file *filp, const char __user *ubuf,
+		   size_t cnt, loff_t *ppos)
+{
+	char buf[16];
+	ssize_t len;
+	u32 loops;
+
+	len = simple_write_to_buffer(buf, sizeof(buf) - 1, ppos, ubuf, cnt);
+	if (len < 0)
+		return len;
+
+	buf[len] = '\0';
+	if (!kstrtouint(buf, 0, &loops) && loops)
+		bench_loops = loops;
+
+	return len;
+}
+
 static const struct file_operations clk_info_fops = {
 	.open		= vclk_clk_info_open,
 	.read		= vclk_read_clk_info,
@@ -279,6 +395,13 @@ static const struct file_operations set_margin_fops = {
 	.llseek		= seq_lseek,
 };
 
+static const struct file_operations dvfs_bench_fops = {
+	.open		= simple_open,
+	.read		= vclk_read_dvfs_bench,
+	.write		= vclk_write_dvfs_bench,
+	.llseek		= seq_lseek,
+};
+
 /* caller must hold prepare_lock */
 static int vclk_debug_create_one(struct vclk *vclk, struct dentry *pdentry)
 {
@@ -397,6 +520,11 @@ static int __init vclk_debug_init(void)
 	if (!d)
 		return -ENOMEM;
 
+	d = debugfs_create_file("dvfs_bench", 0644, rootdir, NULL,
+				&dvfs_bench_fops);
+	if (!d)
+		return -ENOMEM;
+
 	return 0;
 }
 late_initcall(vclk_debug_init);
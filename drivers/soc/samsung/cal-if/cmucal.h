@@ -138,6 +138,8 @@ struct vclk {
 	int			margin_id;
 	struct vclk_switch	*switch_info;
 	struct vclk_trans_ops	*ops;
+	bool			lut_sorted;	/* rates are descending */
+	int			cur_lv;		/* lut index of vrate, hint */
 #ifdef CONFIG_DEBUG_FS
 	struct dentry		*dentry;
 #endif
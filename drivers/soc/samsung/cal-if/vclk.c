@@ -12,18 +12,33 @@
 #define ECT_DUMMY_SFR	(0xFFFFFFFF)
 unsigned int asv_table_ver = 0;
 
+/*
+ * Returns the first level whose rate is not above @rate. The LUTs are in
+ * descending order of rate, which vclk_initialize() checks once, so that
+ * DVFS lookups are binary searches. Unsorted LUTs are searched linearly.
+ */
 static struct vclk_lut *get_lut(struct vclk *vclk, unsigned int rate)
 {
-	int i;
+	int lo = 0, hi = vclk->num_rates, mid;
 
-	for (i = 0; i < vclk->num_rates; i++)
-		if (rate >= vclk->lut[i].rate)
-			break;
+	if (!vclk->lut_sorted) {
+		for (lo = 0; lo < vclk->num_rates; lo++)
+			if (rate >= vclk->lut[lo].rate)
+				break;
+	} else {
+		while (lo < hi) {
+			mid = (lo + hi) / 2;
+			if (rate >= vclk->lut[mid].rate)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+	}
 
-	if (i == vclk->num_rates)
+	if (lo == vclk->num_rates)
 		return NULL;
 
-	return &vclk->lut[i];
+	return &vclk->lut[lo];
 }
 
 static unsigned int get_max_rate(unsigned int from, unsigned int to)
@@ -73,7 +88,7 @@ static int transition_switch(struct vclk *vclk, struct vclk_lut *lut,
 	ra_set_clk_by_type(list, lut, num_list, MUX_TYPE, TRANS_FORCE);
 	ra_set_clk_by_type(list, lut, num_list, DIV_TYPE, TRANS_LOW);
 
-	vclk->vrate = switch_rate;
+	WRITE_ONCE(vclk->vrate, switch_rate);
 
 	return 0;
 }
@@ -176,7 +191,8 @@ static int __vclk_set_rate(unsigned int id, unsigned int rate, int cmd)
 		transition(vclk, new_lut);
 	}
 
-	vclk->vrate = rate;
+	vclk->cur_lv = new_lut - vclk->lut;
+	WRITE_ONCE(vclk->vrate, rate);
 
 	return 0;
 }
@@ -223,22 +239,33 @@ unsigned long vclk_recalc_rate(unsigned int id)
 	if (IS_DFS_VCLK(vclk->id) ||
 	    IS_COMMON_VCLK(vclk->id) ||
 	    IS_ACPM_VCLK(vclk->id)) {
+		/* Registers are most likely still at the last level set */
+		i = vclk->cur_lv;
+		if (i >= 0 && i < vclk->num_rates &&
+		    !ra_compare_clk_list(vclk->lut[i].params, vclk->list,
+					 vclk->num_list)) {
+			WRITE_ONCE(vclk->vrate, vclk->lut[i].rate);
+			return vclk->vrate;
+		}
+
 		for (i = 0; i < vclk->num_rates; i++) {
 			ret = ra_compare_clk_list(vclk->lut[i].params,
 						  vclk->list,
 						  vclk->num_list);
 			if (!ret) {
-				vclk->vrate = vclk->lut[i].rate;
+				vclk->cur_lv = i;
+				WRITE_ONCE(vclk->vrate, vclk->lut[i].rate);
 				break;
 			}
 		}
 
 		if (i == vclk->num_rates) {
-			vclk->vrate = 0;
+			vclk->cur_lv = -1;
+			WRITE_ONCE(vclk->vrate, 0);
 			pr_debug("%s:%x failed\n", __func__, id);
 		}
 	} else {
-		vclk->vrate = ra_recalc_rate(vclk->list[0]);
+		WRITE_ONCE(vclk->vrate, ra_recalc_rate(vclk->list[0]));
 	}
 
 	return vclk->vrate;
@@ -251,7 +278,7 @@ unsigned long vclk_get_rate(unsigned int id)
 	if (IS_VCLK(id)) {
 		vclk = cmucal_get_node(id);
 		if (vclk)
-			return vclk->vrate;
+			return READ_ONCE(vclk->vrate);
 	}
 
 	return 0;
@@ -680,6 +707,29 @@ int vclk_register_ops(unsigned int id, struct vclk_trans_ops *ops)
 	return -EVCLKNOENT;
 }
 
+static void vclk_init_lut(unsigned int type)
+{
+	struct vclk *vclk;
+	int i, j;
+
+	for (i = 0; i < cmucal_get_list_size(type); i++) {
+		vclk = cmucal_get_node(type | i);
+		if (!vclk || !vclk->lut)
+			continue;
+
+		vclk->cur_lv = -1;
+		vclk->lut_sorted = true;
+		for (j = 1; j < vclk->num_rates; j++) {
+			if (vclk->lut[j].rate > vclk->lut[j - 1].rate) {
+				pr_warn("%s: lut is not in descending order\n",
+					vclk->name);
+				vclk->lut_sorted = false;
+				break;
+			}
+		}
+	}
+}
+
 int __init vclk_initialize(void)
 {
 	pr_info("vclk initialize for cmucal\n");
@@ -690,5 +740,8 @@ int __init vclk_initialize(void)
 
 	vclk_bind();
 
+	vclk_init_lut(VCLK_TYPE);
+	vclk_init_lut(ACPM_VCLK_TYPE);
+
 	return 0;
 }
@@ -8,7 +8,13 @@
 #include <linux/errno.h>
 #include <linux/fs.h>
 #include <linux/file.h>
+#include <linux/hashtable.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/rculist.h>
+#include <linux/slab.h>
+#include <linux/stringhash.h>
 #include <linux/vmalloc.h>
 
 #define ALIGNMENT_SIZE	 4
@@ -30,6 +36,24 @@ static phys_addr_t ect_size;
 
 static struct vm_struct ect_early_vm;
 
+/*
+ * Blocks are parsed on their first ect_get_block(), and the named entries
+ * of a parsed block are hashed by (block, name), so the domain lookups of
+ * the drivers do not walk the lists and compare every name.
+ */
+#define ECT_INDEX_BITS	8
+
+struct ect_index_entry {
+	struct hlist_node node;
+	void *block;
+	char *name;
+	void *item;
+};
+
+static DEFINE_HASHTABLE(ect_index, ECT_INDEX_BITS);
+static DEFINE_MUTEX(ect_lock);
+static u64 ect_header_parse_ns;
+
 /* API for internal */
 
 static void ect_parse_integer(void **address, void *value)
@@ -1169,6 +1193,73 @@ err_block_list_allocation:
 	return ret;
 }
 
+static void *ect_index_find(void *block, char *name)
+{
+	struct ect_index_entry *entry;
+	void *item = NULL;
+	u32 key;
+
+	key = full_name_hash(block, name, strlen(name));
+
+	rcu_read_lock();
+	hash_for_each_possible_rcu(ect_index, entry, node, key) {
+		if (entry->block == block && ect_strcmp(entry->name, name) == 0) {
+			item = entry->item;
+			break;
+		}
+	}
+	rcu_read_unlock();
+
+	return item;
+}
+
+/* caller must hold ect_lock */
+static int ect_index_add(void *block, char *name, void *item)
+{
+	struct ect_index_entry *entry;
+
+	/* the first of duplicated names is the one the lists return */
+	if (ect_index_find(block, name))
+		return 0;
+
+	entry = kmalloc(sizeof(*entry), GFP_KERNEL);
+	if (entry == NULL)
+		return -ENOMEM;
+
+	entry->block = block;
+	entry->name = name;
+	entry->item = item;
+	hash_add_rcu(ect_index, &entry->node,
+			full_name_hash(block, name, strlen(name)));
+
+	return 0;
+}
+
+#define ECT_INDEX_BLOCK(func, type, num, list, name)				\
+static int func(struct ect_info *info)						\
+{										\
+	struct type *header = info->block_handle;				\
+	int i;									\
+										\
+	for (i = 0; i < header->num; ++i) {					\
+		if (ect_index_add(header, header->list[i].name, &header->list[i]))	\
+			return -ENOMEM;						\
+	}									\
+										\
+	return 0;								\
+}
+
+ECT_INDEX_BLOCK(ect_index_dvfs, ect_dvfs_header, num_of_domain, domain_list, domain_name)
+ECT_INDEX_BLOCK(ect_index_pll, ect_pll_header, num_of_pll, pll_list, pll_name)
+ECT_INDEX_BLOCK(ect_index_voltage, ect_voltage_header, num_of_domain, domain_list, domain_name)
+ECT_INDEX_BLOCK(ect_index_rcc, ect_rcc_header, num_of_domain, domain_list, domain_name)
+ECT_INDEX_BLOCK(ect_index_ap_thermal, ect_ap_thermal_header, num_of_function, function_list, function_name)
+ECT_INDEX_BLOCK(ect_index_margin, ect_margin_header, num_of_domain, domain_list, domain_name)
+ECT_INDEX_BLOCK(ect_index_minlock, ect_minlock_header, num_of_domain, domain_list, domain_name)
+ECT_INDEX_BLOCK(ect_index_gen_param, ect_gen_param_header, num_of_table, table_list, table_name)
+ECT_INDEX_BLOCK(ect_index_bin, ect_bin_header, num_of_binary, binary_list, binary_name)
+ECT_INDEX_BLOCK(ect_index_pidtm, ect_pidtm_header, num_of_block, block_list, block_name)
+
 static void ect_present_test_data(char *version)
 {
 	if (version[1] == '.')
@@ -1245,6 +1336,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_AP_THERMAL,
 		.block_name_length = sizeof(BLOCK_AP_THERMAL) - 1,
 		.parser = ect_parse_ap_thermal_header,
+		.index = ect_index_ap_thermal,
 		.dump = ect_dump_ap_thermal,
 		.dump_ops = {
 			.open = dump_open,
@@ -1259,6 +1351,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_ASV,
 		.block_name_length = sizeof(BLOCK_ASV) - 1,
 		.parser = ect_parse_voltage_header,
+		.index = ect_index_voltage,
 		.dump = ect_dump_voltage,
 		.dump_ops = {
 			.open = dump_open,
@@ -1273,6 +1366,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_DVFS,
 		.block_name_length = sizeof(BLOCK_DVFS) - 1,
 		.parser = ect_parse_dvfs_header,
+		.index = ect_index_dvfs,
 		.dump = ect_dump_dvfs,
 		.dump_ops = {
 			.open = dump_open,
@@ -1287,6 +1381,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_MARGIN,
 		.block_name_length = sizeof(BLOCK_MARGIN) - 1,
 		.parser = ect_parse_margin_header,
+		.index = ect_index_margin,
 		.dump = ect_dump_margin,
 		.dump_ops = {
 			.open = dump_open,
@@ -1315,6 +1410,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_PLL,
 		.block_name_length = sizeof(BLOCK_PLL) - 1,
 		.parser = ect_parse_pll_header,
+		.index = ect_index_pll,
 		.dump = ect_dump_pll,
 		.dump_ops = {
 			.open = dump_open,
@@ -1329,6 +1425,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_RCC,
 		.block_name_length = sizeof(BLOCK_RCC) - 1,
 		.parser = ect_parse_rcc_header,
+		.index = ect_index_rcc,
 		.dump = ect_dump_rcc,
 		.dump_ops = {
 			.open = dump_open,
@@ -1357,6 +1454,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_MINLOCK,
 		.block_name_length = sizeof(BLOCK_MINLOCK) - 1,
 		.parser = ect_parse_minlock_header,
+		.index = ect_index_minlock,
 		.dump = ect_dump_minlock,
 		.dump_ops = {
 			.open = dump_open,
@@ -1371,6 +1469,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_GEN_PARAM,
 		.block_name_length = sizeof(BLOCK_GEN_PARAM) - 1,
 		.parser = ect_parse_gen_param_header,
+		.index = ect_index_gen_param,
 		.dump = ect_dump_gen_parameter,
 		.dump_ops = {
 			.open = dump_open,
@@ -1385,6 +1484,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_BIN,
 		.block_name_length = sizeof(BLOCK_BIN) - 1,
 		.parser = ect_parse_bin_header,
+		.index = ect_index_bin,
 		.dump = ect_dump_binary,
 		.dump_ops = {
 			.open = dump_open,
@@ -1413,6 +1513,7 @@ static struct ect_info ect_list[] = {
 		.block_name = BLOCK_PIDTM,
 		.block_name_length = sizeof(BLOCK_PIDTM) - 1,
 		.parser = ect_parse_pidtm_header,
+		.index = ect_index_pidtm,
 		.dump = ect_dump_pidtm,
 		.dump_ops = {
 			.open = dump_open,
@@ -1426,6 +1527,65 @@ static struct ect_info ect_list[] = {
 	}
 };
 
+static bool ect_block_indexed(void *block)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE32(ect_list); ++i) {
+		if (ect_list[i].block_handle == block)
+			return ect_list[i].block_indexed;
+	}
+
+	return false;
+}
+
+/* Parses the block of @info on first use, a block failing to parse is not retried */
+static void *ect_load_block(struct ect_info *info)
+{
+	ktime_t start;
+
+	mutex_lock(&ect_lock);
+	if (info->block_handle == NULL && info->block_address != NULL) {
+		start = ktime_get();
+
+		if (info->parser(info->block_address, info))
+			pr_err("[ECT] : parse error %s\n", info->block_name);
+		else if (info->index && info->index(info) == 0)
+			info->block_indexed = true;
+
+		info->block_parse_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+		info->block_address = NULL;
+	}
+	mutex_unlock(&ect_lock);
+
+	return info->block_handle;
+}
+
+static int __init ect_report_parse_time(void)
+{
+	int i;
+
+	if (ect_header_info.block_handle == NULL)
+		return 0;
+
+	pr_info("[ECT] : header parsed in %llu ns\n", ect_header_parse_ns);
+
+	for (i = 0; i < ARRAY_SIZE32(ect_list); ++i) {
+		if (ect_list[i].block_precedence < 0)
+			continue;
+
+		if (ect_list[i].block_address != NULL)
+			pr_info("[ECT] : %s not used during boot\n", ect_list[i].block_name);
+		else
+			pr_info("[ECT] : %s parsed in %llu ns%s\n", ect_list[i].block_name,
+					ect_list[i].block_parse_ns,
+					ect_list[i].block_indexed ? ", indexed" : "");
+	}
+
+	return 0;
+}
+late_initcall_sync(ect_report_parse_time);
+
 #if defined(CONFIG_ECT_DUMP)
 
 static struct ect_info* ect_get_info(char *block_name)
@@ -2071,6 +2231,9 @@ static int dump_open(struct inode *inode, struct file *file)
 {
 	struct ect_info *info = (struct ect_info *)inode->i_private;
 
+	if (info != &ect_header_info)
+		ect_load_block(info);
+
 	return single_open(file, info->dump, inode->i_private);
 }
 
@@ -2087,6 +2250,7 @@ static int ect_dump_all(struct seq_file *s, void *data)
 			if (ect_list[j].block_precedence != i)
 				continue;
 
+			ect_load_block(&ect_list[j]);
 			ret = ect_list[j].dump(s, data);
 			if (ret)
 				return ret;
@@ -2173,7 +2337,7 @@ static int ect_dump_init(void)
 		return -ENOMEM;
 
 	for (i = 0; i < ARRAY_SIZE32(ect_list); ++i) {
-		if (ect_list[i].block_handle == NULL)
+		if (ect_list[i].block_precedence < 0)
 			continue;
 
 		d = debugfs_create_file(ect_list[i].dump_node_name, S_IRUGO, root, &(ect_list[i]),
@@ -2230,7 +2394,7 @@ void *ect_get_block(char *block_name)
 
 	for (i = 0; i < ARRAY_SIZE32(ect_list); ++i) {
 		if (ect_strcmp(block_name, ect_list[i].block_name) == 0)
-			return ect_list[i].block_handle;
+			return ect_load_block(&ect_list[i]);
 	}
 
 	return NULL;
@@ -2246,6 +2410,9 @@ struct ect_dvfs_domain *ect_dvfs_get_domain(void *block, char *domain_name)
 		domain_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, domain_name);
+
 	header = (struct ect_dvfs_header *)block;
 
 	for (i = 0; i < header->num_of_domain; ++i) {
@@ -2268,6 +2435,9 @@ struct ect_pll *ect_pll_get_pll(void *block, char *pll_name)
 		pll_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, pll_name);
+
 	header = (struct ect_pll_header *)block;
 
 	for (i = 0; i < header->num_of_pll; ++i) {
@@ -2290,6 +2460,9 @@ struct ect_voltage_domain *ect_asv_get_domain(void *block, char *domain_name)
 		domain_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, domain_name);
+
 	header = (struct ect_voltage_header *)block;
 
 	for (i = 0; i < header->num_of_domain; ++i) {
@@ -2312,6 +2485,9 @@ struct ect_rcc_domain *ect_rcc_get_domain(void *block, char *domain_name)
 		domain_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, domain_name);
+
 	header = (struct ect_rcc_header *)block;
 
 	for (i = 0; i < header->num_of_domain; ++i) {
@@ -2355,6 +2531,9 @@ struct ect_ap_thermal_function *ect_ap_thermal_get_function(void *block, char *f
 		function_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, function_name);
+
 	header = (struct ect_ap_thermal_header *)block;
 
 	for (i = 0; i < header->num_of_function; ++i) {
@@ -2377,6 +2556,9 @@ struct ect_pidtm_block *ect_pidtm_get_block(void *block, char *block_name)
 		block_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, block_name);
+
 	header = (struct ect_pidtm_header *)block;
 
 	for (i = 0; i < header->num_of_block; ++i) {
@@ -2399,6 +2581,9 @@ struct ect_margin_domain *ect_margin_get_domain(void *block, char *domain_name)
 		domain_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, domain_name);
+
 	header = (struct ect_margin_header *)block;
 
 	for (i = 0; i < header->num_of_domain; ++i) {
@@ -2463,6 +2648,9 @@ struct ect_minlock_domain *ect_minlock_get_domain(void *block, char *domain_name
 		domain_name == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, domain_name);
+
 	header = (struct ect_minlock_header *)block;
 
 	for (i = 0; i < header->num_of_domain; ++i) {
@@ -2484,6 +2672,9 @@ struct ect_gen_param_table *ect_gen_param_get_table(void *block, char *table_nam
 	if (block == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, table_name);
+
 	header = (struct ect_gen_param_header *)block;
 
 	for (i = 0; i < header->num_of_table; ++i) {
@@ -2505,6 +2696,9 @@ struct ect_bin *ect_binary_get_bin(void *block, char *binary_name)
 	if (block == NULL)
 		return NULL;
 
+	if (ect_block_indexed(block))
+		return ect_index_find(block, binary_name);
+
 	header = (struct ect_bin_header *)block;
 
 	for (i = 0; i < header->num_of_binary; ++i) {
@@ -2546,9 +2740,12 @@ int ect_parse_binary_header(void)
 	void *address;
 	unsigned int length, offset;
 	struct ect_header *ect_header;
+	ktime_t start;
 
 	ect_init_map_io();
 
+	start = ktime_get();
+
 	address = (void *)ect_address;
 	if (address == NULL)
 		return -EINVAL;
@@ -2579,21 +2776,16 @@ int ect_parse_binary_header(void)
 			if (strncmp(block_name, ect_list[j].block_name, ect_list[j].block_name_length) != 0)
 				continue;
 
-			if (ect_list[j].parser((void *)ect_address + offset, ect_list + j)) {
-				pr_err("[ECT] : parse error %s\n", block_name);
-				ret = -EINVAL;
-				goto err_parser;
-			}
-
+			ect_list[j].block_address = (void *)ect_address + offset;
 			ect_list[j].block_precedence = i;
 		}
 	}
 
 	ect_header_info.block_handle = ect_header;
+	ect_header_parse_ns = ktime_to_ns(ktime_sub(ktime_get(), start));
 
 	return ret;
 
-err_parser:
 err_parse_string:
 err_memcmp:
 	kfree(ect_header);
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Continuous sampling of BCM results.
+ * The BCM plugin keeps writing results to the dump buffer while it runs.
+ * New entries are collected from the dump buffer every period into a ring
+ * with the kernel time of collection, so that tools can follow the
+ * bandwidth of each IP by mmap of bcm_sample/sample_ring without IPC.
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/io.h>
+#include <linux/math64.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/vmalloc.h>
+#include <linux/workqueue.h>
+#include <linux/platform_device.h>
+#include <linux/sched/clock.h>
+
+#include <soc/samsung/exynos-bcm_dbg.h>
+#include <soc/samsung/exynos-bcm_dbg-dump.h>
+
+#define BCM_SAMPLE_RING_SIZE			(SZ_256K)
+
+struct exynos_bcm_sample_data {
+	struct exynos_bcm_dbg_data	*data;
+	struct mutex			lock;
+	struct delayed_work		work;
+	struct exynos_bcm_sample_ring	*ring;
+
+	unsigned int			period;
+	unsigned int			cursor;
+	u32				last_seq_no;
+	bool				started;
+
+	/* statistics since the last start */
+	u64				start_time;
+	u64				samples;
+	u64				overruns;
+	u64				polls;
+};
+
+static struct exynos_bcm_sample_data bcm_sample;
+
+static void exynos_bcm_sample_collect(struct exynos_bcm_sample_data *sample)
+{
+	struct exynos_bcm_dbg_data *data = sample->data;
+	struct exynos_bcm_sample_ring *ring = sample->ring;
+	struct exynos_bcm_dump_info __iomem *dump_base;
+	struct exynos_bcm_dump_info dump_info;
+	struct exynos_bcm_sample *entry;
+	unsigned int nr_dump, n;
+	u32 head = ring->head;
+	u64 time;
+
+	dump_base = data->dump_addr.v_addr + EXYNOS_BCM_KTIME_SIZE;
+	nr_dump = (data->dump_addr.buff_size - EXYNOS_BCM_KTIME_SIZE) /
+			sizeof(struct exynos_bcm_dump_info);
+	if (!nr_dump)
+		return;
+
+	time = cpu_clock(raw_smp_processor_id());
+
+	/* read entries from the cursor until an entry is not newer */
+	for (n = 0; n < nr_dump; n++) {
+		if (sample->cursor >= nr_dump)
+			sample->cursor = 0;
+
+		memcpy_fromio(&dump_info, &dump_base[sample->cursor],
+				sizeof(dump_info));
+
+		if (!(dump_info.dump_header & BIT(BCM_DUMP_VALID_SHIFT)))
+			break;
+
+		if (sample->started) {
+			s32 diff = dump_info.dump_seq_no - sample->last_seq_no;
+
+			if (diff <= 0)
+				break;
+			/* the plugin wrapped around before collection */
+			sample->overruns += diff - 1;
+		}
+
+		entry = &ring->entry[head % ring->nr_entries];
+		entry->time = time;
+		entry->dump_seq_no = dump_info.dump_seq_no;
+		entry->dump_time = dump_info.dump_time;
+		entry->ip_index = BCM_CMD_GET(dump_info.dump_header,
+					BCM_IP_MASK, 0);
+		entry->defined_event = BCM_CMD_GET(dump_info.dump_header,
+					BCM_EVT_PRE_DEFINE_MASK,
+					BCM_DUMP_PRE_DEFINE_SHIFT);
+		entry->out_data = dump_info.out_data;
+		head++;
+
+		sample->last_seq_no = dump_info.dump_seq_no;
+		sample->started = true;
+		sample->cursor++;
+	}
+
+	sample->samples += head - ring->head;
+	sample->polls++;
+
+	/* entries must be visible before the head */
+	smp_wmb();
+	WRITE_ONCE(ring->head, head);
+}
+
+static void exynos_bcm_sample_work(struct work_struct *work)
+{
+	struct exynos_bcm_sample_data *sample = container_of(work,
+			struct exynos_bcm_sample_data, work.work);
+
+	exynos_bcm_sample_collect(sample);
+
+	schedule_delayed_work(&sample->work, msecs_to_jiffies(sample->period));
+}
+
+static int exynos_bcm_sample_set_period(struct exynos_bcm_sample_data *sample,
+					unsigned int period)
+{
+	struct exynos_bcm_dbg_data *data = sample->data;
+
+	if (period && (period < BCM_TIMER_PERIOD_MIN ||
+			period > BCM_TIMER_PERIOD_MAX)) {
+		BCM_ERR("%s: Invalid period(%u), range(%u ~ %u)ms\n", __func__,
+			period, BCM_TIMER_PERIOD_MIN, BCM_TIMER_PERIOD_MAX);
+		return -EINVAL;
+	}
+
+	if (period && !data->dump_addr.v_addr) {
+		BCM_ERR("%s: No memory region for dump\n", __func__);
+		return -ENOMEM;
+	}
+
+	mutex_lock(&sample->lock);
+
+	cancel_delayed_work_sync(&sample->work);
+
+	sample->period = period;
+	sample->ring->period = period;
+
+	if (period) {
+		sample->cursor = 0;
+		sample->started = false;
+		sample->start_time = cpu_clock(raw_smp_processor_id());
+		sample->samples = 0;
+		sample->overruns = 0;
+		sample->polls = 0;
+		schedule_delayed_work(&sample->work, 0);
+	}
+
+	mutex_unlock(&sample->lock);
+
+	return 0;
+}
+
+static ssize_t show_get_sample(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	struct exynos_bcm_sample_data *sample = &bcm_sample;
+	u64 elapsed, rate = 0;
+	ssize_t count = 0;
+
+	mutex_lock(&sample->lock);
+
+	elapsed = cpu_clock(raw_smp_processor_id()) - sample->start_time;
+	if (sample->period && elapsed >= NSEC_PER_MSEC)
+		rate = div64_u64(sample->samples * MSEC_PER_SEC,
+				div_u64(elapsed, NSEC_PER_MSEC));
+
+	count += snprintf(buf + count, PAGE_SIZE, "\n= BCM continuous sampling =\n");
+	count += snprintf(buf + count, PAGE_SIZE, "period = %u ms\n",
+			sample->period);
+	count += snprintf(buf + count, PAGE_SIZE, "ring entries = %u\n",
+			sample->ring->nr_entries);
+	count += snprintf(buf + count, PAGE_SIZE, "samples = %llu\n",
+			sample->samples);
+	count += snprintf(buf + count, PAGE_SIZE, "sample rate = %llu /s\n",
+			rate);
+	count += snprintf(buf + count, PAGE_SIZE, "overruns = %llu\n",
+			sample->overruns);
+	count += snprintf(buf + count, PAGE_SIZE, "polls = %llu\n",
+			sample->polls);
+
+	mutex_unlock(&sample->lock);
+
+	return count;
+}
+
+static ssize_t show_sample_ctrl_help(struct device *dev,
+				struct device_attribute *attr, char *buf)
+{
+	ssize_t count = 0;
+
+	count += snprintf(buf + count, PAGE_SIZE, "\n= sample_ctrl help =\n");
+	count += snprintf(buf + count, PAGE_SIZE, "Usage:\n");
+	count += snprintf(buf + count, PAGE_SIZE,
+			"echo [period] > sample_ctrl\n");
+	count += snprintf(buf + count, PAGE_SIZE,
+			"period: collection period in ms(%u ~ %u), 0 stops sampling\n",
+			BCM_TIMER_PERIOD_MIN, BCM_TIMER_PERIOD_MAX);
+	count += snprintf(buf + count, PAGE_SIZE,
+			"Samples are read by mmap of sample_ring\n");
+
+	return count;
+}
+
+static ssize_t store_sample_ctrl(struct device *dev,
+				struct device_attribute *attr,
+				const char *buf, size_t count)
+{
+	unsigned int period;
+	int ret;
+
+	ret = kstrtouint(buf, 0, &period);
+	if (ret)
+		return ret;
+
+	ret = exynos_bcm_sample_set_period(&bcm_sample, period);
+	if (ret)
+		return ret;
+
+	return count;
+}
+
+static int exynos_bcm_sample_ring_mmap(struct file *filp, struct kobject *kobj,
+				struct bin_attribute *attr,
+				struct vm_area_struct *vma)
+{
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return remap_vmalloc_range(vma, bcm_sample.ring, vma->vm_pgoff);
+}
+
+static DEVICE_ATTR(get_sample, 0440, show_get_sample, NULL);
+static DEVICE_ATTR(sample_ctrl_help, 0440, show_sample_ctrl_help, NULL);
+static DEVICE_ATTR(sample_ctrl, 0640, NULL, store_sample_ctrl);
+
+static struct bin_attribute bin_attr_sample_ring = {
+	.attr	= { .name = "sample_ring", .mode = 0440 },
+	.size	= BCM_SAMPLE_RING_SIZE,
+	.mmap	= exynos_bcm_sample_ring_mmap,
+};
+
+static struct attribute *exynos_bcm_sample_sysfs_entries[] = {
+	&dev_attr_get_sample.attr,
+	&dev_attr_sample_ctrl_help.attr,
+	&dev_attr_sample_ctrl.attr,
+	NULL,
+};
+
+static struct bin_attribute *exynos_bcm_sample_bin_entries[] = {
+	&bin_attr_sample_ring,
+	NULL,
+};
+
+static struct attribute_group exynos_bcm_sample_attr_group = {
+	.name		= "bcm_sample",
+	.attrs		= exynos_bcm_sample_sysfs_entries,
+	.bin_attrs	= exynos_bcm_sample_bin_entries,
+};
+
+int exynos_bcm_dbg_sample_init(struct exynos_bcm_dbg_data *data)
+{
+	struct exynos_bcm_sample_data *sample = &bcm_sample;
+	int ret;
+
+	sample->ring = vmalloc_user(BCM_SAMPLE_RING_SIZE);
+	if (!sample->ring) {
+		BCM_ERR("%s: failed to allocate sample ring\n", __func__);
+		return -ENOMEM;
+	}
+
+	sample->ring->entry_size = sizeof(struct exynos_bcm_sample);
+	sample->ring->nr_entries = (BCM_SAMPLE_RING_SIZE -
+			sizeof(struct exynos_bcm_sample_ring)) /
+			sizeof(struct exynos_bcm_sample);
+
+	sample->data = data;
+	mutex_init(&sample->lock);
+	INIT_DELAYED_WORK(&sample->work, exynos_bcm_sample_work);
+
+	ret = sysfs_create_group(&data->dev->kobj, &exynos_bcm_sample_attr_group);
+	if (ret) {
+		BCM_ERR("%s: failed creat sysfs for BCM sampling\n", __func__);
+		vfree(sample->ring);
+		sample->ring = NULL;
+		return ret;
+	}
+
+	return 0;
+}
+
+void exynos_bcm_dbg_sample_exit(struct exynos_bcm_dbg_data *data)
+{
+	struct exynos_bcm_sample_data *sample = &bcm_sample;
+
+	if (!sample->ring)
+		return;
+
+	sysfs_remove_group(&data->dev->kobj, &exynos_bcm_sample_attr_group);
+	cancel_delayed_work_sync(&sample->work);
+	vfree(sample->ring);
+	sample->ring = NULL;
+}
@@ -3396,6 +3396,8 @@ static int __init exynos_bcm_dbg_probe(struct platform_device *pdev)
 	if (ret)
 		BCM_ERR("%s: failed creat sysfs for Exynos BCM DBG\n", __func__);
 
+	exynos_bcm_dbg_sample_init(data);
+
 #ifdef CONFIG_EXYNOS_ITMON
 	data->itmon_notifier.notifier_call = exynos_bcm_dbg_itmon_notifier;
 	itmon_notifier_chain_register(&data->itmon_notifier);
@@ -3420,6 +3422,7 @@ static int exynos_bcm_dbg_remove(struct platform_device *pdev)
 					platform_get_drvdata(pdev);
 	int ret;
 
+	exynos_bcm_dbg_sample_exit(data);
 	sysfs_remove_group(&data->dev->kobj, &exynos_bcm_dbg_attr_group);
 	platform_set_drvdata(pdev, NULL);
 	ret = exynos_bcm_dbg_pd_sync_exit(data);
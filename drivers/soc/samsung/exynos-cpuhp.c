@@ -15,11 +15,22 @@
 #include <linux/kthread.h>
 #include <linux/pm_qos.h>
 #include <linux/suspend.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
 #include <linux/debug-snapshot.h>
 
 #include <soc/samsung/exynos-cpuhp.h>
 
 #define CPUHP_USER_NAME_LEN	16
+#define CPUHP_SETTLE_US		2000
+
+/* timing statistics of cpu up/down transition */
+struct cpuhp_stat {
+	u64			cnt;
+	u64			sum_us;
+	u64			max_us;
+	u64			last_us;
+};
 
 struct cpuhp_user {
 	struct list_head	list;
@@ -55,6 +66,19 @@ static struct {
 	/* user request mask */
 	struct cpumask		online_cpus;
 
+	/*
+	 * Requests arriving within settle window are coalesced and applied
+	 * at once by settle_work. 0 means requests are applied immediately.
+	 */
+	unsigned int		settle_us;
+	struct delayed_work	settle_work;
+
+	/* request and transition statistics */
+	u64			req_cnt;
+	u64			coalesced_cnt;
+	struct cpuhp_stat	up_stat;
+	struct cpuhp_stat	down_stat;
+
 	/* cpuhp kobject */
 	struct kobject		*kobj;
 } cpuhp = {
@@ -166,10 +190,14 @@ int exynos_cpuhp_register(char *name, struct cpumask mask, int type)
  * User requests cpu-hp.
  * The mask contains the requested cpu mask, and the type is hp operaton type.
  * The INTERSECTIONS of other user's request masks is determined by the final cpu-mask.
+ *
+ * If settle window is set, the request is not applied immediately. Requests
+ * of all users arriving within the window are merged and the cpus are
+ * brought up/down with a single transition when the window expires.
  */
 int exynos_cpuhp_request(char *name, struct cpumask mask, int type)
 {
-	int ret;
+	int ret = 0;
 
 	mutex_lock(&cpuhp.lock);
 
@@ -178,7 +206,15 @@ int exynos_cpuhp_request(char *name, struct cpumask mask, int type)
 		return 0;
 	}
 
-	ret = cpuhp_do(true);
+	cpuhp.req_cnt++;
+
+	if (cpuhp.settle_us) {
+		/* window is started by the first request, do not extend it */
+		if (!queue_delayed_work(system_highpri_wq, &cpuhp.settle_work,
+				usecs_to_jiffies(cpuhp.settle_us)))
+			cpuhp.coalesced_cnt++;
+	} else
+		ret = cpuhp_do(true);
 
 	mutex_unlock(&cpuhp.lock);
 
@@ -314,6 +350,17 @@ exit:
 	return ret;
 }
 
+static void cpuhp_account_stat(struct cpuhp_stat *stat, ktime_t start)
+{
+	u64 delta = ktime_us_delta(ktime_get(), start);
+
+	stat->cnt++;
+	stat->sum_us += delta;
+	stat->last_us = delta;
+	if (delta > stat->max_us)
+		stat->max_us = delta;
+}
+
 /* print cpu control informatoin for deubgging */
 static void cpuhp_print_debug_info(struct cpumask online_cpus, int fast_hp)
 {
@@ -337,6 +384,7 @@ static int cpuhp_do(int fast_hp)
 {
 	int ret = 0;
 	struct cpumask online_cpus, enable_cpus, disable_cpus;
+	ktime_t start;
 
 	/*
 	 * If cpu hotplug is disabled or suspended,
@@ -357,13 +405,24 @@ static int cpuhp_do(int fast_hp)
 	/* get the disable cpu mask for new offline cpu */
 	cpumask_andnot(&disable_cpus, &cpuhp.online_cpus, &online_cpus);
 
-	if (!cpumask_empty(&enable_cpus))
+	if (!cpumask_empty(&enable_cpus)) {
+		start = ktime_get();
 		ret = cpuhp_cpu_up(enable_cpus, fast_hp);
+		cpuhp_account_stat(&cpuhp.up_stat, start);
+	}
 	if (ret)
 		goto out;
 
-	if (!cpumask_empty(&disable_cpus))
+	if (!cpumask_empty(&disable_cpus)) {
+		start = ktime_get();
 		ret = cpuhp_cpu_down(disable_cpus, fast_hp);
+		cpuhp_account_stat(&cpuhp.down_stat, start);
+	}
+
+	if (cpuhp.debug)
+		pr_info("%s: up %lluus, down %lluus\n", __func__,
+			cpumask_empty(&enable_cpus) ? 0 : cpuhp.up_stat.last_us,
+			cpumask_empty(&disable_cpus) ? 0 : cpuhp.down_stat.last_us);
 
 	cpumask_copy(&cpuhp.online_cpus, &online_cpus);
 
@@ -371,6 +430,14 @@ out:
 	return ret;
 }
 
+/* apply requests coalesced during settle window */
+static void cpuhp_settle_work_fn(struct work_struct *work)
+{
+	mutex_lock(&cpuhp.lock);
+	cpuhp_do(true);
+	mutex_unlock(&cpuhp.lock);
+}
+
 static int cpuhp_control(bool enable)
 {
 	struct cpumask mask;
@@ -555,6 +622,64 @@ static ssize_t store_debug(struct kobject *kobj,
 	return count;
 }
 
+/*
+ * User can change settle window to coalesce requests as below:
+ *
+ * #echo 2000 > /sys/power/cpuhp/settle_us
+ *
+ * If it is 0, requests are applied immediately.
+ */
+static ssize_t show_settle_us(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return snprintf(buf, 12, "%u\n", cpuhp.settle_us);
+}
+
+static ssize_t store_settle_us(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf,
+		size_t count)
+{
+	unsigned int input;
+
+	if (!sscanf(buf, "%u", &input))
+		return -EINVAL;
+
+	cpuhp.settle_us = input;
+
+	return count;
+}
+
+/*
+ * It shows the number of requests and the timing of cpu up/down transitions
+ *
+ * #cat /sys/power/cpuhp/stat
+ */
+static ssize_t show_stat(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	struct cpuhp_stat *stats[] = { &cpuhp.up_stat, &cpuhp.down_stat };
+	const char *names[] = { "up", "down" };
+	ssize_t ret = 0;
+	int i;
+
+	mutex_lock(&cpuhp.lock);
+
+	ret += snprintf(buf + ret, PAGE_SIZE - ret,
+			"requests: %llu coalesced: %llu\n",
+			cpuhp.req_cnt, cpuhp.coalesced_cnt);
+
+	for (i = 0; i < ARRAY_SIZE(stats); i++)
+		ret += snprintf(buf + ret, PAGE_SIZE - ret,
+			"%-4s: cnt=%llu avg=%lluus max=%lluus last=%lluus\n",
+			names[i], stats[i]->cnt,
+			stats[i]->cnt ? div64_u64(stats[i]->sum_us, stats[i]->cnt) : 0,
+			stats[i]->max_us, stats[i]->last_us);
+
+	mutex_unlock(&cpuhp.lock);
+
+	return ret;
+}
+
 static struct kobj_attribute cpuhp_enabled =
 __ATTR(enabled, 0644, show_enable, store_enable);
 static struct kobj_attribute cpuhp_debug =
@@ -563,6 +688,10 @@ static struct kobj_attribute cpuhp_online_cpu =
 __ATTR(online_cpu, 0444, show_online_cpu, NULL);
 static struct kobj_attribute cpuhp_users =
 __ATTR(users, 0444, show_users, NULL);
+static struct kobj_attribute cpuhp_settle_us =
+__ATTR(settle_us, 0644, show_settle_us, store_settle_us);
+static struct kobj_attribute cpuhp_stat =
+__ATTR(stat, 0444, show_stat, NULL);
 
 static struct attribute *cpuhp_attrs[] = {
 	&cpuhp_online_cpu.attr,
@@ -570,6 +699,8 @@ static struct attribute *cpuhp_attrs[] = {
 	&cpuhp_enabled.attr,
 	&cpuhp_debug.attr,
 	&cpuhp_users.attr,
+	&cpuhp_settle_us.attr,
+	&cpuhp_stat.attr,
 	NULL,
 };
 
@@ -608,6 +739,9 @@ static void __init cpuhp_dt_init(void)
 	struct device_node *np = of_find_node_by_name(NULL, "cpuhp");
 	const char *buf;
 
+	if (of_property_read_u32(np, "settle_us", &cpuhp.settle_us))
+		cpuhp.settle_us = CPUHP_SETTLE_US;
+
 	if (of_property_read_string(np, "fast_hp_cpus", &buf)) {
 		pr_info("fast_hp_cpus property is omitted!\n");
 		return;
@@ -667,6 +801,8 @@ static void __init cpuhp_sysfs_init(void)
 
 static int __init cpuhp_init(void)
 {
+	INIT_DELAYED_WORK(&cpuhp.settle_work, cpuhp_settle_work_fn);
+
 	/* Parse data from device tree */
 	cpuhp_dt_init();
 
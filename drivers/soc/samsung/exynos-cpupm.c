@@ -9,6 +9,7 @@
  */
 
 #include <linux/cpumask.h>
+#include <linux/log2.h>
 #include <linux/slab.h>
 #include <linux/tick.h>
 #include <linux/psci.h>
@@ -434,11 +435,24 @@ struct power_mode {
 
 	/* user's request for enabling/disabling power mode */
 	bool		user_request;
+
+	/* time to enter power mode, it is used to check prediction */
+	ktime_t		entry_time;
 };
 
 /* Maximum number of power modes manageable per cpu */
 #define MAX_MODE	5
 
+/*
+ * Idle length histogram
+ * Bucket i counts idle periods of [2^i, 2^(i+1)) usec, the last bucket
+ * counts all longer periods. The histogram decays by half every
+ * IDLE_HIST_DECAY samples to follow the recent wakeup pattern.
+ */
+#define IDLE_HIST_SIZE		16
+#define IDLE_HIST_DECAY		64
+#define IDLE_HIST_MIN_SAMPLE	8
+
 /*
  * Main struct of CPUPM
  * Each cpu has its own data structure and main purpose of this struct is to
@@ -450,6 +464,13 @@ struct exynos_cpupm {
 
 	/* array to manage the power mode that contains the cpu */
 	struct power_mode *	modes[MAX_MODE];
+
+	/* time to enter idle */
+	ktime_t			entry_time;
+
+	/* histogram of idle length for idle prediction */
+	unsigned int		hist[IDLE_HIST_SIZE];
+	unsigned int		hist_total;
 };
 
 static DEFINE_PER_CPU(struct exynos_cpupm, cpupm);
@@ -562,6 +583,88 @@ static int cpus_busy(int target_residency, const struct cpumask *cpus)
 	return 0;
 }
 
+/******************************************************************************
+ *                              Idle prediction                               *
+ ******************************************************************************/
+/*
+ * Sleep length from tickless framework only knows timer events, so cpus woken
+ * by device interrupts break power mode right after entering it. Idle
+ * prediction tracks the idle length of each cpu and estimates the length as
+ * the value exceeded by predict_confidence percent of recent idle periods.
+ * 0 disables idle prediction.
+ */
+static unsigned int predict_confidence = 80;
+
+static void update_idle_hist(struct exynos_cpupm *pm, s64 length)
+{
+	int bucket, i;
+
+	bucket = length > 1 ? ilog2((u64)length) : 0;
+	if (bucket >= IDLE_HIST_SIZE)
+		bucket = IDLE_HIST_SIZE - 1;
+
+	pm->hist[bucket]++;
+	pm->hist_total++;
+
+	if (pm->hist_total < IDLE_HIST_DECAY)
+		return;
+
+	pm->hist_total = 0;
+	for (i = 0; i < IDLE_HIST_SIZE; i++) {
+		pm->hist[i] >>= 1;
+		pm->hist_total += pm->hist[i];
+	}
+}
+
+/* returns predicted idle length in usec, S64_MAX means no prediction */
+static s64 predict_idle_length(struct exynos_cpupm *pm)
+{
+	unsigned int threshold, sum = 0;
+	int i;
+
+	if (!predict_confidence || pm->hist_total < IDLE_HIST_MIN_SAMPLE)
+		return S64_MAX;
+
+	threshold = pm->hist_total * (100 - predict_confidence) / 100;
+	for (i = 0; i < IDLE_HIST_SIZE; i++) {
+		sum += pm->hist[i];
+		if (sum > threshold)
+			break;
+	}
+
+	if (i >= IDLE_HIST_SIZE - 1)
+		return S64_MAX;
+
+	return 1LL << i;
+}
+
+/*
+ * Predict residency of power mode jointly with all cpus in the power domain.
+ * Power mode is broken by the first waking cpu, so if the remaining predicted
+ * idle length of any sibling is smaller than target_residency, CPUPM regards
+ * it as BUSY. A sibling idle longer than its prediction is left to the sleep
+ * length.
+ */
+static int cpus_predicted_busy(struct power_mode *mode)
+{
+	ktime_t now = ktime_get();
+	int cpu;
+
+	for_each_cpu_and(cpu, cpu_online_mask, &mode->siblings) {
+		struct exynos_cpupm *pm = &per_cpu(cpupm, cpu);
+		s64 remain = predict_idle_length(pm);
+
+		if (remain == S64_MAX)
+			continue;
+
+		remain -= ktime_us_delta(now, pm->entry_time);
+		if (remain > 0 && remain < mode->target_residency)
+			return -EBUSY;
+	}
+
+	return 0;
+}
+
 static int initcall_done;
 static int system_busy(void)
 {
@@ -600,6 +703,17 @@ static int can_enter_power_mode(int cpu, struct power_mode *mode)
 	if (mode->system_idle && system_busy())
 		return 0;
 
+	/*
+	 * Timer events and idle IPs allow the power mode, but the wakeup
+	 * pattern of cpus expects the mode to be broken soon.
+	 */
+	if (cpus_predicted_busy(mode)) {
+#ifdef CONFIG_ARM64_EXYNOS_CPUIDLE
+		cpuidle_profile_group_idle_prevent(mode->id);
+#endif
+		return 0;
+	}
+
 	return 1;
 }
 
@@ -632,6 +746,7 @@ static int try_to_enter_power_mode(int cpu, struct power_mode *mode)
 
 	dbg_snapshot_cpuidle(mode->name, 0, 0, DSS_FLAG_IN);
 	set_state_powerdown(mode);
+	mode->entry_time = ktime_get();
 
 #ifdef CONFIG_ARM64_EXYNOS_CPUIDLE
 	cpuidle_profile_group_idle_enter(mode->id);
@@ -644,6 +759,12 @@ static void exit_mode(int cpu, struct power_mode *mode, int cancel)
 {
 #ifdef CONFIG_ARM64_EXYNOS_CPUIDLE
 	cpuidle_profile_group_idle_exit(mode->id, cancel);
+
+	/* power mode exited before target_residency means early wakeup */
+	if (!cancel)
+		cpuidle_profile_group_idle_residency(mode->id,
+			ktime_us_delta(ktime_get(), mode->entry_time)
+					< mode->target_residency);
 #endif
 
 	/*
@@ -682,6 +803,7 @@ int exynos_cpu_pm_enter(int cpu, int index)
 
 	/* Set cpu state to POWERDOWN */
 	set_state_powerdown(pm);
+	pm->entry_time = ktime_get();
 
 	/* Try to enter power mode */
 	for (i = 0; i < MAX_MODE; i++) {
@@ -707,6 +829,10 @@ void exynos_cpu_pm_exit(int cpu, int cancel)
 	spin_lock(&cpupm_lock);
 	pm = &per_cpu(cpupm, cpu);
 
+	/* Canceled idle does not reflect wakeup pattern */
+	if (!cancel)
+		update_idle_hist(pm, ktime_us_delta(ktime_get(), pm->entry_time));
+
 	/* Make settings to exit from mode */
 	for (i = 0; i < MAX_MODE; i++) {
 		mode = pm->modes[i];
@@ -765,6 +891,33 @@ static ssize_t store_power_mode(struct kobject *kobj,
 	return count;
 }
 
+static ssize_t show_predict_confidence(struct kobject *kobj,
+			struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", predict_confidence);
+}
+
+static ssize_t store_predict_confidence(struct kobject *kobj,
+			struct kobj_attribute *attr, const char *buf,
+			size_t count)
+{
+	unsigned int val;
+
+	if (!sscanf(buf, "%u", &val))
+		return -EINVAL;
+
+	if (val >= 100)
+		return -EINVAL;
+
+	predict_confidence = val;
+
+	return count;
+}
+
+static struct kobj_attribute predict_confidence_attr =
+__ATTR(predict_confidence, 0644, show_predict_confidence,
+				store_predict_confidence);
+
 /*
  * attr_pool is used to create sysfs node at initialization time. Saving the
  * initiailized attr to attr_pool, and it creates nodes of each attr at the
@@ -890,8 +1043,13 @@ static int __init cpu_power_mode_init(void)
 #endif
 	}
 
-	if (attr_count)
-		cpupm_sysfs_node_init(attr_count);
+	dn = of_find_node_by_path("/cpupm");
+	of_property_read_u32(dn, "predict-confidence", &predict_confidence);
+	if (predict_confidence >= 100)
+		predict_confidence = 0;
+
+	attr_pool[attr_count++] = &predict_confidence_attr.attr;
+	cpupm_sysfs_node_init(attr_count);
 
 	return 0;
 }
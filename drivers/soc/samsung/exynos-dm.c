@@ -16,6 +16,10 @@
 #include <linux/errno.h>
 #include <linux/of.h>
 #include <linux/slab.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/ktime.h>
 #include <linux/debug-snapshot.h>
 #include "acpm/acpm.h"
 #include "acpm/acpm_ipc.h"
@@ -435,6 +439,7 @@ int exynos_dm_data_init(int dm_type, void *data,
 		exynos_dm->dm_data[dm_type].max_freq = max_freq;
 
 	exynos_dm->dm_data[dm_type].devdata = data;
+	dm_gen++;
 
 out:
 	mutex_unlock(&exynos_dm->lock);
@@ -442,6 +447,106 @@ out:
 	return ret;
 }
 
+/*
+ * Constraints applied to a domain are scattered over the constraint lists of
+ * the master domains. They are collected into arrays per domain whenever the
+ * constraint tables change, so that the solver does not need to walk all
+ * constraint lists of all domains for every domain it updates. If the cache
+ * cannot be built, the solver falls back to walking the lists.
+ */
+static int count_constraints(int dm_type, bool min)
+{
+	struct exynos_dm_constraint *constraint;
+	struct list_head *constraint_list;
+	int i, count = 0;
+
+	for (i = 0; i < exynos_dm->domain_count; i++) {
+		if (!exynos_dm->dm_data[i].available)
+			continue;
+
+		constraint_list = min ? get_min_constraint_list(&exynos_dm->dm_data[i]) :
+					get_max_constraint_list(&exynos_dm->dm_data[i]);
+		list_for_each_entry(constraint, constraint_list, node)
+			if (constraint->constraint_dm_type == dm_type)
+				count++;
+	}
+
+	return count;
+}
+
+static void fill_constraints(int dm_type, bool min,
+				struct exynos_dm_constraint **cache)
+{
+	struct exynos_dm_constraint *constraint;
+	struct list_head *constraint_list;
+	int i, count = 0;
+
+	for (i = 0; i < exynos_dm->domain_count; i++) {
+		if (!exynos_dm->dm_data[i].available)
+			continue;
+
+		constraint_list = min ? get_min_constraint_list(&exynos_dm->dm_data[i]) :
+					get_max_constraint_list(&exynos_dm->dm_data[i]);
+		list_for_each_entry(constraint, constraint_list, node)
+			if (constraint->constraint_dm_type == dm_type)
+				cache[count++] = constraint;
+	}
+}
+
+static void build_constraint_cache(int dm_type)
+{
+	struct exynos_dm_data *dm = &exynos_dm->dm_data[dm_type];
+	struct exynos_dm_constraint **min_cache = NULL, **max_cache = NULL;
+	int min_count, max_count;
+
+	min_count = count_constraints(dm_type, true);
+	max_count = count_constraints(dm_type, false);
+
+	if (min_count) {
+		min_cache = kcalloc(min_count, sizeof(*min_cache), GFP_KERNEL);
+		if (!min_cache)
+			goto fail;
+		fill_constraints(dm_type, true, min_cache);
+	}
+
+	if (max_count) {
+		max_cache = kcalloc(max_count, sizeof(*max_cache), GFP_KERNEL);
+		if (!max_cache)
+			goto fail;
+		fill_constraints(dm_type, false, max_cache);
+	}
+
+	kfree(dm->min_cache);
+	kfree(dm->max_cache);
+	dm->min_cache = min_cache;
+	dm->max_cache = max_cache;
+	dm->min_cache_count = min_count;
+	dm->max_cache_count = max_count;
+	dm->cache_valid = true;
+
+	return;
+
+fail:
+	kfree(min_cache);
+	kfree(dm->min_cache);
+	kfree(dm->max_cache);
+	dm->min_cache = NULL;
+	dm->max_cache = NULL;
+	dm->min_cache_count = 0;
+	dm->max_cache_count = 0;
+	dm->cache_valid = false;
+
+	dev_warn(exynos_dm->dev, "failed to build constraint cache of dm type(%d)\n",
+			dm_type);
+}
+
+/*
+ * Generation of solver input. It increases whenever the result of solving
+ * can be changed, so the request same as the last solved one is skipped
+ * while the generation is not changed.
+ */
+static u64 dm_gen = 1;
+
 /*
  * 	Initialize sequence Step.2
  */
@@ -529,8 +634,13 @@ int register_exynos_dm_constraint_table(int dm_type,
 
 		/* linked sub constraint */
 		constraint->sub_constraint = sub_constraint;
+
+		build_constraint_cache(dm_type);
 	}
 
+	build_constraint_cache(constraint->constraint_dm_type);
+	dm_gen++;
+
 	mutex_unlock(&exynos_dm->lock);
 
 	return 0;
@@ -567,10 +677,16 @@ int unregister_exynos_dm_constraint_table(int dm_type,
 		list_del(&sub_constraint->node);
 		kfree(sub_constraint->freq_table);
 		kfree(sub_constraint);
+		constraint->sub_constraint = NULL;
+
+		build_constraint_cache(dm_type);
 	}
 
 	list_del(&constraint->node);
 
+	build_constraint_cache(constraint->constraint_dm_type);
+	dm_gen++;
+
 	mutex_unlock(&exynos_dm->lock);
 
 	return 0;
@@ -685,6 +801,7 @@ static int __policy_update_call_to_DM(int dm_type, u32 min_freq, u32 max_freq)
 		goto out;
 
 	update_policy_min_max_freq(dm, min_freq, max_freq);
+	dm_gen++;
 
 	/* Check dependent domains */
 
@@ -774,6 +891,27 @@ static int constraint_checker_max(struct list_head *head, u32 freq)
 	return 0;
 }
 
+/*
+ * Solve time statistics, it only counts the time to decide the frequencies
+ * of dependent domains except the scaling.
+ */
+static struct {
+	u64	count;
+	u64	skipped;
+	u64	total_ns;
+	u64	max_ns;
+	u64	last_ns;
+} dm_solve_stat;
+
+static void dm_account_solve_time(u64 delta)
+{
+	dm_solve_stat.count++;
+	dm_solve_stat.total_ns += delta;
+	dm_solve_stat.last_ns = delta;
+	if (delta > dm_solve_stat.max_ns)
+		dm_solve_stat.max_ns = delta;
+}
+
 /*
  * DM CALL
  */
@@ -786,6 +924,7 @@ static int __DM_CALL(int dm_type, unsigned long *target_freq)
 	u32 old_min_freq;
 	struct timeval pre, before, after;
 	s32 time = 0, pre_time = 0;
+	u64 solve_start;
 
 #ifdef CONFIG_DEBUG_SNAPSHOT_DM
 	dbg_snapshot_dm((int)dm_type, *target_freq, 1, pre_time, time);
@@ -794,6 +933,17 @@ static int __DM_CALL(int dm_type, unsigned long *target_freq)
 	do_gettimeofday(&before);
 
 	dm = &exynos_dm->dm_data[dm_type];
+
+	/* Nothing changed since the last solving of the same request */
+	if (dm->solved_gen == dm_gen && dm->solved_req_freq == (u32)(*target_freq)) {
+		*target_freq = dm->target_freq;
+		dm_solve_stat.skipped++;
+		return 0;
+	}
+	dm->solved_req_freq = (u32)(*target_freq);
+
+	solve_start = ktime_get_ns();
+
 	old_min_freq = dm->min_freq;
 	dm->gov_min_freq = (u32)(*target_freq);
 
@@ -811,6 +961,7 @@ static int __DM_CALL(int dm_type, unsigned long *target_freq)
 	ret = dm_data_updater(dm_type);
 	if (ret) {
 		pr_err("Failed to update DM DATA!\n");
+		dm->solved_gen = 0;
 		return -EAGAIN;
 	}
 
@@ -829,6 +980,8 @@ static int __DM_CALL(int dm_type, unsigned long *target_freq)
 	constraint_data_updater(dm_type, 1);
 	max_constraint_data_updater(dm_type, 1);
 
+	dm_account_solve_time(ktime_get_ns() - solve_start);
+
 	if (dm->target_freq > dm->cur_freq)
 		scaling_callback(UP, relation);
 	else if (dm->target_freq < dm->cur_freq)
@@ -844,6 +997,8 @@ static int __DM_CALL(int dm_type, unsigned long *target_freq)
 		max_order[i] = DM_EMPTY;
 	}
 
+	dm->solved_gen = ++dm_gen;
+
 	do_gettimeofday(&after);
 
 	pre_time = (before.tv_sec - pre.tv_sec) * USEC_PER_SEC +
@@ -872,6 +1027,14 @@ static int dm_data_updater(int dm_type)
 	min_freq = dm->policy_min_freq;
 	max_freq = dm->policy_max_freq;
 
+	if (likely(dm->cache_valid)) {
+		for (i = 0; i < dm->min_cache_count; i++)
+			min_freq = max(min_freq, dm->min_cache[i]->min_freq);
+		for (i = 0; i < dm->max_cache_count; i++)
+			max_freq = min(max_freq, dm->max_cache[i]->max_freq);
+		goto out;
+	}
+
 	/* Check min/max constraint conditions */
 	for (i = 0; i < exynos_dm->domain_count; i++) {
 		if (!exynos_dm->dm_data[i].available)
@@ -898,6 +1061,7 @@ static int dm_data_updater(int dm_type)
 		}
 	}
 
+out:
 	min_freq = max(min_freq, dm->gov_min_freq); //MIN freq should be checked with gov_min_freq
 	update_min_max_freq(dm, min_freq, max_freq);
 
@@ -1106,6 +1270,171 @@ static int scaling_callback(enum dvfs_direction dir, unsigned int relation)
 	return 0;
 }
 
+/*
+ * DEBUGFS for solver benchmark
+ *
+ * solve_stat : statistics of the solve time of DM CALL, write to reset
+ * benchmark  : write "<dm type> <iterations>" to solve the current state
+ *              of the domain repeatedly without scaling, read the result
+ */
+#define DM_BENCHMARK_MAX_ITER	10000
+
+static struct dentry *exynos_dm_debugfs;
+static u64 dm_benchmark_result[3];	/* iterations, avg_ns, max_ns */
+static int dm_benchmark_type = -1;
+
+static void dm_benchmark(int dm_type, int iterations)
+{
+	u64 start, delta, total = 0, max = 0;
+	int i, n;
+
+	mutex_lock(&exynos_dm->lock);
+
+	for (n = 0; n < iterations; n++) {
+		start = ktime_get_ns();
+
+		for (i = 0; i < exynos_dm->domain_count; i++)
+			exynos_dm->dm_data[i].constraint_checked = 0;
+
+		dm_data_updater(dm_type);
+		constraint_data_updater(dm_type, 1);
+		max_constraint_data_updater(dm_type, 1);
+
+		delta = ktime_get_ns() - start;
+		total += delta;
+		max = max(max, delta);
+
+		for (i = 0; i <= exynos_dm->domain_count; i++) {
+			min_order[i] = DM_EMPTY;
+			max_order[i] = DM_EMPTY;
+		}
+	}
+
+	for (i = 0; i < exynos_dm->domain_count; i++)
+		exynos_dm->dm_data[i].constraint_checked = 0;
+
+	/* next DM CALL should be solved again */
+	dm_gen++;
+
+	mutex_unlock(&exynos_dm->lock);
+
+	dm_benchmark_type = dm_type;
+	dm_benchmark_result[0] = iterations;
+	dm_benchmark_result[1] = div64_u64(total, iterations);
+	dm_benchmark_result[2] = max;
+}
+
+static int solve_stat_show(struct seq_file *s, void *unused)
+{
+	u64 avg;
+
+	mutex_lock(&exynos_dm->lock);
+	avg = dm_solve_stat.count ?
+		div64_u64(dm_solve_stat.total_ns, dm_solve_stat.count) : 0;
+	seq_printf(s, "solved : %llu\n", dm_solve_stat.count);
+	seq_printf(s, "skipped : %llu\n", dm_solve_stat.skipped);
+	seq_printf(s, "avg : %llu ns\n", avg);
+	seq_printf(s, "max : %llu ns\n", dm_solve_stat.max_ns);
+	seq_printf(s, "last : %llu ns\n", dm_solve_stat.last_ns);
+	mutex_unlock(&exynos_dm->lock);
+
+	return 0;
+}
+
+static int solve_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, solve_stat_show, inode->i_private);
+}
+
+static ssize_t solve_stat_write(struct file *file, const char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	mutex_lock(&exynos_dm->lock);
+	memset(&dm_solve_stat, 0, sizeof(dm_solve_stat));
+	mutex_unlock(&exynos_dm->lock);
+
+	return count;
+}
+
+static const struct file_operations solve_stat_fops = {
+	.open		= solve_stat_open,
+	.read		= seq_read,
+	.write		= solve_stat_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int benchmark_show(struct seq_file *s, void *unused)
+{
+	if (dm_benchmark_type < 0) {
+		seq_puts(s, "not executed\n");
+		return 0;
+	}
+
+	seq_printf(s, "%s : iterations=%llu avg=%llu ns max=%llu ns\n",
+			exynos_dm->dm_data[dm_benchmark_type].dm_type_name,
+			dm_benchmark_result[0], dm_benchmark_result[1],
+			dm_benchmark_result[2]);
+
+	return 0;
+}
+
+static int benchmark_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, benchmark_show, inode->i_private);
+}
+
+static ssize_t benchmark_write(struct file *file, const char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	char kbuf[32];
+	int dm_type, iterations;
+
+	if (count >= sizeof(kbuf))
+		return -EINVAL;
+
+	if (copy_from_user(kbuf, buf, count))
+		return -EFAULT;
+	kbuf[count] = '\0';
+
+	if (sscanf(kbuf, "%d %d", &dm_type, &iterations) != 2)
+		return -EINVAL;
+
+	if (dm_type < 0 || dm_type >= exynos_dm->domain_count)
+		return -EINVAL;
+
+	/* the solver runs with DM lock held, limit the iterations */
+	if (iterations <= 0 || iterations > DM_BENCHMARK_MAX_ITER)
+		return -EINVAL;
+
+	if (!exynos_dm->dm_data[dm_type].available)
+		return -ENODEV;
+
+	dm_benchmark(dm_type, iterations);
+
+	return count;
+}
+
+static const struct file_operations benchmark_fops = {
+	.open		= benchmark_open,
+	.read		= seq_read,
+	.write		= benchmark_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static void exynos_dm_debugfs_init(void)
+{
+	exynos_dm_debugfs = debugfs_create_dir("exynos-dm", NULL);
+	if (!exynos_dm_debugfs)
+		return;
+
+	debugfs_create_file("solve_stat", 0644, exynos_dm_debugfs, NULL,
+				&solve_stat_fops);
+	debugfs_create_file("benchmark", 0644, exynos_dm_debugfs, NULL,
+				&benchmark_fops);
+}
+
 static void get_governor_min_freq(struct exynos_dm_data *dm_data, u32 *gov_min_freq)
 {
 	*gov_min_freq = dm_data->gov_min_freq;
@@ -1222,6 +1551,8 @@ static int exynos_dm_probe(struct platform_device *pdev)
 	exynos_dm = dm;
 	platform_set_drvdata(pdev, dm);
 
+	exynos_dm_debugfs_init();
+
 	return 0;
 
 err_parse_dt:
@@ -32,6 +32,10 @@
 #define DEFAULT_BOOT_ENABLE_MS (40000)		/* 40 s */
 
 #define EMC_EVENT_NUM	2
+
+/* number of samples of busy cpus histogram per domain */
+#define EMC_HIST_SIZE	8
+#define DEFAULT_PREDICT_RATIO	75	/* percentile of busy cpus histogram */
 enum emc_event {
 	/* mode change finished and then waiting new mode */
 	EMC_WAITING_NEW_MODE = 0,
@@ -54,6 +58,14 @@ struct emc_mode {
 	unsigned int		change_latency;
 	unsigned int		enabled;
 
+	/* minimum residency in this mode before leaving (ms) */
+	unsigned int		min_residency;
+
+	/* accounting of the mode change cost of entering this mode */
+	unsigned int		change_cnt;
+	u64			change_cost_sum;	/* us */
+	u64			change_cost_max;	/* us */
+
 	/* kobject for sysfs group */
 	struct kobject		kobj;
 };
@@ -70,6 +82,18 @@ struct emc_domain {
 	unsigned long		load;
 	unsigned long		max;
 
+	/*
+	 * Short histogram of the number of busy cpus. busy_ring keeps the
+	 * samples of last EMC_HIST_SIZE ticks and busy_hist counts them by
+	 * the number of busy cpus.
+	 */
+	unsigned int		busy_ring[EMC_HIST_SIZE];
+	unsigned int		busy_hist[NR_CPUS + 1];
+	unsigned int		ring_idx;
+	unsigned int		nr_samples;
+	unsigned long		last_sample;
+	unsigned int		predict_ratio;
+
 	/* kobject for sysfs group */
 	struct kobject		kobj;
 };
@@ -93,6 +117,11 @@ struct emc {
 	/* loadsum of boostable and trigger domain */
 	unsigned int		ldsum;
 
+	/* time entering cur_mode, for minimum residency */
+	ktime_t			mode_entered;
+	/* number of mode change requests held by minimum residency */
+	unsigned int		residency_hold;
+
 	/* member for mode change */
 	struct task_struct	*task;
 	struct irq_work		irq_work;
@@ -290,6 +319,53 @@ static int emc_update_load(void)
 	return 0;
 }
 
+/*
+ * Record the number of busy cpus of domain once a tick. Drop the oldest
+ * sample from the histogram when the ring is full.
+ */
+static void emc_update_busy_hist(struct emc_domain *domain, unsigned int nr_busy)
+{
+	unsigned int old;
+
+	if (domain->nr_samples && domain->last_sample == jiffies)
+		return;
+	domain->last_sample = jiffies;
+
+	if (domain->nr_samples == EMC_HIST_SIZE) {
+		old = domain->busy_ring[domain->ring_idx];
+		domain->busy_hist[old]--;
+	} else {
+		domain->nr_samples++;
+	}
+
+	domain->busy_ring[domain->ring_idx] = nr_busy;
+	domain->busy_hist[nr_busy]++;
+	domain->ring_idx = (domain->ring_idx + 1) % EMC_HIST_SIZE;
+}
+
+/*
+ * Predict the number of busy cpus of domain as the predict_ratio percentile
+ * of the histogram, a short burst is not taken as busy.
+ */
+static unsigned int emc_predict_busy(struct emc_domain *domain)
+{
+	unsigned int need, sum = 0;
+	int i;
+
+	if (!domain->nr_samples)
+		return 0;
+
+	need = DIV_ROUND_UP(domain->nr_samples * domain->predict_ratio, 100);
+
+	for (i = 0; i <= NR_CPUS; i++) {
+		sum += domain->busy_hist[i];
+		if (sum >= need)
+			return i;
+	}
+
+	return NR_CPUS;
+}
+
 /* update domains's cpus status whether busy or idle */
 static int emc_update_domain_status(struct emc_domain *domain)
 {
@@ -322,6 +398,8 @@ static int emc_update_domain_status(struct emc_domain *domain)
 			cpumask_set_cpu(cpu, &idle_cpus);
 	}
 
+	emc_update_busy_hist(domain, cpumask_weight(&busy_cpus));
+
 	/* domain cpus status updated system cpus mask */
 	cpumask_or(&emc.heavy_cpus, &emc.heavy_cpus, &heavy_cpus);
 	cpumask_or(&emc.busy_cpus, &emc.busy_cpus, &busy_cpus);
@@ -417,16 +495,19 @@ static bool emc_has_boostable_cpu(void)
 static struct emc_mode* emc_select_mode(void)
 {
 	struct emc_mode *mode, *target_mode = NULL;
-	int need_online_cnt;
+	struct emc_domain *domain;
+	int need_online_cnt = 0;
 
 	/* if there is no boostable cpu, we don't need to booting */
 	if (!emc_has_boostable_cpu())
 		return emc_get_base_mode();
 
 	/*
-	 * need_online_cnt: number of cpus that need online
+	 * need_online_cnt: number of cpus that need online,
+	 * predicted from the busy cpus histogram of each domain
 	 */
-	need_online_cnt = cpumask_weight(&emc.busy_cpus);
+	list_for_each_entry(domain, &emc.domains, list)
+		need_online_cnt += emc_predict_busy(domain);
 
 	/* In reverse order to find the most boostable mode */
 	list_for_each_entry_reverse(mode, &emc.modes, list) {
@@ -555,9 +636,20 @@ static unsigned int emc_clear_event(void)
 }
 
 /* mode change function */
+static void emc_account_change_cost(struct emc_mode *mode, ktime_t start)
+{
+	u64 cost = ktime_us_delta(ktime_get(), start);
+
+	mode->change_cnt++;
+	mode->change_cost_sum += cost;
+	if (cost > mode->change_cost_max)
+		mode->change_cost_max = cost;
+}
+
 static int emc_do_mode_change(void *data)
 {
 	unsigned long flags;
+	ktime_t start;
 
 	while (1) {
 		unsigned int event;
@@ -577,7 +669,10 @@ static int emc_do_mode_change(void *data)
 		spin_unlock_irqrestore(&emc_lock, flags);
 
 		/* request mode change */
+		start = ktime_get();
 		exynos_cpuhp_request("EMC", emc.cur_mode->cpus, emc.ctrl_type);
+		emc.mode_entered = ktime_get();
+		emc_account_change_cost(emc.cur_mode, start);
 
 		dbg_snapshot_printk("EMC: mode change finished %s (cpus%d)\n",
 			emc.cur_mode->name, cpumask_weight(&emc.cur_mode->cpus));
@@ -624,6 +719,17 @@ void exynos_emc_update(int cpu)
 	/* get mode */
 	target_mode = emc_get_mode(updated);
 
+	/*
+	 * Keep current mode until it stays for its minimum residency,
+	 * to prevent oscillation between modes under bursty load.
+	 */
+	if (target_mode != emc.cur_mode && emc.cur_mode->min_residency &&
+	    ktime_ms_delta(ktime_get(), emc.mode_entered) <
+					emc.cur_mode->min_residency) {
+		emc.residency_hold++;
+		target_mode = emc.cur_mode;
+	}
+
 skip_load_check:
 	/* request mode */
 	if (emc.req_mode != target_mode)
@@ -932,6 +1038,7 @@ emc_show(boostable, boostable);
 emc_domain_store(cpu_heavy_thr, cpu_heavy_thr);
 emc_domain_store(cpu_idle_thr, cpu_idle_thr);
 emc_domain_store(busy_ratio, busy_ratio);
+emc_domain_show(predict_ratio, predict_ratio);
 emc_domain_show(cpu_heavy_thr, cpu_heavy_thr);
 emc_domain_show(cpu_idle_thr, cpu_idle_thr);
 emc_domain_show(busy_ratio, busy_ratio);
@@ -940,6 +1047,8 @@ emc_mode_store(max_freq, max_freq);
 emc_mode_store(change_latency, change_latency);
 emc_mode_store(ldsum_thr, ldsum_thr);
 emc_mode_store(mode_enabled, enabled);
+emc_mode_store(min_residency, min_residency);
+emc_mode_show(min_residency, min_residency);
 emc_mode_show(max_freq, max_freq);
 emc_mode_show(change_latency, change_latency);
 emc_mode_show(ldsum_thr, ldsum_thr);
@@ -1105,6 +1214,37 @@ static ssize_t show_user_mode(struct kobject *kobj, char *buf)
 	return ret;
 }
 
+static ssize_t store_predict_ratio(struct kobject *kobj,
+			const char *buf, size_t count)
+{
+	struct emc_domain *domain = to_domain(kobj);
+	unsigned int val;
+
+	if (kstrtouint(buf, 10, &val) || !val || val > 100)
+		return -EINVAL;
+
+	domain->predict_ratio = val;
+
+	return count;
+}
+
+static ssize_t show_residency_hold(struct kobject *kobj, char *buf)
+{
+	return sprintf(buf, "%u\n", emc.residency_hold);
+}
+
+static ssize_t show_change_cost(struct kobject *kobj, char *buf)
+{
+	struct emc_mode *mode = to_mode(kobj);
+	u64 avg = 0;
+
+	if (mode->change_cnt)
+		avg = div_u64(mode->change_cost_sum, mode->change_cnt);
+
+	return sprintf(buf, "count=%u avg=%lluus max=%lluus\n",
+			mode->change_cnt, avg, mode->change_cost_max);
+}
+
 static ssize_t show_domain_name(struct kobject *kobj, char *buf)
 {
 	struct emc_domain *domain = to_domain(kobj);
@@ -1164,23 +1304,28 @@ emc_attr_rw(enabled);
 emc_attr_rw(ctrl_type);
 emc_attr_ro(boostable);
 emc_attr_rw(user_mode);
+emc_attr_ro(residency_hold);
 
 emc_attr_ro(domain_name);
 emc_attr_rw(cpu_heavy_thr);
 emc_attr_rw(cpu_idle_thr);
 emc_attr_rw(busy_ratio);
+emc_attr_rw(predict_ratio);
 
 emc_attr_ro(mode_name);
 emc_attr_rw(max_freq);
 emc_attr_rw(change_latency);
 emc_attr_rw(ldsum_thr);
 emc_attr_rw(mode_enabled);
+emc_attr_rw(min_residency);
+emc_attr_ro(change_cost);
 
 static struct attribute *emc_attrs[] = {
 	&enabled.attr,
 	&ctrl_type.attr,
 	&boostable.attr,
 	&user_mode.attr,
+	&residency_hold.attr,
 	NULL
 };
 
@@ -1189,6 +1334,7 @@ static struct attribute *emc_domain_attrs[] = {
 	&cpu_heavy_thr.attr,
 	&cpu_idle_thr.attr,
 	&busy_ratio.attr,
+	&predict_ratio.attr,
 	NULL
 };
 
@@ -1198,6 +1344,8 @@ static struct attribute *emc_mode_attrs[] = {
 	&change_latency.attr,
 	&ldsum_thr.attr,
 	&mode_enabled.attr,
+	&min_residency.attr,
+	&change_cost.attr,
 	NULL
 };
 
@@ -1354,6 +1502,9 @@ static int __init emc_parse_mode(struct device_node *dn)
 	if (of_property_read_u32(dn, "enabled", &mode->enabled))
 		goto free;
 
+	if (of_property_read_u32(dn, "min_residency", &mode->min_residency))
+		mode->min_residency = 0;
+
 	list_add_tail(&mode->list, &emc.modes);
 
 	return 0;
@@ -1392,6 +1543,9 @@ static int __init emc_parse_domain(struct device_node *dn)
 	if (of_property_read_u32(dn, "busy_ratio", &domain->busy_ratio))
 		goto free;
 
+	if (of_property_read_u32(dn, "predict_ratio", &domain->predict_ratio))
+		domain->predict_ratio = DEFAULT_PREDICT_RATIO;
+
 	list_add_tail(&domain->list, &emc.domains);
 
 	return 0;
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * Latency tracer of the buffers through the Exynos frame pipelines
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/atomic.h>
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/init.h>
+#include <linux/ktime.h>
+#include <linux/mutex.h>
+#include <linux/random.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/siphash.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+
+#include <soc/samsung/exynos-frametrace.h>
+
+/*
+ * fimc-is, mali, MFC and DECON record here the steps of the dma-bufs they
+ * process, so that a camera preview buffer may be followed from the sensor
+ * to the encoder or the screen. A buffer is identified by a keyed hash of
+ * its dma_buf, the same in every driver and for its whole life, which does
+ * not expose the kernel address.
+ *
+ * The records go to one ring, a slot taken by an atomic increment, and the
+ * sequence number of a record is written last, so that the reader drops
+ * the records being overwritten. "echo 1 > enable" in
+ * /sys/kernel/debug/exynos-frametrace allocates the ring and patches the
+ * branches in, "trace" lists the records, oldest first, with the time in
+ * ns of CLOCK_MONOTONIC.
+ */
+#define EXYNOS_FRAMETRACE_ENTRIES	8192
+
+struct exynos_frametrace_rec {
+	u64	ts;
+	u64	buf;
+	u32	seq;
+	u32	info;
+	u16	stage;
+	u16	cpu;
+	u32	pid;
+};
+
+struct exynos_frametrace_snapshot {
+	unsigned int			nr;
+	struct exynos_frametrace_rec	recs[0];
+};
+
+static const char * const exynos_frametrace_names[] = {
+	[EXYNOS_FRAMETRACE_CAM_QBUF]	= "cam_qbuf",
+	[EXYNOS_FRAMETRACE_CAM_DONE]	= "cam_done",
+	[EXYNOS_FRAMETRACE_GPU_START]	= "gpu_start",
+	[EXYNOS_FRAMETRACE_GPU_DONE]	= "gpu_done",
+	[EXYNOS_FRAMETRACE_MFC_QBUF]	= "mfc_qbuf",
+	[EXYNOS_FRAMETRACE_MFC_DONE]	= "mfc_done",
+	[EXYNOS_FRAMETRACE_DPU_QUEUE]	= "dpu_queue",
+	[EXYNOS_FRAMETRACE_DPU_SCANOUT]	= "dpu_scanout",
+};
+
+DEFINE_STATIC_KEY_FALSE(exynos_frametrace_key);
+EXPORT_SYMBOL_GPL(exynos_frametrace_key);
+
+static struct exynos_frametrace_rec *exynos_frametrace_ring;
+static atomic_t exynos_frametrace_head = ATOMIC_INIT(0);
+static siphash_key_t exynos_frametrace_hash_key __read_mostly;
+static DEFINE_MUTEX(exynos_frametrace_lock);
+
+void __exynos_frametrace(struct dma_buf *dmabuf,
+			 enum exynos_frametrace_stage stage, u32 info)
+{
+	u32 seq = (u32)atomic_inc_return(&exynos_frametrace_head);
+	struct exynos_frametrace_rec *rec;
+
+	/* 0 is never a valid sequence */
+	if (unlikely(!seq))
+		seq = (u32)atomic_inc_return(&exynos_frametrace_head);
+
+	rec = &exynos_frametrace_ring[seq & (EXYNOS_FRAMETRACE_ENTRIES - 1)];
+
+	WRITE_ONCE(rec->seq, 0);
+	smp_wmb();
+
+	rec->ts = ktime_get_ns();
+	rec->buf = siphash_1u64((u64)(unsigned long)dmabuf,
+				&exynos_frametrace_hash_key);
+	rec->info = info;
+	rec->stage = stage;
+	rec->cpu = raw_smp_processor_id();
+	rec->pid = current->pid;
+
+	smp_wmb();
+	WRITE_ONCE(rec->seq, seq);
+}
+EXPORT_SYMBOL_GPL(__exynos_frametrace);
+
+static void *exynos_frametrace_start(struct seq_file *s, loff_t *pos)
+{
+	struct exynos_frametrace_snapshot *snap = s->private;
+
+	if (!*pos)
+		return SEQ_START_TOKEN;
+
+	return *pos <= snap->nr ? &snap->recs[*pos - 1] : NULL;
+}
+
+static void *exynos_frametrace_next(struct seq_file *s, void *v, loff_t *pos)
+{
+	++*pos;
+
+	return exynos_frametrace_start(s, pos);
+}
+
+static void exynos_frametrace_stop(struct seq_file *s, void *v)
+{
+}
+
+static int exynos_frametrace_show(struct seq_file *s, void *v)
+{
+	struct exynos_frametrace_rec *rec = v;
+
+	if (v == SEQ_START_TOKEN) {
+		seq_puts(s, "# ts_ns cpu pid stage buf info\n");
+		return 0;
+	}
+
+	seq_printf(s, "%llu %u %u %s %016llx %u\n", rec->ts, rec->cpu,
+		   rec->pid, rec->stage < EXYNOS_FRAMETRACE_STAGES ?
+		   exynos_frametrace_names[rec->stage] : "?",
+		   rec->buf, rec->info);
+
+	return 0;
+}
+
+static const struct seq_operations exynos_frametrace_sops = {
+	.start	= exynos_frametrace_start,
+	.next	= exynos_frametrace_next,
+	.stop	= exynos_frametrace_stop,
+	.show	= exynos_frametrace_show,
+};
+
+static int exynos_frametrace_open(struct inode *inode, struct file *file)
+{
+	struct exynos_frametrace_snapshot *snap;
+	struct exynos_frametrace_rec *rec;
+	u32 head, seq, i;
+	int ret;
+
+	snap = vzalloc(sizeof(*snap) +
+		       sizeof(*rec) * EXYNOS_FRAMETRACE_ENTRIES);
+	if (!snap)
+		return -ENOMEM;
+
+	mutex_lock(&exynos_frametrace_lock);
+	head = (u32)atomic_read(&exynos_frametrace_head);
+	for (i = 0; exynos_frametrace_ring && i < EXYNOS_FRAMETRACE_ENTRIES;
+	     i++) {
+		seq = head - (EXYNOS_FRAMETRACE_ENTRIES - 1) + i;
+		if (!seq)
+			continue;
+
+		rec = &exynos_frametrace_ring[seq &
+				(EXYNOS_FRAMETRACE_ENTRIES - 1)];
+		if (READ_ONCE(rec->seq) != seq)
+			continue;
+		smp_rmb();
+		snap->recs[snap->nr] = *rec;
+		smp_rmb();
+		/* overwritten while copied */
+		if (READ_ONCE(rec->seq) == seq)
+			snap->nr++;
+	}
+	mutex_unlock(&exynos_frametrace_lock);
+
+	ret = seq_open(file, &exynos_frametrace_sops);
+	if (ret) {
+		vfree(snap);
+		return ret;
+	}
+	((struct seq_file *)file->private_data)->private = snap;
+
+	return 0;
+}
+
+static int exynos_frametrace_release(struct inode *inode, struct file *file)
+{
+	struct seq_file *s = file->private_data;
+
+	vfree(s->private);
+
+	return seq_release(inode, file);
+}
+
+static const struct file_operations exynos_frametrace_fops = {
+	.open		= exynos_frametrace_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= exynos_frametrace_release,
+};
+
+static ssize_t exynos_frametrace_enable_read(struct file *file,
+		char __user *buf, size_t count, loff_t *ppos)
+{
+	char val[2] = { exynos_frametrace_enabled() ? '1' : '0', '\n' };
+
+	return simple_read_from_buffer(buf, count, ppos, val, sizeof(val));
+}
+
+static ssize_t exynos_frametrace_enable_write(struct file *file,
+		const char __user *buf, size_t count, loff_t *ppos)
+{
+	bool enable;
+	int ret;
+
+	ret = kstrtobool_from_user(buf, count, &enable);
+	if (ret)
+		return ret;
+
+	mutex_lock(&exynos_frametrace_lock);
+	if (enable && !exynos_frametrace_ring) {
+		exynos_frametrace_ring = vzalloc(sizeof(*exynos_frametrace_ring) *
+						 EXYNOS_FRAMETRACE_ENTRIES);
+		if (!exynos_frametrace_ring) {
+			mutex_unlock(&exynos_frametrace_lock);
+			return -ENOMEM;
+		}
+		get_random_bytes(&exynos_frametrace_hash_key,
+				 sizeof(exynos_frametrace_hash_key));
+	}
+
+	/* the ring is kept on disable, for the records not read yet */
+	if (enable)
+		static_branch_enable(&exynos_frametrace_key);
+	else
+		static_branch_disable(&exynos_frametrace_key);
+	mutex_unlock(&exynos_frametrace_lock);
+
+	return count;
+}
+
+static const struct file_operations exynos_frametrace_enable_fops = {
+	.open		= simple_open,
+	.read		= exynos_frametrace_enable_read,
+	.write		= exynos_frametrace_enable_write,
+	.llseek		= default_llseek,
+};
+
+static int __init exynos_frametrace_init(void)
+{
+	struct dentry *root;
+
+	root = debugfs_create_dir("exynos-frametrace", NULL);
+	if (IS_ERR_OR_NULL(root))
+		return 0;
+
+	debugfs_create_file("enable", 0600, root, NULL,
+			    &exynos_frametrace_enable_fops);
+	debugfs_create_file("trace", 0400, root, NULL,
+			    &exynos_frametrace_fops);
+
+	return 0;
+}
+late_initcall(exynos_frametrace_init);
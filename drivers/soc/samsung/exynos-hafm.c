@@ -278,35 +278,115 @@ static int request_dvfs_on_sr0(unsigned int req_freq)
 /****************************************************************/
 static void __exynos_hiu_update_data(struct cpufreq_policy *policy);
 
+/* Write req_freq on SR0, mailbox transaction is started */
+static void hiu_start_request(unsigned int req_freq)
+{
+	if (check_hiu_need_register_restore())
+		__exynos_hiu_update_data(NULL);
+
+	request_dvfs_on_sr0(req_freq);
+
+	pr_debug("exynos-hiu: set REQDVFS to HIU : %ukHz\n", req_freq);
+}
+
+/*
+ * Complete the outstanding transaction and take the pending request.
+ * Returns the pending frequency to be requested next, or 0 if there is
+ * no pending request and the mailbox becomes idle.
+ */
+static unsigned int hiu_complete_request(void)
+{
+	unsigned long flags;
+	unsigned int next_freq = 0;
+	u64 latency;
+
+	spin_lock_irqsave(&data->req_lock, flags);
+
+	data->cur_freq = data->inflight_freq;
+
+	latency = ktime_us_delta(ktime_get(), data->inflight_time);
+	data->done_count++;
+	data->latency_sum += latency;
+	if (latency > data->latency_max)
+		data->latency_max = latency;
+
+	if (data->pending_freq) {
+		next_freq = data->pending_freq;
+		data->inflight_freq = next_freq;
+		data->inflight_time = data->pending_time;
+		data->pending_freq = 0;
+	} else {
+		data->req_busy = false;
+	}
+
+	spin_unlock_irqrestore(&data->req_lock, flags);
+
+	return next_freq;
+}
+
+static void hiu_wait_request_done(unsigned int req_freq)
+{
+	while (!check_hiu_normal_req_done(req_freq) &&
+		!check_hiu_mailbox_err_pending())
+		usleep_range(POLL_PERIOD, 2 * POLL_PERIOD);
+
+	if (check_hiu_mailbox_err_pending()) {
+		hiu_mailbox_err_handler();
+		BUG_ON(1);
+	}
+
+	clear_hiu_sr1_irq_pending();
+}
+
+/*
+ * Request DVFS to HIU.
+ * If a mailbox transaction is outstanding, the request is stored in the
+ * request slot and applied when the transaction is completed. A newer
+ * request replaces the stored one, so only the latest value is delivered.
+ */
 int exynos_hiu_set_freq(unsigned int id, unsigned int req_freq)
 {
+	unsigned long flags;
+
 	if (unlikely(!data))
 		return -ENODEV;
 
 	if (!data->enabled)
 		return -ENODEV;
 
-	if (check_hiu_need_register_restore())
-		__exynos_hiu_update_data(NULL);
+	spin_lock_irqsave(&data->req_lock, flags);
 
-	/* Write req_freq on SR0 to request DVFS */
-	request_dvfs_on_sr0(req_freq);
+	data->req_count++;
+
+	if (data->req_busy) {
+		if (data->pending_freq)
+			data->coalesced_count++;
+		else
+			data->pending_time = ktime_get();
+		data->pending_freq = req_freq;
+		spin_unlock_irqrestore(&data->req_lock, flags);
+		return 0;
+	}
 
-	if (data->operation_mode == POLLING_MODE) {
-		while (!check_hiu_normal_req_done(req_freq) &&
-			!check_hiu_mailbox_err_pending())
-			usleep_range(POLL_PERIOD, 2 * POLL_PERIOD);
+	data->req_busy = true;
+	data->inflight_freq = req_freq;
+	data->inflight_time = ktime_get();
 
-		if (check_hiu_mailbox_err_pending()) {
-			hiu_mailbox_err_handler();
-			BUG_ON(1);
-		}
+	spin_unlock_irqrestore(&data->req_lock, flags);
 
-		data->cur_freq = req_freq;
-		clear_hiu_sr1_irq_pending();
-	}
+	hiu_start_request(req_freq);
 
-	pr_debug("exynos-hiu: set REQDVFS to HIU : %ukHz\n", req_freq);
+	/* In interrupt mode, transaction is completed by exynos_hiu_work() */
+	if (data->operation_mode != POLLING_MODE)
+		return 0;
+
+	while (req_freq) {
+		hiu_wait_request_done(req_freq);
+
+		req_freq = hiu_complete_request();
+		if (req_freq)
+			hiu_start_request(req_freq);
+	}
 
 	return 0;
 }
@@ -340,7 +420,21 @@ unsigned int exynos_pstate_get_boost_freq(int cpu)
 /****************************************************************/
 static void exynos_hiu_work(struct work_struct *work)
 {
-	/* TO DO */
+	unsigned int next_freq;
+
+	if (check_hiu_mailbox_err_pending()) {
+		hiu_mailbox_err_handler();
+		BUG_ON(1);
+	}
+
+	if (!check_hiu_sr1_irq_pending())
+		return;
+
+	clear_hiu_sr1_irq_pending();
+
+	next_freq = hiu_complete_request();
+	if (next_freq)
+		hiu_start_request(next_freq);
 }
 
 static irqreturn_t exynos_hiu_irq_handler(int irq, void *id)
@@ -460,16 +554,39 @@ hiu_dvfs_limit_store(struct device *dev, struct device_attribute *devattr,
 	return count;
 }
 
+static ssize_t
+hiu_req_stat_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	unsigned long flags;
+	u64 req, coalesced, done, sum, max;
+
+	spin_lock_irqsave(&data->req_lock, flags);
+	req = data->req_count;
+	coalesced = data->coalesced_count;
+	done = data->done_count;
+	sum = data->latency_sum;
+	max = data->latency_max;
+	spin_unlock_irqrestore(&data->req_lock, flags);
+
+	return snprintf(buf, PAGE_SIZE,
+		"request: %llu\ncoalesced: %llu\ndone: %llu\n"
+		"latency(us): avg=%llu max=%llu\n",
+		req, coalesced, done, done ? div64_u64(sum, done) : 0, max);
+}
+
 static DEVICE_ATTR(enabled, 0644, hiu_enable_show, hiu_enable_store);
 static DEVICE_ATTR(boosted, 0444, hiu_boosted_show, NULL);
 static DEVICE_ATTR(boost_threshold, 0444, hiu_boost_threshold_show, NULL);
 static DEVICE_ATTR(dvfs_limit, 0644, hiu_dvfs_limit_show, hiu_dvfs_limit_store);
+static DEVICE_ATTR(req_stat, 0444, hiu_req_stat_show, NULL);
 
 static struct attribute *exynos_hiu_attrs[] = {
 	&dev_attr_enabled.attr,
 	&dev_attr_boosted.attr,
 	&dev_attr_boost_threshold.attr,
 	&dev_attr_dvfs_limit.attr,
+	&dev_attr_req_stat.attr,
 	NULL,
 };
 
@@ -567,6 +684,7 @@ static int exynos_hiu_probe(struct platform_device *pdev)
 
 	data->base = ioremap(GCU_BASE, SZ_4K);
 	data->pb_delivered = false;
+	spin_lock_init(&data->req_lock);
 
 	ret = hiu_dt_parsing(dn);
 	if (ret) {
@@ -3,6 +3,8 @@
 
 #include <linux/cpufreq.h>
 #include <linux/interrupt.h>
+#include <linux/ktime.h>
+#include <linux/spinlock.h>
 
 /* Function Id to Enable HIU in EL3 */
 #define GCU_BASE		(0x1E4C0000)
@@ -153,6 +155,24 @@ struct exynos_hiu_data {
 
 	struct device_node *	dn;
 	struct hiu_stats *	stats;
+
+	/*
+	 * Request slot. Only one mailbox transaction is outstanding, and
+	 * requests arriving meanwhile overwrite pending_freq.
+	 */
+	spinlock_t		req_lock;
+	bool			req_busy;
+	unsigned int		inflight_freq;
+	ktime_t			inflight_time;
+	unsigned int		pending_freq;
+	ktime_t			pending_time;
+
+	/* request statistics */
+	u64			req_count;
+	u64			coalesced_count;
+	u64			done_count;
+	u64			latency_sum;
+	u64			latency_max;
 };
 
 #if defined(CONFIG_EXYNOS_PSTATE_HAFM) || defined(CONFIG_EXYNOS_PSTATE_HAFM_TB)
@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *
+ * IRQ affinity balancer for Exynos
+ *
+ * Interrupts described in the device tree are placed according to the set
+ * of online cpus. Latency sensitive interrupts are pinned to dedicated cpus
+ * and the others are spread across the remaining cpus by measured rate, so
+ * that they do not pile up on a single little core when EMC or cpuhp takes
+ * cores offline.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/cpu.h>
+#include <linux/cpuhotplug.h>
+#include <linux/interrupt.h>
+#include <linux/irq.h>
+#include <linux/irqdesc.h>
+#include <linux/kernel_stat.h>
+#include <linux/of.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+
+#define IRQB_MAX_IRQS		32
+#define IRQB_INTERVAL_MS	1000
+
+/* interrupt description from device tree */
+struct irqb_entry {
+	const char		*name;
+	bool			pinned;
+	struct cpumask		cpus;
+};
+
+/* interrupt resolved from an entry */
+struct irqb_irq {
+	unsigned int		irq;
+	struct irqb_entry	*entry;
+	unsigned int		last_count;
+	unsigned int		rate;		/* interrupts per second */
+	int			cpu;		/* -1 unless balanced to a cpu */
+};
+
+static struct {
+	bool			enabled;
+	unsigned int		interval_ms;
+	struct cpumask		balance_cpus;
+
+	struct irqb_entry	*entries;
+	int			entry_count;
+
+	struct irqb_irq		irqs[IRQB_MAX_IRQS];
+	int			irq_count;
+
+	unsigned long		balance_count;
+	unsigned long		move_count;
+
+	struct mutex		lock;
+	struct delayed_work	work;
+	struct kobject		*kobj;
+} irqb;
+
+/**********************************************************************
+ *                          Balancing policy                          *
+ **********************************************************************/
+/*
+ * Interrupts can be requested after boot (MFC, modem), so interrupt numbers
+ * are resolved from action names at every balancing.
+ */
+static void irqb_resolve_irqs(void)
+{
+	struct irqb_irq old[IRQB_MAX_IRQS];
+	int old_count = irqb.irq_count;
+	struct irq_desc *desc;
+	unsigned int irq;
+	int i, j;
+
+	memcpy(old, irqb.irqs, sizeof(old));
+	irqb.irq_count = 0;
+
+	for_each_irq_desc(irq, desc) {
+		struct irqaction *action;
+		struct irqb_irq *birq;
+		unsigned long flags;
+
+		if (irqd_is_per_cpu(&desc->irq_data))
+			continue;
+
+		raw_spin_lock_irqsave(&desc->lock, flags);
+		action = desc->action;
+		for (i = 0; action && action->name && i < irqb.entry_count; i++)
+			if (!strcmp(action->name, irqb.entries[i].name))
+				break;
+		if (!action || !action->name)
+			i = irqb.entry_count;
+		raw_spin_unlock_irqrestore(&desc->lock, flags);
+
+		if (i == irqb.entry_count)
+			continue;
+
+		if (irqb.irq_count >= IRQB_MAX_IRQS)
+			break;
+
+		birq = &irqb.irqs[irqb.irq_count++];
+		birq->irq = irq;
+		birq->entry = &irqb.entries[i];
+		birq->last_count = kstat_irqs(irq);
+		birq->rate = 0;
+		birq->cpu = -1;
+
+		/* keep history of interrupt already known */
+		for (j = 0; j < old_count; j++) {
+			if (old[j].irq != irq)
+				continue;
+
+			birq->last_count = old[j].last_count;
+			birq->rate = old[j].rate;
+			birq->cpu = old[j].cpu;
+			break;
+		}
+	}
+}
+
+/*
+ * Rate is measured over the periodic window only. Balancing from hotplug
+ * callbacks reuses the last measured rate.
+ */
+static void irqb_update_rate(unsigned int interval_ms)
+{
+	int i;
+
+	if (!interval_ms)
+		return;
+
+	for (i = 0; i < irqb.irq_count; i++) {
+		struct irqb_irq *birq = &irqb.irqs[i];
+		unsigned int count = kstat_irqs(birq->irq);
+
+		birq->rate = (count - birq->last_count) * MSEC_PER_SEC
+							/ interval_ms;
+		birq->last_count = count;
+	}
+}
+
+static void irqb_set_affinity(struct irqb_irq *birq, const struct cpumask *mask)
+{
+	struct irq_desc *desc = irq_to_desc(birq->irq);
+
+	if (!desc || cpumask_equal(desc->irq_common_data.affinity, mask))
+		return;
+
+	if (irq_set_affinity(birq->irq, mask))
+		return;
+
+	irqb.move_count++;
+}
+
+/*
+ * Pinned interrupts go to their dedicated cpus. Balanced interrupts are
+ * assigned from the highest rate to the non-dedicated cpu with the least
+ * assigned rate. Current cpu is kept on a tie to avoid needless migration.
+ */
+static void __irqb_balance(int dying_cpu, unsigned int interval_ms)
+{
+	struct cpumask avail, dedicated, spread, mask;
+	unsigned long load[NR_CPUS] = { 0, };
+	bool assigned[IRQB_MAX_IRQS] = { 0, };
+	int i, cpu;
+
+	cpumask_and(&avail, &irqb.balance_cpus, cpu_online_mask);
+	if (dying_cpu >= 0)
+		cpumask_clear_cpu(dying_cpu, &avail);
+	if (cpumask_empty(&avail))
+		return;
+
+	irqb_resolve_irqs();
+	irqb_update_rate(interval_ms);
+
+	cpumask_clear(&dedicated);
+	for (i = 0; i < irqb.entry_count; i++)
+		if (irqb.entries[i].pinned)
+			cpumask_or(&dedicated, &dedicated, &irqb.entries[i].cpus);
+	cpumask_and(&dedicated, &dedicated, &avail);
+
+	cpumask_andnot(&spread, &avail, &dedicated);
+	if (cpumask_empty(&spread))
+		cpumask_copy(&spread, &avail);
+
+	for (i = 0; i < irqb.irq_count; i++) {
+		struct irqb_irq *birq = &irqb.irqs[i];
+
+		if (!birq->entry->pinned)
+			continue;
+
+		cpumask_and(&mask, &birq->entry->cpus, &avail);
+		if (cpumask_empty(&mask))
+			cpumask_copy(&mask, &spread);
+
+		birq->cpu = -1;
+		irqb_set_affinity(birq, &mask);
+	}
+
+	for (;;) {
+		struct irqb_irq *birq = NULL;
+		int best_cpu = -1;
+
+		for (i = 0; i < irqb.irq_count; i++) {
+			if (assigned[i] || irqb.irqs[i].entry->pinned)
+				continue;
+
+			if (!birq || irqb.irqs[i].rate > birq->rate)
+				birq = &irqb.irqs[i];
+		}
+
+		if (!birq)
+			break;
+
+		assigned[birq - irqb.irqs] = true;
+
+		cpumask_and(&mask, &birq->entry->cpus, &spread);
+		if (cpumask_empty(&mask))
+			cpumask_copy(&mask, &spread);
+
+		for_each_cpu(cpu, &mask) {
+			if (best_cpu < 0 || load[cpu] < load[best_cpu])
+				best_cpu = cpu;
+			else if (load[cpu] == load[best_cpu] && cpu == birq->cpu)
+				best_cpu = cpu;
+		}
+
+		/* count one for idle interrupt so that they are spread too */
+		load[best_cpu] += birq->rate + 1;
+		birq->cpu = best_cpu;
+		irqb_set_affinity(birq, cpumask_of(best_cpu));
+	}
+
+	irqb.balance_count++;
+}
+
+static void irqb_balance(int dying_cpu)
+{
+	mutex_lock(&irqb.lock);
+	if (irqb.enabled)
+		__irqb_balance(dying_cpu, 0);
+	mutex_unlock(&irqb.lock);
+}
+
+static void irqb_work_fn(struct work_struct *work)
+{
+	mutex_lock(&irqb.lock);
+	if (irqb.enabled)
+		__irqb_balance(-1, irqb.interval_ms);
+	mutex_unlock(&irqb.lock);
+
+	schedule_delayed_work(&irqb.work, msecs_to_jiffies(irqb.interval_ms));
+}
+
+/*
+ * Both EMC mode change and cpuhp request go through cpu hotplug, so
+ * interrupts are replaced in the hotplug callbacks. Interrupts are moved
+ * off the dying cpu before the generic migration picks an arbitrary one.
+ */
+static int irqb_cpu_online(unsigned int cpu)
+{
+	irqb_balance(-1);
+
+	return 0;
+}
+
+static int irqb_cpu_offline(unsigned int cpu)
+{
+	irqb_balance(cpu);
+
+	return 0;
+}
+
+/**********************************************************************
+ *                             Sysfs                                  *
+ **********************************************************************/
+static ssize_t show_enabled(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return snprintf(buf, 10, "%d\n", irqb.enabled);
+}
+
+static ssize_t store_enabled(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf,
+		size_t count)
+{
+	int input;
+
+	if (!sscanf(buf, "%d", &input))
+		return -EINVAL;
+
+	mutex_lock(&irqb.lock);
+	irqb.enabled = !!input;
+	if (irqb.enabled)
+		__irqb_balance(-1, 0);
+	mutex_unlock(&irqb.lock);
+
+	return count;
+}
+
+static ssize_t show_status(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	ssize_t ret = 0;
+	int i;
+
+	mutex_lock(&irqb.lock);
+
+	ret += snprintf(buf + ret, PAGE_SIZE - ret, "balance=%lu move=%lu\n",
+			irqb.balance_count, irqb.move_count);
+	ret += snprintf(buf + ret, PAGE_SIZE - ret, "%5s %-20s %10s %s\n",
+			"irq", "name", "rate", "cpu");
+
+	for (i = 0; i < irqb.irq_count; i++) {
+		struct irqb_irq *birq = &irqb.irqs[i];
+
+		if (birq->entry->pinned)
+			ret += snprintf(buf + ret, PAGE_SIZE - ret,
+					"%5u %-20s %10u pinned(%*pbl)\n",
+					birq->irq, birq->entry->name, birq->rate,
+					cpumask_pr_args(&birq->entry->cpus));
+		else
+			ret += snprintf(buf + ret, PAGE_SIZE - ret,
+					"%5u %-20s %10u %d\n",
+					birq->irq, birq->entry->name, birq->rate,
+					birq->cpu);
+	}
+
+	mutex_unlock(&irqb.lock);
+
+	return ret;
+}
+
+static struct kobj_attribute irqb_enabled =
+__ATTR(enabled, 0644, show_enabled, store_enabled);
+static struct kobj_attribute irqb_status =
+__ATTR(status, 0444, show_status, NULL);
+
+static struct attribute *irqb_attrs[] = {
+	&irqb_enabled.attr,
+	&irqb_status.attr,
+	NULL,
+};
+
+static const struct attribute_group irqb_group = {
+	.attrs = irqb_attrs,
+};
+
+/**********************************************************************
+ *                          Initialization                            *
+ **********************************************************************/
+static int __init irqb_parse_dt(struct device_node *dn)
+{
+	struct device_node *child;
+	const char *buf;
+	int index = 0;
+
+	if (of_property_read_u32(dn, "interval-ms", &irqb.interval_ms))
+		irqb.interval_ms = IRQB_INTERVAL_MS;
+
+	if (!of_property_read_string(dn, "balance-cpus", &buf))
+		cpulist_parse(buf, &irqb.balance_cpus);
+	else
+		cpumask_copy(&irqb.balance_cpus, cpu_possible_mask);
+
+	irqb.entry_count = of_get_child_count(dn);
+	if (!irqb.entry_count)
+		return -ENODEV;
+
+	irqb.entries = kcalloc(irqb.entry_count, sizeof(struct irqb_entry),
+							GFP_KERNEL);
+	if (!irqb.entries)
+		return -ENOMEM;
+
+	for_each_child_of_node(dn, child) {
+		struct irqb_entry *entry = &irqb.entries[index];
+
+		if (of_property_read_string(child, "irq-name", &entry->name))
+			continue;
+
+		if (!of_property_read_string(child, "pinned-cpus", &buf)) {
+			cpulist_parse(buf, &entry->cpus);
+			entry->pinned = true;
+		} else {
+			cpumask_copy(&entry->cpus, cpu_possible_mask);
+		}
+
+		index++;
+	}
+
+	irqb.entry_count = index;
+
+	return 0;
+}
+
+static int __init exynos_irqbalance_init(void)
+{
+	struct device_node *dn;
+	int ret;
+
+	dn = of_find_node_by_path("/exynos-irqbalance");
+	if (!dn)
+		return 0;
+
+	mutex_init(&irqb.lock);
+	INIT_DELAYED_WORK(&irqb.work, irqb_work_fn);
+
+	ret = irqb_parse_dt(dn);
+	of_node_put(dn);
+	if (ret) {
+		pr_err("exynos-irqbalance: failed to parse dt(%d)\n", ret);
+		return ret;
+	}
+
+	irqb.enabled = true;
+
+	ret = cpuhp_setup_state_nocalls(CPUHP_AP_ONLINE_DYN,
+			"exynos_irqbalance", irqb_cpu_online, irqb_cpu_offline);
+	if (ret < 0) {
+		pr_err("exynos-irqbalance: failed to register cpuhp(%d)\n", ret);
+		return ret;
+	}
+
+	irqb.kobj = kobject_create_and_add("irqbalance", power_kobj);
+	if (!irqb.kobj || sysfs_create_group(irqb.kobj, &irqb_group))
+		pr_err("exynos-irqbalance: failed to create sysfs\n");
+
+	irqb_balance(-1);
+	schedule_delayed_work(&irqb.work, msecs_to_jiffies(irqb.interval_ms));
+
+	return 0;
+}
+late_initcall(exynos_irqbalance_init);
@@ -17,6 +17,7 @@
 #include <linux/uaccess.h>
 
 #include <soc/samsung/exynos-pd.h>
+#include <soc/samsung/exynos-probe.h>
 
 #ifdef CONFIG_DEBUG_FS
 static struct dentry *exynos_pd_dbg_root;
@@ -180,8 +181,11 @@ static ssize_t exynos_pd_dbg_write(struct file *file, const char __user *user_bu
 	case 'c':
 		exynos_pd_dbg_long_test(dev);
 		break;
+	case 's':
+		exynos_pd_show_power_domain();
+		break;
 	default:
-		pr_err("%s %s: Invalid input ['0'|'1'|'c']\n",
+		pr_err("%s %s: Invalid input ['0'|'1'|'c'|'s']\n",
 				EXYNOS_PD_DBG_PREFIX, __func__);
 		break;
 	}
@@ -319,6 +323,7 @@ static struct platform_driver exynos_pd_dbg_drv = {
 	.remove		= exynos_pd_dbg_remove,
 	.driver		= {
 		.name	= "exynos_pd_dbg",
+		.probe_type = EXYNOS_PROBE_NONCRITICAL,
 		.owner	= THIS_MODULE,
 		.pm	= &exynos_pd_dbg_pm_ops,
 #ifdef CONFIG_OF
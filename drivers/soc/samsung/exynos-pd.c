@@ -18,6 +18,7 @@
 #include <linux/apm-exynos.h>
 #include <sound/samsung/abox.h>
 #include <linux/sec_debug.h>
+#include <linux/suspend.h>
 
 struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name)
 {
@@ -100,9 +101,71 @@ static void exynos_pd_prepare_forced_off(struct exynos_pm_domain *pd)
 {
 }
 
+static void exynos_pd_account(unsigned int *count, u64 *total_ns,
+			      u64 *max_ns, ktime_t begin)
+{
+	u64 ns = ktime_to_ns(ktime_sub(ktime_get(), begin));
+
+	(*count)++;
+	*total_ns += ns;
+	if (ns > *max_ns)
+		*max_ns = ns;
+}
+
+/*
+ * Media IPs power their domain on again shortly after each job. The intervals
+ * between an off request and the next on request are averaged, and off
+ * requests are held for a delay that covers most of them, so that the domain
+ * is not powered off and on again, nor the IPs re-initialised, between jobs.
+ * An interval longer than worth waiting for counts as twice the maximum delay
+ * so that one long idle does not spoil what was learned.
+ */
+static void exynos_pd_learn_reuse(struct exynos_pm_domain *pd)
+{
+	u64 interval, cap;
+
+	if (!pd->off_delay_max_ms || !pd->off_request)
+		return;
+
+	cap = 2ULL * pd->off_delay_max_ms * NSEC_PER_MSEC;
+	interval = min_t(u64, ktime_to_ns(ktime_sub(ktime_get(),
+					pd->off_request)), cap);
+	pd->off_request = 0;
+
+	if (pd->reuse_avg_ns)
+		pd->reuse_avg_ns = (pd->reuse_avg_ns * 7 + interval) >> 3;
+	else
+		pd->reuse_avg_ns = interval;
+}
+
+static unsigned int exynos_pd_off_delay_ms(struct exynos_pm_domain *pd)
+{
+	u64 avg_ms;
+
+	if (!pd->off_delay_max_ms || !pd->reuse_avg_ns)
+		return 0;
+
+	avg_ms = div_u64(pd->reuse_avg_ns, NSEC_PER_MSEC);
+	if (avg_ms >= pd->off_delay_max_ms)
+		return 0;
+
+	return min_t(u64, 2 * avg_ms + 1, pd->off_delay_max_ms);
+}
+
+/* Power off now a domain whose power-off was deferred */
+static void exynos_pd_flush_deferred_off(struct exynos_pm_domain *pd)
+{
+	if (!pd->power_off_deferred)
+		return;
+
+	mod_delayed_work(system_power_efficient_wq, &pd->off_work, 0);
+	flush_delayed_work(&pd->off_work);
+}
+
 static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 {
 	struct exynos_pm_domain *pd = container_of(genpd, struct exynos_pm_domain, genpd);
+	ktime_t begin;
 	int ret = 0;
 
 	mutex_lock(&pd->access_lock);
@@ -114,11 +177,22 @@ static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 		goto acc_unlock;
 	}
 
+	exynos_pd_learn_reuse(pd);
+
+	if (pd->power_off_deferred) {
+		/* Still powered, the work sees the flag cleared if it runs */
+		cancel_delayed_work(&pd->off_work);
+		pd->power_off_deferred = false;
+		pd->deferred_hits++;
+		goto acc_unlock;
+	}
+
 	if (pd->power_down_skipped) {
 		pr_info(EXYNOS_PD_PREFIX "%s power-on is skipped.\n", pd->name);
 		goto acc_unlock;
 	}
 
+	begin = ktime_get();
 	exynos_pd_power_on_pre(pd);
 
 	ret = pd->pd_control(pd->cal_pdid, 1);
@@ -130,6 +204,8 @@ static int exynos_pd_power_on(struct generic_pm_domain *genpd)
 	}
 
 	exynos_pd_power_on_post(pd);
+	exynos_pd_account(&pd->on_count, &pd->on_total_ns, &pd->on_max_ns,
+			  begin);
 
 acc_unlock:
 	DEBUG_PRINT_INFO("%s(%s)-, ret = %d\n", __func__, pd->name, ret);
@@ -138,9 +214,59 @@ acc_unlock:
 	return ret;
 }
 
+/* Must be called with access_lock held */
+static int __exynos_pd_power_off(struct exynos_pm_domain *pd)
+{
+	struct generic_pm_domain *genpd = &pd->genpd;
+	ktime_t begin = ktime_get();
+	int ret;
+
+	exynos_pd_power_off_pre(pd);
+
+	ret = pd->pd_control(pd->cal_pdid, 0);
+	if (unlikely(ret)) {
+		if (ret == -4) {
+			pr_err(EXYNOS_PD_PREFIX "Timed out during %s  power off! -> forced power off\n", genpd->name);
+			exynos_pd_prepare_forced_off(pd);
+			ret = pd->pd_control(pd->cal_pdid, 0);
+			if (unlikely(ret)) {
+				pr_auto(ASL1, EXYNOS_PD_PREFIX "%s occur error at power off!\n", genpd->name);
+				sec_debug_set_extra_info_epd((char *)(genpd->name));
+				return ret;
+			}
+		} else {
+			pr_auto(ASL1, EXYNOS_PD_PREFIX "%s occur error at power off!!\n", genpd->name);
+			sec_debug_set_extra_info_epd((char *)(genpd->name));
+			return ret;
+		}
+	}
+
+	exynos_pd_power_off_post(pd);
+	pd->power_down_skipped = false;
+	exynos_pd_account(&pd->off_count, &pd->off_total_ns, &pd->off_max_ns,
+			  begin);
+
+	return 0;
+}
+
+static void exynos_pd_off_work(struct work_struct *work)
+{
+	struct exynos_pm_domain *pd = container_of(to_delayed_work(work),
+					struct exynos_pm_domain, off_work);
+
+	mutex_lock(&pd->access_lock);
+	if (pd->power_off_deferred) {
+		pd->power_off_deferred = false;
+		pd->deferred_misses++;
+		__exynos_pd_power_off(pd);
+	}
+	mutex_unlock(&pd->access_lock);
+}
+
 static int exynos_pd_power_off(struct generic_pm_domain *genpd)
 {
 	struct exynos_pm_domain *pd = container_of(genpd, struct exynos_pm_domain, genpd);
+	struct gpd_link *link;
 	int ret = 0;
 
 	mutex_lock(&pd->access_lock);
@@ -158,28 +284,23 @@ static int exynos_pd_power_off(struct generic_pm_domain *genpd)
 		goto acc_unlock;
 	}
 
-	exynos_pd_power_off_pre(pd);
+	/* Sub-domains held on must be powered off before their parent */
+	list_for_each_entry(link, &genpd->master_links, master_node)
+		exynos_pd_flush_deferred_off(container_of(link->slave,
+					struct exynos_pm_domain, genpd));
 
-	ret = pd->pd_control(pd->cal_pdid, 0);
-	if (unlikely(ret)) {
-		if (ret == -4) {
-			pr_err(EXYNOS_PD_PREFIX "Timed out during %s  power off! -> forced power off\n", genpd->name);
-			exynos_pd_prepare_forced_off(pd);
-			ret = pd->pd_control(pd->cal_pdid, 0);
-			if (unlikely(ret)) {
-				pr_auto(ASL1, EXYNOS_PD_PREFIX "%s occur error at power off!\n", genpd->name);
-				sec_debug_set_extra_info_epd((char *)(genpd->name));
-				goto acc_unlock;
-			}
-		} else {
-			pr_auto(ASL1, EXYNOS_PD_PREFIX "%s occur error at power off!!\n", genpd->name);
-			sec_debug_set_extra_info_epd((char *)(genpd->name));
-			goto acc_unlock;
-		}
+	pd->off_request = ktime_get();
+	pd->off_delay_ms = exynos_pd_off_delay_ms(pd);
+
+	/* No delay once the system is suspending */
+	if (pd->off_delay_ms && !genpd->prepared_count) {
+		pd->power_off_deferred = true;
+		queue_delayed_work(system_power_efficient_wq, &pd->off_work,
+				   msecs_to_jiffies(pd->off_delay_ms));
+		goto acc_unlock;
 	}
 
-	exynos_pd_power_off_post(pd);
-	pd->power_down_skipped = false;
+	ret = __exynos_pd_power_off(pd);
 
 acc_unlock:
 	DEBUG_PRINT_INFO("%s(%s)-, ret = %d\n", __func__, pd->name, ret);
@@ -276,7 +397,7 @@ static int exynos_pd_genpd_init(struct exynos_pm_domain *pd, int state)
  *
  * read the status of power domain and show it.
  */
-static void exynos_pd_show_power_domain(void)
+void exynos_pd_show_power_domain(void)
 {
 	struct device_node *np;
 	for_each_compatible_node(np, NULL, "samsung,exynos-pd") {
@@ -290,12 +411,31 @@ static void exynos_pd_show_power_domain(void)
 			pd = platform_get_drvdata(pdev);
 			pr_info("   %-9s - %-3s\n", pd->genpd.name,
 					cal_pd_status(pd->cal_pdid) ? "on" : "off");
+
+			mutex_lock(&pd->access_lock);
+			pr_info("      on  %u, avg %llu us, max %llu us\n",
+				pd->on_count,
+				pd->on_count ? div_u64(pd->on_total_ns /
+					pd->on_count, NSEC_PER_USEC) : 0,
+				div_u64(pd->on_max_ns, NSEC_PER_USEC));
+			pr_info("      off %u, avg %llu us, max %llu us\n",
+				pd->off_count,
+				pd->off_count ? div_u64(pd->off_total_ns /
+					pd->off_count, NSEC_PER_USEC) : 0,
+				div_u64(pd->off_max_ns, NSEC_PER_USEC));
+			if (pd->off_delay_max_ms)
+				pr_info("      off delay %u/%u ms, reuse avg %llu us, hits %u, misses %u\n",
+					pd->off_delay_ms, pd->off_delay_max_ms,
+					div_u64(pd->reuse_avg_ns, NSEC_PER_USEC),
+					pd->deferred_hits, pd->deferred_misses);
+			mutex_unlock(&pd->access_lock);
 		} else
 			pr_info("   %-9s - %s\n", np->name, "on,  always");
 	}
 
 	return;
 }
+EXPORT_SYMBOL(exynos_pd_show_power_domain);
 
 static __init int exynos_pd_dt_parse(void)
 {
@@ -335,6 +475,9 @@ static __init int exynos_pd_dt_parse(void)
 		pd->devfreq_index = of_get_devfreq_sync_volt_idx(pd->of_node);
 		of_get_power_down_ok(pd);
 		pd->power_down_skipped = false;
+		of_property_read_u32(np, "power-off-delay-max-ms",
+				     &pd->off_delay_max_ms);
+		INIT_DELAYED_WORK(&pd->off_work, exynos_pd_off_work);
 
 		ret = of_property_read_u32(np, "need_smc", (u32 *)&pd->need_smc);
 		if (ret) {
@@ -398,6 +541,7 @@ static __init int exynos_pd_dt_parse(void)
 			}
 
 			mutex_init(&sub_pd->access_lock);
+			INIT_DELAYED_WORK(&sub_pd->off_work, exynos_pd_off_work);
 			platform_set_drvdata(sub_pdev, sub_pd);
 
 			ret = exynos_pd_genpd_init(sub_pd, initial_state);
@@ -463,6 +607,38 @@ static __init int exynos_pd_dt_parse(void)
 }
 #endif /* CONFIG_OF */
 
+/* Power off before suspend the domains held on */
+static int exynos_pd_pm_notifier(struct notifier_block *nb,
+				 unsigned long event, void *data)
+{
+	struct device_node *np;
+
+	if (event != PM_SUSPEND_PREPARE)
+		return NOTIFY_DONE;
+
+	for_each_compatible_node(np, NULL, "samsung,exynos-pd") {
+		struct platform_device *pdev;
+		struct exynos_pm_domain *pd;
+
+		if (!of_device_is_available(np))
+			continue;
+
+		pdev = of_find_device_by_node(np);
+		if (!pdev)
+			continue;
+
+		pd = platform_get_drvdata(pdev);
+		if (pd)
+			exynos_pd_flush_deferred_off(pd);
+	}
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block exynos_pd_pm_nb = {
+	.notifier_call = exynos_pd_pm_notifier,
+};
+
 static int __init exynos_pd_init(void)
 {
 	int ret;
@@ -478,6 +654,8 @@ static int __init exynos_pd_init(void)
 		/* show information of power domain registration */
 		exynos_pd_show_power_domain();
 
+		register_pm_notifier(&exynos_pd_pm_nb);
+
 		return 0;
 	}
 #endif
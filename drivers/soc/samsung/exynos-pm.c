@@ -20,6 +20,9 @@
 #include <linux/slab.h>
 #include <linux/psci.h>
 #include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/seq_file.h>
+#include <trace/events/power.h>
 #include <asm/cpuidle.h>
 #include <asm/smp_plat.h>
 
@@ -441,6 +444,178 @@ bool is_test_usbl2_suspend_set(void)
 EXPORT_SYMBOL_GPL(is_test_usbl2_suspend_set);
 
 #ifdef CONFIG_DEBUG_FS
+/*
+ * Device suspend/resume profiler. The device PM callbacks are timed through
+ * the device_pm_callback_start/end tracepoints, and those longer than
+ * dev_pm_min_us are kept in a ring, which is cleared when a suspend starts
+ * so that it holds the last cycle.
+ */
+#define DEV_PM_RING_SIZE	256
+#define DEV_PM_INFLIGHT		32
+#define DEV_PM_NAME_LEN		32
+
+struct dev_pm_record {
+	char name[DEV_PM_NAME_LEN];
+	const char *info;
+	int event;
+	int error;
+	u64 start_ns;
+	u64 time_ns;
+};
+
+static struct {
+	struct device *dev;
+	const char *info;
+	int event;
+	u64 start_ns;
+} dev_pm_inflight[DEV_PM_INFLIGHT];
+
+static struct dev_pm_record dev_pm_ring[DEV_PM_RING_SIZE];
+static unsigned int dev_pm_head, dev_pm_count, dev_pm_dropped;
+static u32 dev_pm_min_us = 100;
+static DEFINE_SPINLOCK(dev_pm_lock);
+
+static void exynos_pm_callback_start(void *data, struct device *dev,
+				     const char *pm_ops, int event)
+{
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&dev_pm_lock, flags);
+	for (i = 0; i < DEV_PM_INFLIGHT; i++) {
+		if (dev_pm_inflight[i].dev)
+			continue;
+
+		dev_pm_inflight[i].dev = dev;
+		dev_pm_inflight[i].info = pm_ops;
+		dev_pm_inflight[i].event = event;
+		dev_pm_inflight[i].start_ns = ktime_get_ns();
+		break;
+	}
+	if (i == DEV_PM_INFLIGHT)
+		dev_pm_dropped++;
+	spin_unlock_irqrestore(&dev_pm_lock, flags);
+}
+
+static void exynos_pm_callback_end(void *data, struct device *dev, int error)
+{
+	struct dev_pm_record *rec;
+	unsigned long flags;
+	u64 now = ktime_get_ns();
+	int i;
+
+	spin_lock_irqsave(&dev_pm_lock, flags);
+	for (i = 0; i < DEV_PM_INFLIGHT; i++) {
+		if (dev_pm_inflight[i].dev != dev)
+			continue;
+
+		dev_pm_inflight[i].dev = NULL;
+		if (now - dev_pm_inflight[i].start_ns < (u64)dev_pm_min_us * NSEC_PER_USEC)
+			break;
+
+		rec = &dev_pm_ring[dev_pm_head];
+		strlcpy(rec->name, dev_name(dev), sizeof(rec->name));
+		rec->info = dev_pm_inflight[i].info;
+		rec->event = dev_pm_inflight[i].event;
+		rec->error = error;
+		rec->start_ns = dev_pm_inflight[i].start_ns;
+		rec->time_ns = now - rec->start_ns;
+
+		dev_pm_head = (dev_pm_head + 1) % DEV_PM_RING_SIZE;
+		if (dev_pm_count < DEV_PM_RING_SIZE)
+			dev_pm_count++;
+		break;
+	}
+	spin_unlock_irqrestore(&dev_pm_lock, flags);
+}
+
+static const char *exynos_pm_event_name(int event)
+{
+	switch (event) {
+	case PM_EVENT_SUSPEND:
+		return "suspend";
+	case PM_EVENT_RESUME:
+		return "resume";
+	case PM_EVENT_FREEZE:
+		return "freeze";
+	case PM_EVENT_QUIESCE:
+		return "quiesce";
+	case PM_EVENT_HIBERNATE:
+		return "hibernate";
+	case PM_EVENT_THAW:
+		return "thaw";
+	case PM_EVENT_RESTORE:
+		return "restore";
+	case PM_EVENT_RECOVER:
+		return "recover";
+	default:
+		return "(unknown)";
+	}
+}
+
+static int exynos_pm_dev_time_show(struct seq_file *s, void *unused)
+{
+	struct dev_pm_record *rec;
+	unsigned int i, n, head, dropped;
+	unsigned long flags;
+
+	spin_lock_irqsave(&dev_pm_lock, flags);
+	n = dev_pm_count;
+	head = dev_pm_head;
+	dropped = dev_pm_dropped;
+	spin_unlock_irqrestore(&dev_pm_lock, flags);
+
+	seq_printf(s, "callbacks longer than %u us, %u untracked\n",
+			dev_pm_min_us, dropped);
+	seq_printf(s, "%-12s %-10s %-24s %-32s %10s %s\n",
+			"start(us)", "event", "callback", "device", "time(us)", "error");
+
+	for (i = 0; i < n; i++) {
+		/* records may be overwritten while printed, it is a debug aid */
+		rec = &dev_pm_ring[(head + DEV_PM_RING_SIZE - n + i) % DEV_PM_RING_SIZE];
+		seq_printf(s, "%-12llu %-10s %-24s %-32s %10llu %d\n",
+				div_u64(rec->start_ns, NSEC_PER_USEC),
+				exynos_pm_event_name(rec->event), rec->info,
+				rec->name, div_u64(rec->time_ns, NSEC_PER_USEC),
+				rec->error);
+	}
+
+	return 0;
+}
+
+static int exynos_pm_dev_time_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, exynos_pm_dev_time_show, inode->i_private);
+}
+
+static const struct file_operations exynos_pm_dev_time_fops = {
+	.open		= exynos_pm_dev_time_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int exynos_pm_dev_time_notifier(struct notifier_block *nb,
+				       unsigned long event, void *unused)
+{
+	unsigned long flags;
+
+	if (event != PM_SUSPEND_PREPARE)
+		return NOTIFY_DONE;
+
+	spin_lock_irqsave(&dev_pm_lock, flags);
+	dev_pm_head = 0;
+	dev_pm_count = 0;
+	dev_pm_dropped = 0;
+	spin_unlock_irqrestore(&dev_pm_lock, flags);
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block exynos_pm_dev_time_nb = {
+	.notifier_call = exynos_pm_dev_time_notifier,
+};
+
 static void __init exynos_pm_debugfs_init(void)
 {
 	struct dentry *root, *d;
@@ -478,6 +653,30 @@ static void __init exynos_pm_debugfs_init(void)
 					EXYNOS_PM_PREFIX, __func__);
 		return;
 	}
+
+	d = debugfs_create_u32("dev_pm_min_us", 0644, root, &dev_pm_min_us);
+	if (!d) {
+		pr_err("%s %s: could't create debugfs dev_pm_min_us\n",
+					EXYNOS_PM_PREFIX, __func__);
+		return;
+	}
+
+	d = debugfs_create_file("dev_pm_time", 0444, root, NULL,
+				&exynos_pm_dev_time_fops);
+	if (!d) {
+		pr_err("%s %s: could't create debugfs dev_pm_time\n",
+					EXYNOS_PM_PREFIX, __func__);
+		return;
+	}
+
+	if (register_trace_device_pm_callback_start(exynos_pm_callback_start, NULL) ||
+	    register_trace_device_pm_callback_end(exynos_pm_callback_end, NULL)) {
+		pr_err("%s %s: could't register device pm tracepoints\n",
+					EXYNOS_PM_PREFIX, __func__);
+		return;
+	}
+
+	register_pm_notifier(&exynos_pm_dev_time_nb);
 }
 #endif
 
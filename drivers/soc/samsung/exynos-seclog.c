@@ -27,6 +27,7 @@
 #include <linux/debugfs.h>
 #include <linux/smc.h>
 
+#include <soc/samsung/exynos-probe.h>
 #include <soc/samsung/exynos-seclog.h>
 
 /*
@@ -336,6 +337,7 @@ static struct platform_driver exynos_seclog_driver = {
 	.probe = exynos_seclog_probe,
 	.driver = {
 		.name = "exynos-seclog",
+		.probe_type = EXYNOS_PROBE_NONCRITICAL,
 		.owner = THIS_MODULE,
 		.of_match_table = of_match_ptr(exynos_seclog_of_match_table),
 	}
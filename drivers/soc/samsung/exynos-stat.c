@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * Per-cpu statistics of the Exynos drivers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+
+#include <soc/samsung/exynos-stat.h>
+
+/*
+ * Each stat has a file in /sys/kernel/debug/exynos-stat with its counters
+ * and the non-empty buckets of its histograms as "lower bound:count", and
+ * writing to it clears them. The "all" file is a snapshot of every stat in
+ * the binary layout of exynos-stat.h, taken at open, so that a tool gets
+ * them all in one read.
+ */
+static LIST_HEAD(exynos_stat_list);
+static DEFINE_MUTEX(exynos_stat_lock);
+static unsigned int exynos_stat_nr;
+static struct dentry *exynos_stat_root;
+
+static inline unsigned int exynos_stat_slots(struct exynos_stat *stat)
+{
+	return stat->nr_counters + stat->nr_hists * EXYNOS_STAT_HIST_BUCKETS;
+}
+
+static u64 exynos_stat_sum(struct exynos_stat *stat, unsigned int slot)
+{
+	u64 sum = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		sum += per_cpu_ptr(stat->slots, cpu)[slot];
+
+	return sum;
+}
+
+u64 exynos_stat_read(struct exynos_stat *stat, unsigned int counter)
+{
+	return stat ? exynos_stat_sum(stat, counter) : 0;
+}
+EXPORT_SYMBOL_GPL(exynos_stat_read);
+
+/* An update racing with the reset on another cpu may survive it */
+void exynos_stat_reset(struct exynos_stat *stat)
+{
+	int cpu;
+
+	if (!stat)
+		return;
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(stat->slots, cpu), 0,
+		       exynos_stat_slots(stat) * sizeof(u64));
+}
+EXPORT_SYMBOL_GPL(exynos_stat_reset);
+
+static int exynos_stat_show(struct seq_file *s, void *unused)
+{
+	struct exynos_stat *stat = s->private;
+	unsigned int i, b, slot;
+	u64 val;
+
+	for (i = 0; i < stat->nr_counters; i++)
+		seq_printf(s, "%-16s %llu\n", stat->counters[i],
+			   exynos_stat_sum(stat, i));
+
+	for (i = 0; i < stat->nr_hists; i++) {
+		seq_printf(s, "%-16s", stat->hists[i]);
+		slot = stat->nr_counters + i * EXYNOS_STAT_HIST_BUCKETS;
+		for (b = 0; b < EXYNOS_STAT_HIST_BUCKETS; b++) {
+			val = exynos_stat_sum(stat, slot + b);
+			if (val)
+				seq_printf(s, " %llu:%llu",
+					   b ? 1ULL << (b - 1) : 0ULL, val);
+		}
+		seq_putc(s, '\n');
+	}
+
+	return 0;
+}
+
+static int exynos_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, exynos_stat_show, inode->i_private);
+}
+
+static ssize_t exynos_stat_write(struct file *file, const char __user *buf,
+				 size_t count, loff_t *ppos)
+{
+	struct seq_file *s = file->private_data;
+
+	exynos_stat_reset(s->private);
+
+	return count;
+}
+
+static const struct file_operations exynos_stat_fops = {
+	.open		= exynos_stat_open,
+	.read		= seq_read,
+	.write		= exynos_stat_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+struct exynos_stat_snapshot {
+	size_t	len;
+	u8	data[0];
+};
+
+static int exynos_stat_all_open(struct inode *inode, struct file *file)
+{
+	struct exynos_stat_snapshot *snap;
+	struct exynos_stat_header *hdr;
+	struct exynos_stat_record *rec;
+	struct exynos_stat *stat;
+	unsigned int i;
+	size_t len;
+	u8 *p;
+
+	mutex_lock(&exynos_stat_lock);
+
+	len = sizeof(*hdr);
+	list_for_each_entry(stat, &exynos_stat_list, node)
+		len += sizeof(*rec) + exynos_stat_slots(stat) * sizeof(u64);
+
+	snap = vzalloc(sizeof(*snap) + len);
+	if (!snap) {
+		mutex_unlock(&exynos_stat_lock);
+		return -ENOMEM;
+	}
+	snap->len = len;
+
+	hdr = (struct exynos_stat_header *)snap->data;
+	hdr->magic = EXYNOS_STAT_MAGIC;
+	hdr->version = EXYNOS_STAT_VERSION;
+	hdr->nr_stats = exynos_stat_nr;
+	hdr->hist_buckets = EXYNOS_STAT_HIST_BUCKETS;
+
+	p = snap->data + sizeof(*hdr);
+	list_for_each_entry(stat, &exynos_stat_list, node) {
+		rec = (struct exynos_stat_record *)p;
+		memcpy(rec->name, stat->name, sizeof(rec->name));
+		rec->nr_counters = stat->nr_counters;
+		rec->nr_hists = stat->nr_hists;
+		for (i = 0; i < exynos_stat_slots(stat); i++)
+			rec->values[i] = exynos_stat_sum(stat, i);
+		p += sizeof(*rec) + exynos_stat_slots(stat) * sizeof(u64);
+	}
+
+	mutex_unlock(&exynos_stat_lock);
+
+	file->private_data = snap;
+
+	return 0;
+}
+
+static ssize_t exynos_stat_all_read(struct file *file, char __user *buf,
+				    size_t count, loff_t *ppos)
+{
+	struct exynos_stat_snapshot *snap = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, snap->data, snap->len);
+}
+
+static int exynos_stat_all_release(struct inode *inode, struct file *file)
+{
+	vfree(file->private_data);
+
+	return 0;
+}
+
+static const struct file_operations exynos_stat_all_fops = {
+	.open		= exynos_stat_all_open,
+	.read		= exynos_stat_all_read,
+	.llseek		= default_llseek,
+	.release	= exynos_stat_all_release,
+};
+
+/* Called with exynos_stat_lock, the drivers may create stats at any initcall */
+static struct dentry *exynos_stat_get_root(void)
+{
+	if (exynos_stat_root)
+		return exynos_stat_root;
+
+	exynos_stat_root = debugfs_create_dir("exynos-stat", NULL);
+	if (IS_ERR_OR_NULL(exynos_stat_root)) {
+		exynos_stat_root = NULL;
+		return NULL;
+	}
+
+	debugfs_create_file("all", 0400, exynos_stat_root, NULL,
+			    &exynos_stat_all_fops);
+
+	return exynos_stat_root;
+}
+
+struct exynos_stat *exynos_stat_create(const char *name,
+		const char * const *counters, unsigned int nr_counters,
+		const char * const *hists, unsigned int nr_hists)
+{
+	struct exynos_stat *stat;
+	struct dentry *root;
+
+	stat = kzalloc(sizeof(*stat), GFP_KERNEL);
+	if (!stat)
+		return NULL;
+
+	strlcpy(stat->name, name, sizeof(stat->name));
+	stat->counters = counters;
+	stat->nr_counters = nr_counters;
+	stat->hists = hists;
+	stat->nr_hists = nr_hists;
+
+	stat->slots = __alloc_percpu(exynos_stat_slots(stat) * sizeof(u64),
+				     sizeof(u64));
+	if (!stat->slots) {
+		kfree(stat);
+		return NULL;
+	}
+
+	mutex_lock(&exynos_stat_lock);
+	root = exynos_stat_get_root();
+	if (root)
+		stat->dentry = debugfs_create_file(stat->name, 0600, root,
+						   stat, &exynos_stat_fops);
+	list_add_tail(&stat->node, &exynos_stat_list);
+	exynos_stat_nr++;
+	mutex_unlock(&exynos_stat_lock);
+
+	return stat;
+}
+EXPORT_SYMBOL_GPL(exynos_stat_create);
+
+/* The caller makes sure that no update runs anymore */
+void exynos_stat_destroy(struct exynos_stat *stat)
+{
+	if (!stat)
+		return;
+
+	mutex_lock(&exynos_stat_lock);
+	list_del(&stat->node);
+	exynos_stat_nr--;
+	mutex_unlock(&exynos_stat_lock);
+
+	debugfs_remove(stat->dentry);
+	free_percpu(stat->slots);
+	kfree(stat);
+}
+EXPORT_SYMBOL_GPL(exynos_stat_destroy);
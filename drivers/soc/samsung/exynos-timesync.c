@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * Time base shared by the AP and the subsystems
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/clocksource.h>
+#include <linux/debugfs.h>
+#include <linux/init.h>
+#include <linux/list.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/seq_file.h>
+#include <linux/seqlock.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/suspend.h>
+#include <linux/workqueue.h>
+
+#include <clocksource/arm_arch_timer.h>
+#include <soc/samsung/exynos-timesync.h>
+#include <soc/samsung/exynos-wq.h>
+
+/*
+ * The system counter keeps counting in suspend and is read by CHUB, ABOX
+ * and CP as well, so a timestamp taken in its cycles by any of them is
+ * converted to CLOCK_BOOTTIME here from a (cycles, boottime) base. The base
+ * is taken again periodically and on resume, for the slew of the timekeeping,
+ * and how far the previous base was is kept as the "counter" client.
+ */
+#define TIMESYNC_RESYNC_PERIOD		(10 * HZ)
+/* drift is measured over samples at least that far apart */
+#define TIMESYNC_DRIFT_INTERVAL_NS	NSEC_PER_SEC
+
+struct exynos_timesync_base {
+	u64 cycles;
+	u64 boot_ns;
+};
+
+struct exynos_timesync_client {
+	struct list_head list;
+	const char *name;
+	spinlock_t lock;
+	u64 samples;
+	s64 last_offset;	/* remote - local */
+	s64 min_offset;
+	s64 max_offset;
+	u64 ref_local;		/* sample the drift is measured from */
+	s64 ref_offset;
+	s64 drift_ppb;
+	s64 max_drift_ppb;
+};
+
+static DEFINE_SEQLOCK(timesync_lock);
+static struct exynos_timesync_base timesync_base;
+static u32 timesync_mult, timesync_shift;
+
+static DEFINE_MUTEX(timesync_clients_lock);
+static LIST_HEAD(timesync_clients);
+static struct exynos_timesync_client *timesync_counter;
+
+static struct delayed_work timesync_work;
+
+u64 exynos_timesync_cycles(void)
+{
+	return arch_timer_read_counter();
+}
+EXPORT_SYMBOL_GPL(exynos_timesync_cycles);
+
+u64 exynos_timesync_cycles_to_boottime(u64 cycles)
+{
+	struct exynos_timesync_base base;
+	unsigned int seq;
+
+	if (!timesync_mult)
+		return ktime_get_boot_ns();
+
+	do {
+		seq = read_seqbegin(&timesync_lock);
+		base = timesync_base;
+	} while (read_seqretry(&timesync_lock, seq));
+
+	if (cycles >= base.cycles)
+		return base.boot_ns + mul_u64_u32_shr(cycles - base.cycles,
+				timesync_mult, timesync_shift);
+
+	return base.boot_ns - mul_u64_u32_shr(base.cycles - cycles,
+			timesync_mult, timesync_shift);
+}
+EXPORT_SYMBOL_GPL(exynos_timesync_cycles_to_boottime);
+
+u64 exynos_timesync_boottime(void)
+{
+	return exynos_timesync_cycles_to_boottime(exynos_timesync_cycles());
+}
+EXPORT_SYMBOL_GPL(exynos_timesync_boottime);
+
+struct exynos_timesync_client *exynos_timesync_register(const char *name)
+{
+	struct exynos_timesync_client *client;
+
+	client = kzalloc(sizeof(*client), GFP_KERNEL);
+	if (!client)
+		return NULL;
+
+	client->name = kstrdup_const(name, GFP_KERNEL);
+	if (!client->name) {
+		kfree(client);
+		return NULL;
+	}
+	spin_lock_init(&client->lock);
+
+	mutex_lock(&timesync_clients_lock);
+	list_add_tail(&client->list, &timesync_clients);
+	mutex_unlock(&timesync_clients_lock);
+
+	return client;
+}
+EXPORT_SYMBOL_GPL(exynos_timesync_register);
+
+void exynos_timesync_unregister(struct exynos_timesync_client *client)
+{
+	if (!client)
+		return;
+
+	mutex_lock(&timesync_clients_lock);
+	list_del(&client->list);
+	mutex_unlock(&timesync_clients_lock);
+
+	kfree_const(client->name);
+	kfree(client);
+}
+EXPORT_SYMBOL_GPL(exynos_timesync_unregister);
+
+/*
+ * Records a remote timestamp against the local boottime of the same moment.
+ * The offset includes the latency of the transport, if not taken together.
+ */
+void exynos_timesync_sample(struct exynos_timesync_client *client,
+		u64 local_ns, u64 remote_ns)
+{
+	s64 offset = (s64)(remote_ns - local_ns);
+	unsigned long flags;
+	u64 interval;
+
+	if (!client)
+		return;
+
+	spin_lock_irqsave(&client->lock, flags);
+	if (!client->samples++) {
+		client->min_offset = offset;
+		client->max_offset = offset;
+		client->ref_local = local_ns;
+		client->ref_offset = offset;
+	}
+
+	client->last_offset = offset;
+	client->min_offset = min(client->min_offset, offset);
+	client->max_offset = max(client->max_offset, offset);
+
+	interval = local_ns - client->ref_local;
+	if ((s64)interval >= TIMESYNC_DRIFT_INTERVAL_NS) {
+		client->drift_ppb = div64_s64((offset - client->ref_offset) *
+				(s64)NSEC_PER_SEC, interval);
+		if (abs(client->drift_ppb) > abs(client->max_drift_ppb))
+			client->max_drift_ppb = client->drift_ppb;
+		client->ref_local = local_ns;
+		client->ref_offset = offset;
+	}
+	spin_unlock_irqrestore(&client->lock, flags);
+}
+EXPORT_SYMBOL_GPL(exynos_timesync_sample);
+
+s64 exynos_timesync_offset(struct exynos_timesync_client *client)
+{
+	return client ? READ_ONCE(client->last_offset) : 0;
+}
+EXPORT_SYMBOL_GPL(exynos_timesync_offset);
+
+static void exynos_timesync_resync(void)
+{
+	struct exynos_timesync_base now;
+	unsigned long flags;
+	u64 expected;
+
+	local_irq_save(flags);
+	now.cycles = exynos_timesync_cycles();
+	now.boot_ns = ktime_get_boot_ns();
+	local_irq_restore(flags);
+
+	expected = exynos_timesync_cycles_to_boottime(now.cycles);
+	exynos_timesync_sample(timesync_counter, now.boot_ns, expected);
+
+	write_seqlock_irqsave(&timesync_lock, flags);
+	timesync_base = now;
+	write_sequnlock_irqrestore(&timesync_lock, flags);
+}
+
+static void exynos_timesync_work_fn(struct work_struct *work)
+{
+	exynos_timesync_resync();
+	queue_delayed_work(exynos_little_wq, &timesync_work,
+			TIMESYNC_RESYNC_PERIOD);
+}
+
+static int exynos_timesync_pm_notifier(struct notifier_block *nb,
+		unsigned long event, void *unused)
+{
+	switch (event) {
+	case PM_SUSPEND_PREPARE:
+		cancel_delayed_work_sync(&timesync_work);
+		break;
+	case PM_POST_SUSPEND:
+		exynos_timesync_resync();
+		queue_delayed_work(exynos_little_wq, &timesync_work,
+				TIMESYNC_RESYNC_PERIOD);
+		break;
+	}
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block exynos_timesync_pm_nb = {
+	.notifier_call = exynos_timesync_pm_notifier,
+};
+
+static int exynos_timesync_show(struct seq_file *s, void *unused)
+{
+	struct exynos_timesync_client *client;
+	unsigned long flags;
+
+	seq_printf(s, "rate %u Hz, cycles %llu, boottime %llu ns\n",
+			arch_timer_get_rate(), exynos_timesync_cycles(),
+			exynos_timesync_boottime());
+	seq_printf(s, "%-12s %10s %14s %14s %14s %10s %10s\n", "client",
+			"samples", "offset_ns", "min_ns", "max_ns",
+			"drift_ppb", "max_ppb");
+
+	mutex_lock(&timesync_clients_lock);
+	list_for_each_entry(client, &timesync_clients, list) {
+		spin_lock_irqsave(&client->lock, flags);
+		seq_printf(s, "%-12s %10llu %14lld %14lld %14lld %10lld %10lld\n",
+				client->name, client->samples,
+				client->last_offset, client->min_offset,
+				client->max_offset, client->drift_ppb,
+				client->max_drift_ppb);
+		spin_unlock_irqrestore(&client->lock, flags);
+	}
+	mutex_unlock(&timesync_clients_lock);
+
+	return 0;
+}
+
+static int exynos_timesync_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, exynos_timesync_show, inode->i_private);
+}
+
+static const struct file_operations exynos_timesync_fops = {
+	.open		= exynos_timesync_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init exynos_timesync_init(void)
+{
+	u32 rate = arch_timer_get_rate();
+
+	if (!rate) {
+		pr_err("%s: system counter is not available\n", __func__);
+		return -ENODEV;
+	}
+
+	clocks_calc_mult_shift(&timesync_mult, &timesync_shift, rate,
+			NSEC_PER_SEC, 3600);
+	exynos_timesync_resync();
+
+	return 0;
+}
+core_initcall(exynos_timesync_init);
+
+static int __init exynos_timesync_late_init(void)
+{
+	if (!timesync_mult)
+		return 0;
+
+	timesync_counter = exynos_timesync_register("counter");
+
+	INIT_DEFERRABLE_WORK(&timesync_work, exynos_timesync_work_fn);
+	queue_delayed_work(exynos_little_wq, &timesync_work,
+			TIMESYNC_RESYNC_PERIOD);
+	register_pm_notifier(&exynos_timesync_pm_nb);
+
+	debugfs_create_file("exynos-timesync", 0400, NULL, NULL,
+			&exynos_timesync_fops);
+
+	return 0;
+}
+late_initcall(exynos_timesync_late_init);
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * Workqueue of the Exynos drivers bound to the little cluster
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/cpumask.h>
+#include <linux/init.h>
+#include <linux/topology.h>
+#include <linux/workqueue.h>
+
+#include <soc/samsung/exynos-wq.h>
+
+/*
+ * The background works of the drivers (QoS requests, watchdogs, buffer
+ * reclaim...) run on the cluster of the boot cpu, the little one, so that
+ * they do not wake up an idle big cluster and break its power down. The
+ * cpus may be changed in /sys/devices/virtual/workqueue/exynos_little/cpumask,
+ * and cpu_stats there counts the works run on each cpu.
+ */
+struct workqueue_struct *exynos_little_wq __read_mostly;
+EXPORT_SYMBOL_GPL(exynos_little_wq);
+
+static int __init exynos_little_wq_init(void)
+{
+	struct workqueue_attrs *attrs;
+	int ret;
+
+	exynos_little_wq = alloc_workqueue("exynos_little",
+			WQ_UNBOUND | WQ_SYSFS | WQ_CPU_STATS, 0);
+	if (!exynos_little_wq) {
+		pr_err("%s: failed to allocate workqueue\n", __func__);
+		exynos_little_wq = system_unbound_wq;
+		return -ENOMEM;
+	}
+
+	attrs = alloc_workqueue_attrs(GFP_KERNEL);
+	if (!attrs)
+		return -ENOMEM;
+
+	cpumask_and(attrs->cpumask, topology_core_cpumask(0), cpu_possible_mask);
+	ret = apply_workqueue_attrs(exynos_little_wq, attrs);
+	if (ret)
+		pr_err("%s: failed to bind to the little cluster(%d)\n",
+				__func__, ret);
+
+	free_workqueue_attrs(attrs);
+
+	return ret;
+}
+core_initcall(exynos_little_wq_init);
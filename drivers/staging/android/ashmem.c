@@ -31,6 +31,9 @@
 #include <linux/personality.h>
 #include <linux/bitops.h>
 #include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/wait.h>
+#include <linux/interval_tree_generic.h>
 #include <linux/shmem_fs.h>
 #include "ashmem.h"
 
@@ -41,7 +44,8 @@
 /**
  * struct ashmem_area - The anonymous shared memory area
  * @name:		The optional name in /proc/pid/maps
- * @unpinned_list:	The list of all ashmem areas
+ * @unpinned_tree:	The interval tree of unpinned ranges of this area
+ * @mutex:		Protects @unpinned_tree and its ranges
  * @file:		The shmem-based backing file
  * @size:		The size of the mapping, in bytes
  * @prot_mask:		The allowed protection bits, as vm_flags
@@ -53,7 +57,8 @@
  */
 struct ashmem_area {
 	char name[ASHMEM_FULL_NAME_LEN];
-	struct list_head unpinned_list;
+	struct rb_root_cached unpinned_tree;
+	struct mutex mutex;
 	struct file *file;
 	size_t size;
 	unsigned long prot_mask;
@@ -62,40 +67,52 @@ struct ashmem_area {
 /**
  * struct ashmem_range - A range of unpinned/evictable pages
  * @lru:	         The entry in the LRU list
- * @unpinned:	         The entry in its area's unpinned list
+ * @node:	         The node in its area's unpinned tree
+ * @subtree_last:	 The last page of the subtree rooted at @node
  * @asma:	         The associated anonymous shared memory area.
  * @pgstart:	         The starting page (inclusive)
  * @pgend:	         The ending page (inclusive)
  * @purged:	         The purge status (ASHMEM_NOT or ASHMEM_WAS_PURGED)
  *
  * The lifecycle of this structure is from unpin to pin.
- * It is protected by 'ashmem_mutex'
+ * It is protected by its area's mutex, @lru by 'ashmem_lru_lock'
  */
 struct ashmem_range {
 	struct list_head lru;
-	struct list_head unpinned;
+	struct rb_node node;
+	size_t subtree_last;
 	struct ashmem_area *asma;
 	size_t pgstart;
 	size_t pgend;
 	unsigned int purged;
 };
 
-/* LRU list of unpinned pages, protected by ashmem_mutex */
+/* LRU list of unpinned pages, protected by ashmem_lru_lock */
 static LIST_HEAD(ashmem_lru_list);
 
 /*
  * long lru_count - The count of pages on our LRU list.
  *
- * This is protected by ashmem_mutex.
+ * This is protected by ashmem_lru_lock.
  */
 static unsigned long lru_count;
 
 /*
- * ashmem_mutex - protects the list of and each individual ashmem_area
+ * ashmem_mutex - protects the name, size, file and prot_mask of each
+ * individual ashmem_area
  *
  * Lock Ordering: ashmex_mutex -> i_mutex -> i_alloc_sem
+ *		  asma->mutex -> ashmem_lru_lock
  */
 static DEFINE_MUTEX(ashmem_mutex);
+static DEFINE_SPINLOCK(ashmem_lru_lock);
+
+/*
+ * Ranges the shrinker has marked purged but not yet punched out of their
+ * backing file. Pinning a purged range waits for them.
+ */
+static atomic_t ashmem_shrink_inflight = ATOMIC_INIT(0);
+static DECLARE_WAIT_QUEUE_HEAD(ashmem_shrink_wait);
 
 static struct kmem_cache *ashmem_area_cachep __read_mostly;
 static struct kmem_cache *ashmem_range_cachep __read_mostly;
@@ -105,6 +122,19 @@ static inline unsigned long range_size(struct ashmem_range *range)
 	return range->pgend - range->pgstart + 1;
 }
 
+static inline size_t range_start(struct ashmem_range *range)
+{
+	return range->pgstart;
+}
+
+static inline size_t range_last(struct ashmem_range *range)
+{
+	return range->pgend;
+}
+
+INTERVAL_TREE_DEFINE(struct ashmem_range, node, size_t, subtree_last,
+		     range_start, range_last, static, range_tree)
+
 static inline bool range_on_lru(struct ashmem_range *range)
 {
 	return range->purged == ASHMEM_NOT_PURGED;
@@ -122,23 +152,6 @@ static inline bool page_range_subsumed_by_range(struct ashmem_range *range,
 	return (range->pgstart <= start) && (range->pgend >= end);
 }
 
-static inline bool page_in_range(struct ashmem_range *range, size_t page)
-{
-	return (range->pgstart <= page) && (range->pgend >= page);
-}
-
-static inline bool page_range_in_range(struct ashmem_range *range,
-				       size_t start, size_t end)
-{
-	return page_in_range(range, start) || page_in_range(range, end) ||
-		page_range_subsumes_range(range, start, end);
-}
-
-static inline bool range_before_page(struct ashmem_range *range, size_t page)
-{
-	return range->pgend < page;
-}
-
 #define PROT_MASK		(PROT_EXEC | PROT_READ | PROT_WRITE)
 
 /**
@@ -147,6 +160,8 @@ static inline bool range_before_page(struct ashmem_range *range, size_t page)
  *
  * The range is first added to the end (tail) of the LRU list.
  * After this, the size of the range is added to @lru_count
+ *
+ * Caller must hold ashmem_lru_lock.
  */
 static inline void lru_add(struct ashmem_range *range)
 {
@@ -160,6 +175,8 @@ static inline void lru_add(struct ashmem_range *range)
  *
  * The range is first deleted from the LRU list.
  * After this, the size of the range is removed from @lru_count
+ *
+ * Caller must hold ashmem_lru_lock.
  */
 static inline void lru_del(struct ashmem_range *range)
 {
@@ -170,17 +187,15 @@ static inline void lru_del(struct ashmem_range *range)
 /**
  * range_alloc() - Allocates and initializes a new ashmem_range structure
  * @asma:	   The associated ashmem_area
- * @prev_range:	   The previous ashmem_range in the sorted asma->unpinned list
  * @purged:	   Initial purge status (ASMEM_NOT_PURGED or ASHMEM_WAS_PURGED)
  * @start:	   The starting page (inclusive)
  * @end:	   The ending page (inclusive)
  *
- * This function is protected by ashmem_mutex.
+ * This function is protected by asma->mutex.
  *
  * Return: 0 if successful, or -ENOMEM if there is an error
  */
-static int range_alloc(struct ashmem_area *asma,
-		       struct ashmem_range *prev_range, unsigned int purged,
+static int range_alloc(struct ashmem_area *asma, unsigned int purged,
 		       size_t start, size_t end)
 {
 	struct ashmem_range *range;
@@ -194,10 +209,13 @@ static int range_alloc(struct ashmem_area *asma,
 	range->pgend = end;
 	range->purged = purged;
 
-	list_add_tail(&range->unpinned, &prev_range->unpinned);
+	range_tree_insert(range, &asma->unpinned_tree);
 
-	if (range_on_lru(range))
+	if (range_on_lru(range)) {
+		spin_lock(&ashmem_lru_lock);
 		lru_add(range);
+		spin_unlock(&ashmem_lru_lock);
+	}
 
 	return 0;
 }
@@ -208,9 +226,12 @@ static int range_alloc(struct ashmem_area *asma,
  */
 static void range_del(struct ashmem_range *range)
 {
-	list_del(&range->unpinned);
-	if (range_on_lru(range))
+	range_tree_remove(range, &range->asma->unpinned_tree);
+	if (range_on_lru(range)) {
+		spin_lock(&ashmem_lru_lock);
 		lru_del(range);
+		spin_unlock(&ashmem_lru_lock);
+	}
 	kmem_cache_free(ashmem_range_cachep, range);
 }
 
@@ -231,11 +252,16 @@ static inline void range_shrink(struct ashmem_range *range,
 {
 	size_t pre = range_size(range);
 
+	range_tree_remove(range, &range->asma->unpinned_tree);
 	range->pgstart = start;
 	range->pgend = end;
+	range_tree_insert(range, &range->asma->unpinned_tree);
 
-	if (range_on_lru(range))
+	if (range_on_lru(range)) {
+		spin_lock(&ashmem_lru_lock);
 		lru_count -= pre - range_size(range);
+		spin_unlock(&ashmem_lru_lock);
+	}
 }
 
 /**
@@ -261,7 +287,8 @@ static int ashmem_open(struct inode *inode, struct file *file)
 	if (unlikely(!asma))
 		return -ENOMEM;
 
-	INIT_LIST_HEAD(&asma->unpinned_list);
+	asma->unpinned_tree = RB_ROOT_CACHED;
+	mutex_init(&asma->mutex);
 	memcpy(asma->name, ASHMEM_NAME_PREFIX, ASHMEM_NAME_PREFIX_LEN);
 	asma->prot_mask = PROT_MASK;
 	file->private_data = asma;
@@ -280,12 +307,12 @@ static int ashmem_open(struct inode *inode, struct file *file)
 static int ashmem_release(struct inode *ignored, struct file *file)
 {
 	struct ashmem_area *asma = file->private_data;
-	struct ashmem_range *range, *next;
+	struct rb_node *node;
 
-	mutex_lock(&ashmem_mutex);
-	list_for_each_entry_safe(range, next, &asma->unpinned_list, unpinned)
-		range_del(range);
-	mutex_unlock(&ashmem_mutex);
+	mutex_lock(&asma->mutex);
+	while ((node = rb_first_cached(&asma->unpinned_tree)))
+		range_del(rb_entry(node, struct ashmem_range, node));
+	mutex_unlock(&asma->mutex);
 
 	if (asma->file)
 		fput(asma->file);
@@ -454,41 +481,76 @@ out:
  *
  * 'gfp_mask' is the mask of the allocation that got us into this mess.
  *
- * Return value is the number of objects freed or -1 if we cannot
+ * Return value is the number of objects freed or SHRINK_STOP if we cannot
  * proceed without risk of deadlock (due to gfp_mask).
  *
  * We approximate LRU via least-recently-unpinned, jettisoning unpinned partial
- * chunks of ashmem regions LRU-wise one-at-a-time until we hit 'nr_to_scan'
- * pages freed.
+ * chunks of ashmem regions LRU-wise until we hit 'nr_to_scan' ranges. Up to
+ * ASHMEM_SHRINK_BATCH ranges are taken off the LRU under ashmem_lru_lock and
+ * their pages are punched out with no lock held. Ranges of areas busy with
+ * pin/unpin are skipped.
  */
+#define ASHMEM_SHRINK_BATCH	16
+
+struct ashmem_purge {
+	struct file *file;
+	loff_t start;
+	loff_t end;
+};
+
 static unsigned long
 ashmem_shrink_scan(struct shrinker *shrink, struct shrink_control *sc)
 {
+	struct ashmem_purge batch[ASHMEM_SHRINK_BATCH];
 	struct ashmem_range *range, *next;
 	unsigned long freed = 0;
+	int i, nr;
 
 	/* We might recurse into filesystem code, so bail out if necessary */
 	if (!(sc->gfp_mask & __GFP_FS))
 		return SHRINK_STOP;
 
-	if (!mutex_trylock(&ashmem_mutex))
-		return -1;
+	while (sc->nr_to_scan > 0) {
+		nr = 0;
 
-	list_for_each_entry_safe(range, next, &ashmem_lru_list, lru) {
-		loff_t start = range->pgstart * PAGE_SIZE;
-		loff_t end = (range->pgend + 1) * PAGE_SIZE;
+		spin_lock(&ashmem_lru_lock);
+		list_for_each_entry_safe(range, next, &ashmem_lru_list, lru) {
+			struct ashmem_area *asma = range->asma;
 
-		range->asma->file->f_op->fallocate(range->asma->file,
-				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
-				start, end - start);
-		range->purged = ASHMEM_WAS_PURGED;
-		lru_del(range);
+			if (!mutex_trylock(&asma->mutex))
+				continue;
+
+			batch[nr].file = get_file(asma->file);
+			batch[nr].start = range->pgstart * PAGE_SIZE;
+			batch[nr].end = (range->pgend + 1) * PAGE_SIZE;
+			range->purged = ASHMEM_WAS_PURGED;
+			lru_del(range);
+			atomic_inc(&ashmem_shrink_inflight);
+			mutex_unlock(&asma->mutex);
+
+			freed += range_size(range);
+			nr++;
+			if (--sc->nr_to_scan <= 0 || nr == ASHMEM_SHRINK_BATCH)
+				break;
+		}
+		spin_unlock(&ashmem_lru_lock);
 
-		freed += range_size(range);
-		if (--sc->nr_to_scan <= 0)
+		if (!nr)
 			break;
+
+		for (i = 0; i < nr; i++) {
+			struct file *file = batch[i].file;
+
+			file->f_op->fallocate(file,
+				FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				batch[i].start, batch[i].end - batch[i].start);
+			fput(file);
+		}
+
+		if (atomic_sub_and_test(nr, &ashmem_shrink_inflight))
+			wake_up_all(&ashmem_shrink_wait);
 	}
-	mutex_unlock(&ashmem_mutex);
+
 	return freed;
 }
 
@@ -606,18 +668,15 @@ static int get_name(struct ashmem_area *asma, void __user *name)
  * ashmem_pin - pin the given ashmem region, returning whether it was
  * previously purged (ASHMEM_WAS_PURGED) or not (ASHMEM_NOT_PURGED).
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static int ashmem_pin(struct ashmem_area *asma, size_t pgstart, size_t pgend)
 {
-	struct ashmem_range *range, *next;
+	struct ashmem_range *range;
 	int ret = ASHMEM_NOT_PURGED;
 
-	list_for_each_entry_safe(range, next, &asma->unpinned_list, unpinned) {
-		/* moved past last applicable page; we can short circuit */
-		if (range_before_page(range, pgstart))
-			break;
-
+	while ((range = range_tree_iter_first(&asma->unpinned_tree,
+					      pgstart, pgend))) {
 		/*
 		 * The user can ask us to pin pages that span multiple ranges,
 		 * or to pin pages that aren't even unpinned, so this is messy.
@@ -633,99 +692,85 @@ static int ashmem_pin(struct ashmem_area *asma, size_t pgstart, size_t pgend)
 		 *    so we have to update one side of the range and then
 		 *    create a new range for the other side.
 		 */
-		if (page_range_in_range(range, pgstart, pgend)) {
-			ret |= range->purged;
+		ret |= range->purged;
 
-			/* Case #1: Easy. Just nuke the whole thing. */
-			if (page_range_subsumes_range(range, pgstart, pgend)) {
-				range_del(range);
-				continue;
-			}
+		/* Case #1: Easy. Just nuke the whole thing. */
+		if (page_range_subsumes_range(range, pgstart, pgend)) {
+			range_del(range);
+			continue;
+		}
 
-			/* Case #2: We overlap from the start, so adjust it */
-			if (range->pgstart >= pgstart) {
-				range_shrink(range, pgend + 1, range->pgend);
-				continue;
-			}
+		/* Case #2: We overlap from the start, so adjust it */
+		if (range->pgstart >= pgstart) {
+			range_shrink(range, pgend + 1, range->pgend);
+			continue;
+		}
 
-			/* Case #3: We overlap from the rear, so adjust it */
-			if (range->pgend <= pgend) {
-				range_shrink(range, range->pgstart,
-					     pgstart - 1);
-				continue;
-			}
-
-			/*
-			 * Case #4: We eat a chunk out of the middle. A bit
-			 * more complicated, we allocate a new range for the
-			 * second half and adjust the first chunk's endpoint.
-			 */
-			range_alloc(asma, range, range->purged,
-				    pgend + 1, range->pgend);
+		/* Case #3: We overlap from the rear, so adjust it */
+		if (range->pgend <= pgend) {
 			range_shrink(range, range->pgstart, pgstart - 1);
-			break;
+			continue;
 		}
+
+		/*
+		 * Case #4: We eat a chunk out of the middle. A bit
+		 * more complicated, we allocate a new range for the
+		 * second half and adjust the first chunk's endpoint.
+		 */
+		range_alloc(asma, range->purged, pgend + 1, range->pgend);
+		range_shrink(range, range->pgstart, pgstart - 1);
+		break;
 	}
 
+	/* The shrinker may still be punching out the purged pages */
+	if (ret == ASHMEM_WAS_PURGED)
+		wait_event(ashmem_shrink_wait,
+			   !atomic_read(&ashmem_shrink_inflight));
+
 	return ret;
 }
 
 /*
  * ashmem_unpin - unpin the given range of pages. Returns zero on success.
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static int ashmem_unpin(struct ashmem_area *asma, size_t pgstart, size_t pgend)
 {
-	struct ashmem_range *range, *next;
+	struct ashmem_range *range;
 	unsigned int purged = ASHMEM_NOT_PURGED;
 
-restart:
-	list_for_each_entry_safe(range, next, &asma->unpinned_list, unpinned) {
-		/* short circuit: this is our insertion point */
-		if (range_before_page(range, pgstart))
-			break;
-
+	while ((range = range_tree_iter_first(&asma->unpinned_tree,
+					      pgstart, pgend))) {
 		/*
 		 * The user can ask us to unpin pages that are already entirely
 		 * or partially pinned. We handle those two cases here.
 		 */
 		if (page_range_subsumed_by_range(range, pgstart, pgend))
 			return 0;
-		if (page_range_in_range(range, pgstart, pgend)) {
-			pgstart = min(range->pgstart, pgstart);
-			pgend = max(range->pgend, pgend);
-			purged |= range->purged;
-			range_del(range);
-			goto restart;
-		}
+
+		pgstart = min(range->pgstart, pgstart);
+		pgend = max(range->pgend, pgend);
+		purged |= range->purged;
+		range_del(range);
 	}
 
-	return range_alloc(asma, range, purged, pgstart, pgend);
+	return range_alloc(asma, purged, pgstart, pgend);
 }
 
 /*
  * ashmem_get_pin_status - Returns ASHMEM_IS_UNPINNED if _any_ pages in the
  * given interval are unpinned and ASHMEM_IS_PINNED otherwise.
  *
- * Caller must hold ashmem_mutex.
+ * Caller must hold asma->mutex.
  */
 static int ashmem_get_pin_status(struct ashmem_area *asma, size_t pgstart,
 				 size_t pgend)
 {
-	struct ashmem_range *range;
-	int ret = ASHMEM_IS_PINNED;
+	if (range_tree_iter_first(&asma->unpinned_tree, pgstart, pgend))
+		return ASHMEM_IS_UNPINNED;
 
-	list_for_each_entry(range, &asma->unpinned_list, unpinned) {
-		if (range_before_page(range, pgstart))
-			break;
-		if (page_range_in_range(range, pgstart, pgend)) {
-			ret = ASHMEM_IS_UNPINNED;
-			break;
-		}
-	}
-
-	return ret;
+	return ASHMEM_IS_PINNED;
 }
 
 static int ashmem_pin_unpin(struct ashmem_area *asma, unsigned long cmd,
@@ -733,32 +778,38 @@ static int ashmem_pin_unpin(struct ashmem_area *asma, unsigned long cmd,
 {
 	struct ashmem_pin pin;
 	size_t pgstart, pgend;
+	size_t size;
 	int ret = -EINVAL;
 
 	if (unlikely(copy_from_user(&pin, p, sizeof(pin))))
 		return -EFAULT;
 
+	/* the size can't change any more once the file is set */
 	mutex_lock(&ashmem_mutex);
+	size = asma->file ? asma->size : 0;
+	mutex_unlock(&ashmem_mutex);
 
-	if (unlikely(!asma->file))
-		goto out_unlock;
+	if (unlikely(!size))
+		return ret;
 
 	/* per custom, you can pass zero for len to mean "everything onward" */
 	if (!pin.len)
-		pin.len = PAGE_ALIGN(asma->size) - pin.offset;
+		pin.len = PAGE_ALIGN(size) - pin.offset;
 
 	if (unlikely((pin.offset | pin.len) & ~PAGE_MASK))
-		goto out_unlock;
+		return ret;
 
 	if (unlikely(((__u32)-1) - pin.offset < pin.len))
-		goto out_unlock;
+		return ret;
 
-	if (unlikely(PAGE_ALIGN(asma->size) < pin.offset + pin.len))
-		goto out_unlock;
+	if (unlikely(PAGE_ALIGN(size) < pin.offset + pin.len))
+		return ret;
 
 	pgstart = pin.offset / PAGE_SIZE;
 	pgend = pgstart + (pin.len / PAGE_SIZE) - 1;
 
+	mutex_lock(&asma->mutex);
+
 	switch (cmd) {
 	case ASHMEM_PIN:
 		ret = ashmem_pin(asma, pgstart, pgend);
@@ -771,8 +822,7 @@ static int ashmem_pin_unpin(struct ashmem_area *asma, unsigned long cmd,
 		break;
 	}
 
-out_unlock:
-	mutex_unlock(&ashmem_mutex);
+	mutex_unlock(&asma->mutex);
 
 	return ret;
 }
@@ -17,6 +17,10 @@
 #include <net/sock.h>
 #include <linux/hrtimer.h>
 #include <linux/proc_fs.h>
+#include <linux/swap.h>
+#include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/workqueue.h>
 
 
 #define RET_OK   0
@@ -95,12 +99,38 @@ static void dump_kfreecess_msg(struct kfreecess_msg_data *msg)
 }
 
 
+static int mod_putmsg(struct sk_buff *skb, int type, int mod,
+		struct priv_data *data, int flags)
+{
+	struct nlmsghdr *nlh = NULL;
+	struct kfreecess_msg_data *payload = NULL;
+
+	nlh = nlmsg_put(skb, 0, 0, 0, sizeof(struct kfreecess_msg_data), flags);
+	if (!nlh)
+		return RET_ERR;
+
+	payload = nlmsg_data(nlh);
+	payload->type = type;
+	payload->mod = mod;
+	payload->src_portid = KERNEL_ID_NETLINK;
+	payload->dst_portid = atomic_read(&bind_port[mod]);
+
+	if (data) {
+		payload->caller_pid = data->caller_pid;
+		payload->target_uid = data->target_uid;
+		if (payload->mod == MOD_PKG)
+			memcpy(&payload->pkg_info, &data->pkg_info, sizeof(pkg_info_t));
+		else
+			payload->flag = data->flag;
+	}
+
+	return RET_OK;
+}
+
 int mod_sendmsg(int type, int mod, struct priv_data* data)
 {
 	int ret, msg_len = 0;
 	struct sk_buff *skb = NULL;
-	struct nlmsghdr *nlh = NULL;
-	struct kfreecess_msg_data *payload = NULL;
 
 	if (!atomic_read(&kfreecess_init_suc))
 		return RET_ERR;
@@ -122,28 +152,13 @@ int mod_sendmsg(int type, int mod, struct priv_data* data)
 		return RET_ERR;
 	}
 
-	nlh = nlmsg_put(skb, 0, 0, 0, msg_len, 0);
-	if (!nlh) {
+	if (mod_putmsg(skb, type, mod, data, 0)) {
 		kfree_skb(skb);
 		return RET_ERR;
 	}
 
-	payload = nlmsg_data(nlh);
-	payload->type = type;
-	payload->mod = mod;
-	payload->src_portid = KERNEL_ID_NETLINK;
-	payload->dst_portid = atomic_read(&bind_port[mod]);
-
-	if (data) {
-		payload->caller_pid = data->caller_pid;
-		payload->target_uid = data->target_uid;
-		if (payload->mod == MOD_PKG)
-			memcpy(&payload->pkg_info, &data->pkg_info, sizeof(pkg_info_t));
-		else
-			payload->flag = data->flag;
-	}
 	//dump_kfreecess_msg(payload);
-	if ((ret = nlmsg_unicast(kfreecess_mod_sock, skb, payload->dst_portid)) < 0) {
+	if ((ret = nlmsg_unicast(kfreecess_mod_sock, skb, atomic_read(&bind_port[mod]))) < 0) {
 		pr_err("nlmsg_unicast failed! %s errno %d\n", __func__ , ret);
 		return RET_ERR;
 	} else
@@ -191,6 +206,197 @@ int sig_report(struct task_struct *caller, struct task_struct *p)
 	return ret;
 }
 
+/*
+ * Binder reports to frozen apps are batched.
+ * A one way transaction to a frozen app stays queued in the binder todo list
+ * of the target, so that its report is held here for batch_window_ms and
+ * the reports for the same uid are merged into one message. All reports of
+ * a window are sent in one multipart netlink message, so that a broadcast to
+ * many frozen apps doesn't make the manager thaw and refreeze per message.
+ * A synchronous transaction blocks the caller, so that it is reported at
+ * once and takes over the held report of the uid.
+ */
+#define FREECESS_UID_SLOTS	64
+
+struct freecess_uid_slot {
+	uid_t uid;
+	bool pending;
+	struct priv_data data;
+	u64 last_report;	/* jiffies */
+	u64 reports;
+	u64 thaw_reqs;
+};
+
+static struct freecess_batch_s {
+	spinlock_t lock;
+	struct freecess_uid_slot slot[FREECESS_UID_SLOTS];
+	unsigned int nr_pending;
+	unsigned int window_ms;
+	struct delayed_work work;
+
+	u64 batches;
+	u64 merged;
+	u64 cycles;
+} freecess_batch = {
+	.lock = __SPIN_LOCK_UNLOCKED(freecess_batch.lock),
+	.window_ms = 20,
+};
+
+/* called with freecess_batch.lock held */
+static struct freecess_uid_slot *freecess_get_slot(uid_t uid)
+{
+	struct freecess_uid_slot *slot, *victim = NULL;
+	int i;
+
+	for (i = 0; i < FREECESS_UID_SLOTS; i++) {
+		slot = &freecess_batch.slot[i];
+		if (slot->reports && slot->uid == uid)
+			return slot;
+		if (slot->pending)
+			continue;
+		if (!victim || slot->last_report < victim->last_report)
+			victim = slot;
+	}
+
+	/* all slots are held, report without batching */
+	if (!victim)
+		return NULL;
+
+	memset(victim, 0, sizeof(*victim));
+	victim->uid = uid;
+
+	return victim;
+}
+
+/* called with freecess_batch.lock held */
+static void freecess_thaw_req(struct freecess_uid_slot *slot)
+{
+	/* the uid was thawed before and got frozen again */
+	if (slot->thaw_reqs++)
+		freecess_batch.cycles++;
+}
+
+static void freecess_batch_flush(struct work_struct *work)
+{
+	struct report_stat_s *stat = &freecess_info.mod_reportstat[MOD_BINDER];
+	struct freecess_uid_slot *slot;
+	struct sk_buff *skb;
+	unsigned long flags;
+	u64 walltime, timecost;
+	int i, ret, nr = 0;
+
+	walltime = ktime_to_us(ktime_get());
+
+	spin_lock_irqsave(&freecess_batch.lock, flags);
+	if (!freecess_batch.nr_pending) {
+		spin_unlock_irqrestore(&freecess_batch.lock, flags);
+		return;
+	}
+
+	skb = nlmsg_new(freecess_batch.nr_pending *
+			nlmsg_total_size(sizeof(struct kfreecess_msg_data)),
+			GFP_ATOMIC);
+	if (!skb) {
+		/* keep the reports held and retry in the next window */
+		pr_err("%s alloc_skb failed!\n", __func__);
+		schedule_delayed_work(&freecess_batch.work,
+				msecs_to_jiffies(freecess_batch.window_ms));
+		spin_unlock_irqrestore(&freecess_batch.lock, flags);
+		return;
+	}
+
+	for (i = 0; i < FREECESS_UID_SLOTS; i++) {
+		slot = &freecess_batch.slot[i];
+		if (!slot->pending)
+			continue;
+
+		slot->pending = false;
+		if (mod_putmsg(skb, MSG_TO_USER, MOD_BINDER,
+					&slot->data, NLM_F_MULTI))
+			continue;
+
+		freecess_thaw_req(slot);
+		nr++;
+	}
+	if (nr)
+		freecess_batch.batches++;
+	freecess_batch.nr_pending = 0;
+	spin_unlock_irqrestore(&freecess_batch.lock, flags);
+
+	if (!nr) {
+		kfree_skb(skb);
+		return;
+	}
+
+	ret = nlmsg_unicast(kfreecess_mod_sock, skb, atomic_read(&bind_port[MOD_BINDER]));
+	if (ret < 0)
+		pr_err("nlmsg_unicast failed! %s errno %d\n", __func__, ret);
+
+	spin_lock_irqsave(&stat->lock, flags);
+	if (ret < 0) {
+		stat->data.report_fail_count += nr;
+		stat->data.report_fail_from_windowstart += nr;
+	} else {
+		stat->data.report_suc_count += nr;
+		stat->data.report_suc_from_windowstart += nr;
+	}
+
+	timecost = ktime_to_us(ktime_get()) - walltime;
+	stat->data.total_runtime += timecost;
+	stat->data.runtime_from_windowstart += timecost;
+	spin_unlock_irqrestore(&stat->lock, flags);
+}
+
+/*
+ * Returns true if the report is held for the batch, false if it is to be
+ * sent now.
+ */
+static bool freecess_batch_binder(struct priv_data *data)
+{
+	struct freecess_uid_slot *slot;
+	unsigned long flags;
+	bool held = false;
+
+	if (!atomic_read(&kfreecess_init_suc))
+		return false;
+
+	spin_lock_irqsave(&freecess_batch.lock, flags);
+
+	slot = freecess_get_slot(data->target_uid);
+	if (!slot)
+		goto out;
+
+	slot->reports++;
+	slot->last_report = get_jiffies_64();
+
+	if (slot->pending) {
+		freecess_batch.merged++;
+		if (data->flag) {
+			held = true;
+			goto out;
+		}
+		/* the synchronous report takes over the held one */
+		slot->pending = false;
+		freecess_batch.nr_pending--;
+	}
+
+	if (!data->flag || !freecess_batch.window_ms) {
+		freecess_thaw_req(slot);
+		goto out;
+	}
+
+	slot->pending = true;
+	slot->data = *data;
+	if (!freecess_batch.nr_pending++)
+		schedule_delayed_work(&freecess_batch.work,
+				msecs_to_jiffies(freecess_batch.window_ms));
+	held = true;
+out:
+	spin_unlock_irqrestore(&freecess_batch.lock, flags);
+
+	return held;
+}
+
 int binder_report(struct task_struct *caller, struct task_struct *p, int flag)
 {
 	int ret = RET_OK;
@@ -211,6 +417,9 @@ int binder_report(struct task_struct *caller, struct task_struct *p, int flag)
 
 	walltime = ktime_to_us(ktime_get());
 	if (p && thread_group_is_frozen(p)) {
+		if (freecess_batch_binder(&data))
+			return RET_OK;
+
 		ret = mod_sendmsg(MSG_TO_USER, MOD_BINDER, &data);
 		stat = &freecess_info.mod_reportstat[MOD_BINDER];
 		spin_lock_irqsave(&stat->lock, flags);
@@ -492,6 +701,167 @@ static const struct file_operations mod_stat_proc_fops = {
 	.release  = single_release,
 };
 
+static int freecess_batch_show(struct seq_file *m, void *v)
+{
+	struct freecess_uid_slot *slot;
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&freecess_batch.lock, flags);
+	seq_printf(m, "window_ms: %u\n", freecess_batch.window_ms);
+	seq_printf(m, "batches: %llu\n", freecess_batch.batches);
+	seq_printf(m, "merged: %llu\n", freecess_batch.merged);
+	seq_printf(m, "freeze_thaw_cycles: %llu\n", freecess_batch.cycles);
+	seq_printf(m, "-----------------------------\n");
+	seq_printf(m, "uid reports thaw_reqs\n");
+	for (i = 0; i < FREECESS_UID_SLOTS; i++) {
+		slot = &freecess_batch.slot[i];
+		if (!slot->reports)
+			continue;
+		seq_printf(m, "%u %llu %llu\n", slot->uid,
+				slot->reports, slot->thaw_reqs);
+	}
+	spin_unlock_irqrestore(&freecess_batch.lock, flags);
+
+	return 0;
+}
+
+static int freecess_batch_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, freecess_batch_show, NULL);
+}
+
+/* #echo <window_ms> > /proc/freecess/batch, 0 reports without batching */
+static ssize_t freecess_batch_write(struct file *filp, const char __user *buf, size_t count, loff_t *f_ops)
+{
+	unsigned int window_ms;
+	int ret;
+
+	ret = kstrtouint_from_user(buf, count, 10, &window_ms);
+	if (ret)
+		return ret;
+
+	WRITE_ONCE(freecess_batch.window_ms, window_ms);
+
+	return count;
+}
+
+static const struct file_operations batch_proc_fops = {
+	.open     = freecess_batch_open,
+	.read     = seq_read,
+	.write    = freecess_batch_write,
+	.llseek   = seq_lseek,
+	.release  = single_release,
+};
+
+#ifdef CONFIG_PROCESS_RECLAIM
+/*
+ * Freecess reclaims pages of a process once it got frozen in background,
+ * so that the process is kept cached instead of being killed:
+ *
+ * #echo "<pid> [anon|file|all]" > /proc/freecess/reclaim
+ *
+ * Reclaim is done in background and only while the process stays frozen.
+ */
+struct freecess_reclaim_work {
+	struct work_struct work;
+	struct task_struct *task;
+	enum reclaim_type type;
+};
+
+static atomic64_t freecess_reclaim_count;
+static atomic64_t freecess_reclaim_pages;
+
+static void freecess_reclaim_fn(struct work_struct *work)
+{
+	struct freecess_reclaim_work *rw = container_of(work,
+				struct freecess_reclaim_work, work);
+
+	if (thread_group_is_frozen(rw->task)) {
+		atomic64_add(reclaim_task(rw->task, rw->type),
+				&freecess_reclaim_pages);
+		atomic64_inc(&freecess_reclaim_count);
+	}
+
+	put_task_struct(rw->task);
+	kfree(rw);
+}
+
+static int freecess_reclaim_show(struct seq_file *m, void *v)
+{
+	seq_printf(m, "reclaim_count: %lld\n",
+			(long long)atomic64_read(&freecess_reclaim_count));
+	seq_printf(m, "reclaimed_pages: %lld\n",
+			(long long)atomic64_read(&freecess_reclaim_pages));
+	return 0;
+}
+
+static int freecess_reclaim_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, freecess_reclaim_show, NULL);
+}
+
+static ssize_t freecess_reclaim_write(struct file *filp, const char __user *buf, size_t count, loff_t *f_ops)
+{
+	struct freecess_reclaim_work *rw;
+	struct task_struct *task;
+	enum reclaim_type type = RECLAIM_ANON;
+	char buffer[32], type_buf[8] = "anon";
+	int pid;
+
+	memset(buffer, 0, sizeof(buffer));
+	if (count > sizeof(buffer) - 1)
+		count = sizeof(buffer) - 1;
+	if (copy_from_user(buffer, buf, count))
+		return -EFAULT;
+
+	if (sscanf(buffer, "%d %7s", &pid, type_buf) < 1)
+		return -EINVAL;
+
+	if (!strcmp(type_buf, "file"))
+		type = RECLAIM_FILE;
+	else if (!strcmp(type_buf, "all"))
+		type = RECLAIM_ALL;
+	else if (strcmp(type_buf, "anon"))
+		return -EINVAL;
+
+	rcu_read_lock();
+	task = find_task_by_vpid(pid);
+	if (task)
+		get_task_struct(task);
+	rcu_read_unlock();
+
+	if (!task)
+		return -ESRCH;
+
+	if (!thread_group_is_frozen(task)) {
+		put_task_struct(task);
+		return -EINVAL;
+	}
+
+	rw = kmalloc(sizeof(*rw), GFP_KERNEL);
+	if (!rw) {
+		put_task_struct(task);
+		return -ENOMEM;
+	}
+
+	rw->task = task;
+	rw->type = type;
+	INIT_WORK(&rw->work, freecess_reclaim_fn);
+	queue_work(system_unbound_wq, &rw->work);
+
+	return count;
+}
+
+static const struct file_operations reclaim_proc_fops = {
+	.open     = freecess_reclaim_open,
+	.read     = seq_read,
+	.write    = freecess_reclaim_write,
+	.llseek   = seq_lseek,
+	.release  = single_release,
+};
+#endif
+
 static void freecess_runinfo_init(struct freecess_info_s *f)
 {
 	int i;
@@ -583,6 +953,17 @@ static int __init kfreecess_init(void)
 		}
 	}
 
+	INIT_DELAYED_WORK(&freecess_batch.work, freecess_batch_flush);
+	if (freecess_rootdir &&
+	    !proc_create("batch", 0644, freecess_rootdir, &batch_proc_fops))
+		pr_err("create /proc/freecess/batch failed\n");
+
+#ifdef CONFIG_PROCESS_RECLAIM
+	if (freecess_rootdir &&
+	    !proc_create("reclaim", 0644, freecess_rootdir, &reclaim_proc_fops))
+		pr_err("create /proc/freecess/reclaim failed\n");
+#endif
+
 	freecess_runinfo_init(&freecess_info);
 	atomic_set(&kfreecess_init_suc, 1);
 	return RET_OK;
@@ -590,6 +971,8 @@ static int __init kfreecess_init(void)
 
 static void __exit kfreecess_exit(void)
 {
+	cancel_delayed_work_sync(&freecess_batch.work);
+
 	if (kfreecess_mod_sock)
 		netlink_kernel_release(kfreecess_mod_sock);
 
@@ -597,6 +980,10 @@ static void __exit kfreecess_exit(void)
 		remove_proc_entry("windowstat", freecess_rootdir);
 		remove_proc_entry("modstat", freecess_rootdir);
 		remove_proc_entry("pkgstat", freecess_rootdir);
+		remove_proc_entry("batch", freecess_rootdir);
+#ifdef CONFIG_PROCESS_RECLAIM
+		remove_proc_entry("reclaim", freecess_rootdir);
+#endif
 		remove_proc_entry("freecess", NULL);
 	}
 }
@@ -202,6 +202,8 @@ void *ion_buffer_kmap_get(struct ion_buffer *buffer)
 	buffer->vaddr = vaddr;
 	buffer->kmap_cnt++;
 
+	ion_exynos_buffer_cpu_access(buffer);
+
 	ion_event_end(ION_EVENT_TYPE_KMAP, buffer);
 
 	return vaddr;
@@ -336,6 +338,8 @@ static int ion_mmap(struct dma_buf *dmabuf, struct vm_area_struct *vma)
 	mutex_lock(&buffer->lock);
 	/* now map it to userspace */
 	ret = buffer->heap->ops->map_user(buffer->heap, buffer, vma);
+	if (!ret)
+		ion_exynos_buffer_cpu_access(buffer);
 	mutex_unlock(&buffer->lock);
 
 	if (ret)
@@ -451,6 +455,9 @@ const struct dma_buf_ops ion_dma_buf_ops = {
 	.unmap_dma_buf_area = ion_exynos_unmap_dma_buf_area,
 	.begin_cpu_access = ion_exynos_dma_buf_begin_cpu_access,
 	.end_cpu_access = ion_exynos_dma_buf_end_cpu_access,
+	.begin_cpu_access_partial = ion_exynos_dma_buf_begin_cpu_access_partial,
+	.end_cpu_access_partial = ion_exynos_dma_buf_end_cpu_access_partial,
+	.cache_sgt_mapping = true,
 #else
 	.attach = ion_dma_buf_attach,
 	.detach = ion_dma_buf_detatch,
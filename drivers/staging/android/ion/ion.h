@@ -157,6 +157,17 @@ struct ion_heap_ops {
  * returned to the system allocator.
  */
 #define ION_PRIV_FLAG_SHRINKER_FREE BIT(0)
+/*
+ * CPU may have dirty cache lines of the buffer, e.g. the heap zeroed the
+ * cached pages without flushing. Cleared when the buffer is cleaned for the
+ * device.
+ */
+#define ION_PRIV_FLAG_CPU_DIRTY BIT(1)
+/*
+ * Buffer has been mapped or accessed by CPU. Cache maintenance of the buffer
+ * cannot be skipped anymore.
+ */
+#define ION_PRIV_FLAG_CPU_ACCESS BIT(2)
 
 /**
  * struct ion_heap - represents a heap in the system
@@ -332,6 +343,9 @@ size_t ion_heap_freelist_size(struct ion_heap *heap);
  * @order:		order of pages in the pool
  * @list:		plist node for list of pools
  * @cached:		it's cached pool or not
+ * @hit:		number of allocations served from the pool
+ * @miss:		number of allocations served by the page allocator
+ * @prefilled:		number of items added by ion_page_pool_prefill()
  *
  * Allows you to keep a pool of pre allocated pages to use from your heap.
  * Keeping a pool of pages that is ready for dma, ie any cached mapping have
@@ -348,14 +362,32 @@ struct ion_page_pool {
 	gfp_t gfp_mask;
 	unsigned int order;
 	struct plist_node list;
+	unsigned long hit;
+	unsigned long miss;
+	unsigned long prefilled;
 };
 
 struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order,
 					   bool cached);
 void ion_page_pool_destroy(struct ion_page_pool *pool);
 struct page *ion_page_pool_alloc(struct ion_page_pool *pool, bool nozero);
+struct page *ion_page_pool_only_alloc(struct ion_page_pool *pool);
 void ion_page_pool_free(struct ion_page_pool *pool, struct page *page);
 
+/** ion_page_pool_prefill - fills the pool with zeroed pages
+ * @pool:		the pool
+ * @nr_items:		number of items the pool should hold
+ *
+ * Pages are taken only from free memory without reclaim. Returns the number
+ * of items added.
+ */
+int ion_page_pool_prefill(struct ion_page_pool *pool, int nr_items);
+
+static inline int ion_page_pool_count(struct ion_page_pool *pool)
+{
+	return READ_ONCE(pool->high_count) + READ_ONCE(pool->low_count);
+}
+
 /** ion_page_pool_shrink - shrinks the size of the memory cached in the pool
  * @pool:		the pool
  * @gfp_mask:		the memory type to reclaim
@@ -15,97 +15,122 @@
  */
 
 #include <linux/slab.h>
-#include <linux/genalloc.h>
+#include <linux/bitmap.h>
+#include <linux/vmalloc.h>
+#include <linux/seq_file.h>
 #include <linux/smc.h>
 
 #include <asm/cacheflush.h>
 
 #include "ion.h"
 #include "ion_exynos.h"
+#include "ion_debug.h"
 
 #ifdef CONFIG_EXYNOS_CONTENT_PATH_PROTECTION
 
 #define ION_SECURE_DMA_BASE	0x80000000
 #define ION_SECURE_DMA_END	0xE0000000
-
-static struct gen_pool *secure_iova_pool;
-static DEFINE_SPINLOCK(siova_pool_lock);
+#define ION_SECURE_DMA_PAGES	\
+	((ION_SECURE_DMA_END - ION_SECURE_DMA_BASE) >> PAGE_SHIFT)
 
 #define MAX_IOVA_ALIGNMENT      12
 
-static unsigned long find_first_fit_with_align(unsigned long *map,
-					       unsigned long size,
-					       unsigned long start,
-					       unsigned int nr, void *data,
-					       struct gen_pool *pool)
-{
-	unsigned long align = ((*(unsigned int *)data) >> PAGE_SHIFT);
-
-	if (align > (1 << MAX_IOVA_ALIGNMENT))
-		align = (1 << MAX_IOVA_ALIGNMENT);
-
-	return bitmap_find_next_zero_area(map, size, start, nr, (align - 1));
-}
+/*
+ * Secure IOVAs are handed out from a bitmap of pages. The search starts where
+ * the last allocation ended, so that the allocations of a playback start do
+ * not scan again the area filled by the previous ones. It wraps once around.
+ */
+static struct {
+	unsigned long *bitmap;
+	unsigned long next;		/* page following the last allocation */
+	unsigned long used;		/* pages */
+	unsigned long peak;		/* most pages used at once */
+	unsigned long failed;		/* allocations without room */
+} secure_iova;
+static DEFINE_SPINLOCK(siova_pool_lock);
 
 static int ion_secure_iova_alloc(unsigned long *addr, unsigned long size,
 				 unsigned int align)
 {
-	unsigned long out_addr;
+	unsigned long nr = DIV_ROUND_UP(size, PAGE_SIZE);
+	unsigned long mask = (align >> PAGE_SHIFT) - 1;
+	unsigned long start;
 
-	if (!secure_iova_pool) {
+	if (!secure_iova.bitmap) {
 		perrfn("Secure IOVA pool is not created");
 		return -ENODEV;
 	}
 
-	spin_lock(&siova_pool_lock);
-	if (align > PAGE_SIZE) {
-		gen_pool_set_algo(secure_iova_pool,
-				  find_first_fit_with_align, &align);
-		out_addr = gen_pool_alloc(secure_iova_pool, size);
-		gen_pool_set_algo(secure_iova_pool, NULL, NULL);
-	} else {
-		out_addr = gen_pool_alloc(secure_iova_pool, size);
-	}
-	spin_unlock(&siova_pool_lock);
+	if (mask >= (1 << MAX_IOVA_ALIGNMENT))
+		mask = (1 << MAX_IOVA_ALIGNMENT) - 1;
 
-	if (out_addr == 0) {
-		perrfn("failed alloc secure iova. %zu/%zu bytes used",
-		       gen_pool_avail(secure_iova_pool),
-		       gen_pool_size(secure_iova_pool));
+	spin_lock(&siova_pool_lock);
+	start = bitmap_find_next_zero_area(secure_iova.bitmap,
+					   ION_SECURE_DMA_PAGES,
+					   secure_iova.next, nr, mask);
+	if (start >= ION_SECURE_DMA_PAGES && secure_iova.next)
+		start = bitmap_find_next_zero_area(secure_iova.bitmap,
+						   ION_SECURE_DMA_PAGES,
+						   0, nr, mask);
+	if (start >= ION_SECURE_DMA_PAGES) {
+		secure_iova.failed++;
+		spin_unlock(&siova_pool_lock);
+		perrfn("failed alloc secure iova. %lu/%lu bytes used",
+		       secure_iova.used << PAGE_SHIFT,
+		       (unsigned long)ION_SECURE_DMA_PAGES << PAGE_SHIFT);
 		return -ENOMEM;
 	}
 
-	*addr = out_addr;
+	bitmap_set(secure_iova.bitmap, start, nr);
+	secure_iova.next = start + nr;
+	if (secure_iova.next >= ION_SECURE_DMA_PAGES)
+		secure_iova.next = 0;
+	secure_iova.used += nr;
+	if (secure_iova.used > secure_iova.peak)
+		secure_iova.peak = secure_iova.used;
+	spin_unlock(&siova_pool_lock);
+
+	*addr = ION_SECURE_DMA_BASE + (start << PAGE_SHIFT);
 
 	return 0;
 }
 
 static void ion_secure_iova_free(unsigned long addr, unsigned long size)
 {
-	if (!secure_iova_pool) {
+	unsigned long nr = DIV_ROUND_UP(size, PAGE_SIZE);
+
+	if (!secure_iova.bitmap) {
 		perrfn("Secure IOVA pool is not created");
 		return;
 	}
 
 	spin_lock(&siova_pool_lock);
-	gen_pool_free(secure_iova_pool, addr, size);
+	bitmap_clear(secure_iova.bitmap,
+		     (addr - ION_SECURE_DMA_BASE) >> PAGE_SHIFT, nr);
+	secure_iova.used -= nr;
+	spin_unlock(&siova_pool_lock);
+}
+
+void ion_secure_iova_show(struct seq_file *s)
+{
+	spin_lock(&siova_pool_lock);
+	seq_printf(s, "secure iova: %lu kb used, %lu kb peak, %lu kb total, %lu failed\n",
+		   secure_iova.used << (PAGE_SHIFT - 10),
+		   secure_iova.peak << (PAGE_SHIFT - 10),
+		   (unsigned long)ION_SECURE_DMA_PAGES << (PAGE_SHIFT - 10),
+		   secure_iova.failed);
 	spin_unlock(&siova_pool_lock);
 }
 
 int __init ion_secure_iova_pool_create(void)
 {
-	secure_iova_pool = gen_pool_create(PAGE_SHIFT, -1);
-	if (!secure_iova_pool) {
+	secure_iova.bitmap = vzalloc(BITS_TO_LONGS(ION_SECURE_DMA_PAGES) *
+				     sizeof(unsigned long));
+	if (!secure_iova.bitmap) {
 		perrfn("failed to create Secure IOVA pool");
 		return -ENOMEM;
 	}
 
-	if (gen_pool_add(secure_iova_pool, ION_SECURE_DMA_BASE,
-			 ION_SECURE_DMA_END - ION_SECURE_DMA_BASE, -1)) {
-		perrfn("failed to set address range of Secure IOVA pool");
-		return -ENOMEM;
-	}
-
 	return 0;
 }
 
@@ -115,6 +140,7 @@ static int ion_secure_protect(struct ion_buffer_prot_info *protdesc,
 	unsigned long size = protdesc->chunk_count * protdesc->chunk_size;
 	unsigned long dma_addr = 0;
 	enum drmdrv_result_t drmret = DRMDRV_OK;
+	ktime_t begin = ktime_get();
 	int ret;
 
 	ret = ion_secure_iova_alloc(&dma_addr, size,
@@ -135,10 +161,13 @@ static int ion_secure_protect(struct ion_buffer_prot_info *protdesc,
 		goto err_smc;
 	}
 
+	ion_debug_protect(false, size, begin, false);
+
 	return 0;
 err_smc:
 	ion_secure_iova_free(dma_addr, size);
 err_iova:
+	ion_debug_protect(false, size, begin, true);
 	perrfn("PROT:%#x (err=%d,va=%#lx,len=%#lx,cnt=%u,flg=%u)",
 	       SMC_DRM_PPMP_PROT, drmret, dma_addr, size,
 	       protdesc->chunk_count, protdesc->flags);
@@ -149,12 +178,14 @@ err_iova:
 static int ion_secure_unprotect(struct ion_buffer_prot_info *protdesc)
 {
 	unsigned long size = protdesc->chunk_count * protdesc->chunk_size;
+	ktime_t begin = ktime_get();
 	int ret;
 	/*
 	 * No need to flush protdesc for unprotection because it is never
 	 * modified since the buffer is protected.
 	 */
 	ret = exynos_smc(SMC_DRM_PPMP_UNPROT, virt_to_phys(protdesc), 0, 0);
+	ion_debug_protect(true, size, begin, ret != DRMDRV_OK);
 
 	if (ret != DRMDRV_OK) {
 		perrfn("UNPROT:%d(err=%d,va=%#x,len=%#lx,cnt=%u,flg=%u)",
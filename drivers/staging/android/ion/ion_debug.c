@@ -19,6 +19,8 @@
 #include <linux/oom.h>
 #include <linux/sort.h>
 #include <linux/slab.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
 
 #include "ion.h"
 #include "ion_exynos.h"
@@ -161,6 +163,109 @@ static const struct file_operations debug_event_fops = {
 	.release = single_release,
 };
 
+static atomic64_t cache_sync_bytes;
+static atomic64_t cache_skip_bytes;
+
+void ion_debug_cache_sync(size_t size, bool skipped)
+{
+	atomic64_add(size, skipped ? &cache_skip_bytes : &cache_sync_bytes);
+}
+
+static int ion_debug_cache_sync_show(struct seq_file *s, void *unused)
+{
+	seq_printf(s, "performed: %lld kb\n",
+		   (long long)atomic64_read(&cache_sync_bytes) / SZ_1K);
+	seq_printf(s, "skipped  : %lld kb\n",
+		   (long long)atomic64_read(&cache_skip_bytes) / SZ_1K);
+
+	return 0;
+}
+
+static int ion_debug_cache_sync_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ion_debug_cache_sync_show, inode->i_private);
+}
+
+static const struct file_operations debug_cache_sync_fops = {
+	.open = ion_debug_cache_sync_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+/* Latencies of (un)protection, in buckets of 4x from 16us */
+#define ION_PROT_BUCKETS	6
+
+static struct ion_prot_stat {
+	unsigned long count;
+	unsigned long failed;
+	unsigned long bytes;
+	u64 total_us;
+	u64 max_us;
+	unsigned long buckets[ION_PROT_BUCKETS];
+} prot_stat[2];
+static DEFINE_SPINLOCK(prot_stat_lock);
+
+void ion_debug_protect(bool unprotect, unsigned long size, ktime_t begin,
+		       bool failed)
+{
+	struct ion_prot_stat *stat = &prot_stat[unprotect];
+	u64 us = ktime_us_delta(ktime_get(), begin);
+	int bucket = us < 16 ? 0 : (ilog2(us) - 2) / 2;
+
+	spin_lock(&prot_stat_lock);
+	stat->count++;
+	if (failed)
+		stat->failed++;
+	stat->bytes += size;
+	stat->total_us += us;
+	if (us > stat->max_us)
+		stat->max_us = us;
+	stat->buckets[min(bucket, ION_PROT_BUCKETS - 1)]++;
+	spin_unlock(&prot_stat_lock);
+}
+
+static int ion_debug_protection_show(struct seq_file *s, void *unused)
+{
+	static const char * const names[] = { "protect", "unprotect" };
+	struct ion_prot_stat stat;
+	int i, j;
+
+	seq_printf(s, "%10s %8s %6s %10s %8s %8s %s\n", "type", "count",
+		   "failed", "size (kb)", "avg (us)", "max (us)",
+		   "<16us <64us <256us <1ms <4ms more");
+
+	for (i = 0; i < ARRAY_SIZE(prot_stat); i++) {
+		spin_lock(&prot_stat_lock);
+		stat = prot_stat[i];
+		spin_unlock(&prot_stat_lock);
+
+		seq_printf(s, "%10s %8lu %6lu %10lu %8llu %8llu", names[i],
+			   stat.count, stat.failed, stat.bytes / SZ_1K,
+			   stat.count ? div64_u64(stat.total_us, stat.count) : 0,
+			   stat.max_us);
+		for (j = 0; j < ION_PROT_BUCKETS; j++)
+			seq_printf(s, " %lu", stat.buckets[j]);
+		seq_puts(s, "\n");
+	}
+
+	ion_secure_iova_show(s);
+
+	return 0;
+}
+
+static int ion_debug_protection_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ion_debug_protection_show, inode->i_private);
+}
+
+static const struct file_operations debug_protection_fops = {
+	.open = ion_debug_protection_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 static int contig_heap_cmp(const void *l, const void *r)
 {
 	struct ion_buffer *left = *((struct ion_buffer **)l);
@@ -425,7 +530,7 @@ static struct ion_oom_notifier_struct ion_oom_notifier = {
 
 void ion_debug_initialize(struct ion_device *idev)
 {
-	struct dentry *buffer_file, *event_file;
+	struct dentry *buffer_file, *event_file, *sync_file, *prot_file;
 
 	buffer_file = debugfs_create_file("buffers", 0444, idev->debug_root,
 					  idev, &debug_buffers_fops);
@@ -437,6 +542,16 @@ void ion_debug_initialize(struct ion_device *idev)
 	if (!event_file)
 		perrfn("failed to create debugfs/ion/event");
 
+	sync_file = debugfs_create_file("cache_sync", 0444, idev->debug_root,
+					idev, &debug_cache_sync_fops);
+	if (!sync_file)
+		perrfn("failed to create debugfs/ion/cache_sync");
+
+	prot_file = debugfs_create_file("protection", 0444, idev->debug_root,
+					idev, &debug_protection_fops);
+	if (!prot_file)
+		perrfn("failed to create debugfs/ion/protection");
+
 	idev->heaps_debug_root = debugfs_create_dir("heaps", idev->debug_root);
 	if (!idev->heaps_debug_root)
 		perrfn("failed to create debugfs/ion/heaps directory");
@@ -20,8 +20,13 @@
 #ifdef CONFIG_ION_EXYNOS
 void ion_contig_heap_show_buffers(struct seq_file *s, struct ion_heap *heap,
 				  phys_addr_t base, size_t pool_size);
+void ion_debug_cache_sync(size_t size, bool skipped);
+void ion_debug_protect(bool unprotect, unsigned long size, ktime_t begin,
+		       bool failed);
 #else
 #define ion_contig_heap_show_buffers do { } while (0)
+#define ion_debug_cache_sync(size, skipped) do { } while (0)
+#define ion_debug_protect(unprotect, size, begin, failed) do { } while (0)
 #endif
 
 enum ion_event_type {
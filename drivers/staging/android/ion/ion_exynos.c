@@ -24,6 +24,14 @@
 #include "ion_exynos.h"
 #include "ion_debug.h"
 
+/*
+ * IOVAs of a buffer are kept until the buffer is freed even though no device
+ * uses them so that repeated maps of the same buffer are served without
+ * building page tables again. They are released under memory pressure.
+ */
+static atomic_long_t ion_idle_iovas;
+static struct ion_device *ion_exynos_dev;
+
 struct dma_buf *ion_alloc_dmabuf(const char *heap_name,
 				 size_t len, unsigned int flags)
 {
@@ -105,8 +113,9 @@ static dma_addr_t __ion_iovmm_map(struct dma_buf_attachment *attachment,
 
 	list_for_each_entry(iovm_map, &buffer->iovas, list) {
 		if ((domain == iovm_map->domain) && (prop == iovm_map->prop)) {
+			if (atomic_inc_return(&iovm_map->mapcnt) == 1)
+				atomic_long_dec(&ion_idle_iovas);
 			mutex_unlock(&buffer->lock);
-			atomic_inc(&iovm_map->mapcnt);
 			return iovm_map->iova;
 		}
 	}
@@ -188,8 +197,9 @@ void __ion_iovmm_unmap(struct dma_buf_attachment *attachment, dma_addr_t iova)
 	mutex_lock(&buffer->lock);
 	list_for_each_entry(iovm_map, &buffer->iovas, list) {
 		if ((domain == iovm_map->domain) && (iova == iovm_map->iova)) {
+			if (atomic_dec_return(&iovm_map->mapcnt) == 0)
+				atomic_long_inc(&ion_idle_iovas);
 			mutex_unlock(&buffer->lock);
-			atomic_dec(&iovm_map->mapcnt);
 			return;
 		}
 	}
@@ -237,6 +247,55 @@ void ion_iovmm_unmap_attr(struct dma_buf_attachment *attachment,
 	}
 }
 
+static unsigned long ion_exynos_iova_count(struct shrinker *shrinker,
+					   struct shrink_control *sc)
+{
+	return atomic_long_read(&ion_idle_iovas);
+}
+
+static unsigned long ion_exynos_iova_scan(struct shrinker *shrinker,
+					  struct shrink_control *sc)
+{
+	struct ion_device *idev = ion_exynos_dev;
+	unsigned long freed = 0;
+	struct rb_node *n;
+
+	if (!mutex_trylock(&idev->buffer_lock))
+		return SHRINK_STOP;
+
+	for (n = rb_first(&idev->buffers); n && freed < sc->nr_to_scan;
+	     n = rb_next(n)) {
+		struct ion_buffer *buffer = rb_entry(n, struct ion_buffer, node);
+		struct ion_iovm_map *iovm_map, *tmp;
+
+		if (!mutex_trylock(&buffer->lock))
+			continue;
+
+		list_for_each_entry_safe(iovm_map, tmp, &buffer->iovas, list) {
+			if (atomic_read(&iovm_map->mapcnt))
+				continue;
+
+			iovmm_unmap(iovm_map->dev, iovm_map->iova);
+			list_del(&iovm_map->list);
+			kfree(iovm_map);
+			atomic_long_dec(&ion_idle_iovas);
+			freed++;
+		}
+
+		mutex_unlock(&buffer->lock);
+	}
+
+	mutex_unlock(&idev->buffer_lock);
+
+	return freed;
+}
+
+static struct shrinker ion_exynos_iova_shrinker = {
+	.count_objects = ion_exynos_iova_count,
+	.scan_objects = ion_exynos_iova_scan,
+	.seeks = DEFAULT_SEEKS,
+};
+
 #define MAX_BUFFER_IDS 2048
 static DEFINE_IDA(ion_buffer_ida);
 static int last_buffer_id;
@@ -259,6 +318,9 @@ void exynos_ion_fixup(struct ion_device *idev)
 	arch_setup_dma_ops(dev, 0x0ULL, 1ULL << 36, NULL, false);
 	dev->dma_mask = &dev->coherent_dma_mask;
 	dma_set_mask(dev, DMA_BIT_MASK(36));
+
+	ion_exynos_dev = idev;
+	register_shrinker(&ion_exynos_iova_shrinker);
 }
 
 int exynos_ion_alloc_fixup(struct ion_device *idev, struct ion_buffer *buffer)
@@ -281,6 +343,10 @@ int exynos_ion_alloc_fixup(struct ion_device *idev, struct ion_buffer *buffer)
 
 	buffer->id = id;
 
+	/* heaps do not clean the zeroed pages of cached buffers */
+	if (ion_buffer_cached(buffer))
+		buffer->private_flags |= ION_PRIV_FLAG_CPU_DIRTY;
+
 	/* assign dma_addresses to scatter-gather list */
 	nents = dma_map_sg_attrs(idev->dev.this_device, table->sgl,
 				 table->orig_nents, DMA_TO_DEVICE,
@@ -306,6 +372,8 @@ void exynos_ion_free_fixup(struct ion_buffer *buffer)
 			   DMA_ATTR_SKIP_CPU_SYNC);
 
 	list_for_each_entry_safe(iovm_map, tmp, &buffer->iovas, list) {
+		if (!atomic_read(&iovm_map->mapcnt))
+			atomic_long_dec(&ion_idle_iovas);
 		iovmm_unmap(iovm_map->dev, iovm_map->iova);
 		list_del(&iovm_map->list);
 		kfree(iovm_map);
@@ -315,14 +383,71 @@ void exynos_ion_free_fixup(struct ion_buffer *buffer)
 		ida_simple_remove(&ion_buffer_ida, buffer->id);
 }
 
+/*
+ * Buffers that the CPU has never accessed do not need cache maintenance on
+ * map and unmap for the devices. The only cache lines of such a buffer are
+ * the zeroed lines left by the heap which are cleaned by the first map for a
+ * device. Such a buffer is invalidated once when CPU accesses the buffer for
+ * the first time in ion_exynos_buffer_cpu_access().
+ */
+static bool ion_exynos_need_sync(struct ion_buffer *buffer, size_t size,
+				 bool for_device)
+{
+	unsigned long flags = READ_ONCE(buffer->private_flags);
+	bool need = !!(flags & ION_PRIV_FLAG_CPU_ACCESS);
+
+	if (for_device && (flags & ION_PRIV_FLAG_CPU_DIRTY))
+		need = true;
+
+	ion_debug_cache_sync(size, !need);
+
+	return need;
+}
+
+static void ion_exynos_clear_dirty(struct ion_buffer *buffer, size_t size)
+{
+	if (size < buffer->size)
+		return;
+
+	mutex_lock(&buffer->lock);
+	buffer->private_flags &= ~ION_PRIV_FLAG_CPU_DIRTY;
+	mutex_unlock(&buffer->lock);
+}
+
+/* Should be called with buffer->lock held */
+void ion_exynos_buffer_cpu_access(struct ion_buffer *buffer)
+{
+	if (buffer->private_flags & ION_PRIV_FLAG_CPU_ACCESS)
+		return;
+
+	buffer->private_flags |= ION_PRIV_FLAG_CPU_ACCESS;
+
+	/*
+	 * Drop the lines that could be fetched speculatively while cache
+	 * maintenance of the buffer is skipped. The dirty lines left by the
+	 * heap should not be dropped.
+	 */
+	if (!ion_buffer_cached(buffer) ||
+	    (buffer->private_flags & ION_PRIV_FLAG_CPU_DIRTY))
+		return;
+
+	dma_sync_sg_for_cpu(buffer->dev->dev.this_device,
+			    buffer->sg_table->sgl,
+			    buffer->sg_table->orig_nents, DMA_FROM_DEVICE);
+
+	ion_debug_cache_sync(buffer->size, false);
+}
+
 struct sg_table *ion_exynos_map_dma_buf_area(
 		struct dma_buf_attachment *attachment,
 		enum dma_data_direction direction, size_t size)
 {
 	struct ion_buffer *buffer = attachment->dmabuf->priv;
 
-	if (ion_buffer_cached(buffer) && direction != DMA_NONE) {
+	if (ion_buffer_cached(buffer) && direction != DMA_NONE &&
+	    ion_exynos_need_sync(buffer, size, true)) {
 		struct scatterlist *sg;
+		size_t total = size;
 		int i;
 
 		ion_event_begin();
@@ -341,6 +466,8 @@ struct sg_table *ion_exynos_map_dma_buf_area(
 				break;
 		}
 
+		ion_exynos_clear_dirty(buffer, total);
+
 		ion_event_end(ION_EVENT_TYPE_MAP_DMA_BUF, buffer);
 	}
 
@@ -354,7 +481,8 @@ void ion_exynos_unmap_dma_buf_area(struct dma_buf_attachment *attachment,
 {
 	struct ion_buffer *buffer = attachment->dmabuf->priv;
 
-	if (ion_buffer_cached(buffer) && direction != DMA_NONE) {
+	if (ion_buffer_cached(buffer) && direction != DMA_NONE &&
+	    ion_exynos_need_sync(buffer, size, false)) {
 		struct scatterlist *sg;
 		int i;
 
@@ -383,12 +511,15 @@ struct sg_table *ion_exynos_map_dma_buf(struct dma_buf_attachment *attachment,
 {
 	struct ion_buffer *buffer = attachment->dmabuf->priv;
 
-	if (ion_buffer_cached(buffer) && direction != DMA_NONE) {
+	if (ion_buffer_cached(buffer) && direction != DMA_NONE &&
+	    ion_exynos_need_sync(buffer, buffer->size, true)) {
 		ion_event_begin();
 
 		dma_sync_sg_for_device(attachment->dev, buffer->sg_table->sgl,
 				       buffer->sg_table->nents, direction);
 
+		ion_exynos_clear_dirty(buffer, buffer->size);
+
 		ion_event_end(ION_EVENT_TYPE_MAP_DMA_BUF, buffer);
 	}
 
@@ -401,7 +532,8 @@ void ion_exynos_unmap_dma_buf(struct dma_buf_attachment *attachment,
 {
 	struct ion_buffer *buffer = attachment->dmabuf->priv;
 
-	if (ion_buffer_cached(buffer) && direction != DMA_NONE) {
+	if (ion_buffer_cached(buffer) && direction != DMA_NONE &&
+	    ion_exynos_need_sync(buffer, buffer->size, false)) {
 		ion_event_begin();
 
 		dma_sync_sg_for_cpu(attachment->dev, table->sgl,
@@ -433,11 +565,11 @@ int ion_exynos_dma_buf_begin_cpu_access(struct dma_buf *dmabuf,
 
 	ion_event_begin();
 
-	if (buffer->heap->ops->map_kernel) {
-		mutex_lock(&buffer->lock);
+	mutex_lock(&buffer->lock);
+	if (buffer->heap->ops->map_kernel)
 		vaddr = ion_buffer_kmap_get(buffer);
-		mutex_unlock(&buffer->lock);
-	}
+	ion_exynos_buffer_cpu_access(buffer);
+	mutex_unlock(&buffer->lock);
 
 	if (!ion_buffer_cached(buffer))
 		return 0;
@@ -453,6 +585,8 @@ int ion_exynos_dma_buf_begin_cpu_access(struct dma_buf *dmabuf,
 				    direction);
 	}
 
+	ion_debug_cache_sync(buffer->size, false);
+
 	ion_event_end(ION_EVENT_TYPE_BEGIN_CPU_ACCESS, buffer);
 
 	return 0;
@@ -485,6 +619,103 @@ int ion_exynos_dma_buf_end_cpu_access(struct dma_buf *dmabuf,
 				       direction);
 	}
 
+	ion_debug_cache_sync(buffer->size, false);
+
+	ion_event_end(ION_EVENT_TYPE_END_CPU_ACCESS, buffer);
+
+	return 0;
+}
+
+/*
+ * Cache maintenance only on the segments that overlap [@offset, @offset+@len)
+ * of @buffer. The sub-ranges of the segments are synced with the same
+ * operations as the whole buffer sync in begin/end_cpu_access.
+ */
+static void ion_exynos_sync_sg_range(struct ion_buffer *buffer,
+				     enum dma_data_direction direction,
+				     unsigned int offset, unsigned int len,
+				     bool for_cpu)
+{
+	struct device *dev = buffer->dev->dev.this_device;
+	struct scatterlist *sg;
+	unsigned int size;
+	dma_addr_t addr;
+	int i;
+
+	for_each_sg(buffer->sg_table->sgl, sg,
+		    buffer->sg_table->orig_nents, i) {
+		if (!len)
+			break;
+
+		if (offset >= sg->length) {
+			offset -= sg->length;
+			continue;
+		}
+
+		addr = sg->dma_address + offset;
+		size = min(len, sg->length - offset);
+
+		if (direction == DMA_BIDIRECTIONAL)
+			__dma_flush_area(phys_to_virt(dma_to_phys(dev, addr)),
+					 size);
+		else if (for_cpu)
+			dma_sync_single_for_cpu(dev, addr, size, direction);
+		else
+			dma_sync_single_for_device(dev, addr, size, direction);
+
+		offset = 0;
+		len -= size;
+	}
+}
+
+int ion_exynos_dma_buf_begin_cpu_access_partial(struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len)
+{
+	struct ion_buffer *buffer = dmabuf->priv;
+	void *vaddr;
+
+	ion_event_begin();
+
+	mutex_lock(&buffer->lock);
+	if (buffer->heap->ops->map_kernel)
+		vaddr = ion_buffer_kmap_get(buffer);
+	ion_exynos_buffer_cpu_access(buffer);
+	mutex_unlock(&buffer->lock);
+
+	if (!ion_buffer_cached(buffer))
+		return 0;
+
+	ion_exynos_sync_sg_range(buffer, direction, offset, len, true);
+
+	ion_debug_cache_sync(len, false);
+
+	ion_event_end(ION_EVENT_TYPE_BEGIN_CPU_ACCESS, buffer);
+
+	return 0;
+}
+
+int ion_exynos_dma_buf_end_cpu_access_partial(struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len)
+{
+	struct ion_buffer *buffer = dmabuf->priv;
+
+	ion_event_begin();
+
+	if (buffer->heap->ops->map_kernel) {
+		mutex_lock(&buffer->lock);
+		ion_buffer_kmap_put(buffer);
+		mutex_unlock(&buffer->lock);
+	}
+
+	if (!ion_buffer_cached(buffer))
+		return 0;
+
+	ion_exynos_sync_sg_range(buffer, direction, offset, len, false);
+
+	ion_debug_cache_sync(len, false);
+
 	ion_event_end(ION_EVENT_TYPE_END_CPU_ACCESS, buffer);
 
 	return 0;
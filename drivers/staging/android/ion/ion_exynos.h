@@ -27,6 +27,7 @@ struct ion_platform_heap;
 struct ion_device;
 struct ion_buffer;
 struct dma_buf_attachment;
+struct seq_file;
 
 /**
  * struct ion_buffer_prot_info - buffer protection information
@@ -80,11 +81,16 @@ extern struct ion_heap *ion_hpa_heap_create(struct ion_platform_heap *pheap,
 
 #if defined(CONFIG_EXYNOS_CONTENT_PATH_PROTECTION) && defined(CONFIG_ION_EXYNOS)
 int __init ion_secure_iova_pool_create(void);
+void ion_secure_iova_show(struct seq_file *s);
 #else
 static inline int ion_secure_iova_pool_create(void)
 {
 	return 0;
 }
+
+static inline void ion_secure_iova_show(struct seq_file *s)
+{
+}
 #endif
 
 #ifdef CONFIG_ION_EXYNOS
@@ -110,10 +116,17 @@ struct sg_table *ion_exynos_map_dma_buf(struct dma_buf_attachment *attachment,
 void ion_exynos_unmap_dma_buf(struct dma_buf_attachment *attachment,
 			      struct sg_table *table,
 			      enum dma_data_direction direction);
+void ion_exynos_buffer_cpu_access(struct ion_buffer *buffer);
 int ion_exynos_dma_buf_begin_cpu_access(struct dma_buf *dmabuf,
 					enum dma_data_direction direction);
 int ion_exynos_dma_buf_end_cpu_access(struct dma_buf *dmabuf,
 				      enum dma_data_direction direction);
+int ion_exynos_dma_buf_begin_cpu_access_partial(struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len);
+int ion_exynos_dma_buf_end_cpu_access_partial(struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len);
 void ion_debug_initialize(struct ion_device *idev);
 void ion_debug_heap_init(struct ion_heap *heap);
 
@@ -152,6 +165,7 @@ static inline struct sg_table *ion_exynos_map_dma_buf(
 }
 
 #define ion_exynos_unmap_dma_buf(attachment, table, direction) do { } while (0)
+#define ion_exynos_buffer_cpu_access(buffer) do { } while (0)
 
 static inline int ion_exynos_dma_buf_begin_cpu_access(
 					struct dma_buf *dmabuf,
@@ -167,6 +181,22 @@ static inline int ion_exynos_dma_buf_end_cpu_access(
 	return 0;
 }
 
+static inline int ion_exynos_dma_buf_begin_cpu_access_partial(
+					struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len)
+{
+	return 0;
+}
+
+static inline int ion_exynos_dma_buf_end_cpu_access_partial(
+					struct dma_buf *dmabuf,
+					enum dma_data_direction direction,
+					unsigned int offset, unsigned int len)
+{
+	return 0;
+}
+
 #define ion_debug_initialize(idev) do { } while (0)
 #define ion_debug_heap_init(idev) do { } while (0)
 #endif
@@ -93,6 +93,11 @@ struct page *ion_page_pool_alloc(struct ion_page_pool *pool, bool nozero)
 		page = ion_page_pool_remove(pool, true);
 	else if (pool->low_count)
 		page = ion_page_pool_remove(pool, false);
+
+	if (page)
+		pool->hit++;
+	else
+		pool->miss++;
 	mutex_unlock(&pool->mutex);
 
 	if (!page) {
@@ -105,6 +110,24 @@ struct page *ion_page_pool_alloc(struct ion_page_pool *pool, bool nozero)
 	return page;
 }
 
+/* Allocates from the items in the pool only, never from the page allocator */
+struct page *ion_page_pool_only_alloc(struct ion_page_pool *pool)
+{
+	struct page *page = NULL;
+
+	mutex_lock(&pool->mutex);
+	if (pool->high_count)
+		page = ion_page_pool_remove(pool, true);
+	else if (pool->low_count)
+		page = ion_page_pool_remove(pool, false);
+
+	if (page)
+		pool->hit++;
+	mutex_unlock(&pool->mutex);
+
+	return page;
+}
+
 void ion_page_pool_free(struct ion_page_pool *pool, struct page *page)
 {
 	int ret;
@@ -116,6 +139,34 @@ void ion_page_pool_free(struct ion_page_pool *pool, struct page *page)
 		ion_page_pool_free_pages(pool, page);
 }
 
+int ion_page_pool_prefill(struct ion_page_pool *pool, int nr_items)
+{
+	gfp_t gfpmask = (pool->gfp_mask | __GFP_ZERO | __GFP_NOWARN |
+			 __GFP_NORETRY) & ~__GFP_RECLAIM;
+	struct page *page;
+	int added = 0;
+
+	while (ion_page_pool_count(pool) < nr_items) {
+		page = alloc_pages(gfpmask, pool->order);
+		if (!page)
+			break;
+
+		if (!pool->cached)
+			__flush_dcache_area(page_to_virt(page),
+					    1 << (PAGE_SHIFT + pool->order));
+
+		ion_page_pool_add(pool, page);
+		added++;
+		cond_resched();
+	}
+
+	mutex_lock(&pool->mutex);
+	pool->prefilled += added;
+	mutex_unlock(&pool->mutex);
+
+	return added;
+}
+
 static int ion_page_pool_total(struct ion_page_pool *pool, bool high)
 {
 	int count = pool->low_count;
@@ -169,6 +220,9 @@ struct ion_page_pool *ion_page_pool_create(gfp_t gfp_mask, unsigned int order,
 		return NULL;
 	pool->high_count = 0;
 	pool->low_count = 0;
+	pool->hit = 0;
+	pool->miss = 0;
+	pool->prefilled = 0;
 	INIT_LIST_HEAD(&pool->low_items);
 	INIT_LIST_HEAD(&pool->high_items);
 	pool->gfp_mask = gfp_mask | __GFP_COMP;
@@ -18,11 +18,14 @@
 #include <linux/dma-mapping.h>
 #include <linux/err.h>
 #include <linux/highmem.h>
+#include <linux/list_sort.h>
 #include <linux/mm.h>
+#include <linux/moduleparam.h>
 #include <linux/scatterlist.h>
 #include <linux/seq_file.h>
 #include <linux/slab.h>
 #include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 #include "ion.h"
 
 #define NUM_ORDERS ARRAY_SIZE(orders)
@@ -32,6 +35,18 @@ static gfp_t high_order_gfp_flags = (GFP_HIGHUSER | __GFP_ZERO | __GFP_NOWARN |
 static gfp_t low_order_gfp_flags  = GFP_HIGHUSER | __GFP_ZERO;
 static const unsigned int orders[] = {8, 4, 0};
 
+/*
+ * Number of items per order kept zeroed in the pools ahead of allocation.
+ * The pool is filled up to the value in the background once an allocation
+ * leaves it below half of the value.
+ */
+static int prefill_uncached[] = {16, 64, 256};
+static int prefill_cached[] = {0, 0, 0};
+static int nr_prefill_uncached = ARRAY_SIZE(prefill_uncached);
+static int nr_prefill_cached = ARRAY_SIZE(prefill_cached);
+module_param_array(prefill_uncached, int, &nr_prefill_uncached, 0644);
+module_param_array(prefill_cached, int, &nr_prefill_cached, 0644);
+
 static int order_to_index(unsigned int order)
 {
 	int i;
@@ -52,30 +67,63 @@ struct ion_system_heap {
 	struct ion_heap heap;
 	struct ion_page_pool *uncached_pools[NUM_ORDERS];
 	struct ion_page_pool *cached_pools[NUM_ORDERS];
+	struct work_struct prefill_work;
 };
 
+static void ion_system_heap_prefill_work(struct work_struct *work)
+{
+	struct ion_system_heap *heap = container_of(work, struct ion_system_heap,
+						    prefill_work);
+	int i;
+
+	for (i = 0; i < NUM_ORDERS; i++) {
+		ion_page_pool_prefill(heap->uncached_pools[i],
+				      READ_ONCE(prefill_uncached[i]));
+		ion_page_pool_prefill(heap->cached_pools[i],
+				      READ_ONCE(prefill_cached[i]));
+	}
+}
+
+static void ion_system_heap_check_prefill(struct ion_system_heap *heap,
+					  struct ion_page_pool *pool)
+{
+	int *prefill = pool->cached ? prefill_cached : prefill_uncached;
+	int target = READ_ONCE(prefill[order_to_index(pool->order)]);
+
+	if (ion_page_pool_count(pool) < target / 2)
+		queue_work(system_unbound_wq, &heap->prefill_work);
+}
+
 /**
  * The page from page-pool are all zeroed before. We need do cache
  * clean for cached buffer. The uncached buffer are always non-cached
  * since it's allocated. So no need for non-cached pages.
  */
+static struct ion_page_pool *buffer_page_pool(struct ion_system_heap *heap,
+					      struct ion_buffer *buffer,
+					      unsigned long order)
+{
+	bool cached = ion_buffer_cached(buffer);
+	bool cleancache = buffer->flags & ION_FLAG_SYNC_FORCE;
+
+	if (!cached || cleancache)
+		return heap->uncached_pools[order_to_index(order)];
+
+	return heap->cached_pools[order_to_index(order)];
+}
+
 static struct page *alloc_buffer_page(struct ion_system_heap *heap,
 				      struct ion_buffer *buffer,
 				      unsigned long order)
 {
-	bool cached = ion_buffer_cached(buffer);
 	bool nozero = buffer->flags & ION_FLAG_NOZEROED;
-	bool cleancache = buffer->flags & ION_FLAG_SYNC_FORCE;
-	struct ion_page_pool *pool;
+	struct ion_page_pool *pool = buffer_page_pool(heap, buffer, order);
 	struct page *page;
 
-	if (!cached || cleancache)
-		pool = heap->uncached_pools[order_to_index(order)];
-	else
-		pool = heap->cached_pools[order_to_index(order)];
-
 	page = ion_page_pool_alloc(pool, nozero);
 
+	ion_system_heap_check_prefill(heap, pool);
+
 	return page;
 }
 
@@ -106,6 +154,11 @@ static void free_buffer_page(struct ion_system_heap *heap,
 	ion_page_pool_free(pool, page);
 }
 
+/*
+ * Orders larger than @max_order already failed in the page allocator during
+ * this allocation, but pool items of those orders are still taken since the
+ * pages are sorted by order afterwards.
+ */
 static struct page *alloc_largest_available(struct ion_system_heap *heap,
 					    struct ion_buffer *buffer,
 					    unsigned long size,
@@ -117,10 +170,12 @@ static struct page *alloc_largest_available(struct ion_system_heap *heap,
 	for (i = 0; i < NUM_ORDERS; i++) {
 		if (size < order_to_size(orders[i]))
 			continue;
-		if (max_order < orders[i])
-			continue;
 
-		page = alloc_buffer_page(heap, buffer, orders[i]);
+		if (max_order < orders[i])
+			page = ion_page_pool_only_alloc(
+				buffer_page_pool(heap, buffer, orders[i]));
+		else
+			page = alloc_buffer_page(heap, buffer, orders[i]);
 		if (!page)
 			continue;
 
@@ -130,6 +185,14 @@ static struct page *alloc_largest_available(struct ion_system_heap *heap,
 	return NULL;
 }
 
+static int page_order_cmp(void *priv, struct list_head *a, struct list_head *b)
+{
+	struct page *pa = list_entry(a, struct page, lru);
+	struct page *pb = list_entry(b, struct page, lru);
+
+	return compound_order(pb) - compound_order(pa);
+}
+
 static int ion_system_heap_allocate(struct ion_heap *heap,
 				    struct ion_buffer *buffer,
 				    unsigned long size,
@@ -159,9 +222,17 @@ static int ion_system_heap_allocate(struct ion_heap *heap,
 			goto free_pages;
 		list_add_tail(&page->lru, &pages);
 		size_remaining -= PAGE_SIZE << compound_order(page);
-		max_order = compound_order(page);
+		max_order = min(max_order, compound_order(page));
 		i++;
 	}
+
+	/*
+	 * IOVMM places buffers at 1MB aligned addresses. Laying the chunks out
+	 * from the largest order keeps every 1MB and 64KB chunk at an address
+	 * aligned to its size, so exynos-iommu maps them with section and
+	 * large page entries instead of 4KB small pages.
+	 */
+	list_sort(NULL, &pages, page_order_cmp);
 	table = kmalloc(sizeof(*table), GFP_KERNEL);
 	if (!table)
 		goto free_pages;
@@ -294,6 +365,16 @@ static int ion_system_heap_debug_show(struct ion_heap *heap, struct seq_file *s,
 			   pool->low_count, pool->order,
 			   (PAGE_SIZE << pool->order) * pool->low_count);
 	}
+
+	seq_puts(s, "order  pool       hit       miss  prefilled\n");
+	for (i = 0; i < NUM_ORDERS; i++) {
+		pool = sys_heap->uncached_pools[i];
+		seq_printf(s, "%5u  uncached %9lu %9lu %9lu\n", pool->order,
+			   pool->hit, pool->miss, pool->prefilled);
+		pool = sys_heap->cached_pools[i];
+		seq_printf(s, "%5u  cached   %9lu %9lu %9lu\n", pool->order,
+			   pool->hit, pool->miss, pool->prefilled);
+	}
 	return 0;
 }
 
@@ -415,6 +496,7 @@ static struct ion_heap *__ion_system_heap_create(void)
 	heap->heap.ops = &system_heap_ops;
 	heap->heap.type = ION_HEAP_TYPE_SYSTEM;
 	heap->heap.flags = ION_HEAP_FLAG_DEFER_FREE;
+	INIT_WORK(&heap->prefill_work, ion_system_heap_prefill_work);
 
 	if (ion_system_heap_create_pools(heap->uncached_pools, false))
 		goto free_heap;
@@ -423,6 +505,7 @@ static struct ion_heap *__ion_system_heap_create(void)
 		goto destroy_uncached_pools;
 
 	heap->heap.debug_show = ion_system_heap_debug_show;
+	queue_work(system_unbound_wq, &heap->prefill_work);
 	
 	if (!system_heap) {
 		system_heap = heap;
@@ -43,7 +43,11 @@
 #include <linux/profile.h>
 #include <linux/notifier.h>
 #include <linux/ratelimit.h>
+#include <linux/ktime.h>
+#include <linux/bitmap.h>
 
+#define CREATE_TRACE_POINTS
+#include "trace/lowmemorykiller.h"
 
 static u32 lowmem_debug_level = 1;
 static short lowmem_adj[6] = {
@@ -68,6 +72,21 @@ static int lmkd_cricount;
 
 static unsigned long lowmem_deathpending_timeout;
 
+/*
+ * The victim being waited for. It is recorded at kill and released when its
+ * mm is torn down, so the latency from pressure detection to memory freed
+ * can be traced.
+ */
+static struct {
+	struct mm_struct *mm;
+	pid_t pid;
+	int tasksize;
+	ktime_t detect;
+	ktime_t kill;
+} lowmem_victim;
+static DEFINE_SPINLOCK(lowmem_victim_lock);
+static u32 lowmem_kill_latency_us;
+
 #define lowmem_print(level, x...)			\
 	do {						\
 		if (lowmem_debug_level >= (level))	\
@@ -119,6 +138,144 @@ static void show_memory(void)
 #undef K
 }
 
+#ifdef CONFIG_ANDROID_LMK_ADJ_INDEX
+/*
+ * Candidate index. Each thread group leader is linked into the bucket of its
+ * oom_score_adj and a bitmap tracks populated buckets, so the scan starts at
+ * the highest populated bucket and stops at the first bucket that yields a
+ * victim instead of walking every process. Writers are serialized by
+ * lmk_adj_lock, the scan walks the buckets under rcu like the task list.
+ */
+#define LMK_ADJ_BUCKET_SHIFT	3
+#define LMK_ADJ_BUCKET(adj)	(((adj) - OOM_SCORE_ADJ_MIN) >> LMK_ADJ_BUCKET_SHIFT)
+#define LMK_ADJ_NR_BUCKETS	(LMK_ADJ_BUCKET(OOM_SCORE_ADJ_MAX) + 1)
+
+static struct hlist_head lmk_adj_bucket[LMK_ADJ_NR_BUCKETS];
+static DECLARE_BITMAP(lmk_adj_map, LMK_ADJ_NR_BUCKETS);
+static DEFINE_SPINLOCK(lmk_adj_lock);
+
+static void __lmk_adj_link(struct task_struct *p)
+{
+	int b = LMK_ADJ_BUCKET(p->signal->oom_score_adj);
+
+	hlist_add_head_rcu(&p->lmk_adj_node, &lmk_adj_bucket[b]);
+	p->lmk_adj_bucket = b;
+	__set_bit(b, lmk_adj_map);
+}
+
+static void __lmk_adj_unlink(struct task_struct *p)
+{
+	int b = p->lmk_adj_bucket;
+
+	hlist_del_init_rcu(&p->lmk_adj_node);
+	if (hlist_empty(&lmk_adj_bucket[b]))
+		__clear_bit(b, lmk_adj_map);
+}
+
+/* Called with tasklist_lock held for a new thread group leader */
+void lmk_adj_add(struct task_struct *p)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	__lmk_adj_link(p);
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+}
+
+/* Called with tasklist_lock held when a thread group leader is released */
+void lmk_adj_del(struct task_struct *p)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	if (!hlist_unhashed(&p->lmk_adj_node))
+		__lmk_adj_unlink(p);
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+}
+
+/* Called with tasklist_lock held when exec makes @new the group leader */
+void lmk_adj_replace(struct task_struct *old, struct task_struct *new)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	if (!hlist_unhashed(&old->lmk_adj_node)) {
+		__lmk_adj_unlink(old);
+		__lmk_adj_link(new);
+	}
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+}
+
+/* Moves the process of @p to the bucket of its current oom_score_adj */
+void lmk_adj_update(struct task_struct *p)
+{
+	unsigned long flags;
+
+	p = p->group_leader;
+
+	spin_lock_irqsave(&lmk_adj_lock, flags);
+	if (!hlist_unhashed(&p->lmk_adj_node) &&
+	    p->lmk_adj_bucket != LMK_ADJ_BUCKET(p->signal->oom_score_adj)) {
+		__lmk_adj_unlink(p);
+		__lmk_adj_link(p);
+	}
+	spin_unlock_irqrestore(&lmk_adj_lock, flags);
+}
+
+/* Returns the highest populated bucket below @size */
+static inline int lmk_adj_last(int size)
+{
+	int b = find_last_bit(lmk_adj_map, size);
+
+	return b < size ? b : LMK_ADJ_NR_BUCKETS;
+}
+
+#define for_each_lowmem_bucket(b, min_adj)				\
+	for (b = lmk_adj_last(LMK_ADJ_NR_BUCKETS);			\
+	     b < LMK_ADJ_NR_BUCKETS && b >= LMK_ADJ_BUCKET(min_adj);	\
+	     b = lmk_adj_last(b))
+
+#define for_each_lowmem_task(tsk, b)					\
+	hlist_for_each_entry_rcu(tsk, &lmk_adj_bucket[b], lmk_adj_node)
+#else
+#define for_each_lowmem_bucket(b, min_adj)	for (b = 0; b < 1; b++)
+#define for_each_lowmem_task(tsk, b)		for_each_process(tsk)
+#endif
+
+/* Called with task_lock held on the thread of the victim owning @mm */
+static void lowmem_victim_kill(struct task_struct *p, int tasksize,
+			       ktime_t detect)
+{
+	spin_lock(&lowmem_victim_lock);
+	lowmem_victim.mm = p->mm;
+	lowmem_victim.pid = p->pid;
+	lowmem_victim.tasksize = tasksize;
+	lowmem_victim.detect = detect;
+	lowmem_victim.kill = ktime_get();
+	spin_unlock(&lowmem_victim_lock);
+}
+
+/* Called from __mmput() once the address space has been torn down */
+void lowmem_mm_exit(struct mm_struct *mm)
+{
+	ktime_t now;
+
+	if (READ_ONCE(lowmem_victim.mm) != mm)
+		return;
+
+	spin_lock(&lowmem_victim_lock);
+	if (lowmem_victim.mm == mm) {
+		now = ktime_get();
+		trace_lowmemory_reaped(lowmem_victim.pid,
+			lowmem_victim.tasksize * (long)(PAGE_SIZE / 1024),
+			ktime_to_ns(ktime_sub(lowmem_victim.kill, lowmem_victim.detect)),
+			ktime_to_ns(ktime_sub(now, lowmem_victim.kill)));
+		lowmem_kill_latency_us = ktime_us_delta(now, lowmem_victim.detect);
+		lowmem_victim.mm = NULL;
+	}
+	spin_unlock(&lowmem_victim_lock);
+}
+
 static unsigned long lowmem_count(struct shrinker *s,
 				  struct shrink_control *sc)
 {
@@ -139,6 +296,8 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 	int minfree = 0;
 	int selected_tasksize = 0;
 	short selected_oom_score_adj;
+	int b;
+	ktime_t detect = ktime_get();
 	int array_size = ARRAY_SIZE(lowmem_adj);
 	int other_free = global_zone_page_state(NR_FREE_PAGES) - totalreserve_pages;
 	int other_file = global_node_page_state(NR_FILE_PAGES) -
@@ -180,65 +339,76 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 
 	selected_oom_score_adj = min_score_adj;
 
+	/* the previous victim has not released its memory yet */
+	if (READ_ONCE(lowmem_victim.mm) &&
+	    time_before_eq(jiffies, lowmem_deathpending_timeout))
+		return SHRINK_STOP;
+
 	rcu_read_lock();
-	for_each_process(tsk) {
-		struct task_struct *p;
-		short oom_score_adj;
+	for_each_lowmem_bucket(b, min_score_adj) {
+		for_each_lowmem_task(tsk, b) {
+			struct task_struct *p;
+			short oom_score_adj;
 
-		if (tsk->flags & PF_KTHREAD)
-			continue;
+			if (tsk->flags & PF_KTHREAD)
+				continue;
 
-		p = find_lock_task_mm(tsk);
-		if (!p)
-			continue;
+			p = find_lock_task_mm(tsk);
+			if (!p)
+				continue;
 
-		if (task_lmk_waiting(p)) {
-			task_unlock(p);
+			if (task_lmk_waiting(p)) {
+				task_unlock(p);
 
-			if (time_before_eq(jiffies,
-					   lowmem_deathpending_timeout)) {
-				rcu_read_unlock();
-				return SHRINK_STOP;
-			}
+				if (time_before_eq(jiffies,
+						   lowmem_deathpending_timeout)) {
+					rcu_read_unlock();
+					return SHRINK_STOP;
+				}
 
-			continue;
-		}
-		if (p->state & TASK_UNINTERRUPTIBLE) {
-			task_unlock(p);
-			continue;
-		}
-		oom_score_adj = p->signal->oom_score_adj;
-		if (oom_score_adj < min_score_adj) {
-			task_unlock(p);
-			continue;
-		}
-		tasksize = get_mm_rss(p->mm);
+				continue;
+			}
+			if (p->state & TASK_UNINTERRUPTIBLE) {
+				task_unlock(p);
+				continue;
+			}
+			oom_score_adj = p->signal->oom_score_adj;
+			if (oom_score_adj < min_score_adj) {
+				task_unlock(p);
+				continue;
+			}
+			tasksize = get_mm_rss(p->mm);
 #if defined(CONFIG_SWAP)
-		swap_rss = get_mm_counter(p->mm, MM_SWAPENTS) *
-				swap_comp_nrpages / swap_orig_nrpages;
-		lowmem_print(3, "%s tasksize rss: %d swap_rss: %d swap: %lu/%lu\n",
-			     __func__, tasksize, swap_rss, swap_comp_nrpages,
-			     swap_orig_nrpages);
-		tasksize += swap_rss;
+			swap_rss = get_mm_counter(p->mm, MM_SWAPENTS) *
+					swap_comp_nrpages / swap_orig_nrpages;
+			lowmem_print(3, "%s tasksize rss: %d swap_rss: %d swap: %lu/%lu\n",
+				     __func__, tasksize, swap_rss, swap_comp_nrpages,
+				     swap_orig_nrpages);
+			tasksize += swap_rss;
 #endif
-		task_unlock(p);
-		if (tasksize <= 0)
-			continue;
-		if (selected) {
-			if (oom_score_adj < selected_oom_score_adj)
-				continue;
-			if (oom_score_adj == selected_oom_score_adj &&
-			    tasksize <= selected_tasksize)
+			task_unlock(p);
+			if (tasksize <= 0)
 				continue;
-		}
-		selected = p;
-		selected_tasksize = tasksize;
+			if (selected) {
+				if (oom_score_adj < selected_oom_score_adj)
+					continue;
+				if (oom_score_adj == selected_oom_score_adj &&
+				    tasksize <= selected_tasksize)
+					continue;
+			}
+			selected = p;
+			selected_tasksize = tasksize;
 #if defined(CONFIG_SWAP)
-		selected_swap_rss = swap_rss;
+			selected_swap_rss = swap_rss;
 #endif
-		selected_oom_score_adj = oom_score_adj;
-		lowmem_print(2, "select '%s' (%d), adj %hd, size %d, to kill\n",
-			     p->comm, p->pid, oom_score_adj, tasksize);
+			selected_oom_score_adj = oom_score_adj;
+			lowmem_print(2, "select '%s' (%d), adj %hd, size %d, to kill\n",
+				     p->comm, p->pid, oom_score_adj, tasksize);
+		}
+
+		/* lower buckets only hold lower oom_score_adj */
+		if (selected)
+			break;
 	}
 	if (selected) {
 #if defined(CONFIG_SWAP)
@@ -246,9 +416,16 @@ static unsigned long lowmem_scan(struct shrinker *s, struct shrink_control *sc)
 #endif
 		task_lock(selected);
 		send_sig(SIGKILL, selected, 0);
-		if (selected->mm)
+		if (selected->mm) {
 			task_set_lmk_waiting(selected);
+			lowmem_victim_kill(selected, selected_tasksize, detect);
+		}
 		task_unlock(selected);
+		trace_lowmemory_kill(selected, selected_oom_score_adj,
+				     other_file * (long)(PAGE_SIZE / 1024),
+				     minfree * (long)(PAGE_SIZE / 1024),
+				     other_free * (long)(PAGE_SIZE / 1024),
+				     ktime_to_ns(ktime_sub(ktime_get(), detect)));
 		lowmem_print(1, "Killing '%s' (%d), adj %hd,\n"
 #if defined(CONFIG_SWAP)
 				 "   to free %ldkB (%ldKB %ldKB) on behalf of '%s' (%d) because\n"
@@ -316,5 +493,6 @@ module_param_array_named(minfree, lowmem_minfree, uint, &lowmem_minfree_size,
 			 0644);
 module_param_named(debug_level, lowmem_debug_level, uint, 0644);
 module_param_named(lmkcount, lowmem_lmkcount, uint, 0444);
+module_param_named(kill_latency_us, lowmem_kill_latency_us, uint, 0444);
 module_param_named(lmkd_count, lmkd_count, int, 0644);
 module_param_named(lmkd_cricount, lmkd_cricount, int, 0644);
\ No newline at end of file
@@ -0,0 +1,69 @@
+#undef TRACE_SYSTEM
+#define TRACE_INCLUDE_PATH ../../drivers/staging/android/trace
+#define TRACE_SYSTEM lowmemorykiller
+
+#if !defined(_TRACE_LOWMEMORYKILLER_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_LOWMEMORYKILLER_H
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(lowmemory_kill,
+	TP_PROTO(struct task_struct *killed_task, short adj, long cache_size,
+		 long cache_limit, long free, s64 select_ns),
+
+	TP_ARGS(killed_task, adj, cache_size, cache_limit, free, select_ns),
+
+	TP_STRUCT__entry(
+		__array(char,	comm,	TASK_COMM_LEN)
+		__field(pid_t,	pid)
+		__field(short,	adj)
+		__field(long,	pagecache_size)
+		__field(long,	pagecache_limit)
+		__field(long,	free)
+		__field(s64,	select_ns)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, killed_task->comm, TASK_COMM_LEN);
+		__entry->pid		= killed_task->pid;
+		__entry->adj		= adj;
+		__entry->pagecache_size	= cache_size;
+		__entry->pagecache_limit = cache_limit;
+		__entry->free		= free;
+		__entry->select_ns	= select_ns;
+	),
+
+	TP_printk("%s (%d) adj %hd, page cache %ldkB (limit %ldkB), free %ldkB, select %lldns",
+		  __entry->comm, __entry->pid, __entry->adj,
+		  __entry->pagecache_size, __entry->pagecache_limit,
+		  __entry->free, __entry->select_ns)
+);
+
+TRACE_EVENT(lowmemory_reaped,
+	TP_PROTO(pid_t pid, long size, s64 kill_ns, s64 reap_ns),
+
+	TP_ARGS(pid, size, kill_ns, reap_ns),
+
+	TP_STRUCT__entry(
+		__field(pid_t,	pid)
+		__field(long,	size)
+		__field(s64,	kill_ns)
+		__field(s64,	reap_ns)
+	),
+
+	TP_fast_assign(
+		__entry->pid		= pid;
+		__entry->size		= size;
+		__entry->kill_ns	= kill_ns;
+		__entry->reap_ns	= reap_ns;
+	),
+
+	TP_printk("pid %d freed %ldkB, detect to kill %lldns, kill to free %lldns",
+		  __entry->pid, __entry->size,
+		  __entry->kill_ns, __entry->reap_ns)
+);
+
+#endif /* _TRACE_LOWMEMORYKILLER_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -26,7 +26,10 @@
 #include <linux/err.h>
 #include <linux/slab.h>
 #include <linux/cpu.h>
+#include <linux/debugfs.h>
 #include <linux/gpu_cooling.h>
+#include <linux/ktime.h>
+#include <linux/seq_file.h>
 #include <soc/samsung/tmu.h>
 #include <trace/events/thermal.h>
 
@@ -47,6 +50,29 @@ struct power_table {
 	u32 power;
 };
 
+/* IPA intervals kept for debugfs */
+#define GPU_IPA_HISTORY		16
+
+/**
+ * struct gpu_ipa_interval - power of the gpu in an IPA interval
+ * @time_ms:	time of the power request
+ * @freq:	busy weighted average frequency in KHz over the interval
+ * @load:	measured load over the interval, at @freq
+ * @static_power:	leakage at the current voltage and temperature in mW
+ * @dynamic_power:	dynamic power in mW
+ * @allowed_power:	power granted by the governor in mW
+ * @target_freq:	frequency the gpu is limited to in KHz
+ */
+struct gpu_ipa_interval {
+	u64 time_ms;
+	u32 freq;
+	u32 load;
+	u32 static_power;
+	u32 dynamic_power;
+	u32 allowed_power;
+	u32 target_freq;
+};
+
 /**
  * struct gpufreq_cooling_device - data for cooling device with gpufreq
  * @id: unique integer value corresponding to each gpufreq_cooling_device
@@ -75,6 +101,15 @@ struct gpufreq_cooling_device {
 	int *asv_coeff;
 	unsigned int var_volt_size;
 	unsigned int var_temp_size;
+	/* measured load, see gpufreq_get_measured_power() */
+	u64 *load_residency;
+	int nr_levels;
+	ktime_t last_update;
+	u32 load_freq;
+	struct gpu_ipa_interval history[GPU_IPA_HISTORY];
+	unsigned int history_idx;
+	unsigned long intervals;
+	unsigned long throttled;
 };
 
 static DEFINE_IDR(gpufreq_idr);
@@ -266,10 +301,9 @@ EXPORT_SYMBOL_GPL(gpufreq_cooling_get_freq);
  * @capacitance: dynamic power coefficient for these gpus
  *
  * Build a dynamic power to frequency table for this gpu and store it
- * in @gpufreq_cdev.  This table will be used in gpu_power_to_freq() and
- * gpu_freq_to_power() to convert between power and frequency
- * efficiently.  Power is stored in mW, frequency in KHz.  The
- * resulting table is in ascending order.
+ * in @gpufreq_cdev.  This table will be used in gpu_freq_to_power()
+ * to convert frequency to power efficiently.  Power is stored in mW,
+ * frequency in KHz.  The resulting table is in ascending order.
  *
  * Return: 0 on success, -EINVAL if there are no OPPs for any CPUs,
  * -ENOMEM if we run out of memory or -EAGAIN if an OPP was
@@ -414,43 +448,59 @@ err_mem:
 	return -ENOMEM;
 }
 
+/*
+ * Finds @x in the axis of var_table whose entries are @tbl[k * @stride] for k
+ * in 1..@size, in ascending order. Returns the index below @x and stores in
+ * @w the weight of the next one, in 1/1024, 0 out of the axis.
+ */
+static int lookup_static_axis(const int *tbl, int stride, int size, int x,
+			      int *w)
+{
+	int k, lo, hi;
+
+	for (k = 1; k < size && x >= tbl[(k + 1) * stride]; k++)
+		;
+
+	lo = tbl[k * stride];
+	hi = k < size ? tbl[(k + 1) * stride] : lo;
+	*w = (x > lo && hi > lo) ? (x - lo) * 1024 / (hi - lo) : 0;
+
+	return k;
+}
+
+/*
+ * The leakage of the ECT table is interpolated between the voltages and the
+ * temperatures of the table, so that it follows the temperature instead of
+ * jumping by a whole row or column at once.
+ */
 static int lookup_static_power(struct gpufreq_cooling_device *gpufreq_cdev,
 		unsigned long voltage, int temperature, u32 *power)
 {
-	int volt_index = 0, temp_index = 0;
-	int index = 0;
+	int stride = gpufreq_cdev->var_temp_size + 1;
+	const int *tbl = gpufreq_cdev->var_table;
+	int v, t, wv, wt;
+	s64 p0, p1;
 
 	voltage = voltage / 1000;
 	temperature  = temperature / 1000;
 
-	for (volt_index = 0; volt_index <= gpufreq_cdev->var_volt_size; volt_index++) {
-		if (voltage < gpufreq_cdev->var_table[volt_index * ((int)gpufreq_cdev->var_temp_size + 1)]) {
-			volt_index = volt_index - 1;
-			break;
-		}
-	}
-
-	if (volt_index == 0)
-		volt_index = 1;
+	v = lookup_static_axis(tbl, stride, gpufreq_cdev->var_volt_size,
+			       voltage, &wv);
+	t = lookup_static_axis(tbl, 1, gpufreq_cdev->var_temp_size,
+			       temperature, &wt);
 
-	if (volt_index > gpufreq_cdev->var_volt_size)
-		volt_index = gpufreq_cdev->var_volt_size;
+	p0 = tbl[v * stride + t];
+	if (wt)
+		p0 += (tbl[v * stride + t + 1] - p0) * wt / 1024;
 
-	for (temp_index = 0; temp_index <= gpufreq_cdev->var_temp_size; temp_index++) {
-		if (temperature < gpufreq_cdev->var_table[temp_index]) {
-			temp_index = temp_index - 1;
-			break;
-		}
+	if (wv) {
+		p1 = tbl[(v + 1) * stride + t];
+		if (wt)
+			p1 += (tbl[(v + 1) * stride + t + 1] - p1) * wt / 1024;
+		p0 += (p1 - p0) * wv / 1024;
 	}
 
-	if (temp_index == 0)
-		temp_index = 1;
-
-	if (temp_index > gpufreq_cdev->var_temp_size)
-		temp_index = gpufreq_cdev->var_temp_size;
-
-	index = (int)(volt_index * (gpufreq_cdev->var_temp_size + 1) + temp_index);
-	*power = (unsigned int)gpufreq_cdev->var_table[index];
+	*power = p0 > 0 ? (u32)p0 : 0;
 
 	return 0;
 }
@@ -468,19 +518,6 @@ static u32 gpu_freq_to_power(struct gpufreq_cooling_device *gpufreq_cdev,
 	return pt[i - 1].power;
 }
 
-static u32 gpu_power_to_freq(struct gpufreq_cooling_device *gpufreq_cdev,
-			     u32 power)
-{
-	int i;
-	struct power_table *pt = gpufreq_cdev->dyn_power_table;
-
-	for (i = 1; i < gpufreq_cdev->dyn_power_table_entries; i++)
-		if (power < pt[i].power)
-			break;
-
-	return pt[i - 1].frequency;
-}
-
 /**
  * get_static_power() - calculate the static power consumed by the gpus
  * @gpufreq_cdev:	struct &gpufreq_cooling_device for this gpu cdev
@@ -534,6 +571,74 @@ static u32 get_dynamic_power(struct gpufreq_cooling_device *gpufreq_cdev,
 	return (raw_gpu_power * gpufreq_cdev->last_load) / 100;
 }
 
+/**
+ * gpufreq_get_measured_power() - dynamic power since the previous request
+ * @gpufreq_cdev:	&gpufreq_cooling_device for this cdev
+ * @dynamic_power:	pointer in which to store the dynamic power in mW
+ *
+ * The gpu driver accounts its load per DVFS level, so the dynamic power is
+ * the one of every frequency the gpu ran at in the IPA interval, weighted
+ * by the time it was busy there, instead of the load of the last DVFS
+ * sample at the current frequency. last_load and load_freq are set to the
+ * load of the interval and to its busy weighted frequency.
+ *
+ * Return: 0 on success, -EINVAL if the gpu driver accounted nothing.
+ */
+static int gpufreq_get_measured_power(struct gpufreq_cooling_device *gpufreq_cdev,
+				      u32 *dynamic_power)
+{
+	ktime_t now = ktime_get();
+	s64 elapsed_ms = ktime_ms_delta(now, gpufreq_cdev->last_update);
+	u64 busy = 0, power = 0, freq_busy = 0;
+	unsigned long freq;
+	int i, n;
+
+	if (!gpufreq_cdev->load_residency)
+		return -EINVAL;
+
+	n = gpu_dvfs_get_load_residency(gpufreq_cdev->load_residency,
+					gpufreq_cdev->nr_levels);
+	gpufreq_cdev->last_update = now;
+	if (n <= 0 || elapsed_ms <= 0)
+		return -EINVAL;
+
+	for (i = 0; i < n; i++) {
+		u64 res = gpufreq_cdev->load_residency[i];
+
+		if (!res)
+			continue;
+
+		freq = gpu_dvfs_get_clock(i);
+		power += (u64)gpu_freq_to_power(gpufreq_cdev, freq) * res;
+		freq_busy += (u64)freq * res;
+		busy += res;
+	}
+
+	gpufreq_cdev->last_load = min_t(u64, div64_u64(busy, elapsed_ms), 100);
+	gpufreq_cdev->load_freq = busy ? div64_u64(freq_busy, busy) : 0;
+	*dynamic_power = div64_u64(power, elapsed_ms * 100);
+
+	return 0;
+}
+
+/*
+ * Dynamic power at @freq for the work measured in the last interval. The
+ * same work takes longer at a lower frequency, so the load is scaled by
+ * load_freq / @freq.
+ */
+static u32 gpufreq_dynamic_power_at(struct gpufreq_cooling_device *gpufreq_cdev,
+				    unsigned long freq)
+{
+	u64 load = gpufreq_cdev->last_load;
+
+	if (gpufreq_cdev->load_freq && freq)
+		load = div64_u64(load * gpufreq_cdev->load_freq, freq);
+	if (load > 100)
+		load = 100;
+
+	return div64_u64((u64)gpu_freq_to_power(gpufreq_cdev, freq) * load, 100);
+}
+
 /**
  * gpufreq_apply_cooling - function to apply frequency clipping.
  * @gpufreq_cdev: gpufreq_cooling_device pointer containing frequency
@@ -696,13 +801,19 @@ static int gpufreq_get_requested_power(struct thermal_cooling_device *cdev,
 	struct gpufreq_cooling_device *gpufreq_cdev = cdev->devdata;
 	u32 load_gpu = 0;
 
-	freq = gpu_dvfs_get_cur_clock();
+	struct gpu_ipa_interval *last;
 
-	load_gpu = gpu_dvfs_get_utilization();;
+	freq = gpu_dvfs_get_cur_clock();
 
-	gpufreq_cdev->last_load = load_gpu;
+	if (gpufreq_get_measured_power(gpufreq_cdev, &dynamic_power)) {
+		/* no measurement, the last DVFS sample at the current clock */
+		load_gpu = gpu_dvfs_get_utilization();
+		gpufreq_cdev->last_load = load_gpu;
+		gpufreq_cdev->load_freq = freq;
+		dynamic_power = get_dynamic_power(gpufreq_cdev, freq);
+	}
+	load_gpu = gpufreq_cdev->last_load;
 
-	dynamic_power = get_dynamic_power(gpufreq_cdev, freq);
 	ret = get_static_power(gpufreq_cdev, tz, freq, &static_power);
 
 	if (ret)
@@ -713,6 +824,17 @@ static int gpufreq_get_requested_power(struct thermal_cooling_device *cdev,
 			freq, load_gpu, dynamic_power, static_power);
 	}
 
+	gpufreq_cdev->history_idx = (gpufreq_cdev->history_idx + 1) %
+				    GPU_IPA_HISTORY;
+	last = &gpufreq_cdev->history[gpufreq_cdev->history_idx];
+	memset(last, 0, sizeof(*last));
+	last->time_ms = ktime_to_ms(ktime_get());
+	last->freq = gpufreq_cdev->load_freq;
+	last->load = load_gpu;
+	last->static_power = static_power;
+	last->dynamic_power = dynamic_power;
+	gpufreq_cdev->intervals++;
+
 	*power = static_power + dynamic_power;
 	return 0;
 }
@@ -778,20 +900,35 @@ static int gpufreq_power2state(struct thermal_cooling_device *cdev,
 			       struct thermal_zone_device *tz, u32 power,
 			       unsigned long *state)
 {
-	unsigned int cur_freq, target_freq;
-	int ret;
-	s32 dyn_power;
+	unsigned int target_freq = 0;
+	int i, ret;
 	u32 static_power;
 	struct gpufreq_cooling_device *gpufreq_cdev = cdev->devdata;
+	struct gpu_ipa_interval *last;
+
+	/*
+	 * The highest frequency whose leakage, at its own voltage, and
+	 * dynamic power for the measured work fit in @power. Budgeting the
+	 * whole dynamic power at full load and the leakage of the current
+	 * voltage throttles a partly loaded gpu far below what it may use.
+	 */
+	for (i = 0; gpu_freq_table[i].frequency != GPU_TABLE_END; i++) {
+		target_freq = gpu_freq_table[i].frequency;
+		ret = get_static_power(gpufreq_cdev, tz, target_freq,
+				       &static_power);
+		if (ret)
+			return ret;
 
-	cur_freq = gpu_dvfs_get_cur_clock();
-	ret = get_static_power(gpufreq_cdev, tz, cur_freq, &static_power);
-	if (ret)
-		return ret;
+		if (static_power + gpufreq_dynamic_power_at(gpufreq_cdev,
+				target_freq) <= power)
+			break;
+	}
 
-	dyn_power = power - static_power;
-	dyn_power = dyn_power > 0 ? dyn_power : 0;
-	target_freq = gpu_power_to_freq(gpufreq_cdev, dyn_power);
+	last = &gpufreq_cdev->history[gpufreq_cdev->history_idx];
+	last->allowed_power = power;
+	last->target_freq = target_freq;
+	if (i)
+		gpufreq_cdev->throttled++;
 
 	*state = gpufreq_cooling_get_level(0, target_freq);
 	if (*state == THERMAL_CSTATE_INVALID) {
@@ -853,6 +990,11 @@ __gpufreq_cooling_register(struct device_node *np,
 	}
 
 	if (capacitance) {
+		gpufreq_cdev->nr_levels = gpu_dvfs_get_step();
+		gpufreq_cdev->load_residency = kcalloc(gpufreq_cdev->nr_levels,
+				sizeof(*gpufreq_cdev->load_residency), GFP_KERNEL);
+		gpufreq_cdev->last_update = ktime_get();
+
 		gpufreq_cooling_ops.get_requested_power =
 			gpufreq_get_requested_power;
 		gpufreq_cooling_ops.state2power = gpufreq_state2power;
@@ -1002,6 +1144,7 @@ void gpufreq_cooling_unregister(struct thermal_cooling_device *cdev)
 
 	thermal_cooling_device_unregister(gpufreq_cdev->cool_dev);
 	release_idr(&gpufreq_idr, gpufreq_cdev->id);
+	kfree(gpufreq_cdev->load_residency);
 	kfree(gpufreq_cdev);
 }
 EXPORT_SYMBOL_GPL(gpufreq_cooling_unregister);
@@ -1054,6 +1197,43 @@ static int gpu_cooling_table_init(void)
 	return 0;
 }
 
+static int gpufreq_power_show(struct seq_file *m, void *v)
+{
+	struct gpufreq_cooling_device *gpufreq_cdev = m->private;
+	struct gpu_ipa_interval *p;
+	int i;
+
+	seq_printf(m, "intervals %lu throttled %lu\n",
+		   gpufreq_cdev->intervals, gpufreq_cdev->throttled);
+	seq_puts(m, "time_ms       freq load static dynamic estimated allowed target_freq\n");
+
+	/* oldest first */
+	for (i = 1; i <= GPU_IPA_HISTORY; i++) {
+		p = &gpufreq_cdev->history[(gpufreq_cdev->history_idx + i) %
+					   GPU_IPA_HISTORY];
+		if (!p->time_ms)
+			continue;
+		seq_printf(m, "%-12llu %7u %4u %6u %7u %9u %7u %11u\n",
+			   p->time_ms, p->freq, p->load, p->static_power,
+			   p->dynamic_power, p->static_power + p->dynamic_power,
+			   p->allowed_power, p->target_freq);
+	}
+
+	return 0;
+}
+
+static int gpufreq_power_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, gpufreq_power_show, inode->i_private);
+}
+
+static const struct file_operations gpufreq_power_fops = {
+	.open		= gpufreq_power_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static int __init exynos_gpu_cooling_init(void)
 {
 	struct device_node *np;
@@ -1104,6 +1284,10 @@ regist:
 		return -EINVAL;
 	}
 
+	if (capacitance)
+		debugfs_create_file("gpu_ipa_power", 0444, NULL, dev->devdata,
+				    &gpufreq_power_fops);
+
 	return ret;
 }
 device_initcall(exynos_gpu_cooling_init);
@@ -28,6 +28,7 @@
 #include <linux/file.h>
 #include <linux/debugfs.h>
 #include <linux/sched/clock.h>
+#include <linux/spinlock.h>
 #include <soc/samsung/acpm_ipc_ctrl.h>
 #include "exynos_acpm_tmu.h"
 
@@ -36,6 +37,99 @@ static unsigned int acpm_tmu_ch_num, acpm_tmu_size;
 static bool acpm_tmu_test_mode;
 static bool acpm_tmu_log;
 
+/*
+ * Temperatures read by TMU_IPC_READ_TEMP are kept for acpm_tmu_cache_ns,
+ * so that the thermal zone polling, the cooling devices and the sysfs
+ * readers of a zone within that time share one IPC. The firmware reads
+ * one zone per request, there is no request for all the zones at once.
+ */
+#define ACPM_TMU_CACHE_NR	16
+#define ACPM_TMU_CACHE_NS	(10 * NSEC_PER_MSEC)
+
+struct acpm_tmu_cache {
+	int temp;
+	int stat;
+	unsigned long long stamp;
+	bool valid;
+};
+
+static struct acpm_tmu_cache acpm_tmu_cache[ACPM_TMU_CACHE_NR];
+static unsigned long long acpm_tmu_cache_ns = ACPM_TMU_CACHE_NS;
+static unsigned long long acpm_tmu_ipc_count, acpm_tmu_ipc_saved;
+static DEFINE_SPINLOCK(acpm_tmu_cache_lock);
+
+static void acpm_tmu_cache_invalidate(void)
+{
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&acpm_tmu_cache_lock, flags);
+	for (i = 0; i < ACPM_TMU_CACHE_NR; i++)
+		acpm_tmu_cache[i].valid = false;
+	spin_unlock_irqrestore(&acpm_tmu_cache_lock, flags);
+}
+
+static bool acpm_tmu_cache_get(int tz, int *temp, int *stat)
+{
+	struct acpm_tmu_cache *cache;
+	unsigned long flags;
+	bool hit = false;
+
+	if (tz < 0 || tz >= ACPM_TMU_CACHE_NR)
+		return false;
+
+	cache = &acpm_tmu_cache[tz];
+
+	spin_lock_irqsave(&acpm_tmu_cache_lock, flags);
+	if (cache->valid && sched_clock() - cache->stamp < acpm_tmu_cache_ns) {
+		*temp = cache->temp;
+		*stat = cache->stat;
+		acpm_tmu_ipc_saved++;
+		hit = true;
+	}
+	spin_unlock_irqrestore(&acpm_tmu_cache_lock, flags);
+
+	return hit;
+}
+
+static void acpm_tmu_cache_put(int tz, int temp, int stat, unsigned long long stamp)
+{
+	struct acpm_tmu_cache *cache;
+	unsigned long flags;
+
+	spin_lock_irqsave(&acpm_tmu_cache_lock, flags);
+	acpm_tmu_ipc_count++;
+	if (tz >= 0 && tz < ACPM_TMU_CACHE_NR) {
+		cache = &acpm_tmu_cache[tz];
+		cache->temp = temp;
+		cache->stat = stat;
+		cache->stamp = stamp;
+		cache->valid = true;
+	}
+	spin_unlock_irqrestore(&acpm_tmu_cache_lock, flags);
+}
+
+void exynos_acpm_tmu_set_cache_time(unsigned int us)
+{
+	acpm_tmu_cache_ns = (unsigned long long)us * NSEC_PER_USEC;
+	acpm_tmu_cache_invalidate();
+}
+
+unsigned int exynos_acpm_tmu_get_cache_time(void)
+{
+	return acpm_tmu_cache_ns / NSEC_PER_USEC;
+}
+
+void exynos_acpm_tmu_get_ipc_stats(unsigned long long *count, unsigned long long *saved)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&acpm_tmu_cache_lock, flags);
+	*count = acpm_tmu_ipc_count;
+	*saved = acpm_tmu_ipc_saved;
+	spin_unlock_irqrestore(&acpm_tmu_cache_lock, flags);
+}
+
 bool exynos_acpm_tmu_is_test_mode(void)
 {
 	return acpm_tmu_test_mode;
@@ -44,6 +138,7 @@ bool exynos_acpm_tmu_is_test_mode(void)
 void exynos_acpm_tmu_set_test_mode(bool mode)
 {
 	acpm_tmu_test_mode = mode;
+	acpm_tmu_cache_invalidate();
 }
 
 void exynos_acpm_tmu_log(bool mode)
@@ -120,6 +215,9 @@ int exynos_acpm_tmu_set_read_temp(int tz, int *temp, int *stat)
 	if (acpm_tmu_test_mode)
 		return -1;
 
+	if (acpm_tmu_cache_get(tz, temp, stat))
+		return 0;
+
 	memset(&message, 0, sizeof(message));
 
 	message.req.type = TMU_IPC_READ_TEMP;
@@ -149,6 +247,8 @@ int exynos_acpm_tmu_set_read_temp(int tz, int *temp, int *stat)
 	*temp = message.resp.temp;
 	*stat = message.resp.stat;
 
+	acpm_tmu_cache_put(tz, *temp, *stat, before);
+
 	return 0;
 }
 
@@ -164,6 +264,8 @@ int exynos_acpm_tmu_set_suspend(void)
 
 	memset(&message, 0, sizeof(message));
 
+	acpm_tmu_cache_invalidate();
+
 	message.req.type = TMU_IPC_AP_SUSPEND;
 
 	config.cmd = message.data;
@@ -202,6 +304,8 @@ int exynos_acpm_tmu_set_cp_call(void)
 
 	memset(&message, 0, sizeof(message));
 
+	acpm_tmu_cache_invalidate();
+
 	message.req.type = TMU_IPC_CP_CALL;
 
 	config.cmd = message.data;
@@ -240,6 +344,8 @@ int exynos_acpm_tmu_set_resume(void)
 
 	memset(&message, 0, sizeof(message));
 
+	acpm_tmu_cache_invalidate();
+
 	message.req.type = TMU_IPC_AP_RESUME;
 
 	config.cmd = message.data;
@@ -116,5 +116,8 @@ int exynos_acpm_tmu_ipc_dump(int no, unsigned int dump[]);
 bool exynos_acpm_tmu_is_test_mode(void);
 void exynos_acpm_tmu_set_test_mode(bool mode);
 void exynos_acpm_tmu_log(bool mode);
+void exynos_acpm_tmu_set_cache_time(unsigned int us);
+unsigned int exynos_acpm_tmu_get_cache_time(void);
+void exynos_acpm_tmu_get_ipc_stats(unsigned long long *count, unsigned long long *saved);
 
 #endif /* __EXYNOS_ACPM_TMU_H__ */
@@ -41,6 +41,7 @@
 #include <linux/gpu_cooling.h>
 #include <linux/isp_cooling.h>
 #include <linux/slab.h>
+#include <linux/math64.h>
 #include <linux/debugfs.h>
 #include <linux/debug-snapshot.h>
 #include <linux/cpuhotplug.h>
@@ -785,6 +786,161 @@ static void exynos9610_tmu_control(struct platform_device *pdev, bool on)
 	tmu_core_enable(pdev);
 }
 
+/*
+ * Slope of the samples in millicelsius per second by least squares method.
+ */
+static int exynos_tmu_predict_slope(struct exynos_tmu_predict *pr)
+{
+	s64 sx = 0, sy = 0, sxy = 0, sxx = 0, denom;
+	int oldest = (pr->head - pr->count + TMU_PREDICT_WINDOW) % TMU_PREDICT_WINDOW;
+	int i, n = pr->count;
+
+	if (n < 2)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		int idx = (oldest + i) % TMU_PREDICT_WINDOW;
+		s64 x = ktime_ms_delta(pr->time[idx], pr->time[oldest]);
+		s64 y = pr->temp[idx];
+
+		sx += x;
+		sy += y;
+		sxy += x * y;
+		sxx += x * x;
+	}
+
+	denom = n * sxx - sx * sx;
+	if (!denom)
+		return 0;
+
+	return (int)div64_s64((n * sxy - sx * sy) * MSEC_PER_SEC, denom);
+}
+
+static void exynos_tmu_predict_account(struct exynos_tmu_predict *pr, ktime_t now)
+{
+	s64 delta = ktime_ms_delta(now, pr->last_update);
+
+	pr->last_update = now;
+
+	if (!pr->throttling || delta <= 0)
+		return;
+
+	pr->cap_sum += (u64)pr->cap * delta;
+	pr->cap_time += delta;
+}
+
+/*
+ * Called with every temperature sample. While the temperature extrapolated
+ * over horizon_ms is within margin of the first trip, the cap is lowered by
+ * step_freq per sample. Once it is below the margin by hysteresis, the cap
+ * is raised again by step_freq per sample. A throttling episode that ends
+ * without reaching the trip is counted as an avoided trip.
+ */
+static void exynos_tmu_predict(struct exynos_tmu_data *data, int temp)
+{
+	struct exynos_tmu_predict *pr = data->predict;
+	struct thermal_zone_device *tz = data->tzd;
+	unsigned int cap;
+	int trip_temp;
+	ktime_t now;
+
+	if (!pr || IS_ERR_OR_NULL(tz) || !tz->ops->get_trip_temp)
+		return;
+
+	if (tz->ops->get_trip_temp(tz, 0, &trip_temp))
+		return;
+
+	now = ktime_get();
+	exynos_tmu_predict_account(pr, now);
+
+	pr->time[pr->head] = now;
+	pr->temp[pr->head] = temp;
+	pr->head = (pr->head + 1) % TMU_PREDICT_WINDOW;
+	if (pr->count < TMU_PREDICT_WINDOW)
+		pr->count++;
+
+	pr->slope = exynos_tmu_predict_slope(pr);
+	pr->predicted = temp + pr->slope * (int)pr->horizon_ms / (int)MSEC_PER_SEC;
+
+	cap = pr->cap;
+	if (pr->predicted >= trip_temp - pr->margin) {
+		if (!pr->throttling) {
+			pr->throttling = true;
+			pr->tripped = false;
+			pr->episodes++;
+		}
+
+		cap = (cap > pr->min_freq + pr->step_freq) ?
+				cap - pr->step_freq : pr->min_freq;
+	} else if (pr->throttling &&
+			pr->predicted < trip_temp - pr->margin - pr->hysteresis) {
+		cap = min(cap + pr->step_freq, pr->max_freq);
+	}
+
+	if (pr->throttling && temp >= trip_temp)
+		pr->tripped = true;
+
+	if (cap != pr->cap) {
+		pr->cap = cap;
+		pm_qos_update_request(&pr->qos_req, cap);
+		dbg_snapshot_thermal(data->pdata, temp / MCELSIUS, "predict", cap);
+	}
+
+	if (pr->throttling && pr->cap == pr->max_freq) {
+		pr->throttling = false;
+		if (pr->tripped)
+			pr->missed++;
+		else
+			pr->avoided++;
+	}
+}
+
+static void exynos_tmu_predict_init(struct platform_device *pdev)
+{
+	struct exynos_tmu_data *data = platform_get_drvdata(pdev);
+	struct device_node *np = pdev->dev.of_node;
+	struct exynos_tmu_predict *pr;
+	u32 val;
+
+	if (of_property_read_u32(np, "predict_pm_qos_class", &val))
+		return;
+
+	pr = devm_kzalloc(&pdev->dev, sizeof(*pr), GFP_KERNEL);
+	if (!pr)
+		return;
+
+	pr->pm_qos_class = val;
+
+	if (of_property_read_u32(np, "predict_max_freq", &pr->max_freq) ||
+		of_property_read_u32(np, "predict_min_freq", &pr->min_freq) ||
+		of_property_read_u32(np, "predict_step_freq", &pr->step_freq) ||
+		pr->min_freq >= pr->max_freq || !pr->step_freq) {
+		dev_err(&pdev->dev, "invalid predictive throttling frequency\n");
+		devm_kfree(&pdev->dev, pr);
+		return;
+	}
+
+	pr->horizon_ms = 1000;
+	of_property_read_u32(np, "predict_horizon_ms", &pr->horizon_ms);
+
+	/* margin and hysteresis are given in celsius */
+	val = 3;
+	of_property_read_u32(np, "predict_margin", &val);
+	pr->margin = val * MCELSIUS;
+	val = 2;
+	of_property_read_u32(np, "predict_hysteresis", &val);
+	pr->hysteresis = val * MCELSIUS;
+
+	pr->cap = pr->max_freq;
+	pr->last_update = ktime_get();
+	pm_qos_add_request(&pr->qos_req, pr->pm_qos_class, PM_QOS_DEFAULT_VALUE);
+
+	data->predict = pr;
+
+	dev_info(&pdev->dev, "predictive throttling %u~%u kHz, horizon %ums\n",
+			pr->min_freq, pr->max_freq, pr->horizon_ms);
+}
+
 #define MCINFO_LOG_THRESHOLD	(4)
 
 static int exynos_get_temp(void *p, int *temp)
@@ -813,6 +969,8 @@ static int exynos_get_temp(void *p, int *temp)
 	else
 		*temp = code_to_temp(data, data->tmu_read(data)) * MCELSIUS;
 
+	exynos_tmu_predict(data, *temp);
+
 	mutex_unlock(&data->lock);
 
 #ifndef CONFIG_EXYNOS_ACPM_THERMAL
@@ -898,6 +1056,39 @@ static int exynos_get_trend(void *p, int trip, enum thermal_trend *trend)
 	return 0;
 }
 
+/*
+ * Returns the distance from the current temperature to the first trip point
+ * of the sensor in millicelsius and the trend of the temperature. It uses
+ * the temperature last updated by the thermal core, so it does not access
+ * the sensor and can be called in atomic context.
+ */
+int exynos_tmu_get_headroom(const char *tmu_name, int *headroom,
+				enum thermal_trend *trend)
+{
+	struct exynos_tmu_data *data;
+	struct thermal_zone_device *tz;
+	int trip_temp, ret;
+
+	list_for_each_entry(data, &dtm_dev_list, node) {
+		if (strncasecmp(data->tmu_name, tmu_name, THERMAL_NAME_LENGTH))
+			continue;
+
+		tz = data->tzd;
+		if (IS_ERR_OR_NULL(tz) || !data->enabled)
+			return -ENODEV;
+
+		ret = tz->ops->get_trip_temp(tz, 0, &trip_temp);
+		if (ret < 0)
+			return ret;
+
+		*headroom = trip_temp - READ_ONCE(tz->temperature);
+
+		return exynos_get_trend(data, 0, trend);
+	}
+
+	return -ENODEV;
+}
+
 #ifdef CONFIG_THERMAL_EMULATION
 static void exynos9810_tmu_set_emulation(struct exynos_tmu_data *data,
 					 int temp)
@@ -1513,6 +1704,39 @@ hotplug_in_temp_store(struct device *dev, struct device_attribute *devattr,
 	return count;
 }
 
+static ssize_t
+predict_stat_show(struct device *dev, struct device_attribute *devattr,
+		       char *buf)
+{
+	struct platform_device *pdev = to_platform_device(dev);
+	struct exynos_tmu_data *data = platform_get_drvdata(pdev);
+	struct exynos_tmu_predict *pr = data->predict;
+	u64 avg_cap;
+	int len;
+
+	if (!pr)
+		return -ENODEV;
+
+	mutex_lock(&data->lock);
+
+	exynos_tmu_predict_account(pr, ktime_get());
+	avg_cap = pr->cap_time ? div64_u64(pr->cap_sum, pr->cap_time) : pr->max_freq;
+
+	len = snprintf(buf, PAGE_SIZE,
+		"cap: %u\nslope: %d\npredicted: %d\nthrottling: %d\n"
+		"episodes: %u\navoided: %u\nmissed: %u\n"
+		"throttle_time_ms: %llu\navg_cap: %llu\n",
+		pr->cap, pr->slope, pr->predicted, pr->throttling,
+		pr->episodes, pr->avoided, pr->missed,
+		pr->cap_time, avg_cap);
+
+	mutex_unlock(&data->lock);
+
+	return len;
+}
+
+static DEVICE_ATTR(predict_stat, S_IRUGO, predict_stat_show, NULL);
+
 static DEVICE_ATTR(balance_offset, S_IWUSR | S_IRUGO, balance_offset_show,
 		balance_offset_store);
 
@@ -1529,6 +1753,7 @@ static struct attribute *exynos_tmu_attrs[] = {
 	&dev_attr_all_temp.attr,
 	&dev_attr_hotplug_out_temp.attr,
 	&dev_attr_hotplug_in_temp.attr,
+	&dev_attr_predict_stat.attr,
 	NULL,
 };
 
@@ -1761,6 +1986,8 @@ static int exynos_tmu_probe(struct platform_device *pdev)
 	if (ret)
 		goto err_sensor;
 
+	exynos_tmu_predict_init(pdev);
+
 	/* Regist high priorty workqueue */
 	if (!thermal_irq_wq) {
 		attr.nice = 0;
@@ -2040,6 +2267,47 @@ static int log_print_set(void *data, unsigned long long val)
 }
 DEFINE_SIMPLE_ATTRIBUTE(log_print_fops, NULL, log_print_set, "%llu\n");
 
+static int temp_cache_us_get(void *data, unsigned long long *val)
+{
+	*val = exynos_acpm_tmu_get_cache_time();
+
+	return 0;
+}
+
+static int temp_cache_us_set(void *data, unsigned long long val)
+{
+	if (val > USEC_PER_SEC)
+		return -EINVAL;
+
+	exynos_acpm_tmu_set_cache_time(val);
+
+	return 0;
+}
+DEFINE_SIMPLE_ATTRIBUTE(temp_cache_us_fops, temp_cache_us_get, temp_cache_us_set, "%llu\n");
+
+static ssize_t ipc_stats_read(struct file *file, char __user *user_buf,
+					size_t count, loff_t *ppos)
+{
+	unsigned long long sent, saved;
+	char buf[64];
+	ssize_t ret;
+
+	exynos_acpm_tmu_get_ipc_stats(&sent, &saved);
+
+	ret = snprintf(buf, sizeof(buf), "read_temp ipc %llu saved %llu\n",
+			sent, saved);
+	if (ret < 0)
+		return ret;
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, ret);
+}
+
+static const struct file_operations ipc_stats_fops = {
+	.open = simple_open,
+	.read = ipc_stats_read,
+	.llseek = default_llseek,
+};
+
 static ssize_t ipc_dump1_read(struct file *file, char __user *user_buf,
 					size_t count, loff_t *ppos)
 {
@@ -2112,6 +2380,8 @@ static int exynos_thermal_create_debugfs(void)
 	debugfs_create_file("log_print", 0644, debugfs_root, NULL, &log_print_fops);
 	debugfs_create_file("ipc_dump1", 0644, debugfs_root, NULL, &ipc_dump1_fops);
 	debugfs_create_file("ipc_dump2", 0644, debugfs_root, NULL, &ipc_dump2_fops);
+	debugfs_create_file("temp_cache_us", 0644, debugfs_root, NULL, &temp_cache_us_fops);
+	debugfs_create_file("ipc_stats", 0444, debugfs_root, NULL, &ipc_stats_fops);
 #endif
 	return 0;
 }
@@ -23,6 +23,8 @@
 #ifndef _EXYNOS_TMU_H
 #define _EXYNOS_TMU_H
 #include <linux/cpu_cooling.h>
+#include <linux/ktime.h>
+#include <linux/pm_qos.h>
 #include <linux/gpu_cooling.h>
 #include <linux/isp_cooling.h>
 #include <dt-bindings/thermal/thermal_exynos.h>
@@ -92,6 +94,46 @@ struct sensor_info {
 	u16 temp_error2;
 };
 
+/*
+ * Predictive throttling. The temperature trend is extrapolated from the
+ * recent samples, and the frequency cap of pm_qos_class is lowered step by
+ * step before the first trip is reached.
+ */
+#define TMU_PREDICT_WINDOW	8
+
+struct exynos_tmu_predict {
+	/* recent samples */
+	ktime_t time[TMU_PREDICT_WINDOW];
+	int temp[TMU_PREDICT_WINDOW];
+	int head;
+	int count;
+
+	/* configuration */
+	unsigned int horizon_ms;
+	int margin;
+	int hysteresis;
+	int pm_qos_class;
+	unsigned int max_freq;
+	unsigned int min_freq;
+	unsigned int step_freq;
+
+	/* control state */
+	struct pm_qos_request qos_req;
+	unsigned int cap;
+	int slope;
+	int predicted;
+	bool throttling;
+	bool tripped;
+
+	/* statistics */
+	unsigned int episodes;
+	unsigned int avoided;
+	unsigned int missed;
+	u64 cap_sum;
+	u64 cap_time;
+	ktime_t last_update;
+};
+
 /**
  * struct exynos_tmu_data : A structure to hold the private data of the TMU
 	driver
@@ -145,6 +187,7 @@ struct exynos_tmu_data {
 	struct device_node *np;
 	int balance_offset;
 	struct mutex hotplug_lock;
+	struct exynos_tmu_predict *predict;
 
 	int (*tmu_initialize)(struct platform_device *pdev);
 	void (*tmu_control)(struct platform_device *pdev, bool on);
@@ -30,6 +30,8 @@
 #include <linux/of_platform.h>
 #include <linux/regulator/consumer.h>
 #include <linux/workqueue.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 
 #include <linux/io.h>
 #include <linux/usb/otg-fsm.h>
@@ -45,6 +47,48 @@ struct dwc3_exynos_rsw {
 	struct work_struct	work;
 };
 
+/*
+ * Low power states of runtime suspend.
+ * LIGHT keeps the clocks running, so that resume only has to tell IDLE_IP.
+ * It is chosen when recent idle periods were short, and it is demoted to
+ * DEEP (clocks off) when no resume comes within hold_ms.
+ */
+enum dwc3_exynos_lpm_state {
+	DWC3_LPM_ACTIVE,
+	DWC3_LPM_LIGHT,
+	DWC3_LPM_DEEP,
+	DWC3_LPM_MAX,
+};
+
+static const char *dwc3_lpm_state_name[DWC3_LPM_MAX] = {
+	"active", "light", "deep",
+};
+
+struct dwc3_exynos_lpm_stat {
+	u64			entries;
+	u64			residency_us;
+	u64			resume_ns;
+	u64			resume_max_ns;
+};
+
+struct dwc3_exynos_lpm {
+	struct mutex		lock;
+	struct delayed_work	demote_work;
+	enum dwc3_exynos_lpm_state state;
+	ktime_t			state_time;
+	ktime_t			suspend_time;
+
+	/* idle predictor, average of recent idle periods */
+	u64			avg_idle_us;
+	unsigned int		light_idle_us;
+	unsigned int		hold_ms;
+
+	struct dwc3_exynos_lpm_stat stat[DWC3_LPM_MAX];
+};
+
+#define DWC3_LPM_LIGHT_IDLE_US	(200 * USEC_PER_MSEC)
+#define DWC3_LPM_HOLD_MS	500
+
 struct dwc3_exynos {
 	struct platform_device	*usb2_phy;
 	struct platform_device	*usb3_phy;
@@ -58,6 +102,7 @@ struct dwc3_exynos {
 	int			idle_ip_index;
 
 	struct dwc3_exynos_rsw	rsw;
+	struct dwc3_exynos_lpm	lpm;
 };
 
 void dwc3_otg_run_sm(struct otg_fsm *fsm);
@@ -402,6 +447,168 @@ static int dwc3_exynos_remove_child(struct device *dev, void *unused)
 	return 0;
 }
 
+/* -------------------------------------------------------------------------- */
+
+/* lpm->lock must be held */
+static void dwc3_exynos_lpm_enter(struct dwc3_exynos_lpm *lpm,
+				enum dwc3_exynos_lpm_state state)
+{
+	ktime_t now = ktime_get();
+
+	lpm->stat[lpm->state].residency_us +=
+		ktime_us_delta(now, lpm->state_time);
+	lpm->stat[state].entries++;
+	lpm->state = state;
+	lpm->state_time = now;
+}
+
+/* Turns the clocks off if they were kept for LIGHT */
+static void dwc3_exynos_lpm_demote(struct dwc3_exynos *exynos)
+{
+	struct dwc3_exynos_lpm *lpm = &exynos->lpm;
+
+	mutex_lock(&lpm->lock);
+	if (lpm->state == DWC3_LPM_LIGHT) {
+		dwc3_exynos_clk_disable(exynos);
+		dwc3_exynos_lpm_enter(lpm, DWC3_LPM_DEEP);
+	}
+	mutex_unlock(&lpm->lock);
+}
+
+static void dwc3_exynos_lpm_demote_work(struct work_struct *w)
+{
+	struct dwc3_exynos_lpm	*lpm = container_of(to_delayed_work(w),
+					struct dwc3_exynos_lpm, demote_work);
+	struct dwc3_exynos	*exynos = container_of(lpm,
+					struct dwc3_exynos, lpm);
+
+	dwc3_exynos_lpm_demote(exynos);
+}
+
+static ssize_t
+dwc3_exynos_lpm_stats_show(struct device *dev,
+			   struct device_attribute *attr, char *buf)
+{
+	struct dwc3_exynos *exynos = dev_get_drvdata(dev);
+	struct dwc3_exynos_lpm *lpm = &exynos->lpm;
+	struct dwc3_exynos_lpm_stat *stat;
+	ssize_t count = 0;
+	u64 residency;
+	int i;
+
+	mutex_lock(&lpm->lock);
+
+	count += snprintf(buf + count, PAGE_SIZE - count,
+			"state: %s avg_idle: %llu us\n",
+			dwc3_lpm_state_name[lpm->state], lpm->avg_idle_us);
+	count += snprintf(buf + count, PAGE_SIZE - count,
+			"%-8s %10s %16s %14s %14s\n", "state", "entries",
+			"residency(us)", "avg_resume(ns)", "max_resume(ns)");
+
+	for (i = 0; i < DWC3_LPM_MAX; i++) {
+		stat = &lpm->stat[i];
+		residency = stat->residency_us;
+		if (i == lpm->state)
+			residency += ktime_us_delta(ktime_get(), lpm->state_time);
+
+		count += snprintf(buf + count, PAGE_SIZE - count,
+				"%-8s %10llu %16llu %14llu %14llu\n",
+				dwc3_lpm_state_name[i], stat->entries, residency,
+				stat->entries ?
+				div64_u64(stat->resume_ns, stat->entries) : 0,
+				stat->resume_max_ns);
+	}
+
+	mutex_unlock(&lpm->lock);
+
+	return count;
+}
+static DEVICE_ATTR(lpm_stats, 0444, dwc3_exynos_lpm_stats_show, NULL);
+
+static ssize_t
+dwc3_exynos_lpm_light_idle_us_show(struct device *dev,
+				   struct device_attribute *attr, char *buf)
+{
+	struct dwc3_exynos *exynos = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n", exynos->lpm.light_idle_us);
+}
+
+static ssize_t
+dwc3_exynos_lpm_light_idle_us_store(struct device *dev,
+				    struct device_attribute *attr,
+				    const char *buf, size_t n)
+{
+	struct dwc3_exynos *exynos = dev_get_drvdata(dev);
+	unsigned int val;
+
+	if (kstrtouint(buf, 0, &val))
+		return -EINVAL;
+
+	exynos->lpm.light_idle_us = val;
+
+	return n;
+}
+static DEVICE_ATTR(lpm_light_idle_us, 0644, dwc3_exynos_lpm_light_idle_us_show,
+		dwc3_exynos_lpm_light_idle_us_store);
+
+static ssize_t
+dwc3_exynos_lpm_hold_ms_show(struct device *dev,
+			     struct device_attribute *attr, char *buf)
+{
+	struct dwc3_exynos *exynos = dev_get_drvdata(dev);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n", exynos->lpm.hold_ms);
+}
+
+static ssize_t
+dwc3_exynos_lpm_hold_ms_store(struct device *dev,
+			      struct device_attribute *attr,
+			      const char *buf, size_t n)
+{
+	struct dwc3_exynos *exynos = dev_get_drvdata(dev);
+	unsigned int val;
+
+	if (kstrtouint(buf, 0, &val))
+		return -EINVAL;
+
+	exynos->lpm.hold_ms = val;
+
+	return n;
+}
+static DEVICE_ATTR(lpm_hold_ms, 0644, dwc3_exynos_lpm_hold_ms_show,
+		dwc3_exynos_lpm_hold_ms_store);
+
+static struct attribute *dwc3_exynos_lpm_attrs[] = {
+	&dev_attr_lpm_stats.attr,
+	&dev_attr_lpm_light_idle_us.attr,
+	&dev_attr_lpm_hold_ms.attr,
+	NULL,
+};
+
+static const struct attribute_group dwc3_exynos_lpm_group = {
+	.attrs = dwc3_exynos_lpm_attrs,
+};
+
+static void dwc3_exynos_lpm_init(struct dwc3_exynos *exynos)
+{
+	struct dwc3_exynos_lpm *lpm = &exynos->lpm;
+	struct device_node *node = exynos->dev->of_node;
+
+	mutex_init(&lpm->lock);
+	INIT_DELAYED_WORK(&lpm->demote_work, dwc3_exynos_lpm_demote_work);
+
+	lpm->light_idle_us = DWC3_LPM_LIGHT_IDLE_US;
+	lpm->hold_ms = DWC3_LPM_HOLD_MS;
+	of_property_read_u32(node, "lpm-light-idle-us", &lpm->light_idle_us);
+	of_property_read_u32(node, "lpm-hold-ms", &lpm->hold_ms);
+
+	/* no history yet, predict a long idle */
+	lpm->avg_idle_us = U64_MAX >> 2;
+	lpm->state = DWC3_LPM_ACTIVE;
+	lpm->state_time = ktime_get();
+}
+
 static int dwc3_exynos_probe(struct platform_device *pdev)
 {
 	struct dwc3_exynos	*exynos;
@@ -430,6 +637,8 @@ static int dwc3_exynos_probe(struct platform_device *pdev)
 	exynos_update_ip_idle_status(exynos->idle_ip_index, 0);
 #endif
 
+	dwc3_exynos_lpm_init(exynos);
+
 	ret = dwc3_exynos_clk_get(exynos);
 	if (ret)
 		return ret;
@@ -479,6 +688,10 @@ static int dwc3_exynos_probe(struct platform_device *pdev)
 		goto phys_err;
 	}
 
+	ret = devm_device_add_group(dev, &dwc3_exynos_lpm_group);
+	if (ret)
+		dev_err(dev, "failed to create lpm sysfs\n");
+
 	if (node) {
 		ret = of_platform_populate(node, NULL, NULL, dev);
 		if (ret) {
@@ -520,6 +733,8 @@ static int dwc3_exynos_remove(struct platform_device *pdev)
 	platform_device_unregister(exynos->usb3_phy);
 
 	pm_runtime_disable(&pdev->dev);
+	cancel_delayed_work_sync(&exynos->lpm.demote_work);
+	dwc3_exynos_lpm_demote(exynos);
 	if (!pm_runtime_status_suspended(&pdev->dev)) {
 		dwc3_exynos_clk_disable(exynos);
 		pm_runtime_set_suspended(&pdev->dev);
@@ -539,10 +754,24 @@ static int dwc3_exynos_remove(struct platform_device *pdev)
 static int dwc3_exynos_runtime_suspend(struct device *dev)
 {
 	struct dwc3_exynos *exynos = dev_get_drvdata(dev);
+	struct dwc3_exynos_lpm *lpm = &exynos->lpm;
+	bool light;
 
 	dev_info(dev, "%s\n", __func__);
 
-	dwc3_exynos_clk_disable(exynos);
+	mutex_lock(&lpm->lock);
+	lpm->suspend_time = ktime_get();
+	light = lpm->hold_ms && lpm->avg_idle_us < lpm->light_idle_us;
+	if (light) {
+		/* traffic is expected soon, keep the clocks for a fast resume */
+		dwc3_exynos_lpm_enter(lpm, DWC3_LPM_LIGHT);
+		schedule_delayed_work(&lpm->demote_work,
+				msecs_to_jiffies(lpm->hold_ms));
+	} else {
+		dwc3_exynos_clk_disable(exynos);
+		dwc3_exynos_lpm_enter(lpm, DWC3_LPM_DEEP);
+	}
+	mutex_unlock(&lpm->lock);
 
 #ifdef CONFIG_ARM64_EXYNOS_CPUIDLE
 	/* inform what USB state is idle to IDLE_IP */
@@ -555,21 +784,46 @@ static int dwc3_exynos_runtime_suspend(struct device *dev)
 static int dwc3_exynos_runtime_resume(struct device *dev)
 {
 	struct dwc3_exynos *exynos = dev_get_drvdata(dev);
+	struct dwc3_exynos_lpm *lpm = &exynos->lpm;
+	struct dwc3_exynos_lpm_stat *stat;
+	ktime_t start = ktime_get();
+	u64 idle_us, ns;
 	int ret = 0;
 
 	dev_info(dev, "%s\n", __func__);
 
+	cancel_delayed_work_sync(&lpm->demote_work);
+
 #ifdef CONFIG_ARM64_EXYNOS_CPUIDLE
 	/* inform what USB state is not idle to IDLE_IP */
 	exynos_update_ip_idle_status(exynos->idle_ip_index, 0);
 #endif
 
-	ret = dwc3_exynos_clk_enable(exynos);
-	if (ret) {
-		dev_err(dev, "%s: clk_enable failed\n", __func__);
-		return ret;
+	mutex_lock(&lpm->lock);
+
+	if (lpm->state != DWC3_LPM_LIGHT) {
+		ret = dwc3_exynos_clk_enable(exynos);
+		if (ret) {
+			mutex_unlock(&lpm->lock);
+			dev_err(dev, "%s: clk_enable failed\n", __func__);
+			return ret;
+		}
 	}
 
+	/* average of recent idle periods, 1/4 weight of the last one */
+	idle_us = ktime_us_delta(start, lpm->suspend_time);
+	lpm->avg_idle_us = (lpm->avg_idle_us * 3 + idle_us) >> 2;
+
+	stat = &lpm->stat[lpm->state];
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	stat->resume_ns += ns;
+	if (ns > stat->resume_max_ns)
+		stat->resume_max_ns = ns;
+
+	dwc3_exynos_lpm_enter(lpm, DWC3_LPM_ACTIVE);
+
+	mutex_unlock(&lpm->lock);
+
 	return 0;
 }
 #endif
@@ -581,8 +835,12 @@ static int dwc3_exynos_suspend(struct device *dev)
 
 	dev_dbg(dev, "%s\n", __func__);
 
-	if (pm_runtime_suspended(dev))
+	if (pm_runtime_suspended(dev)) {
+		/* clocks kept for a light runtime suspend are not wanted */
+		cancel_delayed_work_sync(&exynos->lpm.demote_work);
+		dwc3_exynos_lpm_demote(exynos);
 		return 0;
+	}
 
 	dwc3_exynos_clk_disable(exynos);
 
@@ -630,6 +888,11 @@ static int dwc3_exynos_resume(struct device *dev)
 		return ret;
 	}
 
+	mutex_lock(&exynos->lpm.lock);
+	if (exynos->lpm.state != DWC3_LPM_ACTIVE)
+		dwc3_exynos_lpm_enter(&exynos->lpm, DWC3_LPM_ACTIVE);
+	mutex_unlock(&exynos->lpm.lock);
+
 	/* runtime set active to reflect active state. */
 	pm_runtime_disable(dev);
 	pm_runtime_set_active(dev);
@@ -54,6 +54,8 @@
 #include <linux/file.h>
 #include <linux/configfs.h>
 #include <linux/sched/signal.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 #include "f_mtp.h"
 #include "configfs.h"
 
@@ -96,6 +98,13 @@
 /*-------------------------------------------------------------------------*/
 
 #define MTPG_BULK_BUFFER_SIZE	32768
+/*
+ * Larger bulk requests for super speed, so that each completion moves more
+ * data and vfs_read of the next request overlaps the queued transfers.
+ * Falls back to MTPG_BULK_BUFFER_SIZE if the buffers can't be allocated.
+ */
+#define MTPG_BULK_BUFFER_SIZE_SS	(256 * 1024)
+#define MTPG_SS_REQ_MAX		4
 #define MTPG_INTR_BUFFER_SIZE	28
 
 /* number of rx and tx requests to allocate */
@@ -170,6 +179,12 @@ struct mtpg_dev {
 	atomic_t		wintfd_excl;
 	char cancel_io_buf[USB_PTPREQUEST_CANCELIO_SIZE+1];
 	int cancel_io;
+
+	unsigned int		bulk_buf_len;
+	u64			tx_bytes;
+	u64			rx_bytes;
+	int64_t			send_bytes;
+	u64			send_us;
 };
 
 /* Global mtpg_dev Structure
@@ -667,7 +682,7 @@ static ssize_t mtpg_read(struct file *fp, char __user *buf,
 		DEBUG_MTPR("[%s]\t%d: get request\n", __func__, __LINE__);
 		while ((req = mtpg_req_get(dev, &dev->rx_idle))) {
 requeue_req:
-			req->length = MTPG_BULK_BUFFER_SIZE;
+			req->length = dev->bulk_buf_len;
 			DEBUG_MTPR("[%s]\t%d:usb-ep-queue\n",
 						__func__, __LINE__);
 			ret = usb_ep_queue(dev->bulk_out, req, GFP_ATOMIC);
@@ -809,8 +824,8 @@ static ssize_t mtpg_write(struct file *fp, const char __user *buf,
 		}
 
 		if (req != 0) {
-			if (count > MTPG_BULK_BUFFER_SIZE)
-				xfer = MTPG_BULK_BUFFER_SIZE;
+			if (count > dev->bulk_buf_len)
+				xfer = dev->bulk_buf_len;
 			else
 				xfer = count;
 
@@ -921,6 +936,8 @@ static void read_send_work(struct work_struct *work)
 	int64_t hdr_length = 0;
 	int r = 0;
 	int ZLP_flag = 0;
+	int64_t total;
+	ktime_t start;
 
 	/* read our parameters */
 	smp_rmb();
@@ -928,6 +945,8 @@ static void read_send_work(struct work_struct *work)
 	count = dev->read_send_length;
 	hdr_length = sizeof(struct usb_container_header);
 	count += hdr_length;
+	total = count;
+	start = ktime_get();
 
 	printk(KERN_DEBUG "[%s:%d] offset=[%lld]\t leth+hder=[%lld]\n",
 					 __func__, __LINE__, file_pos, count);
@@ -968,8 +987,8 @@ static void read_send_work(struct work_struct *work)
 			break;
 		}
 
-		if (count > MTPG_BULK_BUFFER_SIZE)
-			xfer = MTPG_BULK_BUFFER_SIZE;
+		if (count > dev->bulk_buf_len)
+			xfer = dev->bulk_buf_len;
 		else
 			xfer = count;
 
@@ -1012,6 +1031,8 @@ static void read_send_work(struct work_struct *work)
 
 	DEBUG_MTPB("[%s] \tline = [%d] \t r = [%d]\n", __func__, __LINE__, r);
 
+	dev->send_bytes = total - count;
+	dev->send_us = ktime_us_delta(ktime_get(), start);
 	dev->read_send_result = r;
 	smp_wmb();
 }
@@ -1345,6 +1366,8 @@ static void mtpg_complete_in(struct usb_ep *ep, struct usb_request *req)
 
 	if (req->status != 0)
 		dev->error = 1;
+	else
+		dev->tx_bytes += req->actual;
 
 	mtpg_req_put(dev, &dev->tx_idle, req);
 	wake_up(&dev->write_wq);
@@ -1364,6 +1387,7 @@ static void mtpg_complete_out(struct usb_ep *ep, struct usb_request *req)
 		mtpg_req_put(dev, &dev->rx_idle, req);
 	} else {
 		DEBUG_MTPB("[%s]\t%d for rx_done\n", __func__, __LINE__);
+		dev->rx_bytes += req->actual;
 		mtpg_req_put(dev, &dev->rx_done, req);
 	}
 	wake_up(&dev->read_wq);
@@ -1383,6 +1407,67 @@ static void mtpg_complete_intr(struct usb_ep *ep, struct usb_request *req)
 }
 static DEVICE_ATTR(guid,  S_IRUGO | S_IWUSR,
 		guid_show, guid_store);
+
+static ssize_t throughput_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct mtpg_dev *mtpg = the_mtpg;
+	u64 kbps = 0;
+
+	if (!mtpg)
+		return -ENODEV;
+
+	if (mtpg->send_us)
+		kbps = div64_u64((u64)mtpg->send_bytes * USEC_PER_SEC,
+				mtpg->send_us) >> 10;
+
+	return snprintf(buf, PAGE_SIZE,
+			"bulk_buf_len: %u\ntx_bytes: %llu\nrx_bytes: %llu\n"
+			"last_send: %lld bytes %llu us %llu KB/s\n",
+			mtpg->bulk_buf_len, mtpg->tx_bytes, mtpg->rx_bytes,
+			mtpg->send_bytes, mtpg->send_us, kbps);
+}
+static DEVICE_ATTR(throughput, S_IRUGO, throughput_show, NULL);
+
+static void mtpg_free_bulk_reqs(struct mtpg_dev *dev)
+{
+	struct usb_request *req;
+
+	while ((req = mtpg_req_get(dev, &dev->rx_idle)))
+		mtpg_request_free(req, dev->bulk_out);
+
+	while ((req = mtpg_req_get(dev, &dev->tx_idle)))
+		mtpg_request_free(req, dev->bulk_in);
+}
+
+static int mtpg_alloc_bulk_reqs(struct mtpg_dev *dev, int buffer_size,
+				int rx_max, int tx_max)
+{
+	struct usb_request *req;
+	int i;
+
+	for (i = 0; i < rx_max; i++) {
+		req = mtpg_request_new(dev->bulk_out, buffer_size);
+		if (!req)
+			goto fail;
+		req->complete = mtpg_complete_out;
+		mtpg_req_put(dev, &dev->rx_idle, req);
+	}
+
+	for (i = 0; i < tx_max; i++) {
+		req = mtpg_request_new(dev->bulk_in, buffer_size);
+		if (!req)
+			goto fail;
+		req->complete = mtpg_complete_in;
+		mtpg_req_put(dev, &dev->tx_idle, req);
+	}
+
+	dev->bulk_buf_len = buffer_size;
+	return 0;
+fail:
+	mtpg_free_bulk_reqs(dev);
+	return -ENOMEM;
+}
 static void
 mtpg_function_unbind(struct usb_configuration *c, struct usb_function *f)
 {
@@ -1392,11 +1477,7 @@ mtpg_function_unbind(struct usb_configuration *c, struct usb_function *f)
 	printk(KERN_DEBUG "[%s]\tline = [%d]\n", __func__, __LINE__);
 
 	strings_dev_mtp[F_MTP_IDX].id = 0;
-	while ((req = mtpg_req_get(dev, &dev->rx_idle)))
-		mtpg_request_free(req, dev->bulk_out);
-
-	while ((req = mtpg_req_get(dev, &dev->tx_idle)))
-		mtpg_request_free(req, dev->bulk_in);
+	mtpg_free_bulk_reqs(dev);
 
 	while ((req = mtpg_req_get(dev, &dev->intr_idle)))
 		mtpg_request_free(req, dev->int_in);
@@ -1470,21 +1551,15 @@ mtpg_function_bind(struct usb_configuration *c, struct usb_function *f)
 		req->complete = mtpg_complete_intr;
 		mtpg_req_put(mtpg, &mtpg->intr_idle, req);
 	}
-	for (i = 0; i < MTPG_RX_REQ_MAX; i++) {
-		req = mtpg_request_new(mtpg->bulk_out, MTPG_BULK_BUFFER_SIZE);
-		if (!req)
-			goto out;
-		req->complete = mtpg_complete_out;
-		mtpg_req_put(mtpg, &mtpg->rx_idle, req);
-	}
 
-	for (i = 0; i < MTPG_MTPG_TX_REQ_MAX; i++) {
-		req = mtpg_request_new(mtpg->bulk_in, MTPG_BULK_BUFFER_SIZE);
-		if (!req)
-			goto out;
-		req->complete = mtpg_complete_in;
-		mtpg_req_put(mtpg, &mtpg->tx_idle, req);
-	}
+	status = -ENOMEM;
+	if (gadget_is_superspeed(cdev->gadget))
+		status = mtpg_alloc_bulk_reqs(mtpg, MTPG_BULK_BUFFER_SIZE_SS,
+					MTPG_SS_REQ_MAX, MTPG_SS_REQ_MAX);
+	if (status && mtpg_alloc_bulk_reqs(mtpg, MTPG_BULK_BUFFER_SIZE,
+					MTPG_RX_REQ_MAX, MTPG_MTPG_TX_REQ_MAX))
+		goto out;
+	status = 0;
 
 	if (gadget_is_dualspeed(cdev->gadget)) {
 
@@ -1904,6 +1979,11 @@ static int mtp_setup(struct mtp_instance *fi_mtp)
 	} else
 		printk(KERN_DEBUG "mtp: %s success to create guid attr\n",
 				__func__);
+
+	err = device_create_file(mtpg_device.this_device, &dev_attr_throughput);
+	if (err)
+		printk(KERN_DEBUG "mtp: %s failed to create throughput attr\n",
+				__func__);
 	return 0;
 err_work:
 err_misc_register:
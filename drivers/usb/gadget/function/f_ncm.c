@@ -21,6 +21,8 @@
 #include <linux/device.h>
 #include <linux/etherdevice.h>
 #include <linux/crc32.h>
+#include <linux/hrtimer.h>
+#include <linux/math64.h>
 
 #include <linux/usb/cdc.h>
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
@@ -74,6 +76,19 @@ struct f_ncm {
 	 * callback and ethernet open/close
 	 */
 	spinlock_t			lock;
+
+	/* For multi-frame NDP TX */
+	struct net_device		*netdev;
+	struct sk_buff			*skb_tx_data;
+	struct sk_buff			*skb_tx_ndp;
+	u16				ndp_dgram_count;
+	bool				timer_force_tx;
+	bool				timer_stopping;
+	unsigned			tx_timeout_ns;
+	struct tasklet_struct		tx_tasklet;
+	struct hrtimer			task_timer;
+
+	struct ncm_ntb_stats		*stats;
 };
 
 static inline struct f_ncm *func_to_ncm(struct usb_function *f)
@@ -95,13 +110,12 @@ static inline unsigned ncm_bitrate(struct usb_gadget *g)
 /*-------------------------------------------------------------------------*/
 
 /*
- * We cannot group frames so use just the minimal size which ok to put
- * one max-size ethernet frame.
- * If the host can group frames, allow it to do that, 16K is selected,
- * because it's used by default by the current linux host driver
+ * Frames are grouped into one NTB in both directions, so that a large NTB
+ * is offered to the host. 32K is the default rx size of the current linux
+ * host driver, the host may set a smaller IN size by SET_NTB_INPUT_SIZE.
  */
+#define NTB_DEFAULT_IN_SIZE	32768
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-#define NTB_DEFAULT_IN_SIZE	16384
 #define NCM_MAX_DGRAM_SIZE	9014
 #define MAX_NDP_DATAGRAMS	1
 #define NTH_NDP_OUT_TOTAL_SIZE	\
@@ -109,10 +123,19 @@ static inline unsigned ncm_bitrate(struct usb_gadget *g)
 		ntb_parameters.wNdpOutAlignment) +	\
 		sizeof(struct usb_cdc_ncm_ndp16) +	\
 		((MAX_NDP_DATAGRAMS)*sizeof(struct usb_cdc_ncm_dpe16)))
-#else
-#define NTB_DEFAULT_IN_SIZE	USB_CDC_NCM_NTB_MIN_IN_SIZE
 #endif
-#define NTB_OUT_SIZE		16384
+#define NTB_OUT_SIZE		32768
+
+/*
+ * Datagrams are held in the NTB being built until it is full or the tx
+ * timer expires. The timeout follows the load: it is doubled whenever an NTB
+ * is sent full, and halved whenever the timer sends an NTB of at most
+ * TX_LIGHT_NUM_DPE datagrams, so that light traffic is not delayed.
+ */
+#define TX_MAX_NUM_DPE		64
+#define TX_LIGHT_NUM_DPE	2
+#define TX_TIMEOUT_MIN_NSECS	50000
+#define TX_TIMEOUT_MAX_NSECS	400000
 
 /*
  * skbs of size less than that will not be aligned
@@ -558,6 +581,7 @@ static inline void ncm_reset_values(struct f_ncm *ncm)
 	ncm->port.header_len = 0;
 	ncm->port.fixed_out_len = le32_to_cpu(ntb_parameters.dwNtbOutMaxSize);
 	ncm->port.fixed_in_len = NTB_DEFAULT_IN_SIZE;
+	ncm->tx_timeout_ns = TX_TIMEOUT_MIN_NSECS;
 
 	/* ncm->ndp_sign must be initialized  */
 	ncm->ndp_sign = ncm->parser_opts->ndp_sign;
@@ -961,6 +985,8 @@ invalid:
 }
 
 
+static void ncm_tx_purge(struct f_ncm *ncm);
+
 static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 {
 	struct f_ncm		*ncm = func_to_ncm(f);
@@ -994,6 +1020,7 @@ static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 		if (ncm->port.in_ep->driver_data) {
 			DBG(cdev, "reset ncm\n");
 			gether_disconnect(&ncm->port);
+			ncm_tx_purge(ncm);
 			ncm_reset_values(ncm);
 		}
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
@@ -1030,6 +1057,7 @@ static int ncm_set_alt(struct usb_function *f, unsigned intf, unsigned alt)
 			net = gether_connect(&ncm->port);
 			if (IS_ERR(net))
 				return PTR_ERR(net);
+			ncm->netdev = net;
 #ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
 			ncm->net = net;
 			ncm->net->mtu = ncm->dgramsize - ETH_HLEN;
@@ -1067,131 +1095,287 @@ static int ncm_get_alt(struct usb_function *f, unsigned intf)
 		return 0;
 	return ncm->port.in_ep->driver_data ? 1 : 0;
 }
+/*
+ * Closes the NTB being built and returns it.
+ * The NDP is placed after the datagrams.
+ */
+static struct sk_buff *package_for_tx(struct f_ncm *ncm)
+{
+	__le16		*ntb_iter;
+	struct sk_buff	*skb2 = NULL;
+	unsigned	ndp_pad;
+	unsigned	ndp_index;
+	unsigned	new_len;
+	unsigned	max_size = ncm->port.fixed_in_len;
+	int		pad = 0;
+
+	const struct ndp_parser_opts *opts = ncm->parser_opts;
+	const int ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
+	const int dgram_idx_len = 2 * 2 * opts->dgram_item_len;
+
+	/* Stop the timer */
+	hrtimer_try_to_cancel(&ncm->task_timer);
+
+	ndp_pad = ALIGN(ncm->skb_tx_data->len, ndp_align) -
+			ncm->skb_tx_data->len;
+	ndp_index = ncm->skb_tx_data->len + ndp_pad;
+	new_len = ndp_index + dgram_idx_len + ncm->skb_tx_ndp->len;
+
+#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
+	/* force short packet */
+	if (new_len < max_size &&
+	    (new_len % le16_to_cpu(ncm->port.in_ep->desc->wMaxPacketSize)) == 0)
+		pad = 1;
+	new_len += pad;
+#else
+	/*
+	 * Incase of a large NTB, expand it to max_size which needs no zlp as
+	 * the transfer is dwNtbInMaxSize.
+	 */
+	if (new_len > MAX_TX_NONFIXED)
+		pad = max_size - new_len;
+#endif
+
+	/* Set the final BlockLength and wNdpIndex */
+	ntb_iter = (void *) ncm->skb_tx_data->data;
+	/* Increment pointer to BlockLength */
+	ntb_iter += 2 + 1 + 1;
+	put_ncm(&ntb_iter, opts->block_length, new_len);
+	put_ncm(&ntb_iter, opts->fp_index, ndp_index);
+
+	/* Set the final NDP wLength */
+	new_len = opts->ndp_size +
+			(ncm->ndp_dgram_count * dgram_idx_len);
+	/* Increment from start to wLength */
+	ntb_iter = (void *) ncm->skb_tx_ndp->data;
+	ntb_iter += 2;
+	put_unaligned_le16(new_len, ntb_iter);
+
+	/* the zeroed entry is not a datagram */
+	ncm->stats->tx_ntbs++;
+	ncm->stats->tx_dgrams += ncm->ndp_dgram_count - 1;
+	ncm->ndp_dgram_count = 0;
+
+	/* Merge the skbs */
+	swap(skb2, ncm->skb_tx_data);
+
+	/* Insert NDP alignment. */
+	skb_put_zero(skb2, ndp_pad);
+
+	/* Copy NTB across. */
+	skb_put_data(skb2, ncm->skb_tx_ndp->data, ncm->skb_tx_ndp->len);
+	dev_consume_skb_any(ncm->skb_tx_ndp);
+	ncm->skb_tx_ndp = NULL;
+
+	/* Insert zero'd datagram. */
+	skb_put_zero(skb2, dgram_idx_len);
+
+	if (pad)
+		skb_put_zero(skb2, pad);
+
+	return skb2;
+}
+
 static struct sk_buff *ncm_wrap_ntb(struct gether *port,
 				    struct sk_buff *skb)
 {
 	struct f_ncm	*ncm = func_to_ncm(&port->func);
-	struct sk_buff	*skb2;
+	struct sk_buff	*skb2 = NULL;
 	int		ncb_len = 0;
-	__le16		*tmp;
-	int		div;
-	int		rem;
-	int		pad;
-	int		ndp_align;
-	int		ndp_pad;
+	__le16		*ntb_data;
+	__le16		*ntb_ndp;
+	int		dgram_pad;
+
 	unsigned	max_size = ncm->port.fixed_in_len;
 	const struct ndp_parser_opts *opts = ncm->parser_opts;
-	unsigned	crc_len = ncm->is_crc ? sizeof(uint32_t) : 0;
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	int		force_shortpkt = 0;
-#endif
-	div = le16_to_cpu(ntb_parameters.wNdpInDivisor);
-	rem = le16_to_cpu(ntb_parameters.wNdpInPayloadRemainder);
-	ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
-
-	ncb_len += opts->nth_size;
-	ndp_pad = ALIGN(ncb_len, ndp_align) - ncb_len;
-	ncb_len += ndp_pad;
-	ncb_len += opts->ndp_size;
-	ncb_len += 2 * 2 * opts->dgram_item_len; /* Datagram entry */
-	ncb_len += 2 * 2 * opts->dgram_item_len; /* Zero datagram entry */
-	pad = ALIGN(ncb_len, div) + rem - ncb_len;
-	ncb_len += pad;
-
-	if (ncb_len + skb->len + crc_len > max_size) {
-		printk(KERN_ERR"usb: %s Dropped skb skblen (%d) \n", __func__, skb->len);
-		dev_kfree_skb_any(skb);
+	const int ndp_align = le16_to_cpu(ntb_parameters.wNdpInAlignment);
+	const int div = le16_to_cpu(ntb_parameters.wNdpInDivisor);
+	const int rem = le16_to_cpu(ntb_parameters.wNdpInPayloadRemainder);
+	const int dgram_idx_len = 2 * 2 * opts->dgram_item_len;
+
+	if (!skb && !ncm->skb_tx_data)
 		return NULL;
+
+	if (skb) {
+		/* Add the CRC if required up front */
+		if (ncm->is_crc) {
+			uint32_t	crc;
+			__le16		*crc_pos;
+
+			crc = ~crc32_le(~0, skb->data, skb->len);
+			crc_pos = skb_put(skb, sizeof(uint32_t));
+			put_unaligned_le32(crc, crc_pos);
+		}
+
+		/*
+		 * If the new skb is too big for the current NCM NTB then
+		 * set the current stored skb to be sent now and clear it
+		 * ready for new data.
+		 * NOTE: Assume maximum align for speed of calculation.
+		 */
+		if (ncm->skb_tx_data
+		    && (ncm->ndp_dgram_count >= TX_MAX_NUM_DPE
+		    || (ncm->skb_tx_data->len +
+		    div + rem + skb->len +
+		    ncm->skb_tx_ndp->len + ndp_align + (2 * dgram_idx_len))
+		    > max_size)) {
+			/* the NTB is full, traffic is heavy */
+			ncm->tx_timeout_ns = min_t(unsigned,
+					ncm->tx_timeout_ns * 2,
+					TX_TIMEOUT_MAX_NSECS);
+			skb2 = package_for_tx(ncm);
+		}
+
+		if (!ncm->skb_tx_data) {
+			ncb_len = opts->nth_size;
+			dgram_pad = ALIGN(ncb_len, div) + rem - ncb_len;
+			ncb_len += dgram_pad;
+
+			if (ncb_len + skb->len + ndp_align + opts->ndp_size +
+			    (2 * dgram_idx_len) > max_size) {
+				printk(KERN_ERR"usb: %s Dropped skb skblen (%d) \n",
+						__func__, skb->len);
+				goto err;
+			}
+
+			/* Create a new skb for the NTH and datagrams. */
+			ncm->skb_tx_data = alloc_skb(max_size, GFP_ATOMIC);
+			if (!ncm->skb_tx_data)
+				goto err;
+
+			ncm->skb_tx_data->dev = ncm->netdev;
+			ntb_data = skb_put_zero(ncm->skb_tx_data, ncb_len);
+			/* dwSignature */
+			put_unaligned_le32(opts->nth_sign, ntb_data);
+			ntb_data += 2;
+			/* wHeaderLength */
+			put_unaligned_le16(opts->nth_size, ntb_data++);
+
+			/* Allocate an skb for storing the NDP */
+			ncm->skb_tx_ndp = alloc_skb((int)(opts->ndp_size
+						    + dgram_idx_len
+						    * TX_MAX_NUM_DPE),
+						    GFP_ATOMIC);
+			if (!ncm->skb_tx_ndp)
+				goto err;
+
+			ncm->skb_tx_ndp->dev = ncm->netdev;
+			ntb_ndp = skb_put_zero(ncm->skb_tx_ndp, opts->ndp_size);
+			/* dwSignature */
+			put_unaligned_le32(ncm->ndp_sign, ntb_ndp);
+			ntb_ndp += 2;
+
+			/* There is always a zeroed entry */
+			ncm->ndp_dgram_count = 1;
+
+			/* Note: we skip opts->next_fp_index */
+		}
+
+		/* Delay the timer. */
+		hrtimer_start(&ncm->task_timer, ktime_set(0, ncm->tx_timeout_ns),
+			      HRTIMER_MODE_REL);
+
+		/* Add the datagram position entries */
+		ntb_ndp = skb_put_zero(ncm->skb_tx_ndp, dgram_idx_len);
+
+		ncb_len = ncm->skb_tx_data->len;
+		dgram_pad = ALIGN(ncb_len, div) + rem - ncb_len;
+		ncb_len += dgram_pad;
+
+		/* (d)wDatagramIndex */
+		put_ncm(&ntb_ndp, opts->dgram_item_len, ncb_len);
+		/* (d)wDatagramLength */
+		put_ncm(&ntb_ndp, opts->dgram_item_len, skb->len);
+		ncm->ndp_dgram_count++;
+
+		/* Add the new data to the skb */
+		skb_put_zero(ncm->skb_tx_data, dgram_pad);
+		skb_put_data(ncm->skb_tx_data, skb->data, skb->len);
+		dev_consume_skb_any(skb);
+		skb = NULL;
+
+	} else if (ncm->skb_tx_data && ncm->timer_force_tx) {
+		/* few datagrams were waiting for the timer, traffic is light */
+		if (ncm->ndp_dgram_count - 1 <= TX_LIGHT_NUM_DPE)
+			ncm->tx_timeout_ns = max_t(unsigned,
+					ncm->tx_timeout_ns / 2,
+					TX_TIMEOUT_MIN_NSECS);
+		ncm->stats->tx_timer_ntbs++;
+		/* If the tx was requested because of a timeout then send */
+		skb2 = package_for_tx(ncm);
 	}
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if ((ncb_len + skb->len + crc_len < max_size) && (((ncb_len + skb->len + crc_len) %
-		le16_to_cpu(ncm->port.in_ep->desc->wMaxPacketSize)) == 0)) {
-		/* force short packet */
-		printk(KERN_ERR "usb: force short packet %d  \n", ncm->port.in_ep->desc->wMaxPacketSize);
-		force_shortpkt = 1;
+
+	return skb2;
+
+err:
+	if (ncm->netdev)
+		ncm->netdev->stats.tx_dropped++;
+
+	if (skb)
+		dev_kfree_skb_any(skb);
+	if (ncm->skb_tx_data) {
+		dev_kfree_skb_any(ncm->skb_tx_data);
+		ncm->skb_tx_data = NULL;
 	}
-#endif
-	skb2 = skb_copy_expand(skb, ncb_len,
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-			       force_shortpkt,
-#else
-			       max_size - skb->len - ncb_len - crc_len,
-#endif
-			       GFP_ATOMIC);
-	dev_kfree_skb_any(skb);
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if (!skb2) {
-		printk(KERN_ERR"usb: %s Dropped skb skblen realloc failed (%d) \n", __func__, skb->len);
-		return NULL;
+	if (ncm->skb_tx_ndp) {
+		dev_kfree_skb_any(ncm->skb_tx_ndp);
+		ncm->skb_tx_ndp = NULL;
 	}
-#else
-	if (!skb2)
-		return NULL;
-#endif
-	skb = skb2;
+	ncm->ndp_dgram_count = 0;
 
-	tmp = (void *) skb_push(skb, ncb_len);
-	memset(tmp, 0, ncb_len);
-
-	put_unaligned_le32(opts->nth_sign, tmp); /* dwSignature */
-	tmp += 2;
-	/* wHeaderLength */
-	put_unaligned_le16(opts->nth_size, tmp++);
-	tmp++; /* skip wSequence */
-#ifdef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	put_ncm(&tmp, opts->block_length, skb->len + force_shortpkt); /* (d)wBlockLength */
-#else
-	put_ncm(&tmp, opts->block_length, skb->len); /* (d)wBlockLength */
-#endif
-	/* (d)wFpIndex */
-	/* the first pointer is right after the NTH + align */
-	put_ncm(&tmp, opts->fp_index, opts->nth_size + ndp_pad);
+	return skb2;
+}
 
-	tmp = (void *)tmp + ndp_pad;
+/*
+ * This transmits the NTB if there are frames waiting.
+ */
+static void ncm_tx_tasklet(unsigned long data)
+{
+	struct f_ncm	*ncm = (void *)data;
 
-	/* NDP */
-	put_unaligned_le32(ncm->ndp_sign, tmp); /* dwSignature */
-	tmp += 2;
-	/* wLength */
-	put_unaligned_le16(ncb_len - opts->nth_size - pad, tmp++);
+	if (ncm->timer_stopping)
+		return;
 
-	tmp += opts->reserved1;
-	tmp += opts->next_fp_index; /* skip reserved (d)wNextFpIndex */
-	tmp += opts->reserved2;
+	/* Only send if data is available. */
+	if (ncm->skb_tx_data && ncm->netdev) {
+		ncm->timer_force_tx = true;
 
-	if (ncm->is_crc) {
-		uint32_t crc;
+		/* u_ether passes a NULL skb to wrap() to flush held frames */
+		ncm->netdev->netdev_ops->ndo_start_xmit(NULL, ncm->netdev);
 
-		crc = ~crc32_le(~0,
-				skb->data + ncb_len,
-				skb->len - ncb_len);
-		put_unaligned_le32(crc, skb->data + skb->len);
-		skb_put(skb, crc_len);
+		ncm->timer_force_tx = false;
 	}
+}
 
-	/* (d)wDatagramIndex[0] */
-	put_ncm(&tmp, opts->dgram_item_len, ncb_len);
-	/* (d)wDatagramLength[0] */
-	put_ncm(&tmp, opts->dgram_item_len, skb->len - ncb_len);
-	/* (d)wDatagramIndex[1] and  (d)wDatagramLength[1] already zeroed */
-
-	/* Incase of Higher MTU size we do not need to expand and zero off the remaining
-	   In packet size to max_size . This saves bandwidth . e.g for 16K In size max mtu is 9k
-	*/
-#ifndef CONFIG_USB_NCM_SUPPORT_MTU_CHANGE
-	if (skb->len > MAX_TX_NONFIXED) {
-		memset(skb_put(skb, max_size - skb->len),
-		       0, max_size - skb->len);
-		printk(KERN_DEBUG"usb:%s Expanding the buffer %d \n", __func__, skb->len);
+/*
+ * The transmit should only be run if no skb data has been sent
+ * for a certain duration.
+ */
+static enum hrtimer_restart ncm_tx_timeout(struct hrtimer *data)
+{
+	struct f_ncm *ncm = container_of(data, struct f_ncm, task_timer);
+
+	tasklet_schedule(&ncm->tx_tasklet);
+	return HRTIMER_NORESTART;
+}
+
+/* Drops the NTB being built, called once the port is disconnected */
+static void ncm_tx_purge(struct f_ncm *ncm)
+{
+	ncm->timer_stopping = true;
+	hrtimer_cancel(&ncm->task_timer);
+	tasklet_kill(&ncm->tx_tasklet);
+	ncm->timer_stopping = false;
+
+	if (ncm->skb_tx_data) {
+		dev_kfree_skb_any(ncm->skb_tx_data);
+		ncm->skb_tx_data = NULL;
 	}
-#else
-	if (force_shortpkt) {
-		memset(skb_put(skb, force_shortpkt),
-		       0, force_shortpkt);
-		printk(KERN_ERR"usb:%s final Expanding the buffer %d \n", __func__, skb->len);
+	if (ncm->skb_tx_ndp) {
+		dev_kfree_skb_any(ncm->skb_tx_ndp);
+		ncm->skb_tx_ndp = NULL;
 	}
-#endif
-	return skb;
+	ncm->ndp_dgram_count = 0;
 }
 
 static int ncm_unwrap_ntb(struct gether *port,
@@ -1321,6 +1505,8 @@ static int ncm_unwrap_ntb(struct gether *port,
 
 	VDBG(port->func.config->cdev,
 	     "Parsed NTB with %d frames\n", dgram_counter);
+	ncm->stats->rx_ntbs++;
+	ncm->stats->rx_dgrams += dgram_counter;
 	return 0;
 err:
 	printk(KERN_DEBUG"usb:%s Dropped %d \n", __func__, skb->len);
@@ -1336,8 +1522,10 @@ static void ncm_disable(struct usb_function *f)
 
 	DBG(cdev, "ncm deactivated\n");
 
-	if (ncm->port.in_ep->driver_data)
+	if (ncm->port.in_ep->driver_data) {
 		gether_disconnect(&ncm->port);
+		ncm_tx_purge(ncm);
+	}
 
 	if (ncm->notify->driver_data) {
 		usb_ep_disable(ncm->notify);
@@ -1748,11 +1936,32 @@ USB_ETHERNET_CONFIGFS_ITEM_ATTR_QMULT(ncm);
 /* f_ncm_opts_ifname */
 USB_ETHERNET_CONFIGFS_ITEM_ATTR_IFNAME(ncm);
 
+static ssize_t ncm_opts_ntb_stats_show(struct config_item *item, char *page)
+{
+	struct f_ncm_opts *opts = to_f_ncm_opts(item);
+	struct ncm_ntb_stats *stats = &opts->stats;
+	u64 tx_avg = 0, rx_avg = 0;
+
+	if (stats->tx_ntbs)
+		tx_avg = div64_u64(stats->tx_dgrams, stats->tx_ntbs);
+	if (stats->rx_ntbs)
+		rx_avg = div64_u64(stats->rx_dgrams, stats->rx_ntbs);
+
+	return sprintf(page, "tx_ntbs %llu tx_dgrams %llu tx_dgrams_per_ntb %llu tx_timer_ntbs %llu\n"
+			"rx_ntbs %llu rx_dgrams %llu rx_dgrams_per_ntb %llu\n",
+			stats->tx_ntbs, stats->tx_dgrams, tx_avg,
+			stats->tx_timer_ntbs,
+			stats->rx_ntbs, stats->rx_dgrams, rx_avg);
+}
+
+CONFIGFS_ATTR_RO(ncm_opts_, ntb_stats);
+
 static struct configfs_attribute *ncm_attrs[] = {
 	&ncm_opts_attr_dev_addr,
 	&ncm_opts_attr_host_addr,
 	&ncm_opts_attr_qmult,
 	&ncm_opts_attr_ifname,
+	&ncm_opts_attr_ntb_stats,
 	NULL,
 };
 
@@ -1821,6 +2030,8 @@ static void ncm_unbind(struct usb_configuration *c, struct usb_function *f)
 #endif
 	DBG(c->cdev, "ncm unbind\n");
 
+	ncm_tx_purge(ncm);
+
 	ncm_string_defs[0].id = 0;
 	usb_free_all_descriptors(f);
 
@@ -1872,6 +2083,11 @@ static struct usb_function *ncm_alloc(struct usb_function_instance *fi)
 	ncm->port.wrap = ncm_wrap_ntb;
 	ncm->port.unwrap = ncm_unwrap_ntb;
 
+	ncm->stats = &opts->stats;
+	hrtimer_init(&ncm->task_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	ncm->task_timer.function = ncm_tx_timeout;
+	tasklet_init(&ncm->tx_tasklet, ncm_tx_tasklet, (unsigned long) ncm);
+
 #ifdef CONFIG_USB_ANDROID_SAMSUNG_COMPOSITE
 	ncm_function_init();
 #endif
@@ -18,10 +18,20 @@
 
 #include <linux/usb/composite.h>
 
+/* NTB aggregation statistics, see ntb_stats in configfs */
+struct ncm_ntb_stats {
+	u64				tx_ntbs;
+	u64				tx_dgrams;
+	u64				tx_timer_ntbs;
+	u64				rx_ntbs;
+	u64				rx_dgrams;
+};
+
 struct f_ncm_opts {
 	struct usb_function_instance	func_inst;
 	struct net_device		*net;
 	bool				bound;
+	struct ncm_ntb_stats		stats;
 
 	/*
 	 * Read/write access to configfs attributes is handled by configfs.
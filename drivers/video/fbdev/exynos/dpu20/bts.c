@@ -164,16 +164,34 @@ static void dpu_bts_share_bw_info(int id)
 	}
 }
 
+/* Sends bandwidth to BTS only if it's different from the last request */
+static void dpu_bts_request_bw(struct decon_device *decon, struct bts_bw bw)
+{
+	decon->bts.req_cnt++;
+
+	if (decon->bts.req_valid && !memcmp(&decon->bts.req_bw, &bw, sizeof(bw))) {
+		decon->bts.req_elided++;
+		return;
+	}
+
+	bts_update_bw(decon->bts.type, bw);
+	decon->bts.req_bw = bw;
+	decon->bts.req_valid = true;
+}
+
 void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
 {
 	struct decon_win_config *config = regs->dpp_config;
 	struct bts_decon_info bts_info;
 	enum dpp_rotate rot;
 	int idx, i;
+	ktime_t start;
 
 	if (!decon->bts.enabled)
 		return;
 
+	start = ktime_get();
+
 	DPU_DEBUG_BTS("\n");
 	DPU_DEBUG_BTS("%s + : DECON%d\n", __func__, decon->id);
 
@@ -210,6 +228,19 @@ void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
 	bts_info.vclk = decon->bts.resol_clk;
 	bts_info.lcd_w = decon->lcd_info->xres;
 	bts_info.lcd_h = decon->lcd_info->yres;
+
+	decon->bts.calc_cnt++;
+	if (decon->bts.calc_valid && !memcmp(&decon->bts.calc_key, &bts_info,
+				sizeof(struct bts_decon_info))) {
+		/* total_bw and bw[] of the same layers are still valid */
+		decon->bts.calc_hit++;
+		DPU_DEBUG_BTS("\tsame layers, reuse bandwidth\n");
+		goto find_freq;
+	}
+
+	memcpy(&decon->bts.calc_key, &bts_info, sizeof(struct bts_decon_info));
+	decon->bts.calc_valid = true;
+
 	decon->bts.total_bw = bts_calc_bw(decon->bts.type, &bts_info);
 	memcpy(&decon->bts.bts_info, &bts_info, sizeof(struct bts_decon_info));
 
@@ -220,6 +251,8 @@ void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
 					i, decon->bts.bw[i].val);
 	}
 
+find_freq:
+
 	DPU_DEBUG_BTS("\tDECON%d total bandwidth = %d\n", decon->id,
 			decon->bts.total_bw);
 
@@ -228,6 +261,8 @@ void dpu_bts_calc_bw(struct decon_device *decon, struct decon_reg_data *regs)
 	/* update bw for other decons */
 	dpu_bts_share_bw_info(decon->id);
 
+	decon->bts.calc_time += ktime_to_ns(ktime_sub(ktime_get(), start));
+
 	DPU_DEBUG_BTS("%s -\n", __func__);
 }
 
@@ -256,7 +291,7 @@ void dpu_bts_update_bw(struct decon_device *decon, struct decon_reg_data *regs,
 
 	if (is_after) { /* after DECON h/w configuration */
 		if (decon->bts.total_bw <= decon->bts.prev_total_bw)
-			bts_update_bw(decon->bts.type, bw);
+			dpu_bts_request_bw(decon, bw);
 
 #if defined(CONFIG_EXYNOS_DISPLAYPORT)
 		if ((displayport->state == DISPLAYPORT_STATE_ON)
@@ -272,7 +307,7 @@ void dpu_bts_update_bw(struct decon_device *decon, struct decon_reg_data *regs,
 		decon->bts.prev_max_disp_freq = decon->bts.max_disp_freq;
 	} else {
 		if (decon->bts.total_bw > decon->bts.prev_total_bw)
-			bts_update_bw(decon->bts.type, bw);
+			dpu_bts_request_bw(decon, bw);
 
 #if defined(CONFIG_EXYNOS_DISPLAYPORT)
 		if ((displayport->state == DISPLAYPORT_STATE_ON)
@@ -370,7 +405,7 @@ void dpu_bts_release_bw(struct decon_device *decon)
 		return;
 
 	if (decon->dt.out_type == DECON_OUT_DSI) {
-		bts_update_bw(decon->bts.type, bw);
+		dpu_bts_request_bw(decon, bw);
 		decon->bts.prev_total_bw = 0;
 		pm_qos_update_request(&decon->bts.disp_qos, 0);
 		decon->bts.prev_max_disp_freq = 0;
@@ -457,6 +492,8 @@ void dpu_bts_init(struct decon_device *decon)
 	pm_qos_add_request(&decon->bts.int_qos, PM_QOS_DEVICE_THROUGHPUT, 0);
 	pm_qos_add_request(&decon->bts.disp_qos, PM_QOS_DISPLAY_THROUGHPUT, 0);
 	decon->bts.scen_updated = 0;
+	decon->bts.calc_valid = false;
+	decon->bts.req_valid = false;
 
 	for (i = 0; i < BTS_DPP_MAX; ++i) {
 		sd = decon->dpp_sd[DPU_DMA2CH(i)];
@@ -78,6 +78,10 @@ extern struct decon_bts_ops decon_bts_control;
 #define MAX_PLANE_CNT		3
 #define MAX_PLANE_ADDR_CNT	4
 #define DECON_ENTER_HIBER_CNT	3
+/* frame interval longer than this isn't a cadence */
+#define DECON_HIBER_MAX_INTERVAL	(200 * USEC_PER_MSEC)
+/* hibernation should last this long at least to save power */
+#define DECON_HIBER_MIN_RESIDENCY	(16 * USEC_PER_MSEC)
 #define DECON_ENTER_LPD_CNT	3
 #define MIN_BLK_MODE_WIDTH	144
 #define MIN_BLK_MODE_HEIGHT	16
@@ -324,6 +328,8 @@ struct decon_dma_buf_data {
 	struct dma_buf_attachment	*attachment;
 	struct sg_table			*sg_table;
 	dma_addr_t			dma_addr;
+	/* DMA_FROM_DEVICE only for writeback output */
+	enum dma_data_direction		dir;
 #if defined(CONFIG_SUPPORT_LEGACY_FENCE)
 	struct sync_file                *fence;
 #else
@@ -411,6 +417,8 @@ struct decon_reg_data {
 	struct decon_win_rect block_rect[MAX_DECON_WIN];
 	struct decon_window_regs win_regs[MAX_DECON_WIN];
 	struct decon_dma_buf_data dma_buf_data[MAX_DECON_WIN + 1][MAX_PLANE_CNT];
+	/* buffers given to exynos_sysmmu_preload() */
+	unsigned int preload_cnt;
 #if !defined(CONFIG_SUPPORT_LEGACY_FENCE)
 	struct dma_fence *retire_fence;
 #endif
@@ -669,6 +677,8 @@ void DPU_EVENT_LOG_FENCE(struct v4l2_subdev *sd,
 		struct decon_reg_data *regs, dpu_event_t type);
 void DPU_EVENT_SHOW(struct seq_file *s, struct decon_device *decon);
 int decon_create_debugfs(struct decon_device *decon);
+int decon_set_update_thread_policy(struct decon_device *decon, int prio,
+		const struct cpumask *cpus);
 void decon_destroy_debugfs(struct decon_device *decon);
 
 /* HDR information of panel */
@@ -761,7 +771,9 @@ struct decon_debug {
 	struct dentry *debug_event;
 	struct dentry *debug_dump;
 	struct dentry *debug_bts;
+	struct dentry *debug_bts_stat;
 	struct dentry *debug_win;
+	struct dentry *debug_win_auto;
 	struct dentry *debug_systrace;
 #if defined(CONFIG_DSIM_CMD_TEST)
 	struct dentry *debug_cmd;
@@ -775,6 +787,8 @@ struct decon_debug {
 	atomic_t event_log_idx;
 	dpu_log_level_t event_log_level;
 	struct dentry *debug_low_persistence;
+	struct dentry *debug_up_stat;
+	struct dentry *debug_up_thread;
 	struct dpu_afbc_info prev_afbc_info;
 	struct dpu_afbc_info cur_afbc_info;
 #if defined(CONFIG_SUPPORT_LEGACY_ION)
@@ -785,6 +799,18 @@ struct decon_debug {
 	int prev_afbc_win_id[MAX_DECON_WIN];
 };
 
+#define DECON_UP_STAT_MAX		64	/* should be power of 2 */
+#define DECON_UP_THREAD_PRIO		20
+
+/* timestamps of each stage of one decon_update_regs() */
+struct decon_up_stat {
+	ktime_t start;
+	ktime_t fence;		/* all acquire fences are signaled */
+	ktime_t bts;		/* bandwidth is raised */
+	ktime_t regs;		/* SFRs are programmed */
+	ktime_t done;		/* frame is started or cleared */
+};
+
 struct decon_update_regs {
 	struct mutex lock;
 	struct list_head list;
@@ -793,6 +819,14 @@ struct decon_update_regs {
 	struct kthread_worker worker;
 	struct kthread_work work;
 	atomic_t remaining_frame;
+
+	/* written only by update thread, read by debugfs without lock */
+	struct decon_up_stat stat[DECON_UP_STAT_MAX];
+	atomic_t stat_idx;
+
+	/* scheduling policy of update thread, prio 0 means SCHED_NORMAL */
+	int prio;
+	struct cpumask cpus;
 };
 
 struct decon_vsync {
@@ -824,6 +858,17 @@ struct decon_hiber {
 	u32 enter_cnt;
 	u32 exit_cnt;
 	bool enabled;
+
+	/*
+	 * Frame cadence prediction. Hibernation isn't entered if the next
+	 * frame is expected before enter and exit could pay off.
+	 */
+	ktime_t last_frame;
+	u32 frame_interval;	/* us, moving average */
+	u32 enter_time;		/* us, moving average */
+	u32 exit_time;		/* us, moving average */
+	u32 abort_cnt;
+	bool aborted;
 };
 
 struct decon_win_update {
@@ -834,6 +879,18 @@ struct decon_win_update {
 	u32 verti_cnt;
 	/* previous update region */
 	struct decon_rect prev_up_region;
+
+	/*
+	 * If update region isn't given by user, it's derived from windows
+	 * that are changed from previous frame
+	 */
+	bool auto_enabled;
+	bool prev_valid;
+	struct decon_win_config prev_config[MAX_DECON_WIN];
+	struct dma_buf *prev_buf[MAX_DECON_WIN]; /* only for comparison */
+	u32 auto_cnt;
+	/* pixels not transferred to panel by window update */
+	u64 saved_pixels;
 };
 
 struct decon_bts_ops {
@@ -863,6 +920,22 @@ struct decon_bts {
 	u32 ch_bw[3][BTS_DPU_MAX];
 	enum bts_bw_type type;
 	struct bts_decon_info bts_info;
+
+	/*
+	 * Input of the last bandwidth calculation. If the layers are same,
+	 * previous result is reused.
+	 */
+	bool calc_valid;
+	struct bts_decon_info calc_key;
+	/* last requested bandwidth, same request is not sent again */
+	bool req_valid;
+	struct bts_bw req_bw;
+
+	u32 calc_cnt;
+	u32 calc_hit;
+	u64 calc_time;		/* ns */
+	u32 req_cnt;
+	u32 req_elided;
 #endif
 	struct decon_bts_ops *ops;
 	struct pm_qos_request mif_qos;
@@ -1101,6 +1174,8 @@ void decon_wb_free_irq(struct decon_device *decon);
 int decon_wb_get_clocks(struct decon_device *decon);
 void decon_wb_set_clocks(struct decon_device *decon);
 int decon_wb_get_out_sd(struct decon_device *decon);
+int decon_wb_check_output(struct decon_device *decon,
+		struct decon_win_config *config);
 
 #if defined(CONFIG_EXYNOS_DISPLAYPORT)
 /* DECON to DISPLAYPORT interface functions */
@@ -1167,6 +1242,7 @@ static inline u32 win_end_pos(int x, int y,  u32 xres, u32 yres)
 
 /* HIBER releated */
 int decon_exit_hiber(struct decon_device *decon);
+void decon_hiber_frame_arrived(struct decon_device *decon);
 int decon_enter_hiber(struct decon_device *decon);
 int decon_lcd_off(struct decon_device *decon);
 int decon_register_hiber_work(struct decon_device *decon);
@@ -1382,6 +1458,8 @@ int decon_update_last_regs(struct decon_device *decon,
 						struct decon_win_config_data_old)
 #define S3CFB_WIN_CONFIG		_IOW('F', 209, \
 						struct decon_win_config_data)
+#define S3CFB_VALIDATE_WIN_CONFIG	_IOW('F', 210, \
+						struct decon_win_config_data)
 
 /* cursor async */
 #define DECON_WIN_CURSOR_POS		_IOW('F', 222, struct decon_user_window)
@@ -43,6 +43,7 @@
 #include <media/v4l2-subdev.h>
 #if defined(CONFIG_CAL_IF)
 #include <soc/samsung/cal-if.h>
+#include <soc/samsung/exynos-frametrace.h>
 #endif
 #if defined(CONFIG_SOC_EXYNOS9610)
 #include <dt-bindings/clock/exynos9610.h>
@@ -269,7 +270,7 @@ static void decon_free_unused_buf(struct decon_device *decon,
 		ion_iovmm_unmap(dma->attachment, dma->dma_addr);
 	if (dma->attachment && dma->sg_table)
 		dma_buf_unmap_attachment(dma->attachment,
-				dma->sg_table, DMA_TO_DEVICE);
+				dma->sg_table, dma->dir);
 	if (dma->dma_buf && dma->attachment)
 		dma_buf_detach(dma->dma_buf, dma->attachment);
 	if (dma->dma_buf)
@@ -295,7 +296,7 @@ static void decon_free_dma_buf(struct decon_device *decon,
 	ion_iovmm_unmap(dma->attachment, dma->dma_addr);
 
 	dma_buf_unmap_attachment(dma->attachment, dma->sg_table,
-			DMA_TO_DEVICE);
+			dma->dir);
 
 	dma_buf_detach(dma->dma_buf, dma->attachment);
 	dma_buf_put(dma->dma_buf);
@@ -1266,6 +1267,12 @@ static unsigned int decon_map_ion_handle(struct decon_device *decon,
 	dma->fence = NULL;
 	dma->dma_buf = buf;
 
+	/* writeback output is written by ODMA */
+	if ((decon->dt.out_type == DECON_OUT_WB) && (win_no == decon->dt.max_win))
+		dma->dir = DMA_FROM_DEVICE;
+	else
+		dma->dir = DMA_TO_DEVICE;
+
 	dma->attachment = dma_buf_attach(dma->dma_buf, dev);
 	if (IS_ERR_OR_NULL(dma->attachment)) {
 		decon_err("dma_buf_attach() failed: %ld\n",
@@ -1273,8 +1280,7 @@ static unsigned int decon_map_ion_handle(struct decon_device *decon,
 		goto err_buf_map_attach;
 	}
 
-	dma->sg_table = dma_buf_map_attachment(dma->attachment,
-			DMA_TO_DEVICE);
+	dma->sg_table = dma_buf_map_attachment(dma->attachment, dma->dir);
 	if (IS_ERR_OR_NULL(dma->sg_table)) {
 		decon_err("dma_buf_map_attachment() failed: %ld\n",
 				PTR_ERR(dma->sg_table));
@@ -1283,7 +1289,7 @@ static unsigned int decon_map_ion_handle(struct decon_device *decon,
 
 	/* This is DVA(Device Virtual Address) for setting base address SFR */
 	dma->dma_addr = ion_iovmm_map(dma->attachment, 0, dma->dma_buf->size,
-				      DMA_TO_DEVICE, 0);
+				      dma->dir, 0);
 	if (IS_ERR_VALUE(dma->dma_addr)) {
 		decon_err("ion_iovmm_map() failed: %pa\n", &dma->dma_addr);
 		goto err_iovmm_map;
@@ -1297,7 +1303,7 @@ static unsigned int decon_map_ion_handle(struct decon_device *decon,
 
 err_iovmm_map:
 	dma_buf_unmap_attachment(dma->attachment, dma->sg_table,
-			DMA_TO_DEVICE);
+			dma->dir);
 err_buf_map_attachment:
 	dma_buf_detach(dma->dma_buf, dma->attachment);
 err_buf_map_attach:
@@ -1317,6 +1323,7 @@ static int decon_import_buffer(struct decon_device *decon, int idx,
 	struct displayport_device *displayport;
 #endif
 	struct dsim_device *dsim;
+	struct dpp_device *dpp;
 	struct device *dev = NULL;
 	int i;
 	size_t buf_size = 0;
@@ -1353,6 +1360,10 @@ static int decon_import_buffer(struct decon_device *decon, int idx,
 			displayport = v4l2_get_subdevdata(decon->out_sd[0]);
 			dev = displayport->dev;
 #endif
+		} else if (decon->dt.out_type == DECON_OUT_WB) {
+			/* out_sd of writeback is ODMA */
+			dpp = v4l2_get_subdevdata(decon->out_sd[0]);
+			dev = dpp->dev;
 		} else { /* DSI case */
 			dsim = v4l2_get_subdevdata(decon->out_sd[0]);
 			dev = dsim->dev;
@@ -1368,6 +1379,15 @@ static int decon_import_buffer(struct decon_device *decon, int idx,
 			return -ENOMEM;
 		}
 
+		/* TLB of the next frame is warmed up and fault is not allowed */
+		if (exynos_sysmmu_preload(dev, dma_buf_data->dma_addr, buf_size,
+					regs->preload_cnt++) == -EFAULT) {
+			decon_err("win[%d] buffer is not fully mapped\n", idx);
+			return -EFAULT;
+		}
+
+		exynos_frametrace(buf, EXYNOS_FRAMETRACE_DPU_QUEUE, idx);
+
 		/* DVA is passed to DPP parameters structure */
 		config->dpp_parm.addr[i] = dma_buf_data->dma_addr;
 	}
@@ -2165,12 +2185,35 @@ static void decon_update_afbc_info(struct decon_device *decon,
 }
 #endif
 
+static void decon_save_up_stat(struct decon_device *decon,
+		struct decon_up_stat *stat)
+{
+	int idx = atomic_inc_return(&decon->up.stat_idx) & (DECON_UP_STAT_MAX - 1);
+
+	decon->up.stat[idx] = *stat;
+}
+
+/* The buffers of the frame are on screen, or written back */
+static void decon_frametrace_scanout(struct decon_device *decon,
+		struct decon_reg_data *regs)
+{
+	int i;
+
+	if (!exynos_frametrace_enabled())
+		return;
+
+	for (i = 0; i < decon->dt.max_win; i++)
+		exynos_frametrace(regs->dma_buf_data[i][0].dma_buf,
+				EXYNOS_FRAMETRACE_DPU_SCANOUT, i);
+}
+
 static void decon_update_regs(struct decon_device *decon,
 		struct decon_reg_data *regs)
 {
 	struct decon_dma_buf_data old_dma_bufs[decon->dt.max_win][MAX_PLANE_CNT];
 	int old_plane_cnt[MAX_DECON_WIN];
 	struct decon_mode_info psr;
+	struct decon_up_stat stat = { .start = ktime_get() };
 	int i;
 
 	if (!decon->systrace.pid)
@@ -2194,6 +2237,7 @@ static void decon_update_regs(struct decon_device *decon,
 	}
 
 	decon_systrace(decon, 'C', "decon_fence_wait", 0);
+	stat.fence = ktime_get();
 
 	decon_check_used_dpp(decon, regs);
 
@@ -2208,6 +2252,7 @@ static void decon_update_regs(struct decon_device *decon,
 	decon->bts.ops->bts_calc_bw(decon, regs);
 	decon->bts.ops->bts_update_bw(decon, regs, 0);
 #endif
+	stat.bts = ktime_get();
 
 	DPU_EVENT_LOG_WINCON(&decon->sd, regs);
 
@@ -2223,6 +2268,7 @@ static void decon_update_regs(struct decon_device *decon,
 #endif
 			BUG();
 		}
+		stat.regs = ktime_get();
 		if (!regs->num_of_window) {
 			__decon_update_clear(decon, regs);
 			decon_wait_for_vsync(decon, VSYNC_TIMEOUT_MSEC);
@@ -2281,6 +2327,10 @@ static void decon_update_regs(struct decon_device *decon,
 	}
 
 end:
+	stat.done = ktime_get();
+	decon_save_up_stat(decon, &stat);
+	decon_frametrace_scanout(decon, regs);
+
 	DPU_EVENT_LOG(DPU_EVT_TRIG_MASK, &decon->sd, ktime_set(0, 0));
 
 	decon_release_old_bufs(decon, regs, old_dma_bufs, old_plane_cnt);
@@ -2551,6 +2601,9 @@ static int decon_prepare_win_config(struct decon_device *decon,
 
 	if (decon->dt.out_type == DECON_OUT_WB) {
 		regs->protection[decon->dt.max_win] = win_config[decon->dt.max_win].protection;
+		ret = decon_wb_check_output(decon, &win_config[decon->dt.max_win]);
+		if (ret)
+			goto config_err;
 		ret = decon_import_buffer(decon, decon->dt.max_win,
 				&win_config[decon->dt.max_win], regs);
 	}
@@ -2606,6 +2659,45 @@ static bool decon_get_mask_layer(struct decon_device *decon,
 }
 #endif
 
+/*
+ * Tests whether DPPs can handle the buffer windows of the configuration.
+ * Nothing is imported or applied, so HWC can try a composition in advance.
+ */
+static int decon_validate_win_config(struct decon_device *decon,
+		struct decon_win_config_data *win_data)
+{
+	struct decon_win_config *config;
+	struct dpp_config dpp_config;
+	struct v4l2_subdev *sd;
+	int i, ret = 0;
+
+	for (i = 0; i < decon->dt.max_win; i++) {
+		config = &win_data->config[i];
+
+		if (config->state != DECON_WIN_STATE_BUFFER &&
+				config->state != DECON_WIN_STATE_CURSOR)
+			continue;
+
+		ret = decon_check_limitation(decon, i, config);
+		if (ret)
+			break;
+
+		sd = decon->dpp_sd[DPU_DMA2CH(config->idma_type)];
+		memcpy(&dpp_config.config, config,
+				sizeof(struct decon_win_config));
+		dpp_config.rcv_num = 0;
+		ret = v4l2_subdev_call(sd, core, ioctl,
+				DPP_VALIDATE_CONFIG, &dpp_config);
+		if (ret) {
+			decon_dbg("decon-%d win%d isn't supported by %s\n",
+					decon->id, i, sd->name);
+			break;
+		}
+	}
+
+	return ret;
+}
+
 static int decon_set_win_config(struct decon_device *decon,
 		struct decon_win_config_data *win_data)
 {
@@ -2644,6 +2736,9 @@ static int decon_set_win_config(struct decon_device *decon,
 		goto err;
 	}
 
+	if (decon->dt.out_type == DECON_OUT_DSI)
+		decon_hiber_frame_arrived(decon);
+
 	regs = kzalloc(sizeof(struct decon_reg_data), GFP_KERNEL);
 	if (!regs) {
 		decon_err("could not allocate decon_reg_data\n");
@@ -2887,6 +2982,16 @@ static int decon_ioctl(struct fb_info *info, unsigned int cmd,
 		}
 		break;
 
+	case S3CFB_VALIDATE_WIN_CONFIG:
+		if (copy_from_user(&win_data, (void __user *)arg,
+					sizeof(struct decon_win_config_data))) {
+			ret = -EFAULT;
+			break;
+		}
+
+		ret = decon_validate_win_config(decon, &win_data);
+		break;
+
 	case S3CFB_GET_HDR_CAPABILITIES:
 		ret = decon_get_hdr_capa(decon, &hdr_capa);
 		if (ret)
@@ -3801,14 +3906,54 @@ static void decon_destroy_update_thread(struct decon_device *decon)
 		kthread_stop(decon->up.thread);
 }
 
-static int decon_create_update_thread(struct decon_device *decon, char *name)
+/*
+ * Sets scheduling policy of update thread. Update thread runs as SCHED_FIFO
+ * with @prio, or SCHED_NORMAL if @prio is 0, on @cpus.
+ */
+int decon_set_update_thread_policy(struct decon_device *decon, int prio,
+		const struct cpumask *cpus)
 {
-	struct sched_param param;
+	struct sched_param param = { .sched_priority = prio };
+	int ret;
+
+	if (!decon->up.thread)
+		return -ENODEV;
 
+	if (prio < 0 || prio >= MAX_RT_PRIO)
+		return -EINVAL;
+
+	if (!cpumask_intersects(cpus, cpu_online_mask))
+		return -EINVAL;
+
+	ret = sched_setscheduler_nocheck(decon->up.thread,
+			prio ? SCHED_FIFO : SCHED_NORMAL, &param);
+	if (ret) {
+		decon_err("failed to set update thread priority(%d)\n", ret);
+		return ret;
+	}
+
+	ret = set_cpus_allowed_ptr(decon->up.thread, cpus);
+	if (ret) {
+		decon_err("failed to set update thread affinity(%d)\n", ret);
+		return ret;
+	}
+
+	decon->up.prio = prio;
+	cpumask_copy(&decon->up.cpus, cpus);
+
+	decon_info("update thread: prio(%d) cpus(%*pbl)\n", prio,
+			cpumask_pr_args(cpus));
+
+	return 0;
+}
+
+static int decon_create_update_thread(struct decon_device *decon, char *name)
+{
 	INIT_LIST_HEAD(&decon->up.list);
 	INIT_LIST_HEAD(&decon->up.saved_list);
 	decon->up_list_saved = false;
 	atomic_set(&decon->up.remaining_frame, 0);
+	atomic_set(&decon->up.stat_idx, -1);
 	kthread_init_worker(&decon->up.worker);
 	decon->up.thread = kthread_run(kthread_worker_fn,
 			&decon->up.worker, name);
@@ -3817,8 +3962,8 @@ static int decon_create_update_thread(struct decon_device *decon, char *name)
 		decon_err("failed to run update_regs thread\n");
 		return PTR_ERR(decon->up.thread);
 	}
-	param.sched_priority = 20;
-	sched_setscheduler_nocheck(decon->up.thread, SCHED_FIFO, &param);
+	decon_set_update_thread_policy(decon, DECON_UP_THREAD_PRIO,
+			cpu_possible_mask);
 	kthread_init_work(&decon->up.work, decon_update_regs_handler);
 
 	return 0;
@@ -22,6 +22,7 @@
 #include <linux/of_address.h>
 #include <linux/pinctrl/consumer.h>
 #include <linux/irq.h>
+#include <linux/ems_service.h>
 #include <media/v4l2-subdev.h>
 #if defined(CONFIG_EXYNOS_WD_DVFS)
 #include <linux/exynos-wd.h>
@@ -63,6 +64,8 @@ static irqreturn_t decon_irq_handler(int irq, void *dev_data)
 	if (irq_sts_reg & DPU_FRAME_DONE_INT_PEND) {
 		DPU_EVENT_LOG(DPU_EVT_DECON_FRAMEDONE, &decon->sd, ktime_set(0, 0));
 		decon_hiber_trig_reset(decon);
+		if (decon->id == 0)
+			ems_input_boost_frame_done();
 		if (decon->state == DECON_STATE_TUI)
 			decon_info("%s:%d TUI Frame Done\n", __func__, __LINE__);
 	}
@@ -938,6 +941,56 @@ int decon_mmap(struct fb_info *info, struct vm_area_struct *vma)
 }
 EXPORT_SYMBOL(decon_mmap);
 
+/* moving average with 1/8 weight of the new sample */
+static inline u32 decon_hiber_avg(u32 avg, u32 sample)
+{
+	return avg ? avg - (avg >> 3) + (sample >> 3) : sample;
+}
+
+/*
+ * Called whenever a new frame is requested. The interval between frames is
+ * tracked to predict when the next frame will come. An interval longer than
+ * DECON_HIBER_MAX_INTERVAL means the screen went idle and isn't a cadence.
+ */
+void decon_hiber_frame_arrived(struct decon_device *decon)
+{
+	struct decon_hiber *hiber = &decon->hiber;
+	ktime_t now = ktime_get();
+	s64 interval;
+
+	if (!hiber->enabled)
+		return;
+
+	interval = ktime_us_delta(now, hiber->last_frame);
+	if (hiber->last_frame && interval < DECON_HIBER_MAX_INTERVAL)
+		hiber->frame_interval = decon_hiber_avg(hiber->frame_interval,
+				(u32)interval);
+
+	hiber->last_frame = now;
+	hiber->aborted = false;
+}
+
+/*
+ * Returns true if the next frame is predicted far enough to pay off the
+ * cost of entering and exiting hibernation. Without enough history or once
+ * the expected frame is late for a while, hibernation is allowed.
+ */
+static bool decon_hiber_predict_cond(struct decon_device *decon)
+{
+	struct decon_hiber *hiber = &decon->hiber;
+	s64 elapsed;
+
+	if (!hiber->frame_interval || !hiber->last_frame)
+		return true;
+
+	elapsed = ktime_us_delta(ktime_get(), hiber->last_frame);
+	if (elapsed >= 2 * hiber->frame_interval)
+		return true;
+
+	return hiber->frame_interval - elapsed > hiber->enter_time +
+		hiber->exit_time + DECON_HIBER_MIN_RESIDENCY;
+}
+
 int decon_exit_hiber(struct decon_device *decon)
 {
 	int ret = 0;
@@ -995,6 +1048,8 @@ int decon_exit_hiber(struct decon_device *decon)
 	decon_dbg("decon-%d %s - (state:%d -> %d)\n",
 			decon->id, __func__, prev_state, decon->state);
 	decon->hiber.exit_cnt++;
+	decon->hiber.exit_time = decon_hiber_avg(decon->hiber.exit_time,
+			(u32)ktime_us_delta(ktime_get(), start));
 	DPU_EVENT_LOG(DPU_EVT_EXIT_HIBER, &decon->sd, start);
 
 err:
@@ -1067,6 +1122,8 @@ int decon_enter_hiber(struct decon_device *decon)
 	decon->state = DECON_STATE_HIBER;
 
 	decon->hiber.enter_cnt++;
+	decon->hiber.enter_time = decon_hiber_avg(decon->hiber.enter_time,
+			(u32)ktime_us_delta(ktime_get(), start));
 	DPU_EVENT_LOG(DPU_EVT_ENTER_HIBER, &decon->sd, start);
 
 err:
@@ -1103,8 +1160,19 @@ static void decon_hiber_handler(struct kthread_work *work)
 	if (!decon || !decon->hiber.enabled)
 		return;
 
-	if (decon_hiber_enter_cond(decon))
-		decon_enter_hiber(decon);
+	if (!decon_hiber_enter_cond(decon))
+		return;
+
+	if (!decon_hiber_predict_cond(decon)) {
+		/* count once per idle period, the handler runs at every TE */
+		if (!decon->hiber.aborted) {
+			decon->hiber.aborted = true;
+			decon->hiber.abort_cnt++;
+		}
+		return;
+	}
+
+	decon_enter_hiber(decon);
 }
 
 int decon_register_hiber_work(struct decon_device *decon)
@@ -11,6 +11,10 @@
 
 #include <linux/clk-provider.h>
 #include "decon.h"
+#include "dpp.h"
+
+/* stride of encoder input buffer is aligned by macroblock */
+#define DECON_WB_YUV_STRIDE_ALIGN	16
 
 static irqreturn_t decon_wb_irq_handler(int irq, void *dev_data)
 {
@@ -185,3 +189,41 @@ int decon_wb_get_out_sd(struct decon_device *decon)
 
 	return 0;
 }
+
+/*
+ * Writeback output can be given to the video encoder as its source buffer
+ * without copy. YUV420 output must be laid out as the encoder expects.
+ */
+int decon_wb_check_output(struct decon_device *decon,
+		struct decon_win_config *config)
+{
+	if ((config->dst.w == 0) || (config->dst.h == 0) ||
+			(config->dst.x + config->dst.w > config->dst.f_w) ||
+			(config->dst.y + config->dst.h > config->dst.f_h)) {
+		decon_err("wb output size is abnormal [%d %d %d %d] in %dx%d\n",
+				config->dst.x, config->dst.y,
+				config->dst.w, config->dst.h,
+				config->dst.f_w, config->dst.f_h);
+		return -EINVAL;
+	}
+
+	if (!is_yuv420(config))
+		return 0;
+
+	if (!check_align(config->dst.x, config->dst.y, 2, 2) ||
+			!check_align(config->dst.w, config->dst.h, 2, 2)) {
+		decon_err("wb YUV420 output isn't 2 pixel aligned [%d %d %d %d]\n",
+				config->dst.x, config->dst.y,
+				config->dst.w, config->dst.h);
+		return -EINVAL;
+	}
+
+	if (!check_align(config->dst.f_w, config->dst.f_h,
+				DECON_WB_YUV_STRIDE_ALIGN, 2)) {
+		decon_err("wb YUV420 output stride(%d) isn't %d aligned\n",
+				config->dst.f_w, DECON_WB_YUV_STRIDE_ALIGN);
+		return -EINVAL;
+	}
+
+	return 0;
+}
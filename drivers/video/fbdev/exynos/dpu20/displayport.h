@@ -345,6 +345,8 @@ struct fb_vendor {
 
 #define DPCD_TEST_AUDIO_PATTERN_TYPE 0x00272
 
+#define DPCD_ADD_BRANCH_IEEE_OUI	0x500
+#define DPCD_BRANCH_ID_LENGTH	12
 #define DPCD_BRANCH_HW_REVISION	0x509
 #define DPCD_BRANCH_SW_REVISION_MAJOR	0x50A
 #define DPCD_BRANCH_SW_REVISION_MINOR	0x50B
@@ -501,6 +503,47 @@ struct edid_data {
 	u8 min_lumi_data;
 };
 
+#define DISPLAYPORT_SINK_CACHE_SIZE 4
+
+/*
+ * EDID and last good link training of a sink, keyed by the crc32 of the
+ * DPCD receiver capabilities, the branch device identification and the
+ * EDID block 0, so that a DeX dock behind another adapter is another sink.
+ */
+struct displayport_sink_cache {
+	u32 key;
+	unsigned long last_used;	/* jiffies, for the eviction */
+
+	u8 *edid;
+	int edid_blocks;
+
+	bool link_valid;
+	u8 link_rate;
+	u8 lane_cnt;
+	u8 drive_current[MAX_LANE_CNT];
+	u8 pre_emphasis[MAX_LANE_CNT];
+};
+
+enum displayport_connect_stage {
+	DP_CONNECT_HPD,
+	DP_CONNECT_EDID,
+	DP_CONNECT_LINK,
+	DP_CONNECT_VIDEO,
+	DP_CONNECT_STAGE_MAX,
+};
+
+/* Timing of the last connection, from the HPD to the first frame */
+struct displayport_connect_stats {
+	ktime_t time[DP_CONNECT_STAGE_MAX];
+	bool edid_cached;
+	bool fast_link;
+
+	unsigned int edid_hits;
+	unsigned int edid_misses;
+	unsigned int fast_link_ok;
+	unsigned int fast_link_fail;
+};
+
 struct displayport_device {
 	enum displayport_state state;
 	struct device *dev;
@@ -566,6 +609,11 @@ struct displayport_device {
 	struct edid_data rx_edid_data;
 
 	int idle_ip_index;
+
+	struct displayport_sink_cache sink_cache[DISPLAYPORT_SINK_CACHE_SIZE];
+	struct displayport_sink_cache *cur_sink;
+	struct displayport_connect_stats connect;
+	struct dentry *debug_connect;
 };
 
 struct displayport_debug_param {
@@ -1000,6 +1048,7 @@ int displayport_reg_stand_alone_crc_sorting(void);
 
 int edid_read(struct displayport_device *hdev, u8 **data);
 int edid_update(struct displayport_device *hdev);
+void edid_sink_cache_free(struct displayport_device *hdev);
 struct v4l2_dv_timings edid_preferred_preset(void);
 void edid_set_preferred_preset(int mode);
 int edid_find_resolution(u16 xres, u16 yres, u16 refresh);
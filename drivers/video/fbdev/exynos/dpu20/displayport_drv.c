@@ -25,6 +25,8 @@
 #include <linux/of_gpio.h>
 #include <linux/device.h>
 #include <linux/module.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <video/mipi_display.h>
 #include <linux/regulator/consumer.h>
 #include <media/v4l2-dv-timings.h>
@@ -91,6 +93,8 @@ static int displayport_remove(struct platform_device *pdev)
 	mutex_destroy(&displayport->aux_lock);
 	mutex_destroy(&displayport->training_lock);
 	destroy_workqueue(displayport->dp_wq);
+	debugfs_remove(displayport->debug_connect);
+	edid_sink_cache_free(displayport);
 	destroy_workqueue(displayport->hdcp2_wq);
 	displayport_info("displayport driver removed\n");
 
@@ -519,7 +523,11 @@ EQ_Training_Retry:
 	goto EQ_Training_Retry;
 }
 
-static int displayport_fast_link_training(void)
+/*
+ * Trains at the link rate, lane count and levels of @sink, when it has
+ * trained before, otherwise at the maximum of the sink with default levels.
+ */
+static int displayport_fast_link_training(const struct displayport_sink_cache *sink)
 {
 	u8 link_rate;
 	u8 lane_cnt;
@@ -553,6 +561,13 @@ static int displayport_fast_link_training(void)
 		drive_current[i] = 2;
 	}
 
+	if (sink && sink->link_valid) {
+		link_rate = sink->link_rate;
+		lane_cnt = sink->lane_cnt;
+		memcpy(drive_current, sink->drive_current, sizeof(drive_current));
+		memcpy(pre_emphasis, sink->pre_emphasis, sizeof(pre_emphasis));
+	}
+
 	displayport_reg_phy_reset(1);
 	displayport_reg_phy_init_setting();
 	displayport_reg_phy_mode_setting();
@@ -657,9 +672,10 @@ static int displayport_fast_link_training(void)
 			return -EINVAL;
 		}
 	} else {
-		if (lane_cr_done != 0x01)
+		if (lane_cr_done != 0x01) {
 			displayport_err("Fast Link Training Fail : lane_cnt %d -", lane_cnt);
-		return -EINVAL;
+			return -EINVAL;
+		}
 	}
 
 	displayport_info("lane_cr_done = %x\n", lane_cr_done);
@@ -804,10 +820,32 @@ static int displayport_link_status_read(void)
 	return 0;
 }
 
+/* Keeps the link rate, lane count and levels trained with the sink */
+static void displayport_sink_save_link(struct displayport_sink_cache *sink)
+{
+	u8 lane_set[MAX_LANE_CNT] = {0, };
+	int i;
+
+	if (displayport_reg_dpcd_read_burst(DPCD_ADD_TRANING_LANE0_SET,
+				MAX_LANE_CNT, lane_set)) {
+		sink->link_valid = false;
+		return;
+	}
+
+	sink->link_rate = displayport_reg_get_link_bw();
+	sink->lane_cnt = displayport_reg_get_lane_count();
+	for (i = 0; i < MAX_LANE_CNT; i++) {
+		sink->drive_current[i] = lane_set[i] & 0x3;
+		sink->pre_emphasis[i] = (lane_set[i] >> 3) & 0x3;
+	}
+	sink->link_valid = true;
+}
+
 static int displayport_link_training(void)
 {
 	u8 val;
 	struct displayport_device *displayport = get_displayport_drvdata();
+	struct displayport_sink_cache *sink;
 	int ret = 0;
 
 	mutex_lock(&displayport->training_lock);
@@ -815,17 +853,41 @@ static int displayport_link_training(void)
 	ret = edid_update(displayport);
 	if (ret < 0)
 		displayport_err("failed to update edid\n");
+	displayport->connect.time[DP_CONNECT_EDID] = ktime_get();
+
+	sink = displayport->cur_sink;
+	displayport->connect.fast_link = false;
+
+	/* The last good link of a known sink is tried first */
+	if (sink && sink->link_valid && !g_displayport_debug_param.param_used) {
+		ret = displayport_fast_link_training(sink);
+		if (!ret) {
+			displayport->connect.fast_link = true;
+			displayport->connect.fast_link_ok++;
+			goto out;
+		}
+
+		displayport_info("cached link %02x %02x of sink %08x failed\n",
+				sink->link_rate, sink->lane_cnt, sink->key);
+		displayport->connect.fast_link_fail++;
+		sink->link_valid = false;
+	}
 
 	displayport_reg_dpcd_read(DPCD_ADD_MAX_DOWNSPREAD, 1, &val);
 	displayport_dbg("DPCD_ADD_MAX_DOWNSPREAD = %x\n", val);
 
 	if (val & NO_AUX_HANDSHAKE_LINK_TRANING) {
-		ret = displayport_fast_link_training();
+		ret = displayport_fast_link_training(NULL);
 		if (ret < 0)
 			ret = displayport_full_link_training();
 	} else
 		ret = displayport_full_link_training();
 
+out:
+	if (!ret && sink)
+		displayport_sink_save_link(sink);
+	displayport->connect.time[DP_CONNECT_LINK] = ktime_get();
+
 	mutex_unlock(&displayport->training_lock);
 
 	return ret;
@@ -881,6 +943,9 @@ void displayport_hpd_changed(int state)
 	if (state) {
 		pm_stay_awake(displayport->dev);
 
+		displayport->connect.time[DP_CONNECT_HPD] = ktime_get();
+		displayport->connect.time[DP_CONNECT_VIDEO] = 0;
+
 		displayport->bpc = BPC_8;	/*default setting*/
 		displayport->bist_used = 0;
 		displayport->bist_type = COLOR_BAR;
@@ -1933,6 +1998,69 @@ static void hdcp_start(struct displayport_device *displayport)
 #endif
 }
 
+static s64 displayport_connect_us(struct displayport_device *displayport,
+		enum displayport_connect_stage from, enum displayport_connect_stage to)
+{
+	return ktime_us_delta(displayport->connect.time[to],
+			displayport->connect.time[from]);
+}
+
+/* Logs the timing of a connection when its first frame starts */
+static void displayport_connect_done(struct displayport_device *displayport)
+{
+	struct displayport_connect_stats *connect = &displayport->connect;
+
+	if (!connect->time[DP_CONNECT_HPD] || connect->time[DP_CONNECT_VIDEO])
+		return;
+
+	connect->time[DP_CONNECT_VIDEO] = ktime_get();
+
+	displayport_info("connect %lld us: edid %lld us%s, link %lld us%s, video %lld us\n",
+			displayport_connect_us(displayport, DP_CONNECT_HPD, DP_CONNECT_VIDEO),
+			displayport_connect_us(displayport, DP_CONNECT_HPD, DP_CONNECT_EDID),
+			connect->edid_cached ? " (cached)" : "",
+			displayport_connect_us(displayport, DP_CONNECT_EDID, DP_CONNECT_LINK),
+			connect->fast_link ? " (fast)" : "",
+			displayport_connect_us(displayport, DP_CONNECT_LINK, DP_CONNECT_VIDEO));
+}
+
+static int displayport_connect_show(struct seq_file *s, void *unused)
+{
+	struct displayport_device *displayport = s->private;
+	struct displayport_connect_stats *connect = &displayport->connect;
+
+	if (connect->time[DP_CONNECT_VIDEO]) {
+		seq_printf(s, "hpd_to_edid_us: %lld%s\n",
+				displayport_connect_us(displayport, DP_CONNECT_HPD, DP_CONNECT_EDID),
+				connect->edid_cached ? " cached" : "");
+		seq_printf(s, "edid_to_link_us: %lld%s\n",
+				displayport_connect_us(displayport, DP_CONNECT_EDID, DP_CONNECT_LINK),
+				connect->fast_link ? " fast" : "");
+		seq_printf(s, "link_to_video_us: %lld\n",
+				displayport_connect_us(displayport, DP_CONNECT_LINK, DP_CONNECT_VIDEO));
+		seq_printf(s, "total_us: %lld\n",
+				displayport_connect_us(displayport, DP_CONNECT_HPD, DP_CONNECT_VIDEO));
+	}
+	seq_printf(s, "edid_cache: %u hits %u misses\n",
+			connect->edid_hits, connect->edid_misses);
+	seq_printf(s, "fast_link: %u ok %u failed\n",
+			connect->fast_link_ok, connect->fast_link_fail);
+
+	return 0;
+}
+
+static int displayport_connect_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, displayport_connect_show, inode->i_private);
+}
+
+static const struct file_operations displayport_connect_fops = {
+	.open		= displayport_connect_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static int displayport_enable(struct displayport_device *displayport)
 {
 	int ret = 0;
@@ -1973,6 +2101,7 @@ static int displayport_enable(struct displayport_device *displayport)
 	displayport_reg_video_mute(0);
 #endif
 	displayport_reg_start();
+	displayport_connect_done(displayport);
 
 	displayport->state = DISPLAYPORT_STATE_ON;
 	wake_up_interruptible(&displayport->dp_wait);
@@ -3038,6 +3167,9 @@ static int displayport_probe(struct platform_device *pdev)
 		return -EINVAL;
 	}
 
+	displayport->debug_connect = debugfs_create_file("displayport_connect",
+			0444, NULL, displayport, &displayport_connect_fops);
+
 #ifdef DISPLAYPORT_TEST
 	dp_class = class_create(THIS_MODULE, "dp_sec");
 	if (IS_ERR(dp_class))
@@ -10,6 +10,10 @@
 */
 
 #include <linux/fb.h>
+#include <linux/crc32.h>
+#include <linux/jiffies.h>
+#include <linux/moduleparam.h>
+#include <linux/slab.h>
 #include "displayport.h"
 
 #define EDID_SEGMENT_ADDR	(0x60 >> 1)
@@ -24,6 +28,10 @@
 
 int forced_resolution = -1;
 
+/* 0 reads the whole EDID at every connection, e.g. for the Link CTS */
+static bool sink_cache = true;
+module_param(sink_cache, bool, 0644);
+
 static struct fb_videomode ud_mode_h14b_vsdb[] = {
 	{"3840x2160p@30", 30, 3840, 2160, 297000000, 0, 0, 0, 0, 0, 0, 0, FB_VMODE_NONINTERLACED, 0},
 	{"3840x2160p@25", 25, 3840, 2160, 297000000, 0, 0, 0, 0, 0, 0, 0, FB_VMODE_NONINTERLACED, 0},
@@ -92,13 +100,84 @@ static int edid_read_block(struct displayport_device *hdev, int block, u8 *buf,
 	return 0;
 }
 
+static u32 edid_sink_key(const u8 *block0)
+{
+	u8 caps[16] = {0, };
+	u8 branch[DPCD_BRANCH_ID_LENGTH] = {0, };
+	u32 key;
+
+	displayport_reg_dpcd_read_burst(DPCD_ADD_REVISION_NUMBER,
+			sizeof(caps), caps);
+	displayport_reg_dpcd_read_burst(DPCD_ADD_BRANCH_IEEE_OUI,
+			sizeof(branch), branch);
+
+	key = crc32_le(~0, caps, sizeof(caps));
+	key = crc32_le(key, branch, sizeof(branch));
+
+	return crc32_le(key, block0, EDID_BLOCK_SIZE);
+}
+
+/* Entry of the connected sink, the least recently used one is reset if new */
+static struct displayport_sink_cache *edid_sink_lookup(
+		struct displayport_device *hdev, const u8 *block0)
+{
+	struct displayport_sink_cache *sink, *lru = NULL;
+	u32 key = edid_sink_key(block0);
+	int i;
+
+	for (i = 0; i < DISPLAYPORT_SINK_CACHE_SIZE; i++) {
+		sink = &hdev->sink_cache[i];
+		if (!sink->edid) {
+			/* a free entry is always the one to take */
+			if (!lru || lru->edid)
+				lru = sink;
+			continue;
+		}
+
+		if (sink->key == key)
+			goto found;
+
+		if (!lru || (lru->edid &&
+				time_before(sink->last_used, lru->last_used)))
+			lru = sink;
+	}
+
+	sink = lru;
+	kfree(sink->edid);
+	memset(sink, 0, sizeof(*sink));
+	sink->key = key;
+
+found:
+	sink->last_used = jiffies;
+	return sink;
+}
+
+void edid_sink_cache_free(struct displayport_device *hdev)
+{
+	int i;
+
+	for (i = 0; i < DISPLAYPORT_SINK_CACHE_SIZE; i++) {
+		kfree(hdev->sink_cache[i].edid);
+		hdev->sink_cache[i].edid = NULL;
+	}
+	hdev->cur_sink = NULL;
+}
+
+/*
+ * Block 0 is always read, it identifies the sink. The extension blocks are
+ * taken from the cache when the sink is known.
+ */
 int edid_read(struct displayport_device *hdev, u8 **data)
 {
+	struct displayport_sink_cache *sink = NULL;
 	u8 block0[EDID_BLOCK_SIZE];
 	u8 *edid;
 	int block = 0;
 	int block_cnt, ret;
 
+	hdev->cur_sink = NULL;
+	hdev->connect.edid_cached = false;
+
 	ret = edid_read_block(hdev, 0, block0, sizeof(block0));
 	if (ret)
 		return ret;
@@ -106,6 +185,27 @@ int edid_read(struct displayport_device *hdev, u8 **data)
 	block_cnt = block0[EDID_EXTENSION_FLAG] + 1;
 	displayport_info("block_cnt = %d\n", block_cnt);
 
+	if (sink_cache) {
+		sink = edid_sink_lookup(hdev, block0);
+		hdev->cur_sink = sink;
+
+		if (sink->edid && sink->edid_blocks == block_cnt &&
+				!memcmp(sink->edid, block0, sizeof(block0))) {
+			edid = kmemdup(sink->edid, block_cnt * EDID_BLOCK_SIZE,
+					GFP_KERNEL);
+			if (!edid)
+				return -ENOMEM;
+
+			displayport_info("EDID of sink %08x from the cache\n",
+					sink->key);
+			hdev->connect.edid_cached = true;
+			hdev->connect.edid_hits++;
+			*data = edid;
+			return block_cnt;
+		}
+		hdev->connect.edid_misses++;
+	}
+
 	edid = kmalloc(block_cnt * EDID_BLOCK_SIZE, GFP_KERNEL);
 	if (!edid)
 		return -ENOMEM;
@@ -123,6 +223,15 @@ int edid_read(struct displayport_device *hdev, u8 **data)
 		}
 	}
 
+	if (sink) {
+		kfree(sink->edid);
+		sink->edid = kmemdup(edid, block_cnt * EDID_BLOCK_SIZE,
+				GFP_KERNEL);
+		sink->edid_blocks = sink->edid ? block_cnt : 0;
+		if (!sink->edid)
+			hdev->cur_sink = NULL;
+	}
+
 	*data = edid;
 
 	return block_cnt;
@@ -57,6 +57,8 @@ extern int dpp_log_level;
 			&& (config->format <= DECON_PIXEL_FORMAT_YVU422_3P))
 #define is_yuv420(config) ((config->format >= DECON_PIXEL_FORMAT_NV12) \
 			&& (config->format <= DECON_PIXEL_FORMAT_YVU420M))
+#define is_yuv420_fmt(fmt) (((fmt) >= DECON_PIXEL_FORMAT_NV12) \
+			&& ((fmt) <= DECON_PIXEL_FORMAT_YVU420M))
 
 #define dpp_err(fmt, ...)							\
 	do {									\
@@ -136,10 +138,29 @@ struct dpp_resources {
 	int dma_irq;
 };
 
+/*
+ * HDR state of the last configuration. The EOTF, gamut and tone mapping LUTs
+ * only depend on it, so a frame with the same state needs no LUT upload.
+ */
+struct dpp_hdr_stat {
+	bool valid;
+	u32 hdr;
+	u32 min_luminance;
+	u32 max_luminance;
+	u64 configs;
+	u64 uploads;		/* state changed, LUTs are programmed */
+	u64 avoided;		/* state unchanged since the last frame */
+	u64 prog_ns;		/* SFR programming, all frames */
+	u64 prog_max_ns;
+	u64 lut_ns;		/* SFR programming, frames of an upload */
+};
+
 struct dpp_debug {
 	struct timer_list op_timer;
 	u32 done_count;
 	u32 recovery_cnt;
+	struct dpp_hdr_stat hdr;
+	struct dentry *debug_hdr;
 };
 
 struct dpp_config {
@@ -193,6 +214,22 @@ struct dpp_restrictions_info {
 	u32 reserved[4];
 };
 
+/*
+ * Format capability is looked up by rotation class, AFBC, scaling, block
+ * mode and HDR of a layer. It's built once at probe from the attributes.
+ */
+enum dpp_cap_rot {
+	DPP_CAP_ROT_NONE = 0,
+	DPP_CAP_ROT_FLIP,	/* x/y flip and 180 */
+	DPP_CAP_ROT_90,		/* 90 and 270 with or without flip */
+	DPP_CAP_ROT_MAX,
+};
+
+#define DPP_CAP_IDX(rot, comp, scale, block, hdr)		\
+	(((rot) << 4) | (!!(comp) << 3) | (!!(scale) << 2) |	\
+	 (!!(block) << 1) | !!(hdr))
+#define DPP_CAP_CNT		(DPP_CAP_ROT_MAX << 4)
+
 struct dpp_device {
 	int id;
 	int port;
@@ -208,6 +245,7 @@ struct dpp_device {
 	spinlock_t dma_slock;
 	struct mutex lock;
 	struct dpp_restriction restriction;
+	u64 caps[DECON_PIXEL_FORMAT_MAX];
 };
 
 extern struct dpp_device *dpp_drvdata[MAX_DPP_CNT];
@@ -331,5 +369,6 @@ void dpp_dump(struct dpp_device *dpp);
 #define DPP_AFBC_ATTR_ENABLED		_IOR('P', 6, unsigned long)
 #define DPP_GET_PORT_NUM		_IOR('P', 7, unsigned long)
 #define DPP_GET_RESTRICTION		_IOR('P', 8, unsigned long)
+#define DPP_VALIDATE_CONFIG		_IOW('P', 9, struct dpp_config)
 
 #endif /* __SAMSUNG_DPP_H__ */
@@ -16,6 +16,9 @@
 #include <linux/exynos_iovmm.h>
 #include <linux/videodev2_exynos_media.h>
 #include <linux/console.h>
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
 
 #include "dpp.h"
 #include "decon.h"
@@ -24,6 +27,8 @@ int dpp_log_level = 6;
 
 struct dpp_device *dpp_drvdata[MAX_DPP_CNT];
 
+static struct dentry *dpp_debug_root;
+
 void dpp_dump(struct dpp_device *dpp)
 {
 	int acquired = console_trylock();
@@ -303,123 +308,182 @@ static int dpp_check_addr(struct dpp_device *dpp, struct dpp_params_info *p)
 	return 0;
 }
 
-static int dpp_check_format(struct dpp_device *dpp, struct dpp_params_info *p)
+#define dpp_cap_err(verbose, fmt, ...)				\
+	do {							\
+		if (verbose)					\
+			dpp_err(fmt, ##__VA_ARGS__);		\
+	} while (0)
+
+/*
+ * Checks what depends only on the format, rotation, AFBC, scaling, block
+ * mode and HDR of a layer. It's evaluated for every combination at probe
+ * to build the capability table, and again verbosely if a layer misses it.
+ */
+static int dpp_check_caps(struct dpp_device *dpp, struct dpp_params_info *p,
+		bool verbose)
 {
+	bool yuv420 = is_yuv420_fmt(p->format);
+
 	if (!test_bit(DPP_ATTR_ROT, &dpp->attr) && (p->rot > DPP_ROT_180)) {
-		dpp_err("Not support rotation in DPP%d - VGRF only!\n",
+		dpp_cap_err(verbose, "Not support rotation in DPP%d - VGRF only!\n",
 				p->rot);
 		return -EINVAL;
 	}
 
 	if (!test_bit(DPP_ATTR_HDR, &dpp->attr) && (p->hdr > DPP_HDR_OFF)) {
-		dpp_err("Not support hdr in DPP%d - VGRF only!\n",
+		dpp_cap_err(verbose, "Not support hdr in DPP%d - VGRF only!\n",
 				dpp->id);
 		return -EINVAL;
 	}
 
-	if ((p->hdr < DPP_HDR_OFF) || (p->hdr > DPP_HDR_HLG)) {
-		dpp_err("Unsupported HDR standard in DPP%d, HDR std(%d)\n",
-				dpp->id, p->hdr);
-		return -EINVAL;
-	}
-
 	if (!test_bit(DPP_ATTR_CSC, &dpp->attr) &&
 			(p->format >= DECON_PIXEL_FORMAT_NV16)) {
-		dpp_err("Not support YUV format(%d) in DPP%d - VG & VGF only!\n",
+		dpp_cap_err(verbose, "Not support YUV format(%d) in DPP%d - VG & VGF only!\n",
 			p->format, dpp->id);
 		return -EINVAL;
 	}
 
 	if (!test_bit(DPP_ATTR_AFBC, &dpp->attr) && p->is_comp) {
-		dpp_err("Not support AFBC decoding in DPP%d - VGF only!\n",
+		dpp_cap_err(verbose, "Not support AFBC decoding in DPP%d - VGF only!\n",
 				dpp->id);
 		return -EINVAL;
 	}
 
 	if (!test_bit(DPP_ATTR_SCALE, &dpp->attr) && p->is_scale) {
-		dpp_err("Not support SCALING in DPP%d - VGF only!\n", dpp->id);
-		return -EINVAL;
-	}
-
-	return 0;
-}
-
-/*
- * TODO: h/w limitation will be changed in KC
- * This function must be modified for KC after releasing DPP constraints
- */
-static int dpp_check_limitation(struct dpp_device *dpp, struct dpp_params_info *p)
-{
-	int ret;
-	struct dpp_img_format vi;
-
-	ret = dpp_check_scale_ratio(p);
-	if (ret) {
-		dpp_err("failed to set dpp%d scale information\n", dpp->id);
+		dpp_cap_err(verbose, "Not support SCALING in DPP%d - VGF only!\n",
+				dpp->id);
 		return -EINVAL;
 	}
 
-	dpp_select_format(dpp, &vi, p);
-
-	ret = dpp_check_format(dpp, p);
-	if (ret)
-		return -EINVAL;
-
-	ret = dpp_check_addr(dpp, p);
-	if (ret)
-		return -EINVAL;
-
 	if (p->is_comp && p->rot) {
-		dpp_err("Not support [AFBC+ROTATION] at the same time in DPP%d\n",
+		dpp_cap_err(verbose, "Not support [AFBC+ROTATION] at the same time in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
 	if (p->is_comp && p->is_block) {
-		dpp_err("Not support [AFBC+BLOCK] at the same time in DPP%d\n",
+		dpp_cap_err(verbose, "Not support [AFBC+BLOCK] at the same time in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
-	if (p->is_comp && vi.yuv420) {
-		dpp_err("Not support AFBC decoding for YUV format in DPP%d\n",
+	if (p->is_comp && yuv420) {
+		dpp_cap_err(verbose, "Not support AFBC decoding for YUV format in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
 	if (p->is_block && p->is_scale) {
-		dpp_err("Not support [BLOCK+SCALE] at the same time in DPP%d\n",
+		dpp_cap_err(verbose, "Not support [BLOCK+SCALE] at the same time in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
-	if (p->is_block && vi.yuv420) {
-		dpp_err("Not support BLOCK Mode for YUV format in DPP%d\n",
+	if (p->is_block && yuv420) {
+		dpp_cap_err(verbose, "Not support BLOCK Mode for YUV format in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
 	/* FIXME */
 	if (p->is_block && p->rot) {
-		dpp_err("Not support [BLOCK+ROTATION] at the same time in DPP%d\n",
+		dpp_cap_err(verbose, "Not support [BLOCK+ROTATION] at the same time in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
 	/* HDR channel limitation */
 	if ((p->hdr != DPP_HDR_OFF) && p->is_comp) {
-		dpp_err("Not support [HDR+AFBC] at the same time in DPP%d\n",
+		dpp_cap_err(verbose, "Not support [HDR+AFBC] at the same time in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
 	/* HDR channel limitation */
 	if ((p->hdr != DPP_HDR_OFF) && p->rot) {
-		dpp_err("Not support [HDR+ROTATION] at the same time in DPP%d\n",
+		dpp_cap_err(verbose, "Not support [HDR+ROTATION] at the same time in DPP%d\n",
 			dpp->id);
 		return -EINVAL;
 	}
 
+	return 0;
+}
+
+static inline enum dpp_cap_rot dpp_cap_rot(enum dpp_rotate rot)
+{
+	if (rot > DPP_ROT_180)
+		return DPP_CAP_ROT_90;
+	else if (rot != DPP_ROT_NORMAL)
+		return DPP_CAP_ROT_FLIP;
+
+	return DPP_CAP_ROT_NONE;
+}
+
+static void dpp_init_caps(struct dpp_device *dpp)
+{
+	/* representative value of each rotation class */
+	const enum dpp_rotate rot[DPP_CAP_ROT_MAX] = {
+		DPP_ROT_NORMAL, DPP_ROT_180, DPP_ROT_90,
+	};
+	struct dpp_params_info p;
+	u32 fmt, idx;
+
+	memset(&p, 0, sizeof(p));
+
+	for (fmt = 0; fmt < DECON_PIXEL_FORMAT_MAX; fmt++) {
+		dpp->caps[fmt] = 0;
+		p.format = fmt;
+
+		for (idx = 0; idx < DPP_CAP_CNT; idx++) {
+			p.rot = rot[idx >> 4];
+			p.is_comp = !!(idx & BIT(3));
+			p.is_scale = !!(idx & BIT(2));
+			p.is_block = !!(idx & BIT(1));
+			p.hdr = (idx & BIT(0)) ? DPP_HDR_ST2084 : DPP_HDR_OFF;
+
+			if (!dpp_check_caps(dpp, &p, false))
+				dpp->caps[fmt] |= BIT_ULL(idx);
+		}
+	}
+}
+
+/*
+ * TODO: h/w limitation will be changed in KC
+ * This function must be modified for KC after releasing DPP constraints
+ */
+static int dpp_check_limitation(struct dpp_device *dpp, struct dpp_params_info *p)
+{
+	int ret;
+	struct dpp_img_format vi;
+	u32 idx;
+
+	ret = dpp_check_scale_ratio(p);
+	if (ret) {
+		dpp_err("failed to set dpp%d scale information\n", dpp->id);
+		return -EINVAL;
+	}
+
+	if ((p->hdr < DPP_HDR_OFF) || (p->hdr > DPP_HDR_HLG)) {
+		dpp_err("Unsupported HDR standard in DPP%d, HDR std(%d)\n",
+				dpp->id, p->hdr);
+		return -EINVAL;
+	}
+
+	if (p->format >= DECON_PIXEL_FORMAT_MAX) {
+		dpp_err("Unsupported format(%d) in DPP%d\n", p->format, dpp->id);
+		return -EINVAL;
+	}
+
+	dpp_select_format(dpp, &vi, p);
+
+	idx = DPP_CAP_IDX(dpp_cap_rot(p->rot), p->is_comp, p->is_scale,
+			p->is_block, p->hdr != DPP_HDR_OFF);
+	if (!(dpp->caps[p->format] & BIT_ULL(idx))) {
+		/* evaluate again only to tell the reason */
+		dpp_check_caps(dpp, p, true);
+		return -EINVAL;
+	}
+
 	ret = dpp_check_size(dpp, &vi);
 	if (ret)
 		return -EINVAL;
@@ -439,13 +503,57 @@ static int dpp_afbc_enabled(struct dpp_device *dpp, int *afbc_enabled)
 	return ret;
 }
 
-static int dpp_set_config(struct dpp_device *dpp)
+/* Returns true if the LUTs of @p differ from the ones of the last frame */
+static bool dpp_hdr_changed(struct dpp_device *dpp, struct dpp_params_info *p)
+{
+	struct dpp_hdr_stat *stat = &dpp->d.hdr;
+	bool changed;
+
+	if (!test_bit(DPP_ATTR_HDR, &dpp->attr))
+		return false;
+
+	changed = !stat->valid || stat->hdr != p->hdr;
+	/* luminances only matter to the tone mapping of HDR layers */
+	if (p->hdr != DPP_HDR_OFF)
+		changed |= stat->min_luminance != p->min_luminance ||
+			stat->max_luminance != p->max_luminance;
+
+	stat->valid = true;
+	stat->hdr = p->hdr;
+	stat->min_luminance = p->min_luminance;
+	stat->max_luminance = p->max_luminance;
+
+	stat->configs++;
+	if (changed)
+		stat->uploads++;
+	else
+		stat->avoided++;
+
+	return changed;
+}
+
+static void dpp_hdr_account(struct dpp_device *dpp, bool changed, s64 ns)
+{
+	struct dpp_hdr_stat *stat = &dpp->d.hdr;
+
+	stat->prog_ns += ns;
+	if (ns > stat->prog_max_ns)
+		stat->prog_max_ns = ns;
+	if (changed)
+		stat->lut_ns += ns;
+}
+
+static int dpp_set_config(struct dpp_device *dpp, struct dpp_config *config)
 {
 	struct dpp_params_info params;
+	bool hdr_changed;
+	ktime_t start;
 	int ret = 0;
 
 	mutex_lock(&dpp->lock);
 
+	dpp->dpp_config = config;
+
 	/* parameters from decon driver are translated for dpp driver */
 	dpp_get_params(dpp, &params);
 
@@ -454,9 +562,15 @@ static int dpp_set_config(struct dpp_device *dpp)
 	if (ret)
 		goto err;
 
+	ret = dpp_check_addr(dpp, &params);
+	if (ret)
+		goto err;
+
 	if (dpp->state == DPP_STATE_OFF) {
 		dpp_dbg("dpp%d is started\n", dpp->id);
 		dpp_reg_init(dpp->id, dpp->attr);
+		/* LUTs are lost with the power of the DPP */
+		dpp->d.hdr.valid = false;
 
 		enable_irq(dpp->res.dma_irq);
 		if (test_bit(DPP_ATTR_DPP, &dpp->attr))
@@ -464,7 +578,11 @@ static int dpp_set_config(struct dpp_device *dpp)
 	}
 
 	/* set all parameters to dpp hw */
+	hdr_changed = dpp_hdr_changed(dpp, &params);
+	start = ktime_get();
 	dpp_reg_configure_params(dpp->id, &params, dpp->attr);
+	dpp_hdr_account(dpp, hdr_changed, ktime_to_ns(ktime_sub(ktime_get(),
+					start)));
 
 	dpp->d.op_timer.expires = (jiffies + 1 * HZ);
 	mod_timer(&dpp->d.op_timer, dpp->d.op_timer.expires);
@@ -481,6 +599,28 @@ err:
 	return ret;
 }
 
+/* Checks the configuration against h/w limitation without applying it */
+static int dpp_validate_config(struct dpp_device *dpp, struct dpp_config *config)
+{
+	struct dpp_config *cur_config;
+	struct dpp_params_info params;
+	int ret;
+
+	mutex_lock(&dpp->lock);
+
+	cur_config = dpp->dpp_config;
+	dpp->dpp_config = config;
+
+	dpp_get_params(dpp, &params);
+	ret = dpp_check_limitation(dpp, &params);
+
+	dpp->dpp_config = cur_config;
+
+	mutex_unlock(&dpp->lock);
+
+	return ret;
+}
+
 static int dpp_stop(struct dpp_device *dpp, bool reset)
 {
 	int ret = 0;
@@ -518,12 +658,20 @@ static long dpp_subdev_ioctl(struct v4l2_subdev *sd, unsigned int cmd, void *arg
 
 	switch (cmd) {
 	case DPP_WIN_CONFIG:
-		dpp->dpp_config = (struct dpp_config *)arg;
-		ret = dpp_set_config(dpp);
+		ret = dpp_set_config(dpp, (struct dpp_config *)arg);
 		if (ret)
 			dpp_err("failed to configure dpp%d\n", dpp->id);
 		break;
 
+	case DPP_VALIDATE_CONFIG:
+		if (!arg) {
+			dpp_err("failed to get dpp config to validate\n");
+			ret = -EINVAL;
+			break;
+		}
+		ret = dpp_validate_config(dpp, (struct dpp_config *)arg);
+		break;
+
 	case DPP_STOP:
 		ret = dpp_stop(dpp, reset);
 		if (ret)
@@ -715,6 +863,8 @@ static void dpp_parse_dt(struct dpp_device *dpp, struct device *dev)
 		dpp_print_restriction(dpp);
 	}
 
+	dpp_init_caps(dpp);
+
 	dpp->dev = dev;
 }
 
@@ -887,6 +1037,64 @@ static int dpp_init_resources(struct dpp_device *dpp, struct platform_device *pd
 	return 0;
 }
 
+static int dpp_debug_hdr_show(struct seq_file *s, void *unused)
+{
+	struct dpp_device *dpp = s->private;
+	struct dpp_hdr_stat stat;
+
+	mutex_lock(&dpp->lock);
+	stat = dpp->d.hdr;
+	mutex_unlock(&dpp->lock);
+
+	seq_printf(s, "configs: %llu\n", stat.configs);
+	seq_printf(s, "lut uploads: %llu\n", stat.uploads);
+	seq_printf(s, "lut uploads avoided: %llu\n", stat.avoided);
+	seq_printf(s, "programming avg/max(ns): %llu %llu\n",
+			stat.configs ? div64_u64(stat.prog_ns, stat.configs) : 0,
+			stat.prog_max_ns);
+	seq_printf(s, "programming with lut avg(ns): %llu\n",
+			stat.uploads ? div64_u64(stat.lut_ns, stat.uploads) : 0);
+	if (stat.valid)
+		seq_printf(s, "last hdr: %u luminance: %u-%u\n", stat.hdr,
+				stat.min_luminance, stat.max_luminance);
+
+	return 0;
+}
+
+static int dpp_debug_hdr_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, dpp_debug_hdr_show, inode->i_private);
+}
+
+static const struct file_operations dpp_hdr_fops = {
+	.open = dpp_debug_hdr_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static void dpp_create_debugfs(struct dpp_device *dpp)
+{
+	char name[16];
+
+	if (!test_bit(DPP_ATTR_HDR, &dpp->attr))
+		return;
+
+	if (!dpp_debug_root) {
+		dpp_debug_root = debugfs_create_dir("dpp", NULL);
+		if (!dpp_debug_root) {
+			dpp_err("failed to create debugfs root directory\n");
+			return;
+		}
+	}
+
+	snprintf(name, sizeof(name), "hdr_stat%d", dpp->id);
+	dpp->d.debug_hdr = debugfs_create_file(name, 0444, dpp_debug_root,
+			dpp, &dpp_hdr_fops);
+	if (!dpp->d.debug_hdr)
+		dpp_err("failed to create hdr stat file(%d)\n", dpp->id);
+}
+
 static int dpp_probe(struct platform_device *pdev)
 {
 	struct device *dev = &pdev->dev;
@@ -914,6 +1122,7 @@ static int dpp_probe(struct platform_device *pdev)
 	dpp_init_subdev(dpp);
 	platform_set_drvdata(pdev, dpp);
 	setup_timer(&dpp->d.op_timer, dpp_op_timer_handler, (unsigned long)dpp);
+	dpp_create_debugfs(dpp);
 
 	dpp->state = DPP_STATE_OFF;
 	dpp_info("dpp%d is probed successfully\n", dpp->id);
@@ -540,8 +540,12 @@ void DPU_EVENT_SHOW(struct seq_file *s, struct decon_device *decon)
 	if (!decon->id)
 		seq_printf(s, "-- Total underrun count(%d)\n",
 				dsim->total_underrun_cnt);
-	seq_printf(s, "-- Hibernation enter/exit count(%d %d)\n",
-			decon->hiber.enter_cnt, decon->hiber.exit_cnt);
+	seq_printf(s, "-- Hibernation enter/exit/abort count(%d %d %d)\n",
+			decon->hiber.enter_cnt, decon->hiber.exit_cnt,
+			decon->hiber.abort_cnt);
+	seq_printf(s, "-- Hibernation frame interval(%dus) enter/exit time(%dus %dus)\n",
+			decon->hiber.frame_interval, decon->hiber.enter_time,
+			decon->hiber.exit_time);
 	seq_puts(s, "-------------------------------------------------------------\n");
 	seq_printf(s, "%14s  %20s  %20s\n",
 		"Time", "Event ID", "Remarks");
@@ -807,6 +811,35 @@ static const struct file_operations decon_bts_fops = {
 	.release = seq_release,
 };
 
+static int decon_debug_bts_stat_show(struct seq_file *s, void *unused)
+{
+#if defined(CONFIG_EXYNOS_BTS)
+	struct decon_device *decon = s->private;
+	struct decon_bts *bts = &decon->bts;
+
+	seq_printf(s, "calc: %u, cached: %u, avg time: %llu ns\n",
+			bts->calc_cnt, bts->calc_hit,
+			bts->calc_cnt ? div_u64(bts->calc_time, bts->calc_cnt) : 0);
+	seq_printf(s, "request: %u, elided: %u\n",
+			bts->req_cnt, bts->req_elided);
+	seq_printf(s, "total bw: %u, peak: %u, disp freq: %u\n",
+			bts->total_bw, bts->peak, bts->max_disp_freq);
+#endif
+	return 0;
+}
+
+static int decon_debug_bts_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, decon_debug_bts_stat_show, inode->i_private);
+}
+
+static const struct file_operations decon_bts_stat_fops = {
+	.open = decon_debug_bts_stat_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 static int decon_debug_win_show(struct seq_file *s, void *unused)
 {
 	seq_printf(s, "%u\n", win_update_log_level);
@@ -850,6 +883,61 @@ static const struct file_operations decon_win_fops = {
 	.release = seq_release,
 };
 
+static int decon_debug_win_auto_show(struct seq_file *s, void *unused)
+{
+	struct decon_device *decon = get_decon_drvdata(0);
+
+	seq_printf(s, "auto(%s) auto_cnt(%u) saved_pixels(%llu)\n",
+			decon->win_up.auto_enabled ? "on" : "off",
+			decon->win_up.auto_cnt, decon->win_up.saved_pixels);
+
+	return 0;
+}
+
+static int decon_debug_win_auto_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, decon_debug_win_auto_show, inode->i_private);
+}
+
+static ssize_t decon_debug_win_auto_write(struct file *file, const char __user *buf,
+		size_t count, loff_t *f_ops)
+{
+	struct decon_device *decon;
+	char *buf_data;
+	int ret;
+	unsigned int auto_enabled;
+
+	buf_data = kmalloc(count, GFP_KERNEL);
+	if (buf_data == NULL)
+		return count;
+
+	ret = copy_from_user(buf_data, buf, count);
+	if (ret < 0)
+		goto out;
+
+	ret = sscanf(buf_data, "%u", &auto_enabled);
+	if (ret < 0)
+		goto out;
+
+	decon = get_decon_drvdata(0);
+	mutex_lock(&decon->lock);
+	decon->win_up.auto_enabled = decon->win_up.enabled && auto_enabled;
+	decon->win_up.prev_valid = false;
+	mutex_unlock(&decon->lock);
+
+out:
+	kfree(buf_data);
+	return count;
+}
+
+static const struct file_operations decon_win_auto_fops = {
+	.open = decon_debug_win_auto_open,
+	.write = decon_debug_win_auto_write,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = seq_release,
+};
+
 static int decon_debug_mres_show(struct seq_file *s, void *unused)
 {
 	seq_printf(s, "%u\n", dpu_mres_log_level);
@@ -1172,6 +1260,107 @@ static const struct file_operations decon_low_persistence_fops = {
 	.release = seq_release,
 };
 
+static int decon_debug_up_stat_show(struct seq_file *s, void *unused)
+{
+	struct decon_device *decon = s->private;
+	struct decon_up_stat *stat;
+	int latest = atomic_read(&decon->up.stat_idx);
+	int i, idx;
+
+	if (latest < 0)
+		return 0;
+
+	seq_puts(s, "[ start time ] fence(us) bts(us) regs(us) done(us) total(us)\n");
+
+	for (i = min(latest, DECON_UP_STAT_MAX - 1); i >= 0; i--) {
+		idx = (latest - i) & (DECON_UP_STAT_MAX - 1);
+		stat = &decon->up.stat[idx];
+
+		seq_printf(s, "[%12lld] %9lld %7lld ", ktime_to_us(stat->start),
+				ktime_us_delta(stat->fence, stat->start),
+				ktime_us_delta(stat->bts, stat->fence));
+		/* regs is not stamped if windows are cleared */
+		if (ktime_to_ns(stat->regs))
+			seq_printf(s, "%8lld %8lld ",
+				ktime_us_delta(stat->regs, stat->bts),
+				ktime_us_delta(stat->done, stat->regs));
+		else
+			seq_printf(s, "%8s %8lld ", "-",
+				ktime_us_delta(stat->done, stat->bts));
+		seq_printf(s, "%9lld\n", ktime_us_delta(stat->done, stat->start));
+	}
+
+	return 0;
+}
+
+static int decon_debug_up_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, decon_debug_up_stat_show, inode->i_private);
+}
+
+static const struct file_operations decon_up_stat_fops = {
+	.open = decon_debug_up_stat_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int decon_debug_up_thread_show(struct seq_file *s, void *unused)
+{
+	struct decon_device *decon = s->private;
+
+	seq_printf(s, "%d %*pbl\n", decon->up.prio,
+			cpumask_pr_args(&decon->up.cpus));
+
+	return 0;
+}
+
+static int decon_debug_up_thread_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, decon_debug_up_thread_show, inode->i_private);
+}
+
+/* "<fifo priority> [cpu list]", e.g. "20 4-7". priority 0 means SCHED_NORMAL */
+static ssize_t decon_debug_up_thread_write(struct file *file, const char __user *buf,
+		size_t count, loff_t *f_ops)
+{
+	struct decon_device *decon = ((struct seq_file *)file->private_data)->private;
+	char buf_data[64];
+	char cpulist[48] = "";
+	cpumask_t cpus;
+	int prio, ret;
+
+	if (count >= sizeof(buf_data))
+		return -EINVAL;
+
+	if (copy_from_user(buf_data, buf, count))
+		return -EFAULT;
+	buf_data[count] = '\0';
+
+	ret = sscanf(buf_data, "%d %47s", &prio, cpulist);
+	if (ret < 1)
+		return -EINVAL;
+
+	if (ret < 2)
+		cpumask_copy(&cpus, &decon->up.cpus);
+	else if (cpulist_parse(cpulist, &cpus))
+		return -EINVAL;
+
+	ret = decon_set_update_thread_policy(decon, prio, &cpus);
+	if (ret)
+		return ret;
+
+	return count;
+}
+
+static const struct file_operations decon_up_thread_fops = {
+	.open = decon_debug_up_thread_open,
+	.write = decon_debug_up_thread_write,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 int decon_create_debugfs(struct decon_device *decon)
 {
 	char name[MAX_NAME_SIZE];
@@ -1229,6 +1418,33 @@ int decon_create_debugfs(struct decon_device *decon)
 		goto err_debugfs;
 	}
 
+	snprintf(name, MAX_NAME_SIZE, "bts_stat%d", decon->id);
+	decon->d.debug_bts_stat = debugfs_create_file(name, 0444,
+			decon->d.debug_root, decon, &decon_bts_stat_fops);
+	if (!decon->d.debug_bts_stat) {
+		decon_err("failed to create bts stat file(%d)\n", decon->id);
+		ret = -ENOENT;
+		goto err_debugfs;
+	}
+
+	snprintf(name, MAX_NAME_SIZE, "update_stat%d", decon->id);
+	decon->d.debug_up_stat = debugfs_create_file(name, 0444,
+			decon->d.debug_root, decon, &decon_up_stat_fops);
+	if (!decon->d.debug_up_stat) {
+		decon_err("failed to create update stat file(%d)\n", decon->id);
+		ret = -ENOENT;
+		goto err_debugfs;
+	}
+
+	snprintf(name, MAX_NAME_SIZE, "update_thread%d", decon->id);
+	decon->d.debug_up_thread = debugfs_create_file(name, 0644,
+			decon->d.debug_root, decon, &decon_up_thread_fops);
+	if (!decon->d.debug_up_thread) {
+		decon_err("failed to create update thread file(%d)\n", decon->id);
+		ret = -ENOENT;
+		goto err_debugfs;
+	}
+
 	if (decon->id == 0) {
 		decon->d.debug_bts = debugfs_create_file("bts_log", 0444,
 				decon->d.debug_root, NULL, &decon_bts_fops);
@@ -1244,6 +1460,13 @@ int decon_create_debugfs(struct decon_device *decon)
 			ret = -ENOENT;
 			goto err_debugfs;
 		}
+		decon->d.debug_win_auto = debugfs_create_file("win_update_auto", 0444,
+				decon->d.debug_root, NULL, &decon_win_auto_fops);
+		if (!decon->d.debug_win_auto) {
+			decon_err("failed to create win update auto file\n");
+			ret = -ENOENT;
+			goto err_debugfs;
+		}
 		decon->d.debug_mres = debugfs_create_file("mres_log", 0444,
 				decon->d.debug_root, NULL, &decon_mres_fops);
 		if (!decon->d.debug_mres) {
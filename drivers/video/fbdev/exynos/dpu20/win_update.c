@@ -9,12 +9,143 @@
  * published by the Free Software Foundation.
 */
 
+#include <linux/dma-buf.h>
 #include <video/mipi_display.h>
 
 #include "decon.h"
 #include "dpp.h"
 #include "dsim.h"
 
+static void win_update_dst_rect(struct decon_win_config *config,
+		struct decon_rect *r)
+{
+	r->left = config->dst.x;
+	r->top = config->dst.y;
+	r->right = config->dst.x + config->dst.w - 1;
+	r->bottom = config->dst.y + config->dst.h - 1;
+}
+
+static void win_update_union(struct decon_rect *damage, bool *damaged,
+		struct decon_rect *r)
+{
+	if (!*damaged) {
+		*damage = *r;
+		*damaged = true;
+		return;
+	}
+
+	damage->left = min(damage->left, r->left);
+	damage->top = min(damage->top, r->top);
+	damage->right = max(damage->right, r->right);
+	damage->bottom = max(damage->bottom, r->bottom);
+}
+
+/*
+ * A window is unchanged if it has the same configuration and buffer and
+ * no acquire fence, i.e. nothing has been rendered to the buffer again.
+ */
+static bool win_update_is_changed(struct decon_win_config *cur,
+		struct decon_win_config *prev, struct dma_buf *cur_buf,
+		struct dma_buf *prev_buf)
+{
+	struct decon_win_config c = *cur, p = *prev;
+
+	if (cur->state == DECON_WIN_STATE_BUFFER) {
+		if (cur->acq_fence >= 0 || !cur_buf || cur_buf != prev_buf)
+			return true;
+
+		memset(c.fd_idma, 0, sizeof(c.fd_idma));
+		memset(p.fd_idma, 0, sizeof(p.fd_idma));
+		c.acq_fence = p.acq_fence = 0;
+		c.rel_fence = p.rel_fence = 0;
+	}
+
+	return memcmp(&c, &p, sizeof(c)) != 0;
+}
+
+/*
+ * Find the union of damage from previous frame and fill it in as user
+ * requested update region. Window which is changed, added or removed
+ * damages its current and previous destination.
+ */
+static void win_update_auto_region(struct decon_device *decon,
+		struct decon_win_config *win_config)
+{
+	struct decon_win_update *win_up = &decon->win_up;
+	struct decon_win_config *update_config = &win_config[DECON_WIN_UPDATE_IDX];
+	struct decon_win_config *config, *prev;
+	struct dma_buf *buf[MAX_DECON_WIN];
+	struct decon_rect damage, r;
+	bool damaged = false, valid = true;
+	int i;
+
+	for (i = 0; i < decon->dt.max_win; i++) {
+		config = &win_config[i];
+		buf[i] = NULL;
+
+		switch (config->state) {
+		case DECON_WIN_STATE_DISABLED:
+		case DECON_WIN_STATE_COLOR:
+			break;
+		case DECON_WIN_STATE_BUFFER:
+			buf[i] = dma_buf_get(config->fd_idma[0]);
+			if (IS_ERR(buf[i]))
+				buf[i] = NULL;
+			else
+				dma_buf_put(buf[i]);
+			break;
+		default:
+			/* cursor and the others are updated asynchronously */
+			valid = false;
+			break;
+		}
+	}
+
+	if (!valid || !win_up->prev_valid ||
+			update_config->state == DECON_WIN_STATE_UPDATE)
+		goto save;
+
+	for (i = 0; i < decon->dt.max_win; i++) {
+		config = &win_config[i];
+		prev = &win_up->prev_config[i];
+
+		if (!win_update_is_changed(config, prev, buf[i], win_up->prev_buf[i]))
+			continue;
+
+		if (config->state != DECON_WIN_STATE_DISABLED) {
+			win_update_dst_rect(config, &r);
+			win_update_union(&damage, &damaged, &r);
+		}
+		if (prev->state != DECON_WIN_STATE_DISABLED) {
+			win_update_dst_rect(prev, &r);
+			win_update_union(&damage, &damaged, &r);
+		}
+	}
+
+	if (damaged) {
+		memset(update_config, 0, sizeof(struct decon_win_config));
+		update_config->state = DECON_WIN_STATE_UPDATE;
+		update_config->dst.x = max(damage.left, 0);
+		update_config->dst.y = max(damage.top, 0);
+		update_config->dst.w = min_t(int, damage.right,
+				decon->lcd_info->xres - 1) - update_config->dst.x + 1;
+		update_config->dst.h = min_t(int, damage.bottom,
+				decon->lcd_info->yres - 1) - update_config->dst.y + 1;
+		win_up->auto_cnt++;
+
+		DPU_DEBUG_WIN("auto update region[%d %d %d %d]\n",
+				update_config->dst.x, update_config->dst.y,
+				update_config->dst.w, update_config->dst.h);
+	}
+
+save:
+	win_up->prev_valid = valid;
+	for (i = 0; i < decon->dt.max_win; i++) {
+		win_up->prev_config[i] = win_config[i];
+		win_up->prev_buf[i] = buf[i];
+	}
+}
+
 static void win_update_adjust_region(struct decon_device *decon,
 		struct decon_win_config *win_config,
 		struct decon_reg_data *regs)
@@ -337,6 +468,7 @@ void dpu_prepare_win_update_config(struct decon_device *decon,
 
 	/* If LCD resolution is changed, window update is ignored */
 	if (dpu_need_mres_config(decon, win_config, regs)) {
+		decon->win_up.prev_valid = false;
 		regs->up_region.left = 0;
 		regs->up_region.top = 0;
 		regs->up_region.right = regs->lcd_width - 1;
@@ -344,12 +476,22 @@ void dpu_prepare_win_update_config(struct decon_device *decon,
 		return;
 	}
 
+	if (decon->win_up.auto_enabled)
+		win_update_auto_region(decon, win_config);
+	else
+		decon->win_up.prev_valid = false;
+
 	/* find adjusted update region on LCD */
 	win_update_adjust_region(decon, win_config, regs);
 
 	/* check DPP hw limitation if violated, update region is changed to full */
 	win_update_check_limitation(decon, win_config, regs);
 
+	decon->win_up.saved_pixels += (u64)decon->lcd_info->xres *
+			decon->lcd_info->yres -
+			(u64)(regs->up_region.right - regs->up_region.left + 1) *
+			(regs->up_region.bottom - regs->up_region.top + 1);
+
 	/*
 	 * If update region is changed, need_update flag is set.
 	 * That means hw configuration is needed
@@ -649,6 +791,7 @@ void dpu_init_win_update(struct decon_device *decon)
 			decon->win_up.hori_cnt, decon->win_up.verti_cnt);
 
 	decon->win_up.enabled = true;
+	decon->win_up.auto_enabled = true;
 
 	decon->mres_enabled = false;
 	if (!IS_ENABLED(CONFIG_EXYNOS_MULTIRESOLUTION)) {
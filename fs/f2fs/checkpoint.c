@@ -1108,6 +1108,36 @@ static bool __need_flush_quota(struct f2fs_sb_info *sbi)
 	return false;
 }
 
+static void __record_cp_stage(struct f2fs_sb_info *sbi, int stage, u64 ns)
+{
+	u64 us = div_u64(ns, NSEC_PER_USEC);
+
+	sbi->cp_stage_time[stage] = us;
+	if (sbi->cp_stage_max[stage] < us)
+		sbi->cp_stage_max[stage] = us;
+}
+
+/*
+ * Writes back dirty node pages while the checkpoint flushes data pages and
+ * quota, so that most of them are done before FS operations are blocked.
+ * Node pages dirtied after this are left to block_operations().
+ */
+void f2fs_cp_node_flush_work(struct work_struct *work)
+{
+	struct f2fs_sb_info *sbi = container_of(work, struct f2fs_sb_info,
+							cp_node_work);
+	struct writeback_control wbc = {
+		.sync_mode = WB_SYNC_NONE,
+		.nr_to_write = LONG_MAX,
+		.for_reclaim = 0,
+	};
+	struct blk_plug plug;
+
+	blk_start_plug(&plug);
+	f2fs_sync_node_pages(sbi, &wbc, false, FS_CP_NODE_IO);
+	blk_finish_plug(&plug);
+}
+
 /*
  * Freeze all the FS-operations for checkpoint.
  */
@@ -1120,9 +1150,13 @@ static int block_operations(struct f2fs_sb_info *sbi)
 	};
 	struct blk_plug plug;
 	int err = 0, cnt = 0;
+	u64 node_time = 0, start;
 
 	blk_start_plug(&plug);
 
+	if (get_pages(sbi, F2FS_DIRTY_NODES))
+		queue_work(system_unbound_wq, &sbi->cp_node_work);
+
 	/*
 	 * Let's flush inline_data in dirty node pages.
 	 */
@@ -1134,6 +1168,7 @@ retry_flush_quotas:
 
 		if (++cnt > DEFAULT_RETRY_QUOTA_FLUSH_COUNT) {
 			set_sbi_flag(sbi, SBI_QUOTA_SKIP_FLUSH);
+			flush_work(&sbi->cp_node_work);
 			f2fs_lock_all(sbi);
 			goto retry_flush_dents;
 		}
@@ -1146,6 +1181,9 @@ retry_flush_quotas:
 			up_read(&sbi->sb->s_umount);
 	}
 
+	/* don't block FS operations until the node flush is done */
+	flush_work(&sbi->cp_node_work);
+
 	f2fs_lock_all(sbi);
 	if (__need_flush_quota(sbi)) {
 		f2fs_unlock_all(sbi);
@@ -1193,9 +1231,11 @@ retry_flush_nodes:
 
 	if (get_pages(sbi, F2FS_DIRTY_NODES)) {
 		up_write(&sbi->node_write);
+		start = local_clock();
 		atomic_inc(&sbi->wb_sync_req[NODE]);
 		err = f2fs_sync_node_pages(sbi, &wbc, false, FS_CP_NODE_IO);
 		atomic_dec(&sbi->wb_sync_req[NODE]);
+		node_time += local_clock() - start;
 		if (err) {
 			up_write(&sbi->node_change);
 			f2fs_unlock_all(sbi);
@@ -1212,7 +1252,9 @@ retry_flush_nodes:
 	 */
 	__prepare_cp_block(sbi);
 	up_write(&sbi->node_change);
+	__record_cp_stage(sbi, CP_STAGE_FLUSH_NODES, node_time);
 out:
+	flush_work(&sbi->cp_node_work);
 	blk_finish_plug(&plug);
 	return err;
 }
@@ -1539,6 +1581,7 @@ int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc)
 {
 	struct f2fs_checkpoint *ckpt = F2FS_CKPT(sbi);
 	unsigned long long ckpt_ver;
+	u64 start;
 	int err = 0;
 
 	if (unlikely(is_sbi_flag_set(sbi, SBI_CP_DISABLED))) {
@@ -1564,9 +1607,11 @@ int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc)
 
 	trace_f2fs_write_checkpoint(sbi->sb, cpc->reason, "start block_ops");
 
+	start = local_clock();
 	err = block_operations(sbi);
 	if (err)
 		goto out;
+	__record_cp_stage(sbi, CP_STAGE_BLOCK_OPS, local_clock() - start);
 
 	trace_f2fs_write_checkpoint(sbi->sb, cpc->reason, "finish block_ops");
 
@@ -1598,14 +1643,18 @@ int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc)
 	ckpt->checkpoint_ver = cpu_to_le64(++ckpt_ver);
 
 	/* write cached NAT/SIT entries to NAT/SIT area */
+	start = local_clock();
 	err = f2fs_flush_nat_entries(sbi, cpc);
 	if (err)
 		goto stop;
 
 	f2fs_flush_sit_entries(sbi, cpc);
+	__record_cp_stage(sbi, CP_STAGE_FLUSH_META, local_clock() - start);
 
 	/* unlock all the fs_lock[] in do_checkpoint() */
+	start = local_clock();
 	err = do_checkpoint(sbi, cpc);
+	__record_cp_stage(sbi, CP_STAGE_WRITE_CP, local_clock() - start);
 	if (err)
 		f2fs_release_discard_addrs(sbi);
 	else
@@ -38,6 +38,9 @@ static void update_general_status(struct f2fs_sb_info *sbi)
 	si->ext_tree = atomic_read(&sbi->total_ext_tree);
 	si->zombie_tree = atomic_read(&sbi->total_zombie_tree);
 	si->ext_node = atomic_read(&sbi->total_ext_node);
+	si->hit_retain = atomic64_read(&sbi->read_hit_retain);
+	si->retain_tree = atomic_read(&sbi->total_retain_tree);
+	si->retain_node = atomic_read(&sbi->total_retain_node);
 	si->ndirty_node = get_pages(sbi, F2FS_DIRTY_NODES);
 	si->ndirty_dent = get_pages(sbi, F2FS_DIRTY_DENTS);
 	si->ndirty_meta = get_pages(sbi, F2FS_DIRTY_META);
@@ -108,6 +111,9 @@ static void update_general_status(struct f2fs_sb_info *sbi)
 	si->other_skip_bggc = sbi->other_skip_bggc;
 	si->skipped_atomic_files[BG_GC] = sbi->skipped_atomic_files[BG_GC];
 	si->skipped_atomic_files[FG_GC] = sbi->skipped_atomic_files[FG_GC];
+	si->skipped_young_secs = sbi->skipped_young_secs;
+	si->gc_moved_blks = sbi->gc_moved_blks;
+	si->gc_moved_invalid = sbi->gc_moved_invalid;
 	si->util_free = (int)(free_user_blocks(sbi) >> sbi->log_blocks_per_seg)
 		* 100 / (int)(sbi->user_block_count >> sbi->log_blocks_per_seg)
 		/ 2;
@@ -361,6 +367,10 @@ static int stat_show(struct seq_file *s, void *v)
 				si->skipped_atomic_files[BG_GC] +
 				si->skipped_atomic_files[FG_GC],
 				si->skipped_atomic_files[BG_GC]);
+		seq_printf(s, "Skipped : young section (BG) %llu\n",
+				si->skipped_young_secs);
+		seq_printf(s, "GC moved : %llu blocks, invalidated: %llu\n",
+				si->gc_moved_blks, si->gc_moved_invalid);
 		seq_printf(s, "BG skip : IO: %u, Other: %u\n",
 				si->io_skip_bggc, si->other_skip_bggc);
 		seq_puts(s, "\nExtent Cache:\n");
@@ -373,6 +383,11 @@ static int stat_show(struct seq_file *s, void *v)
 				si->hit_total, si->total_ext);
 		seq_printf(s, "  - Inner Struct Count: tree: %d(%d), node: %d\n",
 				si->ext_tree, si->zombie_tree, si->ext_node);
+		seq_printf(s, "  - Miss Count: %llu\n",
+				si->total_ext - si->hit_total);
+		seq_printf(s, "  - Retained: tree: %d, node: %d, hit: %llu\n",
+				si->retain_tree, si->retain_node,
+				si->hit_retain);
 		seq_puts(s, "\nBalancing F2FS Async:\n");
 		seq_printf(s, "  - IO_R (Data: %4d, Node: %4d, Meta: %4d\n",
 			   si->nr_rd_data, si->nr_rd_node, si->nr_rd_meta);
@@ -482,6 +497,7 @@ int f2fs_build_stats(struct f2fs_sb_info *sbi)
 	atomic64_set(&sbi->read_hit_rbtree, 0);
 	atomic64_set(&sbi->read_hit_largest, 0);
 	atomic64_set(&sbi->read_hit_cached, 0);
+	atomic64_set(&sbi->read_hit_retain, 0);
 
 	atomic_set(&sbi->inline_xattr, 0);
 	atomic_set(&sbi->inline_inode, 0);
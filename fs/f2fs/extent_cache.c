@@ -219,6 +219,8 @@ static struct extent_node *__attach_extent_node(struct f2fs_sb_info *sbi,
 	rb_insert_color_cached(&en->rb_node, &et->root, leftmost);
 	atomic_inc(&et->node_cnt);
 	atomic_inc(&sbi->total_ext_node);
+	if (et->retain)
+		atomic_inc(&sbi->total_retain_node);
 	return en;
 }
 
@@ -228,6 +230,8 @@ static void __detach_extent_node(struct f2fs_sb_info *sbi,
 	rb_erase_cached(&en->rb_node, &et->root);
 	atomic_dec(&et->node_cnt);
 	atomic_dec(&sbi->total_ext_node);
+	if (et->retain)
+		atomic_dec(&sbi->total_retain_node);
 
 	if (et->cached_en == en)
 		et->cached_en = NULL;
@@ -315,6 +319,32 @@ static unsigned int __free_extent_tree(struct f2fs_sb_info *sbi,
 	return count - atomic_read(&et->node_cnt);
 }
 
+/*
+ * Retained trees hold the precached, usually fragmented map of files read
+ * randomly, so that lookups don't fall back to node pages. They are kept
+ * against the shrinker and across inode eviction within max_retain_ext_node.
+ */
+static bool __may_retain_extent(struct f2fs_sb_info *sbi,
+					struct extent_tree *et)
+{
+	if (!et->retain || is_sbi_flag_set(sbi, SBI_IS_CLOSE))
+		return false;
+
+	return atomic_read(&sbi->total_retain_node) <=
+					sbi->max_retain_ext_node;
+}
+
+static void __unretain_extent_tree(struct f2fs_sb_info *sbi,
+					struct extent_tree *et)
+{
+	if (!et->retain)
+		return;
+
+	et->retain = false;
+	atomic_sub(atomic_read(&et->node_cnt), &sbi->total_retain_node);
+	atomic_dec(&sbi->total_retain_tree);
+}
+
 static void __drop_largest_extent(struct extent_tree *et,
 					pgoff_t fofs, unsigned int len)
 {
@@ -405,6 +435,8 @@ static bool f2fs_lookup_extent_tree(struct inode *inode, pgoff_t pgofs,
 		stat_inc_cached_node_hit(sbi);
 	else
 		stat_inc_rbtree_node_hit(sbi);
+	if (et->retain)
+		stat_inc_retain_node_hit(sbi);
 
 	*ei = en->ei;
 	spin_lock(&sbi->extent_lock);
@@ -605,8 +637,11 @@ static void f2fs_update_extent_tree_range(struct inode *inode,
 			__insert_extent_tree(sbi, et, &ei,
 					insert_p, insert_parent, leftmost);
 
-		/* give up extent_cache, if split and small updates happen */
-		if (dei.len >= 1 &&
+		/*
+		 * give up extent_cache, if split and small updates happen,
+		 * unless the tree is retained for its fragmented map
+		 */
+		if (dei.len >= 1 && !et->retain &&
 				prev.len < F2FS_MIN_EXTENT_LEN &&
 				et->largest.len < F2FS_MIN_EXTENT_LEN) {
 			et->largest.len = 0;
@@ -647,11 +682,14 @@ unsigned int f2fs_shrink_extent_tree(struct f2fs_sb_info *sbi, int nr_shrink)
 
 	/* 1. remove unreferenced extent tree */
 	list_for_each_entry_safe(et, next, &sbi->zombie_list, list) {
-		if (atomic_read(&et->node_cnt)) {
-			write_lock(&et->lock);
+		if (__may_retain_extent(sbi, et))
+			continue;
+
+		write_lock(&et->lock);
+		if (atomic_read(&et->node_cnt))
 			node_cnt += __free_extent_tree(sbi, et);
-			write_unlock(&et->lock);
-		}
+		__unretain_extent_tree(sbi, et);
+		write_unlock(&et->lock);
 		f2fs_bug_on(sbi, atomic_read(&et->node_cnt));
 		list_del_init(&et->list);
 		radix_tree_delete(&sbi->extent_tree_root, et->ino);
@@ -680,7 +718,8 @@ free_node:
 		en = list_first_entry(&sbi->extent_list,
 					struct extent_node, list);
 		et = en->et;
-		if (!write_trylock(&et->lock)) {
+		if (__may_retain_extent(sbi, et) ||
+				!write_trylock(&et->lock)) {
 			/* refresh this extent node's position in extent list */
 			list_move_tail(&en->list, &sbi->extent_list);
 			continue;
@@ -734,6 +773,7 @@ void f2fs_drop_extent_tree(struct inode *inode)
 
 	write_lock(&et->lock);
 	__free_extent_tree(sbi, et);
+	__unretain_extent_tree(sbi, et);
 	if (et->largest.len) {
 		et->largest.len = 0;
 		updated = true;
@@ -743,6 +783,27 @@ void f2fs_drop_extent_tree(struct inode *inode)
 		f2fs_mark_inode_dirty_sync(inode, true);
 }
 
+/*
+ * Keep the extent tree of a file precached for random read, as long as
+ * nobody writes to it, e.g. APK and dex files read at app launch.
+ */
+void f2fs_retain_extent_tree(struct inode *inode)
+{
+	struct f2fs_sb_info *sbi = F2FS_I_SB(inode);
+	struct extent_tree *et = F2FS_I(inode)->extent_tree;
+
+	if (!f2fs_may_extent_tree(inode) || atomic_read(&inode->i_writecount) > 0)
+		return;
+
+	write_lock(&et->lock);
+	if (!et->retain && !is_inode_flag_set(inode, FI_NO_EXTENT)) {
+		et->retain = true;
+		atomic_add(atomic_read(&et->node_cnt), &sbi->total_retain_node);
+		atomic_inc(&sbi->total_retain_tree);
+	}
+	write_unlock(&et->lock);
+}
+
 void f2fs_destroy_extent_tree(struct inode *inode)
 {
 	struct f2fs_sb_info *sbi = F2FS_I_SB(inode);
@@ -767,6 +828,7 @@ void f2fs_destroy_extent_tree(struct inode *inode)
 	/* delete extent tree entry in radix tree */
 	mutex_lock(&sbi->extent_tree_lock);
 	f2fs_bug_on(sbi, atomic_read(&et->node_cnt));
+	__unretain_extent_tree(sbi, et);
 	radix_tree_delete(&sbi->extent_tree_root, inode->i_ino);
 	kmem_cache_free(extent_tree_slab, et);
 	atomic_dec(&sbi->total_ext_tree);
@@ -824,6 +886,9 @@ void f2fs_init_extent_cache_info(struct f2fs_sb_info *sbi)
 	INIT_LIST_HEAD(&sbi->zombie_list);
 	atomic_set(&sbi->total_zombie_tree, 0);
 	atomic_set(&sbi->total_ext_node, 0);
+	atomic_set(&sbi->total_retain_tree, 0);
+	atomic_set(&sbi->total_retain_node, 0);
+	sbi->max_retain_ext_node = DEF_MAX_RETAIN_EXTENT_NODE;
 }
 
 int __init f2fs_create_extent_cache(void)
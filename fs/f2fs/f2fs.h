@@ -22,7 +22,6 @@
 #include <linux/bio.h>
 #include <linux/blkdev.h>
 #include <linux/quotaops.h>
-#include <crypto/hash.h>
 #include <linux/overflow.h>
 #include <linux/ctype.h>
 #include "../mount.h"
@@ -575,6 +574,9 @@ enum {
 /* number of extent info in extent cache we try to shrink */
 #define EXTENT_CACHE_SHRINK_NUMBER	128
 
+/* # of extent info of retained extent trees kept against the shrinker */
+#define DEF_MAX_RETAIN_EXTENT_NODE	16384
+
 struct rb_entry {
 	struct rb_node rb_node;		/* rb node located in rb-tree */
 	unsigned int ofs;		/* start offset of the entry */
@@ -611,6 +613,7 @@ struct extent_tree {
 	rwlock_t lock;			/* protect extent info rb-tree */
 	atomic_t node_cnt;		/* # of extent node in rb-tree*/
 	bool largest_updated;		/* largest extent updated */
+	bool retain;			/* precached for hot read, keep it */
 };
 
 /*
@@ -1281,6 +1284,15 @@ struct f2fs_sec_stat_info {
 	u32 max_undiscard_blks;		/* # of undiscard blocks */
 };
 
+/* checkpoint stages timed for cp_time_stat */
+enum {
+	CP_STAGE_BLOCK_OPS,		/* block_operations() */
+	CP_STAGE_FLUSH_NODES,		/* node pages flushed under cp_rwsem */
+	CP_STAGE_FLUSH_META,		/* NAT/SIT entries */
+	CP_STAGE_WRITE_CP,		/* do_checkpoint() */
+	NR_CP_STAGE,
+};
+
 struct f2fs_sec_fsck_info {
 	u64 fsck_read_bytes;
 	u64 fsck_written_bytes;
@@ -1358,6 +1370,9 @@ struct f2fs_sb_info {
 	struct rw_semaphore cp_rwsem;		/* blocking FS operations */
 	struct rw_semaphore node_write;		/* locking node writes */
 	struct rw_semaphore node_change;	/* locking node change */
+	struct work_struct cp_node_work;	/* node flush before cp_rwsem */
+	u64 cp_stage_time[NR_CP_STAGE];		/* last checkpoint, in usec */
+	u64 cp_stage_max[NR_CP_STAGE];		/* max. of checkpoints, in usec */
 	wait_queue_head_t cp_wait;
 	unsigned long last_time[MAX_TIME];	/* to store time in jiffies */
 	long interval_time[MAX_TIME];		/* to store thresholds */
@@ -1385,6 +1400,9 @@ struct f2fs_sb_info {
 	struct list_head zombie_list;		/* extent zombie tree list */
 	atomic_t total_zombie_tree;		/* extent zombie tree count */
 	atomic_t total_ext_node;		/* extent info count */
+	atomic_t total_retain_tree;		/* retained extent tree count */
+	atomic_t total_retain_node;		/* extent info count of retained trees */
+	unsigned int max_retain_ext_node;	/* max # of retained extent info */
 
 	/* basic filesystem units */
 	unsigned int log_sectors_per_block;	/* log2 sectors per block */
@@ -1439,10 +1457,19 @@ struct f2fs_sb_info {
 	/* for skip statistic */
 	unsigned long long skipped_atomic_files[2];	/* FG_GC and BG_GC */
 	unsigned long long skipped_gc_rwsem;		/* FG_GC only */
+	unsigned long long skipped_young_secs;		/* BG_GC only */
+
+	/* for write amplification statistic, under sentry_lock */
+	unsigned long long gc_moved_blks;	/* # of blocks moved by GC */
+	unsigned long long gc_moved_invalid;	/* # of them invalidated later */
+	unsigned long long gc_freed_segs;	/* # of segments cleaned by GC */
 
 	/* threshold for gc trials on pinned files */
 	u64 gc_pin_file_threshold;
 
+	/* min. age in seconds of the section BG_GC moves */
+	unsigned int gc_age_threshold;
+
 	/* maximum # of trials to find a victim segment for SSR and GC */
 	unsigned int max_victim_search;
 
@@ -1460,6 +1487,7 @@ struct f2fs_sb_info {
 	atomic64_t read_hit_rbtree;		/* # of hit rbtree extent node */
 	atomic64_t read_hit_largest;		/* # of hit largest extent node */
 	atomic64_t read_hit_cached;		/* # of hit cached extent node */
+	atomic64_t read_hit_retain;		/* # of hit in retained extent tree */
 	atomic_t inline_xattr;			/* # of inline_xattr inodes */
 	atomic_t inline_inode;			/* # of inline_data inodes */
 	atomic_t inline_dir;			/* # of inline_dentry inodes */
@@ -1496,8 +1524,6 @@ struct f2fs_sb_info {
 	u64 sectors_written_start;
 	u64 kbytes_written;
 
-	/* Reference to checksum algorithm driver via cryptoapi */
-	struct crypto_shash *s_chksum_driver;
 
 	/* Precomputed FS UUID checksum for seeding other checksums */
 	__u32 s_chksum_seed;
@@ -1616,22 +1642,7 @@ void f2fs_get_fsck_stat(struct f2fs_sb_info *sbi);
 static inline u32 __f2fs_crc32(struct f2fs_sb_info *sbi, u32 crc,
 			      const void *address, unsigned int length)
 {
-	struct {
-		struct shash_desc shash;
-		char ctx[4];
-	} desc;
-	int err;
-
-	BUG_ON(crypto_shash_descsize(sbi->s_chksum_driver) != sizeof(desc.ctx));
-
-	desc.shash.tfm = sbi->s_chksum_driver;
-	desc.shash.flags = 0;
-	*(u32 *)desc.ctx = crc;
-
-	err = crypto_shash_update(&desc.shash, address, length);
-	BUG_ON(err);
-
-	return *(u32 *)desc.ctx;
+	return crc32_le_inline(crc, address, length);
 }
 
 static inline u32 f2fs_crc32(struct f2fs_sb_info *sbi, const void *address,
@@ -3291,6 +3302,7 @@ void f2fs_update_dirty_page(struct inode *inode, struct page *page);
 void f2fs_remove_dirty_inode(struct inode *inode);
 int f2fs_sync_dirty_inodes(struct f2fs_sb_info *sbi, enum inode_type type);
 void f2fs_wait_on_all_pages_writeback(struct f2fs_sb_info *sbi);
+void f2fs_cp_node_flush_work(struct work_struct *work);
 int f2fs_write_checkpoint(struct f2fs_sb_info *sbi, struct cp_control *cpc);
 void f2fs_init_ino_entry_info(struct f2fs_sb_info *sbi);
 int __init f2fs_create_checkpoint_caches(void);
@@ -3373,8 +3385,9 @@ struct f2fs_stat_info {
 	int all_area_segs, sit_area_segs, nat_area_segs, ssa_area_segs;
 	int main_area_segs, main_area_sections, main_area_zones;
 	unsigned long long hit_largest, hit_cached, hit_rbtree;
-	unsigned long long hit_total, total_ext;
+	unsigned long long hit_total, total_ext, hit_retain;
 	int ext_tree, zombie_tree, ext_node;
+	int retain_tree, retain_node;
 	int ndirty_node, ndirty_dent, ndirty_meta, ndirty_imeta;
 	int ndirty_data, ndirty_qdata;
 	int inmem_pages;
@@ -3402,6 +3415,8 @@ struct f2fs_stat_info {
 	int tot_blks, data_blks, node_blks;
 	int bg_data_blks, bg_node_blks;
 	unsigned long long skipped_atomic_files[2];
+	unsigned long long skipped_young_secs;
+	unsigned long long gc_moved_blks, gc_moved_invalid;
 	int curseg[NR_CURSEG_TYPE];
 	int cursec[NR_CURSEG_TYPE];
 	int curzone[NR_CURSEG_TYPE];
@@ -3430,6 +3445,7 @@ static inline struct f2fs_stat_info *F2FS_STAT(struct f2fs_sb_info *sbi)
 #define stat_inc_rbtree_node_hit(sbi)	(atomic64_inc(&(sbi)->read_hit_rbtree))
 #define stat_inc_largest_node_hit(sbi)	(atomic64_inc(&(sbi)->read_hit_largest))
 #define stat_inc_cached_node_hit(sbi)	(atomic64_inc(&(sbi)->read_hit_cached))
+#define stat_inc_retain_node_hit(sbi)	(atomic64_inc(&(sbi)->read_hit_retain))
 #define stat_inc_inline_xattr(inode)					\
 	do {								\
 		if (f2fs_has_inline_xattr(inode))			\
@@ -3549,6 +3565,7 @@ void f2fs_destroy_root_stats(void);
 #define stat_inc_rbtree_node_hit(sb)			do { } while (0)
 #define stat_inc_largest_node_hit(sbi)			do { } while (0)
 #define stat_inc_cached_node_hit(sbi)			do { } while (0)
+#define stat_inc_retain_node_hit(sbi)			do { } while (0)
 #define stat_inc_inline_xattr(inode)			do { } while (0)
 #define stat_dec_inline_xattr(inode)			do { } while (0)
 #define stat_inc_inline_inode(inode)			do { } while (0)
@@ -3647,6 +3664,7 @@ bool f2fs_check_rb_tree_consistence(struct f2fs_sb_info *sbi,
 unsigned int f2fs_shrink_extent_tree(struct f2fs_sb_info *sbi, int nr_shrink);
 bool f2fs_init_extent_tree(struct inode *inode, struct f2fs_extent *i_ext);
 void f2fs_drop_extent_tree(struct inode *inode);
+void f2fs_retain_extent_tree(struct inode *inode);
 unsigned int f2fs_destroy_extent_node(struct inode *inode);
 void f2fs_destroy_extent_tree(struct inode *inode);
 bool f2fs_lookup_extent_cache(struct inode *inode, pgoff_t pgofs,
@@ -2978,6 +2978,8 @@ int f2fs_precache_extents(struct inode *inode)
 		map.m_lblk = m_next_extent;
 	}
 
+	/* the map was asked for random read, keep it against the shrinker */
+	f2fs_retain_extent_tree(inode);
 	return err;
 }
 
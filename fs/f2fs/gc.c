@@ -13,6 +13,8 @@
 #include <linux/kthread.h>
 #include <linux/delay.h>
 #include <linux/freezer.h>
+#include <linux/fb.h>
+#include <linux/power_supply.h>
 
 #include "f2fs.h"
 #include "node.h"
@@ -20,12 +22,85 @@
 #include "gc.h"
 #include <trace/events/f2fs.h>
 
+static void wake_up_gc_thread(struct f2fs_gc_kthread *gc_th)
+{
+	gc_th->gc_wake = 1;
+	wake_up_interruptible_all(&gc_th->gc_wait_queue_head);
+}
+
+/* DECON relays the blank events of the primary display to fb clients */
+static int gc_fb_notifier_call(struct notifier_block *nb,
+					unsigned long event, void *data)
+{
+	struct f2fs_gc_kthread *gc_th = container_of(nb,
+					struct f2fs_gc_kthread, fb_nb);
+	struct fb_event *evdata = data;
+
+	if (event != FB_EVENT_BLANK || !evdata || !evdata->data)
+		return NOTIFY_DONE;
+
+	if (evdata->info && evdata->info->node)
+		return NOTIFY_DONE;
+
+	gc_th->screen_off = *(int *)evdata->data == FB_BLANK_POWERDOWN;
+	if (gc_th->screen_off)
+		wake_up_gc_thread(gc_th);
+
+	return NOTIFY_OK;
+}
+
+/* called in atomic context, the supply is read again by the gc thread */
+static int gc_psy_notifier_call(struct notifier_block *nb,
+					unsigned long event, void *data)
+{
+	struct f2fs_gc_kthread *gc_th = container_of(nb,
+					struct f2fs_gc_kthread, psy_nb);
+
+	if (event != PSY_EVENT_PROP_CHANGED)
+		return NOTIFY_DONE;
+
+	gc_th->psy_changed = true;
+	wake_up_gc_thread(gc_th);
+
+	return NOTIFY_OK;
+}
+
+static void register_gc_notifier(struct f2fs_gc_kthread *gc_th)
+{
+	gc_th->fb_nb.notifier_call = gc_fb_notifier_call;
+	fb_register_client(&gc_th->fb_nb);
+#ifdef CONFIG_POWER_SUPPLY
+	gc_th->psy_nb.notifier_call = gc_psy_notifier_call;
+	power_supply_reg_notifier(&gc_th->psy_nb);
+#endif
+}
+
+static void unregister_gc_notifier(struct f2fs_gc_kthread *gc_th)
+{
+	fb_unregister_client(&gc_th->fb_nb);
+#ifdef CONFIG_POWER_SUPPLY
+	power_supply_unreg_notifier(&gc_th->psy_nb);
+#endif
+}
+
+static bool is_charging_gc(struct f2fs_gc_kthread *gc_th)
+{
+	if (gc_th->psy_changed) {
+		gc_th->psy_changed = false;
+		gc_th->charging = power_supply_is_system_supplied() > 0;
+	}
+
+	return gc_th->charging_gc && gc_th->screen_off && gc_th->charging;
+}
+
 static int gc_thread_func(void *data)
 {
 	struct f2fs_sb_info *sbi = data;
 	struct f2fs_gc_kthread *gc_th = sbi->gc_thread;
 	wait_queue_head_t *wq = &sbi->gc_thread->gc_wait_queue_head;
+	unsigned long long freed_segs;
 	unsigned int wait_ms;
+	int sched;
 
 	wait_ms = gc_th->min_sleep_time;
 
@@ -78,6 +153,7 @@ static int gc_thread_func(void *data)
 		 */
 		if (sbi->gc_mode == GC_URGENT) {
 			wait_ms = gc_th->urgent_sleep_time;
+			sched = GC_SCHED_URGENT;
 			mutex_lock(&sbi->gc_mutex);
 			goto do_gc;
 		}
@@ -87,24 +163,42 @@ static int gc_thread_func(void *data)
 			goto next;
 		}
 
+		/*
+		 * Stay off the device for a whole interval during foreground
+		 * I/O bursts, even if the screen is off while charging.
+		 */
 		if (!is_idle(sbi, GC_TIME)) {
-			increase_sleep_time(gc_th, &wait_ms);
+			if (is_charging_gc(gc_th))
+				wait_ms = gc_th->min_sleep_time;
+			else
+				increase_sleep_time(gc_th, &wait_ms);
+			gc_th->sched_paused++;
 			mutex_unlock(&sbi->gc_mutex);
 			stat_io_skip_bggc_count(sbi);
 			goto next;
 		}
 
-		if (has_enough_invalid_blocks(sbi))
-			decrease_sleep_time(gc_th, &wait_ms);
-		else
-			increase_sleep_time(gc_th, &wait_ms);
+		if (is_charging_gc(gc_th)) {
+			wait_ms = gc_th->charging_sleep_time;
+			sched = GC_SCHED_CHARGING;
+		} else {
+			sched = GC_SCHED_NORMAL;
+			if (has_enough_invalid_blocks(sbi))
+				decrease_sleep_time(gc_th, &wait_ms);
+			else
+				increase_sleep_time(gc_th, &wait_ms);
+		}
 do_gc:
 		stat_inc_bggc_count(sbi);
+		freed_segs = sbi->gc_freed_segs;
 
 		/* if return value is not zero, no victim was selected */
 		if (f2fs_gc(sbi, test_opt(sbi, FORCE_FG_GC), true, NULL_SEGNO))
 			wait_ms = gc_th->no_gc_sleep_time;
 
+		gc_th->sched_runs[sched]++;
+		gc_th->sched_segs[sched] += sbi->gc_freed_segs - freed_segs;
+
 		trace_f2fs_background_gc(sbi->sb, wait_ms,
 				prefree_segments(sbi), free_segments(sbi));
 
@@ -136,6 +230,15 @@ int f2fs_start_gc_thread(struct f2fs_sb_info *sbi)
 
 	gc_th->gc_wake= 0;
 
+	gc_th->charging_gc = 1;
+	gc_th->charging_sleep_time = DEF_GC_THREAD_CHARGING_SLEEP_TIME;
+	gc_th->screen_off = false;
+	gc_th->charging = power_supply_is_system_supplied() > 0;
+	gc_th->psy_changed = false;
+	memset(gc_th->sched_runs, 0, sizeof(gc_th->sched_runs));
+	memset(gc_th->sched_segs, 0, sizeof(gc_th->sched_segs));
+	gc_th->sched_paused = 0;
+
 	sbi->gc_thread = gc_th;
 	init_waitqueue_head(&sbi->gc_thread->gc_wait_queue_head);
 	sbi->gc_thread->f2fs_gc_task = kthread_run(gc_thread_func, sbi,
@@ -144,7 +247,10 @@ int f2fs_start_gc_thread(struct f2fs_sb_info *sbi)
 		err = PTR_ERR(gc_th->f2fs_gc_task);
 		kfree(gc_th);
 		sbi->gc_thread = NULL;
+		goto out;
 	}
+
+	register_gc_notifier(gc_th);
 out:
 	return err;
 }
@@ -154,6 +260,7 @@ void f2fs_stop_gc_thread(struct f2fs_sb_info *sbi)
 	struct f2fs_gc_kthread *gc_th = sbi->gc_thread;
 	if (!gc_th)
 		return;
+	unregister_gc_notifier(gc_th);
 	kthread_stop(gc_th->f2fs_gc_task);
 	kfree(gc_th);
 	sbi->gc_thread = NULL;
@@ -271,6 +378,23 @@ static unsigned int get_cb_cost(struct f2fs_sb_info *sbi, unsigned int segno)
 	return UINT_MAX - ((100 * (100 - u) * age) / (100 + u));
 }
 
+/*
+ * Sections modified recently keep losing valid blocks, so moving them now
+ * mostly writes blocks to be invalidated soon after.
+ */
+static bool is_young_section(struct f2fs_sb_info *sbi, unsigned int segno)
+{
+	unsigned int start = GET_SEG_FROM_SEC(sbi, GET_SEC_FROM_SEG(sbi, segno));
+	unsigned long long mtime = 0, now = get_mtime(sbi, false);
+	unsigned int i;
+
+	for (i = 0; i < sbi->segs_per_sec; i++)
+		mtime += get_seg_entry(sbi, start + i)->mtime;
+	mtime = div_u64(mtime, sbi->segs_per_sec);
+
+	return mtime < now && now - mtime < sbi->gc_age_threshold;
+}
+
 static inline unsigned int get_gc_cost(struct f2fs_sb_info *sbi,
 			unsigned int segno, struct victim_sel_policy *p)
 {
@@ -313,6 +437,8 @@ static int get_victim_by_default(struct f2fs_sb_info *sbi,
 	unsigned int secno, last_victim;
 	unsigned int last_segment = MAIN_SEGS(sbi);
 	unsigned int nsearched = 0;
+	unsigned int young_segno = NULL_SEGNO, young_cost;
+	bool age_check;
 
 	mutex_lock(&dirty_i->seglist_lock);
 
@@ -321,6 +447,10 @@ static int get_victim_by_default(struct f2fs_sb_info *sbi,
 
 	p.min_segno = NULL_SEGNO;
 	p.min_cost = get_max_cost(sbi, &p);
+	young_cost = p.min_cost;
+
+	age_check = p.alloc_mode == LFS && gc_type == BG_GC &&
+			sbi->gc_mode != GC_URGENT && sbi->gc_age_threshold;
 
 	if (*result != NULL_SEGNO) {
 		if (get_valid_blocks(sbi, *result, false) &&
@@ -385,6 +515,14 @@ static int get_victim_by_default(struct f2fs_sb_info *sbi,
 #endif
 		cost = get_gc_cost(sbi, segno, &p);
 
+		if (age_check && is_young_section(sbi, segno)) {
+			if (young_cost > cost) {
+				young_segno = segno;
+				young_cost = cost;
+			}
+			goto next;
+		}
+
 		if (p.min_cost > cost) {
 			p.min_segno = segno;
 			p.min_cost = cost;
@@ -399,6 +537,18 @@ next:
 			break;
 		}
 	}
+
+	/*
+	 * Once SSR starts to reuse dirty segments, free sections must be made
+	 * from young sections as well, or FG_GC will do it with the user waiting.
+	 */
+	if (p.min_segno == NULL_SEGNO && young_segno != NULL_SEGNO) {
+		if (f2fs_need_SSR(sbi))
+			p.min_segno = young_segno;
+		else
+			sbi->skipped_young_secs++;
+	}
+
 	if (p.min_segno != NULL_SEGNO) {
 got_it:
 		if (p.alloc_mode == LFS) {
@@ -711,6 +861,7 @@ static int move_data_block(struct inode *inode, block_t bidx,
 		.encrypted_page = NULL,
 		.in_list = false,
 		.retry = false,
+		.io_type = FS_GC_DATA_IO,
 	};
 	struct dnode_of_data dn;
 	struct f2fs_summary sum;
@@ -785,7 +936,7 @@ static int move_data_block(struct inode *inode, block_t bidx,
 		down_write(&fio.sbi->io_order_lock);
 
 	f2fs_allocate_data_block(fio.sbi, NULL, fio.old_blkaddr, &newaddr,
-					&sum, CURSEG_COLD_DATA, NULL, false);
+					&sum, CURSEG_COLD_DATA, &fio, false);
 
 	fio.encrypted_page = f2fs_pagecache_get_page(META_MAPPING(fio.sbi),
 				newaddr, FGP_LOCK | FGP_CREAT, GFP_NOFS);
@@ -1338,6 +1489,8 @@ stop:
 	SIT_I(sbi)->last_victim[ALLOC_NEXT] = 0;
 	SIT_I(sbi)->last_victim[FLUSH_DEVICE] = init_segno;
 
+	sbi->gc_freed_segs += total_freed;
+
 	gc_end_time = local_clock();
 	trace_f2fs_gc_end(sbi->sb, ret, total_freed, sec_freed,
 				get_pages(sbi, F2FS_DIRTY_NODES),
@@ -1364,6 +1517,7 @@ void f2fs_build_gc_manager(struct f2fs_sb_info *sbi)
 	DIRTY_I(sbi)->v_ops = &default_v_ops;
 
 	sbi->gc_pin_file_threshold = DEF_GC_FAILED_PINNED_FILES;
+	sbi->gc_age_threshold = DEF_GC_AGE_THRESHOLD;
 
 	/* give warm/cold data area from slower device */
 	if (f2fs_is_multi_device(sbi) && sbi->segs_per_sec == 1)
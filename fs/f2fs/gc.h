@@ -14,14 +14,26 @@
 #define DEF_GC_THREAD_MIN_SLEEP_TIME	30000	/* milliseconds */
 #define DEF_GC_THREAD_MAX_SLEEP_TIME	60000
 #define DEF_GC_THREAD_NOGC_SLEEP_TIME	300000	/* wait 5 min */
+#define DEF_GC_THREAD_CHARGING_SLEEP_TIME	1000	/* 1 sec */
 #define LIMIT_INVALID_BLOCK	40 /* percentage over total user space */
 #define LIMIT_FREE_BLOCK	40 /* percentage over invalid + free space */
 
 #define DEF_GC_FAILED_PINNED_FILES	2048
 
+/* sections modified within it are left to be invalidated, not moved by BG_GC */
+#define DEF_GC_AGE_THRESHOLD	(60 * 60)	/* 1 hour */
+
 /* Search max. number of dirty segments to select a victim segment */
 #define DEF_MAX_VICTIM_SEARCH 4096 /* covers 8GB */
 
+/* scheduling modes of the gc thread */
+enum {
+	GC_SCHED_NORMAL,	/* sleep on timer, run if I/O is idle */
+	GC_SCHED_CHARGING,	/* screen off and charging, run continuously */
+	GC_SCHED_URGENT,	/* gc_urgent */
+	GC_SCHED_MAX,
+};
+
 struct f2fs_gc_kthread {
 	struct task_struct *f2fs_gc_task;
 	wait_queue_head_t gc_wait_queue_head;
@@ -34,6 +46,20 @@ struct f2fs_gc_kthread {
 
 	/* for changing gc mode */
 	unsigned int gc_wake;
+
+	/* for GC_SCHED_CHARGING */
+	unsigned int charging_gc;
+	unsigned int charging_sleep_time;
+	bool screen_off;
+	bool charging;
+	bool psy_changed;
+	struct notifier_block fb_nb;
+	struct notifier_block psy_nb;
+
+	/* for scheduling statistic */
+	unsigned long long sched_runs[GC_SCHED_MAX];
+	unsigned long long sched_segs[GC_SCHED_MAX];
+	unsigned long long sched_paused;	/* by foreground I/O */
 };
 
 struct gc_inode_list {
@@ -2177,6 +2177,34 @@ static void update_sit_entry(struct f2fs_sb_info *sbi, block_t blkaddr, int del)
 
 	if (sbi->segs_per_sec > 1)
 		get_sec_entry(sbi, segno)->valid_blocks += del;
+
+	/*
+	 * blocks moved in by GC are not tracked one by one, so any block
+	 * invalidated in the segment is taken as one of them.
+	 */
+	if (del < 0 && se->gc_blocks) {
+		se->gc_blocks--;
+		sbi->gc_moved_invalid++;
+	}
+}
+
+static bool __is_gc_write(struct f2fs_io_info *fio)
+{
+	if (!fio)
+		return false;
+	if (fio->io_type == FS_GC_DATA_IO || fio->io_type == FS_GC_NODE_IO)
+		return true;
+	/* data pages moved by BG_GC are written back later */
+	return fio->type == DATA && fio->page && is_cold_data(fio->page);
+}
+
+static void __update_gc_moved(struct f2fs_sb_info *sbi, block_t blkaddr)
+{
+	struct seg_entry *se = get_seg_entry(sbi, GET_SEGNO(sbi, blkaddr));
+
+	if (se->gc_blocks < se->valid_blocks)
+		se->gc_blocks++;
+	sbi->gc_moved_blks++;
 }
 
 void f2fs_invalidate_blocks(struct f2fs_sb_info *sbi, block_t addr)
@@ -3051,6 +3079,8 @@ void f2fs_allocate_data_block(struct f2fs_sb_info *sbi, struct page *page,
 	update_sit_entry(sbi, *new_blkaddr, 1);
 	if (GET_SEGNO(sbi, old_blkaddr) != NULL_SEGNO)
 		update_sit_entry(sbi, old_blkaddr, -1);
+	if (__is_gc_write(fio))
+		__update_gc_moved(sbi, *new_blkaddr);
 
 	if (!__has_curseg_space(sbi, type))
 		sit_i->s_ops->allocate_segment(sbi, type, false);
@@ -269,6 +269,10 @@ static ssize_t f2fs_sec_stats_show(struct f2fs_sb_info *sbi, char *buf)
 			si->skipped_atomic_files[BG_GC] +
 			si->skipped_atomic_files[FG_GC],
 			si->skipped_atomic_files[BG_GC]);
+	len += snprintf(buf + len, PAGE_SIZE - len, "Skipped : young section (BG) %llu\n",
+			si->skipped_young_secs);
+	len += snprintf(buf + len, PAGE_SIZE - len, "GC moved : %llu blocks, invalidated: %llu\n",
+			si->gc_moved_blks, si->gc_moved_invalid);
 	len += snprintf(buf + len, PAGE_SIZE - len, "BG skip : IO: %u, Other: %u\n",
 			si->io_skip_bggc, si->other_skip_bggc);
 	len += snprintf(buf + len, PAGE_SIZE - len, "\nExtent Cache:\n");
@@ -281,6 +285,10 @@ static ssize_t f2fs_sec_stats_show(struct f2fs_sb_info *sbi, char *buf)
 			si->hit_total, si->total_ext);
 	len += snprintf(buf + len, PAGE_SIZE - len, "  - Inner Struct Count: tree: %d(%d), node: %d\n",
 			si->ext_tree, si->zombie_tree, si->ext_node);
+	len += snprintf(buf + len, PAGE_SIZE - len, "  - Miss Count: %llu\n",
+			si->total_ext - si->hit_total);
+	len += snprintf(buf + len, PAGE_SIZE - len, "  - Retained: tree: %d, node: %d, hit: %llu\n",
+			si->retain_tree, si->retain_node, si->hit_retain);
 	len += snprintf(buf + len, PAGE_SIZE - len, "\nBalancing F2FS Async:\n");
 	len += snprintf(buf + len, PAGE_SIZE - len, "  - IO_R (Data: %4d, Node: %4d, Meta: %4d\n",
 			si->nr_rd_data, si->nr_rd_node, si->nr_rd_meta);
@@ -395,6 +403,31 @@ static ssize_t f2fs_sbi_show(struct f2fs_attr *a,
 			"BGGC_DSEG", sbi->sec_stat.gc_data_seg_count[BG_GC],
 			"BGGC_DBLK", sbi->sec_stat.gc_data_blk_count[BG_GC],
 			"BGGC_TTIME", sbi->sec_stat.gc_ttime[BG_GC]);
+	} else if (!strcmp(a->attr.name, "cp_time_stat")) {
+		return snprintf(buf, PAGE_SIZE, "\"%s\":\"%llu\",\"%s\":\"%llu\","
+		"\"%s\":\"%llu\",\"%s\":\"%llu\",\"%s\":\"%llu\",\"%s\":\"%llu\","
+		"\"%s\":\"%llu\",\"%s\":\"%llu\"\n",
+			"BLOCK_OPS", sbi->cp_stage_time[CP_STAGE_BLOCK_OPS],
+			"BLOCK_OPS_MAX", sbi->cp_stage_max[CP_STAGE_BLOCK_OPS],
+			"FLUSH_NODES", sbi->cp_stage_time[CP_STAGE_FLUSH_NODES],
+			"FLUSH_NODES_MAX", sbi->cp_stage_max[CP_STAGE_FLUSH_NODES],
+			"FLUSH_META", sbi->cp_stage_time[CP_STAGE_FLUSH_META],
+			"FLUSH_META_MAX", sbi->cp_stage_max[CP_STAGE_FLUSH_META],
+			"WRITE_CP", sbi->cp_stage_time[CP_STAGE_WRITE_CP],
+			"WRITE_CP_MAX", sbi->cp_stage_max[CP_STAGE_WRITE_CP]);
+	} else if (!strcmp(a->attr.name, "gc_sched_stat")) {
+		struct f2fs_gc_kthread *gc_th = (struct f2fs_gc_kthread *)ptr;
+
+		return snprintf(buf, PAGE_SIZE, "\"%s\":\"%llu\",\"%s\":\"%llu\","
+		"\"%s\":\"%llu\",\"%s\":\"%llu\",\"%s\":\"%llu\",\"%s\":\"%llu\","
+		"\"%s\":\"%llu\"\n",
+			"NORMAL", gc_th->sched_runs[GC_SCHED_NORMAL],
+			"NORMAL_SEG", gc_th->sched_segs[GC_SCHED_NORMAL],
+			"CHARGING", gc_th->sched_runs[GC_SCHED_CHARGING],
+			"CHARGING_SEG", gc_th->sched_segs[GC_SCHED_CHARGING],
+			"URGENT", gc_th->sched_runs[GC_SCHED_URGENT],
+			"URGENT_SEG", gc_th->sched_segs[GC_SCHED_URGENT],
+			"PAUSED", gc_th->sched_paused);
 	} else if (!strcmp(a->attr.name, "sec_io_stat")) {
 		u64 kbytes_written = 0;
 
@@ -522,6 +555,16 @@ out:
 			sbi->sec_stat.gc_ttime[BG_GC] = 0;
 			sbi->sec_stat.gc_ttime[FG_GC] = 0;
 		return count;
+	} else if (!strcmp(a->attr.name, "cp_time_stat")) {
+		memset(sbi->cp_stage_max, 0, sizeof(sbi->cp_stage_max));
+		return count;
+	} else if (!strcmp(a->attr.name, "gc_sched_stat")) {
+		struct f2fs_gc_kthread *gc_th = (struct f2fs_gc_kthread *)ptr;
+
+		memset(gc_th->sched_runs, 0, sizeof(gc_th->sched_runs));
+		memset(gc_th->sched_segs, 0, sizeof(gc_th->sched_segs));
+		gc_th->sched_paused = 0;
+		return count;
 	} else if (!strcmp(a->attr.name, "sec_io_stat")) {
 		sbi->sec_stat.cp_cnt[STAT_CP_ALL] = 0;
 		sbi->sec_stat.cp_cnt[STAT_CP_BG] = 0;
@@ -741,6 +784,10 @@ F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_urgent_sleep_time,
 F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_min_sleep_time, min_sleep_time);
 F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_max_sleep_time, max_sleep_time);
 F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_no_gc_sleep_time, no_gc_sleep_time);
+F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_charging, charging_gc);
+F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_charging_sleep_time,
+							charging_sleep_time);
+F2FS_RW_ATTR(GC_THREAD, f2fs_gc_kthread, gc_sched_stat, sched_runs);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_idle, gc_mode);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_urgent, gc_mode);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, reclaim_segments, rec_prefree_segments);
@@ -758,6 +805,7 @@ F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, ram_thresh, ram_thresh);
 F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, ra_nid_pages, ra_nid_pages);
 F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, dirty_nats_ratio, dirty_nats_ratio);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, max_victim_search, max_victim_search);
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, max_retain_extent_node, max_retain_ext_node);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, dir_level, dir_level);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, cp_interval, interval_time[CP_TIME]);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, idle_interval, interval_time[REQ_TIME]);
@@ -769,6 +817,7 @@ F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info,
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, iostat_enable, iostat_enable);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, readdir_ra, readdir_ra);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_pin_file_thresh, gc_pin_file_threshold);
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, gc_age_threshold, gc_age_threshold);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_super_block, extension_list, extension_list);
 #ifdef CONFIG_F2FS_FAULT_INJECTION
 F2FS_RW_ATTR(FAULT_INFO_RATE, f2fs_fault_info, inject_rate, inject_rate);
@@ -776,6 +825,7 @@ F2FS_RW_ATTR(FAULT_INFO_TYPE, f2fs_fault_info, inject_type, inject_type);
 #endif
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, sec_gc_stat, sec_stat);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, sec_io_stat, sec_stat);
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, cp_time_stat, cp_stage_time);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, sec_stats, stat_info);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, sec_fsck_stat, sec_fsck_stat);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, sec_part_best_extents, s_sec_part_best_extents);
@@ -813,6 +863,9 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(gc_min_sleep_time),
 	ATTR_LIST(gc_max_sleep_time),
 	ATTR_LIST(gc_no_gc_sleep_time),
+	ATTR_LIST(gc_charging),
+	ATTR_LIST(gc_charging_sleep_time),
+	ATTR_LIST(gc_sched_stat),
 	ATTR_LIST(gc_idle),
 	ATTR_LIST(gc_urgent),
 	ATTR_LIST(reclaim_segments),
@@ -826,6 +879,7 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(min_hot_blocks),
 	ATTR_LIST(min_ssr_sections),
 	ATTR_LIST(max_victim_search),
+	ATTR_LIST(max_retain_extent_node),
 	ATTR_LIST(dir_level),
 	ATTR_LIST(ram_thresh),
 	ATTR_LIST(ra_nid_pages),
@@ -838,9 +892,11 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(iostat_enable),
 	ATTR_LIST(readdir_ra),
 	ATTR_LIST(gc_pin_file_thresh),
+	ATTR_LIST(gc_age_threshold),
 	ATTR_LIST(extension_list),
 	ATTR_LIST(sec_gc_stat),
 	ATTR_LIST(sec_io_stat),
+	ATTR_LIST(cp_time_stat),
 	ATTR_LIST(sec_stats),
 	ATTR_LIST(sec_fsck_stat),
 	ATTR_LIST(sec_part_best_extents),
@@ -1096,6 +1096,7 @@ static int __set_oom_adj(struct file *file, int oom_adj, bool legacy)
 	if (!legacy && has_capability_noaudit(current, CAP_SYS_RESOURCE))
 		task->signal->oom_score_adj_min = (short)oom_adj;
 	trace_oom_score_adj_update(task);
+	lmk_adj_update(task);
 
 	if (mm) {
 		struct task_struct *p;
@@ -1116,6 +1117,7 @@ static int __set_oom_adj(struct file *file, int oom_adj, bool legacy)
 					p->signal->oom_score_adj_min = (short)oom_adj;
 			}
 			task_unlock(p);
+			lmk_adj_update(p);
 		}
 		rcu_read_unlock();
 		mmdrop(mm);
@@ -3234,6 +3236,9 @@ static const struct pid_entry tgid_base_stuff[] = {
 	REG("mounts",     S_IRUGO, proc_mounts_operations),
 	REG("mountinfo",  S_IRUGO, proc_mountinfo_operations),
 	REG("mountstats", S_IRUSR, proc_mountstats_operations),
+#ifdef CONFIG_PROCESS_RECLAIM
+	REG("reclaim", S_IWUSR, proc_reclaim_operations),
+#endif
 #ifdef CONFIG_PROC_PAGE_MONITOR
 	REG("clear_refs", S_IWUSR, proc_clear_refs_operations),
 	REG("smaps",      S_IRUGO, proc_pid_smaps_operations),
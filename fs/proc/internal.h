@@ -303,6 +303,7 @@ extern const struct file_operations proc_pid_smaps_operations;
 extern const struct file_operations proc_pid_smaps_rollup_operations;
 extern const struct file_operations proc_tid_smaps_operations;
 extern const struct file_operations proc_clear_refs_operations;
+extern const struct file_operations proc_reclaim_operations;
 extern const struct file_operations proc_pagemap_operations;
 
 extern unsigned long task_vsize(struct mm_struct *);
@@ -12,6 +12,7 @@
 #include <linux/mempolicy.h>
 #include <linux/rmap.h>
 #include <linux/swap.h>
+#include <linux/mm_inline.h>
 #include <linux/sched/mm.h>
 #include <linux/swapops.h>
 #include <linux/mmu_notifier.h>
@@ -1289,6 +1290,185 @@ const struct file_operations proc_clear_refs_operations = {
 	.llseek		= noop_llseek,
 };
 
+#ifdef CONFIG_PROCESS_RECLAIM
+struct reclaim_param {
+	enum reclaim_type type;
+	unsigned long nr_scanned;
+	unsigned long nr_reclaimed;
+};
+
+static int reclaim_pte_range(pmd_t *pmd, unsigned long addr,
+				unsigned long end, struct mm_walk *walk)
+{
+	struct reclaim_param *rp = walk->private;
+	struct vm_area_struct *vma = walk->vma;
+	pte_t *orig_pte, *pte, ptent;
+	spinlock_t *ptl;
+	struct page *page;
+	LIST_HEAD(page_list);
+	int isolated;
+
+	split_huge_pmd(vma, pmd, addr);
+	if (pmd_trans_unstable(pmd))
+		return 0;
+cont:
+	isolated = 0;
+	orig_pte = pte = pte_offset_map_lock(vma->vm_mm, pmd, addr, &ptl);
+	for (; addr != end; pte++, addr += PAGE_SIZE) {
+		ptent = *pte;
+		if (!pte_present(ptent))
+			continue;
+
+		page = vm_normal_page(vma, addr, ptent);
+		if (!page)
+			continue;
+
+		/* pages shared with other processes are left to kswapd */
+		if (PageTransCompound(page) || page_mapcount(page) != 1)
+			continue;
+
+		if (isolate_lru_page(page))
+			continue;
+
+		list_add(&page->lru, &page_list);
+		inc_node_page_state(page, NR_ISOLATED_ANON +
+				page_is_file_cache(page));
+		isolated++;
+		rp->nr_scanned++;
+
+		/* reclaim in batch not to hold too many isolated pages */
+		if (isolated >= SWAP_CLUSTER_MAX) {
+			addr += PAGE_SIZE;
+			break;
+		}
+	}
+	pte_unmap_unlock(orig_pte, ptl);
+
+	rp->nr_reclaimed += reclaim_pages_from_list(&page_list);
+	cond_resched();
+
+	if (addr != end)
+		goto cont;
+
+	return 0;
+}
+
+static int reclaim_test_walk(unsigned long start, unsigned long end,
+				struct mm_walk *walk)
+{
+	struct reclaim_param *rp = walk->private;
+	struct vm_area_struct *vma = walk->vma;
+
+	if (vma->vm_flags & (VM_LOCKED | VM_PFNMAP | VM_HUGETLB))
+		return 1;
+
+	if (rp->type == RECLAIM_ANON && vma->vm_file)
+		return 1;
+	if (rp->type == RECLAIM_FILE && !vma->vm_file)
+		return 1;
+	return 0;
+}
+
+/*
+ * Reclaims pages of @task in [@start, @end). Whole address space is walked
+ * if @end is 0. Returns the number of reclaimed pages.
+ */
+static unsigned long __reclaim_task(struct task_struct *task,
+		enum reclaim_type type, unsigned long start, unsigned long end)
+{
+	struct reclaim_param rp = {
+		.type = type,
+	};
+	struct mm_walk reclaim_walk = {
+		.pmd_entry = reclaim_pte_range,
+		.test_walk = reclaim_test_walk,
+		.private = &rp,
+	};
+	struct mm_struct *mm;
+
+	mm = get_task_mm(task);
+	if (!mm)
+		return 0;
+
+	reclaim_walk.mm = mm;
+
+	down_read(&mm->mmap_sem);
+	if (!end)
+		end = mm->highest_vm_end;
+	walk_page_range(start, end, &reclaim_walk);
+	up_read(&mm->mmap_sem);
+
+	mmput(mm);
+
+	return rp.nr_reclaimed;
+}
+
+/**
+ * reclaim_task() - reclaim pages of a process
+ * @task: process, typically frozen in background
+ * @type: which pages to reclaim
+ *
+ * Anon pages go to swap, i.e. zram. May sleep.
+ */
+unsigned long reclaim_task(struct task_struct *task, enum reclaim_type type)
+{
+	return __reclaim_task(task, type, 0, 0);
+}
+
+static ssize_t reclaim_write(struct file *file, const char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	struct task_struct *task;
+	char buffer[64];
+	enum reclaim_type type;
+	unsigned long start = 0, size = 0;
+	char *type_buf, *range;
+
+	memset(buffer, 0, sizeof(buffer));
+	if (count > sizeof(buffer) - 1)
+		count = sizeof(buffer) - 1;
+	if (copy_from_user(buffer, buf, count))
+		return -EFAULT;
+
+	range = strstrip(buffer);
+	type_buf = strsep(&range, " ");
+
+	if (!strcmp(type_buf, "file"))
+		type = RECLAIM_FILE;
+	else if (!strcmp(type_buf, "anon"))
+		type = RECLAIM_ANON;
+	else if (!strcmp(type_buf, "all"))
+		type = RECLAIM_ALL;
+	else
+		return -EINVAL;
+
+	/* per vma targeting by "<type> <addr> <size>" */
+	if (range) {
+		if (sscanf(range, "%lx %lx", &start, &size) != 2)
+			return -EINVAL;
+		if (!size || start + size <= start)
+			return -EINVAL;
+		start &= PAGE_MASK;
+		size = PAGE_ALIGN(size);
+	}
+
+	task = get_proc_task(file_inode(file));
+	if (!task)
+		return -ESRCH;
+
+	__reclaim_task(task, type, start, size ? start + size : 0);
+
+	put_task_struct(task);
+
+	return count;
+}
+
+const struct file_operations proc_reclaim_operations = {
+	.write		= reclaim_write,
+	.llseek		= noop_llseek,
+};
+#endif
+
 typedef struct {
 	u64 pme;
 } pagemap_entry_t;
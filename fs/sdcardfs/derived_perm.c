@@ -20,6 +20,10 @@
 
 #include "sdcardfs.h"
 
+/* bumped whenever derived permissions cached in inodes may be stale */
+atomic_t sdcardfs_perm_gen = ATOMIC_INIT(1);
+atomic64_t sdcardfs_perm_cache_hit = ATOMIC64_INIT(0);
+
 /* copy derived state from parent inode */
 static void inherit_derived_state(struct inode *parent, struct inode *child)
 {
@@ -390,9 +394,63 @@ static void __fixup_perms_recursive(struct dentry *dentry, struct limit_search *
 
 void fixup_perms_recursive(struct dentry *dentry, struct limit_search *limit)
 {
+	/* packagelist changed, every cached derived permission is stale */
+	atomic_inc(&sdcardfs_perm_gen);
 	__fixup_perms_recursive(dentry, limit, 0);
 }
 
+/* true if children derived from @info before the update derive differently */
+static bool derived_state_changed(struct sdcardfs_inode_info *info,
+		const struct sdcardfs_inode_data *old, void *old_top)
+{
+	struct sdcardfs_inode_data *data = info->data;
+
+	return data->perm != old->perm || data->userid != old->userid ||
+		data->d_uid != old->d_uid ||
+		data->under_android != old->under_android ||
+		data->under_cache != old->under_cache ||
+		data->under_obb != old->under_obb ||
+		READ_ONCE(info->top_data) != old_top;
+}
+
+/*
+ * A cached inode looked up again by the same name under the same parent
+ * derives the same permission unless the packagelist changed since, so the
+ * derivation is skipped then.
+ */
+static void get_derived_permission_cached(struct dentry *parent,
+		struct inode *inode, const struct qstr *name)
+{
+	struct sdcardfs_inode_info *info = SDCARDFS_I(inode);
+	unsigned int gen = atomic_read(&sdcardfs_perm_gen);
+	unsigned int hash = full_name_case_hash(0, name->name, name->len);
+	struct sdcardfs_inode_data old;
+	void *old_top;
+	bool moved;
+
+	moved = READ_ONCE(info->perm_parent) != d_inode(parent) ||
+		READ_ONCE(info->perm_hash) != hash;
+	if (!moved && READ_ONCE(info->perm_gen) == gen) {
+		atomic64_inc(&sdcardfs_perm_cache_hit);
+		return;
+	}
+
+	if (!moved || !info->perm_parent || !S_ISDIR(inode->i_mode)) {
+		get_derived_permission_inode_new(parent, inode, name);
+	} else {
+		/* children derived from a moved directory may be stale */
+		old = *info->data;
+		old_top = READ_ONCE(info->top_data);
+		get_derived_permission_inode_new(parent, inode, name);
+		if (derived_state_changed(info, &old, old_top))
+			gen = atomic_inc_return(&sdcardfs_perm_gen);
+	}
+
+	WRITE_ONCE(info->perm_parent, d_inode(parent));
+	WRITE_ONCE(info->perm_hash, hash);
+	WRITE_ONCE(info->perm_gen, gen);
+}
+
 /* main function for updating derived permission */
 inline void update_derived_permission_lock(struct dentry *dentry,
 		struct inode *inode)
@@ -410,7 +468,7 @@ inline void update_derived_permission_lock(struct dentry *dentry,
 	if (!IS_ROOT(dentry)) {
 		parent = dget_parent(dentry);
 		if (parent) {
-			get_derived_permission_inode_new(parent, inode,
+			get_derived_permission_cached(parent, inode,
 					&dentry->d_name);
 			dput(parent);
 		}
@@ -19,10 +19,29 @@
  */
 
 #include "sdcardfs.h"
+#include <linux/splice.h>
 #ifdef CONFIG_SDCARD_FS_FADV_NOACTIVE
 #include <linux/backing-dev.h>
 #endif
 
+/* bytes read, written and mapped straight from lower files */
+static atomic64_t passthrough_read_bytes = ATOMIC64_INIT(0);
+static atomic64_t passthrough_write_bytes = ATOMIC64_INIT(0);
+static atomic64_t passthrough_mmap_bytes = ATOMIC64_INIT(0);
+
+ssize_t sdcardfs_passthrough_stat(char *page)
+{
+	return scnprintf(page, PAGE_SIZE, "read:%lld write:%lld mmap:%lld\n",
+			(long long)atomic64_read(&passthrough_read_bytes),
+			(long long)atomic64_read(&passthrough_write_bytes),
+			(long long)atomic64_read(&passthrough_mmap_bytes));
+}
+
+static inline bool sdcardfs_passthrough(struct file *file)
+{
+	return SDCARDFS_SB(file_inode(file)->i_sb)->options.passthrough;
+}
+
 static ssize_t sdcardfs_read(struct file *file, char __user *buf,
 			   size_t count, loff_t *ppos)
 {
@@ -49,9 +68,11 @@ static ssize_t sdcardfs_read(struct file *file, char __user *buf,
 
 	err = vfs_read(lower_file, buf, count, ppos);
 	/* update our inode atime upon a successful lower read */
-	if (err >= 0)
+	if (err >= 0) {
+		atomic64_add(err, &passthrough_read_bytes);
 		fsstack_copy_attr_atime(d_inode(dentry),
 					file_inode(lower_file));
+	}
 
 	return err;
 }
@@ -74,6 +95,7 @@ static ssize_t sdcardfs_write(struct file *file, const char __user *buf,
 	err = vfs_write(lower_file, buf, count, ppos);
 	/* update our inode times+sizes upon a successful lower write */
 	if (err >= 0) {
+		atomic64_add(err, &passthrough_write_bytes);
 		if (sizeof(loff_t) > sizeof(long))
 			inode_lock(inode);
 		fsstack_copy_inode_size(inode, file_inode(lower_file));
@@ -195,6 +217,27 @@ static int sdcardfs_mmap(struct file *file, struct vm_area_struct *vma)
 		goto out;
 	}
 
+	/*
+	 * In passthrough mode the vma is handed over to the lower file with
+	 * its own vm_ops, so faults, fault-around and page_mkwrite are served
+	 * by the lower filesystem without going through us.
+	 */
+	if (sdcardfs_passthrough(file)) {
+		vma->vm_file = get_file(lower_file);
+		err = call_mmap(lower_file, vma);
+		if (err) {
+			vma->vm_file = file;
+			fput(lower_file);
+			goto out;
+		}
+		/* drop the reference mmap_region() took for us */
+		fput(file);
+		file_accessed(file);
+		atomic64_add(vma->vm_end - vma->vm_start,
+				&passthrough_mmap_bytes);
+		goto out;
+	}
+
 	/*
 	 * find and save lower vm_ops.
 	 *
@@ -392,9 +435,12 @@ ssize_t sdcardfs_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 	iocb->ki_filp = file;
 	fput(lower_file);
 	/* update upper inode atime as needed */
-	if (err >= 0 || err == -EIOCBQUEUED)
+	if (err >= 0 || err == -EIOCBQUEUED) {
+		if (err > 0)
+			atomic64_add(err, &passthrough_read_bytes);
 		fsstack_copy_attr_atime(file->f_path.dentry->d_inode,
 					file_inode(lower_file));
+	}
 out:
 	return err;
 }
@@ -421,6 +467,8 @@ ssize_t sdcardfs_write_iter(struct kiocb *iocb, struct iov_iter *iter)
 	fput(lower_file);
 	/* update upper inode times/sizes as needed */
 	if (err >= 0 || err == -EIOCBQUEUED) {
+		if (err > 0)
+			atomic64_add(err, &passthrough_write_bytes);
 		if (sizeof(loff_t) > sizeof(long))
 			inode_lock(inode);
 		fsstack_copy_inode_size(inode, file_inode(lower_file));
@@ -432,6 +480,61 @@ out:
 	return err;
 }
 
+/*
+ * In passthrough mode splice moves lower page cache pages to and from the
+ * pipe, otherwise it is done through our read_iter and write_iter.
+ */
+static ssize_t sdcardfs_splice_read(struct file *file, loff_t *ppos,
+			struct pipe_inode_info *pipe, size_t len,
+			unsigned int flags)
+{
+	ssize_t err;
+	struct file *lower_file = sdcardfs_lower_file(file);
+
+	if (!sdcardfs_passthrough(file) || !lower_file->f_op->splice_read)
+		return generic_file_splice_read(file, ppos, pipe, len, flags);
+
+	err = lower_file->f_op->splice_read(lower_file, ppos, pipe, len, flags);
+	if (err >= 0) {
+		atomic64_add(err, &passthrough_read_bytes);
+		fsstack_copy_attr_atime(file_inode(file),
+					file_inode(lower_file));
+	}
+	return err;
+}
+
+static ssize_t sdcardfs_splice_write(struct pipe_inode_info *pipe,
+			struct file *file, loff_t *ppos, size_t len,
+			unsigned int flags)
+{
+	ssize_t err;
+	struct file *lower_file = sdcardfs_lower_file(file);
+	struct inode *inode = file_inode(file);
+
+	if (!sdcardfs_passthrough(file) || !lower_file->f_op->splice_write)
+		return iter_file_splice_write(pipe, file, ppos, len, flags);
+
+	/* check disk space */
+	if (!check_min_free_space(file->f_path.dentry, len, 0)) {
+		pr_err("No minimum free space.\n");
+		return -ENOSPC;
+	}
+
+	file_start_write(lower_file);
+	err = lower_file->f_op->splice_write(pipe, lower_file, ppos, len, flags);
+	file_end_write(lower_file);
+	if (err >= 0) {
+		atomic64_add(err, &passthrough_write_bytes);
+		if (sizeof(loff_t) > sizeof(long))
+			inode_lock(inode);
+		fsstack_copy_inode_size(inode, file_inode(lower_file));
+		fsstack_copy_attr_times(inode, file_inode(lower_file));
+		if (sizeof(loff_t) > sizeof(long))
+			inode_unlock(inode);
+	}
+	return err;
+}
+
 const struct file_operations sdcardfs_main_fops = {
 	.llseek		= generic_file_llseek,
 	.read		= sdcardfs_read,
@@ -448,6 +551,8 @@ const struct file_operations sdcardfs_main_fops = {
 	.fasync		= sdcardfs_fasync,
 	.read_iter	= sdcardfs_read_iter,
 	.write_iter	= sdcardfs_write_iter,
+	.splice_read	= sdcardfs_splice_read,
+	.splice_write	= sdcardfs_splice_write,
 };
 
 /* trimmed directory options */
@@ -20,6 +20,163 @@
 
 #include "sdcardfs.h"
 #include "linux/delay.h"
+#include <linux/hashtable.h>
+
+/*
+ * Case-insensitive name cache
+ *
+ * Remembers the result of scanning a lower directory for a name that did not
+ * match exactly: the real name on the lower filesystem, or that nothing
+ * matched. An entry is trusted only while the mtime of the lower directory is
+ * unchanged. It is recorded only once the mtime is older than the current
+ * time, so that a later change can't carry the same mtime.
+ */
+#define NAME_CACHE_BITS		10
+#define NAME_CACHE_MAX		4096
+
+struct name_cache_entry {
+	struct hlist_node hlist;
+	struct list_head lru;
+	struct inode *dir;
+	unsigned long ino;
+	u32 generation;
+	struct timespec mtime;
+	unsigned int hash;
+	bool negative;
+	unsigned int len;
+	char name[DNAME_INLINE_LEN];
+};
+
+static DEFINE_HASHTABLE(name_cache, NAME_CACHE_BITS);
+static LIST_HEAD(name_cache_lru);
+static DEFINE_SPINLOCK(name_cache_lock);
+static unsigned int name_cache_count;
+
+static atomic64_t name_cache_hit = ATOMIC64_INIT(0);
+static atomic64_t name_cache_neg_hit = ATOMIC64_INIT(0);
+static atomic64_t name_cache_miss = ATOMIC64_INIT(0);
+
+static struct name_cache_entry *__name_cache_find(struct inode *dir,
+		const struct qstr *name, unsigned int hash)
+{
+	struct name_cache_entry *entry;
+	struct qstr cached;
+
+	hash_for_each_possible(name_cache, entry, hlist, hash) {
+		cached = (struct qstr)QSTR_INIT(entry->name, entry->len);
+		if (entry->hash == hash && entry->dir == dir &&
+				entry->ino == dir->i_ino &&
+				entry->generation == dir->i_generation &&
+				qstr_case_eq(name, &cached))
+			return entry;
+	}
+	return NULL;
+}
+
+static void __name_cache_del(struct name_cache_entry *entry)
+{
+	hash_del(&entry->hlist);
+	list_del(&entry->lru);
+	name_cache_count--;
+	kfree(entry);
+}
+
+/*
+ * Returns 0 and fills @real_name if a name matching @name exists in @dir,
+ * -ENOENT if none exists, or -EAGAIN if @dir has to be scanned.
+ */
+static int name_cache_lookup(struct inode *dir, const struct qstr *name,
+		char *real_name)
+{
+	unsigned int hash = full_name_case_hash(0, name->name, name->len);
+	struct name_cache_entry *entry;
+	int err = -EAGAIN;
+
+	spin_lock(&name_cache_lock);
+	entry = __name_cache_find(dir, name, hash);
+	if (!entry)
+		goto out;
+	if (!timespec_equal(&entry->mtime, &dir->i_mtime)) {
+		__name_cache_del(entry);
+		goto out;
+	}
+	list_move(&entry->lru, &name_cache_lru);
+	if (entry->negative) {
+		atomic64_inc(&name_cache_neg_hit);
+		err = -ENOENT;
+	} else {
+		atomic64_inc(&name_cache_hit);
+		memcpy(real_name, entry->name, entry->len);
+		real_name[entry->len] = 0;
+		err = 0;
+	}
+out:
+	spin_unlock(&name_cache_lock);
+	if (err == -EAGAIN)
+		atomic64_inc(&name_cache_miss);
+	return err;
+}
+
+/* @real_name is NULL if no name matching @name exists in @dir */
+static void name_cache_insert(struct inode *dir, const struct qstr *name,
+		const char *real_name)
+{
+	struct name_cache_entry *entry, *old;
+	struct timespec now = current_time(dir);
+
+	if (name->len >= DNAME_INLINE_LEN)
+		return;
+	if (timespec_equal(&now, &dir->i_mtime))
+		return;
+
+	entry = kmalloc(sizeof(*entry), GFP_KERNEL);
+	if (!entry)
+		return;
+
+	entry->dir = dir;
+	entry->ino = dir->i_ino;
+	entry->generation = dir->i_generation;
+	entry->mtime = dir->i_mtime;
+	entry->hash = full_name_case_hash(0, name->name, name->len);
+	entry->negative = !real_name;
+	entry->len = name->len;
+	memcpy(entry->name, real_name ? : (const char *)name->name, name->len);
+	entry->name[name->len] = 0;
+
+	spin_lock(&name_cache_lock);
+	old = __name_cache_find(dir, name, entry->hash);
+	if (old)
+		__name_cache_del(old);
+	if (name_cache_count >= NAME_CACHE_MAX)
+		__name_cache_del(list_last_entry(&name_cache_lru,
+					struct name_cache_entry, lru));
+	hash_add(name_cache, &entry->hlist, entry->hash);
+	list_add(&entry->lru, &name_cache_lru);
+	name_cache_count++;
+	spin_unlock(&name_cache_lock);
+}
+
+static void name_cache_destroy(void)
+{
+	struct name_cache_entry *entry, *tmp;
+
+	spin_lock(&name_cache_lock);
+	list_for_each_entry_safe(entry, tmp, &name_cache_lru, lru)
+		__name_cache_del(entry);
+	spin_unlock(&name_cache_lock);
+}
+
+ssize_t sdcardfs_lookup_cache_stat(char *page)
+{
+	return scnprintf(page, PAGE_SIZE,
+			"name_hit:%lld name_neg_hit:%lld name_miss:%lld "
+			"name_entries:%u perm_hit:%lld\n",
+			(long long)atomic64_read(&name_cache_hit),
+			(long long)atomic64_read(&name_cache_neg_hit),
+			(long long)atomic64_read(&name_cache_miss),
+			READ_ONCE(name_cache_count),
+			(long long)atomic64_read(&sdcardfs_perm_cache_hit));
+}
 
 /* The dentry cache is just so we have properly sized dentries */
 static struct kmem_cache *sdcardfs_dentry_cachep;
@@ -36,6 +193,7 @@ int sdcardfs_init_dentry_cache(void)
 
 void sdcardfs_destroy_dentry_cache(void)
 {
+	name_cache_destroy();
 	kmem_cache_destroy(sdcardfs_dentry_cachep);
 }
 
@@ -291,6 +449,18 @@ static struct dentry *__sdcardfs_lookup(struct dentry *dentry,
 			err = -ENOMEM;
 			goto out;
 		}
+
+		err = name_cache_lookup(d_inode(lower_dir_dentry), name,
+					buffer.name);
+		if (!err) {
+			err = vfs_path_lookup(lower_dir_dentry, lower_dir_mnt,
+						buffer.name, 0, &lower_path);
+			if (err != -ENOENT)
+				goto put_name;
+		} else if (err == -ENOENT) {
+			goto put_name;
+		}
+
 		file = dentry_open(lower_parent_path, O_RDONLY, cred);
 		if (IS_ERR(file)) {
 			err = PTR_ERR(file);
@@ -301,6 +471,8 @@ static struct dentry *__sdcardfs_lookup(struct dentry *dentry,
 		if (err)
 			goto put_name;
 
+		name_cache_insert(d_inode(lower_dir_dentry), name,
+				buffer.found ? buffer.name : NULL);
 		if (buffer.found)
 			err = vfs_path_lookup(lower_dir_dentry,
 						lower_dir_mnt,
@@ -35,6 +35,7 @@ enum {
 	Opt_gid_derivation,
 	Opt_default_normal,
 	Opt_nocache,
+	Opt_passthrough,
 	Opt_unshared_obb,
 	Opt_err,
 };
@@ -52,6 +53,7 @@ static const match_table_t sdcardfs_tokens = {
 	{Opt_unshared_obb, "unshared_obb"},
 	{Opt_reserved_mb, "reserved_mb=%u"},
 	{Opt_nocache, "nocache"},
+	{Opt_passthrough, "passthrough"},
 	{Opt_err, NULL}
 };
 
@@ -76,6 +78,7 @@ static int parse_options(struct super_block *sb, char *options, int silent,
 	opts->gid_derivation = false;
 	opts->default_normal = false;
 	opts->nocache = false;
+	opts->passthrough = false;
 
 	*debug = 0;
 
@@ -136,6 +139,9 @@ static int parse_options(struct super_block *sb, char *options, int silent,
 		case Opt_nocache:
 			opts->nocache = true;
 			break;
+		case Opt_passthrough:
+			opts->passthrough = true;
+			break;
 		case Opt_unshared_obb:
 			opts->unshared_obb = true;
 			break;
@@ -200,6 +206,7 @@ int parse_options_remount(struct super_block *sb, char *options, int silent,
 		case Opt_fsgid:
 		case Opt_reserved_mb:
 		case Opt_gid_derivation:
+		case Opt_passthrough:
 			if (!silent)
 				pr_warn("Option \"%s\" can't be changed during remount\n", p);
 			break;
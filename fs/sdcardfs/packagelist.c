@@ -45,7 +45,7 @@ static DEFINE_HASHTABLE(ext_to_groupid, 8);
 
 static struct kmem_cache *hashtable_entry_cachep;
 
-static unsigned int full_name_case_hash(const void *salt, const unsigned char *name, unsigned int len)
+unsigned int full_name_case_hash(const void *salt, const unsigned char *name, unsigned int len)
 {
 	unsigned long hash = init_name_hash(salt);
 
@@ -826,9 +826,27 @@ static struct configfs_attribute packages_attr_packages_gid_list = {
 
 SDCARDFS_CONFIGFS_ATTR_WO(packages_, remove_userid);
 
+static ssize_t packages_lookup_cache_stat_show(struct config_item *item,
+				       char *page)
+{
+	return sdcardfs_lookup_cache_stat(page);
+}
+
+SDCARDFS_CONFIGFS_ATTR_RO(packages_, lookup_cache_stat);
+
+static ssize_t packages_passthrough_stat_show(struct config_item *item,
+				       char *page)
+{
+	return sdcardfs_passthrough_stat(page);
+}
+
+SDCARDFS_CONFIGFS_ATTR_RO(packages_, passthrough_stat);
+
 static struct configfs_attribute *packages_attrs[] = {
 	&packages_attr_packages_gid_list,
 	&packages_attr_remove_userid,
+	&packages_attr_lookup_cache_stat,
+	&packages_attr_passthrough_stat,
 	NULL,
 };
 
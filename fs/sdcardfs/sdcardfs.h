@@ -168,6 +168,8 @@ extern int sdcardfs_init_inode_cache(void);
 extern void sdcardfs_destroy_inode_cache(void);
 extern int sdcardfs_init_dentry_cache(void);
 extern void sdcardfs_destroy_dentry_cache(void);
+extern ssize_t sdcardfs_lookup_cache_stat(char *page);
+extern ssize_t sdcardfs_passthrough_stat(char *page);
 extern int new_dentry_private_data(struct dentry *dentry);
 extern void free_dentry_private_data(struct dentry *dentry);
 extern struct dentry *sdcardfs_lookup(struct inode *dir, struct dentry *dentry,
@@ -208,6 +210,11 @@ struct sdcardfs_inode_info {
 	spinlock_t top_lock;
 	struct sdcardfs_inode_data *top_data;
 
+	/* derived permission is valid while these match, see derived_perm.c */
+	unsigned int perm_gen;
+	unsigned int perm_hash;
+	struct inode *perm_parent;
+
 	struct inode vfs_inode;
 };
 
@@ -229,6 +236,7 @@ struct sdcardfs_mount_options {
 	bool unshared_obb;
 	unsigned int reserved_mb;
 	bool nocache;
+	bool passthrough;
 };
 
 struct sdcardfs_vfsmount_options {
@@ -542,6 +550,7 @@ extern appid_t get_appid(const char *app_name);
 extern appid_t get_ext_gid(const char *app_name);
 extern appid_t is_excluded(const char *app_name, userid_t userid);
 extern int check_caller_access_to_name(struct inode *parent_node, const struct qstr *name);
+extern unsigned int full_name_case_hash(const void *salt, const unsigned char *name, unsigned int len);
 extern int packagelist_init(void);
 extern void packagelist_exit(void);
 
@@ -562,6 +571,8 @@ extern void get_derived_permission_new(struct dentry *parent,
 extern void get_derived_permission_inode_new(struct dentry *parent,
 		struct inode *inode, const struct qstr *name);
 extern void fixup_perms_recursive(struct dentry *dentry, struct limit_search *limit);
+extern atomic_t sdcardfs_perm_gen;
+extern atomic64_t sdcardfs_perm_cache_hit;
 
 extern void update_derived_permission_lock(struct dentry *dentry,
 		struct inode *inode);
@@ -318,6 +318,8 @@ static int sdcardfs_show_options(struct vfsmount *mnt, struct seq_file *m,
 		seq_printf(m, ",reserved=%uMB", opts->reserved_mb);
 	if (opts->nocache)
 		seq_printf(m, ",nocache");
+	if (opts->passthrough)
+		seq_puts(m, ",passthrough");
 
 	return 0;
 };
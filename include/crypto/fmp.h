@@ -22,6 +22,7 @@
 #define FMP_CBC_MAX_KEY_SIZE	FMP_KEY_SIZE_16
 #define FMP_XTS_MAX_KEY_SIZE	((FMP_KEY_SIZE_32) * (2))
 #define FMP_MAX_KEY_SIZE	FMP_XTS_MAX_KEY_SIZE
+#define FMP_KEY_WORDS		(FMP_MAX_KEY_SIZE / 4)
 
 #define FMP_HOST_TYPE_NAME_LEN	8
 #define FMP_BLOCK_TYPE_NAME_LEN	8
@@ -73,6 +74,13 @@ struct fmp_crypto_info {
 	enum fmp_crypto_enc_mode enc_mode;
 	enum fmp_crypto_algo_mode algo_mode;
 	void *ctx;
+	/*
+	 * File key expanded into descriptor order by setkey, so that requests
+	 * of the same key only copy it. Any other write to key must clear
+	 * key_expanded.
+	 */
+	bool key_expanded;
+	u32 key_words[FMP_KEY_WORDS];
 };
 
 #if defined(CONFIG_MMC_DW_EXYNOS_FMP)
@@ -208,6 +216,9 @@ struct fips_result {
 	bool sha256;
 	bool hmac;
 	bool integrity;
+	/* duration of the boot time checks */
+	u64 selftest_us;
+	u64 integrity_us;
 };
 #endif
 
@@ -227,10 +238,19 @@ struct fmp_test_data {
 	struct fmp_crypto_info ci;
 };
 
+/* Descriptor setup by exynos_fmp_crypt(), counted per cpu */
+struct fmp_stat {
+	u64 crypt;
+	u64 key_hit;
+	u64 setup_ns;
+	u64 setup_max_ns;
+};
+
 struct exynos_fmp {
 	struct device *dev;
 	enum fmp_disk_key_status status_disk_key;
 	struct fmp_test_data *test_data;
+	struct fmp_stat __percpu *stat;
 #ifdef CONFIG_EXYNOS_FMP_FIPS
 	struct fips_result result;
 	struct miscdevice miscdev;
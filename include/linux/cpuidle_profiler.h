@@ -16,10 +16,13 @@
 
 extern void cpuidle_profile_cpu_idle_enter(int cpu, int index);
 extern void cpuidle_profile_cpu_idle_exit(int cpu, int index, int cancel);
+extern void cpuidle_profile_cpu_idle_exit_done(int cpu, int index);
 extern void cpuidle_profile_cpu_idle_register(struct cpuidle_driver *drv);
 extern void cpuidle_profile_group_idle_enter(int id);
 extern void cpuidle_profile_group_idle_exit(int id, int cancel);
 extern void cpuidle_profile_group_idle_register(int id, const char *name);
+extern void cpuidle_profile_group_idle_residency(int id, int early);
+extern void cpuidle_profile_group_idle_prevent(int id);
 extern void cpuidle_profile_idle_ip(int index, unsigned int idle_ip);
 
 #endif /* CPUIDLE_PROFILE_H */
@@ -65,6 +65,25 @@ static inline u32 __crc32c_le_combine(u32 crc1, u32 crc2, size_t len2)
 
 #define crc32(seed, data, length)  crc32_le(seed, (unsigned char const *)(data), length)
 
+/*
+ * crc32_le_inline(), crc32c_le_inline() - crc32_le() and __crc32c_le() for
+ * hot paths, inlined with the crc instructions where the architecture has
+ * them.
+ */
+#ifdef CONFIG_ARM64
+#include <asm/crc32.h>
+#else
+static inline u32 crc32_le_inline(u32 crc, const void *p, size_t len)
+{
+	return crc32_le(crc, p, len);
+}
+
+static inline u32 crc32c_le_inline(u32 crc, const void *p, size_t len)
+{
+	return __crc32c_le(crc, p, len);
+}
+#endif
+
 /*
  * Helpers for hash table generation of ethernet nics:
  *
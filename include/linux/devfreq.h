@@ -222,7 +222,8 @@ extern struct devfreq *devfreq_get_devfreq_by_phandle(struct device *dev,
 						int index);
 
 #if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_ONDEMAND) || IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_USAGE)\
-	|| IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_INTERACTIVE)
+	|| IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_INTERACTIVE)\
+	|| IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
 struct devfreq_notifier_block {
        struct notifier_block nb;
        struct devfreq *df;
@@ -305,6 +306,37 @@ struct devfreq_simple_interactive_data {
 };
 #endif
 
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+/**
+ * struct devfreq_simple_predictive_data - void *data fed to struct devfreq
+ *	and devfreq_add_device
+ * @target_load:	Load of measured traffic which the frequency is chosen
+ *			to keep. Specify 0 to use the default.
+ * @upthreshold:	Load regarded as saturated bus, counted in late_cnt.
+ *			Specify 0 to use the default.
+ * @predict_ratio:	Percent of demand rise added to the rising demand.
+ * @down_weight:	Weight of previous prediction while demand is falling.
+ * @update_cnt:		Number of predictions with measured traffic.
+ * @ahead_cnt:		Number of predictions stepped ahead of the demand.
+ * @late_cnt:		Number of measurements with saturated bus.
+ */
+struct devfreq_simple_predictive_data {
+	unsigned int target_load;
+	unsigned int upthreshold;
+	unsigned int predict_ratio;
+	unsigned int down_weight;
+	unsigned long prev_demand;
+	unsigned long predicted;
+	unsigned long update_cnt;
+	unsigned long ahead_cnt;
+	unsigned long late_cnt;
+	int pm_qos_class;
+	int pm_qos_class_max;
+	struct devfreq_notifier_block nb;
+	struct devfreq_notifier_block nb_max;
+};
+#endif
+
 #if IS_ENABLED(CONFIG_DEVFREQ_GOV_PASSIVE)
 /**
  * struct devfreq_passive_data - void *data fed to struct devfreq
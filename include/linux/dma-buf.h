@@ -164,6 +164,21 @@ struct dma_buf_ops {
 	 * if the call would block.
 	 */
 
+	/**
+	 * @cache_sgt_mapping:
+	 *
+	 * If true, the &sg_table returned by the first map of an attachment is
+	 * kept in &dma_buf_attachment.sgt and returned again by later maps of
+	 * the same direction without calling @map_dma_buf. The mapping is
+	 * released by dma_buf_detach() or by the shrinker when it is not used.
+	 * @map_dma_buf and @unmap_dma_buf are called with &dma_buf.lock held.
+	 *
+	 * The exporter must keep the buffer coherent for the CPU in
+	 * @begin_cpu_access and @end_cpu_access because the cache maintenance
+	 * in @map_dma_buf and @unmap_dma_buf is not repeated for every use.
+	 */
+	bool cache_sgt_mapping;
+
 	/**
 	 * @release:
 	 *
@@ -222,6 +237,23 @@ struct dma_buf_ops {
 	 * to be restarted.
 	 */
 	int (*end_cpu_access)(struct dma_buf *, enum dma_data_direction);
+
+	/**
+	 * @[begin|end]_cpu_access_partial:
+	 *
+	 * This is called from dma_buf_[begin|end]_cpu_access_partial().
+	 * This is the same as [begin|end]_cpu_access, but only the range of
+	 * @len bytes from @offset needs to be coherent, so the exporter can
+	 * limit the cache maintenance to the range.
+	 *
+	 * This callback is optional.
+	 */
+	int (*begin_cpu_access_partial)(struct dma_buf *,
+					enum dma_data_direction,
+					unsigned int offset, unsigned int len);
+	int (*end_cpu_access_partial)(struct dma_buf *,
+				      enum dma_data_direction,
+				      unsigned int offset, unsigned int len);
 	void *(*map_atomic)(struct dma_buf *, unsigned long);
 	void (*unmap_atomic)(struct dma_buf *, unsigned long, void *);
 	void *(*map)(struct dma_buf *, unsigned long);
@@ -327,6 +359,9 @@ struct dma_buf {
  * @dev: device attached to the buffer.
  * @node: list of dma_buf_attachment.
  * @priv: exporter specific attachment data.
+ * @sgt: cached mapping if &dma_buf_ops.cache_sgt_mapping is set.
+ * @dir: direction of @sgt.
+ * @map_count: number of users of @sgt.
  *
  * This structure holds the attachment information between the dma_buf buffer
  * and its user device(s). The list contains one attachment struct per device
@@ -342,6 +377,9 @@ struct dma_buf_attachment {
 	struct device *dev;
 	struct list_head node;
 	void *priv;
+	struct sg_table *sgt;
+	enum dma_data_direction dir;
+	unsigned int map_count;
 };
 
 /**
@@ -416,8 +454,14 @@ void dma_buf_unmap_attachment(struct dma_buf_attachment *, struct sg_table *,
 				enum dma_data_direction);
 int dma_buf_begin_cpu_access(struct dma_buf *dma_buf,
 			     enum dma_data_direction dir);
+int dma_buf_begin_cpu_access_partial(struct dma_buf *dma_buf,
+				     enum dma_data_direction dir,
+				     unsigned int offset, unsigned int len);
 int dma_buf_end_cpu_access(struct dma_buf *dma_buf,
 			   enum dma_data_direction dir);
+int dma_buf_end_cpu_access_partial(struct dma_buf *dma_buf,
+				   enum dma_data_direction dir,
+				   unsigned int offset, unsigned int len);
 void *dma_buf_kmap_atomic(struct dma_buf *, unsigned long);
 void dma_buf_kunmap_atomic(struct dma_buf *, unsigned long, void *);
 void *dma_buf_kmap(struct dma_buf *, unsigned long);
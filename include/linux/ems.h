@@ -22,6 +22,8 @@ struct gb_qos_request {
 };
 
 #define LEAVE_BAND	0
+#define JOIN_BAND	1
+#define COLOCATE_BAND	2
 
 struct task_band {
 	int id;
@@ -34,6 +36,11 @@ struct task_band {
 
 	unsigned long util;
 	unsigned long last_update_time;
+
+	/* JOIN_BAND or COLOCATE_BAND, given by schedtune "band" attribute */
+	int mode;
+	/* cpu that member of band was placed on most recently */
+	int last_cpu;
 };
 
 #ifdef CONFIG_SCHED_EMS
@@ -42,6 +49,7 @@ extern unsigned int get_cpu_max_capacity(unsigned int cpu);
 
 /* task util initialization */
 extern void exynos_init_entity_util_avg(struct sched_entity *se);
+extern void exynos_init_util_learn(struct task_struct *p);
 
 /* active balance */
 extern int exynos_need_active_balance(enum cpu_idle_type idle,
@@ -66,13 +74,14 @@ extern void update_lbt_overutil(int cpu, unsigned long capacity);
 extern void gb_qos_update_request(struct gb_qos_request *req, u32 new_value);
 
 /* task band */
-extern void sync_band(struct task_struct *p, bool join);
+extern void sync_band(struct task_struct *p, int band);
 extern void newbie_join_band(struct task_struct *newbie);
 extern int alloc_bands(void);
 extern void update_band(struct task_struct *p, long old_util);
 extern int band_playing(struct task_struct *p, int cpu);
 #else
 static inline void exynos_init_entity_util_avg(struct sched_entity *se) { }
+static inline void exynos_init_util_learn(struct task_struct *p) { }
 
 static inline int exynos_need_active_balance(enum cpu_idle_type idle,
 				struct sched_domain *sd, int src_cpu, int dst_cpu)
@@ -103,7 +112,7 @@ static inline void update_lbt_overutil(int cpu, unsigned long capacity) { }
 
 static inline void gb_qos_update_request(struct gb_qos_request *req, u32 new_value) { }
 
-static inline void sync_band(struct task_struct *p, bool join) { }
+static inline void sync_band(struct task_struct *p, int band) { }
 static inline void newbie_join_band(struct task_struct *newbie) { }
 static inline int alloc_bands(void)
 {
@@ -11,6 +11,9 @@
  * GNU General Public License for more details.
  */
 
+#include <linux/hrtimer.h>
+#include <linux/pm_qos.h>
+
 enum stune_group {
 	STUNE_ROOT,
 	STUNE_FOREGROUND,
@@ -26,11 +29,51 @@ struct kpp {
 	bool active;
 };
 
+/*
+ * Performance service with deadline. Until the deadline expires, tasks of
+ * the group are served with prefer perf and the frequency of performance
+ * cluster is kept above min_freq.
+ */
+struct ems_deadline_req {
+	struct kpp kpp;
+	struct pm_qos_request min_qos;
+	struct hrtimer timer;
+};
+
 #ifdef CONFIG_SCHED_EMS
 /* prefer perf */
 extern int kpp_status(int grp_idx);
 extern void kpp_request(int grp_idx, struct kpp *req, int value);
+
+/* deadline service */
+extern void ems_deadline_init(struct ems_deadline_req *req);
+extern void ems_deadline_request(struct ems_deadline_req *req, int grp_idx,
+			int prefer_perf, s32 min_freq, unsigned int deadline_us);
+extern void ems_deadline_cancel(struct ems_deadline_req *req);
+extern int ems_group_deadline_request(int grp_idx, unsigned int deadline_us);
+
+/* foreground app */
+extern bool ems_task_is_topapp(struct task_struct *p);
+extern bool ems_task_is_foreground(struct task_struct *p);
 #else
 static inline int kpp_status(int grp_idx) { return 0; }
 static inline void kpp_request(int grp_idx, struct kpp *req, int value) { }
+
+static inline void ems_deadline_init(struct ems_deadline_req *req) { }
+static inline void ems_deadline_request(struct ems_deadline_req *req, int grp_idx,
+			int prefer_perf, s32 min_freq, unsigned int deadline_us) { }
+static inline void ems_deadline_cancel(struct ems_deadline_req *req) { }
+static inline int ems_group_deadline_request(int grp_idx, unsigned int deadline_us)
+{
+	return -ENODEV;
+}
+
+static inline bool ems_task_is_topapp(struct task_struct *p) { return false; }
+static inline bool ems_task_is_foreground(struct task_struct *p) { return false; }
+#endif
+
+#ifdef CONFIG_SCHED_EMS_INPUT_BOOST
+extern void ems_input_boost_frame_done(void);
+#else
+static inline void ems_input_boost_frame_done(void) { }
 #endif
@@ -283,6 +283,23 @@ int exynos_sysmmu_set_ppc_event(struct device *dev, int event);
 void exynos_sysmmu_clear_ppc_event(struct device *dev);
 void exynos_sysmmu_show_ppc_event(struct device *dev);
 
+/*
+ * exynos_sysmmu_preload() - prepare the System MMU for a buffer to be read
+ *
+ * @dev: device descriptor of master device.
+ * @iova: start of the buffer.
+ * @size: size of the buffer.
+ * @slot: index of the buffer among the ones accessed at the same time.
+ * Returns 0 if every page of the buffer is mapped, -EFAULT if not, then the
+ * device would fault on the buffer.
+ *
+ * The page table entries of the buffer are counted as TLB misses in
+ * debugfs sysmmu/tlbstat, and the private TLB way of address matching
+ * @slot, if any, prefetches the entries of the buffer.
+ */
+int exynos_sysmmu_preload(struct device *dev, dma_addr_t iova, size_t size,
+			  unsigned int slot);
+
 /*
  * iovmm_set_fault_handler - register fault handler of dev to iommu controller
  * @dev: the device that wants to register fault handler
@@ -307,6 +324,7 @@ void iovmm_set_fault_handler(struct device *dev,
 #define exynos_sysmmu_clear_ppc_event(dev) do { } while (0)
 #define exynos_sysmmu_show_ppc_event(dev) do { } while (0)
 #define exynos_sysmmu_set_ppc_event(dev, event) do { } while (0)
+#define exynos_sysmmu_preload(dev, iova, size, slot) (0)
 #define iovmm_set_fault_handler(dev, handler, token) do { } while(0)
 
 #define exynos_iommu_sync_for_device(dev, iova, len, dir) do { } while (0)
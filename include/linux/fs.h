@@ -845,6 +845,8 @@ struct file_ra_state {
 
 	unsigned int ra_pages;		/* Maximum readahead window */
 	unsigned int mmap_miss;		/* Cache miss stat for mmap accesses */
+	unsigned int mmap_ra_pages;	/* mmap read-around window, 0: max */
+	unsigned int mmap_hit;		/* pages of the window faulted in */
 	loff_t prev_pos;		/* Cache last read() position */
 };
 
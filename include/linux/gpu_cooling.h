@@ -127,6 +127,7 @@ extern int gpu_dvfs_get_voltage(int clock);
 extern int gpu_dvfs_get_step(void);
 extern int gpu_dvfs_get_cur_clock(void);
 extern int gpu_dvfs_get_utilization(void);
+extern int gpu_dvfs_get_load_residency(u64 *residency, int nr_levels);
 extern int gpu_dvfs_get_max_freq(void);
 #else
 static inline int gpu_dvfs_get_clock(int level) { return 0; }
@@ -134,6 +135,7 @@ static inline int gpu_dvfs_get_voltage(int clock) { return 0; }
 static inline int gpu_dvfs_get_step(void) { return 0; }
 static inline int gpu_dvfs_get_cur_clock(void) { return 0; }
 static inline int gpu_dvfs_get_utilization(void) { return 0; }
+static inline int gpu_dvfs_get_load_residency(u64 *residency, int nr_levels) { return 0; }
 static inline int gpu_dvfs_get_max_freq(void) { return 0; }
 #endif
 #endif /* __GPU_COOLING_H__ */
@@ -186,6 +186,20 @@ struct mem_cgroup {
 	/* vmpressure notifications */
 	struct vmpressure vmpressure;
 
+	/*
+	 * Cached app, see memory.app_cached. The cached soft limit replaces
+	 * soft_limit while the app is cached, protected by memcg_cached_lock.
+	 */
+	bool app_cached;
+	unsigned long cached_soft_limit;
+	unsigned long saved_soft_limit;
+	struct list_head cached_node;
+	/* Proactively reclaimed pages and refaults since the app got cached */
+	unsigned long cached_reclaimed;
+	unsigned long total_cached_reclaimed;
+	unsigned long cached_refault_anon;
+	unsigned long cached_refault_file;
+
 	/*
 	 * Should the accounting and control be hierarchical, per subtree?
 	 */
@@ -266,6 +280,7 @@ struct mem_cgroup {
 };
 
 extern struct mem_cgroup *root_mem_cgroup;
+extern int memcg_cached_swappiness;
 
 static inline bool mem_cgroup_disabled(void)
 {
@@ -722,6 +722,12 @@ typedef struct pglist_data {
 
 	unsigned long		flags;
 
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+	/* Foreground file pages kept in the current inactive file round */
+	unsigned long		lru_protected;
+	unsigned long		lru_protect_scanned;
+#endif
+
 	ZONE_PADDING(_pad2_)
 
 	/* Per-node vmstats */
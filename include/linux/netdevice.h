@@ -1609,6 +1609,11 @@ enum netdev_priv_flags {
  *	@gso_max_size:	Maximum size of generic segmentation offload
  *	@gso_max_segs:	Maximum number of segments that can be passed to the
  *			NIC for GSO
+ *	@link_capacity_kbps:	Capacity of the link published by the driver,
+ *				0 if unknown
+ *	@link_queue_bytes:	Bytes queued to the link published by the driver
+ *	@link_hint_paced:	Pacing rate updates capped at the link capacity
+ *	@link_hint_tsq_limited:	TSQ throttles sized by the link capacity
  *
  *	@dcbnl_ops:	Data Center Bridging netlink ops
  *	@num_tc:	Number of traffic classes in the net device
@@ -1888,6 +1893,12 @@ struct net_device {
 	unsigned int		gso_max_size;
 #define GSO_MAX_SEGS		65535
 	u16			gso_max_segs;
+#ifdef CONFIG_NET_LINK_HINT
+	unsigned int		link_capacity_kbps;
+	unsigned int		link_queue_bytes;
+	atomic_long_t		link_hint_paced;
+	atomic_long_t		link_hint_tsq_limited;
+#endif
 
 #ifdef CONFIG_DCB
 	const struct dcbnl_rtnl_ops *dcbnl_ops;
@@ -2771,6 +2782,25 @@ struct sd_flow_limit {
 extern int netdev_flow_limit_table_len;
 #endif /* CONFIG_NET_FLOW_LIMIT */
 
+#ifdef CONFIG_NET_LINK_HINT
+/*
+ * Publishes the capacity of the link of @dev and the bytes queued to it, for
+ * TCP to size its pacing rate and its small queues. 0 capacity clears it.
+ */
+static inline void netdev_set_link_hint(struct net_device *dev,
+					unsigned int capacity_kbps,
+					unsigned int queue_bytes)
+{
+	WRITE_ONCE(dev->link_capacity_kbps, capacity_kbps);
+	WRITE_ONCE(dev->link_queue_bytes, queue_bytes);
+}
+#endif
+
+#ifdef CONFIG_RPS_HEAVY_FLOW
+extern unsigned int rps_heavy_flow_kbps;
+void rps_heavy_flow_update_cpus(void);
+#endif
+
 /*
  * Incoming packets are placed on per-CPU queues
  */
@@ -2782,6 +2812,9 @@ struct softnet_data {
 	unsigned int		processed;
 	unsigned int		time_squeeze;
 	unsigned int		received_rps;
+#ifdef CONFIG_RPS_HEAVY_FLOW
+	unsigned int		rps_heavy;
+#endif
 #ifdef CONFIG_RPS
 	struct softnet_data	*rps_ipi_list;
 #endif
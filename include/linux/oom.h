@@ -114,6 +114,25 @@ extern void oom_killer_enable(void);
 extern struct task_struct *find_lock_task_mm(struct task_struct *p);
 extern void dump_tasks(struct mem_cgroup *memcg, const nodemask_t *nodemask);
 
+#ifdef CONFIG_ANDROID_LOW_MEMORY_KILLER
+extern void lowmem_mm_exit(struct mm_struct *mm);
+#else
+static inline void lowmem_mm_exit(struct mm_struct *mm) { }
+#endif
+
+#ifdef CONFIG_ANDROID_LMK_ADJ_INDEX
+extern void lmk_adj_add(struct task_struct *p);
+extern void lmk_adj_del(struct task_struct *p);
+extern void lmk_adj_replace(struct task_struct *old, struct task_struct *new);
+extern void lmk_adj_update(struct task_struct *p);
+#else
+static inline void lmk_adj_add(struct task_struct *p) { }
+static inline void lmk_adj_del(struct task_struct *p) { }
+static inline void lmk_adj_replace(struct task_struct *old,
+				   struct task_struct *new) { }
+static inline void lmk_adj_update(struct task_struct *p) { }
+#endif
+
 /* sysctls */
 extern int sysctl_oom_dump_tasks;
 extern int sysctl_oom_kill_allocating_task;
@@ -192,8 +192,16 @@ static inline void page_dup_rmap(struct page *page, bool compound)
 /*
  * Called from mm/vmscan.c to handle paging out
  */
-int page_referenced(struct page *, int is_locked,
-			struct mem_cgroup *memcg, unsigned long *vm_flags);
+int __page_referenced(struct page *, int is_locked,
+			struct mem_cgroup *memcg, unsigned long *vm_flags,
+			bool *foreground);
+
+static inline int page_referenced(struct page *page, int is_locked,
+				  struct mem_cgroup *memcg,
+				  unsigned long *vm_flags)
+{
+	return __page_referenced(page, is_locked, memcg, vm_flags, NULL);
+}
 
 bool try_to_unmap(struct page *, enum ttu_flags flags);
 
@@ -281,6 +289,14 @@ void rmap_walk_locked(struct page *page, struct rmap_walk_control *rwc);
 #define anon_vma_prepare(vma)	(0)
 #define anon_vma_link(vma)	do {} while (0)
 
+static inline int __page_referenced(struct page *page, int is_locked,
+				    struct mem_cgroup *memcg,
+				    unsigned long *vm_flags, bool *foreground)
+{
+	*vm_flags = 0;
+	return 0;
+}
+
 static inline int page_referenced(struct page *page, int is_locked,
 				  struct mem_cgroup *memcg,
 				  unsigned long *vm_flags)
@@ -428,6 +428,8 @@ struct ontime_entity {
 	struct ontime_avg avg;
 	int migrating;
 	int cpu;
+	/* key of the learned init util table, given at fork */
+	u32 learn_key;
 };
 
 struct sched_statistics {
@@ -1258,6 +1260,11 @@ struct task_struct {
 #ifdef CONFIG_MMU
 	struct task_struct		*oom_reaper_list;
 #endif
+#ifdef CONFIG_ANDROID_LMK_ADJ_INDEX
+	/* lowmemorykiller candidate index, linked for group leaders only */
+	struct hlist_node		lmk_adj_node;
+	int				lmk_adj_bucket;
+#endif
 #ifdef CONFIG_VMAP_STACK
 	struct vm_struct		*stack_vm_area;
 #endif
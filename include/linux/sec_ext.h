@@ -47,6 +47,7 @@ extern void sec_bootstat_get_cpuinfo(int *freq, int *online);
 extern void sec_bootstat_get_thermal(int *temp);
 
 #define DEVICE_INIT_TIME_100MS 100000
+#define DEVICE_PROBE_TIME_10MS 10000
 extern struct list_head device_init_time_list;
 
 struct device_init_time_entry { 
@@ -55,10 +56,15 @@ struct device_init_time_entry {
 	unsigned long long duration; 
 };
 
+extern void sec_bootstat_add_device_init(struct device_init_time_entry *entry);
+extern void sec_bootstat_add_probe(const char *drv, const char *dev,
+		unsigned long long duration);
+
 #else
 #define sec_bootstat_mct_start(a)		do { } while (0)
 #define sec_bootstat_add(a)			do { } while (0)
 #define sec_bootstat_add_initcall(a)		do { } while (0)
+#define sec_bootstat_add_probe(a, b, c)		do { } while (0)
 
 #define sec_bootstat_get_cpuinfo(a, b)		do { } while (0)
 #define sec_bootstat_get_thermal(a)		do { } while (0)
@@ -175,6 +175,14 @@ enum {
 	SWP_SCANNING	= (1 << 11),	/* refcount in scan_swap_map */
 };
 
+/* Swapin readahead policy of a swap device */
+enum {
+	SWAP_RA_READAHEAD,	/* read ahead around every fault */
+	SWAP_RA_SEQUENTIAL,	/* read ahead once faults look sequential */
+	SWAP_RA_NONE,		/* never read ahead */
+	NR_SWAP_RA_POLICY,
+};
+
 #define SWAP_CLUSTER_MAX 32UL
 #define COMPACT_CLUSTER_MAX SWAP_CLUSTER_MAX
 
@@ -236,6 +244,7 @@ struct swap_info_struct {
 	unsigned char *swap_map;	/* vmalloc'ed array of usage counts */
 	struct swap_cluster_info *cluster_info; /* cluster info. Only for SSD */
 	struct swap_cluster_list free_clusters; /* free clusters list */
+	unsigned int ra_policy;		/* SWAP_RA_* swapin readahead policy */
 	unsigned int lowest_bit;	/* index of first free in swap_map */
 	unsigned int highest_bit;	/* index of last free in swap_map */
 	unsigned int pages;		/* total of usable pages of swap */
@@ -346,6 +355,17 @@ extern unsigned long pgdat_reclaimable_pages(struct pglist_data *pgdat);
 extern unsigned long try_to_free_pages(struct zonelist *zonelist, int order,
 					gfp_t gfp_mask, nodemask_t *mask);
 extern int __isolate_lru_page(struct page *page, isolate_mode_t mode);
+#ifdef CONFIG_PROCESS_RECLAIM
+enum reclaim_type {
+	RECLAIM_FILE,
+	RECLAIM_ANON,
+	RECLAIM_ALL,
+};
+
+extern unsigned long reclaim_pages_from_list(struct list_head *page_list);
+extern unsigned long reclaim_task(struct task_struct *task,
+				  enum reclaim_type type);
+#endif
 extern unsigned long try_to_free_mem_cgroup_pages(struct mem_cgroup *memcg,
 						  unsigned long nr_pages,
 						  gfp_t gfp_mask,
@@ -373,6 +393,12 @@ extern void check_move_unevictable_pages(struct page **, int nr_pages);
 extern int kswapd_run(int nid);
 extern void kswapd_stop(int nid);
 
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+extern void lru_protect_update_task(struct task_struct *p);
+#else
+static inline void lru_protect_update_task(struct task_struct *p) { }
+#endif
+
 #ifdef CONFIG_SWAP
 
 #include <linux/blk_types.h> /* for bio_end_io_t */
@@ -468,6 +494,9 @@ extern int page_swapcount(struct page *);
 extern int __swp_swapcount(swp_entry_t entry);
 extern int swp_swapcount(swp_entry_t entry);
 extern struct swap_info_struct *page_swap_info(struct page *);
+extern struct swap_info_struct *swp_swap_info(swp_entry_t entry);
+extern ssize_t swap_ra_policy_show(char *buf);
+extern int swap_ra_policy_store(unsigned int type, const char *policy);
 extern bool reuse_swap_page(struct page *, int *);
 extern int try_to_free_swap(struct page *);
 struct backing_dev_info;
@@ -629,6 +658,10 @@ static inline int mem_cgroup_swappiness(struct mem_cgroup *memcg)
 	if (mem_cgroup_disabled() || !memcg->css.parent)
 		return vm_swappiness;
 
+	/* Cached apps are compressed to zram before their file pages go */
+	if (memcg->app_cached && memcg_cached_swappiness >= 0)
+		return memcg_cached_swappiness;
+
 	return memcg->swappiness;
 }
 
@@ -7,8 +7,9 @@
 #include <linux/mutex.h>
 
 #define SWAP_SLOTS_CACHE_SIZE			SWAP_BATCH
-#define THRESHOLD_ACTIVATE_SWAP_SLOTS_CACHE	(5*SWAP_SLOTS_CACHE_SIZE)
-#define THRESHOLD_DEACTIVATE_SWAP_SLOTS_CACHE	(2*SWAP_SLOTS_CACHE_SIZE)
+#define SWAP_SLOTS_CACHE_SIZE_MAX		(4*SWAP_BATCH)
+#define THRESHOLD_ACTIVATE_SWAP_SLOTS_CACHE	(5*swap_slots_cache_size)
+#define THRESHOLD_DEACTIVATE_SWAP_SLOTS_CACHE	(2*swap_slots_cache_size)
 
 struct swap_slots_cache {
 	bool		lock_initialized;
@@ -27,5 +28,6 @@ int enable_swap_slots_cache(void);
 int free_swap_slot(swp_entry_t entry);
 
 extern bool swap_slot_cache_enabled;
+extern int swap_slots_cache_size;
 
 #endif /* _LINUX_SWAP_SLOTS_H */
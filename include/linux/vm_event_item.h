@@ -28,6 +28,7 @@ enum vm_event_item { PGPGIN, PGPGOUT, PSWPIN, PSWPOUT,
 		FOR_ALL_ZONES(PGSCAN_SKIP),
 		PGFREE, PGACTIVATE, PGDEACTIVATE, PGLAZYFREE,
 		PGFAULT, PGMAJFAULT,
+		PGREADAROUND, PGREADAROUND_HIT, PGREADAROUND_WASTE,
 		PGLAZYFREED,
 		PGREFILL,
 		PGSTEAL_KSWAPD,
@@ -35,6 +36,14 @@ enum vm_event_item { PGPGIN, PGPGOUT, PSWPIN, PSWPOUT,
 		PGSCAN_KSWAPD,
 		PGSCAN_DIRECT,
 		PGSCAN_DIRECT_THROTTLE,
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+		PGPROTECT,
+		PGPROTECT_RESCUED,
+#endif
+#if CONFIG_KSWAPD_WORKERS
+		PGSTEAL_KSWAPD_WORKER,
+		PGSCAN_KSWAPD_WORKER,
+#endif
 #ifdef CONFIG_NUMA
 		PGSCAN_ZONE_RECLAIM_FAILED,
 #endif
@@ -109,6 +118,7 @@ enum vm_event_item { PGPGIN, PGPGOUT, PSWPIN, PSWPOUT,
 #ifdef CONFIG_SWAP
 		SWAP_RA,
 		SWAP_RA_HIT,
+		SWAP_RA_SKIP,
 #endif
 		NR_VM_EVENT_ITEMS
 };
@@ -10,6 +10,13 @@
 #include <linux/cgroup.h>
 #include <linux/eventfd.h>
 
+/* From queueing a notification to signalling its eventfds */
+struct vmpressure_latency {
+	unsigned long nr;
+	u64 total_ns;
+	u64 max_ns;
+};
+
 struct vmpressure {
 	unsigned long scanned;
 	unsigned long reclaimed;
@@ -26,6 +33,22 @@ struct vmpressure {
 	struct mutex events_lock;
 
 	struct work_struct work;
+
+	/*
+	 * Stall based pressure: time the tasks of the memcg spent in direct
+	 * reclaim and compaction since the start of the current window.
+	 */
+	u64 stall_ns;
+	u64 stall_start;
+	/* Lowest threshold of the stall events, 0 if there are none */
+	u64 stall_thresh_min;
+	struct work_struct stall_work;
+
+	/* Protected by sr_lock, when the works were queued */
+	u64 queued;
+	u64 stall_queued;
+	struct vmpressure_latency level_latency;
+	struct vmpressure_latency stall_latency;
 };
 
 struct mem_cgroup;
@@ -34,6 +57,7 @@ struct mem_cgroup;
 extern void vmpressure(gfp_t gfp, struct mem_cgroup *memcg, bool tree,
 		       unsigned long scanned, unsigned long reclaimed);
 extern void vmpressure_prio(gfp_t gfp, struct mem_cgroup *memcg, int prio);
+extern void vmpressure_stall(gfp_t gfp, u64 stall_ns);
 
 extern void vmpressure_init(struct vmpressure *vmpr);
 extern void vmpressure_cleanup(struct vmpressure *vmpr);
@@ -44,10 +68,13 @@ extern int vmpressure_register_event(struct mem_cgroup *memcg,
 				     const char *args);
 extern void vmpressure_unregister_event(struct mem_cgroup *memcg,
 					struct eventfd_ctx *eventfd);
+struct seq_file;
+extern void vmpressure_stats_show(struct seq_file *m, struct vmpressure *vmpr);
 #else
 static inline void vmpressure(gfp_t gfp, struct mem_cgroup *memcg, bool tree,
 			      unsigned long scanned, unsigned long reclaimed) {}
 static inline void vmpressure_prio(gfp_t gfp, struct mem_cgroup *memcg,
 				   int prio) {}
+static inline void vmpressure_stall(gfp_t gfp, u64 stall_ns) {}
 #endif /* CONFIG_MEMCG */
 #endif /* __LINUX_VMPRESSURE_H */
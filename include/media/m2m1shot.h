@@ -54,6 +54,10 @@ struct m2m1shot_task;
  * @current_task: indicate the task that is currently being processed
  * @ops		: callback functions that the client device driver must
  *                implement according to the events.
+ * @batch_count	: number of batches processed by M2M1SHOT_IOC_PROCESS_BATCH
+ * @batch_tasks	: number of tasks processed in the batches
+ * @batch_time_us: sum of the elapsed time of the batches
+ * @batch_max	: the largest number of tasks in a batch
  */
 struct m2m1shot_device {
 	struct miscdevice misc;
@@ -65,6 +69,10 @@ struct m2m1shot_device {
 	unsigned long timeout_jiffies;	/* timeout jiffies for a task */
 	struct m2m1shot_task *current_task; /* current working task */
 	const struct m2m1shot_devops *ops;
+	unsigned long batch_count;
+	unsigned long batch_tasks;
+	u64 batch_time_us;
+	unsigned int batch_max;
 };
 
 /**
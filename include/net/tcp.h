@@ -270,6 +270,9 @@ extern int sysctl_tcp_recovery;
 #define TCP_RACK_LOSS_DETECTION  0x1 /* Use RACK to detect losses */
 
 extern int sysctl_tcp_limit_output_bytes;
+#ifdef CONFIG_NET_LINK_HINT
+extern int sysctl_tcp_link_hint_queue_us;
+#endif
 extern int sysctl_tcp_challenge_ack_limit;
 extern int sysctl_tcp_min_tso_segs;
 extern int sysctl_tcp_min_rtt_wlen;
@@ -1159,6 +1162,19 @@ static inline unsigned int tcp_packets_in_flight(const struct tcp_sock *tp)
 
 #define TCP_INFINITE_SSTHRESH	0x7fffffff
 
+#ifdef CONFIG_NET_LINK_HINT
+/* The device of the route of @sk if its driver publishes the link capacity */
+static inline struct net_device *tcp_link_hint_dev(struct sock *sk)
+{
+	struct dst_entry *dst = __sk_dst_get(sk);
+
+	if (dst && dst->dev && READ_ONCE(dst->dev->link_capacity_kbps))
+		return dst->dev;
+
+	return NULL;
+}
+#endif
+
 static inline bool tcp_in_slow_start(const struct tcp_sock *tp)
 {
 	return tp->snd_cwnd < tp->snd_ssthresh;
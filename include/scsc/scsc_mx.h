@@ -347,6 +347,7 @@ u16 scsc_service_get_alignment(struct scsc_service *service);
 #ifdef CONFIG_SCSC_QOS
 int scsc_service_pm_qos_add_request(struct scsc_service *service, enum scsc_qos_config config);
 int scsc_service_pm_qos_update_request(struct scsc_service *service, enum scsc_qos_config config);
+int scsc_service_pm_qos_update_request_tput(struct scsc_service *service, u32 tput_mbps);
 int scsc_service_pm_qos_remove_request(struct scsc_service *service);
 #endif
 
@@ -1,8 +1,29 @@
 #ifndef __ACPM_IPC_CTRL_H__
 #define __ACPM_IPC_CTRL_H__
 
+#include <linux/list.h>
+#include <linux/types.h>
+
 typedef void (*ipc_callback)(unsigned int *cmd, unsigned int size);
 
+struct acpm_ipc_async_req;
+typedef void (*acpm_ipc_done_fn)(struct acpm_ipc_async_req *req, int err);
+
+/*
+ * Asynchronous IPC request. The response is copied to cmd, which must be
+ * as large as the channel queue element, and done is called in the context
+ * that collects the response. The request must stay valid until done.
+ */
+struct acpm_ipc_async_req {
+	struct list_head list;
+	unsigned int *cmd;
+	acpm_ipc_done_fn done;
+	void *data;
+
+	unsigned int seq_num;
+	u64 submit_time;
+};
+
 struct ipc_config {
 	unsigned int *cmd;
 	unsigned int *indirection_base;
@@ -29,6 +50,8 @@ unsigned int acpm_ipc_request_channel(struct device_node *np, ipc_callback handl
 unsigned int acpm_ipc_release_channel(struct device_node *np, unsigned int channel_id);
 int acpm_ipc_send_data(unsigned int channel_id, struct ipc_config *cfg);
 int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_config *cfg);
+int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_config *cfg,
+		struct acpm_ipc_async_req *req);
 int acpm_ipc_set_ch_mode(struct device_node *np, bool polling);
 void exynos_acpm_reboot(void);
 void acpm_stop_log(void);
@@ -55,6 +78,12 @@ static inline int acpm_ipc_send_data_sync(unsigned int channel_id, struct ipc_co
 	return 0;
 }
 
+static inline int acpm_ipc_send_data_async(unsigned int channel_id, struct ipc_config *cfg,
+		struct acpm_ipc_async_req *req)
+{
+	return 0;
+}
+
 static inline int acpm_ipc_set_ch_mode(struct device_node *np, bool polling)
 {
 	return 0;
@@ -400,10 +400,14 @@ struct ect_info
 	char *block_name;
 	int block_name_length;
 	int (*parser)(void *address, struct ect_info *info);
+	int (*index)(struct ect_info *info);
 	int (*dump)(struct seq_file *s, void *data);
 	struct file_operations dump_ops;
 	char *dump_node_name;
 	void *block_handle;
+	void *block_address;
+	bool block_indexed;
+	u64 block_parse_ns;
 	int block_precedence;
 };
 
@@ -14,6 +14,7 @@
 /* BCM DUMP format definition */
 #define BCM_DUMP_PRE_DEFINE_SHIFT		(16)
 #define BCM_DUMP_MAX_STR			(4 * 1024)
+#define BCM_DUMP_VALID_SHIFT			(31)
 
 struct exynos_bcm_out_data {
 	u32				ccnt;
@@ -33,10 +34,40 @@ struct exynos_bcm_dump_info {
 	struct exynos_bcm_out_data	out_data;
 } __attribute__((packed));
 
+/*
+ * Continuous sampling ring, mapped read only by userspace.
+ * head is the number of samples written so far, entry[head % nr_entries] is
+ * the next slot to be written.
+ */
+struct exynos_bcm_sample {
+	u64				time;
+	u32				dump_seq_no;
+	u32				dump_time;
+	u32				ip_index;
+	u32				defined_event;
+	struct exynos_bcm_out_data	out_data;
+};
+
+struct exynos_bcm_sample_ring {
+	u32				head;
+	u32				nr_entries;
+	u32				entry_size;
+	u32				period;
+	struct exynos_bcm_sample	entry[0];
+};
+
 #ifdef CONFIG_EXYNOS_BCM_DBG_DUMP
 int exynos_bcm_dbg_buffer_dump(struct exynos_bcm_dbg_data *data, bool klog);
 #else
 #define exynos_bcm_dbg_buffer_dump(a, b) do {} while (0)
 #endif
 
+#ifdef CONFIG_EXYNOS_BCM_DBG_SAMPLE
+int exynos_bcm_dbg_sample_init(struct exynos_bcm_dbg_data *data);
+void exynos_bcm_dbg_sample_exit(struct exynos_bcm_dbg_data *data);
+#else
+#define exynos_bcm_dbg_sample_init(a) do {} while (0)
+#define exynos_bcm_dbg_sample_exit(a) do {} while (0)
+#endif
+
 #endif	/* __EXYNOS_BCM_DBG_DUMP_H_ */
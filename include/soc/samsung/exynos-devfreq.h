@@ -27,6 +27,7 @@
 
 /* DEVFREQ GOV TYPE */
 #define SIMPLE_INTERACTIVE 0
+#define SIMPLE_PREDICTIVE 1
 
 struct exynos_devfreq_opp_table {
 	u32 idx;
@@ -57,6 +58,10 @@ struct exynos_devfreq_data {
 	void					*governor_data;
 #if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_INTERACTIVE)
 	struct devfreq_simple_interactive_data	simple_interactive_data;
+#endif
+#if IS_ENABLED(CONFIG_DEVFREQ_GOV_SIMPLE_PREDICTIVE)
+	struct devfreq_simple_predictive_data	simple_predictive_data;
+	void __iomem				*ppmu_base;
 #endif
 	u32					dfs_id;
 	s32					old_idx;
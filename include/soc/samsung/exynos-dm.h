@@ -113,6 +113,17 @@ struct exynos_dm_data {
 	struct list_head		min_clist;
 	struct list_head		max_clist;
 	u32				constraint_checked;
+
+	/* constraints applied to this domain, cached at registration */
+	bool				cache_valid;
+	int				min_cache_count;
+	int				max_cache_count;
+	struct exynos_dm_constraint	**min_cache;
+	struct exynos_dm_constraint	**max_cache;
+
+	/* solver state to skip the same request */
+	u64				solved_gen;
+	u32				solved_req_freq;
 #ifdef CONFIG_EXYNOS_ACPM
 	u32				cal_id;
 #endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __EXYNOS_FRAMETRACE_H
+#define __EXYNOS_FRAMETRACE_H
+
+#include <linux/jump_label.h>
+#include <linux/types.h>
+
+struct dma_buf;
+
+/*
+ * Steps of a buffer through the camera, GPU, MFC and DECON pipelines. The
+ * info of a record is the video node for CAM, the atom id for GPU, the
+ * context for MFC and the window for DPU.
+ */
+enum exynos_frametrace_stage {
+	EXYNOS_FRAMETRACE_CAM_QBUF,
+	EXYNOS_FRAMETRACE_CAM_DONE,
+	EXYNOS_FRAMETRACE_GPU_START,
+	EXYNOS_FRAMETRACE_GPU_DONE,
+	EXYNOS_FRAMETRACE_MFC_QBUF,
+	EXYNOS_FRAMETRACE_MFC_DONE,
+	EXYNOS_FRAMETRACE_DPU_QUEUE,
+	EXYNOS_FRAMETRACE_DPU_SCANOUT,
+	EXYNOS_FRAMETRACE_STAGES,
+};
+
+#ifdef CONFIG_EXYNOS_FRAMETRACE
+extern struct static_key_false exynos_frametrace_key;
+
+void __exynos_frametrace(struct dma_buf *dmabuf,
+			 enum exynos_frametrace_stage stage, u32 info);
+
+/* A nop branch unless enabled in /sys/kernel/debug/exynos-frametrace */
+static inline void exynos_frametrace(struct dma_buf *dmabuf,
+				     enum exynos_frametrace_stage stage,
+				     u32 info)
+{
+	if (static_branch_unlikely(&exynos_frametrace_key) && dmabuf)
+		__exynos_frametrace(dmabuf, stage, info);
+}
+
+static inline bool exynos_frametrace_enabled(void)
+{
+	return static_branch_unlikely(&exynos_frametrace_key);
+}
+#else
+static inline void exynos_frametrace(struct dma_buf *dmabuf,
+				     enum exynos_frametrace_stage stage,
+				     u32 info) {}
+
+static inline bool exynos_frametrace_enabled(void)
+{
+	return false;
+}
+#endif
+
+#endif /* __EXYNOS_FRAMETRACE_H */
@@ -27,6 +27,8 @@
 #include <linux/slab.h>
 #include <linux/mutex.h>
 #include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
 
 #include <linux/mfd/samsung/core.h>
 #if defined(CONFIG_EXYNOS_BCM_DBG)
@@ -72,6 +74,27 @@ struct exynos_pm_domain {
 #endif
 	bool power_down_skipped;
 	unsigned int need_smc;
+
+	/* on/off latency, protected by access_lock */
+	unsigned int on_count;
+	unsigned int off_count;
+	u64 on_total_ns;
+	u64 off_total_ns;
+	u64 on_max_ns;
+	u64 off_max_ns;
+
+	/*
+	 * Adaptive power-off delay, learned from the intervals between an off
+	 * request and the next on request. Disabled if off_delay_max_ms is 0.
+	 */
+	unsigned int off_delay_max_ms;
+	unsigned int off_delay_ms;	/* delay of the last off request */
+	ktime_t off_request;		/* time of the last off request */
+	u64 reuse_avg_ns;		/* average off to on interval */
+	bool power_off_deferred;
+	struct delayed_work off_work;
+	unsigned int deferred_hits;	/* powered on again in time */
+	unsigned int deferred_misses;	/* powered off while held on */
 };
 
 struct exynos_pd_dbg_info {
@@ -85,6 +108,7 @@ struct exynos_pd_dbg_info {
 #ifdef CONFIG_EXYNOS_PD
 struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name);
 int exynos_pd_status(struct exynos_pm_domain *pd);
+void exynos_pd_show_power_domain(void);
 #else
 static inline struct exynos_pm_domain *exynos_pd_lookup_name(const char *domain_name)
 {
@@ -94,6 +118,9 @@ static inline int exynos_pd_status(struct exynos_pm_domain *pd)
 {
 	return NULL;
 }
+static inline void exynos_pd_show_power_domain(void)
+{
+}
 #endif
 
 #ifdef CONFIG_SND_SOC_SAMSUNG_VTS
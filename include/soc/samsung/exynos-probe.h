@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __EXYNOS_PROBE_H
+#define __EXYNOS_PROBE_H
+
+#include <linux/device.h>
+
+/*
+ * Probe type of the drivers which are not needed before the first frame,
+ * e.g. codecs, audio and debug drivers. They are probed asynchronously,
+ * off the boot path, unless CONFIG_EXYNOS_ASYNC_PROBE is disabled.
+ */
+#ifdef CONFIG_EXYNOS_ASYNC_PROBE
+#define EXYNOS_PROBE_NONCRITICAL	PROBE_PREFER_ASYNCHRONOUS
+#else
+#define EXYNOS_PROBE_NONCRITICAL	PROBE_DEFAULT_STRATEGY
+#endif
+
+#endif /* __EXYNOS_PROBE_H */
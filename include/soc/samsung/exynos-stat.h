@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __EXYNOS_STAT_H
+#define __EXYNOS_STAT_H
+
+#include <linux/bitops.h>
+#include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/percpu.h>
+#include <linux/types.h>
+
+#define EXYNOS_STAT_NAME_LEN		32
+/* bucket n > 0 counts the values of [2^(n-1), 2^n), the last one the rest */
+#define EXYNOS_STAT_HIST_BUCKETS	32
+
+/*
+ * Counters and log2 histograms of a driver. The hot paths add to the slots
+ * of their cpu, with no lock nor atomic, in any context, and the readers sum
+ * the slots of the possible cpus, so that nothing is lost on cpu hotplug.
+ */
+struct exynos_stat {
+	char			name[EXYNOS_STAT_NAME_LEN];
+	const char * const	*counters;
+	const char * const	*hists;
+	unsigned int		nr_counters;
+	unsigned int		nr_hists;
+	u64 __percpu		*slots;
+	struct list_head	node;
+	struct dentry		*dentry;
+};
+
+/*
+ * Binary export of every stat, /sys/kernel/debug/exynos-stat/all: a header,
+ * then a record per stat followed by its nr_counters counters and its
+ * nr_hists histograms of hist_buckets values, all u64 in cpu endianness.
+ */
+#define EXYNOS_STAT_MAGIC	0x45535441	/* "ESTA" */
+#define EXYNOS_STAT_VERSION	1
+
+struct exynos_stat_header {
+	u32	magic;
+	u32	version;
+	u32	nr_stats;
+	u32	hist_buckets;
+};
+
+struct exynos_stat_record {
+	char	name[EXYNOS_STAT_NAME_LEN];
+	u32	nr_counters;
+	u32	nr_hists;
+	u64	values[0];
+};
+
+#ifdef CONFIG_EXYNOS_STAT
+/* Returns NULL on failure, which the updates then ignore */
+struct exynos_stat *exynos_stat_create(const char *name,
+		const char * const *counters, unsigned int nr_counters,
+		const char * const *hists, unsigned int nr_hists);
+void exynos_stat_destroy(struct exynos_stat *stat);
+void exynos_stat_reset(struct exynos_stat *stat);
+u64 exynos_stat_read(struct exynos_stat *stat, unsigned int counter);
+
+static inline void exynos_stat_add(struct exynos_stat *stat,
+				   unsigned int counter, u64 val)
+{
+	if (stat)
+		this_cpu_add(stat->slots[counter], val);
+}
+
+static inline void exynos_stat_hist(struct exynos_stat *stat,
+				    unsigned int hist, u64 val)
+{
+	unsigned int bucket = min_t(unsigned int, fls64(val),
+				    EXYNOS_STAT_HIST_BUCKETS - 1);
+
+	if (stat)
+		this_cpu_inc(stat->slots[stat->nr_counters +
+				hist * EXYNOS_STAT_HIST_BUCKETS + bucket]);
+}
+#else
+static inline struct exynos_stat *exynos_stat_create(const char *name,
+		const char * const *counters, unsigned int nr_counters,
+		const char * const *hists, unsigned int nr_hists)
+{
+	return NULL;
+}
+
+static inline void exynos_stat_destroy(struct exynos_stat *stat) {}
+static inline void exynos_stat_reset(struct exynos_stat *stat) {}
+
+static inline u64 exynos_stat_read(struct exynos_stat *stat,
+				   unsigned int counter)
+{
+	return 0;
+}
+
+static inline void exynos_stat_add(struct exynos_stat *stat,
+				   unsigned int counter, u64 val) {}
+static inline void exynos_stat_hist(struct exynos_stat *stat,
+				    unsigned int hist, u64 val) {}
+#endif
+
+static inline void exynos_stat_inc(struct exynos_stat *stat,
+				   unsigned int counter)
+{
+	exynos_stat_add(stat, counter, 1);
+}
+
+#endif /* __EXYNOS_STAT_H */
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __EXYNOS_TIMESYNC_H
+#define __EXYNOS_TIMESYNC_H
+
+#include <linux/timekeeping.h>
+#include <linux/types.h>
+
+/*
+ * Time base shared by the AP and the subsystems (CHUB, ABOX, CP): the
+ * system counter, which the subsystems read too, is mapped to CLOCK_BOOTTIME
+ * without any IPC. The clients report pairs of local and remote timestamps
+ * taken at the same time, from which the drift of their time base is kept.
+ */
+struct exynos_timesync_client;
+
+#ifdef CONFIG_EXYNOS_TIMESYNC
+extern u64 exynos_timesync_cycles(void);
+extern u64 exynos_timesync_cycles_to_boottime(u64 cycles);
+extern u64 exynos_timesync_boottime(void);
+
+extern struct exynos_timesync_client *exynos_timesync_register(const char *name);
+extern void exynos_timesync_unregister(struct exynos_timesync_client *client);
+extern void exynos_timesync_sample(struct exynos_timesync_client *client,
+		u64 local_ns, u64 remote_ns);
+extern s64 exynos_timesync_offset(struct exynos_timesync_client *client);
+#else
+static inline u64 exynos_timesync_cycles(void)
+{
+	return 0;
+}
+
+static inline u64 exynos_timesync_cycles_to_boottime(u64 cycles)
+{
+	return ktime_get_boot_ns();
+}
+
+static inline u64 exynos_timesync_boottime(void)
+{
+	return ktime_get_boot_ns();
+}
+
+static inline struct exynos_timesync_client *
+exynos_timesync_register(const char *name)
+{
+	return NULL;
+}
+
+static inline void exynos_timesync_unregister(struct exynos_timesync_client *client) {}
+
+static inline void exynos_timesync_sample(struct exynos_timesync_client *client,
+		u64 local_ns, u64 remote_ns) {}
+
+static inline s64 exynos_timesync_offset(struct exynos_timesync_client *client)
+{
+	return 0;
+}
+#endif
+
+#endif /* __EXYNOS_TIMESYNC_H */
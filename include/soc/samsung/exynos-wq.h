@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2018 Samsung Electronics Co., Ltd.
+ *		http://www.samsung.com
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __EXYNOS_WQ_H
+#define __EXYNOS_WQ_H
+
+#include <linux/workqueue.h>
+
+/*
+ * Unbound workqueue bound to the little cluster, for the background works
+ * of the drivers which would otherwise run on whatever cpu queued them.
+ */
+#ifdef CONFIG_EXYNOS_LITTLE_WQ
+extern struct workqueue_struct *exynos_little_wq;
+#else
+#define exynos_little_wq	system_power_efficient_wq
+#endif
+
+#endif /* __EXYNOS_WQ_H */
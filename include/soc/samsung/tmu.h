@@ -12,6 +12,8 @@
 #ifndef __ASM_ARCH_TMU_H
 #define __ASM_ARCH_TMU_H
 
+#include <linux/thermal.h>
+
 #define EXYNOS_MAX_TEMP		125
 #define EXYNOS_MIN_TEMP		10
 #define EXYNOS_COLD_TEMP	15
@@ -47,11 +49,18 @@ enum isp_noti_state_t {
 
 #ifdef CONFIG_EXYNOS_THERMAL
 extern int exynos_tmu_add_notifier(struct notifier_block *n);
+extern int exynos_tmu_get_headroom(const char *tmu_name, int *headroom,
+				enum thermal_trend *trend);
 #else
 static inline int exynos_tmu_add_notifier(struct notifier_block *n)
 {
 	return 0;
 }
+static inline int exynos_tmu_get_headroom(const char *tmu_name, int *headroom,
+				enum thermal_trend *trend)
+{
+	return -ENODEV;
+}
 #endif
 #if defined(CONFIG_GPU_THERMAL)
 extern int exynos_gpu_add_notifier(struct notifier_block *n);
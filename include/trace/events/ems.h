@@ -154,6 +154,31 @@ TRACE_EVENT(ems_global_boost,
 	TP_printk("name=%s global_boost=%d", __entry->name, __entry->boost)
 );
 
+/*
+ * Tracepoint for global boost thermal admission
+ */
+TRACE_EVENT(ems_global_boost_admit,
+
+	TP_PROTO(int headroom, int trend, int scale),
+
+	TP_ARGS(headroom, trend, scale),
+
+	TP_STRUCT__entry(
+		__field(	int,	headroom	)
+		__field(	int,	trend		)
+		__field(	int,	scale		)
+	),
+
+	TP_fast_assign(
+		__entry->headroom	= headroom;
+		__entry->trend		= trend;
+		__entry->scale		= scale;
+	),
+
+	TP_printk("headroom=%d trend=%d scale=%d",
+		__entry->headroom, __entry->trend, __entry->scale)
+);
+
 /*
  * Tracepoint for prefer idle
  */
@@ -467,6 +492,36 @@ TRACE_EVENT(ems_prefer_perf_service,
 	TP_printk("comm=%s pid=%d util=%lu service_cpu=%d event=%s",
 			__entry->comm, __entry->pid, __entry->util, __entry->service_cpu, __entry->event)
 );
+
+TRACE_EVENT(ems_freqvar_pred,
+
+	TP_PROTO(struct task_struct *p, int group, int cpu,
+			unsigned long predicted, unsigned long actual),
+
+	TP_ARGS(p, group, cpu, predicted, actual),
+
+	TP_STRUCT__entry(
+		__array( char,		comm,		TASK_COMM_LEN	)
+		__field( pid_t,		pid				)
+		__field( int,		group				)
+		__field( int,		cpu				)
+		__field( unsigned long,	predicted			)
+		__field( unsigned long,	actual				)
+	),
+
+	TP_fast_assign(
+		memcpy(__entry->comm, p->comm, TASK_COMM_LEN);
+		__entry->pid			= p->pid;
+		__entry->group			= group;
+		__entry->cpu			= cpu;
+		__entry->predicted		= predicted;
+		__entry->actual			= actual;
+	),
+
+	TP_printk("comm=%s pid=%d group=%d cpu=%d predicted=%lu actual=%lu",
+			__entry->comm, __entry->pid, __entry->group, __entry->cpu,
+			__entry->predicted, __entry->actual)
+);
 #endif /* _TRACE_EMS_H */
 
 /* This part must be outside protection */
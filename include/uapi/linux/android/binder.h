@@ -183,6 +183,15 @@ struct binder_buffer_object {
 
 enum {
 	BINDER_BUFFER_FLAG_HAS_PARENT = 0x01,
+	/*
+	 * @buffer holds a dma-buf fd instead of an address. The first
+	 * @length bytes of the dma-buf are mapped into the target buffer
+	 * in place of a copy, and @buffer is rewritten to their address
+	 * in the target. The mapping is page aligned, so it takes up to
+	 * ALIGN(@length, PAGE_SIZE) + PAGE_SIZE bytes of the extra buffers
+	 * space of the transaction.
+	 */
+	BINDER_BUFFER_FLAG_DMA_BUF = 0x02,
 };
 
 /* struct binder_fd_array_object - object describing an array of fds in a buffer
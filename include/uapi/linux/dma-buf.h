@@ -35,8 +35,17 @@ struct dma_buf_sync {
 #define DMA_BUF_SYNC_VALID_FLAGS_MASK \
 	(DMA_BUF_SYNC_RW | DMA_BUF_SYNC_END)
 
+/* begin/end cpu access of [offset, offset + len) of the dma-buf */
+struct dma_buf_sync_partial {
+	__u64 flags;
+	__u32 offset;
+	__u32 len;
+};
+
 #define DMA_BUF_BASE		'b'
 #define DMA_BUF_IOCTL_SYNC	_IOW(DMA_BUF_BASE, 0, struct dma_buf_sync)
+#define DMA_BUF_IOCTL_SYNC_PARTIAL	\
+		_IOW(DMA_BUF_BASE, 15, struct dma_buf_sync_partial)
 
 /*
  * create a dma-buf that is a container of the given dma-bufs.
@@ -114,7 +114,29 @@ struct m2m1shot_custom_data {
 	unsigned long arg;
 };
 
+/*
+ * Batch of tasks processed by a single M2M1SHOT_IOC_PROCESS_BATCH.
+ * All tasks in a batch should have the same formats and operation except
+ * the buffers. The tasks are chained by the driver without returning to
+ * the user until the last task finishes. Every task in @tasks is written
+ * back to the user with its result in the same way as M2M1SHOT_IOC_PROCESS.
+ *
+ * @tasks	: user address of the array of struct m2m1shot
+ * @num_tasks	: number of tasks in @tasks, up to M2M1SHOT_MAX_BATCH
+ * @num_done	: [out] number of tasks completed successfully
+ * @elapsed_us	: [out] time elapsed from submission to the last completion
+ */
+#define M2M1SHOT_MAX_BATCH 32
+
+struct m2m1shot_batch {
+	unsigned long tasks;
+	__u32 num_tasks;
+	__u32 num_done;
+	__u64 elapsed_us;
+};
+
 #define M2M1SHOT_IOC_PROCESS	_IOWR('M',  0, struct m2m1shot)
+#define M2M1SHOT_IOC_PROCESS_BATCH _IOWR('M', 1, struct m2m1shot_batch)
 #define M2M1SHOT_IOC_CUSTOM	_IOWR('M', 16, struct m2m1shot_custom_data)
 
 #endif /* _UAPI__M2M1SHOT_H_ */
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note */
+#ifndef _UAPI_LINUX_SCHED_WALT_RING_H
+#define _UAPI_LINUX_SCHED_WALT_RING_H
+
+#include <linux/types.h>
+
+/*
+ * WALT window samples exported through mmap of /dev/walt_ring.
+ *
+ * The mapping holds WALT_RING_NR_GROUPS rings, one per schedtune group
+ * index, each WALT_RING_SIZE bytes long. A ring starts with a header
+ * followed by WALT_RING_NR_ENTRIES samples.
+ *
+ * Producers reserve a slot and write the sample lock-free. seq of a sample
+ * is odd while the sample is being written. A reader should read seq, copy
+ * the sample, and read seq again; the copy is valid only if both reads
+ * return the same even value. seq >> 1 is the position of the sample in
+ * the ring, so samples can be ordered and lost samples detected.
+ */
+#define WALT_RING_VERSION	1
+#define WALT_RING_NR_GROUPS	8
+#define WALT_RING_NR_ENTRIES	255
+#define WALT_RING_SIZE		8192
+
+struct walt_ring_sample {
+	__u32 seq;
+	__s32 pid;
+	__u64 window_start;	/* ns */
+	__u32 demand;		/* ns, scaled to max capacity */
+	__u32 busy;		/* ns of the concluded window, scaled */
+	__u16 cpu;
+	__u16 freq_scale;	/* current frequency, 1024 is max */
+	__u32 samples;		/* number of windows the busy time covers */
+};
+
+struct walt_ring_header {
+	__u32 version;
+	__u32 nr_entries;
+	__u64 head;		/* position of the latest sample + 1 */
+	__u32 reserved[4];
+};
+
+struct walt_ring {
+	struct walt_ring_header hdr;
+	struct walt_ring_sample samples[WALT_RING_NR_ENTRIES];
+};
+
+#endif /* _UAPI_LINUX_SCHED_WALT_RING_H */
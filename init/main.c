@@ -974,7 +974,7 @@ static int __init_or_module do_one_initcall_sec_debug(initcall_t fn)
 			return -ENOMEM;
 		}
 		entry->duration = duration;
-		list_add(&entry->next, &device_init_time_list);
+		sec_bootstat_add_device_init(entry);
 		printk(KERN_DEBUG "initcall %pF returned %d after %lld usecs\n",
 			 fn, ret, duration);
 	}
@@ -43,6 +43,9 @@
 #include <linux/kernel.h>
 #include <linux/debugfs.h>
 #include <linux/seq_file.h>
+#include <linux/bitmap.h>
+#include <linux/math64.h>
+#include <linux/sched/clock.h>
 
 #include <linux/uaccess.h>
 #include <linux/export.h>
@@ -57,6 +60,17 @@ struct pm_qos_object {
 	struct pm_qos_constraints *constraints;
 	struct miscdevice pm_qos_power_miscdev;
 	char *name;
+
+	/* statistics */
+	int pm_qos_class;
+	u64 update_count;
+	u64 change_count;
+	u64 notify_count;
+	u64 last_update_count;
+	u64 last_stat_time;
+
+	/* batched notification */
+	s32 notified_value;
 };
 
 static DEFINE_SPINLOCK(pm_qos_lock);
@@ -605,10 +619,11 @@ static int pm_qos_dbg_show_requests(struct seq_file *s, void *unused)
 			state = "Active";
 		}
 		tot_reqs++;
-		seq_printf(s, "%d: %d: %s(%s:%d)\n", tot_reqs,
+		seq_printf(s, "%d: %d: %s(%s:%d) updates=%u\n", tot_reqs,
 			   (req->node).prio, state,
 			   req->func,
-			   req->line);
+			   req->line,
+			   req->update_count);
 	}
 
 	seq_printf(s, "Type=%s, Value=%d, Requests: active=%d / total=%d\n",
@@ -632,6 +647,173 @@ static const struct file_operations pm_qos_debug_fops = {
 	.release        = single_release,
 };
 
+/*
+ * Batched notification. For the classes that opt in, the notifiers are not
+ * called in the context of the request but deferred to the next tick, so
+ * requests updated at high rate are notified once per tick with the latest
+ * target value.
+ */
+static DECLARE_BITMAP(pm_qos_batched, PM_QOS_NUM_CLASSES);
+static DECLARE_BITMAP(pm_qos_notify_pending, PM_QOS_NUM_CLASSES);
+
+static void pm_qos_batch_work_fn(struct work_struct *work);
+static DECLARE_DELAYED_WORK(pm_qos_batch_work, pm_qos_batch_work_fn);
+
+static void pm_qos_batch_work_fn(struct work_struct *work)
+{
+	struct pm_qos_object *qos;
+	int pm_qos_class;
+	s32 value;
+
+	for_each_set_bit(pm_qos_class, pm_qos_notify_pending, PM_QOS_NUM_CLASSES) {
+		if (!test_and_clear_bit(pm_qos_class, pm_qos_notify_pending))
+			continue;
+
+		qos = pm_qos_array[pm_qos_class];
+		value = pm_qos_read_value(qos->constraints);
+
+		/* the value went back to what the notifiers already know */
+		if (value == READ_ONCE(qos->notified_value))
+			continue;
+
+		WRITE_ONCE(qos->notified_value, value);
+		qos->notify_count++;
+		qos->pm_qos_class = pm_qos_class;
+		blocking_notifier_call_chain(qos->constraints->notifiers,
+					     (unsigned long)value,
+					     (void *)&qos->pm_qos_class);
+	}
+}
+
+/*
+ * pm_qos_update_target() is shared with device PM QoS, so the class is taken
+ * from the request only if the constraints belong to the class.
+ */
+static struct pm_qos_object *pm_qos_object_of(struct pm_qos_constraints *c,
+					struct plist_node *node)
+{
+	struct pm_qos_request *req = container_of(node, struct pm_qos_request, node);
+	int pm_qos_class = req->pm_qos_class;
+
+	if (pm_qos_class <= PM_QOS_RESERVED || pm_qos_class >= PM_QOS_NUM_CLASSES)
+		return NULL;
+
+	if (pm_qos_array[pm_qos_class]->constraints != c)
+		return NULL;
+
+	return pm_qos_array[pm_qos_class];
+}
+
+/**
+ * pm_qos_set_batched - defers notifiers of the class to once per tick
+ * @pm_qos_class: class to be configured
+ * @batched: true to batch notifications, false to notify synchronously
+ *
+ * Watchers of batched class are notified up to one tick later than the
+ * change of the target value, while pm_qos_request() always returns the
+ * current value.
+ */
+int pm_qos_set_batched(int pm_qos_class, bool batched)
+{
+	struct pm_qos_object *qos;
+
+	if (pm_qos_class <= PM_QOS_RESERVED || pm_qos_class >= PM_QOS_NUM_CLASSES)
+		return -EINVAL;
+
+	qos = pm_qos_array[pm_qos_class];
+	if (qos->constraints->type == PM_QOS_FORCE_MAX)
+		return -EINVAL;
+
+	if (batched) {
+		WRITE_ONCE(qos->notified_value, pm_qos_read_value(qos->constraints));
+		set_bit(pm_qos_class, pm_qos_batched);
+	} else {
+		clear_bit(pm_qos_class, pm_qos_batched);
+		flush_delayed_work(&pm_qos_batch_work);
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(pm_qos_set_batched);
+
+/*
+ * Shows the update statistics of all classes. The rate is the number of
+ * updates per second since the previous read.
+ */
+static int pm_qos_dbg_show_stat(struct seq_file *s, void *unused)
+{
+	struct pm_qos_object *qos;
+	u64 now = sched_clock();
+	u64 update_count, rate;
+	unsigned long flags;
+	int i;
+
+	seq_printf(s, "%-28s %10s %10s %10s %8s %s\n", "class",
+			"updates", "changes", "notifies", "rate/s", "batched");
+
+	for (i = PM_QOS_CPU_DMA_LATENCY; i < PM_QOS_NUM_CLASSES; i++) {
+		qos = pm_qos_array[i];
+
+		spin_lock_irqsave(&pm_qos_lock, flags);
+		update_count = qos->update_count;
+		rate = 0;
+		if (qos->last_stat_time && now > qos->last_stat_time)
+			rate = div64_u64((update_count - qos->last_update_count) *
+					NSEC_PER_SEC, now - qos->last_stat_time);
+		qos->last_update_count = update_count;
+		qos->last_stat_time = now;
+		spin_unlock_irqrestore(&pm_qos_lock, flags);
+
+		seq_printf(s, "%-28s %10llu %10llu %10llu %8llu %d\n", qos->name,
+				update_count, qos->change_count, qos->notify_count,
+				rate, test_bit(i, pm_qos_batched));
+	}
+
+	return 0;
+}
+
+static int pm_qos_dbg_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, pm_qos_dbg_show_stat, inode->i_private);
+}
+
+/* "<class name> <0|1>" configures batched notification of the class */
+static ssize_t pm_qos_dbg_stat_write(struct file *file, const char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	char kbuf[48], name[32];
+	unsigned int batched;
+	int i, ret;
+
+	if (count >= sizeof(kbuf))
+		return -EINVAL;
+
+	if (copy_from_user(kbuf, buf, count))
+		return -EFAULT;
+	kbuf[count] = '\0';
+
+	if (sscanf(kbuf, "%31s %u", name, &batched) != 2)
+		return -EINVAL;
+
+	for (i = PM_QOS_CPU_DMA_LATENCY; i < PM_QOS_NUM_CLASSES; i++) {
+		if (strcmp(pm_qos_array[i]->name, name))
+			continue;
+
+		ret = pm_qos_set_batched(i, !!batched);
+		return ret ? ret : count;
+	}
+
+	return -EINVAL;
+}
+
+static const struct file_operations pm_qos_stat_fops = {
+	.open		= pm_qos_dbg_stat_open,
+	.read		= seq_read,
+	.write		= pm_qos_dbg_stat_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 /**
  * pm_qos_update_target - manages the constraints list and calls the notifiers
  *  if needed
@@ -648,9 +830,12 @@ int pm_qos_update_target(struct pm_qos_constraints *c, struct plist_node *node,
 {
 	unsigned long flags;
 	int prev_value, curr_value, new_value;
+	struct pm_qos_object *qos = pm_qos_object_of(c, node);
 	int ret;
 
 	spin_lock_irqsave(&pm_qos_lock, flags);
+	if (qos)
+		qos->update_count++;
 	prev_value = pm_qos_get_value(c);
 	if (value == PM_QOS_DEFAULT_VALUE)
 		new_value = c->default_value;
@@ -679,6 +864,8 @@ int pm_qos_update_target(struct pm_qos_constraints *c, struct plist_node *node,
 
 	curr_value = pm_qos_get_value(c);
 	pm_qos_set_value(c, curr_value);
+	if (qos && prev_value != curr_value)
+		qos->change_count++;
 
 	spin_unlock_irqrestore(&pm_qos_lock, flags);
 
@@ -695,10 +882,16 @@ int pm_qos_update_target(struct pm_qos_constraints *c, struct plist_node *node,
 		struct pm_qos_request *req = container_of(node, struct pm_qos_request, node);
 
 		ret = 1;
-		if (c->notifiers)
+		if (qos && test_bit(req->pm_qos_class, pm_qos_batched)) {
+			if (!test_and_set_bit(req->pm_qos_class, pm_qos_notify_pending))
+				schedule_delayed_work(&pm_qos_batch_work, 1);
+		} else if (c->notifiers) {
+			if (qos)
+				qos->notify_count++;
 			blocking_notifier_call_chain(c->notifiers,
 						     (unsigned long)curr_value,
 						     (void *)&req->pm_qos_class);
+		}
 	} else {
 		ret = 0;
 	}
@@ -819,6 +1012,8 @@ static void __pm_qos_update_request(struct pm_qos_request *req,
 {
 	trace_pm_qos_update_request(req->pm_qos_class, new_value);
 
+	req->update_count++;
+
 	if (new_value != req->node.prio)
 		pm_qos_update_target(
 			pm_qos_array[req->pm_qos_class]->constraints,
@@ -924,6 +1119,7 @@ void pm_qos_update_request_timeout(struct pm_qos_request *req, s32 new_value,
 
 	trace_pm_qos_update_request_timeout(req->pm_qos_class,
 					    new_value, timeout_us);
+	req->update_count++;
 	if (new_value != req->node.prio)
 		pm_qos_update_target(
 			pm_qos_array[req->pm_qos_class]->constraints,
@@ -1113,6 +1309,8 @@ static int __init pm_qos_power_init(void)
 	d = debugfs_create_dir("pm_qos", NULL);
 	if (IS_ERR_OR_NULL(d))
 		d = NULL;
+	else
+		debugfs_create_file("stat", 0644, d, NULL, &pm_qos_stat_fops);
 
 	for (i = PM_QOS_CPU_DMA_LATENCY; i < PM_QOS_NUM_CLASSES; i++) {
 		ret = register_pm_qos_misc(pm_qos_array[i], d);
@@ -32,6 +32,9 @@ int vprintk_store(int facility, int level,
 __printf(1, 0) int vprintk_default(const char *fmt, va_list args);
 __printf(1, 0) int vprintk_deferred(const char *fmt, va_list args);
 __printf(1, 0) int vprintk_func(const char *fmt, va_list args);
+#ifdef CONFIG_PRINTK_DEFERRED_FLUSH
+__printf(1, 0) int vprintk_stage(const char *fmt, va_list args);
+#endif
 void __printk_safe_enter(void);
 void __printk_safe_exit(void);
 
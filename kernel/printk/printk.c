@@ -48,6 +48,10 @@
 #include <linux/sched/clock.h>
 #include <linux/sched/debug.h>
 #include <linux/sched/task_stack.h>
+#include <linux/kthread.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/topology.h>
 
 #include <linux/uaccess.h>
 #include <asm/sections.h>
@@ -2110,6 +2114,165 @@ int vprintk_store(int facility, int level,
 			  dict, dictlen, text, text_len);
 }
 
+#ifdef CONFIG_PRINTK_DEFERRED_FLUSH
+/*
+ * The consoles are written by the printk_flush thread, on the little
+ * cluster, and printk() only stores the messages. A printk() which finds
+ * logbuf_lock contended stages its message in a per-CPU buffer rather than
+ * spinning, see vprintk_stage().
+ */
+static bool printk_deferred_flush = true;
+module_param_named(deferred_flush, printk_deferred_flush, bool,
+		   S_IRUGO | S_IWUSR);
+
+static struct task_struct *printk_flush_task;
+static unsigned long printk_flush_pending;
+
+static struct {
+	atomic_long_t	deferred;	/* printk()s handed to the thread */
+	atomic_long_t	staged;		/* messages staged per CPU */
+	atomic_long_t	dropped;	/* staged messages lost, buffer full */
+	atomic_long_t	flushes;	/* console flushes of the thread */
+} printk_flush_stats;
+
+static bool printk_flush_offload(void)
+{
+	return READ_ONCE(printk_deferred_flush) &&
+	       READ_ONCE(printk_flush_task) && !oops_in_progress &&
+	       system_state == SYSTEM_RUNNING;
+}
+
+static void printk_flush_wake(void)
+{
+	if (!test_and_set_bit(0, &printk_flush_pending))
+		wake_up_process(printk_flush_task);
+}
+
+static int printk_flush_thread(void *data)
+{
+	while (!kthread_should_stop()) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (!test_and_clear_bit(0, &printk_flush_pending)) {
+			schedule();
+			continue;
+		}
+		__set_current_state(TASK_RUNNING);
+
+		atomic_long_inc(&printk_flush_stats.flushes);
+		/* console_unlock() prints everything stored meanwhile */
+		console_lock();
+		console_unlock();
+	}
+	__set_current_state(TASK_RUNNING);
+
+	return 0;
+}
+
+static int printk_flush_stats_show(struct seq_file *m, void *v)
+{
+	seq_printf(m, "deferred: %ld\n",
+		   atomic_long_read(&printk_flush_stats.deferred));
+	seq_printf(m, "staged: %ld\n",
+		   atomic_long_read(&printk_flush_stats.staged));
+	seq_printf(m, "dropped: %ld\n",
+		   atomic_long_read(&printk_flush_stats.dropped));
+	seq_printf(m, "flushes: %ld\n",
+		   atomic_long_read(&printk_flush_stats.flushes));
+
+	return 0;
+}
+
+static int printk_flush_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, printk_flush_stats_show, NULL);
+}
+
+static const struct file_operations printk_flush_stats_fops = {
+	.open		= printk_flush_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init printk_flush_init(void)
+{
+	struct task_struct *task;
+
+	task = kthread_create(printk_flush_thread, NULL, "printk_flush");
+	if (IS_ERR(task)) {
+		pr_err("failed to start printk_flush, %ld\n",
+		       PTR_ERR(task));
+		return PTR_ERR(task);
+	}
+
+	set_cpus_allowed_ptr(task, topology_core_cpumask(0));
+	wake_up_process(task);
+	smp_store_release(&printk_flush_task, task);
+
+	debugfs_create_file("printk_flush", 0444, NULL, NULL,
+			    &printk_flush_stats_fops);
+
+	return 0;
+}
+late_initcall(printk_flush_init);
+
+/*
+ * Stores the message for the printk_flush thread to print it. When
+ * logbuf_lock is contended, the message of a printk() is staged, but the
+ * ones of /dev/kmsg and dev_printk() wait for the lock: their facility,
+ * level and dictionary are not in their text.
+ */
+static bool printk_flush_defer(int facility, int level,
+			       const char *dict, size_t dictlen,
+			       const char *fmt, va_list args, int *printed_len)
+{
+	unsigned long flags;
+
+	if (!printk_flush_offload())
+		return false;
+
+	printk_safe_enter_irqsave(flags);
+	if (raw_spin_trylock(&logbuf_lock)) {
+		*printed_len = vprintk_store(facility, level, dict, dictlen,
+					     fmt, args);
+		raw_spin_unlock(&logbuf_lock);
+		printk_safe_exit_irqrestore(flags);
+	} else {
+		printk_safe_exit_irqrestore(flags);
+
+		if (facility || dict || level != LOGLEVEL_DEFAULT)
+			return false;
+
+		*printed_len = vprintk_stage(fmt, args);
+		if (*printed_len)
+			atomic_long_inc(&printk_flush_stats.staged);
+		else
+			atomic_long_inc(&printk_flush_stats.dropped);
+	}
+
+	atomic_long_inc(&printk_flush_stats.deferred);
+	printk_flush_wake();
+
+	return true;
+}
+#else
+static bool printk_flush_offload(void)
+{
+	return false;
+}
+
+static void printk_flush_wake(void)
+{
+}
+
+static bool printk_flush_defer(int facility, int level,
+			       const char *dict, size_t dictlen,
+			       const char *fmt, va_list args, int *printed_len)
+{
+	return false;
+}
+#endif /* CONFIG_PRINTK_DEFERRED_FLUSH */
+
 asmlinkage int vprintk_emit(int facility, int level,
 			    const char *dict, size_t dictlen,
 			    const char *fmt, va_list args)
@@ -2126,6 +2289,11 @@ asmlinkage int vprintk_emit(int facility, int level,
 	boot_delay_msec(level);
 	printk_delay();
 
+	/* If called from the scheduler, we can not wake the thread up */
+	if (!in_sched && printk_flush_defer(facility, level, dict, dictlen,
+					    fmt, args, &printed_len))
+		return printed_len;
+
 	/* This stops the holder of console_sem just where we want him */
 	logbuf_lock_irqsave(flags);
 	printed_len = vprintk_store(facility, level, dict, dictlen, fmt, args);
@@ -3088,7 +3256,9 @@ static void wake_up_klogd_work_func(struct irq_work *irq_work)
 
 	if (pending & PRINTK_PENDING_OUTPUT) {
 		/* If trylock fails, someone else is doing the printing */
-		if (console_trylock())
+		if (printk_flush_offload())
+			printk_flush_wake();
+		else if (console_trylock())
 			console_unlock();
 	}
 
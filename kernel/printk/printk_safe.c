@@ -65,6 +65,10 @@ static DEFINE_PER_CPU(int, printk_context);
 static DEFINE_PER_CPU(struct printk_safe_seq_buf, nmi_print_seq);
 #endif
 
+#ifdef CONFIG_PRINTK_DEFERRED_FLUSH
+static DEFINE_PER_CPU(struct printk_safe_seq_buf, staged_print_seq);
+#endif
+
 /* Get flushed in a more safe context. */
 static void queue_flush_work(struct printk_safe_seq_buf *s)
 {
@@ -268,6 +272,9 @@ void printk_safe_flush(void)
 	for_each_possible_cpu(cpu) {
 #ifdef CONFIG_PRINTK_NMI
 		__printk_safe_flush(&per_cpu(nmi_print_seq, cpu).work);
+#endif
+#ifdef CONFIG_PRINTK_DEFERRED_FLUSH
+		__printk_safe_flush(&per_cpu(staged_print_seq, cpu).work);
 #endif
 		__printk_safe_flush(&per_cpu(safe_print_seq, cpu).work);
 	}
@@ -366,6 +373,21 @@ static __printf(1, 0) int vprintk_safe(const char *fmt, va_list args)
 	return printk_safe_log_store(s, fmt, args);
 }
 
+#ifdef CONFIG_PRINTK_DEFERRED_FLUSH
+/*
+ * printk() for a contended logbuf_lock, when the consoles are flushed by
+ * the printk_flush thread. The message is staged in a per-CPU buffer and
+ * moved into the main ring buffer by IRQ work, instead of spinning on the
+ * lock behind the other CPUs. Returns 0 when the buffer is full.
+ */
+__printf(1, 0) int vprintk_stage(const char *fmt, va_list args)
+{
+	struct printk_safe_seq_buf *s = this_cpu_ptr(&staged_print_seq);
+
+	return printk_safe_log_store(s, fmt, args);
+}
+#endif
+
 /* Can be preempted by NMI. */
 void __printk_safe_enter(void)
 {
@@ -420,6 +442,11 @@ void __init printk_safe_init(void)
 		s = &per_cpu(nmi_print_seq, cpu);
 		init_irq_work(&s->work, __printk_safe_flush);
 #endif
+
+#ifdef CONFIG_PRINTK_DEFERRED_FLUSH
+		s = &per_cpu(staged_print_seq, cpu);
+		init_irq_work(&s->work, __printk_safe_flush);
+#endif
 	}
 
 	/* Make sure that IRQ works are initialized before enabling. */
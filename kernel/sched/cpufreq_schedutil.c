@@ -309,11 +309,16 @@ static void sugov_update_commit(struct sugov_policy *sg_policy, u64 time,
 
 #ifdef CONFIG_FREQVAR_TUNE
 unsigned int freqvar_tipping_point(int cpu, unsigned int freq);
+unsigned long freqvar_pred_util(int cpu);
 #else
 static inline unsigned int freqvar_tipping_point(int cpu, unsigned int freq)
 {
 	return  freq + (freq >> 2);
 }
+static inline unsigned long freqvar_pred_util(int cpu)
+{
+	return 0;
+}
 #endif
 
 /**
@@ -429,6 +434,7 @@ static void sugov_get_util(unsigned long *util, unsigned long *max, int cpu)
 	rt = sched_get_rt_rq_util(cpu);
 
 	*util = boosted_cpu_util(cpu, rt);
+	*util = max(*util, freqvar_pred_util(cpu));
 	*util = min(*util, max_cap);
 	*max = max_cap;
 }
@@ -33,15 +33,30 @@ int band_play_cpu(struct task_struct *p)
 {
 	struct task_band *band;
 	int cpu, min_cpu = -1;
+	int last_cpu;
 	unsigned long min_util = ULONG_MAX;
 
 	band = lookup_band(p);
 	if (!band)
 		return -1;
 
+	/*
+	 * In colocate mode, members of band prefer the cpu on which the band
+	 * ran most recently, because it is likely to have the shared data in
+	 * its cache.
+	 */
+	last_cpu = READ_ONCE(band->last_cpu);
+	if (band->mode == COLOCATE_BAND && cpu_selected(last_cpu) &&
+	    cpumask_test_cpu(last_cpu, &band->playable_cpus) &&
+	    cpumask_test_cpu(last_cpu, tsk_cpus_allowed(p)) &&
+	    !cpu_rq(last_cpu)->nr_running)
+		return last_cpu;
+
 	for_each_cpu(cpu, &band->playable_cpus) {
-		if (!cpu_rq(cpu)->nr_running)
-			return cpu;
+		if (!cpu_rq(cpu)->nr_running) {
+			min_cpu = cpu;
+			break;
+		}
 
 		if (cpu_util(cpu) < min_util) {
 			min_cpu = cpu;
@@ -49,13 +64,68 @@ int band_play_cpu(struct task_struct *p)
 		}
 	}
 
+	if (cpu_selected(min_cpu))
+		WRITE_ONCE(band->last_cpu, min_cpu);
+
 	return min_cpu;
 }
 
+/*
+ * Ratio of coregroup capacity that band can occupy. When the band already
+ * plays on a coregroup, the band stays in it up to the stay ratio so that
+ * the band does not ping-pong between coregroups around the boundary.
+ */
+static int colocate_fit_ratio = 80;
+static int colocate_stay_ratio = 90;
+
+static bool band_fits_coregroup(struct task_band *band, int cpu, int ratio)
+{
+	unsigned long capacity;
+
+	capacity = capacity_orig_of(cpu) * cpumask_weight(cpu_coregroup_mask(cpu));
+
+	return band->util * 100 < capacity * ratio;
+}
+
+/*
+ * Colocate mode places all members of band on a single coregroup, which
+ * shares the last level cache, if combined utilization of band fits in it.
+ */
+static void pick_colocate_cpus(struct task_band *band)
+{
+	int cpu, target = -1;
+	int last_cpu = band->last_cpu;
+
+	if (cpu_selected(last_cpu) &&
+	    band_fits_coregroup(band, last_cpu, colocate_stay_ratio))
+		target = last_cpu;
+
+	if (!cpu_selected(target)) {
+		/* Find the slowest coregroup that can cover the band */
+		for_each_online_cpu(cpu) {
+			if (cpu != cpumask_first(cpu_coregroup_mask(cpu)))
+				continue;
+
+			target = cpu;
+			if (band_fits_coregroup(band, cpu, colocate_fit_ratio))
+				break;
+		}
+	}
+
+	if (cpu_selected(target))
+		cpumask_and(&band->playable_cpus, cpu_online_mask,
+				cpu_coregroup_mask(target));
+}
+
 static void pick_playable_cpus(struct task_band *band)
 {
 	cpumask_clear(&band->playable_cpus);
 
+	if (band->mode == COLOCATE_BAND) {
+		pick_colocate_cpus(band);
+		return;
+	}
+
 	/* pick condition should be fixed */
 	if (band->util < 442) // LIT up-threshold * 2
 		cpumask_and(&band->playable_cpus, cpu_online_mask, cpu_coregroup_mask(0));
@@ -119,7 +189,7 @@ static struct task_band *bands[MAX_NUM_BAND_ID];
 DEFINE_RWLOCK(band_rwlock);
 
 #define band_playing(band)	(band->tgid >= 0)
-static void join_band(struct task_struct *p)
+static void join_band(struct task_struct *p, int mode)
 {
 	struct task_band *band;
 	int pos, empty = -1;
@@ -155,8 +225,11 @@ static void join_band(struct task_struct *p)
 		band = bands[empty];
 
 	raw_spin_lock(&band->lock);
-	if (!band_playing(band))
+	if (!band_playing(band)) {
 		band->tgid = p->tgid;
+		band->last_cpu = -1;
+	}
+	band->mode = mode;
 	list_add(&p->band_members, &band->members);
 	rcu_assign_pointer(p->band, band);
 	band->member_count++;
@@ -197,10 +270,10 @@ static void leave_band(struct task_struct *p)
 	write_unlock(&band_rwlock);
 }
 
-void sync_band(struct task_struct *p, bool join)
+void sync_band(struct task_struct *p, int band)
 {
-	if (join)
-		join_band(p);
+	if (band != LEAVE_BAND)
+		join_band(p, band);
 	else
 		leave_band(p);
 }
@@ -250,6 +323,8 @@ int alloc_bands(void)
 		raw_spin_lock_init(&band->lock);
 		INIT_LIST_HEAD(&band->members);
 		band->member_count = 0;
+		band->mode = JOIN_BAND;
+		band->last_cpu = -1;
 		cpumask_clear(&band->playable_cpus);
 
 		bands[pos] = band;
@@ -278,6 +278,8 @@ int exynos_wakeup_balance(struct task_struct *p, int prev_cpu, int sd_flag, int
 	 * The "task band" is a function that groups tasks on a per-process basis
 	 * and assigns them to a specific cpu or cluster. If the attribute "band"
 	 * of schedtune.cgroup is set to '1', task band operate on this cgroup.
+	 * If it is set to '2', all tasks of the band are packed on a single
+	 * coregroup as long as the combined utilization fits in it.
 	 */
 	target_cpu = band_play_cpu(p);
 	if (cpu_selected(target_cpu)) {
@@ -345,6 +347,10 @@ int exynos_wakeup_balance(struct task_struct *p, int prev_cpu, int sd_flag, int
 		strcpy(state, "proper cpu");
 
 out:
+	if (!(sd_flag & SD_BALANCE_FORK))
+		freqvar_pred_task_wakeup(p, cpu_selected(target_cpu) ?
+						target_cpu : prev_cpu);
+
 	trace_ems_wakeup_balance(p, target_cpu, state);
 	return target_cpu;
 }
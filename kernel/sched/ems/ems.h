@@ -25,6 +25,8 @@ extern int global_boosting(struct task_struct *p);
 extern int global_boosted(void);
 extern int select_energy_cpu(struct task_struct *p, int prev_cpu, int sd_flag, int sync);
 extern unsigned int calculate_energy(struct task_struct *p, int target_cpu);
+extern void calculate_energy_batch(struct task_struct *p,
+			struct cpumask *candidates, unsigned int *energy);
 extern int band_play_cpu(struct task_struct *p);
 
 #ifdef CONFIG_SCHED_TUNE
@@ -45,6 +47,15 @@ extern unsigned int get_cpu_max_capacity(unsigned int cpu);
 
 extern unsigned long boosted_task_util(struct task_struct *p);
 
+extern void init_util_learned_load(struct task_struct *parent,
+				struct sched_entity *se);
+
+#ifdef CONFIG_FREQVAR_TUNE
+extern void freqvar_pred_task_wakeup(struct task_struct *p, int cpu);
+#else
+static inline void freqvar_pred_task_wakeup(struct task_struct *p, int cpu) { }
+#endif
+
 static inline struct task_struct *task_of(struct sched_entity *se)
 {
 	return container_of(se, struct task_struct, se);
@@ -62,6 +62,103 @@ struct eco_env {
 	int prev_cpu;
 };
 
+/*
+ * Compact copy of the energy table for energy computation in wakeup path.
+ * Capacity and power of each state are kept in separate contiguous arrays
+ * and only the first cpu of each coregroup owns a lookup table. nr_states
+ * is the number of states reachable under current policy->max, and it is
+ * updated only when cpufreq policy is changed.
+ */
+struct energy_lut {
+	unsigned int nr_states;
+	unsigned int max_states;
+	unsigned int *cap;
+	unsigned int *power;
+};
+static DEFINE_PER_CPU_SHARED_ALIGNED(struct energy_lut, energy_lut);
+
+static inline struct energy_lut *get_energy_lut(int cpu)
+{
+	return &per_cpu(energy_lut, cpumask_first(cpu_coregroup_mask(cpu)));
+}
+
+/*
+ * Compute the energy of coregroup led by group_cpu when task is assigned to
+ * target cpu. util is the utilization of each cpu excluding task.
+ */
+static unsigned int
+calculate_group_energy(struct task_struct *p, int group_cpu,
+			unsigned long *util, int target_cpu)
+{
+	struct energy_lut *lut = get_energy_lut(group_cpu);
+	unsigned long task_util = task_util_est(p);
+	unsigned long max_util = 0, util_sum = 0;
+	unsigned long capacity;
+	unsigned int nr_states = READ_ONCE(lut->nr_states);
+	int i, cap_idx;
+
+	if (unlikely(!nr_states))
+		return 0;
+
+	/*
+	 * 1. The cpu in the coregroup has same capacity and the
+	 *    capacity depends on the cpu that has the biggest
+	 *    utilization. Find biggest utilization in the coregroup
+	 *    to know what capacity the cpu will have.
+	 */
+	for_each_cpu(i, cpu_coregroup_mask(group_cpu)) {
+		unsigned long u = util[i];
+
+		if (unlikely(i == target_cpu))
+			u += task_util;
+
+		if (u > max_util)
+			max_util = u;
+	}
+
+	/*
+	 * 2. Find the capacity according to biggest utilization in
+	 *    coregroup.
+	 */
+	for (cap_idx = 0; cap_idx < nr_states - 1; cap_idx++)
+		if (lut->cap[cap_idx] >= max_util)
+			break;
+	capacity = lut->cap[cap_idx];
+
+	/*
+	 * 3. Get the utilization sum of coregroup. Since cpu
+	 *    utilization of CFS reflects the performance of cpu,
+	 *    normalize the utilization to calculate the amount of
+	 *    cpu usuage that excludes cpu performance.
+	 */
+	for_each_cpu(i, cpu_coregroup_mask(group_cpu)) {
+		unsigned long u = util[i];
+
+		if (i == target_cpu)
+			u += task_util;
+
+		if (i == task_cpu(p))
+			u -= min_t(unsigned long, u, task_util);
+
+		if (i == target_cpu)
+			u += task_util;
+
+		/* utilization with task exceeds max capacity of cpu */
+		if (u >= capacity) {
+			util_sum += SCHED_CAPACITY_SCALE;
+			continue;
+		}
+
+		/* normalize cpu utilization */
+		util_sum += (u << SCHED_CAPACITY_SHIFT) / capacity;
+	}
+
+	/*
+	 * 4. compute active energy
+	 */
+	return util_sum * lut->power[cap_idx];
+}
+
 unsigned int calculate_energy(struct task_struct *p, int target_cpu)
 {
 	unsigned long util[NR_CPUS] = {0, };
@@ -70,79 +167,59 @@ unsigned int calculate_energy(struct task_struct *p, int target_cpu)
 
 	/*
 	 * 0. Calculate utilization of the entire active cpu when task
-	 *    is assigned to target cpu.
+	 *    is not assigned to any cpu.
 	 */
-	for_each_cpu(cpu, cpu_active_mask) {
+	for_each_cpu(cpu, cpu_active_mask)
 		util[cpu] = cpu_util_wake(cpu, p);
 
-		if (unlikely(cpu == target_cpu))
-			util[cpu] += task_util_est(p);
-	}
-
 	for_each_cpu(cpu, cpu_active_mask) {
-		struct energy_table *table;
-		unsigned long max_util = 0, util_sum = 0;
-		unsigned long capacity;
-		int i, cap_idx;
-
 		/* Compute coregroup energy with only one cpu per coregroup */
 		if (cpu != cpumask_first(cpu_coregroup_mask(cpu)))
 			continue;
 
-		/*
-		 * 1. The cpu in the coregroup has same capacity and the
-		 *    capacity depends on the cpu that has the biggest
-		 *    utilization. Find biggest utilization in the coregroup
-		 *    to know what capacity the cpu will have.
-		 */
-		for_each_cpu(i, cpu_coregroup_mask(cpu))
-			if (util[i] > max_util)
-				max_util = util[i];
-
-		/*
-		 * 2. Find the capacity according to biggest utilization in
-		 *    coregroup.
-		 */
-		table = &per_cpu(energy_table, cpu);
-		cap_idx = table->nr_states - 1;
-		for (i = 0; i < table->nr_states; i++) {
-			if (table->states[i].cap >= max_util) {
-				capacity = table->states[i].cap;
-				cap_idx = i;
-				break;
-			}
-		}
+		total_energy += calculate_group_energy(p, cpu, util, target_cpu);
+	}
 
-		/*
-		 * 3. Get the utilization sum of coregroup. Since cpu
-		 *    utilization of CFS reflects the performance of cpu,
-		 *    normalize the utilization to calculate the amount of
-		 *    cpu usuage that excludes cpu performance.
-		 */
-		for_each_cpu(i, cpu_coregroup_mask(cpu)) {
-			if (i == task_cpu(p))
-				util[i] -= min_t(unsigned long, util[i], task_util_est(p));
+	return total_energy;
+}
 
-			if (i == target_cpu)
-				util[i] += task_util_est(p);
+/*
+ * calculate_energy_batch - compute energy for several candidate cpus at once
+ *
+ * @p : task to be placed
+ * @candidates : cpus to be evaluated
+ * @energy : array indexed by cpu, filled with the energy of each candidate
+ *
+ * The result of each candidate is the same as calculate_energy(p, cpu), but
+ * cpu utilization is read once and the energy of coregroups that do not
+ * contain the candidate is shared between the candidates.
+ */
+void calculate_energy_batch(struct task_struct *p, struct cpumask *candidates,
+				unsigned int *energy)
+{
+	unsigned long util[NR_CPUS] = {0, };
+	unsigned int base_energy[NR_CPUS] = {0, };
+	unsigned int total_energy = 0;
+	int cpu;
 
-			/* utilization with task exceeds max capacity of cpu */
-			if (util[i] >= capacity) {
-				util_sum += SCHED_CAPACITY_SCALE;
-				continue;
-			}
+	for_each_cpu(cpu, cpu_active_mask)
+		util[cpu] = cpu_util_wake(cpu, p);
 
-			/* normalize cpu utilization */
-			util_sum += (util[i] << SCHED_CAPACITY_SHIFT) / capacity;
-		}
+	/* Energy of each coregroup when task is not assigned to it */
+	for_each_cpu(cpu, cpu_active_mask) {
+		if (cpu != cpumask_first(cpu_coregroup_mask(cpu)))
+			continue;
 
-		/*
-		 * 4. compute active energy
-		 */
-		total_energy += util_sum * table->states[cap_idx].power;
+		base_energy[cpu] = calculate_group_energy(p, cpu, util, -1);
+		total_energy += base_energy[cpu];
 	}
 
-	return total_energy;
+	for_each_cpu(cpu, candidates) {
+		int group_cpu = cpumask_first(cpu_coregroup_mask(cpu));
+
+		energy[cpu] = total_energy - base_energy[group_cpu] +
+			calculate_group_energy(p, group_cpu, util, cpu);
+	}
 }
 
 static int find_min_util_cpu(struct cpumask *mask, unsigned long task_util)
@@ -177,8 +254,10 @@ static int find_min_util_cpu(struct cpumask *mask, unsigned long task_util)
 static int select_eco_cpu(struct eco_env *eenv)
 {
 	unsigned long task_util = task_util_est(eenv->p);
+	unsigned int energy[NR_CPUS];
 	unsigned int best_energy = UINT_MAX;
 	unsigned int prev_energy;
+	struct cpumask candidates;
 	int eco_cpu = eenv->prev_cpu;
 	int cpu, best_cpu = -1;
 
@@ -189,6 +268,8 @@ static int select_eco_cpu(struct eco_env *eenv)
 	if (!per_cpu(energy_table, eenv->prev_cpu).nr_states)
 		return eenv->prev_cpu;
 
+	cpumask_clear(&candidates);
+
 	for_each_cpu(cpu, cpu_active_mask) {
 		struct cpumask mask;
 		int energy_cpu;
@@ -210,19 +291,25 @@ static int select_eco_cpu(struct eco_env *eenv)
 		 * lowest energy among the min util cpu for each coregroup.
 		 */
 		energy_cpu = find_min_util_cpu(&mask, task_util);
-		if (cpu_selected(energy_cpu)) {
-			unsigned int energy = calculate_energy(eenv->p, energy_cpu);
-
-			if (energy < best_energy) {
-				best_energy = energy;
-				best_cpu = energy_cpu;
-			}
-		}
+		if (cpu_selected(energy_cpu))
+			cpumask_set_cpu(energy_cpu, &candidates);
 	}
 
-	if (!cpu_selected(best_cpu))
+	if (cpumask_empty(&candidates))
 		return -1;
 
+	/* Evaluate all candidates and prev cpu in one pass */
+	cpumask_set_cpu(eenv->prev_cpu, &candidates);
+	calculate_energy_batch(eenv->p, &candidates, energy);
+	cpumask_clear_cpu(eenv->prev_cpu, &candidates);
+
+	for_each_cpu(cpu, &candidates) {
+		if (energy[cpu] < best_energy) {
+			best_energy = energy[cpu];
+			best_cpu = cpu;
+		}
+	}
+
 	/*
 	 * Compare prev cpu to best cpu to determine whether keeping the task
 	 * on PREV CPU and sending the task to BEST CPU is beneficial for
@@ -230,7 +317,7 @@ static int select_eco_cpu(struct eco_env *eenv)
 	 * An energy saving is considered meaningful if it reduces the energy
 	 * consumption of PREV CPU candidate by at least ~1.56%.
 	 */
-	prev_energy = calculate_energy(eenv->p, eenv->prev_cpu);
+	prev_energy = energy[eenv->prev_cpu];
 	if (prev_energy - (prev_energy >> 6) > best_energy)
 		eco_cpu = best_cpu;
 
@@ -338,6 +425,45 @@ fill_cap_table(struct energy_table *table, int max_mips, unsigned long max_mips_
 	}
 }
 
+/*
+ * Number of states whose frequency does not exceed max_freq. At least the
+ * lowest state is always reachable.
+ */
+static unsigned int
+count_reachable_states(struct energy_table *table, unsigned int max_freq)
+{
+	unsigned int nr = 0;
+
+	while (nr < table->nr_states && table->states[nr].frequency <= max_freq)
+		nr++;
+
+	return max_t(unsigned int, nr, 1);
+}
+
+static void build_energy_lut(int cpu)
+{
+	struct energy_table *table = &per_cpu(energy_table, cpu);
+	struct energy_lut *lut = &per_cpu(energy_lut, cpu);
+	int i;
+
+	if (!lut->cap) {
+		lut->cap = kcalloc(table->nr_states * 2,
+				sizeof(unsigned int), GFP_KERNEL);
+		if (unlikely(!lut->cap))
+			return;
+
+		lut->power = lut->cap + table->nr_states;
+		lut->max_states = table->nr_states;
+	}
+
+	for (i = 0; i < lut->max_states; i++) {
+		lut->cap[i] = table->states[i].cap;
+		lut->power[i] = table->states[i].power;
+	}
+
+	WRITE_ONCE(lut->nr_states, lut->max_states);
+}
+
 static void show_energy_table(struct energy_table *table, int cpu)
 {
 	int i;
@@ -377,6 +503,18 @@ static int sched_cpufreq_policy_callback(struct notifier_block *nb,
 		cpu_scale = per_cpu(cpu_orig_scale, cpu) * max_scale;
 		cpu_scale = cpu_scale >> SCHED_CAPACITY_SHIFT;
 		topology_set_cpu_scale(cpu, cpu_scale);
+
+		/*
+		 * States above policy->max cannot be selected, so exclude them
+		 * from the energy lookup table of the coregroup.
+		 */
+		if (cpu == cpumask_first(cpu_coregroup_mask(cpu)) &&
+				per_cpu(energy_lut, cpu).max_states) {
+			struct energy_table *table = &per_cpu(energy_table, cpu);
+
+			WRITE_ONCE(per_cpu(energy_lut, cpu).nr_states,
+				count_reachable_states(table, policy->max));
+		}
 	}
 
 	return NOTIFY_OK;
@@ -478,6 +616,9 @@ void init_sched_energy_table(struct cpumask *cpus, int table_size,
 		fill_cap_table(table, max_mips, max_mips_freq);
 		show_energy_table(table, cpu);
 
+		if (cpu == cpumask_first(cpu_coregroup_mask(cpu)))
+			build_energy_lut(cpu);
+
 		last_state = table->nr_states - 1;
 		per_cpu(cpu_orig_scale, cpu) = table->states[last_state].cap;
 		topology_set_cpu_scale(cpu, table->states[last_state].cap);
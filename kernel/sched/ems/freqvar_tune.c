@@ -8,8 +8,11 @@
 #include <linux/cpufreq.h>
 #include <linux/slab.h>
 #include <linux/of.h>
+#include <trace/events/ems.h>
 
+#include "ems.h"
 #include "../sched.h"
+#include "../tune.h"
 
 /**********************************************************************
  * common APIs                                                        *
@@ -577,6 +580,167 @@ fail_init:
 	return ret;
 }
 
+/**********************************************************************
+ * freqvar predictive ramp                                            *
+ **********************************************************************/
+/*
+ * Predictive ramp learns the utilization which tasks of each schedtune
+ * group reach within the last PRED_HISTORY_SIZE wakeups, and applies it to
+ * the frequency of the target cpu in advance when a task of the group wakes
+ * up. The prediction is halved each time the task turns out to be lighter
+ * than predicted, and it is restored once the prediction hits again.
+ */
+#define PRED_HISTORY_SIZE	4
+#define PRED_MAX_GROUPS		8
+#define PRED_MAX_DECAY		3
+#define PRED_HOLD_NS		(20 * NSEC_PER_MSEC)
+
+struct freqvar_pred_profile {
+	raw_spinlock_t lock;
+	unsigned long history[PRED_HISTORY_SIZE];
+	int pos;
+	int decay;
+	unsigned long predicted;
+};
+static struct freqvar_pred_profile freqvar_pred_profile[PRED_MAX_GROUPS];
+
+struct freqvar_pred {
+	int enabled;
+};
+DEFINE_PER_CPU(struct freqvar_pred *, freqvar_pred);
+
+/* util floor applied to the cpu by predictive ramp and its expiry time */
+struct freqvar_pred_floor {
+	unsigned long util;
+	u64 expire;
+};
+DEFINE_PER_CPU(struct freqvar_pred_floor, freqvar_pred_floor);
+
+static ssize_t freqvar_pred_ramp_show(struct gov_attr_set *attr_set, char *buf)
+{
+	struct cpufreq_policy *policy = sugov_get_attr_policy(attr_set);
+	struct freqvar_pred *pred = per_cpu(freqvar_pred, policy->cpu);
+
+	return sprintf(buf, "%d\n", pred->enabled);
+}
+
+static ssize_t freqvar_pred_ramp_store(struct gov_attr_set *attr_set,
+				      const char *buf, size_t count)
+{
+	struct cpufreq_policy *policy = sugov_get_attr_policy(attr_set);
+	struct freqvar_pred *pred = per_cpu(freqvar_pred, policy->cpu);
+	int enabled;
+
+	if (kstrtoint(buf, 10, &enabled))
+		return -EINVAL;
+
+	pred->enabled = !!enabled;
+
+	return count;
+}
+static struct governor_attr freqvar_pred_ramp_attr = __ATTR_RW(freqvar_pred_ramp);
+
+unsigned long freqvar_pred_util(int cpu)
+{
+	struct freqvar_pred_floor *floor = &per_cpu(freqvar_pred_floor, cpu);
+
+	if (sched_clock() >= READ_ONCE(floor->expire))
+		return 0;
+
+	return READ_ONCE(floor->util);
+}
+
+static unsigned long freqvar_pred_learn(struct freqvar_pred_profile *profile,
+					unsigned long actual)
+{
+	unsigned long predicted = profile->predicted, max_util = 0;
+	int i;
+
+	/* The task turned out to be lighter than predicted, decay prediction */
+	if (actual < (predicted >> 1))
+		profile->decay = min(profile->decay + 1, PRED_MAX_DECAY);
+	else
+		profile->decay = 0;
+
+	profile->history[profile->pos] = actual;
+	profile->pos = (profile->pos + 1) % PRED_HISTORY_SIZE;
+
+	for (i = 0; i < PRED_HISTORY_SIZE; i++)
+		max_util = max(max_util, profile->history[i]);
+
+	profile->predicted = max_util >> profile->decay;
+
+	return predicted;
+}
+
+void freqvar_pred_task_wakeup(struct task_struct *p, int cpu)
+{
+	struct freqvar_pred *pred = per_cpu(freqvar_pred, cpu);
+	struct freqvar_pred_profile *profile;
+	struct freqvar_pred_floor *floor;
+	unsigned long actual, predicted;
+	unsigned long flags;
+	int group;
+
+	if (!pred || !pred->enabled)
+		return;
+
+	group = schedtune_task_group_idx(p);
+	if (group <= 0 || group >= PRED_MAX_GROUPS)
+		return;
+
+	profile = &freqvar_pred_profile[group];
+	actual = task_util(p);
+
+	raw_spin_lock_irqsave(&profile->lock, flags);
+	predicted = freqvar_pred_learn(profile, actual);
+	raw_spin_unlock_irqrestore(&profile->lock, flags);
+
+	trace_ems_freqvar_pred(p, group, cpu, predicted, actual);
+
+	/* Nothing to pre-apply if the task already has enough utilization */
+	if (predicted <= actual)
+		return;
+
+	floor = &per_cpu(freqvar_pred_floor, cpu);
+	WRITE_ONCE(floor->util, predicted);
+	WRITE_ONCE(floor->expire, sched_clock() + PRED_HOLD_NS);
+}
+
+static int freqvar_pred_init(struct device_node *dn, const struct cpumask *mask)
+{
+	struct freqvar_pred *pred;
+	struct cpufreq_policy *policy;
+	int cpu, ret = 0;
+
+	policy = cpufreq_cpu_get(cpumask_first(mask));
+	if (!policy)
+		return -ENODEV;
+
+	pred = kzalloc(sizeof(*pred), GFP_KERNEL);
+	if (!pred) {
+		ret = -ENOMEM;
+		goto fail_init;
+	}
+
+	pred->enabled = of_property_read_bool(dn, "predictive-ramp");
+
+	ret = sugov_sysfs_add_attr(policy, &freqvar_pred_ramp_attr.attr);
+	if (ret)
+		goto fail_init;
+
+	for_each_cpu(cpu, mask)
+		per_cpu(freqvar_pred, cpu) = pred;
+
+	return 0;
+
+fail_init:
+	cpufreq_cpu_put(policy);
+	freqvar_free(pred);
+
+	return ret;
+}
+
 /**********************************************************************
  * cpufreq notifier callback                                          *
  **********************************************************************/
@@ -610,6 +774,10 @@ static int __init freqvar_tune_init(void)
 	struct device_node *dn = NULL;
 	struct cpumask shared_mask;
 	const char *buf;
+	int i;
+
+	for (i = 0; i < PRED_MAX_GROUPS; i++)
+		raw_spin_lock_init(&freqvar_pred_profile[i].lock);
 
 	while ((dn = of_find_node_by_type(dn, "freqvar-tune"))) {
 		/*
@@ -629,6 +797,7 @@ static int __init freqvar_tune_init(void)
 		freqvar_boost_init(dn, &shared_mask);
 		freqvar_rate_limit_init(dn, &shared_mask);
 		freqvar_upscale_ratio_init(dn, &shared_mask);
+		freqvar_pred_init(dn, &shared_mask);
 	}
 
 	cpufreq_register_notifier(&freqvar_cpufreq_notifier,
@@ -8,6 +8,7 @@
 #include <linux/sched.h>
 #include <linux/kobject.h>
 #include <linux/ems.h>
+#include <soc/samsung/tmu.h>
 
 #include <trace/events/ems.h>
 
@@ -28,6 +29,102 @@ static int gb_qos_value(void)
 	return plist_last(&gb_list)->prio;
 }
 
+/*
+ * Thermal admission control
+ *
+ * Boosting tasks to the performance cluster near the thermal trip point only
+ * triggers throttling. Global boost is admitted against the temperature
+ * headroom of the performance cluster. The boost is fully admitted while the
+ * headroom is larger than gb_admit_margin and denied when it is smaller than
+ * gb_deny_margin. In between, the boost is scaled down linearly. To prevent
+ * flapping, the scale only goes down while the temperature is rising and only
+ * goes up while the temperature is dropping.
+ */
+#define GB_TMU_NAME		"BIG"
+#define GB_EVAL_PERIOD_NS	(100 * NSEC_PER_MSEC)
+#define GB_SCALE_MAX		100
+
+static int gb_admit_margin = 10000;	/* millicelsius */
+static int gb_deny_margin = 3000;	/* millicelsius */
+
+static int gb_scale = GB_SCALE_MAX;
+static int gb_last_headroom = INT_MAX;
+static atomic64_t gb_last_eval = ATOMIC64_INIT(0);
+
+static struct {
+	atomic_t admitted;
+	atomic_t scaled;
+	atomic_t denied;
+} gb_stat;
+
+static int gb_calc_scale(int headroom)
+{
+	if (headroom >= gb_admit_margin)
+		return GB_SCALE_MAX;
+
+	if (headroom <= gb_deny_margin)
+		return 0;
+
+	return GB_SCALE_MAX * (headroom - gb_deny_margin) /
+				(gb_admit_margin - gb_deny_margin);
+}
+
+static int gb_thermal_admit(bool force)
+{
+	enum thermal_trend trend;
+	int headroom, scale, prev;
+	u64 now = ktime_get_ns();
+	u64 last = atomic64_read(&gb_last_eval);
+
+	/* evaluate headroom once per period, only one cpu does it */
+	if (!force && now - last < GB_EVAL_PERIOD_NS)
+		return READ_ONCE(gb_scale);
+	if (atomic64_cmpxchg(&gb_last_eval, last, now) != last)
+		return READ_ONCE(gb_scale);
+
+	/* admit unconditionally if thermal information is not available */
+	if (exynos_tmu_get_headroom(GB_TMU_NAME, &headroom, &trend)) {
+		WRITE_ONCE(gb_scale, GB_SCALE_MAX);
+		return GB_SCALE_MAX;
+	}
+
+	scale = gb_calc_scale(headroom);
+	prev = READ_ONCE(gb_scale);
+
+	if (trend == THERMAL_TREND_RAISE_FULL)
+		scale = 0;
+	else if (headroom < gb_last_headroom)
+		scale = min(scale, prev);
+	else if (headroom > gb_last_headroom)
+		scale = max(scale, prev);
+	else
+		scale = prev;
+
+	gb_last_headroom = headroom;
+	WRITE_ONCE(gb_scale, scale);
+
+	if (scale != prev)
+		trace_ems_global_boost_admit(headroom, trend, scale);
+
+	return scale;
+}
+
+static void gb_update_stat(u32 new_value)
+{
+	int scale;
+
+	if (!new_value)
+		return;
+
+	scale = gb_thermal_admit(true);
+	if (scale >= GB_SCALE_MAX)
+		atomic_inc(&gb_stat.admitted);
+	else if (scale > 0)
+		atomic_inc(&gb_stat.scaled);
+	else
+		atomic_inc(&gb_stat.denied);
+}
+
 static DEFINE_SPINLOCK(gb_lock);
 
 void gb_qos_update_request(struct gb_qos_request *req, u32 new_value)
@@ -38,6 +135,8 @@ void gb_qos_update_request(struct gb_qos_request *req, u32 new_value)
 	if (req->node.prio == new_value)
 		return;
 
+	gb_update_stat(new_value);
+
 	spin_lock_irqsave(&gb_lock, flags);
 
 	/*
@@ -94,11 +193,65 @@ static ssize_t store_global_boost(struct kobject *kobj,
 static struct kobj_attribute global_boost_attr =
 __ATTR(global_boost, 0644, show_global_boost, store_global_boost);
 
+static ssize_t show_global_boost_stat(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE,
+			"scale=%d headroom=%d admitted=%d scaled=%d denied=%d\n",
+			READ_ONCE(gb_scale), gb_last_headroom,
+			atomic_read(&gb_stat.admitted),
+			atomic_read(&gb_stat.scaled),
+			atomic_read(&gb_stat.denied));
+}
+
+static struct kobj_attribute global_boost_stat_attr =
+__ATTR(global_boost_stat, 0444, show_global_boost_stat, NULL);
+
+static ssize_t show_global_boost_margin(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return snprintf(buf, PAGE_SIZE, "%d %d\n",
+			gb_admit_margin, gb_deny_margin);
+}
+
+static ssize_t store_global_boost_margin(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf,
+		size_t count)
+{
+	int admit, deny;
+
+	if (sscanf(buf, "%d %d", &admit, &deny) != 2)
+		return -EINVAL;
+
+	if (deny < 0 || admit <= deny)
+		return -EINVAL;
+
+	gb_admit_margin = admit;
+	gb_deny_margin = deny;
+
+	return count;
+}
+
+static struct kobj_attribute global_boost_margin_attr =
+__ATTR(global_boost_margin, 0644, show_global_boost_margin,
+		store_global_boost_margin);
+
+static struct attribute *gb_attrs[] = {
+	&global_boost_attr.attr,
+	&global_boost_stat_attr.attr,
+	&global_boost_margin_attr.attr,
+	NULL,
+};
+
+static const struct attribute_group gb_group = {
+	.attrs = gb_attrs,
+};
+
 static int __init init_gb_sysfs(void)
 {
 	int ret;
 
-	ret = sysfs_create_file(ems_kobj, &global_boost_attr.attr);
+	ret = sysfs_create_group(ems_kobj, &gb_group);
 	if (ret)
 		pr_err("%s: faile to create sysfs file\n", __func__);
 
@@ -107,9 +260,10 @@ static int __init init_gb_sysfs(void)
 late_initcall(init_gb_sysfs);
 
 /*
- * Returns the biggest value in the global boost list. In the current policy,
- * a value greater than 0 is unconditionally boosting. The size of the value
- * is meaningless.
+ * Returns the admitted boost scale(0~100) if there is a request in the global
+ * boost list. In the current policy, a value greater than 0 is boosting and
+ * the size of the requested value is meaningless. The scale reflects thermal
+ * admission, it is 0 if the boost is denied.
  */
 int global_boosted(void)
 {
@@ -117,14 +271,28 @@ int global_boosted(void)
 
 	/* booting boost duration = 40s */
 	if (now < 40 * USEC_PER_SEC)
-		return 1;
+		return GB_SCALE_MAX;
+
+	if (gb_qos_value() <= 0)
+		return 0;
 
-	return gb_qos_value() > 0;
+	return gb_thermal_admit(false);
 }
 
 int global_boosting(struct task_struct *p)
 {
-	if (!global_boosted())
+	int scale = global_boosted();
+
+	if (!scale)
+		return -1;
+
+	/*
+	 * If the boost is scaled down, only tasks whose utilization is large
+	 * enough for the scale are boosted.
+	 */
+	if (scale < GB_SCALE_MAX &&
+	    task_util_est(p) * GB_SCALE_MAX <
+			(GB_SCALE_MAX - scale) * SCHED_CAPACITY_SCALE)
 		return -1;
 
 	return select_perf_cpu(p);
@@ -6,13 +6,16 @@
  */
 
 #include <linux/sched.h>
+#include <linux/jhash.h>
 
 #include "ems.h"
 #include "../sched.h"
+#include "../tune.h"
 
 enum {
 	TYPE_BASE_CFS_RQ_UTIL = 0,
 	TYPE_BASE_INHERIT_PARENT_UTIL,
+	TYPE_LEARNED_UTIL,
 	TYPE_MAX_NUM,
 };
 
@@ -55,6 +58,126 @@ static void base_inherit_parent_util(struct sched_entity *se)
 	sa->util_sum = p->se.avg.util_sum;
 }
 
+/*
+ * Learned initial util
+ *
+ * Short-lived threads spawned by the same parent under the same schedtune
+ * group usually have similar load. The table remembers the converged util and
+ * ontime load of previous instances, keyed by the comm of the parent and the
+ * schedtune group at fork, and seeds new entities with them. The table is
+ * direct mapped and the entry is replaced on collision, so its size is fixed.
+ */
+#define LEARN_TABLE_BITS	7
+#define LEARN_TABLE_SIZE	(1 << LEARN_TABLE_BITS)
+#define LEARN_MIN_LIFETIME	(32 * NSEC_PER_MSEC)
+
+struct learned_util {
+	u32 key;		/* 0 means empty */
+	u32 util_avg;
+	u32 ontime_load;
+};
+
+static struct learned_util learn_table[LEARN_TABLE_SIZE];
+static DEFINE_RAW_SPINLOCK(learn_lock);
+
+static atomic_t learn_hit;
+static atomic_t learn_miss;
+
+static u32 learn_key(struct task_struct *parent)
+{
+	u32 key;
+
+	key = jhash(parent->comm, strnlen(parent->comm, TASK_COMM_LEN),
+			schedtune_task_group_idx(parent));
+
+	return key ? key : 1;
+}
+
+static bool learn_lookup(u32 key, struct learned_util *lu)
+{
+	struct learned_util *entry = &learn_table[key & (LEARN_TABLE_SIZE - 1)];
+	unsigned long flags;
+	bool found;
+
+	raw_spin_lock_irqsave(&learn_lock, flags);
+	found = entry->key == key;
+	if (found)
+		*lu = *entry;
+	raw_spin_unlock_irqrestore(&learn_lock, flags);
+
+	return found;
+}
+
+/* Called at fork, it gives the key to new entity and seeds ontime load */
+void init_util_learned_load(struct task_struct *parent, struct sched_entity *se)
+{
+	struct ontime_avg *oa = &se->ontime.avg;
+	struct learned_util lu;
+
+	se->ontime.learn_key = 0;
+
+	if (init_util_type != TYPE_LEARNED_UTIL)
+		return;
+
+	se->ontime.learn_key = learn_key(parent);
+
+	if (!learn_lookup(se->ontime.learn_key, &lu)) {
+		atomic_inc(&learn_miss);
+		return;
+	}
+
+	atomic_inc(&learn_hit);
+
+	oa->load_avg = lu.ontime_load;
+	oa->load_sum = (u64)lu.ontime_load * LOAD_AVG_MAX;
+}
+
+static void base_learned_util(struct sched_entity *se)
+{
+	struct sched_avg *sa = &se->avg;
+	struct learned_util lu;
+
+	if (!se->ontime.learn_key ||
+	    !learn_lookup(se->ontime.learn_key, &lu)) {
+		base_cfs_rq_util(se);
+		return;
+	}
+
+	sa->util_avg = lu.util_avg;
+	sa->util_sum = (u32)(sa->util_avg * LOAD_AVG_MAX);
+}
+
+/* Called when the task dies, it remembers the converged load of the task */
+void exynos_init_util_learn(struct task_struct *p)
+{
+	struct sched_entity *se = &p->se;
+	u32 key = se->ontime.learn_key;
+	struct learned_util *entry;
+	unsigned long flags;
+
+	if (!key || init_util_type != TYPE_LEARNED_UTIL)
+		return;
+
+	/* load of the task that died too early is not converged yet */
+	if (ktime_get_ns() - p->start_time < LEARN_MIN_LIFETIME)
+		return;
+
+	entry = &learn_table[key & (LEARN_TABLE_SIZE - 1)];
+
+	raw_spin_lock_irqsave(&learn_lock, flags);
+	if (entry->key == key) {
+		/* average with previous instances */
+		entry->util_avg = (entry->util_avg * 3 + se->avg.util_avg) >> 2;
+		entry->ontime_load = (entry->ontime_load * 3 +
+					se->ontime.avg.load_avg) >> 2;
+	} else {
+		entry->key = key;
+		entry->util_avg = se->avg.util_avg;
+		entry->ontime_load = se->ontime.avg.load_avg;
+	}
+	raw_spin_unlock_irqrestore(&learn_lock, flags);
+}
+
 void exynos_init_entity_util_avg(struct sched_entity *se)
 {
 	int type = init_util_type;
@@ -66,6 +189,9 @@ void exynos_init_entity_util_avg(struct sched_entity *se)
 	case TYPE_BASE_INHERIT_PARENT_UTIL:
 		base_inherit_parent_util(se);
 		break;
+	case TYPE_LEARNED_UTIL:
+		base_learned_util(se);
+		break;
 	default:
 		pr_info("%s: Not support initial util type %ld\n",
 				__func__, init_util_type);
@@ -115,15 +241,46 @@ static ssize_t store_initial_util_ratio(struct kobject *kobj,
         return count;
 }
 
+static ssize_t show_learned_util_stat(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	int hit = atomic_read(&learn_hit);
+	int miss = atomic_read(&learn_miss);
+	int i, entries = 0;
+
+	for (i = 0; i < LEARN_TABLE_SIZE; i++)
+		if (READ_ONCE(learn_table[i].key))
+			entries++;
+
+	return snprintf(buf, PAGE_SIZE, "hit=%d miss=%d hit_rate=%d%% entries=%d/%d\n",
+			hit, miss, hit + miss ? hit * 100 / (hit + miss) : 0,
+			entries, LEARN_TABLE_SIZE);
+}
+
+static ssize_t store_learned_util_stat(struct kobject *kobj,
+                struct kobj_attribute *attr, const char *buf,
+                size_t count)
+{
+	/* any write resets the statistics */
+	atomic_set(&learn_hit, 0);
+	atomic_set(&learn_miss, 0);
+
+	return count;
+}
+
 static struct kobj_attribute initial_util_type =
 __ATTR(initial_util_type, 0644, show_initial_util_type, store_initial_util_type);
 
 static struct kobj_attribute initial_util_ratio =
 __ATTR(initial_util_ratio, 0644, show_initial_util_ratio, store_initial_util_ratio);
 
+static struct kobj_attribute learned_util_stat =
+__ATTR(learned_util_stat, 0644, show_learned_util_stat, store_learned_util_stat);
+
 static struct attribute *attrs[] = {
 	&initial_util_type.attr,
 	&initial_util_ratio.attr,
+	&learned_util_stat.attr,
 	NULL,
 };
 
@@ -0,0 +1,261 @@
+/*
+ * Touch input boost for Exynos Mobile Scheduler
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd
+ *
+ * On the first touch-down, the top-app group is served with prefer perf and
+ * the performance cluster gets a frequency floor for a short window through
+ * the deadline service, without waiting for the boost from userspace.
+ *
+ * The latency from touch-down to the boost and to the next frame done of the
+ * display is recorded, the display driver reports frame done by
+ * ems_input_boost_frame_done().
+ */
+
+#include <linux/input.h>
+#include <linux/kobject.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/of.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+#include <linux/ems_service.h>
+
+#include "ems.h"
+
+static struct ems_deadline_req ib_req;
+static struct work_struct ib_work;
+
+static u32 ib_prefer_perf = 1;
+static s32 ib_min_freq;
+static unsigned int ib_duration_us = 300 * USEC_PER_MSEC;
+
+/* touch-down time waiting for the boost and for the frame done */
+static ktime_t ib_down_time;
+static ktime_t ib_frame_pending;
+static int ib_contacts;
+static DEFINE_SPINLOCK(ib_lock);
+
+struct ib_latency {
+	u64 count;
+	u64 sum_us;
+	u64 max_us;
+};
+
+static struct {
+	u64 boosts;
+	struct ib_latency boost;
+	struct ib_latency frame;
+} ib_stat;
+
+static void ib_latency_add(struct ib_latency *lat, ktime_t start, ktime_t end)
+{
+	u64 us = ktime_us_delta(end, start);
+
+	lat->count++;
+	lat->sum_us += us;
+	if (us > lat->max_us)
+		lat->max_us = us;
+}
+
+static void ib_boost_work(struct work_struct *work)
+{
+	unsigned long flags;
+	ktime_t down;
+
+	ems_deadline_request(&ib_req, STUNE_TOPAPP, ib_prefer_perf,
+			ib_min_freq, ib_duration_us);
+
+	spin_lock_irqsave(&ib_lock, flags);
+	down = ib_down_time;
+	ib_stat.boosts++;
+	ib_latency_add(&ib_stat.boost, down, ktime_get());
+	spin_unlock_irqrestore(&ib_lock, flags);
+}
+
+/*
+ * Called by the display driver from the frame done interrupt. The first frame
+ * done after a touch-down completes the touch-to-frame measurement.
+ */
+void ems_input_boost_frame_done(void)
+{
+	unsigned long flags;
+
+	if (!ktime_to_ns(READ_ONCE(ib_frame_pending)))
+		return;
+
+	spin_lock_irqsave(&ib_lock, flags);
+	if (ktime_to_ns(ib_frame_pending)) {
+		ib_latency_add(&ib_stat.frame, ib_frame_pending, ktime_get());
+		ib_frame_pending = 0;
+	}
+	spin_unlock_irqrestore(&ib_lock, flags);
+}
+EXPORT_SYMBOL_GPL(ems_input_boost_frame_done);
+
+static void ib_touch_down(void)
+{
+	unsigned long flags;
+	ktime_t now = ktime_get();
+
+	spin_lock_irqsave(&ib_lock, flags);
+	ib_down_time = now;
+	ib_frame_pending = now;
+	spin_unlock_irqrestore(&ib_lock, flags);
+
+	/* ems_deadline_request() may sleep, input events come in atomic */
+	queue_work(system_highpri_wq, &ib_work);
+}
+
+static void ib_input_event(struct input_handle *handle,
+			unsigned int type, unsigned int code, int value)
+{
+	if (!ib_duration_us)
+		return;
+
+	if (type == EV_KEY && code == BTN_TOUCH) {
+		if (value && !ib_contacts)
+			ib_touch_down();
+		ib_contacts = !!value;
+	} else if (type == EV_ABS && code == ABS_MT_TRACKING_ID) {
+		/* without BTN_TOUCH, every new contact renews the boost */
+		if (value >= 0 && !test_bit(BTN_TOUCH, handle->dev->keybit))
+			ib_touch_down();
+	}
+}
+
+static int ib_input_connect(struct input_handler *handler,
+			struct input_dev *dev, const struct input_device_id *id)
+{
+	struct input_handle *handle;
+	int ret;
+
+	handle = kzalloc(sizeof(*handle), GFP_KERNEL);
+	if (!handle)
+		return -ENOMEM;
+
+	handle->dev = dev;
+	handle->handler = handler;
+	handle->name = "ems_input_boost";
+
+	ret = input_register_handle(handle);
+	if (ret)
+		goto err_register;
+
+	ret = input_open_device(handle);
+	if (ret)
+		goto err_open;
+
+	return 0;
+
+err_open:
+	input_unregister_handle(handle);
+err_register:
+	kfree(handle);
+	return ret;
+}
+
+static void ib_input_disconnect(struct input_handle *handle)
+{
+	input_close_device(handle);
+	input_unregister_handle(handle);
+	kfree(handle);
+}
+
+static const struct input_device_id ib_ids[] = {
+	/* multi-touch touchscreen */
+	{
+		.flags = INPUT_DEVICE_ID_MATCH_EVBIT |
+			INPUT_DEVICE_ID_MATCH_ABSBIT,
+		.evbit = { BIT_MASK(EV_ABS) },
+		.absbit = { [BIT_WORD(ABS_MT_POSITION_X)] =
+			BIT_MASK(ABS_MT_POSITION_X) |
+			BIT_MASK(ABS_MT_POSITION_Y) },
+	},
+	{ },
+};
+
+static struct input_handler ib_input_handler = {
+	.event		= ib_input_event,
+	.connect	= ib_input_connect,
+	.disconnect	= ib_input_disconnect,
+	.name		= "ems_input_boost",
+	.id_table	= ib_ids,
+};
+
+static void ib_show_latency(char *buf, int *ret, const char *name,
+			struct ib_latency *lat)
+{
+	*ret += snprintf(buf + *ret, PAGE_SIZE - *ret,
+			"%s: count=%llu avg=%lluus max=%lluus\n", name,
+			lat->count, lat->count ? div64_u64(lat->sum_us, lat->count) : 0,
+			lat->max_us);
+}
+
+static ssize_t show_input_boost(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	unsigned long flags;
+	int ret = 0;
+
+	ret += snprintf(buf + ret, PAGE_SIZE - ret,
+			"duration=%uus prefer_perf=%u min_freq=%d boosts=%llu\n",
+			ib_duration_us, ib_prefer_perf, ib_min_freq, ib_stat.boosts);
+
+	spin_lock_irqsave(&ib_lock, flags);
+	ib_show_latency(buf, &ret, "touch_to_boost", &ib_stat.boost);
+	ib_show_latency(buf, &ret, "touch_to_frame", &ib_stat.frame);
+	spin_unlock_irqrestore(&ib_lock, flags);
+
+	return ret;
+}
+
+/* duration of the boost in us, 0 disables input boost */
+static ssize_t store_input_boost(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	unsigned int duration_us;
+
+	if (kstrtouint(buf, 0, &duration_us))
+		return -EINVAL;
+
+	ib_duration_us = duration_us;
+	if (!duration_us)
+		ems_deadline_cancel(&ib_req);
+
+	return count;
+}
+
+static struct kobj_attribute input_boost_attr =
+__ATTR(input_boost, 0644, show_input_boost, store_input_boost);
+
+static int __init init_input_boost(void)
+{
+	struct device_node *dn;
+	int ret;
+
+	ems_deadline_init(&ib_req);
+	INIT_WORK(&ib_work, ib_boost_work);
+
+	dn = of_find_node_by_name(NULL, "ems");
+	dn = of_find_node_by_name(dn, "input-boost");
+	if (dn) {
+		of_property_read_u32(dn, "prefer-perf", &ib_prefer_perf);
+		of_property_read_s32(dn, "min-freq", &ib_min_freq);
+		of_property_read_u32(dn, "duration-us", &ib_duration_us);
+		of_node_put(dn);
+	}
+
+	ret = input_register_handler(&ib_input_handler);
+	if (ret) {
+		pr_err("%s: failed to register input handler\n", __func__);
+		return ret;
+	}
+
+	ret = sysfs_create_file(ems_kobj, &input_boost_attr.attr);
+	if (ret)
+		pr_err("%s: faile to create sysfs file\n", __func__);
+
+	return 0;
+}
+late_initcall(init_input_boost);
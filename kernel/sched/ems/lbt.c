@@ -29,7 +29,36 @@ struct lbt_overutil {
 	unsigned long		capacity;
 	int			ratio;
 };
-DEFINE_PER_CPU(struct lbt_overutil *, lbt_overutil);
+
+/*
+ * The overutil table of each cpu is published with RCU. Tuning from sysfs
+ * builds a new table and swaps it, so that load balance in progress always
+ * sees a consistent set of levels. Only the capacity of each level, which
+ * follows cpu capacity, is updated in place with a single word store.
+ */
+struct lbt_overutil_table {
+	struct rcu_head		rcu;
+	struct lbt_overutil	ou[0];
+};
+DEFINE_PER_CPU(struct lbt_overutil_table __rcu *, lbt_overutil_table);
+
+/* Serializes table swap from sysfs */
+static DEFINE_MUTEX(lbt_mutex);
+
+/* Number of times each level was found overutilized, per cpu */
+static unsigned long __percpu *lbt_trigger_count;
+
+static int lbt_nr_levels;
+
+/* Access table without RCU, only for initialization and under lbt_mutex */
+static inline struct lbt_overutil *lbt_ou(int cpu)
+{
+	struct lbt_overutil_table *table;
+
+	table = rcu_dereference_protected(per_cpu(lbt_overutil_table, cpu), 1);
+
+	return table ? table->ou : NULL;
+}
 
 static inline struct sched_domain *find_sd_by_level(int cpu, int level)
 {
@@ -72,34 +101,53 @@ static inline int get_last_level(struct lbt_overutil *ou)
 /****************************************************************/
 bool lbt_overutilized(int cpu, int level)
 {
-	struct lbt_overutil *ou = per_cpu(lbt_overutil, cpu);
+	struct lbt_overutil_table *table;
+	unsigned long capacity;
 	bool overutilized;
 
-	if (!ou)
+	rcu_read_lock();
+	table = rcu_dereference(per_cpu(lbt_overutil_table, cpu));
+	if (!table) {
+		rcu_read_unlock();
 		return false;
+	}
+	capacity = READ_ONCE(table->ou[level].capacity);
+	rcu_read_unlock();
 
-	overutilized = (cpu_util(cpu) > ou[level].capacity) ? true : false;
+	overutilized = (cpu_util(cpu) > capacity) ? true : false;
 
-	if (overutilized)
+	if (overutilized) {
+		this_cpu_inc(lbt_trigger_count[level]);
 		trace_ems_lbt_overutilized(cpu, level, cpu_util(cpu),
-				ou[level].capacity, overutilized);
+				capacity, overutilized);
+	}
 
 	return overutilized;
 }
 
-void update_lbt_overutil(int cpu, unsigned long capacity)
+static void __update_lbt_overutil(struct lbt_overutil *ou, unsigned long capacity)
 {
-	struct lbt_overutil *ou = per_cpu(lbt_overutil, cpu);
 	int level, last = get_last_level(ou);
 
 	for (level = 0; level <= last; level++) {
 		if (ou[level].ratio == DISABLE_OU)
 			continue;
 
-		ou[level].capacity = (capacity * ou[level].ratio) / 100;
+		WRITE_ONCE(ou[level].capacity, (capacity * ou[level].ratio) / 100);
 	}
 }
 
+void update_lbt_overutil(int cpu, unsigned long capacity)
+{
+	struct lbt_overutil_table *table;
+
+	rcu_read_lock();
+	table = rcu_dereference(per_cpu(lbt_overutil_table, cpu));
+	if (table)
+		__update_lbt_overutil(table->ou, capacity);
+	rcu_read_unlock();
+}
+
 /****************************************************************/
 /*				SYSFS				*/
 /****************************************************************/
@@ -118,29 +166,46 @@ static struct attribute_group lbt_group;
 static ssize_t show_overutil_ratio(struct kobject *kobj,
 		struct kobj_attribute *attr, char *buf)
 {
-	struct lbt_overutil *ou = per_cpu(lbt_overutil, 0);
+	struct lbt_overutil_table *table;
 	int level = attr - lbt_kattrs;
 	int cpu, ret = 0;
 
+	rcu_read_lock();
 	for_each_possible_cpu(cpu) {
-		ou = per_cpu(lbt_overutil, cpu);
+		table = rcu_dereference(per_cpu(lbt_overutil_table, cpu));
 
-		if (ou[level].ratio == DISABLE_OU)
+		if (table->ou[level].ratio == DISABLE_OU)
 			continue;
 
 		ret += sprintf(buf + ret, "cpu%d ratio:%3d capacity:%4lu\n",
-				cpu, ou[level].ratio, ou[level].capacity);
+				cpu, table->ou[level].ratio,
+				READ_ONCE(table->ou[level].capacity));
 	}
+	rcu_read_unlock();
 
 	return ret;
 }
 
+static struct lbt_overutil_table *copy_lbt_overutil_table(int cpu)
+{
+	struct lbt_overutil_table *table;
+
+	table = kmalloc(sizeof(struct lbt_overutil_table) +
+			sizeof(struct lbt_overutil) * lbt_nr_levels, GFP_KERNEL);
+	if (!table)
+		return NULL;
+
+	memcpy(table->ou, lbt_ou(cpu), sizeof(struct lbt_overutil) * lbt_nr_levels);
+
+	return table;
+}
+
 static ssize_t store_overutil_ratio(struct kobject *kobj,
 		struct kobj_attribute *attr, const char *buf,
 		size_t count)
 {
-	struct lbt_overutil *ou;
-	unsigned long capacity;
+	struct lbt_overutil_table *new, *old;
+	struct cpumask cpus;
 	int level = attr - lbt_kattrs;
 	int cpu, ratio;
 
@@ -150,31 +215,64 @@ static ssize_t store_overutil_ratio(struct kobject *kobj,
 	/* Check cpu is possible */
 	if (!cpumask_test_cpu(cpu, cpu_possible_mask))
 		return -EINVAL;
-	ou = per_cpu(lbt_overutil, cpu);
 
 	/* If ratio is outrage, disable overutil */
 	if (ratio < 0 || ratio > 100)
 		ratio = DEFAULT_OU_RATIO;
 
-	for_each_cpu(cpu, &ou[level].cpus) {
-		ou = per_cpu(lbt_overutil, cpu);
-		if (ou[level].ratio == DISABLE_OU)
+	mutex_lock(&lbt_mutex);
+
+	cpumask_copy(&cpus, &lbt_ou(cpu)[level].cpus);
+	for_each_cpu(cpu, &cpus) {
+		if (lbt_ou(cpu)[level].ratio == DISABLE_OU)
 			continue;
 
-		ou[level].ratio = ratio;
-		capacity = capacity_orig_of(cpu);
-		update_lbt_overutil(cpu, capacity);
+		new = copy_lbt_overutil_table(cpu);
+		if (!new) {
+			mutex_unlock(&lbt_mutex);
+			return -ENOMEM;
+		}
+
+		new->ou[level].ratio = ratio;
+		__update_lbt_overutil(new->ou, capacity_orig_of(cpu));
+
+		old = rcu_dereference_protected(per_cpu(lbt_overutil_table, cpu),
+				lockdep_is_held(&lbt_mutex));
+		rcu_assign_pointer(per_cpu(lbt_overutil_table, cpu), new);
+		kfree_rcu(old, rcu);
 	}
 
+	mutex_unlock(&lbt_mutex);
+
 	return count;
 }
 
+static ssize_t show_overutil_count(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	int level, cpu, ret = 0;
+
+	for (level = 0; level < lbt_nr_levels; level++) {
+		unsigned long count = 0;
+
+		for_each_possible_cpu(cpu)
+			count += per_cpu_ptr(lbt_trigger_count, cpu)[level];
+
+		ret += sprintf(buf + ret, "level%d count:%lu\n", level, count);
+	}
+
+	return ret;
+}
+
+static struct kobj_attribute overutil_count_attr =
+__ATTR(overutil_count, 0444, show_overutil_count, NULL);
+
 static int alloc_lbt_sysfs(int size)
 {
 	if (size < 0)
 		return -EINVAL;
 
-	lbt_attrs = kzalloc(sizeof(struct attribute *) * (size + 1),
+	lbt_attrs = kzalloc(sizeof(struct attribute *) * (size + 2),
 			GFP_KERNEL);
 	if (!lbt_attrs)
 		goto fail_alloc;
@@ -215,6 +313,7 @@ static int __init lbt_sysfs_init(void)
 				show_overutil_ratio, store_overutil_ratio);
 		lbt_attrs[i] = &lbt_kattrs[i].attr;
 	}
+	lbt_attrs[i] = &overutil_count_attr.attr;
 
 	lbt_group.attrs = lbt_attrs;
 
@@ -244,22 +343,35 @@ static void free_lbt_overutil(void)
 	int cpu;
 
 	for_each_possible_cpu(cpu) {
-		if (per_cpu(lbt_overutil, cpu))
-			kfree(per_cpu(lbt_overutil, cpu));
+		kfree(rcu_dereference_protected(per_cpu(lbt_overutil_table, cpu), 1));
+		RCU_INIT_POINTER(per_cpu(lbt_overutil_table, cpu), NULL);
 	}
+
+	free_percpu(lbt_trigger_count);
+	lbt_trigger_count = NULL;
 }
 
 static int alloc_lbt_overutil(void)
 {
 	int cpu, depth = get_topology_depth();
 
+	lbt_nr_levels = depth + 1;
+
+	lbt_trigger_count = __alloc_percpu(sizeof(unsigned long) * lbt_nr_levels,
+			__alignof__(unsigned long));
+	if (!lbt_trigger_count)
+		goto fail_alloc;
+
 	for_each_possible_cpu(cpu) {
-		struct lbt_overutil *ou = kzalloc(sizeof(struct lbt_overutil) *
-				(depth + 1), GFP_KERNEL);
-		if (!ou)
+		struct lbt_overutil_table *table;
+
+		table = kzalloc(sizeof(struct lbt_overutil_table) +
+				sizeof(struct lbt_overutil) * lbt_nr_levels,
+				GFP_KERNEL);
+		if (!table)
 			goto fail_alloc;
 
-		per_cpu(lbt_overutil, cpu) = ou;
+		RCU_INIT_POINTER(per_cpu(lbt_overutil_table, cpu), table);
 	}
 	return 0;
 
@@ -289,7 +401,7 @@ static void default_lbt_overutil(int level)
 
 		sd = find_sd_by_level(cpu, level);
 		if (!sd) {
-			ou = per_cpu(lbt_overutil, cpu);
+			ou = lbt_ou(cpu);
 			ou[level].ratio = DISABLE_OU;
 			ou[level].top = top;
 			continue;
@@ -297,7 +409,7 @@ static void default_lbt_overutil(int level)
 
 		cpumask_copy(&cpus, sched_domain_span(sd));
 		for_each_cpu(c, &cpus) {
-			ou = per_cpu(lbt_overutil, c);
+			ou = lbt_ou(c);
 			cpumask_copy(&ou[level].cpus, &cpus);
 			ou[level].ratio = DEFAULT_OU_RATIO;
 			ou[level].top = top;
@@ -322,12 +434,12 @@ static void set_lbt_overutil(int level, const char *mask, int ratio)
 
 	/* If this level is overlapped with prev level, disable this level */
 	if (level > 0) {
-		ou = per_cpu(lbt_overutil, cpumask_first(&cpus));
+		ou = lbt_ou(cpumask_first(&cpus));
 		overlap = cpumask_equal(&cpus, &ou[level-1].cpus);
 	}
 
 	for_each_cpu(cpu, &cpus) {
-		ou = per_cpu(lbt_overutil, cpu);
+		ou = lbt_ou(cpu);
 		cpumask_copy(&ou[level].cpus, &cpus);
 		ou[level].ratio = overlap ? DISABLE_OU : ratio;
 		ou[level].top = top;
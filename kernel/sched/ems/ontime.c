@@ -43,6 +43,10 @@ struct ontime_cond {
 	int			coregroup;
 	struct cpumask		cpus;
 
+	/* Statistics of heavy candidate cache lookup in ontime migration */
+	unsigned int		cache_hit;
+	unsigned int		cache_miss;
+
 	struct list_head	list;
 
 	/* kobject for sysfs group */
@@ -61,6 +65,14 @@ struct ontime_env {
 };
 DEFINE_PER_CPU(struct ontime_env, ontime_env);
 
+/*
+ * Heavy candidate of each cpu. It is filled by ontime_update_load_avg() when
+ * a task of the cpu exceeds the upper boundary, and is consumed by
+ * ontime_migration() so that runqueue does not need to be rescanned.
+ * The cached task is pinned with get_task_struct() while it is in the slot.
+ */
+DEFINE_PER_CPU(struct task_struct *, ontime_heavy_candidate);
+
 static inline struct sched_entity *se_of(struct sched_avg *sa)
 {
 	return container_of(sa, struct sched_entity, avg);
@@ -250,13 +262,14 @@ ontime_select_target_cpu(struct task_struct *p, struct cpumask *fit_cpus)
 		 * If there is more than one candidate,
 		 * calculate each energy and choose min_energy_cpu.
 		 */
+		unsigned int energy[NR_CPUS];
 		unsigned int min_energy = UINT_MAX;
 
-		for_each_cpu(cpu, &candidates) {
-			unsigned int new_energy = calculate_energy(p, cpu);
+		calculate_energy_batch(p, &candidates, energy);
 
-			if (min_energy > new_energy) {
-				min_energy = new_energy;
+		for_each_cpu(cpu, &candidates) {
+			if (min_energy > energy[cpu]) {
+				min_energy = energy[cpu];
 				energy_cpu = cpu;
 			}
 		}
@@ -270,6 +283,56 @@ ontime_select_target_cpu(struct task_struct *p, struct cpumask *fit_cpus)
 	return energy_cpu;
 }
 
+static void ontime_cache_candidate(int cpu, struct sched_entity *se)
+{
+	struct task_struct **slot = per_cpu_ptr(&ontime_heavy_candidate, cpu);
+	struct task_struct *p;
+
+	if (entity_is_cfs_rq(se))
+		return;
+
+	/* Keep the candidate in the slot until it is consumed */
+	if (READ_ONCE(*slot))
+		return;
+
+	p = task_of(se);
+	if (p->exit_state)
+		return;
+
+	get_task_struct(p);
+	if (cmpxchg(slot, NULL, p) != NULL)
+		put_task_struct(p);
+}
+
+static struct task_struct *ontime_take_candidate(int cpu)
+{
+	return xchg(per_cpu_ptr(&ontime_heavy_candidate, cpu), NULL);
+}
+
+/* Must be called with rq->lock held */
+static bool ontime_candidate_valid(struct task_struct *p, struct rq *rq)
+{
+	if (!p)
+		return false;
+
+	if (p->exit_state)
+		return false;
+
+	if (!task_on_rq_queued(p) || task_rq(p) != rq)
+		return false;
+
+	if (p->sched_class != &fair_sched_class)
+		return false;
+
+	if (ontime_of(p)->migrating)
+		return false;
+
+	if (!schedtune_ontime_en(p))
+		return false;
+
+	return ontime_load_avg(p) >= get_upper_boundary(cpu_of(rq));
+}
+
 extern struct sched_entity *__pick_next_entity(struct sched_entity *se);
 static struct task_struct *
 ontime_pick_heavy_task(struct sched_entity *se, int *boost_migration)
@@ -430,7 +493,8 @@ out_unlock:
 	return 0;
 }
 
-static void ontime_update_next_balance(int cpu, struct ontime_avg *oa)
+static void
+ontime_update_next_balance(int cpu, struct sched_entity *se, struct ontime_avg *oa)
 {
 	if (cpumask_test_cpu(cpu, cpu_coregroup_mask(MAX_CAPACITY_CPU)))
 		return;
@@ -438,6 +502,10 @@ static void ontime_update_next_balance(int cpu, struct ontime_avg *oa)
 	if (oa->load_avg < get_upper_boundary(cpu))
 		return;
 
+	/* Remember the heavy task so that ontime migration need not rescan */
+	if (se->on_rq)
+		ontime_cache_candidate(cpu, se);
+
 	/*
 	 * Update the next_balance of this cpu because tick is most likely
 	 * to occur first in currently running cpu.
@@ -478,8 +546,9 @@ void ontime_migration(void)
 		unsigned long flags;
 		struct rq *rq = cpu_rq(cpu);
 		struct sched_entity *se;
-		struct task_struct *p;
+		struct task_struct *p, *cached;
 		struct ontime_env *env = &per_cpu(ontime_env, cpu);
+		struct ontime_cond *cond;
 		struct cpumask fit_cpus;
 		int boost_migration = 0;
 		int dst_cpu;
@@ -488,26 +557,40 @@ void ontime_migration(void)
 		if (cpumask_test_cpu(cpu, cpu_coregroup_mask(MAX_CAPACITY_CPU)))
 			break;
 
+		cached = ontime_take_candidate(cpu);
+
 		raw_spin_lock_irqsave(&rq->lock, flags);
 
 		/*
 		 * Ontime migration is not performed when active balance
 		 * is in progress.
 		 */
-		if (rq->active_balance) {
-			raw_spin_unlock_irqrestore(&rq->lock, flags);
-			continue;
-		}
+		if (rq->active_balance)
+			goto unlock;
 
 		/*
 		 * No need to migration if source cpu does not have cfs
 		 * tasks.
 		 */
-		if (!rq->cfs.curr) {
-			raw_spin_unlock_irqrestore(&rq->lock, flags);
-			continue;
+		if (!rq->cfs.curr)
+			goto unlock;
+
+		/*
+		 * Use heavy candidate cached by load tracking if it is still
+		 * valid. Boosted case always picks current task, so it does
+		 * not need the cache.
+		 */
+		cond = get_current_cond(cpu);
+		if (!global_boosted() && ontime_candidate_valid(cached, rq)) {
+			p = cached;
+			if (cond)
+				cond->cache_hit++;
+			goto found;
 		}
 
+		if (cond)
+			cond->cache_miss++;
+
 		/* Find task entity if entity is cfs_rq. */
 		se = rq->cfs.curr;
 		if (entity_is_cfs_rq(se)) {
@@ -524,35 +607,28 @@ void ontime_migration(void)
 		 * heavy task in rq.
 		 */
 		p = ontime_pick_heavy_task(se, &boost_migration);
-		if (!p) {
-			raw_spin_unlock_irqrestore(&rq->lock, flags);
-			continue;
-		}
+		if (!p)
+			goto unlock;
 
+found:
 		/* If fit_cpus is not searched, don't need to select dst_cpu */
-		if (ontime_select_fit_cpus(p, &fit_cpus)) {
-			raw_spin_unlock_irqrestore(&rq->lock, flags);
-			continue;
-		}
+		if (ontime_select_fit_cpus(p, &fit_cpus))
+			goto unlock;
 
 		/*
 		 * If fit_cpus is smaller than current coregroup,
 		 * don't need to ontime migration.
 		 */
-		if (!is_faster_than(cpu, cpumask_first(&fit_cpus))) {
-			raw_spin_unlock_irqrestore(&rq->lock, flags);
-			continue;
-		}
+		if (!is_faster_than(cpu, cpumask_first(&fit_cpus)))
+			goto unlock;
 
 		/*
 		 * Select cpu to migrate the task to. Return negative number
 		 * if there is no idle cpu in sg.
 		 */
 		dst_cpu = ontime_select_target_cpu(p, &fit_cpus);
-		if (!cpu_selected(dst_cpu)) {
-			raw_spin_unlock_irqrestore(&rq->lock, flags);
-			continue;
-		}
+		if (!cpu_selected(dst_cpu))
+			goto unlock;
 
 		ontime_of(p)->migrating = 1;
 		get_task_struct(p);
@@ -573,6 +649,16 @@ void ontime_migration(void)
 		/* Migrate task through stopper */
 		stop_one_cpu_nowait(cpu, ontime_migration_cpu_stop, env,
 				&per_cpu(ontime_migration_work, cpu));
+
+		if (cached)
+			put_task_struct(cached);
+		continue;
+
+unlock:
+		raw_spin_unlock_irqrestore(&rq->lock, flags);
+
+		if (cached)
+			put_task_struct(cached);
 	}
 
 	spin_unlock(&om_lock);
@@ -710,7 +796,7 @@ void ontime_update_load_avg(u64 delta, int cpu, unsigned long weight, struct sch
 		return;
 
 	oa->load_avg = div_u64(oa->load_sum, LOAD_AVG_MAX - 1024 + oa->period_contrib);
-	ontime_update_next_balance(cpu, oa);
+	ontime_update_next_balance(cpu, se_of(sa), oa);
 }
 
 void ontime_new_entity_load(struct task_struct *parent, struct sched_entity *se)
@@ -727,6 +813,8 @@ void ontime_new_entity_load(struct task_struct *parent, struct sched_entity *se)
 	ontime->avg.period_contrib = 1023;
 	ontime->migrating = 0;
 
+	init_util_learned_load(parent, se);
+
 	trace_ems_ontime_new_entity_load(task_of(se), &ontime->avg);
 }
 
@@ -778,6 +866,15 @@ ontime_attr_rw(upper_boundary);
 ontime_attr_rw(lower_boundary);
 ontime_attr_rw(coverage_ratio);
 
+#define ontime_attr_ro(_name)				\
+static struct ontime_attr _name##_attr =		\
+__ATTR(_name, 0444, show_##_name, NULL)
+
+ontime_show(cache_hit);
+ontime_show(cache_miss);
+ontime_attr_ro(cache_hit);
+ontime_attr_ro(cache_miss);
+
 static ssize_t show(struct kobject *kobj, struct attribute *at, char *buf)
 {
 	struct ontime_attr *oattr = container_of(at, struct ontime_attr, attr);
@@ -790,6 +887,9 @@ static ssize_t store(struct kobject *kobj, struct attribute *at,
 {
 	struct ontime_attr *oattr = container_of(at, struct ontime_attr, attr);
 
+	if (!oattr->store)
+		return -EIO;
+
 	return oattr->store(kobj, buf, count);
 }
 
@@ -802,6 +902,8 @@ static struct attribute *ontime_attrs[] = {
 	&upper_boundary_attr.attr,
 	&lower_boundary_attr.attr,
 	&coverage_ratio_attr.attr,
+	&cache_hit_attr.attr,
+	&cache_miss_attr.attr,
 	NULL
 };
 
@@ -5,6 +5,7 @@
  * Park Bumgyu <bumgyu.park@samsung.com>
  */
 
+#include <linux/export.h>
 #include <linux/kobject.h>
 #include <linux/of.h>
 #include <linux/slab.h>
@@ -79,6 +80,126 @@ static void __init init_kpp(void)
 	kpp_en = 1;
 }
 
+/**********************************************************************
+ *                         Deadline Service                           *
+ **********************************************************************/
+static enum hrtimer_restart ems_deadline_expired(struct hrtimer *timer)
+{
+	struct ems_deadline_req *req = container_of(timer,
+					struct ems_deadline_req, timer);
+
+	/* Frequency floor is released by pm_qos timeout itself */
+	kpp_request(req->kpp.grp_idx, &req->kpp, 0);
+
+	return HRTIMER_NORESTART;
+}
+
+void ems_deadline_init(struct ems_deadline_req *req)
+{
+	memset(req, 0, sizeof(*req));
+	hrtimer_init(&req->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	req->timer.function = ems_deadline_expired;
+}
+
+/*
+ * ems_deadline_request - request performance service until deadline
+ *
+ * @req : request initialized by ems_deadline_init()
+ * @grp_idx : schedtune group to be served
+ * @prefer_perf : prefer perf value applied to the group
+ * @min_freq : frequency floor of performance cluster, 0 means no floor
+ * @deadline_us : service is released after this time
+ *
+ * Requesting again before the deadline replaces the previous request.
+ * This function may sleep.
+ */
+void ems_deadline_request(struct ems_deadline_req *req, int grp_idx,
+			int prefer_perf, s32 min_freq, unsigned int deadline_us)
+{
+	if (!deadline_us) {
+		ems_deadline_cancel(req);
+		return;
+	}
+
+	hrtimer_cancel(&req->timer);
+	kpp_request(grp_idx, &req->kpp, prefer_perf);
+	hrtimer_start(&req->timer, ns_to_ktime((u64)deadline_us * NSEC_PER_USEC),
+			HRTIMER_MODE_REL);
+
+	if (!min_freq)
+		return;
+
+	if (!pm_qos_request_active(&req->min_qos))
+		pm_qos_add_request(&req->min_qos, PM_QOS_CLUSTER1_FREQ_MIN, 0);
+	pm_qos_update_request_timeout(&req->min_qos, min_freq, deadline_us);
+}
+
+void ems_deadline_cancel(struct ems_deadline_req *req)
+{
+	hrtimer_cancel(&req->timer);
+
+	if (req->kpp.active)
+		kpp_request(req->kpp.grp_idx, &req->kpp, 0);
+
+	if (pm_qos_request_active(&req->min_qos))
+		pm_qos_update_request(&req->min_qos, 0);
+}
+
+/* Deadline service requested through schedtune "perf_deadline_us" */
+static struct ems_deadline_req group_deadline[STUNE_GROUP_COUNT];
+static DEFINE_MUTEX(group_deadline_lock);
+static u32 deadline_prefer_perf = 1;
+static s32 deadline_min_freq;
+
+int ems_group_deadline_request(int grp_idx, unsigned int deadline_us)
+{
+	if (grp_idx < 0 || grp_idx >= STUNE_GROUP_COUNT)
+		return -EINVAL;
+
+	mutex_lock(&group_deadline_lock);
+	ems_deadline_request(&group_deadline[grp_idx], grp_idx,
+			deadline_prefer_perf, deadline_min_freq, deadline_us);
+	mutex_unlock(&group_deadline_lock);
+
+	return 0;
+}
+
+static void __init init_deadline_service(void)
+{
+	struct device_node *dn;
+	int i;
+
+	for (i = 0; i < STUNE_GROUP_COUNT; i++)
+		ems_deadline_init(&group_deadline[i]);
+
+	dn = of_find_node_by_name(NULL, "ems");
+	dn = of_find_node_by_name(dn, "deadline-service");
+	if (!dn)
+		return;
+
+	of_property_read_u32(dn, "prefer-perf", &deadline_prefer_perf);
+	of_property_read_s32(dn, "min-freq", &deadline_min_freq);
+	of_node_put(dn);
+}
+
+/*
+ * Returns true if the task belongs to the foreground app, so that drivers can
+ * serve the app first without knowing schedtune.
+ */
+bool ems_task_is_topapp(struct task_struct *p)
+{
+	return schedtune_task_group_idx(p) == STUNE_TOPAPP;
+}
+
+/* Returns true if the task belongs to the top-app or the foreground group */
+bool ems_task_is_foreground(struct task_struct *p)
+{
+	int grp_idx = schedtune_task_group_idx(p);
+
+	return grp_idx == STUNE_TOPAPP || grp_idx == STUNE_FOREGROUND;
+}
+EXPORT_SYMBOL_GPL(ems_task_is_foreground);
+
 struct prefer_perf {
 	int			boost;
 	unsigned int		threshold;
@@ -256,6 +377,8 @@ static int __init init_service(void)
 
 	init_kpp();
 
+	init_deadline_service();
+
 	build_prefer_cpus();
 
 	ret = sysfs_create_file(ems_kobj, &kpp_attr.attr);
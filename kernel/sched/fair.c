@@ -7996,6 +7996,7 @@ static void migrate_task_rq_fair(struct task_struct *p)
 
 static void task_dead_fair(struct task_struct *p)
 {
+	exynos_init_util_learn(p);
 	remove_entity_load_avg(&p->se);
 }
 #endif /* CONFIG_SMP */
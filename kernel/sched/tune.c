@@ -1,10 +1,12 @@
 #include <linux/cgroup.h>
 #include <linux/err.h>
+#include <linux/irq_work.h>
 #include <linux/kernel.h>
 #include <linux/percpu.h>
 #include <linux/printk.h>
 #include <linux/rcupdate.h>
 #include <linux/slab.h>
+#include <linux/swap.h>
 #include <linux/ems.h>
 #include <linux/ems_service.h>
 
@@ -48,6 +50,9 @@ struct schedtune {
 	/* Hint to group tasks by process */
 	int band;
 
+	/* Last deadline of performance service requested on this group */
+	unsigned int perf_deadline_us;
+
 	/* SchedTune ontime migration */
 	int ontime_en;
 };
@@ -165,12 +170,19 @@ schedtune_cpu_update(int cpu, u64 now)
 		if (!schedtune_boost_group_active(idx, bg, now))
 			continue;
 
+		/*
+		 * Only a group kept active by its hold can change the
+		 * maximum as time goes by. Re-evaluate when the earliest
+		 * of those holds expires, instead of on every boost check.
+		 */
+		if (!bg->group[idx].tasks && bg->group[idx].ts < boost_ts)
+			boost_ts = bg->group[idx].ts;
+
 		/* This boost group is active */
 		if (boost_max > bg->group[idx].boost)
 			continue;
 
 		boost_max = bg->group[idx].boost;
-		boost_ts =  bg->group[idx].ts;
 	}
 	/* Ensures boost_max is non-negative when all cgroup boost values
 	 * are neagtive. Avoids under-accounting of cpu capacity which may cause
@@ -180,6 +192,75 @@ schedtune_cpu_update(int cpu, u64 now)
 	bg->boost_ts = boost_ts;
 }
 
+/*
+ * Boost updates from userspace are batched. boost_write() only records the
+ * new value of the group and queues an irq_work, which applies all pending
+ * groups and recomputes the maximum of each cpu once per burst of writes.
+ */
+static DEFINE_RAW_SPINLOCK(schedtune_pending_lock);
+static unsigned long schedtune_pending_groups;
+static int schedtune_pending_boost[BOOSTGROUPS_COUNT];
+static struct irq_work schedtune_boost_work;
+
+static void schedtune_boost_work_fn(struct irq_work *work)
+{
+	int boost[BOOSTGROUPS_COUNT];
+	unsigned long pending;
+	unsigned long flags;
+	int cpu, idx;
+
+	raw_spin_lock_irqsave(&schedtune_pending_lock, flags);
+	pending = schedtune_pending_groups;
+	schedtune_pending_groups = 0;
+	for_each_set_bit(idx, &pending, BOOSTGROUPS_COUNT)
+		boost[idx] = schedtune_pending_boost[idx];
+	raw_spin_unlock_irqrestore(&schedtune_pending_lock, flags);
+
+	if (!pending)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct boost_groups *bg = &per_cpu(cpu_boost_groups, cpu);
+		int old_boost_max;
+
+		raw_spin_lock_irqsave(&bg->lock, flags);
+
+		old_boost_max = bg->boost_max;
+		for_each_set_bit(idx, &pending, BOOSTGROUPS_COUNT)
+			bg->group[idx].boost = boost[idx];
+		schedtune_cpu_update(cpu, sched_clock_cpu(cpu));
+
+		raw_spin_unlock_irqrestore(&bg->lock, flags);
+
+		trace_sched_tune_boostgroup_update(cpu,
+				(bg->boost_max > old_boost_max) -
+				(bg->boost_max < old_boost_max),
+				bg->boost_max);
+	}
+}
+
+static void schedtune_boostgroup_update_batched(int idx, int boost)
+{
+	unsigned long flags;
+
+	raw_spin_lock_irqsave(&schedtune_pending_lock, flags);
+	schedtune_pending_boost[idx] = boost;
+	__set_bit(idx, &schedtune_pending_groups);
+	raw_spin_unlock_irqrestore(&schedtune_pending_lock, flags);
+
+	irq_work_queue(&schedtune_boost_work);
+}
+
+/* Drop pending batched update of the group, it is updated synchronously */
+static void schedtune_boostgroup_cancel_batched(int idx)
+{
+	unsigned long flags;
+
+	raw_spin_lock_irqsave(&schedtune_pending_lock, flags);
+	__clear_bit(idx, &schedtune_pending_groups);
+	raw_spin_unlock_irqrestore(&schedtune_pending_lock, flags);
+}
+
 static int
 schedtune_boostgroup_update(int idx, int boost)
 {
@@ -249,6 +330,11 @@ schedtune_tasks_update(struct task_struct *p, int cpu, int idx, int task_count)
 	/* Update boosted tasks count while avoiding to make it negative */
 	bg->group[idx].tasks = max(0, tasks);
 
+	/* The group is now kept active only by its hold, track its expiry */
+	if (task_count < 0 && !bg->group[idx].tasks &&
+	    bg->group[idx].ts < bg->boost_ts)
+		bg->boost_ts = bg->group[idx].ts;
+
 	/* Update timeout on enqueue */
 	if (task_count > 0) {
 		u64 now = sched_clock_cpu(cpu);
@@ -386,8 +472,10 @@ static void schedtune_attach(struct cgroup_taskset *tset)
 	struct task_struct *task;
 	struct cgroup_subsys_state *css;
 
-	cgroup_taskset_for_each(task, css, tset)
+	cgroup_taskset_for_each(task, css, tset) {
 		sync_band(task, css_st(css)->band);
+		lru_protect_update_task(task);
+	}
 }
 
 /*
@@ -486,6 +574,23 @@ int schedtune_ontime_en(struct task_struct *p)
 
 }
 
+int schedtune_task_group_idx(struct task_struct *p)
+{
+	struct schedtune *st;
+	int idx;
+
+	if (unlikely(!schedtune_initialized))
+		return 0;
+
+	/* Get boost group index */
+	rcu_read_lock();
+	st = task_schedtune(p);
+	idx = st->idx;
+	rcu_read_unlock();
+
+	return idx;
+}
+
 int schedtune_prefer_idle(struct task_struct *p)
 {
 	struct schedtune *st;
@@ -569,6 +674,10 @@ band_write(struct cgroup_subsys_state *css, struct cftype *cft,
 	    u64 band)
 {
 	struct schedtune *st = css_st(css);
+
+	if (band > COLOCATE_BAND)
+		return -EINVAL;
+
 	st->band = band;
 
 	return 0;
@@ -592,6 +701,28 @@ prefer_idle_write(struct cgroup_subsys_state *css, struct cftype *cft,
 	return 0;
 }
 
+static u64
+perf_deadline_read(struct cgroup_subsys_state *css, struct cftype *cft)
+{
+	struct schedtune *st = css_st(css);
+
+	return st->perf_deadline_us;
+}
+
+static int
+perf_deadline_write(struct cgroup_subsys_state *css, struct cftype *cft,
+	    u64 deadline_us)
+{
+	struct schedtune *st = css_st(css);
+
+	if (deadline_us > UINT_MAX)
+		return -EINVAL;
+
+	st->perf_deadline_us = deadline_us;
+
+	return ems_group_deadline_request(st->idx, deadline_us);
+}
+
 static u64
 prefer_perf_read(struct cgroup_subsys_state *css, struct cftype *cft)
 {
@@ -630,7 +761,7 @@ boost_write(struct cgroup_subsys_state *css, struct cftype *cft,
 	st->boost = boost;
 
 	/* Update CPU boost */
-	schedtune_boostgroup_update(st->idx, st->boost);
+	schedtune_boostgroup_update_batched(st->idx, st->boost);
 
 	return 0;
 }
@@ -651,6 +782,11 @@ static struct cftype files[] = {
 		.read_u64 = prefer_perf_read,
 		.write_u64 = prefer_perf_write,
 	},
+	{
+		.name = "perf_deadline_us",
+		.read_u64 = perf_deadline_read,
+		.write_u64 = perf_deadline_write,
+	},
 	{
 		.name = "band",
 		.read_u64 = band_read,
@@ -735,6 +871,8 @@ static void
 schedtune_boostgroup_release(struct schedtune *st)
 {
 	/* Reset this boost group */
+	schedtune_boostgroup_cancel_batched(st->idx);
+	irq_work_sync(&schedtune_boost_work);
 	schedtune_boostgroup_update(st->idx, 0);
 
 	/* Keep track of allocated boost groups */
@@ -786,6 +924,7 @@ static int
 schedtune_init(void)
 {
 	schedtune_spc_rdiv = reciprocal_value(100);
+	init_irq_work(&schedtune_boost_work, schedtune_boost_work_fn);
 	schedtune_init_cgroups();
 
 	return 0;
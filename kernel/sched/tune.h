@@ -19,6 +19,7 @@ int schedtune_prefer_idle(struct task_struct *tsk);
 int schedtune_prefer_perf(struct task_struct *tsk);
 int schedtune_util_est_en(struct task_struct *tsk);
 int schedtune_ontime_en(struct task_struct *tsk);
+int schedtune_task_group_idx(struct task_struct *tsk);
 
 void schedtune_enqueue_task(struct task_struct *p, int cpu);
 void schedtune_dequeue_task(struct task_struct *p, int cpu);
@@ -32,6 +33,7 @@ void schedtune_dequeue_task(struct task_struct *p, int cpu);
 #define schedtune_prefer_perf(tsk) 0
 #define schedtune_util_est_en(tsk) 0
 #define schedtune_ontime_en(tsk) 0
+#define schedtune_task_group_idx(tsk) 0
 
 #define schedtune_enqueue_task(task, cpu) do { } while (0)
 #define schedtune_dequeue_task(task, cpu) do { } while (0)
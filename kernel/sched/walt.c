@@ -628,6 +628,8 @@ static void update_history(struct rq *rq, struct task_struct *p,
 
 	p->ravg.demand = demand;
 
+	walt_ring_record(rq, p, runtime, samples);
+
 done:
 	trace_walt_update_history(rq, p, runtime, samples, event);
 	return;
@@ -50,6 +50,14 @@ static inline u64 walt_ktime_clock(void) { return 0; }
 
 #endif /* CONFIG_SCHED_WALT */
 
+#ifdef CONFIG_SCHED_WALT_RING
+void walt_ring_record(struct rq *rq, struct task_struct *p,
+			u32 runtime, int samples);
+#else
+static inline void walt_ring_record(struct rq *rq, struct task_struct *p,
+			u32 runtime, int samples) { }
+#endif
+
 #if defined(CONFIG_CFS_BANDWIDTH) && defined(CONFIG_SCHED_WALT)
 void walt_inc_cfs_cumulative_runnable_avg(struct cfs_rq *rq,
 		struct task_struct *p);
@@ -0,0 +1,121 @@
+/*
+ * WALT window sample ring for userspace performance managers
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ */
+
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
+#include <uapi/linux/sched/walt_ring.h>
+
+#include "sched.h"
+#include "tune.h"
+#include "walt.h"
+
+static struct walt_ring *walt_rings;
+
+/* Slot reservation of each ring, kept apart from the user visible header */
+static atomic_t walt_ring_pos[WALT_RING_NR_GROUPS];
+
+/*
+ * Append a window sample to the ring of the group that task belongs to.
+ * Called from update_history() with rq->lock held. Several cpus may append
+ * to the same ring concurrently, so each producer reserves its own slot and
+ * publishes the sample with an even sequence number once it is complete.
+ */
+void walt_ring_record(struct rq *rq, struct task_struct *p,
+			u32 runtime, int samples)
+{
+	struct walt_ring *ring;
+	struct walt_ring_sample *sample;
+	int group;
+	u32 pos;
+
+	ring = smp_load_acquire(&walt_rings);
+	if (!ring)
+		return;
+
+	group = schedtune_task_group_idx(p);
+	if (unlikely(group < 0 || group >= WALT_RING_NR_GROUPS))
+		return;
+
+	ring += group;
+	pos = (u32)atomic_inc_return(&walt_ring_pos[group]) - 1;
+	sample = &ring->samples[pos % WALT_RING_NR_ENTRIES];
+
+	WRITE_ONCE(sample->seq, (pos << 1) | 1);
+	smp_wmb();
+
+	sample->pid = p->pid;
+	sample->window_start = rq->window_start;
+	sample->demand = p->ravg.demand;
+	sample->busy = runtime;
+	sample->cpu = cpu_of(rq);
+	sample->freq_scale = arch_scale_freq_capacity(NULL, cpu_of(rq));
+	sample->samples = samples;
+
+	smp_wmb();
+	WRITE_ONCE(sample->seq, pos << 1);
+	WRITE_ONCE(ring->hdr.head, (u64)pos + 1);
+}
+
+static int walt_ring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return remap_vmalloc_range(vma, walt_rings, vma->vm_pgoff);
+}
+
+static const struct file_operations walt_ring_fops = {
+	.owner		= THIS_MODULE,
+	.mmap		= walt_ring_mmap,
+	.llseek		= noop_llseek,
+};
+
+static struct miscdevice walt_ring_dev = {
+	.minor		= MISC_DYNAMIC_MINOR,
+	.name		= "walt_ring",
+	.fops		= &walt_ring_fops,
+};
+
+static int __init walt_ring_init(void)
+{
+	struct walt_ring *rings;
+	int group, ret;
+
+	BUILD_BUG_ON(sizeof(struct walt_ring) != WALT_RING_SIZE);
+
+	if (walt_disabled)
+		return 0;
+
+	rings = vmalloc_user(sizeof(struct walt_ring) * WALT_RING_NR_GROUPS);
+	if (!rings)
+		return -ENOMEM;
+
+	for (group = 0; group < WALT_RING_NR_GROUPS; group++) {
+		rings[group].hdr.version = WALT_RING_VERSION;
+		rings[group].hdr.nr_entries = WALT_RING_NR_ENTRIES;
+	}
+
+	ret = misc_register(&walt_ring_dev);
+	if (ret) {
+		pr_err("walt_ring: failed to register device (%d)\n", ret);
+		vfree(rings);
+		return ret;
+	}
+
+	/* Start recording only after the ring is fully initialized */
+	smp_store_release(&walt_rings, rings);
+
+	return 0;
+}
+late_initcall(walt_ring_init);
@@ -260,6 +260,8 @@ struct workqueue_struct {
 	struct workqueue_attrs	*unbound_attrs;	/* PW: only for unbound wqs */
 	struct pool_workqueue	*dfl_pwq;	/* PW: only for unbound wqs */
 
+	unsigned long __percpu	*cpu_stats;	/* I: works run, WQ_CPU_STATS */
+
 #ifdef CONFIG_SYSFS
 	struct wq_device	*wq_dev;	/* I: for sysfs interface */
 #endif
@@ -2116,6 +2118,8 @@ __acquires(&pool->lock)
 	dbg_snapshot_work(worker, worker->task, worker->current_func, DSS_FLAG_IN);
 	worker->current_func(work);
 	dbg_snapshot_work(worker, worker->task, worker->current_func, DSS_FLAG_OUT);
+	if (pwq->wq->cpu_stats)
+		this_cpu_inc(*pwq->wq->cpu_stats);
 	/*
 	 * While we must be careful to not use "work" after this, the trace
 	 * point will only record its address.
@@ -3279,6 +3283,7 @@ static void rcu_free_wq(struct rcu_head *rcu)
 	else
 		free_workqueue_attrs(wq->unbound_attrs);
 
+	free_percpu(wq->cpu_stats);
 	kfree(wq->rescuer);
 	kfree(wq);
 }
@@ -4007,6 +4012,12 @@ struct workqueue_struct *__alloc_workqueue_key(const char *fmt,
 			goto err_free_wq;
 	}
 
+	if (flags & WQ_CPU_STATS) {
+		wq->cpu_stats = alloc_percpu(unsigned long);
+		if (!wq->cpu_stats)
+			goto err_free_wq;
+	}
+
 	va_start(args, lock_name);
 	vsnprintf(wq->name, sizeof(wq->name), fmt, args);
 	va_end(args);
@@ -4076,6 +4087,7 @@ struct workqueue_struct *__alloc_workqueue_key(const char *fmt,
 	return wq;
 
 err_free_wq:
+	free_percpu(wq->cpu_stats);
 	free_workqueue_attrs(wq->unbound_attrs);
 	kfree(wq);
 	return NULL;
@@ -5267,6 +5279,23 @@ out_unlock:
 	return ret ?: count;
 }
 
+static ssize_t wq_cpu_stats_show(struct device *dev,
+				 struct device_attribute *attr, char *buf)
+{
+	struct workqueue_struct *wq = dev_to_wq(dev);
+	int cpu, written = 0;
+
+	for_each_possible_cpu(cpu)
+		written += scnprintf(buf + written, PAGE_SIZE - written,
+				     "cpu%d %lu\n", cpu,
+				     *per_cpu_ptr(wq->cpu_stats, cpu));
+
+	return written;
+}
+
+static struct device_attribute wq_sysfs_cpu_stats_attr =
+	__ATTR(cpu_stats, 0444, wq_cpu_stats_show, NULL);
+
 static struct device_attribute wq_sysfs_unbound_attrs[] = {
 	__ATTR(pool_ids, 0444, wq_pool_ids_show, NULL),
 	__ATTR(nice, 0644, wq_nice_show, wq_nice_store),
@@ -5396,6 +5425,15 @@ int workqueue_sysfs_register(struct workqueue_struct *wq)
 		}
 	}
 
+	if (wq->cpu_stats) {
+		ret = device_create_file(&wq_dev->dev, &wq_sysfs_cpu_stats_attr);
+		if (ret) {
+			device_unregister(&wq_dev->dev);
+			wq->wq_dev = NULL;
+			return ret;
+		}
+	}
+
 	dev_set_uevent_suppress(&wq_dev->dev, false);
 	kobject_uevent(&wq_dev->dev.kobj, KOBJ_ADD);
 	return 0;
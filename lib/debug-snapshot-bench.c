@@ -0,0 +1,109 @@
+/*
+ * debug-snapshot hook microbenchmark
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * The hooks of each event class are called in a loop with the class enabled
+ * and disabled through its static key, and the cost per call is reported in
+ * ns at late init, e.g.
+ *
+ * debug_snapshot_bench: irq      : enabled   42 ns, disabled    1 ns
+ */
+
+#define pr_fmt(fmt) "debug_snapshot_bench: " fmt
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/irqflags.h>
+#include <linux/sched/clock.h>
+#include <linux/debug-snapshot.h>
+
+#include "debug-snapshot-local.h"
+
+static unsigned int loops = 10000;
+module_param(loops, uint, 0444);
+MODULE_PARM_DESC(loops, "hook calls per measurement");
+
+static void dss_bench_irq(void)
+{
+	dbg_snapshot_irq(0, dss_bench_irq, NULL, 0, DSS_FLAG_IN);
+}
+
+static void dss_bench_cpuidle(void)
+{
+	dbg_snapshot_cpuidle("bench", 0, 0, DSS_FLAG_IN);
+}
+
+static void dss_bench_clk(void)
+{
+	dbg_snapshot_clk(NULL, __func__, 0, DSS_FLAG_IN);
+}
+
+static void dss_bench_hrtimer(void)
+{
+	s64 now = 0;
+
+	dbg_snapshot_hrtimer(NULL, &now, dss_bench_hrtimer, DSS_FLAG_IN);
+}
+
+static void dss_bench_acpm(void)
+{
+	dbg_snapshot_acpm(0, "bench", 0);
+}
+
+static const struct {
+	const char *name;
+	void (*fn)(void);
+} dss_bench_hooks[] = {
+	{ "irq",	dss_bench_irq },
+	{ "cpuidle",	dss_bench_cpuidle },
+	{ "clk",	dss_bench_clk },
+	{ "hrtimer",	dss_bench_hrtimer },
+	{ "acpm",	dss_bench_acpm },
+};
+
+/* Returns ns per call of @fn, measured with irqs disabled on this cpu */
+static u64 dss_bench_run(void (*fn)(void))
+{
+	unsigned long flags;
+	unsigned int i;
+	u64 start, ns;
+
+	local_irq_save(flags);
+	start = local_clock();
+	for (i = 0; i < loops; i++)
+		fn();
+	ns = local_clock() - start;
+	local_irq_restore(flags);
+
+	return div_u64(ns, loops);
+}
+
+static int __init dss_bench_init(void)
+{
+	u64 on, off;
+	int i;
+
+	if (!loops)
+		return -EINVAL;
+
+	for (i = 0; i < ARRAY_SIZE(dss_bench_hooks); i++) {
+		const char *name = dss_bench_hooks[i].name;
+
+		on = dss_bench_run(dss_bench_hooks[i].fn);
+		if (dbg_snapshot_set_event(name, false))
+			continue;
+		off = dss_bench_run(dss_bench_hooks[i].fn);
+		dbg_snapshot_set_event(name, true);
+
+		pr_info("%-8s : enabled %4llu ns, disabled %4llu ns\n",
+				name, on, off);
+	}
+
+	return 0;
+}
+late_initcall(dss_bench_init);
@@ -37,6 +37,8 @@ extern void dbg_snapshot_dump_task_info(void);
 extern unsigned int dbg_snapshot_get_core_panic_stat(unsigned cpu);
 extern void dbg_snapshot_set_core_panic_stat(unsigned int val, unsigned cpu);
 extern void dbg_snapshot_recall_hardlockup_core(void);
+extern int dbg_snapshot_set_event(const char *name, bool en);
+extern ssize_t dbg_snapshot_show_event(char *buf, size_t size);
 
 extern struct dbg_snapshot_helper_ops *dss_soc_ops;
 
@@ -23,6 +23,8 @@
 #include <linux/pstore_ram.h>
 #include <linux/sched/clock.h>
 #include <linux/ftrace.h>
+#include <linux/jump_label.h>
+#include <linux/mutex.h>
 
 #include "debug-snapshot-local.h"
 #include <asm/irq.h>
@@ -176,6 +178,102 @@ static char *dss_freq_name[] = {
 static struct dbg_snapshot_log_idx dss_idx;
 static struct dbg_snapshot_lastinfo dss_lastinfo;
 
+/*
+ * Each event class is selected by a static key, so that the hook of a
+ * disabled class is a single branch without loading any flag. Keys are
+ * switched only from sleepable context, see dbg_snapshot_set_event().
+ * dss_base.enabled and the kevents item still stop all classes at once from
+ * any context, e.g. on panic.
+ */
+enum dss_event {
+	DSS_EVENT_TASK,
+	DSS_EVENT_WORK,
+	DSS_EVENT_CPUIDLE,
+	DSS_EVENT_SUSPEND,
+	DSS_EVENT_IRQ,
+	DSS_EVENT_SPINLOCK,
+	DSS_EVENT_IRQS_DISABLED,
+	DSS_EVENT_CLK,
+	DSS_EVENT_PMU,
+	DSS_EVENT_FREQ,
+	DSS_EVENT_DM,
+	DSS_EVENT_HRTIMER,
+	DSS_EVENT_REGULATOR,
+	DSS_EVENT_THERMAL,
+	DSS_EVENT_I2C,
+	DSS_EVENT_SPI,
+	DSS_EVENT_BINDER,
+	DSS_EVENT_ACPM,
+	DSS_EVENT_REG,
+	DSS_EVENT_MAX,
+};
+
+static const char * const dss_event_name[DSS_EVENT_MAX] = {
+	[DSS_EVENT_TASK]		= "task",
+	[DSS_EVENT_WORK]		= "work",
+	[DSS_EVENT_CPUIDLE]		= "cpuidle",
+	[DSS_EVENT_SUSPEND]		= "suspend",
+	[DSS_EVENT_IRQ]			= "irq",
+	[DSS_EVENT_SPINLOCK]		= "spinlock",
+	[DSS_EVENT_IRQS_DISABLED]	= "irqs_disabled",
+	[DSS_EVENT_CLK]			= "clk",
+	[DSS_EVENT_PMU]			= "pmu",
+	[DSS_EVENT_FREQ]		= "freq",
+	[DSS_EVENT_DM]			= "dm",
+	[DSS_EVENT_HRTIMER]		= "hrtimer",
+	[DSS_EVENT_REGULATOR]		= "regulator",
+	[DSS_EVENT_THERMAL]		= "thermal",
+	[DSS_EVENT_I2C]			= "i2c",
+	[DSS_EVENT_SPI]			= "spi",
+	[DSS_EVENT_BINDER]		= "binder",
+	[DSS_EVENT_ACPM]		= "acpm",
+	[DSS_EVENT_REG]			= "reg",
+};
+
+static struct static_key_true dss_event_key[DSS_EVENT_MAX] = {
+	[0 ... DSS_EVENT_MAX - 1] = STATIC_KEY_TRUE_INIT,
+};
+static DEFINE_MUTEX(dss_event_lock);
+
+#define dss_event_enabled(event)	static_branch_likely(&dss_event_key[event])
+
+int dbg_snapshot_set_event(const char *name, bool en)
+{
+	int i;
+
+	for (i = 0; i < DSS_EVENT_MAX; i++) {
+		if (strcmp(dss_event_name[i], name))
+			continue;
+
+		mutex_lock(&dss_event_lock);
+		if (en && !static_key_enabled(&dss_event_key[i]))
+			static_branch_enable(&dss_event_key[i]);
+		else if (!en && static_key_enabled(&dss_event_key[i]))
+			static_branch_disable(&dss_event_key[i]);
+		mutex_unlock(&dss_event_lock);
+
+		pr_info("debug-snapshot: event - %s is %sabled\n",
+				name, en ? "en" : "dis");
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+ssize_t dbg_snapshot_show_event(char *buf, size_t size)
+{
+	ssize_t n = 0;
+	int i;
+
+	for (i = 0; i < DSS_EVENT_MAX; i++)
+		n += scnprintf(buf + n, size - n, "%-12s : %sable\n",
+				dss_event_name[i],
+				static_key_enabled(&dss_event_key[i]) ?
+				"en" : "dis");
+
+	return n;
+}
+
 void __init dbg_snapshot_init_log_idx(void)
 {
 	int i;
@@ -622,7 +720,8 @@ void dbg_snapshot_task(int cpu, void *v_task)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_TASK) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		unsigned long i = atomic_inc_return(&dss_idx.task_log_idx[cpu]) &
@@ -642,7 +741,8 @@ void dbg_snapshot_work(void *worker, void *v_task, void *fn, int en)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_WORK) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 
 	{
@@ -663,7 +763,8 @@ void dbg_snapshot_cpuidle(char *modes, unsigned state, int diff, int en)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_CPUIDLE) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -684,7 +785,8 @@ void dbg_snapshot_suspend(char *log, void *fn, void *dev, int state, int en)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_SUSPEND) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int len;
@@ -827,7 +929,8 @@ void dbg_snapshot_regulator(unsigned long long timestamp, char* f_name, unsigned
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_REGULATOR) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -853,7 +956,8 @@ void dbg_snapshot_thermal(void *data, unsigned int temp, char *name, unsigned in
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_THERMAL) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -873,12 +977,15 @@ void dbg_snapshot_thermal(void *data, unsigned int temp, char *name, unsigned in
 void dbg_snapshot_irq(int irq, void *fn, void *val, unsigned long long start_time, int en)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
-	unsigned long flags;
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_IRQ) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 
-	flags = pure_arch_local_irq_save();
+	/*
+	 * The slot is owned once the index is claimed, so that a nested
+	 * interrupt only takes the next slot and no irq disable is needed.
+	 */
 	{
 		int cpu = raw_smp_processor_id();
 		unsigned long long time, latency;
@@ -901,7 +1008,6 @@ void dbg_snapshot_irq(int irq, void *fn, void *val, unsigned long long start_tim
 		dss_log->irq[cpu][i].latency = latency;
 		dss_log->irq[cpu][i].en = en;
 	}
-	pure_arch_local_irq_restore(flags);
 }
 
 #ifdef CONFIG_DEBUG_SNAPSHOT_SPINLOCK
@@ -909,7 +1015,8 @@ void dbg_snapshot_spinlock(void *v_lock, int en)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_SPINLOCK) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -944,7 +1051,8 @@ void dbg_snapshot_irqs_disabled(unsigned long flags)
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 	int cpu = raw_smp_processor_id();
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_IRQS_DISABLED) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 
 	if (unlikely(flags)) {
@@ -984,7 +1092,8 @@ void dbg_snapshot_clk(void *clock, const char *func_name, unsigned long arg, int
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_CLK) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1005,7 +1114,8 @@ void dbg_snapshot_pmu(int id, const char *func_name, int mode)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_PMU) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1087,7 +1197,8 @@ void dbg_snapshot_freq(int type, unsigned long old_freq, unsigned long target_fr
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_FREQ) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1161,7 +1272,8 @@ void dbg_snapshot_dm(int type, unsigned long min, unsigned long max, s32 wait_t,
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_DM) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1184,7 +1296,8 @@ void dbg_snapshot_hrtimer(void *timer, s64 *now, void *fn, int en)
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_HRTIMER) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1205,7 +1318,8 @@ void dbg_snapshot_i2c(struct i2c_adapter *adap, struct i2c_msg *msgs, int num, i
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_I2C) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1227,7 +1341,8 @@ void dbg_snapshot_spi(struct spi_controller *ctlr, struct spi_message *cur_msg,
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_SPI) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1252,7 +1367,8 @@ void dbg_snapshot_binder(struct trace_binder_transaction_base *base,
 	int cpu;
 	unsigned long i;
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_BINDER) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	if (base == NULL)
 		return;
@@ -1288,7 +1404,8 @@ void dbg_snapshot_acpm(unsigned long long timestamp, const char *log, unsigned i
 {
 	struct dbg_snapshot_item *item = &dss_items[dss_desc.kevents_num];
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_ACPM) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 	{
 		int cpu = raw_smp_processor_id();
@@ -1351,7 +1468,8 @@ void dbg_snapshot_reg(unsigned int read, size_t val, size_t reg, int en)
 	unsigned long i, j;
 	size_t phys_reg, start_addr, end_addr;
 
-	if (unlikely(!dss_base.enabled || !item->entry.enabled))
+	if (!dss_event_enabled(DSS_EVENT_REG) ||
+	    unlikely(!dss_base.enabled || !item->entry.enabled))
 		return;
 
 	if (dss_reg_exlist[0].addr == 0)
@@ -96,6 +96,26 @@ static ssize_t dss_enable_store(struct kobject *kobj,
 	return count;
 }
 
+static ssize_t dss_event_show(struct kobject *kobj,
+				struct kobj_attribute *attr, char *buf)
+{
+	return dbg_snapshot_show_event(buf, PAGE_SIZE);
+}
+
+static ssize_t dss_event_store(struct kobject *kobj,
+				struct kobj_attribute *attr,
+				const char *buf, size_t count)
+{
+	char name[16];
+	int en;
+
+	if (sscanf(buf, "%15s %d", name, &en) != 2 ||
+			dbg_snapshot_set_event(name, !!en))
+		pr_info("echo name 0|1 > events\n");
+
+	return count;
+}
+
 static ssize_t dss_callstack_show(struct kobject *kobj,
 				struct kobj_attribute *attr, char *buf)
 {
@@ -277,6 +297,9 @@ static ssize_t dss_reg_exlist_store(struct kobject *kobj,
 static struct kobj_attribute dss_enable_attr =
 __ATTR(enabled, 0644, dss_enable_show, dss_enable_store);
 
+static struct kobj_attribute dss_event_attr =
+__ATTR(events, 0644, dss_event_show, dss_event_store);
+
 static struct kobj_attribute dss_callstack_attr =
 __ATTR(callstack, 0644, dss_callstack_show, dss_callstack_store);
 
@@ -300,6 +323,7 @@ __ATTR(exlist_reg, 0644, dss_reg_exlist_show, dss_reg_exlist_store);
 
 static struct attribute *dss_sysfs_attrs[] = {
 	&dss_enable_attr.attr,
+	&dss_event_attr.attr,
 	&dss_callstack_attr.attr,
 	&dss_irqlog_attr.attr,
 #ifdef CONFIG_DEBUG_SNAPSHOT_IRQ_EXIT
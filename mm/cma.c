@@ -35,6 +35,8 @@
 #include <linux/cma.h>
 #include <linux/highmem.h>
 #include <linux/io.h>
+#include <linux/ktime.h>
+#include <linux/moduleparam.h>
 #include <trace/events/cma.h>
 
 #include "cma.h"
@@ -43,6 +45,18 @@ struct cma cma_areas[MAX_CMA_AREAS];
 unsigned cma_area_count;
 static DEFINE_MUTEX(cma_mutex);
 
+/*
+ * Pre-migrated reserve: a work keeps reserve_percent of every area migrated
+ * out and held, so that cma_alloc() serves the requests which fit in it
+ * without migrating the pages in use at that time. The reserve is taken by
+ * pageblocks from the top of the area, and given back when cma_alloc()
+ * finds no free range left.
+ */
+static unsigned int cma_reserve_percent;
+static bool cma_reserve_ready;
+
+#define CMA_RESERVE_DELAY	(2 * HZ)
+
 phys_addr_t cma_get_base(const struct cma *cma)
 {
 	return PFN_PHYS(cma->base_pfn);
@@ -96,6 +110,168 @@ static void cma_clear_bitmap(struct cma *cma, unsigned long pfn,
 	mutex_unlock(&cma->lock);
 }
 
+/* Gives back the reserved pages above @target */
+static void cma_reserve_drain(struct cma *cma, unsigned long target)
+{
+	unsigned long bitmap_maxno = cma_bitmap_maxno(cma);
+	unsigned long start, end, nr, pfn;
+
+	mutex_lock(&cma->lock);
+	while (cma->nr_reserved > target) {
+		start = find_first_zero_bit(cma->reserve_map, bitmap_maxno);
+		if (WARN_ON_ONCE(start >= bitmap_maxno))
+			break;
+		end = find_next_bit(cma->reserve_map, bitmap_maxno, start);
+		nr = min(end - start, cma_bitmap_pages_to_bits(cma,
+					cma->nr_reserved - target));
+		bitmap_set(cma->reserve_map, start, nr);
+		cma->nr_reserved -= nr << cma->order_per_bit;
+		mutex_unlock(&cma->lock);
+
+		pfn = cma->base_pfn + (start << cma->order_per_bit);
+		free_contig_range(pfn, nr << cma->order_per_bit);
+		cma_clear_bitmap(cma, pfn, nr << cma->order_per_bit);
+
+		mutex_lock(&cma->lock);
+	}
+	mutex_unlock(&cma->lock);
+}
+
+/* Migrates out free pageblocks, from the top of the area, up to @target */
+static void cma_reserve_fill(struct cma *cma, unsigned long target)
+{
+	unsigned long chunk = cma_bitmap_pages_to_bits(cma, pageblock_nr_pages);
+	unsigned long chunk_pages = chunk << cma->order_per_bit;
+	unsigned long start, end, pfn;
+	int ret;
+
+	for (end = round_down(cma_bitmap_maxno(cma), chunk); end >= chunk;
+	     end = start) {
+		start = end - chunk;
+
+		mutex_lock(&cma->lock);
+		if (cma->nr_reserved + chunk_pages > target) {
+			mutex_unlock(&cma->lock);
+			break;
+		}
+		if (find_next_bit(cma->bitmap, end, start) < end) {
+			mutex_unlock(&cma->lock);
+			continue;
+		}
+		bitmap_set(cma->bitmap, start, chunk);
+		mutex_unlock(&cma->lock);
+
+		pfn = cma->base_pfn + (start << cma->order_per_bit);
+		mutex_lock(&cma_mutex);
+		ret = alloc_contig_range(pfn, pfn + chunk_pages, MIGRATE_CMA,
+					 GFP_KERNEL | __GFP_NOWARN);
+		mutex_unlock(&cma_mutex);
+
+		mutex_lock(&cma->lock);
+		if (ret) {
+			bitmap_clear(cma->bitmap, start, chunk);
+			cma->stats.nr_reserve_busy++;
+		} else {
+			bitmap_clear(cma->reserve_map, start, chunk);
+			cma->nr_reserved += chunk_pages;
+		}
+		mutex_unlock(&cma->lock);
+
+		cond_resched();
+	}
+}
+
+static void cma_reserve_work(struct work_struct *work)
+{
+	struct cma *cma = container_of(to_delayed_work(work), struct cma,
+				       reserve_work);
+	unsigned long target = cma->count * READ_ONCE(cma_reserve_percent) / 100;
+
+	cma_reserve_drain(cma, target);
+	cma_reserve_fill(cma, target);
+}
+
+static void cma_reserve_kick(struct cma *cma)
+{
+	if (cma->reserve_map && READ_ONCE(cma_reserve_ready))
+		mod_delayed_work(system_unbound_wq, &cma->reserve_work,
+				 CMA_RESERVE_DELAY);
+}
+
+static int cma_reserve_percent_set(const char *val,
+				   const struct kernel_param *kp)
+{
+	unsigned int percent;
+	int i, ret;
+
+	ret = kstrtouint(val, 0, &percent);
+	if (ret || percent > 100)
+		return -EINVAL;
+
+	WRITE_ONCE(cma_reserve_percent, percent);
+	for (i = 0; i < cma_area_count; i++)
+		cma_reserve_kick(&cma_areas[i]);
+
+	return 0;
+}
+
+static const struct kernel_param_ops cma_reserve_percent_ops = {
+	.set = cma_reserve_percent_set,
+	.get = param_get_uint,
+};
+module_param_cb(reserve_percent, &cma_reserve_percent_ops,
+		&cma_reserve_percent, 0644);
+
+/* Takes the range from the reserve, it needs no migration */
+static struct page *cma_alloc_reserved(struct cma *cma, size_t count,
+				       unsigned long mask, unsigned long offset)
+{
+	unsigned long bitmap_maxno = cma_bitmap_maxno(cma);
+	unsigned long bitmap_count = cma_bitmap_pages_to_bits(cma, count);
+	unsigned long bitmap_no, pfn, tail;
+
+	if (!cma->reserve_map || !READ_ONCE(cma->nr_reserved))
+		return NULL;
+
+	mutex_lock(&cma->lock);
+	bitmap_no = bitmap_find_next_zero_area_off(cma->reserve_map,
+			bitmap_maxno, 0, bitmap_count, mask, offset);
+	if (bitmap_no >= bitmap_maxno) {
+		mutex_unlock(&cma->lock);
+		return NULL;
+	}
+	bitmap_set(cma->reserve_map, bitmap_no, bitmap_count);
+	cma->nr_reserved -= bitmap_count << cma->order_per_bit;
+	cma->stats.nr_reserve_hit++;
+	mutex_unlock(&cma->lock);
+
+	pfn = cma->base_pfn + (bitmap_no << cma->order_per_bit);
+	/* as alloc_contig_range(), only @count pages of the last bit */
+	tail = (bitmap_count << cma->order_per_bit) - count;
+	if (tail)
+		free_contig_range(pfn + count, tail);
+
+	return pfn_to_page(pfn);
+}
+
+static void cma_account_alloc(struct cma *cma, ktime_t start, bool success,
+			      unsigned long nr_busy)
+{
+	unsigned long us = ktime_us_delta(ktime_get(), start);
+	unsigned long ms = us / USEC_PER_MSEC;
+	int i = ms ? min_t(int, ilog2(ms) / 2 + 1, CMA_LATENCY_BUCKETS - 1) : 0;
+
+	mutex_lock(&cma->lock);
+	cma->stats.nr_alloc++;
+	if (!success)
+		cma->stats.nr_fail++;
+	cma->stats.nr_busy += nr_busy;
+	cma->stats.latency[i]++;
+	if (us > cma->stats.max_latency_us)
+		cma->stats.max_latency_us = us;
+	mutex_unlock(&cma->lock);
+}
+
 static int __init cma_activate_area(struct cma *cma)
 {
 	int bitmap_size = BITS_TO_LONGS(cma_bitmap_maxno(cma)) * sizeof(long);
@@ -138,6 +314,12 @@ static int __init cma_activate_area(struct cma *cma)
 	spin_lock_init(&cma->mem_head_lock);
 #endif
 
+	/* the area works without a reserve */
+	cma->reserve_map = kmalloc(bitmap_size, GFP_KERNEL);
+	if (cma->reserve_map)
+		bitmap_fill(cma->reserve_map, cma_bitmap_maxno(cma));
+	INIT_DEFERRABLE_WORK(&cma->reserve_work, cma_reserve_work);
+
 	return 0;
 
 not_in_zone:
@@ -162,6 +344,19 @@ static int __init cma_init_reserved_areas(void)
 }
 core_initcall(cma_init_reserved_areas);
 
+static int __init cma_reserve_init(void)
+{
+	int i;
+
+	WRITE_ONCE(cma_reserve_ready, true);
+	if (cma_reserve_percent)
+		for (i = 0; i < cma_area_count; i++)
+			cma_reserve_kick(&cma_areas[i]);
+
+	return 0;
+}
+late_initcall(cma_reserve_init);
+
 /**
  * cma_init_reserved_mem() - create custom contiguous area from reserved memory
  * @base: Base address of the reserved area
@@ -421,7 +616,10 @@ struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align,
 	unsigned long pfn = -1;
 	unsigned long start = 0;
 	unsigned long bitmap_maxno, bitmap_no, bitmap_count;
+	unsigned long nr_busy = 0;
 	struct page *page = NULL;
+	bool drained = false;
+	ktime_t start_time;
 	int ret = -ENOMEM;
 
 	if (!cma || !cma->count)
@@ -441,6 +639,17 @@ struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align,
 	if (bitmap_count > bitmap_maxno)
 		return NULL;
 
+	start_time = ktime_get();
+
+	page = cma_alloc_reserved(cma, count, mask, offset);
+	if (page) {
+		pfn = page_to_pfn(page);
+		ret = 0;
+		cma_reserve_kick(cma);
+		goto out;
+	}
+
+retry:
 	for (;;) {
 		mutex_lock(&cma->lock);
 		bitmap_no = bitmap_find_next_zero_area_off(cma->bitmap,
@@ -448,6 +657,14 @@ struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align,
 				offset);
 		if (bitmap_no >= bitmap_maxno) {
 			mutex_unlock(&cma->lock);
+			/* the reserve may hold the range */
+			if (!drained && READ_ONCE(cma->nr_reserved)) {
+				drained = true;
+				cma_reserve_drain(cma, 0);
+				cma_reserve_kick(cma);
+				start = 0;
+				goto retry;
+			}
 			break;
 		}
 		bitmap_set(cma->bitmap, bitmap_no, bitmap_count);
@@ -472,12 +689,16 @@ struct page *cma_alloc(struct cma *cma, size_t count, unsigned int align,
 		if (ret != -EBUSY)
 			break;
 
+		nr_busy++;
+
 		pr_debug("%s(): memory range at %p is busy, retrying\n",
 			 __func__, pfn_to_page(pfn));
 		/* try again with a bit different memory target */
 		start = bitmap_no + mask + 1;
 	}
 
+out:
+	cma_account_alloc(cma, start_time, page, nr_busy);
 	trace_cma_alloc(pfn, page, count, align);
 
 	if (ret && !(gfp_mask & __GFP_NOWARN)) {
@@ -520,6 +741,9 @@ bool cma_release(struct cma *cma, const struct page *pages, unsigned int count)
 	cma_clear_bitmap(cma, pfn, count);
 	trace_cma_release(pfn, pages, count);
 
+	if (READ_ONCE(cma_reserve_percent))
+		cma_reserve_kick(cma);
+
 	return true;
 }
 
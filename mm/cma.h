@@ -2,6 +2,24 @@
 #ifndef __MM_CMA_H__
 #define __MM_CMA_H__
 
+#include <linux/workqueue.h>
+
+/*
+ * Buckets of cma_alloc() latency: bucket 0 is < 1 ms, bucket i < 4^i ms,
+ * the last one the rest.
+ */
+#define CMA_LATENCY_BUCKETS	7
+
+struct cma_stats {
+	unsigned long nr_alloc;
+	unsigned long nr_fail;
+	unsigned long nr_reserve_hit;	/* served by the reserve */
+	unsigned long nr_busy;		/* ranges which failed to migrate */
+	unsigned long nr_reserve_busy;	/* same, for the reserve */
+	unsigned long max_latency_us;
+	unsigned long latency[CMA_LATENCY_BUCKETS];
+};
+
 struct cma {
 	unsigned long   base_pfn;
 	unsigned long   count;
@@ -13,6 +31,14 @@ struct cma {
 	spinlock_t mem_head_lock;
 #endif
 	const char *name;
+	/*
+	 * Ranges already migrated out and held for cma_alloc(), as cleared
+	 * bits. They are set in bitmap as well. Protected by lock.
+	 */
+	unsigned long	*reserve_map;
+	unsigned long	nr_reserved;	/* pages */
+	struct delayed_work reserve_work;
+	struct cma_stats stats;		/* protected by lock */
 };
 
 extern struct cma cma_areas[MAX_CMA_AREAS];
@@ -10,6 +10,7 @@
 #include <linux/cma.h>
 #include <linux/list.h>
 #include <linux/kernel.h>
+#include <linux/seq_file.h>
 #include <linux/slab.h>
 #include <linux/mm_types.h>
 
@@ -70,6 +71,46 @@ static int cma_maxchunk_get(void *data, u64 *val)
 }
 DEFINE_SIMPLE_ATTRIBUTE(cma_maxchunk_fops, cma_maxchunk_get, NULL, "%llu\n");
 
+static int cma_stats_show(struct seq_file *m, void *unused)
+{
+	struct cma *cma = m->private;
+	struct cma_stats stats;
+	unsigned long nr_reserved;
+	int i;
+
+	mutex_lock(&cma->lock);
+	stats = cma->stats;
+	nr_reserved = cma->nr_reserved;
+	mutex_unlock(&cma->lock);
+
+	seq_printf(m, "alloc: %lu\n", stats.nr_alloc);
+	seq_printf(m, "fail: %lu\n", stats.nr_fail);
+	seq_printf(m, "reserve_hit: %lu\n", stats.nr_reserve_hit);
+	seq_printf(m, "reserved_pages: %lu\n", nr_reserved);
+	seq_printf(m, "migrate_busy: %lu\n", stats.nr_busy);
+	seq_printf(m, "reserve_migrate_busy: %lu\n", stats.nr_reserve_busy);
+	seq_printf(m, "max_latency_us: %lu\n", stats.max_latency_us);
+	for (i = 0; i < CMA_LATENCY_BUCKETS - 1; i++)
+		seq_printf(m, "latency_lt_%lums: %lu\n", 1UL << (2 * i),
+			   stats.latency[i]);
+	seq_printf(m, "latency_ge_%lums: %lu\n", 1UL << (2 * (i - 1)),
+		   stats.latency[i]);
+
+	return 0;
+}
+
+static int cma_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, cma_stats_show, inode->i_private);
+}
+
+static const struct file_operations cma_stats_fops = {
+	.open		= cma_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static void cma_add_to_cma_mem_list(struct cma *cma, struct cma_mem *mem)
 {
 	spin_lock(&cma->mem_head_lock);
@@ -186,6 +227,7 @@ static void cma_debugfs_add_one(struct cma *cma, int idx)
 				&cma->order_per_bit, &cma_debugfs_fops);
 	debugfs_create_file("used", S_IRUGO, tmp, cma, &cma_used_fops);
 	debugfs_create_file("maxchunk", S_IRUGO, tmp, cma, &cma_maxchunk_fops);
+	debugfs_create_file("stats", S_IRUGO, tmp, cma, &cma_stats_fops);
 
 	u32s = DIV_ROUND_UP(cma_bitmap_maxno(cma), BITS_PER_BYTE * sizeof(u32));
 	debugfs_create_u32_array("bitmap", S_IRUGO, tmp, (u32*)cma->bitmap, u32s);
@@ -2353,6 +2353,47 @@ int mmap_readaround_limit = (VM_MAX_READAHEAD / 4); 		/* page */
 int mmap_readaround_limit = CONFIG_MMAP_READAROUND_LIMIT;	/* page */
 #endif
 
+#define MMAP_READAROUND_MIN	(4)	/* page */
+
+/*
+ * The read-around window of a file is sized by the hit ratio of the previous
+ * window when it is replaced: halved below 1/4 of its pages faulted in and
+ * doubled above 3/4, up to mmap_readaround_limit. Files faulted at random,
+ * like the dex and so files of an app launch, end up with a small window.
+ */
+static unsigned int mmap_readaround_pages(struct file_ra_state *ra)
+{
+	unsigned int max_pages = min_t(unsigned int, ra->ra_pages,
+				       mmap_readaround_limit);
+	unsigned int pages = ra->mmap_ra_pages ?: max_pages;
+	unsigned int hit = min(ra->mmap_hit, ra->size);
+
+	if (ra->size) {
+		count_vm_events(PGREADAROUND_HIT, hit);
+		count_vm_events(PGREADAROUND_WASTE, ra->size - hit);
+
+		if (hit * 4 < ra->size)
+			pages = max_t(unsigned int, pages / 2,
+				      MMAP_READAROUND_MIN);
+		else if (hit * 4 >= ra->size * 3)
+			pages *= 2;
+	}
+
+	pages = min(pages, max_pages);
+	ra->mmap_ra_pages = pages;
+	/* the page faulted in */
+	ra->mmap_hit = 1;
+
+	return pages;
+}
+
+static inline void mmap_readaround_hit(struct file_ra_state *ra,
+				       pgoff_t offset)
+{
+	if (offset - ra->start < ra->size && ra->mmap_hit < ra->size)
+		ra->mmap_hit++;
+}
+
 /*
  * Synchronous readahead happens when we don't even find
  * a page in the page cache at all.
@@ -2391,7 +2432,8 @@ static void do_sync_mmap_readahead(struct vm_area_struct *vma,
 	/*
 	 * mmap read-around
 	 */
-	ra_pages = min_t(unsigned int, ra->ra_pages, mmap_readaround_limit);
+	ra_pages = mmap_readaround_pages(ra);
+	count_vm_events(PGREADAROUND, ra_pages);
 	ra->start = max_t(long, 0, offset - ra_pages / 2);
 	ra->size = ra_pages;
 	ra->async_size = ra_pages / 4;
@@ -2415,6 +2457,7 @@ static void do_async_mmap_readahead(struct vm_area_struct *vma,
 		return;
 	if (ra->mmap_miss > 0)
 		ra->mmap_miss--;
+	mmap_readaround_hit(ra, offset);
 	if (PageReadahead(page))
 		page_cache_async_readahead(mapping, ra, file,
 					   page, offset, ra->ra_pages);
@@ -2624,6 +2667,7 @@ repeat:
 
 		if (file->f_ra.mmap_miss > 0)
 			file->f_ra.mmap_miss--;
+		mmap_readaround_hit(&file->f_ra, iter.index);
 
 		vmf->address += (iter.index - last_pgoff) << PAGE_SHIFT;
 		if (vmf->pte)
@@ -29,6 +29,9 @@
 #include <linux/oom.h>
 #include <linux/sched/task.h>
 #include <linux/sched/mm.h>
+#include <linux/seq_file.h>
+#include <linux/uaccess.h>
+#include <linux/workqueue.h>
 
 #include "internal.h"
 
@@ -256,40 +259,181 @@ static void prep_highorder_pages(unsigned long base_pfn, int order)
 		set_page_count(pfn_to_page(pfn), 0);
 }
 
-/**
- * alloc_pages_highorder_except() - allocate large order pages
- * @order:           required page order
- * @pages:           array to store allocated @order order pages
- * @nents:           number of @order order pages
- * @exception_areas: memory areas that should not include pages in @pages
- * @nr_exception:    number of memory areas in @exception_areas
- *
- * Returns 0 on allocation success. -error otherwise.
- *
- * Allocates @nents pages of @order << PAGE_SHIFT number of consecutive pages
- * and store the page descriptors of the allocated pages to @pages. Every page
- * in @pages should also be aligned by @order << PAGE_SHIFT.
- *
- * If @nr_exception is larger than 0, alloc_page_highorder_except() does not
- * allocate pages in the areas described in @exception_areas. @exception_areas
- * is an array of array with two elements: The first element is the start
- * address of an area and the last element is the end address. The end address
- * is the last byte address in the area, that is "[start address] + [size] - 1".
+/*
+ * Tries to migrate out the chunk at *@ppfn. Returns 0 if the chunk is
+ * allocated. Otherwise, *@ppfn may be advanced to skip the area that is not
+ * worth scanning. It is set to the last chunk to skip because the caller
+ * adds a chunk before the next try.
  */
-int alloc_pages_highorder_except(int order, struct page **pages, int nents,
-				 phys_addr_t exception_areas[][2],
-				 int nr_exception)
+static int hpa_isolate_chunk(unsigned long *ppfn, int order,
+			     phys_addr_t exception_areas[][2],
+			     int nr_exception)
+{
+	unsigned int nr_pages = 1 << order;
+	unsigned long pfn = *ppfn;
+	unsigned long tmp;
+	int mt, ret;
+
+	/* pfn validation check in the range */
+	tmp = pfn;
+	do {
+		if (!pfn_valid(tmp))
+			break;
+	} while (++tmp < (pfn + nr_pages));
+
+	if (tmp < (pfn + nr_pages))
+		return -EINVAL;
+
+	mt = get_pageblock_migratetype(pfn_to_page(pfn));
+	/*
+	 * CMA pages should not be reclaimed.
+	 * Isolated page blocks should not be tried again because it
+	 * causes isolated page block remained in isolated state
+	 * forever.
+	 */
+	if (is_migrate_cma(mt) || is_migrate_isolate(mt)) {
+		/* nr_pages is added before next iteration */
+		*ppfn = ALIGN(pfn + 1, pageblock_nr_pages) - nr_pages;
+		return -EBUSY;
+	}
+
+	ret = get_exception_of_page(pfn << PAGE_SHIFT,
+				    exception_areas, nr_exception);
+	if (ret >= 0) {
+		*ppfn = ((exception_areas[ret][1] + 1) >> PAGE_SHIFT) - nr_pages;
+		return -EINVAL;
+	}
+
+	if (!is_movable_chunk(pfn, order))
+		return -EBUSY;
+
+	ret = alloc_contig_range_fast(pfn, pfn + nr_pages, mt);
+	if (ret)
+		return ret;
+
+	prep_highorder_pages(pfn, order);
+
+	return 0;
+}
+
+/**********************************************************************
+ *                          Parallel scan                             *
+ **********************************************************************/
+/*
+ * Migrating out a large number of chunks is dominated by page copy, so
+ * the pfn range is split into disjoint parts scanned by unbound workers
+ * that run on idle cpus. Boundaries are aligned to the isolation unit of
+ * alloc_contig_range() so that workers never isolate the same pageblock.
+ */
+#define HPA_MAX_WORKERS		8
+#define HPA_PARALLEL_MIN	16	/* chunks to go parallel */
+
+static u32 hpa_workers = 4;
+
+struct hpa_scan_ctl {
+	int			order;
+	struct page		**pages;
+	atomic_t		want;
+	atomic_t		filled;
+	phys_addr_t		(*exception_areas)[2];
+	int			nr_exception;
+	atomic_t		pending;
+	struct completion	done;
+};
+
+struct hpa_scan_work {
+	struct work_struct	work;
+	struct hpa_scan_ctl	*ctl;
+	unsigned long		start;
+	unsigned long		end;
+};
+
+static void hpa_scan_work_fn(struct work_struct *work)
+{
+	struct hpa_scan_work *sw = container_of(work, struct hpa_scan_work,
+						work);
+	struct hpa_scan_ctl *ctl = sw->ctl;
+	unsigned int nr_pages = 1 << ctl->order;
+	unsigned long pfn;
+
+	for (pfn = ALIGN(sw->start, nr_pages); pfn + nr_pages <= sw->end;
+	     pfn += nr_pages) {
+		/* reserve a slot first not to allocate more than wanted */
+		if (atomic_dec_if_positive(&ctl->want) < 0)
+			break;
+
+		if (hpa_isolate_chunk(&pfn, ctl->order, ctl->exception_areas,
+				      ctl->nr_exception)) {
+			atomic_inc(&ctl->want);
+			continue;
+		}
+
+		ctl->pages[atomic_inc_return(&ctl->filled) - 1] =
+							pfn_to_page(pfn);
+	}
+
+	if (atomic_dec_and_test(&ctl->pending))
+		complete(&ctl->done);
+}
+
+/* Returns the number of chunks stored from @pages[0] */
+static int hpa_parallel_scan(int order, struct page **pages, int count,
+			     int nr_workers,
+			     phys_addr_t exception_areas[][2],
+			     int nr_exception)
+{
+	struct hpa_scan_work works[HPA_MAX_WORKERS];
+	struct hpa_scan_ctl ctl = {
+		.order = order,
+		.pages = pages,
+		.exception_areas = exception_areas,
+		.nr_exception = nr_exception,
+	};
+	unsigned long align = max_t(unsigned long, MAX_ORDER_NR_PAGES,
+				    pageblock_nr_pages);
+	unsigned long part, pfn;
+	int i;
+
+	part = ALIGN(DIV_ROUND_UP(end_pfn - start_pfn, nr_workers), align);
+
+	atomic_set(&ctl.want, count);
+	atomic_set(&ctl.filled, 0);
+	atomic_set(&ctl.pending, nr_workers);
+	init_completion(&ctl.done);
+
+	for (i = 0, pfn = start_pfn; i < nr_workers; i++, pfn += part) {
+		works[i].ctl = &ctl;
+		works[i].start = min(pfn, end_pfn);
+		works[i].end = min(pfn + part, end_pfn);
+		INIT_WORK_ONSTACK(&works[i].work, hpa_scan_work_fn);
+		queue_work(system_unbound_wq, &works[i].work);
+	}
+
+	wait_for_completion(&ctl.done);
+
+	for (i = 0; i < nr_workers; i++)
+		destroy_work_on_stack(&works[i].work);
+
+	return atomic_read(&ctl.filled);
+}
+
+/*
+ * Tries to fill @pages[@nents - @remained..@nents) from free lists first and
+ * then by migrating movable chunks. Returns the number of chunks that could
+ * not be allocated. It never kills a process.
+ */
+static int __alloc_pages_highorder(int order, struct page **pages, int nents,
+				   int remained,
+				   phys_addr_t exception_areas[][2],
+				   int nr_exception)
 {
 	struct zone *zone;
 	unsigned int nr_pages = 1 << order;
 	unsigned long total_scanned = 0;
-	unsigned long pfn, tmp;
-	int remained = nents;
-	int ret;
-	int retry_count = 0;
+	unsigned long pfn;
+	int nr_workers;
 	int allocated;
 
-retry:
 	for_each_zone(zone) {
 		if (zone->spanned_pages == 0)
 			continue;
@@ -305,63 +449,240 @@ retry:
 
 	migrate_prep();
 
+	nr_workers = min_t(int, min_t(u32, hpa_workers, HPA_MAX_WORKERS),
+			   num_online_cpus());
+	if (nr_workers > 1 && remained >= HPA_PARALLEL_MIN) {
+		remained -= hpa_parallel_scan(order, pages + nents - remained,
+					      remained, nr_workers,
+					      exception_areas, nr_exception);
+		if (remained == 0)
+			return 0;
+	}
+
+	/* serial scan picks up what the parallel scan has missed */
 	for (pfn = ALIGN(cached_scan_pfn, nr_pages);
 			(total_scanned < (end_pfn - start_pfn) * MAX_SCAN_TRY)
 			&& (remained > 0);
 			pfn += nr_pages, total_scanned += nr_pages) {
-		int mt;
-
 		if (pfn + nr_pages > end_pfn) {
 			pfn = start_pfn;
 			continue;
 		}
 
-		/* pfn validation check in the range */
-		tmp = pfn;
-		do {
-			if (!pfn_valid(tmp))
-				break;
-		} while (++tmp < (pfn + nr_pages));
-
-		if (tmp < (pfn + nr_pages))
+		if (hpa_isolate_chunk(&pfn, order, exception_areas,
+				      nr_exception))
 			continue;
 
-		mt = get_pageblock_migratetype(pfn_to_page(pfn));
-		/*
-		 * CMA pages should not be reclaimed.
-		 * Isolated page blocks should not be tried again because it
-		 * causes isolated page block remained in isolated state
-		 * forever.
-		 */
-		if (is_migrate_cma(mt) || is_migrate_isolate(mt)) {
-			/* nr_pages is added before next iteration */
-			pfn = ALIGN(pfn + 1, pageblock_nr_pages) - nr_pages;
-			continue;
-		}
+		pages[nents - remained] = pfn_to_page(pfn);
+		remained--;
+	}
 
-		ret = get_exception_of_page(pfn << PAGE_SHIFT,
-					    exception_areas, nr_exception);
-		if (ret >= 0) {
-			pfn = (exception_areas[ret][1] + 1) >> PAGE_SHIFT;
-			pfn -= nr_pages;
-			continue;
-		}
+	/* save latest scanned pfn */
+	cached_scan_pfn = pfn;
 
-		if (!is_movable_chunk(pfn, order))
-			continue;
+	return remained;
+}
 
-		ret = alloc_contig_range_fast(pfn, pfn + nr_pages, mt);
-		if (ret == 0)
-			prep_highorder_pages(pfn, order);
-		else
+/**********************************************************************
+ *                          Reserve mode                              *
+ **********************************************************************/
+/*
+ * In reserve mode, a background worker keeps @target chunks of @order
+ * already compacted and taken out of the buddy allocator. Allocation of the
+ * same order takes the reserved chunks first so that its latency does not
+ * depend on migration and hpa_killer(). The worker refills the reserve
+ * whenever chunks are taken out of it.
+ */
+#define HPA_REFILL_BATCH	16
+#define HPA_REFILL_RETRY_MS	1000
+#define HPA_LAT_BUCKETS		24	/* bucket i counts < 2^i us */
+
+static struct hpa_reserve {
+	struct mutex		lock;
+	struct list_head	chunks;
+	unsigned int		order;
+	unsigned int		target;
+	unsigned int		count;
+	struct delayed_work	work;
+
+	/* statistics */
+	unsigned long		alloc_count;
+	unsigned long		alloc_fail;
+	unsigned long		served_chunks;
+	unsigned long		refill_chunks;
+	unsigned long		refill_fail;
+	unsigned long		kill_count;
+	unsigned long		kill_avoided;
+	unsigned long		lat_hist[HPA_LAT_BUCKETS];
+	u64			lat_max_us;
+} hpa_reserve = {
+	.lock = __MUTEX_INITIALIZER(hpa_reserve.lock),
+	.chunks = LIST_HEAD_INIT(hpa_reserve.chunks),
+};
+
+static void hpa_reserve_kick(unsigned long delay_ms)
+{
+	queue_delayed_work(system_unbound_wq, &hpa_reserve.work,
+			   msecs_to_jiffies(delay_ms));
+}
+
+static int hpa_reserve_take(int order, struct page **pages, int nents,
+			    phys_addr_t exception_areas[][2],
+			    int nr_exception)
+{
+	struct page *page, *tmp;
+	int taken = 0;
+
+	mutex_lock(&hpa_reserve.lock);
+
+	if (hpa_reserve.order != order)
+		goto out;
+
+	list_for_each_entry_safe(page, tmp, &hpa_reserve.chunks, lru) {
+		if (taken == nents)
+			break;
+
+		if (get_exception_of_page(page_to_phys(page), exception_areas,
+					  nr_exception) >= 0)
 			continue;
 
-		pages[nents - remained] = pfn_to_page(pfn);
-		remained--;
+		list_del(&page->lru);
+		pages[taken++] = page;
+		hpa_reserve.count--;
 	}
 
-	/* save latest scanned pfn */
-	cached_scan_pfn = pfn;
+	hpa_reserve.served_chunks += taken;
+out:
+	mutex_unlock(&hpa_reserve.lock);
+
+	if (taken)
+		hpa_reserve_kick(0);
+
+	return taken;
+}
+
+static void hpa_reserve_account(ktime_t start, int taken, bool killed,
+				int ret)
+{
+	u64 us = ktime_to_us(ktime_sub(ktime_get(), start));
+	int idx = min_t(int, fls64(us), HPA_LAT_BUCKETS - 1);
+
+	mutex_lock(&hpa_reserve.lock);
+	hpa_reserve.alloc_count++;
+	if (ret)
+		hpa_reserve.alloc_fail++;
+	if (killed)
+		hpa_reserve.kill_count++;
+	else if (taken && !ret)
+		hpa_reserve.kill_avoided++;
+	hpa_reserve.lat_hist[idx]++;
+	if (us > hpa_reserve.lat_max_us)
+		hpa_reserve.lat_max_us = us;
+	mutex_unlock(&hpa_reserve.lock);
+}
+
+/* Drops chunks above @target. Called with hpa_reserve.lock held. */
+static void hpa_reserve_trim(void)
+{
+	struct page *page;
+
+	while (hpa_reserve.count > hpa_reserve.target) {
+		page = list_first_entry(&hpa_reserve.chunks, struct page, lru);
+		list_del(&page->lru);
+		__free_pages(page, hpa_reserve.order);
+		hpa_reserve.count--;
+	}
+}
+
+static void hpa_reserve_refill(struct work_struct *work)
+{
+	struct page *pages[HPA_REFILL_BATCH];
+	unsigned int order, want;
+	int i, got;
+
+	for (;;) {
+		mutex_lock(&hpa_reserve.lock);
+		order = hpa_reserve.order;
+		want = hpa_reserve.target > hpa_reserve.count ?
+			hpa_reserve.target - hpa_reserve.count : 0;
+		mutex_unlock(&hpa_reserve.lock);
+
+		if (!want)
+			return;
+
+		want = min_t(unsigned int, want, HPA_REFILL_BATCH);
+		got = want - __alloc_pages_highorder(order, pages, want, want,
+						     NULL, 0);
+
+		mutex_lock(&hpa_reserve.lock);
+		for (i = 0; i < got; i++) {
+			/* reserve was reconfigured while compacting */
+			if (order != hpa_reserve.order) {
+				__free_pages(pages[i], order);
+				continue;
+			}
+			list_add_tail(&pages[i]->lru, &hpa_reserve.chunks);
+			hpa_reserve.count++;
+		}
+		hpa_reserve.refill_chunks += got;
+		hpa_reserve_trim();
+		if (!got)
+			hpa_reserve.refill_fail++;
+		mutex_unlock(&hpa_reserve.lock);
+
+		/* memory is too fragmented now, compact later */
+		if (!got) {
+			hpa_reserve_kick(HPA_REFILL_RETRY_MS);
+			return;
+		}
+
+		cond_resched();
+	}
+}
+
+/**
+ * alloc_pages_highorder_except() - allocate large order pages
+ * @order:           required page order
+ * @pages:           array to store allocated @order order pages
+ * @nents:           number of @order order pages
+ * @exception_areas: memory areas that should not include pages in @pages
+ * @nr_exception:    number of memory areas in @exception_areas
+ *
+ * Returns 0 on allocation success. -error otherwise.
+ *
+ * Allocates @nents pages of @order << PAGE_SHIFT number of consecutive pages
+ * and store the page descriptors of the allocated pages to @pages. Every page
+ * in @pages should also be aligned by @order << PAGE_SHIFT.
+ *
+ * If @nr_exception is larger than 0, alloc_page_highorder_except() does not
+ * allocate pages in the areas described in @exception_areas. @exception_areas
+ * is an array of array with two elements: The first element is the start
+ * address of an area and the last element is the end address. The end address
+ * is the last byte address in the area, that is "[start address] + [size] - 1".
+ *
+ * Chunks kept by the reserve mode are used first if @order is the reserved
+ * order.
+ */
+int alloc_pages_highorder_except(int order, struct page **pages, int nents,
+				 phys_addr_t exception_areas[][2],
+				 int nr_exception)
+{
+	ktime_t start = ktime_get();
+	bool killed = false;
+	int remained;
+	int ret = 0;
+	int retry_count = 0;
+	int taken;
+
+	taken = hpa_reserve_take(order, pages, nents,
+				 exception_areas, nr_exception);
+	remained = nents - taken;
+
+retry:
+	if (remained)
+		remained = __alloc_pages_highorder(order, pages, nents,
+						   remained, exception_areas,
+						   nr_exception);
 
 	if (remained) {
 		int i;
@@ -370,7 +691,7 @@ retry:
 		count_vm_event(DROP_SLAB);
 		ret = hpa_killer();
 		if (ret == 0) {
-			total_scanned = 0;
+			killed = true;
 			pr_info("HPA: drop_slab and killer retry %d count\n",
 				retry_count++);
 			goto retry;
@@ -385,6 +706,8 @@ retry:
 		ret = -ENOMEM;
 	}
 
+	hpa_reserve_account(start, taken, killed, ret);
+
 	return ret;
 }
 
@@ -398,6 +721,229 @@ int free_pages_highorder(int order, struct page **pages, int nents)
 	return 0;
 }
 
+static int hpa_reserve_show(struct seq_file *m, void *unused)
+{
+	mutex_lock(&hpa_reserve.lock);
+	seq_printf(m, "%u %u\n", hpa_reserve.order, hpa_reserve.target);
+	mutex_unlock(&hpa_reserve.lock);
+
+	return 0;
+}
+
+static int hpa_reserve_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, hpa_reserve_show, inode->i_private);
+}
+
+/*
+ * Reserve mode is configured as below:
+ *
+ * #echo "<order> <count>" > /sys/kernel/debug/hpa/reserve
+ *
+ * Count 0 disables reserve mode and releases the reserved chunks.
+ */
+static ssize_t hpa_reserve_write(struct file *file, const char __user *ubuf,
+				 size_t count, loff_t *ppos)
+{
+	char buf[32];
+	unsigned int order, target;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	if (sscanf(buf, "%u %u", &order, &target) != 2)
+		return -EINVAL;
+
+	if (order >= MAX_ORDER)
+		return -EINVAL;
+
+	mutex_lock(&hpa_reserve.lock);
+	if (order != hpa_reserve.order) {
+		hpa_reserve.target = 0;
+		hpa_reserve_trim();
+		hpa_reserve.order = order;
+	}
+	hpa_reserve.target = target;
+	hpa_reserve_trim();
+	mutex_unlock(&hpa_reserve.lock);
+
+	hpa_reserve_kick(0);
+
+	return count;
+}
+
+static const struct file_operations hpa_reserve_fops = {
+	.open		= hpa_reserve_open,
+	.read		= seq_read,
+	.write		= hpa_reserve_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+/* returns upper bound in us of the bucket where @permille is reached */
+static u64 hpa_lat_percentile(unsigned long total, unsigned int permille)
+{
+	unsigned long sum = 0;
+	int i;
+
+	if (!total)
+		return 0;
+
+	for (i = 0; i < HPA_LAT_BUCKETS; i++) {
+		sum += hpa_reserve.lat_hist[i];
+		if (sum * 1000 >= total * permille)
+			break;
+	}
+
+	return 1ULL << min(i, HPA_LAT_BUCKETS - 1);
+}
+
+static int hpa_stat_show(struct seq_file *m, void *unused)
+{
+	unsigned long total;
+
+	mutex_lock(&hpa_reserve.lock);
+
+	total = hpa_reserve.alloc_count;
+
+	seq_printf(m, "reserve order=%u target=%u count=%u\n",
+		   hpa_reserve.order, hpa_reserve.target, hpa_reserve.count);
+	seq_printf(m, "alloc=%lu fail=%lu served_chunks=%lu\n",
+		   total, hpa_reserve.alloc_fail, hpa_reserve.served_chunks);
+	seq_printf(m, "refill_chunks=%lu refill_fail=%lu\n",
+		   hpa_reserve.refill_chunks, hpa_reserve.refill_fail);
+	/* kill_avoided: served from reserve without invoking hpa_killer() */
+	seq_printf(m, "kill=%lu kill_avoided=%lu\n",
+		   hpa_reserve.kill_count, hpa_reserve.kill_avoided);
+	seq_printf(m, "latency_us p50<%llu p90<%llu p99<%llu max=%llu\n",
+		   hpa_lat_percentile(total, 500),
+		   hpa_lat_percentile(total, 900),
+		   hpa_lat_percentile(total, 990),
+		   hpa_reserve.lat_max_us);
+
+	mutex_unlock(&hpa_reserve.lock);
+
+	return 0;
+}
+
+static int hpa_stat_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, hpa_stat_show, inode->i_private);
+}
+
+static const struct file_operations hpa_stat_fops = {
+	.open		= hpa_stat_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+/*
+ * Allocates the given number of chunks, frees them and reports wall time:
+ *
+ * #echo "<order> <count>" > /sys/kernel/debug/hpa/benchmark
+ * #cat /sys/kernel/debug/hpa/benchmark
+ */
+static struct {
+	unsigned int	order;
+	unsigned int	count;
+	unsigned int	workers;
+	int		ret;
+	u64		alloc_us;
+	u64		free_us;
+} hpa_bench;
+
+static DEFINE_MUTEX(hpa_bench_lock);
+
+static int hpa_bench_show(struct seq_file *m, void *unused)
+{
+	mutex_lock(&hpa_bench_lock);
+	seq_printf(m, "order=%u count=%u workers=%u ret=%d alloc_us=%llu free_us=%llu\n",
+		   hpa_bench.order, hpa_bench.count, hpa_bench.workers,
+		   hpa_bench.ret, hpa_bench.alloc_us, hpa_bench.free_us);
+	mutex_unlock(&hpa_bench_lock);
+
+	return 0;
+}
+
+static int hpa_bench_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, hpa_bench_show, inode->i_private);
+}
+
+static ssize_t hpa_bench_write(struct file *file, const char __user *ubuf,
+			       size_t count, loff_t *ppos)
+{
+	char buf[32];
+	unsigned int order, nents;
+	struct page **pages;
+	ktime_t start;
+
+	if (count >= sizeof(buf))
+		return -EINVAL;
+
+	if (copy_from_user(buf, ubuf, count))
+		return -EFAULT;
+	buf[count] = '\0';
+
+	if (sscanf(buf, "%u %u", &order, &nents) != 2)
+		return -EINVAL;
+
+	if (order >= MAX_ORDER || !nents)
+		return -EINVAL;
+
+	pages = vmalloc(sizeof(*pages) * nents);
+	if (!pages)
+		return -ENOMEM;
+
+	mutex_lock(&hpa_bench_lock);
+
+	hpa_bench.order = order;
+	hpa_bench.count = nents;
+	hpa_bench.workers = hpa_workers;
+
+	start = ktime_get();
+	hpa_bench.ret = alloc_pages_highorder(order, pages, nents);
+	hpa_bench.alloc_us = ktime_to_us(ktime_sub(ktime_get(), start));
+
+	start = ktime_get();
+	if (!hpa_bench.ret)
+		free_pages_highorder(order, pages, nents);
+	hpa_bench.free_us = ktime_to_us(ktime_sub(ktime_get(), start));
+
+	mutex_unlock(&hpa_bench_lock);
+
+	vfree(pages);
+
+	return count;
+}
+
+static const struct file_operations hpa_bench_fops = {
+	.open		= hpa_bench_open,
+	.read		= seq_read,
+	.write		= hpa_bench_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static void __init hpa_debugfs_init(void)
+{
+	struct dentry *root;
+
+	root = debugfs_create_dir("hpa", NULL);
+	if (!root)
+		return;
+
+	debugfs_create_file("reserve", 0644, root, NULL, &hpa_reserve_fops);
+	debugfs_create_file("stat", 0444, root, NULL, &hpa_stat_fops);
+	debugfs_create_file("benchmark", 0644, root, NULL, &hpa_bench_fops);
+	debugfs_create_u32("workers", 0644, root, &hpa_workers);
+}
+
 static int __init init_highorder_pages_allocator(void)
 {
 	struct zone *zone;
@@ -418,6 +964,9 @@ static int __init init_highorder_pages_allocator(void)
 
 	cached_scan_pfn = start_pfn;
 
+	INIT_DELAYED_WORK(&hpa_reserve.work, hpa_reserve_refill);
+	hpa_debugfs_init();
+
 	return 0;
 }
 late_initcall(init_highorder_pages_allocator);
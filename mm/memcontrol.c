@@ -65,6 +65,9 @@
 #include <linux/lockdep.h>
 #include <linux/file.h>
 #include <linux/tracehook.h>
+#include <linux/moduleparam.h>
+#include <linux/topology.h>
+#include <linux/workqueue.h>
 #include "internal.h"
 #include <net/sock.h>
 #include <net/ip.h>
@@ -3307,6 +3310,15 @@ static u64 mem_cgroup_vmpressure_read(struct cgroup_subsys_state *css,
 
 	return vmpressure;
 }
+
+static int mem_cgroup_pressure_stats_show(struct seq_file *m, void *v)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_css(seq_css(m));
+
+	vmpressure_stats_show(m, memcg_to_vmpressure(memcg));
+	return 0;
+}
+
 static u64 mem_cgroup_swappiness_read(struct cgroup_subsys_state *css,
 				      struct cftype *cft)
 {
@@ -3331,6 +3343,213 @@ static int mem_cgroup_swappiness_write(struct cgroup_subsys_state *css,
 	return 0;
 }
 
+/*
+ * Android keeps a memcg per app. The activity manager writes 1 to
+ * memory.app_cached when the app goes to the cached state and 0 when it
+ * comes back. While cached, memory.cached_soft_limit_in_bytes replaces the
+ * soft limit of the memcg, its anon pages are preferred by the reclaim
+ * (cached_swappiness) and, cached_reclaim_delay_ms after the transition,
+ * the excess over the soft limit is reclaimed to zram by a low priority
+ * worker on the little cluster, so that kswapd and the allocating tasks
+ * find free memory instead of cold apps.
+ */
+int memcg_cached_swappiness = 100;
+module_param_named(cached_swappiness, memcg_cached_swappiness, int, 0644);
+
+static unsigned int memcg_cached_reclaim_delay_ms = 5000;
+module_param_named(cached_reclaim_delay_ms, memcg_cached_reclaim_delay_ms,
+		   uint, 0644);
+
+/* pages reclaimed per memcg and pass, before moving to the next one */
+#define MEMCG_CACHED_RECLAIM_BATCH	(SWAP_CLUSTER_MAX * 32)
+
+static DEFINE_MUTEX(memcg_cached_lock);
+static LIST_HEAD(memcg_cached_list);
+static struct workqueue_struct *memcg_cached_wq;
+static void memcg_cached_reclaim_fn(struct work_struct *work);
+static DECLARE_DELAYED_WORK(memcg_cached_reclaim_work, memcg_cached_reclaim_fn);
+
+static unsigned long memcg_refault_anon(struct mem_cgroup *memcg)
+{
+	return memcg_sum_events(memcg, PSWPIN);
+}
+
+static unsigned long memcg_refault_file(struct mem_cgroup *memcg)
+{
+	return memcg_page_state(memcg, WORKINGSET_REFAULT);
+}
+
+/* The next memcg over its cached soft limit, with a reference */
+static struct mem_cgroup *memcg_cached_next(void)
+{
+	struct mem_cgroup *memcg;
+
+	mutex_lock(&memcg_cached_lock);
+	list_for_each_entry(memcg, &memcg_cached_list, cached_node) {
+		if (!soft_limit_excess(memcg))
+			continue;
+		if (!css_tryget_online(&memcg->css))
+			continue;
+		/* round robin between the apps over their limit */
+		list_move_tail(&memcg->cached_node, &memcg_cached_list);
+		mutex_unlock(&memcg_cached_lock);
+		return memcg;
+	}
+	mutex_unlock(&memcg_cached_lock);
+
+	return NULL;
+}
+
+static void memcg_cached_reclaim_fn(struct work_struct *work)
+{
+	struct mem_cgroup *memcg;
+	unsigned long excess, reclaimed;
+	bool progress = false;
+
+	while ((memcg = memcg_cached_next())) {
+		excess = min_t(unsigned long, soft_limit_excess(memcg),
+			       MEMCG_CACHED_RECLAIM_BATCH);
+		reclaimed = try_to_free_mem_cgroup_pages(memcg, excess,
+							 GFP_KERNEL, true);
+
+		mutex_lock(&memcg_cached_lock);
+		memcg->cached_reclaimed += reclaimed;
+		memcg->total_cached_reclaimed += reclaimed;
+		mutex_unlock(&memcg_cached_lock);
+		css_put(&memcg->css);
+
+		if (!reclaimed)
+			break;
+		progress = true;
+		cond_resched();
+	}
+
+	/*
+	 * An app is still over its limit but nothing could be reclaimed from
+	 * it. Retry later if the pass made progress, otherwise leave it to
+	 * the regular reclaim.
+	 */
+	if (memcg && progress)
+		queue_delayed_work(memcg_cached_wq, &memcg_cached_reclaim_work,
+				   HZ);
+}
+
+static void memcg_set_cached(struct mem_cgroup *memcg, bool cached)
+{
+	mutex_lock(&memcg_cached_lock);
+	if (memcg->app_cached == cached)
+		goto out;
+
+	if (cached) {
+		memcg->saved_soft_limit = memcg->soft_limit;
+		memcg->soft_limit = min(memcg->soft_limit,
+					memcg->cached_soft_limit);
+		memcg->cached_reclaimed = 0;
+		memcg->cached_refault_anon = memcg_refault_anon(memcg);
+		memcg->cached_refault_file = memcg_refault_file(memcg);
+		list_add_tail(&memcg->cached_node, &memcg_cached_list);
+	} else {
+		memcg->soft_limit = memcg->saved_soft_limit;
+		list_del_init(&memcg->cached_node);
+	}
+	WRITE_ONCE(memcg->app_cached, cached);
+
+	if (cached && memcg_cached_wq && memcg->soft_limit != PAGE_COUNTER_MAX)
+		mod_delayed_work(memcg_cached_wq, &memcg_cached_reclaim_work,
+				 msecs_to_jiffies(memcg_cached_reclaim_delay_ms));
+out:
+	mutex_unlock(&memcg_cached_lock);
+}
+
+static u64 mem_cgroup_app_cached_read(struct cgroup_subsys_state *css,
+				      struct cftype *cft)
+{
+	return mem_cgroup_from_css(css)->app_cached;
+}
+
+static int mem_cgroup_app_cached_write(struct cgroup_subsys_state *css,
+				       struct cftype *cft, u64 val)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_css(css);
+
+	if (val > 1 || mem_cgroup_is_root(memcg))
+		return -EINVAL;
+
+	memcg_set_cached(memcg, val);
+	return 0;
+}
+
+static u64 mem_cgroup_cached_soft_limit_read(struct cgroup_subsys_state *css,
+					     struct cftype *cft)
+{
+	return (u64)mem_cgroup_from_css(css)->cached_soft_limit * PAGE_SIZE;
+}
+
+static ssize_t mem_cgroup_cached_soft_limit_write(struct kernfs_open_file *of,
+						  char *buf, size_t nbytes,
+						  loff_t off)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_css(of_css(of));
+	unsigned long nr_pages;
+	int ret;
+
+	buf = strstrip(buf);
+	ret = page_counter_memparse(buf, "-1", &nr_pages);
+	if (ret)
+		return ret;
+
+	mutex_lock(&memcg_cached_lock);
+	memcg->cached_soft_limit = nr_pages;
+	if (memcg->app_cached)
+		memcg->soft_limit = min(memcg->saved_soft_limit, nr_pages);
+	mutex_unlock(&memcg_cached_lock);
+
+	return nbytes;
+}
+
+static int mem_cgroup_cached_stat_show(struct seq_file *m, void *v)
+{
+	struct mem_cgroup *memcg = mem_cgroup_from_css(seq_css(m));
+	unsigned long anon = 0, file = 0;
+
+	mutex_lock(&memcg_cached_lock);
+	if (memcg->app_cached) {
+		anon = memcg_refault_anon(memcg) - memcg->cached_refault_anon;
+		file = memcg_refault_file(memcg) - memcg->cached_refault_file;
+	}
+	seq_printf(m, "cached %d\n", memcg->app_cached);
+	seq_printf(m, "reclaimed %lu\n", memcg->cached_reclaimed);
+	seq_printf(m, "refault_anon %lu\n", anon);
+	seq_printf(m, "refault_file %lu\n", file);
+	seq_printf(m, "total_reclaimed %lu\n", memcg->total_cached_reclaimed);
+	mutex_unlock(&memcg_cached_lock);
+
+	return 0;
+}
+
+static int __init memcg_cached_init(void)
+{
+	struct workqueue_attrs *attrs;
+
+	memcg_cached_wq = alloc_workqueue("memcg_cached",
+			WQ_UNBOUND | WQ_FREEZABLE | WQ_SYSFS, 1);
+	if (!memcg_cached_wq)
+		return -ENOMEM;
+
+	attrs = alloc_workqueue_attrs(GFP_KERNEL);
+	if (!attrs)
+		return 0;
+
+	/* little cluster, below the apps */
+	attrs->nice = MAX_NICE;
+	cpumask_and(attrs->cpumask, topology_core_cpumask(0), cpu_possible_mask);
+	if (apply_workqueue_attrs(memcg_cached_wq, attrs))
+		pr_err("%s: failed to set the workqueue attributes\n", __func__);
+	free_workqueue_attrs(attrs);
+
+	return 0;
+}
+
 static void __mem_cgroup_threshold(struct mem_cgroup *memcg, bool swap)
 {
 	struct mem_cgroup_threshold_ary *t;
@@ -4063,6 +4282,27 @@ static struct cftype mem_cgroup_legacy_files[] = {
 		.name = "vmpressure",
 		.read_u64 = mem_cgroup_vmpressure_read,
 	},
+	{
+		.name = "pressure_stats",
+		.seq_show = mem_cgroup_pressure_stats_show,
+	},
+	{
+		.name = "app_cached",
+		.flags = CFTYPE_NOT_ON_ROOT,
+		.read_u64 = mem_cgroup_app_cached_read,
+		.write_u64 = mem_cgroup_app_cached_write,
+	},
+	{
+		.name = "cached_soft_limit_in_bytes",
+		.flags = CFTYPE_NOT_ON_ROOT,
+		.read_u64 = mem_cgroup_cached_soft_limit_read,
+		.write = mem_cgroup_cached_soft_limit_write,
+	},
+	{
+		.name = "cached_stat",
+		.flags = CFTYPE_NOT_ON_ROOT,
+		.seq_show = mem_cgroup_cached_stat_show,
+	},
 #ifdef CONFIG_NUMA
 	{
 		.name = "numa_stat",
@@ -4326,6 +4566,8 @@ mem_cgroup_css_alloc(struct cgroup_subsys_state *parent_css)
 
 	memcg->high = PAGE_COUNTER_MAX;
 	memcg->soft_limit = PAGE_COUNTER_MAX;
+	memcg->cached_soft_limit = PAGE_COUNTER_MAX;
+	INIT_LIST_HEAD(&memcg->cached_node);
 	if (parent) {
 		memcg->swappiness = mem_cgroup_swappiness(parent);
 		memcg->oom_kill_disable = parent->oom_kill_disable;
@@ -4400,6 +4642,7 @@ static void mem_cgroup_css_offline(struct cgroup_subsys_state *css)
 	spin_unlock(&memcg->event_list_lock);
 
 	memcg->low = 0;
+	memcg_set_cached(memcg, false);
 
 	memcg_offline_kmem(memcg);
 	wb_memcg_offline(memcg);
@@ -6025,6 +6268,8 @@ static int __init mem_cgroup_init(void)
 		soft_limit_tree.rb_tree_per_node[node] = rtpn;
 	}
 
+	memcg_cached_init();
+
 	return 0;
 }
 subsys_initcall(mem_cgroup_init);
@@ -2939,6 +2939,8 @@ int do_swap_page(struct vm_fault *vmf)
 		ret = VM_FAULT_MAJOR;
 		count_vm_event(PGMAJFAULT);
 		count_memcg_event_mm(vma->vm_mm, PGMAJFAULT);
+		/* Only the memcg one, the global PSWPIN is counted on the io */
+		count_memcg_event_mm(vma->vm_mm, PSWPIN);
 	} else if (PageHWPoison(page)) {
 		/*
 		 * hwpoisoned dirty swapcache pages are kept for killing
@@ -67,6 +67,7 @@
 #include <linux/ftrace.h>
 #include <linux/lockdep.h>
 #include <linux/nmi.h>
+#include <linux/vmpressure.h>
 
 #include <asm/sections.h>
 #include <asm/tlbflush.h>
@@ -3415,14 +3416,17 @@ __alloc_pages_direct_compact(gfp_t gfp_mask, unsigned int order,
 {
 	struct page *page;
 	unsigned int noreclaim_flag;
+	u64 start;
 
 	if (!order)
 		return NULL;
 
+	start = ktime_get_ns();
 	noreclaim_flag = memalloc_noreclaim_save();
 	*compact_result = try_to_compact_pages(gfp_mask, order, alloc_flags, ac,
 									prio);
 	memalloc_noreclaim_restore(noreclaim_flag);
+	vmpressure_stall(gfp_mask, ktime_get_ns() - start);
 
 	if (*compact_result <= COMPACT_INACTIVE)
 		return NULL;
@@ -3611,9 +3615,12 @@ __perform_reclaim(gfp_t gfp_mask, unsigned int order,
 	struct reclaim_state reclaim_state;
 	int progress;
 	unsigned int noreclaim_flag;
+	u64 start;
 
 	cond_resched();
 
+	start = ktime_get_ns();
+
 	/* We now go into synchronous reclaim */
 	cpuset_memory_pressure_bump();
 	noreclaim_flag = memalloc_noreclaim_save();
@@ -3627,6 +3634,7 @@ __perform_reclaim(gfp_t gfp_mask, unsigned int order,
 	current->reclaim_state = NULL;
 	fs_reclaim_release(gfp_mask);
 	memalloc_noreclaim_restore(noreclaim_flag);
+	vmpressure_stall(gfp_mask, ktime_get_ns() - start);
 
 	cond_resched();
 
@@ -46,6 +46,7 @@
  */
 
 #include <linux/mm.h>
+#include <linux/sched/coredump.h>
 #include <linux/sched/mm.h>
 #include <linux/sched/task.h>
 #include <linux/pagemap.h>
@@ -746,6 +747,7 @@ struct page_referenced_arg {
 	int referenced;
 	unsigned long vm_flags;
 	struct mem_cgroup *memcg;
+	bool foreground;
 };
 /*
  * arg: page_referenced_arg will be passed
@@ -794,6 +796,8 @@ static bool page_referenced_one(struct page *page, struct vm_area_struct *vma,
 		}
 
 		pra->mapcount--;
+		if (test_bit(MMF_FOREGROUND, &vma->vm_mm->flags))
+			pra->foreground = true;
 	}
 
 	if (referenced)
@@ -824,19 +828,21 @@ static bool invalid_page_referenced_vma(struct vm_area_struct *vma, void *arg)
 }
 
 /**
- * page_referenced - test if the page was referenced
+ * __page_referenced - test if the page was referenced
  * @page: the page to test
  * @is_locked: caller holds lock on the page
  * @memcg: target memory cgroup
  * @vm_flags: collect encountered vma->vm_flags who actually referenced the page
+ * @foreground: if not NULL, set if the page is mapped by a foreground app
  *
  * Quick test_and_clear_referenced for all mappings to a page,
  * returns the number of ptes which referenced the page.
  */
-int page_referenced(struct page *page,
-		    int is_locked,
-		    struct mem_cgroup *memcg,
-		    unsigned long *vm_flags)
+int __page_referenced(struct page *page,
+		      int is_locked,
+		      struct mem_cgroup *memcg,
+		      unsigned long *vm_flags,
+		      bool *foreground)
 {
 	int we_locked = 0;
 	struct page_referenced_arg pra = {
@@ -873,6 +879,8 @@ int page_referenced(struct page *page,
 
 	rmap_walk(page, &rwc);
 	*vm_flags = pra.vm_flags;
+	if (foreground)
+		*foreground = pra.foreground;
 
 	if (we_locked)
 		unlock_page(page);
@@ -40,6 +40,8 @@ static DEFINE_PER_CPU(struct swap_slots_cache, swp_slots);
 static bool	swap_slot_cache_active;
 bool	swap_slot_cache_enabled;
 static bool	swap_slot_cache_initialized;
+/* slots cached per cpu, see swap_slots_cache_sizing() */
+int	swap_slots_cache_size __read_mostly = SWAP_SLOTS_CACHE_SIZE;
 DEFINE_MUTEX(swap_slots_cache_mutex);
 /* Serialize swap slots cache enable/disable operations */
 DEFINE_MUTEX(swap_slots_cache_enable_mutex);
@@ -124,12 +126,12 @@ static int alloc_swap_slot_cache(unsigned int cpu)
 	 * as kvzalloc could trigger reclaim and get_swap_page,
 	 * which can lock swap_slots_cache_mutex.
 	 */
-	slots = kvzalloc(sizeof(swp_entry_t) * SWAP_SLOTS_CACHE_SIZE,
+	slots = kvzalloc(sizeof(swp_entry_t) * swap_slots_cache_size,
 			 GFP_KERNEL);
 	if (!slots)
 		return -ENOMEM;
 
-	slots_ret = kvzalloc(sizeof(swp_entry_t) * SWAP_SLOTS_CACHE_SIZE,
+	slots_ret = kvzalloc(sizeof(swp_entry_t) * swap_slots_cache_size,
 			     GFP_KERNEL);
 	if (!slots_ret) {
 		kvfree(slots);
@@ -233,6 +235,20 @@ static int free_slot_cache(unsigned int cpu)
 	return 0;
 }
 
+/*
+ * More cpus reclaiming in parallel contend harder on the swap_info lock
+ * when refilling, so each cpu takes a bigger batch at a time. The slots
+ * parked in the caches stay a small part of the device.
+ */
+static void swap_slots_cache_sizing(void)
+{
+	int size;
+
+	size = SWAP_SLOTS_CACHE_SIZE * DIV_ROUND_UP(num_possible_cpus(), 4);
+	swap_slots_cache_size = clamp(size, SWAP_SLOTS_CACHE_SIZE,
+				      SWAP_SLOTS_CACHE_SIZE_MAX);
+}
+
 int enable_swap_slots_cache(void)
 {
 	int ret = 0;
@@ -243,6 +259,8 @@ int enable_swap_slots_cache(void)
 		goto out_unlock;
 	}
 
+	swap_slots_cache_sizing();
+
 	ret = cpuhp_setup_state(CPUHP_AP_ONLINE_DYN, "swap_slots_cache",
 				alloc_swap_slot_cache, free_slot_cache);
 	if (WARN_ONCE(ret < 0, "Cache allocation failed (%s), operating "
@@ -263,9 +281,17 @@ static int refill_swap_slots_cache(struct swap_slots_cache *cache)
 		return 0;
 
 	cache->cur = 0;
-	if (swap_slot_cache_active)
-		cache->nr = get_swap_pages(SWAP_SLOTS_CACHE_SIZE, false,
-					   cache->slots);
+	/* get_swap_pages() hands out at most SWAP_BATCH slots at a time */
+	while (swap_slot_cache_active &&
+	       cache->nr < swap_slots_cache_size) {
+		int want = min(swap_slots_cache_size - cache->nr, SWAP_BATCH);
+		int got = get_swap_pages(want, false,
+					 cache->slots + cache->nr);
+
+		cache->nr += got;
+		if (got < want)
+			break;
+	}
 
 	return cache->nr;
 }
@@ -282,7 +308,7 @@ int free_swap_slot(swp_entry_t entry)
 			spin_unlock_irq(&cache->free_lock);
 			goto direct_free;
 		}
-		if (cache->n_ret >= SWAP_SLOTS_CACHE_SIZE) {
+		if (cache->n_ret >= swap_slots_cache_size) {
 			/*
 			 * Return slots to global pool.
 			 * The current swap_map value is SWAP_HAS_CACHE.
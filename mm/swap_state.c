@@ -512,7 +512,13 @@ static unsigned int __swapin_nr_pages(unsigned long prev_offset,
 	return pages;
 }
 
-static unsigned long swapin_nr_pages(unsigned long offset)
+static inline unsigned int swap_ra_policy(swp_entry_t entry)
+{
+	return READ_ONCE(swp_swap_info(entry)->ra_policy);
+}
+
+static unsigned long swapin_nr_pages(unsigned long offset,
+				     unsigned int policy)
 {
 	static unsigned long prev_offset;
 	unsigned int hits, pages, max_pages;
@@ -522,7 +528,21 @@ static unsigned long swapin_nr_pages(unsigned long offset)
 	if (max_pages <= 1)
 		return 1;
 
+	if (policy == SWAP_RA_NONE) {
+		count_vm_event(SWAP_RA_SKIP);
+		return 1;
+	}
+
 	hits = atomic_xchg(&swapin_readahead_hits, 0);
+	/* No readahead was used, wait for the next fault in a row */
+	if (policy == SWAP_RA_SEQUENTIAL && !hits &&
+	    offset != prev_offset + 1) {
+		prev_offset = offset;
+		atomic_set(&last_readahead_pages, 1);
+		count_vm_event(SWAP_RA_SKIP);
+		return 1;
+	}
+
 	pages = __swapin_nr_pages(prev_offset, offset, hits, max_pages,
 				  atomic_read(&last_readahead_pages));
 	if (!hits)
@@ -562,7 +582,7 @@ struct page *swapin_readahead(swp_entry_t entry, gfp_t gfp_mask,
 	struct blk_plug plug;
 	bool do_poll = true, page_allocated;
 
-	mask = swapin_nr_pages(offset) - 1;
+	mask = swapin_nr_pages(offset, swap_ra_policy(entry)) - 1;
 	if (!mask)
 		goto skip;
 
@@ -657,6 +677,7 @@ struct page *swap_readahead_detect(struct vm_fault *vmf,
 	unsigned long start, end;
 	pte_t *pte;
 	unsigned int max_win, hits, prev_win, win, left;
+	unsigned int policy;
 #ifndef CONFIG_64BIT
 	pte_t *tpte;
 #endif
@@ -676,13 +697,27 @@ struct page *swap_readahead_detect(struct vm_fault *vmf,
 	if (page)
 		return page;
 
+	policy = swap_ra_policy(entry);
+	if (policy == SWAP_RA_NONE) {
+		count_vm_event(SWAP_RA_SKIP);
+		swap_ra->win = 1;
+		return NULL;
+	}
+
 	fpfn = PFN_DOWN(faddr);
 	swap_ra_info = GET_SWAP_RA_VAL(vma);
 	pfn = PFN_DOWN(SWAP_RA_ADDR(swap_ra_info));
 	prev_win = SWAP_RA_WIN(swap_ra_info);
 	hits = SWAP_RA_HITS(swap_ra_info);
-	swap_ra->win = win = __swapin_nr_pages(pfn, fpfn, hits,
-					       max_win, prev_win);
+	/* No readahead was used, wait for the next fault in a row */
+	if (policy == SWAP_RA_SEQUENTIAL && !hits &&
+	    fpfn != pfn + 1 && pfn != fpfn + 1) {
+		count_vm_event(SWAP_RA_SKIP);
+		win = 1;
+	} else {
+		win = __swapin_nr_pages(pfn, fpfn, hits, max_win, prev_win);
+	}
+	swap_ra->win = win;
 	atomic_long_set(&vma->swap_readahead_info,
 			SWAP_RA_VAL(faddr, win, 0));
 
@@ -784,8 +819,33 @@ static struct kobj_attribute vma_ra_enabled_attr =
 	__ATTR(vma_ra_enabled, 0644, vma_ra_enabled_show,
 	       vma_ra_enabled_store);
 
+static ssize_t ra_policy_show(struct kobject *kobj,
+			      struct kobj_attribute *attr, char *buf)
+{
+	return swap_ra_policy_show(buf);
+}
+static ssize_t ra_policy_store(struct kobject *kobj,
+			       struct kobj_attribute *attr,
+			       const char *buf, size_t count)
+{
+	char policy[16];
+	unsigned int type;
+	int ret;
+
+	/* "<type> <readahead|sequential|none>" */
+	if (sscanf(buf, "%u %15s", &type, policy) != 2)
+		return -EINVAL;
+
+	ret = swap_ra_policy_store(type, policy);
+
+	return ret ? ret : count;
+}
+static struct kobj_attribute ra_policy_attr =
+	__ATTR(ra_policy, 0644, ra_policy_show, ra_policy_store);
+
 static struct attribute *swap_attrs[] = {
 	&vma_ra_enabled_attr.attr,
+	&ra_policy_attr.attr,
 	NULL,
 };
 
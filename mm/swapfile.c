@@ -3189,6 +3189,15 @@ SYSCALL_DEFINE2(swapon, const char __user *, specialfile, int, swap_flags)
 	if (bdi_cap_stable_pages_required(inode_to_bdi(inode)))
 		p->flags |= SWP_STABLE_WRITES;
 
+	/*
+	 * Devices serving pages synchronously, like zram, gain nothing from
+	 * reading neighbouring slots that are not going to be faulted.
+	 */
+	if (p->bdev && p->bdev->bd_disk->fops->rw_page)
+		p->ra_policy = SWAP_RA_SEQUENTIAL;
+	else
+		p->ra_policy = SWAP_RA_READAHEAD;
+
 	if (p->bdev && blk_queue_nonrot(bdev_get_queue(p->bdev))) {
 		int cpu;
 		unsigned long ci, nr_cluster;
@@ -3478,6 +3487,61 @@ struct swap_info_struct *page_swap_info(struct page *page)
 	return swap_info[swp_type(swap)];
 }
 
+struct swap_info_struct *swp_swap_info(swp_entry_t entry)
+{
+	return swap_info[swp_type(entry)];
+}
+
+static const char * const swap_ra_policy_names[NR_SWAP_RA_POLICY] = {
+	[SWAP_RA_READAHEAD]	= "readahead",
+	[SWAP_RA_SEQUENTIAL]	= "sequential",
+	[SWAP_RA_NONE]		= "none",
+};
+
+/* Lists "<type> <device> <policy>" for each active swap device */
+ssize_t swap_ra_policy_show(char *buf)
+{
+	struct swap_info_struct *si;
+	unsigned int type;
+	ssize_t len = 0;
+
+	spin_lock(&swap_lock);
+	for (type = 0; type < nr_swapfiles; type++) {
+		si = swap_info[type];
+		if (!(si->flags & SWP_WRITEOK))
+			continue;
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%u %pD %s\n",
+				 type, si->swap_file,
+				 swap_ra_policy_names[si->ra_policy]);
+	}
+	spin_unlock(&swap_lock);
+
+	return len;
+}
+
+int swap_ra_policy_store(unsigned int type, const char *policy)
+{
+	struct swap_info_struct *si;
+	int ret = -EINVAL;
+	int i;
+
+	i = match_string(swap_ra_policy_names, NR_SWAP_RA_POLICY, policy);
+	if (i < 0)
+		return i;
+
+	spin_lock(&swap_lock);
+	if (type < nr_swapfiles) {
+		si = swap_info[type];
+		if (si->flags & SWP_WRITEOK) {
+			WRITE_ONCE(si->ra_policy, i);
+			ret = 0;
+		}
+	}
+	spin_unlock(&swap_lock);
+
+	return ret;
+}
+
 /*
  * out-of-line __page_file_ methods to avoid include hell.
  */
@@ -15,6 +15,8 @@
 #include <linux/cgroup.h>
 #include <linux/fs.h>
 #include <linux/log2.h>
+#include <linux/memcontrol.h>
+#include <linux/moduleparam.h>
 #include <linux/sched.h>
 #include <linux/mm.h>
 #include <linux/vmstat.h>
@@ -22,6 +24,7 @@
 #include <linux/slab.h>
 #include <linux/swap.h>
 #include <linux/printk.h>
+#include <linux/seq_file.h>
 #include <linux/vmpressure.h>
 
 /*
@@ -70,6 +73,16 @@ static const unsigned int vmpressure_level_critical = 95;
  */
 static const unsigned int vmpressure_level_critical_prio = ilog2(100 / 10);
 
+/*
+ * The reclaim window above is counted in scanned pages, so a critical level
+ * may only be reported after a lot of reclaim work, while the foreground is
+ * already stuck. Stall events instead report the time the tasks of a memcg
+ * spent in direct reclaim and compaction, once it is over their threshold
+ * within a window of stall_window_ms, in any descendant of the memcg.
+ */
+static unsigned int vmpressure_stall_window_ms = 1000;
+module_param_named(stall_window_ms, vmpressure_stall_window_ms, uint, 0644);
+
 static struct vmpressure *work_to_vmpressure(struct work_struct *work)
 {
 	return container_of(work, struct vmpressure, work);
@@ -156,9 +169,26 @@ struct vmpressure_event {
 	struct eventfd_ctx *efd;
 	enum vmpressure_levels level;
 	enum vmpressure_modes mode;
+	/* Stall events only, the window of the latest signal */
+	u64 stall_thresh_ns;
+	u64 stall_signalled;
 	struct list_head node;
 };
 
+static void vmpressure_account_latency(struct vmpressure *vmpr,
+				       struct vmpressure_latency *lat,
+				       u64 queued)
+{
+	u64 delta = ktime_get_ns() - queued;
+
+	spin_lock(&vmpr->sr_lock);
+	lat->nr++;
+	lat->total_ns += delta;
+	if (delta > lat->max_ns)
+		lat->max_ns = delta;
+	spin_unlock(&vmpr->sr_lock);
+}
+
 static bool vmpressure_event(struct vmpressure *vmpr,
 			     const enum vmpressure_levels level,
 			     bool ancestor, bool signalled)
@@ -172,7 +202,7 @@ static bool vmpressure_event(struct vmpressure *vmpr,
 			continue;
 		if (signalled && ev->mode == VMPRESSURE_NO_PASSTHROUGH)
 			continue;
-		if (level < ev->level)
+		if (ev->stall_thresh_ns || level < ev->level)
 			continue;
 		eventfd_signal(ev->efd, 1);
 		ret = true;
@@ -185,11 +215,13 @@ static bool vmpressure_event(struct vmpressure *vmpr,
 static void vmpressure_work_fn(struct work_struct *work)
 {
 	struct vmpressure *vmpr = work_to_vmpressure(work);
+	struct vmpressure *origin = vmpr;
 	unsigned long scanned;
 	unsigned long reclaimed;
 	enum vmpressure_levels level;
 	bool ancestor = false;
 	bool signalled = false;
+	u64 queued;
 
 	spin_lock(&vmpr->sr_lock);
 	/*
@@ -207,6 +239,7 @@ static void vmpressure_work_fn(struct work_struct *work)
 	}
 
 	reclaimed = vmpr->tree_reclaimed;
+	queued = vmpr->queued;
 	vmpr->tree_scanned = 0;
 	vmpr->tree_reclaimed = 0;
 	spin_unlock(&vmpr->sr_lock);
@@ -218,6 +251,41 @@ static void vmpressure_work_fn(struct work_struct *work)
 			signalled = true;
 		ancestor = true;
 	} while ((vmpr = vmpressure_parent(vmpr)));
+
+	if (signalled)
+		vmpressure_account_latency(origin, &origin->level_latency,
+					   queued);
+}
+
+static void vmpressure_stall_work_fn(struct work_struct *work)
+{
+	struct vmpressure *vmpr = container_of(work, struct vmpressure,
+					       stall_work);
+	struct vmpressure_event *ev;
+	bool signalled = false;
+	u64 stall, start, queued;
+
+	spin_lock(&vmpr->sr_lock);
+	stall = vmpr->stall_ns;
+	start = vmpr->stall_start;
+	queued = vmpr->stall_queued;
+	spin_unlock(&vmpr->sr_lock);
+
+	mutex_lock(&vmpr->events_lock);
+	list_for_each_entry(ev, &vmpr->events, node) {
+		if (!ev->stall_thresh_ns || stall < ev->stall_thresh_ns)
+			continue;
+		/* Once per window */
+		if (ev->stall_signalled == start)
+			continue;
+		ev->stall_signalled = start;
+		eventfd_signal(ev->efd, 1);
+		signalled = true;
+	}
+	mutex_unlock(&vmpr->events_lock);
+
+	if (signalled)
+		vmpressure_account_latency(vmpr, &vmpr->stall_latency, queued);
 }
 
 /**
@@ -275,10 +343,14 @@ void vmpressure(gfp_t gfp, struct mem_cgroup *memcg, bool tree,
 		spin_lock(&vmpr->sr_lock);
 		scanned = vmpr->tree_scanned += scanned;
 		vmpr->tree_reclaimed += reclaimed;
-		spin_unlock(&vmpr->sr_lock);
 
-		if (scanned < vmpressure_win)
+		if (scanned < vmpressure_win) {
+			spin_unlock(&vmpr->sr_lock);
 			return;
+		}
+		if (!work_pending(&vmpr->work))
+			vmpr->queued = ktime_get_ns();
+		spin_unlock(&vmpr->sr_lock);
 		schedule_work(&vmpr->work);
 	} else {
 		enum vmpressure_levels level;
@@ -343,6 +415,76 @@ void vmpressure_prio(gfp_t gfp, struct mem_cgroup *memcg, int prio)
 	vmpressure(gfp, memcg, true, vmpressure_win, 0);
 }
 
+/**
+ * vmpressure_stall() - Account memory pressure through allocation stalls
+ * @gfp:	allocation's gfp mask
+ * @stall_ns:	time spent in direct reclaim or compaction
+ *
+ * This function should be called from the allocator slow path after the
+ * current task came back from direct reclaim or compaction. The stall is
+ * accounted to the memcg of the task and to its ancestors, and the stall
+ * events whose threshold is crossed in the current window are signalled
+ * from a high priority work, without waiting for the reclaim window.
+ *
+ * This function does not return any value.
+ */
+void vmpressure_stall(gfp_t gfp, u64 stall_ns)
+{
+	struct mem_cgroup *memcg;
+	struct vmpressure *vmpr;
+	u64 now, window;
+	bool queue;
+
+	if (mem_cgroup_disabled() || !stall_ns)
+		return;
+
+	/* Same as vmpressure(), only the pressure userland can help with */
+	if (!(gfp & (__GFP_HIGHMEM | __GFP_MOVABLE | __GFP_IO | __GFP_FS)))
+		return;
+
+	now = ktime_get_ns();
+	window = (u64)READ_ONCE(vmpressure_stall_window_ms) * NSEC_PER_MSEC;
+
+	rcu_read_lock();
+	memcg = mem_cgroup_from_task(current);
+	for (; memcg; memcg = parent_mem_cgroup(memcg)) {
+		vmpr = memcg_to_vmpressure(memcg);
+
+		spin_lock(&vmpr->sr_lock);
+		if (now - vmpr->stall_start >= window) {
+			vmpr->stall_start = now;
+			vmpr->stall_ns = 0;
+		}
+		vmpr->stall_ns += stall_ns;
+		queue = vmpr->stall_thresh_min &&
+			vmpr->stall_ns >= vmpr->stall_thresh_min;
+		if (queue && !work_pending(&vmpr->stall_work))
+			vmpr->stall_queued = now;
+		spin_unlock(&vmpr->sr_lock);
+
+		if (queue)
+			queue_work(system_highpri_wq, &vmpr->stall_work);
+	}
+	rcu_read_unlock();
+}
+
+/* Called with events_lock held */
+static void vmpressure_update_stall_thresh(struct vmpressure *vmpr)
+{
+	struct vmpressure_event *ev;
+	u64 thresh = 0;
+
+	list_for_each_entry(ev, &vmpr->events, node) {
+		if (ev->stall_thresh_ns &&
+		    (!thresh || ev->stall_thresh_ns < thresh))
+			thresh = ev->stall_thresh_ns;
+	}
+
+	spin_lock(&vmpr->sr_lock);
+	vmpr->stall_thresh_min = thresh;
+	spin_unlock(&vmpr->sr_lock);
+}
+
 static enum vmpressure_levels str_to_level(const char *arg)
 {
 	enum vmpressure_levels level;
@@ -378,6 +520,10 @@ static enum vmpressure_modes str_to_mode(const char *arg)
  * or "critical") and an optional mode (one of vmpressure_str_modes, i.e.
  * "hierarchy" or "local").
  *
+ * Alternatively "stall,<ms>" binds a stall event, signalled at most once per
+ * window when the tasks of @memcg and of its descendants stalled for <ms> in
+ * direct reclaim and compaction within the window.
+ *
  * To be used as memcg event method.
  */
 int vmpressure_register_event(struct mem_cgroup *memcg,
@@ -387,6 +533,7 @@ int vmpressure_register_event(struct mem_cgroup *memcg,
 	struct vmpressure_event *ev;
 	enum vmpressure_modes mode = VMPRESSURE_NO_PASSTHROUGH;
 	enum vmpressure_levels level = -1;
+	unsigned int stall_ms = 0;
 	char *spec, *spec_orig;
 	char *token;
 	int ret = 0;
@@ -400,6 +547,16 @@ int vmpressure_register_event(struct mem_cgroup *memcg,
 
 	/* Find required level */
 	token = strsep(&spec, ",");
+	if (!strcmp(token, "stall")) {
+		token = strsep(&spec, ",");
+		if (!token || kstrtouint(token, 10, &stall_ms) || !stall_ms) {
+			ret = -EINVAL;
+			goto out;
+		}
+		level = VMPRESSURE_CRITICAL;
+		goto alloc;
+	}
+
 	level = str_to_level(token);
 	if (level == -1) {
 		ret = -EINVAL;
@@ -416,6 +573,7 @@ int vmpressure_register_event(struct mem_cgroup *memcg,
 		}
 	}
 
+alloc:
 	ev = kzalloc(sizeof(*ev), GFP_KERNEL);
 	if (!ev) {
 		ret = -ENOMEM;
@@ -425,9 +583,12 @@ int vmpressure_register_event(struct mem_cgroup *memcg,
 	ev->efd = eventfd;
 	ev->level = level;
 	ev->mode = mode;
+	ev->stall_thresh_ns = (u64)stall_ms * NSEC_PER_MSEC;
 
 	mutex_lock(&vmpr->events_lock);
 	list_add(&ev->node, &vmpr->events);
+	if (ev->stall_thresh_ns)
+		vmpressure_update_stall_thresh(vmpr);
 	mutex_unlock(&vmpr->events_lock);
 out:
 	kfree(spec_orig);
@@ -456,6 +617,8 @@ void vmpressure_unregister_event(struct mem_cgroup *memcg,
 		if (ev->efd != eventfd)
 			continue;
 		list_del(&ev->node);
+		if (ev->stall_thresh_ns)
+			vmpressure_update_stall_thresh(vmpr);
 		kfree(ev);
 		break;
 	}
@@ -475,6 +638,45 @@ void vmpressure_init(struct vmpressure *vmpr)
 	mutex_init(&vmpr->events_lock);
 	INIT_LIST_HEAD(&vmpr->events);
 	INIT_WORK(&vmpr->work, vmpressure_work_fn);
+	INIT_WORK(&vmpr->stall_work, vmpressure_stall_work_fn);
+}
+
+static void vmpressure_latency_show(struct seq_file *m, const char *name,
+				    struct vmpressure_latency *lat)
+{
+	seq_printf(m, "%s_events %lu\n", name, lat->nr);
+	seq_printf(m, "%s_latency_avg_us %llu\n", name,
+		   lat->nr ? div64_u64(lat->total_ns, lat->nr) / NSEC_PER_USEC :
+		   0);
+	seq_printf(m, "%s_latency_max_us %llu\n", name,
+		   lat->max_ns / NSEC_PER_USEC);
+}
+
+/**
+ * vmpressure_stats_show() - Show the stall and notification statistics
+ * @m:		seq_file to print to
+ * @vmpr:	vmpressure structure of the memcg
+ */
+void vmpressure_stats_show(struct seq_file *m, struct vmpressure *vmpr)
+{
+	struct vmpressure_latency level, stall;
+	u64 stall_ns, start;
+
+	spin_lock(&vmpr->sr_lock);
+	stall_ns = vmpr->stall_ns;
+	start = vmpr->stall_start;
+	level = vmpr->level_latency;
+	stall = vmpr->stall_latency;
+	spin_unlock(&vmpr->sr_lock);
+
+	/* Nothing stalled in this window yet */
+	if (ktime_get_ns() - start >=
+	    (u64)READ_ONCE(vmpressure_stall_window_ms) * NSEC_PER_MSEC)
+		stall_ns = 0;
+
+	seq_printf(m, "stall_us %llu\n", stall_ns / NSEC_PER_USEC);
+	vmpressure_latency_show(m, "level", &level);
+	vmpressure_latency_show(m, "stall", &stall);
 }
 
 /**
@@ -491,4 +693,5 @@ void vmpressure_cleanup(struct vmpressure *vmpr)
 	 * goes away.
 	 */
 	flush_work(&vmpr->work);
+	flush_work(&vmpr->stall_work);
 }
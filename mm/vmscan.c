@@ -49,6 +49,8 @@
 #include <linux/prefetch.h>
 #include <linux/printk.h>
 #include <linux/dax.h>
+#include <linux/ems.h>
+#include <linux/ems_service.h>
 
 #include <asm/tlbflush.h>
 #include <asm/div64.h>
@@ -867,14 +869,65 @@ enum page_references {
 	PAGEREF_ACTIVATE,
 };
 
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+/*
+ * Unreferenced file pages mapped by the foreground app take another trip
+ * around the inactive list before they are reclaimed, so that the streaming
+ * I/O of the background does not evict the code of the app. The second
+ * chance is the one of the mapped pages, PG_referenced. At most
+ * lru_protect_pages are kept per round of the inactive file list, whose end
+ * is guessed from the unreferenced file pages scanned.
+ */
+static unsigned long lru_protect_pages = 16384;
+
+void lru_protect_update_task(struct task_struct *p)
+{
+	task_lock(p);
+	if (p->mm) {
+		if (ems_task_is_foreground(p))
+			set_bit(MMF_FOREGROUND, &p->mm->flags);
+		else
+			clear_bit(MMF_FOREGROUND, &p->mm->flags);
+	}
+	task_unlock(p);
+}
+
+/* Racy, the counters only bound the protection */
+static bool lru_protect_page(struct page *page, bool foreground)
+{
+	struct pglist_data *pgdat = page_pgdat(page);
+
+	if (++pgdat->lru_protect_scanned >
+	    node_page_state(pgdat, NR_INACTIVE_FILE)) {
+		pgdat->lru_protect_scanned = 0;
+		pgdat->lru_protected = 0;
+	}
+
+	if (!foreground ||
+	    pgdat->lru_protected >= READ_ONCE(lru_protect_pages))
+		return false;
+
+	pgdat->lru_protected++;
+	count_vm_event(PGPROTECT);
+
+	return true;
+}
+#else
+static inline bool lru_protect_page(struct page *page, bool foreground)
+{
+	return false;
+}
+#endif
+
 static enum page_references page_check_references(struct page *page,
 						  struct scan_control *sc)
 {
 	int referenced_ptes, referenced_page;
 	unsigned long vm_flags;
+	bool foreground = false;
 
-	referenced_ptes = page_referenced(page, 1, sc->target_mem_cgroup,
-					  &vm_flags);
+	referenced_ptes = __page_referenced(page, 1, sc->target_mem_cgroup,
+					    &vm_flags, &foreground);
 	referenced_page = TestClearPageReferenced(page);
 
 	/*
@@ -903,8 +956,14 @@ static enum page_references page_check_references(struct page *page,
 		 */
 		SetPageReferenced(page);
 
-		if (referenced_page || referenced_ptes > 1)
+		if (referenced_page || referenced_ptes > 1) {
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+			/* used again after its trip, a refault avoided */
+			if (foreground && referenced_page)
+				count_vm_event(PGPROTECT_RESCUED);
+#endif
 			return PAGEREF_ACTIVATE;
+		}
 
 		/*
 		 * Activate file-backed executable pages after first usage.
@@ -915,6 +974,12 @@ static enum page_references page_check_references(struct page *page,
 		return PAGEREF_KEEP;
 	}
 
+	if (!PageSwapBacked(page) && !referenced_page &&
+	    lru_protect_page(page, foreground)) {
+		SetPageReferenced(page);
+		return PAGEREF_KEEP;
+	}
+
 	/* Reclaim if clean, defer dirty pages to writeback */
 	if (referenced_page && !PageSwapBacked(page))
 		return PAGEREF_RECLAIM_CLEAN;
@@ -1424,6 +1489,63 @@ unsigned long reclaim_clean_pages_from_list(struct zone *zone,
 	return nr_reclaimed;
 }
 
+#ifdef CONFIG_PROCESS_RECLAIM
+/*
+ * reclaim_pages_from_list() - reclaim isolated pages of a process
+ * @page_list: pages isolated by isolate_lru_page() and accounted as
+ *             NR_ISOLATED_ANON/FILE
+ *
+ * Anon pages are swapped out and file pages are dropped or written back
+ * regardless of their references. Pages which could not be reclaimed are
+ * put back to LRU. Returns the number of reclaimed pages.
+ */
+unsigned long reclaim_pages_from_list(struct list_head *page_list)
+{
+	struct scan_control sc = {
+		.gfp_mask = GFP_KERNEL,
+		.priority = DEF_PRIORITY,
+		.may_writepage = 1,
+		.may_unmap = 1,
+		.may_swap = 1,
+	};
+	unsigned long nr_reclaimed = 0;
+	struct reclaim_stat stat;
+	struct page *page;
+
+	while (!list_empty(page_list)) {
+		struct pglist_data *pgdat;
+		unsigned long nr_isolated[2] = { 0, };
+		LIST_HEAD(node_list);
+		struct page *next;
+
+		/* shrink_page_list() works on pages of a node */
+		pgdat = page_pgdat(lru_to_page(page_list));
+		list_for_each_entry_safe(page, next, page_list, lru) {
+			if (page_pgdat(page) != pgdat)
+				continue;
+
+			ClearPageActive(page);
+			nr_isolated[page_is_file_cache(page)]++;
+			list_move(&page->lru, &node_list);
+		}
+
+		nr_reclaimed += shrink_page_list(&node_list, pgdat, &sc,
+				TTU_IGNORE_ACCESS, &stat, true);
+
+		mod_node_page_state(pgdat, NR_ISOLATED_ANON, -nr_isolated[0]);
+		mod_node_page_state(pgdat, NR_ISOLATED_FILE, -nr_isolated[1]);
+
+		while (!list_empty(&node_list)) {
+			page = lru_to_page(&node_list);
+			list_del(&page->lru);
+			putback_lru_page(page);
+		}
+	}
+
+	return nr_reclaimed;
+}
+#endif
+
 /*
  * Attempt to remove the specified page from its LRU.  Only take this page
  * if it is of the appropriate PageActive status.  Pages which are being
@@ -2221,6 +2343,35 @@ static bool memory_boosting_disabled = false;
 
 #define MEM_BOOST_MAX_TIME (5 * HZ) /* 5 sec */
 
+#if CONFIG_KSWAPD_WORKERS
+/*
+ * kswapd reclaim workers. While balancing a node kswapd hands a copy of its
+ * scan_control to the workers and each of them shrinks the node for a share
+ * of nr_to_reclaim. LRU isolation hands every thread its own batches, so the
+ * scanning is partitioned among the threads while the balancing decisions
+ * stay with kswapd.
+ */
+struct kswapd_worker {
+	struct task_struct *tsk;
+	pg_data_t *pgdat;
+	struct scan_control sc;
+	bool kicked;
+	bool queued;
+	bool affine;
+	unsigned long nr_scanned;
+	unsigned long nr_reclaimed;
+};
+
+struct kswapd_pool {
+	atomic_t pending;
+	struct completion done;
+	struct kswapd_worker worker[CONFIG_KSWAPD_WORKERS];
+};
+
+static struct kswapd_pool kswapd_pools[MAX_NUMNODES];
+static unsigned int kswapd_nr_workers = CONFIG_KSWAPD_WORKERS;
+#endif
+
 #ifdef CONFIG_SYSFS
 static ssize_t mem_boost_mode_show(struct kobject *kobj,
 				    struct kobj_attribute *attr, char *buf)
@@ -2272,15 +2423,101 @@ static ssize_t disable_mem_boost_store(struct kobject *kobj,
 	return count;
 }
 
+#if CONFIG_KSWAPD_WORKERS
+static ssize_t kswapd_workers_show(struct kobject *kobj,
+				   struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", kswapd_nr_workers);
+}
+
+static ssize_t kswapd_workers_store(struct kobject *kobj,
+				    struct kobj_attribute *attr,
+				    const char *buf, size_t count)
+{
+	unsigned int nr;
+	int err;
+
+	err = kstrtouint(buf, 10, &nr);
+	if (err || nr > CONFIG_KSWAPD_WORKERS)
+		return -EINVAL;
+
+	WRITE_ONCE(kswapd_nr_workers, nr);
+
+	return count;
+}
+
+static ssize_t kswapd_worker_stat_show(struct kobject *kobj,
+				       struct kobj_attribute *attr, char *buf)
+{
+	struct kswapd_worker *w;
+	int nid, i, ret = 0;
+
+	ret += sprintf(buf + ret, "%-16s %12s %12s\n",
+			"thread", "pgscan", "pgsteal");
+	for_each_node_state(nid, N_MEMORY) {
+		for (i = 0; i < CONFIG_KSWAPD_WORKERS; i++) {
+			w = &kswapd_pools[nid].worker[i];
+			if (!w->tsk)
+				continue;
+			ret += sprintf(buf + ret, "%-16s %12lu %12lu\n",
+					w->tsk->comm, w->nr_scanned,
+					w->nr_reclaimed);
+		}
+	}
+
+	return ret;
+}
+
+static struct kobj_attribute kswapd_worker_stat_attr =
+__ATTR(kswapd_worker_stat, 0444, kswapd_worker_stat_show, NULL);
+#endif
+
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+static ssize_t lru_protect_pages_show(struct kobject *kobj,
+				      struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%lu\n", lru_protect_pages);
+}
+
+static ssize_t lru_protect_pages_store(struct kobject *kobj,
+				       struct kobj_attribute *attr,
+				       const char *buf, size_t count)
+{
+	unsigned long nr;
+	int err;
+
+	err = kstrtoul(buf, 10, &nr);
+	if (err)
+		return -EINVAL;
+
+	WRITE_ONCE(lru_protect_pages, nr);
+
+	return count;
+}
+#endif
+
 #define MEM_BOOST_ATTR(_name) \
 	static struct kobj_attribute _name##_attr = \
 		__ATTR(_name, 0644, _name##_show, _name##_store)
 MEM_BOOST_ATTR(mem_boost_mode);
 MEM_BOOST_ATTR(disable_mem_boost);
+#if CONFIG_KSWAPD_WORKERS
+MEM_BOOST_ATTR(kswapd_workers);
+#endif
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+MEM_BOOST_ATTR(lru_protect_pages);
+#endif
 
 static struct attribute *mem_boost_attrs[] = {
 	&mem_boost_mode_attr.attr,
 	&disable_mem_boost_attr.attr,
+#if CONFIG_KSWAPD_WORKERS
+	&kswapd_workers_attr.attr,
+	&kswapd_worker_stat_attr.attr,
+#endif
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+	&lru_protect_pages_attr.attr,
+#endif
 	NULL,
 };
 
@@ -3437,11 +3674,226 @@ static bool prepare_kswapd_sleep(pg_data_t *pgdat, int order, int classzone_idx)
  * reclaim or if the lack of progress was due to pages under writeback.
  * This is used to determine if the scanning priority needs to be raised.
  */
+#if CONFIG_KSWAPD_WORKERS
+/*
+ * Worker threads are placed on the cpus with the lowest capacity known to
+ * EMS so that background reclaim stays off the big cores. Returns false
+ * while the capacities are not known yet.
+ */
+static bool kswapd_worker_affine(struct task_struct *tsk)
+{
+#ifdef CONFIG_SCHED_EMS
+	unsigned int cap, min_cap = UINT_MAX;
+	struct cpumask mask;
+	int cpu;
+
+	cpumask_clear(&mask);
+	for_each_online_cpu(cpu) {
+		cap = get_cpu_max_capacity(cpu);
+		if (!cap)
+			return false;
+
+		if (cap < min_cap) {
+			min_cap = cap;
+			cpumask_clear(&mask);
+		}
+		if (cap == min_cap)
+			cpumask_set_cpu(cpu, &mask);
+	}
+
+	if (cpumask_empty(&mask))
+		return false;
+
+	set_cpus_allowed_ptr(tsk, &mask);
+#endif
+	return true;
+}
+
+static int kswapd_worker(void *p)
+{
+	struct kswapd_worker *w = p;
+	struct kswapd_pool *pool = &kswapd_pools[w->pgdat->node_id];
+	struct reclaim_state reclaim_state = {
+		.reclaimed_slab = 0,
+	};
+
+	current->reclaim_state = &reclaim_state;
+	current->flags |= PF_MEMALLOC | PF_SWAPWRITE | PF_KSWAPD;
+
+	/*
+	 * Workers are not freezable. They only run while kswapd waits for
+	 * them and kswapd itself is frozen in between.
+	 */
+	for ( ; ; ) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (kthread_should_stop())
+			break;
+
+		if (!smp_load_acquire(&w->kicked)) {
+			schedule();
+			continue;
+		}
+		__set_current_state(TASK_RUNNING);
+
+		if (!w->affine)
+			w->affine = kswapd_worker_affine(current);
+
+		fs_reclaim_acquire(GFP_KERNEL);
+		shrink_node(w->pgdat, &w->sc);
+		fs_reclaim_release(GFP_KERNEL);
+
+		w->nr_scanned += w->sc.nr_scanned;
+		w->nr_reclaimed += w->sc.nr_reclaimed;
+		count_vm_events(PGSCAN_KSWAPD_WORKER, w->sc.nr_scanned);
+		count_vm_events(PGSTEAL_KSWAPD_WORKER, w->sc.nr_reclaimed);
+
+		WRITE_ONCE(w->kicked, false);
+		if (atomic_dec_and_test(&pool->pending))
+			complete(&pool->done);
+	}
+	__set_current_state(TASK_RUNNING);
+
+	current->flags &= ~(PF_MEMALLOC | PF_SWAPWRITE | PF_KSWAPD);
+	current->reclaim_state = NULL;
+
+	return 0;
+}
+
+/*
+ * Hands a share of sc->nr_to_reclaim to each worker and leaves the share of
+ * kswapd in sc. Returns the number of workers kicked.
+ */
+static int kswapd_kick_workers(pg_data_t *pgdat, struct scan_control *sc)
+{
+	struct kswapd_pool *pool = &kswapd_pools[pgdat->node_id];
+	unsigned int nr = READ_ONCE(kswapd_nr_workers);
+	struct kswapd_worker *w;
+	unsigned long share;
+	int i, kicked = 0;
+
+	share = max(sc->nr_to_reclaim / (nr + 1), SWAP_CLUSTER_MAX);
+	if (!nr || share >= sc->nr_to_reclaim)
+		return 0;
+
+	reinit_completion(&pool->done);
+	atomic_set(&pool->pending, 1);
+
+	for (i = 0; i < nr; i++) {
+		w = &pool->worker[i];
+		if (!w->tsk)
+			continue;
+
+		w->sc = *sc;
+		w->sc.nr_to_reclaim = share;
+		w->sc.nr_scanned = 0;
+		w->sc.nr_reclaimed = 0;
+
+		w->queued = true;
+		atomic_inc(&pool->pending);
+		smp_store_release(&w->kicked, true);
+		wake_up_process(w->tsk);
+		kicked++;
+	}
+
+	if (atomic_dec_and_test(&pool->pending))
+		complete(&pool->done);
+
+	if (kicked)
+		sc->nr_to_reclaim = share;
+
+	return kicked;
+}
+
+/* Waits for the kicked workers and accounts their progress to @sc */
+static void kswapd_wait_workers(pg_data_t *pgdat, struct scan_control *sc,
+				int kicked)
+{
+	struct kswapd_pool *pool = &kswapd_pools[pgdat->node_id];
+	struct kswapd_worker *w;
+	int i;
+
+	if (!kicked)
+		return;
+
+	wait_for_completion(&pool->done);
+
+	for (i = 0; i < CONFIG_KSWAPD_WORKERS; i++) {
+		w = &pool->worker[i];
+		if (!w->queued)
+			continue;
+
+		sc->nr_scanned += w->sc.nr_scanned;
+		sc->nr_reclaimed += w->sc.nr_reclaimed;
+		w->queued = false;
+	}
+}
+
+static void kswapd_run_workers(pg_data_t *pgdat)
+{
+	struct kswapd_pool *pool = &kswapd_pools[pgdat->node_id];
+	struct kswapd_worker *w;
+	int i;
+
+	init_completion(&pool->done);
+
+	for (i = 0; i < CONFIG_KSWAPD_WORKERS; i++) {
+		w = &pool->worker[i];
+		if (w->tsk)
+			continue;
+
+		w->pgdat = pgdat;
+		w->affine = false;
+		w->tsk = kthread_run(kswapd_worker, w, "kswapd%d:%d",
+				     pgdat->node_id, i);
+		if (IS_ERR(w->tsk)) {
+			pr_err("Failed to start kswapd worker %d on node %d\n",
+			       i, pgdat->node_id);
+			w->tsk = NULL;
+		}
+	}
+}
+
+static void kswapd_stop_workers(pg_data_t *pgdat)
+{
+	struct kswapd_pool *pool = &kswapd_pools[pgdat->node_id];
+	int i;
+
+	for (i = 0; i < CONFIG_KSWAPD_WORKERS; i++) {
+		if (!pool->worker[i].tsk)
+			continue;
+
+		kthread_stop(pool->worker[i].tsk);
+		pool->worker[i].tsk = NULL;
+	}
+}
+
+static void kswapd_unaffine_workers(pg_data_t *pgdat)
+{
+	struct kswapd_pool *pool = &kswapd_pools[pgdat->node_id];
+	int i;
+
+	for (i = 0; i < CONFIG_KSWAPD_WORKERS; i++)
+		pool->worker[i].affine = false;
+}
+#else
+static inline int kswapd_kick_workers(pg_data_t *pgdat,
+				      struct scan_control *sc)
+{
+	return 0;
+}
+static inline void kswapd_wait_workers(pg_data_t *pgdat,
+				       struct scan_control *sc, int kicked) { }
+static inline void kswapd_run_workers(pg_data_t *pgdat) { }
+static inline void kswapd_stop_workers(pg_data_t *pgdat) { }
+static inline void kswapd_unaffine_workers(pg_data_t *pgdat) { }
+#endif
+
 static bool kswapd_shrink_node(pg_data_t *pgdat,
 			       struct scan_control *sc)
 {
 	struct zone *zone;
-	int z;
+	unsigned long nr_to_reclaim;
+	int z, kicked;
 
 	/* Reclaim a number of pages proportional to the number of zones */
 	sc->nr_to_reclaim = 0;
@@ -3457,7 +3909,11 @@ static bool kswapd_shrink_node(pg_data_t *pgdat,
 	 * Historically care was taken to put equal pressure on all zones but
 	 * now pressure is applied based on node LRU order.
 	 */
+	nr_to_reclaim = sc->nr_to_reclaim;
+	kicked = kswapd_kick_workers(pgdat, sc);
 	shrink_node(pgdat, sc);
+	kswapd_wait_workers(pgdat, sc, kicked);
+	sc->nr_to_reclaim = nr_to_reclaim;
 
 	/*
 	 * Fragmentation may mean that the system cannot be rebalanced for
@@ -3908,6 +4364,9 @@ static int kswapd_cpu_online(unsigned int cpu)
 		if (cpumask_any_and(cpu_online_mask, mask) < nr_cpu_ids)
 			/* One of our CPUs online: restore mask */
 			set_cpus_allowed_ptr(pgdat->kswapd, mask);
+
+		/* workers pick their little cpus again on the next run */
+		kswapd_unaffine_workers(pgdat);
 	}
 	return 0;
 }
@@ -3931,7 +4390,11 @@ int kswapd_run(int nid)
 		pr_err("Failed to start kswapd on node %d\n", nid);
 		ret = PTR_ERR(pgdat->kswapd);
 		pgdat->kswapd = NULL;
+		return ret;
 	}
+
+	kswapd_run_workers(pgdat);
+
 	return ret;
 }
 
@@ -3947,6 +4410,8 @@ void kswapd_stop(int nid)
 		kthread_stop(kswapd);
 		NODE_DATA(nid)->kswapd = NULL;
 	}
+
+	kswapd_stop_workers(NODE_DATA(nid));
 }
 
 static int __init kswapd_init(void)
@@ -1114,6 +1114,9 @@ const char * const vmstat_text[] = {
 
 	"pgfault",
 	"pgmajfault",
+	"pgreadaround",
+	"pgreadaround_hit",
+	"pgreadaround_waste",
 	"pglazyfreed",
 
 	"pgrefill",
@@ -1122,6 +1125,14 @@ const char * const vmstat_text[] = {
 	"pgscan_kswapd",
 	"pgscan_direct",
 	"pgscan_direct_throttle",
+#ifdef CONFIG_LRU_PROTECT_FOREGROUND
+	"pgprotect",
+	"pgprotect_rescued",
+#endif
+#if CONFIG_KSWAPD_WORKERS
+	"pgsteal_kswapd_worker",
+	"pgscan_kswapd_worker",
+#endif
 
 #ifdef CONFIG_NUMA
 	"zone_reclaim_failed",
@@ -1214,6 +1225,7 @@ const char * const vmstat_text[] = {
 #ifdef CONFIG_SWAP
 	"swap_ra",
 	"swap_ra_hit",
+	"swap_ra_skip",
 #endif
 #endif /* CONFIG_VM_EVENTS_COUNTERS */
 };
@@ -296,6 +296,7 @@ struct mapping_area {
 	struct vm_struct *vm; /* vm area for mapping object that span pages */
 #else
 	char *vm_buf; /* copy buffer for objects that span pages */
+	bool vm_direct; /* spanning object is accessed in linear map */
 #endif
 	char *vm_addr; /* address of kmap_atomic()'ed pages */
 	enum zs_mapmode vm_mm; /* mapping mode */
@@ -1220,6 +1221,43 @@ static inline void __zs_cpu_down(struct mapping_area *area)
 	area->vm_buf = NULL;
 }
 
+/*
+ * Without highmem, every page is permanently mapped in the linear map, so
+ * kmap_atomic() is only page_address(). If the two pages of a spanning
+ * object are also physically adjacent, the object is contiguous in the
+ * linear map and is accessed in place without any copy.
+ */
+#ifdef CONFIG_HIGHMEM
+static inline bool zs_pages_adjacent(struct page *pages[2])
+{
+	return false;
+}
+
+static inline void *zs_page_map(struct page *page)
+{
+	return kmap_atomic(page);
+}
+
+static inline void zs_page_unmap(void *addr)
+{
+	kunmap_atomic(addr);
+}
+#else
+static inline bool zs_pages_adjacent(struct page *pages[2])
+{
+	return page_to_pfn(pages[1]) == page_to_pfn(pages[0]) + 1;
+}
+
+static inline void *zs_page_map(struct page *page)
+{
+	return page_address(page);
+}
+
+static inline void zs_page_unmap(void *addr)
+{
+}
+#endif
+
 static void *__zs_map_object(struct mapping_area *area,
 			struct page *pages[2], int off, int size)
 {
@@ -1230,6 +1268,10 @@ static void *__zs_map_object(struct mapping_area *area,
 	/* disable page faults to match kmap_atomic() return conditions */
 	pagefault_disable();
 
+	area->vm_direct = zs_pages_adjacent(pages);
+	if (area->vm_direct)
+		return (char *)zs_page_map(pages[0]) + off;
+
 	/* no read fastpath */
 	if (area->vm_mm == ZS_MM_WO)
 		goto out;
@@ -1238,12 +1280,12 @@ static void *__zs_map_object(struct mapping_area *area,
 	sizes[1] = size - sizes[0];
 
 	/* copy object to per-cpu buffer */
-	addr = kmap_atomic(pages[0]);
+	addr = zs_page_map(pages[0]);
 	memcpy(buf, addr + off, sizes[0]);
-	kunmap_atomic(addr);
-	addr = kmap_atomic(pages[1]);
+	zs_page_unmap(addr);
+	addr = zs_page_map(pages[1]);
 	memcpy(buf + sizes[0], addr, sizes[1]);
-	kunmap_atomic(addr);
+	zs_page_unmap(addr);
 out:
 	return area->vm_buf;
 }
@@ -1256,7 +1298,7 @@ static void __zs_unmap_object(struct mapping_area *area,
 	char *buf;
 
 	/* no write fastpath */
-	if (area->vm_mm == ZS_MM_RO)
+	if (area->vm_mm == ZS_MM_RO || area->vm_direct)
 		goto out;
 
 	buf = area->vm_buf;
@@ -1268,12 +1310,12 @@ static void __zs_unmap_object(struct mapping_area *area,
 	sizes[1] = size - sizes[0];
 
 	/* copy per-cpu buffer to object */
-	addr = kmap_atomic(pages[0]);
+	addr = zs_page_map(pages[0]);
 	memcpy(addr + off, buf, sizes[0]);
-	kunmap_atomic(addr);
-	addr = kmap_atomic(pages[1]);
+	zs_page_unmap(addr);
+	addr = zs_page_map(pages[1]);
 	memcpy(addr, buf + sizes[0], sizes[1]);
-	kunmap_atomic(addr);
+	zs_page_unmap(addr);
 
 out:
 	/* enable page faults to match kunmap_atomic() return conditions */
@@ -0,0 +1,136 @@
+/*
+ * zsmalloc map/unmap microbenchmark
+ *
+ * Copyright (C) 2018 Samsung Electronics Co., Ltd.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ *
+ * Objects of each size are allocated from a private pool and mapped and
+ * unmapped repeatedly in read only and write only mode. Throughput per size
+ * is reported in MB/s at module load, e.g.
+ *
+ * #insmod zsmalloc_bench.ko step=128 nr_objs=256 loops=64
+ */
+
+#define pr_fmt(fmt) "zsmalloc_bench: " fmt
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/zsmalloc.h>
+
+static unsigned int step = 128;
+module_param(step, uint, 0444);
+MODULE_PARM_DESC(step, "object size step in bytes");
+
+static unsigned int nr_objs = 256;
+module_param(nr_objs, uint, 0444);
+MODULE_PARM_DESC(nr_objs, "objects allocated per size");
+
+static unsigned int loops = 64;
+module_param(loops, uint, 0444);
+MODULE_PARM_DESC(loops, "map/unmap passes over the objects");
+
+/* Returns MB/s of mapping and touching every object in @mm mode */
+static u64 zs_bench_map(struct zs_pool *pool, unsigned long *handles,
+			size_t size, enum zs_mapmode mm)
+{
+	unsigned int i, j;
+	ktime_t start;
+	u64 ns, bytes;
+	char *addr;
+
+	start = ktime_get();
+	for (j = 0; j < loops; j++) {
+		for (i = 0; i < nr_objs; i++) {
+			addr = zs_map_object(pool, handles[i], mm);
+			if (mm == ZS_MM_WO)
+				memset(addr, j, size);
+			else
+				READ_ONCE(addr[size - 1]);
+			zs_unmap_object(pool, handles[i]);
+		}
+		cond_resched();
+	}
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	bytes = (u64)size * nr_objs * loops;
+
+	return ns ? div64_u64(bytes * NSEC_PER_SEC, ns) >> 20 : 0;
+}
+
+static int zs_bench_size(struct zs_pool *pool, unsigned long *handles,
+			 size_t size)
+{
+	unsigned int i, nr;
+	u64 ro, wo;
+
+	for (nr = 0; nr < nr_objs; nr++) {
+		handles[nr] = zs_malloc(pool, size, GFP_KERNEL);
+		if (!handles[nr])
+			break;
+	}
+
+	if (nr < nr_objs) {
+		pr_err("failed to allocate %zu bytes object\n", size);
+		for (i = 0; i < nr; i++)
+			zs_free(pool, handles[i]);
+		return -ENOMEM;
+	}
+
+	wo = zs_bench_map(pool, handles, size, ZS_MM_WO);
+	ro = zs_bench_map(pool, handles, size, ZS_MM_RO);
+
+	pr_info("size %5zu: RO %6llu MB/s WO %6llu MB/s\n", size, ro, wo);
+
+	for (i = 0; i < nr_objs; i++)
+		zs_free(pool, handles[i]);
+
+	return 0;
+}
+
+static int __init zs_bench_init(void)
+{
+	struct zs_pool *pool;
+	unsigned long *handles;
+	size_t size;
+	int ret = 0;
+
+	if (!step || !nr_objs || !loops)
+		return -EINVAL;
+
+	handles = kcalloc(nr_objs, sizeof(*handles), GFP_KERNEL);
+	if (!handles)
+		return -ENOMEM;
+
+	pool = zs_create_pool("zs_bench");
+	if (!pool) {
+		kfree(handles);
+		return -ENOMEM;
+	}
+
+	for (size = step; size <= PAGE_SIZE; size += step) {
+		ret = zs_bench_size(pool, handles, size);
+		if (ret)
+			break;
+	}
+
+	zs_destroy_pool(pool);
+	kfree(handles);
+
+	return ret;
+}
+
+static void __exit zs_bench_exit(void)
+{
+}
+
+module_init(zs_bench_init);
+module_exit(zs_bench_exit);
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("zsmalloc map/unmap microbenchmark");
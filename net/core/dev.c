@@ -145,6 +145,8 @@
 #include <linux/crash_dump.h>
 #include <linux/sctp.h>
 #include <net/udp_tunnel.h>
+#include <linux/arch_topology.h>
+#include <linux/ems.h>
 
 #include "net-sysfs.h"
 
@@ -3658,6 +3660,122 @@ set_rps_cpu(struct net_device *dev, struct sk_buff *skb,
  * CPU from the RPS map of the receiving queue for a given skb.
  * rcu_read_lock must be held on entry.
  */
+#ifdef CONFIG_RPS_HEAVY_FLOW
+/*
+ * The rate of the flows is measured per window in a small table indexed by
+ * the flow hash. A flow above rps_heavy_flow_kbps is heavy until it falls
+ * below half of it, and is then steered to the cores of the highest
+ * capacity instead of the RPS map, which keeps the light flows on the
+ * little cores. Slots are shared by colliding flows, like the RFS tables,
+ * and are updated without locking: a lost update only delays a decision.
+ */
+#define RPS_FLOW_RATE_BITS	8
+#define RPS_FLOW_RATE_WINDOW	(HZ / 10)
+
+struct rps_flow_rate {
+	u32		hash;
+	u32		bytes;
+	unsigned long	window;
+	bool		heavy;
+};
+
+static struct rps_flow_rate rps_flow_rates[1 << RPS_FLOW_RATE_BITS];
+
+unsigned int rps_heavy_flow_kbps __read_mostly = 20000;
+
+static u16 rps_heavy_cpus[NR_CPUS] __read_mostly;
+static unsigned int rps_heavy_nr_cpus __read_mostly;
+
+static unsigned int rps_cpu_capacity(int cpu)
+{
+#ifdef CONFIG_SCHED_EMS
+	unsigned int cap = get_cpu_max_capacity(cpu);
+
+	/* 0 until the energy table is built */
+	if (cap)
+		return cap;
+#endif
+	return topology_get_cpu_scale(NULL, cpu);
+}
+
+/* Finds the cpus of the highest capacity, the targets of heavy flows */
+void rps_heavy_flow_update_cpus(void)
+{
+	unsigned int cap, max_cap = 0, min_cap = UINT_MAX, nr = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		cap = rps_cpu_capacity(cpu);
+		max_cap = max(max_cap, cap);
+		min_cap = min(min_cap, cap);
+	}
+
+	/* nothing to steer to on a symmetric system */
+	if (max_cap != min_cap) {
+		for_each_possible_cpu(cpu)
+			if (rps_cpu_capacity(cpu) == max_cap)
+				rps_heavy_cpus[nr++] = cpu;
+	}
+
+	WRITE_ONCE(rps_heavy_nr_cpus, nr);
+}
+
+static int __init rps_heavy_flow_init(void)
+{
+	rps_heavy_flow_update_cpus();
+
+	return 0;
+}
+late_initcall_sync(rps_heavy_flow_init);
+
+/* The big cpu of a heavy flow, nr_cpu_ids for the others */
+static u32 rps_heavy_flow_cpu(struct sk_buff *skb, u32 hash)
+{
+	struct rps_flow_rate *fr;
+	unsigned int nr = READ_ONCE(rps_heavy_nr_cpus);
+	unsigned int limit = READ_ONCE(rps_heavy_flow_kbps);
+	unsigned long now = jiffies, elapsed;
+	u32 tcpu;
+
+	if (!limit || !nr)
+		return nr_cpu_ids;
+
+	fr = &rps_flow_rates[hash & ((1 << RPS_FLOW_RATE_BITS) - 1)];
+	if (fr->hash != hash) {
+		fr->hash = hash;
+		fr->bytes = 0;
+		fr->window = now;
+		fr->heavy = false;
+	}
+
+	fr->bytes += skb->len;
+	elapsed = now - fr->window;
+	if (elapsed >= RPS_FLOW_RATE_WINDOW) {
+		u64 kbps = div_u64((u64)fr->bytes * 8 * HZ, elapsed * 1000);
+
+		fr->heavy = kbps >= limit || (fr->heavy && kbps >= limit / 2);
+		fr->bytes = 0;
+		fr->window = now;
+	}
+
+	if (!fr->heavy)
+		return nr_cpu_ids;
+
+	tcpu = rps_heavy_cpus[reciprocal_scale(hash, nr)];
+	if (!cpu_online(tcpu))
+		return nr_cpu_ids;
+
+	__this_cpu_inc(softnet_data.rps_heavy);
+
+	return tcpu;
+}
+#else
+static inline u32 rps_heavy_flow_cpu(struct sk_buff *skb, u32 hash)
+{
+	return nr_cpu_ids;
+}
+#endif /* CONFIG_RPS_HEAVY_FLOW */
+
 static int get_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 		       struct rps_dev_flow **rflowp)
 {
@@ -3742,6 +3860,12 @@ static int get_rps_cpu(struct net_device *dev, struct sk_buff *skb,
 try_rps:
 
 	if (map) {
+		tcpu = rps_heavy_flow_cpu(skb, hash);
+		if (tcpu < nr_cpu_ids) {
+			cpu = tcpu;
+			goto done;
+		}
+
 		tcpu = map->cpus[reciprocal_scale(hash, map->len)];
 		if (cpu_online(tcpu)) {
 			cpu = tcpu;
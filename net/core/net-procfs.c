@@ -148,6 +148,7 @@ static int softnet_seq_show(struct seq_file *seq, void *v)
 {
 	struct softnet_data *sd = v;
 	unsigned int flow_limit_count = 0;
+	unsigned int rps_heavy = 0;
 
 #ifdef CONFIG_NET_FLOW_LIMIT
 	struct sd_flow_limit *fl;
@@ -158,13 +159,16 @@ static int softnet_seq_show(struct seq_file *seq, void *v)
 		flow_limit_count = fl->count;
 	rcu_read_unlock();
 #endif
+#ifdef CONFIG_RPS_HEAVY_FLOW
+	rps_heavy = sd->rps_heavy;
+#endif
 
 	seq_printf(seq,
-		   "%08x %08x %08x %08x %08x %08x %08x %08x %08x %08x %08x\n",
+		   "%08x %08x %08x %08x %08x %08x %08x %08x %08x %08x %08x %08x\n",
 		   sd->processed, sd->dropped, sd->time_squeeze, 0,
 		   0, 0, 0, 0, /* was fastroute */
 		   0,	/* was cpu_collision */
-		   sd->received_rps, flow_limit_count);
+		   sd->received_rps, flow_limit_count, rps_heavy);
 	return 0;
 }
 
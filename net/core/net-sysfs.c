@@ -113,6 +113,24 @@ NETDEVICE_SHOW_RO(addr_len, fmt_dec);
 NETDEVICE_SHOW_RO(ifindex, fmt_dec);
 NETDEVICE_SHOW_RO(type, fmt_dec);
 NETDEVICE_SHOW_RO(link_mode, fmt_dec);
+#ifdef CONFIG_NET_LINK_HINT
+NETDEVICE_SHOW_RO(link_capacity_kbps, fmt_dec);
+NETDEVICE_SHOW_RO(link_queue_bytes, fmt_dec);
+
+static ssize_t format_link_hint_stats(const struct net_device *dev, char *buf)
+{
+	return sprintf(buf, "paced %ld\ntsq_limited %ld\n",
+		       atomic_long_read(&dev->link_hint_paced),
+		       atomic_long_read(&dev->link_hint_tsq_limited));
+}
+
+static ssize_t link_hint_stats_show(struct device *dev,
+				    struct device_attribute *attr, char *buf)
+{
+	return netdev_show(dev, attr, buf, format_link_hint_stats);
+}
+static DEVICE_ATTR_RO(link_hint_stats);
+#endif
 
 static ssize_t iflink_show(struct device *dev, struct device_attribute *attr,
 			   char *buf)
@@ -523,6 +541,11 @@ static struct attribute *net_class_attrs[] __ro_after_init = {
 	&dev_attr_addr_assign_type.attr,
 	&dev_attr_addr_len.attr,
 	&dev_attr_link_mode.attr,
+#ifdef CONFIG_NET_LINK_HINT
+	&dev_attr_link_capacity_kbps.attr,
+	&dev_attr_link_queue_bytes.attr,
+	&dev_attr_link_hint_stats.attr,
+#endif
 	&dev_attr_address.attr,
 	&dev_attr_broadcast.attr,
 	&dev_attr_speed.attr,
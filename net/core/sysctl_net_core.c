@@ -102,6 +102,22 @@ static int rps_sock_flow_sysctl(struct ctl_table *table, int write,
 }
 #endif /* CONFIG_RPS */
 
+#ifdef CONFIG_RPS_HEAVY_FLOW
+static int rps_heavy_flow_sysctl(struct ctl_table *table, int write,
+				 void __user *buffer, size_t *lenp,
+				 loff_t *ppos)
+{
+	int ret;
+
+	ret = proc_douintvec(table, write, buffer, lenp, ppos);
+	/* the capacities of EMS may not have been known at boot */
+	if (!ret && write)
+		rps_heavy_flow_update_cpus();
+
+	return ret;
+}
+#endif /* CONFIG_RPS_HEAVY_FLOW */
+
 #ifdef CONFIG_NET_FLOW_LIMIT
 static DEFINE_MUTEX(flow_limit_update_mutex);
 
@@ -458,6 +474,15 @@ static struct ctl_table net_core_table[] = {
 		.proc_handler	= rps_sock_flow_sysctl
 	},
 #endif
+#ifdef CONFIG_RPS_HEAVY_FLOW
+	{
+		.procname	= "rps_heavy_flow_kbps",
+		.data		= &rps_heavy_flow_kbps,
+		.maxlen		= sizeof(unsigned int),
+		.mode		= 0644,
+		.proc_handler	= rps_heavy_flow_sysctl
+	},
+#endif
 #ifdef CONFIG_NET_FLOW_LIMIT
 	{
 		.procname	= "flow_limit_cpu_bitmap",
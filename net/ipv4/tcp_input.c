@@ -804,6 +804,9 @@ int sysctl_tcp_pacing_ca_ratio __read_mostly = 120;
 static void tcp_update_pacing_rate(struct sock *sk)
 {
 	const struct tcp_sock *tp = tcp_sk(sk);
+#ifdef CONFIG_NET_LINK_HINT
+	struct net_device *dev;
+#endif
 	u64 rate;
 
 	/* set sk_pacing_rate to 200 % of current rate (mss * cwnd / srtt) */
@@ -827,12 +830,27 @@ static void tcp_update_pacing_rate(struct sock *sk)
 	if (likely(tp->srtt_us))
 		do_div(rate, tp->srtt_us);
 
+	rate = min_t(u64, rate, sk->sk_max_pacing_rate);
+
+#ifdef CONFIG_NET_LINK_HINT
+	dev = tcp_link_hint_dev(sk);
+	if (dev) {
+		/* Headroom of the CA ratio, so that a higher capacity shows */
+		u64 link_rate = (u64)READ_ONCE(dev->link_capacity_kbps) *
+				(1000 / 8) * sysctl_tcp_pacing_ca_ratio / 100;
+
+		if (rate > link_rate) {
+			rate = link_rate;
+			atomic_long_inc(&dev->link_hint_paced);
+		}
+	}
+#endif
+
 	/* ACCESS_ONCE() is needed because sch_fq fetches sk_pacing_rate
 	 * without any lock. We want to make sure compiler wont store
 	 * intermediate values in this location.
 	 */
-	ACCESS_ONCE(sk->sk_pacing_rate) = min_t(u64, rate,
-						sk->sk_max_pacing_rate);
+	ACCESS_ONCE(sk->sk_pacing_rate) = rate;
 }
 
 /* Calculate rto without backoff.  This is the second half of Van Jacobson's
@@ -53,6 +53,11 @@ int sysctl_tcp_workaround_signed_windows __read_mostly = 0;
 /* Default TSQ limit of four TSO segments */
 int sysctl_tcp_limit_output_bytes __read_mostly = 262144;
 
+#ifdef CONFIG_NET_LINK_HINT
+/* Time of the link capacity queued below TCP by the links publishing it */
+int sysctl_tcp_link_hint_queue_us __read_mostly = 20000;
+#endif
+
 /* This limits the percentage of the congestion window which we
  * will allow a single TSO frame to consume.  Building TSO frames
  * which are too large can cause TCP streams to be bursty.
@@ -2210,9 +2215,50 @@ static bool tcp_pacing_check(const struct sock *sk)
  * of queued bytes to ensure line rate.
  * One example is wifi aggregation (802.11 AMPDU)
  */
+#ifdef CONFIG_NET_LINK_HINT
+/*
+ * When the driver of the link of @sk publishes its capacity, the bytes
+ * allowed below TCP are what the link drains in tcp_link_hint_queue_us,
+ * less what is already queued to the link.
+ */
+static u32 tcp_link_hint_limit(struct sock *sk, struct net_device **devp)
+{
+	struct net_device *dev = tcp_link_hint_dev(sk);
+	u32 queued;
+	u64 budget;
+
+	*devp = dev;
+	if (!dev)
+		return 0;
+
+	budget = div_u64((u64)READ_ONCE(dev->link_capacity_kbps) *
+			 sysctl_tcp_link_hint_queue_us, 8000);
+	queued = READ_ONCE(dev->link_queue_bytes);
+
+	return budget > queued ? min_t(u64, budget - queued, U32_MAX) : 0;
+}
+
+static void tcp_link_hint_throttled(struct net_device *dev)
+{
+	if (dev)
+		atomic_long_inc(&dev->link_hint_tsq_limited);
+}
+#else
+static u32 tcp_link_hint_limit(struct sock *sk, struct net_device **devp)
+{
+	*devp = NULL;
+	return 0;
+}
+
+static void tcp_link_hint_throttled(struct net_device *dev)
+{
+}
+#endif
+
 static bool tcp_small_queue_check(struct sock *sk, const struct sk_buff *skb,
 				  unsigned int factor)
 {
+	struct net_device *dev = NULL;
 	unsigned int limit;
 
 	limit = max(2 * skb->truesize, sk->sk_pacing_rate >> 10);
@@ -2220,11 +2266,14 @@ static bool tcp_small_queue_check(struct sock *sk, const struct sk_buff *skb,
 		limit = min_t(u32, limit, sysctl_tcp_limit_output_bytes);
 		limit <<= factor;
 	} else {
+		limit = max(limit, tcp_link_hint_limit(sk, &dev));
 		/* FIXME: P170118-06256/P171122-01021/P171122-00262
 		 * Disable TSQ to avoid TSQ full and UL TP degression in
-		 * bad network condition
+		 * bad network condition. Links publishing their capacity
+		 * are sized by it instead.
 		 */
-		limit = max_t(u32, limit, 4194304);
+		if (!dev)
+			limit = max_t(u32, limit, 4194304);
 	}
 
 	if (refcount_read(&sk->sk_wmem_alloc) > limit) {
@@ -2243,8 +2292,10 @@ static bool tcp_small_queue_check(struct sock *sk, const struct sk_buff *skb,
 		 * test again the condition.
 		 */
 		smp_mb__after_atomic();
-		if (refcount_read(&sk->sk_wmem_alloc) > limit)
+		if (refcount_read(&sk->sk_wmem_alloc) > limit) {
+			tcp_link_hint_throttled(dev);
 			return true;
+		}
 	}
 	return false;
 }
@@ -39,6 +39,9 @@
 #include <soc/samsung/exynos-pmu.h>
 #ifdef CONFIG_EXYNOS_ITMON
 #include <soc/samsung/exynos-itmon.h>
+#include <soc/samsung/exynos-probe.h>
+#include <soc/samsung/exynos-timesync.h>
+#include <soc/samsung/exynos-wq.h>
 #endif
 #include "../../../../drivers/iommu/exynos-iommu.h"
 
@@ -471,70 +474,83 @@ static void abox_set_sif_channels(struct abox_data *data,
 	data->sif_channels[abox_sif_idx(configmsg)] = val;
 }
 
-static bool __abox_ipc_queue_empty(struct abox_data *data)
+/*
+ * The IPC queue is a bounded ring with a sequence number per slot, so that
+ * requests can be put from any context without a lock. Producers claim a
+ * position with cmpxchg on ipc_queue_end and publish the slot by setting its
+ * sequence. The only consumer is the ordered ipc_workqueue.
+ */
+static void abox_ipc_queue_init(struct abox_data *data)
 {
-	return (data->ipc_queue_end == data->ipc_queue_start);
+	size_t length = ARRAY_SIZE(data->ipc_queue);
+	unsigned int i;
+
+	BUILD_BUG_ON_NOT_POWER_OF_2(ABOX_IPC_QUEUE_SIZE);
+
+	for (i = 0; i < length; i++)
+		data->ipc_queue[i].seq = i;
+	data->ipc_queue_start = 0;
+	atomic_set(&data->ipc_queue_end, 0);
 }
 
-static bool __abox_ipc_queue_full(struct abox_data *data)
+static bool __abox_ipc_queue_empty(struct abox_data *data)
 {
 	size_t length = ARRAY_SIZE(data->ipc_queue);
+	unsigned int pos = data->ipc_queue_start;
+	struct abox_ipc *ipc = &data->ipc_queue[pos % length];
 
-	return (((data->ipc_queue_end + 1) % length) == data->ipc_queue_start);
+	return (int)(smp_load_acquire(&ipc->seq) - (pos + 1)) < 0;
 }
 
 static int abox_ipc_queue_put(struct abox_data *data, struct device *dev,
 		int hw_irq, const void *supplement, size_t size)
 {
-	spinlock_t *lock = &data->ipc_queue_lock;
 	size_t length = ARRAY_SIZE(data->ipc_queue);
-	unsigned long flags;
-	int ret;
-
-	spin_lock_irqsave(lock, flags);
-	if (!__abox_ipc_queue_full(data)) {
-		struct abox_ipc *ipc;
-
-		ipc = &data->ipc_queue[data->ipc_queue_end];
-		ipc->dev = dev;
-		ipc->hw_irq = hw_irq;
-		ipc->put_time = sched_clock();
-		ipc->get_time = 0;
-		memcpy(&ipc->msg, supplement, size);
-		data->ipc_queue_end = (data->ipc_queue_end + 1) % length;
-
-		ret = 0;
-	} else {
-		ret = -EBUSY;
+	struct abox_ipc *ipc;
+	unsigned int pos, seq;
+	int diff;
+
+	pos = atomic_read(&data->ipc_queue_end);
+	for (;;) {
+		ipc = &data->ipc_queue[pos % length];
+		seq = smp_load_acquire(&ipc->seq);
+		diff = (int)(seq - pos);
+		if (diff == 0) {
+			if (atomic_cmpxchg(&data->ipc_queue_end, pos, pos + 1)
+					== pos)
+				break;
+		} else if (diff < 0) {
+			/* slot is not read yet */
+			return -EBUSY;
+		}
+		pos = atomic_read(&data->ipc_queue_end);
 	}
-	spin_unlock_irqrestore(lock, flags);
 
-	return ret;
+	ipc->dev = dev;
+	ipc->hw_irq = hw_irq;
+	ipc->put_time = sched_clock();
+	ipc->get_time = 0;
+	memcpy(&ipc->msg, supplement, size);
+	smp_store_release(&ipc->seq, pos + 1);
+
+	return 0;
 }
 
 static int abox_ipc_queue_get(struct abox_data *data, struct abox_ipc *ipc)
 {
-	spinlock_t *lock = &data->ipc_queue_lock;
 	size_t length = ARRAY_SIZE(data->ipc_queue);
-	unsigned long flags;
-	int ret;
-
-	spin_lock_irqsave(lock, flags);
-	if (!__abox_ipc_queue_empty(data)) {
-		struct abox_ipc *tmp;
+	unsigned int pos = data->ipc_queue_start;
+	struct abox_ipc *tmp = &data->ipc_queue[pos % length];
 
-		tmp = &data->ipc_queue[data->ipc_queue_start];
-		tmp->get_time = sched_clock();
-		*ipc = *tmp;
-		data->ipc_queue_start = (data->ipc_queue_start + 1) % length;
+	if (__abox_ipc_queue_empty(data))
+		return -ENODATA;
 
-		ret = 0;
-	} else {
-		ret = -ENODATA;
-	}
-	spin_unlock_irqrestore(lock, flags);
+	tmp->get_time = sched_clock();
+	*ipc = *tmp;
+	smp_store_release(&tmp->seq, pos + length);
+	data->ipc_queue_start = pos + 1;
 
-	return ret;
+	return 0;
 }
 
 static bool abox_can_calliope_ipc(struct device *dev,
@@ -618,8 +634,8 @@ static void abox_process_ipc(struct work_struct *work)
 	struct device *dev = &data->pdev->dev;
 	struct abox_ipc ipc;
 
-	dev_dbg(dev, "%s: %d %d\n", __func__, data->ipc_queue_start,
-			data->ipc_queue_end);
+	dev_dbg(dev, "%s: %u %u\n", __func__, data->ipc_queue_start,
+			atomic_read(&data->ipc_queue_end));
 
 	pm_runtime_get_sync(dev);
 
@@ -630,9 +646,11 @@ static void abox_process_ipc(struct work_struct *work)
 			ABOX_IPC_MSG *msg = &ipc.msg;
 
 			__abox_process_ipc(dev, data, hw_irq, msg);
+			abox_dbg_ipc_latency(sched_clock() - ipc.put_time);
 
-			/* giving time to ABOX for processing */
-			usleep_range(10, 100);
+			/* giving time to ABOX for processing the next one */
+			if (!__abox_ipc_queue_empty(data))
+				usleep_range(10, 100);
 		}
 	}
 
@@ -689,7 +707,10 @@ int abox_request_ipc(struct device *dev,
 	int ret;
 
 	if (atomic && sync) {
+		unsigned long long time = sched_clock();
+
 		ret = __abox_process_ipc(dev, data, hw_irq, supplement);
+		abox_dbg_ipc_latency(sched_clock() - time);
 	} else {
 		ret = abox_schedule_ipc(dev, data, hw_irq, supplement, size,
 				!!atomic, !!sync);
@@ -1673,7 +1694,7 @@ static int abox_tickle_put(struct snd_kcontrol *kcontrol,
 
 	if (!!val) {
 		pm_request_resume(dev);
-		schedule_delayed_work(&data->tickle_work, 1 * HZ);
+		queue_delayed_work(exynos_little_wq, &data->tickle_work, 1 * HZ);
 	}
 
 	return 0;
@@ -3396,6 +3417,44 @@ unsigned int abox_get_requiring_aud_freq_in_khz(void)
 }
 EXPORT_SYMBOL(abox_get_requiring_aud_freq_in_khz);
 
+/*
+ * Raising a frequency is applied in the context of the request when it can
+ * sleep, e.g. at stream start, instead of waiting for the shared workqueue.
+ * Lowering is left to the works, so that a burst of requests during stream
+ * transition is applied once.
+ */
+static bool abox_qos_can_sleep(void)
+{
+	return !in_interrupt() && !irqs_disabled() && preemptible();
+}
+
+static void abox_qos_requested(struct abox_data *data,
+		enum abox_qos_domain domain)
+{
+	struct abox_qos_stat *stat = &data->qos_stat[domain];
+
+	/* latency is measured from the first request not applied yet */
+	if (!READ_ONCE(stat->req_time))
+		WRITE_ONCE(stat->req_time, sched_clock());
+}
+
+static void abox_qos_applied(struct abox_data *data,
+		enum abox_qos_domain domain)
+{
+	struct abox_qos_stat *stat = &data->qos_stat[domain];
+	unsigned long long req_time = xchg(&stat->req_time, 0);
+	unsigned long long latency;
+
+	if (!req_time)
+		return;
+
+	latency = sched_clock() - req_time;
+	stat->count++;
+	stat->total_ns += latency;
+	if (stat->max_ns < latency)
+		stat->max_ns = latency;
+}
+
 bool abox_cpu_gear_idle(struct device *dev, struct abox_data *data,
 		unsigned int id)
 {
@@ -3485,6 +3544,8 @@ static void abox_notify_cpu_gear(struct abox_data *data, unsigned int freq, unsi
 			/* clock to ns */
 			atime *= 500;
 			do_div(atime, TIMER_RATE / 2000000);
+			exynos_timesync_sample(data->timesync,
+					exynos_timesync_boottime(), atime);
 		} else {
 			ktime = ULLONG_MAX;
 			atime = ULLONG_MAX;
@@ -3642,6 +3703,7 @@ static void abox_change_cpu_gear_work_func(struct work_struct *work)
 		abox_change_cpu_gear_legacy(&data->pdev->dev, data);
 	else
 		abox_change_cpu_gear(&data->pdev->dev, data);
+	abox_qos_applied(data, ABOX_QOS_CPU_GEAR);
 }
 
 int abox_request_cpu_gear(struct device *dev, struct abox_data *data,
@@ -3672,7 +3734,11 @@ int abox_request_cpu_gear(struct device *dev, struct abox_data *data,
 		return -ENOMEM;
 	}
 
+	abox_qos_requested(data, ABOX_QOS_CPU_GEAR);
 	queue_work(data->gear_workqueue, &data->change_cpu_gear_work);
+	/* lower gear is faster clock, wait for it if possible */
+	if (gear < data->cpu_gear && abox_qos_can_sleep())
+		abox_cpu_gear_barrier(data);
 	abox_check_cpu_gear(dev, data, old_id, old_gear, id, gear);
 
 	return 0;
@@ -3707,16 +3773,15 @@ void abox_clear_cpu_gear_requests(struct device *dev, struct abox_data *data)
 	}
 }
 
-static void abox_change_int_freq_work_func(struct work_struct *work)
+static void abox_apply_int_freq(struct abox_data *data)
 {
-	struct abox_data *data = container_of(work, struct abox_data,
-			change_int_freq_work);
 	struct device *dev = &data->pdev->dev;
 	struct abox_qos_request *request;
 	unsigned int freq = 0;
 
 	dev_dbg(dev, "%s\n", __func__);
 
+	mutex_lock(&data->qos_lock);
 	for (request = data->int_requests; request - data->int_requests <
 			ARRAY_SIZE(data->int_requests) && request->id;
 			request++) {
@@ -3729,11 +3794,21 @@ static void abox_change_int_freq_work_func(struct work_struct *work)
 
 	data->int_freq = freq;
 	pm_qos_update_request(&abox_pm_qos_int, data->int_freq);
+	abox_qos_applied(data, ABOX_QOS_INT);
+	mutex_unlock(&data->qos_lock);
 
 	dev_info(dev, "pm qos request int: %dHz\n", pm_qos_request(
 			abox_pm_qos_int.pm_qos_class));
 }
 
+static void abox_change_int_freq_work_func(struct work_struct *work)
+{
+	struct abox_data *data = container_of(work, struct abox_data,
+			change_int_freq_work);
+
+	abox_apply_int_freq(data);
+}
+
 int abox_request_int_freq(struct device *dev, struct abox_data *data,
 		unsigned int id, unsigned int int_freq)
 {
@@ -3759,21 +3834,24 @@ int abox_request_int_freq(struct device *dev, struct abox_data *data,
 		return -ENOMEM;
 	}
 
-	schedule_work(&data->change_int_freq_work);
+	abox_qos_requested(data, ABOX_QOS_INT);
+	if (int_freq > data->int_freq && abox_qos_can_sleep())
+		abox_apply_int_freq(data);
+	else
+		queue_work(exynos_little_wq, &data->change_int_freq_work);
 
 	return 0;
 }
 
-static void abox_change_mif_freq_work_func(struct work_struct *work)
+static void abox_apply_mif_freq(struct abox_data *data)
 {
-	struct abox_data *data = container_of(work, struct abox_data,
-			change_mif_freq_work);
 	struct device *dev = &data->pdev->dev;
 	struct abox_qos_request *request;
 	unsigned int freq = 0;
 
 	dev_dbg(dev, "%s\n", __func__);
 
+	mutex_lock(&data->qos_lock);
 	for (request = data->mif_requests; request - data->mif_requests <
 			ARRAY_SIZE(data->mif_requests) && request->id;
 			request++) {
@@ -3786,11 +3864,21 @@ static void abox_change_mif_freq_work_func(struct work_struct *work)
 
 	data->mif_freq = freq;
 	pm_qos_update_request(&abox_pm_qos_mif, data->mif_freq);
+	abox_qos_applied(data, ABOX_QOS_MIF);
+	mutex_unlock(&data->qos_lock);
 
 	dev_info(dev, "pm qos request mif: %dHz\n", pm_qos_request(
 			abox_pm_qos_mif.pm_qos_class));
 }
 
+static void abox_change_mif_freq_work_func(struct work_struct *work)
+{
+	struct abox_data *data = container_of(work, struct abox_data,
+			change_mif_freq_work);
+
+	abox_apply_mif_freq(data);
+}
+
 static int abox_request_mif_freq(struct device *dev, struct abox_data *data,
 		unsigned int id, unsigned int mif_freq)
 {
@@ -3816,15 +3904,17 @@ static int abox_request_mif_freq(struct device *dev, struct abox_data *data,
 		return -ENOMEM;
 	}
 
-	schedule_work(&data->change_mif_freq_work);
+	abox_qos_requested(data, ABOX_QOS_MIF);
+	if (mif_freq > data->mif_freq && abox_qos_can_sleep())
+		abox_apply_mif_freq(data);
+	else
+		queue_work(exynos_little_wq, &data->change_mif_freq_work);
 
 	return 0;
 }
 
-static void abox_change_lit_freq_work_func(struct work_struct *work)
+static void abox_apply_lit_freq(struct abox_data *data)
 {
-	struct abox_data *data = container_of(work, struct abox_data,
-			change_lit_freq_work);
 	struct device *dev = &data->pdev->dev;
 	size_t array_size = ARRAY_SIZE(data->lit_requests);
 	struct abox_qos_request *request;
@@ -3832,6 +3922,7 @@ static void abox_change_lit_freq_work_func(struct work_struct *work)
 
 	dev_dbg(dev, "%s\n", __func__);
 
+	mutex_lock(&data->qos_lock);
 	for (request = data->lit_requests;
 			request - data->lit_requests < array_size &&
 			request->id; request++) {
@@ -3844,11 +3935,21 @@ static void abox_change_lit_freq_work_func(struct work_struct *work)
 
 	data->lit_freq = freq;
 	pm_qos_update_request(&abox_pm_qos_lit, data->lit_freq);
+	abox_qos_applied(data, ABOX_QOS_LIT);
+	mutex_unlock(&data->qos_lock);
 
 	dev_info(dev, "pm qos request little: %dkHz\n",
 			pm_qos_request(abox_pm_qos_lit.pm_qos_class));
 }
 
+static void abox_change_lit_freq_work_func(struct work_struct *work)
+{
+	struct abox_data *data = container_of(work, struct abox_data,
+			change_lit_freq_work);
+
+	abox_apply_lit_freq(data);
+}
+
 int abox_request_lit_freq(struct device *dev, struct abox_data *data,
 		unsigned int id, unsigned int freq)
 {
@@ -3878,15 +3979,17 @@ int abox_request_lit_freq(struct device *dev, struct abox_data *data,
 		return -ENOMEM;
 	}
 
-	schedule_work(&data->change_lit_freq_work);
+	abox_qos_requested(data, ABOX_QOS_LIT);
+	if (freq > data->lit_freq && abox_qos_can_sleep())
+		abox_apply_lit_freq(data);
+	else
+		queue_work(exynos_little_wq, &data->change_lit_freq_work);
 
 	return 0;
 }
 
-static void abox_change_big_freq_work_func(struct work_struct *work)
+static void abox_apply_big_freq(struct abox_data *data)
 {
-	struct abox_data *data = container_of(work, struct abox_data,
-			change_big_freq_work);
 	struct device *dev = &data->pdev->dev;
 	size_t array_size = ARRAY_SIZE(data->big_requests);
 	struct abox_qos_request *request;
@@ -3894,6 +3997,7 @@ static void abox_change_big_freq_work_func(struct work_struct *work)
 
 	dev_dbg(dev, "%s\n", __func__);
 
+	mutex_lock(&data->qos_lock);
 	for (request = data->big_requests;
 			request - data->big_requests < array_size &&
 			request->id; request++) {
@@ -3906,11 +4010,21 @@ static void abox_change_big_freq_work_func(struct work_struct *work)
 
 	data->big_freq = freq;
 	pm_qos_update_request(&abox_pm_qos_big, data->big_freq);
+	abox_qos_applied(data, ABOX_QOS_BIG);
+	mutex_unlock(&data->qos_lock);
 
 	dev_info(dev, "pm qos request big: %dkHz\n",
 			pm_qos_request(abox_pm_qos_big.pm_qos_class));
 }
 
+static void abox_change_big_freq_work_func(struct work_struct *work)
+{
+	struct abox_data *data = container_of(work, struct abox_data,
+			change_big_freq_work);
+
+	abox_apply_big_freq(data);
+}
+
 int abox_request_big_freq(struct device *dev, struct abox_data *data,
 		unsigned int id, unsigned int freq)
 {
@@ -3940,7 +4054,11 @@ int abox_request_big_freq(struct device *dev, struct abox_data *data,
 		return -ENOMEM;
 	}
 
-	schedule_work(&data->change_big_freq_work);
+	abox_qos_requested(data, ABOX_QOS_BIG);
+	if (freq > data->big_freq && abox_qos_can_sleep())
+		abox_apply_big_freq(data);
+	else
+		queue_work(exynos_little_wq, &data->change_big_freq_work);
 
 	return 0;
 }
@@ -4005,7 +4123,7 @@ int abox_request_hmp_boost(struct device *dev, struct abox_data *data,
 		return -ENOMEM;
 	}
 
-	schedule_work(&data->change_hmp_boost_work);
+	queue_work(exynos_little_wq, &data->change_hmp_boost_work);
 
 	return 0;
 }
@@ -4827,6 +4945,8 @@ static void abox_system_ipc_handler(struct device *dev,
 	case ABOX_REPORT_LOG:
 		ret = abox_log_register_buffer(dev, system_msg->param1,
 				abox_addr_to_kernel_addr(data,
+				system_msg->param2),
+				abox_addr_to_phys_addr(data,
 				system_msg->param2));
 		if (ret < 0) {
 			dev_err(dev, "log buffer registration failed: %u, %u\n",
@@ -5085,6 +5205,8 @@ static int abox_cpu_pm_ipc(struct abox_data *data, bool resume)
 	/* clock to ns */
 	atime *= 500;
 	do_div(atime, TIMER_RATE / 2000000);
+	exynos_timesync_sample(data->timesync, exynos_timesync_boottime(),
+			atime);
 
 	msg.ipcid = IPC_SYSTEM;
 	system->msgtype = resume ? ABOX_RESUME : ABOX_SUSPEND;
@@ -5511,7 +5633,7 @@ int abox_request_l2c(struct device *dev, struct abox_data *data,
 		return -ENOMEM;
 	}
 
-	schedule_work(&data->l2c_work);
+	queue_work(exynos_little_wq, &data->l2c_work);
 
 	return 0;
 }
@@ -6036,7 +6158,34 @@ static ssize_t calliope_cmd_store(struct device *dev,
 	return count;
 }
 
+static ssize_t qos_latency_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	static const char * const names[ABOX_QOS_COUNT] = {
+		[ABOX_QOS_CPU_GEAR] = "cpu_gear",
+		[ABOX_QOS_INT] = "int",
+		[ABOX_QOS_MIF] = "mif",
+		[ABOX_QOS_LIT] = "lit",
+		[ABOX_QOS_BIG] = "big",
+	};
+	struct abox_data *data = dev_get_drvdata(dev);
+	struct abox_qos_stat *stat;
+	char *pbuf = buf;
+	int i;
+
+	for (i = 0; i < ABOX_QOS_COUNT; i++) {
+		stat = &data->qos_stat[i];
+		pbuf += sprintf(pbuf, "%-8s: count=%u avg=%lluns max=%lluns\n",
+				names[i], stat->count,
+				stat->count ? div_u64(stat->total_ns,
+				stat->count) : 0, stat->max_ns);
+	}
+
+	return pbuf - buf;
+}
+
 static DEVICE_ATTR_RO(calliope_version);
+static DEVICE_ATTR_RO(qos_latency);
 static DEVICE_ATTR_WO(calliope_debug);
 static DEVICE_ATTR_WO(calliope_cmd);
 
@@ -6064,8 +6213,9 @@ static int samsung_abox_probe(struct platform_device *pdev)
 
 	abox_probe_quirks(data, np);
 	init_waitqueue_head(&data->ipc_wait_queue);
-	spin_lock_init(&data->ipc_queue_lock);
+	abox_ipc_queue_init(data);
 	mutex_init(&data->iommu_lock);
+	mutex_init(&data->qos_lock);
 	device_init_wakeup(dev, true);
 	data->cpu_gear = ABOX_CPU_GEAR_MIN;
 	data->cpu_gear_min = 3; /* default value from kangchen */
@@ -6322,6 +6472,8 @@ static int samsung_abox_probe(struct platform_device *pdev)
 
 	abox_failsafe_init(dev);
 
+	data->timesync = exynos_timesync_register("abox");
+
 	wakeup_source_init(&data->ws, "abox");
 	wakeup_source_init(&data->ws_boot, "abox_boot");
 
@@ -6337,6 +6489,10 @@ static int samsung_abox_probe(struct platform_device *pdev)
 	if (ret < 0)
 		dev_warn(dev, "Failed to create file: %s\n", "cmd");
 
+	ret = device_create_file(dev, &dev_attr_qos_latency);
+	if (ret < 0)
+		dev_warn(dev, "Failed to create file: %s\n", "qos_latency");
+
 	atomic_notifier_chain_register(&panic_notifier_list,
 			&abox_panic_notifier);
 
@@ -6377,6 +6533,7 @@ static int samsung_abox_remove(struct platform_device *pdev)
 #endif
 	wakeup_source_trash(&data->ws);
 	wakeup_source_trash(&data->ws_boot);
+	exynos_timesync_unregister(data->timesync);
 
 	return 0;
 }
@@ -6408,6 +6565,7 @@ static struct platform_driver samsung_abox_driver = {
 	.shutdown = samsung_abox_shutdown,
 	.driver = {
 		.name = "samsung-abox",
+		.probe_type = EXYNOS_PROBE_NONCRITICAL,
 		.owner = THIS_MODULE,
 		.of_match_table = of_match_ptr(samsung_abox_match),
 		.pm = &samsung_abox_pm,
@@ -522,6 +522,7 @@ enum qchannel {
 #define ABOX_QUIRK_STR_SCSC_BT_HACK	"scsc bt hack"
 
 struct abox_ipc {
+	unsigned int seq;	/* slot is ready to be read when seq == pos + 1 */
 	struct device *dev;
 	int hw_irq;
 	unsigned long long put_time;
@@ -549,6 +550,23 @@ struct abox_qos_request {
 	unsigned int value;
 };
 
+enum abox_qos_domain {
+	ABOX_QOS_CPU_GEAR,
+	ABOX_QOS_INT,
+	ABOX_QOS_MIF,
+	ABOX_QOS_LIT,
+	ABOX_QOS_BIG,
+	ABOX_QOS_COUNT,
+};
+
+/* request to applied latency */
+struct abox_qos_stat {
+	unsigned long long req_time;
+	unsigned int count;
+	unsigned long long total_ns;
+	unsigned long long max_ns;
+};
+
 struct abox_dram_request {
 	void *id;
 	bool on;
@@ -614,13 +632,13 @@ struct abox_data {
 	struct platform_device *pdev_rdma[8];
 	struct platform_device *pdev_wdma[5];
 	struct platform_device *pdev_vts;
+	struct exynos_timesync_client *timesync;
 	struct workqueue_struct *gear_workqueue;
 	struct workqueue_struct *ipc_workqueue;
 	struct work_struct ipc_work;
 	struct abox_ipc ipc_queue[ABOX_IPC_QUEUE_SIZE];
-	int ipc_queue_start;
-	int ipc_queue_end;
-	spinlock_t ipc_queue_lock;
+	unsigned int ipc_queue_start;
+	atomic_t ipc_queue_end;
 	wait_queue_head_t ipc_wait_queue;
 	struct clk *clk_pll;
 	struct clk *clk_audif;
@@ -648,6 +666,8 @@ struct abox_data {
 	unsigned int hmp_boost;
 	struct abox_qos_request hmp_requests[16];
 	struct work_struct change_hmp_boost_work;
+	struct mutex qos_lock;
+	struct abox_qos_stat qos_stat[ABOX_QOS_COUNT];
 	struct abox_dram_request dram_requests[16];
 	unsigned long audif_rates[ABOX_DAI_COUNT];
 	unsigned int sif_rate[SET_INMUX4_SAMPLE_RATE -
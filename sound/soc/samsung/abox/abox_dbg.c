@@ -312,6 +312,254 @@ int abox_dbg_get_error_count(struct device *dev)
 	return count;
 }
 
+#define ABOX_DBG_IPC_LAT_BUCKETS	16
+
+/* bucket n counts latencies in [2^(n-1), 2^n) us, the last one is open */
+static atomic_t abox_ipc_lat_hist[ABOX_DBG_IPC_LAT_BUCKETS];
+static atomic64_t abox_ipc_lat_max;
+
+void abox_dbg_ipc_latency(unsigned long long ns)
+{
+	unsigned long long us = ns / NSEC_PER_USEC;
+	int bucket = us ? min_t(int, fls64(us), ABOX_DBG_IPC_LAT_BUCKETS - 1) : 0;
+	long long max = atomic64_read(&abox_ipc_lat_max);
+
+	atomic_inc(&abox_ipc_lat_hist[bucket]);
+	while (ns > max) {
+		long long old = atomic64_cmpxchg(&abox_ipc_lat_max, max, ns);
+
+		if (old == max)
+			break;
+		max = old;
+	}
+}
+
+static ssize_t abox_dbg_ipc_latency_read(struct file *file,
+		char __user *user_buf, size_t count, loff_t *ppos)
+{
+	char buf[ABOX_DBG_IPC_LAT_BUCKETS * 32 + 64];
+	int i, len = 0;
+
+	for (i = 0; i < ABOX_DBG_IPC_LAT_BUCKETS - 1; i++)
+		len += scnprintf(buf + len, sizeof(buf) - len, "<%6uus: %d\n",
+				1U << i, atomic_read(&abox_ipc_lat_hist[i]));
+	len += scnprintf(buf + len, sizeof(buf) - len, ">=%5uus: %d\n",
+			1U << (i - 1), atomic_read(&abox_ipc_lat_hist[i]));
+	len += scnprintf(buf + len, sizeof(buf) - len, "max: %lldns\n",
+			(long long)atomic64_read(&abox_ipc_lat_max));
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, len);
+}
+
+/* any write resets the histogram */
+static ssize_t abox_dbg_ipc_latency_write(struct file *file,
+		const char __user *user_buf, size_t count, loff_t *ppos)
+{
+	int i;
+
+	for (i = 0; i < ABOX_DBG_IPC_LAT_BUCKETS; i++)
+		atomic_set(&abox_ipc_lat_hist[i], 0);
+	atomic64_set(&abox_ipc_lat_max, 0);
+
+	return count;
+}
+
+static const struct file_operations abox_dbg_ipc_latency_fops = {
+	.open = simple_open,
+	.read = abox_dbg_ipc_latency_read,
+	.write = abox_dbg_ipc_latency_write,
+	.llseek = default_llseek,
+};
+
+#define ABOX_DBG_RDMA_COUNT	8
+
+/* Latency is the playback data queued ahead of the RDMA at pointer query */
+struct abox_dbg_mmap_stat {
+	unsigned int samples;
+	unsigned long long total_us;
+	unsigned int min_us;
+	unsigned int max_us;
+	unsigned int glitches;
+	bool starved;
+};
+
+static struct abox_dbg_mmap_stat abox_mmap_stat[ABOX_DBG_RDMA_COUNT];
+
+void abox_dbg_mmap_start(int id)
+{
+	if (id < 0 || id >= ABOX_DBG_RDMA_COUNT)
+		return;
+
+	abox_mmap_stat[id].starved = false;
+}
+
+void abox_dbg_mmap_position(int id, unsigned int latency_us, bool starved)
+{
+	struct abox_dbg_mmap_stat *stat;
+
+	if (id < 0 || id >= ABOX_DBG_RDMA_COUNT)
+		return;
+
+	stat = &abox_mmap_stat[id];
+	if (!stat->samples || stat->min_us > latency_us)
+		stat->min_us = latency_us;
+	if (stat->max_us < latency_us)
+		stat->max_us = latency_us;
+	stat->total_us += latency_us;
+	stat->samples++;
+
+	/* count only the start of each starvation */
+	if (starved && !stat->starved)
+		stat->glitches++;
+	stat->starved = starved;
+}
+
+static ssize_t abox_dbg_mmap_stat_read(struct file *file,
+		char __user *user_buf, size_t count, loff_t *ppos)
+{
+	char buf[ABOX_DBG_RDMA_COUNT * 96];
+	struct abox_dbg_mmap_stat *stat;
+	int i, len = 0;
+
+	for (i = 0; i < ABOX_DBG_RDMA_COUNT; i++) {
+		stat = &abox_mmap_stat[i];
+		if (!stat->samples)
+			continue;
+		len += scnprintf(buf + len, sizeof(buf) - len,
+				"RDMA%d: latency min=%uus avg=%lluus max=%uus glitches=%u\n",
+				i, stat->min_us,
+				div_u64(stat->total_us, stat->samples),
+				stat->max_us, stat->glitches);
+	}
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, len);
+}
+
+/* any write resets the statistics */
+static ssize_t abox_dbg_mmap_stat_write(struct file *file,
+		const char __user *user_buf, size_t count, loff_t *ppos)
+{
+	memset(abox_mmap_stat, 0, sizeof(abox_mmap_stat));
+
+	return count;
+}
+
+static const struct file_operations abox_dbg_mmap_stat_fops = {
+	.open = simple_open,
+	.read = abox_dbg_mmap_stat_read,
+	.write = abox_dbg_mmap_stat_write,
+	.llseek = default_llseek,
+};
+
+/* Wakeups are counted only while compress offload is playing */
+struct abox_dbg_compr_stat {
+	unsigned int wakeups;
+	unsigned int notified;
+	unsigned long long play_ns;
+	unsigned long long start_ns;
+	bool running;
+};
+
+static struct abox_dbg_compr_stat abox_compr_stat[ABOX_DBG_RDMA_COUNT];
+
+void abox_dbg_compr_start(int id)
+{
+	struct abox_dbg_compr_stat *stat;
+
+	if (id < 0 || id >= ABOX_DBG_RDMA_COUNT)
+		return;
+
+	stat = &abox_compr_stat[id];
+	if (stat->running)
+		return;
+	stat->start_ns = local_clock();
+	stat->running = true;
+}
+
+void abox_dbg_compr_stop(int id)
+{
+	struct abox_dbg_compr_stat *stat;
+
+	if (id < 0 || id >= ABOX_DBG_RDMA_COUNT)
+		return;
+
+	stat = &abox_compr_stat[id];
+	if (!stat->running)
+		return;
+	stat->play_ns += local_clock() - stat->start_ns;
+	stat->running = false;
+}
+
+void abox_dbg_compr_wakeup(int id, bool notified)
+{
+	struct abox_dbg_compr_stat *stat;
+
+	if (id < 0 || id >= ABOX_DBG_RDMA_COUNT)
+		return;
+
+	stat = &abox_compr_stat[id];
+	if (!stat->running)
+		return;
+	stat->wakeups++;
+	if (notified)
+		stat->notified++;
+}
+
+static ssize_t abox_dbg_compr_stat_read(struct file *file,
+		char __user *user_buf, size_t count, loff_t *ppos)
+{
+	char buf[ABOX_DBG_RDMA_COUNT * 96];
+	struct abox_dbg_compr_stat *stat;
+	unsigned long long play_ns, play_ms;
+	int i, len = 0;
+
+	for (i = 0; i < ABOX_DBG_RDMA_COUNT; i++) {
+		stat = &abox_compr_stat[i];
+		play_ns = stat->play_ns;
+		if (stat->running)
+			play_ns += local_clock() - stat->start_ns;
+		play_ms = div_u64(play_ns, NSEC_PER_MSEC);
+		if (!play_ms)
+			continue;
+		len += scnprintf(buf + len, sizeof(buf) - len,
+				"RDMA%d: play=%llus wakeups=%u (%llu/min) notified=%u (%llu/min)\n",
+				i, div_u64(play_ms, MSEC_PER_SEC),
+				stat->wakeups,
+				div64_u64((u64)stat->wakeups * 60 * MSEC_PER_SEC,
+						play_ms),
+				stat->notified,
+				div64_u64((u64)stat->notified * 60 * MSEC_PER_SEC,
+						play_ms));
+	}
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, len);
+}
+
+/* any write resets the statistics */
+static ssize_t abox_dbg_compr_stat_write(struct file *file,
+		const char __user *user_buf, size_t count, loff_t *ppos)
+{
+	struct abox_dbg_compr_stat *stat;
+	int i;
+
+	for (i = 0; i < ABOX_DBG_RDMA_COUNT; i++) {
+		stat = &abox_compr_stat[i];
+		stat->wakeups = 0;
+		stat->notified = 0;
+		stat->play_ns = 0;
+		stat->start_ns = local_clock();
+	}
+
+	return count;
+}
+
+static const struct file_operations abox_dbg_compr_stat_fops = {
+	.open = simple_open,
+	.read = abox_dbg_compr_stat_read,
+	.write = abox_dbg_compr_stat_write,
+	.llseek = default_llseek,
+};
+
 static ssize_t calliope_sram_read(struct file *file, struct kobject *kobj,
 		struct bin_attribute *battr, char *buf,
 		loff_t off, size_t size)
@@ -414,6 +662,12 @@ static int samsung_abox_debug_probe(struct platform_device *pdev)
 	data->dump_base = phys_to_virt(abox_rmem->base);
 	data->dump_base_phys = abox_rmem->base;
 	ret = device_create_file(dev, &dev_attr_gpr);
+	debugfs_create_file("ipc_latency", 0660, abox_dbg_get_root_dir(), NULL,
+			&abox_dbg_ipc_latency_fops);
+	debugfs_create_file("mmap_stats", 0660, abox_dbg_get_root_dir(), NULL,
+			&abox_dbg_mmap_stat_fops);
+	debugfs_create_file("compr_wakeups", 0660, abox_dbg_get_root_dir(),
+			NULL, &abox_dbg_compr_stat_fops);
 	bin_attr_calliope_sram.size = data->sram_size;
 	bin_attr_calliope_sram.private = data->sram_base;
 	bin_attr_calliope_dram.private = data->dram_base;
@@ -99,4 +99,44 @@ extern void abox_dbg_dump_simple(struct device *dev, struct abox_data *data,
  */
 extern void abox_dbg_report_status(struct device *dev, bool ok);
 
+/**
+ * Account an IPC in the latency histogram
+ * @param[in]	ns		time from request to acknowledge by the A-Box
+ */
+extern void abox_dbg_ipc_latency(unsigned long long ns);
+
+/**
+ * Reset starvation state of MMAP playback at stream start
+ * @param[in]	id		id of the rdma
+ */
+extern void abox_dbg_mmap_start(int id);
+
+/**
+ * Account a position query of MMAP playback
+ * @param[in]	id		id of the rdma
+ * @param[in]	latency_us	playback data queued ahead of the rdma
+ * @param[in]	starved		true if no data is queued
+ */
+extern void abox_dbg_mmap_position(int id, unsigned int latency_us,
+		bool starved);
+
+/**
+ * Start accounting playback time of compress offload
+ * @param[in]	id		id of the rdma
+ */
+extern void abox_dbg_compr_start(int id);
+
+/**
+ * Stop accounting playback time of compress offload
+ * @param[in]	id		id of the rdma
+ */
+extern void abox_dbg_compr_stop(int id);
+
+/**
+ * Account an interrupt of compress offload which woke up the AP
+ * @param[in]	id		id of the rdma
+ * @param[in]	notified	true if the writer was woken up too
+ */
+extern void abox_dbg_compr_wakeup(int id, bool notified);
+
 #endif /* __SND_SOC_ABOX_DEBUG_H */
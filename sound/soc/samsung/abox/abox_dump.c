@@ -11,6 +11,8 @@
 /* #define DEBUG */
 #include <linux/module.h>
 #include <linux/debugfs.h>
+#include <linux/mm.h>
+#include <linux/poll.h>
 #include <linux/spinlock.h>
 #include <linux/vmalloc.h>
 #include <linux/pm_runtime.h>
@@ -35,10 +37,13 @@ struct abox_dump_buffer_info {
 	size_t pointer;
 	bool started;
 	bool auto_started;
+	bool mapped;
 	bool file_created;
 	struct file *filp;
 	ssize_t auto_pointer;
 	struct work_struct auto_work;
+	wait_queue_head_t mmap_wait;
+	size_t mmap_pointer;
 };
 
 static struct device *abox_dump_dev_abox;
@@ -75,7 +80,7 @@ static void abox_dump_request_dump(int id)
 	struct abox_dump_buffer_info *info = abox_dump_get_buffer_info(id);
 	ABOX_IPC_MSG msg;
 	struct IPC_SYSTEM_MSG *system = &msg.msg.system;
-	bool start = info->started || info->auto_started;
+	bool start = info->started || info->auto_started || info->mapped;
 
 	dev_dbg(abox_dump_dev_abox, "%s(%d)\n", __func__, id);
 
@@ -217,6 +222,115 @@ static struct snd_soc_card abox_dump_card = {
 	.num_links = 0,
 };
 
+/*
+ * The dump buffer is mapped read only, so that tools read the PCM in place.
+ * Read of the file tells the offset of the buffer in the mapping, its size
+ * and the write pointer of the firmware. Poll waits for the next pointer.
+ */
+static size_t abox_dump_mmap_offset(struct abox_dump_buffer_info *info)
+{
+	return offset_in_page(info->buffer.addr);
+}
+
+static size_t abox_dump_mmap_size(struct abox_dump_buffer_info *info)
+{
+	return PAGE_ALIGN(abox_dump_mmap_offset(info) + info->buffer.bytes);
+}
+
+static int abox_dump_mmap_open(struct inode *inode, struct file *file)
+{
+	struct abox_dump_buffer_info *info = inode->i_private;
+	int ret = 0;
+
+	dev_dbg(info->dev, "%s[%d]\n", __func__, info->id);
+
+	mutex_lock(&info->lock);
+	if (info->mapped) {
+		ret = -EBUSY;
+	} else {
+		info->mapped = true;
+		info->mmap_pointer = info->pointer;
+		file->private_data = info;
+		pm_runtime_get(info->dev);
+		abox_dump_request_dump(info->id);
+	}
+	mutex_unlock(&info->lock);
+
+	return ret;
+}
+
+static int abox_dump_mmap_release(struct inode *inode, struct file *file)
+{
+	struct abox_dump_buffer_info *info = file->private_data;
+
+	dev_dbg(info->dev, "%s[%d]\n", __func__, info->id);
+
+	mutex_lock(&info->lock);
+	info->mapped = false;
+	abox_dump_request_dump(info->id);
+	pm_runtime_put(info->dev);
+	mutex_unlock(&info->lock);
+
+	return 0;
+}
+
+static ssize_t abox_dump_mmap_read(struct file *file, char __user *data,
+		size_t count, loff_t *ppos)
+{
+	struct abox_dump_buffer_info *info = file->private_data;
+	char buffer[SZ_128];
+	size_t pointer = READ_ONCE(info->pointer);
+	int len;
+
+	info->mmap_pointer = pointer;
+	len = scnprintf(buffer, sizeof(buffer),
+			"offset=%zu bytes=%zu pointer=%zu\n",
+			abox_dump_mmap_offset(info), info->buffer.bytes,
+			pointer);
+
+	return simple_read_from_buffer(data, count, ppos, buffer, len);
+}
+
+static unsigned int abox_dump_mmap_poll(struct file *file, poll_table *wait)
+{
+	struct abox_dump_buffer_info *info = file->private_data;
+
+	poll_wait(file, &info->mmap_wait, wait);
+	if (READ_ONCE(info->pointer) != info->mmap_pointer)
+		return POLLIN | POLLRDNORM;
+
+	return 0;
+}
+
+static int abox_dump_mmap_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct abox_dump_buffer_info *info = file->private_data;
+	unsigned long size = vma->vm_end - vma->vm_start;
+
+	dev_dbg(info->dev, "%s[%d](%lu)\n", __func__, info->id, size);
+
+	if (vma->vm_pgoff || size > abox_dump_mmap_size(info))
+		return -EINVAL;
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_page_prot = pgprot_writecombine(vma->vm_page_prot);
+
+	return remap_pfn_range(vma, vma->vm_start,
+			PHYS_PFN(info->buffer.addr), size, vma->vm_page_prot);
+}
+
+static const struct file_operations abox_dump_mmap_fops = {
+	.open = abox_dump_mmap_open,
+	.release = abox_dump_mmap_release,
+	.read = abox_dump_mmap_read,
+	.poll = abox_dump_mmap_poll,
+	.mmap = abox_dump_mmap_mmap,
+	.llseek = default_llseek,
+	.owner = THIS_MODULE,
+};
+
 static void abox_dump_auto_dump_work_func(struct work_struct *work)
 {
 	struct abox_dump_buffer_info *info = container_of(work,
@@ -302,9 +416,15 @@ void abox_dump_register_buffer_work_func(struct work_struct *work)
 		if (info->dev && !abox_dump_get_buffer_info(id)) {
 			dev_info(info->dev, "%s(%d, %s, %#zx)\n", __func__,
 					id, info->name, info->buffer.bytes);
+			char name[16];
+
 			list_add_tail(&info->list, &abox_dump_list_head);
 			platform_device_register_data(info->dev,
 					"samsung-abox-dump", id, NULL, 0);
+			snprintf(name, sizeof(name), "dump-%02d-mmap", id);
+			debugfs_create_file(name, 0444,
+					abox_dbg_get_root_dir(), info,
+					&abox_dump_mmap_fops);
 		}
 	}
 }
@@ -337,6 +457,7 @@ int abox_dump_register_buffer(struct device *dev, int id, const char *name,
 	info->buffer.addr = addr;
 	info->buffer.bytes = bytes;
 	INIT_WORK(&info->auto_work, abox_dump_auto_dump_work_func);
+	init_waitqueue_head(&info->mmap_wait);
 	abox_dump_dev_abox = info->dev = dev;
 	schedule_work(&abox_dump_register_buffer_work);
 
@@ -478,7 +599,10 @@ void abox_dump_period_elapsed(int id, size_t pointer)
 	dev_dbg(dev, "%s[%d](%zx)\n", __func__, id, pointer);
 
 	info->pointer = pointer;
-	schedule_work(&info->auto_work);
+	if (info->mapped)
+		wake_up_interruptible(&info->mmap_wait);
+	if (info->auto_started)
+		schedule_work(&info->auto_work);
 	snd_pcm_period_elapsed(info->substream);
 }
 EXPORT_SYMBOL(abox_dump_period_elapsed);
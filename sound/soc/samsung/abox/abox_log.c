@@ -10,6 +10,7 @@
  */
 /* #define DEBUG */
 #include <linux/debugfs.h>
+#include <linux/mm.h>
 #include <linux/mutex.h>
 #include <linux/vmalloc.h>
 #include <sound/samsung/abox.h>
@@ -47,6 +48,8 @@ struct abox_log_buffer_info {
 	ssize_t file_index;
 	struct mutex lock;
 	struct ABOX_LOG_BUFFER *log_buffer;
+	phys_addr_t log_buffer_addr;
+	atomic_t mapped;
 	struct abox_log_kernel_buffer kernel_buffer;
 };
 
@@ -141,6 +144,10 @@ static void abox_log_flush(struct device *dev,
 	if (log_buffer->index_reader == index_writer)
 		return;
 
+	/* tool reads the shared buffer in place */
+	if (atomic_read(&info->mapped))
+		return;
+
 	dev_dbg(dev, "%s(%d): index_writer=%u, index_reader=%u, size=%u\n",
 			__func__, info->id, index_writer,
 			log_buffer->index_reader, log_buffer->size);
@@ -183,6 +190,19 @@ void abox_log_flush_all(struct device *dev)
 }
 EXPORT_SYMBOL(abox_log_flush_all);
 
+/* Returns true if any log buffer is read through the kernel buffer */
+static bool abox_log_need_flush(void)
+{
+	struct abox_log_buffer_info *info;
+
+	list_for_each_entry(info, &abox_log_list_head, list) {
+		if (!atomic_read(&info->mapped))
+			return true;
+	}
+
+	return false;
+}
+
 static unsigned long abox_log_flush_all_work_rearm_self;
 static void abox_log_flush_all_work_func(struct work_struct *work);
 static DECLARE_DEFERRABLE_WORK(abox_log_flush_all_work,
@@ -191,12 +211,16 @@ static DECLARE_DEFERRABLE_WORK(abox_log_flush_all_work,
 static void abox_log_flush_all_work_func(struct work_struct *work)
 {
 	abox_log_flush_all(NULL);
+	if (!abox_log_need_flush())
+		return;
 	schedule_delayed_work(&abox_log_flush_all_work, msecs_to_jiffies(3000));
 	set_bit(0, &abox_log_flush_all_work_rearm_self);
 }
 
 void abox_log_schedule_flush_all(struct device *dev)
 {
+	if (!abox_log_need_flush())
+		return;
 	if (test_and_clear_bit(0, &abox_log_flush_all_work_rearm_self))
 		cancel_delayed_work(&abox_log_flush_all_work);
 	schedule_delayed_work(&abox_log_flush_all_work, msecs_to_jiffies(100));
@@ -322,6 +346,89 @@ static const struct file_operations abox_log_fops = {
 	.owner = THIS_MODULE,
 };
 
+/*
+ * The shared buffer is mapped read only, so that tools read the log in place
+ * with index_writer and index_reader of struct ABOX_LOG_BUFFER. The buffer is
+ * not flushed to the kernel buffer while it is mapped. Read of the file tells
+ * the offset of struct ABOX_LOG_BUFFER in the mapping.
+ */
+static size_t abox_log_mmap_offset(struct abox_log_buffer_info *info)
+{
+	return offset_in_page(info->log_buffer_addr);
+}
+
+static size_t abox_log_mmap_size(struct abox_log_buffer_info *info)
+{
+	return PAGE_ALIGN(abox_log_mmap_offset(info) +
+			sizeof(*info->log_buffer) + info->log_buffer->size);
+}
+
+static int abox_log_mmap_file_release(struct inode *inode, struct file *file)
+{
+	struct abox_log_buffer_info *info = inode->i_private;
+
+	dev_dbg(info->dev, "%s\n", __func__);
+
+	if (file->private_data) {
+		atomic_dec(&info->mapped);
+		abox_log_schedule_flush_all(info->dev);
+	}
+
+	return 0;
+}
+
+static ssize_t abox_log_mmap_file_read(struct file *file, char __user *buf,
+		size_t count, loff_t *ppos)
+{
+	struct abox_log_buffer_info *info = file_inode(file)->i_private;
+	char buffer[SZ_64];
+	int len;
+
+	len = scnprintf(buffer, sizeof(buffer), "offset=%zu size=%zu\n",
+			abox_log_mmap_offset(info), abox_log_mmap_size(info));
+
+	return simple_read_from_buffer(buf, count, ppos, buffer, len);
+}
+
+static int abox_log_mmap_file_mmap(struct file *file,
+		struct vm_area_struct *vma)
+{
+	struct abox_log_buffer_info *info = file_inode(file)->i_private;
+	unsigned long size = vma->vm_end - vma->vm_start;
+	int ret;
+
+	dev_dbg(info->dev, "%s(%lu)\n", __func__, size);
+
+	if (vma->vm_pgoff || size > abox_log_mmap_size(info))
+		return -EINVAL;
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_page_prot = pgprot_writecombine(vma->vm_page_prot);
+	ret = remap_pfn_range(vma, vma->vm_start,
+			PHYS_PFN(info->log_buffer_addr), size,
+			vma->vm_page_prot);
+	if (ret < 0)
+		return ret;
+
+	/* the first mapping of the file stops flushing until release */
+	if (!file->private_data) {
+		file->private_data = info;
+		atomic_inc(&info->mapped);
+	}
+
+	return 0;
+}
+
+static const struct file_operations abox_log_mmap_fops = {
+	.release = abox_log_mmap_file_release,
+	.read = abox_log_mmap_file_read,
+	.mmap = abox_log_mmap_file_mmap,
+	.llseek = default_llseek,
+	.owner = THIS_MODULE,
+};
+
 static struct abox_log_buffer_info abox_log_buffer_info_new;
 
 void abox_log_register_buffer_work_func(struct work_struct *work)
@@ -329,15 +436,18 @@ void abox_log_register_buffer_work_func(struct work_struct *work)
 	struct device *dev;
 	int id;
 	struct ABOX_LOG_BUFFER *buffer;
+	phys_addr_t addr;
 	struct abox_log_buffer_info *info;
 	char name[16];
 
 	dev = abox_log_buffer_info_new.dev;
 	id = abox_log_buffer_info_new.id;
 	buffer = abox_log_buffer_info_new.log_buffer;
+	addr = abox_log_buffer_info_new.log_buffer_addr;
 	abox_log_buffer_info_new.dev = NULL;
 	abox_log_buffer_info_new.id = 0;
 	abox_log_buffer_info_new.log_buffer = NULL;
+	abox_log_buffer_info_new.log_buffer_addr = 0;
 
 	dev_info(dev, "%s(%d)\n", __func__, id);
 
@@ -346,24 +456,29 @@ void abox_log_register_buffer_work_func(struct work_struct *work)
 	info->id = id;
 	info->file_created = false;
 	atomic_set(&info->opened, 0);
+	atomic_set(&info->mapped, 0);
 	info->kernel_buffer.buffer = vzalloc(SIZE_OF_BUFFER);
 	info->kernel_buffer.index = 0;
 	info->kernel_buffer.wrap = false;
 	init_waitqueue_head(&info->kernel_buffer.wq);
 	info->dev = dev;
 	info->log_buffer = buffer;
+	info->log_buffer_addr = addr;
 	list_add_tail(&info->list, &abox_log_list_head);
 
 	snprintf(name, sizeof(name), "log-%02d", id);
 	debugfs_create_file(name, 0664, abox_dbg_get_root_dir(), info,
 			&abox_log_fops);
+	snprintf(name, sizeof(name), "log-%02d-mmap", id);
+	debugfs_create_file(name, 0444, abox_dbg_get_root_dir(), info,
+			&abox_log_mmap_fops);
 }
 
 static DECLARE_WORK(abox_log_register_buffer_work,
 		abox_log_register_buffer_work_func);
 
 int abox_log_register_buffer(struct device *dev, int id,
-		struct ABOX_LOG_BUFFER *buffer)
+		struct ABOX_LOG_BUFFER *buffer, phys_addr_t addr)
 {
 	struct abox_log_buffer_info *info;
 
@@ -385,6 +500,7 @@ int abox_log_register_buffer(struct device *dev, int id,
 	abox_log_buffer_info_new.dev = dev;
 	abox_log_buffer_info_new.id = id;
 	abox_log_buffer_info_new.log_buffer = buffer;
+	abox_log_buffer_info_new.log_buffer_addr = addr;
 	schedule_work(&abox_log_register_buffer_work);
 
 	return 0;
@@ -434,7 +550,8 @@ static int __init samsung_abox_log_late_initcall(void)
 #ifdef TEST
 	abox_log_test_buffer = vzalloc(SZ_128);
 	abox_log_test_buffer->size = SZ_64;
-	abox_log_register_buffer(NULL, 0, abox_log_test_buffer);
+	abox_log_register_buffer(NULL, 0, abox_log_test_buffer,
+			vmalloc_to_pfn(abox_log_test_buffer) << PAGE_SHIFT);
 	schedule_delayed_work(&abox_log_test_work, msecs_to_jiffies(1000));
 #endif
 
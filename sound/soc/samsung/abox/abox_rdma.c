@@ -124,9 +124,9 @@ enum OFFLOAD_IPTYPE {
 static const struct snd_compr_caps abox_rdma_compr_caps = {
 	.direction		= SND_COMPRESS_PLAYBACK,
 	.min_fragment_size	= SZ_4K,
-	.max_fragment_size	= SZ_32K,
+	.max_fragment_size	= SZ_128K,
 	.min_fragments		= 1,
-	.max_fragments		= 5,
+	.max_fragments		= 8,
 	.num_codecs		= 3,
 	.codecs			= {
 		SND_AUDIOCODEC_MP3,
@@ -331,6 +331,27 @@ static void abox_rdma_compr_clear_intr_ack(struct device *dev)
 	abox_rdma_mailbox_write(dev, COMPR_INTR_ACK, 0);
 }
 
+/*
+ * Returns true if the queued data dropped to the low watermark, which is half
+ * of the buffer or what is left after one free fragment, whichever is more.
+ * Draining stream is always notified to keep the last partial fragment going.
+ */
+static bool abox_rdma_compr_low_watermark(struct abox_compr_data *data,
+		struct snd_compr_runtime *runtime)
+{
+	u64 bytes_available, free, watermark;
+
+	if (data->eos)
+		return true;
+
+	bytes_available = data->received_total - data->copied_total;
+	free = runtime->buffer_size - bytes_available;
+	watermark = max_t(u64, runtime->fragment_size,
+			runtime->buffer_size / 2);
+
+	return free >= watermark;
+}
+
 static int abox_rdma_compr_isr_handler(void *priv)
 {
 	struct platform_device *pdev = priv;
@@ -339,6 +360,7 @@ static int abox_rdma_compr_isr_handler(void *priv)
 	struct abox_compr_data *data = &platform_data->compr_data;
 	int id = platform_data->id;
 	unsigned long flags;
+	bool notify = false;
 	u32 val, fw_stat;
 
 	dev_dbg(dev, "%s[%d]\n", __func__, id);
@@ -379,7 +401,14 @@ static int abox_rdma_compr_isr_handler(void *priv)
 				data->byte_offset -= runtime->buffer_size;
 			spin_unlock_irqrestore(&data->lock, flags);
 
-			snd_compr_fragment_elapsed(data->cstream);
+			/*
+			 * Wake up the writer only when the firmware runs low
+			 * on data, so that the AP refills the buffer in one
+			 * go instead of once per fragment.
+			 */
+			notify = abox_rdma_compr_low_watermark(data, runtime);
+			if (notify)
+				snd_compr_fragment_elapsed(data->cstream);
 
 			if (!data->start &&
 				runtime->state != SNDRV_PCM_STATE_PAUSED) {
@@ -463,6 +492,8 @@ static int abox_rdma_compr_isr_handler(void *priv)
 #endif
 	}
 
+	abox_dbg_compr_wakeup(id, notify);
+
 	wake_up_interruptible(&data->ipc_wait);
 
 	return IRQ_HANDLED;
@@ -759,6 +790,7 @@ static int abox_rdma_compr_trigger(struct snd_compr_stream *stream, int cmd)
 		if (ret < 0)
 			dev_err(dev, "%s: pause cmd failed(%d)\n", __func__,
 					ret);
+		abox_dbg_compr_stop(id);
 		break;
 	case SNDRV_PCM_TRIGGER_STOP:
 		dev_info(dev, "SNDRV_PCM_TRIGGER_STOP\n");
@@ -786,6 +818,7 @@ static int abox_rdma_compr_trigger(struct snd_compr_stream *stream, int cmd)
 		}
 
 		data->start = false;
+		abox_dbg_compr_stop(id);
 
 		/* reset */
 		data->stop_ack = 0;
@@ -801,6 +834,7 @@ static int abox_rdma_compr_trigger(struct snd_compr_stream *stream, int cmd)
 				"SNDRV_PCM_TRIGGER_PAUSE_RELEASE");
 
 		data->start = 1;
+		abox_dbg_compr_start(id);
 		ret = abox_rdma_mailbox_send_cmd(dev, CMD_COMPR_START);
 		if (ret < 0)
 			dev_err(dev, "%s: start cmd failed\n", __func__);
@@ -1500,6 +1534,8 @@ static int abox_rdma_trigger(struct snd_pcm_substream *substream, int cmd)
 	case SNDRV_PCM_TRIGGER_START:
 	case SNDRV_PCM_TRIGGER_RESUME:
 	case SNDRV_PCM_TRIGGER_PAUSE_RELEASE:
+		if (data->buf_type == BUFFER_TYPE_ION)
+			abox_dbg_mmap_start(id);
 		pcmtask_msg->param.trigger = 1;
 		ret = abox_rdma_request_ipc(data, &msg, 1, 0);
 		break;
@@ -1539,11 +1575,18 @@ static snd_pcm_uframes_t abox_rdma_pointer(struct snd_pcm_substream *substream)
 	ssize_t pointer;
 	u32 status = readl(data->sfr_base + ABOX_RDMA_STATUS);
 	bool progress = (status & ABOX_RDMA_PROGRESS_MASK) ? true : false;
-
-	if (data->pointer >= IOVA_RDMA_BUFFER(id)) {
+	bool hw = ((data->type == PLATFORM_NORMAL) ||
+			(data->type == PLATFORM_SYNC)) && progress;
+	bool mmap = (data->buf_type == BUFFER_TYPE_ION);
+
+	/*
+	 * Position reported by IPC is as old as the last period elapsed.
+	 * MMAP streams don't wait for periods, so they always take the
+	 * position from the RDMA status.
+	 */
+	if (data->pointer >= IOVA_RDMA_BUFFER(id) && !(mmap && hw)) {
 		pointer = data->pointer - IOVA_RDMA_BUFFER(id);
-	} else if (((data->type == PLATFORM_NORMAL) ||
-			(data->type == PLATFORM_SYNC)) && progress) {
+	} else if (hw) {
 		ssize_t offset, count;
 		ssize_t buffer_bytes, period_bytes;
 
@@ -1567,6 +1610,16 @@ static snd_pcm_uframes_t abox_rdma_pointer(struct snd_pcm_substream *substream)
 
 	dev_dbg(dev, "%s[%d]: pointer=%08zx\n", __func__, id, pointer);
 
+	if (mmap && runtime->status->state == SNDRV_PCM_STATE_RUNNING &&
+			runtime->control->appl_ptr) {
+		snd_pcm_sframes_t queued = snd_pcm_playback_hw_avail(runtime);
+
+		if (queued < 0)
+			queued = 0;
+		abox_dbg_mmap_position(id, div_u64((u64)queued * USEC_PER_SEC,
+				runtime->rate), !queued);
+	}
+
 	return bytes_to_frames(runtime, pointer);
 }
 